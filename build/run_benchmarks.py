@@ -0,0 +1,335 @@
+#!/usr/bin/env python3
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+
+"""
+Run Open/R benchmark binaries with standardized parameters and collect their
+results into a single JSON report, optionally compared against the report of
+an earlier run, e.g. of the previous release.
+
+Per benchmark, the report holds the time per iteration reported by folly
+benchmark. Per binary, it holds wall and CPU time, peak RSS and, if the binary
+runs on jemalloc, the number of allocations of the whole run.
+
+Usage:
+  run_benchmarks.py --build-dir _build --output benchmarks.json
+  run_benchmarks.py --build-dir _build --output benchmarks.json \\
+      --baseline benchmarks-previous.json
+"""
+
+import argparse
+import json
+import os
+import platform
+import signal
+import sys
+import tempfile
+import time
+
+REPORT_VERSION = 1
+
+# Benchmark binaries as named by CMakeLists.txt
+BENCHMARKS = [
+    "config_store_benchmark",
+    "decision_benchmark",
+    "fib_benchmark",
+    "fib_pipeline_benchmark",
+    "kvstore_benchmark",
+    "kvstore_flood_benchmark",
+    "kvstore_wrapper_benchmark",
+    "link_monitor_benchmark",
+    "messaging_benchmark",
+    "netlink_fib_handler_benchmark",
+    "netlink_protocol_socket_benchmark",
+    "pm_to_kvstore_benchmark",
+    "prefix_manager_benchmark",
+    "spark_benchmark",
+    "spark_scale_benchmark",
+    "util_benchmark",
+]
+
+# Benchmarks programming routes into the kernel, which need root
+ROOT_BENCHMARKS = {
+    "netlink_fib_handler_benchmark",
+    "netlink_protocol_socket_benchmark",
+}
+
+# Ask jemalloc, if in use, to print its stats as JSON upon exit, omitting all
+# but merged arena stats
+JEMALLOC_STATS_CONF = "stats_print:true,stats_print_opts:Jgdablxe"
+
+# Metrics compared against baseline, per binary
+BINARY_METRICS = ["peakRssBytes", "allocations"]
+
+
+def find_binary(build_dir, name):
+    for root, _dirs, files in os.walk(build_dir):
+        if name in files:
+            path = os.path.join(root, name)
+            if os.access(path, os.X_OK):
+                return path
+    return None
+
+
+def parse_benchmark_times(stdout):
+    """
+    Return {benchmark name: ns per iteration} out of `--json` output of folly
+    benchmark, which keys results by "<file>%%<name>".
+    """
+    results = {}
+    # skip any output of the benchmark preceding results
+    offset = 0
+    for line in stdout.splitlines(keepends=True):
+        if line.startswith("{"):
+            try:
+                results, _ = json.JSONDecoder().raw_decode(stdout[offset:])
+                break
+            except ValueError:
+                pass
+        offset += len(line)
+    times = {}
+    for key, value in results.items():
+        name = key.split("%%")[-1]
+        # separators between groups of relative benchmarks
+        if name == "-":
+            continue
+        times[name] = float(value)
+    return times
+
+
+def parse_jemalloc_allocations(stderr):
+    start = stderr.find('{"jemalloc"')
+    if start < 0:
+        return None
+    try:
+        stats, _ = json.JSONDecoder().raw_decode(stderr[start:])
+        merged = stats["jemalloc"]["stats.arenas"]["merged"]
+        return merged["small"]["nmalloc"] + merged["large"]["nmalloc"]
+    except (ValueError, KeyError, TypeError):
+        return None
+
+
+def run_binary(path, args):
+    """
+    Run benchmark binary at `path` and return its output along with resource
+    usage of the child process alone, as reported by wait4().
+    """
+    cmd = [
+        path,
+        "--json",
+        f"--bm_min_usec={args.bm_min_usec}",
+        f"--bm_max_secs={args.bm_max_secs}",
+    ]
+    if args.bm_regex:
+        cmd.append(f"--bm_regex={args.bm_regex}")
+    env = dict(os.environ)
+    env.setdefault("MALLOC_CONF", JEMALLOC_STATS_CONF)
+
+    with tempfile.TemporaryFile("w+") as stdout, tempfile.TemporaryFile(
+        "w+"
+    ) as stderr:
+        start = time.monotonic()
+        pid = os.fork()
+        if pid == 0:
+            os.dup2(stdout.fileno(), 1)
+            os.dup2(stderr.fileno(), 2)
+            try:
+                os.execve(path, cmd, env)
+            finally:
+                os._exit(127)
+
+        timed_out = False
+        while True:
+            waited, status, usage = os.wait4(pid, os.WNOHANG)
+            if waited == pid:
+                break
+            if time.monotonic() - start > args.timeout_secs and not timed_out:
+                os.kill(pid, signal.SIGKILL)
+                timed_out = True
+            time.sleep(0.1)
+        wall_secs = time.monotonic() - start
+
+        stdout.seek(0)
+        stderr.seek(0)
+        return {
+            "command": cmd,
+            "returncode": os.waitstatus_to_exitcode(status)
+            if hasattr(os, "waitstatus_to_exitcode")
+            else status,
+            "timedOut": timed_out,
+            "wallSecs": wall_secs,
+            "usage": usage,
+            "stdout": stdout.read(),
+            "stderr": stderr.read(),
+        }
+
+
+def run_benchmarks(args):
+    binaries = {}
+    for name in args.benchmarks or BENCHMARKS:
+        if name in ROOT_BENCHMARKS and os.geteuid() != 0:
+            print(f"Skipping {name}, requires root", file=sys.stderr)
+            continue
+        path = find_binary(args.build_dir, name)
+        if path is None:
+            print(f"Skipping {name}, not built", file=sys.stderr)
+            continue
+
+        print(f"Running {name}", file=sys.stderr)
+        run = run_binary(path, args)
+        usage = run["usage"]
+        result = {
+            "returncode": run["returncode"],
+            "timedOut": run["timedOut"],
+            "wallSecs": round(run["wallSecs"], 3),
+            "cpuSecs": round(usage.ru_utime + usage.ru_stime, 3),
+            # ru_maxrss is in KB on Linux
+            "peakRssBytes": usage.ru_maxrss * 1024,
+            "allocations": parse_jemalloc_allocations(run["stderr"]),
+            "benchmarks": parse_benchmark_times(run["stdout"]),
+        }
+        if run["returncode"] != 0:
+            result["stderrTail"] = run["stderr"][-4096:]
+        binaries[name] = result
+
+    return {
+        "version": REPORT_VERSION,
+        "timestamp": int(time.time()),
+        "host": platform.node(),
+        "parameters": {
+            "bm_min_usec": args.bm_min_usec,
+            "bm_max_secs": args.bm_max_secs,
+            "bm_regex": args.bm_regex,
+        },
+        "binaries": binaries,
+    }
+
+
+def compare_value(regressions, what, current, baseline, threshold_pct):
+    if not current or not baseline:
+        return
+    change_pct = 100.0 * (current - baseline) / baseline
+    if change_pct > threshold_pct:
+        regressions.append(
+            {
+                "metric": what,
+                "baseline": baseline,
+                "current": current,
+                "changePct": round(change_pct, 1),
+            }
+        )
+
+
+def compare_reports(report, baseline, threshold_pct):
+    """
+    Return metrics of `report` exceeding the ones of `baseline` by more than
+    `threshold_pct`. Metrics missing from either report are not compared.
+    """
+    regressions = []
+    baseline_binaries = baseline.get("binaries", {})
+    for name, result in report["binaries"].items():
+        if name not in baseline_binaries:
+            continue
+        baseline_result = baseline_binaries[name]
+        for metric in BINARY_METRICS:
+            compare_value(
+                regressions,
+                f"{name}:{metric}",
+                result.get(metric),
+                baseline_result.get(metric),
+                threshold_pct,
+            )
+        baseline_times = baseline_result.get("benchmarks", {})
+        for benchmark, ns in result["benchmarks"].items():
+            compare_value(
+                regressions,
+                f"{name}:{benchmark}",
+                ns,
+                baseline_times.get(benchmark),
+                threshold_pct,
+            )
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument(
+        "--build-dir", required=True, help="Build tree holding benchmarks"
+    )
+    parser.add_argument("--output", required=True, help="JSON report to write")
+    parser.add_argument(
+        "--baseline", help="JSON report of an earlier run to compare against"
+    )
+    parser.add_argument(
+        "--threshold-pct",
+        type=float,
+        default=10.0,
+        help="Increase of a metric over baseline reported as regression",
+    )
+    parser.add_argument(
+        "--benchmarks",
+        nargs="*",
+        help="Benchmark binaries to run, all by default",
+    )
+    parser.add_argument(
+        "--bm-regex", default="", help="Only run benchmarks matching regex"
+    )
+    parser.add_argument(
+        "--bm-min-usec",
+        type=int,
+        default=100000,
+        help="Minimum time to run each benchmark epoch",
+    )
+    parser.add_argument(
+        "--bm-max-secs",
+        type=int,
+        default=1,
+        help="Maximum time to run each benchmark",
+    )
+    parser.add_argument(
+        "--timeout-secs",
+        type=int,
+        default=3600,
+        help="Time after which a benchmark binary is killed",
+    )
+    args = parser.parse_args()
+
+    report = run_benchmarks(args)
+    failures = [
+        name
+        for name, result in report["binaries"].items()
+        if result["returncode"] != 0
+    ]
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+        report["baseline"] = {
+            "file": os.path.abspath(args.baseline),
+            "timestamp": baseline.get("timestamp"),
+            "thresholdPct": args.threshold_pct,
+            "regressions": compare_reports(
+                report, baseline, args.threshold_pct
+            ),
+        }
+
+    with open(args.output, "w") as f:
+        json.dump(report, f, indent=2, sort_keys=True)
+    print(f"Wrote {args.output}", file=sys.stderr)
+
+    for name in failures:
+        print(f"FAILED {name}", file=sys.stderr)
+    regressions = report.get("baseline", {}).get("regressions", [])
+    for regression in regressions:
+        print(
+            "REGRESSION {metric}: {baseline} -> {current} "
+            "(+{changePct}%)".format(**regression),
+            file=sys.stderr,
+        )
+    return 1 if failures or regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
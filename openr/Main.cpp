@@ -12,16 +12,26 @@ namespace fs = std::filesystem;
 #include <experimental/filesystem>
 namespace fs = std::experimental::filesystem;
 #endif
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
 #include <syslog.h>
+#include <unistd.h>
 #include <fstream>
 #include <stdexcept>
 
 #include <fbzmq/zmq/Zmq.h>
+#include <folly/String.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/executors/thread_factory/NamedThreadFactory.h>
+#include <folly/futures/Future.h>
 #include <folly/init/Init.h>
 #include <folly/logging/xlog.h>
 #include <folly/system/ThreadName.h>
 #include <glog/logging.h>
 #include <sodium.h>
+#include <thrift/lib/cpp/util/EnumUtils.h>
 #include <thrift/lib/cpp2/server/ThriftServer.h>
 
 #include <openr/allocators/PrefixAllocator.h>
@@ -55,6 +65,7 @@ using namespace openr;
 
 using apache::thrift::concurrency::ThreadManager;
 using openr::messaging::ReplicateQueue;
+using openr::messaging::SharedReplicateQueue;
 
 namespace {
 //
@@ -119,6 +130,93 @@ waitForFibService(const folly::EventBase& mainEvb, int port) {
   XLOG(INFO) << "FibService up. Waited for " << waitMs << " ms.";
 }
 
+/**
+ * Apply CPU affinity and scheduling of thread_scheduling config to the calling
+ * module thread. Failures (e.g. lack of CAP_SYS_NICE) are logged and leave the
+ * thread with its default scheduling.
+ */
+void
+applyThreadScheduling(
+    const Config& config,
+    const std::string& name,
+    const std::vector<int32_t>& isolatedCpus) {
+  const auto schedConfig = config.getThreadSchedulingConfig(name);
+
+  // affinity: own cpus if any, else inherited mask minus isolated cpus
+  cpu_set_t cpuSet;
+  CPU_ZERO(&cpuSet);
+  if (schedConfig.has_value() and not schedConfig->cpus_ref()->empty()) {
+    for (const auto cpu : *schedConfig->cpus_ref()) {
+      CPU_SET(cpu, &cpuSet);
+    }
+  } else if (not isolatedCpus.empty()) {
+    if (pthread_getaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) != 0) {
+      CPU_ZERO(&cpuSet);
+    }
+    for (const auto cpu : isolatedCpus) {
+      CPU_CLR(cpu, &cpuSet);
+    }
+  }
+  if (CPU_COUNT(&cpuSet) > 0) {
+    if (auto err = pthread_setaffinity_np(
+            pthread_self(), sizeof(cpuSet), &cpuSet)) {
+      XLOG(ERR) << "Failed to set CPU affinity of thread " << name << ": "
+                << folly::errnoStr(err);
+    }
+  }
+
+  if (not schedConfig.has_value()) {
+    return;
+  }
+  const auto priority = *schedConfig->priority_ref();
+  if (*schedConfig->policy_ref() == thrift::ThreadSchedulingPolicy::DEFAULT) {
+    if (priority != 0 and
+        setpriority(PRIO_PROCESS, syscall(SYS_gettid), priority) != 0) {
+      XLOG(ERR) << "Failed to set nice value " << priority << " of thread "
+                << name << ": " << folly::errnoStr(errno);
+    }
+    return;
+  }
+  const int policy =
+      *schedConfig->policy_ref() == thrift::ThreadSchedulingPolicy::FIFO
+      ? SCHED_FIFO
+      : SCHED_RR;
+  sched_param param{};
+  param.sched_priority = priority;
+  if (auto err = pthread_setschedparam(pthread_self(), policy, &param)) {
+    XLOG(WARN) << "Failed to set real-time scheduling of thread " << name
+               << ", keeping default scheduling: " << folly::errnoStr(err);
+    return;
+  }
+  XLOG(INFO) << "Thread " << name << " scheduled with "
+             << apache::thrift::util::enumNameSafe(*schedConfig->policy_ref())
+             << " policy, priority " << priority;
+}
+
+/**
+ * [Memory Arenas] Serve allocations of the calling module thread from an arena
+ * of its own as per memory_arenas config. Failures (e.g. jemalloc not in use)
+ * are logged and leave the thread on default arenas.
+ */
+void
+applyMemoryArena(const Config& config, const std::string& name) {
+  const auto& memoryArenas = *config.getConfig().memory_arenas_ref();
+  auto it = memoryArenas.find(name);
+  if (it == memoryArenas.end()) {
+    return;
+  }
+  const bool hugePages = *it->second.huge_pages_ref();
+  try {
+    const auto arena = memory::createArena(hugePages);
+    memory::setThreadArena(arena);
+    XLOG(INFO) << "Thread " << name << " allocates from arena " << arena
+               << (hugePages ? " backed by huge pages" : "");
+  } catch (const std::exception& ex) {
+    XLOG(ERR) << "Failed to set memory arena of thread " << name << ": "
+              << ex.what();
+  }
+}
+
 /**
  * Start an EventBase in a thread, maintain order of thread creation and
  * returns raw pointer of Derived class.
@@ -160,6 +258,9 @@ startEventBase(
 
 int
 main(int argc, char** argv) {
+  // Initialization events are measured from here
+  setOpenrStartTime();
+
   // Set version string to show when `openr --version` is invoked
   std::stringstream ss;
   BuildInfo::log(ss);
@@ -210,6 +311,7 @@ main(int argc, char** argv) {
 #endif
     XLOG(FATAL) << "Failed to start OpenR. Invalid configuration.";
   }
+  logInitializationEvent("Main", thrift::InitializationEvent::CONFIG_LOADED);
 
   SYSLOG(INFO) << config->getRunningConfig();
 
@@ -227,7 +329,7 @@ main(int argc, char** argv) {
   ReplicateQueue<InterfaceDatabase> interfaceUpdatesQueue;
   ReplicateQueue<NeighborInitEvent> neighborUpdatesQueue;
   ReplicateQueue<PrefixEvent> prefixUpdatesQueue;
-  ReplicateQueue<KvStorePublication> kvStoreUpdatesQueue;
+  SharedReplicateQueue<KvStorePublication> kvStoreUpdatesQueue;
   ReplicateQueue<PeerEvent> peerUpdatesQueue;
   ReplicateQueue<KeyValueRequest> kvRequestQueue;
   ReplicateQueue<DecisionRouteUpdate> staticRouteUpdatesQueue;
@@ -253,10 +355,22 @@ main(int argc, char** argv) {
       kvStoreEventsQueue.getReader("linkMonitor");
   auto linkMonitorNetlinkEventsQueueReader =
       netlinkEventsQueue.getReader("linkMonitor");
-  auto sparkInitializationEventsQueueReader =
-      prefixMgrInitializationEventsQueue.getReader("spark");
-  auto sparkInterfaceUpdatesQueueReader =
-      interfaceUpdatesQueue.getReader("spark");
+  // one reader per Spark shard
+  std::vector<std::string> sparkNames;
+  std::vector<messaging::RQueue<thrift::InitializationEvent>>
+      sparkInitializationEventsQueueReaders;
+  std::vector<messaging::RQueue<InterfaceDatabase>>
+      sparkInterfaceUpdatesQueueReaders;
+  for (int32_t shardId = 0;
+       shardId < *config->getSparkConfig().num_shards_ref();
+       ++shardId) {
+    sparkNames.emplace_back(
+        shardId == 0 ? std::string("spark") : fmt::format("spark_{}", shardId));
+    sparkInitializationEventsQueueReaders.emplace_back(
+        prefixMgrInitializationEventsQueue.getReader(sparkNames.back()));
+    sparkInterfaceUpdatesQueueReaders.emplace_back(
+        interfaceUpdatesQueue.getReader(sparkNames.back()));
+  }
   auto prefixMgrKvStoreUpdatesReader =
       kvStoreUpdatesQueue.getReader("prefixManager");
   if (config->isBgpPeeringEnabled()) {
@@ -264,6 +378,11 @@ main(int argc, char** argv) {
         std::make_unique<messaging::RQueue<DecisionRouteUpdate>>(
             prefixMgrRouteUpdatesQueue.getReader("pluginRouteUpdates"));
   }
+  std::optional<messaging::RQueue<InterfaceDatabase>>
+      fibInterfaceUpdatesQueueReader;
+  if (*config->getFibConfig().enable_fast_reroute_ref()) {
+    fibInterfaceUpdatesQueueReader = interfaceUpdatesQueue.getReader("fib");
+  }
 
   // structures to organize our modules
   std::vector<std::thread> allThreads;
@@ -289,11 +408,56 @@ main(int argc, char** argv) {
   });
   mainEvb.waitUntilRunning();
 
-  if (config->isFibServiceWaitingEnabled() and
-      (not config->isNetlinkFibHandlerEnabled())) {
-    waitForFibService(mainEvb, *config->getConfig().fib_port_ref());
-  }
-  logInitializationEvent("Main", thrift::InitializationEvent::AGENT_CONFIGURED);
+  // [Startup graph]
+  //
+  // Modules are started below in dependency order. Work not needed by Spark
+  // to send its first hello is moved off the critical path and expressed as
+  // futures, awaited by modules depending on it:
+  //  - waiting for FibService only blocks start of Fib
+  //  - PersistentStore (loading its database from disk), Monitor and KvStore
+  //    are constructed concurrently with Netlink and with each other
+  folly::CPUThreadPoolExecutor startupExecutor(
+      4, std::make_shared<folly::NamedThreadFactory>("openr-startup"));
+
+  auto fibServiceReady = folly::via(&startupExecutor, [&mainEvb, config]() {
+    if (config->isFibServiceWaitingEnabled() and
+        (not config->isNetlinkFibHandlerEnabled())) {
+      waitForFibService(mainEvb, *config->getConfig().fib_port_ref());
+    }
+    logInitializationEvent(
+        "Main", thrift::InitializationEvent::AGENT_CONFIGURED);
+  });
+
+  auto configStoreReady = folly::via(&startupExecutor, [config]() {
+    auto configStore = std::make_unique<PersistentStore>(config);
+    logInitializationEvent(
+        "PersistentStore",
+        thrift::InitializationEvent::PERSISTENT_STORE_LOADED);
+    return configStore;
+  });
+
+  auto monitorReady = folly::via(&startupExecutor, [&, config]() {
+    return std::make_unique<openr::Monitor>(
+        config,
+        Constants::kEventLogCategory.toString(),
+        logSampleQueue.getReader("monitor"));
+  });
+
+  auto kvStoreReady = folly::via(&startupExecutor, [&, config]() {
+    return std::make_unique<KvStore<thrift::OpenrCtrlCppAsyncClient>>(
+        context,
+        kvStoreUpdatesQueue,
+        kvStoreEventsQueue,
+        peerUpdatesQueue.getReader("kvStore"),
+        kvRequestQueue.getReader("kvStore"),
+        logSampleQueue,
+        KvStoreGlobalCmdUrl{fmt::format(
+            "tcp://{}:{}",
+            *config->getConfig().listen_addr_ref(),
+            Constants::kKvStoreRepPort)},
+        config->getAreaIds(),
+        config->toThriftKvStoreConfig());
+  });
 
   std::shared_ptr<ThreadManager> thriftThreadMgr{nullptr};
   std::unique_ptr<apache::thrift::ThriftServer> netlinkFibServer{nullptr};
@@ -303,7 +467,11 @@ main(int argc, char** argv) {
   // NOTE: Start EventBase only after NetlinkProtocolSocket has been constructed
   auto nlOpenrEvb = std::make_unique<OpenrEventBase>();
   auto nlSock = std::make_unique<openr::fbnl::NetlinkProtocolSocket>(
-      nlOpenrEvb->getEvb(), netlinkEventsQueue);
+      nlOpenrEvb->getEvb(),
+      netlinkEventsQueue,
+      false /* enableIPv6RouteReplaceSemantics */,
+      config->getNetlinkEventCoalescingWindow(),
+      config->isNetlinkIoUringEnabled());
   startEventBase(
       allThreads, orderedEvbs, watchdog, "netlink", std::move(nlOpenrEvb));
 
@@ -323,10 +491,13 @@ main(int argc, char** argv) {
     netlinkFibServer->setCpp2WorkerThreadName("FibTWorker");
     netlinkFibServer->setPort(*config->getConfig().fib_port_ref());
 
-    netlinkFibServerThread =
-        std::make_unique<std::thread>([&netlinkFibServer, &nlSock]() {
+    netlinkFibServerThread = std::make_unique<std::thread>(
+        [&netlinkFibServer,
+         &nlSock,
+         enableNexthopObjects = config->isNetlinkNexthopObjectsEnabled()]() {
           folly::setThreadName("openr-fibService");
-          auto fibHandler = std::make_shared<NetlinkFibHandler>(nlSock.get());
+          auto fibHandler = std::make_shared<NetlinkFibHandler>(
+              nlSock.get(), enableNexthopObjects);
           netlinkFibServer->setInterface(std::move(fibHandler));
 
           XLOG(INFO) << "Starting NetlinkFib server...";
@@ -342,7 +513,7 @@ main(int argc, char** argv) {
       orderedEvbs,
       watchdog,
       "config_store",
-      std::make_unique<PersistentStore>(config));
+      std::move(configStoreReady).get());
 
   // Start monitor Module
   auto monitor = startEventBase(
@@ -350,10 +521,7 @@ main(int argc, char** argv) {
       orderedEvbs,
       watchdog,
       "monitor",
-      std::make_unique<openr::Monitor>(
-          config,
-          Constants::kEventLogCategory.toString(),
-          logSampleQueue.getReader("monitor")));
+      std::move(monitorReady).get());
 
   // Start KVStore
   auto kvStore = startEventBase(
@@ -361,19 +529,7 @@ main(int argc, char** argv) {
       orderedEvbs,
       watchdog,
       "kvstore",
-      std::make_unique<KvStore<thrift::OpenrCtrlCppAsyncClient>>(
-          context,
-          kvStoreUpdatesQueue,
-          kvStoreEventsQueue,
-          peerUpdatesQueue.getReader("kvStore"),
-          kvRequestQueue.getReader("kvStore"),
-          logSampleQueue,
-          KvStoreGlobalCmdUrl{fmt::format(
-              "tcp://{}:{}",
-              *config->getConfig().listen_addr_ref(),
-              Constants::kKvStoreRepPort)},
-          config->getAreaIds(),
-          config->toThriftKvStoreConfig()));
+      std::move(kvStoreReady).get());
   watchdog->addQueue(kvStoreEventsQueue, "kvStoreEventsQueue");
   watchdog->addQueue(kvStoreUpdatesQueue, "kvStoreUpdatesQueue");
   watchdog->addQueue(logSampleQueue, "logSampleQueue");
@@ -416,18 +572,28 @@ main(int argc, char** argv) {
   watchdog->addQueue(prefixUpdatesQueue, "prefixUpdatesQueue");
   watchdog->addQueue(netlinkEventsQueue, "netlinkEventsQueue");
 
-  // Create Spark instance for neighbor discovery
-  auto spark = startEventBase(
-      allThreads,
-      orderedEvbs,
-      watchdog,
-      "spark",
-      std::make_unique<Spark>(
-          std::move(sparkInterfaceUpdatesQueueReader),
-          std::move(sparkInitializationEventsQueueReader),
-          neighborUpdatesQueue,
-          std::make_shared<IoProvider>(),
-          config));
+  // Create Spark instance for neighbor discovery. Interfaces are sharded
+  // among multiple instances if configured.
+  std::vector<Spark*> sparkShards;
+  for (size_t shardId = 0; shardId < sparkNames.size(); ++shardId) {
+    sparkShards.emplace_back(startEventBase(
+        allThreads,
+        orderedEvbs,
+        watchdog,
+        sparkNames.at(shardId),
+        std::make_unique<Spark>(
+            std::move(sparkInterfaceUpdatesQueueReaders.at(shardId)),
+            std::move(sparkInitializationEventsQueueReaders.at(shardId)),
+            neighborUpdatesQueue,
+            std::make_shared<IoProvider>(),
+            config,
+            std::make_pair(
+                Constants::kOpenrVersion, Constants::kOpenrSupportedVersion),
+            Constants::kMaxAllowedPps,
+            shardId)));
+  }
+  auto spark = sparkShards.front();
+  sparkShards.erase(sparkShards.begin());
   watchdog->addQueue(neighborUpdatesQueue, "neighborUpdatesQueue");
 
   // Create link monitor instance.
@@ -519,7 +685,8 @@ main(int argc, char** argv) {
           routeUpdatesQueue));
   watchdog->addQueue(routeUpdatesQueue, "routeUpdatesQueue");
 
-  // Define and start Fib Module
+  // Define and start Fib Module, once FibService is ready
+  std::move(fibServiceReady).get();
   auto fib = startEventBase(
       allThreads,
       orderedEvbs,
@@ -529,7 +696,8 @@ main(int argc, char** argv) {
           config,
           std::move(fibDecisionRouteUpdatesQueueReader),
           fibRouteUpdatesQueue,
-          logSampleQueue));
+          logSampleQueue,
+          std::move(fibInterfaceUpdatesQueueReader)));
   watchdog->addQueue(fibRouteUpdatesQueue, "fibRouteUpdatesQueue");
 
   // Create Open/R control handler
@@ -547,10 +715,45 @@ main(int argc, char** argv) {
       configStore,
       prefixManager,
       spark,
-      config);
+      config,
+      std::move(sparkShards));
   startEventBase(
       allThreads, orderedEvbs, watchdog, "ctrl_evb", std::move(ctrlOpenrEvb));
 
+  // [Memory Governor] degrade modules gracefully as memory usage approaches
+  // the limit monitored by Watchdog
+  if (watchdog) {
+    watchdog->addMemoryPressureHandler(
+        [decision](MemoryPressureLevel level) {
+          decision->setMemoryPressure(level);
+        });
+    watchdog->addMemoryPressureHandler(
+        [fib](MemoryPressureLevel level) { fib->setMemoryPressure(level); });
+    watchdog->addMemoryPressureHandler(
+        [monitor](MemoryPressureLevel level) {
+          monitor->setMemoryPressure(level);
+        });
+    // weak reference, handler must be uniquely owned on shutdown
+    watchdog->addMemoryPressureHandler(
+        [weakCtrlHandler = std::weak_ptr<OpenrCtrlHandler>(ctrlHandler)](
+            MemoryPressureLevel level) {
+          if (auto handler = weakCtrlHandler.lock()) {
+            handler->setMemoryPressure(level);
+          }
+        });
+  }
+
+  // Pin and prioritize module threads as per thread_scheduling config, and
+  // move them to their arenas as per memory_arenas config
+  const auto isolatedCpus = config->getIsolatedCpus();
+  for (auto& evb : orderedEvbs) {
+    evb->getEvb()->runInEventBaseThreadAndWait([&]() {
+      applyThreadScheduling(*config, evb->getEvbName(), isolatedCpus);
+      applyMemoryArena(*config, evb->getEvbName());
+    });
+  }
+  logInitializationEvent("Main", thrift::InitializationEvent::MODULES_STARTED);
+
   // Start the thrift server
   auto thriftCtrlServer =
       std::make_unique<OpenrThriftCtrlServer>(config, ctrlHandler, sslContext);
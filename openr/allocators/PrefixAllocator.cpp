@@ -5,6 +5,7 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <fb303/ServiceData.h>
 #include <folly/Format.h>
 #include <folly/futures/Promise.h>
 #include <folly/logging/xlog.h>
@@ -20,6 +21,8 @@ const std::string kConfigKey{"prefix-allocator-config"};
 
 } // namespace
 
+namespace fb303 = facebook::fb303;
+
 namespace openr {
 
 PrefixAllocator::PrefixAllocator(
@@ -575,7 +578,9 @@ PrefixAllocator::startAllocation(
       [this](uint32_t allocIndex) noexcept -> bool {
         return checkE2eAllocIndex(allocIndex);
       },
-      Constants::kRangeAllocTtl);
+      Constants::kRangeAllocTtl,
+      // stick to previous or hashed index, or the nearest free one
+      true);
 
   // start range allocation
   XLOG(INFO) << "Starting prefix allocation with seed prefix: "
@@ -593,6 +598,7 @@ PrefixAllocator::startAllocation(
     endIndex -= 1;
   }
 
+  allocationStartTs_ = std::chrono::steady_clock::now();
   rangeAllocator_->startAllocator(
       std::make_pair(startIndex, endIndex), getInitPrefixIndex());
 }
@@ -612,6 +618,16 @@ PrefixAllocator::applyMyPrefixIndex(std::optional<uint32_t> prefixIndex) {
   if (prefixIndex and !myPrefixIndex_) {
     XLOG(INFO) << "Elected new prefixIndex " << *prefixIndex;
     logPrefixEvent("PREFIX_ELECTED", std::nullopt, prefixIndex);
+    if (rangeAllocator_) {
+      fb303::fbData->setCounter(
+          "prefix_allocator.allocation_retries",
+          rangeAllocator_->getNumRetries());
+      fb303::fbData->setCounter(
+          "prefix_allocator.time_to_allocation_ms",
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+              std::chrono::steady_clock::now() - allocationStartTs_)
+              .count());
+    }
   } else if (prefixIndex and myPrefixIndex_) {
     XLOG(INFO) << "Updating prefixIndex to " << *prefixIndex << " from "
                << *myPrefixIndex_;
@@ -176,6 +176,9 @@ class PrefixAllocator : public OpenrEventBase {
   // index of my currently claimed prefix within seed prefix
   std::optional<uint32_t> myPrefixIndex_;
 
+  // start of latest range allocation, for time-to-allocation counter
+  std::chrono::steady_clock::time_point allocationStartTs_;
+
   apache::thrift::CompactSerializer serializer_;
 
   // we'll use this to get the full dump from the KvStore
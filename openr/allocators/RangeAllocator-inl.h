@@ -47,7 +47,8 @@ RangeAllocator<T>::RangeAllocator(
     const std::chrono::milliseconds maxBackoffDur /* = 2s */,
     const bool overrideOwner /* = true */,
     const std::function<bool(T)> checkValueInUseCb,
-    const std::chrono::milliseconds rangeAllocTtl)
+    const std::chrono::milliseconds rangeAllocTtl,
+    const bool pickNearestValue)
     : nodeName_(nodeName),
       keyPrefix_(keyPrefix),
       kvStore_(kvStore),
@@ -58,6 +59,7 @@ RangeAllocator<T>::RangeAllocator(
       backoff_(minBackoffDur, maxBackoffDur),
       checkValueInUseCb_(std::move(checkValueInUseCb)),
       rangeAllocTtl_(rangeAllocTtl),
+      pickNearestValue_(pickNearestValue),
       area_(area) {
   timeout_ = folly::AsyncTimeout::make(
       *eventBase_->getEvb(), [this]() mutable noexcept {
@@ -80,6 +82,9 @@ RangeAllocator<T>::~RangeAllocator() {
     }
 
     // Unsubscribe from KvStoreClientInternal if we have been to
+    if (hasStarted_) {
+      kvStoreClient_->unsubscribeKeyFilter();
+    }
     if (myValue_) {
       const auto myKey = createKey(*myValue_);
       kvStoreClient_->unsubscribeKey(area_, myKey);
@@ -134,6 +139,103 @@ RangeAllocator<T>::dumpKeysWithPrefix() const noexcept {
   }
 }
 
+template <typename T>
+void
+RangeAllocator<T>::refreshUnavailableValues() noexcept {
+  auto maybeKeyVals = dumpKeysWithPrefix();
+  CHECK(maybeKeyVals.has_value()); // Crash if key dump failed
+
+  unavailableValues_.clear();
+  for (const auto& [key, thriftVal] : maybeKeyVals.value()) {
+    updateUnavailableValues(key, thriftVal);
+  }
+}
+
+template <typename T>
+void
+RangeAllocator<T>::updateUnavailableValues(
+    const std::string& key, const thrift::Value& thriftVal) noexcept {
+  if (not thriftVal.value_ref().has_value() or
+      thriftVal.value_ref()->size() != sizeof(T)) {
+    return;
+  }
+  const auto val = details::binaryToPrimitive<T>(thriftVal.value_ref().value());
+  if (val < allocRange_.first or val > allocRange_.second or
+      key != createKey(val)) {
+    return;
+  }
+  // owned by higher originator, or by anyone else if override is disallowed.
+  // Own keys and keys without TTL are taken over, same as in tryAllocate().
+  if (nodeName_ == *thriftVal.originatorId_ref() or
+      (overrideOwner_ and nodeName_ > *thriftVal.originatorId_ref()) or
+      (!overrideOwner_ and
+       *thriftVal.ttl_ref() == Constants::kTtlInfinity)) {
+    unavailableValues_.erase(val);
+  } else {
+    unavailableValues_.insert(val);
+  }
+}
+
+template <typename T>
+std::optional<T>
+RangeAllocator<T>::pickAvailableValue(const T seedVal) const noexcept {
+  CHECK_LE(unavailableValues_.size(), allocRangeSize_);
+  const T numAvailable = allocRangeSize_ - unavailableValues_.size();
+  if (numAvailable == 0) {
+    return std::nullopt;
+  }
+
+  if (pickNearestValue_) {
+    // closest value not owned by others nor in use, higher one on tie
+    const auto isAvailable = [this](const T val) {
+      return !unavailableValues_.count(val) and
+          (!checkValueInUseCb_ or !checkValueInUseCb_(val));
+    };
+    const T maxDistance = std::max(
+        preferredValue_ - allocRange_.first,
+        allocRange_.second - preferredValue_);
+    for (T d = 0;; ++d) {
+      if (allocRange_.second - preferredValue_ >= d and
+          isAvailable(preferredValue_ + d)) {
+        return preferredValue_ + d;
+      }
+      if (preferredValue_ - allocRange_.first >= d and
+          isAvailable(preferredValue_ - d)) {
+        return preferredValue_ - d;
+      }
+      if (d == maxDistance) {
+        return std::nullopt;
+      }
+    }
+  }
+
+  // Use random value selection logic based on seedVal
+  std::mt19937_64 gen(seedVal + folly::Random::rand64());
+  std::uniform_int_distribution<T> dist(0, numAvailable - 1);
+
+  // n-th available value: every unavailable value not greater than the
+  // candidate shifts it by one
+  T newVal = allocRange_.first + dist(gen);
+  for (const auto val : unavailableValues_) {
+    if (val > newVal) {
+      break;
+    }
+    ++newVal;
+  }
+
+  // look for a value not in use, starting from the random one
+  for (T i = 0; i < numAvailable; ++i) {
+    if (!checkValueInUseCb_ or !checkValueInUseCb_(newVal)) {
+      return newVal;
+    }
+    // try next available
+    do {
+      newVal = (newVal < allocRange_.second) ? (newVal + 1) : allocRange_.first;
+    } while (unavailableValues_.count(newVal));
+  }
+  return std::nullopt;
+}
+
 template <typename T>
 void
 RangeAllocator<T>::startAllocator(
@@ -163,6 +265,19 @@ RangeAllocator<T>::startAllocator(
     initValue = allocRange_.first;
   }
   allocRangeSize_ = allocRange_.second - allocRange_.first + 1;
+  preferredValue_ = initValue;
+
+  // Track values owned by others
+  kvStoreClient_->subscribeKeyFilter(
+      KvStoreFilters({keyPrefix_}, {}),
+      [this](
+          const std::string& key,
+          std::optional<thrift::Value> thriftVal) noexcept {
+        if (thriftVal.has_value()) {
+          updateUnavailableValues(key, thriftVal.value());
+        }
+      });
+  refreshUnavailableValues();
 
   // Subscribe to changes in KvStore
   VLOG(2) << "RangeAllocator: Created. Scheduling first tryAllocate. "
@@ -259,6 +374,7 @@ RangeAllocator<T>::tryAllocate(const T newVal) noexcept {
   if (!shouldOwnOther && !shouldOwnMine) {
     VLOG(1) << "RangeAllocator: failed to allocate " << newVal << " bcoz of "
             << *maybeThriftVal->originatorId_ref();
+    updateUnavailableValues(newKey, *maybeThriftVal);
     scheduleAllocate(newVal);
     return;
   }
@@ -320,45 +436,25 @@ void
 RangeAllocator<T>::scheduleAllocate(const T seedVal) noexcept {
   // Apply exponential backoff
   backoff_.reportError();
-
-  // Use random value selection logic based on seedVal
-  std::mt19937_64 gen(seedVal + folly::Random::rand64());
-  std::uniform_int_distribution<T> dist(allocRange_.first, allocRange_.second);
-  auto newVal = dist(gen);
-
-  auto maybeKeyVals = dumpKeysWithPrefix();
-  CHECK(maybeKeyVals.has_value()); // Crash if key dump failed
-
-  const auto valOwners =
-      folly::gen::from(maybeKeyVals.value()) |
-      folly::gen::map([](std::pair<std::string, thrift::Value> const& kv) {
-        return std::make_pair(
-            details::binaryToPrimitive<T>(kv.second.value_ref().value()),
-            *kv.second.originatorId_ref());
-      }) |
-      folly::gen::as<
-          std::unordered_map<T /* value */, std::string /* owner */>>();
-
-  // look for a value I can own
-  T i;
-  for (i = 0; i < allocRangeSize_; ++i) {
-    const auto it = valOwners.find(newVal);
-    // not owned yet or owned by higher originator if override is allowed
-    if (it == valOwners.end() or (overrideOwner_ and nodeName_ >= it->second)) {
-      if (!checkValueInUseCb_ or !checkValueInUseCb_(newVal)) {
-        // found
-        break;
-      }
-    }
-    // try next
-    newVal = (newVal < allocRange_.second) ? (newVal + 1) : allocRange_.first;
+  ++numRetries_;
+
+  // look for a value I can own among the ones known to be available
+  auto maybeNewVal = pickAvailableValue(seedVal);
+  if (not maybeNewVal) {
+    // values may have been released since, e.g. expired
+    refreshUnavailableValues();
+    maybeNewVal = pickAvailableValue(seedVal);
   }
-  if (i == allocRangeSize_) {
+  if (not maybeNewVal) {
     LOG(ERROR) << "All values are owned by higher originatorIds";
+    std::mt19937_64 gen(seedVal + folly::Random::rand64());
+    std::uniform_int_distribution<T> dist(
+        allocRange_.first, allocRange_.second);
+    maybeNewVal = dist(gen);
   }
 
   // Schedule timeout to allocate new value
-  allocateValue_ = newVal;
+  allocateValue_ = *maybeNewVal;
   timeout_->scheduleTimeout(backoff_.getTimeRemainingUntilRetry());
 }
 
@@ -410,7 +506,8 @@ RangeAllocator<T>::keyValUpdated(
     // Unsubscribe to update of lost value
     kvStoreClient_->unsubscribeKey(area_, key);
     kvStoreClient_->unsetKey(area_, key);
-    // Schedule allocation for new value
+    // Schedule allocation for new value, avoiding the lost one
+    updateUnavailableValues(key, thriftVal);
     scheduleAllocate(val);
   }
 }
@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <set>
+
 #include <folly/Random.h>
 #include <folly/gen/Base.h>
 
@@ -33,6 +35,15 @@ class RangeAllocator {
    * - Try electing it via KvStore. Higher originatorId wins.
    * - If we fail we should try again with another random number
    * - To ease up re-tries we use ExponentialBackoff
+   * - Values claimed by others are tracked from KvStore updates, so that
+   *   random value is picked only from the ones we can own. Collisions are
+   *   then limited to concurrent claims, even when range is mostly used.
+   *
+   * NOTE: allocator takes over key filter subscription of `kvStoreClient`.
+   *
+   * pickNearestValue: instead of a random value, retry with the available
+   * value nearest to the initial one, e.g. previously allocated value. This
+   * keeps allocations stable across restarts, where collisions are harmless.
    *
    * callback: tells you of new allocated value.
    * overrideOwner:  allow a higher originator ID to grab a key from an existing
@@ -53,7 +64,8 @@ class RangeAllocator {
       const bool overrideOwner = true,
       const std::function<bool(T)> checkValueInUseCb = nullptr,
       const std::chrono::milliseconds rangeAllocTtl =
-          Constants::kRangeAllocTtl);
+          Constants::kRangeAllocTtl,
+      const bool pickNearestValue = false);
 
   /**
    * user must call this to start allocation
@@ -84,6 +96,12 @@ class RangeAllocator {
   // check if the whole range has been allocated
   bool isRangeConsumed() const;
 
+  // Number of allocation retries, i.e. values tried but not won
+  uint64_t
+  getNumRetries() const {
+    return numRetries_;
+  }
+
  private:
   /**
    * Non-copyable and non-movable
@@ -119,6 +137,22 @@ class RangeAllocator {
   std::optional<std::unordered_map<std::string, thrift::Value>>
   dumpKeysWithPrefix() const noexcept;
 
+  /**
+   * Rebuild `unavailableValues_` from KvStore, e.g. as expiry of keys is not
+   * notified to the key filter subscription.
+   */
+  void refreshUnavailableValues() noexcept;
+
+  // Update `unavailableValues_` on new owner of value
+  void updateUnavailableValues(
+      const std::string& key, const thrift::Value& thriftVal) noexcept;
+
+  /**
+   * Pick a random value uniformly among the ones not known to be owned by
+   * others and not in use. Returns std::nullopt if there are none.
+   */
+  std::optional<T> pickAvailableValue(const T seedVal) const noexcept;
+
   //
   // Immutable state
   //
@@ -163,6 +197,16 @@ class RangeAllocator {
   // Currently requested value
   std::optional<T> myRequestedValue_;
 
+  // Values within range owned by others which we can't take over. Ordered,
+  // so that n-th available value can be found with a single walk.
+  std::set<T> unavailableValues_;
+
+  // Initial value, preferred when picking nearest value
+  T preferredValue_{0};
+
+  // Number of scheduled retries
+  uint64_t numRetries_{0};
+
   // Exponential backoff to avoid frequent allocation retries
   ExponentialBackoff<std::chrono::milliseconds> backoff_;
 
@@ -179,6 +223,9 @@ class RangeAllocator {
   // KvStore TTL for value
   const std::chrono::milliseconds rangeAllocTtl_;
 
+  // pick nearest available value to the initial one, rather than random
+  const bool pickNearestValue_{false};
+
   // area ID
   const AreaId area_{};
 };
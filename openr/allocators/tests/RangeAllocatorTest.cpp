@@ -118,7 +118,8 @@ class RangeAllocatorFixture : public ::testing::TestWithParam<bool> {
       const std::optional<std::vector<T>> maybeInitVals,
       std::function<void(int /* client id */, std::optional<T>)> callback,
       const std::chrono::milliseconds rangeAllocTtl =
-          Constants::kRangeAllocTtl) {
+          Constants::kRangeAllocTtl,
+      const bool pickNearestValue = false) {
     // sanity check
     if (maybeInitVals) {
       CHECK_EQ(clients.size(), maybeInitVals->size());
@@ -140,7 +141,8 @@ class RangeAllocatorFixture : public ::testing::TestWithParam<bool> {
           100ms /* max backoff */,
           overrideOwner /* override allowed */,
           nullptr,
-          rangeAllocTtl);
+          rangeAllocTtl,
+          pickNearestValue);
       // start allocator
       allocator->startAllocator(
           allocRange,
@@ -423,6 +425,126 @@ TEST_P(RangeAllocatorFixture, InsufficentRange) {
   }
 }
 
+/**
+ * Run allocators on a range mostly owned by a higher originator. Allocators
+ * must only go for the few values left, and each get one of them.
+ */
+TEST_P(RangeAllocatorFixture, MostlyOwnedRange) {
+  const uint32_t start = 61;
+  const uint32_t rangeSize = kNumClients * 10;
+  const uint32_t end = start + rangeSize - 1; // Range is inclusive
+
+  // Claim all but every 10th value
+  std::set<uint32_t> freeVals;
+  std::vector<std::pair<std::string, thrift::Value>> keyVals;
+  for (uint32_t val = start; val <= end; ++val) {
+    if ((val - start) % 10 == 0) {
+      freeVals.insert(val);
+      continue;
+    }
+    keyVals.emplace_back(
+        fmt::format("value:{}", val),
+        createThriftValue(
+            1,
+            "zzz",
+            details::primitiveToBinary(val),
+            Constants::kRangeAllocTtl.count()));
+  }
+  for (auto& store : stores) {
+    EXPECT_TRUE(store->setKeys(kTestingAreaName, keyVals));
+  }
+
+  folly::Baton waitBaton;
+  bool isPost = false;
+  std::map<int /* client id */, uint32_t /* allocated value */> allocation;
+  auto allocators = createAllocators<uint32_t>(
+      {start, end},
+      std::nullopt,
+      [&](int clientId, std::optional<uint32_t> newVal) {
+        if (newVal) {
+          EXPECT_EQ(1, freeVals.count(newVal.value()));
+          allocation[clientId] = newVal.value();
+        } else {
+          allocation.erase(clientId);
+        }
+
+        const auto allocatedVals = from(allocation) |
+            map([](std::pair<int, uint32_t> const& kv) { return kv.second; }) |
+            as<std::set<uint32_t>>();
+        if (allocatedVals.size() == kNumClients and not isPost) {
+          LOG(INFO) << "We got everything, stopping OpenrEventBase.";
+          isPost = true;
+          waitBaton.post();
+        }
+      });
+
+  // Start the event loop and wait until it is finished execution.
+  evbThread = std::thread([&]() { evb.run(); });
+  evb.waitUntilRunning();
+
+  // Synchronization primitive
+  waitBaton.wait();
+
+  for (auto& allocator : allocators) {
+    allocator.reset();
+  }
+}
+
+/**
+ * Run allocators picking nearest value, with their seed values owned by a
+ * higher originator. Each must get the next value after its seed.
+ */
+TEST_P(RangeAllocatorFixture, PickNearestValue) {
+  const uint32_t start = 61;
+  const uint32_t end = start + kNumClients * 2 - 1; // Range is inclusive
+
+  // Claim seed values, i.e. every other value
+  std::vector<std::pair<std::string, thrift::Value>> keyVals;
+  std::vector<uint32_t> initVals;
+  for (uint32_t i = 0; i < kNumClients; ++i) {
+    const uint32_t val = start + i * 2;
+    initVals.emplace_back(val);
+    keyVals.emplace_back(
+        fmt::format("value:{}", val),
+        createThriftValue(
+            1,
+            "zzz",
+            details::primitiveToBinary(val),
+            Constants::kRangeAllocTtl.count()));
+  }
+  for (auto& store : stores) {
+    EXPECT_TRUE(store->setKeys(kTestingAreaName, keyVals));
+  }
+
+  folly::Baton waitBaton;
+  uint32_t rcvd{0};
+  auto allocators = createAllocators<uint32_t>(
+      {start, end},
+      initVals,
+      [&](int clientId, std::optional<uint32_t> newVal) {
+        ASSERT_TRUE(newVal);
+        EXPECT_EQ(start + clientId * 2 + 1, newVal.value());
+        if (++rcvd == kNumClients) {
+          LOG(INFO) << "We got everything, stopping OpenrEventBase.";
+          waitBaton.post();
+        }
+      },
+      Constants::kRangeAllocTtl,
+      true /* pick nearest value */);
+
+  // Start the event loop and wait until it is finished execution.
+  evbThread = std::thread([&]() { evb.run(); });
+  evb.waitUntilRunning();
+
+  // Synchronization primitive
+  waitBaton.wait();
+
+  for (auto& allocator : allocators) {
+    EXPECT_LE(1, allocator->getNumRetries());
+    allocator.reset();
+  }
+}
+
 } // namespace openr
 
 int
@@ -51,6 +51,16 @@ class AsyncDebounce final : public folly::AsyncTimeout {
     CHECK(isScheduled());
   }
 
+  /**
+   * Change backoff range for the following debounced calls. MUST NOT be
+   * called while timeout is scheduled.
+   */
+  void
+  setBackoffRange(Duration minBackOff, Duration maxBackOff) noexcept {
+    CHECK(not isScheduled());
+    backoff_ = ExponentialBackoff<Duration>(minBackOff, maxBackOff);
+  }
+
   void
   cancelScheduledTimeout() noexcept {
     if (not isScheduled()) {
@@ -51,6 +51,15 @@ class AsyncThrottle final : private folly::AsyncTimeout {
     return isScheduled();
   }
 
+  /**
+   * Change throttle timeout. It applies from next scheduling on, while
+   * callback already scheduled keeps its timeout.
+   */
+  void
+  setTimeout(std::chrono::milliseconds timeout) {
+    timeout_ = timeout;
+  }
+
   /**
    * Cancel scheduled throttle
    */
@@ -65,7 +74,7 @@ class AsyncThrottle final : private folly::AsyncTimeout {
    */
   void timeoutExpired() noexcept override;
 
-  const std::chrono::milliseconds timeout_{0};
+  std::chrono::milliseconds timeout_{0};
   TimeoutCallback callback_{nullptr};
 };
 
@@ -14,6 +14,7 @@ constexpr folly::StringPiece Constants::kAdjDbMarker;
 constexpr folly::StringPiece Constants::kDefaultArea;
 constexpr folly::StringPiece Constants::kErrorResponse;
 constexpr folly::StringPiece Constants::kEventLogCategory;
+constexpr folly::StringPiece Constants::kKvStoreKeyFamilyOther;
 constexpr folly::StringPiece Constants::kNodeLabelRangePrefix;
 constexpr folly::StringPiece Constants::kOpenrCtrlSessionContext;
 constexpr folly::StringPiece Constants::kPlatformHost;
@@ -48,6 +49,7 @@ constexpr std::chrono::milliseconds Constants::kFloodPendingPublication;
 constexpr std::chrono::milliseconds Constants::kInitialBackoff;
 constexpr std::chrono::milliseconds Constants::kKeepAliveCheckInterval;
 constexpr std::chrono::milliseconds Constants::kKvStoreDbTtl;
+constexpr uint32_t Constants::kKvStoreMerkleTreeDepth;
 constexpr std::chrono::milliseconds Constants::kKvStoreClearThrottleTimeout;
 constexpr std::chrono::milliseconds Constants::kKvStoreSyncThrottleTimeout;
 constexpr std::chrono::milliseconds Constants::kLinkImmediateTimeout;
@@ -68,6 +70,8 @@ constexpr std::chrono::milliseconds Constants::kReadTimeout;
 constexpr std::chrono::milliseconds Constants::kServiceConnTimeout;
 constexpr std::chrono::milliseconds Constants::kServiceConnSSLTimeout;
 constexpr std::chrono::milliseconds Constants::kServiceProcTimeout;
+constexpr std::chrono::milliseconds Constants::kSparkNeighborTimerTick;
+constexpr std::chrono::milliseconds Constants::kTtlCountdownTick;
 constexpr std::chrono::milliseconds Constants::kTtlDecrement;
 constexpr std::chrono::milliseconds Constants::kTtlInfInterval;
 constexpr std::chrono::milliseconds Constants::kTtlThreshold;
@@ -75,7 +79,6 @@ constexpr std::chrono::seconds Constants::kConvergenceMaxDuration;
 constexpr std::chrono::seconds Constants::kCounterSubmitInterval;
 constexpr std::chrono::seconds Constants::kKeepAliveIntvl;
 constexpr std::chrono::seconds Constants::kKeepAliveTime;
-constexpr std::chrono::seconds Constants::kFloodTopoDumpInterval;
 constexpr std::chrono::seconds Constants::kMemoryThresholdTime;
 constexpr std::chrono::seconds Constants::kNetlinkSyncThrottleInterval;
 constexpr std::chrono::seconds Constants::kPlatformSyncInterval;
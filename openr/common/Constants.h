@@ -54,6 +54,9 @@ class Constants {
   // The maximum messages we can queue on sending socket
   static constexpr int kHighWaterMark{65536};
 
+  // Max messages a module loop reads off an inter-module queue at once
+  static constexpr size_t kQueueReadBatchSize{256};
+
   // IP TOS to be used for all control IP packets in network flowing across
   // the nodes
   // DSCP = 48 (first 6 bits), ECN = 0 (last 2 bits). Total 192
@@ -85,9 +88,6 @@ class Constants {
   // default interval for kvstore to sync with peers
   static constexpr std::chrono::seconds kStoreSyncInterval{60};
 
-  // default interval for flooding topology dump
-  static constexpr std::chrono::seconds kFloodTopoDumpInterval{60};
-
   // default thrift client keep alive interval to avoid idle timeout
   static constexpr std::chrono::seconds kThriftClientKeepAliveInterval{30};
 
@@ -142,13 +142,21 @@ class Constants {
 
   // The maximum number of spark packets per second we will process from
   // a iface, ip addr pairs that hash to the same bucket in our
-  // fixed size list of BucketedTimeSeries
+  // fixed size list of token buckets
   static constexpr uint32_t kMaxAllowedPps{50};
 
-  // Number of BucketedTimeSeries to spread potential neighbors across
+  // Number of token buckets to spread potential neighbors across
   // for the purpose of limiting the number of packets per second processed
   static constexpr size_t kNumTimeSeries{1024};
 
+  // The maximum number of spark hello and handshake packets per second we
+  // will process from an interface, as a multiple of kMaxAllowedPps
+  static constexpr uint32_t kMaxAllowedPpsPerInterfaceFactor{10};
+
+  // Granularity of per neighbor timers. Timers may fire this late, which is
+  // small compared to the handshake and hold times.
+  static constexpr std::chrono::milliseconds kSparkNeighborTimerTick{10};
+
   //
   // Platform/Fib specific
   //
@@ -194,12 +202,66 @@ class Constants {
   // the time we hold on to announce to KvStore
   static constexpr std::chrono::milliseconds kKvStoreSyncThrottleTimeout{100};
 
+  // the least time we hold on to announce to KvStore with adaptive throttle
+  static constexpr std::chrono::milliseconds kKvStoreSyncMinThrottleTimeout{1};
+
   // Kvstore timer for flooding pending publication
   static constexpr std::chrono::milliseconds kFloodPendingPublication{100};
 
+  // weight of latest sample in smoothed update interval and peer round-trip
+  // time used to size flood batch window
+  static constexpr double kFloodBatchEwmaWeight{0.2};
+
   // KvStore database TTLs
   static constexpr std::chrono::milliseconds kKvStoreDbTtl{5min};
 
+  // window of batching ttl refreshes of self-originated keys. Capped to
+  // 1/16 of key ttl so that refreshes still happen every ttl/4 or so.
+  static constexpr std::chrono::milliseconds kTtlRefreshBatchWindow{1s};
+
+  // depth of the per-area Merkle tree used for bucketed full-sync.
+  // 2^12 = 4096 leaf buckets. MUST be identical across all nodes in an area,
+  // otherwise peers fall back to flat hash comparison.
+  static constexpr uint32_t kKvStoreMerkleTreeDepth{12};
+
+  // format version of warm-restart snapshot of KvStore. Bump on any change
+  // of snapshot layout, so that stale snapshots are ignored.
+  static constexpr int32_t kKvStoreSnapshotVersion{1};
+
+  // default interval of persisting warm-restart snapshot of KvStore
+  static constexpr std::chrono::seconds kKvStoreSnapshotInterval{60};
+
+  // values smaller than this are always flooded in full, since delta would
+  // barely save anything
+  static constexpr size_t kKvStoreValueDeltaMinSize{1024};
+
+  // key families accounted on their own per area. Keys of any further family
+  // are accounted under kKvStoreKeyFamilyOther.
+  static constexpr size_t kKvStoreMaxKeyFamilies{64};
+  static constexpr folly::StringPiece kKvStoreKeyFamilyOther{"other"};
+
+  // max number of distinct key prefix filters with cached hash dump
+  static constexpr size_t kKvStoreHashDumpCacheMaxEntries{16};
+
+  // Bloom filter of recently merged key-vals advertised to peers. 64K bits
+  // with 4 hashes keep false positives below 0.3% for 4K key-vals.
+  static constexpr size_t kKvStoreFloodDigestBits{1 << 16};
+  static constexpr size_t kKvStoreFloodDigestNumHashes{4};
+  static constexpr int32_t kKvStoreFloodDigestMaxHashes{16};
+
+  // interval of rotating and advertising flood digest. Digest of peer is
+  // ignored if not refreshed within twice the interval.
+  static constexpr std::chrono::milliseconds kKvStoreFloodDigestInterval{1s};
+
+  // [Multi-node Dump] default max requests in flight and threads parsing
+  // values of client side dump from multiple nodes
+  static constexpr size_t kKvStoreDumpMaxConcurrency{64};
+  static constexpr size_t kKvStoreDumpParseThreads{4};
+
+  // [Key Sharding] publications with fewer key-vals are merged into shards
+  // inline, as handing them over to workers would cost more than it saves
+  static constexpr size_t kKvStoreShardedMergeMinKeys{256};
+
   // RangeAllocator keys TTLs
   static constexpr std::chrono::milliseconds kRangeAllocTtl{5min};
 
@@ -233,6 +295,9 @@ class Constants {
   static constexpr std::chrono::milliseconds kTtlThreshold{500};
   // ms version
   static constexpr std::chrono::milliseconds kTtlInfInterval{kTtlInfinity};
+  // granularity of KvStore TTL countdown timing wheel. Keys expire at most
+  // one tick later than their TTL.
+  static constexpr std::chrono::milliseconds kTtlCountdownTick{10};
 
   // adjacencies can have weights for weighted ecmp
   static constexpr int64_t kDefaultAdjWeight{1};
@@ -240,10 +305,33 @@ class Constants {
   // buffer size to keep latest perf log
   static constexpr uint16_t kPerfBufferSize{10};
   static constexpr std::chrono::seconds kConvergenceMaxDuration{3s};
+  // number of recent durations kept per convergence stage for percentiles
+  static constexpr size_t kConvergenceStatsSamples{1000};
 
   // hold time for longPoll requests in openrCtrl thrift server
   static constexpr std::chrono::milliseconds kLongPollReqHoldTime{20000};
 
+  // Bounds on deltas and routes buffered for a Fib detail stream subscriber
+  // before deltas are conflated and routes are dropped respectively
+  static constexpr size_t kFibStreamMaxPendingDeltas{1000};
+  static constexpr size_t kFibStreamMaxPendingRoutes{100000};
+
+  // Max number of next-hop groups interned by an encoded stream, see
+  // [Encoded Stream]. Groups are reset past it.
+  static constexpr size_t kStreamMaxNextHopGroups{10000};
+
+  // Length of unicast route ranges fingerprinted incrementally by Fib, see
+  // [Route Fingerprint]
+  static constexpr uint8_t kRouteFingerprintRangeLenV4{16};
+  static constexpr uint8_t kRouteFingerprintRangeLenV6{48};
+
+  // Prefix chunks client can send ahead of a chunked prefix sync sink
+  static constexpr uint64_t kPrefixSyncSinkBufferSize{10};
+
+  // Route batches client can stream ahead of FibService programming them,
+  // see FibServiceCpp.programRoutes()
+  static constexpr uint64_t kRouteStreamSinkBufferSize{16};
+
   //
   // Prefix manager specific
   //
@@ -253,6 +341,9 @@ class Constants {
   static constexpr int32_t kDefaultPathPreference{1000}; // LIVE routes
   static constexpr int32_t kDefaultSourcePreference{200}; // Source pref
 
+  // Max FIB routes redistributed across areas per event loop run
+  static constexpr size_t kMaxRedistributedRoutesPerRun{10000};
+
   // Nexthops used to program drop route
   static constexpr folly::StringPiece kLocalRouteNexthopV4{"0.0.0.0"};
   static constexpr folly::StringPiece kLocalRouteNexthopV6{"::"};
@@ -288,6 +379,22 @@ class Constants {
 
   // Threshold time in secs to crash after reaching critical memory
   static constexpr std::chrono::seconds kMemoryThresholdTime{600};
+
+  // [Memory Governor] Memory pressure stage is left once memory usage falls
+  // this many percent of memory limit below its threshold
+  static constexpr int32_t kMemoryPressureHysteresisPct{5};
+  // [Memory Governor] Number of recent event logs retained by Monitor from
+  // COMPACT_LOGS on
+  static constexpr uint32_t kMemoryPressureMaxEventLogs{10};
+
+  // [Memory Arenas] Size of a transparent huge page. Only extents spanning
+  // at least one are advised to be backed by huge pages.
+  static constexpr size_t kHugePageSize{2 * 1024 * 1024};
+
+  // [Stall Detection] Minimum soft stall threshold, twice the event-base
+  // heartbeat interval, and how long to wait for stack of stalled thread
+  static constexpr std::chrono::milliseconds kMinStallThreshold{200};
+  static constexpr std::chrono::milliseconds kStallStackTimeout{100};
 };
 
 } // namespace openr
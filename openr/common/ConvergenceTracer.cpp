@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+
+#include <fmt/format.h>
+#include <folly/Random.h>
+#include <folly/Synchronized.h>
+#include <folly/json.h>
+#include <folly/system/ThreadId.h>
+#include <folly/system/ThreadName.h>
+
+#include <openr/common/ConvergenceTracer.h>
+
+namespace openr {
+
+namespace {
+
+/**
+ * Ring of events recorded by a single thread. Only owner thread writes, it
+ * fills slot `head % kRingSize` and then bumps `head`. Fields are atomics so
+ * that readers racing with the writer get stale rather than torn values;
+ * entries possibly overwritten while reading are discarded by checking
+ * `head` again.
+ */
+struct TraceRing {
+  struct Entry {
+    std::atomic<int64_t> traceId{0};
+    std::atomic<const char*> event{nullptr};
+    std::atomic<int64_t> unixTsUs{0};
+  };
+
+  explicit TraceRing(std::string threadName)
+      : threadName(std::move(threadName)) {}
+
+  const std::string threadName;
+  std::array<Entry, ConvergenceTracer::kRingSize> entries;
+  std::atomic<uint64_t> head{0};
+};
+
+// Rings of all threads which recorded any event. Rings outlive their thread
+// so that events recorded right before thread exit remain available.
+folly::Synchronized<std::vector<std::shared_ptr<TraceRing>>>&
+getRings() {
+  static auto* rings =
+      new folly::Synchronized<std::vector<std::shared_ptr<TraceRing>>>();
+  return *rings;
+}
+
+TraceRing&
+getThreadRing() {
+  thread_local std::shared_ptr<TraceRing> ring = []() {
+    auto threadName = folly::getCurrentThreadName().value_or(
+        fmt::format("thread-{}", folly::getOSThreadID()));
+    auto newRing = std::make_shared<TraceRing>(std::move(threadName));
+    getRings().wlock()->emplace_back(newRing);
+    return newRing;
+  }();
+  return *ring;
+}
+
+} // namespace
+
+int64_t
+ConvergenceTracer::newTraceId() {
+  // positive, non zero
+  return static_cast<int64_t>(folly::Random::secureRand64() >> 1) | 1;
+}
+
+void
+ConvergenceTracer::record(int64_t traceId, const char* event) noexcept {
+  auto& ring = getThreadRing();
+  const auto head = ring.head.load(std::memory_order_relaxed);
+  auto& entry = ring.entries[head % kRingSize];
+  entry.traceId.store(traceId, std::memory_order_relaxed);
+  entry.event.store(event, std::memory_order_relaxed);
+  entry.unixTsUs.store(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count(),
+      std::memory_order_relaxed);
+  ring.head.store(head + 1, std::memory_order_release);
+}
+
+void
+ConvergenceTracer::record(
+    const thrift::PerfEvents& perfEvents, const char* event) noexcept {
+  for (const auto traceId : *perfEvents.traceIds_ref()) {
+    record(traceId, event);
+  }
+}
+
+void
+ConvergenceTracer::mergeTraceIds(
+    thrift::PerfEvents& to, const thrift::PerfEvents& from) {
+  auto& traceIds = *to.traceIds_ref();
+  for (const auto traceId : *from.traceIds_ref()) {
+    if (traceIds.size() >= kMaxTraceIds) {
+      break;
+    }
+    if (std::find(traceIds.begin(), traceIds.end(), traceId) ==
+        traceIds.end()) {
+      traceIds.emplace_back(traceId);
+    }
+  }
+}
+
+std::vector<thrift::TraceEvent>
+ConvergenceTracer::getEvents(const std::unordered_set<int64_t>& traceIds) {
+  std::vector<thrift::TraceEvent> events;
+  const auto rings = *getRings().rlock();
+  for (const auto& ring : rings) {
+    const auto head = ring->head.load(std::memory_order_acquire);
+    const uint64_t begin = head > kRingSize ? head - kRingSize : 0;
+    // events along with their position in the ring
+    std::vector<std::pair<uint64_t, thrift::TraceEvent>> ringEvents;
+    for (auto i = begin; i < head; ++i) {
+      const auto& entry = ring->entries[i % kRingSize];
+      const auto traceId = entry.traceId.load(std::memory_order_relaxed);
+      if (not traceIds.empty() and not traceIds.count(traceId)) {
+        continue;
+      }
+      thrift::TraceEvent event;
+      event.traceId_ref() = traceId;
+      event.event_ref() = entry.event.load(std::memory_order_relaxed);
+      event.threadName_ref() = ring->threadName;
+      event.unixTsUs_ref() = entry.unixTsUs.load(std::memory_order_relaxed);
+      ringEvents.emplace_back(i, std::move(event));
+    }
+
+    // drop events whose slot got reused by writer while reading. Slot of
+    // `newHead` may be under write, hence it's excluded as well.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const auto newHead = ring->head.load(std::memory_order_relaxed);
+    const uint64_t firstValid =
+        newHead >= kRingSize ? newHead - kRingSize + 1 : 0;
+    for (auto& [i, event] : ringEvents) {
+      if (i >= firstValid) {
+        events.emplace_back(std::move(event));
+      }
+    }
+  }
+
+  std::stable_sort(
+      events.begin(), events.end(), [](const auto& lhs, const auto& rhs) {
+        return *lhs.unixTsUs_ref() < *rhs.unixTsUs_ref();
+      });
+  return events;
+}
+
+std::string
+ConvergenceTracer::toChromeTrace(
+    const std::vector<thrift::TraceEvent>& events) {
+  // Chrome trace needs numeric thread ids, map thread names to them
+  std::unordered_map<std::string, int64_t> threadIds;
+  folly::dynamic traceEvents = folly::dynamic::array;
+  for (const auto& event : events) {
+    auto [it, inserted] =
+        threadIds.emplace(*event.threadName_ref(), threadIds.size() + 1);
+    if (inserted) {
+      traceEvents.push_back(folly::dynamic::object("name", "thread_name")(
+          "ph", "M")("pid", 1)("tid", it->second)(
+          "args", folly::dynamic::object("name", *event.threadName_ref())));
+    }
+    traceEvents.push_back(folly::dynamic::object("name", *event.event_ref())(
+        "cat", "convergence")("ph", "i")("s", "t")("pid", 1)("tid", it->second)(
+        "ts", *event.unixTsUs_ref())(
+        "args",
+        folly::dynamic::object(
+            "trace_id", fmt::format("{:x}", *event.traceId_ref()))));
+  }
+  return folly::toJson(folly::dynamic::object("traceEvents", traceEvents));
+}
+
+} // namespace openr
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <openr/if/gen-cpp2/Types_types.h>
+
+namespace openr {
+
+/**
+ * Low overhead tracing of convergence events across modules.
+ *
+ * Every triggering event (e.g. adjacency change) gets a trace id, carried
+ * along in `PerfEvents.traceIds` of the data objects it leads to. Updates
+ * merged by batching carry the ids of all of them. Modules record trace
+ * events in a lock-free ring buffer of the calling thread; rings are merged
+ * into a timeline on demand.
+ *
+ * Rings are fixed size, oldest events are overwritten.
+ */
+class ConvergenceTracer {
+ public:
+  // Number of events kept per thread
+  static constexpr size_t kRingSize{4096};
+
+  // Max number of trace ids carried by a data object
+  static constexpr size_t kMaxTraceIds{32};
+
+  // Random id for a new triggering event
+  static int64_t newTraceId();
+
+  /**
+   * Record `event` of trace `traceId` in ring of calling thread. `event`
+   * must have static storage duration, e.g. a string literal.
+   */
+  static void record(int64_t traceId, const char* event) noexcept;
+
+  // Record `event` for every trace id of `perfEvents`
+  static void record(
+      const thrift::PerfEvents& perfEvents, const char* event) noexcept;
+
+  /**
+   * Append trace ids of `from` missing in `to`, up to kMaxTraceIds.
+   */
+  static void mergeTraceIds(
+      thrift::PerfEvents& to, const thrift::PerfEvents& from);
+
+  /**
+   * Events recorded by all threads, ordered by time. Only events of
+   * `traceIds` are returned if not empty.
+   */
+  static std::vector<thrift::TraceEvent> getEvents(
+      const std::unordered_set<int64_t>& traceIds = {});
+
+  /**
+   * Serialize `events` in Chrome trace event format, loadable in
+   * chrome://tracing or Perfetto. Every thread is shown as a track.
+   */
+  static std::string toChromeTrace(
+      const std::vector<thrift::TraceEvent>& events);
+};
+
+} // namespace openr
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+
+#include <folly/lang/Bits.h>
+
+namespace openr {
+
+/**
+ * Log-scale histogram of latencies, e.g. time data spends in a queue or lag
+ * of an event loop. Covers values recorded in the last one to two `kWindow`,
+ * so that stats reflect current load rather than the whole lifetime. Both
+ * recording and percentiles are a few dozen of integer operations.
+ * Percentiles are reported as upper bound of their power-of-two bucket,
+ * capped by observed max.
+ *
+ * Not thread-safe, guarded by its owner.
+ */
+class LatencyHistogram {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr std::chrono::seconds kWindow{60};
+
+  void
+  addValue(std::chrono::microseconds latency, Clock::time_point now) {
+    // Rotate windows, keeping the one just ended
+    if (now >= current_.start + kWindow) {
+      previous_ = isLive(current_, now) ? current_ : Window();
+      current_ = Window();
+      current_.start = now;
+    }
+    const uint64_t us = std::max<int64_t>(latency.count(), 0);
+    const size_t bucket =
+        std::min<size_t>(folly::findLastSet(us), kNumBuckets - 1);
+    ++current_.counts[bucket];
+    ++current_.total;
+    current_.max = std::max(current_.max, std::chrono::microseconds(us));
+  }
+
+  /**
+   * Latency at percentile `pct` in [0, 100]. Zero if nothing was recorded
+   * recently.
+   */
+  std::chrono::microseconds
+  getPercentile(double pct, Clock::time_point now) const {
+    std::array<uint64_t, kNumBuckets> counts{};
+    uint64_t total{0};
+    for (const auto* window : {&current_, &previous_}) {
+      if (not isLive(*window, now)) {
+        continue;
+      }
+      for (size_t i = 0; i < kNumBuckets; ++i) {
+        counts[i] += window->counts[i];
+      }
+      total += window->total;
+    }
+    if (total == 0) {
+      return std::chrono::microseconds(0);
+    }
+
+    // Find bucket holding value of rank `pct`, at least the first value
+    const uint64_t rank = std::max<uint64_t>(
+        std::ceil(std::clamp(pct, 0.0, 100.0) / 100.0 * total), 1);
+    const auto max = getMax(now);
+    uint64_t seen{0};
+    for (size_t i = 0; i < kNumBuckets - 1; ++i) {
+      seen += counts[i];
+      if (seen >= rank) {
+        const auto upperBound =
+            std::chrono::microseconds(i == 0 ? 0 : (uint64_t(1) << i) - 1);
+        return std::min(upperBound, max);
+      }
+    }
+    return max;
+  }
+
+  std::chrono::microseconds
+  getMax(Clock::time_point now) const {
+    std::chrono::microseconds max{0};
+    for (const auto* window : {&current_, &previous_}) {
+      if (isLive(*window, now)) {
+        max = std::max(max, window->max);
+      }
+    }
+    return max;
+  }
+
+ private:
+  // Bucket `i` counts latencies in [2^(i-1), 2^i) us, bucket 0 the ones
+  // below 1us, last bucket everything above
+  static constexpr size_t kNumBuckets{32};
+
+  struct Window {
+    Clock::time_point start;
+    std::array<uint64_t, kNumBuckets> counts{};
+    uint64_t total{0};
+    std::chrono::microseconds max{0};
+  };
+
+  // Window is reported until it's older than two windows
+  static bool
+  isLive(const Window& window, Clock::time_point now) {
+    return window.total > 0 and now < window.start + 2 * kWindow;
+  }
+
+  Window current_;
+  Window previous_;
+};
+
+} // namespace openr
@@ -50,4 +50,22 @@ PrefixKey::fromStr(const std::string& key, const std::string& areaIn) {
   return PrefixKey(node, network, areaIn);
 }
 
+std::string
+PrefixKey::getPrefixShardKey(std::string const& node, uint32_t shardId) {
+  return fmt::format(
+      "{}{}:shard-{}", Constants::kPrefixDbMarker.toString(), node, shardId);
+}
+
+folly::Expected<std::pair<std::string, uint32_t>, std::string>
+PrefixKey::parsePrefixShardKey(const std::string& key) {
+  std::string node{};
+  uint32_t shardId{0};
+  if (not RE2::FullMatch(
+          key, PrefixKey::getPrefixShardRE2(), &node, &shardId)) {
+    return folly::makeUnexpected(
+        fmt::format("Invalid format for prefix shard key: {}.", key));
+  }
+  return std::make_pair(std::move(node), shardId);
+}
+
 } // namespace openr
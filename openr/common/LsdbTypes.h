@@ -202,9 +202,10 @@ struct PrefixEntry {
   std::shared_ptr<thrift::PrefixEntry> tPrefixEntry;
   /**
    * Set of area IDs to which this prefix should be advertised. Leave empty to
-   * advertise to all configured areas
+   * advertise to all configured areas. Immutable, and shared by all entries
+   * with same destination areas once stored in PrefixManager.
    */
-  std::unordered_set<std::string> dstAreas;
+  std::shared_ptr<const std::unordered_set<std::string>> dstAreas;
   /**
    * CIDR network of the prefix
    */
@@ -231,7 +232,8 @@ struct PrefixEntry {
       std::optional<OpenrPolicyActionData> policyActionData = std::nullopt,
       OpenrPolicyMatchData policyMatchData = OpenrPolicyMatchData())
       : tPrefixEntry(std::move(tPrefixEntryIn)),
-        dstAreas(std::move(dstAreas)),
+        dstAreas(std::make_shared<const std::unordered_set<std::string>>(
+            std::move(dstAreas))),
         network(toIPNetwork(*tPrefixEntry->prefix_ref())),
         policyActionData(policyActionData),
         policyMatchData(policyMatchData) {}
@@ -241,7 +243,8 @@ struct PrefixEntry {
       std::unordered_set<std::string>&& dstAreas,
       std::optional<std::unordered_set<thrift::NextHopThrift>> nexthops)
       : tPrefixEntry(std::move(tPrefixEntryIn)),
-        dstAreas(std::move(dstAreas)),
+        dstAreas(std::make_shared<const std::unordered_set<std::string>>(
+            std::move(dstAreas))),
         network(toIPNetwork(*tPrefixEntry->prefix_ref())),
         nexthops(std::move(nexthops)) {}
 
@@ -262,7 +265,9 @@ struct PrefixEntry {
 
   bool
   operator==(const PrefixEntry& other) const {
-    return *tPrefixEntry == *other.tPrefixEntry && dstAreas == other.dstAreas &&
+    const bool sameDstAreas = dstAreas == other.dstAreas or
+        (dstAreas and other.dstAreas and *dstAreas == *other.dstAreas);
+    return *tPrefixEntry == *other.tPrefixEntry && sameDstAreas &&
         network == other.network && policyMatchData == other.policyMatchData &&
         policyActionData == other.policyActionData;
   }
@@ -431,6 +436,25 @@ class PrefixKey {
     return prefixKeyPatternV2;
   }
 
+  // Prefix shard key holding entries of all prefixes of a node hashed into
+  // the shard, when prefixes are advertised as a fixed number of keys per
+  // (node, area). Sample format: `prefix:node1:shard-3`
+  static std::string getPrefixShardKey(
+      std::string const& node, uint32_t shardId);
+
+  // parse node name and shard id from prefix shard key
+  static folly::Expected<std::pair<std::string, uint32_t>, std::string>
+  parsePrefixShardKey(const std::string& key);
+
+  static const RE2&
+  getPrefixShardRE2() {
+    static const RE2 prefixShardKeyPattern{fmt::format(
+        "{}(?P<node>[a-zA-Z\\d\\.\\-\\_]+):"
+        "shard-(?P<shardId>[\\d]{{1,10}})",
+        Constants::kPrefixDbMarker.toString())};
+    return prefixShardKeyPattern;
+  }
+
   // return node name and area pair
   inline NodeAndArea const&
   getNodeAndArea() const {
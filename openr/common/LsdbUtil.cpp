@@ -5,6 +5,8 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <string_view>
+
 #include <folly/String.h>
 #include <openr/common/Constants.h>
 #include <openr/common/LsdbUtil.h>
@@ -292,8 +294,51 @@ getRemoteIfName(const thrift::Adjacency& adj) {
   return fmt::format("neigh-{}", *adj.ifName_ref());
 }
 
-thrift::RouteDatabaseDelta
-findDeltaRoutes(
+namespace {
+
+/**
+ * Sorted merge of `newRoutes` and `oldRoutes`, both sorted and keyed by
+ * `getKey`. New routes missing or differing in old ones are added to
+ * `toUpdate`, keys of old routes missing in new ones to `toDelete`.
+ */
+template <typename Route, typename GetKey, typename OnUpdate, typename OnDelete>
+void
+mergeDeltaRoutes(
+    const std::vector<Route>& newRoutes,
+    const std::vector<Route>& oldRoutes,
+    GetKey getKey,
+    OnUpdate onUpdate,
+    OnDelete onDelete) {
+  auto newIt = newRoutes.begin();
+  auto oldIt = oldRoutes.begin();
+  while (newIt != newRoutes.end() and oldIt != oldRoutes.end()) {
+    const auto& newKey = getKey(*newIt);
+    const auto& oldKey = getKey(*oldIt);
+    if (newKey < oldKey) {
+      onUpdate(*newIt++);
+    } else if (oldKey < newKey) {
+      onDelete(oldKey);
+      ++oldIt;
+    } else {
+      if (not(*newIt == *oldIt)) {
+        onUpdate(*newIt);
+      }
+      ++newIt;
+      ++oldIt;
+    }
+  }
+  for (; newIt != newRoutes.end(); ++newIt) {
+    onUpdate(*newIt);
+  }
+  for (; oldIt != oldRoutes.end(); ++oldIt) {
+    onDelete(getKey(*oldIt));
+  }
+}
+
+} // namespace
+
+RouteDatabaseDeltaView
+findDeltaRouteViews(
     const thrift::RouteDatabase& newRouteDb,
     const thrift::RouteDatabase& oldRouteDb) {
   DCHECK(*newRouteDb.thisNodeName_ref() == *oldRouteDb.thisNodeName_ref());
@@ -312,64 +357,57 @@ findDeltaRoutes(
           oldRouteDb.mplsRoutes_ref()->begin(),
           oldRouteDb.mplsRoutes_ref()->end()));
 
-  // Find unicast routes to be added/updated or removed
-  std::vector<thrift::UnicastRoute> unicastRoutesToUpdate;
-  std::set_difference(
-      newRouteDb.unicastRoutes_ref()->begin(),
-      newRouteDb.unicastRoutes_ref()->end(),
-      oldRouteDb.unicastRoutes_ref()->begin(),
-      oldRouteDb.unicastRoutes_ref()->end(),
-      std::inserter(unicastRoutesToUpdate, unicastRoutesToUpdate.begin()));
-  std::vector<thrift::UnicastRoute> unicastRoutesToDelete;
-  std::set_difference(
-      oldRouteDb.unicastRoutes_ref()->begin(),
-      oldRouteDb.unicastRoutes_ref()->end(),
-      newRouteDb.unicastRoutes_ref()->begin(),
-      newRouteDb.unicastRoutes_ref()->end(),
-      std::inserter(unicastRoutesToDelete, unicastRoutesToDelete.begin()));
-
-  // Find mpls routes to be added/updated or removed
-  std::vector<thrift::MplsRoute> mplsRoutesToUpdate;
-  std::set_difference(
-      newRouteDb.mplsRoutes_ref()->begin(),
-      newRouteDb.mplsRoutes_ref()->end(),
-      oldRouteDb.mplsRoutes_ref()->begin(),
-      oldRouteDb.mplsRoutes_ref()->end(),
-      std::inserter(mplsRoutesToUpdate, mplsRoutesToUpdate.begin()));
-  std::vector<thrift::MplsRoute> mplsRoutesToDelete;
-  std::set_difference(
-      oldRouteDb.mplsRoutes_ref()->begin(),
-      oldRouteDb.mplsRoutes_ref()->end(),
-      newRouteDb.mplsRoutes_ref()->begin(),
-      newRouteDb.mplsRoutes_ref()->end(),
-      std::inserter(mplsRoutesToDelete, mplsRoutesToDelete.begin()));
-
-  // Find entry of prefix to be removed
-  std::set<thrift::IpPrefix> prefixesToRemove;
-  for (const auto& route : unicastRoutesToDelete) {
-    prefixesToRemove.emplace(*route.dest_ref());
-  }
-  for (const auto& route : unicastRoutesToUpdate) {
-    prefixesToRemove.erase(*route.dest_ref());
-  }
+  // Routes sorted in full are sorted by prefix or label, the first field
+  RouteDatabaseDeltaView delta;
+  mergeDeltaRoutes(
+      *newRouteDb.unicastRoutes_ref(),
+      *oldRouteDb.unicastRoutes_ref(),
+      [](const thrift::UnicastRoute& route) -> const thrift::IpPrefix& {
+        return *route.dest_ref();
+      },
+      [&delta](const thrift::UnicastRoute& route) {
+        delta.unicastRoutesToUpdate.emplace_back(&route);
+      },
+      [&delta](const thrift::IpPrefix& prefix) {
+        delta.unicastRoutesToDelete.emplace_back(&prefix);
+      });
+  mergeDeltaRoutes(
+      *newRouteDb.mplsRoutes_ref(),
+      *oldRouteDb.mplsRoutes_ref(),
+      [](const thrift::MplsRoute& route) { return *route.topLabel_ref(); },
+      [&delta](const thrift::MplsRoute& route) {
+        delta.mplsRoutesToUpdate.emplace_back(&route);
+      },
+      [&delta](int32_t label) {
+        delta.mplsRoutesToDelete.emplace_back(label);
+      });
+  return delta;
+}
 
-  // Find labels to be removed
-  std::set<int32_t> labelsToRemove;
-  for (const auto& route : mplsRoutesToDelete) {
-    labelsToRemove.emplace(*route.topLabel_ref());
-  }
-  for (const auto& route : mplsRoutesToUpdate) {
-    labelsToRemove.erase(*route.topLabel_ref());
-  }
+thrift::RouteDatabaseDelta
+findDeltaRoutes(
+    const thrift::RouteDatabase& newRouteDb,
+    const thrift::RouteDatabase& oldRouteDb) {
+  const auto delta = findDeltaRouteViews(newRouteDb, oldRouteDb);
 
   // Build routes to be programmed.
   thrift::RouteDatabaseDelta routeDbDelta;
-  routeDbDelta.unicastRoutesToUpdate_ref() = std::move(unicastRoutesToUpdate);
-  routeDbDelta.unicastRoutesToDelete_ref() = {
-      prefixesToRemove.begin(), prefixesToRemove.end()};
-  routeDbDelta.mplsRoutesToUpdate_ref() = std::move(mplsRoutesToUpdate);
-  routeDbDelta.mplsRoutesToDelete_ref() = {
-      labelsToRemove.begin(), labelsToRemove.end()};
+  routeDbDelta.unicastRoutesToUpdate_ref()->reserve(
+      delta.unicastRoutesToUpdate.size());
+  for (const auto* route : delta.unicastRoutesToUpdate) {
+    routeDbDelta.unicastRoutesToUpdate_ref()->emplace_back(*route);
+  }
+  routeDbDelta.unicastRoutesToDelete_ref()->reserve(
+      delta.unicastRoutesToDelete.size());
+  for (const auto* prefix : delta.unicastRoutesToDelete) {
+    routeDbDelta.unicastRoutesToDelete_ref()->emplace_back(*prefix);
+  }
+  routeDbDelta.mplsRoutesToUpdate_ref()->reserve(
+      delta.mplsRoutesToUpdate.size());
+  for (const auto* route : delta.mplsRoutesToUpdate) {
+    routeDbDelta.mplsRoutesToUpdate_ref()->emplace_back(*route);
+  }
+  routeDbDelta.mplsRoutesToDelete_ref() = delta.mplsRoutesToDelete;
 
   return routeDbDelta;
 }
@@ -769,68 +807,72 @@ selectBestNodeArea(
 
 namespace {
 
-std::set<NodeAndArea>
-selectShortestDistance(
-    const PrefixEntries& prefixEntries,
-    const std::set<NodeAndArea>& nodeAreaSet) {
-  std::set<NodeAndArea> ret;
-  int32_t shortestDist = std::numeric_limits<int32_t>::max();
-  for (const auto& nodeArea : nodeAreaSet) {
-    if (prefixEntries.count(nodeArea) == 0) {
+// [Packed Metrics] Announcement of best preferences
+using RouteCandidate = std::pair<const NodeAndArea*, PackedPrefixMetrics>;
+
+// Shortest distance of `candidates`, if any longer than `minDistance`
+std::optional<int32_t>
+getShortestDistance(
+    const std::vector<RouteCandidate>& candidates,
+    std::optional<int32_t> minDistance = std::nullopt) {
+  std::optional<int32_t> shortest;
+  for (const auto& [_, metrics] : candidates) {
+    if (minDistance.has_value() and metrics.distance <= *minDistance) {
       continue;
     }
-    int32_t dist = *prefixEntries.at(nodeArea)->metrics_ref()->distance_ref();
-    if (dist > shortestDist) {
-      continue;
+    if (not shortest.has_value() or metrics.distance < *shortest) {
+      shortest = metrics.distance;
     }
-    if (dist < shortestDist) {
-      shortestDist = dist;
-      ret.clear();
+  }
+  return shortest;
+}
+
+// Candidates within `maxDistance`
+std::set<NodeAndArea>
+selectWithinDistance(
+    const std::vector<RouteCandidate>& candidates, int32_t maxDistance) {
+  std::set<NodeAndArea> ret;
+  for (const auto& [nodeArea, metrics] : candidates) {
+    if (metrics.distance <= maxDistance) {
+      ret.emplace(*nodeArea);
     }
-    ret.emplace(nodeArea);
   }
   return ret;
 }
 
 std::set<NodeAndArea>
-selectShortestDistance2(
-    const PrefixEntries& prefixEntries, std::set<NodeAndArea>& nodeAreaSet) {
-  // Get results with shortest distance.
-  std::set<NodeAndArea> shortestSet =
-      selectShortestDistance(prefixEntries, nodeAreaSet);
-  // Remove NodeAndArea with shortest distance.
-  for (const auto& nodeArea : shortestSet) {
-    nodeAreaSet.erase(nodeArea);
-  }
-  // Get results with second shortest distance.
-  std::set<NodeAndArea> secShortestSet =
-      selectShortestDistance(prefixEntries, nodeAreaSet);
+selectShortestDistance(const std::vector<RouteCandidate>& candidates) {
+  const auto shortest = getShortestDistance(candidates);
+  return shortest.has_value() ? selectWithinDistance(candidates, *shortest)
+                              : std::set<NodeAndArea>();
+}
 
-  std::set<NodeAndArea> ret;
-  std::merge(
-      shortestSet.begin(),
-      shortestSet.end(),
-      secShortestSet.begin(),
-      secShortestSet.end(),
-      std::inserter(ret, ret.begin()));
-  return ret;
+std::set<NodeAndArea>
+selectShortestDistance2(const std::vector<RouteCandidate>& candidates) {
+  // Select results with shortest and second shortest distance
+  const auto shortest = getShortestDistance(candidates);
+  if (not shortest.has_value()) {
+    return {};
+  }
+  const auto secShortest = getShortestDistance(candidates, shortest);
+  return selectWithinDistance(candidates, secShortest.value_or(*shortest));
 }
 
 std::set<NodeAndArea>
-selectShortestDistancePerArea(
-    const PrefixEntries& prefixEntries,
-    const std::set<NodeAndArea>& nodeAreaSet) {
-  // Split nodeAreaSet based on area.
-  std::unordered_map<std::string /*area*/, std::set<NodeAndArea>> areaMap;
-  for (const auto& nodeArea : nodeAreaSet) {
-    areaMap[nodeArea.second].emplace(nodeArea);
+selectShortestDistancePerArea(const std::vector<RouteCandidate>& candidates) {
+  // Get shortest distance in each area
+  std::unordered_map<std::string_view /* area */, int32_t> areaShortest;
+  for (const auto& [nodeArea, metrics] : candidates) {
+    auto [it, inserted] =
+        areaShortest.emplace(nodeArea->second, metrics.distance);
+    if (not inserted) {
+      it->second = std::min(it->second, metrics.distance);
+    }
   }
   std::set<NodeAndArea> ret;
-  // Get shortest distance result in each area.
-  for (const auto& [_, setInArea] : areaMap) {
-    auto shortestRet = selectShortestDistance(prefixEntries, setInArea);
-    for (const auto& nodeArea : shortestRet) {
-      ret.insert(nodeArea);
+  for (const auto& [nodeArea, metrics] : candidates) {
+    if (metrics.distance == areaShortest.at(nodeArea->second)) {
+      ret.emplace(*nodeArea);
     }
   }
   return ret;
@@ -844,35 +886,32 @@ selectRoutes(
     thrift::RouteSelectionAlgorithm algorithm) {
   // First, select prefixEntries with best <path_preference, source_preference>
   // tuples. This is a must-have regardless of route selection algorithms.
-  // Leverage tuple for ease of comparision.
-  std::tuple<int32_t, int32_t> bestMetricsTuple{
-      std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::min()};
-  std::set<NodeAndArea> nodeAreaSet;
+  // Metrics are packed once, selection then compares integers only.
+  std::vector<RouteCandidate> candidates;
+  candidates.reserve(prefixEntries.size());
   for (auto& [key, metricsWrapper] : prefixEntries) {
-    auto& metrics = *metricsWrapper->metrics_ref();
-    std::tuple<int32_t, int32_t> metricsTuple{
-        *metrics.path_preference_ref(), /* prefer-higher */
-        *metrics.source_preference_ref() /* prefer-higher */};
-
-    if (metricsTuple < bestMetricsTuple) {
-      continue;
-    }
-    if (metricsTuple > bestMetricsTuple) {
-      // Clear set and update best metric if this is a new best metric
-      bestMetricsTuple = metricsTuple;
-      nodeAreaSet.clear();
+    const PackedPrefixMetrics metrics(*metricsWrapper->metrics_ref());
+    if (not candidates.empty()) {
+      const auto bestPreferences = candidates.front().second.preferences;
+      if (metrics.preferences < bestPreferences) {
+        continue;
+      }
+      if (metrics.preferences > bestPreferences) {
+        // Clear candidates if this is a new best metric
+        candidates.clear();
+      }
     }
-    nodeAreaSet.emplace(key);
+    candidates.emplace_back(&key, metrics);
   }
 
   // Second, select routes based on selection algorithm.
   switch (algorithm) {
   case thrift::RouteSelectionAlgorithm::SHORTEST_DISTANCE:
-    return selectShortestDistance(prefixEntries, nodeAreaSet);
+    return selectShortestDistance(candidates);
   case thrift::RouteSelectionAlgorithm::K_SHORTEST_DISTANCE_2:
-    return selectShortestDistance2(prefixEntries, nodeAreaSet);
+    return selectShortestDistance2(candidates);
   case thrift::RouteSelectionAlgorithm::PER_AREA_SHORTEST_DISTANCE:
-    return selectShortestDistancePerArea(prefixEntries, nodeAreaSet);
+    return selectShortestDistancePerArea(candidates);
   default:
     XLOG(INFO) << "Unsupported route selection algorithm "
                << apache::thrift::util::enumNameSafe(algorithm);
@@ -104,6 +104,27 @@ folly::CIDRNetwork createLoopbackPrefix(
  */
 std::string getRemoteIfName(const thrift::Adjacency& adj);
 
+/**
+ * [Route Delta View]
+ * Delta between two route databases, as views into them. Valid only as long
+ * as both databases are alive and unmodified.
+ */
+struct RouteDatabaseDeltaView {
+  std::vector<const thrift::UnicastRoute*> unicastRoutesToUpdate;
+  std::vector<const thrift::IpPrefix*> unicastRoutesToDelete;
+  std::vector<const thrift::MplsRoute*> mplsRoutesToUpdate;
+  std::vector<int32_t> mplsRoutesToDelete;
+};
+
+/**
+ * Find delta between two route databases, it requires input to be sorted.
+ * Routes are merged in a single linear pass, routes of the same prefix or
+ * label are compared in full only.
+ */
+RouteDatabaseDeltaView findDeltaRouteViews(
+    const thrift::RouteDatabase& newRouteDb,
+    const thrift::RouteDatabase& oldRouteDb);
+
 /**
  * Find delta between two route databases, it requires input to be sorted.
  */
@@ -277,6 +298,42 @@ std::vector<thrift::MplsRoute> createMplsRoutesFromMap(
 
 std::string getNodeNameFromKey(const std::string& key);
 
+/**
+ * [Packed Metrics]
+ * thrift::PrefixMetrics packed for best route selection: path and source
+ * preferences (prefer-higher) as a single unsigned integer ordered as the
+ * <path_preference, source_preference> tuple, and distance (prefer-lower).
+ * Selection then compares a couple of plain integers.
+ */
+struct PackedPrefixMetrics {
+  explicit PackedPrefixMetrics(const thrift::PrefixMetrics& metrics)
+      : preferences(
+            (static_cast<uint64_t>(
+                 flipSign(*metrics.path_preference_ref()))
+             << 32) |
+            flipSign(*metrics.source_preference_ref())),
+        distance(*metrics.distance_ref()) {}
+
+  // Order of preferences first, then of distance. Positive if better.
+  int
+  compare(const PackedPrefixMetrics& other) const {
+    if (preferences != other.preferences) {
+      return preferences > other.preferences ? 1 : -1;
+    }
+    return distance == other.distance ? 0 : distance < other.distance ? 1 : -1;
+  }
+
+  uint64_t preferences{0};
+  int32_t distance{0};
+
+ private:
+  // map signed to unsigned integers, preserving order
+  static uint32_t
+  flipSign(int32_t value) {
+    return static_cast<uint32_t>(value) ^ 0x80000000u;
+  }
+};
+
 /**
  * Implements Open/R best route selection based on `thrift::PrefixMetrics`. The
  * metrics are compared and keys representing the best metric are returned. It
@@ -284,34 +341,27 @@ std::string getNodeNameFromKey(const std::string& key);
  * key, if more than one keys are returned. Choosing a lowest key as the
  * representative, will be deterministic and easier for implementation.
  *
- * NOTE: MetricsWrapper is expected to provide following API
+ * NOTE: PrefixMap is a map of Key to MetricsWrapper, e.g. `std::unordered_map`,
+ * and MetricsWrapper is expected to provide following API
  *   apache::thrift::field_ref<const thrift::PrefixMetrics&> metrics_ref();
  */
-template <typename Key, typename MetricsWrapper>
+template <typename PrefixMap, typename Key = typename PrefixMap::key_type>
 std::set<Key>
-selectBestPrefixMetrics(
-    std::unordered_map<Key, MetricsWrapper> const& prefixes) {
-  // Leveraging tuple for ease of comparision
-  std::tuple<int32_t, int32_t, int32_t> bestMetricsTuple{
-      std::numeric_limits<int32_t>::min(),
-      std::numeric_limits<int32_t>::min(),
-      std::numeric_limits<int32_t>::min()};
+selectBestPrefixMetrics(PrefixMap const& prefixes) {
+  std::optional<PackedPrefixMetrics> bestMetrics;
   std::set<Key> bestKeys;
   for (auto& [key, metricsWrapper] : prefixes) {
-    auto& metrics = metricsWrapper.metrics_ref().value();
-    std::tuple<int32_t, int32_t, int32_t> metricsTuple{
-        metrics.path_preference_ref().value(), /* prefer-higher */
-        metrics.source_preference_ref().value(), /* prefer-higher */
-        metrics.distance_ref().value() * -1 /* prefer-lower */};
+    const PackedPrefixMetrics metrics(metricsWrapper.metrics_ref().value());
+    const int cmp = bestMetrics.has_value() ? metrics.compare(*bestMetrics) : 1;
 
     // Skip if this is less than best metrics we've seen so far
-    if (metricsTuple < bestMetricsTuple) {
+    if (cmp < 0) {
       continue;
     }
 
     // Clear set and update best metric if this is a new best metric
-    if (metricsTuple > bestMetricsTuple) {
-      bestMetricsTuple = metricsTuple;
+    if (cmp > 0) {
+      bestMetrics = metrics;
       bestKeys.clear();
     }
 
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace openr {
+
+/**
+ * [Memory Governor] Stages of graceful degradation as memory usage approaches
+ * the Watchdog memory limit, see `memory_pressure_thresholds_pct`. Watchdog
+ * notifies registered modules upon every change of stage. Every stage implies
+ * the previous ones, so that a memory spike slows Open/R down instead of
+ * crashing it.
+ */
+enum class MemoryPressureLevel : uint8_t {
+  NONE = 0,
+  // Memoized SPF results, best route selections and ctrl response caches are
+  // dropped and not retained
+  SHRINK_CACHES = 1,
+  // Optional ctrl subscriptions, i.e. Fib detail streams and long polls, are
+  // closed and new ones rejected
+  DROP_SUBSCRIPTIONS = 2,
+  // Perf events of Fib and recent event logs of Monitor are cut down
+  COMPACT_LOGS = 3,
+  // Full dump ctrl APIs with paginated variants are rejected
+  REJECT_DUMPS = 4,
+};
+
+inline const char*
+toString(MemoryPressureLevel level) {
+  switch (level) {
+  case MemoryPressureLevel::NONE:
+    return "NONE";
+  case MemoryPressureLevel::SHRINK_CACHES:
+    return "SHRINK_CACHES";
+  case MemoryPressureLevel::DROP_SUBSCRIPTIONS:
+    return "DROP_SUBSCRIPTIONS";
+  case MemoryPressureLevel::COMPACT_LOGS:
+    return "COMPACT_LOGS";
+  case MemoryPressureLevel::REJECT_DUMPS:
+    return "REJECT_DUMPS";
+  }
+  return "UNKNOWN";
+}
+
+} // namespace openr
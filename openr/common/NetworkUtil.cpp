@@ -5,6 +5,11 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <folly/hash/Hash.h>
+#include <folly/lang/Bits.h>
+#include <algorithm>
+#include <unordered_set>
+
 #include <openr/common/NetworkUtil.h>
 
 namespace std {
@@ -82,4 +87,194 @@ hash<openr::thrift::UnicastRoute>::operator()(
   return res;
 }
 
+/**
+ * Make PackedPrefix hashable
+ */
+size_t
+hash<openr::PackedPrefix>::operator()(
+    openr::PackedPrefix const& prefix) const {
+  std::array<uint64_t, 2> words;
+  std::memcpy(words.data(), prefix.addr.data(), prefix.addr.size());
+  return folly::hash::hash_128_to_64(
+      folly::hash::twang_mix64(words[0] ^ prefix.familyAndLen), words[1]);
+}
+
 } // namespace std
+
+namespace openr {
+
+namespace {
+
+// Zero bits of `addr` past `prefixLength`, a 64-bit word at a time
+void
+maskAddr(std::array<uint8_t, 16>& addr, uint8_t prefixLength) {
+  std::array<uint64_t, 2> words;
+  std::memcpy(words.data(), addr.data(), addr.size());
+  for (int i = 0; i < 2; ++i) {
+    const int bits = std::clamp<int>(prefixLength - 64 * i, 0, 64);
+    const uint64_t mask = bits ? ~uint64_t(0) << (64 - bits) : 0;
+    words[i] &= folly::Endian::big(mask);
+  }
+  std::memcpy(addr.data(), words.data(), addr.size());
+}
+
+} // namespace
+
+PackedPrefix
+PackedPrefix::fromIpPrefix(const thrift::IpPrefix& prefix) {
+  const auto& bytes = *prefix.prefixAddress_ref()->addr_ref();
+  const auto prefixLength = *prefix.prefixLength_ref();
+  if ((bytes.size() != 4 and bytes.size() != 16) or prefixLength < 0 or
+      prefixLength > static_cast<int>(bytes.size() * 8)) {
+    throw thrift::OpenrError(fmt::format(
+        "Invalid IpPrefix: {} address bytes, prefix length {}",
+        bytes.size(),
+        prefixLength));
+  }
+
+  PackedPrefix packed;
+  std::memcpy(packed.addr.data(), bytes.data(), bytes.size());
+  maskAddr(packed.addr, prefixLength);
+  packed.familyAndLen = bytes.size() == 4
+      ? kV6MaxLen + 1 + prefixLength
+      : static_cast<uint8_t>(prefixLength);
+  return packed;
+}
+
+PackedPrefix
+PackedPrefix::fromNetwork(const folly::CIDRNetwork& network) {
+  PackedPrefix packed;
+  std::memcpy(
+      packed.addr.data(), network.first.bytes(), network.first.byteCount());
+  maskAddr(packed.addr, network.second);
+  packed.familyAndLen = network.first.isV4()
+      ? kV6MaxLen + 1 + network.second
+      : network.second;
+  return packed;
+}
+
+folly::CIDRNetwork
+PackedPrefix::toNetwork() const {
+  if (isV4()) {
+    return {
+        folly::IPAddressV4::fromBinary(folly::ByteRange(addr.data(), 4)),
+        getPrefixLength()};
+  }
+  return {
+      folly::IPAddressV6::fromBinary(folly::ByteRange(addr.data(), 16)),
+      getPrefixLength()};
+}
+
+thrift::IpPrefix
+PackedPrefix::toIpPrefix() const {
+  thrift::BinaryAddress binAddr;
+  binAddr.addr_ref()->assign(
+      reinterpret_cast<const char*>(addr.data()), isV4() ? 4 : 16);
+  return createIpPrefix(binAddr, getPrefixLength());
+}
+
+std::vector<folly::CIDRNetwork>
+toIPNetworks(const std::vector<thrift::IpPrefix>& prefixes) {
+  std::vector<folly::CIDRNetwork> networks;
+  networks.reserve(prefixes.size());
+  for (const auto& prefix : prefixes) {
+    networks.emplace_back(PackedPrefix::fromIpPrefix(prefix).toNetwork());
+  }
+  return networks;
+}
+
+std::vector<thrift::IpPrefix>
+toIpPrefixes(const std::vector<folly::CIDRNetwork>& networks) {
+  std::vector<thrift::IpPrefix> prefixes;
+  prefixes.reserve(networks.size());
+  for (const auto& network : networks) {
+    prefixes.emplace_back(toIpPrefix(network));
+  }
+  return prefixes;
+}
+
+std::vector<PackedPrefix>
+toPackedPrefixes(const std::vector<thrift::IpPrefix>& prefixes) {
+  std::vector<PackedPrefix> packed;
+  packed.reserve(prefixes.size());
+  for (const auto& prefix : prefixes) {
+    packed.emplace_back(PackedPrefix::fromIpPrefix(prefix));
+  }
+  return packed;
+}
+
+uint64_t
+getUnicastRouteDigest(const thrift::UnicastRoute& route) {
+  const auto& dest = *route.dest_ref();
+  const auto& destAddr = *dest.prefixAddress_ref()->addr_ref();
+  const int32_t prefixLength = *dest.prefixLength_ref();
+  uint64_t digest = folly::hash::fnv64_buf(destAddr.data(), destAddr.size());
+  digest = folly::hash::fnv64_buf(&prefixLength, sizeof(prefixLength), digest);
+
+  // Next-hops are hashed individually and summed up to be order independent
+  uint64_t nextHopsDigest{0};
+  for (const auto& nh : *route.nextHops_ref()) {
+    const auto& addr = *nh.address_ref()->addr_ref();
+    const auto ifName = nh.address_ref()->ifName_ref().value_or("");
+    uint64_t nhDigest = folly::hash::fnv64_buf(addr.data(), addr.size());
+    nhDigest = folly::hash::fnv64(ifName, nhDigest);
+    // Weight of 0 and 1 both mean equal share
+    const int32_t weight = std::max(*nh.weight_ref(), 1);
+    nhDigest = folly::hash::fnv64_buf(&weight, sizeof(weight), nhDigest);
+    if (nh.mplsAction_ref().has_value()) {
+      const auto& mplsAction = nh.mplsAction_ref().value();
+      std::vector<int32_t> labels{
+          static_cast<int32_t>(*mplsAction.action_ref()),
+          mplsAction.swapLabel_ref().value_or(0)};
+      if (mplsAction.pushLabels_ref().has_value()) {
+        labels.insert(
+            labels.end(),
+            mplsAction.pushLabels_ref()->begin(),
+            mplsAction.pushLabels_ref()->end());
+      }
+      nhDigest = folly::hash::fnv64_buf(
+          labels.data(), labels.size() * sizeof(int32_t), nhDigest);
+    }
+    nextHopsDigest += nhDigest;
+  }
+
+  digest = folly::hash::hash_128_to_64(digest, nextHopsDigest);
+  return digest ? digest : 1;
+}
+
+int32_t
+getPrefixRange(const folly::CIDRNetwork& prefix, int32_t numRanges) {
+  CHECK_GT(numRanges, 0);
+  const uint8_t prefixLength = prefix.second;
+  uint64_t hash =
+      folly::hash::fnv64_buf(prefix.first.bytes(), prefix.first.byteCount());
+  hash = folly::hash::fnv64_buf(&prefixLength, sizeof(prefixLength), hash);
+  return static_cast<int32_t>(hash % static_cast<uint64_t>(numRanges));
+}
+
+std::map<int32_t, int64_t>
+getUnicastRouteRangeDigests(
+    const std::unordered_map<folly::CIDRNetwork, uint64_t>& routeDigests,
+    int32_t numRanges) {
+  std::map<int32_t, uint64_t> digests;
+  std::unordered_set<int32_t> unknownRanges;
+  for (const auto& [prefix, routeDigest] : routeDigests) {
+    const auto range = getPrefixRange(prefix, numRanges);
+    digests[range] += routeDigest;
+    if (routeDigest == 0) {
+      unknownRanges.emplace(range);
+    }
+  }
+
+  std::map<int32_t, int64_t> rangeDigests;
+  for (const auto& [range, digest] : digests) {
+    if (unknownRanges.count(range)) {
+      rangeDigests.emplace(range, 0);
+    } else {
+      rangeDigests.emplace(range, digest ? static_cast<int64_t>(digest) : 1);
+    }
+  }
+  return rangeDigests;
+}
+
+} // namespace openr
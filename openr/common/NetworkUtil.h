@@ -7,6 +7,9 @@
 
 #pragma once
 
+#include <array>
+#include <cstring>
+
 #include <fmt/core.h>
 #include <folly/Format.h>
 #include <folly/IPAddress.h>
@@ -197,8 +200,72 @@ toString(const thrift::MplsRoute& route) {
   return folly::join("\n", lines);
 }
 
+/**
+ * [Packed Prefix]
+ * Compact 17 byte key of a masked prefix: 16 address bytes, IPv4 ones
+ * left-aligned and zero padded, followed by a byte of address family and
+ * prefix length. Unlike folly::CIDRNetwork it is trivially copyable, compared
+ * and hashed as plain bytes, and converts from thrift::IpPrefix without
+ * creating folly::IPAddress.
+ */
+struct PackedPrefix {
+  // Throw thrift::OpenrError on invalid address or prefix length
+  static PackedPrefix fromIpPrefix(const thrift::IpPrefix& prefix);
+
+  static PackedPrefix fromNetwork(const folly::CIDRNetwork& network);
+
+  folly::CIDRNetwork toNetwork() const;
+
+  thrift::IpPrefix toIpPrefix() const;
+
+  bool
+  isV4() const {
+    return familyAndLen > kV6MaxLen;
+  }
+
+  uint8_t
+  getPrefixLength() const {
+    return isV4() ? familyAndLen - kV6MaxLen - 1 : familyAndLen;
+  }
+
+  bool
+  operator==(const PackedPrefix& other) const {
+    return std::memcmp(this, &other, sizeof(PackedPrefix)) == 0;
+  }
+
+  bool
+  operator!=(const PackedPrefix& other) const {
+    return not(*this == other);
+  }
+
+  static constexpr uint8_t kV6MaxLen{128};
+
+  std::array<uint8_t, 16> addr{};
+  // prefix length for IPv6, kV6MaxLen + 1 + prefix length for IPv4
+  uint8_t familyAndLen{0};
+};
+static_assert(sizeof(PackedPrefix) == 17, "PackedPrefix must be 17 bytes");
+
+/**
+ * [Packed Prefix] Batch flavors of prefix conversions, over contiguous arrays
+ * of prefixes as carried by route deltas. Throw thrift::OpenrError on invalid
+ * prefix.
+ */
+std::vector<folly::CIDRNetwork> toIPNetworks(
+    const std::vector<thrift::IpPrefix>& prefixes);
+
+std::vector<thrift::IpPrefix> toIpPrefixes(
+    const std::vector<folly::CIDRNetwork>& networks);
+
+std::vector<PackedPrefix> toPackedPrefixes(
+    const std::vector<thrift::IpPrefix>& prefixes);
+
 inline folly::CIDRNetwork
 toIPNetwork(const thrift::IpPrefix& prefix, bool applyMask = true) {
+  if (applyMask) {
+    // [Packed Prefix] mask address bytes, rather than round trip via string
+    return PackedPrefix::fromIpPrefix(prefix).toNetwork();
+  }
   folly::CIDRNetwork network;
   try {
     network = folly::IPAddress::createNetwork(
@@ -212,4 +279,37 @@ toIPNetwork(const thrift::IpPrefix& prefix, bool applyMask = true) {
   return network;
 }
 
+/**
+ * [Route Digests]
+ * Digests of unicast routes used by differential FIB sync. Prefixes are
+ * partitioned by hash into `numRanges` ranges, and a range digest is the
+ * order-independent combination of route digests within it. Route digests
+ * cover only the forwarding state i.e. destination, next-hop address and
+ * interface, weight and MPLS action. Both digests are stable across
+ * processes, hence can be compared between Open/R and FibService.
+ *
+ * NOTE: Route digest is never 0. A route digest of 0 marks a route with
+ * unknown state, the range digest of which is then reported as 0 so that it
+ * never matches.
+ */
+uint64_t getUnicastRouteDigest(const thrift::UnicastRoute& route);
+
+int32_t getPrefixRange(const folly::CIDRNetwork& prefix, int32_t numRanges);
+
+std::map<int32_t, int64_t> getUnicastRouteRangeDigests(
+    const std::unordered_map<folly::CIDRNetwork, uint64_t>& routeDigests,
+    int32_t numRanges);
+
 } // namespace openr
+
+namespace std {
+
+/**
+ * Make PackedPrefix hashable
+ */
+template <>
+struct hash<openr::PackedPrefix> {
+  size_t operator()(openr::PackedPrefix const&) const;
+};
+
+} // namespace std
@@ -7,6 +7,9 @@
 
 #include <folly/fibers/FiberManagerMap.h>
 #include <folly/logging/xlog.h>
+#if FOLLY_HAS_COROUTINES
+#include <folly/experimental/coro/Task.h>
+#endif
 
 #include <openr/common/OpenrEventBase.h>
 
@@ -122,15 +125,31 @@ OpenrEventBase::ZmqEventHandler::handlerReady(uint16_t events) noexcept {
 }
 
 OpenrEventBase::OpenrEventBase()
-    : fiberManager_(folly::fibers::getFiberManager(evb_, getFmOptions())) {
+    : fiberManager_(folly::fibers::getFiberManager(evb_, getFmOptions())),
+      loopObserver_(std::make_shared<LoopObserver>()) {
+  evb_.setObserver(loopObserver_);
+
   // Periodic timer to update eventbase's timestamp. This is used by Watchdog to
   // identify stuck threads.
   // update aliveness timestamp
   timestamp_.store(std::chrono::steady_clock::now().time_since_epoch().count());
   timeout_ = folly::AsyncTimeout::make(evb_, [this]() noexcept {
-    timestamp_.store(
-        std::chrono::steady_clock::now().time_since_epoch().count());
-    timeout_->scheduleTimeout(std::chrono::seconds(1));
+    const auto now = std::chrono::steady_clock::now();
+    timestamp_.store(now.time_since_epoch().count());
+    if (not hasThread_.load()) {
+      thread_.store(pthread_self());
+      hasThread_.store(true);
+    }
+
+    // Time spent by timer waiting for the loop, past its schedule
+    if (nextHeartbeat_.has_value()) {
+      loopLag_.addValue(
+          std::chrono::duration_cast<std::chrono::microseconds>(
+              now - *nextHeartbeat_),
+          now);
+    }
+    nextHeartbeat_ = now + kHeartbeatInterval;
+    timeout_->scheduleTimeout(kHeartbeatInterval);
   });
   timeout_->scheduleTimeout(0);
 }
@@ -142,11 +161,66 @@ OpenrEventBase::run() {
   evb_.loopForever();
 }
 
+EventBaseStats
+OpenrEventBase::getStats() {
+  const auto now = std::chrono::steady_clock::now();
+  EventBaseStats stats;
+  stats.loopLagP50 = loopLag_.getPercentile(50, now);
+  stats.loopLagP99 = loopLag_.getPercentile(99, now);
+  stats.loopLagMax = loopLag_.getMax(now);
+
+  const auto loopTimeUs =
+      loopObserver_->busyTimeUs_ + loopObserver_->idleTimeUs_;
+  if (loopTimeUs > 0) {
+    stats.busyPct = 100.0 * loopObserver_->busyTimeUs_ / loopTimeUs;
+  }
+  loopObserver_->busyTimeUs_ = 0;
+  loopObserver_->idleTimeUs_ = 0;
+
+  stats.longestTasks = std::move(longestTasks_);
+  longestTasks_.clear();
+  return stats;
+}
+
+std::chrono::steady_clock::time_point
+OpenrEventBase::startTask(const std::string& tag) {
+  const auto startTime = std::chrono::steady_clock::now();
+  *runningTask_.wlock() = RunningTask{tag, startTime};
+  return startTime;
+}
+
+void
+OpenrEventBase::recordTaskDuration(
+    const std::string& tag, std::chrono::steady_clock::time_point startTime) {
+  runningTask_.wlock()->reset();
+  const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - startTime);
+  auto& longest = longestTasks_[tag];
+  longest = std::max(longest, duration);
+}
+
+#if FOLLY_HAS_COROUTINES
+void
+OpenrEventBase::addCoroTask(folly::coro::Task<void>&& task) {
+  coroTaskFutures_.emplace_back(
+      folly::coro::co_withCancellation(
+          cancellationSource_.getToken(), std::move(task))
+          .scheduleOn(folly::getKeepAliveToken(&evb_))
+          .start());
+}
+#endif
+
 void
 OpenrEventBase::stop() {
   for (auto& future : fiberTaskFutures_) {
     future.wait();
   }
+#if FOLLY_HAS_COROUTINES
+  cancellationSource_.requestCancellation();
+  for (auto& future : coroTaskFutures_) {
+    future.wait();
+  }
+#endif
   evb_.terminateLoopSoon();
 }
 
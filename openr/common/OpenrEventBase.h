@@ -7,13 +7,28 @@
 
 #pragma once
 
+#include <pthread.h>
+#include <atomic>
+#include <chrono>
 #include <csignal>
+#include <optional>
+#include <unordered_map>
 
 #include <fbzmq/async/ZmqEventLoop.h>
 #include <fbzmq/zmq/Socket.h>
+#include <folly/fibers/Baton.h>
 #include <folly/fibers/FiberManager.h>
 #include <folly/io/async/AsyncSignalHandler.h>
+#include <folly/Synchronized.h>
 #include <folly/io/async/EventHandler.h>
+#include <folly/logging/xlog.h>
+#if FOLLY_HAS_COROUTINES
+#include <folly/CancellationToken.h>
+#include <folly/experimental/coro/Task.h>
+#endif
+
+#include <openr/common/LatencyHistogram.h>
+#include <openr/messaging/Queue.h>
 
 namespace openr {
 
@@ -27,8 +42,37 @@ class EventBaseStopSignalHandler : public folly::AsyncSignalHandler {
   void signalReceived(int signum) noexcept override;
 };
 
+/**
+ * Load of an OpenrEventBase, see OpenrEventBase::getStats()
+ */
+struct EventBaseStats {
+  // How late heartbeat timer fires, over the last minutes
+  std::chrono::microseconds loopLagP50{0};
+  std::chrono::microseconds loopLagP99{0};
+  std::chrono::microseconds loopLagMax{0};
+
+  // Share of loop time spent running callbacks and tasks, rather than
+  // waiting for events, in percent
+  double busyPct{0};
+
+  // Longest run of every tagged task, e.g. queue reader callbacks
+  std::unordered_map<std::string, std::chrono::microseconds> longestTasks;
+};
+
+/**
+ * Tagged task being run by an OpenrEventBase, see
+ * OpenrEventBase::getRunningTask()
+ */
+struct RunningTask {
+  std::string tag;
+  std::chrono::steady_clock::time_point startTime;
+};
+
 class OpenrEventBase {
  public:
+  // Interval of heartbeat timer, which also probes loop lag
+  static constexpr std::chrono::milliseconds kHeartbeatInterval{100};
+
   OpenrEventBase();
 
   virtual ~OpenrEventBase();
@@ -62,6 +106,92 @@ class OpenrEventBase {
     return fiberManager_.addTaskFuture(std::move(func));
   }
 
+#if FOLLY_HAS_COROUTINES
+  /**
+   * Add a coroutine task, run on underlying event-base with the cancellation
+   * token of this event-base. Unlike fiber tasks, it doesn't own a stack. All
+   * tasks are cancelled and awaited in `stop()`.
+   */
+  void addCoroTask(folly::coro::Task<void>&& task);
+
+  /**
+   * Cancellation token passed to coroutine tasks, cancelled in `stop()`
+   */
+  folly::CancellationToken
+  getCancellationToken() const {
+    return cancellationSource_.getToken();
+  }
+#endif
+
+  /**
+   * Add a task reading batches of up to `maxItems` data elements from `queue`
+   * and handing them to `callback` on event-base thread, until queue is
+   * closed. If `startBaton` is set, reading starts once it's posted.
+   *
+   * Runs as coroutine task when coroutines are available, else as fiber task.
+   * Hence `callback` MUST NOT wait on fiber primitives, e.g. fiber aware
+   * semaphores or synchronous thrift calls; use addFiberTask() for those.
+   */
+  template <typename ValueType, typename F>
+  void
+  addQueueReaderTask(
+      std::string name,
+      messaging::RQueue<ValueType> queue,
+      size_t maxItems,
+      F&& callback,
+      folly::fibers::Baton* startBaton = nullptr) {
+#if FOLLY_HAS_COROUTINES
+    addCoroTask(readQueueCoro(
+        std::move(name),
+        std::move(queue),
+        maxItems,
+        std::forward<F>(callback),
+        startBaton));
+#else
+    addQueueReaderFiberTask(
+        std::move(name),
+        std::move(queue),
+        maxItems,
+        std::forward<F>(callback),
+        startBaton);
+#endif
+  }
+
+  /**
+   * Fiber flavor of addQueueReaderTask(), regardless of coroutine support
+   */
+  template <typename ValueType, typename F>
+  void
+  addQueueReaderFiberTask(
+      std::string name,
+      messaging::RQueue<ValueType> queue,
+      size_t maxItems,
+      F&& callback,
+      folly::fibers::Baton* startBaton = nullptr) {
+    addFiberTask([this,
+                  name = std::move(name),
+                  queue = std::move(queue),
+                  maxItems,
+                  callback = std::forward<F>(callback),
+                  startBaton]() mutable noexcept {
+      if (startBaton) {
+        startBaton->wait();
+      }
+      XLOG(INFO) << "Starting " << name << " processing fiber";
+      while (true) {
+        auto maybeBatch = queue.getBatch(maxItems);
+        if (maybeBatch.hasError()) {
+          break;
+        }
+        // NOTE: duration includes time the fiber is suspended in callback
+        const auto startTime = startTask(name);
+        callback(std::move(maybeBatch).value());
+        recordTaskDuration(name, startTime);
+      }
+      XLOG(INFO) << "Terminating " << name << " processing fiber";
+    });
+  }
+
   /**
    * EventBase API aliases
    */
@@ -70,6 +200,40 @@ class OpenrEventBase {
     evb_.runInEventBaseThread(std::move(callback));
   }
 
+  /**
+   * Loop instrumentation APIs, cheap enough to be always on. MUST be called
+   * from event-base thread.
+   */
+
+  // Stats since previous call. Busy time and longest tasks are reset.
+  EventBaseStats getStats();
+
+  // Mark task identified by `tag` as running, return its start time
+  std::chrono::steady_clock::time_point startTask(const std::string& tag);
+
+  // Record run of task identified by `tag`, started at `startTime`
+  void recordTaskDuration(
+      const std::string& tag, std::chrono::steady_clock::time_point startTime);
+
+  /**
+   * [Stall Detection] Thread-safe, e.g. for Watchdog to attribute stalls
+   */
+
+  // Tagged task being run, between startTask() and recordTaskDuration()
+  std::optional<RunningTask>
+  getRunningTask() const {
+    return *runningTask_.rlock();
+  }
+
+  // Thread running the loop, unset until heartbeat timer first fires
+  std::optional<pthread_t>
+  getThread() const noexcept {
+    if (not hasThread_.load()) {
+      return std::nullopt;
+    }
+    return thread_.load();
+  }
+
   /**
    * Get latest timestamp of health check timer
    */
@@ -161,6 +325,45 @@ class OpenrEventBase {
     std::unique_ptr<folly::AsyncTimeout> timeout_;
   };
 
+#if FOLLY_HAS_COROUTINES
+  /**
+   * Coroutine behind addQueueReaderTask(). Arguments are taken by value to
+   * live in coroutine frame. Cancellation is checked between batches.
+   */
+  template <typename ValueType, typename F>
+  folly::coro::Task<void>
+  readQueueCoro(
+      std::string name,
+      messaging::RQueue<ValueType> queue,
+      size_t maxItems,
+      F callback,
+      folly::fibers::Baton* startBaton) {
+    if (startBaton) {
+      co_await *startBaton;
+    }
+    XLOG(INFO) << "Starting " << name << " processing coroutine";
+    const auto& token = co_await folly::coro::co_current_cancellation_token;
+    while (not token.isCancellationRequested()) {
+      auto maybeBatch = co_await queue.getBatchCoro(maxItems);
+      if (maybeBatch.hasError()) {
+        break;
+      }
+      const auto startTime = startTask(name);
+      invokeNoexcept(callback, std::move(maybeBatch).value());
+      recordTaskDuration(name, startTime);
+    }
+    XLOG(INFO) << "Terminating " << name << " processing coroutine";
+  }
+
+  // Exception escaping callback is fatal, as in noexcept fiber tasks, rather
+  // than silently terminating the coroutine
+  template <typename F, typename Batch>
+  static void
+  invokeNoexcept(F& callback, Batch&& batch) noexcept {
+    callback(std::forward<Batch>(batch));
+  }
+#endif
+
   // EventBase object for async event polling/scheduling
   folly::EventBase evb_;
 
@@ -168,6 +371,12 @@ class OpenrEventBase {
   folly::fibers::FiberManager& fiberManager_;
   std::vector<folly::Future<folly::Unit>> fiberTaskFutures_;
 
+#if FOLLY_HAS_COROUTINES
+  // Coroutine tasks scheduled on evb_, and their cancellation
+  folly::CancellationSource cancellationSource_;
+  std::vector<folly::SemiFuture<folly::Unit>> coroTaskFutures_;
+#endif
+
   // Data structure to hold fd and their handlers
   std::unordered_map<int /* fd */, ZmqEventHandler> fdHandlers_;
 
@@ -175,6 +384,38 @@ class OpenrEventBase {
   std::atomic<std::chrono::steady_clock::duration::rep> timestamp_;
   std::unique_ptr<folly::AsyncTimeout> timeout_;
 
+  // Samples busy and idle time of every loop of evb_
+  class LoopObserver : public folly::EventBaseObserver {
+   public:
+    uint32_t
+    getSampleRate() const override {
+      return 1;
+    }
+
+    void
+    loopSample(int64_t busyTimeUs, int64_t idleTimeUs) override {
+      busyTimeUs_ += busyTimeUs;
+      idleTimeUs_ += idleTimeUs;
+    }
+
+    int64_t busyTimeUs_{0};
+    int64_t idleTimeUs_{0};
+  };
+  std::shared_ptr<LoopObserver> loopObserver_;
+
+  // Lag of heartbeat timer, and when it is expected to fire next. Unset until
+  // event-base runs.
+  LatencyHistogram loopLag_;
+  std::optional<std::chrono::steady_clock::time_point> nextHeartbeat_;
+
+  // Longest run of tagged tasks since previous stats
+  std::unordered_map<std::string, std::chrono::microseconds> longestTasks_;
+
+  // Tagged task being run, and thread running the loop
+  folly::Synchronized<std::optional<RunningTask>> runningTask_;
+  std::atomic<pthread_t> thread_{};
+  std::atomic<bool> hasThread_{false};
+
   // Unique name to identify eventbase
   std::string evbName_;
 };
@@ -5,7 +5,11 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <array>
+
 #include <folly/logging/xlog.h>
+#include <thrift/lib/cpp/TProcessor.h>
+#include <thrift/lib/cpp/concurrency/PriorityThreadManager.h>
 
 #include <openr/common/OpenrThriftCtrlServer.h>
 
@@ -22,6 +26,11 @@ OpenrThriftCtrlServer::start() {
   // Please add your own implementation if you want to start the non default
   // thrift server.
   // Here we will only start the default one.
+  //
+  // [Ctrl Stats] Instrument every method of every ctrl server. Event handler
+  // has to be registered before processors are created by the servers.
+  apache::thrift::TProcessorBase::addProcessorEventHandler(
+      ctrlHandler_->getApiStatsCollector());
   startDefaultThriftServer();
 }
 
@@ -38,6 +47,8 @@ OpenrThriftCtrlServer::stop() {
   for (auto& server : thriftCtrlServerVec_) {
     server.reset();
   }
+  apache::thrift::TProcessorBase::removeProcessorEventHandler(
+      ctrlHandler_->getApiStatsCollector());
 }
 
 void
@@ -69,10 +80,24 @@ OpenrThriftCtrlServer::setUpThriftServer() {
   CHECK(ctrlHandler_);
   auto server = std::make_unique<apache::thrift::ThriftServer>();
   server->setInterface(ctrlHandler_);
-  server->setNumIOWorkerThreads(1);
-  // Intentionally kept this as (1). If you're changing to higher number please
-  // address thread safety for private member variables in OpenrCtrlHandler
-  server->setNumCPUWorkerThreads(1);
+  const auto& thriftServerConfig = config_->getThriftServerConfig();
+  server->setNumIOWorkerThreads(
+      *thriftServerConfig.num_io_worker_threads_ref());
+  // Requests of KvStore peers are sent in HIGH priority, every priority is
+  // served by its own threads. Handler state is synchronized, so requests
+  // can be served concurrently.
+  std::array<size_t, apache::thrift::concurrency::N_PRIORITIES> numThreads;
+  numThreads.fill(1);
+  numThreads.at(apache::thrift::concurrency::HIGH) =
+      *thriftServerConfig.num_peer_sync_threads_ref();
+  numThreads.at(apache::thrift::concurrency::NORMAL) =
+      *thriftServerConfig.num_ctrl_threads_ref();
+  auto threadManager =
+      apache::thrift::concurrency::PriorityThreadManager::
+          newPriorityThreadManager(numThreads);
+  threadManager->setNamePrefix("OpenrCtrl");
+  threadManager->start();
+  server->setThreadManager(threadManager);
   // Enable TOS reflection on the server socket
   server->setTosReflect(true);
   // Set the port and interface for OpenrCtrl thrift server
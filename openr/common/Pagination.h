@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <exception>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include <openr/if/gen-cpp2/OpenrCtrl_types.h>
+
+namespace openr {
+
+/**
+ * [Paginated Dump] helper, see thrift::PageParams.
+ *
+ * Range of `sortedKeys` making up the page requested by `pageParams`, i.e. at
+ * most `pageSize` (at least one) keys after the key of the continuation
+ * token, decoded with `parseToken`. Throws thrift::OpenrError if token can't
+ * be decoded.
+ */
+template <typename Key, typename ParseToken>
+std::pair<
+    typename std::vector<Key>::const_iterator,
+    typename std::vector<Key>::const_iterator>
+getPageRange(
+    const std::vector<Key>& sortedKeys,
+    const thrift::PageParams& pageParams,
+    ParseToken&& parseToken) {
+  auto begin = sortedKeys.cbegin();
+  if (auto token = pageParams.continuationToken_ref()) {
+    std::optional<Key> cursor;
+    try {
+      cursor = parseToken(*token);
+    } catch (std::exception const&) {
+      // reported below
+    }
+    if (not cursor.has_value()) {
+      thrift::OpenrError error;
+      error.message_ref() = fmt::format("Invalid continuation token {}", *token);
+      throw error;
+    }
+    begin = std::upper_bound(sortedKeys.cbegin(), sortedKeys.cend(), *cursor);
+  }
+  const size_t pageSize = std::max(1, *pageParams.pageSize_ref());
+  const auto end = begin +
+      std::min<size_t>(pageSize, std::distance(begin, sortedKeys.cend()));
+  return {begin, end};
+}
+
+} // namespace openr
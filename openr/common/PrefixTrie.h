@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <folly/IPAddress.h>
+
+namespace openr {
+
+/**
+ * Map of IP prefixes to values, organized as binary radix trie per address
+ * family.
+ *
+ * Lookup of prefixes covering an address walks a single path of the trie, in
+ * O(address length) irrespective of the number of prefixes stored.
+ */
+template <typename Value>
+class PrefixTrie {
+ public:
+  /**
+   * Insert or replace value of prefix. Returns true if prefix is new.
+   */
+  bool
+  insert(const folly::CIDRNetwork& prefix, Value value) {
+    Node* node = getRoot(prefix.first);
+    for (uint8_t bit = 0; bit < prefix.second; ++bit) {
+      auto& child = node->children[prefix.first.getNthMSBit(bit)];
+      if (not child) {
+        child = std::make_unique<Node>();
+      }
+      node = child.get();
+    }
+    const bool inserted = not node->entry.has_value();
+    node->entry.emplace(prefix, std::move(value));
+    size_ += inserted ? 1 : 0;
+    return inserted;
+  }
+
+  /**
+   * Erase prefix along with trie nodes not leading to any other prefix.
+   * Returns true if prefix existed.
+   */
+  bool
+  erase(const folly::CIDRNetwork& prefix) {
+    std::vector<Node*> path{getRoot(prefix.first)};
+    for (uint8_t bit = 0; bit < prefix.second; ++bit) {
+      auto& child = path.back()->children[prefix.first.getNthMSBit(bit)];
+      if (not child) {
+        return false;
+      }
+      path.emplace_back(child.get());
+    }
+    if (not path.back()->entry.has_value()) {
+      return false;
+    }
+    path.back()->entry.reset();
+    --size_;
+
+    // prune empty leaves bottom up, root stays
+    for (uint8_t bit = prefix.second; bit > 0; --bit) {
+      Node* node = path[bit];
+      if (node->entry.has_value() or node->children[0] or node->children[1]) {
+        break;
+      }
+      path[bit - 1]->children[prefix.first.getNthMSBit(bit - 1)].reset();
+    }
+    return true;
+  }
+
+  /**
+   * Value of exact prefix, nullptr if it's not present.
+   */
+  Value*
+  find(const folly::CIDRNetwork& prefix) {
+    Node* node = getRoot(prefix.first);
+    for (uint8_t bit = 0; node and bit < prefix.second; ++bit) {
+      node = node->children[prefix.first.getNthMSBit(bit)].get();
+    }
+    return (node and node->entry.has_value()) ? &node->entry->second : nullptr;
+  }
+
+  /**
+   * All entries whose prefix contains `addr`, ordered from shortest to
+   * longest prefix.
+   */
+  std::vector<std::pair<folly::CIDRNetwork, Value>*>
+  findCovering(const folly::IPAddress& addr) {
+    std::vector<std::pair<folly::CIDRNetwork, Value>*> entries;
+    Node* node = getRoot(addr);
+    for (size_t bit = 0; node; ++bit) {
+      if (node->entry.has_value()) {
+        entries.emplace_back(&node->entry.value());
+      }
+      if (bit == addr.bitCount()) {
+        break;
+      }
+      node = node->children[addr.getNthMSBit(bit)].get();
+    }
+    return entries;
+  }
+
+  /**
+   * Entry of the longest prefix containing `prefix`, e.g. route forwarding an
+   * address given as host prefix. nullptr if none. Walks a single path of
+   * the trie without allocating.
+   */
+  const std::pair<folly::CIDRNetwork, Value>*
+  findLongest(const folly::CIDRNetwork& prefix) const {
+    const std::pair<folly::CIDRNetwork, Value>* longest{nullptr};
+    const Node* node = getRoot(prefix.first);
+    for (uint8_t bit = 0; node; ++bit) {
+      if (node->entry.has_value()) {
+        longest = &node->entry.value();
+      }
+      if (bit == prefix.second) {
+        break;
+      }
+      node = node->children[prefix.first.getNthMSBit(bit)].get();
+    }
+    return longest;
+  }
+
+  size_t
+  size() const {
+    return size_;
+  }
+
+  bool
+  empty() const {
+    return size_ == 0;
+  }
+
+  void
+  clear() {
+    v4Root_ = Node();
+    v6Root_ = Node();
+    size_ = 0;
+  }
+
+ private:
+  struct Node {
+    std::array<std::unique_ptr<Node>, 2> children;
+    std::optional<std::pair<folly::CIDRNetwork, Value>> entry;
+  };
+
+  Node*
+  getRoot(const folly::IPAddress& addr) {
+    return addr.isV4() ? &v4Root_ : &v6Root_;
+  }
+
+  const Node*
+  getRoot(const folly::IPAddress& addr) const {
+    return addr.isV4() ? &v4Root_ : &v6Root_;
+  }
+
+  Node v4Root_;
+  Node v6Root_;
+  size_t size_{0};
+};
+
+} // namespace openr
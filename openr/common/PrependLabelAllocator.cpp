@@ -5,12 +5,23 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <fb303/ServiceData.h>
+#include <folly/hash/Hash.h>
 #include <folly/logging/xlog.h>
 #include <openr/common/LsdbTypes.h>
 #include <openr/common/PrependLabelAllocator.h>
 
+namespace fb303 = facebook::fb303;
+
 namespace openr {
 
+size_t
+PrependLabelAllocator::NextHopSetHash::operator()(
+    const std::set<folly::IPAddress>& nextHopSet) const {
+  return folly::hash::hash_range(
+      nextHopSet.begin(), nextHopSet.end(), 0, std::hash<folly::IPAddress>());
+}
+
 PrependLabelAllocator::PrependLabelAllocator(
     std::shared_ptr<const Config> config) {
   if (config->isSegmentRoutingEnabled() &&
@@ -28,30 +39,30 @@ PrependLabelAllocator::PrependLabelAllocator(
   }
 }
 
-int32_t
+std::optional<int32_t>
 PrependLabelAllocator::getNewMplsLabel(bool isV4) {
+  auto& freedMplsLabels = isV4 ? freedMplsLabelsV4_ : freedMplsLabelsV6_;
+  auto& nextMplsLabel = isV4 ? nextMplsLabelV4_ : nextMplsLabelV6_;
+  const auto& labelRange = isV4 ? labelRangeV4_ : labelRangeV6_;
+
   // Return label from free range if any available
-  if (isV4) {
-    if (freedMplsLabelsV4_.size()) {
-      int32_t ret = freedMplsLabelsV4_.back();
-      freedMplsLabelsV4_.pop_back();
-      return ret;
-    }
-    // Return next label from the v4 range
-    CHECK_LE(nextMplsLabelV4_, labelRangeV4_.second)
-        << "V4: Exhausted static MPLS range";
-    return nextMplsLabelV4_++;
-  } else {
-    if (freedMplsLabelsV6_.size()) {
-      int32_t ret = freedMplsLabelsV6_.back();
-      freedMplsLabelsV6_.pop_back();
-      return ret;
-    }
-    // Return next label from the v6 range
-    CHECK_LE(nextMplsLabelV6_, labelRangeV6_.second)
-        << "V6: Exhausted static MPLS range";
-    return nextMplsLabelV6_++;
+  if (freedMplsLabels.size()) {
+    int32_t ret = freedMplsLabels.back();
+    freedMplsLabels.pop_back();
+    return ret;
   }
+  // Return next label from the range
+  if (nextMplsLabel > labelRange.second) {
+    XLOG(ERR) << fmt::format(
+        "V{}: Exhausted prepend label range [{}, {}]",
+        isV4 ? 4 : 6,
+        labelRange.first,
+        labelRange.second);
+    fb303::fbData->addStatValue(
+        "prepend_label_allocator.exhausted", 1, fb303::COUNT);
+    return std::nullopt;
+  }
+  return nextMplsLabel++;
 }
 
 void
@@ -87,7 +98,10 @@ PrependLabelAllocator::decrementRefCount(
     refCount--;
     CHECK_GE(refCount, 0) << "Reference count can never be negative";
     if (refCount == 0) {
-      oldLabel = label;
+      // ATTN: label is 0 if it was never assigned due to range exhaustion
+      if (label != 0) {
+        oldLabel = label;
+      }
       CHECK_GT(nextHopSet.size(), 0) << "Nexthop set must have a valid entry";
       const auto& nh = *nextHopSet.begin();
       nextHopSetToLabel_.erase(nextHopSet);
@@ -116,7 +130,11 @@ PrependLabelAllocator::incrementRefCount(
       CHECK_GT(nextHopSet.size(), 0) << "Nexthop set must have a valid entry";
       const auto& nh = *nextHopSet.begin();
       // Create a new label
-      label = getNewMplsLabel(nh.isV4());
+      auto newLabel = getNewMplsLabel(nh.isV4());
+      if (not newLabel) {
+        return std::make_pair(std::nullopt, false);
+      }
+      label = *newLabel;
       XLOG(DBG1) << "Allocating label " << label
                  << " for nexthop set consisting of";
       for (auto const& nhEntry : nextHopSet) {
@@ -7,6 +7,13 @@
 
 #pragma once
 
+#include <optional>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include <folly/IPAddress.h>
+
 #include <openr/common/MplsUtil.h>
 #include <openr/common/Util.h>
 #include <openr/config/Config.h>
@@ -21,6 +28,10 @@ namespace openr {
 // different areas or openr domains. While a prepend label is advertised
 // to remote nodes/areas, a corresponding MPLS label route can be programmed
 // in local nodes.
+//
+// Nexthop sets are looked up by hash of their canonical (ordered) content and
+// freed labels are kept in a LIFO free-list, so that both allocation and
+// release are O(1) and a released label is the first one to be reused.
 class PrependLabelAllocator {
  public:
   explicit PrependLabelAllocator(std::shared_ptr<const Config> config);
@@ -43,6 +54,10 @@ class PrependLabelAllocator {
    *
    * Returned result is a tuple of label value and a boolean flag indicating if
    * the label is newly allocated.
+   *
+   * If the label range of the address family is exhausted, no label is
+   * returned. Nexthop set is still reference counted, and allocation is
+   * retried upon its next increment, i.e. once other sets released labels.
    */
   std::pair<std::optional<int32_t>, bool> incrementRefCount(
       const std::set<folly::IPAddress>& nextHopSet);
@@ -51,9 +66,9 @@ class PrependLabelAllocator {
   /**
    * Return an available mpls label from previously freed labels from previous
    * iteration or allocation. Otherwise, generate next label next from the range
-   * and allocate.
+   * and allocate. Return std::nullopt if range is exhausted.
    */
-  int32_t getNewMplsLabel(bool isV4);
+  std::optional<int32_t> getNewMplsLabel(bool isV4);
 
   /**
    * Free previously allocated label considering the address family (ipv4 or
@@ -66,10 +81,19 @@ class PrependLabelAllocator {
    */
   const std::pair<int32_t, int32_t> getPrependLabelRange(bool isV4);
 
+  // Fingerprint of nexthop set, std::set iterates in canonical order
+  struct NextHopSetHash {
+    size_t operator()(const std::set<folly::IPAddress>& nextHopSet) const;
+  };
+
   /**
-   * NextHopSet -> [RefCount, Label] mapping.
+   * NextHopSet -> [RefCount, Label] mapping. Label is 0 while no label could
+   * be assigned because of range exhaustion.
    */
-  std::map<std::set<folly::IPAddress>, std::pair<int32_t, int32_t>>
+  std::unordered_map<
+      std::set<folly::IPAddress>,
+      std::pair<int32_t, int32_t>,
+      NextHopSetHash>
       nextHopSetToLabel_;
 
   /*
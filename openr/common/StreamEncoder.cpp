@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <fmt/format.h>
+#include <folly/Range.h>
+
+#include <openr/common/Constants.h>
+#include <openr/common/StreamEncoder.h>
+
+namespace openr {
+
+namespace {
+
+std::unique_ptr<folly::io::StreamCodec>
+createCodec(thrift::StreamCompression compression) {
+  switch (compression) {
+  case thrift::StreamCompression::NONE:
+    return nullptr;
+  case thrift::StreamCompression::ZSTD:
+    if (not folly::io::hasStreamCodec(folly::io::CodecType::ZSTD)) {
+      throw std::invalid_argument("zstd stream compression is not available");
+    }
+    return folly::io::getStreamCodec(folly::io::CodecType::ZSTD);
+  }
+  throw std::invalid_argument(fmt::format(
+      "Unknown stream compression {}", static_cast<int>(compression)));
+}
+
+// Apply `fn` on next-hops of routes to update of `deltas`, unicast routes
+// first, then MPLS ones
+template <typename Fn>
+void
+forEachNextHops(std::vector<thrift::RouteDatabaseDeltaDetail>& deltas, Fn fn) {
+  for (auto& delta : deltas) {
+    for (auto& route : *delta.unicastRoutesToUpdate_ref()) {
+      fn(*route.unicastRoute_ref()->nextHops_ref());
+    }
+    for (auto& route : *delta.mplsRoutesToUpdate_ref()) {
+      fn(*route.mplsRoute_ref()->nextHops_ref());
+    }
+  }
+}
+
+} // namespace
+
+StreamEncoder::StreamEncoder(thrift::StreamEncodingParams params)
+    : params_(std::move(params)),
+      codec_(createCodec(*params_.compression_ref())) {
+  if (codec_) {
+    codec_->resetStream();
+  }
+}
+
+thrift::EncodedStreamMessage
+StreamEncoder::encodeSerialized(std::string serialized) {
+  thrift::EncodedStreamMessage message;
+  message.seqNum_ref() = seqNum_++;
+  message.compression_ref() = *params_.compression_ref();
+  message.uncompressedSize_ref() = serialized.size();
+  if (not codec_) {
+    message.data_ref() = std::move(serialized);
+    return message;
+  }
+
+  // Flush at end of every message, so it can be decompressed as soon as it
+  // is received. Compression state carries over to the next message.
+  std::string compressed;
+  folly::ByteRange input(folly::StringPiece(serialized));
+  const size_t chunkSize =
+      std::max<uint64_t>(codec_->maxCompressedLength(input.size()), 64);
+  bool flushed{false};
+  while (not flushed) {
+    const size_t offset = compressed.size();
+    compressed.resize(offset + chunkSize);
+    folly::MutableByteRange output(
+        reinterpret_cast<uint8_t*>(compressed.data()) + offset, chunkSize);
+    flushed = codec_->compressStream(
+        input, output, folly::io::StreamCodec::FlushOp::FLUSH);
+    compressed.resize(compressed.size() - output.size());
+  }
+  message.data_ref() = std::move(compressed);
+  return message;
+}
+
+thrift::FibDetailStreamBatch
+StreamEncoder::makeFibBatch(
+    std::vector<thrift::RouteDatabaseDeltaDetail> deltas) {
+  thrift::FibDetailStreamBatch batch;
+  if (*params_.internNextHops_ref()) {
+    if (nextHopGroupIds_.size() >= Constants::kStreamMaxNextHopGroups) {
+      nextHopGroupIds_.clear();
+      batch.resetNextHopGroups_ref() = true;
+    }
+    forEachNextHops(deltas, [&](auto& nextHops) {
+      internNextHops(nextHops, batch);
+    });
+  }
+  batch.deltas_ref() = std::move(deltas);
+  return batch;
+}
+
+void
+StreamEncoder::internNextHops(
+    std::vector<thrift::NextHopThrift>& nextHops,
+    thrift::FibDetailStreamBatch& batch) {
+  // serialized next-hops are self-delimiting, concatenation is unambiguous
+  std::string key;
+  for (const auto& nextHop : nextHops) {
+    key.append(
+        apache::thrift::CompactSerializer::serialize<std::string>(nextHop));
+  }
+  auto [it, inserted] = nextHopGroupIds_.emplace(key, nextHopGroupId_);
+  if (inserted) {
+    ++nextHopGroupId_;
+    batch.newNextHopGroups_ref()->emplace(it->second, std::move(nextHops));
+  }
+  batch.nextHopGroupIds_ref()->emplace_back(it->second);
+  nextHops.clear();
+}
+
+std::string
+StreamDecoder::decodeSerialized(const thrift::EncodedStreamMessage& message) {
+  if (*message.seqNum_ref() != expectedSeqNum_) {
+    throw std::runtime_error(fmt::format(
+        "Unexpected message {}, expecting {}",
+        *message.seqNum_ref(),
+        expectedSeqNum_));
+  }
+  ++expectedSeqNum_;
+
+  const auto& data = *message.data_ref();
+  if (*message.compression_ref() == thrift::StreamCompression::NONE) {
+    return data;
+  }
+  if (not codec_) {
+    codec_ = createCodec(*message.compression_ref());
+    codec_->resetStream();
+  }
+
+  std::string serialized(*message.uncompressedSize_ref(), '\0');
+  folly::ByteRange input(folly::StringPiece(data));
+  folly::MutableByteRange output(
+      reinterpret_cast<uint8_t*>(serialized.data()), serialized.size());
+  while (not input.empty() or not output.empty()) {
+    const auto inputSize = input.size();
+    const auto outputSize = output.size();
+    codec_->uncompressStream(
+        input, output, folly::io::StreamCodec::FlushOp::FLUSH);
+    if (input.size() == inputSize and output.size() == outputSize) {
+      throw std::runtime_error(fmt::format(
+          "Malformed message {}, {} bytes left to decompress",
+          *message.seqNum_ref(),
+          outputSize));
+    }
+  }
+  return serialized;
+}
+
+std::vector<thrift::RouteDatabaseDeltaDetail>
+StreamDecoder::restoreFibBatch(thrift::FibDetailStreamBatch batch) {
+  if (*batch.resetNextHopGroups_ref()) {
+    nextHopGroups_.clear();
+  }
+  for (auto& [id, nextHops] : *batch.newNextHopGroups_ref()) {
+    nextHopGroups_[id] = std::move(nextHops);
+  }
+
+  auto& deltas = *batch.deltas_ref();
+  const auto& groupIds = *batch.nextHopGroupIds_ref();
+  if (groupIds.empty()) {
+    // next-hops not interned
+    return std::move(deltas);
+  }
+  size_t index{0};
+  forEachNextHops(deltas, [&](auto& nextHops) {
+    if (index >= groupIds.size()) {
+      throw std::runtime_error("Missing next-hop group ids");
+    }
+    const auto groupId = groupIds.at(index++);
+    auto it = nextHopGroups_.find(groupId);
+    if (it == nextHopGroups_.end()) {
+      throw std::runtime_error(
+          fmt::format("Unknown next-hop group {}", groupId));
+    }
+    nextHops = it->second;
+  });
+  if (index != groupIds.size()) {
+    throw std::runtime_error("Unexpected next-hop group ids");
+  }
+  return std::move(deltas);
+}
+
+} // namespace openr
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <folly/compression/Compression.h>
+#include <thrift/lib/cpp2/protocol/Serializer.h>
+
+#include <openr/if/gen-cpp2/OpenrCtrl_types.h>
+
+namespace openr {
+
+/**
+ * [Encoded Stream] Server side encoder of a single stream, see
+ * thrift::StreamEncodingParams. Messages must be sent in the order they are
+ * encoded in, as every message depends on the previous ones.
+ *
+ * NOTE: Not thread-safe
+ */
+class StreamEncoder {
+ public:
+  // Throws std::invalid_argument if compression isn't available
+  explicit StreamEncoder(thrift::StreamEncodingParams params);
+
+  // Encode `payload` as the next message of the stream
+  template <typename T>
+  thrift::EncodedStreamMessage
+  encode(const T& payload) {
+    return encodeSerialized(
+        apache::thrift::CompactSerializer::serialize<std::string>(payload));
+  }
+
+  /**
+   * Merge `deltas` into a batch, with next-hops of routes interned if
+   * enabled. Interned groups are bounded by kStreamMaxNextHopGroups, they are
+   * reset by the first batch past it.
+   */
+  thrift::FibDetailStreamBatch makeFibBatch(
+      std::vector<thrift::RouteDatabaseDeltaDetail> deltas);
+
+  const thrift::StreamEncodingParams&
+  getParams() const {
+    return params_;
+  }
+
+  size_t
+  getNumNextHopGroups() const {
+    return nextHopGroupIds_.size();
+  }
+
+ private:
+  thrift::EncodedStreamMessage encodeSerialized(std::string serialized);
+
+  // Replace `nextHops` with id of their group, added to `batch` if new
+  void internNextHops(
+      std::vector<thrift::NextHopThrift>& nextHops,
+      thrift::FibDetailStreamBatch& batch);
+
+  const thrift::StreamEncodingParams params_;
+
+  // zstd stream shared by all messages, nullptr if uncompressed
+  std::unique_ptr<folly::io::StreamCodec> codec_;
+
+  int64_t seqNum_{0};
+
+  // Interned next-hop groups, keyed by serialized next-hops
+  std::unordered_map<std::string, int64_t> nextHopGroupIds_;
+  int64_t nextHopGroupId_{0};
+};
+
+/**
+ * [Encoded Stream] Client side decoder of a single stream. Messages must be
+ * decoded in stream order. Throws std::runtime_error on messages out of order
+ * or malformed.
+ *
+ * NOTE: Not thread-safe
+ */
+class StreamDecoder {
+ public:
+  // Decode payload of the next message of the stream
+  template <typename T>
+  T
+  decode(const thrift::EncodedStreamMessage& message) {
+    return apache::thrift::CompactSerializer::deserialize<T>(
+        decodeSerialized(message));
+  }
+
+  /**
+   * Deltas of a decoded Fib batch, with interned next-hops restored.
+   */
+  std::vector<thrift::RouteDatabaseDeltaDetail> restoreFibBatch(
+      thrift::FibDetailStreamBatch batch);
+
+ private:
+  std::string decodeSerialized(const thrift::EncodedStreamMessage& message);
+
+  // Created along with the first compressed message
+  std::unique_ptr<folly::io::StreamCodec> codec_;
+
+  int64_t expectedSeqNum_{0};
+
+  std::unordered_map<int64_t, std::vector<thrift::NextHopThrift>>
+      nextHopGroups_;
+};
+
+} // namespace openr
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <unordered_set>
+
+#include <folly/Synchronized.h>
+
+#include <openr/common/ThreadLocalStats.h>
+
+namespace fb303 = facebook::fb303;
+
+namespace openr {
+
+namespace {
+
+// Stats of the process, intentionally leaked so that stats with static
+// storage duration can unregister in any order on exit
+folly::Synchronized<std::unordered_set<ThreadLocalStat*>>&
+getRegistry() {
+  static auto* registry =
+      new folly::Synchronized<std::unordered_set<ThreadLocalStat*>>();
+  return *registry;
+}
+
+} // namespace
+
+ThreadLocalStat::ThreadLocalStat(std::string key, fb303::ExportType exportType)
+    : key_(std::move(key)),
+      exportType_(exportType),
+      slots_([this]() { return new Slot(this); }) {
+  getRegistry().wlock()->insert(this);
+}
+
+ThreadLocalStat::~ThreadLocalStat() {
+  getRegistry().wlock()->erase(this);
+  flush();
+}
+
+ThreadLocalStat::Slot::~Slot() {
+  stat->exitedSum_.fetch_add(
+      sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+  stat->exitedCount_.fetch_add(
+      count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+void
+ThreadLocalStat::flush() {
+  int64_t sum = exitedSum_.exchange(0, std::memory_order_relaxed);
+  int64_t count = exitedCount_.exchange(0, std::memory_order_relaxed);
+  for (auto& slot : slots_.accessAllThreads()) {
+    sum += slot.sum.exchange(0, std::memory_order_relaxed);
+    count += slot.count.exchange(0, std::memory_order_relaxed);
+  }
+  if (count == 0) {
+    return;
+  }
+
+  // Registered on first use, fb303 may not be ready during static init
+  std::call_once(exportTypeOnce_, [this]() {
+    fb303::fbData->addStatExportType(key_, exportType_);
+  });
+  fb303::fbData->addStatValueAggregated(key_, sum, count);
+}
+
+void
+ThreadLocalStat::flushAll() {
+  auto registry = getRegistry().rlock();
+  for (auto* stat : *registry) {
+    stat->flush();
+  }
+}
+
+} // namespace openr
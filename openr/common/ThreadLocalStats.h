@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include <fb303/ServiceData.h>
+#include <folly/ThreadLocal.h>
+
+namespace openr {
+
+/**
+ * [Thread Local Stats] Pre-registered fb303 stat for hot paths, e.g. per
+ * packet, per netlink message or per route. Unlike
+ * fb303::fbData->addStatValue(), which looks up the stat by name and locks
+ * it on every call, add() only bumps a slot local to the calling thread.
+ * Slots are aggregated into the fb303 stat of the same key and export type on
+ * flush, which happens on export of counters, i.e. ctrl getCounters() and
+ * periodically by Monitor, see flushAll(). Values of exited threads are kept
+ * until the next flush.
+ *
+ * Stats are meant to be long lived, e.g. members of the module using them,
+ * and are flushed once more when destroyed. Several stats may share a key.
+ * Sum and count of one value may land in separate flushes, which is fine for
+ * AVG stats aggregated over time windows.
+ *
+ * NOTE: Thread-safe
+ */
+class ThreadLocalStat {
+ public:
+  ThreadLocalStat(std::string key, facebook::fb303::ExportType exportType);
+  ~ThreadLocalStat();
+
+  // No-copy, registered by address
+  ThreadLocalStat(const ThreadLocalStat&) = delete;
+  ThreadLocalStat& operator=(const ThreadLocalStat&) = delete;
+
+  void
+  add(int64_t value = 1) {
+    auto& slot = *slots_;
+    slot.sum.fetch_add(value, std::memory_order_relaxed);
+    slot.count.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Add values accumulated since last flush to the fb303 stat
+  void flush();
+
+  // Flush all stats of the process
+  static void flushAll();
+
+  const std::string&
+  getKey() const {
+    return key_;
+  }
+
+ private:
+  struct Slot {
+    explicit Slot(ThreadLocalStat* stat) : stat(stat) {}
+    // Keep values of exiting thread for the next flush
+    ~Slot();
+
+    ThreadLocalStat* const stat{nullptr};
+    std::atomic<int64_t> sum{0};
+    std::atomic<int64_t> count{0};
+  };
+
+  const std::string key_;
+  const facebook::fb303::ExportType exportType_;
+  std::once_flag exportTypeOnce_;
+
+  // Values of exited threads, declared before slots_ to outlive them
+  std::atomic<int64_t> exitedSum_{0};
+  std::atomic<int64_t> exitedCount_{0};
+
+  folly::ThreadLocal<Slot, ThreadLocalStat> slots_;
+};
+
+} // namespace openr
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <glog/logging.h>
+
+namespace openr {
+
+/**
+ * Set of keys, each scheduled to expire at a deadline.
+ *
+ * Keys are bucketed into slots of `tick` granularity which are kept ordered by
+ * deadline. Expiring keys touches only the expired slots instead of scanning
+ * all the keys, and the earliest deadline is known in constant time. Deadline
+ * of a key is rounded up to the end of its slot, hence a key never expires
+ * before its deadline.
+ *
+ * A key is scheduled at most once. Re-scheduling moves it to the new slot.
+ */
+template <
+    typename Key,
+    typename Clock = std::chrono::steady_clock,
+    typename Hash = std::hash<Key>>
+class TimerWheel {
+ public:
+  using TimePoint = typename Clock::time_point;
+
+  explicit TimerWheel(
+      std::chrono::milliseconds tick = std::chrono::milliseconds(1))
+      : tick_(std::chrono::duration_cast<typename Clock::duration>(tick)) {
+    CHECK_GT(tick_.count(), 0) << "Tick of timer wheel must be positive";
+  }
+
+  /**
+   * Schedule key to expire at `deadline`. Existing deadline of the key, if
+   * any, is replaced.
+   */
+  void
+  schedule(const Key& key, TimePoint deadline) {
+    const auto slot = toSlot(deadline);
+    auto [it, inserted] = keySlots_.try_emplace(key, slot);
+    if (not inserted) {
+      if (it->second == slot) {
+        return;
+      }
+      eraseFromSlot(key, it->second);
+      it->second = slot;
+    }
+    slots_[slot].emplace(key);
+  }
+
+  /**
+   * Remove scheduled key. Returns number of keys removed.
+   */
+  size_t
+  erase(const Key& key) {
+    auto it = keySlots_.find(key);
+    if (it == keySlots_.end()) {
+      return 0;
+    }
+    eraseFromSlot(key, it->second);
+    keySlots_.erase(it);
+    return 1;
+  }
+
+  size_t
+  count(const Key& key) const {
+    return keySlots_.count(key);
+  }
+
+  size_t
+  size() const {
+    return keySlots_.size();
+  }
+
+  bool
+  empty() const {
+    return keySlots_.empty();
+  }
+
+  void
+  clear() {
+    slots_.clear();
+    keySlots_.clear();
+  }
+
+  /**
+   * Earliest time at which any key expires, std::nullopt if empty
+   */
+  std::optional<TimePoint>
+  nextDeadline() const {
+    if (slots_.empty()) {
+      return std::nullopt;
+    }
+    return slots_.begin()->first;
+  }
+
+  /**
+   * Remove and return all the keys expired at `now`. Order of returned keys
+   * follows their deadlines.
+   */
+  std::vector<Key>
+  popExpired(TimePoint now) {
+    std::vector<Key> expired;
+    auto end = slots_.upper_bound(now);
+    for (auto it = slots_.begin(); it != end; ++it) {
+      for (auto& key : it->second) {
+        keySlots_.erase(key);
+        expired.emplace_back(key);
+      }
+    }
+    slots_.erase(slots_.begin(), end);
+    return expired;
+  }
+
+  /**
+   * Remove and return one of the keys expired at `now` with the earliest
+   * deadline, std::nullopt if none. Unlike `popExpired()`, keys erased while
+   * handling previous ones are never returned.
+   */
+  std::optional<Key>
+  popNextExpired(TimePoint now) {
+    if (slots_.empty() or slots_.begin()->first > now) {
+      return std::nullopt;
+    }
+    auto& keys = slots_.begin()->second;
+    auto key = *keys.begin();
+    keys.erase(keys.begin());
+    if (keys.empty()) {
+      slots_.erase(slots_.begin());
+    }
+    keySlots_.erase(key);
+    return key;
+  }
+
+ private:
+  // Round up deadline to the end of its slot
+  TimePoint
+  toSlot(TimePoint deadline) const {
+    const auto sinceEpoch = deadline.time_since_epoch();
+    auto slot = (sinceEpoch / tick_) * tick_;
+    if (slot < sinceEpoch) {
+      slot += tick_;
+    }
+    return TimePoint(slot);
+  }
+
+  void
+  eraseFromSlot(const Key& key, TimePoint slot) {
+    auto it = slots_.find(slot);
+    CHECK(it != slots_.end());
+    it->second.erase(key);
+    if (it->second.empty()) {
+      slots_.erase(it);
+    }
+  }
+
+  // Slot granularity
+  const typename Clock::duration tick_;
+
+  // Keys of every non-empty slot, ordered by slot deadline
+  std::map<TimePoint, std::unordered_set<Key, Hash>> slots_;
+
+  // Slot of every scheduled key
+  std::unordered_map<Key, TimePoint, Hash> keySlots_;
+};
+
+} // namespace openr
@@ -5,6 +5,8 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
+
 #include <fmt/core.h>
 #include <folly/logging/xlog.h>
 
@@ -13,7 +15,28 @@
 namespace openr {
 
 RegexSet::RegexSet(std::vector<std::string> const& keyPrefixList) {
-  if (keyPrefixList.empty()) {
+  std::vector<std::string> literalPrefixes;
+  std::vector<std::string> regexList;
+  for (auto const& keyPrefix : keyPrefixList) {
+    if (isLiteralPrefix(keyPrefix)) {
+      literalPrefixes.emplace_back(keyPrefix);
+    } else {
+      regexList.emplace_back(keyPrefix);
+    }
+  }
+
+  // After sorting, entries covered by a shorter one directly follow it. Keep
+  // only the covering ones.
+  std::sort(literalPrefixes.begin(), literalPrefixes.end());
+  for (auto& prefix : literalPrefixes) {
+    if (literalPrefixes_.empty() or
+        std::string_view(prefix).substr(0, literalPrefixes_.back().size()) !=
+            literalPrefixes_.back()) {
+      literalPrefixes_.emplace_back(std::move(prefix));
+    }
+  }
+
+  if (regexList.empty()) {
     return;
   }
   re2::RE2::Options re2Options;
@@ -22,7 +45,7 @@ RegexSet::RegexSet(std::vector<std::string> const& keyPrefixList) {
       std::make_unique<re2::RE2::Set>(re2Options, re2::RE2::ANCHOR_START);
   std::string re2AddError{};
 
-  for (auto const& keyPrefix : keyPrefixList) {
+  for (auto const& keyPrefix : regexList) {
     if (regexSet_->Add(keyPrefix, &re2AddError) < 0) {
       XLOG(FATAL) << fmt::format(
           "Failed to add prefixes to RE2 set: '{}', error: '{}'",
@@ -38,9 +61,34 @@ RegexSet::RegexSet(std::vector<std::string> const& keyPrefixList) {
 
 bool
 RegexSet::match(std::string const& key) const {
-  CHECK(regexSet_);
-  std::vector<int> matches;
-  return regexSet_->Match(key, &matches);
+  CHECK(regexSet_ or not literalPrefixes_.empty());
+  if (matchLiteralPrefix(key)) {
+    return true;
+  }
+  // Indices of matching regexes are not needed
+  return regexSet_ and regexSet_->Match(key, nullptr);
+}
+
+bool
+RegexSet::isLiteralPrefix(std::string const& regexOrPrefix) {
+  return regexOrPrefix.find_first_of("\\^$.|?*+()[]{}") == std::string::npos;
+}
+
+bool
+RegexSet::matchLiteralPrefix(std::string_view key) const {
+  // greatest entry not above the key
+  auto it = std::upper_bound(
+      literalPrefixes_.cbegin(),
+      literalPrefixes_.cend(),
+      key,
+      [](std::string_view value, std::string const& prefix) {
+        return value < prefix;
+      });
+  if (it == literalPrefixes_.cbegin()) {
+    return false;
+  }
+  --it;
+  return key.substr(0, it->size()) == *it;
 }
 
 } // namespace openr
@@ -9,9 +9,10 @@
 
 #include <re2/re2.h>
 #include <re2/set.h>
+#include <string_view>
 #include <variant>
+#include <vector>
 
-#include <boost/heap/priority_queue.hpp>
 #include <boost/serialization/strong_typedef.hpp>
 
 #include <openr/common/Constants.h>
@@ -24,25 +25,6 @@ BOOST_STRONG_TYPEDEF(std::string, KvStoreGlobalCmdUrl);
 
 BOOST_STRONG_TYPEDEF(std::string, AreaId);
 
-struct TtlCountdownQueueEntry {
-  std::chrono::steady_clock::time_point expiryTime;
-  std::string key;
-  int64_t version{0};
-  int64_t ttlVersion{0};
-  std::string originatorId;
-
-  bool
-  operator>(TtlCountdownQueueEntry other) const {
-    return expiryTime > other.expiryTime;
-  }
-};
-
-using TtlCountdownQueue = boost::heap::priority_queue<
-    TtlCountdownQueueEntry,
-    // Always returns smallest first
-    boost::heap::compare<std::greater<TtlCountdownQueueEntry>>,
-    boost::heap::stable<true>>;
-
 /**
  * Structure defining KvStore peer update event in one area.
  */
@@ -134,8 +116,11 @@ class SetKeyValueRequest {
 class PersistKeyValueRequest {
  public:
   PersistKeyValueRequest(
-      const AreaId& area, const std::string& key, const std::string& value)
-      : area(area), key(key), value(value) {}
+      const AreaId& area,
+      const std::string& key,
+      const std::string& value,
+      std::vector<int64_t> traceIds = {})
+      : area(area), key(key), value(value), traceIds(std::move(traceIds)) {}
 
   inline AreaId const&
   getArea() const {
@@ -152,6 +137,11 @@ class PersistKeyValueRequest {
     return value;
   }
 
+  inline std::vector<int64_t> const&
+  getTraceIds() const {
+    return traceIds;
+  }
+
  private:
   /**
    * Area identifier. By default key is published to default area kvstore
@@ -166,6 +156,10 @@ class PersistKeyValueRequest {
    * Value to advertise to the consumer.
    */
   std::string value;
+  /**
+   * Convergence trace ids the value originates from, see ConvergenceTracer.
+   */
+  std::vector<int64_t> traceIds;
 };
 
 /**
@@ -225,8 +219,54 @@ class ClearKeyValueRequest {
   bool setValue{false};
 };
 
-using KeyValueRequest = std::
-    variant<SetKeyValueRequest, PersistKeyValueRequest, ClearKeyValueRequest>;
+/**
+ * Batch of key-value requests of one area, e.g. all keys updated by one sync
+ * of PrefixManager. Consumer applies requests in order, all at once instead
+ * of one request per queue read.
+ */
+class BatchKeyValueRequest {
+ public:
+  using Request = std::
+      variant<SetKeyValueRequest, PersistKeyValueRequest, ClearKeyValueRequest>;
+
+  explicit BatchKeyValueRequest(const AreaId& area) : area(area) {}
+
+  void
+  addRequest(Request&& request) {
+    CHECK(
+        std::visit(
+            [](auto&& request) -> AreaId { return request.getArea(); },
+            request) == area)
+        << "Requests of a BatchKeyValueRequest must be of the same area.";
+    requests.emplace_back(std::move(request));
+  }
+
+  inline AreaId const&
+  getArea() const {
+    return area;
+  }
+
+  inline std::vector<Request> const&
+  getRequests() const {
+    return requests;
+  }
+
+ private:
+  /**
+   * Area identifier of all requests.
+   */
+  AreaId area;
+  /**
+   * Requests to be applied in order.
+   */
+  std::vector<Request> requests;
+};
+
+using KeyValueRequest = std::variant<
+    SetKeyValueRequest,
+    PersistKeyValueRequest,
+    ClearKeyValueRequest,
+    BatchKeyValueRequest>;
 
 /**
  * TODO: remove this once openr_intialization is by default enabled
@@ -259,6 +299,13 @@ using KvStorePublication = std::variant<
 /**
  * Provides match capability on list of regexes. Will default to prefix match
  * if regex is normal string.
+ *
+ * [Key Prefix Match] Entries without regex metacharacters, which is the
+ * common case for KvStore key filters e.g. `adj:` or `prefix:`, are kept
+ * apart in a sorted list from which entries covered by a shorter one are
+ * dropped. No entry is then a prefix of another, so the only candidate
+ * matching a key is the greatest entry not above it, found with a binary
+ * search. RE2 set is consulted only for the remaining true regexes.
  */
 class RegexSet {
  public:
@@ -272,7 +319,14 @@ class RegexSet {
    */
   bool match(std::string const& key) const;
 
+  // whether `regexOrPrefix` matches as a plain key prefix
+  static bool isLiteralPrefix(std::string const& regexOrPrefix);
+
  private:
+  bool matchLiteralPrefix(std::string_view key) const;
+
+  // sorted, none is a prefix of another
+  std::vector<std::string> literalPrefixes_;
   std::unique_ptr<re2::RE2::Set> regexSet_;
 };
 
@@ -13,8 +13,18 @@ namespace fs = std::filesystem;
 namespace fs = std::experimental::filesystem;
 #endif
 
+#include <sys/mman.h>
+
+#include <atomic>
+
 #include <fb303/ServiceData.h>
+#include <folly/CPortability.h>
+#include <folly/String.h>
+#include <folly/hash/Hash.h>
+#include <folly/hash/SpookyHashV2.h>
 #include <folly/logging/xlog.h>
+#include <folly/memory/Malloc.h>
+#include <folly/portability/Malloc.h>
 #include <openr/common/Constants.h>
 #include <openr/common/Util.h>
 
@@ -22,17 +32,38 @@ namespace fs = std::experimental::filesystem;
 
 namespace openr {
 
+namespace {
+
+// OpenR start time since steady clock epoch, 0 until recorded
+std::atomic<std::chrono::steady_clock::rep> openrStartTime{0};
+
+} // namespace
+
+void
+setOpenrStartTime(std::chrono::steady_clock::time_point startTime) {
+  openrStartTime.store(startTime.time_since_epoch().count());
+}
+
 void
 logInitializationEvent(
     const std::string& publisher,
     const thrift::InitializationEvent event,
     const std::optional<std::string>& message) {
-  // OpenR start time. Initialized first time function is called.
-  const static auto kOpenrStartTime = std::chrono::steady_clock::now();
+  const auto now = std::chrono::steady_clock::now();
+  // Start time defaults to the first event if not recorded by main(). Failed
+  // exchange loads the start time recorded concurrently.
+  auto startTime = openrStartTime.load();
+  if (startTime == 0 and
+      openrStartTime.compare_exchange_strong(
+          startTime, now.time_since_epoch().count())) {
+    startTime = now.time_since_epoch().count();
+  }
   // Duration in milliseconds since OpenR start.
   auto durationSinceStart =
       std::chrono::ceil<std::chrono::milliseconds>(
-          std::chrono::steady_clock::now() - kOpenrStartTime)
+          now -
+          std::chrono::steady_clock::time_point(
+              std::chrono::steady_clock::duration(startTime)))
           .count();
   auto durationStr = durationSinceStart >= 1000
       ? fmt::format("{}s", durationSinceStart * 1.0 / 1000)
@@ -75,7 +106,23 @@ setupThriftServerTls(
 template <class T>
 int64_t
 generateHashImpl(
-    const int64_t version, const std::string& originatorId, const T& value) {
+    const int64_t version,
+    const std::string& originatorId,
+    const T& value,
+    const thrift::KvStoreHashScheme scheme) {
+  if (scheme == thrift::KvStoreHashScheme::SPOOKY_V2) {
+    // seed with <version, originatorId> and hash value in a single pass
+    uint64_t seed = folly::hash::hash_128_to_64(
+        static_cast<uint64_t>(version),
+        folly::hash::SpookyHashV2::Hash64(
+            originatorId.data(), originatorId.size(), 0));
+    if (value.has_value()) {
+      seed = folly::hash::SpookyHashV2::Hash64(
+          value.value().data(), value.value().size(), seed);
+    }
+    return static_cast<int64_t>(seed);
+  }
+
   size_t seed = 0;
   boost::hash_combine(seed, version);
   boost::hash_combine(seed, originatorId);
@@ -89,16 +136,18 @@ int64_t
 generateHash(
     const int64_t version,
     const std::string& originatorId,
-    const std::optional<std::string>& value) {
-  return generateHashImpl(version, originatorId, value);
+    const std::optional<std::string>& value,
+    const thrift::KvStoreHashScheme scheme) {
+  return generateHashImpl(version, originatorId, value, scheme);
 }
 
 int64_t
 generateHash(
     const int64_t version,
     const std::string& originatorId,
-    const apache::thrift::optional_field_ref<const std::string&> value) {
-  return generateHashImpl(version, originatorId, value);
+    const apache::thrift::optional_field_ref<const std::string&> value,
+    const thrift::KvStoreHashScheme scheme) {
+  return generateHashImpl(version, originatorId, value, scheme);
 }
 
 // construct thrift::KvStoreFloodRate
@@ -183,5 +232,89 @@ getThreadBytesImpl(bool isAllocated) {
   return bytes;
 }
 
+void
+setHeapProfilingActive(bool active) {
+  if (active) {
+    // start over from a clean profile, with the current sampling rate
+    folly::mallctlCall("prof.reset");
+  }
+  folly::mallctlWrite("prof.active", active);
+}
+
+void
+dumpHeapProfile(const std::string& path) {
+  folly::mallctlWrite("prof.dump", path.c_str());
+}
+
+#if defined(FOLLY_USE_JEMALLOC) && !FOLLY_SANITIZE && \
+    (JEMALLOC_VERSION_MAJOR > 4) && defined(MADV_HUGEPAGE)
+namespace {
+
+// default extent hooks, shared by all arenas
+extent_hooks_t* defaultExtentHooks{nullptr};
+
+// default allocation, advising huge pages for extents spanning any
+void*
+hugePageExtentAlloc(
+    extent_hooks_t* /* extentHooks */,
+    void* newAddr,
+    size_t size,
+    size_t alignment,
+    bool* zero,
+    bool* commit,
+    unsigned arenaInd) {
+  void* addr = defaultExtentHooks->alloc(
+      defaultExtentHooks, newAddr, size, alignment, zero, commit, arenaInd);
+  if (addr and size >= Constants::kHugePageSize) {
+    // best effort, e.g. transparent huge pages may be disabled system wide
+    ::madvise(addr, size, MADV_HUGEPAGE);
+  }
+  return addr;
+}
+
+extent_hooks_t*
+getHugePageExtentHooks() {
+  static extent_hooks_t hugePageExtentHooks = []() {
+    folly::mallctlRead("arena.0.extent_hooks", &defaultExtentHooks);
+    auto hooks = *defaultExtentHooks;
+    hooks.alloc = &hugePageExtentAlloc;
+    return hooks;
+  }();
+  return &hugePageExtentHooks;
+}
+
+} // namespace
+
+unsigned
+createArena(bool hugePages) {
+  if (not folly::usingJEMalloc()) {
+    throw std::runtime_error("jemalloc is not in use");
+  }
+  unsigned arena{0};
+  size_t len = sizeof(arena);
+  extent_hooks_t* hooks = hugePages ? getHugePageExtentHooks() : nullptr;
+  if (auto err = mallctl(
+          "arenas.create",
+          &arena,
+          &len,
+          hooks ? &hooks : nullptr,
+          hooks ? sizeof(hooks) : 0)) {
+    throw std::runtime_error(
+        fmt::format("Failed to create arena: {}", folly::errnoStr(err)));
+  }
+  return arena;
+}
+#else
+unsigned
+createArena(bool /* hugePages */) {
+  throw std::runtime_error("jemalloc arenas are not supported by this build");
+}
+#endif
+
+void
+setThreadArena(unsigned arena) {
+  folly::mallctlWrite("thread.arena", arena);
+}
+
 } // namespace memory
 } // namespace openr
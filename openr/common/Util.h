@@ -45,6 +45,15 @@
 const openr::AreaId kTestingAreaName{"test_area_name"};
 
 namespace openr {
+/**
+ * Record OpenR start time, from which durations of initialization events are
+ * measured. Meant to be called first thing in main(), otherwise the time of
+ * the first logged event is taken.
+ */
+void setOpenrStartTime(
+    std::chrono::steady_clock::time_point startTime =
+        std::chrono::steady_clock::now());
+
 /**
  * Log OpenR initialization event and export to fb303::fbData.
  */
@@ -70,12 +79,16 @@ void setupThriftServerTls(
 int64_t generateHash(
     const int64_t version,
     const std::string& originatorId,
-    const std::optional<std::string>& value);
+    const std::optional<std::string>& value,
+    const thrift::KvStoreHashScheme scheme =
+        thrift::KvStoreHashScheme::BOOST_HASH_COMBINE);
 
 int64_t generateHash(
     const int64_t version,
     const std::string& originatorId,
-    const apache::thrift::optional_field_ref<const std::string&> value);
+    const apache::thrift::optional_field_ref<const std::string&> value,
+    const thrift::KvStoreHashScheme scheme =
+        thrift::KvStoreHashScheme::BOOST_HASH_COMBINE);
 
 /**
  * Utility functions for creating thrift objects
@@ -168,6 +181,27 @@ readThriftObjStr(const std::string& buf, Serializer& serializer) {
 
 namespace memory {
 uint64_t getThreadBytesImpl(bool isAllocated);
+
+/**
+ * [Heap Profiling] Control of jemalloc heap profiling, process wide. All
+ * throw std::runtime_error if jemalloc isn't built or started with profiling.
+ */
+// Start (resetting samples) or stop sampling of allocations
+void setHeapProfilingActive(bool active);
+// Dump heap profile of samples so far to `path`
+void dumpHeapProfile(const std::string& path);
+
+/**
+ * [Memory Arenas] jemalloc arenas dedicated to module threads, so that large
+ * tables of a module, e.g. KvStore keys or route databases, are packed
+ * together instead of interleaved with allocations of other modules. Arenas
+ * backed by transparent huge pages cut TLB misses of walks over these tables.
+ * Both throw std::runtime_error if jemalloc isn't in use.
+ */
+// Create an arena, optionally advising the kernel to back it by huge pages
+unsigned createArena(bool hugePages);
+// Serve further allocations of the calling thread from `arena`
+void setThreadArena(unsigned arena);
 } // namespace memory
 
 } // namespace openr
@@ -65,6 +65,46 @@ TEST(AsyncDebounce, BasicOperation) {
   evbThread.join();
 }
 
+TEST(AsyncDebounce, SetBackoffRange) {
+  folly::EventBase evb;
+
+  std::mutex m;
+  std::condition_variable cv;
+
+  std::chrono::milliseconds backOff{20};
+  AsyncDebounce<std::chrono::milliseconds> debouncedFn(
+      &evb,
+      std::chrono::milliseconds(10),
+      std::chrono::milliseconds(100),
+      [&m, &cv]() noexcept {
+        std::unique_lock<std::mutex> lk(m);
+        cv.notify_one();
+      });
+
+  auto evbThread = std::thread(&folly::EventBase::loopForever, &evb);
+
+  std::unique_lock<std::mutex> lk(m);
+  evb.runInEventBaseThread([&m, &debouncedFn, backOff]() {
+    std::unique_lock<std::mutex> l(m);
+    // Fixed backoff is not extended by following calls
+    debouncedFn.setBackoffRange(backOff, backOff);
+    for (int i = 0; i < 5; ++i) {
+      debouncedFn();
+    }
+  });
+  auto start = std::chrono::steady_clock::now();
+  cv.wait_for(lk, backOff * 4);
+  auto finish = std::chrono::steady_clock::now();
+
+  auto duration =
+      std::chrono::duration_cast<std::chrono::milliseconds>(finish - start);
+  EXPECT_GE(duration, backOff);
+  EXPECT_LT(duration, backOff * 2);
+
+  evb.terminateLoopSoon();
+  evbThread.join();
+}
+
 } // namespace openr
 
 int
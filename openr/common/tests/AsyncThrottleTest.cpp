@@ -118,6 +118,44 @@ TEST(AsyncThrottleTest, ImmediateExecution) {
   LOG(INFO) << "Stopping event base.";
 }
 
+TEST(AsyncThrottleTest, SetTimeout) {
+  folly::EventBase evb;
+
+  int count = 0;
+  AsyncThrottle throttledFn(
+      &evb, chrono::milliseconds(100), [&count]() noexcept { count++; });
+
+  evb.runInLoop([&]() noexcept {
+    // Scheduled callback keeps its timeout
+    throttledFn();
+    EXPECT_TRUE(throttledFn.isActive());
+    throttledFn.setTimeout(chrono::milliseconds(0));
+    EXPECT_TRUE(throttledFn.isActive());
+    EXPECT_EQ(0, count);
+
+    // New timeout applies from next scheduling on
+    throttledFn.cancel();
+    throttledFn();
+    EXPECT_FALSE(throttledFn.isActive());
+    EXPECT_EQ(1, count);
+
+    throttledFn.setTimeout(chrono::milliseconds(10));
+    throttledFn();
+    EXPECT_TRUE(throttledFn.isActive());
+    EXPECT_EQ(1, count);
+  });
+
+  folly::AsyncTimeout::schedule(
+      chrono::milliseconds(50), evb, [&]() noexcept {
+        EXPECT_FALSE(throttledFn.isActive());
+        EXPECT_EQ(2, count);
+        evb.terminateLoopSoon();
+      });
+
+  evb.loop();
+  EXPECT_EQ(2, count);
+}
+
 } // namespace openr
 
 int
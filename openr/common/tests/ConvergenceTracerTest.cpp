@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <thread>
+
+#include <folly/json.h>
+#include <folly/system/ThreadName.h>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <openr/common/ConvergenceTracer.h>
+
+using namespace openr;
+
+TEST(ConvergenceTracerTest, MergeTraceIds) {
+  thrift::PerfEvents to;
+  to.traceIds_ref() = {1, 2};
+  thrift::PerfEvents from;
+  from.traceIds_ref() = {2, 3};
+  ConvergenceTracer::mergeTraceIds(to, from);
+  EXPECT_EQ((std::vector<int64_t>{1, 2, 3}), *to.traceIds_ref());
+
+  // capped at kMaxTraceIds
+  for (int64_t i = 0; i < 2 * ConvergenceTracer::kMaxTraceIds; ++i) {
+    from.traceIds_ref()->emplace_back(100 + i);
+  }
+  ConvergenceTracer::mergeTraceIds(to, from);
+  EXPECT_EQ(ConvergenceTracer::kMaxTraceIds, to.traceIds_ref()->size());
+}
+
+TEST(ConvergenceTracerTest, Timeline) {
+  const auto traceId = ConvergenceTracer::newTraceId();
+  const auto otherTraceId = ConvergenceTracer::newTraceId();
+  EXPECT_GT(traceId, 0);
+  EXPECT_NE(traceId, otherTraceId);
+
+  // events of one trace recorded by several threads are merged by time
+  ConvergenceTracer::record(traceId, "FIRST");
+  ConvergenceTracer::record(otherTraceId, "OTHER");
+  std::thread([traceId]() {
+    folly::setThreadName("tracer-test");
+    /* sleep override */
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    ConvergenceTracer::record(traceId, "SECOND");
+  }).join();
+
+  const auto events = ConvergenceTracer::getEvents({traceId});
+  ASSERT_EQ(2, events.size());
+  EXPECT_EQ("FIRST", *events.at(0).event_ref());
+  EXPECT_EQ("SECOND", *events.at(1).event_ref());
+  EXPECT_EQ("tracer-test", *events.at(1).threadName_ref());
+  EXPECT_LE(*events.at(0).unixTsUs_ref(), *events.at(1).unixTsUs_ref());
+  EXPECT_GE(ConvergenceTracer::getEvents().size(), 3);
+
+  // one track per thread, besides the events
+  const auto trace =
+      folly::parseJson(ConvergenceTracer::toChromeTrace(events));
+  const auto& traceEvents = trace.at("traceEvents");
+  ASSERT_EQ(4, traceEvents.size());
+  EXPECT_EQ("thread_name", traceEvents[0].at("name").asString());
+  EXPECT_EQ("FIRST", traceEvents[1].at("name").asString());
+  EXPECT_EQ(*events.at(0).unixTsUs_ref(), traceEvents[1].at("ts").asInt());
+}
+
+TEST(ConvergenceTracerTest, RingOverwrite) {
+  const auto traceId = ConvergenceTracer::newTraceId();
+  for (size_t i = 0; i < ConvergenceTracer::kRingSize + 10; ++i) {
+    ConvergenceTracer::record(traceId, "EVENT");
+  }
+  EXPECT_EQ(
+      ConvergenceTracer::kRingSize,
+      ConvergenceTracer::getEvents({traceId}).size());
+}
+
+int
+main(int argc, char** argv) {
+  // Basic initialization
+  testing::InitGoogleTest(&argc, argv);
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = true;
+
+  // Run the tests
+  return RUN_ALL_TESTS();
+}
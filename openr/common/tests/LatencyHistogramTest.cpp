@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <openr/common/LatencyHistogram.h>
+
+using namespace openr;
+
+TEST(LatencyHistogramTest, Percentiles) {
+  using namespace std::chrono_literals;
+  LatencyHistogram histogram;
+  const auto start = std::chrono::steady_clock::now();
+  EXPECT_EQ(0us, histogram.getPercentile(50, start));
+  EXPECT_EQ(0us, histogram.getMax(start));
+
+  // 98 fast values and 2 slow ones
+  for (int i = 0; i < 98; ++i) {
+    histogram.addValue(10us, start);
+  }
+  histogram.addValue(5000us, start);
+  histogram.addValue(7000us, start);
+
+  // Reported as upper bound of power-of-two bucket, capped by max
+  EXPECT_EQ(15us, histogram.getPercentile(50, start));
+  EXPECT_EQ(7000us, histogram.getPercentile(99, start));
+  EXPECT_EQ(7000us, histogram.getMax(start));
+
+  // Window just ended is still reported along with new one
+  const auto next = start + LatencyHistogram::kWindow;
+  histogram.addValue(1us, next);
+  EXPECT_EQ(7000us, histogram.getMax(next));
+
+  // Windows older than two windows are no longer reported
+  const auto later = next + 2 * LatencyHistogram::kWindow;
+  EXPECT_EQ(0us, histogram.getPercentile(99, later));
+  EXPECT_EQ(0us, histogram.getMax(later));
+}
+
+int
+main(int argc, char** argv) {
+  // Basic initialization
+  testing::InitGoogleTest(&argc, argv);
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = true;
+
+  // Run the tests
+  return RUN_ALL_TESTS();
+}
@@ -10,6 +10,9 @@
 #include <folly/futures/Promise.h>
 #include <folly/init/Init.h>
 #include <folly/synchronization/Baton.h>
+#if FOLLY_HAS_COROUTINES
+#include <folly/experimental/coro/Sleep.h>
+#endif
 #include <gtest/gtest.h>
 
 #include <openr/common/OpenrEventBase.h>
@@ -111,6 +114,80 @@ TEST(OpenrEventBaseTest, DefaultConstructor) {
   evbThread.join();
 }
 
+TEST_F(OpenrEventBaseTestFixture, QueueReaderTask) {
+  // Both flavors read in batches once start baton is posted, until queue is
+  // closed
+  for (bool useFiber : {false, true}) {
+    auto rwQueue = std::make_shared<messaging::RWQueue<int>>();
+    folly::fibers::Baton startBaton;
+    folly::Baton receivedBaton;
+    std::vector<int> received;
+    auto callback = [&](std::vector<int>&& batch) {
+      EXPECT_LE(batch.size(), 2);
+      received.insert(received.end(), batch.begin(), batch.end());
+      if (received.size() == 3) {
+        receivedBaton.post();
+      }
+    };
+    evb.runInEventBaseThread([&]() {
+      if (useFiber) {
+        evb.addQueueReaderFiberTask(
+            "test", messaging::RQueue<int>(rwQueue), 2, callback, &startBaton);
+      } else {
+        evb.addQueueReaderTask(
+            "test", messaging::RQueue<int>(rwQueue), 2, callback, &startBaton);
+      }
+    });
+
+    rwQueue->push(1);
+    rwQueue->push(2);
+    rwQueue->push(3);
+    EXPECT_FALSE(receivedBaton.try_wait_for(std::chrono::milliseconds(100)));
+    EXPECT_EQ(3, rwQueue->size());
+
+    startBaton.post();
+    receivedBaton.wait();
+    EXPECT_EQ(std::vector<int>({1, 2, 3}), received);
+    EXPECT_EQ(0, rwQueue->size());
+
+    // Callback runs are recorded with reader name
+    EventBaseStats stats;
+    evb.getEvb()->runInEventBaseThreadAndWait(
+        [&]() { stats = evb.getStats(); });
+    EXPECT_EQ(1, stats.longestTasks.count("test"));
+
+    // Reader is waiting for more, close queue to terminate it
+    rwQueue->close();
+  }
+}
+
+#if FOLLY_HAS_COROUTINES
+TEST_F(OpenrEventBaseTestFixture, CoroTask) {
+  folly::Baton startedBaton;
+  folly::Baton cancelledBaton;
+  evb.runInEventBaseThread([&]() {
+    evb.addCoroTask(folly::coro::co_invoke(
+        [&]() -> folly::coro::Task<void> {
+          EXPECT_TRUE(evb.getEvb()->isInEventBaseThread());
+          startedBaton.post();
+          // Sleep is interrupted by cancellation in stop()
+          try {
+            co_await folly::coro::sleep(std::chrono::hours(1));
+          } catch (const folly::OperationCancelled&) {
+            cancelledBaton.post();
+          }
+        }));
+  });
+  startedBaton.wait();
+  EXPECT_FALSE(evb.getCancellationToken().isCancellationRequested());
+
+  // stop() cancels and awaits the task
+  evb.stop();
+  EXPECT_TRUE(cancelledBaton.ready());
+  EXPECT_TRUE(evb.getCancellationToken().isCancellationRequested());
+}
+#endif
+
 TEST_F(OpenrEventBaseTestFixture, Timestamp) {
   // Expect non empty timestamp
   auto ts1 = evb.getTimestamp();
@@ -137,6 +214,37 @@ TEST_F(OpenrEventBaseTestFixture, Timestamp) {
   EXPECT_EQ(ts3, ts4);
 }
 
+TEST_F(OpenrEventBaseTestFixture, LoopStats) {
+  // Block loop longer than heartbeat interval, delaying heartbeat
+  evb.getEvb()->runInEventBaseThreadAndWait([&]() {
+    const auto startTime = evb.startTask("blocking");
+    ASSERT_TRUE(evb.getRunningTask().has_value());
+    EXPECT_EQ("blocking", evb.getRunningTask()->tag);
+    /* sleep override */
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    evb.recordTaskDuration("blocking", startTime);
+    EXPECT_FALSE(evb.getRunningTask().has_value());
+  });
+
+  // Let delayed heartbeat record the lag
+  /* sleep override */
+  std::this_thread::sleep_for(2 * OpenrEventBase::kHeartbeatInterval);
+
+  EventBaseStats stats;
+  evb.getEvb()->runInEventBaseThreadAndWait([&]() { stats = evb.getStats(); });
+  EXPECT_GE(stats.loopLagMax, std::chrono::milliseconds(100));
+  EXPECT_LE(stats.loopLagP50, stats.loopLagP99);
+  EXPECT_LE(stats.loopLagP99, stats.loopLagMax);
+  EXPECT_GT(stats.busyPct, 0);
+  EXPECT_GE(stats.longestTasks.at("blocking"), std::chrono::milliseconds(300));
+  EXPECT_TRUE(evb.getThread().has_value());
+
+  // Busy time and longest tasks are reset, lag is still reported
+  evb.getEvb()->runInEventBaseThreadAndWait([&]() { stats = evb.getStats(); });
+  EXPECT_TRUE(stats.longestTasks.empty());
+  EXPECT_GE(stats.loopLagMax, std::chrono::milliseconds(100));
+}
+
 TEST_F(OpenrEventBaseTestFixture, TimeoutTest) {
   folly::Baton waitBaton;
 
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <openr/common/PrefixTrie.h>
+
+namespace {
+folly::CIDRNetwork
+toNetwork(const std::string& prefix) {
+  return folly::IPAddress::createNetwork(prefix);
+}
+
+std::vector<int>
+coveringValues(openr::PrefixTrie<int>& trie, const std::string& addr) {
+  std::vector<int> values;
+  for (auto* entry : trie.findCovering(folly::IPAddress(addr))) {
+    values.emplace_back(entry->second);
+  }
+  return values;
+}
+} // namespace
+
+TEST(PrefixTrieTest, InsertFindErase) {
+  openr::PrefixTrie<int> trie;
+  EXPECT_TRUE(trie.empty());
+  EXPECT_EQ(nullptr, trie.find(toNetwork("10.0.0.0/8")));
+
+  EXPECT_TRUE(trie.insert(toNetwork("10.0.0.0/8"), 1));
+  EXPECT_TRUE(trie.insert(toNetwork("10.1.0.0/16"), 2));
+  EXPECT_TRUE(trie.insert(toNetwork("fc00::/7"), 3));
+  EXPECT_EQ(3, trie.size());
+
+  // Replace value of existing prefix
+  EXPECT_FALSE(trie.insert(toNetwork("10.0.0.0/8"), 4));
+  EXPECT_EQ(3, trie.size());
+  ASSERT_NE(nullptr, trie.find(toNetwork("10.0.0.0/8")));
+  EXPECT_EQ(4, *trie.find(toNetwork("10.0.0.0/8")));
+
+  // Intermediate nodes and other families don't match
+  EXPECT_EQ(nullptr, trie.find(toNetwork("10.0.0.0/12")));
+  EXPECT_EQ(nullptr, trie.find(toNetwork("::/0")));
+
+  EXPECT_FALSE(trie.erase(toNetwork("10.0.0.0/12")));
+  EXPECT_TRUE(trie.erase(toNetwork("10.0.0.0/8")));
+  EXPECT_FALSE(trie.erase(toNetwork("10.0.0.0/8")));
+  EXPECT_EQ(2, trie.size());
+  EXPECT_EQ(nullptr, trie.find(toNetwork("10.0.0.0/8")));
+  ASSERT_NE(nullptr, trie.find(toNetwork("10.1.0.0/16")));
+  EXPECT_EQ(2, *trie.find(toNetwork("10.1.0.0/16")));
+
+  trie.clear();
+  EXPECT_TRUE(trie.empty());
+  EXPECT_EQ(nullptr, trie.find(toNetwork("fc00::/7")));
+}
+
+TEST(PrefixTrieTest, FindCovering) {
+  openr::PrefixTrie<int> trie;
+  trie.insert(toNetwork("0.0.0.0/0"), 0);
+  trie.insert(toNetwork("10.0.0.0/8"), 8);
+  trie.insert(toNetwork("10.1.0.0/16"), 16);
+  trie.insert(toNetwork("10.1.2.3/32"), 32);
+  trie.insert(toNetwork("fc00::/64"), 64);
+
+  // Ordered from shortest to longest prefix
+  EXPECT_EQ(std::vector<int>({0, 8, 16, 32}), coveringValues(trie, "10.1.2.3"));
+  EXPECT_EQ(std::vector<int>({0, 8, 16}), coveringValues(trie, "10.1.2.4"));
+  EXPECT_EQ(std::vector<int>({0, 8}), coveringValues(trie, "10.2.0.0"));
+  EXPECT_EQ(std::vector<int>({0}), coveringValues(trie, "192.168.0.1"));
+
+  // Address families are kept apart
+  EXPECT_EQ(std::vector<int>({64}), coveringValues(trie, "fc00::1"));
+  EXPECT_TRUE(coveringValues(trie, "fd00::1").empty());
+
+  // Erased prefix is no longer reported, while its children still are
+  trie.erase(toNetwork("10.0.0.0/8"));
+  EXPECT_EQ(std::vector<int>({0, 16, 32}), coveringValues(trie, "10.1.2.3"));
+  trie.erase(toNetwork("10.1.2.3/32"));
+  EXPECT_EQ(std::vector<int>({0, 16}), coveringValues(trie, "10.1.2.3"));
+}
+
+TEST(PrefixTrieTest, FindLongest) {
+  openr::PrefixTrie<int> trie;
+  const auto& constTrie = trie;
+  EXPECT_EQ(nullptr, constTrie.findLongest(toNetwork("10.1.2.3/32")));
+
+  trie.insert(toNetwork("10.0.0.0/8"), 8);
+  trie.insert(toNetwork("10.1.0.0/16"), 16);
+  trie.insert(toNetwork("fc00::/64"), 64);
+
+  // Longest prefix containing the address or prefix
+  ASSERT_NE(nullptr, constTrie.findLongest(toNetwork("10.1.2.3/32")));
+  EXPECT_EQ(16, constTrie.findLongest(toNetwork("10.1.2.3/32"))->second);
+  EXPECT_EQ(
+      toNetwork("10.1.0.0/16"),
+      constTrie.findLongest(toNetwork("10.1.2.3/32"))->first);
+  EXPECT_EQ(8, constTrie.findLongest(toNetwork("10.2.0.0/16"))->second);
+  // Longer prefix doesn't contain shorter one
+  EXPECT_EQ(8, constTrie.findLongest(toNetwork("10.0.0.0/12"))->second);
+  EXPECT_EQ(nullptr, constTrie.findLongest(toNetwork("10.0.0.0/7")));
+  EXPECT_EQ(nullptr, constTrie.findLongest(toNetwork("192.168.0.1/32")));
+  EXPECT_EQ(64, constTrie.findLongest(toNetwork("fc00::1/128"))->second);
+  EXPECT_EQ(nullptr, constTrie.findLongest(toNetwork("fd00::1/128")));
+}
+
+int
+main(int argc, char** argv) {
+  // Basic initialization
+  testing::InitGoogleTest(&argc, argv);
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = true;
+
+  // Run the tests
+  return RUN_ALL_TESTS();
+}
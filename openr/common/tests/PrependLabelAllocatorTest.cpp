@@ -131,6 +131,57 @@ TEST_F(PrependLabelAllocatorTestFixture, AllocateFreedLabelToNewNextHopSet) {
   EXPECT_EQ(pair.first.value(), 60000);
 }
 
+class PrependLabelAllocatorSmallRangeTestFixture
+    : public PrependLabelAllocatorTestFixture {
+ public:
+  thrift::OpenrConfig
+  createConfig() override {
+    auto tConfig = PrependLabelAllocatorTestFixture::createConfig();
+    auto& v4Range = *tConfig.segment_routing_config_ref()
+                         ->prepend_label_ranges_ref()
+                         ->v4_ref();
+    v4Range.end_label_ref() = *v4Range.start_label_ref() + 1;
+    return tConfig;
+  }
+};
+
+/**
+ * Exhausted label range returns no label instead of failing. Nexthop set
+ * without label gets one as soon as another set releases its label.
+ */
+TEST_F(PrependLabelAllocatorSmallRangeTestFixture, ExhaustedRange) {
+  std::vector<std::set<folly::IPAddress>> nextHopSets;
+  for (int i = 1; i <= 3; ++i) {
+    nextHopSets.push_back({folly::IPAddress(fmt::format("192.168.0.{}", i))});
+  }
+
+  EXPECT_EQ(
+      prependLabelAllocator_->incrementRefCount(nextHopSets.at(0)),
+      std::make_pair(std::optional<int32_t>(60000), true));
+  EXPECT_EQ(
+      prependLabelAllocator_->incrementRefCount(nextHopSets.at(1)),
+      std::make_pair(std::optional<int32_t>(60001), true));
+
+  // range exhausted
+  auto [label, isNew] =
+      prependLabelAllocator_->incrementRefCount(nextHopSets.at(2));
+  EXPECT_FALSE(label.has_value());
+  EXPECT_FALSE(isNew);
+
+  // released label is reused by the set without label
+  EXPECT_EQ(
+      prependLabelAllocator_->decrementRefCount(nextHopSets.at(0)), 60000);
+  EXPECT_EQ(
+      prependLabelAllocator_->incrementRefCount(nextHopSets.at(2)),
+      std::make_pair(std::optional<int32_t>(60000), true));
+
+  // set held twice releases its label along with the second reference only
+  EXPECT_FALSE(
+      prependLabelAllocator_->decrementRefCount(nextHopSets.at(2)).has_value());
+  EXPECT_EQ(
+      prependLabelAllocator_->decrementRefCount(nextHopSets.at(2)), 60000);
+}
+
 } // namespace openr
 
 int
@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <openr/common/Constants.h>
+#include <openr/common/LsdbUtil.h>
+#include <openr/common/NetworkUtil.h>
+#include <openr/common/StreamEncoder.h>
+
+using namespace openr;
+
+namespace {
+
+thrift::Publication
+createPublication(int64_t version) {
+  thrift::Publication pub;
+  pub.area_ref() = "area";
+  for (int i = 0; i < 100; ++i) {
+    thrift::Value value;
+    value.version_ref() = version;
+    value.originatorId_ref() = "node1";
+    value.value_ref() = fmt::format("value-{}-{}", i, version);
+    pub.keyVals_ref()->emplace(fmt::format("prefix:node1:{}", i), value);
+  }
+  return pub;
+}
+
+std::vector<thrift::NextHopThrift>
+createNextHops(int64_t weight) {
+  return {
+      createNextHop(
+          toBinaryAddress(folly::IPAddress("fe80::1")),
+          "eth0",
+          10,
+          std::nullopt,
+          std::nullopt,
+          std::nullopt,
+          weight),
+      createNextHop(
+          toBinaryAddress(folly::IPAddress("fe80::2")),
+          "eth1",
+          10,
+          std::nullopt,
+          std::nullopt,
+          std::nullopt,
+          weight),
+  };
+}
+
+thrift::RouteDatabaseDeltaDetail
+createDelta(const std::string& prefix, int64_t weight) {
+  thrift::RouteDatabaseDeltaDetail delta;
+  delta.unicastRoutesToUpdate_ref()->emplace_back(
+      createUnicastRouteDetail(toIpPrefix(prefix), createNextHops(weight)));
+  thrift::MplsRouteDetail mplsRoute;
+  mplsRoute.mplsRoute_ref() = createMplsRoute(100, createNextHops(weight));
+  delta.mplsRoutesToUpdate_ref()->emplace_back(std::move(mplsRoute));
+  return delta;
+}
+
+thrift::StreamEncodingParams
+createParams(thrift::StreamCompression compression, bool internNextHops) {
+  thrift::StreamEncodingParams params;
+  params.compression_ref() = compression;
+  params.internNextHops_ref() = internNextHops;
+  return params;
+}
+
+} // namespace
+
+TEST(StreamEncoderTest, Uncompressed) {
+  StreamEncoder encoder(createParams(thrift::StreamCompression::NONE, false));
+  StreamDecoder decoder;
+  for (int64_t i = 0; i < 3; ++i) {
+    const auto pub = createPublication(i);
+    const auto message = encoder.encode(pub);
+    EXPECT_EQ(i, *message.seqNum_ref());
+    EXPECT_EQ(message.data_ref()->size(), *message.uncompressedSize_ref());
+    EXPECT_EQ(pub, decoder.decode<thrift::Publication>(message));
+  }
+}
+
+TEST(StreamEncoderTest, Compressed) {
+  if (not folly::io::hasStreamCodec(folly::io::CodecType::ZSTD)) {
+    GTEST_SKIP() << "zstd stream compression is not available";
+  }
+  StreamEncoder encoder(createParams(thrift::StreamCompression::ZSTD, false));
+  StreamDecoder decoder;
+  size_t uncompressedSize{0};
+  size_t compressedSize{0};
+  for (int64_t i = 0; i < 10; ++i) {
+    const auto pub = createPublication(i);
+    const auto message = encoder.encode(pub);
+    uncompressedSize += *message.uncompressedSize_ref();
+    compressedSize += message.data_ref()->size();
+    // every message is decodable as soon as it is received
+    EXPECT_EQ(pub, decoder.decode<thrift::Publication>(message));
+  }
+  EXPECT_LT(compressedSize * 2, uncompressedSize);
+}
+
+TEST(StreamEncoderTest, OutOfOrder) {
+  StreamEncoder encoder(createParams(thrift::StreamCompression::NONE, false));
+  StreamDecoder decoder;
+  encoder.encode(createPublication(0));
+  const auto message = encoder.encode(createPublication(1));
+  EXPECT_THROW(
+      decoder.decode<thrift::Publication>(message), std::runtime_error);
+}
+
+TEST(StreamEncoderTest, InternNextHops) {
+  StreamEncoder encoder(createParams(thrift::StreamCompression::NONE, true));
+  StreamDecoder decoder;
+
+  // routes of both deltas share the same next-hops
+  const std::vector<thrift::RouteDatabaseDeltaDetail> deltas{
+      createDelta("10.0.0.0/8", 1), createDelta("11.0.0.0/8", 1)};
+  auto batch = encoder.makeFibBatch(deltas);
+  EXPECT_EQ(1, batch.newNextHopGroups_ref()->size());
+  EXPECT_EQ(4, batch.nextHopGroupIds_ref()->size());
+  EXPECT_TRUE(batch.deltas_ref()
+                  ->at(0)
+                  .unicastRoutesToUpdate_ref()
+                  ->at(0)
+                  .unicastRoute_ref()
+                  ->nextHops_ref()
+                  ->empty());
+  EXPECT_EQ(
+      deltas,
+      decoder.restoreFibBatch(
+          decoder.decode<thrift::FibDetailStreamBatch>(encoder.encode(batch))));
+
+  // known group isn't sent again
+  const std::vector<thrift::RouteDatabaseDeltaDetail> moreDeltas{
+      createDelta("12.0.0.0/8", 1), createDelta("13.0.0.0/8", 2)};
+  batch = encoder.makeFibBatch(moreDeltas);
+  EXPECT_EQ(1, batch.newNextHopGroups_ref()->size());
+  EXPECT_EQ(
+      moreDeltas,
+      decoder.restoreFibBatch(
+          decoder.decode<thrift::FibDetailStreamBatch>(encoder.encode(batch))));
+  EXPECT_EQ(2, encoder.getNumNextHopGroups());
+}
+
+TEST(StreamEncoderTest, ResetNextHopGroups) {
+  StreamEncoder encoder(createParams(thrift::StreamCompression::NONE, true));
+  StreamDecoder decoder;
+
+  std::vector<thrift::RouteDatabaseDeltaDetail> deltas;
+  for (size_t i = 0; i < Constants::kStreamMaxNextHopGroups; ++i) {
+    deltas.emplace_back(createDelta("10.0.0.0/8", i));
+  }
+  auto batch = encoder.makeFibBatch(deltas);
+  EXPECT_FALSE(*batch.resetNextHopGroups_ref());
+  EXPECT_EQ(
+      deltas,
+      decoder.restoreFibBatch(
+          decoder.decode<thrift::FibDetailStreamBatch>(encoder.encode(batch))));
+
+  // groups are reset past the limit, known groups are sent again
+  deltas = {createDelta("11.0.0.0/8", 0)};
+  batch = encoder.makeFibBatch(deltas);
+  EXPECT_TRUE(*batch.resetNextHopGroups_ref());
+  EXPECT_EQ(1, batch.newNextHopGroups_ref()->size());
+  EXPECT_EQ(1, encoder.getNumNextHopGroups());
+  EXPECT_EQ(
+      deltas,
+      decoder.restoreFibBatch(
+          decoder.decode<thrift::FibDetailStreamBatch>(encoder.encode(batch))));
+}
+
+int
+main(int argc, char** argv) {
+  // Basic initialization
+  testing::InitGoogleTest(&argc, argv);
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = true;
+
+  // Run the tests
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <thread>
+#include <vector>
+
+#include <fb303/ServiceData.h>
+#include <folly/MapUtil.h>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <openr/common/ThreadLocalStats.h>
+
+using namespace openr;
+
+namespace fb303 = facebook::fb303;
+
+namespace {
+
+int64_t
+getCounter(const std::string& key) {
+  return folly::get_default(fb303::fbData->getCounters(), key, 0);
+}
+
+} // namespace
+
+TEST(ThreadLocalStatsTest, Sum) {
+  ThreadLocalStat stat("test.sum", fb303::SUM);
+  stat.add(3);
+  stat.add(4);
+  // not exported until flushed
+  EXPECT_EQ(0, getCounter("test.sum.sum"));
+
+  ThreadLocalStat::flushAll();
+  EXPECT_EQ(7, getCounter("test.sum.sum"));
+
+  // values are added once
+  ThreadLocalStat::flushAll();
+  EXPECT_EQ(7, getCounter("test.sum.sum"));
+}
+
+TEST(ThreadLocalStatsTest, CountAndAvg) {
+  ThreadLocalStat count("test.count", fb303::COUNT);
+  ThreadLocalStat avg("test.avg", fb303::AVG);
+  for (int64_t i = 1; i <= 4; ++i) {
+    count.add();
+    avg.add(i * 10);
+  }
+  count.flush();
+  avg.flush();
+  EXPECT_EQ(4, getCounter("test.count.count"));
+  EXPECT_EQ(25, getCounter("test.avg.avg"));
+}
+
+TEST(ThreadLocalStatsTest, ExitedThreads) {
+  ThreadLocalStat stat("test.threads", fb303::SUM);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&stat]() {
+      for (int j = 0; j < 1000; ++j) {
+        stat.add();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  // values of exited threads are kept until flushed
+  stat.flush();
+  EXPECT_EQ(4000, getCounter("test.threads.sum"));
+}
+
+int
+main(int argc, char** argv) {
+  // Basic initialization
+  testing::InitGoogleTest(&argc, argv);
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = true;
+
+  // Run the tests
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <openr/common/TimerWheel.h>
+
+using namespace std::chrono_literals;
+
+namespace {
+const auto kStart = std::chrono::steady_clock::time_point(1000ms);
+} // namespace
+
+TEST(TimerWheelTest, ScheduleAndExpire) {
+  openr::TimerWheel<int> wheel(10ms);
+  EXPECT_TRUE(wheel.empty());
+  EXPECT_FALSE(wheel.nextDeadline().has_value());
+  EXPECT_TRUE(wheel.popExpired(kStart).empty());
+
+  // Deadlines round up to end of their slot
+  wheel.schedule(1, kStart + 5ms);
+  wheel.schedule(2, kStart + 10ms);
+  wheel.schedule(3, kStart + 25ms);
+  EXPECT_EQ(3, wheel.size());
+  EXPECT_EQ(1, wheel.count(2));
+  EXPECT_EQ(kStart + 10ms, wheel.nextDeadline());
+
+  // Nothing expires before its deadline
+  EXPECT_TRUE(wheel.popExpired(kStart + 9ms).empty());
+
+  // Keys of expired slots are returned and removed
+  auto expired = wheel.popExpired(kStart + 10ms);
+  std::sort(expired.begin(), expired.end());
+  EXPECT_EQ(std::vector<int>({1, 2}), expired);
+  EXPECT_EQ(1, wheel.size());
+  EXPECT_EQ(0, wheel.count(1));
+  EXPECT_EQ(kStart + 30ms, wheel.nextDeadline());
+
+  EXPECT_EQ(std::vector<int>({3}), wheel.popExpired(kStart + 100ms));
+  EXPECT_TRUE(wheel.empty());
+  EXPECT_FALSE(wheel.nextDeadline().has_value());
+}
+
+TEST(TimerWheelTest, RescheduleAndErase) {
+  openr::TimerWheel<int> wheel;
+  wheel.schedule(1, kStart + 5ms);
+  wheel.schedule(2, kStart + 5ms);
+
+  // Rescheduling moves key to the new deadline
+  wheel.schedule(1, kStart + 50ms);
+  EXPECT_EQ(2, wheel.size());
+  EXPECT_EQ(kStart + 5ms, wheel.nextDeadline());
+  wheel.schedule(2, kStart + 1ms);
+  EXPECT_EQ(kStart + 1ms, wheel.nextDeadline());
+
+  EXPECT_EQ(1, wheel.erase(2));
+  EXPECT_EQ(0, wheel.erase(2));
+  EXPECT_EQ(kStart + 50ms, wheel.nextDeadline());
+  EXPECT_TRUE(wheel.popExpired(kStart + 49ms).empty());
+  EXPECT_EQ(std::vector<int>({1}), wheel.popExpired(kStart + 50ms));
+
+  wheel.schedule(3, kStart);
+  wheel.clear();
+  EXPECT_TRUE(wheel.empty());
+  EXPECT_FALSE(wheel.nextDeadline().has_value());
+}
+
+TEST(TimerWheelTest, PopNextExpired) {
+  openr::TimerWheel<int> wheel(10ms);
+  wheel.schedule(1, kStart + 15ms);
+  wheel.schedule(2, kStart + 5ms);
+  wheel.schedule(3, kStart + 5ms);
+
+  // Keys are popped one by one in order of their deadlines
+  EXPECT_FALSE(wheel.popNextExpired(kStart).has_value());
+  auto key = wheel.popNextExpired(kStart + 20ms);
+  ASSERT_TRUE(key.has_value());
+  EXPECT_TRUE(*key == 2 or *key == 3);
+
+  // Key erased in between is not returned
+  wheel.erase(*key == 2 ? 3 : 2);
+  EXPECT_EQ(1, wheel.popNextExpired(kStart + 20ms).value());
+  EXPECT_FALSE(wheel.popNextExpired(kStart + 20ms).has_value());
+  EXPECT_TRUE(wheel.empty());
+}
+
+int
+main(int argc, char** argv) {
+  // Basic initialization
+  testing::InitGoogleTest(&argc, argv);
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = true;
+
+  // Run the tests
+  return RUN_ALL_TESTS();
+}
@@ -54,6 +54,33 @@ TEST(TypesTest, fromStrTest) {
   EXPECT_TRUE(PrefixKey::fromStr(invalidStrWithBadPrefixV2, areaId).hasError());
 }
 
+TEST(TypesTest, prefixShardKeyTest) {
+  const std::string nodeName{"node-1"};
+  const auto shardKey = PrefixKey::getPrefixShardKey(nodeName, 7);
+  EXPECT_EQ(
+      fmt::format(
+          "{}{}:shard-7", Constants::kPrefixDbMarker.toString(), nodeName),
+      shardKey);
+
+  auto maybeShard = PrefixKey::parsePrefixShardKey(shardKey);
+  ASSERT_FALSE(maybeShard.hasError());
+  EXPECT_EQ(nodeName, maybeShard->first);
+  EXPECT_EQ(7, maybeShard->second);
+
+  // shard and per-prefix keys are told apart
+  EXPECT_TRUE(PrefixKey::fromStr(shardKey).hasError());
+  const auto prefixKeyStr =
+      PrefixKey(nodeName, folly::IPAddress::createNetwork("1.1.1.1/32"), "0")
+          .getPrefixKeyV2();
+  EXPECT_TRUE(PrefixKey::parsePrefixShardKey(prefixKeyStr).hasError());
+  EXPECT_TRUE(PrefixKey::parsePrefixShardKey(
+                  fmt::format("{}:shard-1", Constants::kAdjDbMarker.toString()))
+                  .hasError());
+  EXPECT_TRUE(
+      PrefixKey::parsePrefixShardKey(fmt::format("{}shard-a", shardKey))
+          .hasError());
+}
+
 int
 main(int argc, char* argv[]) {
   // Parse command line flags
@@ -9,6 +9,7 @@
 #include <folly/init/Init.h>
 
 #include <openr/common/LsdbUtil.h>
+#include <openr/common/NetworkUtil.h>
 #include <openr/common/Types.h>
 
 using namespace openr;
@@ -48,6 +49,162 @@ BENCHMARK_PARAM(BM_SelectRoutes, 64);
 BENCHMARK_PARAM(BM_SelectRoutes, 128);
 BENCHMARK_PARAM(BM_SelectRoutes, 256);
 
+std::vector<thrift::IpPrefix>
+createIpPrefixes(size_t size) {
+  std::vector<thrift::IpPrefix> prefixes;
+  prefixes.reserve(size);
+  for (size_t i = 0; i < size; ++i) {
+    prefixes.emplace_back(toIpPrefix(
+        i % 2 ? fmt::format("10.{}.{}.0/24", (i >> 8) & 0xff, i & 0xff)
+              : fmt::format("fc00:{:x}:{:x}::/64", i >> 16, i & 0xffff)));
+  }
+  return prefixes;
+}
+
+/**
+ * [Packed Prefix] Conversion of route prefixes, one by one before packed
+ * prefixes were introduced (string round trip), batched and packed
+ */
+void
+BM_ToIPNetworkViaString(uint32_t iters, size_t size) {
+  auto suspender = folly::BenchmarkSuspender();
+  const auto prefixes = createIpPrefixes(size);
+  suspender.dismiss(); // Start measuring benchmark time
+
+  while (iters--) {
+    for (const auto& prefix : prefixes) {
+      folly::doNotOptimizeAway(folly::IPAddress::createNetwork(
+          toIPAddress(*prefix.prefixAddress_ref()).str(),
+          *prefix.prefixLength_ref()));
+    }
+  }
+}
+
+void
+BM_ToIPNetworks(uint32_t iters, size_t size) {
+  auto suspender = folly::BenchmarkSuspender();
+  const auto prefixes = createIpPrefixes(size);
+  suspender.dismiss(); // Start measuring benchmark time
+
+  while (iters--) {
+    folly::doNotOptimizeAway(toIPNetworks(prefixes));
+  }
+}
+
+void
+BM_ToPackedPrefixes(uint32_t iters, size_t size) {
+  auto suspender = folly::BenchmarkSuspender();
+  const auto prefixes = createIpPrefixes(size);
+  suspender.dismiss(); // Start measuring benchmark time
+
+  while (iters--) {
+    folly::doNotOptimizeAway(toPackedPrefixes(prefixes));
+  }
+}
+
+void
+BM_ToIpPrefixes(uint32_t iters, size_t size) {
+  auto suspender = folly::BenchmarkSuspender();
+  const auto networks = toIPNetworks(createIpPrefixes(size));
+  suspender.dismiss(); // Start measuring benchmark time
+
+  while (iters--) {
+    folly::doNotOptimizeAway(toIpPrefixes(networks));
+  }
+}
+
+BENCHMARK_PARAM(BM_ToIPNetworkViaString, 1000);
+BENCHMARK_RELATIVE_PARAM(BM_ToIPNetworks, 1000);
+BENCHMARK_RELATIVE_PARAM(BM_ToPackedPrefixes, 1000);
+BENCHMARK_PARAM(BM_ToIpPrefixes, 1000);
+BENCHMARK_PARAM(BM_ToIPNetworkViaString, 100000);
+BENCHMARK_RELATIVE_PARAM(BM_ToIPNetworks, 100000);
+BENCHMARK_RELATIVE_PARAM(BM_ToPackedPrefixes, 100000);
+BENCHMARK_PARAM(BM_ToIpPrefixes, 100000);
+
+// Sorted route database of `size` routes, every `changeEvery`-th route with
+// another next-hop metric
+thrift::RouteDatabase
+createRouteDb(size_t size, size_t changeEvery) {
+  thrift::RouteDatabase routeDb;
+  routeDb.thisNodeName_ref() = "node";
+  for (auto& prefix : createIpPrefixes(size)) {
+    const auto index = routeDb.unicastRoutes_ref()->size();
+    routeDb.unicastRoutes_ref()->emplace_back(createUnicastRoute(
+        std::move(prefix),
+        {createNextHop(
+            toBinaryAddress("fe80::1"),
+            "eth0",
+            changeEvery and index % changeEvery == 0 ? 2 : 1)}));
+  }
+  std::sort(
+      routeDb.unicastRoutes_ref()->begin(), routeDb.unicastRoutes_ref()->end());
+  return routeDb;
+}
+
+/**
+ * [Route Delta View] Delta of route databases differing by 1% of routes,
+ * copied as thrift delta or as views
+ */
+void
+BM_FindDeltaRoutes(uint32_t iters, size_t size) {
+  auto suspender = folly::BenchmarkSuspender();
+  const auto oldRouteDb = createRouteDb(size, 0);
+  const auto newRouteDb = createRouteDb(size, 100);
+  suspender.dismiss(); // Start measuring benchmark time
+
+  while (iters--) {
+    folly::doNotOptimizeAway(findDeltaRoutes(newRouteDb, oldRouteDb));
+  }
+}
+
+void
+BM_FindDeltaRouteViews(uint32_t iters, size_t size) {
+  auto suspender = folly::BenchmarkSuspender();
+  const auto oldRouteDb = createRouteDb(size, 0);
+  const auto newRouteDb = createRouteDb(size, 100);
+  suspender.dismiss(); // Start measuring benchmark time
+
+  while (iters--) {
+    folly::doNotOptimizeAway(findDeltaRouteViews(newRouteDb, oldRouteDb));
+  }
+}
+
+BENCHMARK_PARAM(BM_FindDeltaRoutes, 10000);
+BENCHMARK_RELATIVE_PARAM(BM_FindDeltaRouteViews, 10000);
+BENCHMARK_PARAM(BM_FindDeltaRoutes, 200000);
+BENCHMARK_RELATIVE_PARAM(BM_FindDeltaRouteViews, 200000);
+
+/*
+ * Match KvStore keys against `size` filter prefixes, e.g. per node adjacency
+ * keys. Literal prefixes are binary searched while ones made regexes by a
+ * trailing `.*` go through RE2 set.
+ */
+void
+BM_RegexSetMatch(uint32_t iters, size_t size, bool literal) {
+  auto suspender = folly::BenchmarkSuspender();
+  std::vector<std::string> keyPrefixes;
+  std::vector<std::string> keys;
+  for (size_t i = 0; i < size; ++i) {
+    keyPrefixes.emplace_back(
+        fmt::format("adj:node{}:{}", i, literal ? "" : ".*"));
+    keys.emplace_back(fmt::format("adj:node{}:", i * 2));
+  }
+  const RegexSet regexSet(keyPrefixes);
+  suspender.dismiss(); // Start measuring benchmark time
+
+  while (iters--) {
+    for (const auto& key : keys) {
+      folly::doNotOptimizeAway(regexSet.match(key));
+    }
+  }
+}
+
+BENCHMARK_NAMED_PARAM(BM_RegexSetMatch, 100_regex, 100, false);
+BENCHMARK_RELATIVE_NAMED_PARAM(BM_RegexSetMatch, 100_literal, 100, true);
+BENCHMARK_NAMED_PARAM(BM_RegexSetMatch, 1000_regex, 1000, false);
+BENCHMARK_RELATIVE_NAMED_PARAM(BM_RegexSetMatch, 1000_literal, 1000, true);
+
 int
 main(int argc, char** argv) {
   folly::init(&argc, &argv);
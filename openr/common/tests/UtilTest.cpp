@@ -12,6 +12,7 @@
 
 #include <openr/common/LsdbUtil.h>
 #include <openr/common/MplsUtil.h>
+#include <openr/common/NetworkUtil.h>
 #include <openr/common/Types.h>
 #include <openr/common/Util.h>
 #include <openr/if/gen-cpp2/KvStore_types.h>
@@ -195,6 +196,15 @@ TEST(UtilTest, NetworkUtilTest) {
 
     EXPECT_THROW(toIPNetwork(v4Prefix), thrift::OpenrError);
     EXPECT_THROW(toIPNetwork(v6Prefix), thrift::OpenrError);
+
+    // Address is masked
+    EXPECT_EQ(
+        folly::IPAddress::createNetwork("10.0.0.0/15", -1, false),
+        toIPNetwork(createIpPrefix(toBinaryAddress("10.1.1.1"), 15)));
+    EXPECT_EQ(
+        folly::IPAddress::createNetwork("2620:0:1c00:0:fc00::/70", -1, false),
+        toIPNetwork(
+            createIpPrefix(toBinaryAddress("2620:0:1c00:0:ffff::1"), 70)));
   }
 
   //
@@ -211,6 +221,58 @@ TEST(UtilTest, NetworkUtilTest) {
   }
 }
 
+TEST(UtilTest, PackedPrefixTest) {
+  const std::vector<std::string> prefixStrs{
+      "0.0.0.0/0",
+      "10.1.1.1/15",
+      "10.1.1.1/32",
+      "::/0",
+      "2620:0:1c00:0:3ff::1/70",
+      "2620::1/128",
+      "::ffff:10.1.1.1/128"};
+  std::vector<thrift::IpPrefix> prefixes;
+  for (const auto& prefixStr : prefixStrs) {
+    prefixes.emplace_back(toIpPrefix(prefixStr));
+  }
+
+  const auto networks = toIPNetworks(prefixes);
+  const auto packed = toPackedPrefixes(prefixes);
+  ASSERT_EQ(prefixStrs.size(), networks.size());
+  ASSERT_EQ(prefixStrs.size(), packed.size());
+  for (size_t i = 0; i < prefixStrs.size(); ++i) {
+    const auto expected = folly::IPAddress::createNetwork(prefixStrs.at(i));
+    EXPECT_EQ(expected, networks.at(i));
+    EXPECT_EQ(expected, packed.at(i).toNetwork());
+    EXPECT_EQ(expected.first.isV4(), packed.at(i).isV4());
+    EXPECT_EQ(expected.second, packed.at(i).getPrefixLength());
+    EXPECT_EQ(toIpPrefix(expected), packed.at(i).toIpPrefix());
+    EXPECT_EQ(PackedPrefix::fromNetwork(expected), packed.at(i));
+  }
+  EXPECT_EQ(toIpPrefixes(networks).size(), prefixes.size());
+
+  // IPv4 and IPv6 prefixes of same bytes and length differ
+  EXPECT_NE(
+      PackedPrefix::fromIpPrefix(toIpPrefix("0.0.0.0/0")),
+      PackedPrefix::fromIpPrefix(toIpPrefix("::/0")));
+
+  // Usable as hash key, unmasked bits ignored
+  std::unordered_set<PackedPrefix> set(packed.begin(), packed.end());
+  EXPECT_EQ(prefixStrs.size(), set.size());
+  EXPECT_EQ(
+      1,
+      set.count(PackedPrefix::fromIpPrefix(
+          createIpPrefix(toBinaryAddress("10.1.254.1"), 15))));
+
+  // Invalid prefixes
+  auto invalid = toIpPrefix("10.1.1.1/32");
+  invalid.prefixLength_ref() = 33;
+  EXPECT_THROW(PackedPrefix::fromIpPrefix(invalid), thrift::OpenrError);
+  invalid.prefixAddress_ref()->addr_ref() = "abc";
+  invalid.prefixLength_ref() = 8;
+  EXPECT_THROW(PackedPrefix::fromIpPrefix(invalid), thrift::OpenrError);
+  EXPECT_THROW(toIPNetworks({invalid}), thrift::OpenrError);
+}
+
 // TODO: migrate PrefixKeyTest into TypesTest with fromStr() validation
 /*
 TEST(UtilTest, PrefixKeyTest) {
@@ -599,6 +661,68 @@ TEST(UtilTest, findDeltaRoutes) {
   EXPECT_EQ(res3.mplsRoutesToDelete_ref()->at(0), 2);
 }
 
+TEST(UtilTest, findDeltaRouteViews) {
+  const auto prefix4 = toIpPrefix("::ffff:10.4.4.4/128");
+  thrift::RouteDatabase oldRouteDb;
+  *oldRouteDb.thisNodeName_ref() = "node-1";
+  thrift::RouteDatabase newRouteDb;
+  *newRouteDb.thisNodeName_ref() = "node-1";
+
+  // prefix1 removed, prefix2 unchanged, prefix3 updated, prefix4 added
+  oldRouteDb.unicastRoutes_ref() = {
+      createUnicastRoute(prefix1, {path1_2_1}),
+      createUnicastRoute(prefix2, {path1_2_1}),
+      createUnicastRoute(prefix3, {path1_3_1})};
+  newRouteDb.unicastRoutes_ref() = {
+      createUnicastRoute(prefix2, {path1_2_1}),
+      createUnicastRoute(prefix3, {path1_3_1, path1_3_2}),
+      createUnicastRoute(prefix4, {path1_3_1})};
+  oldRouteDb.mplsRoutes_ref() = {
+      createMplsRoute(1, {path1_2_1_swap}),
+      createMplsRoute(2, {path1_2_1_swap})};
+  newRouteDb.mplsRoutes_ref() = {
+      createMplsRoute(2, {path1_2_2_swap}),
+      createMplsRoute(3, {path1_3_1_swap})};
+  for (auto* routeDb : {&oldRouteDb, &newRouteDb}) {
+    std::sort(
+        routeDb->unicastRoutes_ref()->begin(),
+        routeDb->unicastRoutes_ref()->end());
+  }
+
+  const auto delta = findDeltaRouteViews(newRouteDb, oldRouteDb);
+  std::set<thrift::IpPrefix> updated;
+  for (const auto* route : delta.unicastRoutesToUpdate) {
+    updated.emplace(*route->dest_ref());
+  }
+  EXPECT_EQ((std::set<thrift::IpPrefix>{prefix3, prefix4}), updated);
+  ASSERT_EQ(1, delta.unicastRoutesToDelete.size());
+  EXPECT_EQ(prefix1, *delta.unicastRoutesToDelete.at(0));
+  // views into databases
+  EXPECT_GE(
+      delta.unicastRoutesToUpdate.at(0),
+      newRouteDb.unicastRoutes_ref()->data());
+  ASSERT_EQ(2, delta.mplsRoutesToUpdate.size());
+  EXPECT_EQ(2, *delta.mplsRoutesToUpdate.at(0)->topLabel_ref());
+  EXPECT_EQ(3, *delta.mplsRoutesToUpdate.at(1)->topLabel_ref());
+  EXPECT_EQ(std::vector<int32_t>{1}, delta.mplsRoutesToDelete);
+
+  // same as copied delta
+  const auto routeDelta = findDeltaRoutes(newRouteDb, oldRouteDb);
+  EXPECT_EQ(2, routeDelta.unicastRoutesToUpdate_ref()->size());
+  EXPECT_EQ(
+      std::vector<thrift::IpPrefix>{prefix1},
+      *routeDelta.unicastRoutesToDelete_ref());
+  EXPECT_EQ(2, routeDelta.mplsRoutesToUpdate_ref()->size());
+  EXPECT_EQ(std::vector<int32_t>{1}, *routeDelta.mplsRoutesToDelete_ref());
+
+  // no delta between same databases
+  const auto noDelta = findDeltaRouteViews(newRouteDb, newRouteDb);
+  EXPECT_TRUE(noDelta.unicastRoutesToUpdate.empty());
+  EXPECT_TRUE(noDelta.unicastRoutesToDelete.empty());
+  EXPECT_TRUE(noDelta.mplsRoutesToUpdate.empty());
+  EXPECT_TRUE(noDelta.mplsRoutesToDelete.empty());
+}
+
 TEST(UtilTest, MplsActionValidate) {
   //
   // PHP
@@ -922,6 +1046,25 @@ TEST(UtilTest, AddJitter) {
       t2_jitter_s <= (1 + pct / 100.0) * t2_jitter_s);
 }
 
+TEST(UtilTest, PackedPrefixMetrics) {
+  const auto packed = [](int32_t pp, int32_t sp, int32_t d) {
+    return PackedPrefixMetrics(createMetrics(pp, sp, d));
+  };
+  // path preference first, then source preference, both prefer-higher
+  EXPECT_GT(packed(200, 0, 10).compare(packed(100, 1000, 0)), 0);
+  EXPECT_GT(packed(100, 200, 10).compare(packed(100, 100, 0)), 0);
+  // distance last, prefer-lower
+  EXPECT_GT(packed(100, 100, 0).compare(packed(100, 100, 10)), 0);
+  EXPECT_EQ(0, packed(100, 100, 10).compare(packed(100, 100, 10)));
+  // order of negative preferences is preserved
+  EXPECT_GT(packed(-1, 0, 0).compare(packed(-2, 0, 0)), 0);
+  EXPECT_GT(packed(0, -1, 0).compare(packed(-1, 100, 0)), 0);
+  EXPECT_LT(
+      packed(std::numeric_limits<int32_t>::min(), 0, 0)
+          .compare(packed(0, std::numeric_limits<int32_t>::min(), 0)),
+      0);
+}
+
 TEST(UtilTest, BestMetricsSelection) {
   //
   // No entry. Returns empty set
@@ -1265,6 +1408,31 @@ TEST(UtilTest, ThriftValueConstruction) {
   EXPECT_EQ(thriftVal.hash_ref().value(), hash);
 }
 
+TEST(UtilTest, GenerateHashSchemeTest) {
+  const std::optional<std::string> value{std::string(10000, 'v')};
+  const auto boostHash = generateHash(1, "node1", value);
+  const auto spookyHash =
+      generateHash(1, "node1", value, thrift::KvStoreHashScheme::SPOOKY_V2);
+
+  // default scheme stays backward compatible
+  EXPECT_EQ(
+      boostHash,
+      generateHash(
+          1, "node1", value, thrift::KvStoreHashScheme::BOOST_HASH_COMBINE));
+  EXPECT_NE(boostHash, spookyHash);
+
+  // deterministic and covers every attribute of the tuple
+  const auto scheme = thrift::KvStoreHashScheme::SPOOKY_V2;
+  EXPECT_EQ(spookyHash, generateHash(1, "node1", value, scheme));
+  EXPECT_NE(spookyHash, generateHash(2, "node1", value, scheme));
+  EXPECT_NE(spookyHash, generateHash(1, "node2", value, scheme));
+  const std::optional<std::string> otherValue{std::string(10000, 'w')};
+  EXPECT_NE(spookyHash, generateHash(1, "node1", otherValue, scheme));
+  EXPECT_NE(
+      spookyHash,
+      generateHash(1, "node1", std::optional<std::string>(), scheme));
+}
+
 TEST(UtilTest, logInitializationEvent) {
   logInitializationEvent("Main", thrift::InitializationEvent::AGENT_CONFIGURED);
   EXPECT_TRUE(facebook::fb303::fbData->hasCounter(
@@ -1278,6 +1446,105 @@ TEST(UtilTest, logInitializationEvent) {
       "this is a message.");
   EXPECT_TRUE(facebook::fb303::fbData->hasCounter(
       "initialization.KVSTORE_SYNCED.duration_ms"));
+
+  // Measured from recorded start time rather than from the first event
+  setOpenrStartTime(std::chrono::steady_clock::now() - std::chrono::seconds(5));
+  logInitializationEvent("Main", thrift::InitializationEvent::CONFIG_LOADED);
+  EXPECT_LE(
+      5000,
+      facebook::fb303::fbData->getCounter(
+          "initialization.CONFIG_LOADED.duration_ms"));
+}
+
+TEST(UtilTest, UnicastRouteDigestTest) {
+  const auto nh1 =
+      createNextHop(toBinaryAddress("fe80::1"), "eth1", 0, std::nullopt);
+  const auto nh2 =
+      createNextHop(toBinaryAddress("fe80::2"), "eth2", 0, std::nullopt);
+  const auto route = createUnicastRoute(prefix1, {nh1, nh2});
+
+  // Digest is independent of nexthop order and never zero
+  const auto digest = getUnicastRouteDigest(route);
+  EXPECT_NE(0, digest);
+  EXPECT_EQ(
+      digest, getUnicastRouteDigest(createUnicastRoute(prefix1, {nh2, nh1})));
+
+  // Weight 0 and 1 both mean equal share
+  auto weightedNh1 = nh1;
+  weightedNh1.weight_ref() = 1;
+  EXPECT_EQ(
+      digest,
+      getUnicastRouteDigest(createUnicastRoute(prefix1, {weightedNh1, nh2})));
+  weightedNh1.weight_ref() = 2;
+  EXPECT_NE(
+      digest,
+      getUnicastRouteDigest(createUnicastRoute(prefix1, {weightedNh1, nh2})));
+
+  // Destination and nexthops are part of digest
+  EXPECT_NE(
+      digest, getUnicastRouteDigest(createUnicastRoute(prefix2, {nh1, nh2})));
+  EXPECT_NE(digest, getUnicastRouteDigest(createUnicastRoute(prefix1, {nh1})));
+
+  // Range digest is summary of all routes in range. Any route with unknown
+  // (zero) digest marks the range as unknown.
+  const int32_t kNumRanges = 1;
+  const auto network1 = toIPNetwork(prefix1);
+  const auto network2 = toIPNetwork(prefix2);
+  ASSERT_EQ(0, getPrefixRange(network1, kNumRanges));
+  std::unordered_map<folly::CIDRNetwork, uint64_t> routeDigests{
+      {network1, digest}, {network2, 10}};
+  auto rangeDigests = getUnicastRouteRangeDigests(routeDigests, kNumRanges);
+  ASSERT_EQ(1, rangeDigests.size());
+  EXPECT_EQ(static_cast<int64_t>(digest + 10), rangeDigests.at(0));
+
+  routeDigests[network2] = 0;
+  rangeDigests = getUnicastRouteRangeDigests(routeDigests, kNumRanges);
+  EXPECT_EQ(0, rangeDigests.at(0));
+}
+
+// [Key Prefix Match] literal prefixes and regexes of the same set
+TEST(UtilTest, RegexSetTest) {
+  EXPECT_TRUE(RegexSet::isLiteralPrefix("adj:node-1_a"));
+  EXPECT_FALSE(RegexSet::isLiteralPrefix("adj:.*"));
+  EXPECT_FALSE(RegexSet::isLiteralPrefix("prefix:[0-9]+"));
+
+  // "ab" is covered by "a" and must not hide it from "ac"
+  RegexSet literalSet({"a", "ab", "b:x", "b:y"});
+  EXPECT_TRUE(literalSet.match("a"));
+  EXPECT_TRUE(literalSet.match("abc"));
+  EXPECT_TRUE(literalSet.match("ac"));
+  EXPECT_TRUE(literalSet.match("b:y1"));
+  EXPECT_FALSE(literalSet.match(""));
+  EXPECT_FALSE(literalSet.match("b:"));
+  EXPECT_FALSE(literalSet.match("b:z"));
+  EXPECT_FALSE(literalSet.match("c"));
+
+  // Regexes stay anchored at the start of the key
+  RegexSet mixedSet({"adj:", "prefix:node[0-9]+:"});
+  EXPECT_TRUE(mixedSet.match("adj:node1"));
+  EXPECT_TRUE(mixedSet.match("prefix:node12:area"));
+  EXPECT_FALSE(mixedSet.match("prefix:nodeA:area"));
+  EXPECT_FALSE(mixedSet.match("x:adj:node1"));
+
+  EXPECT_TRUE(RegexSet({""}).match("anything"));
+}
+
+// [Memory Arenas] allocations of the thread go to its own arena
+TEST(UtilTest, MemoryArenaTest) {
+  unsigned arena{0};
+  try {
+    arena = memory::createArena(true /* hugePages */);
+  } catch (const std::runtime_error&) {
+    GTEST_SKIP() << "jemalloc arenas are not supported";
+  }
+  memory::setThreadArena(arena);
+  unsigned threadArena{0};
+  folly::mallctlRead("thread.arena", &threadArena);
+  EXPECT_EQ(arena, threadArena);
+
+  // extents spanning huge pages are allocated through the hooks of the arena
+  std::vector<char> table(2 * Constants::kHugePageSize, 'x');
+  EXPECT_EQ('x', table.back());
 }
 
 int
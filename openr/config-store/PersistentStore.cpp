@@ -5,9 +5,18 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+
+#include <fmt/format.h>
 #include <folly/FileUtil.h>
+#include <folly/compression/Compression.h>
+#include <folly/hash/Checksum.h>
 #include <folly/io/IOBuf.h>
+#include <folly/lang/Bits.h>
 #include <folly/logging/xlog.h>
+#include <folly/system/MemoryMapping.h>
 
 #include <openr/common/Util.h>
 #include <openr/config-store/PersistentStore.h>
@@ -17,18 +26,222 @@ using std::exception;
 
 namespace {
 
-static const long kDbFlushRatio = 10000;
+// Log is compacted once bytes appended since last snapshot exceed this ratio
+// of snapshot size, and at least kMinCompactionBytes
+static const uint64_t kCompactionRatio = 4;
+static const uint64_t kMinCompactionBytes = 64 * 1024;
 
 } // anonymous namespace
 
 namespace openr {
 
+namespace {
+
+/**
+ * Compress encoded objects into a single BLOCK object. Returns nullptr if
+ * compression doesn't save any space.
+ */
+std::unique_ptr<folly::IOBuf>
+compressObjects(const folly::IOBuf& objects, folly::io::Codec& codec) {
+  const auto length = objects.computeChainDataLength();
+  auto compressed = codec.compress(&objects);
+  if (compressed->computeChainDataLength() + sizeof(uint32_t) >= length) {
+    return nullptr;
+  }
+
+  PersistentObject block;
+  block.type = ActionType::BLOCK;
+  block.data = std::string(sizeof(uint32_t), '\0');
+  const auto lengthBE = folly::Endian::big(static_cast<uint32_t>(length));
+  std::memcpy(block.data->data(), &lengthBE, sizeof(lengthBE));
+  block.data->append(compressed->moveToFbString().toStdString());
+  auto buf = PersistentStore::encodePersistentObject(block);
+  if (buf.hasError()) {
+    throw std::runtime_error(buf.error());
+  }
+  return std::move(*buf);
+}
+
+/**
+ * Encode and append `pObjects` to queue followed by their COMMIT record.
+ * Objects are compressed together into a BLOCK if `codec` is set.
+ */
+folly::Expected<folly::Unit, std::string>
+appendCommittedObjects(
+    folly::IOBufQueue& queue,
+    const std::vector<PersistentObject>& pObjects,
+    folly::io::Codec* codec = nullptr) noexcept {
+  folly::IOBufQueue objects(folly::IOBufQueue::cacheChainLength());
+  for (const auto& pObject : pObjects) {
+    auto buf = PersistentStore::encodePersistentObject(pObject);
+    if (buf.hasError()) {
+      return folly::makeUnexpected(buf.error());
+    }
+    objects.append(std::move(*buf));
+  }
+  auto payload = objects.move();
+  if (payload and codec) {
+    try {
+      if (auto block = compressObjects(*payload, *codec)) {
+        payload = std::move(block);
+      }
+    } catch (std::exception const& e) {
+      return folly::makeUnexpected<std::string>(
+          folly::exceptionStr(e).toStdString());
+    }
+  }
+
+  // Checksum covers the BLOCK rather than objects it holds
+  uint32_t checksum{0};
+  if (payload) {
+    for (const auto range : *payload) {
+      checksum = folly::crc32c(range.data(), range.size(), checksum);
+    }
+    queue.append(std::move(payload));
+  }
+
+  PersistentObject commit;
+  commit.type = ActionType::COMMIT;
+  commit.data = std::string(sizeof(checksum), '\0');
+  const auto checksumBE = folly::Endian::big(checksum);
+  std::memcpy(commit.data->data(), &checksumBE, sizeof(checksumBE));
+  auto buf = PersistentStore::encodePersistentObject(commit);
+  if (buf.hasError()) {
+    return folly::makeUnexpected(buf.error());
+  }
+  queue.append(std::move(*buf));
+  return folly::Unit();
+}
+
+/**
+ * Append 'kTlvFormatMarker' followed by HEADER object, which start every file.
+ */
+folly::Expected<folly::Unit, std::string>
+appendFileHeader(folly::IOBufQueue& queue) noexcept {
+  queue.append(kTlvFormatMarker.data(), kTlvFormatMarker.size());
+
+  PersistentObject header;
+  header.type = ActionType::HEADER;
+  header.data = std::string(sizeof(kLogFormatVersion), '\0');
+  const auto versionBE = folly::Endian::big(kLogFormatVersion);
+  std::memcpy(header.data->data(), &versionBE, sizeof(versionBE));
+  auto buf = PersistentStore::encodePersistentObject(header);
+  if (buf.hasError()) {
+    return folly::makeUnexpected(buf.error());
+  }
+  queue.append(std::move(*buf));
+  return folly::Unit();
+}
+
+/**
+ * PersistentObject referring to its data in the file rather than owning it.
+ */
+struct PersistentObjectRef {
+  ActionType type;
+  std::string key;
+  folly::ByteRange data;
+};
+
+/**
+ * Same as `PersistentStore::decodePersistentObject()`, without copying data.
+ * Cursor must be on a contiguous buffer.
+ */
+folly::Expected<std::optional<PersistentObjectRef>, std::string>
+decodePersistentObjectRef(folly::io::Cursor& cursor) noexcept {
+  // If nothing can be read, return
+  if (not cursor.canAdvance(1)) {
+    return std::nullopt;
+  }
+
+  PersistentObjectRef pObject;
+  try {
+    // Read 'type'
+    pObject.type = ActionType(cursor.readBE<uint8_t>());
+    // Read key length and key
+    auto length = cursor.readBE<uint32_t>();
+    pObject.key = cursor.readFixedString(length);
+
+    // Read data length and refer to data
+    length = cursor.readBE<uint32_t>();
+    if (cursor.length() < length) {
+      throw std::out_of_range("underflow");
+    }
+    pObject.data = folly::ByteRange(cursor.data(), length);
+    cursor.skip(length);
+    return pObject;
+  } catch (std::out_of_range& e) {
+    return folly::makeUnexpected<std::string>(
+        folly::exceptionStr(e).toStdString());
+  }
+}
+
+/**
+ * Decompress BLOCK `data` into `blocks`, and decode the objects it holds.
+ * Decoded objects refer to the decompressed buffer.
+ */
+folly::Expected<std::vector<PersistentObjectRef>, std::string>
+decodeBlock(
+    folly::ByteRange data,
+    std::vector<std::unique_ptr<folly::IOBuf>>& blocks) noexcept {
+  try {
+    if (not folly::io::hasCodec(folly::io::CodecType::ZSTD)) {
+      return folly::makeUnexpected<std::string>(
+          "zstd is not available to decompress block");
+    }
+    if (data.size() < sizeof(uint32_t)) {
+      throw std::out_of_range("underflow");
+    }
+    uint32_t length{0};
+    std::memcpy(&length, data.data(), sizeof(length));
+    length = folly::Endian::big(length);
+    data.advance(sizeof(length));
+
+    auto codec = folly::io::getCodec(folly::io::CodecType::ZSTD);
+    auto compressed = folly::IOBuf::wrapBuffer(data);
+    auto buf = codec->uncompress(compressed.get(), length);
+    buf->coalesce();
+
+    std::vector<PersistentObjectRef> pObjects;
+    folly::io::Cursor cursor(buf.get());
+    while (true) {
+      auto optionalObject = decodePersistentObjectRef(cursor);
+      if (optionalObject.hasError()) {
+        return folly::makeUnexpected(optionalObject.error());
+      }
+      if (not optionalObject->has_value()) {
+        break;
+      }
+      auto& pObject = optionalObject->value();
+      if (pObject.type != ActionType::ADD and pObject.type != ActionType::DEL) {
+        return folly::makeUnexpected<std::string>(
+            "unexpected object type in block");
+      }
+      pObjects.emplace_back(std::move(pObject));
+    }
+    blocks.emplace_back(std::move(buf));
+    return pObjects;
+  } catch (std::exception const& e) {
+    return folly::makeUnexpected<std::string>(
+        folly::exceptionStr(e).toStdString());
+  }
+}
+
+} // namespace
+
 PersistentStore::PersistentStore(
     std::shared_ptr<const Config> config,
     bool dryrun,
     bool periodicallySaveToDisk)
     : storageFilePath_(*config->getConfig().persistent_config_store_path_ref()),
       dryrun_(dryrun) {
+  if (config->isPersistentStoreCompressionEnabled()) {
+    if (folly::io::hasCodec(folly::io::CodecType::ZSTD)) {
+      codec_ = folly::io::getCodec(folly::io::CodecType::ZSTD);
+    } else {
+      XLOG(ERR) << "zstd is not available, persistent store is uncompressed";
+    }
+  }
+
   if (periodicallySaveToDisk) {
     // Create timer and backoff mechanism only if backoff is requested
     saveDbTimerBackoff_ =
@@ -54,6 +267,7 @@ PersistentStore::PersistentStore(
     XLOG(ERR) << "Failed to load config-database from file: "
               << storageFilePath_;
   }
+  publishReadView();
 }
 
 PersistentStore::~PersistentStore() {
@@ -68,18 +282,46 @@ PersistentStore::store(std::string key, std::string value) {
                         p = std::move(p),
                         key = std::move(key),
                         value = std::move(value)]() mutable noexcept {
-    SYSLOG(INFO) << "Store key: " << key << ", value: " << value
-                 << " to config-store";
-    // Override previous value if any
-    database_.insert_or_assign(key, value);
-    auto pObject = toPersistentObject(ActionType::ADD, key, value);
-    pObjects_.emplace_back(std::move(pObject));
+    storeImpl(std::move(key), std::move(value));
+    publishReadView();
+    maybeSaveObjectToDisk();
+    p.setValue();
+  });
+  return sf;
+}
+
+folly::SemiFuture<folly::Unit>
+PersistentStore::storeMany(
+    std::vector<std::pair<std::string, std::string>> keyVals) {
+  folly::Promise<folly::Unit> p;
+  auto sf = p.getSemiFuture();
+  runInEventBaseThread([this,
+                        p = std::move(p),
+                        keyVals = std::move(keyVals)]() mutable noexcept {
+    for (auto& [key, value] : keyVals) {
+      storeImpl(std::move(key), std::move(value));
+    }
+    publishReadView();
+    // ATTN: all objects are committed together
     maybeSaveObjectToDisk();
     p.setValue();
   });
   return sf;
 }
 
+void
+PersistentStore::storeImpl(std::string key, std::string value) {
+  SYSLOG(INFO) << "Store key: " << key << ", value: " << value
+               << " to config-store";
+  numOfPayloadBytes_ += key.size() + value.size();
+  // Override previous value if any
+  lazyValues_.erase(key);
+  maybeReleaseMapping();
+  auto pObject = toPersistentObject(ActionType::ADD, key, value);
+  pObjects_.emplace_back(std::move(pObject));
+  database_.insert_or_assign(std::move(key), std::move(value));
+}
+
 folly::SemiFuture<bool>
 PersistentStore::erase(std::string key) {
   folly::Promise<bool> p;
@@ -87,7 +329,11 @@ PersistentStore::erase(std::string key) {
   runInEventBaseThread(
       [this, p = std::move(p), key = std::move(key)]() mutable noexcept {
         SYSLOG(INFO) << "Erase key: " << key << " from config-store";
-        if (database_.erase(key) > 0) {
+        const auto erased = database_.erase(key) + lazyValues_.erase(key);
+        maybeReleaseMapping();
+        if (erased > 0) {
+          publishReadView();
+          numOfPayloadBytes_ += key.size();
           auto pObject = toPersistentObject(ActionType::DEL, key, "");
           pObjects_.emplace_back(std::move(pObject));
           maybeSaveObjectToDisk();
@@ -100,22 +346,73 @@ PersistentStore::erase(std::string key) {
   return sf;
 }
 
+folly::SemiFuture<bool>
+PersistentStore::sync() {
+  folly::Promise<bool> p;
+  auto sf = p.getSemiFuture();
+  runInEventBaseThread([this, p = std::move(p)]() mutable noexcept {
+    if (saveDbTimer_) {
+      saveDbTimer_->cancelTimeout();
+    }
+    p.setValue(savePersistentObjectToDisk());
+  });
+  return sf;
+}
+
 folly::SemiFuture<std::optional<std::string>>
 PersistentStore::load(std::string key) {
   folly::Promise<std::optional<std::string>> p;
   auto sf = p.getSemiFuture();
   runInEventBaseThread(
       [this, p = std::move(p), key = std::move(key)]() mutable {
-        auto it = database_.find(key);
-        if (it != database_.end()) {
-          p.setValue(it->second);
-        } else {
-          p.setValue(std::nullopt);
+        p.setValue(findValue(key));
+      });
+  return sf;
+}
+
+folly::SemiFuture<std::vector<std::optional<std::string>>>
+PersistentStore::loadMany(std::vector<std::string> keys) {
+  folly::Promise<std::vector<std::optional<std::string>>> p;
+  auto sf = p.getSemiFuture();
+  runInEventBaseThread(
+      [this, p = std::move(p), keys = std::move(keys)]() mutable {
+        std::vector<std::optional<std::string>> values;
+        values.reserve(keys.size());
+        for (const auto& key : keys) {
+          values.emplace_back(findValue(key));
         }
+        p.setValue(std::move(values));
       });
   return sf;
 }
 
+std::optional<std::string>
+PersistentStore::loadSync(const std::string& key) const {
+  const auto readView = std::atomic_load(&readView_);
+  if (not readView) {
+    return std::nullopt;
+  }
+  if (auto it = readView->values.find(key); it != readView->values.end()) {
+    return it->second;
+  }
+  if (auto it = readView->lazyValues.find(key);
+      it != readView->lazyValues.end()) {
+    return it->second.toString();
+  }
+  return std::nullopt;
+}
+
+void
+PersistentStore::publishReadView() {
+  auto readView = std::make_shared<ReadView>();
+  readView->values = database_;
+  readView->lazyValues = lazyValues_;
+  readView->mapping = mapping_;
+  readView->blocks = blocks_;
+  std::atomic_store(
+      &readView_, std::shared_ptr<const ReadView>(std::move(readView)));
+}
+
 void
 PersistentStore::maybeSaveObjectToDisk() noexcept {
   if (not saveDbTimerBackoff_) {
@@ -130,48 +427,47 @@ PersistentStore::maybeSaveObjectToDisk() noexcept {
 
 bool
 PersistentStore::savePersistentObjectToDisk() noexcept {
+  if (pObjects_.empty()) {
+    return true;
+  }
   if (not dryrun_) {
-    // Write PersistentObject to ioBuf
-    std::vector<PersistentObject> newObjects;
-    newObjects = std::move(pObjects_);
-
+    // Group commit of all pending PersistentObjects: single append & fsync
     auto queue = folly::IOBufQueue(folly::IOBufQueue::cacheChainLength());
-
-    for (auto& pObject : newObjects) {
-      auto buf = encodePersistentObject(pObject);
-      if (buf.hasError()) {
-        XLOG(ERR) << "Failed to encode PersistentObject to ioBuf. Error: "
-                  << buf.error();
-        return false;
-      }
-      queue.append(std::move(**buf));
+    auto encoded = appendCommittedObjects(queue, pObjects_, codec_.get());
+    if (encoded.hasError()) {
+      XLOG(ERR) << "Failed to encode PersistentObject to ioBuf. Error: "
+                << encoded.error();
+      return false;
     }
 
-    // Append IoBuf to disk
+    // Append IoBuf to disk. Objects are kept for retry on failure.
     auto ioBuf = queue.move();
+    const auto numBytes = ioBuf->computeChainDataLength();
     auto success = writeIoBufToDisk(ioBuf, WriteType::APPEND);
     if (success.hasError()) {
       XLOG(ERR) << "Failed to write PersistentObject to file '"
                 << storageFilePath_ << "'. Error: " << success.error();
       return false;
     }
+    pObjects_.clear();
+    logBytes_ += numBytes;
 
-    numOfNewWritesToDisk_++;
-
-    // Write the whole database to disk periodically
-    if (numOfNewWritesToDisk_ >= kDbFlushRatio) {
-      numOfNewWritesToDisk_ = 0;
+    // Compact log into a snapshot of the database once it grows too large
+    if (logBytes_ >
+        kCompactionRatio * std::max(snapshotBytes_, kMinCompactionBytes)) {
       const auto startTs = std::chrono::steady_clock::now();
       if (not saveDatabaseToDisk()) {
         return false;
       }
-      XLOG(INFO) << "Updated database on disk. Took "
+      numOfCompactions_++;
+      XLOG(INFO) << "Compacted database on disk. Took "
                  << std::chrono::duration_cast<std::chrono::milliseconds>(
                         std::chrono::steady_clock::now() - startTs)
                         .count()
                  << "ms";
     }
   } else {
+    pObjects_.clear();
     XLOG(DBG1) << "Skipping writing to disk in dryrun mode";
   }
   numOfWritesToDisk_++;
@@ -181,90 +477,182 @@ PersistentStore::savePersistentObjectToDisk() noexcept {
 
 bool
 PersistentStore::saveDatabaseToDisk() noexcept {
-  std::unique_ptr<folly::IOBuf> ioBuf;
-  // If database is empty, write 'kTlvFormatMarker' to disk and return
-  if (database_.empty()) {
-    ioBuf = folly::IOBuf::copyBuffer(
-        kTlvFormatMarker.data(), kTlvFormatMarker.size());
-  } else {
-    // Append kTlvFormatMarker to queue
-    auto queue = folly::IOBufQueue(folly::IOBufQueue::cacheChainLength());
-    queue.append(kTlvFormatMarker.data(), kTlvFormatMarker.size());
-
-    // Encode database_ and append to queue
+  // Snapshot is file header followed by database_ as one commit.
+  // Pending objects are part of database_ already. Values not decoded yet
+  // are copied from the mapping, which remains valid after file is replaced.
+  auto queue = folly::IOBufQueue(folly::IOBufQueue::cacheChainLength());
+  auto header = appendFileHeader(queue);
+  if (header.hasError()) {
+    XLOG(ERR) << "Failed to encode file header. Error: " << header.error();
+    return false;
+  }
+  if (not database_.empty() or not lazyValues_.empty()) {
+    std::vector<PersistentObject> pObjects;
+    pObjects.reserve(database_.size() + lazyValues_.size());
     for (auto& keyPair : database_) {
-      PersistentObject pObject;
-      pObject =
-          toPersistentObject(ActionType::ADD, keyPair.first, keyPair.second);
-
-      auto buf = encodePersistentObject(pObject);
-      if (buf.hasError()) {
-        XLOG(ERR) << "Failed to encode PersistentObject to ioBuf. Error:  "
-                  << buf.error();
-        return false;
-      }
-      queue.append(std::move(*buf));
+      pObjects.emplace_back(
+          toPersistentObject(ActionType::ADD, keyPair.first, keyPair.second));
+    }
+    for (auto& [key, value] : lazyValues_) {
+      pObjects.emplace_back(
+          toPersistentObject(ActionType::ADD, key, value.toString()));
+    }
+    auto encoded = appendCommittedObjects(queue, pObjects, codec_.get());
+    if (encoded.hasError()) {
+      XLOG(ERR) << "Failed to encode PersistentObject to ioBuf. Error:  "
+                << encoded.error();
+      return false;
     }
-    // Write queue to disk
-    ioBuf = queue.move();
   }
 
+  // Write queue to disk
+  auto ioBuf = queue.move();
+  const auto numBytes = ioBuf->computeChainDataLength();
   auto success = writeIoBufToDisk(ioBuf, WriteType::WRITE);
   if (success.hasError()) {
     XLOG(ERR) << "Failed to write database to file '" << storageFilePath_
               << "'. Error: " << success.error();
     return false;
   }
+  pObjects_.clear();
+  snapshotBytes_ = numBytes;
+  logBytes_ = 0;
   return true;
 }
 
+void
+PersistentStore::keepUnrecoverableFileAside() noexcept {
+  if (dryrun_) {
+    return;
+  }
+  const auto asidePath =
+      fmt::format("{}{}", storageFilePath_.string(), kUnrecoverableFileSuffix);
+  std::error_code ec;
+  fs::rename(storageFilePath_, asidePath, ec);
+  if (ec) {
+    XLOG(ERR) << "Failed to move unrecoverable file '" << storageFilePath_
+              << "' aside. Error: " << ec.message()
+              << ". Disabling writes to disk";
+    diskWritesDisabled_ = true;
+    return;
+  }
+  XLOG(ERR) << "Moved unrecoverable file '" << storageFilePath_ << "' to '"
+            << asidePath << "'. Starting with empty database";
+  saveDatabaseToDisk();
+}
+
 bool
 PersistentStore::loadDatabaseFromDisk() noexcept {
   // Check if file exists
   if (not fs::exists(storageFilePath_)) {
     XLOG(INFO) << "Storage file " << storageFilePath_ << " doesn't exists. "
                << "Starting with empty database";
-    return true;
+    // Start the log with header, commits are appended to it
+    return dryrun_ or saveDatabaseToDisk();
   }
 
-  // Read data from file
-  std::string fileData{""};
-  if (not folly::readFile(storageFilePath_.c_str(), fileData)) {
-    XLOG(ERR) << "Failed to read file contents from '" << storageFilePath_
-              << "'. Error (" << errno << "): " << folly::errnoStr(errno);
+  // Map file instead of reading it, values are decoded on first load. File
+  // is only ever appended to or replaced by rename, so mapping stays valid.
+  try {
+    mapping_ = std::make_shared<folly::MemoryMapping>(storageFilePath_.c_str());
+  } catch (std::exception const& e) {
+    XLOG(ERR) << "Failed to map file '" << storageFilePath_
+              << "'. Error: " << folly::exceptionStr(e);
     return false;
   }
 
-  // Create IoBuf and cursor for loading data from disk (TlvFormat)
-  auto ioBuf = folly::IOBuf::wrapBuffer(fileData.c_str(), fileData.size());
-  auto tlvSuccess = loadDatabaseTlvFormat(ioBuf);
+  bool needsRewrite{false};
+  auto tlvSuccess = loadDatabaseTlvFormat(mapping_->range(), needsRewrite);
   if (tlvSuccess.hasError()) {
     XLOG(ERR) << "Failed to read Tlv-format file contents from '"
               << storageFilePath_ << "'. Error: " << tlvSuccess.error();
+    mapping_.reset();
+    blocks_.reset();
+    keepUnrecoverableFileAside();
     return false;
   }
+  snapshotBytes_ = mapping_->range().size();
+  maybeReleaseMapping();
+
+  // Drop torn tail, or convert file of older format, so that new commits are
+  // appended to a valid log
+  if (needsRewrite and not dryrun_) {
+    XLOG(INFO) << "Rewriting database file " << storageFilePath_;
+    return saveDatabaseToDisk();
+  }
   return true;
 }
 
 folly::Expected<folly::Unit, std::string>
 PersistentStore::loadDatabaseTlvFormat(
-    const std::unique_ptr<folly::IOBuf>& ioBuf) noexcept {
-  // Parse ioBuf to persistentObject and then to `database_`
+    folly::ByteRange fileData, bool& needsRewrite) noexcept {
+  // Parse file into key to value index. Values are not copied.
+  auto ioBuf = folly::IOBuf::wrapBuffer(fileData);
   folly::io::Cursor cursor(ioBuf.get());
-  std::unordered_map<std::string, std::string> newDatabase;
+  std::unordered_map<std::string, folly::ByteRange> newIndex;
+  // Decompressed blocks, `newIndex` may refer to their data
+  auto newBlocks =
+      std::make_shared<std::vector<std::unique_ptr<folly::IOBuf>>>();
   // Read 'kTlvFormatMarker'
   try {
-    cursor.readFixedString(kTlvFormatMarker.size());
+    if (cursor.readFixedString(kTlvFormatMarker.size()) != kTlvFormatMarker) {
+      return folly::makeUnexpected<std::string>("missing format marker");
+    }
   } catch (std::out_of_range& e) {
     return folly::makeUnexpected<std::string>(
         folly::exceptionStr(e).toStdString());
   }
+
+  // Read HEADER of log format, if any. File without it is of older format,
+  // where every object is applied as it is read.
+  bool isLog{false};
+  {
+    folly::io::Cursor headerCursor(cursor);
+    auto header = decodePersistentObjectRef(headerCursor);
+    if (header.hasValue() and header->has_value() and
+        header->value().type == ActionType::HEADER) {
+      uint32_t version{0};
+      if (header->value().data.size() != sizeof(version)) {
+        return folly::makeUnexpected<std::string>("malformed format header");
+      }
+      std::memcpy(&version, header->value().data.data(), sizeof(version));
+      version = folly::Endian::big(version);
+      if (version != kLogFormatVersion) {
+        return folly::makeUnexpected(
+            fmt::format("unsupported format version {}", version));
+      }
+      isLog = true;
+      cursor = headerCursor;
+    }
+  }
+
+  const auto applyObject = [&newIndex](PersistentObjectRef&& pObject) {
+    // Add/Delete persistentObject to/from 'newIndex'
+    if (pObject.type == ActionType::ADD) {
+      newIndex.insert_or_assign(std::move(pObject.key), pObject.data);
+    } else if (pObject.type == ActionType::DEL) {
+      newIndex.erase(pObject.key);
+    }
+  };
+
+  // Objects of log are applied once their commit is validated
+  std::vector<PersistentObjectRef> uncommitted;
+  bool tornTail{false};
+  uint32_t checksum{0};
   // Iteratively read persistentObject from disk
   while (true) {
     // Read and decode into persistentObject
-    auto optionalObject = decodePersistentObject(cursor);
+    const auto start = cursor.getCurrentPosition();
+    auto optionalObject = decodePersistentObjectRef(cursor);
     if (optionalObject.hasError()) {
-      return folly::makeUnexpected(optionalObject.error());
+      if (not isLog) {
+        return folly::makeUnexpected(optionalObject.error());
+      }
+      // incomplete object at the tail, e.g. crash while appending
+      XLOG(WARNING) << "Dropping incomplete object at offset " << start
+                    << ". Error: " << optionalObject.error();
+      tornTail = true;
+      break;
     }
 
     // Read finish
@@ -272,23 +660,104 @@ PersistentStore::loadDatabaseTlvFormat(
       break;
     }
     auto pObject = std::move(optionalObject->value());
+    if (not isLog) {
+      if (pObject.type != ActionType::ADD and pObject.type != ActionType::DEL) {
+        return folly::makeUnexpected(fmt::format(
+            "unexpected object of type {} in file of older format at offset {}",
+            static_cast<int>(pObject.type),
+            start));
+      }
+      applyObject(std::move(pObject));
+      continue;
+    }
+    if (pObject.type != ActionType::COMMIT) {
+      checksum = folly::crc32c(
+          fileData.data() + start,
+          cursor.getCurrentPosition() - start,
+          checksum);
+      uncommitted.emplace_back(std::move(pObject));
+      continue;
+    }
 
-    // Add/Delete persistentObject to/from 'newDatabase'
-    if (pObject.type == ActionType::ADD) {
-      newDatabase.insert_or_assign(
-          pObject.key, pObject.data.has_value() ? pObject.data.value() : "");
-    } else if (pObject.type == ActionType::DEL) {
-      newDatabase.erase(pObject.key);
+    uint32_t expected{0};
+    if (pObject.data.size() == sizeof(expected)) {
+      std::memcpy(&expected, pObject.data.data(), sizeof(expected));
+      expected = folly::Endian::big(expected);
     }
+    if (pObject.data.size() != sizeof(expected) or expected != checksum) {
+      XLOG(WARNING) << "Dropping " << uncommitted.size()
+                    << " objects of corrupted commit at offset " << start;
+      uncommitted.clear();
+      tornTail = true;
+      break;
+    }
+    checksum = 0;
+    for (auto& committed : uncommitted) {
+      if (committed.type != ActionType::BLOCK) {
+        applyObject(std::move(committed));
+        continue;
+      }
+      // Block passed the checksum, failing to decode it is not a torn tail
+      // and file must be left as is
+      auto blockObjects = decodeBlock(committed.data, *newBlocks);
+      if (blockObjects.hasError()) {
+        return folly::makeUnexpected(fmt::format(
+            "Failed to decode block of commit at offset {}: {}",
+            start,
+            blockObjects.error()));
+      }
+      for (auto& blockObject : *blockObjects) {
+        applyObject(std::move(blockObject));
+      }
+    }
+    uncommitted.clear();
   }
-  database_ = std::move(newDatabase);
+
+  if (uncommitted.size()) {
+    XLOG(WARNING) << "Dropping " << uncommitted.size()
+                  << " objects without commit";
+    tornTail = true;
+  }
+  needsRewrite = tornTail or not isLog;
+  database_.clear();
+  lazyValues_ = std::move(newIndex);
+  blocks_ = std::move(newBlocks);
   return folly::Unit();
 }
 
+std::optional<std::string>
+PersistentStore::findValue(const std::string& key) {
+  if (auto it = database_.find(key); it != database_.end()) {
+    return it->second;
+  }
+  auto it = lazyValues_.find(key);
+  if (it == lazyValues_.end()) {
+    return std::nullopt;
+  }
+  // Decode value on first access
+  auto value = it->second.toString();
+  lazyValues_.erase(it);
+  database_.emplace(key, value);
+  maybeReleaseMapping();
+  return value;
+}
+
+void
+PersistentStore::maybeReleaseMapping() noexcept {
+  if (lazyValues_.empty()) {
+    mapping_.reset();
+    blocks_.reset();
+  }
+}
+
 // Write over or append IoBuf to disk atomically
 folly::Expected<folly::Unit, std::string>
 PersistentStore::writeIoBufToDisk(
     const std::unique_ptr<folly::IOBuf>& ioBuf, WriteType writeType) noexcept {
+  if (diskWritesDisabled_) {
+    return folly::makeUnexpected<std::string>(
+        "file can not be recovered, refusing to write over it");
+  }
   std::string fileData("");
   try {
     ioBuf->coalesce();
@@ -298,17 +767,30 @@ PersistentStore::writeIoBufToDisk(
       // Write over
       folly::writeFileAtomic(storageFilePath_.c_str(), fileData, 0666);
     } else {
-      // Append to file
-      folly::writeFile(
-          fileData,
-          storageFilePath_.c_str(),
-          O_WRONLY | O_APPEND | O_CREAT,
-          0666);
+      // Append to file and sync, commit is durable once this returns
+      const int fd = folly::openNoInt(
+          storageFilePath_.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0666);
+      if (fd == -1) {
+        return folly::makeUnexpected<std::string>(folly::errnoStr(errno));
+      }
+      const auto written =
+          folly::writeFull(fd, fileData.data(), fileData.size());
+      const int writeErrno = errno;
+      const bool synced = written >= 0 and ::fdatasync(fd) == 0;
+      const int syncErrno = errno;
+      folly::closeNoInt(fd);
+      if (written < 0 or static_cast<size_t>(written) != fileData.size()) {
+        return folly::makeUnexpected<std::string>(folly::errnoStr(writeErrno));
+      }
+      if (not synced) {
+        return folly::makeUnexpected<std::string>(folly::errnoStr(syncErrno));
+      }
     }
   } catch (std::exception const& e) {
     return folly::makeUnexpected<std::string>(
         folly::exceptionStr(e).toStdString());
   }
+  numOfBytesWrittenToDisk_ += fileData.size();
   return folly::Unit();
 }
 
@@ -15,9 +15,15 @@ namespace fs = std::filesystem;
 #include <experimental/filesystem>
 namespace fs = std::experimental::filesystem;
 #endif
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include <folly/Range.h>
+#include <folly/compression/Compression.h>
 #include <folly/futures/Future.h>
+#include <folly/system/MemoryMapping.h>
 #include <thrift/lib/cpp2/protocol/Serializer.h>
 
 #include <openr/common/Constants.h>
@@ -28,6 +34,10 @@ namespace fs = std::experimental::filesystem;
 
 namespace {
 constexpr folly::StringPiece kTlvFormatMarker{"TlvFormatMarker"};
+// Version of group-committed log format, held by HEADER object
+constexpr uint32_t kLogFormatVersion{1};
+// Suffix of file kept aside if it can't be recovered
+constexpr folly::StringPiece kUnrecoverableFileSuffix{".unrecoverable"};
 enum WriteType { APPEND = 1, WRITE = 2 };
 
 } // anonymous namespace
@@ -37,6 +47,15 @@ namespace openr {
 enum ActionType {
   ADD = 1,
   DEL = 2,
+  // Group commit marker, `data` holds CRC32C of the objects since previous
+  // commit. Objects not followed by a valid commit are dropped on recovery.
+  COMMIT = 3,
+  // zstd compressed ADD/DEL objects, `data` holds 4-byte uncompressed length
+  // followed by compressed objects. Always followed by its own COMMIT.
+  BLOCK = 4,
+  // Format header right after 'kTlvFormatMarker' of files written as log,
+  // `data` holds 4-byte format version. Files without it are of older format.
+  HEADER = 5,
 };
 
 struct PersistentObject {
@@ -51,6 +70,28 @@ struct PersistentObject {
  *
  * `storageFilePath`: Describe the path of file in file system where data will
  * be stored/retrieved from (in binary format).
+ *
+ * File is a write-ahead log: a snapshot of the database followed by updates.
+ * Updates are group committed, i.e. all `store()`/`erase()` within a backoff
+ * interval are appended with a COMMIT record in a single write and fsync. Log
+ * is compacted into a new snapshot once it grows beyond a ratio of the
+ * snapshot size. On recovery, objects of a torn or corrupted commit at the
+ * tail are dropped and the file is rewritten.
+ *
+ * Log format is marked explicitly by a HEADER object, and files of older
+ * format without it are converted on load. File which can't be recovered,
+ * e.g. of unknown format version, is never written over. It is renamed with
+ * `kUnrecoverableFileSuffix` and store starts with empty database.
+ *
+ * With `enable_persistent_store_compression`, objects of every commit (and of
+ * snapshot) are zstd compressed together into a single BLOCK covered by the
+ * commit checksum. Files with and without blocks are readable either way, so
+ * knob can be flipped across restarts.
+ *
+ * Reads don't need to hop onto the PersistentStore thread: an immutable view
+ * of the database is republished after every update and read lock free by
+ * `loadSync()` and `loadThriftObj()` on the calling thread. Update is visible
+ * in the view once its SemiFuture completes.
  */
 class PersistentStore : public OpenrEventBase {
  public:
@@ -67,6 +108,23 @@ class PersistentStore : public OpenrEventBase {
     return numOfWritesToDisk_;
   }
 
+  // Bytes written to disk, snapshots included
+  uint64_t
+  getNumOfBytesWrittenToDisk() const {
+    return numOfBytesWrittenToDisk_;
+  }
+
+  // Bytes of keys and values passed to `store()`/`erase()`
+  uint64_t
+  getNumOfPayloadBytes() const {
+    return numOfPayloadBytes_;
+  }
+
+  uint64_t
+  getNumOfCompactions() const {
+    return numOfCompactions_;
+  }
+
   /**
    * Encode/Decode a PersistentObject, this can be private method, but for unit
    * test, we make it public
@@ -83,12 +141,27 @@ class PersistentStore : public OpenrEventBase {
   // Store key-value
   folly::SemiFuture<folly::Unit> store(std::string key, std::string value);
 
+  // Store all key-values in a single hop and group commit
+  folly::SemiFuture<folly::Unit> storeMany(
+      std::vector<std::pair<std::string, std::string>> keyVals);
+
   // Get value for a key. `nullptr` will be returned if key doesn't exists
   folly::SemiFuture<std::optional<std::string>> load(std::string key);
 
+  // Get values of all keys in a single hop, in order of `keys`
+  folly::SemiFuture<std::vector<std::optional<std::string>>> loadMany(
+      std::vector<std::string> keys);
+
+  // Get value for a key from the read view, on the calling thread
+  std::optional<std::string> loadSync(const std::string& key) const;
+
   // Erase config
   folly::SemiFuture<bool> erase(std::string key);
 
+  // Commit pending updates to disk right away, without waiting for the group
+  // commit interval. Returns true on success.
+  folly::SemiFuture<bool> sync();
+
   // Utility function to store thrift objects
   template <typename ThriftType>
   folly::SemiFuture<folly::Unit>
@@ -99,22 +172,23 @@ class PersistentStore : public OpenrEventBase {
     return store(std::move(key), std::move(result));
   }
 
-  // Utility function to load thrift objects
+  // Utility function to load thrift objects, from the read view
   template <typename ThriftType>
   folly::SemiFuture<folly::Expected<ThriftType, folly::Unit>>
   loadThriftObj(std::string key) noexcept {
-    auto futureVal = load(std::move(key));
-    return std::move(futureVal).defer(
-        [](folly::Try<std::optional<std::string>>&& value)
-            -> folly::Expected<ThriftType, folly::Unit> {
-          if (value.hasException() or not value->has_value()) {
-            return folly::makeUnexpected(folly::Unit());
-          }
-          apache::thrift::CompactSerializer serializer;
-          ThriftType obj;
-          serializer.deserialize(*value.value(), obj);
-          return obj;
-        });
+    folly::Expected<ThriftType, folly::Unit> result =
+        folly::makeUnexpected(folly::Unit());
+    try {
+      if (auto value = loadSync(key)) {
+        apache::thrift::CompactSerializer serializer;
+        ThriftType obj;
+        serializer.deserialize(*value, obj);
+        result = std::move(obj);
+      }
+    } catch (const std::exception&) {
+      // undecodable value is reported as missing
+    }
+    return folly::makeSemiFuture(std::move(result));
   }
 
  private:
@@ -123,9 +197,25 @@ class PersistentStore : public OpenrEventBase {
   bool saveDatabaseToDisk() noexcept;
   bool loadDatabaseFromDisk() noexcept;
 
-  // Load TlvFormat from disk
+  // Rename file which failed to load, so that it's not written over
+  void keepUnrecoverableFileAside() noexcept;
+
+  // Load TlvFormat from disk. Sets `needsRewrite` if file must be rewritten,
+  // i.e. it has a torn tail or lacks format header (older format).
   folly::Expected<folly::Unit, std::string> loadDatabaseTlvFormat(
-      const std::unique_ptr<folly::IOBuf>& ioBuf) noexcept;
+      folly::ByteRange fileData, bool& needsRewrite) noexcept;
+
+  // Value of `key`, decoding it from mapped file on first access
+  std::optional<std::string> findValue(const std::string& key);
+
+  // Unmap file once every value loaded from it is decoded or overridden
+  void maybeReleaseMapping() noexcept;
+
+  // Store key-value, to be saved to disk by caller
+  void storeImpl(std::string key, std::string value);
+
+  // Republish read view of the database, after every update
+  void publishReadView();
 
   // Wrapper function to save persistent object to disk immediately or later
   void maybeSaveObjectToDisk() noexcept;
@@ -144,8 +234,13 @@ class PersistentStore : public OpenrEventBase {
   // Keeps track of number of writes of Database to disk
   std::atomic<std::uint64_t> numOfWritesToDisk_{0};
 
-  // Keeps track of number of writes of PersistentObject to disk
-  std::atomic<std::uint64_t> numOfNewWritesToDisk_{0};
+  // Write-ahead log accounting. Bytes appended since last snapshot, and size
+  // of that snapshot, drive compaction.
+  std::atomic<std::uint64_t> numOfBytesWrittenToDisk_{0};
+  std::atomic<std::uint64_t> numOfPayloadBytes_{0};
+  std::atomic<std::uint64_t> numOfCompactions_{0};
+  uint64_t logBytes_{0};
+  uint64_t snapshotBytes_{0};
 
   // Location on disk where data will be synced up. A file will be created
   // if doesn't exists.
@@ -154,6 +249,10 @@ class PersistentStore : public OpenrEventBase {
   // Dryrun to avoid disk writes in UTs
   bool dryrun_{false};
 
+  // Set if unrecoverable file couldn't be kept aside, writing to it would
+  // destroy it
+  bool diskWritesDisabled_{false};
+
   // Timer for saving database to disk
   std::unique_ptr<folly::AsyncTimeout> saveDbTimer_;
   std::unique_ptr<ExponentialBackoff<std::chrono::milliseconds>>
@@ -163,6 +262,27 @@ class PersistentStore : public OpenrEventBase {
   // layer (disk) in a file.
   std::unordered_map<std::string, std::string> database_;
 
+  // Keys loaded from disk whose value is not decoded yet, referring to
+  // values in `mapping_` of the file. Disjoint from `database_`.
+  std::unordered_map<std::string, folly::ByteRange> lazyValues_;
+  std::shared_ptr<folly::MemoryMapping> mapping_;
+  // Decompressed blocks of the file, lazy values may refer to them as well
+  std::shared_ptr<std::vector<std::unique_ptr<folly::IOBuf>>> blocks_;
+
+  // Codec for compressing commits, if enabled
+  std::unique_ptr<folly::io::Codec> codec_;
+
+  // Immutable copy of the database for reads from other threads. Lazy values
+  // keep referring to the mapping, shared with the view until it's replaced.
+  struct ReadView {
+    std::unordered_map<std::string, std::string> values;
+    std::unordered_map<std::string, folly::ByteRange> lazyValues;
+    std::shared_ptr<folly::MemoryMapping> mapping;
+    std::shared_ptr<std::vector<std::unique_ptr<folly::IOBuf>>> blocks;
+  };
+  // ATTN: replaced on PersistentStore thread, use std::atomic_load/store
+  std::shared_ptr<const ReadView> readView_;
+
   // Serializer for encoding/decoding of thrift objects
   apache::thrift::CompactSerializer serializer_;
 
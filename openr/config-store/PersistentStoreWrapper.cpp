@@ -12,11 +12,13 @@
 
 namespace openr {
 
-PersistentStoreWrapper::PersistentStoreWrapper(const unsigned long tid)
+PersistentStoreWrapper::PersistentStoreWrapper(
+    const unsigned long tid, bool enableCompression)
     : filePath(fmt::format("/tmp/openr_persistent_store_test_{}", tid)) {
   XLOG(DBG1) << "PersistentStoreWrapper: Creating PersistentStore.";
   auto tConfig = getBasicOpenrConfig();
   tConfig.persistent_config_store_path_ref() = filePath;
+  tConfig.enable_persistent_store_compression_ref() = enableCompression;
   auto config = std::make_shared<Config>(tConfig);
   store_ = std::make_unique<PersistentStore>(config);
 }
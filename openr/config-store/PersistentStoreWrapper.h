@@ -13,7 +13,8 @@ namespace openr {
 
 class PersistentStoreWrapper {
  public:
-  explicit PersistentStoreWrapper(const unsigned long tid);
+  explicit PersistentStoreWrapper(
+      const unsigned long tid, bool enableCompression = false);
 
   // Destructor will try to save DB to disk before destroying the object
   ~PersistentStoreWrapper() {
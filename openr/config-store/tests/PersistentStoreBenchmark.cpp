@@ -10,6 +10,17 @@
 #include <folly/init/Init.h>
 #include <openr/config-store/PersistentStoreWrapper.h>
 
+#define BENCHMARK_COUNTERS_NAME_PARAM(name, counters, param_name, ...) \
+  BENCHMARK_IMPL_COUNTERS(                                             \
+      FB_CONCATENATE(name, FB_CONCATENATE(_, param_name)),             \
+      FOLLY_PP_STRINGIZE(name) "(" FOLLY_PP_STRINGIZE(param_name) ")", \
+      counters,                                                        \
+      iters,                                                           \
+      unsigned,                                                        \
+      iters) {                                                         \
+    name(counters, iters, ##__VA_ARGS__);                              \
+  }
+
 namespace {
 // kIterations <= n: change this to 10 singce n starts from 10,
 // n is in BENCHMARK_PARAM(BM_PersistentStoreWrite, n)
@@ -155,6 +166,46 @@ BM_PersistentStoreCreateDestroy(uint32_t iters, size_t numOfStringKeys) {
   }
 }
 
+/**
+ * Benchmark for bytes written to disk per byte of stored payload
+ * 1. Write keys to store, committing once per batch of `numOfStringKeys`
+ * 2. Report write amplification, including snapshots written on compaction
+ */
+void
+BM_PersistentStoreWriteAmplification(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    size_t numOfStringKeys,
+    bool enableCompression) {
+  auto suspender = folly::BenchmarkSuspender();
+  const auto tid = std::hash<std::thread::id>()(std::this_thread::get_id());
+  auto store =
+      std::make_unique<PersistentStoreWrapper>(tid + 2, enableCompression);
+  store->run();
+
+  auto stringKeys = constructRandomVector(numOfStringKeys);
+  const auto startBytesWritten = (*store)->getNumOfBytesWrittenToDisk();
+  const auto startPayloadBytes = (*store)->getNumOfPayloadBytes();
+  suspender.dismiss(); // Start measuring benchmark time
+
+  for (uint32_t i = 0; i < iters; i++) {
+    writeKeyValueToStore(stringKeys, *store, 1);
+    (*store)->sync().get();
+  }
+
+  suspender.rehire(); // Stop measuring time again
+  const auto bytesWritten =
+      (*store)->getNumOfBytesWrittenToDisk() - startBytesWritten;
+  const auto payloadBytes =
+      (*store)->getNumOfPayloadBytes() - startPayloadBytes;
+  counters["bytes_written"] = bytesWritten;
+  counters["bytes_written_per_op"] = bytesWritten / iters;
+  counters["compactions"] = (*store)->getNumOfCompactions();
+  counters["write_amplification"] =
+      payloadBytes ? static_cast<double>(bytesWritten) / payloadBytes : 0;
+  eraseKeyFromStore(stringKeys, *store);
+}
+
 // The parameter is the number of keys already written to store
 // before benchmarking the time.
 BENCHMARK_PARAM(BM_PersistentStoreWrite, 10);
@@ -172,6 +223,25 @@ BENCHMARK_PARAM(BM_PersistentStoreCreateDestroy, 100);
 BENCHMARK_PARAM(BM_PersistentStoreCreateDestroy, 1000);
 BENCHMARK_PARAM(BM_PersistentStoreCreateDestroy, 10000);
 
+// The parameters are the number of keys stored per commit, and whether
+// commits are compressed
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreWriteAmplification, counters, 1, 1, false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreWriteAmplification, counters, 10, 10, false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreWriteAmplification, counters, 100, 100, false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreWriteAmplification, counters, 1000, 1000, false);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreWriteAmplification, counters, 1_zstd, 1, true);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreWriteAmplification, counters, 10_zstd, 10, true);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreWriteAmplification, counters, 100_zstd, 100, true);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PersistentStoreWriteAmplification, counters, 1000_zstd, 1000, true);
+
 } // namespace openr
 
 int
@@ -5,11 +5,14 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <cstdio>
+#include <cstring>
 #include <thread>
 #include <utility>
 
 #include <folly/FileUtil.h>
 #include <folly/Random.h>
+#include <folly/lang/Bits.h>
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 #include <gtest/gtest.h>
@@ -215,6 +218,320 @@ TEST(PersistentStoreTest, BulkStoreLoad) {
   }
 }
 
+TEST(PersistentStoreTest, LazyLoad) {
+  const auto tid = std::hash<std::thread::id>()(std::this_thread::get_id());
+
+  std::string filePath;
+  {
+    PersistentStoreWrapper store(tid);
+    store.run();
+    filePath = store.filePath;
+    for (auto index = 0; index < 10; index++) {
+      store->store(fmt::format("key-{}", index), fmt::format("val-{}", index))
+          .get();
+    }
+  }
+
+  // Reload without reading values. Values not decoded yet must survive
+  // snapshot on destruction, along with overrides and erase of others.
+  {
+    PersistentStoreWrapper store(tid);
+    store.run();
+    store->store("key-1", "new-val-1").get();
+    EXPECT_TRUE(store->erase("key-2").get());
+    EXPECT_FALSE(store->erase("key-2").get());
+  }
+
+  StoreDatabase expected;
+  for (auto index = 0; index < 10; index++) {
+    expected[fmt::format("key-{}", index)] = fmt::format("val-{}", index);
+  }
+  expected["key-1"] = "new-val-1";
+  expected.erase("key-2");
+  EXPECT_EQ(expected, loadDatabaseFromDisk(filePath));
+
+  {
+    PersistentStoreWrapper store(tid);
+    store.run();
+    EXPECT_EQ("val-0", store->load("key-0").get());
+    EXPECT_EQ("val-0", store->load("key-0").get());
+    EXPECT_EQ("new-val-1", store->load("key-1").get());
+    EXPECT_FALSE(store->load("key-2").get());
+    for (const auto& [key, _] : expected) {
+      store->erase(key).get();
+    }
+  }
+}
+
+TEST(PersistentStoreTest, BatchAndSyncLoad) {
+  const auto tid = std::hash<std::thread::id>()(std::this_thread::get_id());
+
+  std::string filePath;
+  {
+    PersistentStoreWrapper store(tid);
+    store.run();
+    filePath = store.filePath;
+    store->storeMany({{"key-1", "val-1"}, {"key-2", "val-2"}}).get();
+    // both key-values are committed in a single write
+    EXPECT_TRUE(store->sync().get());
+    EXPECT_EQ(1, store->getNumOfDbWritesToDisk());
+
+    // update is visible in read view once completed
+    EXPECT_EQ("val-1", store->loadSync("key-1"));
+    EXPECT_FALSE(store->loadSync("key-3").has_value());
+    const std::vector<std::optional<std::string>> expected{
+        "val-2", std::nullopt, "val-1"};
+    EXPECT_EQ(expected, store->loadMany({"key-2", "key-3", "key-1"}).get());
+  }
+
+  // values not decoded yet are read from the mapped file
+  {
+    PersistentStoreWrapper store(tid);
+    store.run();
+    EXPECT_EQ("val-2", store->loadSync("key-2"));
+    EXPECT_TRUE(store->erase("key-2").get());
+    EXPECT_FALSE(store->loadSync("key-2").has_value());
+    EXPECT_EQ("val-1", store->loadSync("key-1"));
+    store->erase("key-1").get();
+  }
+}
+
+TEST(PersistentStoreTest, TornTailRecovery) {
+  const auto tid = std::hash<std::thread::id>()(std::this_thread::get_id());
+
+  std::string filePath;
+  {
+    PersistentStoreWrapper store(tid);
+    store.run();
+    filePath = store.filePath;
+    store->store("key1", "val1").get();
+    store->store("key2", "val2").get();
+    EXPECT_TRUE(store->sync().get());
+  }
+
+  //
+  // Simulate crash while appending: object without commit, followed by a
+  // truncated object
+  //
+  {
+    PersistentObject pObject;
+    pObject.type = ActionType::ADD;
+    pObject.key = "key3";
+    pObject.data = "val3";
+    auto buf = PersistentStore::encodePersistentObject(pObject);
+    ASSERT_TRUE(buf.hasValue());
+    std::string tail = (*buf)->moveToFbString().toStdString();
+    tail += tail.substr(0, tail.size() / 2);
+    std::string fileData;
+    ASSERT_TRUE(folly::readFile(filePath.c_str(), fileData));
+    ASSERT_TRUE(folly::writeFile(fileData + tail, filePath.c_str()));
+  }
+
+  {
+    PersistentStoreWrapper store(tid);
+    store.run();
+    EXPECT_EQ("val1", store->load("key1").get());
+    EXPECT_EQ("val2", store->load("key2").get());
+    EXPECT_FALSE(store->load("key3").get());
+  }
+
+  // Torn tail is dropped from file once recovered
+  {
+    const StoreDatabase expected{{"key1", "val1"}, {"key2", "val2"}};
+    EXPECT_EQ(expected, loadDatabaseFromDisk(filePath));
+  }
+
+  // Commit with corrupted checksum is dropped along with its objects
+  {
+    std::string fileData;
+    ASSERT_TRUE(folly::readFile(filePath.c_str(), fileData));
+    ASSERT_FALSE(fileData.empty());
+    fileData.back() ^= 0xff;
+    ASSERT_TRUE(folly::writeFile(fileData, filePath.c_str()));
+
+    PersistentStoreWrapper store(tid);
+    store.run();
+    EXPECT_FALSE(store->load("key1").get());
+    EXPECT_FALSE(store->load("key2").get());
+  }
+}
+
+// Encode objects into file contents, starting with 'kTlvFormatMarker'
+std::string
+encodeFile(const std::vector<PersistentObject>& pObjects) {
+  std::string fileData = kTlvFormatMarker.str();
+  for (const auto& pObject : pObjects) {
+    auto buf = PersistentStore::encodePersistentObject(pObject);
+    EXPECT_TRUE(buf.hasValue());
+    fileData += (*buf)->moveToFbString().toStdString();
+  }
+  return fileData;
+}
+
+PersistentObject
+createHeader(uint32_t version) {
+  PersistentObject header;
+  header.type = ActionType::HEADER;
+  header.data = std::string(sizeof(version), '\0');
+  const auto versionBE = folly::Endian::big(version);
+  std::memcpy(header.data->data(), &versionBE, sizeof(versionBE));
+  return header;
+}
+
+TEST(PersistentStoreTest, OlderFormatConversion) {
+  const auto tid = std::hash<std::thread::id>()(std::this_thread::get_id());
+
+  std::string filePath;
+  {
+    PersistentStoreWrapper store(tid);
+    filePath = store.filePath;
+  }
+
+  // File of older format: objects without header and commits
+  {
+    PersistentObject add1{ActionType::ADD, "key1", "val1"};
+    PersistentObject add2{ActionType::ADD, "key2", "val2"};
+    PersistentObject del2{ActionType::DEL, "key2", std::nullopt};
+    ASSERT_TRUE(
+        folly::writeFile(encodeFile({add1, add2, del2}), filePath.c_str()));
+  }
+
+  {
+    PersistentStoreWrapper store(tid);
+    store.run();
+    EXPECT_EQ("val1", store->load("key1").get());
+    EXPECT_FALSE(store->load("key2").get());
+  }
+
+  // File is converted to log format, starting with header
+  {
+    std::string fileData;
+    ASSERT_TRUE(folly::readFile(filePath.c_str(), fileData));
+    const auto header = encodeFile({createHeader(kLogFormatVersion)});
+    EXPECT_EQ(header, fileData.substr(0, header.size()));
+    const StoreDatabase expected{{"key1", "val1"}};
+    EXPECT_EQ(expected, loadDatabaseFromDisk(filePath));
+  }
+
+  {
+    PersistentStoreWrapper store(tid);
+    store.run();
+    EXPECT_EQ("val1", store->load("key1").get());
+    store->erase("key1").get();
+  }
+}
+
+TEST(PersistentStoreTest, UnrecoverableFileKeptAside) {
+  const auto tid = std::hash<std::thread::id>()(std::this_thread::get_id());
+
+  std::string filePath;
+  {
+    PersistentStoreWrapper store(tid);
+    filePath = store.filePath;
+  }
+  const auto asidePath = filePath + kUnrecoverableFileSuffix.str();
+  std::remove(asidePath.c_str());
+
+  // File of unknown format version
+  PersistentObject add{ActionType::ADD, "key1", "val1"};
+  const auto fileData = encodeFile({createHeader(kLogFormatVersion + 1), add});
+  ASSERT_TRUE(folly::writeFile(fileData, filePath.c_str()));
+
+  {
+    PersistentStoreWrapper store(tid);
+    store.run();
+    EXPECT_FALSE(store->load("key1").get());
+    store->store("key2", "val2").get();
+    EXPECT_TRUE(store->sync().get());
+  }
+
+  // Original file is kept as is, store continues with a new one
+  {
+    std::string asideData;
+    ASSERT_TRUE(folly::readFile(asidePath.c_str(), asideData));
+    EXPECT_EQ(fileData, asideData);
+
+    PersistentStoreWrapper store(tid);
+    store.run();
+    EXPECT_FALSE(store->load("key1").get());
+    EXPECT_EQ("val2", store->load("key2").get());
+    store->erase("key2").get();
+  }
+  std::remove(asidePath.c_str());
+}
+
+TEST(PersistentStoreTest, LogCompaction) {
+  const auto tid = std::hash<std::thread::id>()(std::this_thread::get_id());
+
+  std::string filePath;
+  const std::string value(1024, 'v');
+  {
+    PersistentStoreWrapper store(tid);
+    store.run();
+    filePath = store.filePath;
+
+    // Overwrite the same key until log is compacted
+    for (int i = 0; i < 1000 and store->getNumOfCompactions() == 0; ++i) {
+      store->store("key", fmt::format("{}-{}", value, i)).get();
+      EXPECT_TRUE(store->sync().get());
+    }
+    EXPECT_LT(0, store->getNumOfCompactions());
+    store->store("key", value).get();
+    EXPECT_TRUE(store->sync().get());
+  }
+
+  {
+    PersistentStoreWrapper store(tid);
+    store.run();
+    EXPECT_EQ(value, store->load("key").get());
+    store->erase("key").get();
+  }
+}
+
+TEST(PersistentStoreTest, CompressedFormat) {
+  const auto tid = std::hash<std::thread::id>()(std::this_thread::get_id());
+
+  const std::string value(1024, 'v');
+  uint64_t compressedBytes{0};
+  {
+    PersistentStoreWrapper store(tid, true /* enableCompression */);
+    store.run();
+    store->storeMany({{"key-1", value}, {"key-2", value}}).get();
+    EXPECT_TRUE(store->sync().get());
+    compressedBytes = store->getNumOfBytesWrittenToDisk();
+    EXPECT_GT(store->getNumOfPayloadBytes(), compressedBytes);
+  }
+
+  // compressed file is readable with compression disabled
+  {
+    PersistentStoreWrapper store(tid);
+    store.run();
+    EXPECT_EQ(value, store->loadSync("key-1"));
+    EXPECT_TRUE(store->erase("key-1").get());
+    EXPECT_TRUE(store->sync().get());
+  }
+
+  // mix of compressed and uncompressed commits
+  {
+    PersistentStoreWrapper store(tid, true /* enableCompression */);
+    store.run();
+    EXPECT_FALSE(store->loadSync("key-1").has_value());
+    EXPECT_EQ(value, store->load("key-2").get());
+    store->store("key-3", value).get();
+    EXPECT_TRUE(store->sync().get());
+  }
+
+  {
+    PersistentStoreWrapper store(tid);
+    store.run();
+    EXPECT_FALSE(store->loadSync("key-1").has_value());
+    EXPECT_EQ(value, store->loadSync("key-2"));
+    EXPECT_EQ(value, store->loadSync("key-3"));
+    store->erase("key-2").get();
+    store->erase("key-3").get();
+  }
+}
+
 } // namespace openr
 
 int
@@ -6,13 +6,18 @@
  */
 
 #include <fb303/ServiceData.h>
+#include <folly/json.h>
 #include <folly/logging/xlog.h>
 #include <glog/logging.h>
 #include <thrift/lib/cpp/util/EnumUtils.h>
 #include <thrift/lib/cpp2/protocol/Serializer.h>
+#include <algorithm>
+#include <array>
+#include <set>
 #include <stdexcept>
 
 #include <openr/common/Constants.h>
+#include <openr/common/MemoryPressure.h>
 #include <openr/config/Config.h>
 #include <openr/if/gen-cpp2/Network_types.h>
 #include <openr/if/gen-cpp2/OpenrConfig_types.h>
@@ -49,6 +54,132 @@ AreaConfiguration::compileRegexSet(std::vector<std::string> const& strings) {
   return reSet;
 }
 
+InterfaceRegexMatcher::InterfaceRegexMatcher(
+    std::vector<thrift::AreaConfig> const& areas) {
+  re2::RE2::Options regexOpts;
+  std::string regexErr;
+  regexOpts.set_case_sensitive(false);
+  regexSet_ = std::make_unique<re2::RE2::Set>(regexOpts, re2::RE2::ANCHOR_BOTH);
+
+  for (auto const& area : areas) {
+    areaIds_.emplace_back(*area.area_id_ref());
+  }
+  std::sort(areaIds_.begin(), areaIds_.end());
+
+  for (auto const& area : areas) {
+    const size_t areaIdx = std::lower_bound(
+                               areaIds_.begin(),
+                               areaIds_.end(),
+                               *area.area_id_ref()) -
+        areaIds_.begin();
+    auto addRegexes = [&](std::vector<std::string> const& regexes,
+                          Category category) {
+      for (auto const& regex : regexes) {
+        if (regexSet_->Add(regex, &regexErr) == -1) {
+          throw std::invalid_argument(fmt::format(
+              "Failed to add regex: {}. Error: {}", regex, regexErr));
+        }
+        regexes_.emplace_back(areaIdx, category);
+      }
+    };
+    addRegexes(*area.include_interface_regexes_ref(), Category::INCLUDE);
+    addRegexes(*area.exclude_interface_regexes_ref(), Category::EXCLUDE);
+    addRegexes(
+        *area.redistribute_interface_regexes_ref(), Category::REDISTRIBUTE);
+  }
+
+  if (regexes_.empty()) {
+    // make this regex set unmatchable
+    std::string const unmatchable = "a^";
+    CHECK_NE(-1, regexSet_->Add(unmatchable, &regexErr)) << fmt::format(
+        "Failed to add regex: {}. Error: {}", unmatchable, regexErr);
+  }
+  CHECK(regexSet_->Compile()) << "Regex compilation failed";
+}
+
+InterfaceRegexMatcher::Result
+InterfaceRegexMatcher::match(std::string const& ifName) const {
+  Result result;
+  std::vector<int> matches;
+  if (regexes_.empty() or (not regexSet_->Match(ifName, &matches))) {
+    return result;
+  }
+
+  // matched categories of every area
+  std::vector<std::array<bool, 3>> areaMatches(areaIds_.size());
+  for (const auto idx : matches) {
+    const auto& [areaIdx, category] = regexes_.at(idx);
+    areaMatches.at(areaIdx).at(static_cast<size_t>(category)) = true;
+  }
+  for (size_t i = 0; i < areaIds_.size(); ++i) {
+    const auto& areaMatch = areaMatches[i];
+    if (areaMatch[static_cast<size_t>(Category::INCLUDE)] and
+        not areaMatch[static_cast<size_t>(Category::EXCLUDE)]) {
+      result.discoverAreas.emplace_back(areaIds_[i]);
+    }
+    if (areaMatch[static_cast<size_t>(Category::REDISTRIBUTE)]) {
+      result.redistributeAreas.emplace_back(areaIds_[i]);
+    }
+  }
+  return result;
+}
+
+NeighborRegexMatcher::NeighborRegexMatcher(
+    std::vector<thrift::AreaConfig> const& areas) {
+  re2::RE2::Options regexOpts;
+  std::string regexErr;
+  regexOpts.set_case_sensitive(false);
+  regexSet_ = std::make_unique<re2::RE2::Set>(regexOpts, re2::RE2::ANCHOR_BOTH);
+
+  for (auto const& area : areas) {
+    areaIds_.emplace_back(*area.area_id_ref());
+  }
+  std::sort(areaIds_.begin(), areaIds_.end());
+
+  for (auto const& area : areas) {
+    const size_t areaIdx = std::lower_bound(
+                               areaIds_.begin(),
+                               areaIds_.end(),
+                               *area.area_id_ref()) -
+        areaIds_.begin();
+    for (auto const& regex : *area.neighbor_regexes_ref()) {
+      if (regexSet_->Add(regex, &regexErr) == -1) {
+        throw std::invalid_argument(fmt::format(
+            "Failed to add regex: {}. Error: {}", regex, regexErr));
+      }
+      regexAreas_.emplace_back(areaIdx);
+    }
+  }
+
+  if (regexAreas_.empty()) {
+    // make this regex set unmatchable
+    std::string const unmatchable = "a^";
+    CHECK_NE(-1, regexSet_->Add(unmatchable, &regexErr)) << fmt::format(
+        "Failed to add regex: {}. Error: {}", unmatchable, regexErr);
+  }
+  CHECK(regexSet_->Compile()) << "Regex compilation failed";
+}
+
+std::vector<std::string>
+NeighborRegexMatcher::match(std::string const& neighbor) const {
+  std::vector<int> matches;
+  if (regexAreas_.empty() or (not regexSet_->Match(neighbor, &matches))) {
+    return {};
+  }
+
+  std::vector<bool> areaMatches(areaIds_.size(), false);
+  for (const auto idx : matches) {
+    areaMatches.at(regexAreas_.at(idx)) = true;
+  }
+  std::vector<std::string> areas;
+  for (size_t i = 0; i < areaIds_.size(); ++i) {
+    if (areaMatches[i]) {
+      areas.emplace_back(areaIds_[i]);
+    }
+  }
+  return areas;
+}
+
 Config::Config(const std::string& configFile) {
   std::string contents;
   if (not FileUtil::readFileToString(configFile, contents)) {
@@ -82,6 +213,29 @@ Config::getRunningConfig() const {
   return contents;
 }
 
+std::vector<std::string>
+Config::getChangedFields(
+    const thrift::OpenrConfig& lhs, const thrift::OpenrConfig& rhs) {
+  const auto lhsFields = folly::parseJson(
+      apache::thrift::SimpleJSONSerializer::serialize<std::string>(lhs));
+  const auto rhsFields = folly::parseJson(
+      apache::thrift::SimpleJSONSerializer::serialize<std::string>(rhs));
+
+  std::set<std::string> changedFields;
+  for (const auto& [name, value] : lhsFields.items()) {
+    const auto* other = rhsFields.get_ptr(name);
+    if (not other or *other != value) {
+      changedFields.emplace(name.asString());
+    }
+  }
+  for (const auto& [name, _] : rhsFields.items()) {
+    if (not lhsFields.get_ptr(name)) {
+      changedFields.emplace(name.asString());
+    }
+  }
+  return {changedFields.begin(), changedFields.end()};
+}
+
 PrefixAllocationParams
 Config::createPrefixAllocationParams(
     const std::string& seedPfxStr, uint8_t allocationPfxLen) {
@@ -237,6 +391,14 @@ Config::populateAreaConfig() {
     checkAdjacencyLabelConfig(areaConf);
     checkPrependLabelConfig(areaConf);
   }
+
+  for (auto const& [id, _] : areaConfigs_) {
+    areaIds_.insert(id);
+  }
+  interfaceRegexMatcher_ =
+      std::make_shared<InterfaceRegexMatcher>(*config_.areas_ref());
+  neighborRegexMatcher_ =
+      std::make_shared<NeighborRegexMatcher>(*config_.areas_ref());
 }
 
 void
@@ -251,9 +413,42 @@ Config::checkKvStoreConfig() const {
     }
   }
 
+  if (const auto& floodBatch = kvStoreConf.flood_batch_ref()) {
+    if (*floodBatch->min_window_ms_ref() < 0) {
+      throw std::out_of_range(
+          "kvstore flood_batch min_window_ms should be >= 0");
+    }
+    if (*floodBatch->max_window_ms_ref() <= 0 or
+        *floodBatch->max_window_ms_ref() < *floodBatch->min_window_ms_ref()) {
+      throw std::out_of_range(
+          "kvstore flood_batch max_window_ms should be > 0 and >= "
+          "min_window_ms");
+    }
+  }
+
   if (kvStoreConf.key_ttl_ms_ref() == Constants::kTtlInfinity) {
     throw std::out_of_range("kvstore key_ttl_ms should be a finite number");
   }
+
+  if (const auto& chunkSize = kvStoreConf.full_sync_chunk_size_ref()) {
+    if (*chunkSize <= 0) {
+      throw std::out_of_range("kvstore full_sync_chunk_size should be > 0");
+    }
+  }
+
+  if (const auto& numKeyShards = kvStoreConf.num_key_shards_ref()) {
+    if (*numKeyShards <= 0) {
+      throw std::out_of_range("kvstore num_key_shards should be > 0");
+    }
+  }
+
+  if (const auto& interval =
+          kvStoreConf.warm_restart_snapshot_interval_s_ref()) {
+    if (*interval <= 0) {
+      throw std::out_of_range(
+          "kvstore warm_restart_snapshot_interval_s should be > 0");
+    }
+  }
 }
 
 void
@@ -266,6 +461,22 @@ Config::checkDecisionConfig() const {
         *decisionConf.debounce_min_ms_ref(),
         *decisionConf.debounce_max_ms_ref()));
   }
+  if (*decisionConf.spf_num_threads_ref() < 0) {
+    throw std::out_of_range(fmt::format(
+        "decision_config.spf_num_threads ({}) should be >= 0",
+        *decisionConf.spf_num_threads_ref()));
+  }
+
+  if (*decisionConf.publication_decode_num_threads_ref() < 0) {
+    throw std::out_of_range(fmt::format(
+        "decision_config.publication_decode_num_threads ({}) should be >= 0",
+        *decisionConf.publication_decode_num_threads_ref()));
+  }
+
+  // validate priority prefixes, throws on malformed prefix
+  for (auto const& prefix : *decisionConf.priority_prefixes_ref()) {
+    folly::IPAddress::createNetwork(prefix);
+  }
 }
 
 void
@@ -322,6 +533,51 @@ Config::checkSparkConfig() const {
         "hold_time_s ({}) should be > 0", *sparkConfig.hold_time_s_ref()));
   }
 
+  // Fast failure detection overrides above in milliseconds
+  if (sparkConfig.keepalive_time_ms_ref().has_value() and
+      *sparkConfig.keepalive_time_ms_ref() <= 0) {
+    throw std::out_of_range(fmt::format(
+        "keepalive_time_ms ({}) should be > 0",
+        *sparkConfig.keepalive_time_ms_ref()));
+  }
+
+  if (sparkConfig.hold_time_ms_ref().has_value() and
+      *sparkConfig.hold_time_ms_ref() <= 0) {
+    throw std::out_of_range(fmt::format(
+        "hold_time_ms ({}) should be > 0", *sparkConfig.hold_time_ms_ref()));
+  }
+
+  if (getSparkKeepAliveTime() > getSparkHoldTime()) {
+    throw std::invalid_argument(fmt::format(
+        "keepalive time ({}ms) should be <= hold time ({}ms)",
+        getSparkKeepAliveTime().count(),
+        getSparkHoldTime().count()));
+  }
+
+  if (sparkConfig.max_keepalive_time_ms_ref().has_value() and
+      std::chrono::milliseconds(*sparkConfig.max_keepalive_time_ms_ref()) <
+          getSparkKeepAliveTime()) {
+    throw std::invalid_argument(fmt::format(
+        "max_keepalive_time_ms ({}) should be >= keepalive time ({}ms)",
+        *sparkConfig.max_keepalive_time_ms_ref(),
+        getSparkKeepAliveTime().count()));
+  }
+
+  // ATTN: hold time raised along with keep-alive time is advertised in a
+  // single heartbeat msg. Losing it must not expire the old hold time.
+  if (sparkConfig.max_keepalive_time_ms_ref().has_value() and
+      getSparkHoldTime() <= 2 * getSparkKeepAliveTime()) {
+    throw std::invalid_argument(fmt::format(
+        "hold time ({}ms) should be > 2 * keepalive time ({}ms) under adaptive keep-alive",
+        getSparkHoldTime().count(),
+        getSparkKeepAliveTime().count()));
+  }
+
+  if (*sparkConfig.num_shards_ref() <= 0) {
+    throw std::out_of_range(fmt::format(
+        "num_shards ({}) should be > 0", *sparkConfig.num_shards_ref()));
+  }
+
   if (*sparkConfig.graceful_restart_time_s_ref() <= 0) {
     throw std::out_of_range(fmt::format(
         "graceful_restart_time_s ({}) should be > 0",
@@ -375,6 +631,119 @@ Config::checkMonitorConfig() const {
         "monitor_max_event_log ({}) should be >= 0",
         *monitorConfig.max_event_log_ref()));
   }
+  if (auto name = monitorConfig.shared_counters_name_ref()) {
+    if (name->empty() or name->front() != '/' or
+        name->find('/', 1) != std::string::npos) {
+      throw std::invalid_argument(fmt::format(
+          "shared_counters_name ({}) should be of form /<name>", *name));
+    }
+    if (*monitorConfig.shared_counters_capacity_ref() <= 0) {
+      throw std::out_of_range(fmt::format(
+          "shared_counters_capacity ({}) should be > 0",
+          *monitorConfig.shared_counters_capacity_ref()));
+    }
+  }
+  for (auto const& [event, limit] :
+       *monitorConfig.event_log_rate_limits_ref()) {
+    if (limit <= 0) {
+      throw std::out_of_range(fmt::format(
+          "event_log_rate_limits of {} ({}) should be > 0", event, limit));
+    }
+  }
+  if (*monitorConfig.process_counters_interval_s_ref() <= 0) {
+    throw std::out_of_range(fmt::format(
+        "process_counters_interval_s ({}) should be > 0",
+        *monitorConfig.process_counters_interval_s_ref()));
+  }
+}
+
+void
+Config::checkFibConfig() const {
+  auto& fibConfig = *config_.fib_config_ref();
+  if (*fibConfig.route_programming_chunk_size_ref() < 0) {
+    throw std::out_of_range(fmt::format(
+        "route_programming_chunk_size ({}) should be >= 0",
+        *fibConfig.route_programming_chunk_size_ref()));
+  }
+  if (*fibConfig.max_inflight_chunks_ref() < 1) {
+    throw std::out_of_range(fmt::format(
+        "max_inflight_chunks ({}) should be >= 1",
+        *fibConfig.max_inflight_chunks_ref()));
+  }
+  if (*fibConfig.differential_sync_ranges_ref() < 1) {
+    throw std::out_of_range(fmt::format(
+        "differential_sync_ranges ({}) should be >= 1",
+        *fibConfig.differential_sync_ranges_ref()));
+  }
+  if (*fibConfig.enable_route_streaming_ref() and
+      *fibConfig.route_programming_chunk_size_ref() == 0) {
+    throw std::invalid_argument(
+        "enable_route_streaming requires route_programming_chunk_size > 0");
+  }
+}
+
+void
+Config::checkThreadSchedulingConfig() const {
+  for (const auto& [name, schedConfig] : *config_.thread_scheduling_ref()) {
+    for (const auto cpu : *schedConfig.cpus_ref()) {
+      if (cpu < 0) {
+        throw std::out_of_range(fmt::format(
+            "thread_scheduling {}: cpu ({}) should be >= 0", name, cpu));
+      }
+    }
+    const auto priority = *schedConfig.priority_ref();
+    if (*schedConfig.policy_ref() == thrift::ThreadSchedulingPolicy::DEFAULT) {
+      if (priority < -20 or priority > 19) {
+        throw std::out_of_range(fmt::format(
+            "thread_scheduling {}: nice value ({}) should be in [-20, 19]",
+            name,
+            priority));
+      }
+    } else if (priority < 1 or priority > 99) {
+      throw std::out_of_range(fmt::format(
+          "thread_scheduling {}: real-time priority ({}) should be in [1, 99]",
+          name,
+          priority));
+    }
+    if (*schedConfig.isolate_ref() and schedConfig.cpus_ref()->empty()) {
+      throw std::invalid_argument(fmt::format(
+          "thread_scheduling {}: isolate requires cpus", name));
+    }
+  }
+}
+
+std::optional<thrift::ThreadSchedulingConfig>
+Config::getThreadSchedulingConfig(const std::string& threadName) const {
+  const auto& threadScheduling = *config_.thread_scheduling_ref();
+  if (auto it = threadScheduling.find(threadName);
+      it != threadScheduling.end()) {
+    return it->second;
+  }
+
+  // Spark shards share `spark` entry, else get high priority by default
+  if (threadName == "spark" or threadName.rfind("spark_", 0) == 0) {
+    if (auto it = threadScheduling.find("spark");
+        it != threadScheduling.end()) {
+      return it->second;
+    }
+    thrift::ThreadSchedulingConfig schedConfig;
+    schedConfig.policy_ref() = thrift::ThreadSchedulingPolicy::ROUND_ROBIN;
+    schedConfig.priority_ref() = 1;
+    return schedConfig;
+  }
+  return std::nullopt;
+}
+
+std::vector<int32_t>
+Config::getIsolatedCpus() const {
+  std::set<int32_t> cpus;
+  for (const auto& [_, schedConfig] : *config_.thread_scheduling_ref()) {
+    if (*schedConfig.isolate_ref()) {
+      cpus.insert(
+          schedConfig.cpus_ref()->begin(), schedConfig.cpus_ref()->end());
+    }
+  }
+  return std::vector<int32_t>(cpus.begin(), cpus.end());
 }
 
 void
@@ -400,6 +769,52 @@ Config::checkLinkMonitorConfig() const {
         *lmConf.linkflap_initial_backoff_ms_ref(),
         *lmConf.linkflap_max_backoff_ms_ref()));
   }
+
+  // rtt metric hysteresis validation
+  if (*lmConf.rtt_metric_min_change_pct_ref() < 0) {
+    throw std::out_of_range(fmt::format(
+        "rtt_metric_min_change_pct ({}) should be >= 0",
+        *lmConf.rtt_metric_min_change_pct_ref()));
+  }
+
+  if (*lmConf.rtt_metric_dwell_time_ms_ref() < 0) {
+    throw std::out_of_range(fmt::format(
+        "rtt_metric_dwell_time_ms ({}) should be >= 0",
+        *lmConf.rtt_metric_dwell_time_ms_ref()));
+  }
+
+  if (*lmConf.rtt_metric_ewma_weight_pct_ref() <= 0 or
+      *lmConf.rtt_metric_ewma_weight_pct_ref() > 100) {
+    throw std::out_of_range(fmt::format(
+        "rtt_metric_ewma_weight_pct ({}) should be in range (0, 100]",
+        *lmConf.rtt_metric_ewma_weight_pct_ref()));
+  }
+
+  if (*lmConf.adj_db_serialize_num_threads_ref() < 0) {
+    throw std::out_of_range(fmt::format(
+        "adj_db_serialize_num_threads ({}) should be >= 0",
+        *lmConf.adj_db_serialize_num_threads_ref()));
+  }
+
+  // link flap dampening validation
+  if (const auto& dampConf = lmConf.linkflap_dampening_config_ref()) {
+    if (*dampConf->penalty_per_flap_ref() <= 0 or
+        *dampConf->reuse_threshold_ref() <= 0 or
+        *dampConf->half_life_ms_ref() <= 0 or
+        *dampConf->max_suppress_time_ms_ref() <= 0) {
+      throw std::out_of_range(
+          "linkflap_dampening_config penalty_per_flap, reuse_threshold, "
+          "half_life_ms and max_suppress_time_ms should be > 0");
+    }
+
+    if (*dampConf->reuse_threshold_ref() >=
+        *dampConf->suppress_threshold_ref()) {
+      throw std::out_of_range(fmt::format(
+          "linkflap_dampening_config reuse_threshold ({}) should be < suppress_threshold ({})",
+          *dampConf->reuse_threshold_ref(),
+          *dampConf->suppress_threshold_ref()));
+    }
+  }
 }
 
 void
@@ -625,12 +1040,75 @@ Config::populateInternalDb() {
     throw std::invalid_argument(
         "enable_watchdog = true, but watchdog_config is empty");
   }
+  if (isWatchdogEnabled()) {
+    const auto& watchdogConf = *config_.watchdog_config_ref();
+    for (const auto pct : *watchdogConf.heap_profile_thresholds_pct_ref()) {
+      if (pct <= 0 or pct > 100) {
+        throw std::invalid_argument(fmt::format(
+            "heap_profile_thresholds_pct {} must be within (0, 100]", pct));
+      }
+    }
+    const auto& pressureThresholds =
+        *watchdogConf.memory_pressure_thresholds_pct_ref();
+    if (pressureThresholds.size() >
+        static_cast<size_t>(MemoryPressureLevel::REJECT_DUMPS)) {
+      throw std::invalid_argument(fmt::format(
+          "memory_pressure_thresholds_pct has {} thresholds, at most {} stages",
+          pressureThresholds.size(),
+          static_cast<size_t>(MemoryPressureLevel::REJECT_DUMPS)));
+    }
+    for (size_t i = 0; i < pressureThresholds.size(); ++i) {
+      const auto pct = pressureThresholds.at(i);
+      if (pct <= 0 or pct > 100 or
+          (i > 0 and pct <= pressureThresholds.at(i - 1))) {
+        throw std::invalid_argument(fmt::format(
+            "memory_pressure_thresholds_pct {} must be within (0, 100] and "
+            "strictly increasing",
+            pct));
+      }
+    }
+    if (*watchdogConf.heap_profile_min_interval_s_ref() < 0) {
+      throw std::invalid_argument("heap_profile_min_interval_s must be >= 0");
+    }
+    if (*watchdogConf.heap_profile_max_dumps_ref() <= 0) {
+      throw std::invalid_argument("heap_profile_max_dumps must be > 0");
+    }
+    const auto stallThresholdMs = *watchdogConf.stall_threshold_ms_ref();
+    if (stallThresholdMs != 0 and
+        stallThresholdMs < Constants::kMinStallThreshold.count()) {
+      throw std::invalid_argument(fmt::format(
+          "stall_threshold_ms {} must be 0 or >= {}",
+          stallThresholdMs,
+          Constants::kMinStallThreshold.count()));
+    }
+  }
 
   // Check Route Deletion Parameter
   if (*config_.route_delete_delay_ms_ref() < 0) {
     throw std::invalid_argument("Route delete duration must be >= 0ms");
   }
 
+  // Check netlink event coalescing window
+  if (*config_.netlink_event_coalescing_ms_ref() < 0) {
+    throw std::invalid_argument(
+        "Netlink event coalescing window must be >= 0ms");
+  }
+
+  // Check prefix key sharding
+  if (*config_.prefix_key_shards_ref() < 0) {
+    throw std::invalid_argument("Number of prefix key shards must be >= 0");
+  }
+
+  // Check policy evaluation threads
+  if (*config_.policy_num_threads_ref() < 0) {
+    throw std::invalid_argument("Number of policy threads must be >= 0");
+  }
+
+  // Check adaptive prefix sync throttle
+  if (*config_.prefix_sync_max_throttle_ms_ref() < 0) {
+    throw std::invalid_argument("Prefix sync max throttle must be >= 0ms");
+  }
+
   // validate KvStore config (e.g. ttl/flood-rate/etc.)
   checkKvStoreConfig();
 
@@ -646,6 +1124,12 @@ Config::populateInternalDb() {
   // validate Link Monitor config (e.g. backoff)
   checkLinkMonitorConfig();
 
+  // validate Fib config (e.g. route programming chunks)
+  checkFibConfig();
+
+  // validate thread scheduling config (e.g. priority range)
+  checkThreadSchedulingConfig();
+
   // validate Segment Routing config
   checkSegmentRoutingConfig();
 
@@ -669,6 +1153,12 @@ Config::populateInternalDb() {
   if (isSecureThriftServerEnabled()) {
     checkThriftServerConfig();
   }
+  if (*getThriftServerConfig().num_io_worker_threads_ref() <= 0 or
+      *getThriftServerConfig().num_peer_sync_threads_ref() <= 0 or
+      *getThriftServerConfig().num_ctrl_threads_ref() <= 0) {
+    throw std::invalid_argument(
+        "thrift_server num_io_worker_threads, num_peer_sync_threads and num_ctrl_threads must be > 0");
+  }
 
   //
   // Set an implicit value for eor_time_s (Decision Hold time) if not specified
@@ -706,6 +1196,8 @@ Config::toThriftKvStoreConfig() const {
     thrift::KvStoreFloodRate rate;
     rate.flood_msg_per_sec_ref() = *floodRate->flood_msg_per_sec_ref();
     rate.flood_msg_burst_size_ref() = *floodRate->flood_msg_burst_size_ref();
+    rate.high_priority_key_prefixes_ref().copy_from(
+        floodRate->high_priority_key_prefixes_ref());
 
     config.flood_rate_ref() = std::move(rate);
   }
@@ -725,6 +1217,42 @@ Config::toThriftKvStoreConfig() const {
   if (auto isFloodRoot = oldConfig.is_flood_root_ref()) {
     config.is_flood_root_ref() = *isFloodRoot;
   }
+  if (auto enableMerkleSync = oldConfig.enable_merkle_sync_ref()) {
+    config.enable_merkle_sync_ref() = *enableMerkleSync;
+  }
+  if (auto enableFastValueHash = oldConfig.enable_fast_value_hash_ref()) {
+    config.enable_fast_value_hash_ref() = *enableFastValueHash;
+  }
+  if (auto enableAreaEvbs = oldConfig.enable_area_event_bases_ref()) {
+    config.enable_area_event_bases_ref() = *enableAreaEvbs;
+  }
+  if (auto chunkSize = oldConfig.full_sync_chunk_size_ref()) {
+    config.full_sync_chunk_size_ref() = *chunkSize;
+  }
+  if (auto enableCompression = oldConfig.enable_full_sync_compression_ref()) {
+    config.enable_full_sync_compression_ref() = *enableCompression;
+  }
+  if (auto snapshotDir = oldConfig.warm_restart_snapshot_dir_ref()) {
+    config.warm_restart_snapshot_dir_ref() = *snapshotDir;
+  }
+  if (auto interval = oldConfig.warm_restart_snapshot_interval_s_ref()) {
+    config.warm_restart_snapshot_interval_s_ref() = *interval;
+  }
+  if (auto enableValueDelta = oldConfig.enable_value_delta_ref()) {
+    config.enable_value_delta_ref() = *enableValueDelta;
+  }
+  if (auto enableFloodDigest = oldConfig.enable_flood_digest_ref()) {
+    config.enable_flood_digest_ref() = *enableFloodDigest;
+  }
+  if (auto floodBatch = oldConfig.flood_batch_ref()) {
+    thrift::KvStoreFloodBatch batch;
+    batch.min_window_ms_ref() = *floodBatch->min_window_ms_ref();
+    batch.max_window_ms_ref() = *floodBatch->max_window_ms_ref();
+    config.flood_batch_ref() = std::move(batch);
+  }
+  if (auto numKeyShards = oldConfig.num_key_shards_ref()) {
+    config.num_key_shards_ref() = *numKeyShards;
+  }
   if (auto maybeIpTos = getConfig().ip_tos_ref()) {
     config.ip_tos_ref() = *maybeIpTos;
   }
@@ -21,6 +21,7 @@ namespace fs = std::experimental::filesystem;
 #include <re2/re2.h>
 #include <re2/set.h>
 #include <thrift/lib/cpp2/server/ThriftServer.h>
+#include <chrono>
 #include <optional>
 
 #include <openr/if/gen-cpp2/BgpConfig_types.h>
@@ -110,6 +111,57 @@ class AreaConfiguration {
       interfaceExcludeRegexSet_, interfaceRedistRegexSet_;
 };
 
+/**
+ * Interface include/exclude/redistribute regexes of all areas compiled into a
+ * single RE2::Set at config load. Decisions of all areas for an interface are
+ * taken with one pass over its name.
+ */
+class InterfaceRegexMatcher {
+ public:
+  explicit InterfaceRegexMatcher(std::vector<thrift::AreaConfig> const& areas);
+
+  struct Result {
+    // areas to discover neighbors on the interface, and to redistribute its
+    // addresses to. Ordered by area id.
+    std::vector<std::string> discoverAreas;
+    std::vector<std::string> redistributeAreas;
+  };
+
+  Result match(std::string const& ifName) const;
+
+ private:
+  enum class Category { INCLUDE, EXCLUDE, REDISTRIBUTE };
+
+  // sorted area ids
+  std::vector<std::string> areaIds_;
+
+  // index of area and category of every regex in set, by regex index
+  std::vector<std::pair<size_t, Category>> regexes_;
+
+  std::unique_ptr<re2::RE2::Set> regexSet_;
+};
+
+/**
+ * Neighbor regexes of all areas compiled into a single RE2::Set at config
+ * load, to find areas of a neighbor with one pass over its name.
+ */
+class NeighborRegexMatcher {
+ public:
+  explicit NeighborRegexMatcher(std::vector<thrift::AreaConfig> const& areas);
+
+  // areas to peer with the neighbor in, ordered by area id
+  std::vector<std::string> match(std::string const& neighbor) const;
+
+ private:
+  // sorted area ids
+  std::vector<std::string> areaIds_;
+
+  // index of area of every regex in set, by regex index
+  std::vector<size_t> regexAreas_;
+
+  std::unique_ptr<re2::RE2::Set> regexSet_;
+};
+
 class Config {
  public:
   explicit Config(const std::string& configFile);
@@ -129,6 +181,13 @@ class Config {
   }
   std::string getRunningConfig() const;
 
+  /**
+   * Names of top level OpenrConfig fields differing between `lhs` and `rhs`,
+   * in sorted order. Fields set in only one of them count as changed.
+   */
+  static std::vector<std::string> getChangedFields(
+      const thrift::OpenrConfig& lhs, const thrift::OpenrConfig& rhs);
+
   const std::string&
   getNodeName() const {
     return *config_.node_name_ref();
@@ -169,6 +228,55 @@ class Config {
     return config_.enable_netlink_fib_handler_ref().value_or(false);
   }
 
+  bool
+  isNetlinkNexthopObjectsEnabled() const {
+    return *config_.enable_netlink_nexthop_objects_ref();
+  }
+
+  bool
+  isNetlinkIoUringEnabled() const {
+    return *config_.enable_netlink_io_uring_ref();
+  }
+
+  std::chrono::milliseconds
+  getNetlinkEventCoalescingWindow() const {
+    return std::chrono::milliseconds(
+        *config_.netlink_event_coalescing_ms_ref());
+  }
+
+  // 0 if prefixes are advertised as one key per prefix
+  uint32_t
+  getPrefixKeyShards() const {
+    return *config_.prefix_key_shards_ref();
+  }
+
+  int32_t
+  getPolicyNumThreads() const {
+    return *config_.policy_num_threads_ref();
+  }
+
+  bool
+  isPersistentStoreCompressionEnabled() const {
+    return *config_.enable_persistent_store_compression_ref();
+  }
+
+  // 0 if KvStore sync throttle of PrefixManager is not adaptive
+  std::chrono::milliseconds
+  getPrefixSyncMaxThrottle() const {
+    return std::chrono::milliseconds(
+        *config_.prefix_sync_max_throttle_ms_ref());
+  }
+
+  /**
+   * Scheduling of module thread `threadName`, see
+   * OpenrConfig.thread_scheduling. std::nullopt keeps default scheduling.
+   */
+  std::optional<thrift::ThreadSchedulingConfig> getThreadSchedulingConfig(
+      const std::string& threadName) const;
+
+  // CPUs reserved to isolated module threads
+  std::vector<int32_t> getIsolatedCpus() const;
+
   bool
   isFibServiceWaitingEnabled() const {
     return *config_.enable_fib_service_waiting_ref();
@@ -223,13 +331,21 @@ class Config {
     return areaConfigs_;
   }
 
-  std::unordered_set<std::string>
+  // interface regexes of all areas, compiled into one set
+  std::shared_ptr<const InterfaceRegexMatcher>
+  getInterfaceRegexMatcher() const {
+    return interfaceRegexMatcher_;
+  }
+
+  // neighbor regexes of all areas, compiled into one set
+  std::shared_ptr<const NeighborRegexMatcher>
+  getNeighborRegexMatcher() const {
+    return neighborRegexMatcher_;
+  }
+
+  const std::unordered_set<std::string>&
   getAreaIds() const {
-    std::unordered_set<std::string> ids;
-    for (auto const& [id, _] : areaConfigs_) {
-      ids.insert(id);
-    }
-    return ids;
+    return areaIds_;
   }
 
   //
@@ -240,6 +356,24 @@ class Config {
     return *config_.spark_config_ref();
   }
 
+  std::chrono::milliseconds
+  getSparkKeepAliveTime() const {
+    const auto& sparkConfig = getSparkConfig();
+    if (auto keepAliveTimeMs = sparkConfig.keepalive_time_ms_ref()) {
+      return std::chrono::milliseconds(*keepAliveTimeMs);
+    }
+    return std::chrono::seconds(*sparkConfig.keepalive_time_s_ref());
+  }
+
+  std::chrono::milliseconds
+  getSparkHoldTime() const {
+    const auto& sparkConfig = getSparkConfig();
+    if (auto holdTimeMs = sparkConfig.hold_time_ms_ref()) {
+      return std::chrono::milliseconds(*holdTimeMs);
+    }
+    return std::chrono::seconds(*sparkConfig.hold_time_s_ref());
+  }
+
   //
   // kvstore
   //
@@ -269,6 +403,60 @@ class Config {
     return *config_.decision_config_ref()->enable_bgp_route_programming_ref();
   }
 
+  bool
+  isIncrementalSpfEnabled() const {
+    return *config_.decision_config_ref()->enable_incremental_spf_ref();
+  }
+
+  bool
+  isScopedRouteRebuildEnabled() const {
+    return *config_.decision_config_ref()->enable_scoped_route_rebuild_ref() and
+        not isUcmpEnabled() and not isLfaEnabled();
+  }
+
+  bool
+  isRebuildCostModelEnabled() const {
+    return *config_.decision_config_ref()->enable_rebuild_cost_model_ref();
+  }
+
+  bool
+  isLfaEnabled() const {
+    return *config_.decision_config_ref()->enable_lfa_ref();
+  }
+
+  const std::vector<std::string>&
+  getPriorityPrefixTags() const {
+    return *config_.decision_config_ref()->priority_prefix_tags_ref();
+  }
+
+  const std::vector<std::string>&
+  getPriorityPrefixes() const {
+    return *config_.decision_config_ref()->priority_prefixes_ref();
+  }
+
+  size_t
+  getSpfNumThreads() const {
+    return *config_.decision_config_ref()->spf_num_threads_ref();
+  }
+
+  bool
+  isAdaptiveDebounceEnabled() const {
+    return *config_.decision_config_ref()->enable_adaptive_debounce_ref();
+  }
+
+  size_t
+  getPublicationDecodeNumThreads() const {
+    return *config_.decision_config_ref()
+                ->publication_decode_num_threads_ref();
+  }
+
+  std::optional<std::string>
+  getPublicationCaptureFile() const {
+    return config_.decision_config_ref()
+        ->publication_capture_file_ref()
+        .to_optional();
+  }
+
   //
   // link monitor
   //
@@ -391,6 +579,14 @@ class Config {
     return *config_.monitor_config_ref();
   }
 
+  //
+  // fib
+  //
+  const thrift::FibConfig&
+  getFibConfig() const {
+    return *config_.fib_config_ref();
+  }
+
   //
   // policy
   //
@@ -593,6 +789,9 @@ class Config {
   // validate Link Monitor config
   void checkLinkMonitorConfig() const;
 
+  // validate Fib config
+  void checkFibConfig() const;
+
   // validate Segment Routing config
   void checkSegmentRoutingConfig() const;
 
@@ -608,6 +807,9 @@ class Config {
   // validate thrift server config
   void checkThriftServerConfig() const;
 
+  // validate thread scheduling config
+  void checkThreadSchedulingConfig() const;
+
   // thrift config
   thrift::OpenrConfig config_;
   // prefix allocation
@@ -616,6 +818,13 @@ class Config {
   // areaId -> neighbor regex and interface regex mapped
   std::unordered_map<std::string /* areaId */, AreaConfiguration> areaConfigs_;
 
+  // ids of areaConfigs_
+  std::unordered_set<std::string> areaIds_;
+
+  // interface and neighbor regexes of all areas
+  std::shared_ptr<const InterfaceRegexMatcher> interfaceRegexMatcher_;
+  std::shared_ptr<const NeighborRegexMatcher> neighborRegexMatcher_;
+
 // per class placeholder for test code
 // only need to be setup once here
 #ifdef Config_TEST_FRIENDS
@@ -415,6 +415,78 @@ TEST(ConfigTest, AreaConfiguration) {
   EXPECT_FALSE(areaConf.shouldRedistributeIface(""));
 }
 
+TEST(ConfigTest, InterfaceRegexMatcher) {
+  openr::thrift::AreaConfig area1;
+  area1.area_id_ref() = "area1";
+  area1.include_interface_regexes_ref()->emplace_back("iface.*");
+  area1.exclude_interface_regexes_ref()->emplace_back(".*400.*");
+  area1.redistribute_interface_regexes_ref()->emplace_back("loopback1");
+  openr::thrift::AreaConfig area2;
+  area2.area_id_ref() = "area2";
+  area2.include_interface_regexes_ref()->emplace_back("iface4.*");
+  area2.redistribute_interface_regexes_ref()->emplace_back("loopback.*");
+  openr::thrift::AreaConfig area3;
+  area3.area_id_ref() = "area3";
+  Config cfg{getBasicOpenrConfig("node-1", {area3, area2, area1})};
+
+  // decisions of all areas match the ones of every area
+  auto matcher = cfg.getInterfaceRegexMatcher();
+  for (const auto& ifName :
+       {"iface20", "iface400", "IFACE450", "loopback1", "loopback10", ""}) {
+    std::vector<std::string> discoverAreas, redistAreas;
+    for (const auto& areaId : {"area1", "area2", "area3"}) {
+      const auto& areaConf = cfg.getAreas().at(areaId);
+      if (areaConf.shouldDiscoverOnIface(ifName)) {
+        discoverAreas.emplace_back(areaId);
+      }
+      if (areaConf.shouldRedistributeIface(ifName)) {
+        redistAreas.emplace_back(areaId);
+      }
+    }
+    const auto result = matcher->match(ifName);
+    EXPECT_EQ(discoverAreas, result.discoverAreas) << ifName;
+    EXPECT_EQ(redistAreas, result.redistributeAreas) << ifName;
+  }
+
+  EXPECT_EQ(
+      std::vector<std::string>({"area2"}),
+      matcher->match("iface400").discoverAreas);
+  EXPECT_EQ(
+      std::vector<std::string>({"area1", "area2"}),
+      matcher->match("loopback1").redistributeAreas);
+}
+
+TEST(ConfigTest, NeighborRegexMatcher) {
+  openr::thrift::AreaConfig area1;
+  area1.area_id_ref() = "area1";
+  area1.neighbor_regexes_ref()->emplace_back("fsw.*");
+  openr::thrift::AreaConfig area2;
+  area2.area_id_ref() = "area2";
+  area2.neighbor_regexes_ref()->emplace_back("fsw00.*");
+  area2.neighbor_regexes_ref()->emplace_back("rsw.*");
+  openr::thrift::AreaConfig area3;
+  area3.area_id_ref() = "area3";
+  Config cfg{getBasicOpenrConfig("node-1", {area3, area2, area1})};
+
+  // decisions of all areas match the ones of every area
+  auto matcher = cfg.getNeighborRegexMatcher();
+  for (const auto& neighbor : {"fsw001", "FSW100", "rsw001", "ssw001", ""}) {
+    std::vector<std::string> areas;
+    for (const auto& areaId : {"area1", "area2", "area3"}) {
+      if (cfg.getAreas().at(areaId).shouldPeerWithNeighbor(neighbor)) {
+        areas.emplace_back(areaId);
+      }
+    }
+    EXPECT_EQ(areas, matcher->match(neighbor)) << neighbor;
+  }
+
+  EXPECT_EQ(
+      std::vector<std::string>({"area1", "area2"}), matcher->match("fsw001"));
+  EXPECT_EQ(
+      std::unordered_set<std::string>({"area1", "area2", "area3"}),
+      cfg.getAreaIds());
+}
+
 TEST(ConfigTest, BgpTranslationConfig) {
   auto tConfig = getBasicOpenrConfig();
   tConfig.enable_bgp_peering_ref() = true;
@@ -488,6 +560,15 @@ TEST(ConfigTest, PopulateInternalDb) {
         ->flood_msg_burst_size_ref() = 0;
     EXPECT_THROW((Config(confInvalidFloodMsgPerSec)), std::out_of_range);
   }
+  // flood_batch max_window_ms < min_window_ms
+  {
+    auto confInvalidFloodBatch = getBasicOpenrConfig();
+    thrift::KvstoreFloodBatch floodBatch;
+    floodBatch.min_window_ms_ref() = 100;
+    floodBatch.max_window_ms_ref() = 10;
+    confInvalidFloodBatch.kvstore_config_ref()->flood_batch_ref() = floodBatch;
+    EXPECT_THROW((Config(confInvalidFloodBatch)), std::out_of_range);
+  }
 
   // Spark
 
@@ -546,6 +627,56 @@ TEST(ConfigTest, PopulateInternalDb) {
     EXPECT_THROW(auto c = Config(confInvalidSpark), std::invalid_argument);
   }
 
+  // Exception: keepalive_time_ms <= 0
+  {
+    auto confInvalidSpark = getBasicOpenrConfig();
+    confInvalidSpark.spark_config_ref()->keepalive_time_ms_ref() = 0;
+    EXPECT_THROW(auto c = Config(confInvalidSpark), std::out_of_range);
+  }
+
+  // Exception: keepalive_time_ms > hold time
+  {
+    auto confInvalidSpark = getBasicOpenrConfig();
+    confInvalidSpark.spark_config_ref()->keepalive_time_ms_ref() = 100;
+    confInvalidSpark.spark_config_ref()->hold_time_ms_ref() = 50;
+    EXPECT_THROW(auto c = Config(confInvalidSpark), std::invalid_argument);
+  }
+
+  // Exception: max_keepalive_time_ms < keepalive time
+  {
+    auto confInvalidSpark = getBasicOpenrConfig();
+    confInvalidSpark.spark_config_ref()->keepalive_time_ms_ref() = 100;
+    confInvalidSpark.spark_config_ref()->hold_time_ms_ref() = 400;
+    confInvalidSpark.spark_config_ref()->max_keepalive_time_ms_ref() = 50;
+    EXPECT_THROW(auto c = Config(confInvalidSpark), std::invalid_argument);
+  }
+
+  // Exception: hold time <= 2 * keepalive time under adaptive keep-alive
+  {
+    auto confInvalidSpark = getBasicOpenrConfig();
+    confInvalidSpark.spark_config_ref()->keepalive_time_ms_ref() = 100;
+    confInvalidSpark.spark_config_ref()->hold_time_ms_ref() = 200;
+    confInvalidSpark.spark_config_ref()->max_keepalive_time_ms_ref() = 800;
+    EXPECT_THROW(auto c = Config(confInvalidSpark), std::invalid_argument);
+  }
+
+  // Exception: num_shards <= 0
+  {
+    auto confInvalidSpark = getBasicOpenrConfig();
+    confInvalidSpark.spark_config_ref()->num_shards_ref() = 0;
+    EXPECT_THROW(auto c = Config(confInvalidSpark), std::out_of_range);
+  }
+
+  // Fast failure detection overrides keepalive_time_s and hold_time_s
+  {
+    auto confFastSpark = getBasicOpenrConfig();
+    confFastSpark.spark_config_ref()->keepalive_time_ms_ref() = 20;
+    confFastSpark.spark_config_ref()->hold_time_ms_ref() = 80;
+    auto config = Config(confFastSpark);
+    EXPECT_EQ(std::chrono::milliseconds(20), config.getSparkKeepAliveTime());
+    EXPECT_EQ(std::chrono::milliseconds(80), config.getSparkHoldTime());
+  }
+
   // Exception step_detector_fast_window_size >= 0
   //           step_detector_slow_window_size >= 0
   //           step_detector_lower_threshold >= 0
@@ -599,6 +730,19 @@ TEST(ConfigTest, PopulateInternalDb) {
     confInvalidMon.monitor_config_ref()->max_event_log_ref() = -1;
     EXPECT_THROW(auto c = Config(confInvalidMon), std::out_of_range);
   }
+  // Exception event_log_rate_limits > 0
+  {
+    auto confInvalidMon = getBasicOpenrConfig();
+    confInvalidMon.monitor_config_ref()->event_log_rate_limits_ref() = {
+        {"NEIGHBOR_UP", 0}};
+    EXPECT_THROW(auto c = Config(confInvalidMon), std::out_of_range);
+  }
+  // Exception process_counters_interval_s > 0
+  {
+    auto confInvalidMon = getBasicOpenrConfig();
+    confInvalidMon.monitor_config_ref()->process_counters_interval_s_ref() = 0;
+    EXPECT_THROW(auto c = Config(confInvalidMon), std::out_of_range);
+  }
 
   // link monitor
 
@@ -624,6 +768,83 @@ TEST(ConfigTest, PopulateInternalDb) {
         300000;
     EXPECT_THROW(auto c = Config(confInvalidLm), std::out_of_range);
   }
+  // rtt_metric_min_change_pct < 0
+  {
+    auto confInvalidLm = getBasicOpenrConfig();
+    confInvalidLm.link_monitor_config_ref()->rtt_metric_min_change_pct_ref() =
+        -1;
+    EXPECT_THROW(auto c = Config(confInvalidLm), std::out_of_range);
+  }
+  // rtt_metric_dwell_time_ms < 0
+  {
+    auto confInvalidLm = getBasicOpenrConfig();
+    confInvalidLm.link_monitor_config_ref()->rtt_metric_dwell_time_ms_ref() =
+        -1;
+    EXPECT_THROW(auto c = Config(confInvalidLm), std::out_of_range);
+  }
+  // linkflap_dampening_config half_life_ms <= 0
+  {
+    auto confInvalidLm = getBasicOpenrConfig();
+    thrift::LinkFlapDampeningConfig dampConf;
+    dampConf.half_life_ms_ref() = 0;
+    confInvalidLm.link_monitor_config_ref()->linkflap_dampening_config_ref() =
+        dampConf;
+    EXPECT_THROW(auto c = Config(confInvalidLm), std::out_of_range);
+  }
+  // linkflap_dampening_config reuse_threshold >= suppress_threshold
+  {
+    auto confInvalidLm = getBasicOpenrConfig();
+    thrift::LinkFlapDampeningConfig dampConf;
+    dampConf.reuse_threshold_ref() = 2000;
+    dampConf.suppress_threshold_ref() = 2000;
+    confInvalidLm.link_monitor_config_ref()->linkflap_dampening_config_ref() =
+        dampConf;
+    EXPECT_THROW(auto c = Config(confInvalidLm), std::out_of_range);
+  }
+  // rtt_metric_ewma_weight_pct not in (0, 100]
+  {
+    auto confInvalidLm = getBasicOpenrConfig();
+    confInvalidLm.link_monitor_config_ref()->rtt_metric_ewma_weight_pct_ref() =
+        0;
+    EXPECT_THROW(auto c = Config(confInvalidLm), std::out_of_range);
+    confInvalidLm.link_monitor_config_ref()->rtt_metric_ewma_weight_pct_ref() =
+        101;
+    EXPECT_THROW(auto c = Config(confInvalidLm), std::out_of_range);
+  }
+  // adj_db_serialize_num_threads < 0
+  {
+    auto confInvalidLm = getBasicOpenrConfig();
+    confInvalidLm.link_monitor_config_ref()
+        ->adj_db_serialize_num_threads_ref() = -1;
+    EXPECT_THROW(auto c = Config(confInvalidLm), std::out_of_range);
+  }
+
+  // fib
+
+  // route_programming_chunk_size < 0
+  {
+    auto confInvalidFib = getBasicOpenrConfig();
+    confInvalidFib.fib_config_ref()->route_programming_chunk_size_ref() = -1;
+    EXPECT_THROW(auto c = Config(confInvalidFib), std::out_of_range);
+  }
+  // max_inflight_chunks < 1
+  {
+    auto confInvalidFib = getBasicOpenrConfig();
+    confInvalidFib.fib_config_ref()->max_inflight_chunks_ref() = 0;
+    EXPECT_THROW(auto c = Config(confInvalidFib), std::out_of_range);
+  }
+  // differential_sync_ranges < 1
+  {
+    auto confInvalidFib = getBasicOpenrConfig();
+    confInvalidFib.fib_config_ref()->differential_sync_ranges_ref() = 0;
+    EXPECT_THROW(auto c = Config(confInvalidFib), std::out_of_range);
+  }
+  // enable_route_streaming without chunking
+  {
+    auto confInvalidFib = getBasicOpenrConfig();
+    confInvalidFib.fib_config_ref()->enable_route_streaming_ref() = true;
+    EXPECT_THROW(auto c = Config(confInvalidFib), std::invalid_argument);
+  }
 
   // prefix allocation
 
@@ -727,6 +948,36 @@ TEST(ConfigTest, PopulateInternalDb) {
     EXPECT_THROW((Config(confInvalid)), std::invalid_argument);
   }
 
+  // heap profile threshold out of range
+  {
+    auto confInvalid = getBasicOpenrConfig();
+    confInvalid.enable_watchdog_ref() = true;
+    thrift::WatchdogConfig watchdogConf;
+    watchdogConf.heap_profile_thresholds_pct_ref() = {70, 120};
+    confInvalid.watchdog_config_ref() = watchdogConf;
+    EXPECT_THROW((Config(confInvalid)), std::invalid_argument);
+  }
+
+  // no heap profile kept
+  {
+    auto confInvalid = getBasicOpenrConfig();
+    confInvalid.enable_watchdog_ref() = true;
+    thrift::WatchdogConfig watchdogConf;
+    watchdogConf.heap_profile_max_dumps_ref() = 0;
+    confInvalid.watchdog_config_ref() = watchdogConf;
+    EXPECT_THROW((Config(confInvalid)), std::invalid_argument);
+  }
+
+  // stall threshold finer than heartbeat timer
+  {
+    auto confInvalid = getBasicOpenrConfig();
+    confInvalid.enable_watchdog_ref() = true;
+    thrift::WatchdogConfig watchdogConf;
+    watchdogConf.stall_threshold_ms_ref() = 50;
+    confInvalid.watchdog_config_ref() = watchdogConf;
+    EXPECT_THROW((Config(confInvalid)), std::invalid_argument);
+  }
+
   // vip service
   {
     auto conf = getBasicOpenrConfig();
@@ -767,6 +1018,68 @@ TEST(ConfigTest, PopulateInternalDb) {
     conf.route_delete_delay_ms_ref() = 1000;
     EXPECT_NO_THROW((Config(conf)));
   }
+
+  // Netlink event coalescing
+  {
+    auto conf = getBasicOpenrConfig();
+    conf.netlink_event_coalescing_ms_ref() = -1;
+    EXPECT_THROW((Config(conf)), std::invalid_argument);
+
+    conf.netlink_event_coalescing_ms_ref() = 100;
+    EXPECT_EQ(
+        std::chrono::milliseconds(100),
+        Config(conf).getNetlinkEventCoalescingWindow());
+  }
+
+  // Prefix key shards
+  {
+    auto conf = getBasicOpenrConfig();
+    EXPECT_EQ(0, Config(conf).getPrefixKeyShards());
+
+    conf.prefix_key_shards_ref() = -1;
+    EXPECT_THROW((Config(conf)), std::invalid_argument);
+
+    conf.prefix_key_shards_ref() = 16;
+    EXPECT_EQ(16, Config(conf).getPrefixKeyShards());
+  }
+
+  // Policy evaluation threads
+  {
+    auto conf = getBasicOpenrConfig();
+    EXPECT_EQ(0, Config(conf).getPolicyNumThreads());
+
+    conf.policy_num_threads_ref() = -1;
+    EXPECT_THROW((Config(conf)), std::invalid_argument);
+
+    conf.policy_num_threads_ref() = 4;
+    EXPECT_EQ(4, Config(conf).getPolicyNumThreads());
+  }
+
+  // Ctrl server worker pools
+  {
+    auto conf = getBasicOpenrConfig();
+    conf.thrift_server_ref()->num_peer_sync_threads_ref() = 0;
+    EXPECT_THROW((Config(conf)), std::invalid_argument);
+
+    conf.thrift_server_ref()->num_peer_sync_threads_ref() = 2;
+    conf.thrift_server_ref()->num_ctrl_threads_ref() = 4;
+    EXPECT_NO_THROW((Config(conf)));
+  }
+
+  // Adaptive prefix sync throttle
+  {
+    auto conf = getBasicOpenrConfig();
+    EXPECT_EQ(
+        std::chrono::milliseconds(0), Config(conf).getPrefixSyncMaxThrottle());
+
+    conf.prefix_sync_max_throttle_ms_ref() = -1;
+    EXPECT_THROW((Config(conf)), std::invalid_argument);
+
+    conf.prefix_sync_max_throttle_ms_ref() = 500;
+    EXPECT_EQ(
+        std::chrono::milliseconds(500),
+        Config(conf).getPrefixSyncMaxThrottle());
+  }
 }
 
 TEST(ConfigTest, GeneralGetter) {
@@ -847,6 +1160,61 @@ TEST(ConfigTest, KvstoreGetter) {
   EXPECT_EQ(std::chrono::milliseconds(300000), config.getKvStoreKeyTtl());
 }
 
+TEST(ConfigTest, ThreadSchedulingConfig) {
+  // spark default and fallback of shards
+  {
+    auto tConfig = getBasicOpenrConfig();
+    auto config = Config(tConfig);
+    EXPECT_FALSE(config.getThreadSchedulingConfig("kvstore").has_value());
+    EXPECT_TRUE(config.getIsolatedCpus().empty());
+    for (const auto& name : {"spark", "spark_1"}) {
+      const auto sparkConf = config.getThreadSchedulingConfig(name);
+      ASSERT_TRUE(sparkConf.has_value());
+      EXPECT_EQ(
+          thrift::ThreadSchedulingPolicy::ROUND_ROBIN,
+          *sparkConf->policy_ref());
+      EXPECT_EQ(1, *sparkConf->priority_ref());
+    }
+  }
+  // explicit config and isolated cpus
+  {
+    auto tConfig = getBasicOpenrConfig();
+    thrift::ThreadSchedulingConfig sparkConf;
+    sparkConf.cpus_ref() = {3, 2};
+    sparkConf.isolate_ref() = true;
+    thrift::ThreadSchedulingConfig decisionConf;
+    decisionConf.cpus_ref() = {1};
+    decisionConf.priority_ref() = -5;
+    tConfig.thread_scheduling_ref() = {
+        {"spark", sparkConf}, {"decision", decisionConf}};
+    auto config = Config(tConfig);
+    EXPECT_EQ(sparkConf, config.getThreadSchedulingConfig("spark_2"));
+    EXPECT_EQ(decisionConf, config.getThreadSchedulingConfig("decision"));
+    EXPECT_EQ((std::vector<int32_t>{2, 3}), config.getIsolatedCpus());
+  }
+  // invalid priority
+  {
+    auto tConfig = getBasicOpenrConfig();
+    thrift::ThreadSchedulingConfig schedConf;
+    schedConf.policy_ref() = thrift::ThreadSchedulingPolicy::FIFO;
+    tConfig.thread_scheduling_ref() = {{"fib", schedConf}};
+    EXPECT_THROW((Config(tConfig)), std::out_of_range);
+
+    schedConf.policy_ref() = thrift::ThreadSchedulingPolicy::DEFAULT;
+    schedConf.priority_ref() = 20;
+    tConfig.thread_scheduling_ref() = {{"fib", schedConf}};
+    EXPECT_THROW((Config(tConfig)), std::out_of_range);
+  }
+  // isolation without cpus
+  {
+    auto tConfig = getBasicOpenrConfig();
+    thrift::ThreadSchedulingConfig schedConf;
+    schedConf.isolate_ref() = true;
+    tConfig.thread_scheduling_ref() = {{"fib", schedConf}};
+    EXPECT_THROW((Config(tConfig)), std::invalid_argument);
+  }
+}
+
 TEST(ConfigTest, LinkMonitorGetter) {
   auto tConfig = getBasicOpenrConfig();
   // set empty area list to see doamin get converted to area
@@ -938,4 +1306,19 @@ TEST(ConfigTest, EorTime) {
   }
 }
 
+TEST(ConfigTest, ChangedFields) {
+  const auto tConfig = getBasicOpenrConfig();
+  EXPECT_TRUE(Config::getChangedFields(tConfig, tConfig).empty());
+
+  // field changed, as well as field set on one side only
+  auto newConfig = tConfig;
+  thrift::OriginatedPrefix originatedPrefix;
+  originatedPrefix.prefix_ref() = "10.0.0.0/8";
+  newConfig.originated_prefixes_ref() = {originatedPrefix};
+  *newConfig.node_name_ref() = "other-node";
+  const std::vector<std::string> expFields{"node_name", "originated_prefixes"};
+  EXPECT_EQ(expFields, Config::getChangedFields(tConfig, newConfig));
+  EXPECT_EQ(expFields, Config::getChangedFields(newConfig, tConfig));
+}
+
 } // namespace openr
@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <fb303/ServiceData.h>
+#include <fmt/format.h>
+#include <thrift/lib/cpp2/server/Cpp2ConnContext.h>
+
+#include <openr/ctrl-server/CtrlApiStatsCollector.h>
+
+namespace fb303 = facebook::fb303;
+
+namespace openr {
+
+namespace {
+
+std::chrono::microseconds
+elapsed(
+    CtrlApiStatsCollector::Clock::time_point from,
+    CtrlApiStatsCollector::Clock::time_point to) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(to - from);
+}
+
+} // namespace
+
+CtrlApiStatsCollector::MethodStats::MethodStats(folly::StringPiece method)
+    : callsKey(fmt::format("ctrl.api.{}.calls", method)),
+      errorsKey(fmt::format("ctrl.api.{}.errors", method)),
+      bytesOutKey(fmt::format("ctrl.api.{}.bytes_out", method)) {}
+
+void*
+CtrlApiStatsCollector::getContext(
+    const char* /* fnName */,
+    apache::thrift::TConnectionContext* connContext) {
+  auto* ctx = new CallContext();
+  ctx->start = Clock::now();
+  // Requests are timestamped by thrift server when read off the socket
+  if (auto* reqContext =
+          dynamic_cast<apache::thrift::Cpp2RequestContext*>(connContext)) {
+    const auto readEnd = reqContext->getTimestamps().readEnd;
+    if (readEnd != Clock::time_point() and readEnd <= ctx->start) {
+      ctx->queueTime = elapsed(readEnd, ctx->start);
+    }
+  }
+  return ctx;
+}
+
+void
+CtrlApiStatsCollector::freeContext(void* ctx, const char* fnName) {
+  if (not ctx) {
+    return;
+  }
+  std::unique_ptr<CallContext> call(static_cast<CallContext*>(ctx));
+  const auto now = Clock::now();
+
+  // Streams and oneway methods may complete without writing a response
+  const auto moduleStart =
+      call->postRead != Clock::time_point() ? call->postRead : call->start;
+  const auto moduleEnd =
+      call->preWrite != Clock::time_point() ? call->preWrite : now;
+  recordCall(
+      fnName,
+      call->queueTime,
+      elapsed(moduleStart, std::max(moduleStart, moduleEnd)),
+      call->serializationTime,
+      call->bytesOut,
+      call->isError,
+      now);
+}
+
+void
+CtrlApiStatsCollector::preRead(void* ctx, const char* /* fnName */) {
+  static_cast<CallContext*>(ctx)->preRead = Clock::now();
+}
+
+void
+CtrlApiStatsCollector::postRead(
+    void* ctx,
+    const char* /* fnName */,
+    apache::thrift::transport::THeader* /* header */,
+    uint32_t /* bytes */) {
+  auto* call = static_cast<CallContext*>(ctx);
+  call->postRead = Clock::now();
+  if (call->preRead != Clock::time_point()) {
+    call->serializationTime += elapsed(call->preRead, call->postRead);
+  }
+}
+
+void
+CtrlApiStatsCollector::preWrite(void* ctx, const char* /* fnName */) {
+  static_cast<CallContext*>(ctx)->preWrite = Clock::now();
+}
+
+void
+CtrlApiStatsCollector::postWrite(
+    void* ctx, const char* /* fnName */, uint32_t bytes) {
+  auto* call = static_cast<CallContext*>(ctx);
+  if (call->preWrite != Clock::time_point()) {
+    call->serializationTime += elapsed(call->preWrite, Clock::now());
+  }
+  call->bytesOut += bytes;
+}
+
+void
+CtrlApiStatsCollector::handlerError(void* ctx, const char* /* fnName */) {
+  static_cast<CallContext*>(ctx)->isError = true;
+}
+
+void
+CtrlApiStatsCollector::userException(
+    void* ctx,
+    const char* /* fnName */,
+    const std::string& /* ex */,
+    const std::string& /* exWhat */) {
+  static_cast<CallContext*>(ctx)->isError = true;
+}
+
+void
+CtrlApiStatsCollector::recordCall(
+    folly::StringPiece method,
+    std::optional<std::chrono::microseconds> queueTime,
+    std::chrono::microseconds moduleTime,
+    std::chrono::microseconds serializationTime,
+    int64_t bytesOut,
+    bool isError,
+    Clock::time_point now) {
+  auto stats = stats_.wlock();
+  auto it = stats->find(method);
+  if (it == stats->end()) {
+    it = stats->emplace(method.str(), MethodStats(method)).first;
+  }
+  auto& methodStats = it->second;
+
+  ++methodStats.calls;
+  methodStats.bytesOut += bytesOut;
+  fb303::fbData->addStatValue(methodStats.callsKey, 1, fb303::COUNT);
+  fb303::fbData->addStatValue(methodStats.bytesOutKey, bytesOut, fb303::SUM);
+  if (isError) {
+    ++methodStats.errors;
+    fb303::fbData->addStatValue(methodStats.errorsKey, 1, fb303::COUNT);
+  }
+
+  auto totalTime = moduleTime + serializationTime;
+  if (queueTime.has_value()) {
+    methodStats.queueTime.addValue(*queueTime, now);
+    totalTime += *queueTime;
+  }
+  methodStats.moduleTime.addValue(moduleTime, now);
+  methodStats.serializationTime.addValue(serializationTime, now);
+  methodStats.totalTime.addValue(totalTime, now);
+}
+
+std::map<std::string, thrift::CtrlApiStats>
+CtrlApiStatsCollector::getStats() const {
+  const auto now = Clock::now();
+  std::map<std::string, thrift::CtrlApiStats> result;
+  auto stats = stats_.rlock();
+  for (const auto& [method, methodStats] : *stats) {
+    auto& apiStats = result[method];
+    apiStats.calls_ref() = methodStats.calls;
+    apiStats.errors_ref() = methodStats.errors;
+    apiStats.bytesOut_ref() = methodStats.bytesOut;
+    apiStats.queueTimeP50Us_ref() =
+        methodStats.queueTime.getPercentile(50, now).count();
+    apiStats.queueTimeP99Us_ref() =
+        methodStats.queueTime.getPercentile(99, now).count();
+    apiStats.moduleTimeP50Us_ref() =
+        methodStats.moduleTime.getPercentile(50, now).count();
+    apiStats.moduleTimeP99Us_ref() =
+        methodStats.moduleTime.getPercentile(99, now).count();
+    apiStats.serializationTimeP50Us_ref() =
+        methodStats.serializationTime.getPercentile(50, now).count();
+    apiStats.serializationTimeP99Us_ref() =
+        methodStats.serializationTime.getPercentile(99, now).count();
+    apiStats.totalTimeP50Us_ref() =
+        methodStats.totalTime.getPercentile(50, now).count();
+    apiStats.totalTimeP99Us_ref() =
+        methodStats.totalTime.getPercentile(99, now).count();
+  }
+  return result;
+}
+
+void
+CtrlApiStatsCollector::getCounters(
+    std::map<std::string, int64_t>& counters) const {
+  for (const auto& [method, apiStats] : getStats()) {
+    const auto prefix = fmt::format("ctrl.api.{}", method);
+    counters[prefix + ".queue_time_us.p50"] = *apiStats.queueTimeP50Us_ref();
+    counters[prefix + ".queue_time_us.p99"] = *apiStats.queueTimeP99Us_ref();
+    counters[prefix + ".module_time_us.p50"] = *apiStats.moduleTimeP50Us_ref();
+    counters[prefix + ".module_time_us.p99"] = *apiStats.moduleTimeP99Us_ref();
+    counters[prefix + ".serialization_time_us.p50"] =
+        *apiStats.serializationTimeP50Us_ref();
+    counters[prefix + ".serialization_time_us.p99"] =
+        *apiStats.serializationTimeP99Us_ref();
+    counters[prefix + ".total_time_us.p50"] = *apiStats.totalTimeP50Us_ref();
+    counters[prefix + ".total_time_us.p99"] = *apiStats.totalTimeP99Us_ref();
+  }
+}
+
+} // namespace openr
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <optional>
+#include <string>
+
+#include <folly/Range.h>
+#include <folly/Synchronized.h>
+#include <folly/container/F14Map.h>
+#include <thrift/lib/cpp/TProcessorEventHandler.h>
+
+#include <openr/common/LatencyHistogram.h>
+#include <openr/if/gen-cpp2/OpenrCtrl_types.h>
+
+namespace openr {
+
+/**
+ * [Ctrl Stats] Per-method stats of ctrl thrift APIs, registered as thrift
+ * processor event handler so that every method is instrumented without
+ * touching its implementation. Latency of every call is split into
+ * - queue: from request being read off the socket till it's picked up by a
+ *   worker thread. Recorded only if thrift server timestamped the request.
+ * - module: from arguments being deserialized till response is ready to be
+ *   serialized, i.e. time spent by handler and the modules it calls into
+ * - serialization: deserialization of arguments and serialization of response
+ *
+ * Calls, errors and bytes out are exported as fb303 stats on completion of
+ * every call. Percentiles are computed on demand only, see getCounters().
+ *
+ * NOTE: Thread-safe
+ */
+class CtrlApiStatsCollector : public apache::thrift::TProcessorEventHandler {
+ public:
+  using Clock = LatencyHistogram::Clock;
+
+  //
+  // apache::thrift::TProcessorEventHandler
+  //
+
+  void* getContext(
+      const char* fnName,
+      apache::thrift::TConnectionContext* connContext) override;
+
+  void freeContext(void* ctx, const char* fnName) override;
+
+  void preRead(void* ctx, const char* fnName) override;
+
+  void postRead(
+      void* ctx,
+      const char* fnName,
+      apache::thrift::transport::THeader* header,
+      uint32_t bytes) override;
+
+  void preWrite(void* ctx, const char* fnName) override;
+
+  void postWrite(void* ctx, const char* fnName, uint32_t bytes) override;
+
+  void handlerError(void* ctx, const char* fnName) override;
+
+  void userException(
+      void* ctx,
+      const char* fnName,
+      const std::string& ex,
+      const std::string& exWhat) override;
+
+  // Stats of all methods called so far, keyed by method name
+  std::map<std::string, thrift::CtrlApiStats> getStats() const;
+
+  // Add latency percentiles of all methods to `counters`
+  void getCounters(std::map<std::string, int64_t>& counters) const;
+
+  /**
+   * Record a completed call. Exposed for testing, called from freeContext()
+   * otherwise.
+   */
+  void recordCall(
+      folly::StringPiece method,
+      std::optional<std::chrono::microseconds> queueTime,
+      std::chrono::microseconds moduleTime,
+      std::chrono::microseconds serializationTime,
+      int64_t bytesOut,
+      bool isError,
+      Clock::time_point now);
+
+ private:
+  // Timestamps of an in-flight call, passed around as event handler context
+  struct CallContext {
+    Clock::time_point start;
+    Clock::time_point preRead;
+    Clock::time_point postRead;
+    Clock::time_point preWrite;
+    std::optional<std::chrono::microseconds> queueTime;
+    std::chrono::microseconds serializationTime{0};
+    int64_t bytesOut{0};
+    bool isError{false};
+  };
+
+  struct MethodStats {
+    explicit MethodStats(folly::StringPiece method);
+
+    // fb303 stat keys, built once per method
+    std::string callsKey;
+    std::string errorsKey;
+    std::string bytesOutKey;
+
+    int64_t calls{0};
+    int64_t errors{0};
+    int64_t bytesOut{0};
+    LatencyHistogram queueTime;
+    LatencyHistogram moduleTime;
+    LatencyHistogram serializationTime;
+    LatencyHistogram totalTime;
+  };
+
+  // Method name is looked up without allocating, F14 supports heterogeneous
+  // lookup of string keys
+  folly::Synchronized<folly::F14FastMap<std::string, MethodStats>> stats_;
+};
+
+} // namespace openr
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include <folly/Synchronized.h>
+
+namespace openr {
+
+/**
+ * Cache of responses of a read-only ctrl API, keyed by the serialized
+ * arguments of the request. Every response is tagged with the state version
+ * of the owning module it was computed at, and is served only as long as the
+ * module reports the same version. Version must be read before computing the
+ * response, so a cached response is never older than its version.
+ *
+ * Cached responses are shared and immutable. Number of cached arguments is
+ * bounded by `maxEntries`, stale entries are dropped first when full.
+ *
+ * NOTE: Thread-safe
+ */
+template <typename Response>
+class CtrlResponseCache {
+ public:
+  explicit CtrlResponseCache(size_t maxEntries) : maxEntries_(maxEntries) {}
+
+  /**
+   * Cached response for `args` if it was computed at `version`, nullptr
+   * otherwise.
+   */
+  std::shared_ptr<const Response>
+  get(const std::string& args, int64_t version) const {
+    auto entries = entries_.rlock();
+    auto it = entries->find(args);
+    if (it == entries->end() or it->second.version != version) {
+      return nullptr;
+    }
+    return it->second.response;
+  }
+
+  /**
+   * Cache `response` for `args` computed at `version`. Entries computed at
+   * any other version are dropped if cache is full.
+   */
+  void
+  put(const std::string& args,
+      int64_t version,
+      std::shared_ptr<const Response> response) {
+    if (not enabled_.load(std::memory_order_relaxed)) {
+      return;
+    }
+    auto entries = entries_.wlock();
+    if (entries->size() >= maxEntries_ and not entries->count(args)) {
+      for (auto it = entries->begin(); it != entries->end();) {
+        it = it->second.version != version ? entries->erase(it) : ++it;
+      }
+      if (entries->size() >= maxEntries_) {
+        entries->clear();
+      }
+    }
+    auto& entry = (*entries)[args];
+    // keep response of later version in case of racing requests
+    if (entry.response and entry.version > version) {
+      return;
+    }
+    entry.version = version;
+    entry.response = std::move(response);
+  }
+
+  size_t
+  size() const {
+    return entries_.rlock()->size();
+  }
+
+  /**
+   * [Memory Governor] Drop all cached responses. Disabled cache keeps no
+   * responses until it is enabled again.
+   */
+  void
+  clear() {
+    entries_.wlock()->clear();
+  }
+
+  void
+  setEnabled(bool enabled) {
+    enabled_.store(enabled, std::memory_order_relaxed);
+    if (not enabled) {
+      clear();
+    }
+  }
+
+ private:
+  struct Entry {
+    int64_t version{0};
+    std::shared_ptr<const Response> response;
+  };
+
+  const size_t maxEntries_{0};
+  std::atomic<bool> enabled_{true};
+  folly::Synchronized<std::unordered_map<std::string, Entry>> entries_;
+};
+
+} // namespace openr
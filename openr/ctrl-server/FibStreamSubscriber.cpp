@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <openr/common/NetworkUtil.h>
+#include <openr/ctrl-server/FibStreamSubscriber.h>
+
+namespace openr {
+
+FibStreamBuffer::FibStreamBuffer(
+    size_t maxPendingDeltas, size_t maxPendingRoutes)
+    : maxPendingDeltas_(maxPendingDeltas),
+      maxPendingRoutes_(maxPendingRoutes) {}
+
+void
+FibStreamBuffer::push(thrift::RouteDatabaseDeltaDetail&& delta) {
+  // Routes are being dropped, remember what the delta touches
+  if (resync_) {
+    drop(delta);
+    return;
+  }
+
+  // Queue as is while there is a room and nothing is being conflated
+  if (numConflatingDeltas_ == 0 and deltas_.size() < maxPendingDeltas_) {
+    deltas_.emplace_back(std::move(delta));
+    return;
+  }
+
+  // Buffer is full. Conflate queued deltas along with the new one
+  while (not deltas_.empty()) {
+    conflate(std::move(deltas_.front()));
+    deltas_.pop_front();
+  }
+  conflate(std::move(delta));
+
+  if (conflatedUnicastRoutes_.size() + conflatedMplsRoutes_.size() <=
+      maxPendingRoutes_) {
+    return;
+  }
+
+  // Too many routes to conflate. Drop them and resync instead
+  resync_ = true;
+  for (const auto& [prefix, _] : conflatedUnicastRoutes_) {
+    droppedPrefixes_.emplace(prefix);
+  }
+  for (const auto& [label, _] : conflatedMplsRoutes_) {
+    droppedLabels_.emplace(label);
+  }
+  conflatedUnicastRoutes_.clear();
+  conflatedMplsRoutes_.clear();
+  numDroppedDeltas_ += numConflatingDeltas_;
+  numDroppingDeltas_ += numConflatingDeltas_;
+  numConflatingDeltas_ = 0;
+}
+
+std::optional<thrift::RouteDatabaseDeltaDetail>
+FibStreamBuffer::pop() {
+  if (not deltas_.empty()) {
+    auto delta = std::move(deltas_.front());
+    deltas_.pop_front();
+    return delta;
+  }
+
+  if (numConflatingDeltas_ == 0) {
+    return std::nullopt;
+  }
+
+  thrift::RouteDatabaseDeltaDetail delta;
+  for (auto& [prefix, route] : conflatedUnicastRoutes_) {
+    if (route.has_value()) {
+      delta.unicastRoutesToUpdate_ref()->emplace_back(std::move(*route));
+    } else {
+      delta.unicastRoutesToDelete_ref()->emplace_back(toIpPrefix(prefix));
+    }
+  }
+  for (auto& [label, route] : conflatedMplsRoutes_) {
+    if (route.has_value()) {
+      delta.mplsRoutesToUpdate_ref()->emplace_back(std::move(*route));
+    } else {
+      delta.mplsRoutesToDelete_ref()->emplace_back(label);
+    }
+  }
+  conflatedUnicastRoutes_.clear();
+  conflatedMplsRoutes_.clear();
+  numConflatingDeltas_ = 0;
+  return delta;
+}
+
+bool
+FibStreamBuffer::startResync() {
+  if (not resync_) {
+    return false;
+  }
+
+  resyncPrefixes_.merge(droppedPrefixes_);
+  resyncLabels_.merge(droppedLabels_);
+  droppedPrefixes_.clear();
+  droppedLabels_.clear();
+  numDroppingDeltas_ = 0;
+  resync_ = false;
+  ++numResyncs_;
+  return true;
+}
+
+thrift::RouteDatabaseDeltaDetail
+FibStreamBuffer::finishResync(const thrift::RouteDatabaseDetail& routeDb) {
+  thrift::RouteDatabaseDeltaDetail delta;
+
+  // Routes present in snapshot are updated, others are deleted
+  for (const auto& route : *routeDb.unicastRoutes_ref()) {
+    if (resyncPrefixes_.erase(
+            toIPNetwork(*route.unicastRoute_ref()->dest_ref()))) {
+      delta.unicastRoutesToUpdate_ref()->emplace_back(route);
+    }
+  }
+  for (const auto& prefix : resyncPrefixes_) {
+    delta.unicastRoutesToDelete_ref()->emplace_back(toIpPrefix(prefix));
+  }
+
+  for (const auto& route : *routeDb.mplsRoutes_ref()) {
+    if (resyncLabels_.erase(*route.mplsRoute_ref()->topLabel_ref())) {
+      delta.mplsRoutesToUpdate_ref()->emplace_back(route);
+    }
+  }
+  for (const auto& label : resyncLabels_) {
+    delta.mplsRoutesToDelete_ref()->emplace_back(label);
+  }
+
+  resyncPrefixes_.clear();
+  resyncLabels_.clear();
+  return delta;
+}
+
+void
+FibStreamBuffer::conflate(thrift::RouteDatabaseDeltaDetail&& delta) {
+  for (auto& route : *delta.unicastRoutesToUpdate_ref()) {
+    auto prefix = toIPNetwork(*route.unicastRoute_ref()->dest_ref());
+    conflatedUnicastRoutes_.insert_or_assign(prefix, std::move(route));
+  }
+  for (const auto& prefix : *delta.unicastRoutesToDelete_ref()) {
+    conflatedUnicastRoutes_.insert_or_assign(
+        toIPNetwork(prefix), std::nullopt);
+  }
+  for (auto& route : *delta.mplsRoutesToUpdate_ref()) {
+    auto label = *route.mplsRoute_ref()->topLabel_ref();
+    conflatedMplsRoutes_.insert_or_assign(label, std::move(route));
+  }
+  for (const auto& label : *delta.mplsRoutesToDelete_ref()) {
+    conflatedMplsRoutes_.insert_or_assign(label, std::nullopt);
+  }
+  ++numConflatingDeltas_;
+  ++numConflatedDeltas_;
+}
+
+void
+FibStreamBuffer::drop(const thrift::RouteDatabaseDeltaDetail& delta) {
+  for (const auto& route : *delta.unicastRoutesToUpdate_ref()) {
+    droppedPrefixes_.emplace(
+        toIPNetwork(*route.unicastRoute_ref()->dest_ref()));
+  }
+  for (const auto& prefix : *delta.unicastRoutesToDelete_ref()) {
+    droppedPrefixes_.emplace(toIPNetwork(prefix));
+  }
+  for (const auto& route : *delta.mplsRoutesToUpdate_ref()) {
+    droppedLabels_.emplace(*route.mplsRoute_ref()->topLabel_ref());
+  }
+  for (const auto& label : *delta.mplsRoutesToDelete_ref()) {
+    droppedLabels_.emplace(label);
+  }
+  ++numDroppingDeltas_;
+  ++numDroppedDeltas_;
+}
+
+} // namespace openr
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <folly/IPAddress.h>
+#if FOLLY_HAS_COROUTINES
+#include <folly/experimental/coro/Baton.h>
+#endif
+
+#include <openr/if/gen-cpp2/OpenrCtrl_types.h>
+#include <thrift/lib/cpp2/async/ServerPublisherStream.h>
+
+namespace openr {
+
+/**
+ * Bounded buffer of route deltas pending to be streamed to a subscriber.
+ *
+ * Deltas are queued as is up to `maxPendingDeltas`. Once full, the queued
+ * deltas are conflated into a single delta keeping only the latest update or
+ * delete of every prefix and label. Conflated deltas carry at most
+ * `maxPendingRoutes` routes. Past that, routes are dropped and only the
+ * prefixes and labels they touched are remembered. The subscriber then has to
+ * be resynced from a fresh route snapshot, see `startResync()`.
+ *
+ * Memory used by the buffer is hence bounded regardless of how far the
+ * subscriber falls behind.
+ *
+ * NOTE: Not thread-safe
+ */
+class FibStreamBuffer {
+ public:
+  FibStreamBuffer(size_t maxPendingDeltas, size_t maxPendingRoutes);
+
+  // Queue delta to be streamed
+  void push(thrift::RouteDatabaseDeltaDetail&& delta);
+
+  // Next delta to be streamed, std::nullopt if there is none or routes have
+  // been dropped and subscriber needs resync
+  std::optional<thrift::RouteDatabaseDeltaDetail> pop();
+
+  // Deltas pushed afterwards are buffered again and streamed after resync
+  // delta. Returns false if no resync is needed.
+  bool startResync();
+
+  // Delta resyncing the prefixes and labels of the dropped routes from
+  // `routeDb` snapshot taken after `startResync()`
+  thrift::RouteDatabaseDeltaDetail finishResync(
+      const thrift::RouteDatabaseDetail& routeDb);
+
+  bool
+  needsResync() const {
+    return resync_;
+  }
+
+  // Number of deltas pending to be streamed
+  size_t
+  numPendingDeltas() const {
+    return deltas_.size() + numConflatingDeltas_ + numDroppingDeltas_;
+  }
+
+  // Deltas conflated with others
+  int64_t
+  numConflatedDeltas() const {
+    return numConflatedDeltas_;
+  }
+
+  // Deltas dropped, their routes are resynced from snapshot instead
+  int64_t
+  numDroppedDeltas() const {
+    return numDroppedDeltas_;
+  }
+
+  int64_t
+  numResyncs() const {
+    return numResyncs_;
+  }
+
+ private:
+  // Merge delta into conflated routes
+  void conflate(thrift::RouteDatabaseDeltaDetail&& delta);
+
+  // Merge delta into the prefixes and labels to resync
+  void drop(const thrift::RouteDatabaseDeltaDetail& delta);
+
+  const size_t maxPendingDeltas_{0};
+  const size_t maxPendingRoutes_{0};
+
+  // Deltas queued as is
+  std::deque<thrift::RouteDatabaseDeltaDetail> deltas_;
+
+  // Latest update or delete (std::nullopt) of conflated prefixes and labels
+  std::unordered_map<
+      folly::CIDRNetwork,
+      std::optional<thrift::UnicastRouteDetail>>
+      conflatedUnicastRoutes_;
+  std::unordered_map<int32_t, std::optional<thrift::MplsRouteDetail>>
+      conflatedMplsRoutes_;
+  size_t numConflatingDeltas_{0};
+
+  // Prefixes and labels of dropped routes
+  bool resync_{false};
+  std::unordered_set<folly::CIDRNetwork> droppedPrefixes_;
+  std::unordered_set<int32_t> droppedLabels_;
+  size_t numDroppingDeltas_{0};
+
+  // Prefixes and labels being resynced
+  std::unordered_set<folly::CIDRNetwork> resyncPrefixes_;
+  std::unordered_set<int32_t> resyncLabels_;
+
+  int64_t numConflatedDeltas_{0};
+  int64_t numDroppedDeltas_{0};
+  int64_t numResyncs_{0};
+};
+
+/**
+ * State of a `subscribeFibDetail` stream
+ *
+ * With coroutines the stream is pulled by the client, see
+ * `OpenrCtrlHandler::streamFibDetail()`, and deltas wait in the bounded
+ * `buffer` until client is ready to receive them. Otherwise deltas are handed
+ * to `publisher` as they arrive.
+ */
+struct FibStreamSubscriber {
+  FibStreamSubscriber(
+      std::chrono::steady_clock::time_point upSince,
+      std::unique_ptr<apache::thrift::ServerStreamPublisher<
+          thrift::RouteDatabaseDeltaDetail>> publisher,
+      size_t maxPendingDeltas,
+      size_t maxPendingRoutes)
+      : upSince(upSince),
+        publisher(std::move(publisher)),
+        total_messages(0),
+        buffer(maxPendingDeltas, maxPendingRoutes) {}
+
+  std::chrono::steady_clock::time_point upSince;
+  std::unique_ptr<
+      apache::thrift::ServerStreamPublisher<thrift::RouteDatabaseDeltaDetail>>
+      publisher;
+  int64_t total_messages;
+  std::chrono::system_clock::time_point last_message_time;
+
+  FibStreamBuffer buffer;
+  // Set when the stream must be terminated
+  bool closed{false};
+#if FOLLY_HAS_COROUTINES
+  // Posted when buffer has a delta or stream is closed
+  folly::coro::Baton baton;
+#endif
+};
+
+} // namespace openr
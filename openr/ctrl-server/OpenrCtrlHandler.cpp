@@ -16,10 +16,20 @@ namespace fs = std::experimental::filesystem;
 #endif
 
 #include <folly/ExceptionString.h>
+#include <folly/ScopeGuard.h>
+#include <folly/String.h>
 #include <folly/logging/xlog.h>
+#include <thrift/lib/cpp2/protocol/Serializer.h>
+#if FOLLY_HAS_COROUTINES
+#include <folly/CancellationToken.h>
+#include <folly/experimental/coro/CurrentExecutor.h>
+#include <folly/experimental/coro/Task.h>
+#endif
 
 #include <openr/common/Constants.h>
+#include <openr/common/ConvergenceTracer.h>
 #include <openr/common/LsdbUtil.h>
+#include <openr/common/ThreadLocalStats.h>
 #include <openr/common/Util.h>
 #include <openr/monitor/LogSample.h>
 
@@ -27,6 +37,41 @@ namespace fb303 = facebook::fb303;
 
 namespace openr {
 
+namespace {
+
+// Top level config fields which can be applied without restart
+const std::unordered_set<std::string> kReloadableConfigFields{
+    "originated_prefixes",
+};
+
+/**
+ * [Ctrl Cache] Serve response for `args` from `cache` if it was computed at
+ * `version` of the owning module, or `fetch` it and cache it otherwise.
+ */
+template <typename Response, typename Args, typename Fetch>
+folly::SemiFuture<std::unique_ptr<Response>>
+getCachedResponse(
+    std::shared_ptr<CtrlResponseCache<Response>> cache,
+    const Args& args,
+    int64_t version,
+    Fetch&& fetch) {
+  auto key = apache::thrift::CompactSerializer::serialize<std::string>(args);
+  if (auto cached = cache->get(key, version)) {
+    fb303::fbData->addStatValue("ctrl.response_cache.hit", 1, fb303::COUNT);
+    return folly::makeSemiFuture(std::make_unique<Response>(*cached));
+  }
+  fb303::fbData->addStatValue("ctrl.response_cache.miss", 1, fb303::COUNT);
+  return fetch().deferValue(
+      [cache = std::move(cache), key = std::move(key), version](
+          std::unique_ptr<Response>&& response) {
+        auto shared = std::make_shared<const Response>(std::move(*response));
+        cache->put(key, version, shared);
+        return std::make_unique<Response>(*shared);
+      });
+}
+
+} // namespace
+
 OpenrCtrlHandler::OpenrCtrlHandler(
     const std::string& nodeName,
     const std::unordered_set<std::string>& acceptablePeerCommonNames,
@@ -39,7 +84,8 @@ OpenrCtrlHandler::OpenrCtrlHandler(
     PersistentStore* configStore,
     PrefixManager* prefixManager,
     Spark* spark,
-    std::shared_ptr<const Config> config)
+    std::shared_ptr<const Config> config,
+    std::vector<Spark*> sparkShards)
     : fb303::BaseService("openr"),
       nodeName_(nodeName),
       acceptablePeerCommonNames_(acceptablePeerCommonNames),
@@ -52,7 +98,8 @@ OpenrCtrlHandler::OpenrCtrlHandler(
       configStore_(configStore),
       prefixManager_(prefixManager),
       spark_(spark),
-      config_(config) {
+      config_(config),
+      sparkShards_(std::move(sparkShards)) {
   // We expect ctrl-evb not be running otherwise adding fiber task is not
   // thread safe.
   CHECK_NOTNULL(ctrlEvb);
@@ -71,12 +118,13 @@ OpenrCtrlHandler::OpenrCtrlHandler(
               break;
             }
 
+            // ATTN: publication is shared with other readers
             folly::variant_match(
-                std::move(maybePub).value(),
-                [this](thrift::Publication&& pub) {
-                  processPublication(std::move(pub));
+                *maybePub.value(),
+                [this](thrift::Publication const& pub) {
+                  processPublication(pub);
                 },
-                [](thrift::InitializationEvent&&) {
+                [](thrift::InitializationEvent const&) {
                   // skip the processing of initialization event
                 });
           }
@@ -110,17 +158,25 @@ OpenrCtrlHandler::OpenrCtrlHandler(
               }
             });
 
-            // Publish the detailed update to all active streams
+            // Buffer the detailed update for all active streams
             fibDetailSubscribers_.withWLock(
                 [&maybeUpdate](auto& fibSubscribers) {
                   if (fibSubscribers.size()) {
                     const auto fibUpdateDetail =
                         maybeUpdate.value().toThriftDetail();
-                    for (auto& fibSubscriber : fibSubscribers) {
-                      fibSubscriber.second.total_messages++;
-                      fibSubscriber.second.last_message_time =
-                          std::chrono::system_clock::now();
-                      fibSubscriber.second.publisher->next(fibUpdateDetail);
+                    for (auto& [_, fibSubscriber] : fibSubscribers) {
+                      fibSubscriber->buffer.push(
+                          thrift::RouteDatabaseDeltaDetail(fibUpdateDetail));
+#if FOLLY_HAS_COROUTINES
+                      fibSubscriber->baton.post();
+#else
+                      while (auto delta = fibSubscriber->buffer.pop()) {
+                        fibSubscriber->total_messages++;
+                        fibSubscriber->last_message_time =
+                            std::chrono::system_clock::now();
+                        fibSubscriber->publisher->next(std::move(*delta));
+                      }
+#endif
                     }
                   }
                 });
@@ -137,7 +193,7 @@ OpenrCtrlHandler::~OpenrCtrlHandler() {
   closeFibPublishers();
 
   XLOG(INFO) << "Cleanup all pending request(s).";
-  longPollReqs_.withWLock([&](auto& longPollReqs) { longPollReqs.clear(); });
+  cleanupPendingLongPollReqs();
 
   XLOG(INFO)
       << "Waiting for termination of kvStoreUpdatesQueue, FibUpdatesQueue";
@@ -155,9 +211,7 @@ void
 OpenrCtrlHandler::closeKvStorePublishers() {
   std::vector<std::unique_ptr<KvStorePublisher>> publishers;
   kvStorePublishers_.withWLock([&](auto& kvStorePublishers_) {
-    for (auto& [_, publisher] : kvStorePublishers_) {
-      publishers.emplace_back(std::move(publisher));
-    }
+    publishers = kvStorePublishers_.releaseAll();
   });
   XLOG(INFO) << "Terminating " << publishers.size()
              << " active KvStore snoop stream(s).";
@@ -184,18 +238,90 @@ OpenrCtrlHandler::closeFibPublishers() {
   for (auto& fibPublisher : fibPublishers_close) {
     std::move(fibPublisher).complete();
   }
+
+  // Streams of Fib detail subscribers end once they see being closed
+  fibDetailSubscribers_.withWLock([](auto& fibDetailSubscribers) {
+    for (auto& [_, fibSubscriber] : fibDetailSubscribers) {
+      fibSubscriber->closed = true;
+#if FOLLY_HAS_COROUTINES
+      fibSubscriber->baton.post();
+#endif
+    }
+  });
 }
 
 void
-OpenrCtrlHandler::processPublication(thrift::Publication&& pub) {
-  // publish via KvStorePublisher
-  kvStorePublishers_.withWLock([&](auto& kvStorePublishers_) {
-    for (auto& [_, publisher] : kvStorePublishers_) {
-      publisher->last_message_time_ = std::chrono::system_clock::now();
-      publisher->total_messages_++;
-      publisher->publish(pub);
+OpenrCtrlHandler::setMemoryPressure(MemoryPressureLevel level) {
+  const auto prevLevel = memoryPressure_.exchange(level);
+  if (prevLevel == level) {
+    return;
+  }
+  XLOG(INFO) << "[Memory Governor] Ctrl memory pressure "
+             << toString(prevLevel) << " -> " << toString(level);
+
+  const bool shrinkCaches = level >= MemoryPressureLevel::SHRINK_CACHES;
+  runningConfigCache_->setEnabled(not shrinkCaches);
+  advertisedRoutesCache_->setEnabled(not shrinkCaches);
+  receivedRoutesCache_->setEnabled(not shrinkCaches);
+  if (shrinkCaches) {
+    fb303::fbData->addStatValue(
+        "ctrl.memory_pressure.caches_cleared", 1, fb303::COUNT);
+  }
+
+  if (level < MemoryPressureLevel::DROP_SUBSCRIPTIONS or
+      prevLevel >= MemoryPressureLevel::DROP_SUBSCRIPTIONS) {
+    return;
+  }
+  // Optional subscriptions only, KvStore and Fib delta streams are kept for
+  // routing agents relying on them
+  size_t numDropped = getNumPendingLongPollReqs();
+  cleanupPendingLongPollReqs();
+  fibDetailSubscribers_.withWLock([&numDropped](auto& fibDetailSubscribers) {
+    for (auto& [_, fibSubscriber] : fibDetailSubscribers) {
+      if (not fibSubscriber->closed) {
+        fibSubscriber->closed = true;
+        ++numDropped;
+      }
+#if FOLLY_HAS_COROUTINES
+      fibSubscriber->baton.post();
+#endif
     }
   });
+  XLOG(WARNING) << "[Memory Governor] Dropped " << numDropped
+                << " optional subscription(s)";
+  fb303::fbData->addStatValue(
+      "ctrl.memory_pressure.subscriptions_dropped", numDropped, fb303::SUM);
+}
+
+void
+OpenrCtrlHandler::rejectUnderMemoryPressure(
+    MemoryPressureLevel level,
+    std::string const& api,
+    std::string const& alternative) {
+  const auto currentLevel = memoryPressure_.load();
+  if (currentLevel < level) {
+    return;
+  }
+  fb303::fbData->addStatValue(
+      level >= MemoryPressureLevel::REJECT_DUMPS
+          ? "ctrl.memory_pressure.dumps_rejected"
+          : "ctrl.memory_pressure.subscriptions_rejected",
+      1,
+      fb303::COUNT);
+  throw thrift::OpenrError(fmt::format(
+      "{} is rejected under memory pressure ({}){}",
+      api,
+      toString(currentLevel),
+      alternative.empty() ? "" : fmt::format(", use {} instead", alternative)));
+}
+
+void
+OpenrCtrlHandler::processPublication(thrift::Publication const& pub) {
+  // publish via KvStorePublisher. Key-vals are routed to interested
+  // publishers in a single pass.
+  kvStorePublishers_.withWLock([&](auto& kvStorePublishers_) {
+    kvStorePublishers_.publish(pub);
+  });
 
   // check if any of KeyVal has 'adj' update
   bool isAdjChanged = false;
@@ -213,38 +339,49 @@ OpenrCtrlHandler::processPublication(thrift::Publication&& pub) {
       break;
     }
   }
+  for (auto const& key : *pub.expiredKeys_ref()) {
+    if (key.find(Constants::kAdjDbMarker.toString()) == 0) {
+      XLOG(DBG3) << "Adj key: " << key << " expiry received";
+      isAdjChanged = true;
+      break;
+    }
+  }
 
-  if (isAdjChanged) {
-    // thrift::Publication contains "adj:*" key change.
-    // Clean ALL pending promises
-    longPollReqs_.withWLock([&](auto& longPollReqs) {
-      for (auto& [_, req] : longPollReqs[*pub.area_ref()]) {
-        auto& p = req.first; // get the promise
-        p.setValue(true);
-      }
-      longPollReqs.clear();
-    });
-  } else {
-    longPollReqs_.withWLock([&](auto& longPollReqs) {
-      auto now = getUnixTimeStampMs();
-      std::vector<int64_t> reqsToClean;
-      for (auto& [clientId, req] : longPollReqs[*pub.area_ref()]) {
-        auto& p = req.first;
-        auto& timeStamp = req.second;
-        if (now - timeStamp >= Constants::kLongPollReqHoldTime.count()) {
-          XLOG(INFO) << "Elapsed time: " << now - timeStamp
-                     << " is over hold limit: "
-                     << Constants::kLongPollReqHoldTime.count();
-          reqsToClean.emplace_back(clientId);
-          p.setValue(false);
-        }
-      }
+  // requests to be answered, promises are fulfilled outside of the lock
+  std::deque<LongPollReq> reqsToWake;
+  bool isReqsToWakeExpired{false};
+  longPollReqs_.withWLock([&](auto& longPollReqs) {
+    auto it = longPollReqs.find(*pub.area_ref());
+    if (isAdjChanged) {
+      // thrift::Publication contains "adj:*" key change. All pending
+      // requests of the area are parked at previous version.
+      auto& longPollArea =
+          it != longPollReqs.end() ? it->second : longPollReqs[*pub.area_ref()];
+      ++longPollArea.adjVersion;
+      reqsToWake.swap(longPollArea.pendingReqs);
+      return;
+    }
+    if (it == longPollReqs.end()) {
+      return;
+    }
 
-      // cleanup expired requests since no ADJ change observed
-      for (auto& clientId : reqsToClean) {
-        longPollReqs[*pub.area_ref()].erase(clientId);
-      }
-    });
+    // cleanup expired requests since no ADJ change observed
+    auto& pendingReqs = it->second.pendingReqs;
+    const auto now = getUnixTimeStampMs();
+    while (not pendingReqs.empty() and
+           now - pendingReqs.front().timeStamp >=
+               Constants::kLongPollReqHoldTime.count()) {
+      XLOG(INFO) << "Elapsed time: " << now - pendingReqs.front().timeStamp
+                 << " is over hold limit: "
+                 << Constants::kLongPollReqHoldTime.count();
+      reqsToWake.emplace_back(std::move(pendingReqs.front()));
+      pendingReqs.pop_front();
+    }
+    isReqsToWakeExpired = true;
+  });
+
+  for (auto& req : reqsToWake) {
+    req.promise.setValue(not isReqsToWakeExpired);
   }
 }
 
@@ -296,9 +433,54 @@ OpenrCtrlHandler::getEventLogs(std::vector<::std::string>& _return) {
   }
 }
 
+void
+OpenrCtrlHandler::startHeapProfiling() {
+  try {
+    memory::setHeapProfilingActive(true);
+  } catch (const std::exception& ex) {
+    throw thrift::OpenrError(
+        fmt::format("Failed to start heap profiling: {}", ex.what()));
+  }
+  XLOG(INFO) << "[Heap Profiling] Heap profiling started";
+}
+
+void
+OpenrCtrlHandler::stopHeapProfiling(std::unique_ptr<std::string> dumpPath) {
+  try {
+    if (not dumpPath->empty()) {
+      memory::dumpHeapProfile(*dumpPath);
+      XLOG(INFO) << "[Heap Profiling] Heap profile dumped to " << *dumpPath;
+    }
+    memory::setHeapProfilingActive(false);
+  } catch (const std::exception& ex) {
+    throw thrift::OpenrError(
+        fmt::format("Failed to stop heap profiling: {}", ex.what()));
+  }
+  XLOG(INFO) << "[Heap Profiling] Heap profiling stopped";
+}
+
+void
+OpenrCtrlHandler::getTraceEvents(
+    std::vector<thrift::TraceEvent>& _return,
+    std::unique_ptr<std::vector<int64_t>> traceIds) {
+  _return = ConvergenceTracer::getEvents(
+      std::unordered_set<int64_t>(traceIds->begin(), traceIds->end()));
+}
+
+void
+OpenrCtrlHandler::getTraceEventsChromeJson(
+    std::string& _return, std::unique_ptr<std::vector<int64_t>> traceIds) {
+  _return = ConvergenceTracer::toChromeTrace(ConvergenceTracer::getEvents(
+      std::unordered_set<int64_t>(traceIds->begin(), traceIds->end())));
+}
+
 void
 OpenrCtrlHandler::getCounters(std::map<std::string, int64_t>& _return) {
+  // [Thread Local Stats] hot path stats are aggregated on export only
+  ThreadLocalStat::flushAll();
   BaseService::getCounters(_return);
+  // [Ctrl Stats] latency percentiles are computed on demand only
+  apiStatsCollector_->getCounters(_return);
 }
 
 void
@@ -386,24 +568,91 @@ OpenrCtrlHandler::dryrunConfig(
   }
 }
 
+// apply changes of config without restart
+void
+OpenrCtrlHandler::reloadConfig(
+    std::vector<std::string>& _return, std::unique_ptr<std::string> file) {
+  if (not file) {
+    throw thrift::OpenrError("Dereference nullptr for config file");
+  }
+
+  const auto& fileName = *file;
+  if (not fs::exists(fileName)) {
+    throw thrift::OpenrError(
+        fmt::format("Config file doesn't exist: {}", fileName));
+  }
+
+  std::shared_ptr<const Config> newConfig;
+  try {
+    newConfig = std::make_shared<const Config>(fileName);
+  } catch (const std::exception& ex) {
+    throw thrift::OpenrError(ex.what());
+  }
+
+  std::lock_guard<std::mutex> l(reloadConfigLock_);
+  const auto oldConfig = std::atomic_load(&config_);
+  const auto changedFields =
+      Config::getChangedFields(oldConfig->getConfig(), newConfig->getConfig());
+
+  // reject the whole reload if any change can't be applied live
+  std::vector<std::string> restartFields;
+  for (const auto& field : changedFields) {
+    if (not kReloadableConfigFields.count(field)) {
+      restartFields.emplace_back(field);
+    }
+  }
+  if (not restartFields.empty()) {
+    throw thrift::OpenrError(fmt::format(
+        "Changes of config fields [{}] require restart",
+        folly::join(", ", restartFields)));
+  }
+
+  for (const auto& field : changedFields) {
+    XLOG(INFO) << "[Config Reload] Applying changes of " << field;
+    if (field == "originated_prefixes") {
+      if (not prefixManager_) {
+        throw thrift::OpenrError("PrefixManager is not running");
+      }
+      prefixManager_
+          ->updateOriginatedPrefixes(
+              newConfig->getConfig().originated_prefixes_ref().value_or(
+                  std::vector<thrift::OriginatedPrefix>{}))
+          .get();
+    }
+  }
+
+  std::atomic_store(&config_, newConfig);
+  configVersion_.fetch_add(1, std::memory_order_release);
+  fb303::fbData->addStatValue("ctrl.config_reload", 1, fb303::COUNT);
+  _return = changedFields;
+}
+
 void
 OpenrCtrlHandler::getRunningConfig(std::string& _return) {
-  _return = config_->getRunningConfig();
+  // served from cache until next reload, serializing config is expensive
+  const auto version = configVersion_.load(std::memory_order_acquire);
+  if (auto cached = runningConfigCache_->get("", version)) {
+    fb303::fbData->addStatValue("ctrl.response_cache.hit", 1, fb303::COUNT);
+    _return = *cached;
+    return;
+  }
+  fb303::fbData->addStatValue("ctrl.response_cache.miss", 1, fb303::COUNT);
+  auto runningConfig = std::make_shared<const std::string>(
+      std::atomic_load(&config_)->getRunningConfig());
+  runningConfigCache_->put("", version, runningConfig);
+  _return = *runningConfig;
 }
 
 void
 OpenrCtrlHandler::getRunningConfigThrift(thrift::OpenrConfig& _config) {
-  _config = config_->getConfig();
+  _config = std::atomic_load(&config_)->getConfig();
 }
 
 void
 OpenrCtrlHandler::getInitializationEvents(
     std::map<thrift::InitializationEvent, int64_t>& _return) {
-  for (int eventInt = int(thrift::InitializationEvent::INITIALIZING);
-       eventInt <= int(thrift::InitializationEvent::INITIALIZED);
-       ++eventInt) {
-    auto event = static_cast<thrift::InitializationEvent>(eventInt);
-
+  for (const auto event :
+       apache::thrift::TEnumTraits<thrift::InitializationEvent>::values) {
     // The fb303 counter is set in function logInitializationEvent().
     auto counterKey = fmt::format(
         Constants::kInitEventCounterFormat,
@@ -439,7 +688,8 @@ std::unique_ptr<std::string>
 OpenrCtrlHandler::getSingleAreaOrThrow(std::string const& caller) {
   fb303::fbData->addStatValue(
       fmt::format("ctrl.get_single_area.{}", caller), 1, fb303::COUNT);
-  auto const& areas = config_->getAreas();
+  const auto config = std::atomic_load(&config_);
+  auto const& areas = config->getAreas();
   if (1 != areas.size()) {
     throw thrift::OpenrError(
         "Iterface requires node to be confgiured with exactly one area");
@@ -505,7 +755,13 @@ folly::SemiFuture<std::unique_ptr<std::vector<thrift::AdvertisedRouteDetail>>>
 OpenrCtrlHandler::semifuture_getAdvertisedRoutesFiltered(
     std::unique_ptr<thrift::AdvertisedRouteFilter> filter) {
   CHECK(prefixManager_);
-  return prefixManager_->getAdvertisedRoutesFiltered(std::move(*filter));
+  return getCachedResponse(
+      advertisedRoutesCache_,
+      *filter,
+      prefixManager_->getAdvertisedRoutesVersion(),
+      [this, &filter]() {
+        return prefixManager_->getAdvertisedRoutesFiltered(std::move(*filter));
+      });
 }
 
 folly::SemiFuture<std::unique_ptr<std::vector<thrift::OriginatedPrefixEntry>>>
@@ -548,12 +804,18 @@ OpenrCtrlHandler::semifuture_getAdvertisedRoutesWithOriginationPolicy(
 
 folly::SemiFuture<std::unique_ptr<thrift::RouteDatabase>>
 OpenrCtrlHandler::semifuture_getRouteDb() {
+  rejectUnderMemoryPressure(
+      MemoryPressureLevel::REJECT_DUMPS, "getRouteDb", "getUnicastRoutesPage");
   CHECK(fib_);
   return fib_->getRouteDb();
 }
 
 folly::SemiFuture<std::unique_ptr<thrift::RouteDatabaseDetail>>
 OpenrCtrlHandler::semifuture_getRouteDetailDb() {
+  rejectUnderMemoryPressure(
+      MemoryPressureLevel::REJECT_DUMPS,
+      "getRouteDetailDb",
+      "getUnicastRoutesPage");
   CHECK(fib_);
   return fib_->getRouteDetailDb();
 }
@@ -561,17 +823,67 @@ OpenrCtrlHandler::semifuture_getRouteDetailDb() {
 folly::SemiFuture<std::unique_ptr<std::vector<thrift::UnicastRoute>>>
 OpenrCtrlHandler::semifuture_getUnicastRoutesFiltered(
     std::unique_ptr<std::vector<std::string>> prefixes) {
+  if (prefixes->empty()) {
+    rejectUnderMemoryPressure(
+        MemoryPressureLevel::REJECT_DUMPS,
+        "getUnicastRoutesFiltered",
+        "getUnicastRoutesPage");
+  }
   CHECK(fib_);
   return fib_->getUnicastRoutes(std::move(*prefixes));
 }
 
 folly::SemiFuture<std::unique_ptr<std::vector<thrift::UnicastRoute>>>
 OpenrCtrlHandler::semifuture_getUnicastRoutes() {
-  folly::Promise<std::unique_ptr<std::vector<thrift::UnicastRoute>>> p;
+  rejectUnderMemoryPressure(
+      MemoryPressureLevel::REJECT_DUMPS,
+      "getUnicastRoutes",
+      "getUnicastRoutesPage");
   CHECK(fib_);
   return fib_->getUnicastRoutes({});
 }
 
+folly::SemiFuture<std::unique_ptr<thrift::UnicastRoutesPage>>
+OpenrCtrlHandler::semifuture_getUnicastRoutesPage(
+    std::unique_ptr<thrift::PageParams> pageParams) {
+  CHECK(fib_);
+  return fib_->getUnicastRoutesPage(std::move(*pageParams));
+}
+
+folly::SemiFuture<std::unique_ptr<std::vector<thrift::RouteLookupResult>>>
+OpenrCtrlHandler::semifuture_lookupRoutes(
+    std::unique_ptr<std::vector<thrift::BinaryAddress>> addresses) {
+  CHECK(fib_);
+  std::vector<folly::IPAddress> addrs;
+  addrs.reserve(addresses->size());
+  for (const auto& address : *addresses) {
+    try {
+      addrs.emplace_back(toIPAddress(address));
+    } catch (const std::exception& ex) {
+      throw thrift::OpenrError(
+          fmt::format("Invalid address to lookup: {}", ex.what()));
+    }
+  }
+  return fib_->lookupRoutes(std::move(addrs));
+}
+
+folly::SemiFuture<std::unique_ptr<std::vector<thrift::RouteFingerprint>>>
+OpenrCtrlHandler::semifuture_getUnicastRouteFingerprints(
+    std::unique_ptr<std::vector<thrift::IpPrefix>> ranges) {
+  CHECK(fib_);
+  std::vector<folly::CIDRNetwork> networks;
+  networks.reserve(ranges->size());
+  for (const auto& range : *ranges) {
+    try {
+      networks.emplace_back(toIPNetwork(range));
+    } catch (const std::exception& ex) {
+      throw thrift::OpenrError(
+          fmt::format("Invalid range to fingerprint: {}", ex.what()));
+    }
+  }
+  return fib_->getUnicastRouteFingerprints(std::move(networks));
+}
+
 folly::SemiFuture<std::unique_ptr<std::vector<thrift::MplsRoute>>>
 OpenrCtrlHandler::semifuture_getMplsRoutes() {
   CHECK(fib_);
@@ -591,13 +903,45 @@ OpenrCtrlHandler::semifuture_getMplsRoutesFiltered(
 folly::SemiFuture<folly::Unit>
 OpenrCtrlHandler::semifuture_floodRestartingMsg() {
   CHECK(spark_);
-  return spark_->floodRestartingMsg();
+  if (sparkShards_.empty()) {
+    return spark_->floodRestartingMsg();
+  }
+
+  std::vector<folly::SemiFuture<folly::Unit>> futures;
+  futures.emplace_back(spark_->floodRestartingMsg());
+  for (auto* sparkShard : sparkShards_) {
+    futures.emplace_back(sparkShard->floodRestartingMsg());
+  }
+  return folly::collect(std::move(futures)).deferValue([](auto&&) {
+    return folly::Unit();
+  });
 }
 
 folly::SemiFuture<std::unique_ptr<std::vector<thrift::SparkNeighbor>>>
 OpenrCtrlHandler::semifuture_getNeighbors() {
   CHECK(spark_);
-  return spark_->getNeighbors();
+  if (sparkShards_.empty()) {
+    return spark_->getNeighbors();
+  }
+
+  // merge neighbors of every shard
+  std::vector<
+      folly::SemiFuture<std::unique_ptr<std::vector<thrift::SparkNeighbor>>>>
+      futures;
+  futures.emplace_back(spark_->getNeighbors());
+  for (auto* sparkShard : sparkShards_) {
+    futures.emplace_back(sparkShard->getNeighbors());
+  }
+  return folly::collect(std::move(futures)).deferValue([](auto&& results) {
+    auto neighbors = std::make_unique<std::vector<thrift::SparkNeighbor>>();
+    for (auto& shardNeighbors : results) {
+      neighbors->insert(
+          neighbors->end(),
+          std::make_move_iterator(shardNeighbors->begin()),
+          std::make_move_iterator(shardNeighbors->end()));
+    }
+    return neighbors;
+  });
 }
 
 //
@@ -609,6 +953,19 @@ OpenrCtrlHandler::semifuture_getPerfDb() {
   return fib_->getPerfDb();
 }
 
+folly::SemiFuture<
+    std::unique_ptr<std::vector<thrift::ConvergenceDistribution>>>
+OpenrCtrlHandler::semifuture_getConvergenceDistributions() {
+  CHECK(fib_);
+  return fib_->getConvergenceDistributions();
+}
+
+void
+OpenrCtrlHandler::getCtrlApiStats(
+    std::map<std::string, thrift::CtrlApiStats>& _return) {
+  _return = apiStatsCollector_->getStats();
+}
+
 //
 // Decision APIs
 //
@@ -622,8 +979,27 @@ OpenrCtrlHandler::semifuture_getReceivedRoutes() {
 folly::SemiFuture<std::unique_ptr<std::vector<thrift::ReceivedRouteDetail>>>
 OpenrCtrlHandler::semifuture_getReceivedRoutesFiltered(
     std::unique_ptr<thrift::ReceivedRouteFilter> filter) {
+  rejectUnderMemoryPressure(
+      MemoryPressureLevel::REJECT_DUMPS,
+      "getReceivedRoutesFiltered",
+      "getReceivedRoutesPage");
   CHECK(decision_);
-  return decision_->getReceivedRoutesFiltered(std::move(*filter));
+  return getCachedResponse(
+      receivedRoutesCache_,
+      *filter,
+      decision_->getReceivedRoutesVersion(),
+      [this, &filter]() {
+        return decision_->getReceivedRoutesFiltered(std::move(*filter));
+      });
+}
+
+folly::SemiFuture<std::unique_ptr<thrift::ReceivedRoutesPage>>
+OpenrCtrlHandler::semifuture_getReceivedRoutesPage(
+    std::unique_ptr<thrift::ReceivedRouteFilter> filter,
+    std::unique_ptr<thrift::PageParams> pageParams) {
+  CHECK(decision_);
+  return decision_->getReceivedRoutesPage(
+      std::move(*filter), std::move(*pageParams));
 }
 
 folly::SemiFuture<std::unique_ptr<thrift::RouteDatabase>>
@@ -653,14 +1029,31 @@ OpenrCtrlHandler::semifuture_getDecisionAdjacencyDbs() {
 folly::SemiFuture<std::unique_ptr<std::vector<thrift::AdjacencyDatabase>>>
 OpenrCtrlHandler::semifuture_getDecisionAdjacenciesFiltered(
     std::unique_ptr<thrift::AdjacenciesFilter> filter) {
+  rejectUnderMemoryPressure(
+      MemoryPressureLevel::REJECT_DUMPS,
+      "getDecisionAdjacenciesFiltered",
+      "getDecisionAdjacenciesPage");
   CHECK(decision_);
   return decision_->getDecisionAdjacenciesFiltered(std::move(*filter));
 }
 
+folly::SemiFuture<std::unique_ptr<thrift::AdjacenciesPage>>
+OpenrCtrlHandler::semifuture_getDecisionAdjacenciesPage(
+    std::unique_ptr<thrift::AdjacenciesFilter> filter,
+    std::unique_ptr<thrift::PageParams> pageParams) {
+  CHECK(decision_);
+  return decision_->getDecisionAdjacenciesPage(
+      std::move(*filter), std::move(*pageParams));
+}
+
 folly::SemiFuture<std::unique_ptr<
     std::map<std::string, std::vector<::openr::thrift::AdjacencyDatabase>>>>
 OpenrCtrlHandler::semifuture_getDecisionAreaAdjacenciesFiltered(
     std::unique_ptr<thrift::AdjacenciesFilter> filter) {
+  rejectUnderMemoryPressure(
+      MemoryPressureLevel::REJECT_DUMPS,
+      "getDecisionAreaAdjacenciesFiltered",
+      "getDecisionAdjacenciesPage");
   CHECK(decision_);
   return decision_->getDecisionAreaAdjacenciesFiltered(std::move(*filter));
 }
@@ -719,6 +1112,11 @@ folly::SemiFuture<std::unique_ptr<thrift::Publication>>
 OpenrCtrlHandler::semifuture_getKvStoreKeyValsFilteredArea(
     std::unique_ptr<thrift::KeyDumpParams> filter,
     std::unique_ptr<std::string> area) {
+  // long polls compare "adj:" keys only and are dropped earlier
+  rejectUnderMemoryPressure(
+      MemoryPressureLevel::REJECT_DUMPS,
+      "getKvStoreKeyValsFilteredArea",
+      "getKvStoreKeyValsFilteredAreaPage");
   CHECK(kvStore_);
   return kvStore_->semifuture_dumpKvStoreKeys(std::move(*filter), {*area})
       .deferValue(
@@ -729,6 +1127,26 @@ OpenrCtrlHandler::semifuture_getKvStoreKeyValsFilteredArea(
           });
 }
 
+folly::SemiFuture<std::unique_ptr<thrift::KvStoreKeyValsPage>>
+OpenrCtrlHandler::semifuture_getKvStoreKeyValsFilteredAreaPage(
+    std::unique_ptr<thrift::KeyDumpParams> filter,
+    std::unique_ptr<std::string> area,
+    std::unique_ptr<thrift::PageParams> pageParams) {
+  CHECK(kvStore_);
+  return kvStore_->semifuture_getKvStoreKeyValsPage(
+      std::move(*area), std::move(*filter), std::move(*pageParams));
+}
+
+folly::SemiFuture<std::unique_ptr<thrift::KvStoreSyncChunk>>
+OpenrCtrlHandler::semifuture_getKvStoreSyncChunkArea(
+    std::unique_ptr<thrift::KeyDumpParams> filter,
+    std::unique_ptr<std::string> area,
+    std::unique_ptr<thrift::KvStoreSyncChunkParams> chunkParams) {
+  CHECK(kvStore_);
+  return kvStore_->semifuture_getKvStoreSyncChunk(
+      std::move(*area), std::move(*filter), std::move(*chunkParams));
+}
+
 folly::SemiFuture<std::unique_ptr<thrift::Publication>>
 OpenrCtrlHandler::semifuture_getKvStoreHashFiltered(
     std::unique_ptr<thrift::KeyDumpParams> filter) {
@@ -765,11 +1183,14 @@ folly::SemiFuture<bool>
 OpenrCtrlHandler::semifuture_longPollKvStoreAdjArea(
     std::unique_ptr<std::string> area,
     std::unique_ptr<thrift::KeyVals> snapshot) {
+  rejectUnderMemoryPressure(
+      MemoryPressureLevel::DROP_SUBSCRIPTIONS, "longPollKvStoreAdjArea");
   folly::Promise<bool> p;
   auto sf = p.getSemiFuture();
 
-  auto timeStamp = getUnixTimeStampMs();
-  auto requestId = pendingRequestId_++;
+  // adj version of the area the snapshot is compared at
+  const auto adjVersion = longPollReqs_.withWLock(
+      [&](auto& longPollReqs) { return longPollReqs[*area].adjVersion; });
 
   thrift::KeyDumpParams params;
 
@@ -813,10 +1234,20 @@ OpenrCtrlHandler::semifuture_longPollKvStoreAdjArea(
     // Store req for future processing when there is publication
     // from KvStore.
     XLOG(DBG3) << "No adj change detected. Store req as pending request";
-    longPollReqs_.withWLock([&](auto& longPollReq) {
-      longPollReq[*area].emplace(
-          requestId, std::make_pair(std::move(p), timeStamp));
+    const bool parked = longPollReqs_.withWLock([&](auto& longPollReqs) {
+      auto& longPollArea = longPollReqs[*area];
+      if (longPollArea.adjVersion != adjVersion) {
+        return false;
+      }
+      longPollArea.pendingReqs.emplace_back(
+          LongPollReq{std::move(p), getUnixTimeStampMs()});
+      return true;
     });
+    if (not parked) {
+      // adj change published while comparing the snapshot
+      XLOG(DBG3) << "AdjKey changed while comparing. Notify immediately";
+      p.setValue(true);
+    }
   }
   return sf;
 }
@@ -867,6 +1298,14 @@ OpenrCtrlHandler::semifuture_getKvStoreAreaSummary(
       std::move(*selectAreas));
 }
 
+folly::SemiFuture<
+    std::unique_ptr<std::map<std::string, thrift::KvStoreKeyFamilyStats>>>
+OpenrCtrlHandler::semifuture_getKvStoreKeyFamilyStatsArea(
+    std::unique_ptr<std::string> area) {
+  CHECK(kvStore_);
+  return kvStore_->semifuture_getKvStoreKeyFamilyStats(std::move(*area));
+}
+
 folly::SemiFuture<std::unique_ptr<std::vector<thrift::StreamSubscriberInfo>>>
 OpenrCtrlHandler::semifuture_getSubscriberInfo(int64_t type) {
   folly::Promise<std::unique_ptr<std::vector<thrift::StreamSubscriberInfo>>>
@@ -879,7 +1318,7 @@ OpenrCtrlHandler::semifuture_getSubscriberInfo(int64_t type) {
     std::vector<thrift::StreamSubscriberInfo> subscribers;
     if (type == 0) {
       kvStorePublishers_.withWLock([&](auto& kvStorePublishers_) {
-        for (auto& [id, publisher] : kvStorePublishers_) {
+        for (auto& [id, publisher] : kvStorePublishers_.getPublishers()) {
           thrift::StreamSubscriberInfo subscriber;
           subscriber.subscriber_id_ref() = id;
 
@@ -907,14 +1346,20 @@ OpenrCtrlHandler::semifuture_getSubscriberInfo(int64_t type) {
           auto currentTime = std::chrono::steady_clock::now();
           auto duration_time =
               std::chrono::duration_cast<std::chrono::milliseconds>(
-                  currentTime - publisher.upSince);
+                  currentTime - publisher->upSince);
           subscriber.uptime_ref() = duration_time.count();
           subscriber.last_msg_sent_time_ref() =
               std::chrono::time_point_cast<std::chrono::milliseconds>(
-                  publisher.last_message_time)
+                  publisher->last_message_time)
                   .time_since_epoch()
                   .count();
-          subscriber.total_streamed_msgs_ref() = publisher.total_messages;
+          subscriber.total_streamed_msgs_ref() = publisher->total_messages;
+
+          const auto& buffer = publisher->buffer;
+          subscriber.pending_msgs_ref() = buffer.numPendingDeltas();
+          subscriber.conflated_msgs_ref() = buffer.numConflatedDeltas();
+          subscriber.dropped_msgs_ref() = buffer.numDroppedDeltas();
+          subscriber.resyncs_ref() = buffer.numResyncs();
 
           subscribers.emplace_back(subscriber);
         }
@@ -930,45 +1375,165 @@ OpenrCtrlHandler::semifuture_getSubscriberInfo(int64_t type) {
   return sf;
 }
 
-apache::thrift::ServerStream<thrift::Publication>
-OpenrCtrlHandler::subscribeKvStoreFilter(
+template <typename... PublisherArgs>
+void
+OpenrCtrlHandler::addKvStorePublisher(
+    int64_t clientToken,
     std::unique_ptr<thrift::KeyDumpParams> filter,
-    std::unique_ptr<std::set<std::string>> selectAreas) {
-  // Get new client-ID (monotonically increasing)
-  auto clientToken = publisherToken_++;
-
-  auto streamAndPublisher =
-      apache::thrift::ServerStream<thrift::Publication>::createPublisher(
-          [this, clientToken]() {
-            kvStorePublishers_.withWLock([&](auto& kvStorePublishers_) {
-              if (kvStorePublishers_.erase(clientToken)) {
-                XLOG(INFO) << "KvStore snoop stream-" << clientToken
-                           << " ended.";
-              } else {
-                XLOG(ERR) << "Can't remove unknown KvStore snoop stream-"
-                          << clientToken;
-              }
-              fb303::fbData->setCounter(
-                  "subscribers.kvstore", kvStorePublishers_.size());
-            });
-          });
-
+    std::unique_ptr<std::set<std::string>> selectAreas,
+    bool holdUntilSnapshots,
+    PublisherArgs&&... publisherArgs) {
   kvStorePublishers_.withWLock([&](auto& kvStorePublishers_) {
-    assert(kvStorePublishers_.count(clientToken) == 0);
+    assert(kvStorePublishers_.getPublishers().count(clientToken) == 0);
     XLOG(INFO) << "KvStore snoop stream-" << clientToken
                << " started for areas: " << folly::join(", ", *selectAreas);
     auto kvStorePublisher = std::make_unique<KvStorePublisher>(
         *selectAreas,
         std::move(*filter),
-        std::move(streamAndPublisher.second),
+        std::forward<PublisherArgs>(publisherArgs)...,
         std::chrono::steady_clock::now(),
         0);
-    kvStorePublishers_.emplace(clientToken, std::move(kvStorePublisher));
+    if (holdUntilSnapshots) {
+      kvStorePublisher->holdUntilSnapshots();
+    }
+    kvStorePublishers_.add(clientToken, std::move(kvStorePublisher));
     fb303::fbData->setCounter("subscribers.kvstore", kvStorePublishers_.size());
   });
+}
+
+std::unique_ptr<StreamEncoder>
+OpenrCtrlHandler::createStreamEncoder(thrift::StreamEncodingParams encoding) {
+  try {
+    return std::make_unique<StreamEncoder>(std::move(encoding));
+  } catch (const std::invalid_argument& ex) {
+    throw thrift::OpenrError(ex.what());
+  }
+}
+
+apache::thrift::ServerStream<thrift::Publication>
+OpenrCtrlHandler::subscribeKvStoreFilter(
+    std::unique_ptr<thrift::KeyDumpParams> filter,
+    std::unique_ptr<std::set<std::string>> selectAreas) {
+  // Get new client-ID (monotonically increasing)
+  return subscribeKvStoreFilter(
+      publisherToken_++,
+      std::move(filter),
+      std::move(selectAreas),
+      false /* holdUntilSnapshots */);
+}
+
+apache::thrift::ServerStream<thrift::Publication>
+OpenrCtrlHandler::subscribeKvStoreFilter(
+    int64_t clientToken,
+    std::unique_ptr<thrift::KeyDumpParams> filter,
+    std::unique_ptr<std::set<std::string>> selectAreas,
+    bool holdUntilSnapshots) {
+  auto streamAndPublisher =
+      apache::thrift::ServerStream<thrift::Publication>::createPublisher(
+          [this, clientToken]() { removeKvStorePublisher(clientToken); });
+
+  addKvStorePublisher(
+      clientToken,
+      std::move(filter),
+      std::move(selectAreas),
+      holdUntilSnapshots,
+      std::move(streamAndPublisher.second));
   return std::move(streamAndPublisher.first);
 }
 
+apache::thrift::ServerStream<thrift::EncodedStreamMessage>
+OpenrCtrlHandler::subscribeKvStoreFilterEncoded(
+    std::unique_ptr<thrift::KeyDumpParams> filter,
+    std::unique_ptr<std::set<std::string>> selectAreas,
+    std::unique_ptr<StreamEncoder> encoder) {
+  // Get new client-ID (monotonically increasing)
+  return subscribeKvStoreFilterEncoded(
+      publisherToken_++,
+      std::move(filter),
+      std::move(selectAreas),
+      std::move(encoder),
+      false /* holdUntilSnapshots */);
+}
+
+apache::thrift::ServerStream<thrift::EncodedStreamMessage>
+OpenrCtrlHandler::subscribeKvStoreFilterEncoded(
+    int64_t clientToken,
+    std::unique_ptr<thrift::KeyDumpParams> filter,
+    std::unique_ptr<std::set<std::string>> selectAreas,
+    std::unique_ptr<StreamEncoder> encoder,
+    bool holdUntilSnapshots) {
+  auto streamAndPublisher = apache::thrift::ServerStream<
+      thrift::EncodedStreamMessage>::createPublisher([this, clientToken]() {
+    removeKvStorePublisher(clientToken);
+  });
+
+  addKvStorePublisher(
+      clientToken,
+      std::move(filter),
+      std::move(selectAreas),
+      holdUntilSnapshots,
+      std::move(streamAndPublisher.second),
+      std::move(encoder));
+  return std::move(streamAndPublisher.first);
+}
+
+folly::SemiFuture<std::vector<thrift::Publication>>
+OpenrCtrlHandler::dumpKvStoreSnapshots(
+    int64_t clientToken,
+    thrift::KeyDumpParams filter,
+    std::set<std::string> selectAreas) {
+  CHECK(kvStore_);
+  return kvStore_->semifuture_getKvStoreDumpSnapshots(std::move(selectAreas))
+      .deferValue([this, clientToken, filter = std::move(filter)](
+                      std::vector<std::shared_ptr<const KvStoreDumpSnapshot>>&&
+                          snapshots) {
+        // ATTN: runs on ctrl worker thread, KvStore keeps on flooding
+        const auto keyPrefixMatch = getKeyDumpFilters(filter);
+        const auto nowMs = getUnixTimeStampMs();
+        std::vector<thrift::Publication> pubs;
+        std::unordered_map<std::string, int64_t> seqNums;
+        for (const auto& snapshot : snapshots) {
+          const auto& area = *snapshot->snapshot.area_ref();
+          auto pub = dumpSnapshotWithFilters(
+              *snapshot,
+              keyPrefixMatch,
+              *filter.doNotPublishValue_ref(),
+              nowMs);
+          if (filter.keyValHashes_ref().has_value()) {
+            pub = dumpDifference(
+                area, *pub.keyVals_ref(), *filter.keyValHashes_ref());
+            pub.seqNum_ref() = snapshot->seqNum;
+          }
+          // Set the publication timestamp
+          pub.timestamp_ms_ref() = nowMs;
+          seqNums.emplace(area, snapshot->seqNum);
+          pubs.emplace_back(std::move(pub));
+        }
+
+        kvStorePublishers_.withWLock([&](auto& kvStorePublishers) {
+          const auto& publishers = kvStorePublishers.getPublishers();
+          // publisher is gone if stream was cancelled meanwhile
+          auto it = publishers.find(clientToken);
+          if (it != publishers.end()) {
+            it->second->startFromSnapshots(std::move(seqNums));
+          }
+        });
+        return pubs;
+      });
+}
+
+void
+OpenrCtrlHandler::removeKvStorePublisher(int64_t clientToken) {
+  kvStorePublishers_.withWLock([&](auto& kvStorePublishers_) {
+    if (kvStorePublishers_.erase(clientToken)) {
+      XLOG(INFO) << "KvStore snoop stream-" << clientToken << " ended.";
+    } else {
+      XLOG(ERR) << "Can't remove unknown KvStore snoop stream-" << clientToken;
+    }
+    fb303::fbData->setCounter("subscribers.kvstore", kvStorePublishers_.size());
+  });
+}
+
 folly::SemiFuture<apache::thrift::ResponseAndServerStream<
     thrift::Publication,
     thrift::Publication>>
@@ -1004,23 +1569,47 @@ folly::SemiFuture<apache::thrift::ResponseAndServerStream<
 OpenrCtrlHandler::semifuture_subscribeAndGetAreaKvStores(
     std::unique_ptr<thrift::KeyDumpParams> dumpParams,
     std::unique_ptr<std::set<std::string>> selectAreas) {
-  auto dumpParamsCopy = std::make_unique<thrift::KeyDumpParams>(*dumpParams);
-  auto selectAreasCopy = std::make_unique<std::set<std::string>>(*selectAreas);
-  return kvStore_
-      ->semifuture_dumpKvStoreKeys(
-          std::move(*dumpParams), std::move(*selectAreas))
-      .defer([stream = subscribeKvStoreFilter(
-                  std::move(dumpParamsCopy), std::move(selectAreasCopy))](
-                 folly::Try<std::unique_ptr<std::vector<thrift::Publication>>>&&
-                     pubs) mutable {
-        pubs.throwUnlessValue();
-        for (auto& pub : *pubs.value()) {
-          // Set the publication timestamp
-          pub.timestamp_ms_ref() = getUnixTimeStampMs();
-        }
+  // Get new client-ID (monotonically increasing)
+  const auto clientToken = publisherToken_++;
+  // ATTN: publisher is registered ahead of dump, holding updates published
+  //       meanwhile
+  auto stream = subscribeKvStoreFilter(
+      clientToken,
+      std::make_unique<thrift::KeyDumpParams>(*dumpParams),
+      std::make_unique<std::set<std::string>>(*selectAreas),
+      true /* holdUntilSnapshots */);
+  return dumpKvStoreSnapshots(
+             clientToken, std::move(*dumpParams), std::move(*selectAreas))
+      .deferValue([stream = std::move(stream)](
+                      std::vector<thrift::Publication>&& pubs) mutable {
         return apache::thrift::ResponseAndServerStream<
             std::vector<thrift::Publication>,
-            thrift::Publication>{std::move(*pubs.value()), std::move(stream)};
+            thrift::Publication>{std::move(pubs), std::move(stream)};
+      });
+}
+
+folly::SemiFuture<apache::thrift::ResponseAndServerStream<
+    std::vector<thrift::Publication>,
+    thrift::EncodedStreamMessage>>
+OpenrCtrlHandler::semifuture_subscribeAndGetAreaKvStoresEncoded(
+    std::unique_ptr<thrift::KeyDumpParams> dumpParams,
+    std::unique_ptr<std::set<std::string>> selectAreas,
+    std::unique_ptr<thrift::StreamEncodingParams> encoding) {
+  auto encoder = createStreamEncoder(std::move(*encoding));
+  const auto clientToken = publisherToken_++;
+  auto stream = subscribeKvStoreFilterEncoded(
+      clientToken,
+      std::make_unique<thrift::KeyDumpParams>(*dumpParams),
+      std::make_unique<std::set<std::string>>(*selectAreas),
+      std::move(encoder),
+      true /* holdUntilSnapshots */);
+  return dumpKvStoreSnapshots(
+             clientToken, std::move(*dumpParams), std::move(*selectAreas))
+      .deferValue([stream = std::move(stream)](
+                      std::vector<thrift::Publication>&& pubs) mutable {
+        return apache::thrift::ResponseAndServerStream<
+            std::vector<thrift::Publication>,
+            thrift::EncodedStreamMessage>{std::move(pubs), std::move(stream)};
       });
 }
 
@@ -1060,7 +1649,9 @@ folly::SemiFuture<apache::thrift::ResponseAndServerStream<
     thrift::RouteDatabaseDelta>>
 OpenrCtrlHandler::semifuture_subscribeAndGetFib() {
   auto stream = subscribeFib();
-  return semifuture_getRouteDb().defer(
+  // initial dump of delta stream is not subject to memory pressure
+  CHECK(fib_);
+  return fib_->getRouteDb().defer(
       [stream = std::move(stream)](
           folly::Try<std::unique_ptr<thrift::RouteDatabase>>&& db) mutable {
         db.throwUnlessValue();
@@ -1071,23 +1662,144 @@ OpenrCtrlHandler::semifuture_subscribeAndGetFib() {
       });
 }
 
+void
+OpenrCtrlHandler::removeFibDetailSubscriber(int64_t clientToken) {
+  fibDetailSubscribers_.withWLock([&clientToken](auto& fibDetailSubscribers) {
+    if (fibDetailSubscribers.erase(clientToken)) {
+      XLOG(INFO) << "Fib detail snoop stream-" << clientToken << " ended.";
+    } else {
+      XLOG(ERR) << "Can't remove unknown Fib detail snoop stream-"
+                << clientToken;
+    }
+    fb303::fbData->setCounter(
+        "subscribers.fibDetail", fibDetailSubscribers.size());
+  });
+}
+
+#if FOLLY_HAS_COROUTINES
+std::shared_ptr<FibStreamSubscriber>
+OpenrCtrlHandler::addFibDetailSubscriber(int64_t clientToken) {
+  auto subscriber = std::make_shared<FibStreamSubscriber>(
+      std::chrono::steady_clock::now(),
+      nullptr,
+      Constants::kFibStreamMaxPendingDeltas,
+      Constants::kFibStreamMaxPendingRoutes);
+
+  fibDetailSubscribers_.withWLock(
+      [&clientToken, &subscriber](auto& fibDetailSubscribers) {
+        assert(fibDetailSubscribers.count(clientToken) == 0);
+        XLOG(INFO) << "Fib detail snoop stream-" << clientToken << " started.";
+        fibDetailSubscribers.emplace(clientToken, subscriber);
+        fb303::fbData->setCounter(
+            "subscribers.fibDetail", fibDetailSubscribers.size());
+      });
+  return subscriber;
+}
+
+folly::coro::Task<std::vector<thrift::RouteDatabaseDeltaDetail>>
+OpenrCtrlHandler::waitFibDetailDeltas(
+    std::shared_ptr<FibStreamSubscriber> subscriber, size_t maxDeltas) {
+  // Wake up when client cancels the stream
+  const auto& cancelToken = co_await folly::coro::co_current_cancellation_token;
+  folly::CancellationCallback onCancel(
+      cancelToken, [&subscriber]() { subscriber->baton.post(); });
+
+  std::vector<thrift::RouteDatabaseDeltaDetail> deltas;
+  while (not cancelToken.isCancellationRequested()) {
+    // Reset before looking into buffer to not miss any post
+    subscriber->baton.reset();
+
+    bool closed{false};
+    bool resync{false};
+    fibDetailSubscribers_.withWLock([&](auto&) {
+      closed = subscriber->closed;
+      while (deltas.size() < maxDeltas) {
+        auto delta = subscriber->buffer.pop();
+        if (not delta.has_value()) {
+          break;
+        }
+        deltas.emplace_back(std::move(*delta));
+      }
+      resync = deltas.empty() and subscriber->buffer.startResync();
+    });
+    if (closed) {
+      deltas.clear();
+      break;
+    }
+
+    // Routes have been dropped while client was lagging behind. Resync them
+    // from a fresh snapshot of routes.
+    if (resync) {
+      auto routeDb = co_await fib_->getRouteDetailDb();
+      fibDetailSubscribers_.withWLock([&](auto&) {
+        if (auto delta = subscriber->buffer.finishResync(*routeDb)) {
+          deltas.emplace_back(std::move(*delta));
+        }
+      });
+    }
+
+    if (deltas.empty()) {
+      co_await subscriber->baton;
+      continue;
+    }
+
+    fibDetailSubscribers_.withWLock([&](auto&) {
+      subscriber->total_messages++;
+      subscriber->last_message_time = std::chrono::system_clock::now();
+    });
+    break;
+  }
+  co_return deltas;
+}
+
+folly::coro::AsyncGenerator<thrift::RouteDatabaseDeltaDetail&&>
+OpenrCtrlHandler::streamFibDetail(
+    int64_t clientToken, std::shared_ptr<FibStreamSubscriber> subscriber) {
+  SCOPE_EXIT {
+    removeFibDetailSubscriber(clientToken);
+  };
+
+  while (true) {
+    auto deltas = co_await waitFibDetailDeltas(subscriber, 1);
+    if (deltas.empty()) {
+      break;
+    }
+    co_yield std::move(deltas.front());
+  }
+}
+
+folly::coro::AsyncGenerator<thrift::EncodedStreamMessage&&>
+OpenrCtrlHandler::streamFibDetailEncoded(
+    int64_t clientToken,
+    std::shared_ptr<FibStreamSubscriber> subscriber,
+    std::unique_ptr<StreamEncoder> encoder) {
+  SCOPE_EXIT {
+    removeFibDetailSubscriber(clientToken);
+  };
+
+  const size_t maxBatchSize =
+      std::max(1, *encoder->getParams().maxBatchSize_ref());
+  while (true) {
+    auto deltas = co_await waitFibDetailDeltas(subscriber, maxBatchSize);
+    if (deltas.empty()) {
+      break;
+    }
+    co_yield encoder->encode(encoder->makeFibBatch(std::move(deltas)));
+  }
+}
+#endif
+
 apache::thrift::ServerStream<thrift::RouteDatabaseDeltaDetail>
 OpenrCtrlHandler::subscribeFibDetail() {
   // Get new client-ID (monotonically increasing)
   auto clientToken = publisherToken_++;
 
+#if FOLLY_HAS_COROUTINES
+  return streamFibDetail(clientToken, addFibDetailSubscriber(clientToken));
+#else
   auto streamAndPublisher = apache::thrift::ServerStream<
       thrift::RouteDatabaseDeltaDetail>::createPublisher([this, clientToken]() {
-    fibDetailSubscribers_.withWLock([&clientToken](auto& fibDetailSubscribers) {
-      if (fibDetailSubscribers.erase(clientToken)) {
-        XLOG(INFO) << "Fib detail snoop stream-" << clientToken << " ended.";
-      } else {
-        XLOG(ERR) << "Can't remove unknown Fib detail snoop stream-"
-                  << clientToken;
-      }
-      fb303::fbData->setCounter(
-          "subscribers.fibDetail", fibDetailSubscribers.size());
-    });
+    removeFibDetailSubscriber(clientToken);
   });
 
   fibDetailSubscribers_.withWLock(
@@ -1097,20 +1809,27 @@ OpenrCtrlHandler::subscribeFibDetail() {
         auto publisher = std::make_unique<apache::thrift::ServerStreamPublisher<
             thrift::RouteDatabaseDeltaDetail>>(
             std::move(streamAndPublisher.second));
-        FibStreamSubscriber fib_subscriber(
-            std::chrono::steady_clock::now(), std::move(publisher));
-        fibDetailSubscribers.emplace(clientToken, std::move(fib_subscriber));
+        fibDetailSubscribers.emplace(
+            clientToken,
+            std::make_shared<FibStreamSubscriber>(
+                std::chrono::steady_clock::now(),
+                std::move(publisher),
+                Constants::kFibStreamMaxPendingDeltas,
+                Constants::kFibStreamMaxPendingRoutes));
         fb303::fbData->setCounter(
             "subscribers.fibDetail", fibDetailSubscribers.size());
       });
 
   return std::move(streamAndPublisher.first);
+#endif
 }
 
 folly::SemiFuture<apache::thrift::ResponseAndServerStream<
     thrift::RouteDatabaseDetail,
     thrift::RouteDatabaseDeltaDetail>>
 OpenrCtrlHandler::semifuture_subscribeAndGetFibDetail() {
+  rejectUnderMemoryPressure(
+      MemoryPressureLevel::DROP_SUBSCRIPTIONS, "subscribeAndGetFibDetail");
   auto stream = subscribeFibDetail();
   return semifuture_getRouteDetailDb().defer(
       [stream = std::move(stream)](
@@ -1124,6 +1843,71 @@ OpenrCtrlHandler::semifuture_subscribeAndGetFibDetail() {
       });
 }
 
+#if FOLLY_HAS_COROUTINES
+folly::SemiFuture<apache::thrift::ResponseAndServerStream<
+    thrift::RouteDatabaseDetail,
+    thrift::EncodedStreamMessage>>
+OpenrCtrlHandler::semifuture_subscribeAndGetFibDetailEncoded(
+    std::unique_ptr<thrift::StreamEncodingParams> encoding) {
+  rejectUnderMemoryPressure(
+      MemoryPressureLevel::DROP_SUBSCRIPTIONS,
+      "subscribeAndGetFibDetailEncoded");
+  auto encoder = createStreamEncoder(std::move(*encoding));
+  // Get new client-ID (monotonically increasing)
+  auto clientToken = publisherToken_++;
+  apache::thrift::ServerStream<thrift::EncodedStreamMessage> stream =
+      streamFibDetailEncoded(
+          clientToken, addFibDetailSubscriber(clientToken), std::move(encoder));
+  return semifuture_getRouteDetailDb().defer(
+      [stream = std::move(stream)](
+          folly::Try<std::unique_ptr<thrift::RouteDatabaseDetail>>&&
+              db) mutable {
+        db.throwIfFailed();
+        return apache::thrift::ResponseAndServerStream<
+            thrift::RouteDatabaseDetail,
+            thrift::EncodedStreamMessage>{
+            std::move(*db.value()), std::move(stream)};
+      });
+}
+#endif
+
+#if FOLLY_HAS_COROUTINES
+apache::thrift::SinkConsumer<std::vector<thrift::PrefixEntry>, int64_t>
+OpenrCtrlHandler::syncPrefixesByTypeStream(thrift::PrefixType prefixType) {
+  CHECK(prefixManager_);
+  return apache::thrift::SinkConsumer<
+      std::vector<thrift::PrefixEntry>,
+      int64_t>{
+      [this, prefixType](
+          folly::coro::AsyncGenerator<std::vector<thrift::PrefixEntry>&&>
+              chunks) -> folly::coro::Task<int64_t> {
+        int64_t numPrefixes{0};
+        folly::exception_wrapper ew;
+        try {
+          while (auto chunk = co_await chunks.next()) {
+            numPrefixes += chunk->size();
+            co_await prefixManager_->syncPrefixesByTypeChunk(
+                prefixType, std::move(*chunk));
+          }
+        } catch (const std::exception& ex) {
+          ew = folly::exception_wrapper(std::current_exception(), ex);
+        }
+
+        // ATTN: can't co_await within catch block
+        if (ew) {
+          XLOG(ERR) << "Chunked sync of prefixes of type "
+                    << toString(prefixType)
+                    << " terminated: " << ew.what();
+          co_await prefixManager_->abortSyncPrefixesByType(prefixType);
+          ew.throw_exception();
+        }
+        co_await prefixManager_->commitSyncPrefixesByType(prefixType);
+        co_return numPrefixes;
+      },
+      Constants::kPrefixSyncSinkBufferSize};
+}
+#endif
+
 //
 // LinkMonitor APIs
 //
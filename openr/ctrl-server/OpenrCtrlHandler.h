@@ -7,10 +7,22 @@
 
 #pragma once
 
+#include <deque>
+#include <mutex>
+
 #include <fb303/BaseService.h>
+#if FOLLY_HAS_COROUTINES
+#include <folly/experimental/coro/AsyncGenerator.h>
+#include <folly/experimental/coro/Task.h>
+#endif
+#include <openr/common/MemoryPressure.h>
+#include <openr/common/StreamEncoder.h>
 #include <openr/common/Types.h>
 #include <openr/config-store/PersistentStore.h>
 #include <openr/config/Config.h>
+#include <openr/ctrl-server/CtrlApiStatsCollector.h>
+#include <openr/ctrl-server/CtrlResponseCache.h>
+#include <openr/ctrl-server/FibStreamSubscriber.h>
 #include <openr/decision/Decision.h>
 #include <openr/fib/Fib.h>
 #include <openr/if/gen-cpp2/OpenrCtrl.h>
@@ -25,21 +37,6 @@
 
 namespace openr {
 
-struct FibStreamSubscriber {
-  FibStreamSubscriber(
-      std::chrono::steady_clock::time_point upSince,
-      std::unique_ptr<apache::thrift::ServerStreamPublisher<
-          thrift::RouteDatabaseDeltaDetail>> publisher)
-      : upSince(upSince), publisher(std::move(publisher)), total_messages(0) {}
-
-  std::chrono::steady_clock::time_point upSince;
-  std::unique_ptr<
-      apache::thrift::ServerStreamPublisher<thrift::RouteDatabaseDeltaDetail>>
-      publisher;
-  int64_t total_messages;
-  std::chrono::system_clock::time_point last_message_time;
-};
-
 class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
                                public facebook::fb303::BaseService {
  public:
@@ -59,7 +56,10 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
       PersistentStore* configStore,
       PrefixManager* prefixManager,
       Spark* spark,
-      std::shared_ptr<const Config> config);
+      std::shared_ptr<const Config> config,
+      // additional Spark instances if interfaces are sharded, see
+      // SparkConfig.num_shards
+      std::vector<Spark*> sparkShards = {});
 
   ~OpenrCtrlHandler() override;
 
@@ -92,6 +92,10 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
   void dryrunConfig(
       ::std::string& _return, std::unique_ptr<::std::string> file) override;
 
+  void reloadConfig(
+      std::vector<::std::string>& _return,
+      std::unique_ptr<::std::string> file) override;
+
   //
   // OpenR initialization APIs
   //
@@ -109,6 +113,18 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
 
   void getEventLogs(std::vector<::std::string>& _return) override;
 
+  void startHeapProfiling() override;
+
+  void stopHeapProfiling(std::unique_ptr<std::string> dumpPath) override;
+
+  void getTraceEvents(
+      std::vector<thrift::TraceEvent>& _return,
+      std::unique_ptr<std::vector<int64_t>> traceIds) override;
+
+  void getTraceEventsChromeJson(
+      std::string& _return,
+      std::unique_ptr<std::vector<int64_t>> traceIds) override;
+
   //
   // PrefixManager APIs
   //
@@ -175,6 +191,18 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
   folly::SemiFuture<std::unique_ptr<std::vector<thrift::UnicastRoute>>>
   semifuture_getUnicastRoutes() override;
 
+  folly::SemiFuture<std::unique_ptr<thrift::UnicastRoutesPage>>
+  semifuture_getUnicastRoutesPage(
+      std::unique_ptr<thrift::PageParams> pageParams) override;
+
+  folly::SemiFuture<std::unique_ptr<std::vector<thrift::RouteLookupResult>>>
+  semifuture_lookupRoutes(
+      std::unique_ptr<std::vector<thrift::BinaryAddress>> addresses) override;
+
+  folly::SemiFuture<std::unique_ptr<std::vector<thrift::RouteFingerprint>>>
+  semifuture_getUnicastRouteFingerprints(
+      std::unique_ptr<std::vector<thrift::IpPrefix>> ranges) override;
+
   folly::SemiFuture<std::unique_ptr<std::vector<thrift::MplsRoute>>>
   semifuture_getMplsRoutesFiltered(
       std::unique_ptr<std::vector<int32_t>> labels) override;
@@ -198,6 +226,13 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
   folly::SemiFuture<std::unique_ptr<thrift::PerfDatabase>>
   semifuture_getPerfDb() override;
 
+  folly::SemiFuture<
+      std::unique_ptr<std::vector<thrift::ConvergenceDistribution>>>
+  semifuture_getConvergenceDistributions() override;
+
+  void getCtrlApiStats(
+      std::map<std::string, thrift::CtrlApiStats>& _return) override;
+
   //
   // Decision APIs
   //
@@ -209,6 +244,11 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
   semifuture_getReceivedRoutesFiltered(
       std::unique_ptr<thrift::ReceivedRouteFilter> filter) override;
 
+  folly::SemiFuture<std::unique_ptr<thrift::ReceivedRoutesPage>>
+  semifuture_getReceivedRoutesPage(
+      std::unique_ptr<thrift::ReceivedRouteFilter> filter,
+      std::unique_ptr<thrift::PageParams> pageParams) override;
+
   folly::SemiFuture<std::unique_ptr<thrift::AdjDbs>>
   semifuture_getDecisionAdjacencyDbs() override;
 
@@ -218,6 +258,11 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
   semifuture_getDecisionAdjacenciesFiltered(
       std::unique_ptr<thrift::AdjacenciesFilter> filter) override;
 
+  folly::SemiFuture<std::unique_ptr<thrift::AdjacenciesPage>>
+  semifuture_getDecisionAdjacenciesPage(
+      std::unique_ptr<thrift::AdjacenciesFilter> filter,
+      std::unique_ptr<thrift::PageParams> pageParams) override;
+
   folly::SemiFuture<std::unique_ptr<
       std::map<std::string, std::vector<thrift::AdjacencyDatabase>>>>
   semifuture_getDecisionAreaAdjacenciesFiltered(
@@ -270,6 +315,13 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
       std::unique_ptr<thrift::KeyDumpParams> filter,
       std::unique_ptr<std::string> area) override;
 
+  // Page of above, see [Paginated Dump]
+  folly::SemiFuture<std::unique_ptr<thrift::KvStoreKeyValsPage>>
+  semifuture_getKvStoreKeyValsFilteredAreaPage(
+      std::unique_ptr<thrift::KeyDumpParams> filter,
+      std::unique_ptr<std::string> area,
+      std::unique_ptr<thrift::PageParams> pageParams) override;
+
   /*
    * [Backward Compatibility] Same as above, but use local KvStoreDb's area
    */
@@ -277,6 +329,20 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
   semifuture_getKvStoreKeyValsFiltered(
       std::unique_ptr<thrift::KeyDumpParams> filter) override;
 
+  /*
+   * API to return one chunk of full-sync response by given:
+   *  - thrift::KeyDumpParams;
+   *  - a specific area;
+   *  - thrift::KvStoreSyncChunkParams, i.e. range of keys to cover;
+   *
+   * ATTN: used by KvStore peers to break down initial full-sync into chunks
+   */
+  folly::SemiFuture<std::unique_ptr<thrift::KvStoreSyncChunk>>
+  semifuture_getKvStoreSyncChunkArea(
+      std::unique_ptr<thrift::KeyDumpParams> filter,
+      std::unique_ptr<std::string> area,
+      std::unique_ptr<thrift::KvStoreSyncChunkParams> chunkParams) override;
+
   /*
    * API to return key-val HASHes(NO binary value included) only by given:
    *  - thrift::KeyDumpParams;
@@ -348,6 +414,15 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
   semifuture_getKvStoreAreaSummary(
       std::unique_ptr<std::set<std::string>> selectAreas) override;
 
+  /*
+   * API to return memory and churn accounting per key family, e.g. `adj`,
+   * `prefix`, of a specified area
+   */
+  folly::SemiFuture<
+      std::unique_ptr<std::map<std::string, thrift::KvStoreKeyFamilyStats>>>
+  semifuture_getKvStoreKeyFamilyStatsArea(
+      std::unique_ptr<std::string> area) override;
+
   // Stream API's
   // Intentionally not use SemiFuture as stream is async by nature and we will
   // immediately create and return the stream handler
@@ -355,6 +430,13 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
       std::unique_ptr<thrift::KeyDumpParams> filter,
       std::unique_ptr<std::set<std::string>> selectAreas);
 
+  // [Encoded Stream] subscribeKvStoreFilter() encoded by `encoder`
+  apache::thrift::ServerStream<thrift::EncodedStreamMessage>
+  subscribeKvStoreFilterEncoded(
+      std::unique_ptr<thrift::KeyDumpParams> filter,
+      std::unique_ptr<std::set<std::string>> selectAreas,
+      std::unique_ptr<StreamEncoder> encoder);
+
   apache::thrift::ServerStream<thrift::RouteDatabaseDelta> subscribeFib();
 
   apache::thrift::ServerStream<thrift::RouteDatabaseDeltaDetail>
@@ -378,6 +460,14 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
       std::unique_ptr<thrift::KeyDumpParams> filter,
       std::unique_ptr<std::set<std::string>> selectAreas) override;
 
+  folly::SemiFuture<apache::thrift::ResponseAndServerStream<
+      std::vector<thrift::Publication>,
+      thrift::EncodedStreamMessage>>
+  semifuture_subscribeAndGetAreaKvStoresEncoded(
+      std::unique_ptr<thrift::KeyDumpParams> filter,
+      std::unique_ptr<std::set<std::string>> selectAreas,
+      std::unique_ptr<thrift::StreamEncodingParams> encoding) override;
+
   folly::SemiFuture<apache::thrift::ResponseAndServerStream<
       thrift::RouteDatabase,
       thrift::RouteDatabaseDelta>>
@@ -388,6 +478,22 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
       thrift::RouteDatabaseDeltaDetail>>
   semifuture_subscribeAndGetFibDetail() override;
 
+#if FOLLY_HAS_COROUTINES
+  // [Encoded Stream] Fib detail deltas are batched, hence streamed off
+  // coroutines only
+  folly::SemiFuture<apache::thrift::ResponseAndServerStream<
+      thrift::RouteDatabaseDetail,
+      thrift::EncodedStreamMessage>>
+  semifuture_subscribeAndGetFibDetailEncoded(
+      std::unique_ptr<thrift::StreamEncodingParams> encoding) override;
+#endif
+
+#if FOLLY_HAS_COROUTINES
+  // Sink API's
+  apache::thrift::SinkConsumer<std::vector<thrift::PrefixEntry>, int64_t>
+  syncPrefixesByTypeStream(thrift::PrefixType prefixType) override;
+#endif
+
   // Long poll support
   folly::SemiFuture<bool> semifuture_longPollKvStoreAdj(
       std::unique_ptr<thrift::KeyVals> snapshot) override;
@@ -491,7 +597,11 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
 
   inline size_t
   getNumPendingLongPollReqs() {
-    return longPollReqs_->size();
+    size_t numReqs{0};
+    for (const auto& [_, longPollArea] : *longPollReqs_.rlock()) {
+      numReqs += longPollArea.pendingReqs.size();
+    }
+    return numReqs;
   }
 
   inline size_t
@@ -504,12 +614,34 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
     return fibDetailSubscribers_.wlock()->size();
   }
 
+  // [Ctrl Stats] to be registered as thrift processor event handler by the
+  // server exposing this handler
+  inline std::shared_ptr<CtrlApiStatsCollector>
+  getApiStatsCollector() {
+    return apiStatsCollector_;
+  }
+
+  /*
+   * [Memory Governor] React to memory pressure reported by Watchdog
+   *  - SHRINK_CACHES: response caches are cleared and kept empty
+   *  - DROP_SUBSCRIPTIONS: Fib detail streams and pending long polls are
+   *    terminated, new ones are rejected
+   *  - REJECT_DUMPS: unpaginated dumps of routes, adjacencies and KvStore
+   *    keys are rejected in favour of their paginated variants
+   */
+  void setMemoryPressure(MemoryPressureLevel level);
+
   //
   // API to cleanup private variables
   //
   inline void
   cleanupPendingLongPollReqs() {
-    longPollReqs_->clear();
+    // adj versions are kept for requests comparing their snapshot
+    longPollReqs_.withWLock([](auto& longPollReqs) {
+      for (auto& [_, longPollArea] : longPollReqs) {
+        longPollArea.pendingReqs.clear();
+      }
+    });
   }
 
  private:
@@ -517,11 +649,94 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
   // eaxclty 1 area is configured
   std::unique_ptr<std::string> getSingleAreaOrThrow(std::string const& caller);
 
-  void processPublication(thrift::Publication&& pub);
+  // [Memory Governor] throws OpenrError if memory pressure is at `level`
+  // or above, pointing caller of `api` to `alternative` if any
+  void rejectUnderMemoryPressure(
+      MemoryPressureLevel level,
+      std::string const& api,
+      std::string const& alternative = "");
+
+  void processPublication(thrift::Publication const& pub);
   void authorizeConnection();
   void closeKvStorePublishers();
   void closeFibPublishers();
 
+  // Remove KvStore snoop stream publisher once its stream has ended
+  void removeKvStorePublisher(int64_t clientToken);
+
+  // Remove Fib detail subscriber once its stream has ended
+  void removeFibDetailSubscriber(int64_t clientToken);
+
+  // Register KvStore snoop stream publisher, removed once stream ends.
+  // [Snapshot Dump] With `holdUntilSnapshots`, publications are held back
+  // until dumpKvStoreSnapshots() starts the publisher.
+  template <typename... PublisherArgs>
+  void addKvStorePublisher(
+      int64_t clientToken,
+      std::unique_ptr<thrift::KeyDumpParams> filter,
+      std::unique_ptr<std::set<std::string>> selectAreas,
+      bool holdUntilSnapshots,
+      PublisherArgs&&... publisherArgs);
+
+  // Stream of publisher registered under `clientToken`
+  apache::thrift::ServerStream<thrift::Publication> subscribeKvStoreFilter(
+      int64_t clientToken,
+      std::unique_ptr<thrift::KeyDumpParams> filter,
+      std::unique_ptr<std::set<std::string>> selectAreas,
+      bool holdUntilSnapshots);
+
+  apache::thrift::ServerStream<thrift::EncodedStreamMessage>
+  subscribeKvStoreFilterEncoded(
+      int64_t clientToken,
+      std::unique_ptr<thrift::KeyDumpParams> filter,
+      std::unique_ptr<std::set<std::string>> selectAreas,
+      std::unique_ptr<StreamEncoder> encoder,
+      bool holdUntilSnapshots);
+
+  /*
+   * [Snapshot Dump]
+   *
+   * Initial dump of subscribeAndGet APIs. Dump is served off snapshots shared
+   * by KvStore, filtered on ctrl worker thread rather than KvStore event
+   * bases. Publisher of `clientToken` is then started at sequence numbers of
+   * snapshots, so stream neither misses nor repeats any update of the dump.
+   */
+  folly::SemiFuture<std::vector<thrift::Publication>> dumpKvStoreSnapshots(
+      int64_t clientToken,
+      thrift::KeyDumpParams filter,
+      std::set<std::string> selectAreas);
+
+  // Encoder of `encoding`, throws thrift::OpenrError if not supported
+  static std::unique_ptr<StreamEncoder> createStreamEncoder(
+      thrift::StreamEncodingParams encoding);
+
+#if FOLLY_HAS_COROUTINES
+  // Register new Fib detail subscriber
+  std::shared_ptr<FibStreamSubscriber> addFibDetailSubscriber(
+      int64_t clientToken);
+
+  // Wait for up to `maxDeltas` deltas buffered for the subscriber. Empty
+  // once subscriber is closed or stream is cancelled.
+  folly::coro::Task<std::vector<thrift::RouteDatabaseDeltaDetail>>
+  waitFibDetailDeltas(
+      std::shared_ptr<FibStreamSubscriber> subscriber, size_t maxDeltas);
+
+  // Stream deltas buffered for the subscriber as client asks for them. Client
+  // falling behind leaves deltas in the bounded buffer of the subscriber
+  // instead of the unbounded queue of stream publisher.
+  folly::coro::AsyncGenerator<thrift::RouteDatabaseDeltaDetail&&>
+  streamFibDetail(
+      int64_t clientToken, std::shared_ptr<FibStreamSubscriber> subscriber);
+
+  // [Encoded Stream] streamFibDetail() as encoded batches of deltas. Deltas
+  // buffered while client lags behind are merged into the next batch.
+  folly::coro::AsyncGenerator<thrift::EncodedStreamMessage&&>
+  streamFibDetailEncoded(
+      int64_t clientToken,
+      std::shared_ptr<FibStreamSubscriber> subscriber,
+      std::unique_ptr<StreamEncoder> encoder);
+#endif
+
   const std::string nodeName_;
   const std::unordered_set<std::string> acceptablePeerCommonNames_;
 
@@ -535,15 +750,22 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
   PersistentStore* configStore_{nullptr};
   PrefixManager* prefixManager_{nullptr};
   Spark* spark_{nullptr};
+  // ATTN: replaced upon config reload, use std::atomic_load/store
   std::shared_ptr<const Config> config_;
+  // serialize config reloads
+  std::mutex reloadConfigLock_;
+  // [Ctrl Cache] bumped on every config reload
+  std::atomic<int64_t> configVersion_{0};
+  std::vector<Spark*> sparkShards_;
+
+  // [Memory Governor] last level reported by Watchdog
+  std::atomic<MemoryPressureLevel> memoryPressure_{MemoryPressureLevel::NONE};
 
   // Publisher token (monotonically increasing) for all publishers
   std::atomic<int64_t> publisherToken_{0};
 
-  // Active kvstore snoop publishers
-  folly::Synchronized<
-      std::unordered_map<int64_t, std::unique_ptr<KvStorePublisher>>>
-      kvStorePublishers_;
+  // Active kvstore snoop publishers, indexed by their filters
+  folly::Synchronized<KvStorePublisherDispatcher> kvStorePublishers_;
 
   // Active Fib streaming publishers
   folly::Synchronized<std::unordered_map<
@@ -551,18 +773,53 @@ class OpenrCtrlHandler final : public thrift::OpenrCtrlCppSvIf,
       apache::thrift::ServerStreamPublisher<thrift::RouteDatabaseDelta>>>
       fibPublishers_;
 
-  // Active Fib Detail streaming publishers
-  folly::Synchronized<std::unordered_map<int64_t, FibStreamSubscriber>>
+  // Active Fib Detail streaming subscribers. Lock also guards the state of
+  // subscribers, including the ones held by their streams only.
+  folly::Synchronized<
+      std::unordered_map<int64_t, std::shared_ptr<FibStreamSubscriber>>>
       fibDetailSubscribers_;
 
-  // pending longPoll requests from clients, which consists of
-  // 1). promise; 2). timestamp when req received on server
-  std::atomic<int64_t> pendingRequestId_{0};
-  folly::Synchronized<std::unordered_map<
-      std::string /* area */,
-      std::unordered_map<int64_t, std::pair<folly::Promise<bool>, int64_t>>>>
+  // pending longPoll request of a client along with the timestamp it got
+  // parked at
+  struct LongPollReq {
+    folly::Promise<bool> promise;
+    int64_t timeStamp{0};
+  };
+
+  // [Long Poll] pending longPoll requests of an area. `adjVersion` is bumped
+  // on every "adj:" key change of the area. Requests compare their snapshot
+  // against KvStore at some version and are parked only if the area is still
+  // at that version, so every parked request is stale once version is bumped
+  // and all of them are woken. Requests are parked in arrival order, hence
+  // expired ones are found at the front. Publications cost O(woken requests)
+  // rather than O(pending requests).
+  struct LongPollArea {
+    int64_t adjVersion{0};
+    std::deque<LongPollReq> pendingReqs;
+  };
+  folly::Synchronized<
+      std::unordered_map<std::string /* area */, LongPollArea>>
       longPollReqs_;
 
+  // [Ctrl Cache] responses of read-only APIs polled by monitoring agents,
+  // keyed by request arguments and versioned by state of owning module.
+  // Shared with pending requests, which fill them on completion.
+  static constexpr size_t kMaxCachedResponses{64};
+  using AdvertisedRoutesCache =
+      CtrlResponseCache<std::vector<thrift::AdvertisedRouteDetail>>;
+  using ReceivedRoutesCache =
+      CtrlResponseCache<std::vector<thrift::ReceivedRouteDetail>>;
+  std::shared_ptr<CtrlResponseCache<std::string>> runningConfigCache_{
+      std::make_shared<CtrlResponseCache<std::string>>(kMaxCachedResponses)};
+  std::shared_ptr<AdvertisedRoutesCache> advertisedRoutesCache_{
+      std::make_shared<AdvertisedRoutesCache>(kMaxCachedResponses)};
+  std::shared_ptr<ReceivedRoutesCache> receivedRoutesCache_{
+      std::make_shared<ReceivedRoutesCache>(kMaxCachedResponses)};
+
+  // [Ctrl Stats] per-method stats of ctrl APIs
+  std::shared_ptr<CtrlApiStatsCollector> apiStatsCollector_{
+      std::make_shared<CtrlApiStatsCollector>()};
+
   // fiber task future hold for kvStore update, fib update reader's
   std::vector<folly::Future<folly::Unit>> workers_;
 }; // class OpenrCtrlHandler
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <openr/ctrl-server/CtrlApiStatsCollector.h>
+
+using namespace openr;
+using namespace std::chrono_literals;
+
+TEST(CtrlApiStatsCollectorTest, RecordCall) {
+  CtrlApiStatsCollector collector;
+  const auto now = CtrlApiStatsCollector::Clock::now();
+  for (int i = 0; i < 100; ++i) {
+    // one slow call out of a hundred
+    const auto moduleTime = i == 0 ? 10000us : 100us;
+    collector.recordCall(
+        "OpenrCtrl.getRunningConfig", 10us, moduleTime, 1us, 50, false, now);
+  }
+  // queue time unknown
+  collector.recordCall(
+      "OpenrCtrl.getPerfDb", std::nullopt, 100us, 1us, 0, true, now);
+
+  const auto stats = collector.getStats();
+  ASSERT_EQ(2, stats.size());
+
+  const auto& config = stats.at("OpenrCtrl.getRunningConfig");
+  EXPECT_EQ(100, *config.calls_ref());
+  EXPECT_EQ(0, *config.errors_ref());
+  EXPECT_EQ(5000, *config.bytesOut_ref());
+  // percentiles are upper bounds of power-of-two buckets
+  EXPECT_EQ(15, *config.queueTimeP50Us_ref());
+  EXPECT_EQ(127, *config.moduleTimeP50Us_ref());
+  EXPECT_EQ(127, *config.moduleTimeP99Us_ref());
+  EXPECT_EQ(1, *config.serializationTimeP99Us_ref());
+  EXPECT_EQ(127, *config.totalTimeP50Us_ref());
+
+  const auto& perfDb = stats.at("OpenrCtrl.getPerfDb");
+  EXPECT_EQ(1, *perfDb.calls_ref());
+  EXPECT_EQ(1, *perfDb.errors_ref());
+  EXPECT_EQ(0, *perfDb.queueTimeP99Us_ref());
+  EXPECT_EQ(101, *perfDb.totalTimeP99Us_ref());
+
+  std::map<std::string, int64_t> counters;
+  collector.getCounters(counters);
+  EXPECT_EQ(
+      127,
+      counters.at("ctrl.api.OpenrCtrl.getRunningConfig.module_time_us.p99"));
+  EXPECT_EQ(0, counters.at("ctrl.api.OpenrCtrl.getPerfDb.queue_time_us.p50"));
+}
+
+TEST(CtrlApiStatsCollectorTest, EventHandler) {
+  CtrlApiStatsCollector collector;
+  const char* fnName = "OpenrCtrl.getMyNodeName";
+  auto* ctx = collector.getContext(fnName, nullptr);
+  collector.preRead(ctx, fnName);
+  collector.postRead(ctx, fnName, nullptr, 10);
+  collector.preWrite(ctx, fnName);
+  collector.postWrite(ctx, fnName, 20);
+  collector.freeContext(ctx, fnName);
+
+  ctx = collector.getContext(fnName, nullptr);
+  collector.userException(ctx, fnName, "OpenrError", "error");
+  collector.freeContext(ctx, fnName);
+
+  const auto stats = collector.getStats();
+  ASSERT_EQ(1, stats.count(fnName));
+  EXPECT_EQ(2, *stats.at(fnName).calls_ref());
+  EXPECT_EQ(1, *stats.at(fnName).errors_ref());
+  EXPECT_EQ(20, *stats.at(fnName).bytesOut_ref());
+}
+
+int
+main(int argc, char** argv) {
+  // Basic initialization
+  testing::InitGoogleTest(&argc, argv);
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = true;
+
+  // Run the tests
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <openr/ctrl-server/CtrlResponseCache.h>
+
+using namespace openr;
+
+TEST(CtrlResponseCacheTest, VersionedLookup) {
+  CtrlResponseCache<std::string> cache(4);
+  EXPECT_EQ(nullptr, cache.get("args", 1));
+
+  cache.put("args", 1, std::make_shared<const std::string>("v1"));
+  ASSERT_NE(nullptr, cache.get("args", 1));
+  EXPECT_EQ("v1", *cache.get("args", 1));
+  // other version or arguments miss
+  EXPECT_EQ(nullptr, cache.get("args", 2));
+  EXPECT_EQ(nullptr, cache.get("other", 1));
+
+  // newer version replaces the response
+  cache.put("args", 2, std::make_shared<const std::string>("v2"));
+  EXPECT_EQ(nullptr, cache.get("args", 1));
+  EXPECT_EQ("v2", *cache.get("args", 2));
+
+  // late response of older version doesn't replace newer one
+  cache.put("args", 1, std::make_shared<const std::string>("v1"));
+  EXPECT_EQ("v2", *cache.get("args", 2));
+  EXPECT_EQ(1, cache.size());
+}
+
+TEST(CtrlResponseCacheTest, Bounded) {
+  CtrlResponseCache<std::string> cache(2);
+  cache.put("a", 1, std::make_shared<const std::string>("a"));
+  cache.put("b", 2, std::make_shared<const std::string>("b"));
+  EXPECT_EQ(2, cache.size());
+
+  // stale entry of "a" is dropped first
+  cache.put("c", 2, std::make_shared<const std::string>("c"));
+  EXPECT_EQ(2, cache.size());
+  EXPECT_EQ(nullptr, cache.get("a", 1));
+  EXPECT_EQ("b", *cache.get("b", 2));
+  EXPECT_EQ("c", *cache.get("c", 2));
+
+  // all entries are current, start over
+  cache.put("d", 2, std::make_shared<const std::string>("d"));
+  EXPECT_EQ(1, cache.size());
+  EXPECT_EQ("d", *cache.get("d", 2));
+
+  // updating existing entry doesn't evict
+  cache.put("e", 2, std::make_shared<const std::string>("e"));
+  cache.put("d", 3, std::make_shared<const std::string>("d3"));
+  EXPECT_EQ(2, cache.size());
+  EXPECT_EQ("e", *cache.get("e", 2));
+  EXPECT_EQ("d3", *cache.get("d", 3));
+}
+
+TEST(CtrlResponseCacheTest, Disabled) {
+  CtrlResponseCache<std::string> cache(2);
+  cache.put("a", 1, std::make_shared<const std::string>("a"));
+  cache.setEnabled(false);
+  EXPECT_EQ(0, cache.size());
+  cache.put("a", 1, std::make_shared<const std::string>("a"));
+  EXPECT_EQ(nullptr, cache.get("a", 1));
+
+  cache.setEnabled(true);
+  cache.put("a", 1, std::make_shared<const std::string>("a"));
+  EXPECT_EQ("a", *cache.get("a", 1));
+  cache.clear();
+  EXPECT_EQ(0, cache.size());
+}
+
+int
+main(int argc, char** argv) {
+  // Basic initialization
+  testing::InitGoogleTest(&argc, argv);
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = true;
+
+  // Run the tests
+  return RUN_ALL_TESTS();
+}
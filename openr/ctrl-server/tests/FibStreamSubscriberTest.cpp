@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <openr/common/NetworkUtil.h>
+#include <openr/ctrl-server/FibStreamSubscriber.h>
+
+using namespace openr;
+
+namespace {
+
+// Route of `prefix` carrying `version` next-hops to tell updates apart
+thrift::UnicastRouteDetail
+createRoute(const std::string& prefix, size_t version) {
+  thrift::UnicastRouteDetail route;
+  route.unicastRoute_ref()->dest_ref() = toIpPrefix(prefix);
+  route.unicastRoute_ref()->nextHops_ref()->resize(version);
+  return route;
+}
+
+thrift::RouteDatabaseDeltaDetail
+createUpdate(const std::string& prefix, size_t version) {
+  thrift::RouteDatabaseDeltaDetail delta;
+  delta.unicastRoutesToUpdate_ref()->emplace_back(
+      createRoute(prefix, version));
+  return delta;
+}
+
+thrift::RouteDatabaseDeltaDetail
+createDelete(const std::string& prefix) {
+  thrift::RouteDatabaseDeltaDetail delta;
+  delta.unicastRoutesToDelete_ref()->emplace_back(toIpPrefix(prefix));
+  return delta;
+}
+
+thrift::RouteDatabaseDeltaDetail
+createLabelUpdate(int32_t label) {
+  thrift::RouteDatabaseDeltaDetail delta;
+  thrift::MplsRouteDetail route;
+  route.mplsRoute_ref()->topLabel_ref() = label;
+  delta.mplsRoutesToUpdate_ref()->emplace_back(std::move(route));
+  return delta;
+}
+
+} // namespace
+
+TEST(FibStreamBufferTest, QueueWithinBound) {
+  FibStreamBuffer buffer(2, 10);
+  EXPECT_FALSE(buffer.pop().has_value());
+
+  buffer.push(createUpdate("10.0.0.0/24", 1));
+  buffer.push(createUpdate("10.0.0.0/24", 2));
+  EXPECT_EQ(2, buffer.numPendingDeltas());
+
+  // Deltas are streamed as is, in order
+  auto delta = buffer.pop();
+  ASSERT_TRUE(delta.has_value());
+  EXPECT_EQ(createUpdate("10.0.0.0/24", 1), *delta);
+  delta = buffer.pop();
+  ASSERT_TRUE(delta.has_value());
+  EXPECT_EQ(createUpdate("10.0.0.0/24", 2), *delta);
+
+  EXPECT_FALSE(buffer.pop().has_value());
+  EXPECT_EQ(0, buffer.numPendingDeltas());
+  EXPECT_EQ(0, buffer.numConflatedDeltas());
+  EXPECT_EQ(0, buffer.numDroppedDeltas());
+}
+
+TEST(FibStreamBufferTest, ConflateWhenFull) {
+  FibStreamBuffer buffer(2, 10);
+
+  buffer.push(createUpdate("10.0.0.0/24", 1));
+  buffer.push(createUpdate("10.0.1.0/24", 1));
+  buffer.push(createUpdate("10.0.0.0/24", 2));
+  buffer.push(createDelete("10.0.1.0/24"));
+  buffer.push(createLabelUpdate(100));
+  EXPECT_EQ(5, buffer.numPendingDeltas());
+  EXPECT_EQ(5, buffer.numConflatedDeltas());
+
+  // Latest update or delete of every prefix and label is kept
+  auto delta = buffer.pop();
+  ASSERT_TRUE(delta.has_value());
+  EXPECT_THAT(
+      *delta->unicastRoutesToUpdate_ref(),
+      testing::ElementsAre(createRoute("10.0.0.0/24", 2)));
+  EXPECT_THAT(
+      *delta->unicastRoutesToDelete_ref(),
+      testing::ElementsAre(toIpPrefix("10.0.1.0/24")));
+  ASSERT_EQ(1, delta->mplsRoutesToUpdate_ref()->size());
+  const auto& mplsRoute = delta->mplsRoutesToUpdate_ref()->at(0);
+  EXPECT_EQ(100, *mplsRoute.mplsRoute_ref()->topLabel_ref());
+
+  EXPECT_FALSE(buffer.pop().has_value());
+  EXPECT_EQ(0, buffer.numPendingDeltas());
+  EXPECT_FALSE(buffer.needsResync());
+
+  // Deltas are queued as is again once drained
+  buffer.push(createUpdate("10.0.0.0/24", 3));
+  EXPECT_EQ(createUpdate("10.0.0.0/24", 3), buffer.pop());
+}
+
+TEST(FibStreamBufferTest, ResyncDroppedRoutes) {
+  FibStreamBuffer buffer(1, 2);
+
+  buffer.push(createUpdate("10.0.0.0/24", 1));
+  buffer.push(createUpdate("10.0.1.0/24", 1));
+  EXPECT_FALSE(buffer.needsResync());
+
+  // Third route exceeds the bound on conflated routes
+  buffer.push(createUpdate("10.0.2.0/24", 1));
+  EXPECT_TRUE(buffer.needsResync());
+  EXPECT_EQ(3, buffer.numDroppedDeltas());
+  buffer.push(createDelete("10.0.3.0/24"));
+  EXPECT_EQ(4, buffer.numDroppedDeltas());
+  EXPECT_EQ(4, buffer.numPendingDeltas());
+  EXPECT_FALSE(buffer.pop().has_value());
+
+  EXPECT_TRUE(buffer.startResync());
+  EXPECT_FALSE(buffer.startResync());
+  EXPECT_EQ(1, buffer.numResyncs());
+  EXPECT_EQ(0, buffer.numPendingDeltas());
+
+  // Delta arriving while snapshot is fetched is streamed after resync
+  buffer.push(createUpdate("10.0.4.0/24", 1));
+
+  // Snapshot carries routes of the dropped deltas which still exist
+  thrift::RouteDatabaseDetail routeDb;
+  routeDb.unicastRoutes_ref()->emplace_back(createRoute("10.0.0.0/24", 2));
+  routeDb.unicastRoutes_ref()->emplace_back(createRoute("10.0.1.0/24", 1));
+  routeDb.unicastRoutes_ref()->emplace_back(createRoute("10.0.5.0/24", 1));
+
+  auto delta = buffer.finishResync(routeDb);
+  EXPECT_THAT(
+      *delta.unicastRoutesToUpdate_ref(),
+      testing::UnorderedElementsAre(
+          createRoute("10.0.0.0/24", 2), createRoute("10.0.1.0/24", 1)));
+  EXPECT_THAT(
+      *delta.unicastRoutesToDelete_ref(),
+      testing::UnorderedElementsAre(
+          toIpPrefix("10.0.2.0/24"), toIpPrefix("10.0.3.0/24")));
+
+  EXPECT_EQ(createUpdate("10.0.4.0/24", 1), buffer.pop());
+  EXPECT_FALSE(buffer.pop().has_value());
+}
+
+int
+main(int argc, char** argv) {
+  // Basic initialization
+  testing::InitGoogleTest(&argc, argv);
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = true;
+
+  // Run the tests
+  return RUN_ALL_TESTS();
+}
@@ -267,6 +267,11 @@ TEST_F(OpenrCtrlFixture, InitializationApis) {
   EXPECT_GE(handler_->getInitializationDurationMs(), 0);
   handler_->getInitializationEvents(events);
   EXPECT_EQ(events.count(thrift::InitializationEvent::INITIALIZED), 1);
+
+  // Startup phases are reported along with initialization events
+  logInitializationEvent("Main", thrift::InitializationEvent::MODULES_STARTED);
+  handler_->getInitializationEvents(events);
+  EXPECT_EQ(events.count(thrift::InitializationEvent::MODULES_STARTED), 1);
 }
 
 TEST_F(OpenrCtrlFixture, PrefixManagerApis) {
@@ -325,6 +330,23 @@ TEST_F(OpenrCtrlFixture, PrefixManagerApis) {
     auto routes = handler_->semifuture_getAdvertisedRoutes().get();
     EXPECT_EQ(1, routes->size());
   }
+
+  {
+    // served from cache until advertised routes change
+    auto cached = handler_->semifuture_getAdvertisedRoutes().get();
+    EXPECT_EQ(1, cached->size());
+
+    std::vector<thrift::PrefixEntry> prefixes{
+        createPrefixEntry("24.0.0.0/8", thrift::PrefixType::LOOPBACK),
+    };
+    handler_
+        ->semifuture_advertisePrefixes(
+            std::make_unique<std::vector<thrift::PrefixEntry>>(
+                std::move(prefixes)))
+        .get();
+    auto routes = handler_->semifuture_getAdvertisedRoutes().get();
+    EXPECT_EQ(2, routes->size());
+  }
 }
 
 TEST_F(OpenrCtrlFixture, RouteApis) {
@@ -369,6 +391,25 @@ TEST_F(OpenrCtrlFixture, RouteApis) {
     auto res = handler_->semifuture_getUnicastRoutes().get();
     EXPECT_EQ(0, res->size());
   }
+
+  {
+    auto page = handler_
+                    ->semifuture_getUnicastRoutesPage(
+                        std::make_unique<thrift::PageParams>())
+                    .get();
+    EXPECT_EQ(0, page->routes_ref()->size());
+    EXPECT_TRUE(page->pageInfo_ref()->snapshotVersion_ref().has_value());
+    EXPECT_FALSE(page->pageInfo_ref()->continuationToken_ref().has_value());
+
+    thrift::PageParams pageParams;
+    pageParams.continuationToken_ref() = "not-a-prefix";
+    EXPECT_THROW(
+        handler_
+            ->semifuture_getUnicastRoutesPage(
+                std::make_unique<thrift::PageParams>(pageParams))
+            .get(),
+        thrift::OpenrError);
+  }
   {
     const std::vector<std::int32_t> labels{1, 2};
     auto res = handler_
@@ -405,6 +446,35 @@ TEST_F(OpenrCtrlFixture, DecisionApis) {
     EXPECT_EQ(0, dbs->size());
   }
 
+  {
+    auto page = handler_
+                    ->semifuture_getDecisionAdjacenciesPage(
+                        std::make_unique<thrift::AdjacenciesFilter>(),
+                        std::make_unique<thrift::PageParams>())
+                    .get();
+    EXPECT_EQ(0, page->adjacencyDbs_ref()->size());
+    EXPECT_FALSE(page->pageInfo_ref()->continuationToken_ref().has_value());
+
+    auto routesPage = handler_
+                          ->semifuture_getReceivedRoutesPage(
+                              std::make_unique<thrift::ReceivedRouteFilter>(),
+                              std::make_unique<thrift::PageParams>())
+                          .get();
+    EXPECT_EQ(0, routesPage->routes_ref()->size());
+    EXPECT_FALSE(
+        routesPage->pageInfo_ref()->continuationToken_ref().has_value());
+
+    thrift::PageParams pageParams;
+    pageParams.continuationToken_ref() = "not-a-prefix";
+    EXPECT_THROW(
+        handler_
+            ->semifuture_getReceivedRoutesPage(
+                std::make_unique<thrift::ReceivedRouteFilter>(),
+                std::make_unique<thrift::PageParams>(pageParams))
+            .get(),
+        thrift::OpenrError);
+  }
+
   {
     auto routes = handler_->semifuture_getReceivedRoutes().get();
     EXPECT_EQ(0, routes->size());
@@ -583,6 +653,37 @@ TEST_F(OpenrCtrlFixture, KvStoreApis) {
     EXPECT_EQ(value333, keyVals["key333"]);
   }
 
+  // paginated dump covers every key exactly once
+  {
+    thrift::KeyDumpParams params;
+    params.keys_ref() = {"key"};
+    thrift::PageParams pageParams;
+    pageParams.pageSize_ref() = 4;
+    thrift::KeyVals keyVals;
+    size_t numPages{0};
+    while (true) {
+      auto page = handler_
+                      ->semifuture_getKvStoreKeyValsFilteredAreaPage(
+                          std::make_unique<thrift::KeyDumpParams>(params),
+                          std::make_unique<std::string>(kSpineAreaId),
+                          std::make_unique<thrift::PageParams>(pageParams))
+                      .get();
+      EXPECT_FALSE(page->pageInfo_ref()->snapshotVersion_ref().has_value());
+      EXPECT_GE(4, page->publication_ref()->keyVals_ref()->size());
+      for (auto& [key, val] : *page->publication_ref()->keyVals_ref()) {
+        EXPECT_TRUE(keyVals.emplace(key, val).second);
+      }
+      ++numPages;
+      if (not page->pageInfo_ref()->continuationToken_ref().has_value()) {
+        break;
+      }
+      pageParams.continuationToken_ref() =
+          *page->pageInfo_ref()->continuationToken_ref();
+    }
+    EXPECT_LE(3, numPages);
+    EXPECT_EQ(kvs, keyVals);
+  }
+
   //
   // getKvStoreAreaSummary() related
   //
@@ -974,6 +1075,120 @@ TEST_F(OpenrCtrlFixture, subscribeAndGetKvStoreFilteredWithKeysNoTtlUpdate) {
     }
   }
 
+  // Subscribe and Get API with encoded stream
+  {
+    const std::string key{"snoop-key"};
+    std::atomic<int> received{0};
+    thrift::StreamEncodingParams encoding;
+    encoding.compression_ref() =
+        folly::io::hasStreamCodec(folly::io::CodecType::ZSTD)
+        ? thrift::StreamCompression::ZSTD
+        : thrift::StreamCompression::NONE;
+    auto responseAndSubscription =
+        handler_
+            ->semifuture_subscribeAndGetAreaKvStoresEncoded(
+                std::make_unique<thrift::KeyDumpParams>(),
+                std::make_unique<std::set<std::string>>(kSpineOnlySet),
+                std::make_unique<thrift::StreamEncodingParams>(encoding))
+            .get();
+    ASSERT_EQ(
+        1,
+        (*responseAndSubscription.response.begin()->keyVals_ref()).count(key));
+
+    // messages are decoded in stream order
+    auto decoder = std::make_shared<StreamDecoder>();
+    auto subscription =
+        std::move(responseAndSubscription.stream)
+            .toClientStreamUnsafeDoNotUse()
+            .subscribeExTry(
+                folly::getEventBase(), [&received, key, decoder](auto&& t) {
+                  if (!t.hasValue()) {
+                    return;
+                  }
+                  auto pub = decoder->decode<thrift::Publication>(*t);
+                  if (not pub.keyVals_ref()->count(key)) {
+                    return;
+                  }
+                  EXPECT_EQ(
+                      received + 9, *pub.keyVals_ref()->at(key).version_ref());
+                  received++;
+                });
+    EXPECT_EQ(1, handler_->getNumKvStorePublishers());
+    for (int64_t version = 9; version < 12; ++version) {
+      kvStoreWrapper_->setKey(
+          kSpineAreaId,
+          key,
+          createThriftValue(version, "node1", std::string("value1")));
+    }
+    while (received < 3) {
+      std::this_thread::yield();
+    }
+
+    subscription.cancel();
+    std::move(subscription).detach();
+    while (handler_->getNumKvStorePublishers() != 0) {
+      std::this_thread::yield();
+    }
+  }
+
+  // Subscribe and Get API served off shared snapshot. Stream starts right
+  // after the dump.
+  {
+    const std::string key{"snoop-key"};
+    std::atomic<int> received{0};
+    auto getDump = [&]() {
+      return handler_
+          ->semifuture_subscribeAndGetAreaKvStores(
+              std::make_unique<thrift::KeyDumpParams>(),
+              std::make_unique<std::set<std::string>>(kSpineOnlySet))
+          .get();
+    };
+    auto responseAndSubscription = getDump();
+    const auto& dump = *responseAndSubscription.response.begin();
+    ASSERT_TRUE(dump.seqNum_ref().has_value());
+    const auto dumpSeqNum = *dump.seqNum_ref();
+    EXPECT_EQ(11, *dump.keyVals_ref()->at(key).version_ref());
+
+    auto subscription =
+        std::move(responseAndSubscription.stream)
+            .toClientStreamUnsafeDoNotUse()
+            .subscribeExTry(
+                folly::getEventBase(), [&received, key, dumpSeqNum](auto&& t) {
+                  if (!t.hasValue()) {
+                    return;
+                  }
+                  // nothing already in dump is streamed
+                  ASSERT_TRUE(t->seqNum_ref().has_value());
+                  EXPECT_LT(dumpSeqNum, *t->seqNum_ref());
+                  if (t->keyVals_ref()->count(key)) {
+                    EXPECT_EQ(12, *t->keyVals_ref()->at(key).version_ref());
+                    received++;
+                  }
+                });
+    kvStoreWrapper_->setKey(
+        kSpineAreaId,
+        key,
+        createThriftValue(12, "node1", std::string("value1")));
+    while (received < 1) {
+      std::this_thread::yield();
+    }
+
+    // snapshot is taken again once KvStore changed
+    auto nextResponseAndSubscription = getDump();
+    const auto& nextDump = *nextResponseAndSubscription.response.begin();
+    EXPECT_LT(dumpSeqNum, *nextDump.seqNum_ref());
+    EXPECT_EQ(12, *nextDump.keyVals_ref()->at(key).version_ref());
+
+    subscription.cancel();
+    std::move(subscription).detach();
+    {
+      auto stream = std::move(nextResponseAndSubscription.stream);
+    }
+    while (handler_->getNumKvStorePublishers() != 0) {
+      std::this_thread::yield();
+    }
+  }
+
   // Subscribe and Get API
   // No entry is found in the initial shapshot
   // Matching prefixes get injected later.
@@ -1918,6 +2133,71 @@ TEST_F(OpenrCtrlFixture, subscribeAndGetKvStoreFilteredWithoutValue) {
   }
 }
 
+TEST_F(OpenrCtrlFixture, subscribeKvStoreFilteredMultipleSubscribers) {
+  // Two concurrent subscribers with disjoint key prefixes. Each of them
+  // should ONLY receive keys matching its own filter.
+  std::atomic<int> received1{0};
+  std::atomic<int> received2{0};
+  auto subscribe = [this](
+                       std::string const& prefix,
+                       std::atomic<int>* received) {
+    thrift::KeyDumpParams filter;
+    filter.keys_ref() = {prefix};
+    filter.oper_ref() = thrift::FilterOperator::OR;
+
+    auto responseAndSubscription =
+        handler_
+            ->semifuture_subscribeAndGetAreaKvStores(
+                std::make_unique<thrift::KeyDumpParams>(filter),
+                std::make_unique<std::set<std::string>>(kSpineOnlySet))
+            .get();
+
+    return std::move(responseAndSubscription.stream)
+        .toClientStreamUnsafeDoNotUse()
+        .subscribeExTry(
+            folly::getUnsafeMutableGlobalEventBase(),
+            [prefix, received](
+                folly::Try<openr::thrift::Publication>&& t) mutable {
+              if (not t.hasValue()) {
+                return;
+              }
+              for (auto const& [key, _] : *t->keyVals_ref()) {
+                EXPECT_EQ(0, key.compare(0, prefix.size(), prefix));
+                ++(*received);
+              }
+            });
+  };
+  auto subscription1 = subscribe("key1", &received1);
+  auto subscription2 = subscribe("key2", &received2);
+
+  EXPECT_EQ(2, handler_->getNumKvStorePublishers());
+
+  for (auto const& key : {"key1:a", "key2:a", "key3:a", "key1:b"}) {
+    kvStoreWrapper_->setKey(
+        kSpineAreaId,
+        key,
+        createThriftValue(1, "node1", std::string("value"), 30000, 1));
+  }
+
+  // Wait until both subscribers receive their keys
+  while (received1 < 2 or received2 < 1) {
+    std::this_thread::yield();
+  }
+  EXPECT_EQ(2, received1);
+  EXPECT_EQ(1, received2);
+
+  // Cancel subscriptions
+  subscription1.cancel();
+  std::move(subscription1).detach();
+  subscription2.cancel();
+  std::move(subscription2).detach();
+
+  // Wait until publishers are destroyed
+  while (handler_->getNumKvStorePublishers() != 0) {
+    std::this_thread::yield();
+  }
+}
+
 TEST_F(OpenrCtrlFixture, LinkMonitorApis) {
   // create an interface
   auto nlEventsInjector =
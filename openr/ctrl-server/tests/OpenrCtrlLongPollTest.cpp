@@ -287,6 +287,31 @@ TEST_F(LongPollFixture, LongPollAdjExpired) {
   ASSERT_TRUE(isAdjChanged);
 }
 
+/*
+ * This UT mimicks multiple clients polling the same area. A single "adj:" key
+ * change wakes all of them.
+ */
+TEST_F(LongPollFixture, LongPollMultipleClients) {
+  std::vector<folly::SemiFuture<bool>> polls;
+  for (int i = 0; i < 3; ++i) {
+    polls.emplace_back(handler_->semifuture_longPollKvStoreAdjArea(
+        std::make_unique<std::string>(kTestingAreaName),
+        std::make_unique<thrift::KeyVals>()));
+  }
+  // requests are parked once snapshot is compared
+  EXPECT_EQ(3, handler_->getNumPendingLongPollReqs());
+
+  kvStoreWrapper_->setKey(
+      kTestingAreaName,
+      adjKey_,
+      createThriftValue(1, nodeName_, std::string("value1")));
+
+  for (auto& poll : polls) {
+    EXPECT_TRUE(std::move(poll).get());
+  }
+  EXPECT_EQ(0, handler_->getNumPendingLongPollReqs());
+}
+
 int
 main(int argc, char* argv[]) {
   // Parse command line flags
@@ -5,9 +5,12 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
 #include <fstream>
 
 #include <fb303/ServiceData.h>
+#include <folly/Conv.h>
+#include <folly/executors/thread_factory/NamedThreadFactory.h>
 #include <folly/futures/Future.h>
 #include <folly/logging/xlog.h>
 #include <utility>
@@ -17,9 +20,11 @@
 #endif
 
 #include <openr/common/Constants.h>
+#include <openr/common/ConvergenceTracer.h>
 #include <openr/common/Flags.h>
 #include <openr/common/LsdbUtil.h>
 #include <openr/common/NetworkUtil.h>
+#include <openr/common/Pagination.h>
 #include <openr/decision/Decision.h>
 #include <openr/decision/PrefixState.h>
 #include <openr/decision/RibEntry.h>
@@ -36,11 +41,20 @@ DecisionPendingUpdates::applyLinkStateChange(
     std::string const& nodeName,
     LinkState::LinkStateChange const& change,
     apache::thrift::optional_field_ref<thrift::PerfEvents const&> perfEvents) {
+  // remote topology change only affects routes towards some nodes, while
+  // local one may affect nexthops of any route. Drain of a node, local or
+  // remote, doesn't change any link, hence only affects routes towards nodes
+  // whose distance, nexthops or overload changed as well.
+  const bool scopedTopologyChange = change.topologyChanged &&
+      enableScopedRouteRebuild_ &&
+      (nodeName != myNodeName_ || change.isNodeDrainOnly());
   needsFullRebuild_ |=
-      (change.topologyChanged || change.nodeLabelChanged ||
+      ((change.topologyChanged && not scopedTopologyChange) ||
+       change.nodeLabelChanged ||
        // we only need a full rebuild if link attributes change locally
        // this would be a nexthop or link label change
        (change.linkAttributesChanged && nodeName == myNodeName_));
+  needsScopedRebuild_ |= scopedTopologyChange;
   addUpdate(perfEvents);
 }
 
@@ -56,7 +70,9 @@ void
 DecisionPendingUpdates::reset() {
   count_ = 0;
   perfEvents_ = std::nullopt;
+  traceIds_ = thrift::PerfEvents{};
   needsFullRebuild_ = false;
+  needsScopedRebuild_ = false;
   updatedPrefixes_.clear();
 }
 
@@ -67,6 +83,11 @@ DecisionPendingUpdates::addEvent(std::string const& eventDescription) {
   }
 }
 
+void
+DecisionPendingUpdates::traceEvent(const char* event) {
+  ConvergenceTracer::record(traceIds_, event);
+}
+
 std::optional<thrift::PerfEvents>
 DecisionPendingUpdates::moveOutEvents() {
   std::optional<thrift::PerfEvents> events = std::move(perfEvents_);
@@ -92,6 +113,74 @@ DecisionPendingUpdates::addUpdate(
     perfEvents_ = perfEvents ? *perfEvents : thrift::PerfEvents{};
     addPerfEvent(*perfEvents_, myNodeName_, "DECISION_RECEIVED");
   }
+
+  // Trace ids of all updates in the batch are kept, irrespective of the
+  // perf events retained above
+  if (perfEvents) {
+    ConvergenceTracer::record(*perfEvents, "DECISION_RECEIVED");
+    ConvergenceTracer::mergeTraceIds(traceIds_, *perfEvents);
+  }
+  if (perfEvents_) {
+    perfEvents_->traceIds_ref() = *traceIds_.traceIds_ref();
+  }
+}
+
+DecisionDebounceTuner::DecisionDebounceTuner(
+    std::chrono::milliseconds minDebounce,
+    std::chrono::milliseconds maxDebounce)
+    : minDebounce_(minDebounce),
+      maxDebounce_(maxDebounce),
+      lastUpdateIntervalMs_(2 * maxDebounce.count()),
+      updateIntervalMs_(2 * maxDebounce.count()) {}
+
+void
+DecisionDebounceTuner::recordUpdate(std::chrono::steady_clock::time_point now) {
+  if (lastUpdateTime_.has_value()) {
+    lastUpdateIntervalMs_ = std::min<double>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            now - *lastUpdateTime_)
+            .count(),
+        2 * maxDebounce_.count());
+    updateIntervalMs_ = kSampleWeight * lastUpdateIntervalMs_ +
+        (1 - kSampleWeight) * updateIntervalMs_;
+  }
+  lastUpdateTime_ = now;
+}
+
+void
+DecisionDebounceTuner::recordRebuildCost(std::chrono::milliseconds cost) {
+  rebuildCostMs_ =
+      kSampleWeight * cost.count() + (1 - kSampleWeight) * rebuildCostMs_;
+}
+
+std::pair<std::chrono::milliseconds, std::chrono::milliseconds>
+DecisionDebounceTuner::getBackoffRange() const {
+  if (lastUpdateIntervalMs_ >= maxDebounce_.count()) {
+    return {minDebounce_, minDebounce_};
+  }
+  if (updateIntervalMs_ < minDebounce_.count()) {
+    return {maxDebounce_, maxDebounce_};
+  }
+  const auto initialBackoff = std::clamp(
+      std::chrono::milliseconds(
+          static_cast<int64_t>(kRebuildCostFactor * rebuildCostMs_)),
+      minDebounce_,
+      maxDebounce_);
+  return {initialBackoff, maxDebounce_};
+}
+
+RebuildCostEstimate
+estimateRebuildCost(
+    size_t numPrefixes,
+    size_t numNodes,
+    size_t numIncrementalPrefixes,
+    bool incrementalRebuildsMplsRoutes) {
+  RebuildCostEstimate estimate;
+  estimate.fullCost = numPrefixes + numNodes;
+  estimate.incrementalCost =
+      RebuildCostEstimate::kIncrementalRouteCost * numIncrementalPrefixes +
+      (incrementalRebuildsMplsRoutes ? numNodes : 0);
+  return estimate;
 }
 } // namespace detail
 
@@ -103,14 +192,16 @@ Decision::Decision(
     std::shared_ptr<const Config> config,
     // consumer queue
     messaging::RQueue<PeerEvent> peerUpdatesQueue,
-    messaging::RQueue<KvStorePublication> kvStoreUpdatesQueue,
+    messaging::SharedRQueue<KvStorePublication> kvStoreUpdatesQueue,
     messaging::RQueue<DecisionRouteUpdate> staticRouteUpdatesQueue,
     // producer queue
     messaging::ReplicateQueue<DecisionRouteUpdate>& routeUpdatesQueue)
     : config_(config),
       routeUpdatesQueue_(routeUpdatesQueue),
       myNodeName_(*config->getConfig().node_name_ref()),
-      pendingUpdates_(*config->getConfig().node_name_ref()),
+      pendingUpdates_(
+          *config->getConfig().node_name_ref(),
+          config->isScopedRouteRebuildEnabled()),
       rebuildRoutesDebounced_(
           getEvb(),
           std::chrono::milliseconds(*config->getConfig()
@@ -137,7 +228,37 @@ Decision::Decision(
       config->isBgpRouteProgrammingEnabled(),
       config->isBestRouteSelectionEnabled(),
       config->isV4OverV6NexthopEnabled(),
-      config->isUcmpEnabled());
+      config->isUcmpEnabled(),
+      config->getSpfNumThreads(),
+      config->isLfaEnabled());
+  if (config->isAdaptiveDebounceEnabled()) {
+    debounceTuner_.emplace(
+        std::chrono::milliseconds(
+            *config->getConfig().decision_config_ref()->debounce_min_ms_ref()),
+        std::chrono::milliseconds(
+            *config->getConfig().decision_config_ref()->debounce_max_ms_ref()));
+  }
+  if (auto numDecodeThreads = config->getPublicationDecodeNumThreads()) {
+    decodeExecutor_ = std::make_unique<folly::CPUThreadPoolExecutor>(
+        numDecodeThreads,
+        std::make_shared<folly::NamedThreadFactory>("DecisionDecode"));
+  }
+  if (auto captureFile = config->getPublicationCaptureFile()) {
+    try {
+      publicationCapture_ =
+          std::make_unique<PublicationCaptureWriter>(*captureFile);
+      XLOG(INFO) << "[Publication Capture] Recording publications to "
+                 << *captureFile;
+    } catch (const std::system_error& e) {
+      XLOG(ERR) << "[Publication Capture] " << e.what();
+    }
+  }
+  for (auto const& prefix : config->getPriorityPrefixes()) {
+    priorityPrefixes_.emplace(folly::IPAddress::createNetwork(prefix));
+  }
+  priorityPrefixTags_.insert(
+      config->getPriorityPrefixTags().begin(),
+      config->getPriorityPrefixTags().end());
   // Populate prefix types whose static routes Decision awaits before initial
   // RIB computation.
   if (config->isSegmentRoutingEnabled() and config->isBgpPeeringEnabled() and
@@ -172,82 +293,88 @@ Decision::Decision(
   counterUpdateTimer_->scheduleTimeout(Constants::kCounterSubmitInterval);
 
   // Add reader to process peer updates from LinkMonitor
-  addFiberTask([q = std::move(peerUpdatesQueue), this]() mutable noexcept {
-    XLOG(INFO) << "Starting peer updates processing fiber";
-    while (true) {
-      auto maybePeerUpdate = q.get(); // perform read
-      XLOG(DBG3) << "Received peer update";
-      if (maybePeerUpdate.hasError()) {
-        XLOG(INFO) << "Terminating peer updates processing fiber";
-        break;
-      }
-      processPeerUpdates(std::move(maybePeerUpdate).value());
-    }
-  });
-
-  // Add reader to process publication from KvStore
-  addFiberTask([q = std::move(kvStoreUpdatesQueue), this]() mutable noexcept {
-    // Block processing KvStore publication until initial peers are received.
-    // This helps avoid missing KvStore adjacency publications for peers.
-    if (*config_->getConfig().enable_ordered_adj_publication_ref()) {
-      initialPeersReceivedBaton_.wait();
-    }
+  addQueueReaderTask(
+      "peer_updates",
+      std::move(peerUpdatesQueue),
+      Constants::kQueueReadBatchSize,
+      [this](std::vector<PeerEvent>&& peerUpdates) {
+        XLOG(DBG3) << "Received " << peerUpdates.size() << " peer updates";
+        for (auto& peerUpdate : peerUpdates) {
+          processPeerUpdates(std::move(peerUpdate));
+        }
+      });
 
-    XLOG(INFO) << "Starting KvStore updates processing fiber";
-    while (true) {
-      auto maybePub = q.get(); // perform read
-      XLOG(DBG3) << "Received KvStore update";
-      if (maybePub.hasError()) {
-        XLOG(INFO) << "Terminating KvStore updates processing fiber";
-        break;
-      }
-      try {
-        folly::variant_match(
-            std::move(maybePub).value(),
-            [this](thrift::Publication&& pub) {
-              processPublication(std::move(pub));
-              // Compute routes with exponential backoff timer if needed
-              if (pendingUpdates_.needsRouteUpdate()) {
-                rebuildRoutesDebounced_();
+  // Add reader to process publication from KvStore. Read publications queued
+  // up at once, so that a burst is handed to route rebuild debounce together.
+  //
+  // Block processing KvStore publication until initial peers are received.
+  // This helps avoid missing KvStore adjacency publications for peers.
+  addQueueReaderTask(
+      "kvstore_updates",
+      std::move(kvStoreUpdatesQueue),
+      Constants::kQueueReadBatchSize,
+      [this](std::vector<std::shared_ptr<const KvStorePublication>>&& pubs) {
+        XLOG(DBG3) << "Received " << pubs.size() << " KvStore updates";
+        try {
+          for (const auto& publication : pubs) {
+            // [Publication Capture] record exactly what is processed
+            if (publicationCapture_) {
+              auto written = publicationCapture_->write(*publication);
+              if (written.hasError()) {
+                XLOG(ERR) << "[Publication Capture] Stopped on write error: "
+                          << written.error();
+                publicationCapture_.reset();
               }
-            },
-            [this](thrift::InitializationEvent&& event) {
-              CHECK(event == thrift::InitializationEvent::KVSTORE_SYNCED)
-                  << fmt::format(
-                         "Unexpected initialization event: {}",
-                         apache::thrift::util::enumNameSafe(event));
-
-              // Received all initial KvStore publications.
-              XLOG(INFO) << "[Initialization] All initial publications are "
-                            "received from KvStore.";
-              initialKvStoreSynced_ = true;
-              triggerInitialBuildRoutes();
-            });
-      } catch (const std::exception& e) {
+            }
+            // ATTN: publication is shared with other readers. DO NOT mutate.
+            folly::variant_match(
+                *publication,
+                [this](thrift::Publication const& pub) {
+                  processPublication(pub);
+                },
+                [this](thrift::InitializationEvent const& event) {
+                  CHECK(event == thrift::InitializationEvent::KVSTORE_SYNCED)
+                      << fmt::format(
+                             "Unexpected initialization event: {}",
+                             apache::thrift::util::enumNameSafe(event));
+
+                  // Received all initial KvStore publications.
+                  XLOG(INFO)
+                      << "[Initialization] All initial publications are "
+                         "received from KvStore.";
+                  initialKvStoreSynced_ = true;
+                  triggerInitialBuildRoutes();
+                });
+          }
+          // Compute routes with exponential backoff timer if needed
+          if (pendingUpdates_.needsRouteUpdate()) {
+            scheduleRebuildRoutes();
+          }
+        } catch (const std::exception& e) {
 #ifndef NO_FOLLY_EXCEPTION_TRACER
-        // collect stack strace then fail the process
-        for (auto& exInfo : folly::exception_tracer::getCurrentExceptions()) {
-          XLOG(ERR) << exInfo;
-        }
+          // collect stack strace then fail the process
+          for (auto& exInfo :
+               folly::exception_tracer::getCurrentExceptions()) {
+            XLOG(ERR) << exInfo;
+          }
 #endif
-        // FATAL to produce core dump
-        XLOG(FATAL) << "Exception occured in Decision::processPublication - "
-                    << folly::exceptionStr(e);
-      }
-    }
-  });
+          // FATAL to produce core dump
+          XLOG(FATAL) << "Exception occured in Decision::processPublication - "
+                      << folly::exceptionStr(e);
+        }
+      },
+      *config_->getConfig().enable_ordered_adj_publication_ref()
+          ? &initialPeersReceivedBaton_
+          : nullptr);
 
   // Add reader to process static routes publication from prefix-manager
-  addFiberTask(
-      [q = std::move(staticRouteUpdatesQueue), this]() mutable noexcept {
-        XLOG(INFO) << "Starting static routes update processing fiber";
-        while (true) {
-          auto maybeThriftPub = q.get(); // perform read
-          if (maybeThriftPub.hasError()) {
-            XLOG(INFO) << "Terminating static routes update processing fiber";
-            break;
-          }
-          const auto prefixType = maybeThriftPub.value().prefixType;
+  addQueueReaderTask(
+      "static_route_updates",
+      std::move(staticRouteUpdatesQueue),
+      Constants::kQueueReadBatchSize,
+      [this](std::vector<DecisionRouteUpdate>&& thriftPubs) {
+        for (auto& thriftPub : thriftPubs) {
+          const auto prefixType = thriftPub.prefixType;
           if (prefixType.has_value()) {
             XLOG(DBG2) << fmt::format(
                 "Received static routes update of prefix type {}",
@@ -256,7 +383,7 @@ Decision::Decision(
           } else {
             XLOG(DBG2) << "Received static routes update";
           }
-          processStaticRoutesUpdate(std::move(maybeThriftPub).value());
+          processStaticRoutesUpdate(std::move(thriftPub));
         }
       });
 
@@ -272,8 +399,7 @@ Decision::Decision(
   // Create RibPolicy timer to process routes on policy expiry
   ribPolicyTimer_ = folly::AsyncTimeout::make(*getEvb(), [this]() noexcept {
     XLOG(WARNING) << "RibPolicy is expired";
-    pendingUpdates_.setNeedsFullRebuild();
-    rebuildRoutes("RIB_POLICY_EXPIRED");
+    rebuildRoutesForRibPolicy(ribPolicy_.get(), "RIB_POLICY_EXPIRED");
   });
 
   // Initialize some stat keys
@@ -283,7 +409,8 @@ Decision::Decision(
 
 void
 Decision::stop() {
-  // Post initialPeersReceivedBaton_ to unblock internal fiber from stopping.
+  // Post initialPeersReceivedBaton_ to unblock KvStore updates reader from
+  // stopping.
   initialPeersReceivedBaton_.post();
 
   // Invoke stop method of super class
@@ -291,16 +418,43 @@ Decision::stop() {
   XLOG(DBG1) << "Stopped Decision event base";
 }
 
+folly::SemiFuture<std::shared_ptr<const DecisionRouteDb>>
+Decision::getRouteDbSnapshot() {
+  if (auto snapshot = routeDbSnapshot_.load()) {
+    return folly::makeSemiFuture(std::move(snapshot));
+  }
+  folly::Promise<std::shared_ptr<const DecisionRouteDb>> p;
+  auto sf = p.getSemiFuture();
+  runInEventBaseThread([p = std::move(p), this]() mutable {
+    // snapshot may have been built by an earlier read in the meantime
+    auto snapshot = routeDbSnapshot_.load();
+    if (not snapshot) {
+      snapshot = std::make_shared<const DecisionRouteDb>(routeDb_);
+      routeDbSnapshot_.store(snapshot);
+    }
+    p.setValue(std::move(snapshot));
+  });
+  return sf;
+}
+
 folly::SemiFuture<std::unique_ptr<thrift::RouteDatabase>>
 Decision::getDecisionRouteDb(std::string nodeName) {
+  if (nodeName.empty() or nodeName == myNodeName_) {
+    return getRouteDbSnapshot().deferValue(
+        [nodeName = myNodeName_](
+            std::shared_ptr<const DecisionRouteDb> snapshot) {
+          auto routeDb = snapshot->toThrift();
+          *routeDb.thisNodeName_ref() = nodeName;
+          return std::make_unique<thrift::RouteDatabase>(std::move(routeDb));
+        });
+  }
+
+  // routes of other nodes are computed on demand
   folly::Promise<std::unique_ptr<thrift::RouteDatabase>> p;
   auto sf = p.getSemiFuture();
   runInEventBaseThread([p = std::move(p), nodeName, this]() mutable {
     thrift::RouteDatabase routeDb;
 
-    if (nodeName.empty()) {
-      nodeName = myNodeName_;
-    }
     auto maybeRouteDb =
         spfSolver_->buildRouteDb(nodeName, areaLinkStates_, prefixState_);
     if (maybeRouteDb.has_value()) {
@@ -368,24 +522,7 @@ Decision::getReceivedRoutesFiltered(thrift::ReceivedRouteFilter filter) {
           auto routes = prefixState_.getReceivedRoutesFiltered(filter);
 
           // Add best path result to this
-          auto const& bestRoutesCache = spfSolver_->getBestRoutesCache();
-          for (auto& route : routes) {
-            auto const& bestRoutesIt =
-                bestRoutesCache.find(toIPNetwork(*route.prefix_ref()));
-            if (bestRoutesIt != bestRoutesCache.end()) {
-              auto const& bestRoutes = bestRoutesIt->second;
-              // Set all selected node-area
-              for (auto const& [node, area] : bestRoutes.allNodeAreas) {
-                route.bestKeys_ref()->emplace_back();
-                auto& key = route.bestKeys_ref()->back();
-                key.node_ref() = node;
-                key.area_ref() = area;
-              }
-              // Set best node-area
-              route.bestKey_ref()->node_ref() = bestRoutes.bestNodeArea.first;
-              route.bestKey_ref()->area_ref() = bestRoutes.bestNodeArea.second;
-            }
-          }
+          setBestKeys(routes);
 
           // Set the promise
           p.setValue(std::make_unique<std::vector<thrift::ReceivedRouteDetail>>(
@@ -397,6 +534,150 @@ Decision::getReceivedRoutesFiltered(thrift::ReceivedRouteFilter filter) {
   return std::move(sf);
 }
 
+folly::SemiFuture<std::unique_ptr<thrift::AdjacenciesPage>>
+Decision::getDecisionAdjacenciesPage(
+    thrift::AdjacenciesFilter filter, thrift::PageParams pageParams) {
+  auto [p, sf] =
+      folly::makePromiseContract<std::unique_ptr<thrift::AdjacenciesPage>>();
+  runInEventBaseThread([this,
+                        p = std::move(p),
+                        filter = std::move(filter),
+                        pageParams = std::move(pageParams)]() mutable noexcept {
+    try {
+      std::vector<std::pair<std::string /* area */, std::string /* node */>>
+          keys;
+      for (auto const& [area, linkState] : areaLinkStates_) {
+        if (filter.selectAreas_ref()->empty() ||
+            filter.selectAreas_ref()->count(area)) {
+          for (auto const& [node, _] : linkState.getAdjacencyDatabases()) {
+            keys.emplace_back(area, node);
+          }
+        }
+      }
+      std::sort(keys.begin(), keys.end());
+
+      // token is length of area followed by area and node
+      const auto [begin, end] =
+          getPageRange(keys, pageParams, [](const std::string& token) {
+            const auto pos = token.find(':');
+            const auto areaLength = folly::to<size_t>(token.substr(0, pos));
+            return std::make_pair(
+                token.substr(pos + 1, areaLength),
+                token.substr(pos + 1 + areaLength));
+          });
+      auto page = std::make_unique<thrift::AdjacenciesPage>();
+      for (auto it = begin; it != end; ++it) {
+        page->adjacencyDbs_ref()->emplace_back(
+            areaLinkStates_.at(it->first).getAdjacencyDatabases().at(
+                it->second));
+      }
+      page->pageInfo_ref()->snapshotVersion_ref() = lsdbVersion_;
+      if (end != keys.end()) {
+        auto const& [area, node] = *std::prev(end);
+        page->pageInfo_ref()->continuationToken_ref() =
+            fmt::format("{}:{}{}", area.size(), area, node);
+      }
+      p.setValue(std::move(page));
+    } catch (const thrift::OpenrError& e) {
+      p.setException(e);
+    }
+  });
+  return std::move(sf);
+}
+
+folly::SemiFuture<std::unique_ptr<thrift::ReceivedRoutesPage>>
+Decision::getReceivedRoutesPage(
+    thrift::ReceivedRouteFilter filter, thrift::PageParams pageParams) {
+  auto [p, sf] =
+      folly::makePromiseContract<std::unique_ptr<thrift::ReceivedRoutesPage>>();
+  runInEventBaseThread([this,
+                        p = std::move(p),
+                        filter = std::move(filter),
+                        pageParams = std::move(pageParams)]() mutable noexcept {
+    try {
+      // Page through prefixes of the filter if any, all prefixes otherwise
+      std::vector<folly::CIDRNetwork> filterPrefixes;
+      if (auto prefixes = filter.prefixes_ref()) {
+        for (auto const& prefix : *prefixes) {
+          filterPrefixes.emplace_back(toIPNetwork(prefix));
+        }
+        std::sort(filterPrefixes.begin(), filterPrefixes.end());
+        filterPrefixes.erase(
+            std::unique(filterPrefixes.begin(), filterPrefixes.end()),
+            filterPrefixes.end());
+      }
+      auto const& sortedPrefixes =
+          filter.prefixes_ref() ? filterPrefixes : getSortedPrefixes();
+
+      const auto [begin, end] = getPageRange(
+          sortedPrefixes, pageParams, [](const std::string& token) {
+            return folly::IPAddress::createNetwork(token);
+          });
+      auto page = std::make_unique<thrift::ReceivedRoutesPage>();
+      auto const& constFilter = filter;
+      auto const& prefixes = prefixState_.prefixes();
+      for (auto it = begin; it != end; ++it) {
+        auto prefixIt = prefixes.find(*it);
+        if (prefixIt == prefixes.end()) {
+          continue;
+        }
+        PrefixState::filterAndAddReceivedRoute(
+            *page->routes_ref(),
+            constFilter.nodeName_ref(),
+            constFilter.areaName_ref(),
+            prefixIt->first,
+            prefixIt->second);
+      }
+      setBestKeys(*page->routes_ref());
+      page->pageInfo_ref()->snapshotVersion_ref() = lsdbVersion_;
+      if (end != sortedPrefixes.end()) {
+        page->pageInfo_ref()->continuationToken_ref() =
+            folly::IPAddress::networkToString(*std::prev(end));
+      }
+      p.setValue(std::move(page));
+    } catch (const thrift::OpenrError& e) {
+      p.setException(e);
+    }
+  });
+  return std::move(sf);
+}
+
+std::vector<folly::CIDRNetwork> const&
+Decision::getSortedPrefixes() {
+  if (sortedPrefixesVersion_ != lsdbVersion_) {
+    sortedPrefixes_.clear();
+    sortedPrefixes_.reserve(prefixState_.prefixes().size());
+    for (auto const& [prefix, _] : prefixState_.prefixes()) {
+      sortedPrefixes_.emplace_back(prefix);
+    }
+    std::sort(sortedPrefixes_.begin(), sortedPrefixes_.end());
+    sortedPrefixesVersion_ = lsdbVersion_;
+  }
+  return sortedPrefixes_;
+}
+
+void
+Decision::setBestKeys(std::vector<thrift::ReceivedRouteDetail>& routes) const {
+  auto const& bestRoutesCache = spfSolver_->getBestRoutesCache();
+  for (auto& route : routes) {
+    auto const& bestRoutesIt =
+        bestRoutesCache.find(toIPNetwork(*route.prefix_ref()));
+    if (bestRoutesIt != bestRoutesCache.end()) {
+      auto const& bestRoutes = bestRoutesIt->second;
+      // Set all selected node-area
+      for (auto const& [node, area] : bestRoutes.allNodeAreas) {
+        route.bestKeys_ref()->emplace_back();
+        auto& key = route.bestKeys_ref()->back();
+        key.node_ref() = node;
+        key.area_ref() = area;
+      }
+      // Set best node-area
+      route.bestKey_ref()->node_ref() = bestRoutes.bestNodeArea.first;
+      route.bestKey_ref()->area_ref() = bestRoutes.bestNodeArea.second;
+    }
+  }
+}
+
 folly::SemiFuture<folly::Unit>
 Decision::clearRibPolicy() {
   auto [p, sf] = folly::makePromiseContract<folly::Unit>();
@@ -413,10 +694,9 @@ Decision::clearRibPolicy() {
       error.message_ref() = "No RIB policy configured";
       p.setException(error);
     } else {
-      ribPolicy_ = nullptr;
+      auto oldPolicy = std::move(ribPolicy_);
       // Trigger route computation
-      pendingUpdates_.setNeedsFullRebuild();
-      rebuildRoutes("RIB_POLICY_CLEARED");
+      rebuildRoutesForRibPolicy(oldPolicy.get(), "RIB_POLICY_CLEARED");
       p.setValue();
     }
   });
@@ -454,14 +734,13 @@ Decision::setRibPolicy(thrift::RibPolicy const& ribPolicyThrift) {
         // Update local policy instance
         XLOG(INFO) << "Updating RibPolicy with new instance. Validity "
                    << durationLeft.count() << "ms";
-        ribPolicy_ = std::move(ribPolicy);
+        auto oldPolicy = std::exchange(ribPolicy_, std::move(ribPolicy));
 
         // Schedule timer for processing routes on expiry
         ribPolicyTimer_->scheduleTimeout(durationLeft);
 
         // Trigger route computation
-        pendingUpdates_.setNeedsFullRebuild();
-        rebuildRoutes("RIB_POLICY_UPDATE");
+        rebuildRoutesForRibPolicy(oldPolicy.get(), "RIB_POLICY_UPDATE");
 
         // Save rib policy to file.
         saveRibPolicyDebounced_();
@@ -707,23 +986,75 @@ Decision::readRibPolicy() {
   return;
 }
 
+void
+Decision::DecodedLsdbValue
+Decision::decodeLsdbValue(
+    const std::string& key, const thrift::Value& rawVal) const {
+  // stateless, unlike serializer_ which is not shared across threads
+  apache::thrift::CompactSerializer serializer;
+  try {
+    if (key.find(Constants::kAdjDbMarker.toString()) == 0) {
+      // adjacencyDb: keys starting with "adj:"
+      return readThriftObjStr<thrift::AdjacencyDatabase>(
+          rawVal.value_ref().value(), serializer);
+    }
+    if (key.find(Constants::kPrefixDbMarker.toString()) == 0) {
+      // prefixDb: keys starting with "prefix:"
+      return readThriftObjStr<thrift::PrefixDatabase>(
+          rawVal.value_ref().value(), serializer);
+    }
+  } catch (const std::exception& e) {
+    XLOG(ERR) << "Failed to deserialize info for key " << key
+              << ". Exception: " << folly::exceptionStr(e);
+  }
+  return std::monostate{};
+}
+
+std::vector<Decision::DecodedLsdbValue>
+Decision::decodeLsdbValues(
+    std::vector<std::pair<std::string const*, thrift::Value const*>> const&
+        keyVals) const {
+  std::vector<DecodedLsdbValue> decodedValues(keyVals.size());
+  auto decodeRange = [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      decodedValues[i] = decodeLsdbValue(*keyVals[i].first, *keyVals[i].second);
+    }
+  };
+
+  if (not decodeExecutor_ or keyVals.size() < 2 * kMinKeysPerDecodeShard) {
+    decodeRange(0, keyVals.size());
+    return decodedValues;
+  }
+
+  // every shard writes its own range of decodedValues
+  const size_t numShards = std::min(
+      keyVals.size() / kMinKeysPerDecodeShard,
+      decodeExecutor_->numThreads() * kDecodeShardsPerThread);
+  const size_t shardSize = (keyVals.size() + numShards - 1) / numShards;
+  std::vector<folly::Future<folly::Unit>> futures;
+  for (size_t begin = 0; begin < keyVals.size(); begin += shardSize) {
+    const size_t end = std::min(begin + shardSize, keyVals.size());
+    futures.emplace_back(folly::via(
+        decodeExecutor_.get(),
+        [&decodeRange, begin, end]() { decodeRange(begin, end); }));
+  }
+  folly::collect(std::move(futures)).get();
+  fb303::fbData->addStatValue(
+      "decision.publication_parallel_decodes", 1, fb303::COUNT);
+  return decodedValues;
+}
+
 void
 Decision::updateKeyInLsdb(
     const std::string& area,
     LinkState& areaLinkState,
     const std::string& key,
-    const thrift::Value& rawVal) {
-  if (not rawVal.value_ref().has_value()) {
-    // skip TTL update
-    DCHECK(*rawVal.ttlVersion_ref() > 0);
-    return;
-  }
-
+    DecodedLsdbValue&& decodedValue) {
   try {
-    if (key.find(Constants::kAdjDbMarker.toString()) == 0) {
+    if (auto* maybeAdjacencyDb =
+            std::get_if<thrift::AdjacencyDatabase>(&decodedValue)) {
       // adjacencyDb: update keys starting with "adj:"
-      auto adjacencyDb = readThriftObjStr<thrift::AdjacencyDatabase>(
-          rawVal.value_ref().value(), serializer_);
+      auto& adjacencyDb = *maybeAdjacencyDb;
 
       // Process adjacency to unblock Open/R initialization.
       updatePendingAdjacency(area, adjacencyDb);
@@ -744,10 +1075,16 @@ Decision::updateKeyInLsdb(
       return;
     }
 
-    if (key.find(Constants::kPrefixDbMarker.toString()) == 0) {
+    if (auto* maybePrefixDb =
+            std::get_if<thrift::PrefixDatabase>(&decodedValue)) {
       // prefixDb: update keys starting with "prefix:"
-      auto prefixDb = readThriftObjStr<thrift::PrefixDatabase>(
-          rawVal.value_ref().value(), serializer_);
+      auto const& prefixDb = *maybePrefixDb;
+
+      // Shard key carries any number of prefixes of a node
+      if (PrefixKey::parsePrefixShardKey(key).hasValue()) {
+        updatePrefixShardInLsdb(area, key, prefixDb);
+        return;
+      }
 
       // We expect per prefix key, ignore if publication is still in old
       // format.
@@ -783,7 +1120,7 @@ Decision::updateKeyInLsdb(
           prefixDb.perfEvents_ref());
     }
   } catch (const std::exception& e) {
-    XLOG(ERR) << "Failed to deserialize info for key " << key
+    XLOG(ERR) << "Failed to process info for key " << key
               << ". Exception: " << folly::exceptionStr(e);
   }
 }
@@ -807,6 +1144,14 @@ Decision::deleteKeyFromLsdb(
 
   if (key.find(Constants::kPrefixDbMarker.toString()) == 0) {
     // prefixDb: delete keys starting with "prefix:"
+    if (PrefixKey::parsePrefixShardKey(key).hasValue()) {
+      thrift::PrefixDatabase deletedPrefixDb;
+      deletedPrefixDb.thisNodeName_ref() = nodeName;
+      deletedPrefixDb.deletePrefix_ref() = true;
+      updatePrefixShardInLsdb(area, key, deletedPrefixDb);
+      return;
+    }
+
     auto maybePrefixKey = PrefixKey::fromStr(key, area);
     if (maybePrefixKey.hasError()) {
       // this is bad format of key.
@@ -823,13 +1168,60 @@ Decision::deleteKeyFromLsdb(
 }
 
 void
-Decision::processPublication(thrift::Publication&& thriftPub) {
+Decision::updatePrefixShardInLsdb(
+    const std::string& area,
+    const std::string& key,
+    const thrift::PrefixDatabase& prefixDb) {
+  auto const& nodeName = *prefixDb.thisNodeName_ref();
+  auto& shardPrefixes = prefixShards_[area][key];
+  std::unordered_set<folly::CIDRNetwork> prefixes;
+  std::unordered_set<folly::CIDRNetwork> changes;
+
+  if (not *prefixDb.deletePrefix_ref()) {
+    for (auto const& entry : *prefixDb.prefixEntries_ref()) {
+      // Ignore self redistributed route reflection, as for per prefix key
+      auto const& areaStack = *entry.area_stack_ref();
+      if (nodeName == myNodeName_ && areaStack.size() > 0 &&
+          areaLinkStates_.count(areaStack.back())) {
+        continue;
+      }
+
+      auto network = toIPNetwork(*entry.prefix_ref());
+      changes.merge(
+          prefixState_.updatePrefix(PrefixKey(nodeName, network, area), entry));
+      prefixes.emplace(std::move(network));
+    }
+  }
+
+  // Withdraw prefixes no longer in the shard
+  for (auto const& network : shardPrefixes) {
+    if (prefixes.count(network) == 0) {
+      changes.merge(
+          prefixState_.deletePrefix(PrefixKey(nodeName, network, area)));
+    }
+  }
+
+  if (prefixes.empty()) {
+    prefixShards_[area].erase(key);
+  } else {
+    shardPrefixes = std::move(prefixes);
+  }
+  pendingUpdates_.applyPrefixStateChange(
+      std::move(changes), prefixDb.perfEvents_ref());
+}
+
+void
+Decision::processPublication(thrift::Publication const& thriftPub) {
   CHECK(not thriftPub.area_ref()->empty());
   auto const& area = *thriftPub.area_ref();
+  ++lsdbVersion_;
+  receivedRoutesVersion_.fetch_add(1, std::memory_order_release);
 
   auto it = areaLinkStates_.find(area);
   if (it == areaLinkStates_.end()) {
-    it = areaLinkStates_.emplace(area, area).first;
+    it = areaLinkStates_
+             .try_emplace(area, area, config_->isIncrementalSpfEnabled())
+             .first;
   }
   auto& areaLinkState = it->second;
 
@@ -839,13 +1231,52 @@ Decision::processPublication(thrift::Publication&& thriftPub) {
     return;
   }
 
-  // LSDB addition/update
+  // Values to decode, see [Publication Decode]
+  auto* valueHashes = decodeExecutor_ ? &lsdbValueHashes_[area] : nullptr;
+  std::vector<std::pair<std::string const*, thrift::Value const*>> keyVals;
+  keyVals.reserve(thriftPub.keyVals_ref()->size());
+  size_t numSkippedValues{0};
   for (const auto& [key, rawVal] : *thriftPub.keyVals_ref()) {
-    updateKeyInLsdb(area, areaLinkState, key, rawVal);
+    if (not rawVal.value_ref().has_value()) {
+      // skip TTL update
+      DCHECK(*rawVal.ttlVersion_ref() > 0);
+      continue;
+    }
+    if (valueHashes and rawVal.hash_ref().has_value()) {
+      auto hashIt = valueHashes->find(key);
+      if (hashIt != valueHashes->end() and
+          hashIt->second == *rawVal.hash_ref()) {
+        ++numSkippedValues;
+        continue;
+      }
+    }
+    keyVals.emplace_back(&key, &rawVal);
+  }
+  if (numSkippedValues) {
+    fb303::fbData->addStatValue(
+        "decision.publication_skipped_values", numSkippedValues, fb303::SUM);
+  }
+
+  // LSDB addition/update
+  auto decodedValues = decodeLsdbValues(keyVals);
+  for (size_t i = 0; i < keyVals.size(); ++i) {
+    auto const& [key, rawVal] = keyVals[i];
+    if (valueHashes) {
+      if (rawVal->hash_ref().has_value() and
+          not std::holds_alternative<std::monostate>(decodedValues[i])) {
+        valueHashes->insert_or_assign(*key, *rawVal->hash_ref());
+      } else {
+        valueHashes->erase(*key);
+      }
+    }
+    updateKeyInLsdb(area, areaLinkState, *key, std::move(decodedValues[i]));
   }
 
   // LSDB deletion
   for (const auto& key : *thriftPub.expiredKeys_ref()) {
+    if (valueHashes) {
+      valueHashes->erase(key);
+    }
     deleteKeyFromLsdb(area, areaLinkState, key);
   }
 }
@@ -880,7 +1311,7 @@ Decision::processStaticRoutesUpdate(DecisionRouteUpdate&& routeUpdate) {
         routeUpdate.mplsRoutesToUpdate, routeUpdate.mplsRoutesToDelete);
     pendingUpdates_.setNeedsFullRebuild(); // Mark for full DB rebuild
   }
-  rebuildRoutesDebounced_();
+  scheduleRebuildRoutes();
 
   auto prefixType = routeUpdate.prefixType;
   if (prefixType.has_value() and
@@ -895,6 +1326,24 @@ Decision::processStaticRoutesUpdate(DecisionRouteUpdate&& routeUpdate) {
   }
 }
 
+void
+Decision::scheduleRebuildRoutes() {
+  if (debounceTuner_) {
+    debounceTuner_->recordUpdate();
+    // range applies to a whole batch of updates
+    if (not rebuildRoutesDebounced_.isScheduled()) {
+      auto const [minBackoff, maxBackoff] = debounceTuner_->getBackoffRange();
+      rebuildRoutesDebounced_.setBackoffRange(minBackoff, maxBackoff);
+      fb303::fbData->setCounter("decision.debounce_min_ms", minBackoff.count());
+      fb303::fbData->setCounter("decision.debounce_max_ms", maxBackoff.count());
+      fb303::fbData->setCounter(
+          "decision.debounce_update_interval_ms",
+          static_cast<int64_t>(debounceTuner_->getUpdateIntervalMs()));
+    }
+  }
+  rebuildRoutesDebounced_();
+}
+
 void
 Decision::rebuildRoutes(std::string const& event) {
   // Do NOT trigger initial route computation until all conditions are met.
@@ -902,7 +1351,10 @@ Decision::rebuildRoutes(std::string const& event) {
     return;
   }
 
+  const auto rebuildStart = std::chrono::steady_clock::now();
+
   pendingUpdates_.addEvent(event);
+  pendingUpdates_.traceEvent("DECISION_REBUILD_STARTED");
   XLOG(INFO) << "Decision: processing " << pendingUpdates_.getCount()
              << " accumulated updates. " << event;
   if (pendingUpdates_.perfEvents()) {
@@ -915,8 +1367,35 @@ Decision::rebuildRoutes(std::string const& event) {
     }
   }
 
+  auto const& updatedPrefixes = pendingUpdates_.updatedPrefixes();
+
+  // prefixes affected by topology change
+  std::vector<NodeAndArea> affectedNodes;
+  std::unordered_set<folly::CIDRNetwork> affectedPrefixes;
+  const bool scopedRebuild = not pendingUpdates_.needsFullRebuild() and
+      pendingUpdates_.needsScopedRebuild();
+  if (scopedRebuild) {
+    affectedNodes = updateSpfSnapshot();
+    for (auto const& nodeAndArea : affectedNodes) {
+      auto const& prefixes = prefixState_.getPrefixesByNode(nodeAndArea);
+      affectedPrefixes.insert(prefixes.begin(), prefixes.end());
+    }
+    // KSP2 routes depend on entire paths rather than on distance
+    affectedPrefixes.insert(
+        prefixState_.ksp2Prefixes().begin(), prefixState_.ksp2Prefixes().end());
+  }
+
+  bool fullRebuild = pendingUpdates_.needsFullRebuild();
+  if (not fullRebuild and config_->isRebuildCostModelEnabled()) {
+    fullRebuild = isFullRebuildCheaper(affectedPrefixes);
+  }
+
   DecisionRouteUpdate update;
-  if (pendingUpdates_.needsFullRebuild()) {
+  if (fullRebuild) {
+    if (initialRoutesBuilt_ and
+        (not priorityPrefixes_.empty() or not priorityPrefixTags_.empty())) {
+      rebuildPriorityRoutes();
+    }
     // if only static routes gets updated, we still need to update routes
     // because there maybe routes depended on static routes.
     auto maybeRouteDb =
@@ -935,16 +1414,62 @@ Decision::rebuildRoutes(std::string const& event) {
     }
     // update `DecisionRouteDb` cache and return delta as `update`
     update = routeDb_.calculateUpdate(std::move(db));
-    update.type = DecisionRouteUpdate::FULL_SYNC;
+    if (pendingUpdates_.needsFullRebuild()) {
+      update.type = DecisionRouteUpdate::FULL_SYNC;
+    }
+    if (config_->isScopedRouteRebuildEnabled() and not scopedRebuild) {
+      updateSpfSnapshot();
+    }
   } else {
-    // process prefixes update from `prefixState_`
-    for (auto const& prefix : pendingUpdates_.updatedPrefixes()) {
+    auto createRoute = [&](folly::CIDRNetwork const& prefix) {
       if (auto maybeRibEntry = spfSolver_->createRouteForPrefixOrGetStaticRoute(
               myNodeName_, areaLinkStates_, prefixState_, prefix)) {
         update.addRouteToUpdate(std::move(maybeRibEntry).value());
       } else if (routeDb_.unicastRoutes.count(prefix) > 0) {
         update.unicastRoutesToDelete.emplace_back(prefix);
       }
+    };
+
+    // process prefixes update from `prefixState_`
+    for (auto const& prefix : updatedPrefixes) {
+      createRoute(prefix);
+    }
+
+    // process prefixes affected by topology change
+    if (scopedRebuild) {
+      for (auto const& prefix : affectedPrefixes) {
+        if (not updatedPrefixes.count(prefix)) {
+          createRoute(prefix);
+        }
+      }
+
+      // node label routes depend on paths towards every node
+      auto mplsRoutes =
+          spfSolver_->buildMplsRoutes(myNodeName_, areaLinkStates_);
+      for (auto const& [label, _] : routeDb_.mplsRoutes) {
+        if (not mplsRoutes.count(label)) {
+          update.mplsRoutesToDelete.emplace_back(label);
+        }
+      }
+      for (auto& [label, entry] : mplsRoutes) {
+        entry.updateFingerprint();
+        auto search = routeDb_.mplsRoutes.find(label);
+        if (search == routeDb_.mplsRoutes.end() ||
+            not search->second.isSameRoute(entry)) {
+          update.addMplsRouteToUpdate(std::move(entry));
+        }
+      }
+
+      fb303::fbData->addStatValue(
+          "decision.scoped_route_rebuild_runs", 1, fb303::COUNT);
+      fb303::fbData->addStatValue(
+          "decision.scoped_route_rebuild_nodes",
+          affectedNodes.size(),
+          fb303::AVG);
+      fb303::fbData->addStatValue(
+          "decision.scoped_route_rebuild_prefixes",
+          affectedPrefixes.size(),
+          fb303::AVG);
     }
     if (ribPolicy_) {
       auto start = std::chrono::steady_clock::now();
@@ -961,14 +1486,242 @@ Decision::rebuildRoutes(std::string const& event) {
   }
 
   routeDb_.update(update);
+  routeDbSnapshot_.store(nullptr);
+  receivedRoutesVersion_.fetch_add(1, std::memory_order_release);
   pendingUpdates_.addEvent("ROUTE_UPDATE");
+  pendingUpdates_.traceEvent("DECISION_ROUTES_COMPUTED");
   update.perfEvents = pendingUpdates_.moveOutEvents();
   pendingUpdates_.reset();
 
+  // send `DecisionRouteUpdate` to Fib/PrefixMgr
+  routeUpdatesQueue_.push(std::move(update));
+  initialRoutesBuilt_ = true;
+
+  if (debounceTuner_) {
+    debounceTuner_->recordRebuildCost(
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - rebuildStart));
+  }
+
+  if (memoryPressure_ >= MemoryPressureLevel::SHRINK_CACHES) {
+    shrinkCaches();
+  }
+}
+
+void
+Decision::setMemoryPressure(MemoryPressureLevel level) {
+  runInEventBaseThread([this, level]() {
+    memoryPressure_ = level;
+    if (level >= MemoryPressureLevel::SHRINK_CACHES) {
+      shrinkCaches();
+    }
+  });
+}
+
+void
+Decision::shrinkCaches() {
+  for (auto& [_, linkState] : areaLinkStates_) {
+    linkState.clearMemoization();
+  }
+  spfSolver_->clearBestRoutesMemo();
+  spfSolver_->clearMplsRoutesMemo();
+  fb303::fbData->addStatValue(
+      "decision.memory_pressure.caches_shrunk", 1, fb303::COUNT);
+}
+
+void
+Decision::rebuildRoutesForRibPolicy(
+    RibPolicy const* oldPolicy, std::string const& event) {
+  // pending updates may affect any route, rebuild along with them
+  if (not unblockInitialRoutesBuild() or pendingUpdates_.needsRouteUpdate()) {
+    pendingUpdates_.setNeedsFullRebuild();
+    rebuildRoutes(event);
+    return;
+  }
+
+  auto const start = std::chrono::steady_clock::now();
+  RibPolicy const* newPolicy =
+      (ribPolicy_ and ribPolicy_->isActive()) ? ribPolicy_.get() : nullptr;
+
+  DecisionRouteUpdate update;
+  size_t numRoutes{0};
+  for (auto const& [prefix, entry] : routeDb_.unicastRoutes) {
+    if (not(oldPolicy and oldPolicy->match(entry)) and
+        not(newPolicy and newPolicy->match(entry))) {
+      continue;
+    }
+    ++numRoutes;
+    auto maybeRibEntry = spfSolver_->createRouteForPrefixOrGetStaticRoute(
+        myNodeName_, areaLinkStates_, prefixState_, prefix);
+    if (not maybeRibEntry.has_value()) {
+      update.unicastRoutesToDelete.emplace_back(prefix);
+      continue;
+    }
+    if (newPolicy) {
+      newPolicy->applyAction(*maybeRibEntry);
+    }
+    maybeRibEntry->updateFingerprint();
+    if (not entry.isSameRoute(*maybeRibEntry)) {
+      update.addRouteToUpdate(std::move(maybeRibEntry).value());
+    }
+  }
+  updateCounters(
+      "decision.rib_policy_processing.time_ms",
+      start,
+      std::chrono::steady_clock::now());
+  fb303::fbData->addStatValue(
+      "decision.rib_policy_rebuild_routes", numRoutes, fb303::AVG);
+
+  XLOG(INFO) << "Decision: re-evaluated " << numRoutes << " routes. " << event;
+  routeDb_.update(update);
+  routeDbSnapshot_.store(nullptr);
+  receivedRoutesVersion_.fetch_add(1, std::memory_order_release);
+  pendingUpdates_.reset();
+
   // send `DecisionRouteUpdate` to Fib/PrefixMgr
   routeUpdatesQueue_.push(std::move(update));
 }
 
+void
+Decision::rebuildPriorityRoutes() {
+  auto const start = std::chrono::steady_clock::now();
+  RibPolicy const* policy =
+      (ribPolicy_ and ribPolicy_->isActive()) ? ribPolicy_.get() : nullptr;
+
+  DecisionRouteUpdate update;
+  size_t numRoutes{0};
+  for (auto const& [prefix, prefixEntries] : prefixState_.prefixes()) {
+    if (not isPriorityPrefix(prefix, prefixEntries)) {
+      continue;
+    }
+    ++numRoutes;
+    auto maybeRibEntry = spfSolver_->createRouteForPrefixOrGetStaticRoute(
+        myNodeName_, areaLinkStates_, prefixState_, prefix);
+    if (not maybeRibEntry.has_value()) {
+      continue;
+    }
+    if (policy) {
+      policy->applyAction(*maybeRibEntry);
+    }
+    maybeRibEntry->updateFingerprint();
+    auto search = routeDb_.unicastRoutes.find(prefix);
+    if (search == routeDb_.unicastRoutes.end() or
+        not search->second.isSameRoute(*maybeRibEntry)) {
+      update.addRouteToUpdate(std::move(maybeRibEntry).value());
+    }
+  }
+  updateCounters(
+      "decision.priority_route_build_ms",
+      start,
+      std::chrono::steady_clock::now());
+  fb303::fbData->addStatValue(
+      "decision.priority_routes", numRoutes, fb303::AVG);
+
+  if (update.empty()) {
+    return;
+  }
+  XLOG(INFO) << "Decision: sending " << update.size()
+             << " priority route updates";
+  routeDb_.update(update);
+  routeDbSnapshot_.store(nullptr);
+  receivedRoutesVersion_.fetch_add(1, std::memory_order_release);
+
+  // pending events stay with the full rebuild following this update
+  if (auto const& perfEvents = pendingUpdates_.perfEvents()) {
+    update.perfEvents = *perfEvents;
+    addPerfEvent(*update.perfEvents, myNodeName_, "PRIORITY_ROUTE_UPDATE");
+  }
+  routeUpdatesQueue_.push(std::move(update));
+}
+
+bool
+Decision::isPriorityPrefix(
+    folly::CIDRNetwork const& prefix,
+    PrefixEntries const& prefixEntries) const {
+  if (priorityPrefixes_.count(prefix)) {
+    return true;
+  }
+  if (priorityPrefixTags_.empty()) {
+    return false;
+  }
+  for (auto const& [_, entry] : prefixEntries) {
+    for (auto const& tag : *entry->tags_ref()) {
+      if (priorityPrefixTags_.count(tag)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+std::vector<NodeAndArea>
+Decision::updateSpfSnapshot() {
+  std::vector<NodeAndArea> changedNodes;
+  for (auto const& [area, linkState] : areaLinkStates_) {
+    std::unordered_map<std::string, SpfSnapshotEntry> snapshot;
+    for (auto const& [node, nodeResult] : linkState.getSpfResult(myNodeName_)) {
+      snapshot.emplace(
+          node,
+          SpfSnapshotEntry{
+              nodeResult.metric(),
+              nodeResult.nextHops(),
+              linkState.isNodeOverloaded(node)});
+    }
+
+    auto& prevSnapshot = spfSnapshot_[area];
+    for (auto const& [node, entry] : snapshot) {
+      auto search = prevSnapshot.find(node);
+      if (search == prevSnapshot.end() or not(search->second == entry)) {
+        changedNodes.emplace_back(node, area);
+      }
+    }
+    for (auto const& [node, _] : prevSnapshot) {
+      if (not snapshot.count(node)) {
+        changedNodes.emplace_back(node, area);
+      }
+    }
+    prevSnapshot = std::move(snapshot);
+  }
+  return changedNodes;
+}
+
+bool
+Decision::isFullRebuildCheaper(
+    std::unordered_set<folly::CIDRNetwork> const& affectedPrefixes) {
+  auto const& updatedPrefixes = pendingUpdates_.updatedPrefixes();
+  size_t numIncrementalPrefixes = updatedPrefixes.size();
+  for (auto const& prefix : affectedPrefixes) {
+    if (not updatedPrefixes.count(prefix)) {
+      ++numIncrementalPrefixes;
+    }
+  }
+  size_t numNodes{0};
+  for (auto const& [_, linkState] : areaLinkStates_) {
+    numNodes += linkState.numNodes();
+  }
+
+  const auto estimate = detail::estimateRebuildCost(
+      prefixState_.prefixes().size(),
+      numNodes,
+      numIncrementalPrefixes,
+      pendingUpdates_.needsScopedRebuild());
+  const bool fullRebuild = estimate.isFullRebuildCheaper();
+  const auto descr = fmt::format(
+      "{}_REBUILD_SELECTED full_cost={} incremental_cost={}",
+      fullRebuild ? "FULL" : "INCREMENTAL",
+      estimate.fullCost,
+      estimate.incrementalCost);
+  pendingUpdates_.addEvent(descr);
+  XLOG(DBG1) << "Decision: " << descr << " for " << numIncrementalPrefixes
+             << " of " << prefixState_.prefixes().size() << " prefixes";
+  fb303::fbData->addStatValue(
+      fullRebuild ? "decision.rebuild_cost_model.full_rebuilds"
+                  : "decision.rebuild_cost_model.incremental_rebuilds",
+      1,
+      fb303::COUNT);
+  return fullRebuild;
+}
+
 bool
 Decision::unblockInitialRoutesBuild() {
   bool adjReceivedForPeers{true};
@@ -1059,6 +1812,9 @@ Decision::updateGlobalCounters() const {
       "decision.num_nodes", std::max(nodeSet.size(), static_cast<size_t>(1ul)));
   fb303::fbData->setCounter(
       "decision.num_prefixes", prefixState_.prefixes().size());
+  fb303::fbData->setCounter(
+      "decision.num_nexthop_groups",
+      NextHopGroupRegistry::getInstance().size());
 }
 
 } // namespace openr
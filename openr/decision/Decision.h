@@ -7,24 +7,32 @@
 
 #pragma once
 
+#include <atomic>
+#include <variant>
+
 #include <folly/IPAddress.h>
+#include <folly/concurrency/AtomicSharedPtr.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
 #include <folly/futures/Future.h>
 #include <folly/io/async/AsyncTimeout.h>
 #include <thrift/lib/cpp2/protocol/Serializer.h>
 
 #include <openr/common/AsyncDebounce.h>
 #include <openr/common/AsyncThrottle.h>
+#include <openr/common/MemoryPressure.h>
 #include <openr/common/OpenrEventBase.h>
 #include <openr/common/Types.h>
 #include <openr/common/Util.h>
 #include <openr/config/Config.h>
 #include <openr/decision/LinkState.h>
 #include <openr/decision/PrefixState.h>
+#include <openr/decision/PublicationCapture.h>
 #include <openr/decision/RibEntry.h>
 #include <openr/decision/RibPolicy.h>
 #include <openr/decision/RouteUpdate.h>
 #include <openr/decision/SpfSolver.h>
 #include <openr/if/gen-cpp2/KvStore_types.h>
+#include <openr/if/gen-cpp2/OpenrCtrl_types.h>
 #include <openr/if/gen-cpp2/Types_types.h>
 #include <openr/messaging/ReplicateQueue.h>
 
@@ -39,8 +47,10 @@ namespace detail {
  */
 class DecisionPendingUpdates {
  public:
-  explicit DecisionPendingUpdates(std::string const& myNodeName)
-      : myNodeName_(myNodeName) {}
+  explicit DecisionPendingUpdates(
+      std::string const& myNodeName, bool enableScopedRouteRebuild = false)
+      : myNodeName_(myNodeName),
+        enableScopedRouteRebuild_(enableScopedRouteRebuild) {}
 
   void
   setNeedsFullRebuild() {
@@ -52,9 +62,19 @@ class DecisionPendingUpdates {
     return needsFullRebuild_;
   }
 
+  // [Scoped Route Rebuild]
+  // topology changed remotely, or by drain of any node. Only routes of
+  // prefixes advertised by nodes whose distance, nexthops or overload changed
+  // need rebuilding.
+  bool
+  needsScopedRebuild() const {
+    return needsScopedRebuild_;
+  }
+
   bool
   needsRouteUpdate() const {
-    return needsFullRebuild() || !updatedPrefixes_.empty();
+    return needsFullRebuild() || needsScopedRebuild() ||
+        !updatedPrefixes_.empty();
   }
 
   std::unordered_set<folly::CIDRNetwork> const&
@@ -75,6 +95,9 @@ class DecisionPendingUpdates {
 
   void addEvent(std::string const& eventDescription);
 
+  // Record convergence trace `event` for every update in the batch
+  void traceEvent(const char* event);
+
   std::optional<thrift::PerfEvents> const&
   perfEvents() const {
     return perfEvents_;
@@ -97,16 +120,120 @@ class DecisionPendingUpdates {
   // oldest perfEvents list in the batch
   std::optional<thrift::PerfEvents> perfEvents_;
 
+  // convergence trace ids of all updates in the batch, only `traceIds` is set
+  thrift::PerfEvents traceIds_;
+
   // set if we need to rebuild all routes
   bool needsFullRebuild_{false};
 
+  // set if we need to rebuild routes affected by topology change
+  bool needsScopedRebuild_{false};
+
   // track prefixes that have changed in this batch
   std::unordered_set<folly::CIDRNetwork> updatedPrefixes_;
 
   // local node name to determine action on linkAttributes change
   std::string myNodeName_;
+
+  // rebuild only affected routes upon remote topology change
+  bool enableScopedRouteRebuild_{false};
+};
+
+/**
+ * [Adaptive Debounce]
+ *
+ * Pick the debounce range of route rebuild, within configured [min, max],
+ * out of moving averages of the interval between updates and of the route
+ * rebuild cost:
+ *  - quiet, i.e. first update in more than max: rebuild min after it, without
+ *    extending the wait upon following ones;
+ *  - busy: wait at least twice the rebuild cost, so that rebuilding takes at
+ *    most a third of the time, and back off up to max;
+ *  - updates closer together than min on average: batch for max right away;
+ */
+class DecisionDebounceTuner {
+ public:
+  DecisionDebounceTuner(
+      std::chrono::milliseconds minDebounce,
+      std::chrono::milliseconds maxDebounce);
+
+  // record arrival of an update requesting route rebuild
+  void recordUpdate(
+      std::chrono::steady_clock::time_point now =
+          std::chrono::steady_clock::now());
+
+  // record time spent rebuilding routes
+  void recordRebuildCost(std::chrono::milliseconds cost);
+
+  // debounce range for the next batch of updates
+  std::pair<std::chrono::milliseconds, std::chrono::milliseconds>
+  getBackoffRange() const;
+
+  double
+  getUpdateIntervalMs() const {
+    return updateIntervalMs_;
+  }
+
+  double
+  getRebuildCostMs() const {
+    return rebuildCostMs_;
+  }
+
+ private:
+  const std::chrono::milliseconds minDebounce_;
+  const std::chrono::milliseconds maxDebounce_;
+
+  std::optional<std::chrono::steady_clock::time_point> lastUpdateTime_;
+
+  // interval between the latest two updates
+  double lastUpdateIntervalMs_{0};
+
+  // moving averages. A single gap is accounted for at most twice max, so that
+  // a burst following a long quiet period is detected after a few updates.
+  double updateIntervalMs_{0};
+  double rebuildCostMs_{0};
+
+  // weight of the latest sample in moving averages
+  static constexpr double kSampleWeight{0.2};
+
+  // minimum wait of busy network relative to rebuild cost
+  static constexpr double kRebuildCostFactor{2};
+};
+
+/**
+ * [Rebuild Cost Model]
+ *
+ * Estimated cost of rebuilding routes of a batch of updates, in routes
+ * computed by full rebuild:
+ *  - full rebuild computes routes of all prefixes and node label routes
+ *    towards all nodes, then diffs them against current routes at once;
+ *  - incremental rebuild computes and diffs routes of updated prefixes, and of
+ *    prefixes affected by topology change, one by one. Node label routes are
+ *    rebuilt only upon topology change.
+ *
+ * Full rebuild is picked once it is estimated cheaper, e.g. after full-sync of
+ * KvStore updated most prefixes, or a remote change affected most nodes.
+ */
+struct RebuildCostEstimate {
+  uint64_t fullCost{0};
+  uint64_t incrementalCost{0};
+
+  bool
+  isFullRebuildCheaper() const {
+    return fullCost < incrementalCost;
+  }
+
+  // cost of a route computed by incremental rebuild relative to one of full
+  // rebuild, which reuses route selection and next-hops across prefixes
+  static constexpr uint64_t kIncrementalRouteCost{2};
 };
 
+RebuildCostEstimate estimateRebuildCost(
+    size_t numPrefixes,
+    size_t numNodes,
+    size_t numIncrementalPrefixes,
+    bool incrementalRebuildsMplsRoutes);
+
 } // namespace detail
 
 /**
@@ -134,7 +261,7 @@ class Decision : public OpenrEventBase {
       // Queue for receiving peer updates
       messaging::RQueue<PeerEvent> peerUpdatesQueue,
       // Queue for receiving KvStore publications
-      messaging::RQueue<KvStorePublication> kvStoreUpdatesQueue,
+      messaging::SharedRQueue<KvStorePublication> kvStoreUpdatesQueue,
       // Queue for receiving static route updates
       messaging::RQueue<DecisionRouteUpdate> staticRouteUpdatesQueue,
       // Queue for publishing route updates
@@ -149,7 +276,8 @@ class Decision : public OpenrEventBase {
 
   /*
    * Retrieve routeDb from specified node.
-   * If empty nodename specified, will return routeDb of its own
+   * If empty nodename specified, will return routeDb of its own, i.e. the
+   * routes last published to Fib, served out of the route snapshot.
    */
   folly::SemiFuture<std::unique_ptr<thrift::RouteDatabase>> getDecisionRouteDb(
       std::string nodeName);
@@ -175,6 +303,28 @@ class Decision : public OpenrEventBase {
   folly::SemiFuture<std::unique_ptr<std::vector<thrift::ReceivedRouteDetail>>>
   getReceivedRoutesFiltered(thrift::ReceivedRouteFilter filter);
 
+  /*
+   * [Ctrl Cache] Version of received routes and their best route selection,
+   * changing with every publication and route build. Safe to read from any
+   * thread.
+   */
+  int64_t
+  getReceivedRoutesVersion() const {
+    return receivedRoutesVersion_.load(std::memory_order_acquire);
+  }
+
+  /*
+   * [Paginated Dump] Pages of adjacency databases (ordered by area and node)
+   * and of received routes (ordered by prefix). Pages are served out of the
+   * LSDB, whose version changes with every publication processed.
+   */
+  folly::SemiFuture<std::unique_ptr<thrift::AdjacenciesPage>>
+  getDecisionAdjacenciesPage(
+      thrift::AdjacenciesFilter filter, thrift::PageParams pageParams);
+  folly::SemiFuture<std::unique_ptr<thrift::ReceivedRoutesPage>>
+  getReceivedRoutesPage(
+      thrift::ReceivedRouteFilter filter, thrift::PageParams pageParams);
+
   /*
    * Set new or replace existing RibPolicy. This will trigger the new policy
    * run against computed routes and delta will be published.
@@ -194,6 +344,13 @@ class Decision : public OpenrEventBase {
    */
   folly::SemiFuture<folly::Unit> clearRibPolicy();
 
+  /*
+   * [Memory Governor] Memoized SPF results and best route selections are
+   * dropped after every route build from SHRINK_CACHES on. Safe to call from
+   * any thread.
+   */
+  void setMemoryPressure(MemoryPressureLevel level);
+
   // periodically called by counterUpdateTimer_, exposed publicly for testing
   void updateGlobalCounters() const;
 
@@ -220,19 +377,52 @@ class Decision : public OpenrEventBase {
    *    1) updateKeyInLsdb  - process key adding/updating
    *    2) deleteKeyFromLsdb - process key deletion
    */
-  void processPublication(thrift::Publication&& thriftPub);
+  void processPublication(thrift::Publication const& thriftPub);
+
+  /*
+   * [Publication Decode]
+   *
+   * Values of `adj:` and `prefix:` keys are deserialized ahead of any LSDB
+   * update, concurrently on decodeExecutor_ if configured and the publication
+   * is large enough, e.g. of full-sync. With decodeExecutor_, values whose
+   * hash matches the one last applied for the same key are skipped, as
+   * LinkState/PrefixState already hold them. Decision thread then only
+   * applies decoded objects.
+   */
+  using DecodedLsdbValue = std::variant<
+      std::monostate,
+      thrift::AdjacencyDatabase,
+      thrift::PrefixDatabase>;
+
+  // Deserialize value of an `adj:` or `prefix:` key. Empty for other keys or
+  // on failure. Does NOT access Decision state, safe to call on any thread.
+  DecodedLsdbValue decodeLsdbValue(
+      const std::string& key, const thrift::Value& rawVal) const;
+
+  // Deserialize values of keys in order, see [Publication Decode].
+  std::vector<DecodedLsdbValue> decodeLsdbValues(
+      std::vector<std::pair<std::string const*, thrift::Value const*>> const&
+          keyVals) const;
 
   void updateKeyInLsdb(
       const std::string& area,
       LinkState& areaLinkState,
       const std::string& key,
-      const thrift::Value& rawVal);
+      DecodedLsdbValue&& decodedValue);
 
   void deleteKeyFromLsdb(
       const std::string& area,
       LinkState& areaLinkState,
       const std::string& key);
 
+  // Apply prefix shard key holding any number of prefix entries of a node.
+  // Prefixes of the shard missing from prefixDb, or all of them if it's
+  // deleted, are withdrawn.
+  void updatePrefixShardInLsdb(
+      const std::string& area,
+      const std::string& key,
+      const thrift::PrefixDatabase& prefixDb);
+
   // Process publication from PrefixManager
   void processStaticRoutesUpdate(DecisionRouteUpdate&& routeUpdate);
 
@@ -257,6 +447,52 @@ class Decision : public OpenrEventBase {
    */
   void rebuildRoutes(std::string const& event);
 
+  /*
+   * [Compiled RibPolicy]
+   *
+   * Re-evaluate routes upon change of ribPolicy_ from oldPolicy. Only routes
+   * matched by either policy are rebuilt, and only the changed ones are sent
+   * out. Fall back to rebuildRoutes() if any route update is pending.
+   */
+  void rebuildRoutesForRibPolicy(
+      RibPolicy const* oldPolicy, std::string const& event);
+
+  /*
+   * [Priority Routes]
+   *
+   * Ahead of a full route rebuild, compute routes of priority prefixes, e.g.
+   * loopbacks, and send out the changed ones in a separate update, so that
+   * Fib programs them before the bulk of routes. Withdrawn priority prefixes
+   * are left to the full rebuild. Skipped for the initial route build, which
+   * is programmed by Fib as a whole.
+   */
+  void rebuildPriorityRoutes();
+
+  // true if prefix is configured as priority or advertised with priority tag
+  bool isPriorityPrefix(
+      folly::CIDRNetwork const& prefix,
+      PrefixEntries const& prefixEntries) const;
+
+  /*
+   * [Scoped Route Rebuild]
+   *
+   * Compare SPF result of this node in every area against the one of previous
+   * route build and record the new one. Return [node, area] pairs whose
+   * distance, nexthops or overload changed, including nodes which became
+   * reachable or unreachable.
+   */
+  std::vector<NodeAndArea> updateSpfSnapshot();
+
+  /*
+   * [Rebuild Cost Model]
+   *
+   * Return true if rebuilding all routes is estimated cheaper than rebuilding
+   * updated prefixes and `affectedPrefixes` of topology change. Choice and
+   * estimates are recorded in perf events of the batch.
+   */
+  bool isFullRebuildCheaper(
+      std::unordered_set<folly::CIDRNetwork> const& affectedPrefixes);
+
   /*
    * Return true if all conditions of initial routes build are fulfilled.
    */
@@ -281,6 +517,20 @@ class Decision : public OpenrEventBase {
   // cached routeDb
   DecisionRouteDb routeDb_;
 
+  /*
+   * [Route Snapshot]
+   * Immutable copy of routeDb_ shared with control-plane reads, unset if
+   * outdated. Reads convert routes out of the snapshot on the calling thread.
+   * It is dropped upon every update of routeDb_ and built again on the event
+   * base by the first read after it, i.e. routeDb_ is copied at most once per
+   * route update regardless of the number of reads.
+   */
+  folly::atomic_shared_ptr<const DecisionRouteDb> routeDbSnapshot_;
+
+  // latest snapshot. Scheduled on the event base ONLY if it is outdated.
+  folly::SemiFuture<std::shared_ptr<const DecisionRouteDb>>
+  getRouteDbSnapshot();
+
   // Queue to publish route changes
   messaging::ReplicateQueue<DecisionRouteUpdate>& routeUpdatesQueue_;
 
@@ -300,8 +550,77 @@ class Decision : public OpenrEventBase {
   // Global prefix state
   PrefixState prefixState_;
 
+  // [Paginated Dump] version of areaLinkStates_ and prefixState_, bumped on
+  // every publication processed
+  int64_t lsdbVersion_{0};
+
+  // [Ctrl Cache] see getReceivedRoutesVersion()
+  std::atomic<int64_t> receivedRoutesVersion_{0};
+
+  // Prefixes of prefixState_ in ascending order as of sortedPrefixesVersion_.
+  // Sorted by the first paginated read after every change.
+  std::vector<folly::CIDRNetwork> const& getSortedPrefixes();
+  std::vector<folly::CIDRNetwork> sortedPrefixes_;
+  int64_t sortedPrefixesVersion_{-1};
+
+  // Set best route selection result of received routes
+  void setBestKeys(std::vector<thrift::ReceivedRouteDetail>& routes) const;
+
+  // [Scoped Route Rebuild] route affecting attributes of node reachable from
+  // this node, as of previous route build
+  struct SpfSnapshotEntry {
+    LinkStateMetric metric{0};
+    std::unordered_set<std::string> nextHops;
+    bool isOverloaded{false};
+
+    bool
+    operator==(SpfSnapshotEntry const& other) const {
+      return metric == other.metric and nextHops == other.nextHops and
+          isOverloaded == other.isOverloaded;
+    }
+  };
+  std::unordered_map<
+      std::string /* area */,
+      std::unordered_map<std::string /* node */, SpfSnapshotEntry>>
+      spfSnapshot_;
+
   apache::thrift::CompactSerializer serializer_;
 
+  // Pool deserializing publications, unset if deserializing them on Decision
+  // thread. See [Publication Decode].
+  std::unique_ptr<folly::CPUThreadPoolExecutor> decodeExecutor_;
+
+  // Records received publications, unset if capture is disabled or failed.
+  // See [Publication Capture].
+  std::unique_ptr<PublicationCaptureWriter> publicationCapture_;
+
+  // [Memory Governor] level notified by Watchdog
+  MemoryPressureLevel memoryPressure_{MemoryPressureLevel::NONE};
+
+  // [Memory Governor] drop memoized results of route builds
+  void shrinkCaches();
+
+  // Hash of value last applied to LSDB per key. Tracked with decodeExecutor_.
+  std::unordered_map<
+      std::string /* area */,
+      std::unordered_map<std::string /* key */, int64_t /* hash */>>
+      lsdbValueHashes_;
+
+  // Prefixes last applied to LSDB per prefix shard key
+  std::unordered_map<
+      std::string /* area */,
+      std::unordered_map<
+          std::string /* key */,
+          std::unordered_set<folly::CIDRNetwork>>>
+      prefixShards_;
+
+  // Publications with fewer keys than twice this are decoded sequentially
+  static constexpr size_t kMinKeysPerDecodeShard{64};
+
+  // Ratio of decode shards to decodeExecutor_ threads, to balance shards of
+  // unequal cost
+  static constexpr size_t kDecodeShardsPerThread{4};
+
   // Base interval to submit to monitor with (jitter will be added)
   std::chrono::seconds monitorSyncInterval_{0};
 
@@ -323,6 +642,20 @@ class Decision : public OpenrEventBase {
    */
   AsyncDebounce<std::chrono::milliseconds> rebuildRoutesDebounced_;
 
+  // Picks range of rebuildRoutesDebounced_, unset if not adaptive. See
+  // [Adaptive Debounce].
+  std::optional<detail::DecisionDebounceTuner> debounceTuner_;
+
+  // Debounce route rebuild for a route affecting update
+  void scheduleRebuildRoutes();
+
+  // Priority prefixes and prefix tags. See [Priority Routes].
+  std::unordered_set<folly::CIDRNetwork> priorityPrefixes_;
+  std::unordered_set<std::string> priorityPrefixTags_;
+
+  // Set upon the initial route build
+  bool initialRoutesBuilt_{false};
+
   /*
    * Baton for synchronization between ProcessPeerUpdates and ProcessPublication
    * fibers.
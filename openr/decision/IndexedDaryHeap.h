@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include <folly/logging/xlog.h>
+
+namespace openr {
+
+/*
+ * Indexed d-ary min-heap of dense integer ids with decrease-key.
+ *
+ * Position of every id within the heap is tracked, hence the key of a queued
+ * id can be lowered in place with a single sift-up instead of re-heapifying.
+ * Storage is sized by the largest id ever seen and is retained by clear(), so
+ * that a heap reused across runs does not allocate once it has grown.
+ *
+ * Keys are compared with `operator<`. Pairs, e.g. <metric, tie-breaker>, give
+ * a deterministic order among ids of equal metric.
+ */
+template <class Key, size_t Arity = 4>
+class IndexedDaryHeap {
+  static_assert(Arity >= 2, "IndexedDaryHeap arity must be at least 2");
+
+ public:
+  bool
+  empty() const {
+    return heap_.empty();
+  }
+
+  size_t
+  size() const {
+    return heap_.size();
+  }
+
+  bool
+  contains(uint32_t id) const {
+    return id < positions_.size() and positions_[id] != kNotInHeap;
+  }
+
+  Key const&
+  getKey(uint32_t id) const {
+    CHECK(contains(id));
+    return heap_[positions_[id]].first;
+  }
+
+  // insert id which is not queued yet
+  void
+  push(uint32_t id, Key key) {
+    if (id >= positions_.size()) {
+      positions_.resize(id + 1, kNotInHeap);
+    }
+    CHECK_EQ(positions_[id], kNotInHeap);
+    heap_.emplace_back(std::move(key), id);
+    positions_[id] = heap_.size() - 1;
+    siftUp(heap_.size() - 1);
+  }
+
+  // lower key of a queued id. Key MUST NOT be greater than the current one.
+  void
+  decreaseKey(uint32_t id, Key key) {
+    CHECK(contains(id));
+    auto const pos = positions_[id];
+    CHECK(not(heap_[pos].first < key));
+    heap_[pos].first = std::move(key);
+    siftUp(pos);
+  }
+
+  // insert id or lower its key. No-op if queued with a lower or same key.
+  void
+  pushOrDecreaseKey(uint32_t id, Key key) {
+    if (not contains(id)) {
+      push(id, std::move(key));
+    } else if (key < getKey(id)) {
+      decreaseKey(id, std::move(key));
+    }
+  }
+
+  std::pair<Key, uint32_t> const&
+  top() const {
+    CHECK(not heap_.empty());
+    return heap_.front();
+  }
+
+  std::pair<Key, uint32_t>
+  pop() {
+    CHECK(not heap_.empty());
+    auto min = std::move(heap_.front());
+    positions_[min.second] = kNotInHeap;
+    if (heap_.size() > 1) {
+      heap_.front() = std::move(heap_.back());
+      positions_[heap_.front().second] = 0;
+      heap_.pop_back();
+      siftDown(0);
+    } else {
+      heap_.pop_back();
+    }
+    return min;
+  }
+
+  // drop all queued ids, retaining storage
+  void
+  clear() {
+    for (auto const& [_, id] : heap_) {
+      positions_[id] = kNotInHeap;
+    }
+    heap_.clear();
+  }
+
+ private:
+  static constexpr size_t kNotInHeap{std::numeric_limits<size_t>::max()};
+
+  void
+  siftUp(size_t pos) {
+    auto entry = std::move(heap_[pos]);
+    while (pos > 0) {
+      auto const parent = (pos - 1) / Arity;
+      if (not(entry.first < heap_[parent].first)) {
+        break;
+      }
+      place(pos, std::move(heap_[parent]));
+      pos = parent;
+    }
+    place(pos, std::move(entry));
+  }
+
+  void
+  siftDown(size_t pos) {
+    auto entry = std::move(heap_[pos]);
+    while (true) {
+      auto const firstChild = pos * Arity + 1;
+      if (firstChild >= heap_.size()) {
+        break;
+      }
+      auto const lastChild = std::min(firstChild + Arity, heap_.size());
+      auto minChild = firstChild;
+      for (auto child = firstChild + 1; child < lastChild; ++child) {
+        if (heap_[child].first < heap_[minChild].first) {
+          minChild = child;
+        }
+      }
+      if (not(heap_[minChild].first < entry.first)) {
+        break;
+      }
+      place(pos, std::move(heap_[minChild]));
+      pos = minChild;
+    }
+    place(pos, std::move(entry));
+  }
+
+  void
+  place(size_t pos, std::pair<Key, uint32_t>&& entry) {
+    positions_[entry.second] = pos;
+    heap_[pos] = std::move(entry);
+  }
+
+  // queued <key, id> pairs in heap order
+  std::vector<std::pair<Key, uint32_t>> heap_;
+
+  // position of each id within heap_, kNotInHeap if not queued
+  std::vector<size_t> positions_;
+};
+
+} // namespace openr
@@ -5,7 +5,15 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <queue>
+
 #include <fb303/ServiceData.h>
+#include <folly/futures/Future.h>
 #include <folly/logging/xlog.h>
 #include <openr/common/LsdbUtil.h>
 #include <openr/decision/LinkState.h>
@@ -396,7 +404,16 @@ Link::directionalToString(const std::string& fromNode) const {
       getIfaceFromNode(getOtherNodeName(fromNode)));
 }
 
-LinkState::LinkState(const std::string& area) : area_(area) {}
+LinkState::LinkState(const std::string& area, bool enableIncrementalSpf)
+    : area_(area), enableIncrementalSpf_(enableIncrementalSpf) {}
+
+uint64_t
+LinkState::getNextVersion() {
+  // shared by all instances, hence an area re-created under the same name
+  // never matches results memoized for its predecessor
+  static std::atomic<uint64_t> nextVersion{1};
+  return nextVersion.fetch_add(1, std::memory_order_relaxed);
+}
 
 size_t
 LinkState::LinkPtrHash::operator()(const std::shared_ptr<Link>& l) const {
@@ -451,6 +468,7 @@ LinkState::removeLink(std::shared_ptr<Link> link) {
   CHECK(linkMap_.at(link->firstNodeName()).erase(link));
   CHECK(linkMap_.at(link->secondNodeName()).erase(link));
   CHECK(allLinks_.erase(link));
+  heldLinks_.erase(link);
 }
 
 void
@@ -466,12 +484,14 @@ LinkState::removeNode(const std::string& nodeName) {
     try {
       CHECK(linkMap_.at(link->getOtherNodeName(nodeName)).erase(link));
       CHECK(allLinks_.erase(link));
+      heldLinks_.erase(link);
     } catch (std::out_of_range const& e) {
       XLOG(FATAL) << "std::out_of_range for " << nodeName;
     }
   }
   linkMap_.erase(search);
   nodeOverloads_.erase(nodeName);
+  heldNodes_.erase(nodeName);
 }
 
 const LinkState::LinkSet&
@@ -517,35 +537,57 @@ LinkState::isNodeOverloaded(const std::string& nodeName) const {
   return nodeOverloads_.count(nodeName) && nodeOverloads_.at(nodeName).value();
 }
 
+void
+LinkState::updateHeldLink(std::shared_ptr<Link> const& link) {
+  if (link->hasHolds()) {
+    heldLinks_.insert(link);
+  } else {
+    heldLinks_.erase(link);
+  }
+}
+
+void
+LinkState::updateHeldNode(std::string const& nodeName) {
+  auto search = nodeOverloads_.find(nodeName);
+  if (search != nodeOverloads_.end() and search->second.hasHold()) {
+    heldNodes_.insert(nodeName);
+  } else {
+    heldNodes_.erase(nodeName);
+  }
+}
+
 LinkState::LinkStateChange
 LinkState::decrementHolds() {
   LinkStateChange change;
-  for (auto& link : allLinks_) {
-    change.topologyChanged |= link->decrementHolds();
+  for (auto it = heldLinks_.begin(); it != heldLinks_.end();) {
+    auto const& link = *it;
+    if (link->decrementHolds()) {
+      change.topologyChanged = true;
+      change.updatedLinks.emplace_back(link);
+    }
+    it = link->hasHolds() ? std::next(it) : heldLinks_.erase(it);
   }
-  for (auto& kv : nodeOverloads_) {
-    change.topologyChanged |= kv.second.decrementTtl();
+  for (auto it = heldNodes_.begin(); it != heldNodes_.end();) {
+    auto& overload = nodeOverloads_.at(*it);
+    if (overload.decrementTtl()) {
+      change.topologyChanged = true;
+      change.updatedNodes.emplace_back(*it);
+    }
+    it = overload.hasHold() ? std::next(it) : heldNodes_.erase(it);
   }
   if (change.topologyChanged) {
-    spfResults_.clear();
+    updateSpfResults(change);
     kthPathResults_.clear();
+    ucmpResults_.clear();
+    csrTopology_.reset();
+    version_ = getNextVersion();
   }
   return change;
 }
 
 bool
 LinkState::hasHolds() const {
-  for (auto& link : allLinks_) {
-    if (link->hasHolds()) {
-      return true;
-    }
-  }
-  for (auto& kv : nodeOverloads_) {
-    if (kv.second.hasHold()) {
-      return true;
-    }
-  }
-  return false;
+  return not heldLinks_.empty() or not heldNodes_.empty();
 }
 
 std::shared_ptr<Link>
@@ -620,8 +662,14 @@ LinkState::updateAdjacencyDatabase(
   std::unordered_set<Link> linksUp;
   std::unordered_set<Link> linksDown;
 
-  change.topologyChanged |= updateNodeOverloaded(
-      nodeName, *newAdjacencyDb.isOverloaded_ref(), holdUpTtl, holdDownTtl);
+  if (updateNodeOverloaded(
+          nodeName,
+          *newAdjacencyDb.isOverloaded_ref(),
+          holdUpTtl,
+          holdDownTtl)) {
+    change.topologyChanged = true;
+    change.updatedNodes.emplace_back(nodeName);
+  }
 
   change.nodeLabelChanged =
       *priorAdjacencyDb.nodeLabel_ref() != *newAdjacencyDb.nodeLabel_ref();
@@ -652,6 +700,7 @@ LinkState::updateAdjacencyDatabase(
       // change the topology.
       change.topologyChanged |= (*oldIter)->isUp();
       removeLink(*oldIter);
+      change.removedLinks.emplace_back(*oldIter);
       XLOG(DBG1) << "[LINK DOWN] " << (*oldIter)->toString();
       ++oldIter;
       continue;
@@ -662,6 +711,13 @@ LinkState::updateAdjacencyDatabase(
     auto& newLink = **newIter;
     auto& oldLink = **oldIter;
 
+    if (newLink.getMetricFromNode(nodeName) !=
+            oldLink.getMetricFromNode(nodeName) or
+        newLink.getOverloadFromNode(nodeName) !=
+            oldLink.getOverloadFromNode(nodeName)) {
+      change.updatedLinks.emplace_back(*oldIter);
+    }
+
     // change the metric on the link object we already have
     if (newLink.getMetricFromNode(nodeName) !=
         oldLink.getMetricFromNode(nodeName)) {
@@ -720,6 +776,9 @@ LinkState::updateAdjacencyDatabase(
 
       // change the weight on the link object we already have
       oldLink.setWeightFromNode(nodeName, newLink.getWeightFromNode(nodeName));
+
+      // ADJ_WEIGHT_PROPAGATION resolves weights out of link weights
+      ucmpResults_.clear();
     }
 
     // check if local nextHops Changed
@@ -748,10 +807,24 @@ LinkState::updateAdjacencyDatabase(
     ++newIter;
     ++oldIter;
   }
+
+  // only added links and links with changed metric or overload get new holds
+  updateHeldNode(nodeName);
+  for (auto const& link : change.addedLinks) {
+    updateHeldLink(link);
+  }
+  for (auto const& link : change.updatedLinks) {
+    updateHeldLink(link);
+  }
+
   if (change.topologyChanged) {
-    spfResults_.clear();
+    updateSpfResults(change);
     kthPathResults_.clear();
+    ucmpResults_.clear();
+    csrTopology_.reset();
   }
+  // any attribute of the adjacency database may affect next-hops
+  version_ = getNextVersion();
   return change;
 }
 
@@ -762,11 +835,17 @@ LinkState::deleteAdjacencyDatabase(const std::string& nodeName) {
   auto search = adjacencyDatabases_.find(nodeName);
 
   if (search != adjacencyDatabases_.end()) {
+    auto const& links = linksFromNode(nodeName);
+    change.removedLinks.assign(links.begin(), links.end());
+    change.updatedNodes.emplace_back(nodeName);
     removeNode(nodeName);
     adjacencyDatabases_.erase(search);
-    spfResults_.clear();
-    kthPathResults_.clear();
     change.topologyChanged = true;
+    updateSpfResults(change);
+    kthPathResults_.clear();
+    ucmpResults_.clear();
+    csrTopology_.reset();
+    version_ = getNextVersion();
   } else {
     XLOG(WARNING) << "Trying to delete adjacency db for non-existing node "
                   << nodeName;
@@ -802,22 +881,110 @@ LinkState::getKthPaths(
         }
       }
     }
-    std::vector<LinkState::Path> paths;
-    auto const& res = linksToIgnore.empty() ? getSpfResult(src, true)
-                                            : runSpf(src, true, linksToIgnore);
-    if (res.count(dest)) {
-      LinkSet visitedLinks;
-      auto path = traceOnePath(src, dest, res, visitedLinks);
-      while (path && !path->empty()) {
-        paths.push_back(std::move(*path));
-        path = traceOnePath(src, dest, res, visitedLinks);
-      }
+    std::vector<Path> paths;
+    if (linksToIgnore.empty()) {
+      paths = tracePaths(src, dest, getSpfResult(src, true));
+    } else if (auto destIt = nodeIds_.find(dest); destIt != nodeIds_.end()) {
+      // only paths towards dest are traced, stop SPF once it is settled
+      auto const& topology = getCsrTopology();
+      const uint32_t rootId = internNodeName(src);
+      paths = tracePaths(
+          src,
+          dest,
+          runSpf(
+              topology,
+              rootId,
+              true,
+              linksToIgnore,
+              spfScratch_,
+              {destIt->second}));
     }
     entryIter = kthPathResults_.emplace(key, std::move(paths)).first;
   }
   return entryIter->second;
 }
 
+void
+LinkState::computeKthPaths(
+    const std::string& src,
+    std::vector<std::string> const& dests,
+    size_t k,
+    folly::Executor& executor) const {
+  CHECK_GE(k, 1);
+  // first paths are traced on memoized SPF result, nothing to parallelize
+  for (auto const& dest : dests) {
+    getKthPaths(src, dest, 1);
+  }
+
+  // snapshot and node ids are only read from now on
+  auto const& topology = getCsrTopology();
+  const uint32_t rootId = internNodeName(src);
+
+  for (size_t i = 2; i <= k; ++i) {
+    // dests whose i-th paths need SPF run with links of prior paths ignored
+    std::vector<std::tuple<std::string, uint32_t, LinkSet>> pending;
+    for (auto const& dest : dests) {
+      if (kthPathResults_.count(std::make_tuple(src, dest, i))) {
+        continue;
+      }
+      LinkSet linksToIgnore;
+      for (size_t j = 1; j < i; ++j) {
+        for (auto const& path : getKthPaths(src, dest, j)) {
+          linksToIgnore.insert(path.begin(), path.end());
+        }
+      }
+      auto destIt = nodeIds_.find(dest);
+      if (linksToIgnore.empty() or destIt == nodeIds_.end()) {
+        // same as first paths or unreachable, no SPF run needed
+        getKthPaths(src, dest, i);
+        continue;
+      }
+      pending.emplace_back(dest, destIt->second, std::move(linksToIgnore));
+    }
+
+    std::vector<folly::Future<std::vector<Path>>> futures;
+    futures.reserve(pending.size());
+    for (auto const& [dest, destId, linksToIgnore] : pending) {
+      futures.emplace_back(folly::via(
+          &executor,
+          [this, &topology, rootId, &src, &dest = dest, destId = destId,
+           &linksToIgnore = linksToIgnore]() {
+            SpfScratch scratch;
+            return tracePaths(
+                src,
+                dest,
+                runSpf(
+                    topology, rootId, true, linksToIgnore, scratch, {destId}));
+          }));
+    }
+    auto results = folly::collect(std::move(futures)).get();
+
+    // merge in order of dests
+    for (size_t idx = 0; idx < pending.size(); ++idx) {
+      kthPathResults_.emplace(
+          std::make_tuple(src, std::get<0>(pending[idx]), i),
+          std::move(results[idx]));
+    }
+  }
+}
+
+std::vector<LinkState::Path>
+LinkState::tracePaths(
+    std::string const& src,
+    std::string const& dest,
+    SpfResult const& result) const {
+  std::vector<LinkState::Path> paths;
+  if (result.count(dest)) {
+    LinkSet visitedLinks;
+    auto path = traceOnePath(src, dest, result, visitedLinks);
+    while (path && !path->empty()) {
+      paths.push_back(std::move(*path));
+      path = traceOnePath(src, dest, result, visitedLinks);
+    }
+  }
+  return paths;
+}
+
 LinkState::SpfResult const&
 LinkState::getSpfResult(
     const std::string& thisNodeName, bool useLinkMetric) const {
@@ -830,78 +997,514 @@ LinkState::getSpfResult(
   return entryIter->second;
 }
 
+LinkState::UcmpResult const&
+LinkState::getUcmpResult(
+    const std::string& rootNode,
+    const std::unordered_map<std::string, int64_t>& leafNodeToWeights,
+    thrift::PrefixForwardingAlgorithm algo,
+    bool useLinkMetric) const {
+  std::vector<std::pair<std::string, int64_t>> leafWeights(
+      leafNodeToWeights.begin(), leafNodeToWeights.end());
+  std::sort(leafWeights.begin(), leafWeights.end());
+  auto key = std::make_tuple(
+      rootNode, useLinkMetric, algo, std::move(leafWeights));
+  auto entryIter = ucmpResults_.find(key);
+  if (ucmpResults_.end() == entryIter) {
+    auto res = resolveUcmpWeights(
+        getSpfResult(rootNode, useLinkMetric),
+        leafNodeToWeights,
+        algo,
+        useLinkMetric);
+    entryIter = ucmpResults_.emplace(std::move(key), std::move(res)).first;
+  }
+  return entryIter->second;
+}
+
+void
+LinkState::clearMemoization() {
+  spfResults_.clear();
+  ucmpResults_.clear();
+  kthPathResults_.clear();
+  csrTopology_.reset();
+}
+
+void
+LinkState::updateSpfResults(LinkStateChange const& change) {
+  if (not enableIncrementalSpf_) {
+    spfResults_.clear();
+    return;
+  }
+  for (auto& [key, result] : spfResults_) {
+    repairSpf(key.first, key.second, change, result);
+  }
+}
+
+void
+LinkState::repairSpf(
+    const std::string& thisNodeName,
+    bool useLinkMetric,
+    LinkStateChange const& change,
+    SpfResult& result) const {
+  const auto startTime = std::chrono::steady_clock::now();
+
+  auto getMetric = [useLinkMetric](
+                       std::shared_ptr<Link> const& link,
+                       std::string const& fromNode) -> LinkStateMetric {
+    return useLinkMetric ? link->getMetricFromNode(fromNode) : 1;
+  };
+  // node offering transit towards further away nodes
+  auto isTransitNode = [&](std::string const& nodeName) {
+    return nodeName == thisNodeName or not isNodeOverloaded(nodeName);
+  };
+  // whether node is on shortest paths via given link and/or previous node
+  auto isChildOf = [&](std::string const& nodeName,
+                       std::shared_ptr<Link> const& link,
+                       std::string const& prevNode) {
+    auto it = result.find(nodeName);
+    if (it == result.end()) {
+      return false;
+    }
+    for (auto const& pathLink : it->second.pathLinks()) {
+      if ((link == nullptr or pathLink.link == link) and
+          pathLink.prevNode == prevNode) {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  // nodes whose shortest paths may be affected by the change
+  std::unordered_set<std::string> affected;
+
+  // 1) nodes reached through a removed or worsened link or a node which no
+  // longer offers transit. Their paths may get longer.
+  for (auto const* links : {&change.removedLinks, &change.updatedLinks}) {
+    for (auto const& link : *links) {
+      for (auto const& [node, prevNode] :
+           {std::make_pair(link->firstNodeName(), link->secondNodeName()),
+            std::make_pair(link->secondNodeName(), link->firstNodeName())}) {
+        if (isChildOf(node, link, prevNode)) {
+          affected.emplace(node);
+        }
+      }
+    }
+  }
+  for (auto const& nodeName : change.updatedNodes) {
+    if (nodeName == thisNodeName) {
+      continue;
+    }
+    for (auto const& link : linksFromNode(nodeName)) {
+      auto const& otherNodeName = link->getOtherNodeName(nodeName);
+      if (isChildOf(otherNodeName, nullptr, nodeName)) {
+        affected.emplace(otherNodeName);
+      }
+    }
+  }
+
+  // 2) nodes with a new path, through an added or improved link or a node
+  // which now offers transit, no longer than their current one. Probe these
+  // with a Dijkstra bounded by the current metrics.
+  std::priority_queue<
+      std::pair<LinkStateMetric, std::string>,
+      std::vector<std::pair<LinkStateMetric, std::string>>,
+      std::greater<>>
+      probeQ;
+  auto probeFrom = [&](std::string const& nodeName,
+                       LinkStateMetric metric,
+                       std::shared_ptr<Link> const& link) {
+    if (link->isUp() and isTransitNode(nodeName)) {
+      probeQ.emplace(
+          metric + getMetric(link, nodeName), link->getOtherNodeName(nodeName));
+    }
+  };
+  for (auto const* links : {&change.addedLinks, &change.updatedLinks}) {
+    for (auto const& link : *links) {
+      for (auto const& nodeName :
+           {link->firstNodeName(), link->secondNodeName()}) {
+        auto it = result.find(nodeName);
+        if (it != result.end()) {
+          probeFrom(nodeName, it->second.metric(), link);
+        }
+      }
+    }
+  }
+  for (auto const& nodeName : change.updatedNodes) {
+    auto it = result.find(nodeName);
+    if (it != result.end()) {
+      for (auto const& link : linksFromNode(nodeName)) {
+        probeFrom(nodeName, it->second.metric(), link);
+      }
+    }
+  }
+  std::unordered_set<std::string> probed;
+  while (not probeQ.empty()) {
+    auto [metric, nodeName] = probeQ.top();
+    probeQ.pop();
+    if (nodeName == thisNodeName or probed.count(nodeName)) {
+      continue;
+    }
+    auto it = result.find(nodeName);
+    if (it != result.end() and metric > it->second.metric()) {
+      continue;
+    }
+    probed.emplace(nodeName);
+    affected.emplace(nodeName);
+    for (auto const& link : linksFromNode(nodeName)) {
+      probeFrom(nodeName, metric, link);
+    }
+  }
+
+  if (affected.empty()) {
+    return;
+  }
+
+  // 3) nexthops are inherited along shortest paths, hence the entire subtree
+  // below affected nodes is affected as well
+  std::vector<std::string> toVisit(affected.begin(), affected.end());
+  while (not toVisit.empty()) {
+    auto nodeName = std::move(toVisit.back());
+    toVisit.pop_back();
+    for (auto const& link : linksFromNode(nodeName)) {
+      auto const& otherNodeName = link->getOtherNodeName(nodeName);
+      if (not affected.count(otherNodeName) and
+          isChildOf(otherNodeName, link, nodeName)) {
+        affected.emplace(otherNodeName);
+        toVisit.emplace_back(otherNodeName);
+      }
+    }
+  }
+
+  // 4) re-run Dijkstra over affected nodes only. Results of unaffected nodes
+  // are final and act as the source of the run.
+  for (auto const& nodeName : affected) {
+    result.erase(nodeName);
+  }
+  DijkstraQ<DijkstraQSpfNode> q;
+  auto relax = [&](std::string const& nodeName,
+                   LinkStateMetric metric,
+                   std::shared_ptr<Link> const& link) {
+    if (not link->isUp() or not isTransitNode(nodeName)) {
+      return;
+    }
+    auto const& otherNodeName = link->getOtherNodeName(nodeName);
+    if (not affected.count(otherNodeName) or result.count(otherNodeName)) {
+      return;
+    }
+    auto const otherMetric = metric + getMetric(link, nodeName);
+    auto otherNode = q.get(otherNodeName);
+    if (not otherNode) {
+      q.insertNode(otherNodeName, otherMetric);
+    } else if (otherNode->metric() > otherMetric) {
+      otherNode->result.reset(otherMetric);
+      q.reMake();
+    }
+  };
+  for (auto const& nodeName : affected) {
+    for (auto const& link : linksFromNode(nodeName)) {
+      auto const& otherNodeName = link->getOtherNodeName(nodeName);
+      auto it = result.find(otherNodeName);
+      if (it != result.end()) {
+        relax(otherNodeName, it->second.metric(), link);
+      }
+    }
+  }
+
+  while (auto node = q.extractMin()) {
+    auto const& nodeName = node->nodeName;
+    auto const metric = node->metric();
+
+    // previous nodes on shortest paths. Record paths in the very same order
+    // as a full SPF run does, i.e. by order in which previous nodes are
+    // settled and then by their links.
+    std::vector<std::pair<LinkStateMetric, std::string>> prevNodes;
+    for (auto const& link : linksFromNode(nodeName)) {
+      auto const& prevNode = link->getOtherNodeName(nodeName);
+      auto it = result.find(prevNode);
+      if (it == result.end() or not link->isUp() or
+          not isTransitNode(prevNode)) {
+        continue;
+      }
+      auto const prevMetric = it->second.metric();
+      if (prevMetric + getMetric(link, prevNode) == metric and
+          std::tie(prevMetric, prevNode) < std::tie(metric, nodeName)) {
+        prevNodes.emplace_back(prevMetric, prevNode);
+      }
+    }
+    std::sort(prevNodes.begin(), prevNodes.end());
+    prevNodes.erase(
+        std::unique(prevNodes.begin(), prevNodes.end()), prevNodes.end());
+
+    for (auto const& [prevMetric, prevNode] : prevNodes) {
+      auto const& prevNextHops = result.at(prevNode).nextHops();
+      for (auto const& link : linksFromNode(prevNode)) {
+        if (link->getOtherNodeName(prevNode) != nodeName or
+            not link->isUp() or
+            prevMetric + getMetric(link, prevNode) != metric) {
+          continue;
+        }
+        node->result.addPath(link, prevNode);
+        node->result.addNextHops(prevNextHops);
+        if (node->result.nextHops().empty()) {
+          // directly connected node
+          node->result.addNextHop(nodeName);
+        }
+      }
+    }
+
+    auto emplaceRc = result.emplace(nodeName, std::move(node->result));
+    CHECK(emplaceRc.second);
+    for (auto const& link : linksFromNode(nodeName)) {
+      relax(nodeName, metric, link);
+    }
+  }
+
+  auto deltaTime = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - startTime);
+  XLOG(DBG3) << "Incremental SPF from " << thisNodeName << " repaired "
+             << affected.size() << " nodes in " << deltaTime.count() << "us.";
+  fb303::fbData->addStatValue(
+      "decision.incremental_spf_runs", 1, fb303::COUNT);
+  fb303::fbData->addStatValue(
+      "decision.incremental_spf_nodes", affected.size(), fb303::AVG);
+}
+
+uint32_t
+LinkState::internNodeName(const std::string& nodeName) const {
+  auto [it, inserted] =
+      nodeIds_.try_emplace(nodeName, static_cast<uint32_t>(nodeNames_.size()));
+  if (inserted) {
+    nodeNames_.emplace_back(nodeName);
+  }
+  return it->second;
+}
+
+LinkState::CsrTopology const&
+LinkState::getCsrTopology() const {
+  if (csrTopology_.has_value()) {
+    return *csrTopology_;
+  }
+
+  for (auto const& [nodeName, _] : linkMap_) {
+    internNodeName(nodeName);
+  }
+  const size_t numNodes = nodeNames_.size();
+
+  CsrTopology topology;
+  topology.isOverloaded.assign(numNodes, false);
+
+  // [Parallel Link Compaction] group links of each node by the other node
+  // and metric, keeping the order of their first link
+  size_t numLinks{0};
+  std::vector<std::vector<CsrEdge>> nodeEdges(numNodes);
+  std::map<std::pair<uint32_t, LinkStateMetric>, size_t> edgeIndices;
+  for (auto const& [nodeName, links] : linkMap_) {
+    auto const id = nodeIds_.at(nodeName);
+    auto& edges = nodeEdges[id];
+    edgeIndices.clear();
+    for (auto const& link : links) {
+      if (not link->isUp()) {
+        continue;
+      }
+      ++numLinks;
+      const auto toNode = nodeIds_.at(link->getOtherNodeName(nodeName));
+      const auto metric = link->getMetricFromNode(nodeName);
+      auto [it, inserted] =
+          edgeIndices.try_emplace(std::make_pair(toNode, metric), edges.size());
+      if (inserted) {
+        auto& edge = edges.emplace_back();
+        edge.toNode = toNode;
+        edge.metric = metric;
+      }
+      edges[it->second].links.emplace_back(link);
+    }
+    topology.isOverloaded[id] = isNodeOverloaded(nodeName);
+  }
+
+  topology.offsets.reserve(numNodes + 1);
+  topology.offsets.emplace_back(0);
+  for (auto& edges : nodeEdges) {
+    topology.offsets.emplace_back(topology.offsets.back() + edges.size());
+    std::move(edges.begin(), edges.end(), std::back_inserter(topology.edges));
+  }
+  XLOG(DBG2) << "SPF snapshot compacted " << numLinks << " links into "
+             << topology.edges.size() << " edges";
+
+  std::vector<uint32_t> byName(numNodes);
+  std::iota(byName.begin(), byName.end(), 0);
+  std::sort(byName.begin(), byName.end(), [this](uint32_t a, uint32_t b) {
+    return nodeNames_[a] < nodeNames_[b];
+  });
+  topology.nameRanks.resize(numNodes);
+  for (uint32_t rank = 0; rank < numNodes; ++rank) {
+    topology.nameRanks[byName[rank]] = rank;
+  }
+
+  csrTopology_ = std::move(topology);
+  return *csrTopology_;
+}
+
+LinkState::SpfResult
+LinkState::runSpf(
+    const std::string& thisNodeName,
+    bool useLinkMetric,
+    const LinkState::LinkSet& linksToIgnore) const {
+  auto const& topology = getCsrTopology();
+  // root may have no links, hence be unknown to the snapshot
+  const uint32_t rootId = internNodeName(thisNodeName);
+  return runSpf(topology, rootId, useLinkMetric, linksToIgnore, spfScratch_);
+}
+
 /**
  * Compute shortest-path routes from perspective of nodeName;
  */
 LinkState::SpfResult
 LinkState::runSpf(
-    const std::string& thisNodeName,
+    CsrTopology const& topology,
+    uint32_t rootId,
     bool useLinkMetric,
-    const LinkState::LinkSet& linksToIgnore) const {
+    const LinkState::LinkSet& linksToIgnore,
+    SpfScratch& scratch,
+    std::vector<uint32_t> targetIds) const {
   LinkState::SpfResult result;
 
   fb303::fbData->addStatValue("decision.spf_runs", 1, fb303::COUNT);
   const auto startTime = std::chrono::steady_clock::now();
 
-  DijkstraQ<DijkstraQSpfNode> q;
-  q.insertNode(thisNodeName, 0);
+  const size_t numTopologyNodes = topology.offsets.size() - 1;
+
+  // nodes are ordered by metric and then by node name, same as DijkstraQ
+  auto getRank = [&](uint32_t id) -> uint32_t {
+    return id < numTopologyNodes ? topology.nameRanks[id] : 0;
+  };
+  auto& nodes = scratch.nodes;
+  if (nodes.size() < nodeNames_.size()) {
+    nodes.resize(nodeNames_.size());
+  }
+  auto& q = scratch.queue;
+  q.clear();
+  std::vector<uint32_t> settledNodes;
+  // nodes reached but not settled when stopping early
+  std::vector<uint32_t> reachedNodes;
+
+  std::sort(targetIds.begin(), targetIds.end());
+  targetIds.erase(
+      std::unique(targetIds.begin(), targetIds.end()), targetIds.end());
+  size_t numTargetsLeft = targetIds.size();
+  auto isTarget = [&](uint32_t id) {
+    return std::binary_search(targetIds.begin(), targetIds.end(), id);
+  };
+
+  nodes[rootId].metric = 0;
+  q.push(rootId, {0, getRank(rootId)});
   uint64_t loop = 0;
-  while (auto node = q.extractMin()) {
+  while (not q.empty()) {
+    auto const recordedNodeId = q.pop().second;
+    auto& recordedNode = nodes[recordedNodeId];
+    auto const recordedNodeMetric = recordedNode.metric;
     ++loop;
     // we've found this node's shortest paths. record it
-    auto emplaceRc = result.emplace(node->nodeName, std::move(node->result));
-    CHECK(emplaceRc.second);
-
-    auto const& recordedNodeName = emplaceRc.first->first;
-    auto const recordedNodeMetric = emplaceRc.first->second.metric();
-    auto const& recordedNodeNextHops = emplaceRc.first->second.nextHops();
+    recordedNode.settled = true;
+    std::sort(recordedNode.nextHops.begin(), recordedNode.nextHops.end());
+    recordedNode.nextHops.erase(
+        std::unique(recordedNode.nextHops.begin(), recordedNode.nextHops.end()),
+        recordedNode.nextHops.end());
+    settledNodes.emplace_back(recordedNodeId);
+
+    // paths towards settled nodes are final, no need to go any further
+    if (numTargetsLeft > 0 and isTarget(recordedNodeId) and
+        --numTargetsLeft == 0) {
+      while (not q.empty()) {
+        reachedNodes.emplace_back(q.pop().second);
+      }
+      break;
+    }
 
-    if (isNodeOverloaded(recordedNodeName) &&
-        recordedNodeName != thisNodeName) {
+    if (recordedNodeId >= numTopologyNodes) {
+      continue;
+    }
+    if (topology.isOverloaded[recordedNodeId] && recordedNodeId != rootId) {
       // no transit traffic through this node. we've recorded the nexthops to
       // this node, but will not consider any of it's adjancecies as offering
       // lower cost paths towards further away nodes. This effectively drains
       // traffic away from this node
       continue;
     }
-    // we have the shortest path nexthops for recordedNodeName. Use these
-    // nextHops for any node that is connected to recordedNodeName that doesn't
-    // already have a lower cost path from thisNodeName
+    // we have the shortest path nexthops for recordedNode. Use these nextHops
+    // for any node that is connected to recordedNode that doesn't already
+    // have a lower cost path from thisNodeName
     //
     // this is the "relax" step in the Dijkstra Algorithm pseudocode in CLRS
-    for (const auto& link : linksFromNode(recordedNodeName)) {
-      auto& otherNodeName = link->getOtherNodeName(recordedNodeName);
-      if (!link->isUp() or result.count(otherNodeName) or
-          linksToIgnore.count(link)) {
+    for (uint32_t i = topology.offsets[recordedNodeId];
+         i < topology.offsets[recordedNodeId + 1];
+         ++i) {
+      auto const& edge = topology.edges[i];
+      auto& otherNode = nodes[edge.toNode];
+      if (otherNode.settled or
+          (not linksToIgnore.empty() and
+           std::all_of(
+               edge.links.begin(),
+               edge.links.end(),
+               [&linksToIgnore](auto const& link) {
+                 return linksToIgnore.count(link) > 0;
+               }))) {
         continue;
       }
-      auto metric =
-          useLinkMetric ? link->getMetricFromNode(recordedNodeName) : 1;
-      auto otherNode = q.get(otherNodeName);
-      if (!otherNode) {
-        q.insertNode(otherNodeName, recordedNodeMetric + metric);
-        otherNode = q.get(otherNodeName);
+      auto const metric =
+          recordedNodeMetric + (useLinkMetric ? edge.metric : 1);
+      if (otherNode.metric < metric) {
+        continue;
       }
-      if (otherNode->metric() >= recordedNodeMetric + metric) {
-        // recordedNodeName is either along an alternate shortest path towards
-        // otherNodeName or is along a new shorter path. In either case,
-        // otherNodeName should use recordedNodeName's nextHops until it finds
-        // some shorter path
-        if (otherNode->metric() > recordedNodeMetric + metric) {
-          // if this is strictly better, forget about any other paths
-          otherNode->result.reset(recordedNodeMetric + metric);
-          q.reMake();
-        }
-        auto& otherNodeResult = otherNode->result;
-        otherNodeResult.addPath(link, recordedNodeName);
-        otherNodeResult.addNextHops(recordedNodeNextHops);
-        if (otherNodeResult.nextHops().empty()) {
-          // directly connected node
-          otherNodeResult.addNextHop(otherNodeName);
+      // recordedNode is either along an alternate shortest path towards
+      // otherNode or is along a new shorter path. In either case, otherNode
+      // should use recordedNode's nextHops until it finds some shorter path
+      if (otherNode.metric > metric) {
+        // if this is strictly better, forget about any other paths
+        otherNode.metric = metric;
+        otherNode.pathEdges.clear();
+        otherNode.nextHops.clear();
+        q.pushOrDecreaseKey(edge.toNode, {metric, getRank(edge.toNode)});
+      }
+      otherNode.pathEdges.emplace_back(i, recordedNodeId);
+      otherNode.nextHops.insert(
+          otherNode.nextHops.end(),
+          recordedNode.nextHops.begin(),
+          recordedNode.nextHops.end());
+      if (otherNode.nextHops.empty()) {
+        // directly connected node
+        otherNode.nextHops.emplace_back(edge.toNode);
+      }
+    }
+  }
+
+  // convert to node names and reset node states for next run
+  for (auto const id : settledNodes) {
+    auto& node = nodes[id];
+    NodeSpfResult nodeResult(node.metric);
+    // expand compacted edges into their links
+    for (auto const& [edgeIndex, prevId] : node.pathEdges) {
+      for (auto const& link : topology.edges[edgeIndex].links) {
+        if (linksToIgnore.empty() or not linksToIgnore.count(link)) {
+          nodeResult.addPath(link, nodeNames_[prevId]);
         }
       }
     }
+    for (auto const nextHopId : node.nextHops) {
+      nodeResult.addNextHop(nodeNames_[nextHopId]);
+    }
+    result.emplace(nodeNames_[id], std::move(nodeResult));
+
+    node.metric = std::numeric_limits<LinkStateMetric>::max();
+    node.settled = false;
+    node.pathEdges.clear();
+    node.nextHops.clear();
+  }
+  for (auto const id : reachedNodes) {
+    auto& node = nodes[id];
+    node.metric = std::numeric_limits<LinkStateMetric>::max();
+    node.pathEdges.clear();
+    node.nextHops.clear();
   }
+
   XLOG(DBG3) << "Dijkstra loop count: " << loop;
   auto deltaTime = std::chrono::duration_cast<std::chrono::milliseconds>(
       std::chrono::steady_clock::now() - startTime);
@@ -8,14 +8,19 @@
 #pragma once
 
 #include <algorithm>
+#include <map>
 #include <memory>
 #include <numeric>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#include <folly/Executor.h>
+
 #include <openr/common/Constants.h>
+#include <openr/decision/IndexedDaryHeap.h>
 #include <openr/if/gen-cpp2/Network_types.h>
 #include <openr/if/gen-cpp2/Types_types.h>
 
@@ -184,7 +189,8 @@ class Link {
 
 class LinkState {
  public:
-  explicit LinkState(const std::string& area);
+  explicit LinkState(
+      const std::string& area, bool enableIncrementalSpf = false);
 
   struct LinkPtrHash {
     size_t operator()(const std::shared_ptr<Link>& l) const;
@@ -343,6 +349,11 @@ class LinkState {
   // each is memoized all params. memoization invalidated for any topolgy
   // altering calls, i.e. if decrementHolds(), updateAdjacencyDatabase(), or
   // deleteAdjacencyDatabase() returns with LinkState::topologyChanged set true
+  //
+  // [Incremental SPF]
+  // With incremental SPF enabled, memoized SPF results are repaired instead of
+  // being invalidated. Only nodes whose shortest paths may traverse a changed
+  // link or node are recomputed, see updateSpfResults().
   SpfResult const& getSpfResult(
       const std::string& nodeName, bool useLinkMetric = true) const;
 
@@ -354,16 +365,45 @@ class LinkState {
       thrift::PrefixForwardingAlgorithm algo,
       bool useLinkMetric = true) const;
 
+  // [UCMP Memoization]
+  // Memoized resolveUcmpWeights() over the SPF graph rooted at rootNode.
+  // Leaf weights are part of the key, hence a leaf weight change simply
+  // resolves a new entry. All entries are invalidated along with the SPF
+  // memoization, i.e. upon topology change, and upon link weight change.
+  UcmpResult const& getUcmpResult(
+      const std::string& rootNode,
+      const std::unordered_map<std::string, int64_t>& leafNodeToWeights,
+      thrift::PrefixForwardingAlgorithm algo,
+      bool useLinkMetric = true) const;
+
  private:
   // LinkState belongs to a unique area
   const std::string area_;
 
+  // repair memoized SPF results upon topology change instead of clearing them
+  const bool enableIncrementalSpf_{false};
+
+  // [Area Results Cache] see getVersion()
+  static uint64_t getNextVersion();
+  uint64_t version_{getNextVersion()};
+
   // memoization structure for getSpfResult()
   mutable std::unordered_map<
       std::pair<std::string /* nodeName */, bool /* useLinkMetric */>,
       SpfResult>
       spfResults_;
 
+  // memoization structure for getUcmpResult(). Leaf weights are sorted by
+  // node name to make the key independent of hash map iteration order.
+  mutable std::map<
+      std::tuple<
+          std::string /* rootNode */,
+          bool /* useLinkMetric */,
+          thrift::PrefixForwardingAlgorithm,
+          std::vector<std::pair<std::string, int64_t>> /* leaf weights */>,
+      UcmpResult>
+      ucmpResults_;
+
  public:
   // Trace edge-disjoint paths from dest to src.
   // I.e., no two paths returned from this function can share any links
@@ -376,6 +416,19 @@ class LinkState {
   std::vector<LinkState::Path> const& getKthPaths(
       const std::string& src, const std::string& dest, size_t k) const;
 
+  // [Parallel SPF]
+  // Memoize getKthPaths(src, dest, i) for every dest and 1 <= i <= k. SPF
+  // runs of different dests are independent and run concurrently on
+  // executor, while this LinkState is only read. Memoized paths are the same
+  // as of sequential getKthPaths() calls.
+  //
+  // MUST NOT be called concurrently with any other method of this LinkState.
+  void computeKthPaths(
+      const std::string& src,
+      std::vector<std::string> const& dests,
+      size_t k,
+      folly::Executor& executor) const;
+
  private:
   // memoization structure for getKthPaths()
   mutable std::unordered_map<
@@ -402,11 +455,25 @@ class LinkState {
           nodeLabelChanged == other.nodeLabelChanged;
     }
 
+    // [Scoped Route Rebuild] whether topology only changed by drain or
+    // undrain of nodes, i.e. their overload, while no link changed
+    bool
+    isNodeDrainOnly() const {
+      return topologyChanged && addedLinks.empty() && removedLinks.empty() &&
+          updatedLinks.empty() && not updatedNodes.empty();
+    }
+
     // Whether topology has changed
     bool topologyChanged{false};
     // Newly added links in the topology. Today it is only populated in
     // `updateAdjacencyDatabase()`.
     std::vector<std::shared_ptr<Link>> addedLinks;
+    // Links removed from the topology
+    std::vector<std::shared_ptr<Link>> removedLinks;
+    // Links whose metric, overload or hold has changed
+    std::vector<std::shared_ptr<Link>> updatedLinks;
+    // Nodes whose overload has changed or which are removed from the topology
+    std::vector<std::string> updatedNodes;
     // Whether attributes of links have changed
     bool linkAttributesChanged{false};
     // Whehter node labels have changed
@@ -426,6 +493,10 @@ class LinkState {
   // return true if this has caused any change in graph
   LinkStateChange deleteAdjacencyDatabase(const std::string& nodeName);
 
+  // [Memory Governor] drop all memoized SPF, UCMP and k-th paths results
+  // along with the CSR topology, all of which are recomputed on demand
+  void clearMemoization();
+
   // const public methods
 
   // returns metric from a to b,
@@ -440,6 +511,13 @@ class LinkState {
     return area_;
   }
 
+  // [Area Results Cache] changes upon every change of adjacencies or holds.
+  // Versions are unique across LinkState instances.
+  uint64_t
+  getVersion() const {
+    return version_;
+  }
+
   bool
   hasNode(const std::string& nodeName) const {
     return 0 != adjacencyDatabases_.count(nodeName);
@@ -479,7 +557,9 @@ class LinkState {
     if (a.size() <= b.size()) {
       for (size_t i = 0; i < (b.size() - a.size()) + 1; ++i) {
         size_t a_i = 0, b_i = i;
-        while (a_i < a.size() && *a.at(a_i) == *b.at(b_i)) {
+        // links of the same LinkState are compared by pointer first
+        while (a_i < a.size() &&
+               (a[a_i] == b[b_i] || *a[a_i] == *b[b_i])) {
           ++a_i;
           ++b_i;
         }
@@ -514,6 +594,71 @@ class LinkState {
       LinkStateMetric holdUpTtl,
       LinkStateMetric holdDownTtl);
 
+  // update memoized SPF results upon topology change. Results are cleared
+  // unless incremental SPF is enabled.
+  void updateSpfResults(LinkStateChange const& change);
+
+  // [Incremental SPF]
+  // repair SPF result of a root in place after topology change. Nodes whose
+  // shortest paths can be affected by the change are removed from the result
+  // and Dijkstra is re-run over them only, seeded from unaffected nodes.
+  void repairSpf(
+      const std::string& thisNodeName,
+      bool useLinkMetric,
+      LinkStateChange const& change,
+      SpfResult& result) const;
+
+  /*
+   * [Flat Topology]
+   *
+   * Node names are interned into dense integer ids, which are never reused.
+   * SPF runs over a compressed sparse row (CSR) snapshot of links which are
+   * up, i.e. edges leaving node `i` are `edges[offsets[i]]` up to
+   * `edges[offsets[i + 1] - 1]`, in the iteration order of linksFromNode().
+   *
+   * [Parallel Link Compaction] Parallel links towards the same node with
+   * equal metric are compacted into one edge carrying all of them, so SPF
+   * relaxes a bundle once instead of once per member. Members are expanded
+   * into path links of the SPF result only.
+   *
+   * The snapshot is rebuilt lazily upon first SPF run after topology change.
+   */
+  struct CsrEdge {
+    uint32_t toNode{0};
+    // metric advertised from the node this edge leaves
+    LinkStateMetric metric{0};
+    // parallel links, in the iteration order of linksFromNode()
+    std::vector<std::shared_ptr<Link>> links;
+  };
+
+  struct CsrTopology {
+    std::vector<uint32_t> offsets;
+    std::vector<CsrEdge> edges;
+    // overloaded node offers no transit towards further away nodes
+    std::vector<bool> isOverloaded;
+    // rank of node name among all names, to break ties among equal metrics
+    std::vector<uint32_t> nameRanks;
+  };
+
+  // Dijkstra state of a node while running SPF over the snapshot
+  struct CsrSpfNode {
+    LinkStateMetric metric{std::numeric_limits<LinkStateMetric>::max()};
+    bool settled{false};
+    // edge index and previous node of each shortest path
+    std::vector<std::pair<uint32_t, uint32_t>> pathEdges;
+    std::vector<uint32_t> nextHops;
+  };
+
+  // SPF queue keyed by <metric, name rank> and per node state
+  struct SpfScratch {
+    IndexedDaryHeap<std::pair<LinkStateMetric, uint32_t>> queue;
+    std::vector<CsrSpfNode> nodes;
+  };
+
+  uint32_t internNodeName(const std::string& nodeName) const;
+
+  CsrTopology const& getCsrTopology() const;
+
   // run Dijkstra's Shortest Path First algorithm on the link state graph
   SpfResult runSpf(
       const std::string& src, /* the source node for the SPF run */
@@ -524,6 +669,26 @@ class LinkState {
           {} /* optionaly specify a set of links to not use when running */)
       const;
 
+  // run SPF on given snapshot with given scratch space. Only reads the
+  // snapshot and node ids, hence safe to run concurrently with own scratch.
+  //
+  // If targetIds is given, SPF stops as soon as all targets are settled. The
+  // result then only holds nodes settled so far, which include all nodes on
+  // shortest paths towards the targets.
+  SpfResult runSpf(
+      CsrTopology const& topology,
+      uint32_t rootId,
+      bool useLinkMetric,
+      const LinkSet& linksToIgnore,
+      SpfScratch& scratch,
+      std::vector<uint32_t> targetIds = {}) const;
+
+  // trace edge-disjoint paths from dest to src on given SPF result
+  std::vector<Path> tracePaths(
+      std::string const& src,
+      std::string const& dest,
+      SpfResult const& result) const;
+
   // returns Link object if the reverse adjancency is present in
   // adjacencyDatabases_.at(adj.otherNodeName), else returns nullptr
   std::shared_ptr<Link> maybeMakeLink(
@@ -544,10 +709,27 @@ class LinkState {
   std::unordered_map<std::string /* nodeName */, HoldableValue<bool>>
       nodeOverloads_;
 
+  // links and nodes with pending holds, the only ones decrementHolds() visits
+  LinkSet heldLinks_;
+  std::unordered_set<std::string /* nodeName */> heldNodes_;
+
+  // start or stop tracking holds of link/node after its holds changed
+  void updateHeldLink(std::shared_ptr<Link> const& link);
+  void updateHeldNode(std::string const& nodeName);
+
   // the latest AdjacencyDatabase we've received from each node
   std::unordered_map<std::string, thrift::AdjacencyDatabase>
       adjacencyDatabases_;
 
+  // [Flat Topology] interned node names and snapshot of topology. Unset
+  // snapshot is rebuilt upon next SPF run.
+  mutable std::vector<std::string> nodeNames_;
+  mutable std::unordered_map<std::string, uint32_t> nodeIds_;
+  mutable std::optional<CsrTopology> csrTopology_;
+
+  // SPF scratch space, reused across SPF runs to avoid allocation
+  mutable SpfScratch spfScratch_;
+
 }; // class LinkState
 
 // Classes needed for running Dijkstra to build an SPF graph starting at a root
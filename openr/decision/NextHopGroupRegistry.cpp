@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <openr/decision/NextHopGroupRegistry.h>
+
+namespace openr {
+
+NextHopGroupRegistry&
+NextHopGroupRegistry::getInstance() {
+  // intentionally leaked, routes with static storage duration may drop their
+  // groups in any order on exit
+  static auto* registry = new NextHopGroupRegistry();
+  return *registry;
+}
+
+std::shared_ptr<const NextHopGroup>
+NextHopGroupRegistry::intern(
+    const std::unordered_set<thrift::NextHopThrift>& nexthops,
+    uint64_t fingerprint) {
+  auto groups = groups_.wlock();
+  auto [begin, end] = groups->equal_range(fingerprint);
+  for (auto it = begin; it != end; ++it) {
+    // ATTN: group is valid while registered, even if it's being released
+    if (it->second.group->nexthops != nexthops) {
+      continue;
+    }
+    if (auto group = it->second.ref.lock()) {
+      return group;
+    }
+    // group being released, left to its deleter
+  }
+
+  std::shared_ptr<const NextHopGroup> group(
+      new NextHopGroup(nextId_++, fingerprint, nexthops),
+      [this](const NextHopGroup* group) { release(group); });
+  groups->emplace(fingerprint, Entry{group.get(), group});
+  return group;
+}
+
+void
+NextHopGroupRegistry::release(const NextHopGroup* group) {
+  groups_.withWLock([group](auto& groups) {
+    auto [begin, end] = groups.equal_range(group->fingerprint);
+    for (auto it = begin; it != end; ++it) {
+      if (it->second.group == group) {
+        groups.erase(it);
+        break;
+      }
+    }
+  });
+  delete group;
+}
+
+} // namespace openr
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <folly/Synchronized.h>
+
+#include <openr/if/gen-cpp2/Network_types.h>
+
+namespace openr {
+
+/**
+ * [Nexthop Group] Immutable set of next-hops, shared by all routes using it.
+ */
+struct NextHopGroup {
+  NextHopGroup(
+      uint64_t id,
+      uint64_t fingerprint,
+      std::unordered_set<thrift::NextHopThrift> nexthops)
+      : id(id),
+        fingerprint(fingerprint),
+        nexthops(std::move(nexthops)),
+        nexthopList(this->nexthops.begin(), this->nexthops.end()) {}
+
+  // unique among groups alive in the process
+  const uint64_t id{0};
+  // order independent digest, see RibEntry::getNexthopsFingerprint()
+  const uint64_t fingerprint{0};
+  const std::unordered_set<thrift::NextHopThrift> nexthops;
+  // next-hops as carried by thrift routes, built once per group
+  const std::vector<thrift::NextHopThrift> nexthopList;
+};
+
+/**
+ * [Nexthop Group] Registry of next-hop groups, hash-consed by their
+ * next-hops: interning equal next-hop sets yields the same group no matter
+ * which module does it, hence groups compare by identity. There are only a
+ * few hundred distinct next-hop sets among all routes of a node.
+ *
+ * Groups are reference counted and leave the registry once the last
+ * reference is dropped. Ids are never reused.
+ *
+ * NOTE: Thread-safe. Registry must outlive the groups it interned.
+ */
+class NextHopGroupRegistry {
+ public:
+  // registry shared by all modules of the process
+  static NextHopGroupRegistry& getInstance();
+
+  // group of `nexthops`, whose digest is `fingerprint`. Created if there is
+  // none yet.
+  std::shared_ptr<const NextHopGroup> intern(
+      const std::unordered_set<thrift::NextHopThrift>& nexthops,
+      uint64_t fingerprint);
+
+  // number of groups alive
+  size_t
+  size() const {
+    return groups_.rlock()->size();
+  }
+
+ private:
+  struct Entry {
+    const NextHopGroup* group{nullptr};
+    std::weak_ptr<const NextHopGroup> ref;
+  };
+
+  // deleter of groups, invoked once last reference is dropped
+  void release(const NextHopGroup* group);
+
+  std::atomic<uint64_t> nextId_{1};
+
+  // groups indexed by fingerprint
+  folly::Synchronized<std::unordered_multimap<uint64_t, Entry>> groups_;
+};
+
+} // namespace openr
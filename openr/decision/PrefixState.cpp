@@ -12,22 +12,50 @@
 
 namespace openr {
 
+namespace {
+
+// [Shared Prefix Entry]
+// Entry of another originator of the same prefix with identical attributes,
+// e.g. anycast prefix, otherwise a new one
+std::shared_ptr<thrift::PrefixEntry>
+getSharedPrefixEntry(
+    PrefixEntries const& prefixEntries, thrift::PrefixEntry const& entry) {
+  for (auto const& [_, otherEntry] : prefixEntries) {
+    if (otherEntry and *otherEntry == entry) {
+      return otherEntry;
+    }
+  }
+  return std::make_shared<thrift::PrefixEntry>(entry);
+}
+
+} // namespace
+
 std::unordered_set<folly::CIDRNetwork>
 PrefixState::updatePrefix(
     PrefixKey const& key, thrift::PrefixEntry const& entry) {
+  // [Packed Metrics] Sort metric vector once when ingested, rather than on
+  // every comparison of best path selection
+  if (entry.mv_ref().has_value() and
+      not MetricVectorUtils::isSorted(*entry.mv_ref())) {
+    auto sortedEntry = entry;
+    MetricVectorUtils::sortMetricVector(*sortedEntry.mv_ref());
+    return updatePrefix(key, sortedEntry);
+  }
   std::unordered_set<folly::CIDRNetwork> changed;
 
-  auto [it, inserted] = prefixes_[key.getCIDRNetwork()].emplace(
-      key.getNodeAndArea(), std::make_shared<thrift::PrefixEntry>(entry));
+  auto& prefixEntries = prefixes_[key.getCIDRNetwork()];
+  auto [it, inserted] = prefixEntries.try_emplace(key.getNodeAndArea());
 
   // Skip rest of code, if prefix exists and has no change
   if (not inserted && *it->second == entry) {
     return changed;
   }
   // Update prefix
-  if (not inserted) {
-    it->second = std::make_shared<thrift::PrefixEntry>(entry);
+  it->second = getSharedPrefixEntry(prefixEntries, entry);
+  if (inserted) {
+    nodePrefixes_[key.getNodeAndArea()].insert(key.getCIDRNetwork());
   }
+  updateKsp2Prefix(key.getCIDRNetwork());
   changed.insert(key.getCIDRNetwork());
 
   XLOG(DBG1) << "[ROUTE ADVERTISEMENT] "
@@ -53,10 +81,40 @@ PrefixState::deletePrefix(PrefixKey const& key) {
     if (search->second.empty()) {
       prefixes_.erase(search);
     }
+    auto nodeIt = nodePrefixes_.find(key.getNodeAndArea());
+    if (nodeIt != nodePrefixes_.end()) {
+      nodeIt->second.erase(key.getCIDRNetwork());
+      if (nodeIt->second.empty()) {
+        nodePrefixes_.erase(nodeIt);
+      }
+    }
+    updateKsp2Prefix(key.getCIDRNetwork());
   }
   return changed;
 }
 
+std::unordered_set<folly::CIDRNetwork> const&
+PrefixState::getPrefixesByNode(NodeAndArea const& nodeAndArea) const {
+  static const std::unordered_set<folly::CIDRNetwork> kNoPrefixes;
+  auto it = nodePrefixes_.find(nodeAndArea);
+  return it != nodePrefixes_.end() ? it->second : kNoPrefixes;
+}
+
+void
+PrefixState::updateKsp2Prefix(folly::CIDRNetwork const& prefix) {
+  auto search = prefixes_.find(prefix);
+  if (search != prefixes_.end()) {
+    for (auto const& [_, entry] : search->second) {
+      if (*entry->forwardingAlgorithm_ref() ==
+          thrift::PrefixForwardingAlgorithm::KSP2_ED_ECMP) {
+        ksp2Prefixes_.insert(prefix);
+        return;
+      }
+    }
+  }
+  ksp2Prefixes_.erase(prefix);
+}
+
 std::vector<thrift::ReceivedRouteDetail>
 PrefixState::getReceivedRoutesFiltered(
     thrift::ReceivedRouteFilter const& filter) const {
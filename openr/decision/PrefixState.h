@@ -22,8 +22,21 @@ class PrefixState {
     return prefixes_;
   }
 
+  // [Scoped Route Rebuild]
+  // prefixes advertised by node in area
+  std::unordered_set<folly::CIDRNetwork> const& getPrefixesByNode(
+      NodeAndArea const& nodeAndArea) const;
+
+  // prefixes advertised with KSP2_ED_ECMP forwarding algorithm by any node.
+  // Their routes depend on entire paths rather than on distance and nexthops.
+  std::unordered_set<folly::CIDRNetwork> const&
+  ksp2Prefixes() const {
+    return ksp2Prefixes_;
+  }
+
   // returns set of changed prefixes (i.e. a node started advertising or any
-  // attributes changed)
+  // attributes changed). Originators of the same prefix with identical
+  // attributes share the same entry object, which MUST NOT be modified.
   std::unordered_set<folly::CIDRNetwork> updatePrefix(
       PrefixKey const& key, thrift::PrefixEntry const& entry);
 
@@ -59,5 +72,14 @@ class PrefixState {
   // Data structure to maintain mapping from:
   //  IpPrefix -> collection of originator(i.e. [node, area] combination)
   std::unordered_map<folly::CIDRNetwork, PrefixEntries> prefixes_;
+
+  // track prefix in ksp2Prefixes_ iff any of its entries is forwarded by KSP2
+  void updateKsp2Prefix(folly::CIDRNetwork const& prefix);
+
+  // reverse index of prefixes_: [node, area] -> advertised prefixes
+  std::unordered_map<NodeAndArea, std::unordered_set<folly::CIDRNetwork>>
+      nodePrefixes_;
+
+  std::unordered_set<folly::CIDRNetwork> ksp2Prefixes_;
 };
 } // namespace openr
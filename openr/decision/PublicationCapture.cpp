@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#include <fmt/format.h>
+#include <folly/FileUtil.h>
+#include <folly/Overload.h>
+#include <folly/String.h>
+#include <thrift/lib/cpp2/protocol/Serializer.h>
+
+#include <openr/decision/PublicationCapture.h>
+
+namespace openr {
+
+PublicationCaptureWriter::PublicationCaptureWriter(const std::string& filePath)
+    : fd_(folly::openNoInt(
+          filePath.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644)) {
+  if (fd_ == -1) {
+    throw std::system_error(
+        errno,
+        std::generic_category(),
+        fmt::format("Failed to open publication capture file {}", filePath));
+  }
+}
+
+PublicationCaptureWriter::~PublicationCaptureWriter() {
+  folly::closeNoInt(fd_);
+}
+
+folly::Expected<folly::Unit, std::string>
+PublicationCaptureWriter::write(
+    const KvStorePublication& publication,
+    std::chrono::system_clock::time_point timestamp) {
+  thrift::PublicationRecord record;
+  record.timestampUs_ref() =
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          timestamp.time_since_epoch())
+          .count();
+  folly::variant_match(
+      publication,
+      [&](thrift::Publication const& pub) { record.publication_ref() = pub; },
+      [&](thrift::InitializationEvent const& event) {
+        record.initializationEvent_ref() = event;
+      });
+
+  // Length prefix and record go out in a single write, so that a crash
+  // leaves at most a truncated record at the end of the file
+  const auto payload =
+      apache::thrift::CompactSerializer::serialize<std::string>(record);
+  const uint32_t length = htonl(payload.size());
+  std::string data(reinterpret_cast<const char*>(&length), sizeof(length));
+  data.append(payload);
+
+  const auto written = folly::writeFull(fd_, data.data(), data.size());
+  if (written < 0 or static_cast<size_t>(written) != data.size()) {
+    return folly::makeUnexpected<std::string>(folly::errnoStr(errno));
+  }
+  return folly::unit;
+}
+
+std::vector<thrift::PublicationRecord>
+readPublicationCapture(const std::string& filePath) {
+  std::string content;
+  if (not folly::readFile(filePath.c_str(), content)) {
+    throw std::runtime_error(fmt::format(
+        "Failed to read publication capture file {}: {}",
+        filePath,
+        folly::errnoStr(errno)));
+  }
+
+  std::vector<thrift::PublicationRecord> records;
+  size_t offset{0};
+  while (offset + sizeof(uint32_t) <= content.size()) {
+    uint32_t length;
+    std::memcpy(&length, content.data() + offset, sizeof(length));
+    length = ntohl(length);
+    offset += sizeof(uint32_t);
+    if (offset + length > content.size()) {
+      // truncated record at the end
+      break;
+    }
+    try {
+      records.emplace_back(
+          apache::thrift::CompactSerializer::deserialize<
+              thrift::PublicationRecord>(
+              folly::StringPiece(content.data() + offset, length)));
+    } catch (const std::exception& e) {
+      throw std::runtime_error(fmt::format(
+          "Malformed record {} at offset {} of {}: {}",
+          records.size(),
+          offset,
+          filePath,
+          e.what()));
+    }
+    offset += length;
+  }
+  return records;
+}
+
+} // namespace openr
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <folly/Expected.h>
+
+#include <openr/common/Types.h>
+#include <openr/if/gen-cpp2/KvStore_types.h>
+
+namespace openr {
+
+/**
+ * [Publication Capture] Appends publications and initialization events
+ * received by Decision to a capture file, see thrift::PublicationRecord for
+ * the format. Replayed by openr_decision_replay to reproduce route rebuilds
+ * of a node offline.
+ *
+ * NOTE: Not thread-safe
+ */
+class PublicationCaptureWriter {
+ public:
+  // Opens file for appending, throws std::system_error on failure
+  explicit PublicationCaptureWriter(const std::string& filePath);
+  ~PublicationCaptureWriter();
+
+  // No-copy, owns file descriptor
+  PublicationCaptureWriter(const PublicationCaptureWriter&) = delete;
+  PublicationCaptureWriter& operator=(const PublicationCaptureWriter&) = delete;
+
+  // Record publication received at `timestamp`. Error string on failure.
+  folly::Expected<folly::Unit, std::string> write(
+      const KvStorePublication& publication,
+      std::chrono::system_clock::time_point timestamp =
+          std::chrono::system_clock::now());
+
+ private:
+  int fd_{-1};
+};
+
+/**
+ * Read all records of capture file. Throws std::runtime_error if the file
+ * can't be read or is malformed. A record truncated at the end, e.g. by a
+ * crash while writing, is skipped.
+ */
+std::vector<thrift::PublicationRecord> readPublicationCapture(
+    const std::string& filePath);
+
+} // namespace openr
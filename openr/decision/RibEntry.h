@@ -13,7 +13,9 @@
 #include "openr/if/gen-cpp2/Network_types.h"
 
 #include <folly/IPAddress.h>
+#include <folly/hash/Hash.h>
 #include <openr/common/NetworkUtil.h>
+#include <openr/decision/NextHopGroupRegistry.h>
 #include <openr/if/gen-cpp2/Network_types.h>
 #include <openr/if/gen-cpp2/OpenrCtrl.h>
 #include <openr/if/gen-cpp2/Types_types.h>
@@ -27,6 +29,22 @@ struct RibEntry {
   // igp cost of all routes (ecmp) or of lowest cost route (if ucmp)
   unsigned int igpCost;
 
+  // [Route Fingerprint]
+  // 64-bit digest of the fields compared by operator==, except for the
+  // best prefix entry of unicast routes. Zero if not stamped.
+  //
+  // Fields of an entry may still be altered after it is built, e.g. by
+  // RibPolicy, hence DecisionRouteDb stamps entries with updateFingerprint()
+  // as it diffs or stores them.
+  uint64_t fingerprint{0};
+
+  // [Nexthop Group]
+  // Group of `nexthops` shared by all entries with the same next-hops across
+  // modules. Null if not interned. Entries are interned by internNexthops()
+  // as they are added to a DecisionRouteUpdate, and code altering `nexthops`
+  // of an interned entry MUST intern it again.
+  std::shared_ptr<const NextHopGroup> nexthopGroup;
+
   // constructor
   explicit RibEntry(
       std::unordered_set<thrift::NextHopThrift> nexthops,
@@ -39,6 +57,69 @@ struct RibEntry {
   operator==(const RibEntry& other) const {
     return nexthops == other.nexthops;
   }
+
+  void
+  internNexthops() {
+    nexthopGroup = NextHopGroupRegistry::getInstance().intern(
+        nexthops, getNexthopsFingerprint());
+  }
+
+  // next-hops as carried by thrift routes, copied out of the group if the
+  // entry is interned
+  std::vector<thrift::NextHopThrift>
+  getNexthopList() const {
+    if (nexthopGroup) {
+      return nexthopGroup->nexthopList;
+    }
+    return std::vector<thrift::NextHopThrift>(nexthops.begin(), nexthops.end());
+  }
+
+  // order independent digest of nexthops. Every next-hop is mixed before
+  // being summed up, so that e.g. weights swapped between two next-hops do
+  // not cancel out.
+  uint64_t
+  getNexthopsFingerprint() const {
+    return getNexthopsFingerprint(nexthops);
+  }
+
+  static uint64_t
+  getNexthopsFingerprint(
+      std::unordered_set<thrift::NextHopThrift> const& nexthops) {
+    uint64_t res = nexthops.size();
+    for (auto const& nh : nexthops) {
+      res += folly::hash::twang_mix64(getNextHopFingerprint(nh));
+    }
+    return res;
+  }
+
+  static uint64_t
+  getNextHopFingerprint(thrift::NextHopThrift const& nh) {
+    auto const& address = *nh.address_ref();
+    uint64_t res = folly::hash::hash_combine(
+        *address.addr_ref(),
+        address.ifName_ref().has_value(),
+        address.ifName_ref().value_or(""),
+        *nh.weight_ref(),
+        *nh.metric_ref(),
+        nh.area_ref().has_value(),
+        nh.area_ref().value_or(""),
+        nh.neighborNodeName_ref().has_value(),
+        nh.neighborNodeName_ref().value_or(""));
+    if (auto const& mplsAction = nh.mplsAction_ref()) {
+      res = folly::hash::hash_combine(
+          res,
+          static_cast<int32_t>(*mplsAction->action_ref()),
+          mplsAction->swapLabel_ref().has_value(),
+          mplsAction->swapLabel_ref().value_or(0),
+          mplsAction->pushLabels_ref().has_value());
+      if (auto const& pushLabels = mplsAction->pushLabels_ref()) {
+        for (auto const& label : *pushLabels) {
+          res = folly::hash::hash_combine(res, label);
+        }
+      }
+    }
+    return res;
+  }
 };
 
 struct RibUnicastEntry : RibEntry {
@@ -50,6 +131,9 @@ struct RibUnicastEntry : RibEntry {
   // Counter Id assigned to this route. Assignment comes from the
   // RibPolicyStatement that matches to this route.
   std::optional<thrift::RouteCounterID> counterID{std::nullopt};
+  // [LFA] loop-free alternates protecting against failure of the links to
+  // nexthops. Empty unless LFA is enabled.
+  std::unordered_set<thrift::NextHopThrift> backupNexthops;
 
   // constructor
   explicit RibUnicastEntry() {}
@@ -80,7 +164,7 @@ struct RibUnicastEntry : RibEntry {
   operator==(const RibUnicastEntry& other) const {
     return prefix == other.prefix && bestPrefixEntry == other.bestPrefixEntry &&
         doNotInstall == other.doNotInstall && counterID == other.counterID &&
-        RibEntry::operator==(other);
+        backupNexthops == other.backupNexthops && RibEntry::operator==(other);
   }
 
   bool
@@ -88,13 +172,35 @@ struct RibUnicastEntry : RibEntry {
     return !(*this == other);
   }
 
+  void
+  updateFingerprint() {
+    fingerprint = folly::hash::hash_combine(
+        prefix.first.hash(),
+        prefix.second,
+        doNotInstall,
+        counterID.has_value(),
+        counterID.value_or(""),
+        getNexthopsFingerprint(),
+        getNexthopsFingerprint(backupNexthops));
+  }
+
+  // Same as operator== for entries stamped with updateFingerprint(). Next-hop
+  // sets are deep compared ONLY if either entry is not stamped.
+  bool
+  isSameRoute(const RibUnicastEntry& other) const {
+    if (fingerprint == 0 or other.fingerprint == 0) {
+      return *this == other;
+    }
+    return fingerprint == other.fingerprint and
+        bestPrefixEntry == other.bestPrefixEntry;
+  }
+
   // TODO: rename this func
   thrift::UnicastRoute
   toThrift() const {
     thrift::UnicastRoute tUnicast;
     tUnicast.dest_ref() = toIpPrefix(prefix);
-    tUnicast.nextHops_ref() =
-        std::vector<thrift::NextHopThrift>(nexthops.begin(), nexthops.end());
+    tUnicast.nextHops_ref() = getNexthopList();
     tUnicast.counterID_ref().from_optional(counterID);
     return tUnicast;
   }
@@ -105,6 +211,8 @@ struct RibUnicastEntry : RibEntry {
     thrift::UnicastRouteDetail tUnicastDetail;
     tUnicastDetail.unicastRoute_ref() = toThrift();
     tUnicastDetail.bestRoute_ref() = bestPrefixEntry;
+    tUnicastDetail.backupNextHops_ref() = std::vector<thrift::NextHopThrift>(
+        backupNexthops.begin(), backupNexthops.end());
     return tUnicastDetail;
   }
 };
@@ -138,12 +246,26 @@ struct RibMplsEntry : RibEntry {
     return !(*this == other);
   }
 
+  void
+  updateFingerprint() {
+    fingerprint = folly::hash::hash_combine(label, getNexthopsFingerprint());
+  }
+
+  // Same as operator== for entries stamped with updateFingerprint(). Next-hop
+  // sets are deep compared ONLY if either entry is not stamped.
+  bool
+  isSameRoute(const RibMplsEntry& other) const {
+    if (fingerprint == 0 or other.fingerprint == 0) {
+      return *this == other;
+    }
+    return fingerprint == other.fingerprint;
+  }
+
   thrift::MplsRoute
   toThrift() const {
     thrift::MplsRoute tMpls;
     tMpls.topLabel_ref() = label;
-    tMpls.nextHops_ref() =
-        std::vector<thrift::NextHopThrift>(nexthops.begin(), nexthops.end());
+    tMpls.nextHops_ref() = getNexthopList();
     return tMpls;
   }
 
@@ -190,6 +312,7 @@ struct RibMplsEntry : RibEntry {
         ++it;
       }
     }
+    nexthopGroup.reset();
   }
 };
 } // namespace openr
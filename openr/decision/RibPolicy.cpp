@@ -7,6 +7,8 @@
 
 #include <openr/decision/RibPolicy.h>
 
+#include <algorithm>
+
 #include <fb303/ServiceData.h>
 #include <folly/MapUtil.h>
 #include <folly/logging/xlog.h>
@@ -160,6 +162,7 @@ RibPolicyStatement::applyAction(RibUnicastEntry& route) const {
 
   // Update route next-hops
   route.nexthops = std::move(newNexthops);
+  route.nexthopGroup.reset();
 
   return true;
 }
@@ -182,6 +185,20 @@ RibPolicy::RibPolicy(thrift::RibPolicy const& policy)
   for (auto const& statement : *policy.statements_ref()) {
     policyStatements_.emplace_back(RibPolicyStatement(statement));
   }
+
+  // Compile statements into lookup indices. See [Compiled RibPolicy]
+  for (size_t i = 0; i < policyStatements_.size(); ++i) {
+    auto const& statement = policyStatements_.at(i);
+    if (not statement.getPrefixSet().empty()) {
+      for (auto const& prefix : statement.getPrefixSet()) {
+        prefixToStatements_[prefix].emplace_back(i);
+      }
+    } else {
+      for (auto const& tag : statement.getTagSet()) {
+        tagToStatements_[tag].emplace_back(i);
+      }
+    }
+  }
 }
 
 thrift::RibPolicy
@@ -212,10 +229,34 @@ RibPolicy::isActive() const {
   return getTtlDuration().count() > 0;
 }
 
+std::vector<size_t>
+RibPolicy::getCandidateStatements(const RibUnicastEntry& route) const {
+  std::vector<size_t> candidates;
+  auto prefixIt = prefixToStatements_.find(route.prefix);
+  if (prefixIt != prefixToStatements_.end()) {
+    candidates = prefixIt->second;
+  }
+  if (not tagToStatements_.empty()) {
+    for (auto const& tag : *route.bestPrefixEntry.tags_ref()) {
+      auto tagIt = tagToStatements_.find(tag);
+      if (tagIt != tagToStatements_.end()) {
+        candidates.insert(
+            candidates.end(), tagIt->second.begin(), tagIt->second.end());
+      }
+    }
+  }
+
+  // Statements are evaluated in their configured order
+  std::sort(candidates.begin(), candidates.end());
+  candidates.erase(
+      std::unique(candidates.begin(), candidates.end()), candidates.end());
+  return candidates;
+}
+
 bool
 RibPolicy::match(const RibUnicastEntry& route) const {
-  for (auto const& statement : policyStatements_) {
-    if (statement.match(route)) {
+  for (auto const index : getCandidateStatements(route)) {
+    if (policyStatements_.at(index).match(route)) {
       return true;
     }
   }
@@ -224,8 +265,8 @@ RibPolicy::match(const RibUnicastEntry& route) const {
 
 bool
 RibPolicy::applyAction(RibUnicastEntry& route) const {
-  for (auto const& statement : policyStatements_) {
-    if (statement.applyAction(route)) {
+  for (auto const index : getCandidateStatements(route)) {
+    if (policyStatements_.at(index).applyAction(route)) {
       return true;
     }
   }
@@ -42,6 +42,16 @@ class RibPolicyStatement {
    */
   bool applyAction(RibUnicastEntry& route) const;
 
+  std::unordered_set<folly::CIDRNetwork> const&
+  getPrefixSet() const {
+    return prefixSet_;
+  }
+
+  std::unordered_set<std::string> const&
+  getTagSet() const {
+    return tagSet_;
+  }
+
  private:
   const std::string name_;
 
@@ -114,9 +124,28 @@ class RibPolicy {
       const;
 
  private:
+  /*
+   * [Compiled RibPolicy]
+   *
+   * Indices of statements which can possibly match the route, in ascending
+   * order. A statement with prefixes only matches routes of those exact
+   * prefixes, hence statements are indexed by prefix, and only the ones
+   * without prefixes are indexed by tag. Candidates MUST still be matched
+   * against the route, e.g. for tags of a statement with prefixes.
+   */
+  std::vector<size_t> getCandidateStatements(
+      const RibUnicastEntry& route) const;
+
   // List of policy statements
   std::vector<RibPolicyStatement> policyStatements_;
 
+  // Statements indexed by the prefixes they match
+  std::unordered_map<folly::CIDRNetwork, std::vector<size_t>>
+      prefixToStatements_;
+
+  // Statements without prefixes indexed by the tags they match
+  std::unordered_map<std::string, std::vector<size_t>> tagToStatements_;
+
   // Validity
   const std::chrono::steady_clock::time_point validUntilTs_;
 };
@@ -68,24 +68,27 @@ struct DecisionRouteUpdate {
   }
 
   /**
-   * Add unicast route.
+   * Add unicast route. Next-hops of the route are interned, see
+   * [Nexthop Group].
    * NOTE: Parameter is by value that can be constructed from `const&` as well
    * as rvalue. In case of later it'll ensure zero-copy.
    */
   void
   addRouteToUpdate(RibUnicastEntry route) {
+    route.internNexthops();
     auto prefix = route.prefix; // NOTE: Intended copy
     auto res = unicastRoutesToUpdate.emplace(prefix, std::move(route));
     CHECK(res.second) << "Duplicate Unicast route update";
   }
 
   /**
-   * Add mpls route.
+   * Add mpls route. Next-hops of the route are interned.
    * NOTE: Parameter is by value that can be constructed from `const&` as well
    * as rvalue. In case of later it'll ensure zero-copy.
    */
   void
   addMplsRouteToUpdate(RibMplsEntry route) {
+    route.internNexthops();
     auto label = route.label; // NOTE: Intended copy
     auto res = mplsRoutesToUpdate.emplace(label, std::move(route));
     CHECK(res.second) << "Duplicate MPLS route update";
@@ -5,7 +5,14 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
+#include <set>
+
 #include <fb303/ServiceData.h>
+#include <folly/MapUtil.h>
+#include <folly/executors/InlineExecutor.h>
+#include <folly/futures/Future.h>
+#include <folly/hash/Hash.h>
 #include <folly/logging/xlog.h>
 
 #include <openr/common/LsdbUtil.h>
@@ -25,10 +32,14 @@ DecisionRouteUpdate
 DecisionRouteDb::calculateUpdate(DecisionRouteDb&& newDb) const {
   DecisionRouteUpdate delta;
 
-  // unicastRoutesToUpdate
+  // unicastRoutesToUpdate. Entries stored in this db are stamped by update(),
+  // hence entry is compared by fingerprint, see [Route Fingerprint].
+  // Unchanged entries are left behind in newDb rather than being copied.
   for (auto& [prefix, entry] : newDb.unicastRoutes) {
+    entry.updateFingerprint();
     const auto& search = unicastRoutes.find(prefix);
-    if (search == unicastRoutes.end() || search->second != entry) {
+    if (search == unicastRoutes.end() ||
+        not search->second.isSameRoute(entry)) {
       // new prefix, or prefix entry changed
       delta.addRouteToUpdate(std::move(entry));
     }
@@ -43,8 +54,9 @@ DecisionRouteDb::calculateUpdate(DecisionRouteDb&& newDb) const {
 
   // mplsRoutesToUpdate
   for (auto& [label, entry] : newDb.mplsRoutes) {
+    entry.updateFingerprint();
     const auto& search = mplsRoutes.find(label);
-    if (search == mplsRoutes.end() || search->second != entry) {
+    if (search == mplsRoutes.end() || not search->second.isSameRoute(entry)) {
       delta.addMplsRouteToUpdate(std::move(entry));
     }
   }
@@ -64,13 +76,15 @@ DecisionRouteDb::update(DecisionRouteUpdate const& update) {
     unicastRoutes.erase(prefix);
   }
   for (auto const& [_, entry] : update.unicastRoutesToUpdate) {
-    unicastRoutes.insert_or_assign(entry.prefix, entry);
+    auto it = unicastRoutes.insert_or_assign(entry.prefix, entry).first;
+    it->second.updateFingerprint();
   }
   for (auto const& label : update.mplsRoutesToDelete) {
     mplsRoutes.erase(label);
   }
   for (auto const& [_, entry] : update.mplsRoutesToUpdate) {
-    mplsRoutes.insert_or_assign(entry.label, entry);
+    auto it = mplsRoutes.insert_or_assign(entry.label, entry).first;
+    it->second.updateFingerprint();
   }
 }
 
@@ -82,7 +96,9 @@ SpfSolver::SpfSolver(
     bool enableBgpRouteProgramming,
     bool enableBestRouteSelection,
     bool v4OverV6Nexthop,
-    bool enableUcmp)
+    bool enableUcmp,
+    size_t numSpfThreads,
+    bool enableLfa)
     : myNodeName_(myNodeName),
       enableV4_(enableV4),
       enableNodeSegmentLabel_(enableNodeSegmentLabel),
@@ -90,7 +106,8 @@ SpfSolver::SpfSolver(
       enableBgpRouteProgramming_(enableBgpRouteProgramming),
       enableBestRouteSelection_(enableBestRouteSelection),
       v4OverV6Nexthop_(v4OverV6Nexthop),
-      enableUcmp_(enableUcmp) {
+      enableUcmp_(enableUcmp),
+      enableLfa_(enableLfa) {
   // Initialize stat keys
   fb303::fbData->addStatExportType("decision.adj_db_update", fb303::COUNT);
   fb303::fbData->addStatExportType(
@@ -111,6 +128,11 @@ SpfSolver::SpfSolver(
   fb303::fbData->addStatExportType("decision.spf_ms", fb303::AVG);
   fb303::fbData->addStatExportType("decision.spf_runs", fb303::COUNT);
   fb303::fbData->addStatExportType("decision.errors", fb303::COUNT);
+
+  if (numSpfThreads > 0) {
+    spfExecutor_ = std::make_unique<folly::CPUThreadPoolExecutor>(
+        numSpfThreads, std::make_shared<folly::NamedThreadFactory>("SpfPool"));
+  }
 }
 
 SpfSolver::~SpfSolver() = default;
@@ -180,8 +202,15 @@ SpfSolver::createRouteForPrefixOrGetStaticRoute(
     folly::CIDRNetwork const& prefix) {
   // route output from `PrefixState` has higher priority over
   // static unicast routes
+  NextHopGroups nextHopGroups;
   if (auto maybeRoute = createRouteForPrefix(
-          myNodeName, areaLinkStates, prefixState, prefix)) {
+          myNodeName,
+          areaLinkStates,
+          prefixState,
+          prefix,
+          bestRoutesCache_,
+          bestRoutesMemo_,
+          nextHopGroups)) {
     return maybeRoute;
   }
 
@@ -198,8 +227,11 @@ SpfSolver::createRouteForPrefix(
     const std::string& myNodeName,
     std::unordered_map<std::string, LinkState> const& areaLinkStates,
     PrefixState const& prefixState,
-    folly::CIDRNetwork const& prefix) {
-  fb303::fbData->addStatValue("decision.get_route_for_prefix", 1, fb303::COUNT);
+    folly::CIDRNetwork const& prefix,
+    BestRoutesCache& bestRoutesCache,
+    BestRoutesMemo& bestRoutesMemo,
+    NextHopGroups& nextHopGroups) {
+  getRouteForPrefixStat_.add();
 
   // Sanity check for V4 prefixes
   const bool isV4Prefix = prefix.first.isV4();
@@ -215,12 +247,13 @@ SpfSolver::createRouteForPrefix(
 
   auto search = prefixState.prefixes().find(prefix);
   if (search == prefixState.prefixes().end()) {
+    bestRoutesMemo.erase(prefix);
     return std::nullopt;
   }
   auto const& allPrefixEntries = search->second;
 
   // Clear best route selection in prefix state
-  bestRoutesCache_.erase(prefix);
+  bestRoutesCache.erase(prefix);
 
   //
   // Create list of prefix-entries from reachable nodes only
@@ -300,8 +333,32 @@ SpfSolver::createRouteForPrefix(
     }
   }
 
-  auto routeSelectionResult = selectBestRoutes(
-      myNodeName, prefix, prefixEntries, hasBGP, areaLinkStates);
+  // [Best Route Memoization]
+  // bestRoutesMemo_ is only modified by the calling thread in between route
+  // builds, hence it can be safely read by concurrent route builds
+  RouteSelectionResult routeSelectionResult;
+  const auto memoKey = getBestRoutesMemoKey(prefixEntries, areaLinkStates);
+  BestRoutesMemoEntry const* memoEntry{nullptr};
+  auto memoIt = bestRoutesMemo_.find(prefix);
+  if (memoIt != bestRoutesMemo_.end() and memoIt->second.key == memoKey) {
+    bestRouteMemoHitsStat_.add();
+    memoEntry = &memoIt->second;
+    routeSelectionResult = memoEntry->result;
+  } else {
+    bestRouteMemoMissesStat_.add();
+    routeSelectionResult = selectBestRoutes(
+        myNodeName, prefix, prefixEntries, hasBGP, areaLinkStates);
+    BestRoutesMemoEntry newMemoEntry;
+    newMemoEntry.key = memoKey;
+    newMemoEntry.prefixEntries.reserve(prefixEntries.size());
+    for (auto const& [_, prefixEntry] : prefixEntries) {
+      newMemoEntry.prefixEntries.emplace_back(prefixEntry);
+    }
+    newMemoEntry.result = routeSelectionResult;
+    memoEntry =
+        &bestRoutesMemo.insert_or_assign(prefix, std::move(newMemoEntry))
+             .first->second;
+  }
   if (not routeSelectionResult.success) {
     return std::nullopt;
   }
@@ -313,7 +370,7 @@ SpfSolver::createRouteForPrefix(
   }
 
   // Set best route selection in prefix state
-  bestRoutesCache_.insert_or_assign(prefix, routeSelectionResult);
+  bestRoutesCache.insert_or_assign(prefix, routeSelectionResult);
 
   // Skip adding route for one prefix advertised by current node in all
   // following scenarios:
@@ -363,6 +420,7 @@ SpfSolver::createRouteForPrefix(
   //        - TODO: support this functionality for KSP2 forwarding algorithm
   //    - Combine shortest metric next-hops from all area
   std::unordered_set<thrift::NextHopThrift> totalNextHops;
+  std::unordered_set<thrift::NextHopThrift> totalBackupNextHops;
   std::unordered_set<thrift::NextHopThrift> ksp2NextHops;
   std::optional<int64_t> ucmpWeight;
   Metric shortestMetric = std::numeric_limits<Metric>::max();
@@ -382,16 +440,40 @@ SpfSolver::createRouteForPrefix(
     case thrift::PrefixForwardingAlgorithm::SP_ECMP:
     case thrift::PrefixForwardingAlgorithm::SP_UCMP_ADJ_WEIGHT_PROPAGATION:
     case thrift::PrefixForwardingAlgorithm::SP_UCMP_PREFIX_WEIGHT_PROPAGATION: {
-      auto spfAreaResults = selectBestPathsSpf(
-          myNodeName,
-          prefix,
-          routeSelectionResult,
-          prefixEntries,
-          hasBGP,
-          *areaRules.forwardingType_ref(),
-          area,
-          linkState->second,
-          *areaRules.forwardingAlgo_ref());
+      // [Area Results Cache] only recompute areas with changed LinkState or
+      // inputs. Memo of bestRoutesMemo_ is only read, updates are recorded in
+      // bestRoutesMemo, same as best route selection.
+      const auto linkStateVersion = linkState->second.getVersion();
+      const auto areaKey =
+          getAreaResultsMemoKey(routeSelectionResult, hasBGP, areaRules);
+      auto const* areaMemo = folly::get_ptr(memoEntry->areaResults, area);
+      SpfAreaResults spfAreaResults;
+      if (areaMemo and areaMemo->linkStateVersion == linkStateVersion and
+          areaMemo->key == areaKey) {
+        areaResultsMemoHitsStat_.add();
+        spfAreaResults = areaMemo->results;
+      } else {
+        areaResultsMemoMissesStat_.add();
+        spfAreaResults = selectBestPathsSpf(
+            myNodeName,
+            prefix,
+            routeSelectionResult,
+            prefixEntries,
+            hasBGP,
+            *areaRules.forwardingType_ref(),
+            area,
+            linkState->second,
+            *areaRules.forwardingAlgo_ref(),
+            nextHopGroups);
+        auto outMemoIt = bestRoutesMemo.find(prefix);
+        if (outMemoIt == bestRoutesMemo.end()) {
+          outMemoIt = bestRoutesMemo.emplace(prefix, *memoEntry).first;
+          memoEntry = &outMemoIt->second;
+        }
+        outMemoIt->second.areaResults.insert_or_assign(
+            area,
+            AreaResultsMemoEntry{linkStateVersion, areaKey, spfAreaResults});
+      }
       // Only use next-hops in areas with the shortest IGP metric
       //
       // TODO: bypass this code to allow UCMP paths between areas if
@@ -400,10 +482,12 @@ SpfSolver::createRouteForPrefix(
         if (shortestMetric > spfAreaResults.bestMetric) {
           shortestMetric = spfAreaResults.bestMetric;
           totalNextHops.clear();
+          totalBackupNextHops.clear();
           ucmpWeight = std::nullopt;
         }
         totalNextHops.insert(
             spfAreaResults.nextHops.begin(), spfAreaResults.nextHops.end());
+        totalBackupNextHops.merge(spfAreaResults.backupNextHops);
 
         if (not ucmpWeight) {
           ucmpWeight = spfAreaResults.ucmpWeight;
@@ -442,7 +526,12 @@ SpfSolver::createRouteForPrefix(
     totalNextHops.insert(ksp2NextHops.begin(), ksp2NextHops.end());
   }
 
-  return addBestPaths(
+  // [LFA] alternates are only meant for routes forwarded over IP by SPF
+  if (not ksp2NextHops.empty()) {
+    totalBackupNextHops.clear();
+  }
+
+  auto maybeRoute = addBestPaths(
       myNodeName,
       prefix,
       routeSelectionResult,
@@ -451,6 +540,10 @@ SpfSolver::createRouteForPrefix(
       std::move(totalNextHops),
       shortestMetric,
       ucmpWeight);
+  if (maybeRoute.has_value()) {
+    maybeRoute->backupNexthops = std::move(totalBackupNextHops);
+  }
+  return maybeRoute;
 
   // SrPolicy TODO: (T94500292) before returning need to apply prepend label
   // rules. Prepend label rules, may create a new MPLS route (RibMplsEntry)
@@ -478,11 +571,43 @@ SpfSolver::buildRouteDb(
   // Clear best route selection cache
   bestRoutesCache_.clear();
 
+  // Drop memoized best route selection of withdrawn prefixes
+  for (auto it = bestRoutesMemo_.begin(); it != bestRoutesMemo_.end();) {
+    if (prefixState.prefixes().count(it->first)) {
+      ++it;
+    } else {
+      it = bestRoutesMemo_.erase(it);
+    }
+  }
+
+  computeSpfResults(myNodeName, areaLinkStates, prefixState);
+
+  // [Rebuild Arena] temporaries of this build, released at once upon return.
+  // MUST outlive all containers allocated from it.
+  std::pmr::monotonic_buffer_resource rebuildArena{kRebuildArenaInitialBytes};
+
   // Create IPv4, IPv6 routes (includes IP -> MPLS routes)
-  for (const auto& [prefix, _] : prefixState.prefixes()) {
-    if (auto maybeRoute = createRouteForPrefix(
-            myNodeName, areaLinkStates, prefixState, prefix)) {
-      routeDb.addUnicastRoute(std::move(maybeRoute).value());
+  NextHopGroups nextHopGroups{&rebuildArena};
+  if (spfExecutor_) {
+    createRoutesForPrefixes(
+        myNodeName,
+        areaLinkStates,
+        prefixState,
+        routeDb,
+        nextHopGroups,
+        &rebuildArena);
+  } else {
+    for (const auto& [prefix, _] : prefixState.prefixes()) {
+      if (auto maybeRoute = createRouteForPrefix(
+              myNodeName,
+              areaLinkStates,
+              prefixState,
+              prefix,
+              bestRoutesCache_,
+              bestRoutesMemo_,
+              nextHopGroups)) {
+        routeDb.addUnicastRoute(std::move(maybeRoute).value());
+      }
     }
   }
 
@@ -495,10 +620,52 @@ SpfSolver::buildRouteDb(
     routeDb.addUnicastRoute(RibUnicastEntry(ribUnicastEntry));
   }
 
+  // Create MPLS routes
+  routeDb.mplsRoutes =
+      buildMplsRoutes(myNodeName, areaLinkStates, nextHopGroups);
+  fb303::fbData->addStatValue(
+      "decision.next_hop_groups", nextHopGroups.size(), fb303::AVG);
+
+  auto deltaTime = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - startTime);
+  XLOG(INFO) << "Decision::buildRouteDb took " << deltaTime.count() << "ms.";
+  fb303::fbData->addStatValue(
+      "decision.route_build_ms", deltaTime.count(), fb303::AVG);
+  return routeDb;
+} // buildRouteDb
+
+std::unordered_map<int32_t, RibMplsEntry>
+SpfSolver::buildMplsRoutes(
+    const std::string& myNodeName,
+    std::unordered_map<std::string, LinkState> const& areaLinkStates) {
+  NextHopGroups nextHopGroups;
+  return buildMplsRoutes(myNodeName, areaLinkStates, nextHopGroups);
+}
+
+std::unordered_map<int32_t, RibMplsEntry>
+SpfSolver::buildMplsRoutes(
+    const std::string& myNodeName,
+    std::unordered_map<std::string, LinkState> const& areaLinkStates,
+    NextHopGroups& nextHopGroups) {
+  DecisionRouteDb routeDb{};
+
+  // [MPLS Routes Memo] key of local adjacencies per area
+  std::unordered_map<std::string, uint64_t> localAdjacenciesKeys;
+  if (enableNodeSegmentLabel_ or enableAdjacencyLabels_) {
+    for (const auto& [area, linkState] : areaLinkStates) {
+      localAdjacenciesKeys.emplace(
+          area, getLocalAdjacenciesKey(myNodeName, linkState));
+    }
+  }
+  size_t numMemoHits{0};
+  size_t numMemoMisses{0};
+
   //
   // Create MPLS routes for all nodeLabel
   //
   if (enableNodeSegmentLabel_) {
+    // entries of nodes whose label route is built, the rest is dropped
+    decltype(nodeLabelRoutesMemo_) nodeLabelRoutesMemo;
     std::unordered_map<int32_t, std::pair<std::string, RibMplsEntry>>
         labelToNode;
     for (const auto& [area, linkState] : areaLinkStates) {
@@ -553,11 +720,13 @@ SpfSolver::buildRouteDb(
         }
 
         // Get best nexthop towards the node
-        auto metricNhs = getNextHopsWithMetric(
-            myNodeName,
-            {{adjDb.thisNodeName_ref().value(), area}},
-            false,
-            linkState);
+        auto const& metricNhs = getNextHopGroup(
+                                    myNodeName,
+                                    {{adjDb.thisNodeName_ref().value(), area}},
+                                    area,
+                                    linkState,
+                                    nextHopGroups)
+                                    .nextHopsWithMetric;
         if (metricNhs.second.empty()) {
           XLOG(WARNING) << "No route to nodeLabel " << std::to_string(topLabel)
                         << " of node " << nodeName;
@@ -566,31 +735,55 @@ SpfSolver::buildRouteDb(
           continue;
         }
 
-        // Create nexthops with appropriate MplsAction (PHP and SWAP). Note
-        // that all nexthops are valid for routing without loops. Fib is
-        // responsible for installing these routes by making sure it programs
-        // least cost nexthops first and of same action type (based on HW
-        // limitations)
+        // [MPLS Routes Memo] sum of mixed hashes doesn't depend on iteration
+        // order of next-hops
+        uint64_t key = folly::hash::hash_combine(
+            topLabel, localAdjacenciesKeys.at(area), metricNhs.first);
+        for (const auto& [nextHop, metric] : metricNhs.second) {
+          key += folly::hash::twang_mix64(
+              folly::hash::hash_combine(nextHop.first, nextHop.second, metric));
+        }
+        const NodeAndArea nodeAndArea{nodeName, area};
+        auto memoIt = nodeLabelRoutesMemo_.find(nodeAndArea);
+        if (memoIt != nodeLabelRoutesMemo_.end() and
+            memoIt->second.key == key) {
+          ++numMemoHits;
+        } else {
+          ++numMemoMisses;
+          // Create nexthops with appropriate MplsAction (PHP and SWAP). Note
+          // that all nexthops are valid for routing without loops. Fib is
+          // responsible for installing these routes by making sure it
+          // programs least cost nexthops first and of same action type (based
+          // on HW limitations)
+          MplsRoutesMemoEntry entry;
+          entry.key = key;
+          entry.routes.emplace_back(
+              topLabel,
+              getNextHopsThrift(
+                  myNodeName,
+                  {{nodeName, area}},
+                  false /* isV4 */,
+                  v4OverV6Nexthop_,
+                  false /* perDestination */,
+                  metricNhs.first,
+                  metricNhs.second,
+                  topLabel,
+                  area,
+                  linkState));
+          memoIt = nodeLabelRoutesMemo_
+                       .insert_or_assign(nodeAndArea, std::move(entry))
+                       .first;
+        }
+        const auto& memoEntry =
+            nodeLabelRoutesMemo.emplace(nodeAndArea, std::move(memoIt->second))
+                .first->second;
+
         labelToNode.erase(topLabel);
         labelToNode.emplace(
-            topLabel,
-            std::make_pair(
-                adjDb.thisNodeName_ref().value(),
-                RibMplsEntry(
-                    topLabel,
-                    getNextHopsThrift(
-                        myNodeName,
-                        {{adjDb.thisNodeName_ref().value(), area}},
-                        false /* isV4 */,
-                        v4OverV6Nexthop_,
-                        false /* perDestination */,
-                        metricNhs.first,
-                        metricNhs.second,
-                        topLabel,
-                        area,
-                        linkState))));
+            topLabel, std::make_pair(nodeName, memoEntry.routes.front()));
       }
     }
+    nodeLabelRoutesMemo_ = std::move(nodeLabelRoutesMemo);
 
     for (auto& [_, nodeToEntry] : labelToNode) {
       routeDb.addMplsRoute(std::move(nodeToEntry.second));
@@ -601,7 +794,23 @@ SpfSolver::buildRouteDb(
   // Create MPLS routes for all of our adjacencies
   //
   if (enableAdjacencyLabels_) {
-    for (const auto& [_, linkState] : areaLinkStates) {
+    // entries of areas present, the rest is dropped
+    decltype(adjLabelRoutesMemo_) adjLabelRoutesMemo;
+    for (const auto& [area, linkState] : areaLinkStates) {
+      const auto key = localAdjacenciesKeys.at(area);
+      auto memoIt = adjLabelRoutesMemo_.find(area);
+      if (memoIt != adjLabelRoutesMemo_.end() and memoIt->second.key == key) {
+        ++numMemoHits;
+        for (const auto& route : memoIt->second.routes) {
+          routeDb.addMplsRoute(RibMplsEntry(route));
+        }
+        adjLabelRoutesMemo.emplace(area, std::move(memoIt->second));
+        continue;
+      }
+      ++numMemoMisses;
+
+      auto& entry = adjLabelRoutesMemo[area];
+      entry.key = key;
       for (const auto& link : linkState.linksFromNode(myNodeName)) {
         const auto topLabel = link->getAdjLabelFromNode(myNodeName);
         // Top label is not set => Non-SR mode
@@ -617,18 +826,24 @@ SpfSolver::buildRouteDb(
           continue;
         }
 
-        routeDb.addMplsRoute(RibMplsEntry(
+        entry.routes.emplace_back(
             topLabel,
-            {createNextHop(
+            std::unordered_set<thrift::NextHopThrift>{createNextHop(
                 link->getNhV6FromNode(myNodeName),
                 link->getIfaceFromNode(myNodeName),
                 link->getMetricFromNode(myNodeName),
                 createMplsAction(thrift::MplsActionCode::PHP),
                 link->getArea(),
-                link->getOtherNodeName(myNodeName))}));
+                link->getOtherNodeName(myNodeName))});
+        routeDb.addMplsRoute(RibMplsEntry(entry.routes.back()));
       }
     }
+    adjLabelRoutesMemo_ = std::move(adjLabelRoutesMemo);
   }
+  fb303::fbData->addStatValue(
+      "decision.mpls_routes_memo_hits", numMemoHits, fb303::COUNT);
+  fb303::fbData->addStatValue(
+      "decision.mpls_routes_memo_misses", numMemoMisses, fb303::COUNT);
 
   //
   // Add MPLS static routes
@@ -637,13 +852,179 @@ SpfSolver::buildRouteDb(
     routeDb.addMplsRoute(RibMplsEntry(mplsEntry));
   }
 
+  return std::move(routeDb.mplsRoutes);
+}
+
+void
+SpfSolver::computeSpfResults(
+    const std::string& myNodeName,
+    std::unordered_map<std::string, LinkState> const& areaLinkStates,
+    PrefixState const& prefixState) {
+  const auto startTime = std::chrono::steady_clock::now();
+
+  // own SPF result of every area, along with the ones of neighbors looked
+  // up for [LFA]. Results of one area are memoized by a single thread.
+  // Computed lazily if there is no pool.
+  if (spfExecutor_) {
+    std::vector<folly::Future<folly::Unit>> futures;
+    for (auto const& [area, linkState] : areaLinkStates) {
+      futures.emplace_back(folly::via(
+          spfExecutor_.get(), [this, &linkState = linkState, &myNodeName]() {
+            linkState.getSpfResult(myNodeName);
+            if (enableLfa_) {
+              for (auto const& link : linkState.linksFromNode(myNodeName)) {
+                linkState.getSpfResult(link->getOtherNodeName(myNodeName));
+              }
+            }
+          }));
+    }
+    folly::collect(std::move(futures)).get();
+  }
+
+  // nodes advertising prefixes which may be forwarded with KSP2. Paths are
+  // looked up towards them in every area, see selectBestPathsKsp2().
+  std::set<std::string> ksp2Nodes;
+  for (auto const& prefix : prefixState.ksp2Prefixes()) {
+    for (auto const& [nodeArea, _] : prefixState.prefixes().at(prefix)) {
+      ksp2Nodes.emplace(nodeArea.first);
+    }
+  }
+  // memoize KSP2 paths in batch, inline if there is no pool
+  if (not ksp2Nodes.empty()) {
+    const std::vector<std::string> dests(ksp2Nodes.begin(), ksp2Nodes.end());
+    folly::Executor& executor = spfExecutor_
+        ? static_cast<folly::Executor&>(*spfExecutor_)
+        : folly::InlineExecutor::instance();
+    for (auto const& [area, linkState] : areaLinkStates) {
+      linkState.computeKthPaths(myNodeName, dests, 2, executor);
+    }
+  }
+
   auto deltaTime = std::chrono::duration_cast<std::chrono::milliseconds>(
       std::chrono::steady_clock::now() - startTime);
-  XLOG(INFO) << "Decision::buildRouteDb took " << deltaTime.count() << "ms.";
   fb303::fbData->addStatValue(
-      "decision.route_build_ms", deltaTime.count(), fb303::AVG);
-  return routeDb;
-} // buildRouteDb
+      "decision.spf_precompute_ms", deltaTime.count(), fb303::AVG);
+}
+
+void
+SpfSolver::createRoutesForPrefixes(
+    const std::string& myNodeName,
+    std::unordered_map<std::string, LinkState> const& areaLinkStates,
+    PrefixState const& prefixState,
+    DecisionRouteDb& routeDb,
+    NextHopGroups& nextHopGroups,
+    std::pmr::memory_resource* arena) {
+  std::pmr::vector<folly::CIDRNetwork const*> prefixes{arena};
+  prefixes.reserve(prefixState.prefixes().size());
+  for (auto const& [prefix, _] : prefixState.prefixes()) {
+    prefixes.emplace_back(&prefix);
+  }
+  if (prefixes.empty()) {
+    return;
+  }
+
+  // routes and best route selections of a shard of prefixes. Routes and
+  // next-hop groups are allocated from the arena of the fragment, declared
+  // first so that it is released last.
+  struct RouteDbFragment {
+    std::unique_ptr<std::pmr::monotonic_buffer_resource> arena{
+        std::make_unique<std::pmr::monotonic_buffer_resource>()};
+    std::pmr::vector<RibUnicastEntry> unicastRoutes{arena.get()};
+    BestRoutesCache bestRoutes;
+    BestRoutesMemo bestRoutesMemo;
+    NextHopGroups nextHopGroups{arena.get()};
+  };
+
+  const size_t numShards = std::min(
+      prefixes.size(), spfExecutor_->numThreads() * kPrefixShardsPerThread);
+  const size_t shardSize = (prefixes.size() + numShards - 1) / numShards;
+  std::vector<folly::Future<RouteDbFragment>> futures;
+  for (size_t begin = 0; begin < prefixes.size(); begin += shardSize) {
+    const size_t end = std::min(begin + shardSize, prefixes.size());
+    futures.emplace_back(folly::via(spfExecutor_.get(), [&, begin, end]() {
+      RouteDbFragment fragment;
+      for (size_t i = begin; i < end; ++i) {
+        if (auto maybeRoute = createRouteForPrefix(
+                myNodeName,
+                areaLinkStates,
+                prefixState,
+                *prefixes[i],
+                fragment.bestRoutes,
+                fragment.bestRoutesMemo,
+                fragment.nextHopGroups)) {
+          fragment.unicastRoutes.emplace_back(std::move(maybeRoute).value());
+        }
+      }
+      return fragment;
+    }));
+  }
+
+  // every prefix belongs to exactly one shard, hence fragments are disjoint
+  for (auto& fragment : folly::collect(std::move(futures)).get()) {
+    for (auto& route : fragment.unicastRoutes) {
+      routeDb.addUnicastRoute(std::move(route));
+    }
+    bestRoutesCache_.merge(fragment.bestRoutes);
+    for (auto& [prefix, memoEntry] : fragment.bestRoutesMemo) {
+      bestRoutesMemo_.insert_or_assign(prefix, std::move(memoEntry));
+    }
+    // groups of the same key are equal, keep any of them. Groups are moved
+    // rather than spliced, as fragments allocate from arenas of their own.
+    for (auto& [key, group] : fragment.nextHopGroups) {
+      nextHopGroups.try_emplace(key, std::move(group));
+    }
+  }
+}
+
+uint64_t
+SpfSolver::getBestRoutesMemoKey(
+    PrefixEntries const& prefixEntries,
+    std::unordered_map<std::string, LinkState> const& areaLinkStates) {
+  // sum of mixed hashes doesn't depend on iteration order
+  uint64_t key = prefixEntries.size();
+  for (auto const& [nodeAndArea, prefixEntry] : prefixEntries) {
+    auto const& [node, area] = nodeAndArea;
+    auto linkStateIt = areaLinkStates.find(area);
+    const bool isOverloaded = linkStateIt != areaLinkStates.end() and
+        linkStateIt->second.isNodeOverloaded(node);
+    key += folly::hash::twang_mix64(folly::hash::hash_combine(
+        node, area, prefixEntry.get(), isOverloaded));
+  }
+  return key;
+}
+
+uint64_t
+SpfSolver::getLocalAdjacenciesKey(
+    const std::string& myNodeName, const LinkState& linkState) {
+  // sum of mixed hashes doesn't depend on iteration order
+  uint64_t key = linkState.linksFromNode(myNodeName).size();
+  for (const auto& link : linkState.linksFromNode(myNodeName)) {
+    key += folly::hash::twang_mix64(folly::hash::hash_combine(
+        link->getOtherNodeName(myNodeName),
+        link->getIfaceFromNode(myNodeName),
+        std::hash<thrift::BinaryAddress>()(link->getNhV6FromNode(myNodeName)),
+        link->getMetricFromNode(myNodeName),
+        link->getAdjLabelFromNode(myNodeName),
+        link->isUp()));
+  }
+  return key;
+}
+
+uint64_t
+SpfSolver::getAreaResultsMemoKey(
+    RouteSelectionResult const& routeSelectionResult,
+    bool isBgp,
+    thrift::AreaPathComputationRules const& areaRules) {
+  uint64_t key = folly::hash::hash_combine(
+      isBgp,
+      static_cast<int>(*areaRules.forwardingType_ref()),
+      static_cast<int>(*areaRules.forwardingAlgo_ref()));
+  // selected routes are ordered
+  for (auto const& [node, area] : routeSelectionResult.allNodeAreas) {
+    key = folly::hash::hash_combine(key, node, area);
+  }
+  return key;
+}
 
 RouteSelectionResult
 SpfSolver::selectBestRoutes(
@@ -736,9 +1117,10 @@ SpfSolver::runBestPathSelectionBgp(
     PrefixEntries const& prefixEntries,
     std::unordered_map<std::string, LinkState> const& areaLinkStates) {
   RouteSelectionResult ret;
-  std::optional<thrift::MetricVector> bestVector;
+  // metric vectors of prefix entries are sorted by PrefixState already
+  const thrift::MetricVector* bestVector{nullptr};
   for (auto const& [nodeAndArea, prefixEntry] : prefixEntries) {
-    switch (bestVector.has_value()
+    switch (bestVector
                 ? MetricVectorUtils::compareMetricVectors(
                       can_throw(*prefixEntry->mv_ref()), *bestVector)
                 : MetricVectorUtils::CompareResult::WINNER) {
@@ -746,7 +1128,7 @@ SpfSolver::runBestPathSelectionBgp(
       ret.allNodeAreas.clear();
       FOLLY_FALLTHROUGH;
     case MetricVectorUtils::CompareResult::TIE_WINNER:
-      bestVector = can_throw(*prefixEntry->mv_ref());
+      bestVector = &can_throw(*prefixEntry->mv_ref());
       ret.bestNodeArea = nodeAndArea;
       FOLLY_FALLTHROUGH;
     case MetricVectorUtils::CompareResult::TIE_LOOSER:
@@ -778,7 +1160,8 @@ SpfSolver::selectBestPathsSpf(
     thrift::PrefixForwardingType const& forwardingType,
     const std::string& area,
     const LinkState& linkState,
-    thrift::PrefixForwardingAlgorithm fwdingAlgo) {
+    thrift::PrefixForwardingAlgorithm fwdingAlgo,
+    NextHopGroups& nextHopGroups) {
   SpfAreaResults result;
   const bool isV4Prefix = prefix.first.isV4();
   const bool perDestination =
@@ -801,9 +1184,17 @@ SpfSolver::selectBestPathsSpf(
     }
   }
 
-  // Get next-hops
-  const auto nextHopsWithMetric = getNextHopsWithMetric(
-      myNodeName, filteredBestNodeAreas, perDestination, linkState);
+  // Get next-hops. Shared through next-hop group unless per destination.
+  NextHopGroup perDestinationGroup;
+  if (perDestination) {
+    perDestinationGroup.nextHopsWithMetric = getNextHopsWithMetric(
+        myNodeName, filteredBestNodeAreas, perDestination, linkState);
+  }
+  auto& nextHopGroup = perDestination
+      ? perDestinationGroup
+      : getNextHopGroup(
+            myNodeName, filteredBestNodeAreas, area, linkState, nextHopGroups);
+  auto const& nextHopsWithMetric = nextHopGroup.nextHopsWithMetric;
   result.bestMetric = nextHopsWithMetric.first;
   if (nextHopsWithMetric.second.empty()) {
     XLOG(DBG3) << "No route to prefix "
@@ -827,19 +1218,44 @@ SpfSolver::selectBestPathsSpf(
     result.ucmpWeight = maybeUcmpResult->weight();
   }
 
-  result.nextHops = getNextHopsThrift(
-      myNodeName,
-      routeSelectionResult.allNodeAreas,
-      isV4Prefix,
-      v4OverV6Nexthop_,
-      perDestination,
-      nextHopsWithMetric.first,
-      nextHopsWithMetric.second,
-      std::nullopt /* swapLabel */,
-      area,
-      linkState,
-      prefixEntries,
-      maybeUcmpResult);
+  // IP next-hops towards the same nodes only depend on the address family
+  auto& sharedNextHops = (isV4Prefix and not v4OverV6Nexthop_)
+      ? nextHopGroup.nextHopsV4
+      : nextHopGroup.nextHopsV6;
+  if (perDestination or maybeUcmpResult or not sharedNextHops.has_value()) {
+    result.nextHops = getNextHopsThrift(
+        myNodeName,
+        routeSelectionResult.allNodeAreas,
+        isV4Prefix,
+        v4OverV6Nexthop_,
+        perDestination,
+        nextHopsWithMetric.first,
+        nextHopsWithMetric.second,
+        std::nullopt /* swapLabel */,
+        area,
+        linkState,
+        prefixEntries,
+        maybeUcmpResult);
+    if (not perDestination and not maybeUcmpResult) {
+      sharedNextHops = result.nextHops;
+    }
+  } else {
+    result.nextHops = *sharedNextHops;
+  }
+
+  // [LFA] only protect routes forwarded over IP with ECMP
+  if (enableLfa_ and not perDestination and
+      fwdingAlgo == thrift::PrefixForwardingAlgorithm::SP_ECMP and
+      not result.nextHops.empty()) {
+    result.backupNextHops = getLfaNextHopsThrift(
+        myNodeName,
+        filteredBestNodeAreas,
+        isV4Prefix and not v4OverV6Nexthop_,
+        nextHopsWithMetric.first,
+        nextHopsWithMetric.second,
+        area,
+        linkState);
+  }
 
   return result;
 }
@@ -1088,6 +1504,84 @@ SpfSolver::getNextHopsWithMetric(
   return std::make_pair(shortestMetric, nextHopNodes);
 }
 
+SpfSolver::NextHopGroup&
+SpfSolver::getNextHopGroup(
+    const std::string& myNodeName,
+    const std::set<NodeAndArea>& dstNodeAreas,
+    const std::string& area,
+    const LinkState& linkState,
+    NextHopGroups& nextHopGroups) {
+  auto [it, inserted] =
+      nextHopGroups.try_emplace(NextHopGroupKey(area, dstNodeAreas));
+  if (inserted) {
+    it->second.nextHopsWithMetric = getNextHopsWithMetric(
+        myNodeName, dstNodeAreas, false /* perDestination */, linkState);
+  }
+  return it->second;
+}
+
+std::unordered_set<thrift::NextHopThrift>
+SpfSolver::getLfaNextHopsThrift(
+    const std::string& myNodeName,
+    const std::set<NodeAndArea>& dstNodeAreas,
+    bool isV4,
+    const Metric minMetric,
+    std::unordered_map<std::pair<std::string, std::string>, Metric> const&
+        nextHopNodes,
+    const std::string& area,
+    const LinkState& linkState) const {
+  std::unordered_set<std::string> primaryNodes;
+  for (auto const& [nodes, _] : nextHopNodes) {
+    primaryNodes.emplace(nodes.first);
+  }
+
+  std::unordered_set<thrift::NextHopThrift> backupNextHops;
+  for (const auto& link : linkState.linksFromNode(myNodeName)) {
+    const auto& neighborNode = link->getOtherNodeName(myNodeName);
+    if (not link->isUp() or primaryNodes.count(neighborNode)) {
+      continue;
+    }
+
+    auto const& neighborSpfResult = linkState.getSpfResult(neighborNode);
+    auto const myIt = neighborSpfResult.find(myNodeName);
+    if (myIt == neighborSpfResult.end()) {
+      continue;
+    }
+    Metric neighborToDst = std::numeric_limits<Metric>::max();
+    for (const auto& [dstNode, dstArea] : dstNodeAreas) {
+      if (dstArea != area) {
+        continue;
+      }
+      auto const dstIt = neighborSpfResult.find(dstNode);
+      if (dstIt != neighborSpfResult.end()) {
+        neighborToDst = std::min(neighborToDst, dstIt->second.metric());
+      }
+    }
+    if (neighborToDst == std::numeric_limits<Metric>::max()) {
+      continue;
+    }
+
+    // RFC 5286 inequality 1. Otherwise neighbor loops traffic back.
+    if (neighborToDst >= myIt->second.metric() + minMetric) {
+      continue;
+    }
+    // overloaded neighbor does not carry transit traffic
+    if (neighborToDst > 0 and linkState.isNodeOverloaded(neighborNode)) {
+      continue;
+    }
+
+    backupNextHops.emplace(createNextHop(
+        isV4 ? link->getNhV4FromNode(myNodeName)
+             : link->getNhV6FromNode(myNodeName),
+        link->getIfaceFromNode(myNodeName),
+        link->getMetricFromNode(myNodeName) + neighborToDst,
+        std::nullopt /* mplsAction */,
+        area,
+        neighborNode));
+  }
+  return backupNextHops;
+}
+
 std::optional<LinkState::NodeUcmpResult>
 SpfSolver::getNodeUcmpResult(
     const std::string& myNodeName,
@@ -1146,8 +1640,18 @@ SpfSolver::getNodeUcmpResult(
 
   // Resolve UCMP weights. This API returns the UCMP results
   // for all nodes in the SPF graph.
-  auto ucmpResults = linkState.resolveUcmpWeights(
-      linkState.getSpfResult(myNodeName), dstWeights, fwdingAlgo);
+  //
+  // Prefixes advertised by the same set of nodes with the same weights share
+  // the memoized result. Routes built on the SPF thread pool only read the
+  // LinkState, hence resolve weights without memoizing them.
+  std::optional<LinkState::UcmpResult> ucmpResultsStorage;
+  if (spfExecutor_) {
+    ucmpResultsStorage = linkState.resolveUcmpWeights(
+        linkState.getSpfResult(myNodeName), dstWeights, fwdingAlgo);
+  }
+  auto const& ucmpResults = ucmpResultsStorage.has_value()
+      ? *ucmpResultsStorage
+      : linkState.getUcmpResult(myNodeName, dstWeights, fwdingAlgo);
 
   // Find the UCMP results for the local node. This should never
   // fail
@@ -1157,7 +1661,7 @@ SpfSolver::getNodeUcmpResult(
     return std::nullopt;
   }
 
-  return std::move(myNodeResultIt->second);
+  return myNodeResultIt->second;
 }
 
 // TODO Let's use strong-types for the bools to detect any abusement at the
@@ -8,9 +8,15 @@
 #pragma once
 
 #include <chrono>
+#include <memory>
+#include <memory_resource>
 #include <string>
 #include <unordered_map>
 
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/executors/thread_factory/NamedThreadFactory.h>
+
+#include <openr/common/ThreadLocalStats.h>
 #include <openr/decision/LinkState.h>
 #include <openr/decision/PrefixState.h>
 #include <openr/decision/RibEntry.h>
@@ -110,7 +116,9 @@ class SpfSolver {
       bool enableBgpRouteProgramming = false,
       bool enableBestRouteSelection = false,
       bool v4OverV6Nexthop = false,
-      bool enableUcmp = false);
+      bool enableUcmp = false,
+      size_t numSpfThreads = 0,
+      bool enableLfa = false);
   ~SpfSolver();
 
   //
@@ -134,6 +142,12 @@ class SpfSolver {
       std::unordered_map<std::string, LinkState> const& areaLinkStates,
       PrefixState const& prefixState);
 
+  // Build MPLS routes of node and adjacency labels, including static MPLS
+  // routes, for a given router, myNodeName
+  std::unordered_map<int32_t, RibMplsEntry> buildMplsRoutes(
+      const std::string& myNodeName,
+      std::unordered_map<std::string, LinkState> const& areaLinkStates);
+
   std::optional<RibUnicastEntry> createRouteForPrefixOrGetStaticRoute(
       const std::string& myNodeName,
       std::unordered_map<std::string, LinkState> const& areaLinkStates,
@@ -145,6 +159,20 @@ class SpfSolver {
     return bestRoutesCache_;
   }
 
+  // [Memory Governor] drop memoized best route selections, see
+  // [Best Route Memoization]. Best routes cache is kept for ctrl APIs.
+  void
+  clearBestRoutesMemo() {
+    bestRoutesMemo_.clear();
+  }
+
+  // [Memory Governor] drop memoized label routes, see [MPLS Routes Memo]
+  void
+  clearMplsRoutesMemo() {
+    adjLabelRoutesMemo_.clear();
+    nodeLabelRoutesMemo_.clear();
+  }
+
   // Walk all SR Policies and return the route computation rules of the first
   // one that matches. If none of them match then the default route computation
   // rules are returned
@@ -158,16 +186,8 @@ class SpfSolver {
   SpfSolver(SpfSolver const&) = delete;
   SpfSolver& operator=(SpfSolver const&) = delete;
 
-  std::optional<RibUnicastEntry> createRouteForPrefix(
-      const std::string& myNodeName,
-      std::unordered_map<std::string, LinkState> const& areaLinkStates,
-      PrefixState const& prefixState,
-      folly::CIDRNetwork const& prefix);
-
-  static std::pair<openr::LinkStateMetric, std::unordered_set<std::string>>
-  getMinCostNodes(
-      const LinkState::SpfResult& spfResult,
-      const std::set<NodeAndArea>& dstNodeAreas);
+  using BestRoutesCache =
+      std::unordered_map<folly::CIDRNetwork, RouteSelectionResult>;
 
   // Structure which holds the results of per area spf next-hop selection
   // for a single prefix
@@ -178,8 +198,171 @@ class SpfSolver {
     std::optional<int64_t> ucmpWeight{std::nullopt};
     // selected next-hops within the area
     std::unordered_set<thrift::NextHopThrift> nextHops;
+    // [LFA] loop-free alternates of next-hops within the area
+    std::unordered_set<thrift::NextHopThrift> backupNextHops;
   };
 
+  /*
+   * [Area Results Cache]
+   *
+   * SPF next-hop selection of a prefix within an area only depends on its
+   * advertisements, the routes selected among them, its forwarding rules in
+   * the area and the LinkState of the area. Results are memoized per area
+   * along with best route selection, keyed by LinkState version and a hash of
+   * the rest. Hence on nodes in many areas, a change within one area only
+   * recomputes contributions of that area before merging them across areas.
+   */
+  struct AreaResultsMemoEntry {
+    uint64_t linkStateVersion{0};
+    uint64_t key{0};
+    SpfAreaResults results;
+  };
+
+  /*
+   * [Best Route Memoization]
+   *
+   * Best route selection of a prefix only depends on its reachable
+   * advertisements and on overload state of their advertisers. Selection is
+   * memoized per prefix, keyed by an order-independent hash of [node, area],
+   * prefix entry object and overload bit of every advertisement. PrefixState
+   * replaces the entry object upon any attribute change, and memo pins the
+   * entry objects, hence their addresses are never reused while memoized.
+   */
+  struct BestRoutesMemoEntry {
+    uint64_t key{0};
+    std::vector<std::shared_ptr<thrift::PrefixEntry>> prefixEntries;
+    RouteSelectionResult result;
+    // [Area Results Cache] SPF next-hop selection per area
+    std::unordered_map<std::string /* area */, AreaResultsMemoEntry>
+        areaResults;
+  };
+  using BestRoutesMemo =
+      std::unordered_map<folly::CIDRNetwork, BestRoutesMemoEntry>;
+
+  /*
+   * [MPLS Routes Memo]
+   *
+   * Adjacency label routes only depend on the adjacencies of this node within
+   * an area, and the node label route towards a node on its label, these
+   * adjacencies and SPF next-hops towards it. Routes are memoized per area
+   * and per node respectively, keyed by a hash of these inputs, hence a route
+   * build only recreates label routes whose inputs changed. Entries of
+   * withdrawn labels are dropped along with each build.
+   */
+  struct MplsRoutesMemoEntry {
+    uint64_t key{0};
+    std::vector<RibMplsEntry> routes;
+  };
+
+  /*
+   * [Next-Hop Groups]
+   *
+   * Next-hops towards a set of destination nodes within an area, computed
+   * once per route build and shared by unicast routes of all prefixes
+   * advertised by these nodes, as well as by node label routes towards them.
+   * IP next-hops are shared by routes without per-destination labels or UCMP
+   * weights only. Groups are only valid as long as LinkStates don't change.
+   */
+  struct NextHopGroup {
+    // getNextHopsWithMetric() without per-destination next-hops
+    std::pair<
+        LinkStateMetric,
+        std::unordered_map<
+            std::pair<std::string /* nextHopNodeName */, std::string>,
+            LinkStateMetric>>
+        nextHopsWithMetric;
+    // IP next-hops over v4 and v6 addresses, set upon first use
+    std::optional<std::unordered_set<thrift::NextHopThrift>> nextHopsV4;
+    std::optional<std::unordered_set<thrift::NextHopThrift>> nextHopsV6;
+  };
+  // [area, destination nodes]
+  using NextHopGroupKey = std::pair<std::string, std::set<NodeAndArea>>;
+  // allocated from the arena of the route build, see [Rebuild Arena]
+  using NextHopGroups = std::pmr::map<NextHopGroupKey, NextHopGroup>;
+
+  // [Next-Hop Groups] group towards dstNodeAreas, created if missing
+  NextHopGroup& getNextHopGroup(
+      const std::string& myNodeName,
+      const std::set<NodeAndArea>& dstNodeAreas,
+      const std::string& area,
+      const LinkState& linkState,
+      NextHopGroups& nextHopGroups);
+
+  // create route for prefix and record its best route selection in
+  // bestRoutesCache. Best route selection and per area SPF results are looked
+  // up in bestRoutesMemo_, and recorded in bestRoutesMemo if missing or stale.
+  // Next-hops are shared through nextHopGroups.
+  std::optional<RibUnicastEntry> createRouteForPrefix(
+      const std::string& myNodeName,
+      std::unordered_map<std::string, LinkState> const& areaLinkStates,
+      PrefixState const& prefixState,
+      folly::CIDRNetwork const& prefix,
+      BestRoutesCache& bestRoutesCache,
+      BestRoutesMemo& bestRoutesMemo,
+      NextHopGroups& nextHopGroups);
+
+  // buildMplsRoutes() with node label next-hops shared through nextHopGroups
+  std::unordered_map<int32_t, RibMplsEntry> buildMplsRoutes(
+      const std::string& myNodeName,
+      std::unordered_map<std::string, LinkState> const& areaLinkStates,
+      NextHopGroups& nextHopGroups);
+
+  // [Best Route Memoization] key of the advertisement set
+  static uint64_t getBestRoutesMemoKey(
+      PrefixEntries const& prefixEntries,
+      std::unordered_map<std::string, LinkState> const& areaLinkStates);
+
+  // [MPLS Routes Memo] key of the adjacencies of myNodeName within the area
+  static uint64_t getLocalAdjacenciesKey(
+      const std::string& myNodeName, const LinkState& linkState);
+
+  // [Area Results Cache] key of the SPF next-hop selection inputs within an
+  // area, other than advertisements and LinkState
+  static uint64_t getAreaResultsMemoKey(
+      RouteSelectionResult const& routeSelectionResult,
+      bool isBgp,
+      thrift::AreaPathComputationRules const& areaRules);
+
+  /*
+   * [Parallel SPF]
+   *
+   * Memoize SPF results and KSP2 paths needed to build routes ahead of route
+   * computation. Areas are independent and run concurrently, as well as
+   * second shortest paths towards different nodes within an area. KSP2 paths
+   * are computed in batch even without thread pool.
+   */
+  void computeSpfResults(
+      const std::string& myNodeName,
+      std::unordered_map<std::string, LinkState> const& areaLinkStates,
+      PrefixState const& prefixState);
+
+  /*
+   * [Parallel SPF]
+   *
+   * Create unicast routes of all prefixes on spfExecutor_. Prefixes are split
+   * into shards, each building its own fragment of routes and best route
+   * selections, which are merged afterwards. LinkStates MUST have memoized
+   * all SPF results in use, see computeSpfResults(), as they are only read.
+   *
+   * [Rebuild Arena] Temporaries living no longer than the route build, i.e.
+   * shards, fragments of routes and next-hop groups, are allocated from
+   * monotonic arenas released at once when the build is over: `arena` on the
+   * calling thread and an arena of its own per fragment, as arenas are not
+   * thread-safe.
+   */
+  void createRoutesForPrefixes(
+      const std::string& myNodeName,
+      std::unordered_map<std::string, LinkState> const& areaLinkStates,
+      PrefixState const& prefixState,
+      DecisionRouteDb& routeDb,
+      NextHopGroups& nextHopGroups,
+      std::pmr::memory_resource* arena);
+
+  static std::pair<openr::LinkStateMetric, std::unordered_set<std::string>>
+  getMinCostNodes(
+      const LinkState::SpfResult& spfResult,
+      const std::set<NodeAndArea>& dstNodeAreas);
+
   // Given prefixes and the nodes who announce it, get the ecmp next-hops.
   SpfAreaResults selectBestPathsSpf(
       std::string const& myNodeName,
@@ -190,7 +373,8 @@ class SpfSolver {
       thrift::PrefixForwardingType const& forwardingType,
       const std::string& area,
       const LinkState& linkState,
-      thrift::PrefixForwardingAlgorithm fwdingAlgo);
+      thrift::PrefixForwardingAlgorithm fwdingAlgo,
+      NextHopGroups& nextHopGroups);
 
   // Given prefixes and the nodes who announce it, get the kspf2 routes, aka,
   // shortest paths and second shortest paths.
@@ -271,6 +455,30 @@ class SpfSolver {
       bool perDestination,
       const LinkState& linkState);
 
+  /*
+   * [LFA]
+   *
+   * Loop-free alternate next-hops of IP route towards dstNodeAreas, reached
+   * over minMetric via nextHopNodes. Neighbor N, which is not a nexthop, is a
+   * loop-free alternate iff its shortest path towards the destination does
+   * not come back through this node S, i.e. RFC 5286 inequality 1:
+   *
+   *  Distance(N, D) < Distance(N, S) + Distance(S, D)
+   *
+   * Alternates are link protecting. Overloaded neighbors are skipped unless
+   * they are the destination.
+   */
+  std::unordered_set<thrift::NextHopThrift> getLfaNextHopsThrift(
+      const std::string& myNodeName,
+      const std::set<NodeAndArea>& dstNodeAreas,
+      bool isV4,
+      const openr::LinkStateMetric minMetric,
+      std::unordered_map<
+          std::pair<std::string, std::string>,
+          openr::LinkStateMetric> const& nextHopNodes,
+      const std::string& area,
+      const LinkState& linkState) const;
+
   // This function converts best nexthop nodes to best nexthop adjacencies
   // which can then be passed to FIB for programming. It considers and
   // parallel link logic (tested by our UT)
@@ -309,7 +517,29 @@ class SpfSolver {
   // Cache of best route selection.
   // - Cleared when topology changes
   // - Updated for the prefix whenever a route is created for it
-  std::unordered_map<folly::CIDRNetwork, RouteSelectionResult> bestRoutesCache_;
+  BestRoutesCache bestRoutesCache_;
+
+  // [Best Route Memoization] best route selection of prefixes. Unlike
+  // bestRoutesCache_, it is retained across route builds.
+  BestRoutesMemo bestRoutesMemo_;
+
+  // [MPLS Routes Memo] adjacency label routes per area, node label route per
+  // node and area
+  std::unordered_map<std::string /* area */, MplsRoutesMemoEntry>
+      adjLabelRoutesMemo_;
+  std::unordered_map<NodeAndArea, MplsRoutesMemoEntry> nodeLabelRoutesMemo_;
+
+  // Per prefix stats of route builds, see [Thread Local Stats]
+  ThreadLocalStat getRouteForPrefixStat_{
+      "decision.get_route_for_prefix", facebook::fb303::COUNT};
+  ThreadLocalStat bestRouteMemoHitsStat_{
+      "decision.best_route_memo_hits", facebook::fb303::COUNT};
+  ThreadLocalStat bestRouteMemoMissesStat_{
+      "decision.best_route_memo_misses", facebook::fb303::COUNT};
+  ThreadLocalStat areaResultsMemoHitsStat_{
+      "decision.area_results_memo_hits", facebook::fb303::COUNT};
+  ThreadLocalStat areaResultsMemoMissesStat_{
+      "decision.area_results_memo_misses", facebook::fb303::COUNT};
 
   const std::string myNodeName_;
 
@@ -331,5 +561,18 @@ class SpfSolver {
   const bool v4OverV6Nexthop_{false};
 
   const bool enableUcmp_{false};
+
+  // [LFA] compute loop-free alternate backup next-hops of IP routes
+  const bool enableLfa_{false};
+
+  // [Parallel SPF] thread pool running independent SPF and route
+  // computations. Unset to run them sequentially on the calling thread.
+  std::unique_ptr<folly::CPUThreadPoolExecutor> spfExecutor_;
+
+  // prefix shards per thread of spfExecutor_, evening out uneven shards
+  static constexpr size_t kPrefixShardsPerThread{4};
+
+  // [Rebuild Arena] initial buffer of the arena of a route build
+  static constexpr size_t kRebuildArenaInitialBytes{64 * 1024};
 };
 } // namespace openr
@@ -461,6 +461,186 @@ BENCHMARK_COUNTERS_PARAM3(
     100,
     100,
     SP_ECMP);
+
+/*
+ * BM_DecisionFabricChurn:
+ * @first param - integer: num of pods in a fabric topology
+ * @second param - integer: num of planes in a fabric topology
+ * @third param - integer: num of prefixes per node
+ * @fourth param - FabricChurn: change applied to a random rsw per iteration
+ * @fifth param - string: name of the forwarding algorithm
+ *
+ * Measures route rebuild latency (p50/p99) and peak RSS of a fabric under
+ * adjacency flap, node drain and prefix churn. Single pod resembles a 3-stage
+ * Clos, multiple pods a 5-stage one. With 8 pods and 4 planes there are 560
+ * nodes, i.e. 112k prefixes at 200 and ~1M at 1800 prefixes per node.
+ */
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_DecisionFabricChurn,
+    counters,
+    1_4_100_ADJ_FLAP_SP_ECMP,
+    1,
+    4,
+    100,
+    FabricChurn::ADJ_FLAP,
+    SP_ECMP);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_DecisionFabricChurn,
+    counters,
+    1_4_100_NODE_DRAIN_SP_ECMP,
+    1,
+    4,
+    100,
+    FabricChurn::NODE_DRAIN,
+    SP_ECMP);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_DecisionFabricChurn,
+    counters,
+    1_4_100_PREFIX_CHURN_SP_ECMP,
+    1,
+    4,
+    100,
+    FabricChurn::PREFIX_CHURN,
+    SP_ECMP);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_DecisionFabricChurn,
+    counters,
+    8_4_200_ADJ_FLAP_SP_ECMP,
+    8,
+    4,
+    200,
+    FabricChurn::ADJ_FLAP,
+    SP_ECMP);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_DecisionFabricChurn,
+    counters,
+    8_4_200_NODE_DRAIN_SP_ECMP,
+    8,
+    4,
+    200,
+    FabricChurn::NODE_DRAIN,
+    SP_ECMP);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_DecisionFabricChurn,
+    counters,
+    8_4_200_PREFIX_CHURN_SP_ECMP,
+    8,
+    4,
+    200,
+    FabricChurn::PREFIX_CHURN,
+    SP_ECMP);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_DecisionFabricChurn,
+    counters,
+    8_4_200_ADJ_FLAP_KSP2_ED_ECMP,
+    8,
+    4,
+    200,
+    FabricChurn::ADJ_FLAP,
+    KSP2_ED_ECMP);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_DecisionFabricChurn,
+    counters,
+    8_4_200_PREFIX_CHURN_KSP2_ED_ECMP,
+    8,
+    4,
+    200,
+    FabricChurn::PREFIX_CHURN,
+    KSP2_ED_ECMP);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_DecisionFabricChurn,
+    counters,
+    8_4_200_ADJ_FLAP_SP_UCMP,
+    8,
+    4,
+    200,
+    FabricChurn::ADJ_FLAP,
+    SP_UCMP);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_DecisionFabricChurn,
+    counters,
+    8_4_200_NODE_DRAIN_SP_UCMP,
+    8,
+    4,
+    200,
+    FabricChurn::NODE_DRAIN,
+    SP_UCMP);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_DecisionFabricChurn,
+    counters,
+    8_4_1800_ADJ_FLAP_SP_ECMP,
+    8,
+    4,
+    1800,
+    FabricChurn::ADJ_FLAP,
+    SP_ECMP);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_DecisionFabricChurn,
+    counters,
+    8_4_1800_PREFIX_CHURN_SP_ECMP,
+    8,
+    4,
+    1800,
+    FabricChurn::PREFIX_CHURN,
+    SP_ECMP);
+
+/*
+ * BM_SpfQueue:
+ * measures performance of Dijkstra runs with DijkstraQ against the indexed
+ * d-ary heap used by LinkState SPF
+ * @first param - topology: grid or fat-tree
+ * @second param - integer: num of nodes for grid, ports per switch for
+ * fat-tree
+ * @third param - priority queue
+ */
+BENCHMARK_NAMED_PARAM(
+    BM_SpfQueue,
+    GRID_1000_DIJKSTRA_Q,
+    SpfTopology::GRID,
+    1000,
+    SpfQueue::DIJKSTRA_Q);
+BENCHMARK_RELATIVE_NAMED_PARAM(
+    BM_SpfQueue,
+    GRID_1000_INDEXED_HEAP,
+    SpfTopology::GRID,
+    1000,
+    SpfQueue::INDEXED_HEAP);
+BENCHMARK_NAMED_PARAM(
+    BM_SpfQueue,
+    GRID_10000_DIJKSTRA_Q,
+    SpfTopology::GRID,
+    10000,
+    SpfQueue::DIJKSTRA_Q);
+BENCHMARK_RELATIVE_NAMED_PARAM(
+    BM_SpfQueue,
+    GRID_10000_INDEXED_HEAP,
+    SpfTopology::GRID,
+    10000,
+    SpfQueue::INDEXED_HEAP);
+BENCHMARK_NAMED_PARAM(
+    BM_SpfQueue,
+    FAT_TREE_16_DIJKSTRA_Q,
+    SpfTopology::FAT_TREE,
+    16,
+    SpfQueue::DIJKSTRA_Q);
+BENCHMARK_RELATIVE_NAMED_PARAM(
+    BM_SpfQueue,
+    FAT_TREE_16_INDEXED_HEAP,
+    SpfTopology::FAT_TREE,
+    16,
+    SpfQueue::INDEXED_HEAP);
+BENCHMARK_NAMED_PARAM(
+    BM_SpfQueue,
+    FAT_TREE_32_DIJKSTRA_Q,
+    SpfTopology::FAT_TREE,
+    32,
+    SpfQueue::DIJKSTRA_Q);
+BENCHMARK_RELATIVE_NAMED_PARAM(
+    BM_SpfQueue,
+    FAT_TREE_32_INDEXED_HEAP,
+    SpfTopology::FAT_TREE,
+    32,
+    SpfQueue::INDEXED_HEAP);
 } // namespace openr
 
 int
@@ -11,6 +11,7 @@
 #include <folly/IPAddress.h>
 #include <folly/IPAddressV4.h>
 #include <folly/IPAddressV6.h>
+#include <folly/MapUtil.h>
 #include <folly/Optional.h>
 #include <folly/Random.h>
 #include <folly/futures/Promise.h>
@@ -25,6 +26,7 @@
 #include <openr/common/Flags.h>
 #include <openr/common/MplsUtil.h>
 #include <openr/common/NetworkUtil.h>
+#include <openr/common/ThreadLocalStats.h>
 #include <openr/common/Util.h>
 #include <openr/decision/Decision.h>
 #include <openr/decision/RouteUpdate.h>
@@ -585,6 +587,319 @@ TEST(ShortestPathTest, EmptyNeighborAdjacencyDb) {
   EXPECT_EQ(0, routeDb->unicastRoutes.size());
 }
 
+//
+// [Best Route Memoization]
+// Best route selection is memoized across route builds, and redone once
+// advertisement or overload state of the advertiser changes
+//
+TEST(ShortestPathTest, BestRouteMemoization) {
+  std::string nodeName("1");
+  SpfSolver spfSolver(
+      nodeName,
+      false /* disable v4 */,
+      true /* enable segment label */,
+      true /* enable adj labels */,
+      false /* disable LFA */);
+
+  std::unordered_map<std::string, LinkState> areaLinkStates;
+  areaLinkStates.emplace(kTestingAreaName, LinkState(kTestingAreaName));
+  auto& linkState = areaLinkStates.at(kTestingAreaName);
+  PrefixState prefixState;
+
+  linkState.updateAdjacencyDatabase(
+      createAdjDb("1", {adj12}, 1), kTestingAreaName);
+  linkState.updateAdjacencyDatabase(
+      createAdjDb("2", {adj21}, 2), kTestingAreaName);
+  EXPECT_FALSE(updatePrefixDatabase(prefixState, prefixDb1).empty());
+  EXPECT_FALSE(updatePrefixDatabase(prefixState, prefixDb2).empty());
+
+  auto getCounter = [](std::string const& name) {
+    ThreadLocalStat::flushAll();
+    return folly::get_default(fb303::fbData->getCounters(), name, 0);
+  };
+  auto buildRoutes = [&]() {
+    const auto hits = getCounter("decision.best_route_memo_hits.count");
+    const auto misses = getCounter("decision.best_route_memo_misses.count");
+    auto routeDb = spfSolver.buildRouteDb("1", areaLinkStates, prefixState);
+    EXPECT_TRUE(routeDb.has_value());
+    EXPECT_EQ(1, routeDb->unicastRoutes.size());
+    return std::make_pair(
+        getCounter("decision.best_route_memo_hits.count") - hits,
+        getCounter("decision.best_route_memo_misses.count") - misses);
+  };
+
+  // addr1 and addr2 go through best route selection
+  EXPECT_EQ(std::make_pair(0L, 2L), buildRoutes());
+  EXPECT_EQ(std::make_pair(2L, 0L), buildRoutes());
+
+  // overload advertiser of addr2
+  linkState.updateAdjacencyDatabase(
+      createAdjDb("2", {adj21}, 2, true), kTestingAreaName);
+  EXPECT_EQ(std::make_pair(1L, 1L), buildRoutes());
+
+  // change advertisement of addr1
+  auto prefixDb1Breeze = createPrefixDb(
+      "1", {createPrefixEntry(addr1, thrift::PrefixType::BREEZE)});
+  EXPECT_FALSE(updatePrefixDatabase(prefixState, prefixDb1Breeze).empty());
+  EXPECT_EQ(std::make_pair(1L, 1L), buildRoutes());
+}
+
+//
+// [Area Results Cache]
+// SPF next-hop selection is memoized per area, and a change within one area
+// only recomputes next-hops within that area
+//
+TEST(ShortestPathTest, AreaResultsMemoization) {
+  const std::string areaA{"A"}, areaB{"B"};
+  std::unordered_map<std::string, LinkState> areaLinkStates;
+  areaLinkStates.emplace(areaA, LinkState(areaA));
+  areaLinkStates.emplace(areaB, LinkState(areaB));
+  auto& linkStateA = areaLinkStates.at(areaA);
+  auto& linkStateB = areaLinkStates.at(areaB);
+  PrefixState prefixState;
+
+  // addr2 is advertised by 2 in area A and by 3 in area B
+  linkStateA.updateAdjacencyDatabase(
+      createAdjDb("1", {adj12}, 1, false, areaA), areaA);
+  linkStateA.updateAdjacencyDatabase(
+      createAdjDb("2", {adj21}, 2, false, areaA), areaA);
+  linkStateB.updateAdjacencyDatabase(
+      createAdjDb("1", {adj13}, 1, false, areaB), areaB);
+  linkStateB.updateAdjacencyDatabase(
+      createAdjDb("3", {adj31}, 3, false, areaB), areaB);
+  EXPECT_FALSE(
+      updatePrefixDatabase(
+          prefixState, createPrefixDb("2", {createPrefixEntry(addr2)}), areaA)
+          .empty());
+  EXPECT_FALSE(
+      updatePrefixDatabase(
+          prefixState, createPrefixDb("3", {createPrefixEntry(addr2)}), areaB)
+          .empty());
+
+  auto getCounter = [](std::string const& name) {
+    ThreadLocalStat::flushAll();
+    return folly::get_default(fb303::fbData->getCounters(), name, 0);
+  };
+
+  for (size_t numSpfThreads : {0, 2}) {
+    SpfSolver spfSolver(
+        "1",
+        false /* disable v4 */,
+        true /* enable segment label */,
+        true /* enable adj labels */,
+        false /* disable bgp route programming */,
+        false /* disable best route selection */,
+        false /* disable v4 over v6 nexthop */,
+        false /* disable ucmp */,
+        numSpfThreads);
+    auto buildRoutes = [&](size_t numNextHops) {
+      const auto hits = getCounter("decision.area_results_memo_hits.count");
+      const auto misses =
+          getCounter("decision.area_results_memo_misses.count");
+      auto routeDb = spfSolver.buildRouteDb("1", areaLinkStates, prefixState);
+      EXPECT_TRUE(routeDb.has_value());
+      EXPECT_EQ(1, routeDb->unicastRoutes.size());
+      EXPECT_EQ(
+          numNextHops,
+          routeDb->unicastRoutes.at(toIPNetwork(addr2)).nexthops.size());
+      return std::make_pair(
+          getCounter("decision.area_results_memo_hits.count") - hits,
+          getCounter("decision.area_results_memo_misses.count") - misses);
+    };
+
+    // next-hops of both areas are computed once, and merged
+    EXPECT_EQ(std::make_pair(0L, 2L), buildRoutes(2));
+    EXPECT_EQ(std::make_pair(2L, 0L), buildRoutes(2));
+
+    // longer path within area B only recomputes area B
+    auto adj13Longer = adj13;
+    adj13Longer.metric_ref() = 20;
+    linkStateB.updateAdjacencyDatabase(
+        createAdjDb("1", {adj13Longer}, 1, false, areaB), areaB);
+    EXPECT_EQ(std::make_pair(1L, 1L), buildRoutes(1));
+    EXPECT_EQ(std::make_pair(2L, 0L), buildRoutes(1));
+
+    // restore area B for the next iteration
+    linkStateB.updateAdjacencyDatabase(
+        createAdjDb("1", {adj13}, 1, false, areaB), areaB);
+  }
+}
+
+//
+// [MPLS Routes Memo]
+// Adjacency label routes are rebuilt upon change of local adjacencies, node
+// label routes upon change of SPF next-hops towards the node
+//
+TEST(ShortestPathTest, MplsRoutesMemoization) {
+  // 1 - 2 - 3
+  std::unordered_map<std::string, LinkState> areaLinkStates;
+  areaLinkStates.emplace(kTestingAreaName, LinkState(kTestingAreaName));
+  auto& linkState = areaLinkStates.at(kTestingAreaName);
+  linkState.updateAdjacencyDatabase(
+      createAdjDb("1", {adj12}, 1), kTestingAreaName);
+  linkState.updateAdjacencyDatabase(
+      createAdjDb("2", {adj21, adj23}, 2), kTestingAreaName);
+  linkState.updateAdjacencyDatabase(
+      createAdjDb("3", {adj32}, 3), kTestingAreaName);
+
+  auto getCounter = [](std::string const& name) {
+    return folly::get_default(fb303::fbData->getCounters(), name, 0);
+  };
+  SpfSolver spfSolver(
+      "1",
+      false /* disable v4 */,
+      true /* enable segment label */,
+      true /* enable adj labels */,
+      false /* disable LFA */);
+  auto buildRoutes = [&]() {
+    const auto hits = getCounter("decision.mpls_routes_memo_hits.count");
+    const auto misses = getCounter("decision.mpls_routes_memo_misses.count");
+    const auto mplsRoutes = spfSolver.buildMplsRoutes("1", areaLinkStates);
+    const auto memoStats = std::make_pair(
+        getCounter("decision.mpls_routes_memo_hits.count") - hits,
+        getCounter("decision.mpls_routes_memo_misses.count") - misses);
+
+    // node labels of 1, 2, 3 and adjacency label of 1 - 2, same as without
+    // memoization
+    EXPECT_EQ(4, mplsRoutes.size());
+    SpfSolver otherSpfSolver(
+        "1",
+        false /* disable v4 */,
+        true /* enable segment label */,
+        true /* enable adj labels */,
+        false /* disable LFA */);
+    EXPECT_EQ(otherSpfSolver.buildMplsRoutes("1", areaLinkStates), mplsRoutes);
+    return memoStats;
+  };
+
+  // node labels of 2 and 3, adjacency labels of area
+  EXPECT_EQ(std::make_pair(0L, 3L), buildRoutes());
+  EXPECT_EQ(std::make_pair(3L, 0L), buildRoutes());
+
+  // longer path towards 3 only rebuilds its node label route
+  auto adj23Longer = adj23;
+  adj23Longer.metric_ref() = 20;
+  linkState.updateAdjacencyDatabase(
+      createAdjDb("2", {adj21, adj23Longer}, 2), kTestingAreaName);
+  EXPECT_EQ(std::make_pair(2L, 1L), buildRoutes());
+
+  // change of local adjacency rebuilds all of them
+  auto adj12Longer = adj12;
+  adj12Longer.metric_ref() = 20;
+  linkState.updateAdjacencyDatabase(
+      createAdjDb("1", {adj12Longer}, 1), kTestingAreaName);
+  EXPECT_EQ(std::make_pair(0L, 3L), buildRoutes());
+  EXPECT_EQ(std::make_pair(3L, 0L), buildRoutes());
+}
+
+//
+// [Next-Hop Groups]
+// Routes towards prefixes of the same node share next-hops, computed along
+// with the ones of its node label route, with and without SPF threads.
+//
+TEST(ShortestPathTest, NextHopGroups) {
+  std::unordered_map<std::string, LinkState> areaLinkStates;
+  areaLinkStates.emplace(kTestingAreaName, LinkState(kTestingAreaName));
+  auto& linkState = areaLinkStates.at(kTestingAreaName);
+  PrefixState prefixState;
+
+  linkState.updateAdjacencyDatabase(
+      createAdjDb("1", {adj12, adj13}, 1), kTestingAreaName);
+  linkState.updateAdjacencyDatabase(
+      createAdjDb("2", {adj21, adj23}, 2), kTestingAreaName);
+  linkState.updateAdjacencyDatabase(
+      createAdjDb("3", {adj31, adj32}, 3), kTestingAreaName);
+  EXPECT_FALSE(
+      updatePrefixDatabase(
+          prefixState,
+          createPrefixDb(
+              "2", {createPrefixEntry(addr2), createPrefixEntry(addr3)}))
+          .empty());
+
+  for (size_t numSpfThreads : {0, 2}) {
+    SpfSolver spfSolver(
+        "1",
+        false /* disable v4 */,
+        true /* enable segment label */,
+        true /* enable adj labels */,
+        false /* disable bgp route programming */,
+        false /* disable best route selection */,
+        false /* disable v4 over v6 nexthop */,
+        false /* disable ucmp */,
+        numSpfThreads);
+    auto routeDb = spfSolver.buildRouteDb("1", areaLinkStates, prefixState);
+    ASSERT_TRUE(routeDb.has_value());
+    ASSERT_EQ(2, routeDb->unicastRoutes.size());
+
+    auto const& nextHops =
+        routeDb->unicastRoutes.at(toIPNetwork(addr2)).nexthops;
+    EXPECT_EQ(
+        std::unordered_set<thrift::NextHopThrift>(
+            {createNextHopFromAdj(adj12, false, 10)}),
+        nextHops);
+    EXPECT_EQ(nextHops, routeDb->unicastRoutes.at(toIPNetwork(addr3)).nexthops);
+
+    // node label route towards 2 goes through the same neighbor
+    ASSERT_EQ(1, routeDb->mplsRoutes.count(2));
+    auto const& labelNextHops = routeDb->mplsRoutes.at(2).nexthops;
+    ASSERT_EQ(1, labelNextHops.size());
+    EXPECT_EQ(
+        *adj12.ifName_ref(),
+        *labelNextHops.begin()->address_ref()->ifName_ref());
+  }
+}
+
+//
+// [LFA]
+// 1 reaches 2 directly. 3 is a loop-free alternate, as its shortest path
+// towards 2 does not come back through 1, while stub node 4 is not.
+//
+//   2 --- 3
+//    \   /
+//      1 --- 4
+//
+TEST(ShortestPathTest, LoopFreeAlternates) {
+  std::string nodeName("1");
+  SpfSolver spfSolver(
+      nodeName,
+      false /* disable v4 */,
+      true /* enable segment label */,
+      true /* enable adj labels */,
+      false /* disable bgp route programming */,
+      false /* disable best route selection */,
+      false /* disable v4 over v6 nexthop */,
+      false /* disable ucmp */,
+      0 /* no spf threads */,
+      true /* enable lfa */);
+
+  std::unordered_map<std::string, LinkState> areaLinkStates;
+  areaLinkStates.emplace(kTestingAreaName, LinkState(kTestingAreaName));
+  auto& linkState = areaLinkStates.at(kTestingAreaName);
+  PrefixState prefixState;
+
+  linkState.updateAdjacencyDatabase(
+      createAdjDb("1", {adj12, adj13, adj14}, 1), kTestingAreaName);
+  linkState.updateAdjacencyDatabase(
+      createAdjDb("2", {adj21, adj23}, 2), kTestingAreaName);
+  linkState.updateAdjacencyDatabase(
+      createAdjDb("3", {adj31, adj32}, 3), kTestingAreaName);
+  linkState.updateAdjacencyDatabase(
+      createAdjDb("4", {adj41}, 4), kTestingAreaName);
+  EXPECT_FALSE(updatePrefixDatabase(prefixState, prefixDb2).empty());
+
+  auto routeDb = spfSolver.buildRouteDb("1", areaLinkStates, prefixState);
+  ASSERT_TRUE(routeDb.has_value());
+  ASSERT_EQ(1, routeDb->unicastRoutes.count(toIPNetwork(addr2)));
+  auto const& route = routeDb->unicastRoutes.at(toIPNetwork(addr2));
+  EXPECT_THAT(
+      route.nexthops,
+      testing::UnorderedElementsAre(createNextHopFromAdj(adj12, false, 10)));
+  EXPECT_THAT(
+      route.backupNexthops,
+      testing::UnorderedElementsAre(createNextHopFromAdj(adj13, false, 20)));
+  EXPECT_EQ(1, route.toThriftDetail().backupNextHops_ref()->size());
+}
+
 //
 // Query route for unknown neighbor. It should return none
 //
@@ -4712,6 +5027,39 @@ TEST_P(GridTopologyFixture, ShortestPathTest) {
   EXPECT_EQ(gridDistance(src, dst, n), *nextHops.begin()->metric_ref());
 }
 
+// routes built on thread pool MUST be the same as the sequentially built ones
+TEST_P(GridTopologyFixture, ParallelRouteBuild) {
+  SpfSolver parallelSpfSolver(
+      nodeName,
+      false,
+      true /* enable node segment label */,
+      true /* enable adj segment labels */,
+      false,
+      false /* enableBestRouteSelection */,
+      false /* v4OverV6Nexthop */,
+      false /* enableUcmp */,
+      4 /* numSpfThreads */);
+
+  auto routeDb = spfSolver.buildRouteDb("0", areaLinkStates, prefixState);
+  auto parallelRouteDb =
+      parallelSpfSolver.buildRouteDb("0", areaLinkStates, prefixState);
+  ASSERT_TRUE(routeDb.has_value());
+  ASSERT_TRUE(parallelRouteDb.has_value());
+  EXPECT_EQ(n * n - 1, parallelRouteDb->unicastRoutes.size());
+  EXPECT_EQ(routeDb->unicastRoutes, parallelRouteDb->unicastRoutes);
+  EXPECT_EQ(routeDb->mplsRoutes, parallelRouteDb->mplsRoutes);
+
+  auto const& bestRoutes = spfSolver.getBestRoutesCache();
+  auto const& parallelBestRoutes = parallelSpfSolver.getBestRoutesCache();
+  ASSERT_EQ(bestRoutes.size(), parallelBestRoutes.size());
+  for (auto const& [prefix, result] : bestRoutes) {
+    ASSERT_TRUE(parallelBestRoutes.count(prefix));
+    auto const& parallelResult = parallelBestRoutes.at(prefix);
+    EXPECT_EQ(result.allNodeAreas, parallelResult.allNodeAreas);
+    EXPECT_EQ(result.bestNodeArea, parallelResult.bestNodeArea);
+  }
+}
+
 // measure SPF execution time for large networks
 TEST(GridTopology, StressTest) {
   if (!FLAGS_stress_test) {
@@ -5001,7 +5349,7 @@ class DecisionTestFixture : public ::testing::Test {
 
   std::shared_ptr<Config> config;
   messaging::ReplicateQueue<PeerEvent> peerUpdatesQueue;
-  messaging::ReplicateQueue<KvStorePublication> kvStoreUpdatesQueue;
+  messaging::SharedReplicateQueue<KvStorePublication> kvStoreUpdatesQueue;
   messaging::ReplicateQueue<DecisionRouteUpdate> staticRouteUpdatesQueue;
   messaging::ReplicateQueue<DecisionRouteUpdate> routeUpdatesQueue;
   messaging::RQueue<DecisionRouteUpdate> routeUpdatesQueueReader{
@@ -5333,6 +5681,47 @@ TEST_F(DecisionTestFixture, BasicOperations) {
   EXPECT_TRUE(foundLabelRoute);
 }
 
+/**
+ * Verify routes of prefixes advertised in prefix shard keys, along with
+ * per prefix keys. Prefixes missing from an updated shard, or all of them
+ * upon expiry of the shard, are withdrawn.
+ */
+TEST_F(DecisionTestFixture, PrefixShardKeys) {
+  const auto shardKey = PrefixKey::getPrefixShardKey("2", 0);
+  sendKvPublication(createThriftPublication(
+      {{"adj:1", createAdjValue("1", 1, {adj12}, false, 1)},
+       {"adj:2", createAdjValue("2", 1, {adj21}, false, 2)},
+       createPrefixKeyValue("1", 1, addr1),
+       {shardKey, createPrefixValue("2", 1, {addr2, addr3})}},
+      {},
+      {},
+      {},
+      std::string("")));
+  auto routeDbDelta = recvRouteUpdates();
+  EXPECT_EQ(2, routeDbDelta.unicastRoutesToUpdate.size());
+  EXPECT_EQ(1, routeDbDelta.unicastRoutesToUpdate.count(toIPNetwork(addr2)));
+  EXPECT_EQ(1, routeDbDelta.unicastRoutesToUpdate.count(toIPNetwork(addr3)));
+
+  // addr3 is removed from the shard
+  sendKvPublication(createThriftPublication(
+      {{shardKey, createPrefixValue("2", 2, {addr2})}},
+      {},
+      {},
+      {},
+      std::string("")));
+  routeDbDelta = recvRouteUpdates();
+  EXPECT_EQ(0, routeDbDelta.unicastRoutesToUpdate.size());
+  ASSERT_EQ(1, routeDbDelta.unicastRoutesToDelete.size());
+  EXPECT_EQ(toIPNetwork(addr3), routeDbDelta.unicastRoutesToDelete.front());
+
+  // shard expires along with its remaining prefixes
+  sendKvPublication(
+      createThriftPublication({}, {shardKey}, {}, {}, std::string("")));
+  routeDbDelta = recvRouteUpdates();
+  ASSERT_EQ(1, routeDbDelta.unicastRoutesToDelete.size());
+  EXPECT_EQ(toIPNetwork(addr2), routeDbDelta.unicastRoutesToDelete.front());
+}
+
 /**
  * Publish all types of update to Decision and expect that Decision emits
  * a full route database that includes all the routes as its first update.
@@ -6146,7 +6535,7 @@ TEST(Decision, RibPolicyFeatureKnob) {
   ASSERT_FALSE(config->isRibPolicyEnabled());
 
   messaging::ReplicateQueue<PeerEvent> peerUpdatesQueue;
-  messaging::ReplicateQueue<KvStorePublication> kvStoreUpdatesQueue;
+  messaging::SharedReplicateQueue<KvStorePublication> kvStoreUpdatesQueue;
   messaging::ReplicateQueue<DecisionRouteUpdate> staticRouteUpdatesQueue;
   messaging::ReplicateQueue<DecisionRouteUpdate> routeUpdatesQueue;
   auto decision = std::make_unique<Decision>(
@@ -6239,7 +6628,7 @@ TEST_F(DecisionTestFixture, GracefulRestartSupportForRibPolicy) {
       [&]() noexcept {
         // Wait for saveRibPolicyMaxMs to make sure Rib policy is saved to file.
         messaging::ReplicateQueue<PeerEvent> peerUpdatesQueue;
-        messaging::ReplicateQueue<KvStorePublication> kvStoreUpdatesQueue;
+        messaging::SharedReplicateQueue<KvStorePublication> kvStoreUpdatesQueue;
         messaging::ReplicateQueue<DecisionRouteUpdate> staticRouteUpdatesQueue;
         messaging::ReplicateQueue<DecisionRouteUpdate> routeUpdatesQueue;
         auto routeUpdatesQueueReader = routeUpdatesQueue.getReader();
@@ -6350,7 +6739,7 @@ TEST_F(DecisionTestFixture, SaveReadStaleRibPolicy) {
         // Wait for 2 * saveRibPolicyMaxMs.
         // This makes sure expired rib policy is saved to file.
         messaging::ReplicateQueue<PeerEvent> peerUpdatesQueue;
-        messaging::ReplicateQueue<KvStorePublication> kvStoreUpdatesQueue;
+        messaging::SharedReplicateQueue<KvStorePublication> kvStoreUpdatesQueue;
         messaging::ReplicateQueue<DecisionRouteUpdate> staticRouteUpdatesQueue;
         messaging::ReplicateQueue<DecisionRouteUpdate> routeUpdatesQueue;
         auto routeUpdatesQueueReader = routeUpdatesQueue.getReader();
@@ -6550,6 +6939,8 @@ TEST_F(DecisionTestFixture, PubDebouncing) {
       {},
       std::string(""));
 
+  // [Thread Local Stats] per prefix stats are aggregated on flush
+  ThreadLocalStat::flushAll();
   auto counters = fb303::fbData->getCounters();
   EXPECT_EQ(0, counters["decision.spf_runs.count"]);
   EXPECT_EQ(0, counters["decision.route_build_runs.count"]);
@@ -6558,6 +6949,7 @@ TEST_F(DecisionTestFixture, PubDebouncing) {
   recvRouteUpdates();
 
   // validate SPF after initial sync, no rebouncing here
+  ThreadLocalStat::flushAll();
   counters = fb303::fbData->getCounters();
   EXPECT_EQ(1, counters["decision.spf_runs.count"]);
   EXPECT_EQ(1, counters["decision.route_build_runs.count"]);
@@ -6594,6 +6986,7 @@ TEST_F(DecisionTestFixture, PubDebouncing) {
   sendKvPublication(publication);
   recvRouteUpdates();
 
+  ThreadLocalStat::flushAll();
   counters = fb303::fbData->getCounters();
   EXPECT_EQ(2, counters["decision.spf_runs.count"]);
   EXPECT_EQ(2, counters["decision.route_build_runs.count"]);
@@ -6608,6 +7001,7 @@ TEST_F(DecisionTestFixture, PubDebouncing) {
   sendKvPublication(publication);
   recvRouteUpdates();
 
+  ThreadLocalStat::flushAll();
   counters = fb303::fbData->getCounters();
   EXPECT_EQ(2, counters["decision.spf_runs.count"]);
   // only prefix changed no full rebuild needed
@@ -6641,6 +7035,7 @@ TEST_F(DecisionTestFixture, PubDebouncing) {
   sendKvPublication(publication);
   recvRouteUpdates();
 
+  ThreadLocalStat::flushAll();
   counters = fb303::fbData->getCounters();
   EXPECT_EQ(3, counters["decision.spf_runs.count"]);
   EXPECT_EQ(3, counters["decision.route_build_runs.count"]);
@@ -6677,6 +7072,7 @@ TEST_F(DecisionTestFixture, PubDebouncing) {
   sendKvPublication(publication);
   recvRouteUpdates();
 
+  ThreadLocalStat::flushAll();
   counters = fb303::fbData->getCounters();
   // only prefix has changed so spf_runs is unchanged
   EXPECT_EQ(3, counters["decision.spf_runs.count"]);
@@ -7521,6 +7917,312 @@ TEST_P(InitialRibBuildTestFixture, PrefixWithMixedTypeRoutes) {
   evb.run();
 }
 
+/**
+ * Test fixture for testing Decision module with scoped route rebuild.
+ */
+class ScopedRouteRebuildTestFixture : public DecisionTestFixture {
+  openr::thrift::OpenrConfig
+  createConfig() override {
+    auto tConfig = DecisionTestFixture::createConfig();
+    tConfig.decision_config_ref()->enable_scoped_route_rebuild_ref() = true;
+    return tConfig;
+  }
+};
+
+//
+// Remote topology change only rebuilds routes towards affected nodes.
+// Line topology 1 - 2 - 3, with link 2 - 3 going down.
+//
+TEST_F(ScopedRouteRebuildTestFixture, RemoteLinkDown) {
+  auto publication = createThriftPublication(
+      {{"adj:1", createAdjValue("1", 1, {adj12}, false, 1)},
+       {"adj:2", createAdjValue("2", 1, {adj21, adj23}, false, 2)},
+       {"adj:3", createAdjValue("3", 1, {adj32}, false, 3)},
+       createPrefixKeyValue("1", 1, addr1),
+       createPrefixKeyValue("2", 1, addr2),
+       createPrefixKeyValue("3", 1, addr3)},
+      {},
+      {},
+      {},
+      std::string(""));
+  sendKvPublication(publication);
+  auto routeDbDelta = recvRouteUpdates();
+  EXPECT_EQ(2, routeDbDelta.unicastRoutesToUpdate.size());
+
+  // link 2 - 3 down, reported by node 3
+  publication = createThriftPublication(
+      {{"adj:3", createAdjValue("3", 2, {}, false, 3)}},
+      {},
+      {},
+      {},
+      std::string(""));
+  sendKvPublication(publication);
+  routeDbDelta = recvRouteUpdates();
+  EXPECT_EQ(0, routeDbDelta.unicastRoutesToUpdate.size());
+  EXPECT_THAT(
+      routeDbDelta.unicastRoutesToDelete,
+      testing::UnorderedElementsAre(toIPNetwork(addr3)));
+  // node label route of node 3
+  EXPECT_EQ(1, routeDbDelta.mplsRoutesToDelete.size());
+
+  auto counters = fb303::fbData->getCounters();
+  EXPECT_EQ(1, counters.at("decision.scoped_route_rebuild_runs.count"));
+
+  auto routeMap = RouteMap();
+  fillRouteMap("1", routeMap, dumpRouteDb({"1"})["1"]);
+  EXPECT_EQ(
+      routeMap[make_pair("1", toString(addr2))],
+      NextHops({createNextHopFromAdj(adj12, false, 10)}));
+  EXPECT_EQ(0, routeMap.count(make_pair("1", toString(addr3))));
+}
+
+//
+// Drain of this node changes no link, hence is scoped as well and leaves
+// routes of this node untouched. Line topology 1 - 2 - 3.
+//
+TEST_F(ScopedRouteRebuildTestFixture, LocalDrain) {
+  auto publication = createThriftPublication(
+      {{"adj:1", createAdjValue("1", 1, {adj12}, false, 1)},
+       {"adj:2", createAdjValue("2", 1, {adj21, adj23}, false, 2)},
+       {"adj:3", createAdjValue("3", 1, {adj32}, false, 3)},
+       createPrefixKeyValue("1", 1, addr1),
+       createPrefixKeyValue("2", 1, addr2),
+       createPrefixKeyValue("3", 1, addr3)},
+      {},
+      {},
+      {},
+      std::string(""));
+  sendKvPublication(publication);
+  auto routeDbDelta = recvRouteUpdates();
+  EXPECT_EQ(2, routeDbDelta.unicastRoutesToUpdate.size());
+  const auto scopedRuns = folly::get_default(
+      fb303::fbData->getCounters(), "decision.scoped_route_rebuild_runs.count");
+
+  // node 1 drained
+  publication = createThriftPublication(
+      {{"adj:1", createAdjValue("1", 2, {adj12}, true, 1)}},
+      {},
+      {},
+      {},
+      std::string(""));
+  sendKvPublication(publication);
+  routeDbDelta = recvRouteUpdates();
+  EXPECT_EQ(0, routeDbDelta.unicastRoutesToUpdate.size());
+  EXPECT_EQ(0, routeDbDelta.unicastRoutesToDelete.size());
+  EXPECT_EQ(
+      scopedRuns + 1,
+      fb303::fbData->getCounters().at(
+          "decision.scoped_route_rebuild_runs.count"));
+
+  auto routeMap = RouteMap();
+  fillRouteMap("1", routeMap, dumpRouteDb({"1"})["1"]);
+  EXPECT_EQ(
+      routeMap[make_pair("1", toString(addr3))],
+      NextHops({createNextHopFromAdj(adj12, false, 20)}));
+}
+
+/**
+ * Test fixture for testing Decision module with rebuild cost model.
+ */
+class RebuildCostModelTestFixture : public DecisionTestFixture {
+  openr::thrift::OpenrConfig
+  createConfig() override {
+    auto tConfig = DecisionTestFixture::createConfig();
+    tConfig.decision_config_ref()->enable_scoped_route_rebuild_ref() = true;
+    tConfig.decision_config_ref()->enable_rebuild_cost_model_ref() = true;
+    return tConfig;
+  }
+
+ protected:
+  // description of rebuild selection in perf events of `update`
+  static std::string
+  getRebuildSelection(DecisionRouteUpdate const& update) {
+    if (not update.perfEvents.has_value()) {
+      return "";
+    }
+    for (auto const& event : *update.perfEvents->events_ref()) {
+      if (event.eventDescr_ref()->find("_REBUILD_SELECTED") !=
+          std::string::npos) {
+        return *event.eventDescr_ref();
+      }
+    }
+    return "";
+  }
+};
+
+//
+// Rebuild strategy is picked by estimated cost and recorded in perf events.
+// Line topology 1 - 2 - 3, i.e. 3 nodes and 3 prefixes.
+//
+TEST_F(RebuildCostModelTestFixture, SelectRebuild) {
+  auto publication = createThriftPublication(
+      {{"adj:1", createAdjValue("1", 1, {adj12}, false, 1)},
+       {"adj:2", createAdjValue("2", 1, {adj21, adj23}, false, 2)},
+       {"adj:3", createAdjValue("3", 1, {adj32}, false, 3)},
+       createPrefixKeyValue("1", 1, addr1),
+       createPrefixKeyValue("2", 1, addr2),
+       createPrefixKeyValue("3", 1, addr3)},
+      {},
+      {},
+      {},
+      std::string(""));
+  sendKvPublication(publication);
+  auto routeDbDelta = recvRouteUpdates();
+  EXPECT_EQ(2, routeDbDelta.unicastRoutesToUpdate.size());
+  // full rebuild is required, nothing to select
+  EXPECT_EQ("", getRebuildSelection(routeDbDelta));
+
+  // drain of node 2 affects both node 2 and node 3 behind it. Rebuilding
+  // routes of both prefixes and node label routes costs 2 * 2 + 3, more than
+  // rebuilding all 3 prefixes and node label routes.
+  publication = createThriftPublication(
+      {{"adj:2", createAdjValue("2", 2, {adj21, adj23}, true, 2)}},
+      {},
+      {},
+      {},
+      std::string(""));
+  sendKvPublication(publication);
+  routeDbDelta = recvRouteUpdates();
+  EXPECT_EQ(
+      "FULL_REBUILD_SELECTED full_cost=6 incremental_cost=7",
+      getRebuildSelection(routeDbDelta));
+  // delta of full rebuild is sent as incremental update
+  EXPECT_EQ(DecisionRouteUpdate::INCREMENTAL, routeDbDelta.type);
+  EXPECT_EQ(0, routeDbDelta.unicastRoutesToUpdate.size());
+  EXPECT_THAT(
+      routeDbDelta.unicastRoutesToDelete,
+      testing::UnorderedElementsAre(toIPNetwork(addr3)));
+
+  // new prefix of node 2 is rebuilt incrementally
+  publication = createThriftPublication(
+      {createPrefixKeyValue("2", 1, addr4)},
+      {},
+      {},
+      {},
+      std::string(""));
+  sendKvPublication(publication);
+  routeDbDelta = recvRouteUpdates();
+  EXPECT_EQ(
+      "INCREMENTAL_REBUILD_SELECTED full_cost=7 incremental_cost=2",
+      getRebuildSelection(routeDbDelta));
+  EXPECT_EQ(1, routeDbDelta.unicastRoutesToUpdate.size());
+
+  auto counters = fb303::fbData->getCounters();
+  EXPECT_EQ(
+      1, counters.at("decision.rebuild_cost_model.full_rebuilds.count"));
+  EXPECT_EQ(
+      1, counters.at("decision.rebuild_cost_model.incremental_rebuilds.count"));
+}
+
+/**
+ * Test fixture for testing Decision module with publication decode pool.
+ */
+class PublicationDecodeTestFixture : public DecisionTestFixture {
+  openr::thrift::OpenrConfig
+  createConfig() override {
+    auto tConfig = DecisionTestFixture::createConfig();
+    tConfig.decision_config_ref()->publication_decode_num_threads_ref() = 2;
+    return tConfig;
+  }
+};
+
+//
+// Large publication is decoded on the pool. Values already applied are
+// skipped upon re-publication.
+//
+TEST_F(PublicationDecodeTestFixture, DecodeAndSkipAppliedValues) {
+  const size_t kNumPrefixes{200};
+  std::unordered_map<std::string, thrift::Value> keyVals{
+      {"adj:1", createAdjValue("1", 1, {adj12}, false, 1)},
+      {"adj:2", createAdjValue("2", 1, {adj21}, false, 2)}};
+  std::vector<thrift::IpPrefix> prefixes;
+  for (size_t i = 0; i < kNumPrefixes; ++i) {
+    prefixes.emplace_back(toIpPrefix(fmt::format("fc00:cafe:{:x}::/64", i)));
+    keyVals.emplace(createPrefixKeyValue("2", 1, prefixes.back()));
+  }
+
+  sendKvPublication(
+      createThriftPublication(keyVals, {}, {}, {}, std::string("")));
+  auto routeDbDelta = recvRouteUpdates();
+  EXPECT_EQ(kNumPrefixes, routeDbDelta.unicastRoutesToUpdate.size());
+
+  auto counters = fb303::fbData->getCounters();
+  EXPECT_EQ(1, counters.at("decision.publication_parallel_decodes.count"));
+  EXPECT_EQ(0, counters.count("decision.publication_skipped_values.sum"));
+
+  // re-publish all keys with a single prefix withdrawn
+  auto withdrawn = createPrefixKeyValue(
+      "2", 2, prefixes.front(), kTestingAreaName, true /* withdraw */);
+  keyVals.insert_or_assign(withdrawn.first, withdrawn.second);
+  sendKvPublication(
+      createThriftPublication(keyVals, {}, {}, {}, std::string("")));
+  routeDbDelta = recvRouteUpdates();
+  EXPECT_EQ(0, routeDbDelta.unicastRoutesToUpdate.size());
+  EXPECT_THAT(
+      routeDbDelta.unicastRoutesToDelete,
+      testing::UnorderedElementsAre(toIPNetwork(prefixes.front())));
+
+  counters = fb303::fbData->getCounters();
+  EXPECT_EQ(
+      keyVals.size() - 1,
+      counters.at("decision.publication_skipped_values.sum"));
+}
+
+class PriorityRoutesTestFixture : public DecisionTestFixture {
+  openr::thrift::OpenrConfig
+  createConfig() override {
+    auto tConfig = DecisionTestFixture::createConfig();
+    tConfig.decision_config_ref()->priority_prefixes_ref() = {
+        toString(addr2)};
+    return tConfig;
+  }
+};
+
+//
+// Upon full route rebuild, route of priority prefix is sent out ahead of the
+// rest in a separate update. Initial route build is not split.
+//
+TEST_F(PriorityRoutesTestFixture, PriorityRoutesFirst) {
+  auto publication = createThriftPublication(
+      {{"adj:1", createAdjValue("1", 1, {adj12}, false, 1)},
+       {"adj:2", createAdjValue("2", 1, {adj21}, false, 2)},
+       createPrefixKeyValue("2", 1, addr2),
+       createPrefixKeyValue("2", 1, addr3),
+       createPrefixKeyValue("2", 1, addr4)},
+      {},
+      {},
+      {},
+      std::string(""));
+  sendKvPublication(publication);
+  auto routeDbDelta = recvRouteUpdates();
+  EXPECT_EQ(3, routeDbDelta.unicastRoutesToUpdate.size());
+
+  // local metric change rebuilds all routes
+  auto adj12Metric = adj12;
+  adj12Metric.metric_ref() = 20;
+  publication = createThriftPublication(
+      {{"adj:1", createAdjValue("1", 2, {adj12Metric}, false, 1)}},
+      {},
+      {},
+      {},
+      std::string(""));
+  sendKvPublication(publication);
+
+  routeDbDelta = recvRouteUpdates();
+  EXPECT_EQ(DecisionRouteUpdate::INCREMENTAL, routeDbDelta.type);
+  EXPECT_EQ(1, routeDbDelta.unicastRoutesToUpdate.size());
+  EXPECT_EQ(1, routeDbDelta.unicastRoutesToUpdate.count(toIPNetwork(addr2)));
+
+  routeDbDelta = recvRouteUpdates();
+  EXPECT_EQ(DecisionRouteUpdate::FULL_SYNC, routeDbDelta.type);
+  EXPECT_EQ(2, routeDbDelta.unicastRoutesToUpdate.size());
+  EXPECT_EQ(0, routeDbDelta.unicastRoutesToUpdate.count(toIPNetwork(addr2)));
+  EXPECT_EQ(0, routeDbDelta.unicastRoutesToDelete.size());
+
+  auto counters = fb303::fbData->getCounters();
+  EXPECT_EQ(1, counters.count("decision.priority_route_build_ms.avg"));
+}
+
 /**
  * Test fixture for testing Decision module with V4 over V6 nexthop feature.
  */
@@ -7788,6 +8490,98 @@ TEST(DecisionPendingUpdates, needsFullRebuild) {
   EXPECT_TRUE(updates.needsFullRebuild());
 }
 
+TEST(DecisionPendingUpdates, needsScopedRebuild) {
+  openr::detail::DecisionPendingUpdates updates(
+      "node1", true /* enableScopedRouteRebuild */);
+  LinkState::LinkStateChange linkStateChange;
+
+  // remote topology change
+  linkStateChange.topologyChanged = true;
+  updates.applyLinkStateChange("node2", linkStateChange, kEmptyPerfEventRef);
+  EXPECT_TRUE(updates.needsRouteUpdate());
+  EXPECT_TRUE(updates.needsScopedRebuild());
+  EXPECT_FALSE(updates.needsFullRebuild());
+
+  updates.reset();
+  EXPECT_FALSE(updates.needsRouteUpdate());
+  EXPECT_FALSE(updates.needsScopedRebuild());
+
+  // local topology change
+  updates.applyLinkStateChange("node1", linkStateChange, kEmptyPerfEventRef);
+  EXPECT_TRUE(updates.needsFullRebuild());
+
+  // local and remote drain
+  updates.reset();
+  LinkState::LinkStateChange drainChange;
+  drainChange.topologyChanged = true;
+  drainChange.updatedNodes.emplace_back("node1");
+  updates.applyLinkStateChange("node1", drainChange, kEmptyPerfEventRef);
+  EXPECT_TRUE(updates.needsScopedRebuild());
+  EXPECT_FALSE(updates.needsFullRebuild());
+  drainChange.updatedNodes = {"node2"};
+  updates.applyLinkStateChange("node2", drainChange, kEmptyPerfEventRef);
+  EXPECT_FALSE(updates.needsFullRebuild());
+
+  // node label change
+  updates.reset();
+  linkStateChange.nodeLabelChanged = true;
+  updates.applyLinkStateChange("node2", linkStateChange, kEmptyPerfEventRef);
+  EXPECT_TRUE(updates.needsFullRebuild());
+}
+
+TEST(DecisionDebounceTuner, BackoffRange) {
+  const std::chrono::milliseconds minDebounce{10};
+  const std::chrono::milliseconds maxDebounce{250};
+  detail::DecisionDebounceTuner tuner(minDebounce, maxDebounce);
+  auto now = std::chrono::steady_clock::now();
+
+  // quiet network, isolated update is rebuilt after min
+  tuner.recordUpdate(now);
+  EXPECT_EQ(std::make_pair(minDebounce, minDebounce), tuner.getBackoffRange());
+
+  // busy network, waiting at least twice the rebuild cost
+  for (int i = 0; i < 20; ++i) {
+    now += std::chrono::milliseconds(50);
+    tuner.recordUpdate(now);
+    tuner.recordRebuildCost(std::chrono::milliseconds(40));
+  }
+  auto [minBackoff, maxBackoff] = tuner.getBackoffRange();
+  EXPECT_LT(std::chrono::milliseconds(70), minBackoff);
+  EXPECT_GE(std::chrono::milliseconds(80), minBackoff);
+  EXPECT_EQ(maxDebounce, maxBackoff);
+
+  // updates closer together than min, batching for max right away
+  for (int i = 0; i < 30; ++i) {
+    now += std::chrono::milliseconds(1);
+    tuner.recordUpdate(now);
+  }
+  EXPECT_GT(minDebounce.count(), tuner.getUpdateIntervalMs());
+  EXPECT_EQ(std::make_pair(maxDebounce, maxDebounce), tuner.getBackoffRange());
+
+  // first update after a quiet period is rebuilt after min again
+  now += std::chrono::seconds(1);
+  tuner.recordUpdate(now);
+  EXPECT_EQ(std::make_pair(minDebounce, minDebounce), tuner.getBackoffRange());
+}
+
+TEST(RebuildCostEstimate, estimateRebuildCost) {
+  // few updated prefixes are rebuilt incrementally
+  auto estimate = openr::detail::estimateRebuildCost(1000, 10, 10, false);
+  EXPECT_EQ(1010, estimate.fullCost);
+  EXPECT_EQ(20, estimate.incrementalCost);
+  EXPECT_FALSE(estimate.isFullRebuildCheaper());
+
+  // node label routes are rebuilt by both upon topology change
+  estimate = openr::detail::estimateRebuildCost(1000, 10, 10, true);
+  EXPECT_EQ(30, estimate.incrementalCost);
+  EXPECT_FALSE(estimate.isFullRebuildCheaper());
+
+  // most prefixes updated, e.g. by full-sync of KvStore
+  estimate = openr::detail::estimateRebuildCost(1000, 10, 600, false);
+  EXPECT_EQ(1200, estimate.incrementalCost);
+  EXPECT_TRUE(estimate.isFullRebuildCheaper());
+}
+
 TEST(DecisionPendingUpdates, updatedPrefixes) {
   openr::detail::DecisionPendingUpdates updates("node1");
 
@@ -5,6 +5,12 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <map>
+#include <set>
+
+#include <fb303/ServiceData.h>
+#include <folly/Random.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "openr/if/gen-cpp2/OpenrConfig_types.h"
@@ -12,6 +18,7 @@
 #include <openr/common/Constants.h>
 #include <openr/common/NetworkUtil.h>
 #include <openr/common/Util.h>
+#include <openr/decision/IndexedDaryHeap.h>
 #include <openr/decision/LinkState.h>
 #include <openr/decision/tests/DecisionTestUtils.h>
 #include <openr/tests/utils/Utils.h>
@@ -19,6 +26,52 @@
 using namespace testing;
 using namespace openr;
 
+namespace fb303 = facebook::fb303;
+
+namespace {
+
+// adjacency database of a node with given neighbors and metrics towards them
+thrift::AdjacencyDatabase
+createTestAdjDb(
+    int node, std::map<int, int> const& adjMetrics, bool isOverloaded = false) {
+  std::vector<thrift::Adjacency> adjs;
+  for (auto const& [adj, metric] : adjMetrics) {
+    adjs.emplace_back(createAdjacency(
+        fmt::format("{}", adj),
+        fmt::format("{}/{}", node, adj),
+        fmt::format("{}/{}", adj, node),
+        fmt::format("fe80::{}", adj),
+        fmt::format("192.168.0.{}", adj),
+        metric,
+        (node << 16) + adj));
+  }
+  return createAdjDb(
+      fmt::format("{}", node), adjs, node, isOverloaded, kTestingAreaName);
+}
+
+void
+expectSameSpfResult(
+    LinkState::SpfResult const& result, LinkState::SpfResult const& expected) {
+  ASSERT_EQ(expected.size(), result.size());
+  for (auto const& [node, expectedNodeResult] : expected) {
+    ASSERT_TRUE(result.count(node)) << node;
+    auto const& nodeResult = result.at(node);
+    EXPECT_EQ(expectedNodeResult.metric(), nodeResult.metric()) << node;
+    EXPECT_EQ(expectedNodeResult.nextHops(), nodeResult.nextHops()) << node;
+
+    std::multiset<std::pair<std::string, std::string>> paths, expectedPaths;
+    for (auto const& pathLink : nodeResult.pathLinks()) {
+      paths.emplace(pathLink.link->toString(), pathLink.prevNode);
+    }
+    for (auto const& pathLink : expectedNodeResult.pathLinks()) {
+      expectedPaths.emplace(pathLink.link->toString(), pathLink.prevNode);
+    }
+    EXPECT_EQ(expectedPaths, paths) << node;
+  }
+}
+
+} // namespace
+
 TEST(HoldableValueTest, BasicOperation) {
   openr::HoldableValue<bool> hv{true};
   EXPECT_TRUE(hv.value());
@@ -82,6 +135,70 @@ TEST(HoldableValueTest, BasicOperation) {
   EXPECT_EQ(5, hvLsm.value());
 }
 
+TEST(IndexedDaryHeapTest, BasicOperation) {
+  IndexedDaryHeap<std::pair<int, uint32_t>> heap;
+  EXPECT_TRUE(heap.empty());
+  EXPECT_FALSE(heap.contains(3));
+
+  heap.push(3, {30, 0});
+  heap.push(1, {10, 1});
+  heap.push(2, {10, 0});
+  heap.push(7, {70, 0});
+  EXPECT_EQ(4, heap.size());
+  EXPECT_TRUE(heap.contains(7));
+  EXPECT_FALSE(heap.contains(5));
+
+  // equal metric is ordered by tie-breaker
+  EXPECT_EQ(2, heap.top().second);
+
+  // decrease-key moves id to front, no-op if key is not lower
+  heap.decreaseKey(7, {5, 0});
+  EXPECT_EQ(7, heap.top().second);
+  heap.pushOrDecreaseKey(3, {40, 0});
+  EXPECT_EQ(std::make_pair(30, 0u), heap.getKey(3));
+  heap.pushOrDecreaseKey(3, {20, 0});
+  EXPECT_EQ(std::make_pair(20, 0u), heap.getKey(3));
+
+  std::vector<uint32_t> order;
+  while (not heap.empty()) {
+    order.emplace_back(heap.pop().second);
+  }
+  EXPECT_THAT(order, ElementsAre(7, 2, 1, 3));
+  EXPECT_FALSE(heap.contains(7));
+
+  // reuse after clear
+  heap.push(4, {1, 0});
+  heap.push(5, {2, 0});
+  heap.clear();
+  EXPECT_TRUE(heap.empty());
+  EXPECT_FALSE(heap.contains(4));
+  heap.push(5, {3, 0});
+  EXPECT_EQ(5, heap.pop().second);
+}
+
+TEST(IndexedDaryHeapTest, RandomOperations) {
+  IndexedDaryHeap<std::pair<int, uint32_t>, 3> heap;
+  std::map<uint32_t, int> keys;
+  for (int i = 0; i < 1000; ++i) {
+    const uint32_t id = folly::Random::rand32(100);
+    const int key = folly::Random::rand32(1000);
+    heap.pushOrDecreaseKey(id, {key, id});
+    auto [it, inserted] = keys.emplace(id, key);
+    if (not inserted) {
+      it->second = std::min(it->second, key);
+    }
+  }
+  ASSERT_EQ(keys.size(), heap.size());
+
+  std::pair<int, uint32_t> prev{-1, 0};
+  while (not heap.empty()) {
+    auto [key, id] = heap.pop();
+    EXPECT_LT(prev, key);
+    EXPECT_EQ(keys.at(id), key.first);
+    prev = key;
+  }
+}
+
 TEST(LinkTest, BasicOperation) {
   std::string n1 = "node1";
   auto adj1 =
@@ -208,6 +325,70 @@ TEST(LinkStateTest, BasicOperation) {
   EXPECT_THAT(state.linksFromNode(n3), UnorderedElementsAre(Pointee(l2)));
 }
 
+TEST(LinkStateTest, HoldExpiry) {
+  std::string n1 = "node1";
+  std::string n2 = "node2";
+  std::string n3 = "node3";
+  auto adj12 =
+      openr::createAdjacency(n2, "if2", "if1", "fe80::2", "10.0.0.2", 1, 1, 1);
+  auto adj13 =
+      openr::createAdjacency(n3, "if3", "if1", "fe80::3", "10.0.0.3", 1, 1, 1);
+  auto adj21 =
+      openr::createAdjacency(n1, "if1", "if2", "fe80::1", "10.0.0.1", 1, 1, 1);
+  auto adj23 =
+      openr::createAdjacency(n3, "if3", "if2", "fe80::3", "10.0.0.3", 1, 1, 1);
+  auto adj31 =
+      openr::createAdjacency(n1, "if1", "if3", "fe80::1", "10.0.0.1", 1, 1, 1);
+  auto adj32 =
+      openr::createAdjacency(n2, "if2", "if3", "fe80::2", "10.0.0.2", 1, 1, 1);
+
+  openr::Link l1(kTestingAreaName, n1, adj12, n2, adj21);
+  openr::Link l2(kTestingAreaName, n2, adj23, n3, adj32);
+  openr::Link l3(kTestingAreaName, n3, adj31, n1, adj13);
+
+  auto adjDb1 = openr::createAdjDb(n1, {adj12, adj13}, 1);
+  auto adjDb2 = openr::createAdjDb(n2, {adj21, adj23}, 2);
+  auto adjDb3 = openr::createAdjDb(n3, {adj31, adj32}, 3);
+
+  openr::LinkState state{kTestingAreaName};
+  state.updateAdjacencyDatabase(adjDb1, kTestingAreaName, 0, 0);
+  state.updateAdjacencyDatabase(adjDb2, kTestingAreaName, 0, 0);
+  EXPECT_FALSE(state.hasHolds());
+
+  // links of node3 are held up for two ticks
+  auto change = state.updateAdjacencyDatabase(adjDb3, kTestingAreaName, 2, 0);
+  EXPECT_FALSE(change.topologyChanged);
+  EXPECT_TRUE(state.hasHolds());
+  change = state.decrementHolds();
+  EXPECT_FALSE(change.topologyChanged);
+  EXPECT_THAT(change.updatedLinks, testing::IsEmpty());
+  change = state.decrementHolds();
+  EXPECT_TRUE(change.topologyChanged);
+  EXPECT_THAT(
+      change.updatedLinks, UnorderedElementsAre(Pointee(l2), Pointee(l3)));
+  EXPECT_FALSE(state.hasHolds());
+
+  // metric increase on link node1-node2 and overload of node2 are held down
+  adj12.metric_ref() = 5;
+  adjDb1 = openr::createAdjDb(n1, {adj12, adj13}, 1);
+  EXPECT_FALSE(state.updateAdjacencyDatabase(adjDb1, kTestingAreaName, 0, 1)
+                   .topologyChanged);
+  adjDb2.isOverloaded_ref() = true;
+  EXPECT_FALSE(state.updateAdjacencyDatabase(adjDb2, kTestingAreaName, 0, 1)
+                   .topologyChanged);
+  EXPECT_FALSE(state.isNodeOverloaded(n2));
+  EXPECT_TRUE(state.hasHolds());
+
+  // only held link and node are reported upon expiry
+  change = state.decrementHolds();
+  EXPECT_TRUE(change.topologyChanged);
+  EXPECT_THAT(change.updatedLinks, UnorderedElementsAre(Pointee(l1)));
+  EXPECT_THAT(change.updatedNodes, UnorderedElementsAre(n2));
+  EXPECT_TRUE(state.isNodeOverloaded(n2));
+  EXPECT_FALSE(state.hasHolds());
+  EXPECT_FALSE(state.decrementHolds().topologyChanged);
+}
+
 TEST(LinkStateTest, pathAInPathB) {
   auto l1 =
       std::make_shared<openr::Link>(kTestingAreaName, "1", "1/2", "2", "2/1");
@@ -327,6 +508,325 @@ TEST(LinkStateTest, getKthPaths) {
   }
 }
 
+/*
+ * Verify second paths found by SPF stopping at destination. Nodes past
+ * destinations are never settled.
+ *
+ *       10     10     10     10
+ *    1 ---- 2 ---- 3 ---- 6 ---- 7
+ *    |             |
+ *  10|             |10
+ *    |      10     |
+ *    4 ----------- 5
+ */
+TEST(LinkStateTest, KthPathsTowardsDest) {
+  LinkState state{kTestingAreaName};
+  const std::map<int, std::map<int, int>> adjs{
+      {1, {{2, 10}, {4, 10}}},
+      {2, {{1, 10}, {3, 10}}},
+      {3, {{2, 10}, {5, 10}, {6, 10}}},
+      {4, {{1, 10}, {5, 10}}},
+      {5, {{3, 10}, {4, 10}}},
+      {6, {{3, 10}, {7, 10}}},
+      {7, {{6, 10}}},
+  };
+  for (auto const& [node, adjMetrics] : adjs) {
+    state.updateAdjacencyDatabase(
+        createTestAdjDb(node, adjMetrics), kTestingAreaName, 0, 0);
+  }
+
+  auto getHops = [](LinkState::Path const& path) {
+    std::vector<std::string> hops{"1"};
+    for (auto const& link : path) {
+      hops.emplace_back(link->getOtherNodeName(hops.back()));
+    }
+    return hops;
+  };
+
+  auto const& secondTo3 = state.getKthPaths("1", "3", 2);
+  ASSERT_EQ(1, secondTo3.size());
+  EXPECT_THAT(getHops(secondTo3.front()), ElementsAre("1", "4", "5", "3"));
+
+  auto const& secondTo2 = state.getKthPaths("1", "2", 2);
+  ASSERT_EQ(1, secondTo2.size());
+  EXPECT_THAT(
+      getHops(secondTo2.front()), ElementsAre("1", "4", "5", "3", "2"));
+
+  // no edge-disjoint second path past node 3
+  EXPECT_TRUE(state.getKthPaths("1", "7", 2).empty());
+  EXPECT_TRUE(state.getKthPaths("1", "unknown", 2).empty());
+}
+
+/*
+ * Verify KSP2 paths computed concurrently towards all nodes are the same as
+ * the sequentially computed ones. Full mesh of 8 nodes with parallel links.
+ */
+TEST(LinkStateTest, ParallelKthPaths) {
+  std::unordered_map<int, std::vector<int>> mesh;
+  for (int node = 1; node <= 8; ++node) {
+    for (int adj = 1; adj <= 8; ++adj) {
+      if (adj != node) {
+        mesh[node].insert(mesh[node].end(), {adj, adj});
+      }
+    }
+  }
+  auto parallelState = openr::getLinkState(mesh);
+  auto sequentialState = openr::getLinkState(mesh);
+
+  std::vector<std::string> dests;
+  for (int node = 2; node <= 8; ++node) {
+    dests.emplace_back(fmt::format("{}", node));
+  }
+  folly::CPUThreadPoolExecutor executor(4);
+  parallelState.computeKthPaths("1", dests, 2, executor);
+
+  auto toStrings = [](std::vector<LinkState::Path> const& paths) {
+    std::vector<std::vector<std::string>> strs;
+    for (auto const& path : paths) {
+      auto& str = strs.emplace_back();
+      for (auto const& link : path) {
+        str.emplace_back(link->toString());
+      }
+    }
+    std::sort(strs.begin(), strs.end());
+    return strs;
+  };
+  for (auto const& dest : dests) {
+    for (size_t k = 1; k <= 2; ++k) {
+      auto const& paths = parallelState.getKthPaths("1", dest, k);
+      EXPECT_FALSE(paths.empty()) << dest;
+      EXPECT_EQ(
+          toStrings(sequentialState.getKthPaths("1", dest, k)),
+          toStrings(paths))
+          << dest << " k=" << k;
+    }
+  }
+}
+
+/*
+ * Verify SPF over flat topology snapshot is rebuilt as nodes and links come
+ * and go. Line topology 1 - 2 - 3, metric 10.
+ */
+TEST(LinkStateTest, SpfSnapshotRebuild) {
+  LinkState state{kTestingAreaName};
+
+  // root unknown to the topology
+  auto const& unknown = state.getSpfResult("1");
+  EXPECT_EQ(1, unknown.size());
+  EXPECT_EQ(0, unknown.at("1").metric());
+
+  state.updateAdjacencyDatabase(
+      createTestAdjDb(1, {{2, 10}}), kTestingAreaName, 0, 0);
+  state.updateAdjacencyDatabase(
+      createTestAdjDb(2, {{1, 10}, {3, 10}}), kTestingAreaName, 0, 0);
+  state.updateAdjacencyDatabase(
+      createTestAdjDb(3, {{2, 10}}), kTestingAreaName, 0, 0);
+  {
+    auto const& result = state.getSpfResult("1");
+    EXPECT_EQ(3, result.size());
+    EXPECT_EQ(20, result.at("3").metric());
+    EXPECT_THAT(result.at("3").nextHops(), UnorderedElementsAre("2"));
+    EXPECT_THAT(result.at("2").nextHops(), UnorderedElementsAre("2"));
+  }
+
+  // overloaded node is reachable but offers no transit
+  state.updateAdjacencyDatabase(
+      createTestAdjDb(2, {{1, 10}, {3, 10}}, true /* overloaded */),
+      kTestingAreaName,
+      0,
+      0);
+  {
+    auto const& result = state.getSpfResult("1");
+    EXPECT_EQ(2, result.size());
+    EXPECT_EQ(0, result.count("3"));
+  }
+
+  // node removed and added back with a different metric
+  state.deleteAdjacencyDatabase("2");
+  EXPECT_EQ(1, state.getSpfResult("1").size());
+  state.updateAdjacencyDatabase(
+      createTestAdjDb(2, {{1, 5}, {3, 5}}), kTestingAreaName, 0, 0);
+  {
+    auto const& result = state.getSpfResult("3");
+    EXPECT_EQ(3, result.size());
+    EXPECT_EQ(15, result.at("1").metric());
+    EXPECT_EQ(1, result.at("1").pathLinks().size());
+    EXPECT_EQ("2", result.at("1").pathLinks().front().prevNode);
+  }
+}
+
+/*
+ * [Parallel Link Compaction] parallel links with equal metric are relaxed
+ * as one edge, yet all of them show up as path links of SPF result.
+ *
+ * 1 =(4x metric 10, 1x metric 20)= 2 -- 3
+ */
+TEST(LinkStateTest, ParallelLinkCompaction) {
+  LinkState state{kTestingAreaName};
+  auto updateAdjDbs = [&state](std::vector<int32_t> const& parallelMetrics) {
+    std::vector<thrift::Adjacency> adjs1, adjs2;
+    for (size_t i = 0; i < parallelMetrics.size(); ++i) {
+      adjs1.emplace_back(createAdjacency(
+          "2",
+          fmt::format("1/2/{}", i),
+          fmt::format("2/1/{}", i),
+          "fe80::2",
+          "192.168.0.2",
+          parallelMetrics.at(i),
+          0));
+      adjs2.emplace_back(createAdjacency(
+          "1",
+          fmt::format("2/1/{}", i),
+          fmt::format("1/2/{}", i),
+          "fe80::1",
+          "192.168.0.1",
+          parallelMetrics.at(i),
+          0));
+    }
+    adjs2.emplace_back(createAdjacency(
+        "3", "2/3", "3/2", "fe80::3", "192.168.0.3", 10, 0));
+    state.updateAdjacencyDatabase(
+        createAdjDb("1", adjs1, 1, false, kTestingAreaName),
+        kTestingAreaName,
+        0,
+        0);
+    state.updateAdjacencyDatabase(
+        createAdjDb("2", adjs2, 2, false, kTestingAreaName),
+        kTestingAreaName,
+        0,
+        0);
+  };
+  updateAdjDbs({10, 20, 10, 10, 10});
+  state.updateAdjacencyDatabase(
+      createTestAdjDb(3, {{2, 10}}), kTestingAreaName, 0, 0);
+
+  auto expectPathLinks = [](LinkState::NodeSpfResult const& nodeResult,
+                            std::set<std::string> const& ifNames,
+                            std::string const& prevNode) {
+    std::set<std::string> pathIfNames;
+    for (auto const& pathLink : nodeResult.pathLinks()) {
+      EXPECT_EQ(prevNode, pathLink.prevNode);
+      pathIfNames.emplace(pathLink.link->getIfaceFromNode(prevNode));
+    }
+    EXPECT_EQ(ifNames, pathIfNames);
+  };
+  {
+    auto const& result = state.getSpfResult("1");
+    EXPECT_EQ(3, result.size());
+    EXPECT_EQ(10, result.at("2").metric());
+    expectPathLinks(result.at("2"), {"1/2/0", "1/2/2", "1/2/3", "1/2/4"}, "1");
+    EXPECT_EQ(20, result.at("3").metric());
+    expectPathLinks(result.at("3"), {"2/3"}, "2");
+    EXPECT_THAT(result.at("3").nextHops(), UnorderedElementsAre("2"));
+  }
+
+  // members of a bundle are dropped and changed individually
+  updateAdjDbs({10, 20, 30, 10});
+  {
+    auto const& result = state.getSpfResult("2");
+    expectPathLinks(result.at("1"), {"2/1/0", "2/1/3"}, "2");
+  }
+  updateAdjDbs({40, 20, 30});
+  {
+    auto const& result = state.getSpfResult("1");
+    EXPECT_EQ(20, result.at("2").metric());
+    expectPathLinks(result.at("2"), {"1/2/1"}, "1");
+  }
+}
+
+/*
+ * Apply same topology changes to link states with and without incremental SPF
+ * and verify that repaired SPF results match full SPF runs.
+ *
+ * 4x4 grid, node `4 * row + col + 1`, all metrics 10.
+ */
+TEST(LinkStateTest, IncrementalSpf) {
+  std::map<int, std::map<int, int>> grid;
+  for (int row = 0; row < 4; ++row) {
+    for (int col = 0; col < 4; ++col) {
+      const int node = 4 * row + col + 1;
+      if (col < 3) {
+        grid[node][node + 1] = 10;
+        grid[node + 1][node] = 10;
+      }
+      if (row < 3) {
+        grid[node][node + 4] = 10;
+        grid[node + 4][node] = 10;
+      }
+    }
+  }
+
+  LinkState incrementalState{kTestingAreaName, true /* incremental SPF */};
+  LinkState fullState{kTestingAreaName};
+  auto updateAdjDb = [&](int node,
+                         bool isOverloaded = false,
+                         LinkStateMetric holdUpTtl = 0) {
+    auto adjDb = createTestAdjDb(node, grid[node], isOverloaded);
+    auto change = incrementalState.updateAdjacencyDatabase(
+        adjDb, kTestingAreaName, holdUpTtl, 0);
+    EXPECT_EQ(
+        change,
+        fullState.updateAdjacencyDatabase(
+            adjDb, kTestingAreaName, holdUpTtl, 0));
+  };
+  auto verify = [&]() {
+    for (auto const& root : {"1", "6", "16"}) {
+      for (bool useLinkMetric : {true, false}) {
+        expectSameSpfResult(
+            incrementalState.getSpfResult(root, useLinkMetric),
+            fullState.getSpfResult(root, useLinkMetric));
+      }
+    }
+  };
+
+  for (auto const& [node, _] : grid) {
+    updateAdjDb(node);
+  }
+  verify();
+
+  fb303::fbData->resetAllData();
+
+  // metric decrease, one direction only
+  grid[6][7] = 1;
+  updateAdjDb(6);
+  verify();
+
+  // metric increase on shortest path
+  grid[1][2] = 100;
+  updateAdjDb(1);
+  verify();
+
+  // link down
+  grid[6].erase(10);
+  updateAdjDb(6);
+  verify();
+
+  // node overloaded and back
+  updateAdjDb(11, true /* overloaded */);
+  verify();
+  updateAdjDb(11);
+  verify();
+
+  // node removed and added back with hold
+  EXPECT_EQ(
+      incrementalState.deleteAdjacencyDatabase("7"),
+      fullState.deleteAdjacencyDatabase("7"));
+  verify();
+  updateAdjDb(7, false /* overloaded */, 1 /* holdUpTtl */);
+  verify();
+  EXPECT_EQ(incrementalState.decrementHolds(), fullState.decrementHolds());
+  verify();
+
+  // removal of the root itself
+  EXPECT_EQ(
+      incrementalState.deleteAdjacencyDatabase("1"),
+      fullState.deleteAdjacencyDatabase("1"));
+  verify();
+
+  auto counters = fb303::fbData->getCounters();
+  EXPECT_LT(0, counters.at("decision.incremental_spf_runs.count"));
+}
+
 TEST(LinkStateTest, UcmpTest) {
   // Ucmp algorithm: LWP
   //
@@ -482,6 +982,69 @@ TEST(LinkStateTest, UcmpTest) {
   }
 }
 
+TEST(LinkStateTest, UcmpMemoization) {
+  //  (4)    (5)  (6)
+  //    \   /   /   /
+  //     \ /   /   /
+  //     ( 2 )/  (3)
+  //       \     /
+  //        \   /
+  //        ( 1 )
+  auto linkState = openr::getLinkState({
+      {1, {2, 3}},
+      {2, {1, 4, 5, 6}},
+      {3, {1, 6}},
+      {4, {2}},
+      {5, {2}},
+      {6, {2, 3}},
+  });
+  const auto algo =
+      thrift::PrefixForwardingAlgorithm::SP_UCMP_PREFIX_WEIGHT_PROPAGATION;
+  const std::unordered_map<std::string, int64_t> leafWeights{
+      {"4", 2 * Constants::kDefaultAdjWeight},
+      {"5", Constants::kDefaultAdjWeight},
+      {"6", Constants::kDefaultAdjWeight}};
+  auto ucmpRuns = []() {
+    return fb303::fbData->getCounters().at("decision.ucmp_runs.count");
+  };
+
+  fb303::fbData->resetAllData();
+  auto const& ucmpResult = linkState.getUcmpResult("1", leafWeights, algo);
+  auto expectedUcmpResult = linkState.resolveUcmpWeights(
+      linkState.getSpfResult("1"), leafWeights, algo);
+  EXPECT_EQ(expectedUcmpResult.size(), ucmpResult.size());
+  EXPECT_THAT(
+      getNodeUcmpResults(ucmpResult.at("1")),
+      testing::UnorderedElementsAreArray(
+          getNodeUcmpResults(expectedUcmpResult.at("1"))));
+  EXPECT_EQ(4 * Constants::kDefaultAdjWeight, ucmpResult.at("2").weight());
+  EXPECT_EQ(2, ucmpRuns());
+
+  // same leaf weights are resolved once
+  EXPECT_EQ(&ucmpResult, &linkState.getUcmpResult("1", leafWeights, algo));
+  EXPECT_EQ(2, ucmpRuns());
+
+  // leaf weight change resolves a new entry
+  auto newLeafWeights = leafWeights;
+  newLeafWeights.at("4") = Constants::kDefaultAdjWeight;
+  auto const& newUcmpResult =
+      linkState.getUcmpResult("1", newLeafWeights, algo);
+  EXPECT_EQ(3, ucmpRuns());
+  EXPECT_EQ(
+      3 * Constants::kDefaultAdjWeight, newUcmpResult.at("2").weight());
+  EXPECT_EQ(&ucmpResult, &linkState.getUcmpResult("1", leafWeights, algo));
+  EXPECT_EQ(3, ucmpRuns());
+
+  // topology change invalidates memoized results
+  EXPECT_TRUE(linkState.deleteAdjacencyDatabase("5").topologyChanged);
+  auto const& ucmpResultNoNode5 =
+      linkState.getUcmpResult("1", leafWeights, algo);
+  EXPECT_EQ(4, ucmpRuns());
+  EXPECT_EQ(0, ucmpResultNoNode5.count("5"));
+  EXPECT_EQ(
+      3 * Constants::kDefaultAdjWeight, ucmpResultNoNode5.at("2").weight());
+}
+
 int
 main(int argc, char* argv[]) {
   // Parse command line flags
@@ -104,6 +104,117 @@ TEST_F(PrefixStateTestFixture, BasicOperation) {
       *entry);
 }
 
+/**
+ * Verifies prefixes are indexed by advertising node and KSP2 forwarding as
+ * prefix entries come and go
+ */
+TEST(PrefixState, PrefixesByNode) {
+  PrefixState state;
+  const auto prefix1 = toIpPrefix("10.0.0.0/8");
+  const auto prefix2 = toIpPrefix("11.0.0.0/8");
+  const NodeAndArea node0Area0{"node0", "area0"};
+  const NodeAndArea node1Area0{"node1", "area0"};
+
+  PrefixKey k1("node0", toIPNetwork(prefix1), "area0");
+  state.updatePrefix(k1, createPrefixEntry(prefix1));
+  PrefixKey k2("node0", toIPNetwork(prefix2), "area0");
+  state.updatePrefix(k2, createPrefixEntry(prefix2));
+  PrefixKey k3("node1", toIPNetwork(prefix1), "area0");
+  state.updatePrefix(
+      k3,
+      createPrefixEntry(
+          prefix1,
+          thrift::PrefixType::LOOPBACK,
+          "",
+          thrift::PrefixForwardingType::SR_MPLS,
+          thrift::PrefixForwardingAlgorithm::KSP2_ED_ECMP));
+
+  EXPECT_THAT(
+      state.getPrefixesByNode(node0Area0),
+      testing::UnorderedElementsAre(
+          toIPNetwork(prefix1), toIPNetwork(prefix2)));
+  EXPECT_THAT(
+      state.getPrefixesByNode(node1Area0),
+      testing::UnorderedElementsAre(toIPNetwork(prefix1)));
+  EXPECT_TRUE(state.getPrefixesByNode({"node0", "area1"}).empty());
+  EXPECT_THAT(
+      state.ksp2Prefixes(),
+      testing::UnorderedElementsAre(toIPNetwork(prefix1)));
+
+  // withdraw KSP2 entry
+  state.deletePrefix(k3);
+  EXPECT_TRUE(state.getPrefixesByNode(node1Area0).empty());
+  EXPECT_TRUE(state.ksp2Prefixes().empty());
+
+  state.deletePrefix(k1);
+  EXPECT_THAT(
+      state.getPrefixesByNode(node0Area0),
+      testing::UnorderedElementsAre(toIPNetwork(prefix2)));
+}
+
+/**
+ * Verifies that originators of the same prefix with identical attributes share
+ * the prefix entry, and that updating one of them does not affect the others
+ */
+TEST(PrefixState, SharedPrefixEntry) {
+  PrefixState state;
+  const auto prefix = toIpPrefix("10.0.0.0/8");
+  const NodeAndArea node0Area0{"node0", "area0"};
+  const NodeAndArea node1Area0{"node1", "area0"};
+  const NodeAndArea node2Area0{"node2", "area0"};
+
+  const auto entry = createPrefixEntry(prefix);
+  state.updatePrefix(PrefixKey("node0", toIPNetwork(prefix), "area0"), entry);
+  state.updatePrefix(PrefixKey("node1", toIPNetwork(prefix), "area0"), entry);
+  auto bgpEntry = createPrefixEntry(prefix, thrift::PrefixType::BGP);
+  state.updatePrefix(
+      PrefixKey("node2", toIPNetwork(prefix), "area0"), bgpEntry);
+
+  {
+    auto const& entries = state.prefixes().at(toIPNetwork(prefix));
+    EXPECT_EQ(entries.at(node0Area0).get(), entries.at(node1Area0).get());
+    EXPECT_NE(entries.at(node0Area0).get(), entries.at(node2Area0).get());
+  }
+
+  // node1 advertises the same attributes as node2
+  EXPECT_THAT(
+      state.updatePrefix(
+          PrefixKey("node1", toIPNetwork(prefix), "area0"), bgpEntry),
+      testing::UnorderedElementsAre(toIPNetwork(prefix)));
+  {
+    auto const& entries = state.prefixes().at(toIPNetwork(prefix));
+    EXPECT_EQ(entry, *entries.at(node0Area0));
+    EXPECT_EQ(bgpEntry, *entries.at(node1Area0));
+    EXPECT_EQ(entries.at(node1Area0).get(), entries.at(node2Area0).get());
+  }
+}
+
+TEST(PrefixState, SortedMetricVector) {
+  PrefixState state;
+  const auto prefix = toIpPrefix("10.0.0.0/8");
+  const PrefixKey key("node0", toIPNetwork(prefix), "area0");
+
+  // metric vector in increasing order of priority
+  auto entry = createPrefixEntry(prefix, thrift::PrefixType::BGP);
+  thrift::MetricVector mv;
+  mv.metrics_ref()->resize(3);
+  for (int64_t i = 0; i < 3; ++i) {
+    mv.metrics_ref()[i].type_ref() = i;
+    mv.metrics_ref()[i].priority_ref() = i;
+  }
+  entry.mv_ref() = mv;
+  EXPECT_FALSE(MetricVectorUtils::isSorted(mv));
+
+  // sorted when ingested
+  EXPECT_FALSE(state.updatePrefix(key, entry).empty());
+  auto const& entries = state.prefixes().at(toIPNetwork(prefix));
+  EXPECT_TRUE(MetricVectorUtils::isSorted(
+      *entries.at(key.getNodeAndArea())->mv_ref()));
+
+  // same unsorted advertisement isn't a change
+  EXPECT_TRUE(state.updatePrefix(key, entry).empty());
+}
+
 /**
  * Verifies `getReceivedRoutesFiltered` with all filter combinations
  */
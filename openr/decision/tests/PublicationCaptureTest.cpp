@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <unistd.h>
+
+#include <folly/FileUtil.h>
+#include <folly/experimental/TestUtil.h>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <openr/decision/PublicationCapture.h>
+
+using namespace openr;
+
+namespace {
+
+const std::chrono::system_clock::time_point kTs1{
+    std::chrono::microseconds(1000)};
+const std::chrono::system_clock::time_point kTs2{
+    std::chrono::microseconds(2500)};
+
+thrift::Publication
+createPublication() {
+  thrift::Value value;
+  value.version_ref() = 1;
+  value.originatorId_ref() = "node1";
+  value.value_ref() = "adj";
+  thrift::Publication pub;
+  pub.area_ref() = "area1";
+  pub.keyVals_ref()->emplace("adj:node1", value);
+  pub.expiredKeys_ref()->emplace_back("adj:node2");
+  return pub;
+}
+
+} // namespace
+
+TEST(PublicationCaptureTest, WriteRead) {
+  folly::test::TemporaryFile file;
+  const auto pub = createPublication();
+  {
+    PublicationCaptureWriter writer(file.path().string());
+    EXPECT_TRUE(writer.write(pub, kTs1).hasValue());
+    EXPECT_TRUE(
+        writer.write(thrift::InitializationEvent::KVSTORE_SYNCED, kTs2)
+            .hasValue());
+  }
+
+  const auto records = readPublicationCapture(file.path().string());
+  ASSERT_EQ(2, records.size());
+  EXPECT_EQ(1000, *records.at(0).timestampUs_ref());
+  ASSERT_TRUE(records.at(0).publication_ref().has_value());
+  EXPECT_EQ(pub, *records.at(0).publication_ref());
+  EXPECT_FALSE(records.at(0).initializationEvent_ref().has_value());
+  EXPECT_EQ(2500, *records.at(1).timestampUs_ref());
+  EXPECT_FALSE(records.at(1).publication_ref().has_value());
+  EXPECT_EQ(
+      thrift::InitializationEvent::KVSTORE_SYNCED,
+      records.at(1).initializationEvent_ref().value());
+
+  // Reopening appends to existing records
+  {
+    PublicationCaptureWriter writer(file.path().string());
+    EXPECT_TRUE(writer.write(pub, kTs2).hasValue());
+  }
+  EXPECT_EQ(3, readPublicationCapture(file.path().string()).size());
+}
+
+TEST(PublicationCaptureTest, TruncatedRecord) {
+  folly::test::TemporaryFile file;
+  {
+    PublicationCaptureWriter writer(file.path().string());
+    EXPECT_TRUE(writer.write(createPublication(), kTs1).hasValue());
+    EXPECT_TRUE(writer.write(createPublication(), kTs2).hasValue());
+  }
+  std::string content;
+  ASSERT_TRUE(folly::readFile(file.path().c_str(), content));
+  ASSERT_EQ(0, ::truncate(file.path().c_str(), content.size() - 3));
+
+  // Only the complete first record is returned
+  const auto records = readPublicationCapture(file.path().string());
+  ASSERT_EQ(1, records.size());
+  EXPECT_EQ(1000, *records.at(0).timestampUs_ref());
+}
+
+TEST(PublicationCaptureTest, Errors) {
+  EXPECT_THROW(
+      PublicationCaptureWriter("/nonexistent/dir/capture"), std::system_error);
+  EXPECT_THROW(
+      readPublicationCapture("/nonexistent/dir/capture"), std::runtime_error);
+
+  // Complete but malformed record
+  folly::test::TemporaryFile file;
+  const std::string garbage{"\x00\x00\x00\x02\xff\xff", 6};
+  ASSERT_TRUE(folly::writeFile(garbage, file.path().c_str()));
+  EXPECT_THROW(
+      readPublicationCapture(file.path().string()), std::runtime_error);
+}
+
+int
+main(int argc, char** argv) {
+  // Basic initialization
+  testing::InitGoogleTest(&argc, argv);
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = true;
+
+  // Run the tests
+  return RUN_ALL_TESTS();
+}
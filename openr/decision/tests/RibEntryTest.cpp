@@ -93,6 +93,104 @@ TEST(RibEntryTest, RibMplsEntry_filterNexthopsToUniqueAction) {
       std::unordered_set<thrift::NextHopThrift>({path1_3_1_php}));
 }
 
+TEST(RibEntryTest, RibUnicastEntry_fingerprint) {
+  const auto prefix = folly::IPAddress::createNetwork("fc00::/64");
+  auto nh1 = path1_2_1_swap;
+  auto nh2 = path1_3_1_swap;
+  nh1.weight_ref() = 1;
+  nh2.weight_ref() = 2;
+
+  RibUnicastEntry ribEntry(prefix, {nh1, nh2});
+  RibUnicastEntry sameRibEntry(prefix, {nh2, nh1});
+
+  // not stamped entries are deep compared
+  EXPECT_EQ(0, ribEntry.fingerprint);
+  EXPECT_TRUE(ribEntry.isSameRoute(sameRibEntry));
+
+  ribEntry.updateFingerprint();
+  sameRibEntry.updateFingerprint();
+  EXPECT_NE(0, ribEntry.fingerprint);
+  EXPECT_EQ(ribEntry.fingerprint, sameRibEntry.fingerprint);
+  EXPECT_TRUE(ribEntry.isSameRoute(sameRibEntry));
+
+  // weights swapped between next-hops
+  auto swappedNh1 = nh1;
+  auto swappedNh2 = nh2;
+  swappedNh1.weight_ref() = 2;
+  swappedNh2.weight_ref() = 1;
+  RibUnicastEntry swappedRibEntry(prefix, {swappedNh1, swappedNh2});
+  swappedRibEntry.updateFingerprint();
+  EXPECT_NE(ribEntry.fingerprint, swappedRibEntry.fingerprint);
+  EXPECT_FALSE(ribEntry.isSameRoute(swappedRibEntry));
+
+  // attributes other than next-hops
+  auto counterRibEntry = sameRibEntry;
+  counterRibEntry.counterID = "counter";
+  counterRibEntry.updateFingerprint();
+  EXPECT_FALSE(ribEntry.isSameRoute(counterRibEntry));
+
+  auto bestRouteRibEntry = sameRibEntry;
+  bestRouteRibEntry.bestPrefixEntry.minNexthop_ref() = 2;
+  bestRouteRibEntry.updateFingerprint();
+  EXPECT_EQ(ribEntry.fingerprint, bestRouteRibEntry.fingerprint);
+  EXPECT_FALSE(ribEntry.isSameRoute(bestRouteRibEntry));
+}
+
+TEST(RibEntryTest, RibMplsEntry_fingerprint) {
+  RibMplsEntry ribEntry(1, {path1_2_1_swap, path1_3_1_swap});
+  RibMplsEntry sameRibEntry(1, {path1_3_1_swap, path1_2_1_swap});
+  RibMplsEntry phpRibEntry(1, {path1_2_1_php, path1_3_1_php});
+  RibMplsEntry otherLabelRibEntry(2, {path1_2_1_swap, path1_3_1_swap});
+  for (auto* entry :
+       {&ribEntry, &sameRibEntry, &phpRibEntry, &otherLabelRibEntry}) {
+    entry->updateFingerprint();
+  }
+
+  EXPECT_TRUE(ribEntry.isSameRoute(sameRibEntry));
+  EXPECT_FALSE(ribEntry.isSameRoute(phpRibEntry));
+  EXPECT_FALSE(ribEntry.isSameRoute(otherLabelRibEntry));
+}
+
+TEST(RibEntryTest, NextHopGroup) {
+  auto& registry = NextHopGroupRegistry::getInstance();
+  const auto numGroups = registry.size();
+  {
+    RibUnicastEntry ribEntry(
+        folly::IPAddress::createNetwork("fc00::/64"),
+        {path1_2_1_swap, path1_3_1_swap});
+    RibMplsEntry sameNexthopsEntry(1, {path1_3_1_swap, path1_2_1_swap});
+    RibMplsEntry otherNexthopsEntry(1, {path1_2_1_swap});
+    EXPECT_EQ(nullptr, ribEntry.nexthopGroup);
+    ribEntry.internNexthops();
+    sameNexthopsEntry.internNexthops();
+    otherNexthopsEntry.internNexthops();
+
+    // same next-hops share group across route types
+    ASSERT_NE(nullptr, ribEntry.nexthopGroup);
+    EXPECT_EQ(ribEntry.nexthopGroup, sameNexthopsEntry.nexthopGroup);
+    EXPECT_NE(ribEntry.nexthopGroup, otherNexthopsEntry.nexthopGroup);
+    EXPECT_NE(ribEntry.nexthopGroup->id, otherNexthopsEntry.nexthopGroup->id);
+    EXPECT_EQ(ribEntry.nexthops, ribEntry.nexthopGroup->nexthops);
+    EXPECT_THAT(
+        *ribEntry.toThrift().nextHops_ref(),
+        testing::UnorderedElementsAre(path1_2_1_swap, path1_3_1_swap));
+    EXPECT_EQ(numGroups + 2, registry.size());
+
+    // group is released with its last reference
+    const auto id = ribEntry.nexthopGroup->id;
+    ribEntry.nexthopGroup.reset();
+    sameNexthopsEntry.nexthopGroup.reset();
+    EXPECT_EQ(numGroups + 1, registry.size());
+    ribEntry.internNexthops();
+    EXPECT_NE(id, ribEntry.nexthopGroup->id);
+
+    // group of altered next-hops is dropped
+    sameNexthopsEntry.filterNexthopsToUniqueAction();
+    EXPECT_EQ(nullptr, sameNexthopsEntry.nexthopGroup);
+  }
+  EXPECT_EQ(numGroups, registry.size());
+}
+
 } // namespace openr
 
 int
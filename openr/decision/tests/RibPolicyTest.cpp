@@ -330,6 +330,54 @@ TEST(RibPolicy, ApplyAction) {
   }
 }
 
+/**
+ * Verifies that statements matched by tag and by prefix are evaluated in their
+ * configured order
+ */
+TEST(RibPolicy, StatementOrder) {
+  std::vector<std::string> tags{"TAG1"};
+  const auto stmt1 = createPolicyStatement(std::nullopt, tags, 1, {}, {});
+  std::vector<thrift::IpPrefix> prefixes{
+      toIpPrefix("fc01::/64"), toIpPrefix("fc02::/64")};
+  const auto stmt2 = createPolicyStatement(prefixes, std::nullopt, 2, {}, {});
+  const auto stmt3 = createPolicyStatement(prefixes, tags, 3, {}, {});
+  auto policy = RibPolicy(createPolicy({stmt1, stmt2, stmt3}, 1));
+
+  const auto nh = createNextHop(toBinaryAddress("fe80::1"), "iface1", 0);
+
+  // Tagged route of a matching prefix (stmt1 gets applied)
+  {
+    RibUnicastEntry entry(folly::IPAddress::createNetwork("fc01::/64"), {nh});
+    entry.bestPrefixEntry.tags_ref()->insert("TAG1");
+    EXPECT_TRUE(policy.applyAction(entry));
+    EXPECT_EQ(1, *entry.nexthops.begin()->weight_ref());
+  }
+
+  // Untagged route of a matching prefix (stmt2 gets applied)
+  {
+    RibUnicastEntry entry(folly::IPAddress::createNetwork("fc02::/64"), {nh});
+    entry.bestPrefixEntry.tags_ref()->insert("TAG2");
+    EXPECT_TRUE(policy.applyAction(entry));
+    EXPECT_EQ(2, *entry.nexthops.begin()->weight_ref());
+  }
+
+  // Tagged route of a non matching prefix (stmt1 gets applied)
+  {
+    RibUnicastEntry entry(folly::IPAddress::createNetwork("fc03::/64"), {nh});
+    entry.bestPrefixEntry.tags_ref()->insert("TAG1");
+    EXPECT_TRUE(policy.match(entry));
+    EXPECT_TRUE(policy.applyAction(entry));
+    EXPECT_EQ(1, *entry.nexthops.begin()->weight_ref());
+  }
+
+  // Untagged route of a non matching prefix
+  {
+    RibUnicastEntry entry(folly::IPAddress::createNetwork("fc03::/64"), {nh});
+    EXPECT_FALSE(policy.match(entry));
+    EXPECT_FALSE(policy.applyAction(entry));
+  }
+}
+
 TEST(RibPolicy, ApplyPolicy) {
   std::vector<thrift::IpPrefix> prefixes1{toIpPrefix("fc01::/64")};
   const auto stmt1 = createPolicyStatement(
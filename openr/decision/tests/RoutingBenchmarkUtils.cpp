@@ -884,4 +884,290 @@ BM_DecisionFabricPrefixUpdates(
     }
   }
 }
+
+namespace {
+
+// nearest-rank percentile of samples in ascending order
+int64_t
+getPercentile(std::vector<int64_t> const& samples, uint32_t percentile) {
+  CHECK(not samples.empty());
+  auto rank = (samples.size() * percentile + 99) / 100;
+  return samples.at(std::max<size_t>(rank, 1) - 1);
+}
+
+//
+// Create publication applying churn to a random rsw, or reverting the one
+// applied to selectedNode by the previous call.
+//
+thrift::Publication
+createFabricChurnPublication(
+    const std::shared_ptr<DecisionWrapper>& decisionWrapper,
+    FabricChurn churn,
+    std::optional<std::pair<int, int>>& selectedNode,
+    const int numOfPods,
+    const int numOfFswsPerPod,
+    thrift::PrefixForwardingAlgorithm forwardingAlgorithm,
+    const int64_t version) {
+  const bool revert = selectedNode.has_value();
+  auto podId = revert ? selectedNode->first
+                      : folly::Random::rand32() % numOfPods;
+  auto rswIdInPod = revert ? selectedNode->second
+                           : folly::Random::rand32() % kNumOfRswsPerPod;
+  selectedNode = revert
+      ? std::nullopt
+      : std::optional<std::pair<int, int>>(std::make_pair(podId, rswIdInPod));
+
+  auto rswNodeName = getNodeName(kRswMarker, podId, rswIdInPod);
+  thrift::PerfEvents perfEvents;
+  addPerfEvent(perfEvents, rswNodeName, "DECISION_CHURN_UPDATE");
+
+  thrift::Publication pub;
+  pub.area_ref() = kTestingAreaName;
+  if (churn == FabricChurn::PREFIX_CHURN) {
+    apache::thrift::CompactSerializer serializer;
+    for (int i = 0; i < kNumOfChurnPrefixes; ++i) {
+      auto prefixEntry = createPrefixEntry(toIpPrefix(fmt::format(
+          "fc01:{:x}:{:x}:{:x}::/64", podId, rswIdInPod, i)));
+      prefixEntry.forwardingType_ref() =
+          (thrift::PrefixForwardingAlgorithm::KSP2_ED_ECMP ==
+                   forwardingAlgorithm
+               ? thrift::PrefixForwardingType::SR_MPLS
+               : thrift::PrefixForwardingType::IP);
+      prefixEntry.forwardingAlgorithm_ref() = forwardingAlgorithm;
+      auto [prefixKey, prefixDb] = createPrefixKeyAndDb(
+          rswNodeName, prefixEntry, kTestingAreaName, revert /* withdraw */);
+      prefixDb.perfEvents_ref() = perfEvents;
+      pub.keyVals_ref()->emplace(
+          prefixKey.getPrefixKeyV2(),
+          createThriftValue(
+              version,
+              rswNodeName,
+              writeThriftObjStr(std::move(prefixDb), serializer)));
+    }
+    return pub;
+  }
+
+  // ADJ_FLAP takes down the uplink towards the first fsw of the pod
+  std::vector<thrift::Adjacency> adjsRsw;
+  for (int otherId = 0; otherId < numOfFswsPerPod; otherId += 1) {
+    if (churn == FabricChurn::ADJ_FLAP and not revert and otherId == 0) {
+      continue;
+    }
+    createFabricAdjacency(rswNodeName, kFswMarker, podId, otherId, adjsRsw);
+  }
+  auto overloadBit = churn == FabricChurn::NODE_DRAIN and not revert;
+  pub.keyVals_ref() = {
+      {fmt::format("adj:{}", rswNodeName),
+       decisionWrapper->createAdjValue(
+           rswNodeName, version, adjsRsw, std::move(perfEvents), overloadBit)}};
+  return pub;
+}
+
+} // namespace
+
+void
+BM_DecisionFabricChurn(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    uint32_t numOfPods,
+    uint32_t numOfPlanes,
+    uint32_t numberOfPrefixes,
+    FabricChurn churn,
+    thrift::PrefixForwardingAlgorithm forwardingAlgorithm) {
+  auto suspender = folly::BenchmarkSuspender();
+  SystemMetrics sysMetrics;
+  const std::string nodeName = getNodeName(kFswMarker, 0, 0);
+  auto decisionWrapper = std::make_shared<DecisionWrapper>(
+      nodeName,
+      forwardingAlgorithm ==
+          thrift::PrefixForwardingAlgorithm::SP_UCMP_ADJ_WEIGHT_PROPAGATION);
+  std::unordered_map<std::string, std::vector<std::string>> listOfNodenames;
+
+  auto initialPub = createFabric(
+      decisionWrapper,
+      numOfPods,
+      numOfPlanes,
+      kNumOfSswsPerPlane,
+      numOfPlanes, // numOfFswsPerPod == numOfPlanes
+      kNumOfRswsPerPod,
+      listOfNodenames);
+  generatePrefixUpdatePublication(
+      numberOfPrefixes, listOfNodenames, forwardingAlgorithm, initialPub);
+  decisionWrapper->sendKvPublication(initialPub);
+  decisionWrapper->sendKvStoreSyncedEvent();
+  decisionWrapper->recvMyRouteDb();
+
+  std::optional<std::pair<int, int>> selectedNode = std::nullopt;
+  std::vector<int64_t> rebuildMs;
+  size_t peakRssBytes{0};
+  for (uint32_t i = 0; i < iters; i++) {
+    auto pub = createFabricChurnPublication(
+        decisionWrapper,
+        churn,
+        selectedNode,
+        numOfPods,
+        numOfPlanes,
+        forwardingAlgorithm,
+        i + 2 /* version */);
+
+    suspender.dismiss(); // Start measuring benchmark time
+    decisionWrapper->sendKvPublication(pub);
+    auto routeUpdate = decisionWrapper->recvMyRouteDb();
+    suspender.rehire(); // Stop measuring time again
+
+    if (routeUpdate.perfEvents.has_value()) {
+      auto duration = getDurationBetweenPerfEvents(
+          *routeUpdate.perfEvents, "DECISION_DEBOUNCE", "ROUTE_UPDATE");
+      if (duration.hasValue()) {
+        rebuildMs.emplace_back(duration->count());
+      }
+    }
+    if (auto rss = sysMetrics.getRSSMemBytes()) {
+      peakRssBytes = std::max(peakRssBytes, rss.value());
+    }
+  }
+
+  if (not rebuildMs.empty()) {
+    std::sort(rebuildMs.begin(), rebuildMs.end());
+    counters["rebuild_p50(ms)"] = getPercentile(rebuildMs, 50);
+    counters["rebuild_p99(ms)"] = getPercentile(rebuildMs, 99);
+  }
+  counters["peak_rss(MB)"] = peakRssBytes / 1024 / 1024;
+}
+
+namespace {
+
+// adjacency list of node ids with metric of each link
+using SpfGraph =
+    std::vector<std::vector<std::pair<uint32_t, LinkStateMetric>>>;
+
+void
+addSpfGraphLink(SpfGraph& graph, uint32_t a, uint32_t b) {
+  const LinkStateMetric metric = folly::Random::rand32(1, 11);
+  graph[a].emplace_back(b, metric);
+  graph[b].emplace_back(a, metric);
+}
+
+SpfGraph
+createSpfGraph(SpfTopology topology, uint32_t scale) {
+  SpfGraph graph;
+  if (topology == SpfTopology::GRID) {
+    const uint32_t n = std::sqrt(scale);
+    graph.resize(n * n);
+    for (uint32_t row = 0; row < n; ++row) {
+      for (uint32_t col = 0; col < n; ++col) {
+        const uint32_t node = row * n + col;
+        if (col + 1 < n) {
+          addSpfGraphLink(graph, node, node + 1);
+        }
+        if (row + 1 < n) {
+          addSpfGraphLink(graph, node, node + n);
+        }
+      }
+    }
+    return graph;
+  }
+
+  // k-ary fat-tree: k pods of k/2 edge and k/2 aggregation switches, and
+  // (k/2)^2 core switches
+  const uint32_t k = scale;
+  const uint32_t half = k / 2;
+  const uint32_t numPodSws = k * k;
+  graph.resize(numPodSws + half * half);
+  for (uint32_t pod = 0; pod < k; ++pod) {
+    const uint32_t edgeBase = pod * k;
+    const uint32_t aggBase = edgeBase + half;
+    for (uint32_t agg = 0; agg < half; ++agg) {
+      for (uint32_t edge = 0; edge < half; ++edge) {
+        addSpfGraphLink(graph, edgeBase + edge, aggBase + agg);
+      }
+      for (uint32_t core = 0; core < half; ++core) {
+        addSpfGraphLink(graph, aggBase + agg, numPodSws + agg * half + core);
+      }
+    }
+  }
+  return graph;
+}
+
+// Dijkstra with string keyed DijkstraQ
+LinkStateMetric
+runDijkstraQ(
+    SpfGraph const& graph,
+    std::vector<std::string> const& names,
+    std::unordered_map<std::string, uint32_t> const& ids) {
+  std::vector<bool> settled(graph.size(), false);
+  LinkStateMetric total{0};
+  DijkstraQ<DijkstraQSpfNode> q;
+  q.insertNode(names[0], 0);
+  while (auto node = q.extractMin()) {
+    const auto id = ids.at(node->nodeName);
+    const auto metric = node->metric();
+    settled[id] = true;
+    total += metric;
+    for (auto const& [otherId, linkMetric] : graph[id]) {
+      if (settled[otherId]) {
+        continue;
+      }
+      auto otherNode = q.get(names[otherId]);
+      if (not otherNode) {
+        q.insertNode(names[otherId], metric + linkMetric);
+      } else if (otherNode->metric() > metric + linkMetric) {
+        otherNode->result.reset(metric + linkMetric);
+        q.reMake();
+      }
+    }
+  }
+  return total;
+}
+
+// Dijkstra with indexed d-ary heap, reused across runs
+LinkStateMetric
+runIndexedHeap(
+    SpfGraph const& graph,
+    IndexedDaryHeap<std::pair<LinkStateMetric, uint32_t>>& q,
+    std::vector<LinkStateMetric>& metrics) {
+  metrics.assign(graph.size(), std::numeric_limits<LinkStateMetric>::max());
+  LinkStateMetric total{0};
+  metrics[0] = 0;
+  q.push(0, {0, 0});
+  while (not q.empty()) {
+    const auto id = q.pop().second;
+    const auto metric = metrics[id];
+    total += metric;
+    for (auto const& [otherId, linkMetric] : graph[id]) {
+      if (metrics[otherId] > metric + linkMetric) {
+        metrics[otherId] = metric + linkMetric;
+        q.pushOrDecreaseKey(otherId, {metric + linkMetric, otherId});
+      }
+    }
+  }
+  return total;
+}
+
+} // namespace
+
+void
+BM_SpfQueue(
+    uint32_t iters, SpfTopology topology, uint32_t scale, SpfQueue queue) {
+  auto suspender = folly::BenchmarkSuspender();
+  const auto graph = createSpfGraph(topology, scale);
+  std::vector<std::string> names;
+  std::unordered_map<std::string, uint32_t> ids;
+  for (uint32_t id = 0; id < graph.size(); ++id) {
+    names.emplace_back(fmt::format("node-{}", id));
+    ids.emplace(names.back(), id);
+  }
+  IndexedDaryHeap<std::pair<LinkStateMetric, uint32_t>> q;
+  std::vector<LinkStateMetric> metrics;
+
+  suspender.dismiss(); // Start measuring benchmark time
+
+  for (uint32_t i = 0; i < iters; i++) {
+    folly::doNotOptimizeAway(
+        queue == SpfQueue::DIJKSTRA_Q ? runDijkstraQ(graph, names, ids)
+                                      : runIndexedHeap(graph, q, metrics));
+  }
+
+  suspender.rehire(); // Stop measuring time again
+}
 } // namespace openr
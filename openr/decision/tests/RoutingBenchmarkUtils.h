@@ -93,6 +93,8 @@ namespace {
 // We have 24 SSWs per plane as of now and moving towards 36 per plane.
 const int kNumOfSswsPerPlane = 36;
 const int kNumOfRswsPerPod = 48;
+// Prefixes withdrawn and re-advertised by rsw upon PREFIX_CHURN
+const int kNumOfChurnPrefixes = 100;
 const uint8_t kSswMarker = 1;
 const uint8_t kFswMarker = 2;
 const uint8_t kRswMarker = 3;
@@ -110,8 +112,10 @@ using apache::thrift::CompactSerializer;
 //
 class DecisionWrapper {
  public:
-  explicit DecisionWrapper(const std::string& nodeName) {
+  explicit DecisionWrapper(
+      const std::string& nodeName, bool enableUcmp = false) {
     auto tConfig = getBasicOpenrConfig(nodeName);
+    tConfig.enable_ucmp_ref() = enableUcmp;
     // decision config
     tConfig.decision_config_ref()->debounce_min_ms_ref() = 10;
     tConfig.decision_config_ref()->debounce_max_ms_ref() = 500;
@@ -213,7 +217,7 @@ class DecisionWrapper {
 
   std::shared_ptr<Config> config;
   messaging::ReplicateQueue<PeerEvent> peerUpdatesQueue;
-  messaging::ReplicateQueue<KvStorePublication> kvStoreUpdatesQueue;
+  messaging::SharedReplicateQueue<KvStorePublication> kvStoreUpdatesQueue;
   messaging::ReplicateQueue<DecisionRouteUpdate> routeUpdatesQueue;
   messaging::ReplicateQueue<DecisionRouteUpdate> staticRouteUpdatesQueue;
   messaging::RQueue<DecisionRouteUpdate> routeUpdatesQueueReader{
@@ -451,6 +455,40 @@ void BM_DecisionFabricPrefixUpdates(
     uint32_t numOfUpdatePrefixes,
     thrift::PrefixForwardingAlgorithm forwardingAlgorithm);
 
+//
+// Benchmark test for route rebuild latency of a fabric under churn. Each
+// iteration applies one change to a random rsw, reverted by the next one:
+//  - ADJ_FLAP: one uplink of the rsw goes down, or up again;
+//  - NODE_DRAIN: overload bit of the rsw is set, or cleared;
+//  - PREFIX_CHURN: the rsw withdraws kNumOfChurnPrefixes prefixes, or
+//    re-advertises them;
+// Reports p50/p99 rebuild latency, i.e. from debounce to route update, and
+// peak RSS across iterations.
+//
+enum class FabricChurn { ADJ_FLAP, NODE_DRAIN, PREFIX_CHURN };
+
+void BM_DecisionFabricChurn(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    uint32_t numOfPods,
+    uint32_t numOfPlanes,
+    uint32_t numberOfPrefixes,
+    FabricChurn churn,
+    thrift::PrefixForwardingAlgorithm forwardingAlgorithm);
+
+//
+// Benchmark test for SPF priority queues, over a plain graph of integer node
+// ids with random metrics. For grid, scale is the number of nodes. For
+// fat-tree, scale is the (even) number of ports per switch.
+//
+enum class SpfTopology { GRID, FAT_TREE };
+enum class SpfQueue { DIJKSTRA_Q, INDEXED_HEAP };
+
+void BM_SpfQueue(
+    uint32_t iters, SpfTopology topology, uint32_t scale, SpfQueue queue);
+
 const auto SP_ECMP = thrift::PrefixForwardingAlgorithm::SP_ECMP;
 const auto KSP2_ED_ECMP = thrift::PrefixForwardingAlgorithm::KSP2_ED_ECMP;
+const auto SP_UCMP =
+    thrift::PrefixForwardingAlgorithm::SP_UCMP_ADJ_WEIGHT_PROPAGATION;
 } // namespace openr
@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <set>
+#include <thread>
+
+#include <fmt/format.h>
+#include <folly/init/Init.h>
+#include <folly/logging/xlog.h>
+
+#include <openr/common/LsdbUtil.h>
+#include <openr/config/Config.h>
+#include <openr/decision/Decision.h>
+#include <openr/decision/PublicationCapture.h>
+#include <openr/messaging/ReplicateQueue.h>
+#include <openr/tests/utils/Utils.h>
+
+DEFINE_string(
+    capture_file, "", "Publications recorded with publication_capture_file");
+DEFINE_string(
+    config_file,
+    "",
+    "Open/R config of the recording node. Basic config with areas of the "
+    "capture is used if not set");
+DEFINE_string(node_name, "", "Name of the recording node");
+DEFINE_double(
+    speed, 1.0, "Replay speed relative to recording, 0 for no delays at all");
+DEFINE_int32(drain_ms, 2000, "Time to wait for route rebuilds after replay");
+
+namespace {
+
+struct RebuildStats {
+  std::vector<int64_t> computeMs;
+  size_t numRebuilds{0};
+};
+
+std::shared_ptr<const openr::Config>
+getReplayConfig(const std::vector<openr::thrift::PublicationRecord>& records) {
+  openr::thrift::OpenrConfig tConfig;
+  if (not FLAGS_config_file.empty()) {
+    tConfig = openr::Config(FLAGS_config_file).getConfig();
+  } else {
+    std::set<std::string> areas;
+    for (const auto& record : records) {
+      if (auto pub = record.publication_ref()) {
+        areas.emplace(*pub->area_ref());
+      }
+    }
+    std::vector<openr::thrift::AreaConfig> areaConfigs;
+    for (const auto& area : areas) {
+      areaConfigs.emplace_back(openr::createAreaConfig(area, {".*"}, {".*"}));
+    }
+    tConfig = openr::getBasicOpenrConfig(FLAGS_node_name, areaConfigs);
+  }
+  if (not FLAGS_node_name.empty()) {
+    tConfig.node_name_ref() = FLAGS_node_name;
+  }
+  // Peers are not replayed, and replay must not record itself
+  tConfig.enable_ordered_adj_publication_ref() = false;
+  tConfig.decision_config_ref()->publication_capture_file_ref().reset();
+  return std::make_shared<const openr::Config>(tConfig);
+}
+
+void
+printRouteUpdate(
+    const openr::DecisionRouteUpdate& update, RebuildStats& stats) {
+  ++stats.numRebuilds;
+  std::string timing{"no perf events"};
+  if (update.perfEvents.has_value()) {
+    // Event preceding ROUTE_UPDATE is the trigger of the rebuild, e.g.
+    // DECISION_DEBOUNCE, past the rebuild selection of [Rebuild Cost Model]
+    const auto& events = *update.perfEvents->events_ref();
+    auto it = std::find_if(events.cbegin(), events.cend(), [](auto& event) {
+      return *event.eventDescr_ref() == "ROUTE_UPDATE";
+    });
+    auto triggerIt = it;
+    while (triggerIt != events.cbegin() and
+           std::prev(triggerIt)->eventDescr_ref()->find("_REBUILD_SELECTED") !=
+               std::string::npos) {
+      --triggerIt;
+    }
+    if (it != events.cend() and triggerIt != events.cbegin()) {
+      const auto& trigger = *std::prev(triggerIt)->eventDescr_ref();
+      const auto computeMs =
+          *it->unixTs_ref() - *std::prev(triggerIt)->unixTs_ref();
+      stats.computeMs.emplace_back(computeMs);
+      const auto waitMs = openr::getDurationBetweenPerfEvents(
+          *update.perfEvents, "DECISION_RECEIVED", trigger);
+      timing = fmt::format(
+          "{}: wait {} compute {}ms",
+          trigger,
+          waitMs.hasValue() ? fmt::format("{}ms", waitMs->count()) : "n/a",
+          computeMs);
+    }
+  }
+  std::cout << fmt::format(
+                   "rebuild {:>5} {:<48} unicast +{}/-{} mpls +{}/-{}",
+                   stats.numRebuilds,
+                   timing,
+                   update.unicastRoutesToUpdate.size(),
+                   update.unicastRoutesToDelete.size(),
+                   update.mplsRoutesToUpdate.size(),
+                   update.mplsRoutesToDelete.size())
+            << std::endl;
+}
+
+void
+printSummary(RebuildStats& stats) {
+  auto& computeMs = stats.computeMs;
+  std::sort(computeMs.begin(), computeMs.end());
+  auto percentile = [&computeMs](size_t pct) -> int64_t {
+    if (computeMs.empty()) {
+      return 0;
+    }
+    return computeMs.at((computeMs.size() - 1) * pct / 100);
+  };
+  std::cout << fmt::format(
+                   "{} rebuilds, compute p50: {}ms p90: {}ms max: {}ms",
+                   stats.numRebuilds,
+                   percentile(50),
+                   percentile(90),
+                   percentile(100))
+            << std::endl;
+}
+
+} // namespace
+
+int
+main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  CHECK(not FLAGS_capture_file.empty()) << "--capture_file is required";
+  CHECK_GE(FLAGS_speed, 0) << "--speed must not be negative";
+
+  const auto records = openr::readPublicationCapture(FLAGS_capture_file);
+  XLOG(INFO) << "Replaying " << records.size() << " records of "
+             << FLAGS_capture_file;
+  const auto config = getReplayConfig(records);
+
+  openr::messaging::ReplicateQueue<openr::PeerEvent> peerUpdatesQueue;
+  openr::messaging::SharedReplicateQueue<openr::KvStorePublication>
+      kvStoreUpdatesQueue;
+  openr::messaging::ReplicateQueue<openr::DecisionRouteUpdate>
+      staticRouteUpdatesQueue;
+  openr::messaging::ReplicateQueue<openr::DecisionRouteUpdate>
+      routeUpdatesQueue;
+
+  auto decision = std::make_unique<openr::Decision>(
+      config,
+      peerUpdatesQueue.getReader(),
+      kvStoreUpdatesQueue.getReader(),
+      staticRouteUpdatesQueue.getReader(),
+      routeUpdatesQueue);
+  std::thread decisionThread([&decision]() { decision->run(); });
+  decision->waitUntilRunning();
+
+  RebuildStats stats;
+  std::thread routeReaderThread(
+      [reader = routeUpdatesQueue.getReader(), &stats]() mutable {
+        while (auto maybeUpdate = reader.get()) {
+          printRouteUpdate(*maybeUpdate, stats);
+        }
+      });
+
+  // Static routes are not recorded, unblock initial route build
+  for (auto type :
+       {openr::thrift::PrefixType::BGP,
+        openr::thrift::PrefixType::VIP,
+        openr::thrift::PrefixType::CONFIG}) {
+    openr::DecisionRouteUpdate update;
+    update.prefixType = type;
+    staticRouteUpdatesQueue.push(std::move(update));
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  const int64_t firstTsUs =
+      records.empty() ? 0 : *records.front().timestampUs_ref();
+  for (const auto& record : records) {
+    if (FLAGS_speed > 0) {
+      std::this_thread::sleep_until(
+          start +
+          std::chrono::microseconds(static_cast<int64_t>(
+              (*record.timestampUs_ref() - firstTsUs) / FLAGS_speed)));
+    }
+    if (auto pub = record.publication_ref()) {
+      kvStoreUpdatesQueue.push(*pub);
+    } else if (auto event = record.initializationEvent_ref()) {
+      kvStoreUpdatesQueue.push(*event);
+    }
+  }
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(FLAGS_drain_ms));
+  peerUpdatesQueue.close();
+  kvStoreUpdatesQueue.close();
+  staticRouteUpdatesQueue.close();
+  decision->stop();
+  decisionThread.join();
+  routeUpdatesQueue.close();
+  routeReaderThread.join();
+
+  printSummary(stats);
+  return 0;
+}
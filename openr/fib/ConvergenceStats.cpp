@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include <fb303/ServiceData.h>
+#include <fmt/format.h>
+
+#include <openr/common/Constants.h>
+#include <openr/fib/ConvergenceStats.h>
+
+namespace fb303 = facebook::fb303;
+
+namespace openr {
+
+namespace {
+
+std::string
+getCounterKey(thrift::ConvergenceType type, const std::string& stage) {
+  return fmt::format(
+      "fib.convergence.{}.{}_ms",
+      type == thrift::ConvergenceType::ADJACENCY ? "adj" : "prefix",
+      stage == ConvergenceStats::kTotalStage ? "total" : stage);
+}
+
+// Value of rank `pct` in [0, 100] of non empty `sortedValues`
+int64_t
+getPercentile(const std::vector<int64_t>& sortedValues, double pct) {
+  const size_t rank = std::ceil(pct / 100.0 * sortedValues.size());
+  return sortedValues.at(std::clamp<size_t>(rank, 1, sortedValues.size()) - 1);
+}
+
+} // namespace
+
+thrift::ConvergenceType
+ConvergenceStats::getConvergenceType(const thrift::PerfEvents& perfEvents) {
+  const auto& events = *perfEvents.events_ref();
+  if (not events.empty() and
+      *events.front().eventDescr_ref() == "ADJ_DB_UPDATED") {
+    return thrift::ConvergenceType::ADJACENCY;
+  }
+  return thrift::ConvergenceType::PREFIX;
+}
+
+void
+ConvergenceStats::addPerfEvents(const thrift::PerfEvents& perfEvents) {
+  const auto& events = *perfEvents.events_ref();
+  if (events.empty()) {
+    return;
+  }
+  const auto type = getConvergenceType(perfEvents);
+  addDuration(
+      type,
+      kTotalStage.str(),
+      *events.back().unixTs_ref() - *events.front().unixTs_ref());
+  for (size_t i = 1; i < events.size(); ++i) {
+    addDuration(
+        type,
+        *events.at(i).eventDescr_ref(),
+        *events.at(i).unixTs_ref() - *events.at(i - 1).unixTs_ref());
+  }
+}
+
+void
+ConvergenceStats::addDuration(
+    thrift::ConvergenceType type,
+    const std::string& stage,
+    int64_t durationMs) {
+  // events of other nodes may be slightly off due to clock skew
+  durationMs = std::max<int64_t>(durationMs, 0);
+
+  auto [it, inserted] = samples_.try_emplace(std::make_pair(type, stage));
+  const auto key = getCounterKey(type, stage);
+  if (inserted) {
+    fb303::fbData->addHistogram(
+        key,
+        10 /* bucket width */,
+        0 /* min */,
+        std::chrono::milliseconds(Constants::kConvergenceMaxDuration).count());
+    fb303::fbData->exportHistogramPercentile(key, 50, 95, 99);
+  }
+  fb303::fbData->addHistogramValue(key, durationMs);
+
+  auto& samples = it->second;
+  ++samples.count;
+  samples.durationsMs.push_back(durationMs);
+  while (samples.durationsMs.size() > Constants::kConvergenceStatsSamples) {
+    samples.durationsMs.pop_front();
+  }
+}
+
+std::vector<thrift::ConvergenceDistribution>
+ConvergenceStats::getDistributions() const {
+  std::vector<thrift::ConvergenceDistribution> distributions;
+  distributions.reserve(samples_.size());
+  for (const auto& [key, samples] : samples_) {
+    std::vector<int64_t> sortedValues(
+        samples.durationsMs.begin(), samples.durationsMs.end());
+    std::sort(sortedValues.begin(), sortedValues.end());
+
+    auto& distribution = distributions.emplace_back();
+    distribution.type_ref() = key.first;
+    distribution.stage_ref() = key.second;
+    distribution.count_ref() = samples.count;
+    distribution.numSamples_ref() = sortedValues.size();
+    distribution.p50Ms_ref() = getPercentile(sortedValues, 50);
+    distribution.p90Ms_ref() = getPercentile(sortedValues, 90);
+    distribution.p99Ms_ref() = getPercentile(sortedValues, 99);
+    distribution.maxMs_ref() = sortedValues.back();
+  }
+  return distributions;
+}
+
+} // namespace openr
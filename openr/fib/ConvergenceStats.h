@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <folly/Range.h>
+
+#include <openr/if/gen-cpp2/Types_types.h>
+
+namespace openr {
+
+/**
+ * [Convergence Stats] Distributions of route convergence durations, derived
+ * from perf events of route updates once programmed by Fib. Updates are
+ * classified by their first event, ADJ_DB_UPDATED for adjacency changes and
+ * anything else for prefix changes. The end-to-end duration spans from first
+ * to last event, every other stage is timed from the previous event and keyed
+ * by description of the event ending it.
+ *
+ * Exported as fb303 histograms `fib.convergence.<type>.<stage>_ms` with
+ * p50, p95 and p99. Percentiles of the ctrl API are exact, computed over the
+ * latest `kConvergenceStatsSamples` durations of each stage.
+ *
+ * NOTE: Not thread-safe
+ */
+class ConvergenceStats {
+ public:
+  static constexpr folly::StringPiece kTotalStage{"TOTAL"};
+
+  static thrift::ConvergenceType getConvergenceType(
+      const thrift::PerfEvents& perfEvents);
+
+  // Record durations of a programmed update, ignored if it has no events
+  void addPerfEvents(const thrift::PerfEvents& perfEvents);
+
+  std::vector<thrift::ConvergenceDistribution> getDistributions() const;
+
+ private:
+  struct Samples {
+    int64_t count{0};
+    std::deque<int64_t> durationsMs;
+  };
+
+  void addDuration(
+      thrift::ConvergenceType type,
+      const std::string& stage,
+      int64_t durationMs);
+
+  std::map<std::pair<thrift::ConvergenceType, std::string>, Samples> samples_;
+};
+
+} // namespace openr
@@ -7,12 +7,16 @@
 
 #include <fb303/ServiceData.h>
 #include <folly/IPAddress.h>
+#include <folly/String.h>
 #include <folly/logging/xlog.h>
+#include <thrift/lib/cpp/TApplicationException.h>
 #include <thrift/lib/cpp2/async/HeaderClientChannel.h>
 
 #include <openr/common/Constants.h>
+#include <openr/common/ConvergenceTracer.h>
 #include <openr/common/LsdbUtil.h>
 #include <openr/common/NetworkUtil.h>
+#include <openr/common/Pagination.h>
 #include <openr/fib/Fib.h>
 
 namespace fb303 = facebook::fb303;
@@ -44,20 +48,110 @@ logFibUpdateError(thrift::PlatformFibUpdateError const& error) {
   }
 }
 
+// Get rid of doNotInstall routes and filter MPLS next-hops to unique action
+void
+filterRouteUpdate(DecisionRouteUpdate& routeUpdate) {
+  auto iter = routeUpdate.unicastRoutesToUpdate.cbegin();
+  while (iter != routeUpdate.unicastRoutesToUpdate.cend()) {
+    if (iter->second.doNotInstall) {
+      XLOG(INFO) << "Not installing route for prefix "
+                 << folly::IPAddress::networkToString(iter->first);
+      iter = routeUpdate.unicastRoutesToUpdate.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+
+  for (auto& [_, mplsRoute] : routeUpdate.mplsRoutesToUpdate) {
+    mplsRoute.filterNexthopsToUniqueAction();
+  }
+}
+
+// Merge add/updates and deletes of one route type into the pending ones.
+// Returns number of route operations avoided. See [Update Coalescing]
+template <typename Key, typename Entry, typename IsKnown>
+size_t
+coalesceRoutes(
+    std::unordered_map<Key, Entry>& pendingToUpdate,
+    std::vector<Key>& pendingToDelete,
+    std::unordered_map<Key, Entry>&& toUpdate,
+    std::vector<Key>&& toDelete,
+    const IsKnown& isKnown) {
+  size_t numAvoided{0};
+  std::unordered_set<Key> pendingDeletes(
+      pendingToDelete.begin(), pendingToDelete.end());
+
+  // Delete supersedes pending add/update. Add followed by delete of a route
+  // unknown to FIB cancels out.
+  for (const auto& key : toDelete) {
+    if (pendingToUpdate.erase(key)) {
+      ++numAvoided;
+      if (not isKnown(key)) {
+        ++numAvoided;
+        continue;
+      }
+    }
+    if (pendingDeletes.emplace(key).second) {
+      pendingToDelete.emplace_back(key);
+    } else {
+      ++numAvoided; // duplicate delete
+    }
+  }
+
+  // Add/update supersedes pending add/update or delete
+  size_t numDeletesSuperseded{0};
+  for (auto& [key, entry] : toUpdate) {
+    numDeletesSuperseded += pendingDeletes.erase(key);
+    const auto [_, inserted] =
+        pendingToUpdate.insert_or_assign(key, std::move(entry));
+    if (not inserted) {
+      ++numAvoided;
+    }
+  }
+  if (numDeletesSuperseded) {
+    pendingToDelete.erase(
+        std::remove_if(
+            pendingToDelete.begin(),
+            pendingToDelete.end(),
+            [&pendingDeletes](const Key& key) {
+              return pendingDeletes.count(key) == 0;
+            }),
+        pendingToDelete.end());
+    numAvoided += numDeletesSuperseded;
+  }
+
+  return numAvoided;
+}
+
 } // namespace
 
 Fib::Fib(
     std::shared_ptr<const Config> config,
     messaging::RQueue<DecisionRouteUpdate> routeUpdatesQueue,
     messaging::ReplicateQueue<DecisionRouteUpdate>& fibRouteUpdatesQueue,
-    messaging::ReplicateQueue<LogSample>& logSampleQueue)
+    messaging::ReplicateQueue<LogSample>& logSampleQueue,
+    std::optional<messaging::RQueue<InterfaceDatabase>> interfaceUpdatesQueue)
     : myNodeName_(*config->getConfig().node_name_ref()),
       thriftPort_(*config->getConfig().fib_port_ref()),
       dryrun_(config->getConfig().dryrun_ref().value_or(false)),
       enableSegmentRouting_(
           config->getConfig().enable_segment_routing_ref().value_or(false)),
       routeDeleteDelay_(*config->getConfig().route_delete_delay_ms_ref()),
-      retryRoutesExpBackoff_(
+      routeChunkSize_(
+          *config->getFibConfig().route_programming_chunk_size_ref()),
+      maxInflightChunks_(*config->getFibConfig().max_inflight_chunks_ref()),
+      enableUpdateCoalescing_(
+          *config->getFibConfig().enable_update_coalescing_ref()),
+      enableDifferentialSync_(
+          *config->getFibConfig().enable_differential_sync_ref()),
+      differentialSyncRanges_(
+          *config->getFibConfig().differential_sync_ranges_ref()),
+      enableMinimalDiffSync_(
+          *config->getFibConfig().enable_minimal_diff_sync_ref()),
+      enableFastReroute_(*config->getFibConfig().enable_fast_reroute_ref()),
+      unicastRetryBackoff_(
+          Constants::kFibInitialBackoff, Constants::kFibMaxBackoff, false),
+      mplsRetryBackoff_(
           Constants::kFibInitialBackoff, Constants::kFibMaxBackoff, false),
       fibRouteUpdatesQueue_(fibRouteUpdatesQueue),
       logSampleQueue_(logSampleQueue) {
@@ -82,18 +176,60 @@ Fib::Fib(
   addFiberTask(
       [this]() mutable noexcept { keepAliveTask(keepAliveStopSignal_); });
 
-  // Fiber to process route updates from Decision
-  addFiberTask([q = std::move(routeUpdatesQueue), this]() mutable noexcept {
-    while (true) {
-      auto maybeThriftObj = q.get(); // perform read
-      if (maybeThriftObj.hasError()) {
-        XLOG(DBG1) << "Terminating route delta processing fiber";
-        break;
-      }
-      fb303::fbData->addStatValue("fib.process_route_db", 1, fb303::COUNT);
-      processDecisionRouteUpdate(std::move(maybeThriftObj).value());
-    }
-  });
+  //
+  // Start RouteChunks fiber with stop signal if chunked route programming is
+  // enabled. See [Route Chunks]
+  //
+  if (routeChunkSize_) {
+    addFiberTask([this]() mutable noexcept {
+      routeChunksTask(routeChunksStopSignal_);
+    });
+  }
+
+  // Stream route chunks if enabled. See [Route Streaming]
+  if (*config->getFibConfig().enable_route_streaming_ref()) {
+#if FOLLY_HAS_COROUTINES
+    routeStreamClient_ =
+        std::make_unique<RouteStreamClient>(*this, thriftPort_, kFibId_);
+#else
+    XLOG(WARNING) << "Route streaming requires coroutines, disabled.";
+#endif
+  }
+
+  // Fiber to process route updates from Decision. Route programming waits on
+  // fiber semaphore and synchronous thrift calls, hence fiber flavor.
+  addQueueReaderFiberTask(
+      "route_updates",
+      std::move(routeUpdatesQueue),
+      Constants::kQueueReadBatchSize,
+      [this](std::vector<DecisionRouteUpdate>&& routeUpdates) {
+        // Merge updates queued up while we were programming the previous
+        // ones into the first one. See [Update Coalescing]
+        if (enableUpdateCoalescing_) {
+          for (size_t i = 1; i < routeUpdates.size(); ++i) {
+            coalesceQueuedRouteUpdate(
+                routeUpdates.front(), std::move(routeUpdates.at(i)));
+          }
+          routeUpdates.erase(routeUpdates.begin() + 1, routeUpdates.end());
+        }
+        for (auto& routeUpdate : routeUpdates) {
+          fb303::fbData->addStatValue("fib.process_route_db", 1, fb303::COUNT);
+          processDecisionRouteUpdate(std::move(routeUpdate));
+        }
+      });
+
+  // Fiber to process interface updates from LinkMonitor. See [Fast Reroute]
+  if (enableFastReroute_ and interfaceUpdatesQueue.has_value()) {
+    addQueueReaderFiberTask(
+        "interface_updates",
+        std::move(*interfaceUpdatesQueue),
+        Constants::kQueueReadBatchSize,
+        [this](std::vector<InterfaceDatabase>&& interfaceDbs) {
+          for (auto& interfaceDb : interfaceDbs) {
+            processInterfaceUpdates(std::move(interfaceDb));
+          }
+        });
+  }
 
   // Initialize stats keys
   fb303::fbData->addStatExportType("fib.convergence_time_ms", fb303::AVG);
@@ -108,6 +244,21 @@ Fib::Fib(
       "fib.thrift.failure.keepalive", fb303::COUNT);
   fb303::fbData->addStatExportType("fib.thrift.failure.sync_fib", fb303::COUNT);
   fb303::fbData->addStatExportType("fib.route_programming.time_ms", fb303::AVG);
+  fb303::fbData->addStatExportType(
+      "fib.route_programming.chunks", fb303::COUNT);
+  fb303::fbData->addStatExportType(
+      "fib.route_programming.chunk_time_ms", fb303::AVG);
+  fb303::fbData->addStatExportType(
+      "fib.route_programming.chunk_routes_overtaken", fb303::SUM);
+  fb303::fbData->addStatExportType("fib.coalesced_updates", fb303::SUM);
+  fb303::fbData->addStatExportType("fib.coalesced_route_ops", fb303::SUM);
+  fb303::fbData->addStatExportType("fib.sync_fib_ranges", fb303::SUM);
+  fb303::fbData->addStatExportType("fib.fast_reroute.routes", fb303::SUM);
+  fb303::fbData->addStatExportType("fib.fast_reroute.time_ms", fb303::AVG);
+  fb303::fbData->addStatExportType(
+      "fib.route_streaming.sessions", fb303::COUNT);
+  fb303::fbData->addStatExportType(
+      "fib.route_streaming.failures", fb303::COUNT);
 }
 
 void
@@ -116,97 +267,140 @@ Fib::stop() {
   keepAliveStopSignal_.post();
   retryRoutesStopSignal_.post();
   retryRoutesSignal_.signal();
+  routeChunksStopSignal_.post();
+  routeChunksSignal_.signal();
+
+#if FOLLY_HAS_COROUTINES
+  // Complete route stream before its session gets cancelled
+  if (routeStreamClient_) {
+    getEvb()->runInEventBaseThreadAndWait(
+        [this]() { routeStreamClient_->close(); });
+  }
+#endif
 
   // Invoke stop method of super class
   OpenrEventBase::stop();
   XLOG(DBG1) << "Stopped FIB event base";
 }
 
-std::optional<folly::CIDRNetwork>
-Fib::longestPrefixMatch(
-    const folly::CIDRNetwork& inputPrefix,
-    const std::unordered_map<folly::CIDRNetwork, RibUnicastEntry>&
-        unicastRoutes) {
-  std::optional<folly::CIDRNetwork> matchedPrefix;
-  int maxMask = -1;
-  const auto& inputIP = inputPrefix.first;
-  const auto& inputMask = inputPrefix.second;
-
-  // longest prefix matching
-  for (const auto& route : unicastRoutes) {
-    const auto& dbIP = route.first.first;
-    const auto& dbMask = route.first.second;
-
-    if (maxMask < dbMask && inputMask >= dbMask &&
-        inputIP.mask(dbMask) == dbIP) {
-      maxMask = dbMask;
-      matchedPrefix = route.first;
-    }
+folly::SemiFuture<std::shared_ptr<const Fib::RouteSnapshot>>
+Fib::getRouteSnapshot() {
+  if (auto snapshot = routeSnapshot_.load()) {
+    return folly::makeSemiFuture(std::move(snapshot));
   }
-  return matchedPrefix;
-}
-
-folly::SemiFuture<std::unique_ptr<thrift::RouteDatabase>>
-Fib::getRouteDb() {
-  folly::Promise<std::unique_ptr<thrift::RouteDatabase>> p;
+  folly::Promise<std::shared_ptr<const RouteSnapshot>> p;
   auto sf = p.getSemiFuture();
   runInEventBaseThread([p = std::move(p), this]() mutable {
-    thrift::RouteDatabase routeDb;
-    routeDb.thisNodeName_ref() = myNodeName_;
-    for (const auto& route : routeState_.unicastRoutes) {
-      routeDb.unicastRoutes_ref()->emplace_back(route.second.toThrift());
-    }
-    for (const auto& route : routeState_.mplsRoutes) {
-      routeDb.mplsRoutes_ref()->emplace_back(route.second.toThrift());
+    // snapshot may have been built by an earlier read in the meantime
+    auto snapshot = routeSnapshot_.load();
+    if (not snapshot) {
+      auto newSnapshot = std::make_shared<RouteSnapshot>();
+      newSnapshot->unicastRoutes = routeState_.unicastRoutes;
+      newSnapshot->mplsRoutes = routeState_.mplsRoutes;
+      newSnapshot->unicastFingerprints = routeState_.unicastFingerprints;
+      newSnapshot->version = ++routeSnapshotVersion_;
+      snapshot = std::move(newSnapshot);
+      routeSnapshot_.store(snapshot);
     }
-    p.setValue(std::make_unique<thrift::RouteDatabase>(std::move(routeDb)));
+    p.setValue(std::move(snapshot));
   });
   return sf;
 }
 
+folly::SemiFuture<std::unique_ptr<thrift::RouteDatabase>>
+Fib::getRouteDb() {
+  return getRouteSnapshot().deferValue(
+      [nodeName = myNodeName_](std::shared_ptr<const RouteSnapshot> snapshot) {
+        thrift::RouteDatabase routeDb;
+        routeDb.thisNodeName_ref() = nodeName;
+        for (const auto& route : snapshot->unicastRoutes) {
+          routeDb.unicastRoutes_ref()->emplace_back(route.second->toThrift());
+        }
+        for (const auto& route : snapshot->mplsRoutes) {
+          routeDb.mplsRoutes_ref()->emplace_back(route.second->toThrift());
+        }
+        return std::make_unique<thrift::RouteDatabase>(std::move(routeDb));
+      });
+}
+
 folly::SemiFuture<std::unique_ptr<thrift::RouteDatabaseDetail>>
 Fib::getRouteDetailDb() {
-  folly::Promise<std::unique_ptr<thrift::RouteDatabaseDetail>> p;
-  auto sf = p.getSemiFuture();
-  runInEventBaseThread([p = std::move(p), this]() mutable {
-    thrift::RouteDatabaseDetail routeDetailDb;
-    routeDetailDb.thisNodeName_ref() = myNodeName_;
-    for (const auto& route : routeState_.unicastRoutes) {
-      routeDetailDb.unicastRoutes_ref()->emplace_back(
-          route.second.toThriftDetail());
-    }
-    for (const auto& route : routeState_.mplsRoutes) {
-      routeDetailDb.mplsRoutes_ref()->emplace_back(
-          route.second.toThriftDetail());
-    }
-    p.setValue(std::make_unique<thrift::RouteDatabaseDetail>(
-        std::move(routeDetailDb)));
-  });
-  return sf;
+  return getRouteSnapshot().deferValue(
+      [nodeName = myNodeName_](std::shared_ptr<const RouteSnapshot> snapshot) {
+        thrift::RouteDatabaseDetail routeDetailDb;
+        routeDetailDb.thisNodeName_ref() = nodeName;
+        for (const auto& route : snapshot->unicastRoutes) {
+          routeDetailDb.unicastRoutes_ref()->emplace_back(
+              route.second->toThriftDetail());
+        }
+        for (const auto& route : snapshot->mplsRoutes) {
+          routeDetailDb.mplsRoutes_ref()->emplace_back(
+              route.second->toThriftDetail());
+        }
+        return std::make_unique<thrift::RouteDatabaseDetail>(
+            std::move(routeDetailDb));
+      });
 }
 
 folly::SemiFuture<std::unique_ptr<std::vector<thrift::UnicastRoute>>>
 Fib::getUnicastRoutes(std::vector<std::string> prefixes) {
-  folly::Promise<std::unique_ptr<std::vector<thrift::UnicastRoute>>> p;
-  auto sf = p.getSemiFuture();
-  runInEventBaseThread(
-      [p = std::move(p), prefixes = std::move(prefixes), this]() mutable {
-        p.setValue(std::make_unique<std::vector<thrift::UnicastRoute>>(
-            getUnicastRoutesFiltered(std::move(prefixes))));
+  return getRouteSnapshot().deferValue(
+      [prefixes = std::move(prefixes)](
+          std::shared_ptr<const RouteSnapshot> snapshot) mutable {
+        return std::make_unique<std::vector<thrift::UnicastRoute>>(
+            getUnicastRoutesFiltered(*snapshot, std::move(prefixes)));
+      });
+}
+
+folly::SemiFuture<std::unique_ptr<thrift::UnicastRoutesPage>>
+Fib::getUnicastRoutesPage(thrift::PageParams pageParams) {
+  if (auto version = pageParams.snapshotVersion_ref()) {
+    auto snapshot = pagedRouteSnapshot_.load();
+    if (snapshot and snapshot->version == *version) {
+      return folly::makeSemiFutureWith([snapshot = std::move(snapshot),
+                                        pageParams = std::move(pageParams)]() {
+        return getUnicastRoutesPage(*snapshot, pageParams);
+      });
+    }
+  }
+  return getRouteSnapshot().deferValue(
+      [this, pageParams = std::move(pageParams)](
+          std::shared_ptr<const RouteSnapshot> snapshot) {
+        if (not pageParams.continuationToken_ref().has_value()) {
+          pagedRouteSnapshot_.store(snapshot);
+        }
+        return getUnicastRoutesPage(*snapshot, pageParams);
       });
-  return sf;
 }
 
 folly::SemiFuture<std::unique_ptr<std::vector<thrift::MplsRoute>>>
 Fib::getMplsRoutes(std::vector<int32_t> labels) {
-  folly::Promise<std::unique_ptr<std::vector<thrift::MplsRoute>>> p;
-  auto sf = p.getSemiFuture();
-  runInEventBaseThread(
-      [p = std::move(p), labels = std::move(labels), this]() mutable {
-        p.setValue(std::make_unique<std::vector<thrift::MplsRoute>>(
-            getMplsRoutesFiltered(std::move(labels))));
+  return getRouteSnapshot().deferValue(
+      [labels = std::move(labels)](
+          std::shared_ptr<const RouteSnapshot> snapshot) mutable {
+        return std::make_unique<std::vector<thrift::MplsRoute>>(
+            getMplsRoutesFiltered(*snapshot, std::move(labels)));
+      });
+}
+
+folly::SemiFuture<std::unique_ptr<std::vector<thrift::RouteLookupResult>>>
+Fib::lookupRoutes(std::vector<folly::IPAddress> addresses) {
+  return getRouteSnapshot().deferValue(
+      [addresses = std::move(addresses)](
+          std::shared_ptr<const RouteSnapshot> snapshot) {
+        return std::make_unique<std::vector<thrift::RouteLookupResult>>(
+            lookupRoutes(*snapshot, addresses));
+      });
+}
+
+folly::SemiFuture<std::unique_ptr<std::vector<thrift::RouteFingerprint>>>
+Fib::getUnicastRouteFingerprints(std::vector<folly::CIDRNetwork> ranges) {
+  return getRouteSnapshot().deferValue(
+      [ranges = std::move(ranges)](
+          std::shared_ptr<const RouteSnapshot> snapshot) {
+        return std::make_unique<std::vector<thrift::RouteFingerprint>>(
+            getUnicastRouteFingerprints(*snapshot, ranges));
       });
-  return sf;
 }
 
 folly::SemiFuture<std::unique_ptr<thrift::PerfDatabase>>
@@ -219,8 +413,81 @@ Fib::getPerfDb() {
   return sf;
 }
 
+folly::SemiFuture<
+    std::unique_ptr<std::vector<thrift::ConvergenceDistribution>>>
+Fib::getConvergenceDistributions() {
+  folly::Promise<std::unique_ptr<std::vector<thrift::ConvergenceDistribution>>>
+      p;
+  auto sf = p.getSemiFuture();
+  runInEventBaseThread([p = std::move(p), this]() mutable {
+    p.setValue(std::make_unique<std::vector<thrift::ConvergenceDistribution>>(
+        convergenceStats_.getDistributions()));
+  });
+  return sf;
+}
+
+std::unique_ptr<thrift::UnicastRoutesPage>
+Fib::getUnicastRoutesPage(
+    const RouteSnapshot& snapshot, const thrift::PageParams& pageParams) {
+  std::call_once(snapshot.sortedPrefixesOnce, [&snapshot]() {
+    snapshot.sortedPrefixes.reserve(snapshot.unicastRoutes.size());
+    for (const auto& [prefix, _] : snapshot.unicastRoutes) {
+      snapshot.sortedPrefixes.emplace_back(prefix);
+    }
+    std::sort(snapshot.sortedPrefixes.begin(), snapshot.sortedPrefixes.end());
+  });
+
+  const auto& prefixes = snapshot.sortedPrefixes;
+  const auto [begin, end] =
+      getPageRange(prefixes, pageParams, [](const std::string& token) {
+        return folly::IPAddress::createNetwork(token);
+      });
+  auto page = std::make_unique<thrift::UnicastRoutesPage>();
+  for (auto it = begin; it != end; ++it) {
+    page->routes_ref()->emplace_back(
+        snapshot.unicastRoutes.at(*it)->toThrift());
+  }
+  page->pageInfo_ref()->snapshotVersion_ref() = snapshot.version;
+  if (end != prefixes.end()) {
+    page->pageInfo_ref()->continuationToken_ref() =
+        folly::IPAddress::networkToString(*std::prev(end));
+  }
+  return page;
+}
+
+const RibUnicastEntry*
+Fib::findLongestPrefixMatch(
+    const RouteSnapshot& snapshot, const folly::CIDRNetwork& prefix) {
+  std::call_once(snapshot.prefixIndexOnce, [&snapshot]() {
+    for (const auto& [routePrefix, entry] : snapshot.unicastRoutes) {
+      snapshot.prefixIndex.insert(routePrefix, entry.get());
+    }
+  });
+  const auto* match = snapshot.prefixIndex.findLongest(prefix);
+  return match ? match->second : nullptr;
+}
+
+std::vector<thrift::RouteLookupResult>
+Fib::lookupRoutes(
+    const RouteSnapshot& snapshot,
+    const std::vector<folly::IPAddress>& addresses) {
+  std::vector<thrift::RouteLookupResult> results;
+  results.reserve(addresses.size());
+  for (const auto& addr : addresses) {
+    auto& result = results.emplace_back();
+    result.address_ref() = toBinaryAddress(addr);
+    const auto* entry =
+        findLongestPrefixMatch(snapshot, {addr, addr.bitCount()});
+    if (entry) {
+      result.route_ref() = entry->toThrift();
+    }
+  }
+  return results;
+}
+
 std::vector<thrift::UnicastRoute>
-Fib::getUnicastRoutesFiltered(std::vector<std::string> prefixes) {
+Fib::getUnicastRoutesFiltered(
+    const RouteSnapshot& snapshot, std::vector<std::string> prefixes) {
   // return and send the vector<thrift::UnicastRoute>
   std::vector<thrift::UnicastRoute> retRouteVec;
   // the matched prefix after longest prefix matching and avoid duplicates
@@ -228,8 +495,8 @@ Fib::getUnicastRoutesFiltered(std::vector<std::string> prefixes) {
 
   // if the params is empty, return all routes
   if (prefixes.empty()) {
-    for (const auto& routes : routeState_.unicastRoutes) {
-      retRouteVec.emplace_back(routes.second.toThrift());
+    for (const auto& routes : snapshot.unicastRoutes) {
+      retRouteVec.emplace_back(routes.second->toThrift());
     }
     return retRouteVec;
   }
@@ -246,30 +513,60 @@ Fib::getUnicastRoutesFiltered(std::vector<std::string> prefixes) {
     const auto inputPrefix = maybePrefix.value();
 
     // do longest prefix match, add the matched prefix to the result set
-    const auto& matchedPrefix =
-        Fib::longestPrefixMatch(inputPrefix, routeState_.unicastRoutes);
-    if (matchedPrefix.has_value()) {
-      matchPrefixSet.insert(matchedPrefix.value());
+    const auto* entry = findLongestPrefixMatch(snapshot, inputPrefix);
+    if (entry) {
+      matchPrefixSet.insert(entry->prefix);
     }
   }
 
   // get the routes from the prefix set
   for (const auto& prefix : matchPrefixSet) {
-    retRouteVec.emplace_back(routeState_.unicastRoutes.at(prefix).toThrift());
+    retRouteVec.emplace_back(snapshot.unicastRoutes.at(prefix)->toThrift());
   }
 
   return retRouteVec;
 }
 
+std::vector<thrift::RouteFingerprint>
+Fib::getUnicastRouteFingerprints(
+    const RouteSnapshot& snapshot,
+    const std::vector<folly::CIDRNetwork>& ranges) {
+  if (ranges.empty()) {
+    return snapshot.unicastFingerprints.getFingerprints();
+  }
+
+  std::vector<thrift::RouteFingerprint> fingerprints;
+  fingerprints.reserve(ranges.size());
+  for (const auto& range : ranges) {
+    if (RouteFingerprints::isAggregatable(range)) {
+      fingerprints.emplace_back(
+          snapshot.unicastFingerprints.getFingerprint(range));
+      continue;
+    }
+    // narrower than maintained ranges, digest routes within it
+    auto& fingerprint = fingerprints.emplace_back();
+    fingerprint.range_ref() = toIpPrefix(range);
+    for (const auto& [prefix, route] : snapshot.unicastRoutes) {
+      if (prefix.first.family() == range.first.family() and
+          prefix.first.inSubnet(range.first, range.second)) {
+        *fingerprint.numRoutes_ref() += 1;
+        *fingerprint.digest_ref() ^= RouteFingerprints::getRouteDigest(*route);
+      }
+    }
+  }
+  return fingerprints;
+}
+
 std::vector<thrift::MplsRoute>
-Fib::getMplsRoutesFiltered(std::vector<int32_t> labels) {
+Fib::getMplsRoutesFiltered(
+    const RouteSnapshot& snapshot, std::vector<int32_t> labels) {
   // return and send the vector<thrift::MplsRoute>
   std::vector<thrift::MplsRoute> retRouteVec;
 
   // if the params is empty, return all MPLS routes
   if (labels.empty()) {
-    for (const auto& routes : routeState_.mplsRoutes) {
-      retRouteVec.emplace_back(routes.second.toThrift());
+    for (const auto& routes : snapshot.mplsRoutes) {
+      retRouteVec.emplace_back(routes.second->toThrift());
     }
     return retRouteVec;
   }
@@ -281,9 +578,9 @@ Fib::getMplsRoutesFiltered(std::vector<int32_t> labels) {
   }
 
   // get the filtered MPLS routes and avoid duplicates
-  for (const auto& routes : routeState_.mplsRoutes) {
+  for (const auto& routes : snapshot.mplsRoutes) {
     if (labelFilterSet.find(routes.first) != labelFilterSet.end()) {
-      retRouteVec.emplace_back(routes.second.toThrift());
+      retRouteVec.emplace_back(routes.second->toThrift());
     }
   }
 
@@ -297,19 +594,31 @@ Fib::getFibUpdatesReader() {
 
 void
 Fib::RouteState::update(const DecisionRouteUpdate& routeUpdate) {
-  // Add/Update unicast routes to update
+  // Add/Update unicast routes to update. Entries are immutable, hence an
+  // update replaces the entry. See [Shared Route Entries]
   for (const auto& [prefix, route] : routeUpdate.unicastRoutesToUpdate) {
-    unicastRoutes.insert_or_assign(prefix, route);
+    auto entry = std::make_shared<const RibUnicastEntry>(route);
+    unicastFingerprints.add(*entry);
+    auto [it, inserted] = unicastRoutes.try_emplace(prefix, entry);
+    if (not inserted) {
+      unicastFingerprints.remove(*it->second);
+      it->second = std::move(entry);
+    }
   }
 
   // Add mpls routes to update
   for (const auto& [label, route] : routeUpdate.mplsRoutesToUpdate) {
-    mplsRoutes.insert_or_assign(label, route);
+    mplsRoutes.insert_or_assign(
+        label, std::make_shared<const RibMplsEntry>(route));
   }
 
   // Delete unicast routes
   for (const auto& dest : routeUpdate.unicastRoutesToDelete) {
-    unicastRoutes.erase(dest);
+    auto it = unicastRoutes.find(dest);
+    if (it != unicastRoutes.end()) {
+      unicastFingerprints.remove(*it->second);
+      unicastRoutes.erase(it);
+    }
   }
 
   // Delete mpls routes
@@ -329,8 +638,14 @@ Fib::RouteState::createUpdate() {
 
   if (state == SYNCING and not isInitialSynced) {
     update.type = DecisionRouteUpdate::FULL_SYNC;
-    update.unicastRoutesToUpdate = unicastRoutes;
-    update.mplsRoutesToUpdate = mplsRoutes;
+    update.unicastRoutesToUpdate.reserve(unicastRoutes.size());
+    for (const auto& [prefix, route] : unicastRoutes) {
+      update.unicastRoutesToUpdate.emplace(prefix, *route);
+    }
+    update.mplsRoutesToUpdate.reserve(mplsRoutes.size());
+    for (const auto& [label, route] : mplsRoutes) {
+      update.mplsRoutesToUpdate.emplace(label, *route);
+    }
     return update;
   }
 
@@ -341,37 +656,26 @@ Fib::RouteState::createUpdate() {
   update.type = DecisionRouteUpdate::INCREMENTAL;
   auto const currentTime = std::chrono::steady_clock::now();
 
-  // Populate unicast routes to add, update, or delete
-  for (auto itrPrefixes = dirtyPrefixes.begin();
-       itrPrefixes != dirtyPrefixes.end();) {
-    if (currentTime < itrPrefixes->second) {
-      ++itrPrefixes;
-      continue; // Route is not yet ready for retry
-    }
-    auto iter = unicastRoutes.find(itrPrefixes->first);
+  // Populate unicast routes to add, update, or delete. Only routes ready
+  // for retry are removed from dirty state, as we are creating a new update
+  // to program them.
+  for (auto& prefix : dirtyPrefixes.popExpired(currentTime)) {
+    auto iter = unicastRoutes.find(prefix);
     if (iter == unicastRoutes.end()) { // Delete
-      update.unicastRoutesToDelete.emplace_back(itrPrefixes->first);
+      update.unicastRoutesToDelete.emplace_back(prefix);
     } else { // Add or Update
-      update.unicastRoutesToUpdate.emplace(itrPrefixes->first, iter->second);
+      update.unicastRoutesToUpdate.emplace(prefix, *iter->second);
     }
-    // remove as we are creating a new update to program
-    itrPrefixes = dirtyPrefixes.erase(itrPrefixes);
   }
 
   // Populate mpls routes to add, update, or delete
-  for (auto itrLabel = dirtyLabels.begin(); itrLabel != dirtyLabels.end();) {
-    if (currentTime < itrLabel->second) {
-      ++itrLabel;
-      continue; // Route is not yet ready for retry
-    }
-    auto it = mplsRoutes.find(itrLabel->first);
+  for (auto label : dirtyLabels.popExpired(currentTime)) {
+    auto it = mplsRoutes.find(label);
     if (it == mplsRoutes.end()) { // Delete
-      update.mplsRoutesToDelete.emplace_back(itrLabel->first);
+      update.mplsRoutesToDelete.emplace_back(label);
     } else { // Add or Update
-      update.mplsRoutesToUpdate.emplace(itrLabel->first, it->second);
+      update.mplsRoutesToUpdate.emplace(label, *it->second);
     }
-    // remove as we are creating a new update to program
-    itrLabel = dirtyLabels.erase(itrLabel);
   }
 
   return update;
@@ -387,20 +691,22 @@ Fib::nextRetryDuration() const {
   // processing.
   if ((routeState_.state == RouteState::SYNCING) or
       (routeState_.dirtyPrefixes.empty() and routeState_.dirtyLabels.empty())) {
-    // Return backoff duration if any
-    return retryRoutesExpBackoff_.getTimeRemainingUntilRetry();
+    // Return backoff duration if any. Full sync covers both route classes
+    return std::max(
+        unicastRetryBackoff_.getTimeRemainingUntilRetry(),
+        mplsRetryBackoff_.getTimeRemainingUntilRetry());
   }
 
   auto const currTime = std::chrono::steady_clock::now();
   auto nextRetryTime =
       std::chrono::time_point<std::chrono::steady_clock>::max();
 
-  for (auto& [prefix, addDeleteTime] : routeState_.dirtyPrefixes) {
-    nextRetryTime = std::min(addDeleteTime, nextRetryTime);
+  // Earliest deadline of each route class. See [Retry Scheduling]
+  if (auto deadline = routeState_.dirtyPrefixes.nextDeadline()) {
+    nextRetryTime = std::min(deadline.value(), nextRetryTime);
   }
-
-  for (auto& [label, addDeleteTime] : routeState_.dirtyLabels) {
-    nextRetryTime = std::min(addDeleteTime, nextRetryTime);
+  if (auto deadline = routeState_.dirtyLabels.nextDeadline()) {
+    nextRetryTime = std::min(deadline.value(), nextRetryTime);
   }
 
   return std::chrono::ceil<std::chrono::milliseconds>(
@@ -416,12 +722,12 @@ Fib::RouteState::processFibUpdateError(
   // in createUpdate().
   for (auto& [_, prefixes] : *fibError.vrf2failedAddUpdatePrefixes_ref()) {
     for (auto& prefix : prefixes) {
-      dirtyPrefixes.insert_or_assign(toIPNetwork(prefix), retryAt);
+      dirtyPrefixes.schedule(toIPNetwork(prefix), retryAt);
     }
   }
   for (auto& [_, prefixes] : *fibError.vrf2failedDeletePrefixes_ref()) {
     for (auto& prefix : prefixes) {
-      dirtyPrefixes.insert_or_assign(toIPNetwork(prefix), retryAt);
+      dirtyPrefixes.schedule(toIPNetwork(prefix), retryAt);
     }
   }
 
@@ -429,12 +735,75 @@ Fib::RouteState::processFibUpdateError(
   // dirtyPrefixes map. We can distinguish between add/update and delete updates
   // in createUpdate().
   for (auto& label : *fibError.failedAddUpdateMplsLabels_ref()) {
-    dirtyLabels.insert_or_assign(label, retryAt);
+    dirtyLabels.schedule(label, retryAt);
   }
 
   for (auto& label : *fibError.failedDeleteMplsLabels_ref()) {
-    dirtyLabels.insert_or_assign(label, retryAt);
+    dirtyLabels.schedule(label, retryAt);
+  }
+}
+
+size_t
+Fib::coalesceRouteUpdate(
+    DecisionRouteUpdate& pending,
+    DecisionRouteUpdate&& routeUpdate,
+    const std::function<bool(const folly::CIDRNetwork&)>& isPrefixKnown,
+    const std::function<bool(int32_t)>& isLabelKnown) {
+  size_t numAvoided{0};
+  numAvoided += coalesceRoutes(
+      pending.unicastRoutesToUpdate,
+      pending.unicastRoutesToDelete,
+      std::move(routeUpdate.unicastRoutesToUpdate),
+      std::move(routeUpdate.unicastRoutesToDelete),
+      isPrefixKnown);
+  numAvoided += coalesceRoutes(
+      pending.mplsRoutesToUpdate,
+      pending.mplsRoutesToDelete,
+      std::move(routeUpdate.mplsRoutesToUpdate),
+      std::move(routeUpdate.mplsRoutesToDelete),
+      isLabelKnown);
+
+  if (routeUpdate.type == DecisionRouteUpdate::FULL_SYNC) {
+    pending.type = DecisionRouteUpdate::FULL_SYNC;
+  }
+  if (pending.prefixType != routeUpdate.prefixType) {
+    pending.prefixType.reset();
+  }
+  // Convergence is measured against the latest update, while traces of both
+  // are carried on
+  if (routeUpdate.perfEvents.has_value()) {
+    if (pending.perfEvents.has_value()) {
+      ConvergenceTracer::mergeTraceIds(
+          *routeUpdate.perfEvents, *pending.perfEvents);
+    }
+    pending.perfEvents = std::move(routeUpdate.perfEvents);
   }
+
+  return numAvoided;
+}
+
+void
+Fib::coalesceQueuedRouteUpdate(
+    DecisionRouteUpdate& pending, DecisionRouteUpdate&& routeUpdate) {
+  // Filter before merging, so that doNotInstall route doesn't supersede the
+  // pending one
+  filterRouteUpdate(routeUpdate);
+
+  const auto numAvoided = coalesceRouteUpdate(
+      pending,
+      std::move(routeUpdate),
+      [this](const folly::CIDRNetwork& prefix) {
+        return routeState_.unicastRoutes.count(prefix) or
+            routeState_.dirtyPrefixes.count(prefix);
+      },
+      [this](int32_t label) {
+        return routeState_.mplsRoutes.count(label) or
+            routeState_.dirtyLabels.count(label);
+      });
+
+  fb303::fbData->addStatValue("fib.coalesced_updates", 1, fb303::SUM);
+  fb303::fbData->addStatValue(
+      "fib.coalesced_route_ops", numAvoided, fb303::SUM);
 }
 
 // Process new route updates received from Decision module.
@@ -448,24 +817,12 @@ Fib::processDecisionRouteUpdate(DecisionRouteUpdate&& routeUpdate) {
   if (routeUpdate.perfEvents.has_value()) {
     addPerfEvent(
         routeUpdate.perfEvents.value(), myNodeName_, "FIB_ROUTE_DB_RECVD");
+    ConvergenceTracer::record(
+        routeUpdate.perfEvents.value(), "FIB_ROUTE_DB_RECVD");
   }
 
-  // Before anything, get rid of doNotInstall routes
-  auto iter = routeUpdate.unicastRoutesToUpdate.cbegin();
-  while (iter != routeUpdate.unicastRoutesToUpdate.cend()) {
-    if (iter->second.doNotInstall) {
-      XLOG(INFO) << "Not installing route for prefix "
-                 << folly::IPAddress::networkToString(iter->first);
-      iter = routeUpdate.unicastRoutesToUpdate.erase(iter);
-    } else {
-      ++iter;
-    }
-  }
-
-  // Filter MPLS next-hops to unique action
-  for (auto& [_, mplsRoute] : routeUpdate.mplsRoutesToUpdate) {
-    mplsRoute.filterNexthopsToUniqueAction();
-  }
+  // Before anything, get rid of routes which must not be programmed
+  filterRouteUpdate(routeUpdate);
 
   updateRoutes(std::move(routeUpdate));
   if (routeState_.needsRetry()) {
@@ -534,15 +891,23 @@ Fib::updateUnicastRoutes(
 
     // Mark dirty state here & set
     for (auto& prefix : routeUpdate.unicastRoutesToDelete) {
-      const auto [itr, _] = routeState_.dirtyPrefixes.insert_or_assign(
+      routeState_.dirtyPrefixes.schedule(
           prefix, currentTime + routeDeleteDelay_);
       XLOG(INFO) << "Will delete unicast route "
                  << folly::IPAddress::networkToString(prefix) << " after "
-                 << std::chrono::duration_cast<std::chrono::milliseconds>(
-                        itr->second - currentTime)
-                        .count()
-                 << "ms";
+                 << routeDeleteDelay_.count() << "ms";
+    }
+  }
+
+  // Hand over routes to the chunk pipeline. Add/updates are published when
+  // their chunk completes. See [Route Chunks]
+  if (routeChunkSize_ and not dryrun_) {
+    std::vector<folly::CIDRNetwork> routesToDelete;
+    if (unicastRoutesToDelete.size()) {
+      routesToDelete = routeUpdate.unicastRoutesToDelete;
     }
+    enqueueRouteChunks(routeUpdate, routesToDelete);
+    return success;
   }
 
   if (unicastRoutesToDelete.size()) {
@@ -567,7 +932,7 @@ Fib::updateUnicastRoutes(
         // Marked all routes to be deleted as dirty. So we try to remove them
         // again from FIB.
         for (const auto& prefix : routeUpdate.unicastRoutesToDelete) {
-          routeState_.dirtyPrefixes.insert_or_assign(prefix, retryAt);
+          routeState_.dirtyPrefixes.schedule(prefix, retryAt);
         }
         // NOTE: We still want to advertise these prefixes as deleted
       }
@@ -607,7 +972,7 @@ Fib::updateUnicastRoutes(
         // Next retry should restore, but meanwhile clients can take appropriate
         // action because FIB state is unclear e.g. withdraw route from KvStore
         for (auto& [prefix, _] : routeUpdate.unicastRoutesToUpdate) {
-          routeState_.dirtyPrefixes.insert_or_assign(prefix, retryAt);
+          routeState_.dirtyPrefixes.schedule(prefix, retryAt);
           routeUpdate.unicastRoutesToDelete.emplace_back(prefix);
         }
 
@@ -638,13 +1003,10 @@ Fib::updateMplsRoutes(
 
     // Mark dirty state here & set
     for (auto& mplsRoute : routeUpdate.mplsRoutesToDelete) {
-      const auto [itr, _] = routeState_.dirtyLabels.insert_or_assign(
+      routeState_.dirtyLabels.schedule(
           mplsRoute, currentTime + routeDeleteDelay_);
       XLOG(INFO) << "Will delete mpls route " << mplsRoute << " after "
-                 << std::chrono::duration_cast<std::chrono::milliseconds>(
-                        itr->second - currentTime)
-                        .count()
-                 << "ms";
+                 << routeDeleteDelay_.count() << "ms";
     }
   }
 
@@ -670,7 +1032,7 @@ Fib::updateMplsRoutes(
         // Marked all routes to be deleted as dirty. So we try to remove them
         // again from FIB.
         for (const auto& label : routeUpdate.mplsRoutesToDelete) {
-          routeState_.dirtyLabels.insert_or_assign(label, retryAt);
+          routeState_.dirtyLabels.schedule(label, retryAt);
         }
         // NOTE: We still want to advertise these labels as deleted
       }
@@ -711,7 +1073,7 @@ Fib::updateMplsRoutes(
         // appropriate action because FIB state is unclear e.g. withdraw route
         // from KvStore
         for (auto& [label, _] : routeUpdate.mplsRoutesToUpdate) {
-          routeState_.dirtyLabels.insert_or_assign(label, retryAt);
+          routeState_.dirtyLabels.schedule(label, retryAt);
           routeUpdate.mplsRoutesToDelete.emplace_back(label);
         }
 
@@ -724,22 +1086,24 @@ Fib::updateMplsRoutes(
   return success;
 }
 
-bool
+Fib::ProgrammingStatus
 Fib::updateRoutes(DecisionRouteUpdate&& routeUpdate, bool useDeleteDelay) {
   SCOPE_EXIT {
     updateRoutesSemaphore_.signal(); // Release when this function returns
   };
   updateRoutesSemaphore_.wait();
+  ProgrammingStatus status;
 
   // Return if empty
   if (routeUpdate.empty()) {
     XLOG(INFO) << "No entries in route update";
-    return true;
+    return status;
   }
 
   // Backup routes in routeState_. In case update routes failed, routes will be
   // programmed in later scheduled FIB sync.
   routeState_.update(routeUpdate);
+  invalidateRouteSnapshot();
 
   // Update flat counters here as they depend on routeState_ and its change
   updateGlobalCounters();
@@ -749,25 +1113,34 @@ Fib::updateRoutes(DecisionRouteUpdate&& routeUpdate, bool useDeleteDelay) {
   // state we let `syncRoutes` do the work instead.
   if (routeState_.state == RouteState::SYNCING) {
     XLOG(INFO) << "Skip route programming in SYNCING state";
-    return true;
+    return status;
   }
 
   XLOG(INFO) << "Updating routes in FIB";
   auto const currentTime = std::chrono::steady_clock::now();
-  auto const retryAt =
-      currentTime + retryRoutesExpBackoff_.getTimeRemainingUntilRetry();
-  bool success{true};
+
+  // Routes in RouteState are kept as received. See [Fast Reroute]
+  pruneRouteUpdate(routeUpdate);
 
   // Convert DecisionRouteUpdate to RouteDatabaseDelta to use UnicastRoute
   // and MplsRoute with the FibService client APIs
   auto routeDbDelta = routeUpdate.toThrift();
 
-  success &= updateUnicastRoutes(
-      useDeleteDelay, currentTime, retryAt, routeUpdate, routeDbDelta);
+  // Failed routes are retried based on backoff of their route class
+  status.unicast = updateUnicastRoutes(
+      useDeleteDelay,
+      currentTime,
+      currentTime + unicastRetryBackoff_.getTimeRemainingUntilRetry(),
+      routeUpdate,
+      routeDbDelta);
 
   if (enableSegmentRouting_) {
-    success &= updateMplsRoutes(
-        useDeleteDelay, currentTime, retryAt, routeUpdate, routeDbDelta);
+    status.mpls = updateMplsRoutes(
+        useDeleteDelay,
+        currentTime,
+        currentTime + mplsRetryBackoff_.getTimeRemainingUntilRetry(),
+        routeUpdate,
+        routeDbDelta);
   }
   // Log statistics
   const auto elapsedTime = std::chrono::ceil<std::chrono::milliseconds>(
@@ -785,30 +1158,299 @@ Fib::updateRoutes(DecisionRouteUpdate&& routeUpdate, bool useDeleteDelay) {
     routeUpdate.mplsRoutesToUpdate.clear();
     routeUpdate.mplsRoutesToDelete.clear();
   }
+  // Nothing left to publish if unicast routes were handed over to chunks
+  if (routeChunkSize_ and routeUpdate.empty() and
+      not routeUpdate.perfEvents.has_value()) {
+    return status;
+  }
   fibRouteUpdatesQueue_.push(std::move(routeUpdate));
 
-  return success;
+  return status;
+}
+
+void
+Fib::enqueueRouteChunks(
+    DecisionRouteUpdate& routeUpdate,
+    const std::vector<folly::CIDRNetwork>& routesToDelete) {
+  // Drop prefixes of this update from chunks which are not yet dispatched.
+  // Newer route state supersedes whatever the queued chunk would program.
+  if (not pendingRouteChunks_.empty()) {
+    std::unordered_set<folly::CIDRNetwork> prefixes(
+        routeUpdate.unicastRoutesToDelete.begin(),
+        routeUpdate.unicastRoutesToDelete.end());
+    for (auto const& [prefix, _] : routeUpdate.unicastRoutesToUpdate) {
+      prefixes.emplace(prefix);
+    }
+
+    size_t numOvertaken{0};
+    for (auto& chunk : pendingRouteChunks_) {
+      auto& toUpdate = chunk.unicastRoutesToUpdate;
+      for (auto it = toUpdate.begin(); it != toUpdate.end();) {
+        if (prefixes.count(it->first)) {
+          it = toUpdate.erase(it);
+          ++numOvertaken;
+        } else {
+          ++it;
+        }
+      }
+      auto& toDelete = chunk.unicastRoutesToDelete;
+      auto const toDeleteEnd = std::remove_if(
+          toDelete.begin(), toDelete.end(), [&prefixes](auto const& prefix) {
+            return prefixes.count(prefix) > 0;
+          });
+      numOvertaken += std::distance(toDeleteEnd, toDelete.end());
+      toDelete.erase(toDeleteEnd, toDelete.end());
+    }
+    fb303::fbData->addStatValue(
+        "fib.route_programming.chunk_routes_overtaken",
+        numOvertaken,
+        fb303::SUM);
+  }
+
+  // Chunk route deletions. These are already published with the update.
+  for (size_t i = 0; i < routesToDelete.size(); i += routeChunkSize_) {
+    DecisionRouteUpdate chunk;
+    chunk.unicastRoutesToDelete.assign(
+        routesToDelete.begin() + i,
+        routesToDelete.begin() +
+            std::min(i + routeChunkSize_, routesToDelete.size()));
+    pendingRouteChunks_.emplace_back(std::move(chunk));
+  }
+
+  // Chunk route add/updates. These are moved out of the update and get
+  // published along with their chunk.
+  size_t numAddChunks{0};
+  DecisionRouteUpdate chunk;
+  for (auto& [prefix, route] : routeUpdate.unicastRoutesToUpdate) {
+    chunk.unicastRoutesToUpdate.emplace(prefix, std::move(route));
+    if (chunk.unicastRoutesToUpdate.size() >= routeChunkSize_) {
+      pendingRouteChunks_.emplace_back(std::move(chunk));
+      chunk = DecisionRouteUpdate();
+      ++numAddChunks;
+    }
+  }
+  if (not chunk.unicastRoutesToUpdate.empty()) {
+    pendingRouteChunks_.emplace_back(std::move(chunk));
+    ++numAddChunks;
+  }
+  routeUpdate.unicastRoutesToUpdate.clear();
+
+  // Perf events ride along with the last chunk so that convergence accounts
+  // for programming of the whole update
+  if (numAddChunks) {
+    pendingRouteChunks_.back().perfEvents = std::move(routeUpdate.perfEvents);
+    routeUpdate.perfEvents.reset();
+  }
+
+  routeChunksSignal_.signal();
+}
+
+void
+Fib::dispatchRouteChunks() {
+  // Queued chunks are superseded by the full sync of route state
+  if (routeState_.state == RouteState::SYNCING) {
+    pendingRouteChunks_.clear();
+    return;
+  }
+
+  while (not pendingRouteChunks_.empty() and
+         inflightRouteChunks_.size() < maxInflightChunks_) {
+    auto& chunk = pendingRouteChunks_.front();
+    if (chunk.unicastRoutesToUpdate.empty() and
+        chunk.unicastRoutesToDelete.empty()) {
+      pendingRouteChunks_.pop_front(); // Overtaken by newer updates
+      continue;
+    }
+
+    // Wait for in-flight chunk if it programs any of the prefixes of this
+    // chunk. FibService doesn't guarantee ordering across requests, unlike
+    // streamed chunks.
+    const bool streaming = isRouteStreaming();
+    std::vector<folly::CIDRNetwork> prefixes{
+        chunk.unicastRoutesToDelete.begin(), chunk.unicastRoutesToDelete.end()};
+    for (auto const& [prefix, _] : chunk.unicastRoutesToUpdate) {
+      prefixes.emplace_back(prefix);
+    }
+    if (not streaming and
+        std::any_of(
+            prefixes.begin(), prefixes.end(), [this](auto const& prefix) {
+              return inflightPrefixes_.count(prefix) > 0;
+            })) {
+      break;
+    }
+    inflightPrefixes_.insert(prefixes.begin(), prefixes.end());
+
+    XLOG(INFO) << "Dispatching chunk of "
+               << (chunk.unicastRoutesToDelete.empty() ? "add/update"
+                                                       : "delete")
+               << " for " << prefixes.size() << " unicast routes in FIB";
+    auto routeDbDelta = chunk.toThrift();
+    auto result = folly::makeSemiFutureWith([&]() {
+#if FOLLY_HAS_COROUTINES
+      if (streaming) {
+        return routeStreamClient_->program(routeDbDelta);
+      }
+#endif
+      createFibClient(*getEvb(), socket_, client_, thriftPort_);
+      if (routeDbDelta.unicastRoutesToDelete_ref()->size()) {
+        return client_->semifuture_deleteUnicastRoutes(
+            kFibId_, *routeDbDelta.unicastRoutesToDelete_ref());
+      }
+      return client_->semifuture_addUnicastRoutes(
+          kFibId_, *routeDbDelta.unicastRoutesToUpdate_ref());
+    });
+    fb303::fbData->addStatValue(
+        "fib.route_programming.chunks", 1, fb303::COUNT);
+
+    inflightRouteChunks_.emplace_back(InflightRouteChunk{
+        std::move(chunk), std::move(result), std::chrono::steady_clock::now()});
+    pendingRouteChunks_.pop_front();
+  }
 }
 
 bool
+Fib::isRouteStreaming() const {
+#if FOLLY_HAS_COROUTINES
+  return routeStreamClient_ and routeStreamClient_->isSupported();
+#else
+  return false;
+#endif
+}
+
+void
+Fib::routeChunksTask(folly::fibers::Baton& stopSignal) noexcept {
+  XLOG(INFO) << "Starting RouteChunks fiber task";
+
+  // Repeat in loop
+  while (not stopSignal.ready()) {
+    // Fill up the window of in-flight chunks. Wait for signal if idle.
+    dispatchRouteChunks();
+    if (inflightRouteChunks_.empty()) {
+      routeChunksSignal_.wait();
+      continue;
+    }
+
+    // Await the oldest in-flight chunk. Fiber gets suspended meanwhile and
+    // new route updates can be queued or overtake queued chunks.
+    auto result = std::move(inflightRouteChunks_.front().result).getTry();
+    auto inflight = std::move(inflightRouteChunks_.front());
+    inflightRouteChunks_.pop_front();
+    auto& chunk = inflight.chunk;
+    for (auto const& prefix : chunk.unicastRoutesToDelete) {
+      inflightPrefixes_.erase(prefix);
+    }
+    for (auto const& [prefix, _] : chunk.unicastRoutesToUpdate) {
+      inflightPrefixes_.erase(prefix);
+    }
+
+    const auto elapsedTime = std::chrono::ceil<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - inflight.dispatchTime);
+    fb303::fbData->addStatValue(
+        "fib.route_programming.chunk_time_ms",
+        elapsedTime.count(),
+        fb303::AVG);
+
+    // Mark only routes of this chunk as dirty on failure
+    const bool isDeleteChunk = not chunk.unicastRoutesToDelete.empty();
+    auto const retryAt = std::chrono::steady_clock::now() +
+        unicastRetryBackoff_.getTimeRemainingUntilRetry();
+    if (auto fibUpdateError =
+            result.tryGetExceptionObject<thrift::PlatformFibUpdateError>()) {
+      logFibUpdateError(*fibUpdateError);
+      // Remove failed routes from chunk publication
+      chunk.processFibUpdateError(*fibUpdateError);
+      // Mark failed routes as dirty in route state
+      routeState_.processFibUpdateError(*fibUpdateError, retryAt);
+    } else if (result.hasException()) {
+      client_.reset();
+#if FOLLY_HAS_COROUTINES
+      if (routeStreamClient_) {
+        routeStreamClient_->close();
+      }
+#endif
+      fb303::fbData->addStatValue(
+          "fib.thrift.failure.add_del_route", 1, fb303::COUNT);
+      XLOG(ERR) << "Failed to program chunk of unicast routes in FIB. Error: "
+                << result.exception().what();
+      // Mark routes of this chunk as dirty for retry. Failed add/updates are
+      // declared as deleted to client same as non chunked programming.
+      for (const auto& prefix : chunk.unicastRoutesToDelete) {
+        routeState_.dirtyPrefixes.schedule(prefix, retryAt);
+      }
+      for (auto& [prefix, _] : chunk.unicastRoutesToUpdate) {
+        routeState_.dirtyPrefixes.schedule(prefix, retryAt);
+        chunk.unicastRoutesToDelete.emplace_back(prefix);
+      }
+      chunk.unicastRoutesToUpdate.clear();
+    }
+    if (routeState_.needsRetry()) {
+      retryRoutesSignal_.signal();
+    }
+
+    // Signal full sync awaiting on in-flight chunks
+    if (inflightRouteChunks_.empty() and awaitingRouteChunksDrain_) {
+      routeChunksDrainedSignal_.post();
+    }
+
+    // Publish programmed routes of this chunk. Deletions are already
+    // published along with the route update.
+    if (isDeleteChunk) {
+      chunk.unicastRoutesToDelete.clear();
+    }
+    if (chunk.empty() and not chunk.perfEvents.has_value()) {
+      continue;
+    }
+    chunk.type = DecisionRouteUpdate::INCREMENTAL;
+    fibRouteUpdatesQueue_.push(std::move(chunk));
+  } // while
+
+  XLOG(INFO) << "RouteChunks fiber task got stopped";
+}
+
+void
+Fib::drainRouteChunks() {
+  pendingRouteChunks_.clear();
+
+  awaitingRouteChunksDrain_ = true;
+  while (not inflightRouteChunks_.empty()) {
+    routeChunksDrainedSignal_.wait();
+    routeChunksDrainedSignal_.reset();
+  }
+  awaitingRouteChunksDrain_ = false;
+}
+
+Fib::ProgrammingStatus
 Fib::syncRoutes() {
   SCOPE_EXIT {
     updateRoutesSemaphore_.signal(); // Release when this function returns
   };
   updateRoutesSemaphore_.wait();
 
-  // Create set of routes to sync in thrift format
-  const auto& unicastRoutes =
-      createUnicastRoutesFromMap(routeState_.unicastRoutes);
-  const auto& mplsRoutes = createMplsRoutesFromMap(routeState_.mplsRoutes);
-  const auto currentTime = std::chrono::steady_clock::now();
-  const auto retryAt =
-      currentTime + retryRoutesExpBackoff_.getTimeRemainingUntilRetry();
-  fb303::fbData->addStatValue("fib.sync_fib_calls", 1, fb303::COUNT);
+  // Queued and in-flight route chunks are superseded by full sync
+  drainRouteChunks();
 
   // Create DecisionRouteUpdate that'll be published after successful sync. On
   // partial failures we remove routes from this update.
   auto fibRouteUpdates = routeState_.createUpdate();
+  pruneRouteUpdate(fibRouteUpdates);
+
+  // Create set of routes to sync in thrift format
+  std::vector<thrift::UnicastRoute> unicastRoutes;
+  unicastRoutes.reserve(fibRouteUpdates.unicastRoutesToUpdate.size());
+  for (const auto& [_, route] : fibRouteUpdates.unicastRoutesToUpdate) {
+    unicastRoutes.emplace_back(route.toThrift());
+  }
+  std::vector<thrift::MplsRoute> mplsRoutes;
+  mplsRoutes.reserve(fibRouteUpdates.mplsRoutesToUpdate.size());
+  for (const auto& [_, route] : fibRouteUpdates.mplsRoutesToUpdate) {
+    mplsRoutes.emplace_back(route.toThrift());
+  }
+  const auto currentTime = std::chrono::steady_clock::now();
+  const auto unicastRetryAt =
+      currentTime + unicastRetryBackoff_.getTimeRemainingUntilRetry();
+  const auto mplsRetryAt =
+      currentTime + mplsRetryBackoff_.getTimeRemainingUntilRetry();
+  fb303::fbData->addStatValue("fib.sync_fib_calls", 1, fb303::COUNT);
 
   // update flat counters here as they depend on routeState_ and its change
   updateGlobalCounters();
@@ -823,20 +1465,27 @@ Fib::syncRoutes() {
   } else {
     try {
       createFibClient(*getEvb(), socket_, client_, thriftPort_);
-      client_->sync_syncFib(kFibId_, unicastRoutes);
+      if (not enableDifferentialSync_ or
+          not syncUnicastRouteRanges(unicastRoutes)) {
+        if (enableMinimalDiffSync_) {
+          syncUnicastRouteDiff(unicastRoutes);
+        } else {
+          client_->sync_syncFib(kFibId_, unicastRoutes);
+        }
+      }
     } catch (thrift::PlatformFibUpdateError const& fibUpdateError) {
       logFibUpdateError(fibUpdateError);
       // Remove failed routes from fibRouteUpdates
       fibRouteUpdates.processFibUpdateError(fibUpdateError);
       // Mark failed routes as dirty in route state
-      routeState_.processFibUpdateError(fibUpdateError, retryAt);
+      routeState_.processFibUpdateError(fibUpdateError, unicastRetryAt);
     } catch (std::exception const& e) {
       client_.reset();
       fb303::fbData->addStatValue(
           "fib.thrift.failure.sync_fib", 1, fb303::COUNT);
       XLOG(ERR) << "Failed to sync unicast routes in FIB. Error: "
                 << folly::exceptionStr(e);
-      return false;
+      return {false /* unicast */, false /* mpls */};
     }
   }
 
@@ -857,14 +1506,14 @@ Fib::syncRoutes() {
         // Remove failed routes from fibRouteUpdates
         fibRouteUpdates.processFibUpdateError(fibUpdateError);
         // Mark failed routes as dirty in route state
-        routeState_.processFibUpdateError(fibUpdateError, retryAt);
+        routeState_.processFibUpdateError(fibUpdateError, mplsRetryAt);
       } catch (std::exception const& e) {
         client_.reset();
         fb303::fbData->addStatValue(
             "fib.thrift.failure.sync_fib", 1, fb303::COUNT);
         XLOG(ERR) << "Failed to sync unicast routes in FIB. Error: "
                   << folly::exceptionStr(e);
-        return false;
+        return {true /* unicast */, false /* mpls */};
       }
     } // else
   } // if enableSegmentRouting_
@@ -892,9 +1541,245 @@ Fib::syncRoutes() {
     routeState_.isInitialSynced = true;
     logInitializationEvent("Fib", thrift::InitializationEvent::FIB_SYNCED);
   }
+  return {};
+}
+
+bool
+Fib::syncUnicastRouteRanges(
+    const std::vector<thrift::UnicastRoute>& unicastRoutes) {
+  std::map<int32_t, int64_t> agentDigests;
+  try {
+    client_->sync_getUnicastRouteDigests(
+        agentDigests, kFibId_, differentialSyncRanges_);
+  } catch (apache::thrift::TApplicationException const& e) {
+    XLOG(WARNING) << "FibService doesn't support differential sync. Error: "
+                  << folly::exceptionStr(e);
+    return false;
+  }
+
+  // Compute digests of routes to be programmed
+  std::vector<folly::CIDRNetwork> prefixes;
+  std::unordered_map<folly::CIDRNetwork, uint64_t> routeDigests;
+  prefixes.reserve(unicastRoutes.size());
+  for (auto const& route : unicastRoutes) {
+    const auto& prefix = prefixes.emplace_back(toIPNetwork(*route.dest_ref()));
+    routeDigests.emplace(prefix, getUnicastRouteDigest(route));
+  }
+  const auto digests =
+      getUnicastRouteRangeDigests(routeDigests, differentialSyncRanges_);
+
+  // Find ranges which differ, including the ones we have no routes for
+  std::set<int32_t> ranges;
+  for (auto const& [range, digest] : digests) {
+    auto it = agentDigests.find(range);
+    if (it == agentDigests.end() or it->second != digest) {
+      ranges.emplace(range);
+    }
+  }
+  for (auto const& [range, _] : agentDigests) {
+    if (not digests.count(range)) {
+      ranges.emplace(range);
+    }
+  }
+  fb303::fbData->addStatValue("fib.sync_fib_ranges", ranges.size(), fb303::SUM);
+
+  if (ranges.empty()) {
+    XLOG(INFO) << "Unicast routes are in sync with FIB. Skip programming";
+    return true;
+  }
+
+  std::vector<thrift::UnicastRoute> routesToSync;
+  for (size_t i = 0; i < unicastRoutes.size(); ++i) {
+    if (ranges.count(getPrefixRange(prefixes[i], differentialSyncRanges_))) {
+      routesToSync.emplace_back(unicastRoutes[i]);
+    }
+  }
+  XLOG(INFO) << "Syncing " << routesToSync.size() << " unicast routes of "
+             << ranges.size() << " out of " << differentialSyncRanges_
+             << " prefix ranges in FIB";
+  if (enableMinimalDiffSync_) {
+    syncUnicastRouteDiff(routesToSync, &ranges);
+    return true;
+  }
+  client_->sync_syncFibRanges(
+      kFibId_,
+      differentialSyncRanges_,
+      std::vector<int32_t>(ranges.begin(), ranges.end()),
+      routesToSync);
   return true;
 }
 
+void
+Fib::syncUnicastRouteDiff(
+    const std::vector<thrift::UnicastRoute>& unicastRoutes,
+    const std::set<int32_t>* ranges) {
+  std::vector<thrift::UnicastRoute> agentRoutes;
+  client_->sync_getRouteTableByClient(agentRoutes, kFibId_);
+
+  // Digests of programmed routes. Equal digests mean equal forwarding.
+  std::unordered_map<folly::CIDRNetwork, uint64_t> agentDigests;
+  for (auto const& route : agentRoutes) {
+    auto prefix = toIPNetwork(*route.dest_ref());
+    if (ranges and
+        not ranges->count(getPrefixRange(prefix, differentialSyncRanges_))) {
+      continue;
+    }
+    agentDigests.emplace(std::move(prefix), getUnicastRouteDigest(route));
+  }
+
+  // Add or update routes missing or differing in FIB. Whatever remains in
+  // `agentDigests` is stale.
+  std::vector<thrift::UnicastRoute> routesToUpdate;
+  for (auto const& route : unicastRoutes) {
+    auto it = agentDigests.find(toIPNetwork(*route.dest_ref()));
+    if (it == agentDigests.end()) {
+      routesToUpdate.emplace_back(route);
+      continue;
+    }
+    if (it->second != getUnicastRouteDigest(route)) {
+      routesToUpdate.emplace_back(route);
+    }
+    agentDigests.erase(it);
+  }
+  std::vector<thrift::IpPrefix> prefixesToDelete;
+  prefixesToDelete.reserve(agentDigests.size());
+  for (auto const& [prefix, _] : agentDigests) {
+    prefixesToDelete.emplace_back(toIpPrefix(prefix));
+  }
+
+  XLOG(INFO) << "Syncing unicast routes by diff with " << agentRoutes.size()
+             << " routes in FIB. Updating " << routesToUpdate.size()
+             << " and deleting " << prefixesToDelete.size() << " routes";
+  fb303::fbData->addStatValue(
+      "fib.sync_fib_diff.num_routes_updated",
+      routesToUpdate.size(),
+      fb303::SUM);
+  fb303::fbData->addStatValue(
+      "fib.sync_fib_diff.num_routes_deleted",
+      prefixesToDelete.size(),
+      fb303::SUM);
+
+  // Delete first to free up FIB resources for updates
+  if (not prefixesToDelete.empty()) {
+    client_->sync_deleteUnicastRoutes(kFibId_, prefixesToDelete);
+  }
+  if (not routesToUpdate.empty()) {
+    client_->sync_addUnicastRoutes(kFibId_, routesToUpdate);
+  }
+}
+
+void
+Fib::processInterfaceUpdates(InterfaceDatabase&& interfaceDb) {
+  const auto startTime = std::chrono::steady_clock::now();
+
+  // Find interfaces gone down or up since the last update
+  std::unordered_set<std::string> upInterfaces;
+  std::unordered_set<std::string> changedInterfaces;
+  for (const auto& info : interfaceDb) {
+    if (info.isUp) {
+      upInterfaces.emplace(info.ifName);
+      if (downInterfaces_.erase(info.ifName)) {
+        changedInterfaces.emplace(info.ifName);
+      }
+    } else if (downInterfaces_.emplace(info.ifName).second) {
+      changedInterfaces.emplace(info.ifName);
+    }
+  }
+  for (const auto& ifName : upInterfaces_) {
+    if (not upInterfaces.count(ifName) and
+        downInterfaces_.emplace(ifName).second) {
+      changedInterfaces.emplace(ifName);
+    }
+  }
+  upInterfaces_ = std::move(upInterfaces);
+  if (changedInterfaces.empty()) {
+    return;
+  }
+
+  // Re-program routes with next-hops via changed interfaces. They get pruned
+  // or restored while being programmed.
+  auto usesChangedInterface =
+      [&changedInterfaces](
+          const std::unordered_set<thrift::NextHopThrift>& nexthops) {
+        for (const auto& nh : nexthops) {
+          const auto& ifName = nh.address_ref()->ifName_ref();
+          if (ifName.has_value() and changedInterfaces.count(*ifName)) {
+            return true;
+          }
+        }
+        return false;
+      };
+  DecisionRouteUpdate routeUpdate;
+  for (const auto& [prefix, route] : routeState_.unicastRoutes) {
+    if (usesChangedInterface(route->nexthops)) {
+      routeUpdate.unicastRoutesToUpdate.emplace(prefix, *route);
+    }
+  }
+  if (enableSegmentRouting_) {
+    for (const auto& [label, route] : routeState_.mplsRoutes) {
+      if (usesChangedInterface(route->nexthops)) {
+        routeUpdate.mplsRoutesToUpdate.emplace(label, *route);
+      }
+    }
+  }
+
+  XLOG(INFO) << fmt::format(
+      "Fast reroute of {} routes on change of interfaces [{}]",
+      routeUpdate.size(),
+      folly::join(", ", changedInterfaces));
+  if (routeUpdate.empty()) {
+    return;
+  }
+  fb303::fbData->addStatValue(
+      "fib.fast_reroute.routes", routeUpdate.size(), fb303::SUM);
+  updateRoutes(std::move(routeUpdate));
+
+  const auto elapsedTime = std::chrono::ceil<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - startTime);
+  fb303::fbData->addStatValue(
+      "fib.fast_reroute.time_ms", elapsedTime.count(), fb303::AVG);
+}
+
+std::optional<std::unordered_set<thrift::NextHopThrift>>
+Fib::getPrunedNexthops(
+    const std::unordered_set<thrift::NextHopThrift>& nexthops) const {
+  if (downInterfaces_.empty()) {
+    return std::nullopt;
+  }
+
+  std::unordered_set<thrift::NextHopThrift> prunedNexthops;
+  for (const auto& nh : nexthops) {
+    const auto& ifName = nh.address_ref()->ifName_ref();
+    if (not ifName.has_value() or not downInterfaces_.count(*ifName)) {
+      prunedNexthops.emplace(nh);
+    }
+  }
+  if (prunedNexthops.empty() or prunedNexthops.size() == nexthops.size()) {
+    return std::nullopt;
+  }
+  return prunedNexthops;
+}
+
+void
+Fib::pruneRouteUpdate(DecisionRouteUpdate& routeUpdate) const {
+  if (downInterfaces_.empty()) {
+    return;
+  }
+
+  for (auto& [_, route] : routeUpdate.unicastRoutesToUpdate) {
+    if (auto nexthops = getPrunedNexthops(route.nexthops)) {
+      route.nexthops = std::move(*nexthops);
+      route.internNexthops();
+    }
+  }
+  for (auto& [_, route] : routeUpdate.mplsRoutesToUpdate) {
+    if (auto nexthops = getPrunedNexthops(route.nexthops)) {
+      route.nexthops = std::move(*nexthops);
+      route.internNexthops();
+    }
+  }
+}
+
 void
 Fib::retryRoutesTask(folly::fibers::Baton& stopSignal) noexcept {
   XLOG(INFO) << "Starting RetryRoutes fiber task";
@@ -919,13 +1804,30 @@ Fib::retryRoutesTask(folly::fibers::Baton& stopSignal) noexcept {
 
 void
 Fib::retryRoutes() noexcept {
-  bool success{false};
-  retryRoutesExpBackoff_.reportError(); // We increase backoff on every retry
-  XLOG(INFO) << "Increasing backoff "
-             << retryRoutesExpBackoff_.getCurrentBackoff().count() << "ms";
+  // We increase backoff of a route class on every retry of its routes, and
+  // clear it if programming is successful. See [Retry Scheduling]
+  auto reportRetry = [](auto& backoff, const std::string& routeClass) {
+    backoff.reportError();
+    XLOG(INFO) << "Increasing " << routeClass << " backoff "
+               << backoff.getCurrentBackoff().count() << "ms";
+  };
+  auto reportSuccess = [](auto& backoff, const std::string& routeClass) {
+    XLOG(INFO) << "Clearing " << routeClass << " backoff";
+    backoff.reportSuccess();
+  };
+
   if (routeState_.state == RouteState::SYNCING) {
-    // SYNC routes if we've RIB snapshot from Decision
-    success |= syncRoutes();
+    // SYNC routes if we've RIB snapshot from Decision. Sync covers both route
+    // classes.
+    reportRetry(unicastRetryBackoff_, "unicast");
+    reportRetry(mplsRetryBackoff_, "mpls");
+    const auto status = syncRoutes();
+    if (status.unicast) {
+      reportSuccess(unicastRetryBackoff_, "unicast");
+    }
+    if (status.mpls) {
+      reportSuccess(mplsRetryBackoff_, "mpls");
+    }
   } else {
     // We retry incremental update of routes based on dirty state in AWAITING
     // & SYNCED states
@@ -934,14 +1836,25 @@ Fib::retryRoutes() noexcept {
       XLOG(INFO) << "Returning because of empty updates";
       return; // Do not process further as this incurred no change
     }
+    const bool retryUnicast = routeUpdate.unicastRoutesToUpdate.size() or
+        routeUpdate.unicastRoutesToDelete.size();
+    const bool retryMpls = routeUpdate.mplsRoutesToUpdate.size() or
+        routeUpdate.mplsRoutesToDelete.size();
+    if (retryUnicast) {
+      reportRetry(unicastRetryBackoff_, "unicast");
+    }
+    if (retryMpls) {
+      reportRetry(mplsRetryBackoff_, "mpls");
+    }
     XLOG(INFO) << "Retry programming of dirty route entries";
-    success |= updateRoutes(std::move(routeUpdate), false /* useDeleteDelay */);
-  }
-
-  // Clear backoff if programming is successful
-  if (success) {
-    XLOG(INFO) << "Clearing backoff";
-    retryRoutesExpBackoff_.reportSuccess();
+    const auto status =
+        updateRoutes(std::move(routeUpdate), false /* useDeleteDelay */);
+    if (retryUnicast and status.unicast) {
+      reportSuccess(unicastRetryBackoff_, "unicast");
+    }
+    if (retryMpls and status.mpls) {
+      reportSuccess(mplsRetryBackoff_, "mpls");
+    }
   }
 
   // Set sync state
@@ -986,7 +1899,8 @@ Fib::keepAlive() noexcept {
                   << "Performing full route DB sync ...";
     // FibAgent has restarted. Enforce full sync
     transitionRouteState(RouteState::FIB_CONNECTED);
-    retryRoutesExpBackoff_.reportSuccess();
+    unicastRetryBackoff_.reportSuccess();
+    mplsRetryBackoff_.reportSuccess();
     retryRoutesSignal_.signal();
   }
   latestAliveSince_ = aliveSince;
@@ -1053,6 +1967,7 @@ Fib::logPerfEvents(std::optional<thrift::PerfEvents>& perfEvents) {
   if (not perfEvents.has_value() or not perfEvents->events_ref()->size()) {
     return;
   }
+  ConvergenceTracer::record(*perfEvents, "FIB_ROUTES_PROGRAMMED");
 
   // Ignore bad perf event sample if creation time of first event is
   // less than creation time of our recently logged perf events.
@@ -1088,10 +2003,9 @@ Fib::logPerfEvents(std::optional<thrift::PerfEvents>& perfEvents) {
   }
 
   // Add new entry to perf DB and purge extra entries
+  convergenceStats_.addPerfEvents(*perfEvents);
   perfDb_.push_back(std::move(perfEvents).value());
-  while (perfDb_.size() >= Constants::kPerfBufferSize) {
-    perfDb_.pop_front();
-  }
+  trimPerfDb();
 
   // Export convergence duration counter
   fb303::fbData->addStatValue(
@@ -1105,6 +2019,31 @@ Fib::logPerfEvents(std::optional<thrift::PerfEvents>& perfEvents) {
   logSampleQueue_.push(sample);
 }
 
+void
+Fib::trimPerfDb() {
+  if (memoryPressure_ >= MemoryPressureLevel::COMPACT_LOGS) {
+    if (perfDb_.size() > 1) {
+      fb303::fbData->addStatValue(
+          "fib.memory_pressure.perf_events_dropped",
+          perfDb_.size() - 1,
+          fb303::COUNT);
+      perfDb_.erase(perfDb_.begin(), perfDb_.end() - 1);
+    }
+    return;
+  }
+  while (perfDb_.size() >= Constants::kPerfBufferSize) {
+    perfDb_.pop_front();
+  }
+}
+
+void
+Fib::setMemoryPressure(MemoryPressureLevel level) {
+  runInEventBaseThread([this, level]() {
+    memoryPressure_ = level;
+    trimPerfDb();
+  });
+}
+
 std::string
 Fib::RouteState::toStr(RouteState::State state) {
   switch (state) {
@@ -1168,7 +2107,9 @@ Fib::transitionRouteState(const RouteState::Event event) {
   // previously installed static route should be ignored.
   if (prevState == RouteState::AWAITING && nextState == RouteState::SYNCING) {
     routeState_.unicastRoutes.clear();
+    routeState_.unicastFingerprints.clear();
     routeState_.mplsRoutes.clear();
+    invalidateRouteSnapshot();
   }
 }
 
@@ -7,16 +7,30 @@
 
 #pragma once
 
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include <folly/concurrency/AtomicSharedPtr.h>
 #include <folly/fibers/Semaphore.h>
+#include <folly/futures/Future.h>
 #include <folly/io/async/AsyncSocket.h>
 #include <folly/io/async/AsyncTimeout.h>
 
 #include <openr/common/ExponentialBackoff.h>
+#include <openr/common/LsdbTypes.h>
+#include <openr/common/MemoryPressure.h>
 #include <openr/common/OpenrEventBase.h>
+#include <openr/common/PrefixTrie.h>
+#include <openr/common/TimerWheel.h>
 #include <openr/config/Config.h>
 #include <openr/decision/RibEntry.h>
 #include <openr/decision/RouteUpdate.h>
+#include <openr/fib/ConvergenceStats.h>
+#include <openr/fib/RouteFingerprints.h>
+#include <openr/fib/RouteStreamClient.h>
 #include <openr/if/gen-cpp2/FibService.h>
+#include <openr/if/gen-cpp2/OpenrCtrl_types.h>
 #include <openr/if/gen-cpp2/Platform_types.h>
 #include <openr/if/gen-cpp2/Types_types.h>
 #include <openr/messaging/ReplicateQueue.h>
@@ -41,7 +55,10 @@ class Fib final : public OpenrEventBase {
       messaging::RQueue<DecisionRouteUpdate> routeUpdatesQueue,
       // producer queue
       messaging::ReplicateQueue<DecisionRouteUpdate>& fibRouteUpdatesQueue,
-      messaging::ReplicateQueue<LogSample>& logSampleQueue);
+      messaging::ReplicateQueue<LogSample>& logSampleQueue,
+      // interface updates from LinkMonitor. See [Fast Reroute]
+      std::optional<messaging::RQueue<InterfaceDatabase>>
+          interfaceUpdatesQueue = std::nullopt);
 
   /**
    * Override stop method of OpenrEventBase
@@ -66,10 +83,47 @@ class Fib final : public OpenrEventBase {
    *
    * @return the matched CIDRNetwork if prefix matching succeed.
    */
-  static std::optional<folly::CIDRNetwork> longestPrefixMatch(
+  template <typename UnicastEntry>
+  static std::optional<folly::CIDRNetwork>
+  longestPrefixMatch(
       const folly::CIDRNetwork& inputPrefix,
-      const std::unordered_map<folly::CIDRNetwork, RibUnicastEntry>&
-          unicastRoutes);
+      const std::unordered_map<folly::CIDRNetwork, UnicastEntry>&
+          unicastRoutes) {
+    std::optional<folly::CIDRNetwork> matchedPrefix;
+    int maxMask = -1;
+    const auto& inputIP = inputPrefix.first;
+    const auto& inputMask = inputPrefix.second;
+
+    // longest prefix matching
+    for (const auto& route : unicastRoutes) {
+      const auto& dbIP = route.first.first;
+      const auto& dbMask = route.first.second;
+
+      if (maxMask < dbMask && inputMask >= dbMask &&
+          inputIP.mask(dbMask) == dbIP) {
+        maxMask = dbMask;
+        matchedPrefix = route.first;
+      }
+    }
+    return matchedPrefix;
+  }
+
+  /**
+   * [Update Coalescing]
+   *
+   * Merge `routeUpdate` into `pending`, an update received earlier and not yet
+   * programmed. The latest add/update or delete of a prefix or label wins. A
+   * delete of a prefix or label, which was added within `pending` and isn't
+   * known to FIB as reported by `isPrefixKnown` or `isLabelKnown`, cancels
+   * out the add. Perf events of the latest update are retained.
+   *
+   * @return number of route operations avoided
+   */
+  static size_t coalesceRouteUpdate(
+      DecisionRouteUpdate& pending,
+      DecisionRouteUpdate&& routeUpdate,
+      const std::function<bool(const folly::CIDRNetwork&)>& isPrefixKnown,
+      const std::function<bool(int32_t)>& isLabelKnown);
 
   /**
    * Show unicast routes which are to be added or updated
@@ -98,6 +152,14 @@ class Fib final : public OpenrEventBase {
   folly::SemiFuture<std::unique_ptr<std::vector<thrift::UnicastRoute>>>
   getUnicastRoutes(std::vector<std::string> prefixes);
 
+  /**
+   * Retrieve page of unicast routes ordered by prefix, see [Paginated Dump].
+   * Pages following the first one are served out of the same snapshot while
+   * it's retained, see [Route Snapshot].
+   */
+  folly::SemiFuture<std::unique_ptr<thrift::UnicastRoutesPage>>
+  getUnicastRoutesPage(thrift::PageParams pageParams);
+
   /**
    * Retrieve mpls routes for specified labels. Returns all if no label is
    * specified in filter list.
@@ -105,16 +167,45 @@ class Fib final : public OpenrEventBase {
   folly::SemiFuture<std::unique_ptr<std::vector<thrift::MplsRoute>>>
   getMplsRoutes(std::vector<int32_t> labels);
 
+  /**
+   * [Route Lookup] Resolve every address into the unicast route forwarding
+   * it, by longest prefix match. Results are in order of `addresses`.
+   */
+  folly::SemiFuture<std::unique_ptr<std::vector<thrift::RouteLookupResult>>>
+  lookupRoutes(std::vector<folly::IPAddress> addresses);
+
+  /**
+   * [Route Fingerprint] Retrieve fingerprints of unicast routes within
+   * `ranges`, in order. Returns fingerprints of all non-empty maintained
+   * ranges if no range is specified.
+   */
+  folly::SemiFuture<std::unique_ptr<std::vector<thrift::RouteFingerprint>>>
+  getUnicastRouteFingerprints(std::vector<folly::CIDRNetwork> ranges);
+
   /**
    * Retrieve performance related information from FIB module
    */
   folly::SemiFuture<std::unique_ptr<thrift::PerfDatabase>> getPerfDb();
 
+  /**
+   * Retrieve distributions of route convergence durations, see
+   * [Convergence Stats]
+   */
+  folly::SemiFuture<
+      std::unique_ptr<std::vector<thrift::ConvergenceDistribution>>>
+  getConvergenceDistributions();
+
   /**
    * API to get reader for fibUpdatesQueue
    */
   messaging::RQueue<DecisionRouteUpdate> getFibUpdatesReader();
 
+  /**
+   * [Memory Governor] Only the latest perf events are retained from
+   * COMPACT_LOGS on. Safe to call from any thread.
+   */
+  void setMemoryPressure(MemoryPressureLevel level);
+
  private:
   // No-copy
   Fib(const Fib&) = delete;
@@ -125,28 +216,132 @@ class Fib final : public OpenrEventBase {
    */
   thrift::PerfDatabase dumpPerfDb() const;
 
+  /**
+   * [Shared Route Entries]
+   * Routes are held as immutable entries shared between RouteState and route
+   * snapshots. An updated route replaces the pointer of its prefix or label,
+   * hence a snapshot costs a pointer per route instead of a deep copy of the
+   * route with its next-hops.
+   */
+  using UnicastRouteMap = std::unordered_map<
+      folly::CIDRNetwork,
+      std::shared_ptr<const RibUnicastEntry>>;
+  using MplsRouteMap =
+      std::unordered_map<int32_t, std::shared_ptr<const RibMplsEntry>>;
+
+  /**
+   * [Route Snapshot]
+   * Immutable copy of routes in RouteState, shared with control-plane reads.
+   * Reads convert routes out of the snapshot on the calling thread. The
+   * snapshot is dropped upon any route change and built again on the event
+   * base by the first read after it. Hence routes are copied at most once per
+   * route change, regardless of the number of reads. See [Shared Route
+   * Entries]
+   *
+   * Snapshots are versioned for paginated reads. Snapshot of the latest first
+   * page is retained even if outdated, so that following pages are served
+   * out of it.
+   */
+  struct RouteSnapshot {
+    UnicastRouteMap unicastRoutes;
+    MplsRouteMap mplsRoutes;
+    int64_t version{0};
+
+    // Prefixes of unicastRoutes in ascending order, sorted on first
+    // paginated read of the snapshot
+    mutable std::once_flag sortedPrefixesOnce;
+    mutable std::vector<folly::CIDRNetwork> sortedPrefixes;
+
+    // [Route Lookup] Longest prefix match index of unicastRoutes, built on
+    // first lookup of the snapshot. Entries point into unicastRoutes.
+    mutable std::once_flag prefixIndexOnce;
+    mutable PrefixTrie<const RibUnicastEntry*> prefixIndex;
+
+    // [Route Fingerprint] Copy of fingerprints of unicastRoutes
+    RouteFingerprints unicastFingerprints;
+  };
+
+  /**
+   * Retrieve the latest route snapshot. Served without scheduling on the event
+   * base unless routes have changed since the snapshot was built.
+   */
+  folly::SemiFuture<std::shared_ptr<const RouteSnapshot>> getRouteSnapshot();
+
+  /**
+   * Drop the route snapshot. MUST be called on every change of routes in
+   * RouteState.
+   */
+  void
+  invalidateRouteSnapshot() {
+    routeSnapshot_.store(nullptr);
+  }
+
   /**
    * Retrieve unicast routes with specified filters
    */
-  std::vector<thrift::UnicastRoute> getUnicastRoutesFiltered(
-      std::vector<std::string> prefixes);
+  static std::vector<thrift::UnicastRoute> getUnicastRoutesFiltered(
+      const RouteSnapshot& snapshot, std::vector<std::string> prefixes);
+
+  /**
+   * Retrieve page of unicast routes out of the snapshot
+   */
+  static std::unique_ptr<thrift::UnicastRoutesPage> getUnicastRoutesPage(
+      const RouteSnapshot& snapshot, const thrift::PageParams& pageParams);
+
+  /**
+   * Unicast route of the longest prefix containing `prefix` out of the
+   * snapshot, nullptr if none
+   */
+  static const RibUnicastEntry* findLongestPrefixMatch(
+      const RouteSnapshot& snapshot, const folly::CIDRNetwork& prefix);
+
+  /**
+   * Resolve addresses into unicast routes out of the snapshot
+   */
+  static std::vector<thrift::RouteLookupResult> lookupRoutes(
+      const RouteSnapshot& snapshot,
+      const std::vector<folly::IPAddress>& addresses);
+
+  /**
+   * Fingerprints of unicast routes within `ranges` out of the snapshot.
+   * Ranges longer than maintained ones are computed out of the routes.
+   */
+  static std::vector<thrift::RouteFingerprint> getUnicastRouteFingerprints(
+      const RouteSnapshot& snapshot,
+      const std::vector<folly::CIDRNetwork>& ranges);
 
   /**
    * Retrieve mpls routes with specified filters
    */
-  std::vector<thrift::MplsRoute> getMplsRoutesFiltered(
-      std::vector<int32_t> labels);
+  static std::vector<thrift::MplsRoute> getMplsRoutesFiltered(
+      const RouteSnapshot& snapshot, std::vector<int32_t> labels);
 
   /**
    * Process new route updates received from Decision module
    */
   void processDecisionRouteUpdate(DecisionRouteUpdate&& routeUpdate);
 
+  /**
+   * Merge route update read from the Decision queue into the pending one and
+   * account for avoided route operations. See [Update Coalescing]
+   */
+  void coalesceQueuedRouteUpdate(
+      DecisionRouteUpdate& pending, DecisionRouteUpdate&& routeUpdate);
+
+  /**
+   * Outcome of route programming per route class. Retry backoff is tracked
+   * independently for unicast and MPLS routes. See [Retry Scheduling]
+   */
+  struct ProgrammingStatus {
+    bool unicast{true};
+    bool mpls{true};
+  };
+
   /**
    * Incremental route programming.
-   * @return true if all routes are successfully programmed
+   * @return per route class, true if all routes are successfully programmed
    */
-  bool updateRoutes(
+  ProgrammingStatus updateRoutes(
       DecisionRouteUpdate&& routeUpdate, bool useDeleteDelay = true);
 
   /**
@@ -179,13 +374,102 @@ class Fib final : public OpenrEventBase {
       DecisionRouteUpdate& routeUpdate,
       thrift::RouteDatabaseDelta& routeDbDelta);
 
+  /**
+   * [Route Chunks]
+   *
+   * If `route_programming_chunk_size` is set, unicast routes are programmed
+   * in chunks of at most that many routes instead of a single FibService call
+   * per update. Chunks are queued and dispatched by `routeChunksTask`, which
+   * keeps up to `max_inflight_chunks` outstanding. Each chunk marks dirty and
+   * publishes only its own routes when it completes, so a failure is confined
+   * to the routes of that chunk.
+   *
+   * A newer route update drops its prefixes from queued chunks which are not
+   * yet dispatched. A chunk touching a prefix of an in-flight chunk waits for
+   * it to complete, which keeps programming order of a prefix intact.
+   */
+  void enqueueRouteChunks(
+      DecisionRouteUpdate& routeUpdate,
+      const std::vector<folly::CIDRNetwork>& routesToDelete);
+  void dispatchRouteChunks();
+  void routeChunksTask(folly::fibers::Baton& stopSignal) noexcept;
+
+  /**
+   * [Route Streaming]
+   *
+   * If `enable_route_streaming` is set, chunks are streamed to FibService
+   * over a single session instead of a call per chunk, see RouteStreamClient.
+   * Acks complete chunks the same way call responses do. As the agent
+   * programs streamed chunks in order, a chunk doesn't wait for in-flight
+   * chunks touching its prefixes. Falls back to a call per chunk if the agent
+   * doesn't support streaming.
+   */
+  bool isRouteStreaming() const;
+
+  /**
+   * Drop queued chunks and wait for in-flight chunks to complete. Invoked
+   * before full sync as it supersedes any pending chunk.
+   */
+  void drainRouteChunks();
+
   /**
    * Sync the current RouteState with the switch agent.
    * - On complete failure retry is scheduled
    * - On partial failure, the failed prefixes/labels are marked dirty and
    *   retryRoutesSignal is invoked.
+   * @return per route class, false if sync failed completely
+   */
+  ProgrammingStatus syncRoutes();
+
+  /**
+   * [Differential Sync]
+   * Sync only unicast routes of prefix ranges whose digest differ from the
+   * ones reported by FibService. Nothing is sent if all digests match e.g.
+   * after restart with routes already in FIB. Throws upon failure same as
+   * `syncFib`.
+   * @return false if FibService doesn't support differential sync
+   */
+  bool syncUnicastRouteRanges(
+      const std::vector<thrift::UnicastRoute>& unicastRoutes);
+
+  /**
+   * [Minimal Diff Sync]
+   * Sync unicast routes by comparing them with routes of FibService, fetched
+   * with `getRouteTableByClient`, and programming only the differing ones.
+   * Routes of FibService outside of `ranges`, if set, are left untouched.
+   * No route is written on warm restart with unchanged routes. Throws upon
+   * failure same as `syncFib`.
    */
-  bool syncRoutes();
+  void syncUnicastRouteDiff(
+      const std::vector<thrift::UnicastRoute>& unicastRoutes,
+      const std::set<int32_t>* ranges = nullptr);
+
+  /**
+   * [Fast Reroute]
+   * If `enable_fast_reroute` is set, Fib tracks interfaces reported down by
+   * LinkMonitor and prunes next-hops via them from every route it programs,
+   * while the remaining ECMP members keep forwarding. Routes using a newly
+   * down interface are re-programmed right away instead of waiting for
+   * Decision to recompute them. A route is left as is if all of its
+   * next-hops would be pruned.
+   *
+   * RouteState keeps routes as received from Decision, so once the interface
+   * is up again its routes are restored to them, and later updates from
+   * Decision reconcile pruned routes as usual.
+   */
+  void processInterfaceUpdates(InterfaceDatabase&& interfaceDb);
+
+  /**
+   * Next-hops left after pruning the ones via down interfaces. std::nullopt
+   * if none is pruned or none would be left.
+   */
+  std::optional<std::unordered_set<thrift::NextHopThrift>> getPrunedNexthops(
+      const std::unordered_set<thrift::NextHopThrift>& nexthops) const;
+
+  /**
+   * Prune next-hops via down interfaces from routes to update in place
+   */
+  void pruneRouteUpdate(DecisionRouteUpdate& routeUpdate) const;
 
   /**
    * Implements route re-programming logic, for failed routes and delayed route
@@ -222,9 +506,14 @@ class Fib final : public OpenrEventBase {
    * State variables to represent computed and programmed routes.
    */
   struct RouteState {
-    // Non modified copy of Unicast and MPLS routes received from Decision
-    std::unordered_map<folly::CIDRNetwork, RibUnicastEntry> unicastRoutes;
-    std::unordered_map<int32_t, RibMplsEntry> mplsRoutes;
+    // Non modified copy of Unicast and MPLS routes received from Decision.
+    // See [Shared Route Entries]
+    UnicastRouteMap unicastRoutes;
+    MplsRouteMap mplsRoutes;
+
+    // [Route Fingerprint] Fingerprints of unicastRoutes, MUST be updated
+    // along with them
+    RouteFingerprints unicastFingerprints;
 
     /**
      * Set of route keys (prefixes & labels) that needs to be updated in HW. Two
@@ -233,16 +522,14 @@ class Fib final : public OpenrEventBase {
      * 2) Prefix/Label experienced a programming failure
      * 3) A delete update needs to be delayed.
      * Along with prefixes and labels, we also store timestamp when routes are
-     * received or updated.
+     * to be retried or deleted.
+     *
+     * [Retry Scheduling] Keys are kept in timer wheels ordered by their
+     * deadline, so a retry tick touches only expired keys rather than the
+     * complete dirty set, and next retry time is known without a scan.
      */
-    std::unordered_map<
-        folly::CIDRNetwork,
-        std::chrono::time_point<std::chrono::steady_clock>>
-        dirtyPrefixes;
-    std::unordered_map<
-        uint32_t,
-        std::chrono::time_point<std::chrono::steady_clock>>
-        dirtyLabels;
+    TimerWheel<folly::CIDRNetwork> dirtyPrefixes;
+    TimerWheel<uint32_t> dirtyLabels;
 
     /**
      * Enumeration depicting the route event that may arrive and affect `State`
@@ -320,7 +607,7 @@ class Fib final : public OpenrEventBase {
 
   /**
    * Get the next earliest timestamps from those routes which are pending
-   * delete.
+   * delete or retry.
    */
   std::chrono::milliseconds nextRetryDuration() const;
 
@@ -333,9 +620,25 @@ class Fib final : public OpenrEventBase {
   // Instantiation of route state
   RouteState routeState_;
 
+  // Snapshot of routes in routeState_, unset if outdated. See [Route Snapshot]
+  folly::atomic_shared_ptr<const RouteSnapshot> routeSnapshot_;
+  int64_t routeSnapshotVersion_{0};
+
+  // Snapshot of the latest first page of paginated reads
+  folly::atomic_shared_ptr<const RouteSnapshot> pagedRouteSnapshot_;
+
   // Events to capture and indicate performance of protocol convergence.
   std::deque<thrift::PerfEvents> perfDb_;
 
+  // Distributions of convergence durations of all logged perf events
+  ConvergenceStats convergenceStats_;
+
+  // [Memory Governor] level notified by Watchdog
+  MemoryPressureLevel memoryPressure_{MemoryPressureLevel::NONE};
+
+  // Trim perfDb_ to its bound under current memory pressure
+  void trimPerfDb();
+
   // Create timestamp of recently logged perf event
   int64_t recentPerfEventCreateTs_{0};
 
@@ -357,22 +660,74 @@ class Fib final : public OpenrEventBase {
   // deleting a a route (both unicast and mpls).
   const std::chrono::milliseconds routeDeleteDelay_{0};
 
+  // Config knobs - Max number of unicast routes per FibService call and max
+  // number of outstanding calls. Chunking is disabled if chunk size is 0.
+  const size_t routeChunkSize_{0};
+  const size_t maxInflightChunks_{1};
+
+  // Config knob - Merge route updates queued up while programming routes.
+  // See [Update Coalescing]
+  const bool enableUpdateCoalescing_{false};
+
+  // Config knobs - Sync only unicast routes of differing prefix ranges and
+  // number of ranges. See [Differential Sync]
+  const bool enableDifferentialSync_{false};
+  const int32_t differentialSyncRanges_{1};
+
+  // Config knob - Program only routes differing from the ones of FibService
+  // on full sync. See [Minimal Diff Sync]
+  const bool enableMinimalDiffSync_{false};
+
+  // Config knob - Prune next-hops via down interfaces. See [Fast Reroute]
+  const bool enableFastReroute_{false};
+
+  // Interfaces reported down and up in the last interface update. Interfaces
+  // missing from an update are considered down.
+  std::unordered_set<std::string> downInterfaces_;
+  std::unordered_set<std::string> upInterfaces_;
+
   // Thrift client connection to switch FIB Agent using which we actually
   // manipulate routes.
   folly::AsyncSocket* socket_{nullptr};
   std::unique_ptr<thrift::FibServiceAsyncClient> client_{nullptr};
 
+#if FOLLY_HAS_COROUTINES
+  // Streaming session with switch FIB Agent, if enabled. See [Route Streaming]
+  std::unique_ptr<RouteStreamClient> routeStreamClient_{nullptr};
+#endif
+
   // State variables for RetryRoutes programming fiber.
   // - Stop signal to terminate retryRoutesFiber, sent only once
   // - Semaphore used for signalling when routes are available for programming
-  // - Exponential backoff to ease of things on repetitive failures
+  // - Exponential backoff to ease of things on repetitive failures, per route
+  //   class. Failing MPLS routes don't delay retry of unicast routes and vice
+  //   versa. See [Retry Scheduling]
   folly::fibers::Baton retryRoutesStopSignal_;
   folly::fibers::Semaphore retryRoutesSignal_{1};
-  ExponentialBackoff<std::chrono::milliseconds> retryRoutesExpBackoff_;
+  ExponentialBackoff<std::chrono::milliseconds> unicastRetryBackoff_;
+  ExponentialBackoff<std::chrono::milliseconds> mplsRetryBackoff_;
 
   // Stop signal for KeepAlive fiber
   folly::fibers::Baton keepAliveStopSignal_;
 
+  // State variables for route chunk programming. See [Route Chunks]
+  // - Chunks queued for dispatch and chunks awaiting FibService response
+  // - Prefixes of in-flight chunks
+  // - Semaphore used for signalling when chunks are queued
+  // - Signal posted when in-flight chunks drained, if awaited by full sync
+  struct InflightRouteChunk {
+    DecisionRouteUpdate chunk;
+    folly::SemiFuture<folly::Unit> result;
+    std::chrono::steady_clock::time_point dispatchTime;
+  };
+  std::deque<DecisionRouteUpdate> pendingRouteChunks_;
+  std::deque<InflightRouteChunk> inflightRouteChunks_;
+  std::unordered_set<folly::CIDRNetwork> inflightPrefixes_;
+  folly::fibers::Baton routeChunksStopSignal_;
+  folly::fibers::Semaphore routeChunksSignal_{1};
+  folly::fibers::Baton routeChunksDrainedSignal_;
+  bool awaitingRouteChunksDrain_{false};
+
   // Queues to publish programmed incremental IP/label routes or those from Fib
   // sync. (Fib streaming)
   messaging::ReplicateQueue<DecisionRouteUpdate>& fibRouteUpdatesQueue_;
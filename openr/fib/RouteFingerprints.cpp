@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/hash/Hash.h>
+#include <folly/logging/xlog.h>
+
+#include <openr/common/Constants.h>
+#include <openr/common/NetworkUtil.h>
+#include <openr/fib/RouteFingerprints.h>
+
+namespace openr {
+
+namespace {
+
+uint64_t
+combine(uint64_t digest, uint64_t value) {
+  return folly::hash::hash_128_to_64(digest, value);
+}
+
+uint64_t
+getNextHopDigest(const thrift::NextHopThrift& nextHop) {
+  const auto& address = *nextHop.address_ref();
+  uint64_t digest = folly::hash::fnv64_buf(
+      address.addr_ref()->data(), address.addr_ref()->size());
+  digest =
+      combine(digest, folly::hash::fnv64(address.ifName_ref().value_or("")));
+  digest = combine(digest, static_cast<uint64_t>(*nextHop.weight_ref()));
+  if (auto mplsAction = nextHop.mplsAction_ref()) {
+    digest = combine(digest, static_cast<uint64_t>(*mplsAction->action_ref()));
+    digest = combine(
+        digest, static_cast<uint64_t>(mplsAction->swapLabel_ref().value_or(0)));
+    if (auto pushLabels = mplsAction->pushLabels_ref()) {
+      // order of labels is significant
+      for (auto label : *pushLabels) {
+        digest = combine(digest, static_cast<uint64_t>(label));
+      }
+    }
+  }
+  return digest;
+}
+
+uint8_t
+getRangeLen(const folly::IPAddress& address) {
+  return address.isV4() ? Constants::kRouteFingerprintRangeLenV4
+                        : Constants::kRouteFingerprintRangeLenV6;
+}
+
+} // namespace
+
+int64_t
+RouteFingerprints::getRouteDigest(const RibUnicastEntry& route) {
+  const auto& [address, len] = route.prefix;
+  uint64_t digest =
+      folly::hash::fnv64_buf(address.bytes(), address.byteCount());
+  digest = combine(digest, len);
+
+  // addition keeps next-hops digest independent of their order
+  uint64_t nextHopsDigest{0};
+  for (const auto& nextHop : route.nexthops) {
+    nextHopsDigest += getNextHopDigest(nextHop);
+  }
+  return static_cast<int64_t>(combine(digest, nextHopsDigest));
+}
+
+folly::CIDRNetwork
+RouteFingerprints::getRange(const folly::CIDRNetwork& prefix) {
+  const auto rangeLen = getRangeLen(prefix.first);
+  return {prefix.first.mask(rangeLen), rangeLen};
+}
+
+bool
+RouteFingerprints::isAggregatable(const folly::CIDRNetwork& range) {
+  return range.second <= getRangeLen(range.first);
+}
+
+void
+RouteFingerprints::add(const RibUnicastEntry& route) {
+  applyRoute(route, 1);
+}
+
+void
+RouteFingerprints::remove(const RibUnicastEntry& route) {
+  // XOR is its own inverse
+  applyRoute(route, -1);
+}
+
+void
+RouteFingerprints::clear() {
+  ranges_.clear();
+}
+
+void
+RouteFingerprints::applyRoute(const RibUnicastEntry& route, int64_t numRoutes) {
+  const auto range = getRange(route.prefix);
+  auto& fingerprint = ranges_[range];
+  fingerprint.numRoutes += numRoutes;
+  fingerprint.digest ^= getRouteDigest(route);
+  if (fingerprint.numRoutes == 0) {
+    XLOG_IF(ERR, fingerprint.digest != 0)
+        << "Non-zero digest of empty range "
+        << folly::IPAddress::networkToString(range);
+    ranges_.erase(range);
+  }
+}
+
+std::vector<thrift::RouteFingerprint>
+RouteFingerprints::getFingerprints() const {
+  std::vector<thrift::RouteFingerprint> fingerprints;
+  fingerprints.reserve(ranges_.size());
+  for (const auto& [range, fingerprint] : ranges_) {
+    auto& tFingerprint = fingerprints.emplace_back();
+    tFingerprint.range_ref() = toIpPrefix(range);
+    tFingerprint.numRoutes_ref() = fingerprint.numRoutes;
+    tFingerprint.digest_ref() = fingerprint.digest;
+  }
+  return fingerprints;
+}
+
+thrift::RouteFingerprint
+RouteFingerprints::getFingerprint(const folly::CIDRNetwork& range) const {
+  CHECK(isAggregatable(range))
+      << folly::IPAddress::networkToString(range) << " is too long";
+  thrift::RouteFingerprint tFingerprint;
+  tFingerprint.range_ref() = toIpPrefix(range);
+  for (const auto& [subRange, fingerprint] : ranges_) {
+    if (subRange.first.family() == range.first.family() and
+        subRange.first.inSubnet(range.first, range.second)) {
+      *tFingerprint.numRoutes_ref() += fingerprint.numRoutes;
+      *tFingerprint.digest_ref() ^= fingerprint.digest;
+    }
+  }
+  return tFingerprint;
+}
+
+} // namespace openr
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include <folly/IPAddress.h>
+
+#include <openr/decision/RibEntry.h>
+#include <openr/if/gen-cpp2/OpenrCtrl_types.h>
+
+namespace openr {
+
+/**
+ * [Route Fingerprint] Digests of unicast routes per prefix range of
+ * `kRouteFingerprintRangeLenV4/V6` bits, kept up to date on every route
+ * change. A route falls into the range containing the network address of its
+ * prefix.
+ *
+ *  - route digest is a hash of its prefix and the forwarding attributes of
+ *    its next-hops, combined by addition, i.e. independent of next-hop order;
+ *  - range digest is the XOR of the digests of its routes;
+ *
+ * Hence digest of any range is the XOR of digests of the ranges, or routes,
+ * within it, so ranges can be compared top-down between nodes without
+ * dumping routes.
+ *
+ * NOTE: digests use FNV/128-to-64 mixing from folly so that nodes running on
+ * different platforms agree on them. Not thread-safe.
+ */
+class RouteFingerprints {
+ public:
+  // digest contribution of a single route
+  static int64_t getRouteDigest(const RibUnicastEntry& route);
+
+  // maintained range the prefix falls into
+  static folly::CIDRNetwork getRange(const folly::CIDRNetwork& prefix);
+
+  // whether `range` is no longer than maintained ranges of its family, i.e.
+  // its fingerprint can be aggregated out of them
+  static bool isAggregatable(const folly::CIDRNetwork& range);
+
+  /*
+   * Incremental maintenance. Callers MUST pass the exact route being
+   * removed, i.e. remove() must see the same route that add() saw.
+   */
+  void add(const RibUnicastEntry& route);
+  void remove(const RibUnicastEntry& route);
+
+  // reset to represent an empty route table
+  void clear();
+
+  // number of non-empty ranges
+  size_t
+  size() const {
+    return ranges_.size();
+  }
+
+  // fingerprints of all non-empty ranges
+  std::vector<thrift::RouteFingerprint> getFingerprints() const;
+
+  // fingerprint of an aggregatable `range`, see isAggregatable()
+  thrift::RouteFingerprint getFingerprint(
+      const folly::CIDRNetwork& range) const;
+
+ private:
+  struct Fingerprint {
+    int64_t numRoutes{0};
+    int64_t digest{0};
+  };
+
+  // XOR digest of `route` into its range, adjusting it by `numRoutes`
+  void applyRoute(const RibUnicastEntry& route, int64_t numRoutes);
+
+  std::map<folly::CIDRNetwork, Fingerprint> ranges_;
+};
+
+} // namespace openr
@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <openr/fib/RouteStreamClient.h>
+
+#if FOLLY_HAS_COROUTINES
+
+#include <fb303/ServiceData.h>
+#include <folly/experimental/coro/AsyncGenerator.h>
+#include <folly/experimental/coro/Collect.h>
+#include <folly/logging/xlog.h>
+#include <thrift/lib/cpp/TApplicationException.h>
+#include <thrift/lib/cpp2/async/RocketClientChannel.h>
+
+#include <openr/common/Constants.h>
+#include <openr/common/OpenrClient.h>
+
+namespace fb303 = facebook::fb303;
+
+namespace openr {
+
+RouteStreamClient::RouteStreamClient(
+    OpenrEventBase& evb, int32_t port, int16_t clientId)
+    : evb_(evb), port_(port), clientId_(clientId) {}
+
+RouteStreamClient::~RouteStreamClient() {
+  close();
+}
+
+folly::SemiFuture<folly::Unit>
+RouteStreamClient::program(const thrift::RouteDatabaseDelta& routeDbDelta) {
+  if (not session_) {
+    // Can throw, leaving no session behind
+    auto client = getOpenrCtrlPlainTextClient<
+        thrift::FibServiceCppAsyncClient,
+        apache::thrift::RocketClientChannel>(
+        *evb_.getEvb(),
+        folly::IPAddress(Constants::kPlatformHost),
+        port_,
+        Constants::kPlatformConnTimeout,
+        Constants::kPlatformRoutesProcTimeout);
+    session_ = std::make_shared<Session>();
+    session_->client = std::move(client);
+    evb_.addCoroTask(runSession(session_));
+    fb303::fbData->addStatValue(
+        "fib.route_streaming.sessions", 1, fb303::COUNT);
+  }
+
+  thrift::RouteOperationBatch batch;
+  const auto seqNum = session_->nextSeqNum++;
+  batch.seqNum_ref() = seqNum;
+  batch.unicastRoutesToUpdate_ref() = *routeDbDelta.unicastRoutesToUpdate_ref();
+  batch.unicastRoutesToDelete_ref() = *routeDbDelta.unicastRoutesToDelete_ref();
+  batch.mplsRoutesToUpdate_ref() = *routeDbDelta.mplsRoutesToUpdate_ref();
+  batch.mplsRoutesToDelete_ref() = *routeDbDelta.mplsRoutesToDelete_ref();
+
+  auto [promise, future] = folly::makePromiseContract<folly::Unit>();
+  session_->pendingAcks.emplace(seqNum, std::move(promise));
+  session_->batches.enqueue(std::move(batch));
+  return std::move(future).within(Constants::kPlatformRoutesProcTimeout);
+}
+
+void
+RouteStreamClient::close() {
+  if (not session_) {
+    return;
+  }
+  // Complete the sink and stop receiving acks. Pending batches are failed
+  // once the session coroutine returns.
+  session_->batches.enqueue(std::nullopt);
+  session_->cancellationSource.requestCancellation();
+  session_.reset();
+}
+
+folly::coro::Task<void>
+RouteStreamClient::runSession(std::shared_ptr<Session> session) {
+  const auto token = folly::CancellationToken::merge(
+      co_await folly::coro::co_current_cancellation_token,
+      session->cancellationSource.getToken());
+
+  folly::exception_wrapper ew;
+  try {
+    // Subscribe to acks before streaming any batch, so that none is missed
+    auto acks = co_await session->client->co_subscribeRouteAcks(clientId_);
+    auto sink = co_await session->client->co_programRoutes(clientId_);
+    XLOG(INFO) << "Opened route stream with FibService";
+
+    auto batches = [](std::shared_ptr<Session> session)
+        -> folly::coro::AsyncGenerator<thrift::RouteOperationBatch&&> {
+      while (auto batch = co_await session->batches.dequeue()) {
+        co_yield std::move(*batch);
+      }
+    };
+    auto receiveAcks =
+        [](std::shared_ptr<Session> session,
+           folly::coro::AsyncGenerator<thrift::RouteOperationAck&&> acks)
+        -> folly::coro::Task<void> {
+      while (auto ack = co_await acks.next()) {
+        processAck(*session, std::move(*ack));
+      }
+    };
+    co_await folly::coro::co_withCancellation(
+        token,
+        folly::coro::collectAll(
+            sink.sink(batches(session)),
+            receiveAcks(session, std::move(acks).toAsyncGenerator())));
+  } catch (const apache::thrift::TApplicationException& ex) {
+    if (ex.getType() ==
+        apache::thrift::TApplicationException::UNKNOWN_METHOD) {
+      XLOG(WARNING) << "FibService doesn't support route streaming";
+      supported_ = false;
+    }
+    ew = folly::exception_wrapper(std::current_exception(), ex);
+  } catch (const std::exception& ex) {
+    ew = folly::exception_wrapper(std::current_exception(), ex);
+  }
+
+  if (ew and not token.isCancellationRequested()) {
+    XLOG(ERR) << "Route stream with FibService failed: " << ew.what();
+    fb303::fbData->addStatValue(
+        "fib.route_streaming.failures", 1, fb303::COUNT);
+  }
+  if (not ew) {
+    ew = folly::make_exception_wrapper<std::runtime_error>(
+        "Route stream with FibService closed");
+  }
+  for (auto& [_, promise] : session->pendingAcks) {
+    promise.setException(ew);
+  }
+  session->pendingAcks.clear();
+
+  // Next batch opens a new session
+  if (session_ == session) {
+    session_.reset();
+  }
+}
+
+void
+RouteStreamClient::processAck(
+    Session& session, thrift::RouteOperationAck&& ack) {
+  auto it = session.pendingAcks.find(*ack.seqNum_ref());
+  if (it == session.pendingAcks.end()) {
+    XLOG(WARNING) << "Ignoring ack of unknown batch " << *ack.seqNum_ref();
+    return;
+  }
+  auto promise = std::move(it->second);
+  session.pendingAcks.erase(it);
+
+  if (auto error = ack.error_ref()) {
+    thrift::PlatformError platformError;
+    platformError.message_ref() = std::move(*error);
+    promise.setException(std::move(platformError));
+  } else if (
+      not ack.failedUnicastRoutes_ref()->empty() or
+      not ack.failedMplsRoutes_ref()->empty()) {
+    thrift::PlatformFibUpdateError fibUpdateError;
+    fibUpdateError.vrf2failedAddUpdatePrefixes_ref()->emplace(
+        0, std::move(*ack.failedUnicastRoutes_ref()));
+    fibUpdateError.failedAddUpdateMplsLabels_ref() =
+        std::move(*ack.failedMplsRoutes_ref());
+    promise.setException(std::move(fibUpdateError));
+  } else {
+    promise.setValue();
+  }
+}
+
+} // namespace openr
+
+#endif
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#if FOLLY_HAS_COROUTINES
+
+#include <map>
+#include <memory>
+#include <optional>
+
+#include <folly/CancellationToken.h>
+#include <folly/experimental/coro/Task.h>
+#include <folly/experimental/coro/UnboundedQueue.h>
+#include <folly/futures/Future.h>
+
+#include <openr/common/OpenrEventBase.h>
+#include <openr/if/gen-cpp2/FibServiceCppAsyncClient.h>
+
+namespace openr {
+
+/**
+ * [Route Streaming] Programs batches of route operations over one streaming
+ * session with FibServiceCpp, instead of a call per batch.
+ *
+ * Batches are streamed on the sink of programRoutes() and acked on the stream
+ * of subscribeRouteAcks(), so any number of batches can be in flight without
+ * waiting for one another. Sink credits bound the batches buffered by the
+ * agent. Agent programs batches in the order they are streamed.
+ *
+ * Session is opened on first use and closed on any error. Batches awaiting
+ * acks of a closed session fail and the next batch opens a new session.
+ *
+ * NOTE: Not thread-safe. MUST be used from the thread of `evb` only.
+ */
+class RouteStreamClient {
+ public:
+  RouteStreamClient(OpenrEventBase& evb, int32_t port, int16_t clientId);
+  ~RouteStreamClient();
+
+  RouteStreamClient(const RouteStreamClient&) = delete;
+  RouteStreamClient& operator=(const RouteStreamClient&) = delete;
+
+  /**
+   * Stream route operations of `routeDbDelta` as one batch. Returned future
+   * completes once the batch is acked, or fails with
+   *  - PlatformFibUpdateError listing routes failed to add/update, at VRF 0;
+   *  - PlatformError if agent failed the batch as a whole;
+   *  - any other error if stream failed or batch wasn't acked in time.
+   */
+  folly::SemiFuture<folly::Unit> program(
+      const thrift::RouteDatabaseDelta& routeDbDelta);
+
+  // False once agent turned out not to support streaming
+  bool
+  isSupported() const {
+    return supported_;
+  }
+
+  /**
+   * Close the current session, if any, failing batches awaiting acks.
+   */
+  void close();
+
+ private:
+  struct Session {
+    std::unique_ptr<thrift::FibServiceCppAsyncClient> client;
+    // Batches to stream. std::nullopt completes the sink.
+    folly::coro::UnboundedQueue<std::optional<thrift::RouteOperationBatch>>
+        batches;
+    // Batches awaiting ack by sequence number
+    std::map<int64_t, folly::Promise<folly::Unit>> pendingAcks;
+    folly::CancellationSource cancellationSource;
+    int64_t nextSeqNum{0};
+  };
+
+  // Stream batches & receive acks of `session` until it's closed or fails
+  folly::coro::Task<void> runSession(std::shared_ptr<Session> session);
+
+  // Fulfill promise of batch acked by `ack`
+  static void processAck(Session& session, thrift::RouteOperationAck&& ack);
+
+  OpenrEventBase& evb_;
+  const int32_t port_{0};
+  const int16_t clientId_{0};
+
+  std::shared_ptr<Session> session_;
+  bool supported_{true};
+};
+
+} // namespace openr
+
+#endif
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+
+#include <fb303/ServiceData.h>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <openr/common/Constants.h>
+#include <openr/fib/ConvergenceStats.h>
+
+using namespace openr;
+
+namespace fb303 = facebook::fb303;
+
+namespace {
+
+// Perf events of `descrs`, `stepMs` apart
+thrift::PerfEvents
+createPerfEvents(const std::vector<std::string>& descrs, int64_t stepMs) {
+  thrift::PerfEvents perfEvents;
+  int64_t ts{1000};
+  for (const auto& descr : descrs) {
+    thrift::PerfEvent event;
+    event.nodeName_ref() = "node1";
+    event.eventDescr_ref() = descr;
+    event.unixTs_ref() = ts;
+    perfEvents.events_ref()->emplace_back(std::move(event));
+    ts += stepMs;
+  }
+  return perfEvents;
+}
+
+const thrift::ConvergenceDistribution&
+findDistribution(
+    const std::vector<thrift::ConvergenceDistribution>& distributions,
+    thrift::ConvergenceType type,
+    const std::string& stage) {
+  auto it = std::find_if(
+      distributions.begin(), distributions.end(), [&](const auto& d) {
+        return *d.type_ref() == type and *d.stage_ref() == stage;
+      });
+  CHECK(it != distributions.end()) << stage;
+  return *it;
+}
+
+} // namespace
+
+TEST(ConvergenceStatsTest, ConvergenceType) {
+  EXPECT_EQ(
+      thrift::ConvergenceType::ADJACENCY,
+      ConvergenceStats::getConvergenceType(createPerfEvents(
+          {"ADJ_DB_UPDATED", "DECISION_RECEIVED", "FIB_ROUTE_DB_RECVD"}, 1)));
+  EXPECT_EQ(
+      thrift::ConvergenceType::PREFIX,
+      ConvergenceStats::getConvergenceType(
+          createPerfEvents({"DECISION_RECEIVED", "FIB_ROUTE_DB_RECVD"}, 1)));
+  EXPECT_EQ(
+      thrift::ConvergenceType::PREFIX,
+      ConvergenceStats::getConvergenceType(thrift::PerfEvents()));
+}
+
+TEST(ConvergenceStatsTest, Distributions) {
+  ConvergenceStats stats;
+  stats.addPerfEvents(thrift::PerfEvents());
+  EXPECT_TRUE(stats.getDistributions().empty());
+
+  // 100 adjacency changes, stages from 1ms to 100ms
+  for (int64_t i = 1; i <= 100; ++i) {
+    stats.addPerfEvents(createPerfEvents(
+        {"ADJ_DB_UPDATED",
+         "DECISION_RECEIVED",
+         "OPENR_FIB_ROUTES_PROGRAMMED"},
+        i));
+  }
+  stats.addPerfEvents(createPerfEvents(
+      {"DECISION_RECEIVED", "OPENR_FIB_ROUTES_PROGRAMMED"}, 20));
+
+  const auto distributions = stats.getDistributions();
+  // total and two stages for adjacency, total and one stage for prefix
+  EXPECT_EQ(5, distributions.size());
+
+  const auto& adjTotal = findDistribution(
+      distributions,
+      thrift::ConvergenceType::ADJACENCY,
+      ConvergenceStats::kTotalStage.str());
+  EXPECT_EQ(100, *adjTotal.count_ref());
+  EXPECT_EQ(100, *adjTotal.numSamples_ref());
+  EXPECT_EQ(100, *adjTotal.p50Ms_ref());
+  EXPECT_EQ(180, *adjTotal.p90Ms_ref());
+  EXPECT_EQ(198, *adjTotal.p99Ms_ref());
+  EXPECT_EQ(200, *adjTotal.maxMs_ref());
+
+  const auto& adjStage = findDistribution(
+      distributions,
+      thrift::ConvergenceType::ADJACENCY,
+      "OPENR_FIB_ROUTES_PROGRAMMED");
+  EXPECT_EQ(50, *adjStage.p50Ms_ref());
+  EXPECT_EQ(99, *adjStage.p99Ms_ref());
+
+  const auto& prefixTotal = findDistribution(
+      distributions,
+      thrift::ConvergenceType::PREFIX,
+      ConvergenceStats::kTotalStage.str());
+  EXPECT_EQ(1, *prefixTotal.count_ref());
+  EXPECT_EQ(20, *prefixTotal.p50Ms_ref());
+  EXPECT_EQ(20, *prefixTotal.maxMs_ref());
+
+  // exported as fb303 histograms
+  const auto counters = fb303::fbData->getCounters();
+  EXPECT_EQ(1, counters.count("fib.convergence.adj.total_ms.p99.60"));
+  EXPECT_EQ(
+      1,
+      counters.count(
+          "fib.convergence.prefix.OPENR_FIB_ROUTES_PROGRAMMED_ms.p50.60"));
+}
+
+TEST(ConvergenceStatsTest, BoundedSamples) {
+  ConvergenceStats stats;
+  const auto numEvents = Constants::kConvergenceStatsSamples + 10;
+  for (size_t i = 0; i < numEvents; ++i) {
+    // clock skewed events are recorded as zero
+    stats.addPerfEvents(
+        createPerfEvents({"ADJ_DB_UPDATED", "DECISION_RECEIVED"}, -1));
+  }
+  const auto distributions = stats.getDistributions();
+  const auto& total = findDistribution(
+      distributions,
+      thrift::ConvergenceType::ADJACENCY,
+      ConvergenceStats::kTotalStage.str());
+  EXPECT_EQ(numEvents, *total.count_ref());
+  EXPECT_EQ(Constants::kConvergenceStatsSamples, *total.numSamples_ref());
+  EXPECT_EQ(0, *total.maxMs_ref());
+}
+
+int
+main(int argc, char** argv) {
+  // Basic initialization
+  testing::InitGoogleTest(&argc, argv);
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = true;
+
+  // Run the tests
+  return RUN_ALL_TESTS();
+}
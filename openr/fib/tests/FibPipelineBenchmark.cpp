@@ -0,0 +1,334 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <fb303/ServiceData.h>
+#include <folly/Benchmark.h>
+#include <folly/init/Init.h>
+#include <thrift/lib/cpp2/server/ThriftServer.h>
+#include <thrift/lib/cpp2/util/ScopedServerThread.h>
+
+#include <openr/common/Util.h>
+#include <openr/config/Config.h>
+#include <openr/fib/Fib.h>
+#include <openr/messaging/ReplicateQueue.h>
+#include <openr/platform/NetlinkFibHandler.h>
+#include <openr/tests/mocks/MockNetlinkFibHandler.h>
+#include <openr/tests/mocks/MockNetlinkProtocolSocket.h>
+#include <openr/tests/mocks/PrefixGenerator.h>
+#include <openr/tests/utils/Utils.h>
+
+/**
+ * Defines a benchmark that allows users to record customized counter during
+ * benchmarking and passes parameters to it with a custom name.
+ */
+#define BENCHMARK_COUNTERS_NAME_PARAM(name, counters, param_name, ...) \
+  BENCHMARK_IMPL_COUNTERS(                                             \
+      FB_CONCATENATE(name, FB_CONCATENATE(_, param_name)),             \
+      FOLLY_PP_STRINGIZE(name) "(" FOLLY_PP_STRINGIZE(param_name) ")", \
+      counters,                                                        \
+      iters,                                                           \
+      unsigned,                                                        \
+      iters) {                                                         \
+    name(counters, iters, ##__VA_ARGS__);                              \
+  }
+
+namespace {
+// Virtual interface
+const std::string kVethNameY("vethTestY");
+// Prefix length of a subnet
+static const long kBitMaskLen = 128;
+
+// Number of nexthops
+const uint8_t kNumOfNexthops = 4;
+
+} // anonymous namespace
+
+namespace fb303 = facebook::fb303;
+
+namespace openr {
+
+using apache::thrift::ThriftServer;
+using apache::thrift::util::ScopedServerThread;
+
+/**
+ * FIB agent serving real Fib in the benchmark
+ */
+enum class FibAgent {
+  // MockNetlinkFibHandler programming routes in memory
+  MOCK,
+  // NetlinkFibHandler programming routes via MockNetlinkProtocolSocket
+  NETLINK,
+};
+
+/**
+ * Runs the whole Decision -> Fib -> FIB agent -> netlink pipeline with real
+ * Fib and mocked FIB agent or netlink socket, both with injectable faults.
+ */
+class FibPipelineWrapper {
+ public:
+  FibPipelineWrapper(FibAgent agent, int32_t chunkSize) {
+    // Register Singleton
+    folly::SingletonVault::singleton()->registrationComplete();
+
+    // Start ThriftServer serving FIB agent
+    server = std::make_shared<ThriftServer>();
+    server->setNumIOWorkerThreads(1);
+    server->setNumAcceptThreads(1);
+    server->setPort(0);
+    if (agent == FibAgent::NETLINK) {
+      // Mocked netlink socket is not thread-safe. Serialize requests to it.
+      server->setNumCPUWorkerThreads(1);
+      nlSock = std::make_unique<fbnl::MockNetlinkProtocolSocket>(&nlEvb);
+      nlSock->addLink(fbnl::utils::createLink(1, kVethNameY)).get();
+      netlinkFibHandler = std::make_shared<NetlinkFibHandler>(nlSock.get());
+      server->setInterface(netlinkFibHandler);
+    } else {
+      mockFibHandler = std::make_shared<MockNetlinkFibHandler>();
+      server->setInterface(mockFibHandler);
+    }
+    fibThriftThread.start(server);
+
+    auto tConfig = getBasicOpenrConfig(
+        "node-1",
+        {}, /* area config */
+        true, /* enableV4 */
+        false /*enableSegmentRouting*/,
+        false /*dryrun*/);
+    tConfig.fib_port_ref() = fibThriftThread.getAddress()->getPort();
+    tConfig.fib_config_ref()->route_programming_chunk_size_ref() = chunkSize;
+    config = std::make_shared<Config>(tConfig);
+
+    // Creat Fib module and start fib thread
+    fib = std::make_shared<Fib>(
+        config,
+        routeUpdatesQueue.getReader(),
+        fibRouteUpdatesQueue,
+        logSampleQueue);
+
+    fibThread = std::make_unique<std::thread>([this]() {
+      LOG(INFO) << "Fib thread starting";
+      fib->run();
+      LOG(INFO) << "Fib thread finishing";
+    });
+    fib->waitUntilRunning();
+  }
+
+  ~FibPipelineWrapper() {
+    LOG(INFO) << "Closing queues";
+    fibRouteUpdatesQueue.close();
+    routeUpdatesQueue.close();
+    logSampleQueue.close();
+
+    // This will be invoked before Fib's d-tor
+    fib->stop();
+    fibThread->join();
+
+    // Stop FIB agent
+    if (mockFibHandler) {
+      mockFibHandler->stop();
+    }
+    fibThriftThread.stop();
+    netlinkFibHandler.reset();
+    nlSock.reset();
+  }
+
+  // Inject latency to every programming request and error to every route
+  void
+  setFaults(std::chrono::microseconds latency, double errorRate) {
+    if (nlSock) {
+      nlSock->setRouteFaults(latency, errorRate);
+    } else {
+      mockFibHandler->setFaults(latency, errorRate);
+    }
+  }
+
+  // Number of route adds attempted by FIB agent so far, including failed ones
+  int64_t
+  getNumRouteAdds() {
+    if (nlSock) {
+      return fb303::fbData->getCounters()["nlmock.add_route.sum"];
+    }
+    return mockFibHandler->getAddRoutesCount() +
+        mockFibHandler->getInjectedErrorsCount();
+  }
+
+  std::shared_ptr<ThriftServer> server;
+  ScopedServerThread fibThriftThread;
+
+  messaging::ReplicateQueue<DecisionRouteUpdate> routeUpdatesQueue;
+  messaging::ReplicateQueue<DecisionRouteUpdate> fibRouteUpdatesQueue;
+  messaging::RQueue<DecisionRouteUpdate> fibRouteUpdatesQueueReader{
+      fibRouteUpdatesQueue.getReader()};
+  messaging::ReplicateQueue<LogSample> logSampleQueue;
+
+  std::shared_ptr<Config> config;
+  std::shared_ptr<Fib> fib;
+  std::unique_ptr<std::thread> fibThread;
+
+  std::shared_ptr<MockNetlinkFibHandler> mockFibHandler{nullptr};
+
+  folly::EventBase nlEvb;
+  std::unique_ptr<fbnl::MockNetlinkProtocolSocket> nlSock{nullptr};
+  std::shared_ptr<NetlinkFibHandler> netlinkFibHandler{nullptr};
+
+  PrefixGenerator prefixGenerator;
+};
+
+/**
+ * Benchmark for programming route updates end to end
+ * 1. Create a fib with FIB agent
+ * 2. Generate random IpV6s and routes
+ * 3. Inject faults into FIB agent
+ * 4. Send routes to fib
+ * 5. Wait until every route is reported programmed. Routes failed to program
+ *    are retried by Fib, which is counted as retry amplification.
+ *
+ * Counters
+ * - routes_per_sec: route programming throughput
+ * - time_to_last_route(ms): time until every route got programmed
+ * - retry_amplification(x100): route adds attempted per route, times 100
+ */
+static void
+BM_FibProgramming(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    FibAgent agent,
+    unsigned numOfRoutes,
+    unsigned chunkSize,
+    unsigned latencyUs,
+    unsigned errorPermille) {
+  auto suspender = folly::BenchmarkSuspender();
+  for (uint32_t i = 0; i < iters; i++) {
+    auto fibWrapper = std::make_unique<FibPipelineWrapper>(agent, chunkSize);
+
+    // Initial syncFib debounce
+    fibWrapper->routeUpdatesQueue.push(DecisionRouteUpdate());
+    fibWrapper->fibRouteUpdatesQueueReader.get().value();
+
+    // Generate random `numOfRoutes` prefixes
+    auto prefixes = fibWrapper->prefixGenerator.ipv6PrefixGenerator(
+        numOfRoutes, kBitMaskLen);
+    DecisionRouteUpdate routeUpdate;
+    for (auto& prefix : prefixes) {
+      auto nhs = fibWrapper->prefixGenerator.getRandomNextHopsUnicast(
+          kNumOfNexthops, kVethNameY);
+      auto nhsSet =
+          std::unordered_set<thrift::NextHopThrift>(nhs.begin(), nhs.end());
+      routeUpdate.unicastRoutesToUpdate.emplace(
+          toIPNetwork(prefix), RibUnicastEntry(toIPNetwork(prefix), nhsSet));
+    }
+
+    fibWrapper->setFaults(
+        std::chrono::microseconds(latencyUs), errorPermille / 1000.0);
+    const auto numRouteAddsBefore = fibWrapper->getNumRouteAdds();
+
+    suspender.dismiss(); // Start measuring benchmark time
+    const auto startTime = std::chrono::steady_clock::now();
+    fibWrapper->routeUpdatesQueue.push(std::move(routeUpdate));
+
+    // Programmed routes are published in chunks and retries. Failed ones are
+    // published as deleted until retried.
+    std::unordered_set<folly::CIDRNetwork> programmedPrefixes;
+    while (programmedPrefixes.size() < numOfRoutes) {
+      auto update = fibWrapper->fibRouteUpdatesQueueReader.get().value();
+      for (const auto& [prefix, _] : update.unicastRoutesToUpdate) {
+        programmedPrefixes.emplace(prefix);
+      }
+      for (const auto& prefix : update.unicastRoutesToDelete) {
+        programmedPrefixes.erase(prefix);
+      }
+    }
+    const auto elapsedMs = std::chrono::ceil<std::chrono::milliseconds>(
+                               std::chrono::steady_clock::now() - startTime)
+                               .count();
+    suspender.rehire(); // Stop measuring time again
+
+    const auto numRouteAdds =
+        fibWrapper->getNumRouteAdds() - numRouteAddsBefore;
+    counters["routes_per_sec"] = numOfRoutes * 1000 / std::max(elapsedMs, 1L);
+    counters["time_to_last_route(ms)"] = elapsedMs;
+    counters["retry_amplification(x100)"] = numRouteAdds * 100 / numOfRoutes;
+  }
+}
+
+/*
+ * @params counters: reserved counter for customized profile
+ * @params FibAgent: agent serving Fib
+ * @params first integer: num of routes
+ * @params second integer: route programming chunk size, 0 disables chunking
+ * @params third integer: latency of every programming request in usecs
+ * @params fourth integer: error rate of every route in permille
+ */
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_FibProgramming, counters, nl_10k, FibAgent::NETLINK, 10000, 0, 0, 0);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_FibProgramming, counters, nl_100k, FibAgent::NETLINK, 100000, 0, 0, 0);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_FibProgramming, counters, nl_1m, FibAgent::NETLINK, 1000000, 0, 0, 0);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_FibProgramming,
+    counters,
+    nl_100k_latency,
+    FibAgent::NETLINK,
+    100000,
+    0,
+    100,
+    0);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_FibProgramming,
+    counters,
+    nl_100k_chunk_latency,
+    FibAgent::NETLINK,
+    100000,
+    1000,
+    100,
+    0);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_FibProgramming,
+    counters,
+    nl_100k_chunk_latency_errors,
+    FibAgent::NETLINK,
+    100000,
+    1000,
+    100,
+    1);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_FibProgramming,
+    counters,
+    mock_100k_latency,
+    FibAgent::MOCK,
+    100000,
+    0,
+    1000,
+    0);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_FibProgramming,
+    counters,
+    mock_100k_chunk_latency,
+    FibAgent::MOCK,
+    100000,
+    1000,
+    1000,
+    0);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_FibProgramming,
+    counters,
+    mock_100k_chunk_latency_errors,
+    FibAgent::MOCK,
+    100000,
+    1000,
+    1000,
+    1);
+
+} // namespace openr
+
+int
+main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
@@ -315,8 +315,17 @@ checkEqualDecisionRouteUpdate(
 
 class FibTestFixture : public ::testing::Test {
  public:
-  explicit FibTestFixture(int32_t routeDeleteDelayMs = 1000)
-      : routeDeleteDelay_(routeDeleteDelayMs) {}
+  explicit FibTestFixture(
+      int32_t routeDeleteDelayMs = 1000,
+      int32_t routeChunkSize = 0,
+      bool enableFastReroute = false,
+      bool enableRouteStreaming = false,
+      bool enableMinimalDiffSync = false)
+      : routeDeleteDelay_(routeDeleteDelayMs),
+        routeChunkSize_(routeChunkSize),
+        enableFastReroute_(enableFastReroute),
+        enableRouteStreaming_(enableRouteStreaming),
+        enableMinimalDiffSync_(enableMinimalDiffSync) {}
   void
   SetUp() override {
     mockFibHandler_ = std::make_shared<MockNetlinkFibHandler>();
@@ -337,15 +346,27 @@ class FibTestFixture : public ::testing::Test {
         false /*orderedFibProgramming*/,
         false /*dryrun*/);
     tConfig.route_delete_delay_ms_ref() = routeDeleteDelay_;
+    tConfig.fib_config_ref()->route_programming_chunk_size_ref() =
+        routeChunkSize_;
+    tConfig.fib_config_ref()->enable_fast_reroute_ref() = enableFastReroute_;
+    tConfig.fib_config_ref()->enable_route_streaming_ref() =
+        enableRouteStreaming_;
+    tConfig.fib_config_ref()->enable_minimal_diff_sync_ref() =
+        enableMinimalDiffSync_;
     tConfig.fib_port_ref() = fibThriftThread.getAddress()->getPort();
 
     config_ = make_shared<Config>(tConfig);
 
+    std::optional<messaging::RQueue<InterfaceDatabase>> interfaceUpdatesReader;
+    if (enableFastReroute_) {
+      interfaceUpdatesReader = interfaceUpdatesQueue.getReader();
+    }
     fib_ = std::make_shared<Fib>(
         config_,
         routeUpdatesQueue.getReader(),
         fibRouteUpdatesQueue,
-        logSampleQueue);
+        logSampleQueue,
+        std::move(interfaceUpdatesReader));
 
     fibThread_ = std::make_unique<std::thread>([this]() {
       LOG(INFO) << "Fib thread starting";
@@ -383,6 +404,7 @@ class FibTestFixture : public ::testing::Test {
     fibRouteUpdatesQueue.close();
     routeUpdatesQueue.close();
     logSampleQueue.close();
+    interfaceUpdatesQueue.close();
 
     LOG(INFO) << "Stopping openr ctrl handler";
     handler_.reset();
@@ -527,6 +549,7 @@ class FibTestFixture : public ::testing::Test {
   messaging::ReplicateQueue<DecisionRouteUpdate> routeUpdatesQueue;
   messaging::ReplicateQueue<DecisionRouteUpdate> fibRouteUpdatesQueue;
   messaging::ReplicateQueue<openr::LogSample> logSampleQueue;
+  messaging::ReplicateQueue<InterfaceDatabase> interfaceUpdatesQueue;
   messaging::RQueue<DecisionRouteUpdate> fibRouteUpdatesQueueReader =
       fibRouteUpdatesQueue.getReader();
 
@@ -544,6 +567,10 @@ class FibTestFixture : public ::testing::Test {
 
  private:
   const int32_t routeDeleteDelay_{0};
+  const int32_t routeChunkSize_{0};
+  const bool enableFastReroute_{false};
+  const bool enableRouteStreaming_{false};
+  const bool enableMinimalDiffSync_{false};
 };
 
 // Fib single streaming client test.
@@ -1104,6 +1131,11 @@ TEST_F(FibTestFixture, getUnicastRoutesFilteredTest) {
   auto route3 = RibUnicastEntry(toIPNetwork(prefix3), {});
   auto route4 = RibUnicastEntry(toIPNetwork(prefix4), {});
 
+  const auto digest1 = RouteFingerprints::getRouteDigest(route1);
+  const auto digest2 = RouteFingerprints::getRouteDigest(route2);
+  const auto digest3 = RouteFingerprints::getRouteDigest(route3);
+  const auto digest4 = RouteFingerprints::getRouteDigest(route4);
+
   const auto& tRoute1 = route1.toThrift();
   const auto& tRoute2 = route2.toThrift();
   const auto& tRoute3 = route3.toThrift();
@@ -1174,6 +1206,66 @@ TEST_F(FibTestFixture, getUnicastRoutesFilteredTest) {
   const auto& notFoundResp =
       getUnicastRoutesFiltered(std::move(notFoundFilter));
   EXPECT_EQ(notFoundResp.size(), 0);
+
+  // bulk lookup of addresses, results in order of addresses
+  const std::vector<std::string> addrs{
+      "192.168.20.19", // match prefix1
+      "192.168.1.1", // match prefix2
+      "10.46.8.0", // no match
+      "fd00::48:2:0", // match prefix3
+      "fd00::48:2:3", // match prefix4
+  };
+  auto lookupAddrs = std::make_unique<std::vector<thrift::BinaryAddress>>();
+  for (const auto& addr : addrs) {
+    lookupAddrs->emplace_back(toBinaryAddress(folly::IPAddress(addr)));
+  }
+  const auto lookupResults =
+      handler_->semifuture_lookupRoutes(std::move(lookupAddrs)).get();
+  ASSERT_EQ(addrs.size(), lookupResults->size());
+  for (size_t i = 0; i < addrs.size(); ++i) {
+    EXPECT_EQ(
+        folly::IPAddress(addrs.at(i)),
+        toIPAddress(*lookupResults->at(i).address_ref()));
+  }
+  EXPECT_EQ(tRoute1, lookupResults->at(0).route_ref().value());
+  EXPECT_EQ(tRoute2, lookupResults->at(1).route_ref().value());
+  EXPECT_FALSE(lookupResults->at(2).route_ref().has_value());
+  EXPECT_EQ(tRoute3, lookupResults->at(3).route_ref().value());
+  EXPECT_EQ(tRoute4, lookupResults->at(4).route_ref().value());
+
+  // [Route Fingerprint] all routes fall into one maintained range per family
+  const auto allFingerprints =
+      handler_
+          ->semifuture_getUnicastRouteFingerprints(
+              std::make_unique<std::vector<thrift::IpPrefix>>())
+          .get();
+  ASSERT_EQ(2, allFingerprints->size());
+  EXPECT_EQ(
+      4,
+      *allFingerprints->at(0).numRoutes_ref() +
+          *allFingerprints->at(1).numRoutes_ref());
+
+  // aggregated and computed fingerprints of ranges, in order of ranges
+  const auto fingerprints =
+      handler_
+          ->semifuture_getUnicastRouteFingerprints(
+              std::make_unique<std::vector<thrift::IpPrefix>>(
+                  std::vector<thrift::IpPrefix>{
+                      toIpPrefix("fd00::/16"),
+                      toIpPrefix("192.168.0.0/16"),
+                      toIpPrefix("192.168.20.0/24"),
+                      toIpPrefix("10.0.0.0/8")}))
+          .get();
+  ASSERT_EQ(4, fingerprints->size());
+  EXPECT_EQ(toIpPrefix("fd00::/16"), *fingerprints->at(0).range_ref());
+  EXPECT_EQ(2, *fingerprints->at(0).numRoutes_ref());
+  EXPECT_EQ(digest3 ^ digest4, *fingerprints->at(0).digest_ref());
+  EXPECT_EQ(2, *fingerprints->at(1).numRoutes_ref());
+  EXPECT_EQ(digest1 ^ digest2, *fingerprints->at(1).digest_ref());
+  EXPECT_EQ(1, *fingerprints->at(2).numRoutes_ref());
+  EXPECT_EQ(digest1, *fingerprints->at(2).digest_ref());
+  EXPECT_EQ(0, *fingerprints->at(3).numRoutes_ref());
+  EXPECT_EQ(0, *fingerprints->at(3).digest_ref());
 }
 
 TEST_F(FibTestFixture, longestPrefixMatchTest) {
@@ -1840,6 +1932,387 @@ TEST_F(FibTestFixture, RouteProgrammingWithPersistentFailure) {
   }
 }
 
+/**
+ * Verify coalescing of route updates. Last update of a prefix/label wins and
+ * add followed by delete of a route unknown to FIB cancels out.
+ */
+TEST(FibCoalesceTest, CoalesceRouteUpdate) {
+  const std::unordered_set<folly::CIDRNetwork> knownPrefixes{
+      toIPNetwork(prefix2), toIPNetwork(prefix3)};
+  const auto isPrefixKnown = [&](const folly::CIDRNetwork& prefix) {
+    return knownPrefixes.count(prefix) > 0;
+  };
+  const auto isLabelKnown = [](int32_t) { return false; };
+
+  // P1 (unknown) and P2 (known) added, P3 deleted, L1 (unknown) added
+  DecisionRouteUpdate pending;
+  pending.addRouteToUpdate(RibUnicastEntry(toIPNetwork(prefix1), {path1_2_1}));
+  pending.addRouteToUpdate(RibUnicastEntry(toIPNetwork(prefix2), {path1_2_1}));
+  pending.unicastRoutesToDelete.emplace_back(toIPNetwork(prefix3));
+  pending.addMplsRouteToUpdate(RibMplsEntry(label1, {mpls_path1_2_1}));
+
+  // P1, P2 and L1 deleted, P3 and P4 added
+  DecisionRouteUpdate routeUpdate;
+  routeUpdate.unicastRoutesToDelete.emplace_back(toIPNetwork(prefix1));
+  routeUpdate.unicastRoutesToDelete.emplace_back(toIPNetwork(prefix2));
+  routeUpdate.addRouteToUpdate(
+      RibUnicastEntry(toIPNetwork(prefix3), {path1_2_2}));
+  routeUpdate.addRouteToUpdate(
+      RibUnicastEntry(toIPNetwork(prefix4), {path1_2_2}));
+  routeUpdate.mplsRoutesToDelete.emplace_back(label1);
+  routeUpdate.perfEvents = thrift::PerfEvents();
+
+  // Avoided ops: P1 add+delete (2), P2 add (1), P3 delete (1), L1 add+delete
+  // (2)
+  EXPECT_EQ(
+      6,
+      Fib::coalesceRouteUpdate(
+          pending, std::move(routeUpdate), isPrefixKnown, isLabelKnown));
+
+  EXPECT_EQ(2, pending.unicastRoutesToUpdate.size());
+  EXPECT_EQ(
+      RibUnicastEntry(toIPNetwork(prefix3), {path1_2_2}),
+      pending.unicastRoutesToUpdate.at(toIPNetwork(prefix3)));
+  EXPECT_EQ(1, pending.unicastRoutesToUpdate.count(toIPNetwork(prefix4)));
+  EXPECT_EQ(
+      std::vector<folly::CIDRNetwork>{toIPNetwork(prefix2)},
+      pending.unicastRoutesToDelete);
+  EXPECT_TRUE(pending.mplsRoutesToUpdate.empty());
+  EXPECT_TRUE(pending.mplsRoutesToDelete.empty());
+  EXPECT_TRUE(pending.perfEvents.has_value());
+}
+
+class FibChunkedProgrammingFixture : public FibTestFixture {
+ public:
+  FibChunkedProgrammingFixture()
+      : FibTestFixture(1000 /* routeDeleteDelayMs */, 2 /* routeChunkSize */) {}
+};
+
+/**
+ * Verify that unicast routes are programmed in chunks and that a failure
+ * marks only the failed routes of the chunk as dirty. Others get published
+ * as soon as their chunk is programmed.
+ */
+TEST_F(FibChunkedProgrammingFixture, ChunkedRouteProgramming) {
+  std::vector<thrift::UnicastRoute> routes;
+
+  //
+  // Initialize FIB to SYNCED state with empty route db
+  //
+  routeUpdatesQueue.push(DecisionRouteUpdate());
+  mockFibHandler_->waitForSyncFib();
+  EXPECT_TRUE(fibRouteUpdatesQueueReader.get()->empty());
+
+  //
+  // 1) Mark P1 as bad and add P1-P4. Two chunks of two routes get programmed
+  //
+  mockFibHandler_->setDirtyState({toIPNetwork(prefix1)}, {});
+  {
+    DecisionRouteUpdate routeUpdate;
+    for (auto const& prefix : {prefix1, prefix2, prefix3, prefix4}) {
+      routeUpdate.addRouteToUpdate(
+          RibUnicastEntry(toIPNetwork(prefix), {path1_2_1}));
+    }
+    routeUpdatesQueue.push(std::move(routeUpdate));
+
+    mockFibHandler_->waitForUpdateUnicastRoutes();
+    mockFibHandler_->waitForUpdateUnicastRoutes();
+    mockFibHandler_->getRouteTableByClient(routes, kFibId);
+    EXPECT_EQ(3, routes.size());
+
+    // Each chunk is published on its own. P1 is withdrawn.
+    std::unordered_set<folly::CIDRNetwork> updatedPrefixes;
+    std::unordered_set<folly::CIDRNetwork> deletedPrefixes;
+    for (int i = 0; i < 2; ++i) {
+      auto publication = fibRouteUpdatesQueueReader.get().value();
+      EXPECT_EQ(DecisionRouteUpdate::INCREMENTAL, publication.type);
+      EXPECT_GE(2, publication.unicastRoutesToUpdate.size());
+      for (auto const& [prefix, _] : publication.unicastRoutesToUpdate) {
+        updatedPrefixes.emplace(prefix);
+      }
+      deletedPrefixes.insert(
+          publication.unicastRoutesToDelete.begin(),
+          publication.unicastRoutesToDelete.end());
+    }
+    EXPECT_EQ(
+        std::unordered_set<folly::CIDRNetwork>(
+            {toIPNetwork(prefix2), toIPNetwork(prefix3), toIPNetwork(prefix4)}),
+        updatedPrefixes);
+    EXPECT_EQ(
+        std::unordered_set<folly::CIDRNetwork>({toIPNetwork(prefix1)}),
+        deletedPrefixes);
+  }
+
+  //
+  // 2) Clear bad state and see only P1 is retried and published
+  //
+  mockFibHandler_->setDirtyState({}, {});
+  while (true) {
+    auto publication = fibRouteUpdatesQueueReader.get().value();
+    EXPECT_GE(1, publication.size());
+    if (publication.unicastRoutesToUpdate.count(toIPNetwork(prefix1))) {
+      break;
+    }
+    EXPECT_EQ(toIPNetwork(prefix1), publication.unicastRoutesToDelete.at(0));
+  }
+  mockFibHandler_->getRouteTableByClient(routes, kFibId);
+  EXPECT_EQ(4, routes.size());
+}
+
+#if FOLLY_HAS_COROUTINES
+class FibRouteStreamingFixture : public FibTestFixture {
+ public:
+  FibRouteStreamingFixture()
+      : FibTestFixture(
+            1000 /* routeDeleteDelayMs */,
+            2 /* routeChunkSize */,
+            false /* enableFastReroute */,
+            true /* enableRouteStreaming */) {}
+};
+
+/**
+ * Verify that streamed chunks get programmed, acked and published same as
+ * chunks programmed with a call each, including per route failures.
+ */
+TEST_F(FibRouteStreamingFixture, StreamedRouteProgramming) {
+  std::vector<thrift::UnicastRoute> routes;
+
+  routeUpdatesQueue.push(DecisionRouteUpdate());
+  mockFibHandler_->waitForSyncFib();
+  EXPECT_TRUE(fibRouteUpdatesQueueReader.get()->empty());
+
+  //
+  // 1) Mark P1 as bad and add P1-P4. Both chunks are streamed and acked, P1
+  // is withdrawn.
+  //
+  mockFibHandler_->setDirtyState({toIPNetwork(prefix1)}, {});
+  {
+    DecisionRouteUpdate routeUpdate;
+    for (auto const& prefix : {prefix1, prefix2, prefix3, prefix4}) {
+      routeUpdate.addRouteToUpdate(
+          RibUnicastEntry(toIPNetwork(prefix), {path1_2_1}));
+    }
+    routeUpdatesQueue.push(std::move(routeUpdate));
+
+    std::unordered_set<folly::CIDRNetwork> updatedPrefixes;
+    std::unordered_set<folly::CIDRNetwork> deletedPrefixes;
+    for (int i = 0; i < 2; ++i) {
+      auto publication = fibRouteUpdatesQueueReader.get().value();
+      EXPECT_EQ(DecisionRouteUpdate::INCREMENTAL, publication.type);
+      for (auto const& [prefix, _] : publication.unicastRoutesToUpdate) {
+        updatedPrefixes.emplace(prefix);
+      }
+      deletedPrefixes.insert(
+          publication.unicastRoutesToDelete.begin(),
+          publication.unicastRoutesToDelete.end());
+    }
+    EXPECT_EQ(
+        std::unordered_set<folly::CIDRNetwork>(
+            {toIPNetwork(prefix2), toIPNetwork(prefix3), toIPNetwork(prefix4)}),
+        updatedPrefixes);
+    EXPECT_EQ(
+        std::unordered_set<folly::CIDRNetwork>({toIPNetwork(prefix1)}),
+        deletedPrefixes);
+    mockFibHandler_->getRouteTableByClient(routes, kFibId);
+    EXPECT_EQ(3, routes.size());
+  }
+
+  //
+  // 2) Clear bad state and see P1 is retried
+  //
+  mockFibHandler_->setDirtyState({}, {});
+  while (true) {
+    auto publication = fibRouteUpdatesQueueReader.get().value();
+    if (publication.unicastRoutesToUpdate.count(toIPNetwork(prefix1))) {
+      break;
+    }
+  }
+  mockFibHandler_->getRouteTableByClient(routes, kFibId);
+  EXPECT_EQ(4, routes.size());
+
+  //
+  // 3) Delete P2. Deletion chunk is streamed too.
+  //
+  {
+    DecisionRouteUpdate routeUpdate;
+    routeUpdate.unicastRoutesToDelete.emplace_back(toIPNetwork(prefix2));
+    routeUpdatesQueue.push(std::move(routeUpdate));
+    mockFibHandler_->waitForDeleteUnicastRoutes();
+  }
+  mockFibHandler_->getRouteTableByClient(routes, kFibId);
+  EXPECT_EQ(3, routes.size());
+}
+#endif
+
+class FibFastRerouteFixture : public FibTestFixture {
+ public:
+  FibFastRerouteFixture()
+      : FibTestFixture(
+            1000 /* routeDeleteDelayMs */,
+            0 /* routeChunkSize */,
+            true /* enableFastReroute */) {}
+};
+
+/**
+ * Verify that next-hops via a down interface are pruned from programmed
+ * routes right away unless none would be left, also from later updates of
+ * Decision, and restored once the interface is up again.
+ */
+TEST_F(FibFastRerouteFixture, PruneNexthopsOfDownInterface) {
+  std::vector<thrift::UnicastRoute> routes;
+  const std::unordered_set<thrift::NextHopThrift> ecmpNexthops{
+      path1_2_1, path1_2_2};
+
+  //
+  // Initialize FIB to SYNCED state with empty route db
+  //
+  routeUpdatesQueue.push(DecisionRouteUpdate());
+  mockFibHandler_->waitForSyncFib();
+  EXPECT_TRUE(fibRouteUpdatesQueueReader.get()->empty());
+
+  //
+  // 1) Add P1 via iface_1_2_1 and iface_1_2_2, and P2 via iface_1_2_1 only
+  //
+  {
+    DecisionRouteUpdate routeUpdate;
+    routeUpdate.addRouteToUpdate(
+        RibUnicastEntry(toIPNetwork(prefix1), ecmpNexthops));
+    routeUpdate.addRouteToUpdate(
+        RibUnicastEntry(toIPNetwork(prefix2), {path1_2_1}));
+    routeUpdatesQueue.push(std::move(routeUpdate));
+    mockFibHandler_->waitForUpdateUnicastRoutes();
+    EXPECT_EQ(2, fibRouteUpdatesQueueReader.get()->size());
+  }
+
+  //
+  // 2) iface_1_2_1 goes down. P1 is re-programmed via iface_1_2_2 while P2
+  //    is left as is
+  //
+  interfaceUpdatesQueue.push(InterfaceDatabase{
+      InterfaceInfo("iface_1_2_1", false, 1, {}),
+      InterfaceInfo("iface_1_2_2", true, 2, {})});
+  {
+    auto publication = fibRouteUpdatesQueueReader.get().value();
+    ASSERT_EQ(1, publication.unicastRoutesToUpdate.size());
+    EXPECT_EQ(
+        std::unordered_set<thrift::NextHopThrift>({path1_2_2}),
+        publication.unicastRoutesToUpdate.at(toIPNetwork(prefix1)).nexthops);
+  }
+  thrift::RouteDatabase expectedRouteDb;
+  expectedRouteDb.unicastRoutes_ref()->emplace_back(
+      createUnicastRoute(prefix1, {path1_2_2}));
+  expectedRouteDb.unicastRoutes_ref()->emplace_back(
+      createUnicastRoute(prefix2, {path1_2_1}));
+  mockFibHandler_->getRouteTableByClient(routes, kFibId);
+  thrift::RouteDatabase routeDb;
+  routeDb.unicastRoutes_ref() = routes;
+  EXPECT_TRUE(checkEqualRouteDatabaseUnicast(expectedRouteDb, routeDb));
+
+  // Routes from Decision are kept in Fib
+  EXPECT_EQ(2, getUnicastRoutes().size());
+
+  //
+  // 3) Decision adds P3 via both interfaces while iface_1_2_1 is down
+  //
+  {
+    DecisionRouteUpdate routeUpdate;
+    routeUpdate.addRouteToUpdate(
+        RibUnicastEntry(toIPNetwork(prefix3), ecmpNexthops));
+    routeUpdatesQueue.push(std::move(routeUpdate));
+    auto publication = fibRouteUpdatesQueueReader.get().value();
+    ASSERT_EQ(1, publication.unicastRoutesToUpdate.size());
+    EXPECT_EQ(
+        std::unordered_set<thrift::NextHopThrift>({path1_2_2}),
+        publication.unicastRoutesToUpdate.at(toIPNetwork(prefix3)).nexthops);
+  }
+
+  //
+  // 4) iface_1_2_1 comes up. Routes are restored to the ones from Decision
+  //
+  interfaceUpdatesQueue.push(InterfaceDatabase{
+      InterfaceInfo("iface_1_2_1", true, 1, {}),
+      InterfaceInfo("iface_1_2_2", true, 2, {})});
+  {
+    auto publication = fibRouteUpdatesQueueReader.get().value();
+    ASSERT_EQ(3, publication.unicastRoutesToUpdate.size());
+    EXPECT_EQ(
+        ecmpNexthops,
+        publication.unicastRoutesToUpdate.at(toIPNetwork(prefix1)).nexthops);
+    EXPECT_EQ(
+        ecmpNexthops,
+        publication.unicastRoutesToUpdate.at(toIPNetwork(prefix3)).nexthops);
+  }
+  mockFibHandler_->getRouteTableByClient(routes, kFibId);
+  EXPECT_EQ(3, routes.size());
+  for (const auto& route : routes) {
+    if (toIPNetwork(*route.dest_ref()) != toIPNetwork(prefix2)) {
+      EXPECT_EQ(2, route.nextHops_ref()->size());
+    }
+  }
+}
+
+class FibMinimalDiffSyncFixture : public FibTestFixture {
+ public:
+  FibMinimalDiffSyncFixture()
+      : FibTestFixture(
+            1000 /* routeDeleteDelayMs */,
+            0 /* routeChunkSize */,
+            false /* enableFastReroute */,
+            false /* enableRouteStreaming */,
+            true /* enableMinimalDiffSync */) {}
+};
+
+/**
+ * Verify that initial sync after restart, with routes left in FIB by the
+ * previous instance, programs only the routes which differ.
+ */
+TEST_F(FibMinimalDiffSyncFixture, SyncOnlyDifferingRoutes) {
+  std::vector<thrift::UnicastRoute> routes;
+
+  // Routes programmed before restart. P1 is unchanged, P2 changes next-hop
+  // and P3 is withdrawn while Open/R was down.
+  mockFibHandler_->addUnicastRoutes(
+      kFibId,
+      std::make_unique<std::vector<thrift::UnicastRoute>>(
+          std::vector<thrift::UnicastRoute>{
+              createUnicastRoute(prefix1, {path1_2_1}),
+              createUnicastRoute(prefix2, {path1_2_1}),
+              createUnicastRoute(prefix3, {path1_2_1})}));
+  mockFibHandler_->waitForUpdateUnicastRoutes();
+  ASSERT_EQ(3, mockFibHandler_->getAddRoutesCount());
+
+  // Decision converges with P1, P2 via new next-hop and new P4
+  DecisionRouteUpdate routeUpdate;
+  routeUpdate.addRouteToUpdate(
+      RibUnicastEntry(toIPNetwork(prefix1), {path1_2_1}));
+  routeUpdate.addRouteToUpdate(
+      RibUnicastEntry(toIPNetwork(prefix2), {path1_2_2}));
+  routeUpdate.addRouteToUpdate(
+      RibUnicastEntry(toIPNetwork(prefix4), {path1_2_1}));
+  routeUpdatesQueue.push(std::move(routeUpdate));
+
+  mockFibHandler_->waitForDeleteUnicastRoutes();
+  mockFibHandler_->waitForUpdateUnicastRoutes();
+  auto publication = fibRouteUpdatesQueueReader.get().value();
+  EXPECT_EQ(DecisionRouteUpdate::FULL_SYNC, publication.type);
+  EXPECT_EQ(3, publication.unicastRoutesToUpdate.size());
+
+  // Only P3 is deleted and P2, P4 are programmed. Route table isn't replaced.
+  EXPECT_EQ(0, mockFibHandler_->getFibSyncCount());
+  EXPECT_EQ(1, mockFibHandler_->getDelRoutesCount());
+  EXPECT_EQ(5, mockFibHandler_->getAddRoutesCount());
+  mockFibHandler_->getRouteTableByClient(routes, kFibId);
+  ASSERT_EQ(3, routes.size());
+  for (const auto& route : routes) {
+    EXPECT_NE(toIPNetwork(prefix3), toIPNetwork(*route.dest_ref()));
+    ASSERT_EQ(1, route.nextHops_ref()->size());
+    EXPECT_EQ(
+        toIPNetwork(*route.dest_ref()) == toIPNetwork(prefix2) ? "iface_1_2_2"
+                                                               : "iface_1_2_1",
+        *route.nextHops_ref()->at(0).address_ref()->ifName_ref());
+  }
+}
+
 int
 main(int argc, char* argv[]) {
   // Parse command line flags
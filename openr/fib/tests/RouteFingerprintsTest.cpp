@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <openr/common/LsdbUtil.h>
+#include <openr/common/NetworkUtil.h>
+#include <openr/fib/RouteFingerprints.h>
+
+using namespace openr;
+
+namespace {
+
+const auto kNextHop1 = createNextHop(
+    toBinaryAddress(folly::IPAddress("fe80::1")), "iface1", 10);
+const auto kNextHop2 = createNextHop(
+    toBinaryAddress(folly::IPAddress("fe80::2")), "iface2", 10);
+
+RibUnicastEntry
+createRoute(
+    const std::string& prefix,
+    std::unordered_set<thrift::NextHopThrift> nexthops = {kNextHop1}) {
+  return RibUnicastEntry(
+      folly::IPAddress::createNetwork(prefix), std::move(nexthops));
+}
+
+} // namespace
+
+TEST(RouteFingerprintsTest, RouteDigest) {
+  const auto route = createRoute("10.0.0.0/24", {kNextHop1, kNextHop2});
+  const auto digest = RouteFingerprints::getRouteDigest(route);
+
+  // independent of next-hop order and non-forwarding attributes
+  EXPECT_EQ(
+      digest,
+      RouteFingerprints::getRouteDigest(
+          createRoute("10.0.0.0/24", {kNextHop2, kNextHop1})));
+  auto nextHop = kNextHop1;
+  nextHop.metric_ref() = 20;
+  nextHop.area_ref() = "area2";
+  EXPECT_EQ(
+      digest,
+      RouteFingerprints::getRouteDigest(
+          createRoute("10.0.0.0/24", {nextHop, kNextHop2})));
+
+  // prefix and forwarding attributes are covered
+  EXPECT_NE(
+      digest,
+      RouteFingerprints::getRouteDigest(
+          createRoute("10.0.0.0/25", {kNextHop1, kNextHop2})));
+  EXPECT_NE(
+      digest,
+      RouteFingerprints::getRouteDigest(createRoute("10.0.0.0/24")));
+  nextHop = kNextHop1;
+  nextHop.weight_ref() = 2;
+  EXPECT_NE(
+      digest,
+      RouteFingerprints::getRouteDigest(
+          createRoute("10.0.0.0/24", {nextHop, kNextHop2})));
+  nextHop = kNextHop1;
+  nextHop.mplsAction_ref() = createMplsAction(
+      thrift::MplsActionCode::PUSH, std::nullopt, std::vector<int32_t>{100});
+  EXPECT_NE(
+      digest,
+      RouteFingerprints::getRouteDigest(
+          createRoute("10.0.0.0/24", {nextHop, kNextHop2})));
+}
+
+TEST(RouteFingerprintsTest, Range) {
+  EXPECT_EQ(
+      folly::IPAddress::createNetwork("10.1.0.0/16"),
+      RouteFingerprints::getRange(
+          folly::IPAddress::createNetwork("10.1.2.0/24")));
+  EXPECT_EQ(
+      folly::IPAddress::createNetwork("0.0.0.0/16"),
+      RouteFingerprints::getRange(
+          folly::IPAddress::createNetwork("0.0.0.0/0")));
+  EXPECT_EQ(
+      folly::IPAddress::createNetwork("fd00:1:2::/48"),
+      RouteFingerprints::getRange(
+          folly::IPAddress::createNetwork("fd00:1:2:3::/64")));
+
+  EXPECT_TRUE(RouteFingerprints::isAggregatable(
+      folly::IPAddress::createNetwork("10.0.0.0/16")));
+  EXPECT_FALSE(RouteFingerprints::isAggregatable(
+      folly::IPAddress::createNetwork("10.0.0.0/17")));
+  EXPECT_TRUE(RouteFingerprints::isAggregatable(
+      folly::IPAddress::createNetwork("fd00::/48")));
+  EXPECT_FALSE(RouteFingerprints::isAggregatable(
+      folly::IPAddress::createNetwork("fd00::/64")));
+}
+
+TEST(RouteFingerprintsTest, Maintenance) {
+  const auto route1 = createRoute("10.1.0.0/24");
+  const auto route2 = createRoute("10.1.1.0/24");
+  const auto route3 = createRoute("10.2.0.0/24");
+  const auto route4 = createRoute("fd00::/64");
+  const auto digest1 = RouteFingerprints::getRouteDigest(route1);
+  const auto digest2 = RouteFingerprints::getRouteDigest(route2);
+  const auto digest3 = RouteFingerprints::getRouteDigest(route3);
+
+  RouteFingerprints fingerprints;
+  fingerprints.add(route1);
+  fingerprints.add(route2);
+  fingerprints.add(route3);
+  fingerprints.add(route4);
+  EXPECT_EQ(3, fingerprints.size());
+  EXPECT_EQ(3, fingerprints.getFingerprints().size());
+
+  const auto range = fingerprints.getFingerprint(
+      folly::IPAddress::createNetwork("10.1.0.0/16"));
+  EXPECT_EQ(toIpPrefix("10.1.0.0/16"), *range.range_ref());
+  EXPECT_EQ(2, *range.numRoutes_ref());
+  EXPECT_EQ(digest1 ^ digest2, *range.digest_ref());
+
+  // aggregate of ranges within, other family excluded
+  const auto aggregate = fingerprints.getFingerprint(
+      folly::IPAddress::createNetwork("10.0.0.0/8"));
+  EXPECT_EQ(3, *aggregate.numRoutes_ref());
+  EXPECT_EQ(digest1 ^ digest2 ^ digest3, *aggregate.digest_ref());
+  EXPECT_EQ(
+      4,
+      *fingerprints.getFingerprint(folly::IPAddress::createNetwork("::/0"))
+              .numRoutes_ref() +
+          *fingerprints
+               .getFingerprint(folly::IPAddress::createNetwork("0.0.0.0/0"))
+               .numRoutes_ref());
+
+  // fingerprint is independent of the order of changes
+  RouteFingerprints otherFingerprints;
+  otherFingerprints.add(route4);
+  otherFingerprints.add(createRoute("10.1.0.0/24", {kNextHop2}));
+  otherFingerprints.add(route3);
+  otherFingerprints.add(route2);
+  otherFingerprints.remove(createRoute("10.1.0.0/24", {kNextHop2}));
+  otherFingerprints.add(route1);
+  EXPECT_EQ(
+      fingerprints.getFingerprints(), otherFingerprints.getFingerprints());
+
+  // empty ranges are dropped
+  fingerprints.remove(route1);
+  fingerprints.remove(route2);
+  EXPECT_EQ(2, fingerprints.size());
+  const auto emptyRange = fingerprints.getFingerprint(
+      folly::IPAddress::createNetwork("10.1.0.0/16"));
+  EXPECT_EQ(0, *emptyRange.numRoutes_ref());
+  EXPECT_EQ(0, *emptyRange.digest_ref());
+
+  fingerprints.clear();
+  EXPECT_EQ(0, fingerprints.size());
+  EXPECT_TRUE(fingerprints.getFingerprints().empty());
+}
+
+int
+main(int argc, char** argv) {
+  // Basic initialization
+  testing::InitGoogleTest(&argc, argv);
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = true;
+
+  // Run the tests
+  return RUN_ALL_TESTS();
+}
@@ -73,6 +73,19 @@ enum InitializationEvent {
    * ErrorCode: failures happen during initial KvStore sync process.
    */
   KVSTORE_SYNC_ERROR = 12,
+  /**
+   * [Startup phase] Configuration has been loaded and validated.
+   */
+  CONFIG_LOADED = 13,
+  /**
+   * [Startup phase] PersistentStore has loaded its database from disk.
+   */
+  PERSISTENT_STORE_LOADED = 14,
+  /**
+   * [Startup phase] All modules have been started, before thrift server
+   * starts serving.
+   */
+  MODULES_STARTED = 15,
 }
 
 exception KvStoreError {
@@ -148,6 +161,17 @@ struct DualPerRootCounters {
   8: i64 totalRecv = 0;
 }
 
+/**
+ * Local route computation counters for a given root
+ */
+struct DualPerRootComputationCounters {
+  1: i64 numPeerEventBatches = 0;
+  2: i64 numPeerEvents = 0;
+  3: i64 numComputations = 0;
+  4: i64 totalComputationTimeUs = 0;
+  5: i64 maxComputationTimeUs = 0;
+}
+
 /**
  * Map of neighbor-node to neighbor-counters
  */
@@ -168,8 +192,66 @@ typedef map<string, map<string, DualPerRootCounters>> (
 struct DualCounters {
   1: NeighborCounters neighborCounters;
   2: RootCounters rootCounters;
+  3: map<string, DualPerRootComputationCounters> rootComputationCounters;
 }
 
+/**
+ * Scheme used to generate `Value.hash`. Hash is computed once by the
+ * originator and carried along with the value, it is never re-computed on the
+ * flooding path. Peers advertise the scheme they support during full-sync and
+ * KvStore ONLY originates with a scheme supported by all of its peers in the
+ * area, so that re-originated values keep comparable hashes.
+ */
+enum KvStoreHashScheme {
+  /**
+   * boost::hash_combine over <version, originatorId, value>. Default and
+   * understood by all versions.
+   */
+  BOOST_HASH_COMBINE = 0,
+
+  /**
+   * 64-bit SpookyHashV2 over value, seeded with <version, originatorId>.
+   * Processes value in 8-byte words and is significantly cheaper for large
+   * values (e.g. prefix databases).
+   */
+  SPOOKY_V2 = 1,
+}
+
+/**
+ * [Value Delta]
+ *
+ * Replace `length` bytes at `offset` of the base value with `data`
+ */
+struct ValuePatchOp {
+  1: i32 offset;
+  2: i32 length;
+  3: binary data;
+} (cpp.minimize_padding)
+
+/**
+ * [Value Delta]
+ *
+ * Application data encoded as patch against the value of `baseVersion`,
+ * instead of being carried in full. Used in flooding ONLY.
+ */
+struct ValueDelta {
+  /**
+   * Version of the value patch ops apply to
+   */
+  1: i64 baseVersion;
+
+  /**
+   * Patch ops with ascending, non-overlapping offsets of the base value
+   */
+  2: list<ValuePatchOp> ops;
+
+  /**
+   * SpookyHashV2 of the resulting value. Receiver falls back to requesting
+   * full value on mismatch.
+   */
+  3: i64 valueHash;
+} (cpp.minimize_padding)
+
 /**
  * `V` of `KV` Store. It encompasses the data that needs to be synchronized
  * along with few attributes that helps ensure eventual consistency.
@@ -221,9 +303,16 @@ struct Value {
   /**
    * Hash associated with `tuple<version, originatorId, value>`. Clients
    * should leave it empty and as will be computed by KvStore on `KEY_SET`
-   * operation.
+   * operation. See `KvStoreHashScheme` for supported hash functions.
    */
   6: optional i64 hash;
+
+  /**
+   * Application data as delta to previous version, in place of `value`. Set
+   * ONLY towards peers advertising `Publication.valueDeltas`. Receiver
+   * restores `value` before merging.
+   */
+  7: optional ValueDelta delta;
 } (cpp.minimize_padding)
 
 /**
@@ -264,6 +353,22 @@ enum FilterOperator {
   AND = 2,
 }
 
+/**
+ * [Flood Digest]
+ *
+ * Bloom filter of <key, version, originatorId, ttlVersion> of key-vals
+ * recently merged by sender. Bit `i` is bit `i % 8` of byte `i / 8`.
+ */
+struct KvStoreFloodDigest {
+  1: i32 numHashes;
+  2: binary bits;
+} (cpp.minimize_padding)
+
+/**
+ * Serialized bytes shared without copy, e.g. across requests to all peers
+ */
+typedef binary (cpp.type = "folly::IOBuf") IOBuf
+
 /**
  * Request object for setting keys in KvStore.
  */
@@ -303,6 +408,22 @@ struct KeySetParams {
    * ID representing sender of the request.
    */
   8: optional string senderId;
+
+  /**
+   * Optional digest of key-vals sender has recently merged. Receiver skips
+   * flooding key-vals contained in it back to sender. Sent periodically with
+   * empty `keyVals`.
+   */
+  9: optional KvStoreFloodDigest floodDigest;
+
+  /**
+   * [Serialized Flood]
+   * Optional `KeySetParams` with ONLY `keyVals` set, serialized with compact
+   * protocol, in place of `keyVals`. Serialized once per flood and shared by
+   * requests to all peers. Set ONLY towards peers advertising
+   * `Publication.serializedKeyVals`.
+   */
+  10: optional IOBuf serializedKeyVals;
 } (cpp.minimize_padding)
 
 /**
@@ -366,6 +487,21 @@ struct KeyDumpParams {
    * ID representing sender of the request.
    */
   8: optional string senderId;
+
+  /**
+   * Optional attribute to include Merkle-tree leaf digests from peer. This is
+   * mutually exclusive with `keyValHashes`.
+   * 1) If root digest matches, respond with empty keyVals;
+   * 2) Otherwise, ONLY respond with keyVals falling into differing buckets;
+   * Bucket layout is indexed by bucket id, see KvStoreMerkleTree.
+   */
+  9: optional list<i64> keyValBucketDigests;
+
+  /**
+   * Highest hash scheme supported by requester. Responder replies with its own
+   * highest supported scheme in `Publication.hashScheme`.
+   */
+  10: optional KvStoreHashScheme hashScheme;
 } (cpp.minimize_padding)
 
 /**
@@ -574,6 +710,150 @@ struct Publication {
    * in milliseconds since epoch
    */
   8: optional i64 timestamp_ms;
+
+  /**
+   * Optional list of Merkle-tree bucket ids which differ between requester and
+   * responder. Set ONLY in response to full-sync request carrying
+   * `keyValBucketDigests`. Requester uses it to scope keys to send back.
+   */
+  9: optional list<i32> differingBuckets;
+
+  /**
+   * Optional attribute in full-sync response to indicate highest hash scheme
+   * supported by responder. Absent implies BOOST_HASH_COMBINE.
+   */
+  10: optional KvStoreHashScheme hashScheme;
+
+  /**
+   * Optional attribute in full-sync response to indicate responder accepts
+   * compact ttl-only key-vals, i.e. without `value` and `hash`, in flooding.
+   */
+  11: optional bool compactTtlUpdates;
+
+  /**
+   * Optional attribute in full-sync response to indicate responder is able to
+   * apply `Value.delta` in flooding. Implies `compactTtlUpdates`.
+   */
+  12: optional bool valueDeltas;
+
+  /**
+   * Optional sequence number of publication to local subscribers, increasing
+   * per area. Subscribers starting off a dump tagged with the sequence number
+   * it was taken at skip publications already reflected in the dump.
+   */
+  13: optional i64 seqNum;
+
+  /**
+   * Optional attribute in full-sync response to indicate responder accepts
+   * `KeySetParams.serializedKeyVals` in flooding.
+   */
+  14: optional bool serializedKeyVals;
+} (cpp.minimize_padding)
+
+/**
+ * Entry of publication capture, i.e. a publication or initialization event
+ * received by Decision from KvStore, along with the time it was received.
+ * Capture file is a sequence of entries, each serialized with
+ * CompactSerializer and prefixed by its length as 32-bit unsigned integer in
+ * network byte order.
+ */
+struct PublicationRecord {
+  /**
+   * System timestamp in microseconds since epoch when received
+   */
+  1: i64 timestampUs;
+
+  /**
+   * Either of publication or initialization event is set
+   */
+  2: optional Publication publication;
+  3: optional InitializationEvent initializationEvent;
+}
+
+/**
+ * Compression applied to a full-sync chunk on the wire
+ */
+enum KvStoreCompression {
+  NONE = 0,
+  ZSTD = 1,
+}
+
+/**
+ * Parameters of chunked full-sync request. A chunk covers a consecutive range
+ * `(cursor, chunkEnd]` of the ordered key space. Requester walks the key
+ * space by passing `chunkEnd` of previous response as `cursor` of the next
+ * request, until a response comes back without `chunkEnd`.
+ */
+struct KvStoreSyncChunkParams {
+  /**
+   * Max number of responder's keys covered by one chunk
+   */
+  1: i32 maxKeysPerChunk = 10000;
+
+  /**
+   * Exclusive lower bound of the chunk. Unset for the first chunk.
+   */
+  2: optional string cursor;
+
+  /**
+   * Inclusive upper bound of `KeyDumpParams.keyValHashes`, set if requester
+   * truncated its hashes to this chunk. Chunk never extends beyond it. Unset
+   * implies hashes cover all keys after `cursor`.
+   */
+  3: optional string hashesUpperBound;
+
+  /**
+   * Compression requested for the response. Responder falls back to NONE if
+   * the codec is not available.
+   */
+  4: KvStoreCompression compression = KvStoreCompression.NONE;
+} (cpp.minimize_padding)
+
+/**
+ * Response of chunked full-sync request
+ */
+struct KvStoreSyncChunk {
+  /**
+   * Full-sync response covering keys of this chunk. Left empty if
+   * `compressedPublication` is set.
+   */
+  1: Publication publication;
+
+  /**
+   * `publication` serialized with compact protocol and compressed with
+   * `compression`
+   */
+  2: optional binary compressedPublication;
+
+  3: KvStoreCompression compression = KvStoreCompression.NONE;
+
+  /**
+   * Inclusive upper bound of this chunk. Unset on the last chunk.
+   */
+  4: optional string chunkEnd;
+} (cpp.minimize_padding)
+
+/**
+ * [Warm Restart Snapshot]
+ *
+ * Key-vals of one area persisted on disk by KvStore, loaded on start to warm
+ * up its database before initial full-sync completes.
+ */
+struct KvStoreSnapshot {
+  /**
+   * Format version of snapshot. Snapshot of other version is ignored.
+   */
+  1: i32 version;
+
+  2: string area;
+
+  /**
+   * Unix timestamp in ms when snapshot was taken. Ttl of key-vals is relative
+   * to this time.
+   */
+  3: i64 timestamp_ms;
+
+  4: KeyVals keyVals;
 } (cpp.minimize_padding)
 
 /**
@@ -603,9 +883,53 @@ struct KvStoreAreaSummary {
   4: i32 keyValsBytes;
 } (cpp.minimize_padding)
 
+/**
+ * Memory and churn accounting of one key family, i.e. keys sharing the same
+ * leading part up to `:`, e.g. `adj` or `prefix`. Update and flood counts are
+ * cumulative, rates are derived by sampling them.
+ */
+struct KvStoreKeyFamilyStats {
+  /**
+   * # of key-vals of the family in KvStoreDb
+   */
+  1: i64 numKeys = 0;
+
+  /**
+   * Total size in bytes of key-vals of the family in KvStoreDb
+   */
+  2: i64 numBytes = 0;
+
+  /**
+   * # of key-val updates, including ttl updates, merged into KvStoreDb
+   */
+  3: i64 numUpdates = 0;
+
+  /**
+   * Total size in bytes of key-vals of the family flooded to peers
+   */
+  4: i64 numFloodBytes = 0;
+} (cpp.minimize_padding)
+
 struct KvStoreFloodRate {
   1: i32 flood_msg_per_sec;
   2: i32 flood_msg_burst_size;
+
+  /**
+   * Keys starting with any of these prefixes, along with TTL updates, are
+   * flooded in high priority class. Each class is rate limited and buffered on
+   * its own, so that bulk updates can not delay urgent ones. Default to
+   * adjacency keys if unset.
+   */
+  3: optional list<string> high_priority_key_prefixes;
+}
+
+/**
+ * Bounds of adaptive flood batching window, see KvstoreFloodBatch of
+ * OpenrConfig
+ */
+struct KvStoreFloodBatch {
+  1: i32 min_window_ms = 1;
+  2: i32 max_window_ms = 100;
 }
 
 /**
@@ -676,6 +1000,73 @@ struct KvStoreConfig {
    */
   10: optional i32 ip_tos;
 
+  /**
+   * Set this true to use Merkle-tree bucket digests for full-sync instead of
+   * flat per-key hash dumps. Falls back to flat hash comparison with peers
+   * which do not support it.
+   */
+  11: optional bool enable_merkle_sync;
+
+  /**
+   * Set this true to hash values with SPOOKY_V2 scheme. Only in effect when
+   * all peers in the area support it, otherwise BOOST_HASH_COMBINE is used.
+   */
+  12: optional bool enable_fast_value_hash;
+
+  /**
+   * Set this true to run KvStoreDb of every area on its own event base and
+   * thread, so that a busy area can not delay processing in other areas.
+   */
+  13: optional bool enable_area_event_bases;
+
+  /**
+   * Set this to split initial full-sync response into chunks of at most this
+   * many keys, instead of one monolithic publication. Falls back to single
+   * response with peers which do not support it.
+   */
+  14: optional i32 full_sync_chunk_size;
+
+  /**
+   * Set this true to request zstd compressed full-sync chunks from peers.
+   * Only in effect along with `full_sync_chunk_size`.
+   */
+  15: optional bool enable_full_sync_compression;
+
+  /**
+   * Set this to periodically write key-vals of every area into a snapshot
+   * under this directory and load it on start. Loaded keys stay unverified
+   * until reconciled with peers during initial full-sync.
+   */
+  16: optional string warm_restart_snapshot_dir;
+
+  /**
+   * Interval in seconds between two warm-restart snapshots
+   */
+  17: optional i32 warm_restart_snapshot_interval_s;
+
+  /**
+   * Set this true to flood changes of large values as delta to previous
+   * version towards peers supporting it
+   */
+  18: optional bool enable_value_delta;
+
+  /**
+   * Set this true to periodically advertise digest of recently merged
+   * key-vals to peers, so that they skip flooding duplicates
+   */
+  19: optional bool enable_flood_digest;
+
+  /**
+   * Set to merge updates arriving within peer round-trip time into one flood
+   */
+  20: optional KvStoreFloodBatch flood_batch;
+
+  /**
+   * Set this to merge key-vals of large publications into this many shards
+   * of every area concurrently
+   */
+  21: optional i32 num_key_shards;
+
   /**
   * [TO BE DEPRECATED]
   * Set buffering size for KvStore socket communication. Updates to neighbor node during
@@ -686,10 +1077,9 @@ struct KvStoreConfig {
   101: i32 zmq_hwm = 65536;
 
   /**
-   * [TO BE DEPRECATED]
-   * Temp var to enable dual msg exchange over thrift channel.
+   * Ignored, dual messages are always exchanged over thrift channel.
    */
-  200: bool enable_thrift_dual_msg = false;
+  200: bool enable_thrift_dual_msg = false (deprecated);
 } (cpp.minimize_padding)
 
 /**
@@ -778,6 +1168,17 @@ service KvStoreService extends fb303_core.BaseService {
 
   PeersMap getKvStorePeersArea(1: string area) throws (1: KvStoreError error);
 
+  /**
+   * Get one chunk of full-sync response. Same as
+   * `getKvStoreKeyValsFilteredArea` but ONLY covers keys in the range given
+   * by `chunkParams`, see KvStoreSyncChunkParams.
+   */
+  KvStoreSyncChunk getKvStoreSyncChunkArea(
+    1: KeyDumpParams filter,
+    2: string area,
+    3: KvStoreSyncChunkParams chunkParams,
+  ) throws (1: KvStoreError error);
+
   /**
    * Get KvStore Summary for each configured area (provided as the filter set).
    * The resp is a list of Summary structs, one for each area
@@ -785,4 +1186,11 @@ service KvStoreService extends fb303_core.BaseService {
   list<KvStoreAreaSummary> getKvStoreAreaSummary(
     1: set<string> selectAreas,
   ) throws (1: KvStoreError error);
+
+  /**
+   * Get memory and churn accounting of an area, keyed by key family
+   */
+  map<string, KvStoreKeyFamilyStats> getKvStoreKeyFamilyStatsArea(
+    1: string area,
+  ) throws (1: KvStoreError error);
 }
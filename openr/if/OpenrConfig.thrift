@@ -56,6 +56,23 @@ exception ConfigError {
 struct KvstoreFloodRate {
   1: i32 flood_msg_per_sec;
   2: i32 flood_msg_burst_size;
+
+  /**
+   * Key prefixes flooded ahead of bulk updates when rate limited, e.g.
+   * "adj:". TTL updates are always flooded in high priority class.
+   */
+  3: optional list<string> high_priority_key_prefixes;
+}
+
+/**
+ * Adaptive batching of flooded updates. Updates arriving faster than peers
+ * acknowledge floods, i.e. within one round-trip time, are merged by key and
+ * flooded together after a window sized from peer round-trip time, bounded by
+ * [min_window_ms, max_window_ms]. Sparse updates are flooded immediately.
+ */
+struct KvstoreFloodBatch {
+  1: i32 min_window_ms = 1;
+  2: i32 max_window_ms = 100;
 }
 
 struct KvstoreConfig {
@@ -106,6 +123,78 @@ struct KvstoreConfig {
    */
   9: optional bool is_flood_root;
 
+  /**
+   * Set this true to use Merkle-tree bucket digests for KvStore full-sync
+   * instead of flat per-key hash dumps. Sync request size becomes constant
+   * and responses only carry keys from differing buckets.
+   */
+  10: optional bool enable_merkle_sync;
+
+  /**
+   * Set this true to hash KvStore values with a faster 64-bit hash function.
+   * The new scheme is negotiated with peers during full-sync and ONLY used
+   * when every peer in the area supports it.
+   */
+  11: optional bool enable_fast_value_hash;
+
+  /**
+   * Set this true to run KvStore of every area on a dedicated thread. Flooding
+   * and full-sync of one area are then processed independently of others.
+   */
+  12: optional bool enable_area_event_bases;
+
+  /**
+   * Set this to receive initial full-sync from peers in chunks of at most this
+   * many keys. This bounds memory and thrift frame size for large areas.
+   */
+  13: optional i32 full_sync_chunk_size;
+
+  /**
+   * Set this true to compress full-sync chunks with zstd on the wire
+   */
+  14: optional bool enable_full_sync_compression;
+
+  /**
+   * Set this to periodically persist key-vals of every area into a snapshot
+   * file under this directory. On restart, KvStore is warmed up from the
+   * snapshot and then reconciled with peers.
+   */
+  15: optional string warm_restart_snapshot_dir;
+
+  /**
+   * Interval in seconds of persisting warm-restart snapshot. Only in effect
+   * along with `warm_restart_snapshot_dir`.
+   */
+  16: optional i32 warm_restart_snapshot_interval_s;
+
+  /**
+   * Set this true to flood changes of large values, e.g. adjacency database of
+   * nodes with many adjacencies, as delta to previous version. Peers which
+   * can not apply deltas keep receiving full values.
+   */
+  17: optional bool enable_value_delta;
+
+  /**
+   * Set this true to periodically advertise Bloom filter digest of recently
+   * merged key-vals to peers. Peers skip flooding key-vals contained in it,
+   * which cuts duplicate flooding on dense topologies. Has no effect with
+   * `enable_flood_optimization`.
+   */
+  18: optional bool enable_flood_digest;
+
+  /**
+   * Set to batch flooded updates under steady load, see KvstoreFloodBatch.
+   * Batched updates are still subject to `flood_rate` if set.
+   */
+  19: optional KvstoreFloodBatch flood_batch;
+
+  /**
+   * Set this to split key-vals of every area by key hash into this many
+   * shards. Key-vals of large publications, e.g. full-sync responses, are
+   * merged into shards concurrently, one thread per shard. Defaults to 1.
+   */
+  20: optional i32 num_key_shards;
+
   /**
   * Set buffering size for KvStore socket communication. Updates to neighbor node during
   * flooding can be buffered upto this number. For larger networks where burst of updates
@@ -115,9 +204,9 @@ struct KvstoreConfig {
   101: i32 zmq_hwm = 65536;
 
   /*
-   * Temp var to enable dual msg exchange over thrift channel.
+   * Ignored, dual messages are always exchanged over thrift channel.
    */
-  200: bool enable_thrift_dual_msg = false;
+  200: bool enable_thrift_dual_msg = false (deprecated);
 } (cpp.minimize_padding)
 
 /*
@@ -181,11 +270,88 @@ struct DecisionConfig {
   /** Decision time to save rib policy  in frequent setRibPolicy requests
   (in milliseconds). */
   4: i32 save_rib_policy_max_ms = 60000;
+  /** Knob to repair memoized SPF results upon topology change instead of
+  re-running full SPF. Only shortest paths affected by changed links or nodes
+  are recomputed. */
+  5: bool enable_incremental_spf = false;
+  /** Number of threads computing SPF of independent areas and KSP2 paths
+  towards independent nodes concurrently. 0 computes them sequentially on
+  Decision thread. */
+  6: i32 spf_num_threads = 0;
+  /** Knob to rebuild routes upon remote topology change only for prefixes
+  advertised by nodes whose distance, nexthops or overload changed, instead of
+  rebuilding all routes. Has no effect with UCMP or LFA enabled. */
+  7: bool enable_scoped_route_rebuild = false;
+  /** Number of threads deserializing adjacency and prefix databases of large
+  KvStore publications, e.g. of full-sync, concurrently. Values whose hash
+  matches the one last applied for the same key are skipped. 0 deserializes
+  them sequentially on Decision thread. */
+  8: i32 publication_decode_num_threads = 0;
+  /** Knob to adapt route rebuild debounce within [debounce_min_ms,
+  debounce_max_ms] to the observed rate of updates and cost of route rebuild.
+  Isolated updates are rebuilt after debounce_min_ms, while bursts of updates
+  are batched for longer. */
+  9: bool enable_adaptive_debounce = false;
+  /** Knob to compute loop-free alternate (LFA, RFC 5286) backup next-hops of
+  unicast routes forwarded by SP_ECMP over IP. Backup next-hops are exposed in
+  route details, and are not programmed. */
+  10: bool enable_lfa = false;
+  /** Routes of prefixes advertised with any of these tags, or listed in
+  priority_prefixes, e.g. loopbacks, are computed first upon full route rebuild
+  and sent to Fib in an earlier, separate route update. Not applied to the
+  initial route build. */
+  11: list<string> priority_prefix_tags = [];
+  12: list<string> priority_prefixes = [];
+  /** If set, every publication Decision receives from KvStore is appended to
+  this file along with the time it was received, for replay with
+  openr_decision_replay. Meant for reproducing convergence issues, the file
+  grows without bound. */
+  13: optional string publication_capture_file;
+  /** Knob to pick between full and incremental route rebuild of every batch
+  of updates by their estimated cost, out of the number of updated and
+  affected prefixes and nodes, instead of rebuilding incrementally whenever
+  possible. Choice and estimates are recorded in perf events of the route
+  update. Meant to be used along with enable_scoped_route_rebuild. */
+  14: bool enable_rebuild_cost_model = false;
 
   /** Knob to enable/disable BGP route programming. */
   101: bool enable_bgp_route_programming = true;
 }
 
+/**
+ * BGP style flap dampening of interfaces. Every transition of an interface to
+ * DOWN state adds penalty, which decays exponentially over time. Interface is
+ * suppressed, i.e. treated as DOWN, once penalty reaches suppress threshold
+ * and reused once it decays below reuse threshold.
+ */
+struct LinkFlapDampeningConfig {
+  /**
+   * Penalty added on every transition of interface to DOWN state
+   */
+  1: i32 penalty_per_flap = 1000;
+
+  /**
+   * Interface is suppressed once accumulated penalty reaches this value
+   */
+  2: i32 suppress_threshold = 2000;
+
+  /**
+   * Suppressed interface is reused once penalty decays below this value
+   */
+  3: i32 reuse_threshold = 750;
+
+  /**
+   * Time for penalty to decay to half
+   */
+  4: i32 half_life_ms = 900000;
+
+  /**
+   * Maximum time an interface can stay suppressed after its last flap. This
+   * caps the accumulated penalty.
+   */
+  5: i32 max_suppress_time_ms = 3600000;
+}
+
 struct LinkMonitorConfig {
   /**
    * When link goes down after being stable/up for long time, then the backoff
@@ -218,6 +384,39 @@ struct LinkMonitorConfig {
   * Enable convergence performance measurement for adjacency updates.
   */
   7: bool enable_perf_measurement = true;
+
+  /**
+   * Hysteresis of RTT metric. A change of RTT metric of an adjacency is only
+   * applied if it differs from the current metric by at least this percentage.
+   * Smaller changes are suppressed. 0 applies every change.
+   */
+  8: i32 rtt_metric_min_change_pct = 0;
+
+  /**
+   * Minimum time between two applied RTT metric changes of an adjacency. A
+   * change within dwell time is deferred until it expires.
+   */
+  9: i32 rtt_metric_dwell_time_ms = 0;
+
+  /**
+   * Weight, in percentage, of a new RTT measurement in the exponentially
+   * weighted moving average of RTT of an adjacency, which RTT metric is
+   * derived from. 100 disables smoothing.
+   */
+  10: i32 rtt_metric_ewma_weight_pct = 100;
+
+  /**
+   * Enable flap dampening of interfaces on top of exponential backoff. See
+   * LinkFlapDampeningConfig.
+   */
+  11: optional LinkFlapDampeningConfig linkflap_dampening_config;
+
+  /**
+   * Number of threads to serialize adjacency databases of all areas with
+   * concurrently when advertising them. 0 serializes them sequentially on
+   * LinkMonitor thread.
+   */
+  12: i32 adj_db_serialize_num_threads = 0;
 }
 
 struct StepDetectorConfig {
@@ -255,6 +454,32 @@ struct SparkConfig {
   6: i32 graceful_restart_time_s = 30;
 
   7: StepDetectorConfig step_detector_conf;
+
+  /**
+   * Fast failure detection. If set, interval of SparkHeartbeatMsg and hold
+   * time in milliseconds, overriding keepalive_time_s and hold_time_s resp.
+   * E.g. 20 and 80 detect link failure within 100ms. Both ends of adjacency
+   * shall be configured alike since the larger of hold times is used.
+   */
+  8: optional i32 keepalive_time_ms;
+  9: optional i32 hold_time_ms;
+
+  /**
+   * Number of Spark instances, each running on its own thread with its own
+   * socket, neighbors and timers. Interfaces are distributed among them by
+   * hash of interface name, so that a busy instance doesn't delay heartbeats
+   * of interfaces owned by others.
+   */
+  10: i32 num_shards = 1;
+
+  /**
+   * Adaptive keep-alive. If set, interval of SparkHeartbeatMsg on an
+   * interface is doubled after a stable period, along with the hold time
+   * advertised to neighbors, up to this value in milliseconds. It goes back to
+   * the configured keep-alive time on neighbor down, RTT change or graceful
+   * restart. Only applies if every neighbor on interface supports it.
+   */
+  11: optional i32 max_keepalive_time_ms;
 }
 
 struct WatchdogConfig {
@@ -269,6 +494,37 @@ struct WatchdogConfig {
    * useful to guarantee protocol doesn’t cause trouble to other services on
    * device where it runs and takes care of slow memory leak kind of issues. */
   3: i32 max_memory_mb = 800;
+  /**
+   * Soft memory thresholds, in percent of `max_memory_mb`, at which a jemalloc
+   * heap profile is dumped, e.g. [70, 85]. Every threshold dumps once as
+   * memory grows past it, and is re-armed once memory falls below it.
+   * Requires jemalloc with profiling enabled (`prof:true`).
+   */
+  4: list<i32> heap_profile_thresholds_pct = [];
+  /** Minimum interval between two threshold-triggered heap profile dumps. */
+  5: i32 heap_profile_min_interval_s = 600;
+  /**
+   * Heap profiles are dumped to `<heap_profile_prefix>.<seq>.heap`, only the
+   * latest `heap_profile_max_dumps` are kept.
+   */
+  6: string heap_profile_prefix = "/tmp/openr";
+  7: i32 heap_profile_max_dumps = 4;
+  /**
+   * Soft stall threshold, well below `thread_timeout_s`. Stack of a thread
+   * whose event loop doesn't run for longer is logged along with the task it
+   * runs, once per stall, and stalls are counted. 0 disables, else must be at
+   * least 200ms.
+   */
+  8: i32 stall_threshold_ms = 0;
+  /**
+   * [Memory Governor] Thresholds, in percent of `max_memory_mb`, of the stages
+   * of graceful degradation under memory pressure, in order: shrink caches,
+   * drop optional ctrl subscriptions, compact perf and event logs, reject
+   * full dump ctrl APIs. Every stage implies the previous ones and is left
+   * once memory falls 5% below its threshold. Fewer thresholds enable the
+   * first stages only, empty disables.
+   */
+  9: list<i32> memory_pressure_thresholds_pct = [];
 }
 
 struct MonitorConfig {
@@ -276,6 +532,117 @@ struct MonitorConfig {
   1: i32 max_event_log = 100;
   /** If set, will enable Monitor::processEventLog() to submit the event logs. */
   2: bool enable_event_log_submission = true;
+  /**
+   * If set, Monitor exports all counters every counter submit interval into
+   * POSIX shared-memory object of this name (e.g. "/openr_counters"), so that
+   * agents can read them without getCounters() RPC. See SharedCounters.h for
+   * the layout.
+   */
+  3: optional string shared_counters_name;
+  /** Max number of counters in the shared-memory region. */
+  4: i32 shared_counters_capacity = 16384;
+  /**
+   * Max number of event logs per second of each event type, e.g.
+   * {"NEIGHBOR_UP": 10}. Event logs over the limit are dropped. Event types
+   * not listed are not limited.
+   */
+  5: map<string, i32> event_log_rate_limits;
+  /**
+   * Interval of sampling process CPU and memory usage into `process.*`
+   * counters, and of refreshing counters in shared memory.
+   */
+  6: i32 process_counters_interval_s = 5;
+}
+
+struct FibConfig {
+  /**
+   * Max number of unicast routes sent to the FibService in a single add or
+   * delete call. Larger route updates are split into chunks which are
+   * programmed in a pipeline, and each chunk is published once programmed.
+   * Value of 0 disables chunking and programs every update in one call.
+   */
+  1: i32 route_programming_chunk_size = 0;
+  /**
+   * Max number of chunks outstanding with the FibService at any time. Only
+   * applicable if chunking is enabled.
+   */
+  2: i32 max_inflight_chunks = 4;
+  /**
+   * Merge route updates from Decision which are queued while FIB programming
+   * is in progress into one update before programming. Last update of a
+   * prefix or label wins, and add followed by delete cancels out.
+   */
+  3: bool enable_update_coalescing = false;
+  /**
+   * Sync only unicast routes of prefix ranges whose digests differ from the
+   * ones reported by FibService, instead of sending the whole route table.
+   * Falls back to full sync if FibService doesn't support it.
+   */
+  4: bool enable_differential_sync = false;
+  /**
+   * Number of prefix ranges (hash partitions) compared in differential sync.
+   */
+  5: i32 differential_sync_ranges = 1024;
+  /**
+   * Prune next-hops via interfaces reported down by LinkMonitor from the
+   * programmed routes right away, without waiting for Decision to recompute
+   * them. Routes whose next-hops would all be pruned are left as is.
+   */
+  6: bool enable_fast_reroute = false;
+  /**
+   * Stream route chunks to FibService and receive their acks asynchronously
+   * instead of a call per chunk. Requires chunking, see
+   * route_programming_chunk_size. Falls back to a call per chunk if
+   * FibService doesn't support streaming.
+   */
+  7: bool enable_route_streaming = false;
+  /**
+   * On full sync, fetch unicast routes programmed for Open/R with
+   * getRouteTableByClient and add, update or delete only the ones which
+   * differ, instead of replacing the route table. Combined with
+   * enable_differential_sync, routes are fetched only if some range differs
+   * and only routes of differing ranges are compared.
+   */
+  8: bool enable_minimal_diff_sync = false;
+}
+
+/**
+ * Scheduling policy of a module thread
+ */
+enum ThreadSchedulingPolicy {
+  // SCHED_OTHER, with `priority` as nice value (-20 to 19)
+  DEFAULT = 0,
+  // SCHED_FIFO real-time policy, with `priority` from 1 to 99
+  FIFO = 1,
+  // SCHED_RR real-time policy, with `priority` from 1 to 99
+  ROUND_ROBIN = 2,
+}
+
+/**
+ * CPU affinity and scheduling of a module thread. Real-time policies need
+ * CAP_SYS_NICE; the thread keeps default scheduling if they can't be applied.
+ */
+struct ThreadSchedulingConfig {
+  /** CPUs the thread runs on. Empty keeps the inherited affinity. */
+  1: list<i32> cpus;
+  2: ThreadSchedulingPolicy policy = ThreadSchedulingPolicy.DEFAULT;
+  3: i32 priority = 0;
+  /**
+   * Reserve `cpus` to this thread: module threads without `cpus` of their
+   * own don't run on them.
+   */
+  4: bool isolate = false;
+}
+
+/**
+ * [Memory Arenas] jemalloc arena of a module thread.
+ */
+struct MemoryArenaConfig {
+  /**
+   * Advise the kernel to back the arena by transparent huge pages, for
+   * threads walking large tables, e.g. kvstore, decision and fib.
+   */
+  1: bool huge_pages = false;
 }
 
 struct MemoryProfilingConfig {
@@ -334,6 +701,17 @@ struct ThriftServerConfig {
   11: optional bool enable_non_default_vrf_thrift_server;
   /** Timeout (2 seconds by default) of Cpp2Worker join in Thrift server */
   12: i32 workers_join_timeout = 2;
+  /** Number of IO threads accepting and parsing requests of ctrl server */
+  13: i32 num_io_worker_threads = 1;
+  /**
+   * Number of threads serving requests of KvStore peers, e.g. flooding and
+   * full sync. Peers send their requests in HIGH priority, which are queued
+   * separately from the rest, so that peer sync isn't held back by heavy
+   * operator or monitoring requests.
+   */
+  14: i32 num_peer_sync_threads = 1;
+  /** Number of threads serving all other requests, e.g. breeze, monitoring */
+  15: i32 num_ctrl_threads = 1;
 }
 
 struct ThriftClientConfig {
@@ -914,6 +1292,81 @@ struct OpenrConfig {
    */
   61: bool enable_ucmp = false;
 
+  /**
+   * Program unicast routes with Linux nexthop objects (kernel 5.3+) when
+   * netlink FIB handler is enabled. Routes sharing the same nexthops share a
+   * refcounted nexthop group and a nexthop change is applied by updating the
+   * group instead of replacing every route.
+   */
+  62: bool enable_netlink_nexthop_objects = false;
+
+  /** Fib route programming config. */
+  63: FibConfig fib_config;
+
+  /**
+   * Coalesce link, address and neighbor events received from netlink within
+   * this window. Only the latest event of every link, address and neighbor is
+   * published to LinkMonitor and Fib handler. 0 disables coalescing.
+   */
+  64: i32 netlink_event_coalescing_ms = 0;
+
+  /**
+   * Number of KvStore keys prefixes of this node are hashed into per area.
+   * A change of prefix re-floods its shard key only, instead of one key per
+   * prefix or one key of all prefixes. 0 advertises one key per prefix.
+   * Decision computes routes from both encodings.
+   */
+  65: i32 prefix_key_shards = 0;
+
+  /**
+   * Adapt the window PrefixManager batches prefix changes for before syncing
+   * them to KvStore, up to this many milliseconds. The window grows with the
+   * rate of prefix changes and the number of changes pending, and shrinks
+   * back to a millisecond once changes stop. 0 keeps the fixed 100ms window.
+   */
+  66: i32 prefix_sync_max_throttle_ms = 0;
+
+  /**
+   * CPU affinity, scheduling and isolation of module threads, keyed by thread
+   * name: watchdog, netlink, config_store, monitor, kvstore, prefix_manager,
+   * prefix_allocator, spark (spark_<N> for extra shards), link_monitor,
+   * vipRouteManager, decision, fib and ctrl_evb. Spark shards use `spark`
+   * entry unless they have their own, and default to ROUND_ROBIN policy with
+   * priority 1, so that heartbeats aren't delayed by bursts of other modules.
+   */
+  67: map<string, ThreadSchedulingConfig> thread_scheduling;
+
+  /**
+   * Number of threads PrefixManager evaluates area and origination policies
+   * of large batches of prefixes with, e.g. upon full sync. Results are
+   * applied in order on PrefixManager thread. 0 evaluates them sequentially
+   * on PrefixManager thread.
+   */
+  68: i32 policy_num_threads = 0;
+
+  /**
+   * Compress objects written to `persistent_config_store_path` with zstd,
+   * every group commit (and snapshot) as one block. Files of either format
+   * are readable regardless of this knob.
+   */
+  69: bool enable_persistent_store_compression = false;
+
+  /**
+   * Dedicated jemalloc arenas of module threads, keyed by thread name as in
+   * `thread_scheduling`. Allocations of these threads, e.g. KvStore keys,
+   * PrefixState and route databases, are packed into their own arena instead
+   * of interleaving with allocations of other modules.
+   */
+  70: map<string, MemoryArenaConfig> memory_arenas;
+
+  /**
+   * Read netlink sockets with io_uring (kernel 6.0+) instead of `recvmmsg`.
+   * Kernel reads replies and events into buffers provided upfront, with one
+   * multishot receive armed per socket. Falls back to `recvmmsg` on older
+   * kernels.
+   */
+  71: bool enable_netlink_io_uring = false;
+
   # vip thrift injection service
   90: optional bool enable_vip_service;
   91: optional vip_service_config.VipServiceConfig vip_service_config;
@@ -78,6 +78,14 @@ struct StreamSubscriberInfo {
   3: i64 last_msg_sent_time;
   // Total number of messages streamed
   4: i64 total_streamed_msgs;
+  // Number of messages pending to be streamed to the subscriber lagging behind
+  5: i64 pending_msgs;
+  // Total number of messages conflated with other pending messages
+  6: i64 conflated_msgs;
+  // Total number of messages dropped and resynced from a fresh snapshot
+  7: i64 dropped_msgs;
+  // Total number of resyncs
+  8: i64 resyncs;
 }
 
 //
@@ -208,6 +216,11 @@ struct RibPolicy {
 struct UnicastRouteDetail {
   1: Network.UnicastRoute unicastRoute (cpp.mixin);
   2: optional Types.PrefixEntry bestRoute;
+  /**
+   * Loop-free alternate next-hops computed by Decision with LFA enabled. They
+   * protect against failure of the links to primary next-hops.
+   */
+  3: list<Network.NextHopThrift> backupNextHops;
 }
 
 /*
@@ -239,6 +252,161 @@ struct RouteDatabaseDeltaDetail {
   4: list<i32> mplsRoutesToDelete;
 }
 
+//
+// Paginated dump data structures
+//
+
+/**
+ * [Paginated Dump]
+ *
+ * Large tables are dumped in pages of entries ordered by key. Client passes
+ * `continuationToken` and `snapshotVersion` of a page to get the next one,
+ * until a page comes back without `continuationToken`. Every entry present
+ * throughout the dump is returned exactly once, whatever changes meanwhile.
+ * Pages are consistent with each other as long as `snapshotVersion` doesn't
+ * change, clients requiring a consistent dump start over otherwise.
+ */
+struct PageParams {
+  /** Max number of keys covered by a page */
+  1: i32 pageSize = 1000;
+  /** Opaque token of the previous page. Unset for the first page. */
+  2: optional string continuationToken;
+  /** `snapshotVersion` of the previous page. Unset for the first page. */
+  3: optional i64 snapshotVersion;
+}
+
+struct PageInfo {
+  /**
+   * Version of the snapshot page is served from. Unset if table is not
+   * versioned, i.e. pages are consistent per entry only.
+   */
+  1: optional i64 snapshotVersion;
+  /** Token of the next page. Unset on the last page. */
+  2: optional string continuationToken;
+}
+
+struct UnicastRoutesPage {
+  1: list<Network.UnicastRoute> routes;
+  2: PageInfo pageInfo;
+}
+
+/**
+ * [Route Lookup] Unicast route forwarding an address, by longest prefix match.
+ * Route is not set if no route contains the address.
+ */
+struct RouteLookupResult {
+  1: Network.BinaryAddress address;
+  2: optional Network.UnicastRoute route;
+}
+
+/**
+ * [Route Fingerprint] Order independent digest of unicast routes of FIB module
+ * within a prefix range. A route belongs to every range containing the network
+ * address of its prefix. Digest covers prefix and forwarding attributes of
+ * next-hops, i.e. address, interface, weight and MPLS action. Nodes, or a
+ * node and its expected routes, agree on a range iff digests are equal, with
+ * high probability.
+ */
+struct RouteFingerprint {
+  1: Network.IpPrefix range;
+  2: i64 numRoutes;
+  3: i64 digest;
+}
+
+struct ReceivedRoutesPage {
+  1: list<ReceivedRouteDetail> routes;
+  2: PageInfo pageInfo;
+}
+
+struct AdjacenciesPage {
+  1: list<Types.AdjacencyDatabase> adjacencyDbs;
+  2: PageInfo pageInfo;
+}
+
+struct KvStoreKeyValsPage {
+  1: KvStore.Publication publication;
+  2: PageInfo pageInfo;
+}
+
+//
+// Encoded stream data structures
+//
+
+/**
+ * [Encoded Stream]
+ *
+ * Optional encoding of Fib and KvStore streams for collectors behind
+ * bandwidth constrained links, negotiated per subscription. Stream carries
+ * EncodedStreamMessage, whose `data` is a compact serialized payload, i.e.
+ * FibDetailStreamBatch or KvStore.Publication. With ZSTD, payloads of a
+ * stream are compressed by a single zstd stream, flushed at every message.
+ * The compression window acts as a dictionary learned on the previous
+ * messages of the stream: messages have to be decompressed in order by a
+ * single zstd stream on client side.
+ */
+enum StreamCompression {
+  NONE = 0,
+  ZSTD = 1,
+}
+
+struct StreamEncodingParams {
+  1: StreamCompression compression = StreamCompression.ZSTD;
+  /** Replace next-hops of Fib routes with ids of interned next-hop groups */
+  2: bool internNextHops = true;
+  /** Max number of Fib deltas merged into a single message */
+  3: i32 maxBatchSize = 64;
+}
+
+struct EncodedStreamMessage {
+  /** Position of the message in stream, starting from 0 */
+  1: i64 seqNum;
+  2: StreamCompression compression;
+  /** Size of the serialized payload */
+  3: i64 uncompressedSize;
+  4: binary data;
+}
+
+/**
+ * Payload of encoded Fib detail stream. With interned next-hops, next-hops of
+ * routes to update (unicast ones first, then MPLS ones, in order of deltas)
+ * are left empty and replaced by ids of `nextHopGroupIds`. Groups are sent
+ * once, along with the first message referring to them, and are valid until
+ * a message resets them.
+ */
+struct FibDetailStreamBatch {
+  1: list<RouteDatabaseDeltaDetail> deltas;
+  2: list<i64> nextHopGroupIds;
+  3: map<i64, list<Network.NextHopThrift>> newNextHopGroups;
+  /** Drop all groups known so far before adding `newNextHopGroups` */
+  4: bool resetNextHopGroups = false;
+}
+
+//
+// Ctrl API stats data structures
+//
+
+/**
+ * [Ctrl Stats] Stats of a ctrl API method. Counts cover the lifetime of the
+ * process, latencies the last one to two minutes. Latency of a call is split
+ * into time queued for a worker thread, time spent by handler and modules,
+ * and (de)serialization time.
+ */
+struct CtrlApiStats {
+  1: i64 calls;
+  /** Calls failed with an exception */
+  2: i64 errors;
+  /** Bytes of serialized responses */
+  3: i64 bytesOut;
+  4: i64 queueTimeP50Us;
+  5: i64 queueTimeP99Us;
+  6: i64 moduleTimeP50Us;
+  7: i64 moduleTimeP99Us;
+  8: i64 serializationTimeP50Us;
+  9: i64 serializationTimeP99Us;
+  10: i64 totalTimeP50Us;
+  11: i64 totalTimeP99Us;
+}
+
 /**
  * Thrift service - exposes RPC APIs for interaction with all of Open/R's
  * modules.
@@ -268,6 +436,17 @@ service OpenrCtrl extends KvStore.KvStoreService {
    */
   string dryrunConfig(1: string file) throws (1: OpenrError error);
 
+  /**
+   * Load file config, validate it and apply the changes to running modules
+   * without restart. Throws exception upon error, or if a changed field can
+   * only be applied by restart, in which case nothing is applied.
+   * Return - names of the changed top level config fields.
+   *
+   * Hot reloadable fields:
+   * - originated_prefixes
+   */
+  list<string> reloadConfig(1: string file) throws (1: OpenrError error);
+
   //
   // OpenR initialization APIs
   //
@@ -381,6 +560,16 @@ service OpenrCtrl extends KvStore.KvStoreService {
     1: ReceivedRouteFilter filter,
   ) throws (1: OpenrError error);
 
+  /**
+   * Page of getReceivedRoutesFiltered(). Page covers `pageSize` prefixes,
+   * prefixes without any route passing the filter are left out. See
+   * [Paginated Dump]
+   */
+  ReceivedRoutesPage getReceivedRoutesPage(
+    1: ReceivedRouteFilter filter,
+    2: PageParams pageParams,
+  ) throws (1: OpenrError error);
+
   /**
    * Get route database of the current node. It is retrieved from FIB module.
    */
@@ -421,6 +610,34 @@ service OpenrCtrl extends KvStore.KvStoreService {
    */
   list<Network.UnicastRoute> getUnicastRoutes() throws (1: OpenrError error);
 
+  /**
+   * Page of getUnicastRoutes(), served out of route snapshot of FIB module.
+   * See [Paginated Dump]
+   */
+  UnicastRoutesPage getUnicastRoutesPage(1: PageParams pageParams) throws (
+    1: OpenrError error,
+  );
+
+  /**
+   * Resolve every address into the unicast route forwarding it, by longest
+   * prefix match against routes of FIB module. Results are in order of
+   * addresses. See [Route Lookup]
+   */
+  list<RouteLookupResult> lookupRoutes(
+    1: list<Network.BinaryAddress> addresses,
+  ) throws (1: OpenrError error);
+
+  /**
+   * Get fingerprints of unicast routes of FIB module within `ranges`, in
+   * order. Without ranges, return fingerprints of all non-empty ranges of
+   * `kRouteFingerprintRangeLenV4/V6` bits, maintained incrementally on route
+   * updates. Mismatching ranges can be narrowed down by querying their
+   * sub-ranges. See [Route Fingerprint]
+   */
+  list<RouteFingerprint> getUnicastRouteFingerprints(
+    1: list<Network.IpPrefix> ranges,
+  ) throws (1: OpenrError error);
+
   /**
    * Get Mpls routes after applying a list of prefix filter.
    * Return all Mpls routes if the input list is empty.
@@ -452,6 +669,19 @@ service OpenrCtrl extends KvStore.KvStoreService {
 
   Types.PerfDatabase getPerfDb() throws (1: OpenrError error);
 
+  /**
+   * Get distributions of route convergence durations, end-to-end and per
+   * stage, for adjacency and prefix changes.
+   */
+  list<Types.ConvergenceDistribution> getConvergenceDistributions() throws (
+    1: OpenrError error,
+  );
+
+  /**
+   * Get stats of ctrl API methods called so far, keyed by method name.
+   */
+  map<string, CtrlApiStats> getCtrlApiStats();
+
   //
   // Decision APIs
   //
@@ -476,6 +706,15 @@ service OpenrCtrl extends KvStore.KvStoreService {
     1: AdjacenciesFilter filter,
   ) throws (1: OpenrError error);
 
+  /**
+   * Page of getDecisionAdjacenciesFiltered(), ordered by area and node. See
+   * [Paginated Dump]
+   */
+  AdjacenciesPage getDecisionAdjacenciesPage(
+    1: AdjacenciesFilter filter,
+    2: PageParams pageParams,
+  ) throws (1: OpenrError error);
+
   /**
    * Get map<area_name, list<adjacency databases>> of all nodes.
    * NOTE: for ABRs, there can be more than one AdjDb for a node (one per area).
@@ -494,6 +733,17 @@ service OpenrCtrl extends KvStore.KvStoreService {
    */
   Types.PrefixDbs getDecisionPrefixDbs() throws (1: OpenrError error);
 
+  /**
+   * Page of getKvStoreKeyValsFilteredArea(). Page covers `pageSize` keys of
+   * the area, keys not passing the filter are left out. KvStore isn't
+   * versioned, see [Paginated Dump]
+   */
+  KvStoreKeyValsPage getKvStoreKeyValsFilteredAreaPage(
+    1: KvStore.KeyDumpParams filter,
+    2: string area,
+    3: PageParams pageParams,
+  ) throws (1: KvStore.KvStoreError error);
+
   /**
    * Long poll API to get KvStore
    * Will return true/false with our own KeyVal snapshot provided
@@ -682,9 +932,38 @@ service OpenrCtrl extends KvStore.KvStoreService {
   // Get log events
   list<string> getEventLogs() throws (1: OpenrError error);
 
+  /**
+   * [Heap Profiling] Start a jemalloc heap profiling session, discarding
+   * samples of any previous session. Requires jemalloc with profiling enabled
+   * (`prof:true`).
+   */
+  void startHeapProfiling() throws (1: OpenrError error);
+
+  /**
+   * [Heap Profiling] Stop the heap profiling session. Heap profile of the
+   * session is dumped to `dumpPath` unless empty.
+   */
+  void stopHeapProfiling(1: string dumpPath) throws (1: OpenrError error);
+
   // Get Openr Node Name
   string getMyNodeName();
 
+  /**
+   * Convergence trace events recorded on this node by all modules, ordered by
+   * time. If `traceIds` is not empty, only events of those traces are
+   * returned. Requires `enable_perf_measurement`.
+   */
+  list<Types.TraceEvent> getTraceEvents(1: list<i64> traceIds) throws (
+    1: OpenrError error,
+  );
+
+  /**
+   * Same as getTraceEvents(), serialized in Chrome trace event JSON format
+   */
+  string getTraceEventsChromeJson(1: list<i64> traceIds) throws (
+    1: OpenrError error,
+  );
+
   //
   // RibPolicy
   //
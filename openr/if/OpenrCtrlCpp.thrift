@@ -42,6 +42,16 @@ service OpenrCtrlCpp extends OpenrCtrl.OpenrCtrl {
     2: set<string> selectAreas,
   );
 
+  // subscribeAndGetAreaKvStores() streaming encoded publications, see
+  // [Encoded Stream]
+  list<KvStore.Publication>, stream<
+    OpenrCtrl.EncodedStreamMessage
+  > subscribeAndGetAreaKvStoresEncoded(
+    1: KvStore.KeyDumpParams filter,
+    2: set<string> selectAreas,
+    3: OpenrCtrl.StreamEncodingParams encoding,
+  );
+
   /**
    * Retrieve Fib snapshot and subscribe for subsequent updates.
    * No update between snapshot and fullstream will be lost,
@@ -53,4 +63,21 @@ service OpenrCtrlCpp extends OpenrCtrl.OpenrCtrl {
   OpenrCtrl.RouteDatabaseDetail, stream<
     OpenrCtrl.RouteDatabaseDeltaDetail
   > subscribeAndGetFibDetail();
+
+  // subscribeAndGetFibDetail() streaming batches of encoded deltas, see
+  // [Encoded Stream]
+  OpenrCtrl.RouteDatabaseDetail, stream<
+    OpenrCtrl.EncodedStreamMessage
+  > subscribeAndGetFibDetailEncoded(1: OpenrCtrl.StreamEncodingParams encoding);
+
+  /**
+   * Chunked syncPrefixesByType for large prefix sets. Prefixes of each chunk
+   * are advertised as they are received. Once client completes the sink,
+   * prefixes of the type which were not received in any chunk are withdrawn
+   * and the number of received prefixes is returned. Sink terminated with an
+   * error leaves advertised prefixes as-is and withdraws nothing.
+   */
+  sink<list<Types.PrefixEntry>, i64> syncPrefixesByTypeStream(
+    1: Types.PrefixType prefixType,
+  );
 }
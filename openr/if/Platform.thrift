@@ -115,6 +115,31 @@ service FibService extends fb303_core.BaseService {
     1: PlatformError error,
   );
 
+  //
+  // Differential sync of unicast routes
+  // Prefixes are partitioned by hash into `numRanges` ranges. Client compares
+  // digests of ranges with its own and syncs only ranges that differ. Digests
+  // must be computed with `getUnicastRouteRangeDigests` in NetworkUtil.h.
+  //
+
+  // Retrieve digests of unicast routes programmed for the client, keyed by
+  // range. Ranges without routes are omitted. Digest of 0 indicates range
+  // with unknown state which must be synced.
+  map<i32, i64> getUnicastRouteDigests(
+    1: i16 clientId,
+    2: i32 numRanges,
+  ) throws (1: PlatformError error);
+
+  // Same as syncFib, but limited to the given ranges. `routes` must contain
+  // all routes of the client within these ranges. Routes of other ranges
+  // are left untouched.
+  void syncFibRanges(
+    1: i16 clientId,
+    2: i32 numRanges,
+    3: list<i32> ranges,
+    4: list<Network.UnicastRoute> routes,
+  ) throws (1: PlatformError error, 2: PlatformFibUpdateError fibError);
+
   //
   // MPLS routes API
   // NOTE: FibAgent may throw `PlatformFibUpdateError` for Add and Sync
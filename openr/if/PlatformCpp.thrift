@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+namespace cpp2 openr.thrift
+namespace py3 openr.thrift
+namespace wiki Open_Routing.Thrift_APIs.PlatformCpp
+
+include "openr/if/Network.thrift"
+include "openr/if/Platform.thrift"
+
+/**
+ * Batch of route operations streamed to FibService, see programRoutes().
+ * Deletions of a batch are applied before its additions/updates.
+ */
+struct RouteOperationBatch {
+  /** Position of the batch in its stream, starting from 0 */
+  1: i64 seqNum;
+  2: list<Network.UnicastRoute> unicastRoutesToUpdate;
+  3: list<Network.IpPrefix> unicastRoutesToDelete;
+  4: list<Network.MplsRoute> mplsRoutesToUpdate;
+  5: list<i32> mplsRoutesToDelete;
+}
+
+/**
+ * Acknowledgement of a programmed batch. Routes to add/update which failed
+ * to program are listed, all other routes of the batch are programmed.
+ */
+struct RouteOperationAck {
+  /** Sequence number of the acknowledged batch */
+  1: i64 seqNum;
+  2: list<Network.IpPrefix> failedUnicastRoutes;
+  3: list<i32> failedMplsRoutes;
+  /**
+   * Error failing the batch as a whole, e.g. failed deletions. None of the
+   * routes of the batch can be assumed to be programmed.
+   */
+  4: optional string error;
+}
+
+/**
+ * Extends FibService with streaming route programming, as streams are only
+ * supported in C++.
+ *
+ * Client streams batches of route operations with programRoutes() and
+ * receives acks of programmed batches, in order, on the stream returned by
+ * subscribeRouteAcks(). Agent can program batches as they arrive and bounds
+ * batches buffered on its side by the credits of the sink.
+ */
+service FibServiceCpp extends Platform.FibService {
+  /**
+   * Stream of acks of batches programmed for the client. New subscription of
+   * the client terminates the previous one. Must be subscribed before
+   * batches are streamed, acks without subscriber are dropped.
+   */
+  stream<RouteOperationAck> subscribeRouteAcks(1: i16 clientId);
+
+  /**
+   * Program streamed batches of route operations of the client, in order.
+   * Number of programmed batches is returned once client completes the sink.
+   */
+  sink<RouteOperationBatch, i64> programRoutes(1: i16 clientId);
+}
@@ -66,6 +66,33 @@ struct PerfEvents {
    * Ordered list of event. Most recent event is appended at the back
    */
   1: list<PerfEvent> events;
+  /**
+   * Trace ids of events triggering this data object, see ConvergenceTracer.
+   * Data objects merged from several updates carry ids of all of them.
+   */
+  2: list<i64> traceIds;
+}
+
+/**
+ * Event of a convergence trace, recorded by a module thread
+ */
+struct TraceEvent {
+  1: i64 traceId;
+  2: string event;
+  3: string threadName;
+  4: i64 unixTsUs;
+}
+
+/**
+ * [Typed Log Sample] Fields of monitor/LogSample.h by type. Rendered as JSON
+ * ONLY when exported, or serialized as is by binary exporters.
+ */
+struct LogSampleData {
+  1: map<string, i64> ints;
+  2: map<string, double> doubles;
+  3: map<string, string> strings;
+  4: map<string, list<string>> stringVectors;
+  5: map<string, set<string>> stringTagsets;
 }
 
 /**
@@ -609,6 +636,44 @@ struct PerfDatabase {
   2: list<PerfEvents> eventInfo;
 } (cpp.minimize_padding)
 
+/**
+ * Change triggering route convergence. Adjacency changes originate perf
+ * events at LinkMonitor, any other update is a prefix change.
+ */
+enum ConvergenceType {
+  ADJACENCY = 0,
+  PREFIX = 1,
+}
+
+/**
+ * Distribution of route convergence durations, from the change to routes
+ * programmed by Fib, over recent convergence events
+ */
+struct ConvergenceDistribution {
+  1: ConvergenceType type;
+
+  /**
+   * "TOTAL" for end-to-end durations, otherwise description of the perf event
+   * ending the stage, timed from the previous event
+   */
+  2: string stage;
+
+  /**
+   * Number of durations recorded since start
+   */
+  3: i64 count = 0;
+
+  /**
+   * Number of recent durations the percentiles are computed over
+   */
+  4: i64 numSamples = 0;
+
+  5: i64 p50Ms = 0;
+  6: i64 p90Ms = 0;
+  7: i64 p99Ms = 0;
+  8: i64 maxMs = 0;
+}
+
 /**
  * Details about an interface in Open/R
  */
@@ -637,6 +702,18 @@ struct InterfaceDetails {
    * functionality in LinkMonitor documentation.
    */
   4: optional i64 linkFlapBackOffMs;
+
+  /**
+   * Accumulated, decayed flap penalty of this interface. Set only if link-flap
+   * dampening is enabled.
+   */
+  5: optional i64 linkFlapPenalty;
+
+  /**
+   * Is this interface suppressed by link-flap dampening. Suppressed interface
+   * is treated as DOWN till its penalty decays below reuse threshold.
+   */
+  6: optional bool isLinkFlapSuppressed;
 } (cpp.minimize_padding)
 
 /**
@@ -906,6 +983,12 @@ struct SparkHeartbeatMsg {
    * https://openr.readthedocs.io/Protocol_Guide/Initialization_Process.html
    */
   3: bool holdAdjacency = false;
+
+  /**
+   * Hold time in milliseconds currently advertised by sender under adaptive
+   * keep-alive. Overrides the one exchanged via SparkHandshakeMsg.
+   */
+  4: optional i64 holdTime;
 }
 
 /**
@@ -965,6 +1048,12 @@ struct SparkHandshakeMsg {
   11: optional string neighborNodeName;
 
   12: optional bool enableFloodOptimization;
+
+  /**
+   * Flag to indicate if sender honors holdTime of SparkHeartbeatMsg, i.e.
+   * receiver may back off its keep-alive time.
+   */
+  13: optional bool enableAdaptiveHoldTime;
 } (cpp.minimize_padding)
 
 /**
@@ -5,6 +5,9 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <chrono>
+
+#include <folly/ScopeGuard.h>
 #include <folly/logging/xlog.h>
 
 #include <openr/kvstore/Dual.h>
@@ -245,6 +248,19 @@ Dual::tryLocalOrDiffusing(
     const DualEvent& event,
     bool needReply,
     std::unordered_map<std::string, thrift::DualMessages>& msgsToSend) {
+  const auto startTime = std::chrono::steady_clock::now();
+  SCOPE_EXIT {
+    const int64_t timeUs =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - startTime)
+            .count();
+    (*computationCounters_.numComputations_ref())++;
+    computationCounters_.totalComputationTimeUs_ref() =
+        *computationCounters_.totalComputationTimeUs_ref() + timeUs;
+    computationCounters_.maxComputationTimeUs_ref() =
+        std::max(*computationCounters_.maxComputationTimeUs_ref(), timeUs);
+  };
+
   auto affected = routeAffected();
   if (not affected) {
     if (needReply) {
@@ -311,6 +327,11 @@ Dual::getStatusString() const noexcept {
       folly::join("\n", counterStrs));
 }
 
+const thrift::DualPerRootComputationCounters&
+Dual::getComputationCounters() const noexcept {
+  return computationCounters_;
+}
+
 std::map<std::string, thrift::DualPerRootCounters>
 Dual::getCounters() const noexcept {
   return counters_;
@@ -431,6 +452,13 @@ Dual::peerUp(
     }
   }
 
+  sendPeerUpMessages(neighbor, msgsToSend);
+}
+
+void
+Dual::sendPeerUpMessages(
+    const std::string& neighbor,
+    std::unordered_map<std::string, thrift::DualMessages>& msgsToSend) {
   // send neighbor all route-table entries whose report-distance is valid
   // NOTE: here we might already send neighbor a update from tryLocalOrDiffusing
   // (2nd update will just be ignored by our neighbor)
@@ -493,6 +521,65 @@ Dual::peerDown(
   }
 }
 
+void
+Dual::peerEvents(
+    const std::map<std::string, std::optional<int64_t>>& events,
+    std::unordered_map<std::string, thrift::DualMessages>& msgsToSend) {
+  (*computationCounters_.numPeerEventBatches_ref())++;
+  computationCounters_.numPeerEvents_ref() =
+      *computationCounters_.numPeerEvents_ref() + events.size();
+
+  // diffusing in progress or current nexthop flapping, replay events one by
+  // one as the state machine may transit in between
+  bool batchable = events.size() > 1 and info_.sm.state == DualState::PASSIVE;
+  for (const auto& [neighbor, cost] : events) {
+    if (cost.has_value() and info_.nexthop.has_value() and
+        *info_.nexthop == neighbor) {
+      batchable = false;
+      break;
+    }
+  }
+  if (not batchable) {
+    for (const auto& [neighbor, cost] : events) {
+      if (cost.has_value()) {
+        peerUp(neighbor, *cost, msgsToSend);
+      } else {
+        peerDown(neighbor, msgsToSend);
+      }
+    }
+    return;
+  }
+
+  // apply all link changes first
+  DualEvent event = DualEvent::OTHERS;
+  for (const auto& [neighbor, cost] : events) {
+    if (cost.has_value()) {
+      XLOG(INFO) << rootId << "::" << nodeId << ": LINK UP event from ("
+                 << neighbor << ", " << *cost << ")";
+      localDistances_[neighbor] = *cost;
+      info_.neighborInfos.emplace(neighbor, NeighborInfo());
+    } else {
+      XLOG(INFO) << rootId << "::" << nodeId << ": LINK DOWN event from "
+                 << neighbor;
+      clearCounters(neighbor);
+      removeChild(neighbor);
+      localDistances_[neighbor] = std::numeric_limits<int64_t>::max();
+      info_.neighborInfos[neighbor].reportDistance =
+          std::numeric_limits<int64_t>::max();
+      event = DualEvent::INCREASE_D;
+    }
+  }
+
+  // then run a single computation for the whole batch
+  tryLocalOrDiffusing(event, false, msgsToSend);
+
+  for (const auto& [neighbor, cost] : events) {
+    if (cost.has_value()) {
+      sendPeerUpMessages(neighbor, msgsToSend);
+    }
+  }
+}
+
 void
 Dual::processUpdate(
     const std::string& neighbor,
@@ -701,6 +788,27 @@ DualNode::peerUp(const std::string& neighbor, int64_t cost) {
   sendAllDualMessages(msgsToSend);
 }
 
+void
+DualNode::peerEvents(
+    const std::map<std::string, std::optional<int64_t>>& events) {
+  // update local-distance and clear counters of down peers
+  for (const auto& [neighbor, cost] : events) {
+    if (cost.has_value()) {
+      localDistances_[neighbor] = *cost;
+    } else {
+      localDistances_[neighbor] = std::numeric_limits<int64_t>::max();
+      clearCounters(neighbor);
+    }
+  }
+
+  std::unordered_map<std::string, thrift::DualMessages> msgsToSend;
+  for (auto& [_, dual] : duals_) {
+    dual.peerEvents(events, msgsToSend);
+  }
+
+  sendAllDualMessages(msgsToSend);
+}
+
 void
 DualNode::peerDown(const std::string& neighbor) {
   // update local-distance
@@ -866,6 +974,8 @@ DualNode::getCounters() const noexcept {
   counters.neighborCounters_ref() = counters_;
   for (const auto& kv : duals_) {
     counters.rootCounters_ref()->emplace(kv.first, kv.second.getCounters());
+    counters.rootComputationCounters_ref()->emplace(
+        kv.first, kv.second.getComputationCounters());
   }
   return counters;
 }
@@ -87,6 +87,14 @@ class Dual {
       const std::string& neighbor,
       std::unordered_map<std::string, thrift::DualMessages>& msgsToSend);
 
+  // batch of peer up/down events. All link changes are applied before a
+  // single local computation, if in PASSIVE state.
+  // input: map<neighbor-id: link-metric, none for peer down>
+  // output: map<neighbor-id: dual-messages-to-send>
+  void peerEvents(
+      const std::map<std::string, std::optional<int64_t>>& events,
+      std::unordered_map<std::string, thrift::DualMessages>& msgsToSend);
+
   // process a DUAL update message
   // input: (neighbor-id, a update dual-message)
   // output: map<neighbor-id: dual-messages-to-send>
@@ -195,6 +203,10 @@ class Dual {
   std::map<std::string, thrift::DualPerRootCounters> getCounters()
       const noexcept;
 
+  // get local computation counters
+  const thrift::DualPerRootComputationCounters&
+  getComputationCounters() const noexcept;
+
   // add a spt child
   void addChild(const std::string& child) noexcept;
 
@@ -256,6 +268,11 @@ class Dual {
   void sendReply(
       std::unordered_map<std::string, thrift::DualMessages>& msgsToSend);
 
+  // send newly up neighbor my route-table entry and pending reply if any
+  void sendPeerUpMessages(
+      const std::string& neighbor,
+      std::unordered_map<std::string, thrift::DualMessages>& msgsToSend);
+
   // check if a neighbor is up or not
   bool neighborUp(const std::string& neighbor);
 
@@ -271,6 +288,9 @@ class Dual {
   // dual messages counters map<neighbor: dual-counters>
   std::map<std::string, thrift::DualPerRootCounters> counters_;
 
+  // local computation counters
+  thrift::DualPerRootComputationCounters computationCounters_;
+
   // callback when nexthop changed
   const std::function<void(
       const std::optional<std::string>& oldNh,
@@ -325,6 +345,11 @@ class DualNode {
   // peer down from neighbor
   void peerDown(const std::string& neighbor);
 
+  // batch of peer up/down events processed at once, so that every root runs
+  // one computation and sends one packet per neighbor for the whole batch
+  // input: map<neighbor-id: link-metric, none for peer down>
+  void peerEvents(const std::map<std::string, std::optional<int64_t>>& events);
+
   // process dual messages
   void processDualMessages(const thrift::DualMessages& messages);
 
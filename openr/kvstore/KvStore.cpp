@@ -5,11 +5,20 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
+#include <cmath>
+
 #include <fb303/ServiceData.h>
 #include <fbzmq/zmq/Zmq.h>
+#include <folly/Random.h>
+#include <folly/executors/thread_factory/NamedThreadFactory.h>
+#include <folly/futures/Future.h>
 #include <folly/logging/xlog.h>
+#include <folly/system/ThreadName.h>
+#include <thrift/lib/cpp/TApplicationException.h>
 
 #include <openr/common/Constants.h>
+#include <openr/common/ConvergenceTracer.h>
 #include <openr/common/EventLogger.h>
 #include <openr/common/Types.h>
 #include <openr/kvstore/KvStore.h>
@@ -18,11 +27,21 @@ namespace fb303 = facebook::fb303;
 
 namespace openr {
 
+namespace {
+
+// name of flood priority class used in counters
+std::string
+getFloodPriorityName(FloodPriority priority) {
+  return priority == FloodPriority::HIGH ? "high" : "normal";
+}
+
+} // namespace
+
 template <class ClientType>
 KvStore<ClientType>::KvStore(
     // initializers for immutable state
     fbzmq::Context& zmqContext,
-    messaging::ReplicateQueue<KvStorePublication>& kvStoreUpdatesQueue,
+    messaging::SharedReplicateQueue<KvStorePublication>& kvStoreUpdatesQueue,
     messaging::ReplicateQueue<KvStoreSyncEvent>& kvStoreEventsQueue,
     messaging::RQueue<PeerEvent> peerUpdatesQueue,
     messaging::RQueue<KeyValueRequest> kvRequestQueue,
@@ -47,19 +66,43 @@ KvStore<ClientType>::KvStore(
           std::chrono::milliseconds(*kvStoreConfig.ttl_decrement_ms_ref()),
           std::chrono::milliseconds(*kvStoreConfig.key_ttl_ms_ref()),
           kvStoreConfig.enable_flood_optimization_ref().value_or(false),
-          kvStoreConfig.is_flood_root_ref().value_or(false),
-          *kvStoreConfig.enable_thrift_dual_msg_ref()) {
+          kvStoreConfig.is_flood_root_ref().value_or(false)) {
   // Schedule periodic timer for counters submission
   counterUpdateTimer_ = folly::AsyncTimeout::make(*getEvb(), [this]() noexcept {
-    for (auto& [key, val] : getGlobalCounters()) {
-      fb303::fbData->setCounter(key, val);
-    }
+    getGlobalCounters().via(getEvb()).thenValue(
+        [](std::map<std::string, int64_t>&& counters) {
+          for (auto& [key, val] : counters) {
+            fb303::fbData->setCounter(key, val);
+          }
+        });
     counterUpdateTimer_->scheduleTimeout(Constants::kCounterSubmitInterval);
   });
   counterUpdateTimer_->scheduleTimeout(Constants::kCounterSubmitInterval);
 
   // Get optional ip_tos from the config
   kvParams_.maybeIpTos = kvStoreConfig.ip_tos_ref().to_optional();
+  kvParams_.enableMerkleSync =
+      kvStoreConfig.enable_merkle_sync_ref().value_or(false);
+  kvParams_.enableFastValueHash =
+      kvStoreConfig.enable_fast_value_hash_ref().value_or(false);
+  kvParams_.enableAreaEventBases =
+      kvStoreConfig.enable_area_event_bases_ref().value_or(false);
+  kvParams_.fullSyncChunkSize =
+      kvStoreConfig.full_sync_chunk_size_ref().to_optional();
+  kvParams_.enableFullSyncCompression =
+      kvStoreConfig.enable_full_sync_compression_ref().value_or(false);
+  if (auto snapshotDir = kvStoreConfig.warm_restart_snapshot_dir_ref()) {
+    kvParams_.snapshotDir = *snapshotDir;
+    kvParams_.snapshotInterval = std::chrono::seconds(
+        kvStoreConfig.warm_restart_snapshot_interval_s_ref().value_or(
+            Constants::kKvStoreSnapshotInterval.count()));
+  }
+  kvParams_.enableValueDelta =
+      kvStoreConfig.enable_value_delta_ref().value_or(false);
+  kvParams_.enableFloodDigest =
+      kvStoreConfig.enable_flood_digest_ref().value_or(false);
+  kvParams_.floodBatch = kvStoreConfig.flood_batch_ref().to_optional();
+  kvParams_.numKeyShards = kvStoreConfig.num_key_shards_ref().value_or(1);
   if (kvParams_.maybeIpTos.has_value()) {
     XLOG(INFO) << fmt::format(
         "Set IP_TOS: {} for node: {}",
@@ -80,7 +123,8 @@ KvStore<ClientType>::KvStore(
         [this](int) noexcept {
           // Drain all available messages in loop
           while (true) {
-            // NOTE: globalCmSock is connected with neighbor's peerSyncSock_.
+            // NOTE: globalCmSock is connected with peer-sync socket of
+            // neighbors of older versions.
             // recvMultiple() will get a vector of fbzmq::Message which has:
             //  1) requestIdMsg; 2) delimMsg; 3) kvStoreRequestMsg;
             auto maybeReq = kvParams_.globalCmdSock.recvMultiple();
@@ -140,32 +184,62 @@ KvStore<ClientType>::KvStore(
 
   // create KvStoreDb instances
   for (auto const& area : areaIds) {
+    OpenrEventBase* evb = this;
+    if (kvParams_.enableAreaEventBases) {
+      auto areaEvb = std::make_unique<OpenrEventBase>();
+      areaEvb->setEvbName(fmt::format("kvstore-{}", area));
+      evb = areaEvb.get();
+      areaEvbs_.emplace(area, std::move(areaEvb));
+    }
     kvStoreDb_.emplace(
         std::piecewise_construct,
         std::forward_as_tuple(area),
         std::forward_as_tuple(
-            this,
+            evb,
             kvParams_,
             area,
-            fbzmq::Socket<ZMQ_ROUTER, fbzmq::ZMQ_CLIENT>(
-                zmqContext,
-                fbzmq::IdentityString{folly::to<std::string>(
-                    *kvStoreConfig.node_name_ref(), "::TCP::SYNC::", area)},
-                folly::none,
-                fbzmq::NonblockingFlag{true}),
             kvStoreConfig.is_flood_root_ref().value_or(false),
             *kvStoreConfig.node_name_ref(),
             std::bind(&KvStore::initialKvStoreDbSynced, this)));
   }
+
+  // [Area Event Base]
+  // Start area event bases after KvStoreDb instances are fully constructed
+  for (auto& [area, areaEvb] : areaEvbs_) {
+    areaEvbThreads_.emplace_back(
+        std::thread([evb = areaEvb.get(), area = area]() noexcept {
+          XLOG(INFO) << "Starting KvStore thread of area: " << area;
+          folly::setThreadName(fmt::format("openr-kvstore-{}", area));
+          evb->run();
+          XLOG(INFO) << "KvStore thread of area: " << area << " got stopped.";
+        }));
+    areaEvb->waitUntilRunning();
+  }
+}
+
+template <class ClientType>
+KvStore<ClientType>::~KvStore() {
+  // ATTN: area event bases are stopped ONLY after KvStore's own event base is
+  //       gone, so that no request from KvStore can be left pending on them.
+  for (auto& [_, areaEvb] : areaEvbs_) {
+    areaEvb->stop();
+  }
+  for (auto& t : areaEvbThreads_) {
+    t.join();
+  }
 }
 
 template <class ClientType>
 void
 KvStore<ClientType>::stop() {
   getEvb()->runImmediatelyOrRunInEventBaseThreadAndWait([this]() {
+    // Stop counter submission, which reaches out to area event bases
+    counterUpdateTimer_->cancelTimeout();
+
     // NOTE: destructor of every instance inside `kvStoreDb_` will gracefully
     //       exit and wait for all pending thrift requests to be processed
-    //       before eventbase stops.
+    //       before eventbase stops. `KvStoreDb::stop()` hops over to the
+    //       event base of the area itself.
     for (auto& [area, kvDb] : kvStoreDb_) {
       kvDb.stop();
     }
@@ -242,6 +316,24 @@ KvStore<ClientType>::getAreaDbOrThrow(
   return search->second;
 }
 
+template <class ClientType>
+OpenrEventBase*
+KvStore<ClientType>::getAreaEvb(std::string const& areaId) {
+  if (areaEvbs_.empty()) {
+    return this;
+  }
+  auto search = areaEvbs_.find(areaId);
+  if (areaEvbs_.end() != search) {
+    return search->second.get();
+  }
+  // ATTN: mirror default area fallback of `getAreaDbOrThrow()`. For invalid
+  //       area, error will be reported by `getAreaDbOrThrow()` on the way.
+  if (areaEvbs_.size() == 1) {
+    return areaEvbs_.begin()->second.get();
+  }
+  return this;
+}
+
 template <class ClientType>
 void
 KvStore<ClientType>::processCmdSocketRequest(
@@ -250,68 +342,116 @@ KvStore<ClientType>::processCmdSocketRequest(
     XLOG(ERR) << "Empty request received";
     return;
   }
-  auto maybeReply = processRequestMsg(
+  auto sf = processRequestMsg(
       req.front().read<std::string>().value(), std::move(req.back()));
   req.pop_back();
 
-  // All messages of the multipart request except the last are sent back as they
-  // are ids or empty delims. Add the response at the end of that list.
-  if (maybeReply.hasValue()) {
-    req.emplace_back(std::move(maybeReply.value()));
-  } else {
-    req.emplace_back(
-        fbzmq::Message::from(Constants::kErrorResponse.toString()).value());
-  }
+  // ATTN: request is served on event base of the area. Reply is sent back on
+  //       this event base, which owns the command socket.
+  std::move(sf).via(getEvb()).thenValue(
+      [this, req = std::move(req)](
+          folly::Expected<fbzmq::Message, fbzmq::Error>&& maybeReply) mutable {
+        // All messages of the multipart request except the last are sent back
+        // as they are ids or empty delims. Add the response at the end of
+        // that list.
+        if (maybeReply.hasValue()) {
+          req.emplace_back(std::move(maybeReply.value()));
+        } else {
+          req.emplace_back(
+              fbzmq::Message::from(Constants::kErrorResponse.toString())
+                  .value());
+        }
 
-  if (not req.back().empty()) {
-    auto sndRet = kvParams_.globalCmdSock.sendMultiple(req);
-    if (sndRet.hasError()) {
-      XLOG(ERR) << "Error sending response. " << sndRet.error();
-    }
-  }
-  return;
+        if (not req.back().empty()) {
+          auto sndRet = kvParams_.globalCmdSock.sendMultiple(req);
+          if (sndRet.hasError()) {
+            XLOG(ERR) << "Error sending response. " << sndRet.error();
+          }
+        }
+      });
 }
 
 template <class ClientType>
 void
 KvStore<ClientType>::processKeyValueRequest(KeyValueRequest&& kvRequest) {
   // get area across different variants of KeyValueRequest
-  const auto& area = std::visit(
+  const auto area = std::visit(
       [](auto&& request) -> AreaId { return request.getArea(); }, kvRequest);
 
+  auto* areaEvb = getAreaEvb(area);
+  if (not areaEvb->getEvb()->isInEventBaseThread()) {
+    // ATTN: requests of the same area are queued on the same event base,
+    //       hence ordering within the area is preserved.
+    areaEvb->runInEventBaseThread(
+        [this, kvRequest = std::move(kvRequest)]() mutable {
+          processKeyValueRequest(std::move(kvRequest));
+        });
+    return;
+  }
+
   try {
     auto& kvStoreDb = getAreaDbOrThrow(area, "processKeyValueRequest");
-    if (auto pPersistKvRequest =
-            std::get_if<PersistKeyValueRequest>(&kvRequest)) {
-      kvStoreDb.persistSelfOriginatedKey(
-          pPersistKvRequest->getKey(), pPersistKvRequest->getValue());
-    } else if (
-        auto pSetKvRequest = std::get_if<SetKeyValueRequest>(&kvRequest)) {
-      kvStoreDb.setSelfOriginatedKey(
-          pSetKvRequest->getKey(),
-          pSetKvRequest->getValue(),
-          pSetKvRequest->getVersion());
-    } else if (
-        auto pClearKvRequest = std::get_if<ClearKeyValueRequest>(&kvRequest)) {
-      if (pClearKvRequest->getSetValue()) {
-        kvStoreDb.unsetSelfOriginatedKey(
-            pClearKvRequest->getKey(), pClearKvRequest->getValue());
-      } else {
-        kvStoreDb.eraseSelfOriginatedKey(pClearKvRequest->getKey());
-      }
-    } else {
-      XLOG(ERR)
-          << "Error processing key value request. Request type not recognized.";
-    }
+    std::visit(
+        [this, &kvStoreDb](auto&& request) {
+          applyKeyValueRequest(kvStoreDb, request);
+        },
+        kvRequest);
   } catch (thrift::KvStoreError const& e) {
     XLOG(ERR) << " Failed to find area " << area.t << " in kvStoreDb_.";
   }
 }
 
 template <class ClientType>
-folly::Expected<fbzmq::Message, fbzmq::Error>
+void
+KvStore<ClientType>::applyKeyValueRequest(
+    KvStoreDb<ClientType>& kvStoreDb, const SetKeyValueRequest& request) {
+  kvStoreDb.setSelfOriginatedKey(
+      request.getKey(), request.getValue(), request.getVersion());
+}
+
+template <class ClientType>
+void
+KvStore<ClientType>::applyKeyValueRequest(
+    KvStoreDb<ClientType>& kvStoreDb, const PersistKeyValueRequest& request) {
+  kvStoreDb.persistSelfOriginatedKey(
+      request.getKey(), request.getValue(), request.getTraceIds());
+}
+
+template <class ClientType>
+void
+KvStore<ClientType>::applyKeyValueRequest(
+    KvStoreDb<ClientType>& kvStoreDb, const ClearKeyValueRequest& request) {
+  if (request.getSetValue()) {
+    kvStoreDb.unsetSelfOriginatedKey(request.getKey(), request.getValue());
+  } else {
+    kvStoreDb.eraseSelfOriginatedKey(request.getKey());
+  }
+}
+
+template <class ClientType>
+void
+KvStore<ClientType>::applyKeyValueRequest(
+    KvStoreDb<ClientType>& kvStoreDb, const BatchKeyValueRequest& request) {
+  // ATTN: persisted and unset keys of the batch are advertised together by
+  //       the throttled advertisement of self-originated keys
+  for (const auto& singleRequest : request.getRequests()) {
+    std::visit(
+        [this, &kvStoreDb](auto&& request) {
+          applyKeyValueRequest(kvStoreDb, request);
+        },
+        singleRequest);
+  }
+  fb303::fbData->addStatValue(
+      "kvstore.batch_key_value_requests.size",
+      request.getRequests().size(),
+      fb303::AVG);
+}
+
+template <class ClientType>
+folly::SemiFuture<folly::Expected<fbzmq::Message, fbzmq::Error>>
 KvStore<ClientType>::processRequestMsg(
     const std::string& requestId, fbzmq::Message&& request) {
+  using Response = folly::Expected<fbzmq::Message, fbzmq::Error>;
   fb303::fbData->addStatValue(
       "kvstore.peers.bytes_received", request.size(), fb303::SUM);
   auto maybeThriftReq =
@@ -320,7 +460,8 @@ KvStore<ClientType>::processRequestMsg(
   if (maybeThriftReq.hasError()) {
     XLOG(ERR) << "processRequest: failed reading thrift::processRequestMsg"
               << maybeThriftReq.error();
-    return {folly::makeUnexpected(fbzmq::Error())};
+    return folly::makeSemiFuture<Response>(
+        folly::makeUnexpected(fbzmq::Error()));
   }
 
   auto& thriftRequest = maybeThriftReq.value();
@@ -330,20 +471,32 @@ KvStore<ClientType>::processRequestMsg(
     auto& kvStoreDb =
         getAreaDbOrThrow(*thriftRequest.area_ref(), "processRequestMsg");
     XLOG(DBG2) << "Request received for area " << kvStoreDb.getAreaId();
-    auto response = kvStoreDb.processRequestMsgHelper(requestId, thriftRequest);
-    if (response.hasValue()) {
-      fb303::fbData->addStatValue(
-          "kvstore.peers.bytes_sent", response->size(), fb303::SUM);
-    }
-    return response;
+    // dispatch to event base of the area without waiting for it
+    auto pf = folly::makePromiseContract<Response>();
+    getAreaEvb(*thriftRequest.area_ref())
+        ->getEvb()
+        ->runImmediatelyOrRunInEventBaseThread(
+            [&kvStoreDb,
+             requestId,
+             thriftRequest = std::move(thriftRequest),
+             p = std::move(pf.first)]() mutable {
+              auto response =
+                  kvStoreDb.processRequestMsgHelper(requestId, thriftRequest);
+              if (response.hasValue()) {
+                fb303::fbData->addStatValue(
+                    "kvstore.peers.bytes_sent", response->size(), fb303::SUM);
+              }
+              p.setValue(std::move(response));
+            });
+    return std::move(pf.second);
   } catch (thrift::KvStoreError const& e) {
-    return folly::makeUnexpected(fbzmq::Error(0, *e.message_ref()));
+    return folly::makeSemiFuture<Response>(
+        folly::makeUnexpected(fbzmq::Error(0, *e.message_ref())));
   }
-  return {folly::makeUnexpected(fbzmq::Error())};
 }
 
 template <class ClientType>
-messaging::RQueue<KvStorePublication>
+messaging::SharedRQueue<KvStorePublication>
 KvStore<ClientType>::getKvStoreUpdatesReader() {
   return kvParams_.kvStoreUpdatesQueue.getReader();
 }
@@ -372,12 +525,15 @@ KvStore<ClientType>::processPeerUpdates(PeerEvent&& event) {
     // 'initialKvStoreDbSynced()' will not publish kvStoreSynced signal, and
     // downstream modules cannot proceed to complete initialization.
     for (auto& [area, kvStoreDb] : kvStoreDb_) {
-      if (kvStoreDb.getPeerCnt() != 0) {
-        continue;
-      }
-      XLOG(INFO)
-          << fmt::format("[Initialization] Received 0 peers in area {}.", area);
-      kvStoreDb.processInitializationEvent();
+      getAreaEvb(area)->getEvb()->runImmediatelyOrRunInEventBaseThread(
+          [area = area, &kvStoreDb]() {
+            if (kvStoreDb.getPeerCnt() != 0) {
+              return;
+            }
+            XLOG(INFO) << fmt::format(
+                "[Initialization] Received 0 peers in area {}.", area);
+            kvStoreDb.processInitializationEvent();
+          });
     }
   }
 }
@@ -388,23 +544,25 @@ KvStore<ClientType>::semifuture_getKvStoreKeyVals(
     std::string area, thrift::KeyGetParams keyGetParams) {
   folly::Promise<std::unique_ptr<thrift::Publication>> p;
   auto sf = p.getSemiFuture();
-  runInEventBaseThread([this,
-                        p = std::move(p),
-                        keyGetParams = std::move(keyGetParams),
-                        area]() mutable {
-    XLOG(DBG3) << "Get key requested for AREA: " << area;
-    try {
-      auto& kvStoreDb = getAreaDbOrThrow(area, "getKvStoreKeyVals");
-
-      auto thriftPub = kvStoreDb.getKeyVals(*keyGetParams.keys_ref());
-      updatePublicationTtl(
-          kvStoreDb.getTtlCountdownQueue(), kvParams_.ttlDecr, thriftPub);
-
-      p.setValue(std::make_unique<thrift::Publication>(std::move(thriftPub)));
-    } catch (thrift::KvStoreError const& e) {
-      p.setException(e);
-    }
-  });
+  getAreaEvb(area)->runInEventBaseThread(
+      [this,
+       p = std::move(p),
+       keyGetParams = std::move(keyGetParams),
+       area]() mutable {
+        XLOG(DBG3) << "Get key requested for AREA: " << area;
+        try {
+          auto& kvStoreDb = getAreaDbOrThrow(area, "getKvStoreKeyVals");
+
+          auto thriftPub = kvStoreDb.getKeyVals(*keyGetParams.keys_ref());
+          updatePublicationTtl(
+              kvStoreDb.getTtlCountdownQueue(), kvParams_.ttlDecr, thriftPub);
+
+          p.setValue(
+              std::make_unique<thrift::Publication>(std::move(thriftPub)));
+        } catch (thrift::KvStoreError const& e) {
+          p.setException(e);
+        }
+      });
   return sf;
 }
 
@@ -414,146 +572,367 @@ KvStore<ClientType>::semifuture_dumpKvStoreSelfOriginatedKeys(
     std::string area) {
   folly::Promise<std::unique_ptr<SelfOriginatedKeyVals>> p;
   auto sf = p.getSemiFuture();
-  runInEventBaseThread([this, p = std::move(p), area]() mutable {
-    XLOG(DBG3) << "Dump self originated key-vals for AREA: " << area;
-    try {
-      auto& kvStoreDb =
-          getAreaDbOrThrow(area, "semifuture_dumpKvStoreSelfOriginatedKeys");
-      // track self origin key-val dump calls
-      fb303::fbData->addStatValue(
-          "kvstore.cmd_self_originated_key_dump", 1, fb303::COUNT);
+  getAreaEvb(area)->runInEventBaseThread(
+      [this, p = std::move(p), area]() mutable {
+        XLOG(DBG3) << "Dump self originated key-vals for AREA: " << area;
+        try {
+          auto& kvStoreDb = getAreaDbOrThrow(
+              area, "semifuture_dumpKvStoreSelfOriginatedKeys");
+          // track self origin key-val dump calls
+          fb303::fbData->addStatValue(
+              "kvstore.cmd_self_originated_key_dump", 1, fb303::COUNT);
 
-      auto keyVals = kvStoreDb.getSelfOriginatedKeyVals();
-      p.setValue(std::make_unique<SelfOriginatedKeyVals>(keyVals));
-    } catch (thrift::KvStoreError const& e) {
-      p.setException(e);
-    }
-  });
+          auto keyVals = kvStoreDb.getSelfOriginatedKeyVals();
+          p.setValue(std::make_unique<SelfOriginatedKeyVals>(keyVals));
+        } catch (thrift::KvStoreError const& e) {
+          p.setException(e);
+        }
+      });
   return sf;
 }
 
+template <class ClientType>
+thrift::Publication
+KvStore<ClientType>::dumpKvStoreKeysFromArea(
+    std::string const& area, thrift::KeyDumpParams const& keyDumpParams) {
+  auto& kvStoreDb = getAreaDbOrThrow(area, "dumpKvStoreKeys");
+  fb303::fbData->addStatValue("kvstore.cmd_key_dump", 1, fb303::COUNT);
+
+  const auto keyPrefixMatch = getKeyDumpFilters(keyDumpParams);
+
+  // Merkle-tree bucket digests are ONLY honored for unfiltered dump,
+  // since digests cover the entire key space.
+  std::optional<std::vector<int32_t>> differingBuckets;
+  // Responder not maintaining the tree falls back to full dump.
+  if (kvStoreDb.getMerkleTree() and
+      keyDumpParams.keyValBucketDigests_ref().has_value() and
+      not keyDumpParams.keyValHashes_ref().has_value() and
+      keyPrefixMatch.getKeyPrefixes().empty() and
+      keyDumpParams.originatorIds_ref()->empty()) {
+    differingBuckets = kvStoreDb.getMerkleTree()->getDifferingBuckets(
+        keyDumpParams.keyValBucketDigests_ref().value());
+  }
+
+  thrift::Publication thriftPub;
+  if (differingBuckets.has_value()) {
+    thriftPub = kvStoreDb.dumpDifferingBuckets(*differingBuckets);
+  } else {
+    // ATTN: also serves as fallback when bucket layout mismatches
+    thriftPub = dumpAllWithFilters(
+        area,
+        kvStoreDb.getKeyValueMap(),
+        kvStoreDb.getKeyIndex(),
+        keyPrefixMatch,
+        *keyDumpParams.doNotPublishValue_ref());
+    if (keyDumpParams.keyValHashes_ref().has_value()) {
+      thriftPub = dumpDifference(
+          area,
+          *thriftPub.keyVals_ref(),
+          keyDumpParams.keyValHashes_ref().value());
+    }
+  }
+  if (keyDumpParams.keyValHashes_ref().has_value() or
+      keyDumpParams.keyValBucketDigests_ref().has_value()) {
+    // full-sync request from peer
+    kvStoreDb.removeUnverifiedKeys(thriftPub);
+    thriftPub.compactTtlUpdates_ref() = true;
+    thriftPub.valueDeltas_ref() = true;
+    thriftPub.serializedKeyVals_ref() = true;
+  }
+  updatePublicationTtl(
+      kvStoreDb.getTtlCountdownQueue(), kvParams_.ttlDecr, thriftPub);
+  // I'm the initiator, set flood-root-id
+  thriftPub.floodRootId_ref().from_optional(kvStoreDb.getSptRootId());
+  // advertise supported hash scheme if requester is able to negotiate
+  if (keyDumpParams.hashScheme_ref().has_value()) {
+    thriftPub.hashScheme_ref() = kvParams_.enableFastValueHash
+        ? thrift::KvStoreHashScheme::SPOOKY_V2
+        : thrift::KvStoreHashScheme::BOOST_HASH_COMBINE;
+  }
+
+  if (keyDumpParams.keyValHashes_ref().has_value() and
+      (*keyDumpParams.prefix_ref()).empty() and
+      (not keyDumpParams.keys_ref().has_value() or
+       (*keyDumpParams.keys_ref()).empty())) {
+    // This usually comes from neighbor nodes
+    size_t numMissingKeys = 0;
+    if (thriftPub.tobeUpdatedKeys_ref().has_value()) {
+      numMissingKeys = thriftPub.tobeUpdatedKeys_ref()->size();
+    }
+    XLOG(INFO) << "[Thrift Sync] Processed full-sync request with "
+               << keyDumpParams.keyValHashes_ref().value().size()
+               << " keyValHashes item(s). Sending "
+               << thriftPub.keyVals_ref()->size() << " key-vals and "
+               << numMissingKeys << " missing keys";
+  }
+  if (differingBuckets.has_value()) {
+    XLOG(INFO) << "[Thrift Sync] Processed full-sync request with "
+               << keyDumpParams.keyValBucketDigests_ref()->size()
+               << " bucket digest(s). Sending "
+               << thriftPub.keyVals_ref()->size() << " key-vals from "
+               << differingBuckets->size() << " differing bucket(s)";
+  }
+  return thriftPub;
+}
+
+template <class ClientType>
+thrift::KvStoreSyncChunk
+KvStore<ClientType>::dumpKvStoreSyncChunkFromArea(
+    std::string const& area,
+    thrift::KeyDumpParams const& keyDumpParams,
+    thrift::KvStoreSyncChunkParams const& chunkParams) {
+  auto& kvStoreDb = getAreaDbOrThrow(area, "dumpKvStoreSyncChunk");
+  fb303::fbData->addStatValue("kvstore.cmd_sync_chunk_dump", 1, fb303::COUNT);
+
+  // chunk covers keys in (cursor, chunkEnd]. Never go beyond hashes known
+  // from requester, otherwise its keys would be missed in comparison.
+  const auto cursor = chunkParams.cursor_ref().to_optional();
+  auto chunkEnd = kvStoreDb.getKeyIndex().getChunkEnd(
+      cursor, std::max(1, *chunkParams.maxKeysPerChunk_ref()));
+  if (auto hashesUpperBound = chunkParams.hashesUpperBound_ref()) {
+    if (not chunkEnd.has_value() or *hashesUpperBound < *chunkEnd) {
+      chunkEnd = *hashesUpperBound;
+    }
+  }
+
+  auto thriftPub = dumpKeysWithFilters(
+      area,
+      kvStoreDb.getKeyValueMap(),
+      kvStoreDb.getKeyIndex().getKeysInRange(cursor, chunkEnd),
+      getKeyDumpFilters(keyDumpParams),
+      *keyDumpParams.doNotPublishValue_ref());
+  if (auto keyValHashes = keyDumpParams.keyValHashes_ref()) {
+    // ATTN: requester may send hashes beyond this chunk, ignore them
+    std::unordered_map<std::string, thrift::Value> chunkHashes;
+    for (auto const& [key, val] : *keyValHashes) {
+      if ((not cursor.has_value() or key > *cursor) and
+          (not chunkEnd.has_value() or key <= *chunkEnd)) {
+        chunkHashes.emplace(key, val);
+      }
+    }
+    thriftPub = dumpDifference(area, *thriftPub.keyVals_ref(), chunkHashes);
+  }
+  kvStoreDb.removeUnverifiedKeys(thriftPub);
+  updatePublicationTtl(
+      kvStoreDb.getTtlCountdownQueue(), kvParams_.ttlDecr, thriftPub);
+  thriftPub.floodRootId_ref().from_optional(kvStoreDb.getSptRootId());
+  thriftPub.compactTtlUpdates_ref() = true;
+  thriftPub.valueDeltas_ref() = true;
+  thriftPub.serializedKeyVals_ref() = true;
+  if (keyDumpParams.hashScheme_ref().has_value()) {
+    thriftPub.hashScheme_ref() = kvParams_.enableFastValueHash
+        ? thrift::KvStoreHashScheme::SPOOKY_V2
+        : thrift::KvStoreHashScheme::BOOST_HASH_COMBINE;
+  }
+
+  XLOG(DBG1) << "[Thrift Sync] Processed full-sync chunk request after key: "
+             << cursor.value_or("") << ". Sending "
+             << thriftPub.keyVals_ref()->size() << " key-vals up to key: "
+             << chunkEnd.value_or("");
+  return packSyncChunk(
+      std::move(thriftPub), chunkEnd, *chunkParams.compression_ref());
+}
+
+template <class ClientType>
+thrift::KvStoreKeyValsPage
+KvStore<ClientType>::dumpKvStoreKeysPageFromArea(
+    std::string const& area,
+    thrift::KeyDumpParams const& keyDumpParams,
+    thrift::PageParams const& pageParams) {
+  auto& kvStoreDb = getAreaDbOrThrow(area, "dumpKvStoreKeysPage");
+  fb303::fbData->addStatValue("kvstore.cmd_key_dump_page", 1, fb303::COUNT);
+
+  // page covers keys in (token, pageEnd], same as full-sync chunk
+  const auto cursor = pageParams.continuationToken_ref().to_optional();
+  const auto pageEnd = kvStoreDb.getKeyIndex().getChunkEnd(
+      cursor, std::max(1, *pageParams.pageSize_ref()));
+
+  thrift::KvStoreKeyValsPage page;
+  page.publication_ref() = dumpKeysWithFilters(
+      area,
+      kvStoreDb.getKeyValueMap(),
+      kvStoreDb.getKeyIndex().getKeysInRange(cursor, pageEnd),
+      getKeyDumpFilters(keyDumpParams),
+      *keyDumpParams.doNotPublishValue_ref());
+  updatePublicationTtl(
+      kvStoreDb.getTtlCountdownQueue(),
+      kvParams_.ttlDecr,
+      *page.publication_ref());
+  page.pageInfo_ref()->continuationToken_ref().from_optional(pageEnd);
+  return page;
+}
+
 template <class ClientType>
 folly::SemiFuture<std::unique_ptr<std::vector<thrift::Publication>>>
 KvStore<ClientType>::semifuture_dumpKvStoreKeys(
     thrift::KeyDumpParams keyDumpParams, std::set<std::string> selectAreas) {
-  folly::Promise<std::unique_ptr<std::vector<thrift::Publication>>> p;
-  auto sf = p.getSemiFuture();
-  runInEventBaseThread([this,
-                        p = std::move(p),
-                        selectAreas = std::move(selectAreas),
-                        keyDumpParams = std::move(keyDumpParams)]() mutable {
-    // Empty senderID means local call.
-    XLOG(DBG3) << fmt::format(
-        "Dump all keys requested for {}, by sender: {}",
-        (selectAreas.empty()
-             ? "all areas."
-             : fmt::format("areas: {}", folly::join(", ", selectAreas))),
-        (keyDumpParams.senderId_ref().has_value()
-             ? keyDumpParams.senderId_ref().value()
-             : ""));
-
-    auto result = std::make_unique<std::vector<thrift::Publication>>();
-    for (auto& area : selectAreas) {
-      try {
-        auto& kvStoreDb = getAreaDbOrThrow(area, "dumpKvStoreKeys");
-        fb303::fbData->addStatValue("kvstore.cmd_key_dump", 1, fb303::COUNT);
+  // Empty senderID means local call.
+  XLOG(DBG3) << fmt::format(
+      "Dump all keys requested for {}, by sender: {}",
+      (selectAreas.empty()
+           ? "all areas."
+           : fmt::format("areas: {}", folly::join(", ", selectAreas))),
+      (keyDumpParams.senderId_ref().has_value()
+           ? keyDumpParams.senderId_ref().value()
+           : ""));
+
+  // fan out to event base of every requested area and gather results
+  std::vector<folly::SemiFuture<std::optional<thrift::Publication>>> sfs;
+  for (auto const& area : selectAreas) {
+    auto pf = folly::makePromiseContract<std::optional<thrift::Publication>>();
+    getAreaEvb(area)->runInEventBaseThread(
+        [this, p = std::move(pf.first), area, keyDumpParams]() mutable {
+          try {
+            p.setValue(dumpKvStoreKeysFromArea(area, keyDumpParams));
+          } catch (thrift::KvStoreError const& e) {
+            XLOG(ERR) << " Failed to find area " << area << " in kvStoreDb_.";
+            p.setValue(std::nullopt);
+          }
+        });
+    sfs.emplace_back(std::move(pf.second));
+  }
 
-        std::vector<std::string> keyPrefixList;
-        if (keyDumpParams.keys_ref().has_value()) {
-          keyPrefixList = *keyDumpParams.keys_ref();
-        } else {
-          folly::split(",", *keyDumpParams.prefix_ref(), keyPrefixList, true);
-        }
+  return folly::collectAll(std::move(sfs))
+      .deferValue(
+          [](std::vector<folly::Try<std::optional<thrift::Publication>>>&&
+                 results) {
+            auto result = std::make_unique<std::vector<thrift::Publication>>();
+            for (auto& maybePub : results) {
+              if (maybePub.hasValue() and maybePub->has_value()) {
+                result->push_back(std::move(maybePub->value()));
+              }
+            }
+            return result;
+          });
+}
 
-        thrift::FilterOperator oper = thrift::FilterOperator::OR;
-        if (keyDumpParams.oper_ref().has_value()) {
-          oper = *keyDumpParams.oper_ref();
-        }
-        // KvStoreFilters contains `thrift::FilterOperator`
-        // Default to thrift::FilterOperator::OR
+template <class ClientType>
+folly::SemiFuture<std::vector<std::shared_ptr<const KvStoreDumpSnapshot>>>
+KvStore<ClientType>::semifuture_getKvStoreDumpSnapshots(
+    std::set<std::string> selectAreas) {
+  fb303::fbData->addStatValue("kvstore.cmd_dump_snapshot", 1, fb303::COUNT);
+
+  // fan out to event base of every requested area and gather results
+  std::vector<folly::SemiFuture<std::shared_ptr<const KvStoreDumpSnapshot>>>
+      sfs;
+  for (auto const& area : selectAreas) {
+    auto pf = folly::makePromiseContract<
+        std::shared_ptr<const KvStoreDumpSnapshot>>();
+    getAreaEvb(area)->runInEventBaseThread(
+        [this, p = std::move(pf.first), area]() mutable {
+          try {
+            p.setValue(
+                getAreaDbOrThrow(area, "getKvStoreDumpSnapshots")
+                    .getDumpSnapshot());
+          } catch (thrift::KvStoreError const& e) {
+            XLOG(ERR) << " Failed to find area " << area << " in kvStoreDb_.";
+            p.setValue(nullptr);
+          }
+        });
+    sfs.emplace_back(std::move(pf.second));
+  }
 
-        const auto keyPrefixMatch = KvStoreFilters(
-            keyPrefixList, *keyDumpParams.originatorIds_ref(), oper);
+  return folly::collectAll(std::move(sfs))
+      .deferValue(
+          [](std::vector<
+              folly::Try<std::shared_ptr<const KvStoreDumpSnapshot>>>&&
+                 results) {
+            std::vector<std::shared_ptr<const KvStoreDumpSnapshot>> snapshots;
+            for (auto& snapshot : results) {
+              if (snapshot.hasValue() and snapshot.value()) {
+                snapshots.emplace_back(std::move(snapshot.value()));
+              }
+            }
+            return snapshots;
+          });
+}
 
-        auto thriftPub = dumpAllWithFilters(
+template <class ClientType>
+folly::SemiFuture<std::unique_ptr<thrift::Publication>>
+KvStore<ClientType>::semifuture_dumpKvStoreHashes(
+    std::string area, thrift::KeyDumpParams keyDumpParams) {
+  folly::Promise<std::unique_ptr<thrift::Publication>> p;
+  auto sf = p.getSemiFuture();
+  getAreaEvb(area)->runInEventBaseThread(
+      [this,
+       p = std::move(p),
+       keyDumpParams = std::move(keyDumpParams),
+       area]() mutable {
+        // Empty senderID means local call.
+        XLOG(DBG3) << fmt::format(
+            "Dump all hashes requested for AREA: {}, by sender: {}",
             area,
-            kvStoreDb.getKeyValueMap(),
-            keyPrefixMatch,
-            *keyDumpParams.doNotPublishValue_ref());
-        if (keyDumpParams.keyValHashes_ref().has_value()) {
-          thriftPub = dumpDifference(
-              area,
-              *thriftPub.keyVals_ref(),
-              keyDumpParams.keyValHashes_ref().value());
-        }
-        updatePublicationTtl(
-            kvStoreDb.getTtlCountdownQueue(), kvParams_.ttlDecr, thriftPub);
-        // I'm the initiator, set flood-root-id
-        thriftPub.floodRootId_ref().from_optional(kvStoreDb.getSptRootId());
-
-        if (keyDumpParams.keyValHashes_ref().has_value() and
-            (*keyDumpParams.prefix_ref()).empty() and
-            (not keyDumpParams.keys_ref().has_value() or
-             (*keyDumpParams.keys_ref()).empty())) {
-          // This usually comes from neighbor nodes
-          size_t numMissingKeys = 0;
-          if (thriftPub.tobeUpdatedKeys_ref().has_value()) {
-            numMissingKeys = thriftPub.tobeUpdatedKeys_ref()->size();
+            (keyDumpParams.senderId_ref().has_value()
+                 ? keyDumpParams.senderId_ref().value()
+                 : ""));
+        try {
+          auto& kvStoreDb =
+              getAreaDbOrThrow(area, "semifuture_dumpKvStoreHashes");
+          fb303::fbData->addStatValue("kvstore.cmd_hash_dump", 1, fb303::COUNT);
+
+          std::vector<std::string> keyPrefixList{};
+          if (keyDumpParams.keys_ref().has_value()) {
+            keyPrefixList = *keyDumpParams.keys_ref();
+          } else {
+            folly::split(",", *keyDumpParams.prefix_ref(), keyPrefixList, true);
           }
-          XLOG(INFO) << "[Thrift Sync] Processed full-sync request with "
-                     << keyDumpParams.keyValHashes_ref().value().size()
-                     << " keyValHashes item(s). Sending "
-                     << thriftPub.keyVals_ref()->size() << " key-vals and "
-                     << numMissingKeys << " missing keys";
+          auto thriftPub = *kvStoreDb.dumpHashes(keyPrefixList);
+          updatePublicationTtl(
+              kvStoreDb.getTtlCountdownQueue(), kvParams_.ttlDecr, thriftPub);
+          p.setValue(
+              std::make_unique<thrift::Publication>(std::move(thriftPub)));
+        } catch (thrift::KvStoreError const& e) {
+          p.setException(e);
         }
-        result->push_back(std::move(thriftPub));
-      } catch (thrift::KvStoreError const& e) {
-        XLOG(ERR) << " Failed to find area " << area << " in kvStoreDb_.";
-      }
-    }
-    p.setValue(std::move(result));
-  });
+      });
   return sf;
 }
 
 template <class ClientType>
-folly::SemiFuture<std::unique_ptr<thrift::Publication>>
-KvStore<ClientType>::semifuture_dumpKvStoreHashes(
-    std::string area, thrift::KeyDumpParams keyDumpParams) {
-  folly::Promise<std::unique_ptr<thrift::Publication>> p;
+folly::SemiFuture<std::unique_ptr<thrift::KvStoreSyncChunk>>
+KvStore<ClientType>::semifuture_getKvStoreSyncChunk(
+    std::string area,
+    thrift::KeyDumpParams keyDumpParams,
+    thrift::KvStoreSyncChunkParams chunkParams) {
+  folly::Promise<std::unique_ptr<thrift::KvStoreSyncChunk>> p;
   auto sf = p.getSemiFuture();
-  runInEventBaseThread([this,
-                        p = std::move(p),
-                        keyDumpParams = std::move(keyDumpParams),
-                        area]() mutable {
-    // Empty senderID means local call.
-    XLOG(DBG3) << fmt::format(
-        "Dump all hashes requested for AREA: {}, by sender: {}",
-        area,
-        (keyDumpParams.senderId_ref().has_value()
-             ? keyDumpParams.senderId_ref().value()
-             : ""));
-    try {
-      auto& kvStoreDb = getAreaDbOrThrow(area, "semifuture_dumpKvStoreHashes");
-      fb303::fbData->addStatValue("kvstore.cmd_hash_dump", 1, fb303::COUNT);
-
-      std::set<std::string> originator{};
-      std::vector<std::string> keyPrefixList{};
-      if (keyDumpParams.keys_ref().has_value()) {
-        keyPrefixList = *keyDumpParams.keys_ref();
-      } else {
-        folly::split(",", *keyDumpParams.prefix_ref(), keyPrefixList, true);
-      }
-      KvStoreFilters kvFilters{keyPrefixList, originator};
-      auto thriftPub =
-          dumpHashWithFilters(area, kvStoreDb.getKeyValueMap(), kvFilters);
-      updatePublicationTtl(
-          kvStoreDb.getTtlCountdownQueue(), kvParams_.ttlDecr, thriftPub);
-      p.setValue(std::make_unique<thrift::Publication>(std::move(thriftPub)));
-    } catch (thrift::KvStoreError const& e) {
-      p.setException(e);
-    }
-  });
+  getAreaEvb(area)->runInEventBaseThread(
+      [this,
+       p = std::move(p),
+       area,
+       keyDumpParams = std::move(keyDumpParams),
+       chunkParams = std::move(chunkParams)]() mutable {
+        try {
+          p.setValue(std::make_unique<thrift::KvStoreSyncChunk>(
+              dumpKvStoreSyncChunkFromArea(area, keyDumpParams, chunkParams)));
+        } catch (thrift::KvStoreError const& e) {
+          p.setException(e);
+        }
+      });
+  return sf;
+}
+
+template <class ClientType>
+folly::SemiFuture<std::unique_ptr<thrift::KvStoreKeyValsPage>>
+KvStore<ClientType>::semifuture_getKvStoreKeyValsPage(
+    std::string area,
+    thrift::KeyDumpParams keyDumpParams,
+    thrift::PageParams pageParams) {
+  folly::Promise<std::unique_ptr<thrift::KvStoreKeyValsPage>> p;
+  auto sf = p.getSemiFuture();
+  getAreaEvb(area)->runInEventBaseThread(
+      [this,
+       p = std::move(p),
+       area,
+       keyDumpParams = std::move(keyDumpParams),
+       pageParams = std::move(pageParams)]() mutable {
+        try {
+          p.setValue(std::make_unique<thrift::KvStoreKeyValsPage>(
+              dumpKvStoreKeysPageFromArea(area, keyDumpParams, pageParams)));
+        } catch (thrift::KvStoreError const& e) {
+          p.setException(e);
+        }
+      });
   return sf;
 }
 
@@ -561,28 +940,36 @@ template <class ClientType>
 folly::SemiFuture<folly::Unit>
 KvStore<ClientType>::semifuture_setKvStoreKeyVals(
     std::string area, thrift::KeySetParams keySetParams) {
+  // [Serialized Flood] decode on the calling thread, off the area event base
+  try {
+    deserializeKeySetParams(keySetParams);
+  } catch (thrift::KvStoreError const& e) {
+    return folly::makeSemiFuture<folly::Unit>(e);
+  }
+
   folly::Promise<folly::Unit> p;
   auto sf = p.getSemiFuture();
-  runInEventBaseThread([this,
-                        p = std::move(p),
-                        keySetParams = std::move(keySetParams),
-                        area]() mutable {
-    // Empty senderID means local call.
-    XLOG(DBG3) << fmt::format(
-        "Set key requested for AREA: {}, by sender: {}",
-        area,
-        (keySetParams.senderId_ref().has_value()
-             ? keySetParams.senderId_ref().value()
-             : ""));
-    try {
-      auto& kvStoreDb = getAreaDbOrThrow(area, "setKvStoreKeyVals");
-      kvStoreDb.setKeyVals(std::move(keySetParams));
-      // ready to return
-      p.setValue();
-    } catch (thrift::KvStoreError const& e) {
-      p.setException(e);
-    }
-  });
+  getAreaEvb(area)->runInEventBaseThread(
+      [this,
+       p = std::move(p),
+       keySetParams = std::move(keySetParams),
+       area]() mutable {
+        // Empty senderID means local call.
+        XLOG(DBG3) << fmt::format(
+            "Set key requested for AREA: {}, by sender: {}",
+            area,
+            (keySetParams.senderId_ref().has_value()
+                 ? keySetParams.senderId_ref().value()
+                 : ""));
+        try {
+          auto& kvStoreDb = getAreaDbOrThrow(area, "setKvStoreKeyVals");
+          kvStoreDb.setKeyVals(std::move(keySetParams));
+          // ready to return
+          p.setValue();
+        } catch (thrift::KvStoreError const& e) {
+          p.setException(e);
+        }
+      });
   return sf;
 }
 
@@ -592,7 +979,7 @@ KvStore<ClientType>::semifuture_getKvStorePeerState(
     std::string const& area, std::string const& peerName) {
   folly::Promise<std::optional<thrift::KvStorePeerState>> promise;
   auto sf = promise.getSemiFuture();
-  runInEventBaseThread(
+  getAreaEvb(area)->runInEventBaseThread(
       [this, p = std::move(promise), peerName, area]() mutable {
         try {
           p.setValue(getAreaDbOrThrow(area, "semifuture_getKvStorePeerState")
@@ -609,16 +996,18 @@ folly::SemiFuture<std::unique_ptr<thrift::PeersMap>>
 KvStore<ClientType>::semifuture_getKvStorePeers(std::string area) {
   folly::Promise<std::unique_ptr<thrift::PeersMap>> p;
   auto sf = p.getSemiFuture();
-  runInEventBaseThread([this, p = std::move(p), area]() mutable {
-    XLOG(DBG2) << "Peer dump requested for AREA: " << area;
-    try {
-      p.setValue(std::make_unique<thrift::PeersMap>(
-          getAreaDbOrThrow(area, "semifuture_getKvStorePeers").dumpPeers()));
-      fb303::fbData->addStatValue("kvstore.cmd_peer_dump", 1, fb303::COUNT);
-    } catch (thrift::KvStoreError const& e) {
-      p.setException(e);
-    }
-  });
+  getAreaEvb(area)->runInEventBaseThread(
+      [this, p = std::move(p), area]() mutable {
+        XLOG(DBG2) << "Peer dump requested for AREA: " << area;
+        try {
+          p.setValue(std::make_unique<thrift::PeersMap>(
+              getAreaDbOrThrow(area, "semifuture_getKvStorePeers")
+                  .dumpPeers()));
+          fb303::fbData->addStatValue("kvstore.cmd_peer_dump", 1, fb303::COUNT);
+        } catch (thrift::KvStoreError const& e) {
+          p.setException(e);
+        }
+      });
   return sf;
 }
 
@@ -626,31 +1015,66 @@ template <class ClientType>
 folly::SemiFuture<std::unique_ptr<std::vector<thrift::KvStoreAreaSummary>>>
 KvStore<ClientType>::semifuture_getKvStoreAreaSummaryInternal(
     std::set<std::string> selectAreas) {
-  folly::Promise<std::unique_ptr<std::vector<thrift::KvStoreAreaSummary>>> p;
-  auto sf = p.getSemiFuture();
-  runInEventBaseThread([this,
-                        p = std::move(p),
-                        selectAreas = std::move(selectAreas)]() mutable {
-    XLOG(INFO)
-        << "KvStore Summary requested for "
-        << (selectAreas.empty()
-                ? "all areas."
-                : fmt::format("areas: {}.", folly::join(", ", selectAreas)));
-
-    auto result = std::make_unique<std::vector<thrift::KvStoreAreaSummary>>();
-    for (auto& [area, kvStoreDb] : kvStoreDb_) {
-      thrift::KvStoreAreaSummary areaSummary;
+  XLOG(INFO)
+      << "KvStore Summary requested for "
+      << (selectAreas.empty()
+              ? "all areas."
+              : fmt::format("areas: {}.", folly::join(", ", selectAreas)));
+
+  // fan out to event base of every area and gather results
+  std::vector<folly::SemiFuture<thrift::KvStoreAreaSummary>> sfs;
+  for (auto& [area, kvStoreDb] : kvStoreDb_) {
+    auto pf = folly::makePromiseContract<thrift::KvStoreAreaSummary>();
+    getAreaEvb(area)->runInEventBaseThread(
+        [p = std::move(pf.first), area = area, &kvStoreDb]() mutable {
+          thrift::KvStoreAreaSummary areaSummary;
+
+          areaSummary.area_ref() = area;
+          auto kvDbCounters = kvStoreDb.getCounters();
+          areaSummary.keyValsCount_ref() = kvDbCounters["kvstore.num_keys"];
+          areaSummary.peersMap_ref() = kvStoreDb.dumpPeers();
+          areaSummary.keyValsBytes_ref() = kvStoreDb.getKeyValsSize();
+
+          p.setValue(std::move(areaSummary));
+        });
+    sfs.emplace_back(std::move(pf.second));
+  }
 
-      areaSummary.area_ref() = area;
-      auto kvDbCounters = kvStoreDb.getCounters();
-      areaSummary.keyValsCount_ref() = kvDbCounters["kvstore.num_keys"];
-      areaSummary.peersMap_ref() = kvStoreDb.dumpPeers();
-      areaSummary.keyValsBytes_ref() = kvStoreDb.getKeyValsSize();
+  return folly::collectAll(std::move(sfs))
+      .deferValue(
+          [](std::vector<folly::Try<thrift::KvStoreAreaSummary>>&& summaries) {
+            auto result =
+                std::make_unique<std::vector<thrift::KvStoreAreaSummary>>();
+            for (auto& summary : summaries) {
+              result->emplace_back(std::move(summary).value());
+            }
+            return result;
+          });
+}
 
-      result->emplace_back(std::move(areaSummary));
-    }
-    p.setValue(std::move(result));
-  });
+template <class ClientType>
+folly::SemiFuture<
+    std::unique_ptr<std::map<std::string, thrift::KvStoreKeyFamilyStats>>>
+KvStore<ClientType>::semifuture_getKvStoreKeyFamilyStats(std::string area) {
+  folly::Promise<
+      std::unique_ptr<std::map<std::string, thrift::KvStoreKeyFamilyStats>>>
+      p;
+  auto sf = p.getSemiFuture();
+  getAreaEvb(area)->runInEventBaseThread(
+      [this, p = std::move(p), area]() mutable {
+        XLOG(DBG3) << "Key family stats requested for AREA: " << area;
+        try {
+          auto const& stats =
+              getAreaDbOrThrow(area, "semifuture_getKvStoreKeyFamilyStats")
+                  .getKeyFamilyStats();
+          p.setValue(
+              std::make_unique<
+                  std::map<std::string, thrift::KvStoreKeyFamilyStats>>(
+                  stats.begin(), stats.end()));
+        } catch (thrift::KvStoreError const& e) {
+          p.setException(e);
+        }
+      });
   return sf;
 }
 
@@ -660,30 +1084,32 @@ KvStore<ClientType>::semifuture_addUpdateKvStorePeers(
     std::string area, thrift::PeersMap peersToAdd) {
   folly::Promise<folly::Unit> p;
   auto sf = p.getSemiFuture();
-  runInEventBaseThread([this,
-                        p = std::move(p),
-                        peersToAdd = std::move(peersToAdd),
-                        area]() mutable {
-    try {
-      auto str = folly::gen::from(peersToAdd) | folly::gen::get<0>() |
-          folly::gen::as<std::vector<std::string>>();
-
-      XLOG(INFO) << "Peer addition for: [" << folly::join(",", str)
-                 << "] in area: " << area;
-      auto& kvStoreDb =
-          getAreaDbOrThrow(area, "semifuture_addUpdateKvStorePeers");
-      if (peersToAdd.empty()) {
-        p.setException(thrift::KvStoreError(
-            "Empty peerNames from peer-add request, ignoring"));
-      } else {
-        fb303::fbData->addStatValue("kvstore.cmd_peer_add", 1, fb303::COUNT);
-        kvStoreDb.addPeers(peersToAdd);
-        p.setValue();
-      }
-    } catch (thrift::KvStoreError const& e) {
-      p.setException(e);
-    }
-  });
+  getAreaEvb(area)->runInEventBaseThread(
+      [this,
+       p = std::move(p),
+       peersToAdd = std::move(peersToAdd),
+       area]() mutable {
+        try {
+          auto str = folly::gen::from(peersToAdd) | folly::gen::get<0>() |
+              folly::gen::as<std::vector<std::string>>();
+
+          XLOG(INFO) << "Peer addition for: [" << folly::join(",", str)
+                     << "] in area: " << area;
+          auto& kvStoreDb =
+              getAreaDbOrThrow(area, "semifuture_addUpdateKvStorePeers");
+          if (peersToAdd.empty()) {
+            p.setException(thrift::KvStoreError(
+                "Empty peerNames from peer-add request, ignoring"));
+          } else {
+            fb303::fbData->addStatValue(
+                "kvstore.cmd_peer_add", 1, fb303::COUNT);
+            kvStoreDb.addPeers(peersToAdd);
+            p.setValue();
+          }
+        } catch (thrift::KvStoreError const& e) {
+          p.setException(e);
+        }
+      });
   return sf;
 }
 
@@ -693,26 +1119,28 @@ KvStore<ClientType>::semifuture_deleteKvStorePeers(
     std::string area, std::vector<std::string> peersToDel) {
   folly::Promise<folly::Unit> p;
   auto sf = p.getSemiFuture();
-  runInEventBaseThread([this,
-                        p = std::move(p),
-                        peersToDel = std::move(peersToDel),
-                        area]() mutable {
-    XLOG(INFO) << "Peer deletion for: [" << folly::join(",", peersToDel)
-               << "] in area: " << area;
-    try {
-      auto& kvStoreDb = getAreaDbOrThrow(area, "semifuture_deleteKvStorePeers");
-      if (peersToDel.empty()) {
-        p.setException(thrift::KvStoreError(
-            "Empty peerNames from peer-del request, ignoring"));
-      } else {
-        fb303::fbData->addStatValue("kvstore.cmd_per_del", 1, fb303::COUNT);
-        kvStoreDb.delPeers(peersToDel);
-        p.setValue();
-      }
-    } catch (thrift::KvStoreError const& e) {
-      p.setException(e);
-    }
-  });
+  getAreaEvb(area)->runInEventBaseThread(
+      [this,
+       p = std::move(p),
+       peersToDel = std::move(peersToDel),
+       area]() mutable {
+        XLOG(INFO) << "Peer deletion for: [" << folly::join(",", peersToDel)
+                   << "] in area: " << area;
+        try {
+          auto& kvStoreDb =
+              getAreaDbOrThrow(area, "semifuture_deleteKvStorePeers");
+          if (peersToDel.empty()) {
+            p.setException(thrift::KvStoreError(
+                "Empty peerNames from peer-del request, ignoring"));
+          } else {
+            fb303::fbData->addStatValue("kvstore.cmd_per_del", 1, fb303::COUNT);
+            kvStoreDb.delPeers(peersToDel);
+            p.setValue();
+          }
+        } catch (thrift::KvStoreError const& e) {
+          p.setException(e);
+        }
+      });
   return sf;
 }
 
@@ -721,16 +1149,17 @@ folly::SemiFuture<std::unique_ptr<thrift::SptInfos>>
 KvStore<ClientType>::semifuture_getSpanningTreeInfos(std::string area) {
   folly::Promise<std::unique_ptr<thrift::SptInfos>> p;
   auto sf = p.getSemiFuture();
-  runInEventBaseThread([this, p = std::move(p), area]() mutable {
-    XLOG(DBG3) << "FLOOD_TOPO_GET command requested for AREA: " << area;
-    try {
-      p.setValue(std::make_unique<thrift::SptInfos>(
-          getAreaDbOrThrow(area, "semifuture_getSpanningTreeInfos")
-              .processFloodTopoGet()));
-    } catch (thrift::KvStoreError const& e) {
-      p.setException(e);
-    }
-  });
+  getAreaEvb(area)->runInEventBaseThread(
+      [this, p = std::move(p), area]() mutable {
+        XLOG(DBG3) << "FLOOD_TOPO_GET command requested for AREA: " << area;
+        try {
+          p.setValue(std::make_unique<thrift::SptInfos>(
+              getAreaDbOrThrow(area, "semifuture_getSpanningTreeInfos")
+                  .processFloodTopoGet()));
+        } catch (thrift::KvStoreError const& e) {
+          p.setException(e);
+        }
+      });
   return sf;
 }
 
@@ -740,19 +1169,20 @@ KvStore<ClientType>::semifuture_updateFloodTopologyChild(
     std::string area, thrift::FloodTopoSetParams floodTopoSetParams) {
   folly::Promise<folly::Unit> p;
   auto sf = p.getSemiFuture();
-  runInEventBaseThread([this,
-                        p = std::move(p),
-                        floodTopoSetParams = std::move(floodTopoSetParams),
-                        area]() mutable {
-    XLOG(DBG2) << "FLOOD_TOPO_SET command requested for AREA: " << area;
-    try {
-      getAreaDbOrThrow(area, "semifuture_updateFloodTopologyChild")
-          .processFloodTopoSet(std::move(floodTopoSetParams));
-      p.setValue();
-    } catch (thrift::KvStoreError const& e) {
-      p.setException(e);
-    }
-  });
+  getAreaEvb(area)->runInEventBaseThread(
+      [this,
+       p = std::move(p),
+       floodTopoSetParams = std::move(floodTopoSetParams),
+       area]() mutable {
+        XLOG(DBG2) << "FLOOD_TOPO_SET command requested for AREA: " << area;
+        try {
+          getAreaDbOrThrow(area, "semifuture_updateFloodTopologyChild")
+              .processFloodTopoSet(std::move(floodTopoSetParams));
+          p.setValue();
+        } catch (thrift::KvStoreError const& e) {
+          p.setException(e);
+        }
+      });
   return sf;
 }
 
@@ -762,78 +1192,103 @@ KvStore<ClientType>::semifuture_processKvStoreDualMessage(
     std::string area, thrift::DualMessages dualMessages) {
   folly::Promise<folly::Unit> p;
   auto sf = p.getSemiFuture();
-  runInEventBaseThread([this,
-                        p = std::move(p),
-                        dualMessages = std::move(dualMessages),
-                        area]() mutable {
-    XLOG(DBG2) << "DUAL messages received for AREA: " << area;
-    try {
-      auto& kvStoreDb =
-          getAreaDbOrThrow(area, "semifuture_processKvStoreDualMessage");
-      if (dualMessages.messages_ref()->empty()) {
-        XLOG(ERR) << "Empty DUAL msg receved";
-        p.setValue();
-      } else {
-        fb303::fbData->addStatValue(
-            "kvstore.received_dual_messages", 1, fb303::COUNT);
+  getAreaEvb(area)->runInEventBaseThread(
+      [this,
+       p = std::move(p),
+       dualMessages = std::move(dualMessages),
+       area]() mutable {
+        XLOG(DBG2) << "DUAL messages received for AREA: " << area;
+        try {
+          auto& kvStoreDb =
+              getAreaDbOrThrow(area, "semifuture_processKvStoreDualMessage");
+          if (dualMessages.messages_ref()->empty()) {
+            XLOG(ERR) << "Empty DUAL msg receved";
+            p.setValue();
+          } else {
+            fb303::fbData->addStatValue(
+                "kvstore.received_dual_messages", 1, fb303::COUNT);
 
-        kvStoreDb.processDualMessages(std::move(dualMessages));
-        p.setValue();
-      }
-    } catch (thrift::KvStoreError const& e) {
-      p.setException(e);
-    }
-  });
+            kvStoreDb.processDualMessages(std::move(dualMessages));
+            p.setValue();
+          }
+        } catch (thrift::KvStoreError const& e) {
+          p.setException(e);
+        }
+      });
   return sf;
 }
 
 template <class ClientType>
 void
 KvStore<ClientType>::initialKvStoreDbSynced() {
-  for (auto& [_, kvStoreDb] : kvStoreDb_) {
-    if (not kvStoreDb.getInitialSyncedWithPeers()) {
-      return;
+  // ATTN: invoked from event base of the area. Hop over to KvStore's own event
+  //       base, which owns `initialSyncSignalSent_`.
+  getEvb()->runImmediatelyOrRunInEventBaseThread([this]() {
+    for (auto& [_, kvStoreDb] : kvStoreDb_) {
+      if (not kvStoreDb.getInitialSyncedWithPeers()) {
+        return;
+      }
     }
-  }
 
-  if (not initialSyncSignalSent_) {
-    // Publish KvStore synced signal.
-    kvParams_.kvStoreUpdatesQueue.push(
-        thrift::InitializationEvent::KVSTORE_SYNCED);
-    initialSyncSignalSent_ = true;
-    logInitializationEvent(
-        "KvStore",
-        thrift::InitializationEvent::KVSTORE_SYNCED,
-        fmt::format(
-            "KvStoreDb sync is completed in all {} areas.", kvStoreDb_.size()));
-  }
+    if (not initialSyncSignalSent_) {
+      // Publish KvStore synced signal.
+      kvParams_.kvStoreUpdatesQueue.push(
+          thrift::InitializationEvent::KVSTORE_SYNCED);
+      initialSyncSignalSent_ = true;
+      logInitializationEvent(
+          "KvStore",
+          thrift::InitializationEvent::KVSTORE_SYNCED,
+          fmt::format(
+              "KvStoreDb sync is completed in all {} areas.",
+              kvStoreDb_.size()));
+    }
+  });
 }
 
 template <class ClientType>
 folly::SemiFuture<std::map<std::string, int64_t>>
 KvStore<ClientType>::semifuture_getCounters() {
-  auto pf = folly::makePromiseContract<std::map<std::string, int64_t>>();
-  runInEventBaseThread([this, p = std::move(pf.first)]() mutable {
-    p.setValue(getGlobalCounters());
-  });
-  return std::move(pf.second);
+  return getGlobalCounters();
 }
 
 template <class ClientType>
-std::map<std::string, int64_t>
-KvStore<ClientType>::getGlobalCounters() const {
-  std::map<std::string, int64_t> flatCounters;
-  for (auto& [_, kvDb] : kvStoreDb_) {
-    auto kvDbCounters = kvDb.getCounters();
-    // add up counters for same key from all kvStoreDb instances
-    std::for_each(
-        kvDbCounters.begin(),
-        kvDbCounters.end(),
-        [&](const std::pair<const std::string, int64_t>& kvDbCounter) {
-          flatCounters[kvDbCounter.first] += kvDbCounter.second;
+folly::SemiFuture<std::map<std::string, int64_t>>
+KvStore<ClientType>::getGlobalCounters() {
+  // fan out to event base of every area and gather counters
+  std::vector<folly::SemiFuture<std::map<std::string, int64_t>>> sfs;
+  for (auto& [area, kvDb] : kvStoreDb_) {
+    auto* areaEvb = getAreaEvb(area);
+    auto pf = folly::makePromiseContract<std::map<std::string, int64_t>>();
+    areaEvb->runInEventBaseThread(
+        [p = std::move(pf.first),
+         area = area,
+         &kvDb = kvDb,
+         areaEvb]() mutable {
+          auto kvDbCounters = kvDb.getCounters();
+          // pending events on the event base serving the area
+          kvDbCounters[fmt::format("kvstore.evb_queue_depth.{}", area)] =
+              areaEvb->getEvb()->getNotificationQueueSize();
+          p.setValue(std::move(kvDbCounters));
         });
+    sfs.emplace_back(std::move(pf.second));
   }
-  return flatCounters;
+
+  return folly::collectAll(std::move(sfs))
+      .deferValue(
+          [](std::vector<folly::Try<std::map<std::string, int64_t>>>&&
+                 results) {
+            // add up counters for same key from all kvStoreDb instances
+            std::map<std::string, int64_t> flatCounters;
+            for (auto& kvDbCounters : results) {
+              if (not kvDbCounters.hasValue()) {
+                continue;
+              }
+              for (auto const& [key, val] : kvDbCounters.value()) {
+                flatCounters[key] += val;
+              }
+            }
+            return flatCounters;
+          });
 }
 
 template <class ClientType>
@@ -902,6 +1357,10 @@ KvStore<ClientType>::initGlobalCounters() {
   // Initialize stats keys
   // TODO: evaluate if expired_key_vals num is in use
   fb303::fbData->addStatExportType("kvstore.expired_key_vals", fb303::SUM);
+  fb303::fbData->addStatExportType(
+      "kvstore.ttl_countdown.expired_keys", fb303::SUM);
+  fb303::fbData->addStatExportType(
+      "kvstore.ttl_countdown.refreshed_keys", fb303::SUM);
 
   fb303::fbData->addStatExportType("kvstore.rate_limit_keys", fb303::AVG);
   fb303::fbData->addStatExportType("kvstore.rate_limit_suppress", fb303::COUNT);
@@ -1140,7 +1599,6 @@ KvStoreDb<ClientType>::KvStoreDb(
     OpenrEventBase* evb,
     KvStoreParams& kvParams,
     const std::string& area,
-    fbzmq::Socket<ZMQ_ROUTER, fbzmq::ZMQ_CLIENT> peerSyncSock,
     bool isFloodRoot,
     const std::string& nodeId,
     std::function<void()> initialKvStoreSyncedCallback)
@@ -1148,21 +1606,51 @@ KvStoreDb<ClientType>::KvStoreDb(
       kvParams_(kvParams),
       area_(area),
       areaTag_(fmt::format("[Area {}] ", area)),
-      peerSyncSock_(std::move(peerSyncSock)),
+      kvStore_(kvParams.numKeyShards),
       initialKvStoreSyncedCallback_(initialKvStoreSyncedCallback),
       evb_(evb) {
+  peerRpcOptions_.setPriority(apache::thrift::concurrency::HIGH);
+  if (kvParams_.enableMerkleSync) {
+    merkleTree_.emplace(Constants::kKvStoreMerkleTreeDepth);
+  }
+  if (kvStore_.numShards() > 1) {
+    mergeExecutor_ = std::make_unique<folly::CPUThreadPoolExecutor>(
+        kvStore_.numShards(),
+        std::make_shared<folly::NamedThreadFactory>("KvStoreMerge"));
+  }
   if (kvParams_.floodRate) {
-    floodLimiter_ = std::make_unique<folly::BasicTokenBucket<>>(
-        *kvParams_.floodRate->flood_msg_per_sec_ref(),
-        *kvParams_.floodRate->flood_msg_burst_size_ref());
+    floodHighPriorityKeyPrefixes_ =
+        kvParams_.floodRate->high_priority_key_prefixes_ref().value_or(
+            std::vector<std::string>{Constants::kAdjDbMarker.toString()});
+    for (size_t i = 0; i < kNumFloodPriorities; ++i) {
+      floodLimiters_.at(i) = std::make_unique<folly::BasicTokenBucket<>>(
+          *kvParams_.floodRate->flood_msg_per_sec_ref(),
+          *kvParams_.floodRate->flood_msg_burst_size_ref());
+      const auto queueDelayKey = fmt::format(
+          "kvstore.flood_priority.{}.queue_delay_ms",
+          getFloodPriorityName(static_cast<FloodPriority>(i)));
+      fb303::fbData->addHistogram(
+          queueDelayKey, 10 /* bucket width */, 0 /* min */, 1000 /* max */);
+      fb303::fbData->exportHistogramPercentile(queueDelayKey, 50, 95, 99);
+    }
     pendingPublicationTimer_ =
         folly::AsyncTimeout::make(*evb_->getEvb(), [this]() noexcept {
-          if (!floodLimiter_->consume(1)) {
+          // flush buffers in priority order as long as tokens are available
+          bool hasPending{false};
+          for (size_t i = 0; i < kNumFloodPriorities; ++i) {
+            if (publicationBuffers_.at(i).keys.empty()) {
+              continue;
+            }
+            if (!floodLimiters_.at(i)->consume(1)) {
+              hasPending = true;
+              continue;
+            }
+            floodBufferedUpdates(static_cast<FloodPriority>(i));
+          }
+          if (hasPending) {
             pendingPublicationTimer_->scheduleTimeout(
                 Constants::kFloodPendingPublication);
-            return;
           }
-          floodBufferedUpdates();
         });
   }
 
@@ -1170,17 +1658,10 @@ KvStoreDb<ClientType>::KvStoreDb(
       << AreaTag()
       << fmt::format("Starting kvstore DB instance for node: {}", nodeId);
 
-  // Create a fiber task to periodically dump flooding topology.
-  evb_->addFiberTask([this]() mutable noexcept { floodTopoDumpTask(); });
-
-  // Create a fiber task to periodically check adj key ttl.
-  evb_->addFiberTask([this]() mutable noexcept { checkKeyTtlTask(); });
-
-  if (kvParams_.enableFloodOptimization) {
-    // [TO BE DEPRECATED]
-    // Attach socket callbacks/schedule events
-    attachCallbacks();
-  }
+  // Dump flooding topology upon DUAL state and peer changes. The actual
+  // scheduling happens within scheduleFloodTopoDump()
+  floodTopoDumpTimer_ = folly::AsyncTimeout::make(
+      *evb_->getEvb(), [this]() noexcept { floodTopoDump(); });
 
   // Perform full-sync if there are peers to sync with.
   thriftSyncTimer_ = folly::AsyncTimeout::make(
@@ -1194,6 +1675,11 @@ KvStoreDb<ClientType>::KvStoreDb(
   // Create ttl timer for refreshing ttls of self-originated key-vals
   selfOriginatedKeyTtlTimer_ = folly::AsyncTimeout::make(
       *evb_->getEvb(), [this]() noexcept { advertiseTtlUpdates(); });
+  ttlRefreshBatchWindow_ = std::max(
+      std::chrono::milliseconds(1),
+      std::min(Constants::kTtlRefreshBatchWindow, kvParams_.keyTtl / 16));
+  ttlRefreshBatchPhase_ = std::chrono::milliseconds(
+      folly::Random::rand64(ttlRefreshBatchWindow_.count()));
 
   // Create timer to advertise pending key-vals
   advertiseKeyValsTimer_ =
@@ -1237,10 +1723,38 @@ KvStoreDb<ClientType>::KvStoreDb(
       "kvstore.received_key_vals." + area, fb303::SUM);
   fb303::fbData->addStatExportType(
       "kvstore.received_publications." + area, fb303::COUNT);
-  fb303::fbData->addStatExportType(
-      "kvstore.num_expiring_keys." + area, fb303::SUM);
-  fb303::fbData->addStatExportType(
-      "kvstore.num_flood_peers." + area, fb303::SUM);
+  fb303::fbData->setCounter("kvstore.num_expiring_keys." + area, 0);
+  fb303::fbData->setCounter("kvstore.num_flood_peers." + area, 0);
+
+  // [Warm Restart Snapshot]
+  // ATTN: load within event base, so that nothing else is processed before.
+  if (kvParams_.snapshotDir.has_value()) {
+    evb_->getEvb()->runInEventBaseThread([this]() noexcept { loadSnapshot(); });
+    snapshotTimer_ =
+        folly::AsyncTimeout::make(*evb_->getEvb(), [this]() noexcept {
+          persistSnapshot();
+          snapshotTimer_->scheduleTimeout(kvParams_.snapshotInterval);
+        });
+    snapshotTimer_->scheduleTimeout(kvParams_.snapshotInterval);
+  }
+
+  // [Flood Digest]
+  // DUAL already floods over a spanning tree, no duplicates to suppress
+  if (kvParams_.enableFloodDigest and not kvParams_.enableFloodOptimization) {
+    floodDigestTimer_ =
+        folly::AsyncTimeout::make(*evb_->getEvb(), [this]() noexcept {
+          advertiseFloodDigest();
+          floodDigestTimer_->scheduleTimeout(
+              Constants::kKvStoreFloodDigestInterval);
+        });
+    floodDigestTimer_->scheduleTimeout(Constants::kKvStoreFloodDigestInterval);
+  }
+
+  // [Flood Batching]
+  if (kvParams_.floodBatch.has_value()) {
+    floodBatchTimer_ = folly::AsyncTimeout::make(
+        *evb_->getEvb(), [this]() noexcept { floodBatchedUpdates(); });
+  }
 }
 
 template <class ClientType>
@@ -1248,10 +1762,6 @@ void
 KvStoreDb<ClientType>::stop() {
   XLOG(INFO) << AreaTag() << "Terminating KvStoreDb.";
 
-  // Send stop signal for internal fibers
-  floodTopoStopSignal_.post();
-  ttlCheckStopSignal_.post();
-
   evb_->getEvb()->runImmediatelyOrRunInEventBaseThreadAndWait([this]() {
     // Destroy thrift clients associated with peers, which will
     // fulfill promises with exceptions if any.
@@ -1261,34 +1771,26 @@ KvStoreDb<ClientType>::stop() {
     selfOriginatedTtlUpdatesThrottled_.reset();
     unsetSelfOriginatedKeysThrottled_.reset();
     advertiseSelfOriginatedKeysThrottled_.reset();
+    floodDigestTimer_.reset();
+    floodBatchTimer_.reset();
+    floodTopoDumpTimer_.reset();
+    if (snapshotTimer_) {
+      // persist latest snapshot for next start
+      snapshotTimer_.reset();
+      persistSnapshot();
+    }
     XLOG(INFO) << AreaTag() << "Successfully destroyed thriftPeers and timers";
   });
 
-  // remove ZMQ socket
-  if (kvParams_.enableFloodOptimization) {
-    evb_->removeSocket(fbzmq::RawZmqSocketPtr{*peerSyncSock_});
-  }
-
   XLOG(INFO) << AreaTag() << "Successfully stopped KvStoreDb.";
 }
 
 template <class ClientType>
 void
-KvStoreDb<ClientType>::floodTopoDumpTask() noexcept {
-  XLOG(INFO) << AreaTag() << "Starting flood-topo dump fiber task";
-
-  while (true) { // Break when stop signal is ready
-    // Sleep before next check
-    // ATTN: sleep first to avoid empty peers when KvStoreDb initially starts.
-    if (floodTopoStopSignal_.try_wait_for(Constants::kFloodTopoDumpInterval)) {
-      break; // Baton was posted
-    } else {
-      floodTopoStopSignal_.reset(); // Baton experienced timeout
-    }
-    floodTopoDump();
-  } // while
-
-  XLOG(INFO) << AreaTag() << "Flood-topo dump fiber task got stopped.";
+KvStoreDb<ClientType>::scheduleFloodTopoDump() noexcept {
+  if (floodTopoDumpTimer_ and not floodTopoDumpTimer_->isScheduled()) {
+    floodTopoDumpTimer_->scheduleTimeout(std::chrono::milliseconds(0));
+  }
 }
 
 template <class ClientType>
@@ -1296,6 +1798,11 @@ void
 KvStoreDb<ClientType>::floodTopoDump() noexcept {
   const auto floodRootId = DualNode::getSptRootId();
   const auto& floodPeers = getFloodPeers(floodRootId);
+  auto floodTopo = std::make_pair(
+      floodRootId, std::set<std::string>(floodPeers.begin(), floodPeers.end()));
+  if (lastFloodTopo_ == floodTopo) {
+    return;
+  }
 
   XLOG(INFO)
       << AreaTag()
@@ -1303,68 +1810,50 @@ KvStoreDb<ClientType>::floodTopoDump() noexcept {
              "[Flood Topo] NodeId: {}, SptRootId: {}, flooding peers: [{}]",
              kvParams_.nodeId,
              floodRootId.has_value() ? floodRootId.value() : "NA",
-             folly::join(",", floodPeers));
+             folly::join(",", floodTopo.second));
 
   // Expose number of flood peers into ODS counter
-  fb303::fbData->addStatValue(
-      "kvstore.num_flood_peers." + area_, floodPeers.size(), fb303::SUM);
+  fb303::fbData->setCounter(
+      "kvstore.num_flood_peers." + area_, floodPeers.size());
+  lastFloodTopo_ = std::move(floodTopo);
 }
 
 template <class ClientType>
 void
-KvStoreDb<ClientType>::checkKeyTtlTask() noexcept {
-  XLOG(INFO) << AreaTag() << "Starting adj key ttl-check fiber task";
-
-  while (true) { // Break when stop signal is ready
-    // Sleep before next check
-    // ATTN: sleep first to avoid empty peers when KvStoreDb initially starts.
-    if (ttlCheckStopSignal_.try_wait_for(
-            5 * Constants::kFloodTopoDumpInterval)) {
-      break; // Baton was posted
-    } else {
-      ttlCheckStopSignal_.reset(); // Baton experienced timeout
-    }
-    checkKeyTtl();
-  } // while
-
-  XLOG(INFO) << AreaTag() << "Adj key ttl-check fiber task got stopped.";
+KvStoreDb<ClientType>::checkKeyTtl(
+    std::string const& key, thrift::Value const& value) {
+  // TODO: now the key match is hardcoded to match `adj:` key ONLY
+  // and can be extended to serve ANY key matching from config
+  if (not folly::StringPiece(key).startsWith(Constants::kAdjDbMarker)) {
+    return;
+  }
+  // ATTN: ttl is refreshed every keyTtl.count() / 4 by default. Ttl merged
+  // below the threshold of 1/2 keyTtl indicates that the ttl-refreshing sent
+  // from peer on timstamp of {3/4, 1/2} keyTtl are NOT received. Merged ttl
+  // is kept as is until next merge, so checking it upon merge is enough.
+  if (*value.ttl_ref() < kvParams_.keyTtl.count() / 2) {
+    expiringKeys_.emplace(key);
+  } else {
+    expiringKeys_.erase(key);
+  }
 }
 
 template <class ClientType>
 void
-KvStoreDb<ClientType>::checkKeyTtl() noexcept {
-  // total number of unexpected keys below ttl alert threshold
-  auto cnt{0};
-
-  // TODO: now the key regex is hardcoded to match `adj:` key ONLY
-  // and can be extended to serve ANY key matching from config
-  KvStoreFilters filter{
-      {Constants::kAdjDbMarker.toString()}, /* key regex match */
-      {}, /* originator match */
-      thrift::FilterOperator::OR /* matching type */};
-
-  for (auto const& [k, v] : kvStore_) {
-    if (not filter.keyMatch(k, v)) {
-      continue;
-    }
-    // ATTN: ttl is refreshed every keyTtl.count() / 4 by default.
-    // Increment the counter if the following condition fulfilled:
-    //
-    // 1. If keyTtl.count() is below the threshold of 1/2 keyTtl, this
-    // indicates that the ttl-refreshing sent from peer on timstamp of
-    // {3/4, 1/2} keyTtl are NOT received;
-    //
-    // 2. If the originator of this adj key is still connected to KvStore,
-    // this is a strong signal that flooding topo is in bad state;
-    if (*v.ttl_ref() < kvParams_.keyTtl.count() / 2 and
-        thriftPeers_.count(*v.originatorId_ref())) {
+KvStoreDb<ClientType>::reportExpiringKeys() noexcept {
+  // If the originator of an adj key under threshold is still connected to
+  // KvStore, this is a strong signal that flooding topo is in bad state
+  size_t cnt{0};
+  for (auto const& key : expiringKeys_) {
+    auto it = kvStore_.find(key);
+    if (it != kvStore_.end() and
+        thriftPeers_.count(*it->second.originatorId_ref())) {
       cnt += 1;
     }
   }
 
   // Expose number of about-to-expire adj keys into ODS counter
-  fb303::fbData->addStatValue(
-      "kvstore.num_expiring_keys." + area_, cnt, fb303::SUM);
+  fb303::fbData->setCounter("kvstore.num_expiring_keys." + area_, cnt);
 }
 
 template <class ClientType>
@@ -1412,7 +1901,9 @@ KvStoreDb<ClientType>::setSelfOriginatedKey(
 template <class ClientType>
 void
 KvStoreDb<ClientType>::persistSelfOriginatedKey(
-    std::string const& key, std::string const& value) {
+    std::string const& key,
+    std::string const& value,
+    std::vector<int64_t> const& traceIds) {
   XLOG(DBG3) << AreaTag()
              << fmt::format("{} called for key: {}", __FUNCTION__, key);
 
@@ -1430,8 +1921,13 @@ KvStoreDb<ClientType>::persistSelfOriginatedKey(
   //  4. ttl - [DONE] - kvParams_.keyTtl.count()
   //  5. ttlVersion - [NOT FILLED] - empty
   //  6. hash - [OPTIONAL] - empty
-  thrift::Value thriftValue =
-      createThriftValue(0, nodeId, value, kvParams_.keyTtl.count());
+  thrift::Value thriftValue = createThriftValue(
+      0 /* version */,
+      nodeId,
+      value,
+      kvParams_.keyTtl.count(),
+      0 /* ttl version */,
+      0 /* hash, computed on setKeyVals */);
   CHECK(thriftValue.value_ref());
 
   // Two cases for this particular (k, v) pair:
@@ -1501,6 +1997,12 @@ KvStoreDb<ClientType>::persistSelfOriginatedKey(
   // Add keys to list of pending keys
   if (shouldAdvertise) {
     keysToAdvertise_.insert(key);
+    auto& keyTraceIds = keysToAdvertiseTraceIds_[key];
+    for (const auto traceId : traceIds) {
+      if (keyTraceIds.size() < ConvergenceTracer::kMaxTraceIds) {
+        keyTraceIds.emplace_back(traceId);
+      }
+    }
   }
 
   // Throttled advertisement of pending keys
@@ -1563,6 +2065,13 @@ KvStoreDb<ClientType>::advertiseSelfOriginatedKeys() {
   // clear out variable used for batching advertisements
   for (auto const& key : keysToClear) {
     keysToAdvertise_.erase(key);
+    if (auto it = keysToAdvertiseTraceIds_.find(key);
+        it != keysToAdvertiseTraceIds_.end()) {
+      for (const auto traceId : it->second) {
+        ConvergenceTracer::record(traceId, "KVSTORE_FLOODED");
+      }
+      keysToAdvertiseTraceIds_.erase(it);
+    }
   }
 
   // Schedule next-timeout for processing/clearing backoffs
@@ -1606,6 +2115,7 @@ KvStoreDb<ClientType>::eraseSelfOriginatedKey(std::string const& key) {
              << fmt::format("{} called for key: {}", __FUNCTION__, key);
   selfOriginatedKeyVals_.erase(key);
   keysToAdvertise_.erase(key);
+  keysToAdvertiseTraceIds_.erase(key);
 }
 
 template <class ClientType>
@@ -1691,10 +2201,12 @@ KvStoreDb<ClientType>::advertiseTtlUpdates() {
   for (auto& [key, val] : selfOriginatedKeyVals_) {
     auto& thriftValue = val.value;
     auto& backoff = val.ttlBackoff;
-    if (not backoff.canTryNow()) {
+    // [TTL Refresh Batching] refresh keys due within this window early
+    const auto timeRemaining = backoff.getTimeRemainingUntilRetry();
+    if (timeRemaining > ttlRefreshBatchWindow_) {
       XLOG(DBG2) << AreaTag() << fmt::format("Skipping key: {}", key);
 
-      timeout = std::min(timeout, backoff.getTimeRemainingUntilRetry());
+      timeout = std::min(timeout, timeRemaining);
       continue;
     }
 
@@ -1727,12 +2239,15 @@ KvStoreDb<ClientType>::advertiseTtlUpdates() {
 
   // Advertise to KvStore
   if (not keyVals.empty()) {
+    fb303::fbData->addStatValue(
+        "kvstore.ttl_refresh.batch_size", keyVals.size(), fb303::AVG);
     thrift::KeySetParams params;
     params.keyVals_ref() = std::move(keyVals);
     setKeyVals(std::move(params));
   }
 
   // Schedule next-timeout for processing/clearing backoffs
+  timeout = getTtlRefreshBatchTimeout(timeout);
   XLOG(DBG2)
       << AreaTag()
       << fmt::format("Scheduling ttl timer after {}ms.", timeout.count());
@@ -1740,94 +2255,677 @@ KvStoreDb<ClientType>::advertiseTtlUpdates() {
   selfOriginatedKeyTtlTimer_->scheduleTimeout(timeout);
 }
 
+template <class ClientType>
+std::chrono::milliseconds
+KvStoreDb<ClientType>::getTtlRefreshBatchTimeout(
+    std::chrono::milliseconds timeout) const {
+  // ATTN: nothing to align if no key-val is ttl-refreshed
+  if (timeout >= Constants::kMaxTtlUpdateInterval) {
+    return timeout;
+  }
+  const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now().time_since_epoch());
+  const auto window = ttlRefreshBatchWindow_.count();
+  const auto fireTime = (now + timeout - ttlRefreshBatchPhase_).count();
+  // round up to window boundary
+  const auto alignedTime = ((fireTime + window - 1) / window) * window;
+  return std::chrono::milliseconds(alignedTime) + ttlRefreshBatchPhase_ - now;
+}
+
+template <class ClientType>
+void
+KvStoreDb<ClientType>::setKeyVals(thrift::KeySetParams&& setParams) {
+  // Update statistics
+  fb303::fbData->addStatValue("kvstore.cmd_key_set", 1, fb303::COUNT);
+
+  // [Flood Digest]
+  // record digest of key-vals peer has recently merged
+  if (setParams.floodDigest_ref().has_value() and
+      setParams.senderId_ref().has_value()) {
+    auto peerIt = thriftPeers_.find(*setParams.senderId_ref());
+    if (peerIt != thriftPeers_.end()) {
+      peerIt->second.floodDigest = std::move(*setParams.floodDigest_ref());
+      peerIt->second.floodDigestTime = std::chrono::steady_clock::now();
+    }
+    if (setParams.keyVals_ref()->empty()) {
+      return;
+    }
+  }
+
+  // Update hash for key-values. This is the ONLY place a value gets hashed
+  // by KvStore, the hash is carried along with the value afterwards.
+  const auto hashScheme = getHashScheme();
+  for (auto& [_, value] : *setParams.keyVals_ref()) {
+    if (value.value_ref().has_value()) {
+      value.hash_ref() = generateHash(
+          *value.version_ref(),
+          *value.originatorId_ref(),
+          value.value_ref(),
+          hashScheme);
+    }
+  }
+
+  // Create publication and merge it with local KvStore
+  thrift::Publication rcvdPublication;
+  rcvdPublication.keyVals_ref() = std::move(*setParams.keyVals_ref());
+  rcvdPublication.nodeIds_ref().move_from(setParams.nodeIds_ref());
+  rcvdPublication.floodRootId_ref().move_from(setParams.floodRootId_ref());
+  mergePublication(rcvdPublication);
+}
+
+template <class ClientType>
+std::unordered_map<std::string, thrift::Value>
+KvStoreDb<ClientType>::mergeKeyValsIntoShards(
+    std::unordered_map<std::string, thrift::Value> const& keyVals) {
+  if (not mergeExecutor_ or
+      keyVals.size() < Constants::kKvStoreShardedMergeMinKeys) {
+    return mergeKeyValues(kvStore_, keyVals, kvParams_.filters).first;
+  }
+
+  // split once, so that every worker only visits key-vals of its own shard.
+  // Slices and filters are shared read-only.
+  auto const slices = splitKeyValuesByShard(kvStore_, keyVals);
+  std::vector<folly::Future<std::unordered_map<std::string, thrift::Value>>>
+      futures;
+  for (size_t shardIdx = 0; shardIdx < kvStore_.numShards(); ++shardIdx) {
+    if (slices.at(shardIdx).empty()) {
+      continue;
+    }
+    futures.emplace_back(
+        folly::via(mergeExecutor_.get(), [this, &slices, shardIdx]() {
+          return mergeKeyValuesIntoShard(
+                     kvStore_, shardIdx, slices.at(shardIdx), kvParams_.filters)
+              .first;
+        }));
+  }
+  auto shardKeyVals = folly::collect(std::move(futures)).get();
+
+  auto mergedKeyVals = std::move(shardKeyVals.at(0));
+  for (size_t shardIdx = 1; shardIdx < shardKeyVals.size(); ++shardIdx) {
+    mergedKeyVals.merge(shardKeyVals.at(shardIdx));
+  }
+  fb303::fbData->addStatValue("kvstore.sharded_merges", 1, fb303::COUNT);
+  return mergedKeyVals;
+}
+
+template <class ClientType>
+void
+KvStoreDb<ClientType>::updateTtlCountdownQueue(
+    const thrift::Publication& publication) {
+  size_t numRefreshedKeys{0};
+  const auto now = std::chrono::steady_clock::now();
+  for (const auto& [key, value] : *publication.keyVals_ref()) {
+    if (*value.ttl_ref() == Constants::kTtlInfinity) {
+      // key no longer expires, drop previous countdown if any
+      ttlCountdownQueue_.erase(key);
+      continue;
+    }
+
+    TtlCountdownQueueEntry queueEntry;
+    queueEntry.expiryTime = now + std::chrono::milliseconds(*value.ttl_ref());
+    queueEntry.key = key;
+    queueEntry.version = *value.version_ref();
+    queueEntry.ttlVersion = *value.ttlVersion_ref();
+    queueEntry.originatorId = *value.originatorId_ref();
+
+    if (ttlCountdownQueue_.find(key)) {
+      ++numRefreshedKeys;
+    }
+
+    // Update entry in place, no stale entry is left behind
+    const auto dueTime = ttlCountdownQueue_.upsert(std::move(queueEntry));
+    if (ttlCountdownTimer_ and
+        (not ttlCountdownTimerExpiry_.has_value() or
+         dueTime < *ttlCountdownTimerExpiry_)) {
+      // Reschedule the shorter timeout
+      scheduleTtlCountdownTimer(dueTime, now);
+    }
+  }
+
+  if (numRefreshedKeys) {
+    fb303::fbData->addStatValue(
+        "kvstore.ttl_countdown.refreshed_keys", numRefreshedKeys, fb303::SUM);
+  }
+}
+
+template <class ClientType>
+thrift::KvStoreHashScheme
+KvStoreDb<ClientType>::getHashScheme() const {
+  if (not kvParams_.enableFastValueHash) {
+    return thrift::KvStoreHashScheme::BOOST_HASH_COMBINE;
+  }
+  for (auto const& [_, peer] : thriftPeers_) {
+    if (peer.hashScheme != thrift::KvStoreHashScheme::SPOOKY_V2) {
+      return thrift::KvStoreHashScheme::BOOST_HASH_COMBINE;
+    }
+  }
+  return thrift::KvStoreHashScheme::SPOOKY_V2;
+}
+
+template <class ClientType>
+void
+KvStoreDb<ClientType>::scheduleTtlCountdownTimer(
+    std::chrono::steady_clock::time_point dueTime,
+    std::chrono::steady_clock::time_point now) {
+  ttlCountdownTimerExpiry_ = dueTime;
+  ttlCountdownTimer_->scheduleTimeout(std::max(
+      std::chrono::milliseconds(0),
+      std::chrono::ceil<std::chrono::milliseconds>(dueTime - now)));
+}
+
+// loop through all key/vals and count the size of KvStoreDB (per area)
+template <class ClientType>
+size_t
+KvStoreDb<ClientType>::getKeyValsSize() const {
+  size_t size = 0;
+  if (kvStore_.empty()) {
+    return size;
+  }
+  // calculate total of struct members with fixed size once at the beginning
+  size_t fixed_size =
+      kvStore_.size() * (sizeof(std::string) + sizeof(thrift::Value));
+
+  // loop through all key/vals and add size of each KV entry
+  for (auto const& [key, value] : kvStore_) {
+    size += key.size() + value.originatorId_ref()->size() +
+        value.value_ref()->size();
+  }
+  size += fixed_size;
+
+  return size;
+}
+
+template <class ClientType>
+thrift::KvStoreKeyFamilyStats&
+KvStoreDb<ClientType>::getKeyFamilyStatsOfKey(std::string const& key) {
+  auto family = getKeyFamily(key);
+  auto it = keyFamilyStats_.find(family);
+  if (it != keyFamilyStats_.end()) {
+    return it->second;
+  }
+  // bound number of families, e.g. app keys without common prefix
+  if (keyFamilyStats_.size() >= Constants::kKvStoreMaxKeyFamilies) {
+    family = Constants::kKvStoreKeyFamilyOther.toString();
+  }
+  return keyFamilyStats_[family];
+}
+
+template <class ClientType>
+void
+KvStoreDb<ClientType>::addKeyFamilyStats(
+    std::string const& key,
+    thrift::Value const& value,
+    std::optional<int64_t> oldBytes) {
+  auto& stats = getKeyFamilyStatsOfKey(key);
+  if (not oldBytes.has_value()) {
+    *stats.numKeys_ref() += 1;
+  }
+  *stats.numBytes_ref() += getKeyValBytes(key, value) - oldBytes.value_or(0);
+  *stats.numUpdates_ref() += 1;
+}
+
+template <class ClientType>
+void
+KvStoreDb<ClientType>::removeKeyFamilyStats(
+    std::string const& key, thrift::Value const& value) {
+  auto& stats = getKeyFamilyStatsOfKey(key);
+  *stats.numKeys_ref() -= 1;
+  *stats.numBytes_ref() -= getKeyValBytes(key, value);
+}
+
+// build publication out of the requested keys (per request)
+// if not keys provided, will return publication with empty keyVals
+template <class ClientType>
+thrift::Publication
+KvStoreDb<ClientType>::getKeyVals(std::vector<std::string> const& keys) {
+  thrift::Publication thriftPub;
+  thriftPub.area_ref() = area_;
+
+  for (auto const& key : keys) {
+    // if requested key if found, respond with version and value
+    auto it = kvStore_.find(key);
+    if (it != kvStore_.end()) {
+      // copy here
+      thriftPub.keyVals_ref()[key] = it->second;
+    }
+  }
+  return thriftPub;
+}
+
+template <class ClientType>
+std::shared_ptr<const thrift::Publication>
+KvStoreDb<ClientType>::dumpHashes(
+    std::vector<std::string> const& keyPrefixList) {
+  if (auto it = hashDumpCache_.find(keyPrefixList);
+      it != hashDumpCache_.end()) {
+    fb303::fbData->addStatValue(
+        "kvstore.hash_dump_cache.num_hits", 1, fb303::COUNT);
+    return it->second;
+  }
+
+  fb303::fbData->addStatValue(
+      "kvstore.hash_dump_cache.num_misses", 1, fb303::COUNT);
+  KvStoreFilters kvFilters{keyPrefixList, std::set<std::string>{}};
+  auto thriftPub = std::make_shared<const thrift::Publication>(
+      dumpHashWithFilters(area_, kvStore_, kvFilters));
+
+  // bound memory held by distinct filters of polling clients
+  if (hashDumpCache_.size() >= Constants::kKvStoreHashDumpCacheMaxEntries) {
+    hashDumpCache_.clear();
+  }
+  hashDumpCache_.emplace(keyPrefixList, thriftPub);
+  return thriftPub;
+}
+
+template <class ClientType>
+std::shared_ptr<const KvStoreDumpSnapshot>
+KvStoreDb<ClientType>::getDumpSnapshot() {
+  if (dumpSnapshot_ and dumpSnapshot_->seqNum == publicationSeqNum_) {
+    fb303::fbData->addStatValue(
+        "kvstore.dump_snapshot.num_hits", 1, fb303::COUNT);
+    return dumpSnapshot_;
+  }
+
+  fb303::fbData->addStatValue(
+      "kvstore.dump_snapshot.num_misses", 1, fb303::COUNT);
+  const auto startTime = std::chrono::steady_clock::now();
+  thrift::Publication pub;
+  pub.keyVals_ref()->reserve(kvStore_.size());
+  pub.keyVals_ref()->insert(kvStore_.begin(), kvStore_.end());
+  // remaining ttl, same as regular dump
+  updatePublicationTtl(ttlCountdownQueue_, kvParams_.ttlDecr, pub);
+
+  auto dumpSnapshot = std::make_shared<KvStoreDumpSnapshot>();
+  dumpSnapshot->seqNum = publicationSeqNum_;
+  dumpSnapshot->snapshot.area_ref() = area_;
+  dumpSnapshot->snapshot.timestamp_ms_ref() = getUnixTimeStampMs();
+  dumpSnapshot->snapshot.keyVals_ref() = std::move(*pub.keyVals_ref());
+  dumpSnapshot_ = std::move(dumpSnapshot);
+
+  const auto timeDelta = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - startTime);
+  fb303::fbData->addStatValue(
+      "kvstore.dump_snapshot.duration_us", timeDelta.count(), fb303::AVG);
+  return dumpSnapshot_;
+}
+
+template <class ClientType>
+void
+KvStoreDb<ClientType>::publishToLocalSubscribers(
+    thrift::Publication publication) {
+  publication.seqNum_ref() = ++publicationSeqNum_;
+  kvParams_.kvStoreUpdatesQueue.push(std::move(publication));
+}
+
+template <class ClientType>
+thrift::Publication
+KvStoreDb<ClientType>::dumpDifferingBuckets(
+    std::vector<int32_t> const& differingBuckets) const {
+  thrift::Publication thriftPub;
+  thriftPub.area_ref() = area_;
+  thriftPub.differingBuckets_ref() = differingBuckets;
+
+  if (differingBuckets.empty()) {
+    // root digest matches, nothing to send
+    return thriftPub;
+  }
+
+  CHECK(merkleTree_.has_value());
+  std::vector<bool> isDiffering(merkleTree_->getNumBuckets(), false);
+  for (auto const& bucket : differingBuckets) {
+    isDiffering.at(bucket) = true;
+  }
+  for (auto const& [key, val] : kvStore_) {
+    if (isDiffering[merkleTree_->getBucket(key)]) {
+      thriftPub.keyVals_ref()->emplace(key, val);
+    }
+  }
+  return thriftPub;
+}
+
+template <class ClientType>
+void
+KvStoreDb<ClientType>::removeUnverifiedKeys(thrift::Publication& pub) const {
+  if (unverifiedKeys_.empty()) {
+    return;
+  }
+  for (auto const& key : unverifiedKeys_) {
+    pub.keyVals_ref()->erase(key);
+  }
+}
+
+template <class ClientType>
+void
+KvStoreDb<ClientType>::loadSnapshot() {
+  const auto startTime = std::chrono::steady_clock::now();
+  const auto filePath = getKvStoreSnapshotPath(*kvParams_.snapshotDir, area_);
+  auto snapshot = readKvStoreSnapshot(filePath);
+  if (not snapshot.has_value()) {
+    return;
+  }
+  if (*snapshot->area_ref() != area_) {
+    XLOG(WARNING) << AreaTag() << "[Snapshot] Ignore snapshot " << filePath
+                  << " of area: " << *snapshot->area_ref();
+    return;
+  }
+
+  // self-originated keys are re-originated by their owner after restart
+  updateSnapshotTtl(*snapshot, getUnixTimeStampMs(), kvParams_.ttlDecr);
+  auto& keyVals = *snapshot->keyVals_ref();
+  for (auto it = keyVals.begin(); it != keyVals.end();) {
+    if (*it->second.originatorId_ref() == kvParams_.nodeId) {
+      it = keyVals.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  thrift::Publication publication;
+  publication.keyVals_ref() = mergeKeyValsIntoShards(keyVals);
+  publication.area_ref() = area_;
+  hashDumpCache_.clear();
+  dumpSnapshot_.reset();
+  for (auto const& [key, _] : *publication.keyVals_ref()) {
+    auto it = kvStore_.find(key);
+    if (it == kvStore_.end()) {
+      continue;
+    }
+    keyIndex_.upsert(key, *it->second.originatorId_ref());
+    if (merkleTree_) {
+      merkleTree_->add(key, it->second);
+    }
+    addKeyFamilyStats(key, it->second, std::nullopt /* new key */);
+    checkKeyTtl(key, it->second);
+    unverifiedKeys_.emplace(key);
+  }
+  reportExpiringKeys();
+  updateTtlCountdownQueue(publication);
+
+  const auto timeDelta = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - startTime);
+  fb303::fbData->addStatValue(
+      "kvstore.snapshot.num_loaded_keys", unverifiedKeys_.size(), fb303::SUM);
+  fb303::fbData->addStatValue(
+      "kvstore.snapshot.load_duration_ms", timeDelta.count(), fb303::AVG);
+  XLOG(INFO) << AreaTag()
+             << fmt::format(
+                    "[Snapshot] Loaded {} key-vals from {} in {}ms",
+                    unverifiedKeys_.size(),
+                    filePath,
+                    timeDelta.count());
+
+  // ATTN: publish to local subscribers ONLY. Peers learn about these keys
+  //       via regular full-sync once verified.
+  if (not publication.keyVals_ref()->empty()) {
+    publication.nodeIds_ref() = std::vector<std::string>{kvParams_.nodeId};
+    publishToLocalSubscribers(std::move(publication));
+  }
+}
+
+template <class ClientType>
+void
+KvStoreDb<ClientType>::persistSnapshot() {
+  // ATTN: never overwrite previous snapshot with keys not reconciled yet
+  if (not unverifiedKeys_.empty()) {
+    XLOG(DBG1) << AreaTag() << "[Snapshot] Skip snapshot with "
+               << unverifiedKeys_.size() << " unverified keys";
+    return;
+  }
+
+  const auto startTime = std::chrono::steady_clock::now();
+  thrift::Publication pub;
+  for (auto const& [key, val] : kvStore_) {
+    if (*val.originatorId_ref() == kvParams_.nodeId) {
+      continue;
+    }
+    pub.keyVals_ref()->emplace(key, val);
+  }
+  // persist remaining ttl, same as sent to peers
+  updatePublicationTtl(ttlCountdownQueue_, kvParams_.ttlDecr, pub);
+
+  thrift::KvStoreSnapshot snapshot;
+  snapshot.version_ref() = Constants::kKvStoreSnapshotVersion;
+  snapshot.area_ref() = area_;
+  snapshot.timestamp_ms_ref() = getUnixTimeStampMs();
+  snapshot.keyVals_ref() = std::move(*pub.keyVals_ref());
+
+  const auto filePath = getKvStoreSnapshotPath(*kvParams_.snapshotDir, area_);
+  if (not writeKvStoreSnapshot(filePath, snapshot)) {
+    fb303::fbData->addStatValue(
+        "kvstore.snapshot.num_persist_failure", 1, fb303::COUNT);
+    return;
+  }
+  const auto timeDelta = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - startTime);
+  fb303::fbData->addStatValue(
+      "kvstore.snapshot.persist_duration_ms", timeDelta.count(), fb303::AVG);
+  XLOG(DBG1) << AreaTag()
+             << fmt::format(
+                    "[Snapshot] Persisted {} key-vals to {} in {}ms",
+                    snapshot.keyVals_ref()->size(),
+                    filePath,
+                    timeDelta.count());
+}
+
+template <class ClientType>
+void
+KvStoreDb<ClientType>::reconcileUnverifiedKeys() {
+  if (unverifiedKeys_.empty()) {
+    return;
+  }
+
+  // keys disputed by peers are gone from the network, purge them
+  std::vector<std::string> staleKeys;
+  for (auto const& key : staleUnverifiedKeys_) {
+    auto it = kvStore_.find(key);
+    if (it == kvStore_.end()) {
+      continue;
+    }
+    staleKeys.emplace_back(key);
+    if (merkleTree_) {
+      merkleTree_->remove(key, it->second);
+    }
+    keyIndex_.erase(key);
+    removeKeyFamilyStats(key, it->second);
+    ttlCountdownQueue_.erase(key);
+    deltaBases_.erase(key);
+    expiringKeys_.erase(key);
+    kvStore_.erase(it);
+  }
+  if (not staleKeys.empty()) {
+    hashDumpCache_.clear();
+    dumpSnapshot_.reset();
+    reportExpiringKeys();
+  }
+
+  XLOG(INFO) << AreaTag()
+             << fmt::format(
+                    "[Snapshot] Reconciled {} unverified keys with peers. "
+                    "Purged {} stale keys.",
+                    unverifiedKeys_.size(),
+                    staleKeys.size());
+  fb303::fbData->addStatValue(
+      "kvstore.snapshot.num_purged_keys", staleKeys.size(), fb303::SUM);
+
+  // remaining keys are identical with peers
+  unverifiedKeys_.clear();
+  staleUnverifiedKeys_.clear();
+
+  if (staleKeys.empty()) {
+    return;
+  }
+  // ATTN: same as expired keys, ONLY notified to local subscribers
+  thrift::Publication expiredKeysPub{};
+  expiredKeysPub.expiredKeys_ref() = std::move(staleKeys);
+  expiredKeysPub.area_ref() = area_;
+  floodPublication(std::move(expiredKeysPub));
+}
+
+template <class ClientType>
+void
+KvStoreDb<ClientType>::resolveValueDeltas(thrift::Publication& publication) {
+  std::vector<std::string> missingBaseKeys;
+  auto& keyVals = *publication.keyVals_ref();
+  for (auto it = keyVals.begin(); it != keyVals.end();) {
+    auto& [key, value] = *it;
+    if (not value.delta_ref().has_value()) {
+      ++it;
+      continue;
+    }
+
+    auto const& delta = *value.delta_ref();
+    auto kvIt = kvStore_.find(key);
+    if (kvIt != kvStore_.end() and kvIt->second.value_ref().has_value()) {
+      auto const& localValue = kvIt->second;
+      if (*localValue.version_ref() == *delta.baseVersion_ref()) {
+        if (auto restored = applyValueDelta(*localValue.value_ref(), delta)) {
+          value.value_ref() = std::move(*restored);
+          value.delta_ref().reset();
+          fb303::fbData->addStatValue(
+              "kvstore.value_delta.num_applied", 1, fb303::COUNT);
+          ++it;
+          continue;
+        }
+      } else if (
+          *localValue.version_ref() > *value.version_ref() or
+          (*localValue.version_ref() == *value.version_ref() and
+           *localValue.originatorId_ref() == *value.originatorId_ref() and
+           localValue.hash_ref().has_value() and
+           localValue.hash_ref() == value.hash_ref())) {
+        // already up to date or newer, nothing to restore
+        it = keyVals.erase(it);
+        continue;
+      }
+    }
+
+    // base is missing or outdated, fall back to full value
+    missingBaseKeys.emplace_back(key);
+    it = keyVals.erase(it);
+  }
+
+  if (missingBaseKeys.empty()) {
+    return;
+  }
+  const auto nodeIds = publication.nodeIds_ref();
+  if (not nodeIds.has_value() or nodeIds->empty()) {
+    XLOG(ERR) << AreaTag()
+              << "[Value Delta] Unknown sender of delta-encoded key-vals: "
+              << folly::join(",", missingBaseKeys);
+    return;
+  }
+  requestFullValues(nodeIds->back(), missingBaseKeys);
+}
+
 template <class ClientType>
 void
-KvStoreDb<ClientType>::setKeyVals(thrift::KeySetParams&& setParams) {
-  // Update statistics
-  fb303::fbData->addStatValue("kvstore.cmd_key_set", 1, fb303::COUNT);
-
-  // Update hash for key-values
-  for (auto& [_, value] : *setParams.keyVals_ref()) {
-    if (value.value_ref().has_value()) {
-      value.hash_ref() = generateHash(
-          *value.version_ref(), *value.originatorId_ref(), value.value_ref());
-    }
+KvStoreDb<ClientType>::requestFullValues(
+    std::string const& peerName, std::vector<std::string> const& keys) {
+  auto peerIt = thriftPeers_.find(peerName);
+  if (peerIt == thriftPeers_.end() or (not peerIt->second.client)) {
+    // next full-sync with peer will bring keys up to date
+    XLOG(WARNING)
+        << AreaTag()
+        << fmt::format(
+               "[Value Delta] Peer: {} is not available to request full value "
+               "of keys: {}",
+               peerName,
+               folly::join(",", keys));
+    return;
   }
 
-  // Create publication and merge it with local KvStore
-  thrift::Publication rcvdPublication;
-  rcvdPublication.keyVals_ref() = std::move(*setParams.keyVals_ref());
-  rcvdPublication.nodeIds_ref().move_from(setParams.nodeIds_ref());
-  rcvdPublication.floodRootId_ref().move_from(setParams.floodRootId_ref());
-  mergePublication(rcvdPublication);
+  XLOG(DBG2) << AreaTag()
+             << fmt::format(
+                    "[Value Delta] Request full value of keys: {} from: {}",
+                    folly::join(",", keys),
+                    peerName);
+  fb303::fbData->addStatValue(
+      "kvstore.value_delta.num_full_value_requests", keys.size(), fb303::SUM);
+
+  auto sf = peerIt->second.client->semifuture_getKvStoreKeyValsArea(
+      peerRpcOptions_, keys, area_);
+  std::move(sf)
+      .via(evb_->getEvb())
+      .thenValue([this, peerName](thrift::Publication&& pub) {
+        // do not flood the key-vals back to peer
+        pub.nodeIds_ref() = std::vector<std::string>{peerName};
+        mergePublication(pub);
+      })
+      .thenError([this, peerName](const folly::exception_wrapper& ew) {
+        XLOG(ERR) << AreaTag()
+                  << fmt::format(
+                         "[Value Delta] Failed to request full value from "
+                         "peer: {}. Error: {}",
+                         peerName,
+                         ew.what());
+      });
 }
 
 template <class ClientType>
 void
-KvStoreDb<ClientType>::updateTtlCountdownQueue(
-    const thrift::Publication& publication) {
-  for (const auto& [key, value] : *publication.keyVals_ref()) {
-    if (*value.ttl_ref() != Constants::kTtlInfinity) {
-      TtlCountdownQueueEntry queueEntry;
-      queueEntry.expiryTime = std::chrono::steady_clock::now() +
-          std::chrono::milliseconds(*value.ttl_ref());
-      queueEntry.key = key;
-      queueEntry.version = *value.version_ref();
-      queueEntry.ttlVersion = *value.ttlVersion_ref();
-      queueEntry.originatorId = *value.originatorId_ref();
-
-      if ((ttlCountdownQueue_.empty() or
-           (queueEntry.expiryTime <= ttlCountdownQueue_.top().expiryTime)) and
-          ttlCountdownTimer_) {
-        // Reschedule the shorter timeout
-        ttlCountdownTimer_->scheduleTimeout(
-            std::chrono::milliseconds(*value.ttl_ref()));
-      }
+KvStoreDb<ClientType>::advertiseFloodDigest() {
+  floodDigest_.rotate();
+
+  thrift::KeySetParams params;
+  params.floodDigest_ref() = floodDigest_.toThrift();
+  params.timestamp_ms_ref() = getUnixTimeStampMs();
+  params.senderId_ref() = nodeId;
+  params.set_nodeIds({kvParams_.nodeId});
 
-      ttlCountdownQueue_.push(std::move(queueEntry));
+  for (auto& [peerName, thriftPeer] : thriftPeers_) {
+    if (*thriftPeer.peerSpec.state_ref() !=
+            thrift::KvStorePeerState::INITIALIZED or
+        (not thriftPeer.client)) {
+      continue;
     }
+    fb303::fbData->addStatValue(
+        "kvstore.flood_digest.num_sent", 1, fb303::COUNT);
+    auto sf = thriftPeer.client->semifuture_setKvStoreKeyVals(
+        peerRpcOptions_, params, area_);
+    std::move(sf)
+        .via(evb_->getEvb())
+        .thenError([peerName = peerName](const folly::exception_wrapper& ew) {
+          // peer session failure is handled by flooding and keep-alive
+          XLOG(DBG2) << fmt::format(
+              "[Flood Digest] Failed to send digest to peer: {}. Error: {}",
+              peerName,
+              ew.what());
+        });
   }
 }
 
-// loop through all key/vals and count the size of KvStoreDB (per area)
 template <class ClientType>
-size_t
-KvStoreDb<ClientType>::getKeyValsSize() const {
-  size_t size = 0;
-  if (kvStore_.empty()) {
-    return size;
-  }
-  // calculate total of struct members with fixed size once at the beginning
-  size_t fixed_size =
-      kvStore_.size() * (sizeof(std::string) + sizeof(thrift::Value));
-
-  // loop through all key/vals and add size of each KV entry
-  for (auto const& [key, value] : kvStore_) {
-    size += key.size() + value.originatorId_ref()->size() +
-        value.value_ref()->size();
+void
+KvStoreDb<ClientType>::populateTobeUpdatedKeys(thrift::Publication& pub) const {
+  std::optional<std::vector<bool>> isDiffering;
+  if (merkleTree_ and pub.differingBuckets_ref().has_value()) {
+    isDiffering = std::vector<bool>(merkleTree_->getNumBuckets(), false);
+    for (auto const& bucket : *pub.differingBuckets_ref()) {
+      if (bucket >= 0 and static_cast<size_t>(bucket) < isDiffering->size()) {
+        isDiffering->at(bucket) = true;
+      }
+    }
   }
-  size += fixed_size;
-
-  return size;
-}
-
-// build publication out of the requested keys (per request)
-// if not keys provided, will return publication with empty keyVals
-template <class ClientType>
-thrift::Publication
-KvStoreDb<ClientType>::getKeyVals(std::vector<std::string> const& keys) {
-  thrift::Publication thriftPub;
-  thriftPub.area_ref() = area_;
 
-  for (auto const& key : keys) {
-    // if requested key if found, respond with version and value
-    auto it = kvStore_.find(key);
-    if (it != kvStore_.end()) {
-      // copy here
-      thriftPub.keyVals_ref()[key] = it->second;
+  std::vector<std::string> tobeUpdatedKeys;
+  for (auto const& [key, myVal] : kvStore_) {
+    if (isDiffering.has_value() and
+        not isDiffering->at(merkleTree_->getBucket(key))) {
+      // bucket matches with peer
+      continue;
+    }
+    const auto& rcvdKv = pub.keyVals_ref()->find(key);
+    if (rcvdKv == pub.keyVals_ref()->end()) {
+      // not exist in peer
+      tobeUpdatedKeys.emplace_back(key);
+      continue;
+    }
+    int rc = compareValues(myVal, rcvdKv->second);
+    if (rc == 1 or rc == -2) {
+      // myVal is better or unknown
+      tobeUpdatedKeys.emplace_back(key);
     }
   }
-  return thriftPub;
+  pub.tobeUpdatedKeys_ref() = std::move(tobeUpdatedKeys);
 }
 
 // This function serves the purpose of periodically scanning peers in
@@ -1873,27 +2971,6 @@ KvStoreDb<ClientType>::requestThriftPeerSync() {
     // mark peer from IDLE -> SYNCING
     numThriftPeersInSync += 1;
 
-    // build KeyDumpParam
-    thrift::KeyDumpParams params;
-    if (kvParams_.filters.has_value()) {
-      std::string keyPrefix =
-          folly::join(",", kvParams_.filters.value().getKeyPrefixes());
-      /* prefix is for backward compatibility */
-      params.prefix_ref() = keyPrefix;
-      if (not keyPrefix.empty()) {
-        params.keys_ref() = kvParams_.filters.value().getKeyPrefixes();
-      }
-      params.originatorIds_ref() =
-          kvParams_.filters.value().getOriginatorIdList();
-    }
-    KvStoreFilters kvFilters(
-        std::vector<std::string>{}, /* keyPrefixList */
-        std::set<std::string>{} /* originator */);
-    // ATTN: dump hashes instead of full key-val pairs with values
-    auto thriftPub = dumpHashWithFilters(area_, kvStore_, kvFilters);
-    params.keyValHashes_ref() = *thriftPub.keyVals_ref();
-    params.senderId_ref() = nodeId;
-
     // record telemetry for initial full-sync
     fb303::fbData->addStatValue(
         "kvstore.thrift.num_full_sync", 1, fb303::COUNT);
@@ -1903,37 +2980,16 @@ KvStoreDb<ClientType>::requestThriftPeerSync() {
                       "[Thrift Sync] Initiating full-sync request for peer: {}",
                       peerName);
 
-    // send request over thrift client and attach callback
+    // tell responses of this round apart from previous rounds
+    ++thriftPeer.fullSyncId;
     auto startTime = std::chrono::steady_clock::now();
-    auto sf = thriftPeer.client->semifuture_getKvStoreKeyValsFilteredArea(
-        params, area_);
-    std::move(sf)
-        .via(evb_->getEvb())
-        .thenValue(
-            [this, peer = peerName, startTime](thrift::Publication&& pub) {
-              // state transition to INITIALIZED
-              auto endTime = std::chrono::steady_clock::now();
-              auto timeDelta =
-                  std::chrono::duration_cast<std::chrono::milliseconds>(
-                      endTime - startTime);
-              processThriftSuccess(peer, std::move(pub), timeDelta);
-            })
-        .thenError([this, peer = peerName, startTime](
-                       const folly::exception_wrapper& ew) {
-          // state transition to IDLE
-          auto endTime = std::chrono::steady_clock::now();
-          auto timeDelta =
-              std::chrono::duration_cast<std::chrono::milliseconds>(
-                  endTime - startTime);
-          processThriftFailure(
-              peer,
-              fmt::format("FULL_SYNC failure with {}, {}", peer, ew.what()),
-              timeDelta);
-
-          // record telemetry for thrift calls
-          fb303::fbData->addStatValue(
-              "kvstore.thrift.num_full_sync_failure", 1, fb303::COUNT);
-        });
+    if (kvParams_.fullSyncChunkSize.has_value() and
+        thriftPeer.chunkedSyncSupported) {
+      requestThriftPeerSyncChunk(
+          peerName, std::nullopt /* cursor */, startTime);
+    } else {
+      requestThriftPeerFullSync(peerName, startTime);
+    }
 
     // in case pending peer size is over parallelSyncLimit,
     // wait until kMaxBackoff before sending next round of sync
@@ -1964,6 +3020,214 @@ KvStoreDb<ClientType>::requestThriftPeerSync() {
   }
 }
 
+template <class ClientType>
+thrift::KeyDumpParams
+KvStoreDb<ClientType>::getFullSyncDumpParams() const {
+  thrift::KeyDumpParams params;
+  if (kvParams_.filters.has_value()) {
+    std::string keyPrefix =
+        folly::join(",", kvParams_.filters.value().getKeyPrefixes());
+    /* prefix is for backward compatibility */
+    params.prefix_ref() = keyPrefix;
+    if (not keyPrefix.empty()) {
+      params.keys_ref() = kvParams_.filters.value().getKeyPrefixes();
+    }
+    params.originatorIds_ref() =
+        kvParams_.filters.value().getOriginatorIdList();
+  }
+  params.senderId_ref() = nodeId;
+  if (kvParams_.enableFastValueHash) {
+    params.hashScheme_ref() = thrift::KvStoreHashScheme::SPOOKY_V2;
+  }
+  return params;
+}
+
+template <class ClientType>
+void
+KvStoreDb<ClientType>::requestThriftPeerFullSync(
+    std::string const& peerName,
+    std::chrono::steady_clock::time_point startTime) {
+  auto& thriftPeer = thriftPeers_.at(peerName);
+
+  // build KeyDumpParam
+  auto params = getFullSyncDumpParams();
+  if (merkleTree_ and not kvParams_.filters.has_value()) {
+    // ATTN: send constant-size bucket digests instead of per-key hashes.
+    //       Responder will ONLY send back keys in differing buckets.
+    params.keyValBucketDigests_ref() = merkleTree_->getLeafDigests();
+  } else {
+    // ATTN: dump hashes instead of full key-val pairs with values
+    params.keyValHashes_ref() =
+        *dumpHashes(std::vector<std::string>{} /* keyPrefixList */)
+             ->keyVals_ref();
+  }
+
+  // send request over thrift client and attach callback
+  auto sf = thriftPeer.client->semifuture_getKvStoreKeyValsFilteredArea(
+      peerRpcOptions_, params, area_);
+  std::move(sf)
+      .via(evb_->getEvb())
+      .thenValue(
+          [this, peer = peerName, startTime](thrift::Publication&& pub) {
+            // state transition to INITIALIZED
+            auto endTime = std::chrono::steady_clock::now();
+            auto timeDelta =
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                    endTime - startTime);
+            processThriftSuccess(peer, std::move(pub), timeDelta);
+          })
+      .thenError([this, peer = peerName, startTime](
+                     const folly::exception_wrapper& ew) {
+        // state transition to IDLE
+        auto endTime = std::chrono::steady_clock::now();
+        auto timeDelta = std::chrono::duration_cast<std::chrono::milliseconds>(
+            endTime - startTime);
+        processThriftFailure(
+            peer,
+            fmt::format("FULL_SYNC failure with {}, {}", peer, ew.what()),
+            timeDelta);
+
+        // record telemetry for thrift calls
+        fb303::fbData->addStatValue(
+            "kvstore.thrift.num_full_sync_failure", 1, fb303::COUNT);
+      });
+}
+
+// This function requests the next chunk of full-sync from peer, covering
+// keys after `cursor`. Only hashes of our own keys in the same range are
+// sent along, so that both request and response stay bounded.
+template <class ClientType>
+void
+KvStoreDb<ClientType>::requestThriftPeerSyncChunk(
+    std::string const& peerName,
+    std::optional<std::string> const& cursor,
+    std::chrono::steady_clock::time_point startTime) {
+  auto& thriftPeer = thriftPeers_.at(peerName);
+  const auto chunkSize = kvParams_.fullSyncChunkSize.value();
+
+  thrift::KvStoreSyncChunkParams chunkParams;
+  chunkParams.maxKeysPerChunk_ref() = chunkSize;
+  chunkParams.cursor_ref().from_optional(cursor);
+  if (kvParams_.enableFullSyncCompression) {
+    chunkParams.compression_ref() = thrift::KvStoreCompression::ZSTD;
+  }
+
+  // ATTN: flat hashes are always used. Merkle-tree bucket digests cover the
+  //       entire key space and can NOT be scoped to a chunk.
+  const auto hashesUpperBound = keyIndex_.getChunkEnd(cursor, chunkSize);
+  chunkParams.hashesUpperBound_ref().from_optional(hashesUpperBound);
+  auto thriftPub = dumpHashOfKeys(
+      area_, kvStore_, keyIndex_.getKeysInRange(cursor, hashesUpperBound));
+  auto params = getFullSyncDumpParams();
+  params.keyValHashes_ref() = std::move(*thriftPub.keyVals_ref());
+
+  auto sf = thriftPeer.client->semifuture_getKvStoreSyncChunkArea(
+      peerRpcOptions_, params, area_, chunkParams);
+  std::move(sf)
+      .via(evb_->getEvb())
+      .thenValue([this,
+                  peer = peerName,
+                  fullSyncId = thriftPeer.fullSyncId,
+                  startTime](thrift::KvStoreSyncChunk&& chunk) {
+        processThriftSyncChunk(peer, fullSyncId, std::move(chunk), startTime);
+      })
+      .thenError([this,
+                  peer = peerName,
+                  fullSyncId = thriftPeer.fullSyncId,
+                  startTime](const folly::exception_wrapper& ew) {
+        auto peerIt = thriftPeers_.find(peer);
+        if (peerIt == thriftPeers_.end() or
+            peerIt->second.fullSyncId != fullSyncId) {
+          return;
+        }
+        // peer doesn't serve chunked full-sync. Fall back to monolithic
+        // full-sync on retry.
+        auto appEx = ew.get_exception<apache::thrift::TApplicationException>();
+        if (appEx and
+            appEx->getType() ==
+                apache::thrift::TApplicationException::UNKNOWN_METHOD) {
+          peerIt->second.chunkedSyncSupported = false;
+        }
+
+        // state transition to IDLE
+        auto endTime = std::chrono::steady_clock::now();
+        auto timeDelta = std::chrono::duration_cast<std::chrono::milliseconds>(
+            endTime - startTime);
+        processThriftFailure(
+            peer,
+            fmt::format("FULL_SYNC failure with {}, {}", peer, ew.what()),
+            timeDelta);
+
+        // record telemetry for thrift calls
+        fb303::fbData->addStatValue(
+            "kvstore.thrift.num_full_sync_failure", 1, fb303::COUNT);
+      });
+}
+
+// This function will process one chunk of full-sync response from peer:
+//  1) Merge chunk with local KvStoreDb and send back keys peer is missing
+//     within the chunk, same as monolithic full-sync response;
+//  2) Request next chunk while peer stays in SYNCING state;
+//  3) Conclude full-sync on the last chunk;
+template <class ClientType>
+void
+KvStoreDb<ClientType>::processThriftSyncChunk(
+    std::string const& peerName,
+    uint64_t fullSyncId,
+    thrift::KvStoreSyncChunk&& chunk,
+    std::chrono::steady_clock::time_point startTime) {
+  // ATTN: peer may have been removed or restarted full-sync meanwhile
+  auto peerIt = thriftPeers_.find(peerName);
+  if (peerIt == thriftPeers_.end() or
+      peerIt->second.fullSyncId != fullSyncId or
+      *peerIt->second.peerSpec.state_ref() !=
+          thrift::KvStorePeerState::SYNCING) {
+    XLOG(WARNING) << AreaTag()
+                  << fmt::format(
+                         "[Thrift Sync] Ignore stale full-sync chunk from: {}",
+                         peerName);
+    return;
+  }
+
+  auto timeDelta = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - startTime);
+  const auto chunkEnd = chunk.chunkEnd_ref().to_optional();
+  thrift::Publication pub;
+  try {
+    pub = unpackSyncChunk(std::move(chunk));
+  } catch (std::exception const& ex) {
+    processThriftFailure(
+        peerName,
+        fmt::format(
+            "FULL_SYNC chunk failure with {}, {}",
+            peerName,
+            folly::exceptionStr(ex)),
+        timeDelta);
+    fb303::fbData->addStatValue(
+        "kvstore.thrift.num_full_sync_failure", 1, fb303::COUNT);
+    return;
+  }
+  fb303::fbData->addStatValue(
+      "kvstore.thrift.num_full_sync_chunks", 1, fb303::COUNT);
+
+  if (not chunkEnd.has_value()) {
+    // last chunk concludes full-sync the same way as monolithic response
+    processThriftSuccess(peerName, std::move(pub), timeDelta);
+    return;
+  }
+
+  const auto kvUpdateCnt = mergePublication(pub, peerName);
+  XLOG(DBG1) << AreaTag()
+             << fmt::format(
+                    "[Thrift Sync] Full-sync chunk up to key: {} received "
+                    "from: {} with {} key-vals. Incurred {} key-value updates.",
+                    *chunkEnd,
+                    peerName,
+                    pub.keyVals_ref()->size(),
+                    kvUpdateCnt);
+  requestThriftPeerSyncChunk(peerName, chunkEnd, startTime);
+}
+
 // This function will process the full-dump response from peers:
 //  1) Merge peer's publication with local KvStoreDb;
 //  2) Send a finalized full-sync to peer for missing keys;
@@ -2000,6 +3264,20 @@ KvStoreDb<ClientType>::processThriftSuccess(
     return;
   }
 
+  // Record hash scheme supported by peer. Old peers do not advertise any.
+  peer.hashScheme = pub.hashScheme_ref().value_or(
+      thrift::KvStoreHashScheme::BOOST_HASH_COMBINE);
+  peer.compactTtlUpdates = pub.compactTtlUpdates_ref().value_or(false);
+  peer.valueDeltas = pub.valueDeltas_ref().value_or(false);
+  peer.serializedKeyVals = pub.serializedKeyVals_ref().value_or(false);
+
+  // Populate keys to send back in case of bucketed full-sync. Responder with
+  // flat hash comparison always sets `tobeUpdatedKeys`.
+  if (kvParams_.enableMerkleSync and
+      not pub.tobeUpdatedKeys_ref().has_value()) {
+    populateTobeUpdatedKeys(pub);
+  }
+
   // ATTN: `peerName` is MANDATORY to fulfill the finialized
   //       full-sync with peers.
   const auto kvUpdateCnt = mergePublication(pub, peerName);
@@ -2087,6 +3365,9 @@ KvStoreDb<ClientType>::processInitializationEvent() {
     }
   }
 
+  // Purge stale snapshot keys before any subscriber acts upon sync signal
+  reconcileUnverifiedKeys();
+
   // Sync with all peers are completed.
   initialSyncCompleted_ = true;
 
@@ -2127,6 +3408,7 @@ KvStoreDb<ClientType>::processThriftFailure(
   peer.keepAliveTimer->cancelTimeout();
   peer.expBackoff.reportError(); // apply exponential backoff
   peer.client.reset();
+  peer.floodDigest.reset();
 
   // state transition
   auto oldState = *peer.peerSpec.state_ref();
@@ -2222,7 +3504,7 @@ KvStoreDb<ClientType>::addThriftPeers(
             auto period = addJitter(Constants::kThriftClientKeepAliveInterval);
             auto& p = thriftPeers_.at(name);
             CHECK(p.client) << "thrift client is NOT initialized";
-            p.client->semifuture_getStatus();
+            p.client->semifuture_getStatus(peerRpcOptions_);
             p.keepAliveTimer->scheduleTimeout(period);
           });
       thriftPeers_.emplace(name, std::move(peer));
@@ -2237,6 +3519,10 @@ KvStoreDb<ClientType>::addThriftPeers(
   if (not thriftSyncTimer_->isScheduled()) {
     thriftSyncTimer_->scheduleTimeout(std::chrono::milliseconds(0));
   }
+
+  // [Monitoring] flood peers and expiring keys depend on peers
+  scheduleFloodTopoDump();
+  reportExpiringKeys();
 }
 
 // TODO: replace addPeers with addThriftPeers call
@@ -2247,133 +3533,46 @@ KvStoreDb<ClientType>::addPeers(
   // thrift peer addition
   addThriftPeers(peers);
 
-  // [TO BE DEPRECATED]
+  // [Flood Optimization] Dual messages are sent over thrift peer clients
   if (kvParams_.enableFloodOptimization) {
-    // ZMQ peer addition
-    ++peerAddCounter_;
     std::vector<std::string> dualPeersToAdd;
     for (auto const& [peerName, newPeerSpec] : peers) {
-      auto const& newPeerCmdId =
-          fmt::format("{}::{}::TCP::CMD::LOCAL", peerName, peerAddCounter_);
       const auto& supportFloodOptimization =
           *newPeerSpec.supportFloodOptimization_ref();
 
-      try {
-        auto it = peers_.find(peerName);
-        bool cmdUrlUpdated{false};
-        bool isNewPeer{false};
-
-        // add dual peers for both new-peer or update-peer event
-        if (supportFloodOptimization) {
-          dualPeersToAdd.emplace_back(peerName);
-        }
-
-        if (it != peers_.end()) {
-          XLOG(INFO)
-              << AreaTag()
-              << fmt::format("[ZMQ] Updating existing peer {}", peerName);
-
-          const auto& peerSpec = it->second.first;
-
-          if (*peerSpec.cmdUrl_ref() != *newPeerSpec.cmdUrl_ref()) {
-            // case1: peer-spec updated (e.g parallel cases)
-            cmdUrlUpdated = true;
-            XLOG(INFO) << AreaTag()
-                       << fmt::format(
-                              "[ZMQ] Disconnecting from {} with id {}",
-                              *peerSpec.cmdUrl_ref(),
-                              it->second.second);
-            const auto ret = peerSyncSock_.disconnect(
-                fbzmq::SocketUrl{*peerSpec.cmdUrl_ref()});
-            if (ret.hasError()) {
-              XLOG(ERR) << AreaTag()
-                        << fmt::format(
-                               "[ZMQ] Error Disconnecting to URL {}. Error: {}",
-                               *peerSpec.cmdUrl_ref(),
-                               ret.error().errString);
-            }
-            it->second.second = newPeerCmdId;
-          } else {
-            // case2. new peer came up (previsously shut down ungracefully)
-            XLOG(WARNING)
-                << AreaTag()
-                << fmt::format(
-                       "[ZMQ] New peer {}. Previously shutdown non-gracefully",
-                       peerName);
-            isNewPeer = true;
-          }
-          // Update entry with new data
-          it->second.first = newPeerSpec;
-        } else {
-          // case3. new peer came up
-          XLOG(INFO) << AreaTag()
-                     << fmt::format("[ZMQ] Adding new peer {}", peerName);
-          isNewPeer = true;
-          cmdUrlUpdated = true;
-          std::tie(it, std::ignore) = peers_.emplace(
-              peerName, std::make_pair(newPeerSpec, newPeerCmdId));
-        }
-
-        if (cmdUrlUpdated) {
-          CHECK(newPeerCmdId == it->second.second);
-          XLOG(INFO) << AreaTag()
-                     << fmt::format(
-                            "[ZMQ] Connecting sync channel to {} with id: {}",
-                            *newPeerSpec.cmdUrl_ref(),
-                            newPeerCmdId);
-          auto const optStatus = peerSyncSock_.setSockOpt(
-              ZMQ_CONNECT_RID, newPeerCmdId.data(), newPeerCmdId.size());
-          if (optStatus.hasError()) {
-            XLOG(ERR)
-                << AreaTag()
-                << fmt::format(
-                       "[ZMQ] Error setting ZMQ_CONNECT_RID with value {}",
-                       newPeerCmdId);
-          }
-          if (peerSyncSock_.connect(fbzmq::SocketUrl{*newPeerSpec.cmdUrl_ref()})
-                  .hasError()) {
-            XLOG(ERR) << AreaTag()
-                      << fmt::format(
-                             "[ZMQ] Error connecting to URL {}",
-                             *newPeerSpec.cmdUrl_ref());
-          }
-        }
+      // add dual peers for both new-peer or update-peer event
+      if (supportFloodOptimization) {
+        dualPeersToAdd.emplace_back(peerName);
+      }
 
-        if (isNewPeer and supportFloodOptimization) {
-          // make sure let peer to unset-child for me for all roots first
-          // after that, I'll be fed with proper dual-events and I'll be
-          // chosing new nexthop if need.
-          unsetChildAll(peerName);
-        }
-      } catch (std::exception const& e) {
-        XLOG(ERR) << AreaTag()
-                  << fmt::format(
-                         "[ZMQ] Error connecting to {}, reason: {}",
-                         peerName,
-                         folly::exceptionStr(e));
+      // Peer is new unless only its address changed (e.g parallel cases).
+      // Peer re-added as is came up again after shutting down ungracefully.
+      auto it = dualPeers_.find(peerName);
+      const bool isNewPeer = it == dualPeers_.end() or
+          (*it->second.peerAddr_ref() == *newPeerSpec.peerAddr_ref() and
+           *it->second.ctrlPort_ref() == *newPeerSpec.ctrlPort_ref());
+      dualPeers_.insert_or_assign(peerName, newPeerSpec);
+
+      if (isNewPeer and supportFloodOptimization) {
+        // make sure let peer to unset-child for me for all roots first
+        // after that, I'll be fed with proper dual-events and I'll be
+        // chosing new nexthop if need.
+        unsetChildAll(peerName);
       }
     }
 
-    // process dual events if any
+    // process dual events if any, all at once
+    std::map<std::string, std::optional<int64_t>> dualEvents;
     for (const auto& peer : dualPeersToAdd) {
       XLOG(INFO) << AreaTag() << fmt::format("[Dual] peer up: {}", peer);
-      DualNode::peerUp(peer, 1 /* link-cost */); // use hop count as metric
+      dualEvents.emplace(peer, 1 /* link-cost */); // use hop count as metric
+    }
+    if (not dualEvents.empty()) {
+      DualNode::peerEvents(dualEvents);
     }
   }
 }
 
-// Send message via socket
-template <class ClientType>
-folly::Expected<size_t, fbzmq::Error>
-KvStoreDb<ClientType>::sendMessageToPeer(
-    const std::string& peerSocketId, const thrift::KvStoreRequest& request) {
-  auto msg = fbzmq::Message::fromThriftObj(request, serializer_).value();
-  fb303::fbData->addStatValue(
-      "kvstore.peers.bytes_sent", msg.size(), fb303::SUM);
-  return peerSyncSock_.sendMultiple(
-      fbzmq::Message::from(peerSocketId).value(), fbzmq::Message(), msg);
-}
-
 template <class ClientType>
 std::map<std::string, int64_t>
 KvStoreDb<ClientType>::getCounters() const {
@@ -2382,8 +3581,7 @@ KvStoreDb<ClientType>::getCounters() const {
   // Add some more flat counters
   counters["kvstore.num_keys"] = kvStore_.size();
   counters["kvstore.num_peers"] = thriftPeers_.size();
-  // [TO BE DEPRECATED]
-  counters["kvstore.num_zmq_peers"] = peers_.size();
+  counters["kvstore.snapshot.num_unverified_keys"] = unverifiedKeys_.size();
 
   /*
    * ATTN: counter with [Area] tag has two layers of counters. For instance,
@@ -2404,6 +3602,15 @@ KvStoreDb<ClientType>::getCounters() const {
   counters["kvstore.num_expiring_keys"] =
       maybeNumExpiringKeys.hasValue() ? maybeNumExpiringKeys.value() : 0;
 
+  // [Key Family Accounting] update and flood counters are cumulative
+  for (auto const& [family, stats] : keyFamilyStats_) {
+    const auto prefix = fmt::format("kvstore.key_family.{}", family);
+    counters[prefix + ".num_keys"] = *stats.numKeys_ref();
+    counters[prefix + ".num_bytes"] = *stats.numBytes_ref();
+    counters[prefix + ".num_updates"] = *stats.numUpdates_ref();
+    counters[prefix + ".num_flood_bytes"] = *stats.numFloodBytes_ref();
+  }
+
   return counters;
 }
 
@@ -2435,6 +3642,10 @@ KvStoreDb<ClientType>::delThriftPeers(std::vector<std::string> const& peers) {
     peerIter->second.client.reset();
     thriftPeers_.erase(peerIter);
   }
+
+  // [Monitoring] flood peers and expiring keys depend on peers
+  scheduleFloodTopoDump();
+  reportExpiringKeys();
 }
 
 // TODO: replace delPeers with delThriftPeers call
@@ -2444,48 +3655,32 @@ KvStoreDb<ClientType>::delPeers(std::vector<std::string> const& peers) {
   // thrift peer deletion
   delThriftPeers(peers);
 
-  // [TO BE DEPRECATED]
+  // [Flood Optimization]
   if (kvParams_.enableFloodOptimization) {
-    // ZMQ peer deletion
     std::vector<std::string> dualPeersToRemove;
     for (auto const& peerName : peers) {
-      // not currently subscribed
-      auto it = peers_.find(peerName);
-      if (it == peers_.end()) {
-        XLOG(ERR)
-            << AreaTag()
-            << fmt::format(
-                   "[ZMQ] Trying to delete non-existing peer {}", peerName);
+      auto it = dualPeers_.find(peerName);
+      if (it == dualPeers_.end()) {
+        XLOG(ERR) << AreaTag()
+                  << fmt::format(
+                         "[Dual] Trying to delete non-existing peer {}",
+                         peerName);
         continue;
       }
-
-      const auto& peerSpec = it->second.first;
-      if (*peerSpec.supportFloodOptimization_ref()) {
+      if (*it->second.supportFloodOptimization_ref()) {
         dualPeersToRemove.emplace_back(peerName);
       }
-
-      XLOG(INFO)
-          << AreaTag()
-          << fmt::format(
-                 "[ZMQ] Detaching from: {}, support-flood-optimization: {}",
-                 *peerSpec.cmdUrl_ref(),
-                 *peerSpec.supportFloodOptimization_ref());
-      auto syncRes =
-          peerSyncSock_.disconnect(fbzmq::SocketUrl{*peerSpec.cmdUrl_ref()});
-      if (syncRes.hasError()) {
-        XLOG(ERR) << AreaTag()
-                  << fmt::format(
-                         "[ZMQ] Failed to detach from {}. Error: {}",
-                         *peerSpec.cmdUrl_ref(),
-                         syncRes.error().errString);
-      }
-      peers_.erase(it);
+      dualPeers_.erase(it);
     }
 
-    // remove dual peers if any
+    // remove dual peers if any, all at once
+    std::map<std::string, std::optional<int64_t>> dualEvents;
     for (const auto& peer : dualPeersToRemove) {
       XLOG(INFO) << AreaTag() << fmt::format("[Dual] peer down: {}", peer);
-      DualNode::peerDown(peer);
+      dualEvents.emplace(peer, std::nullopt);
+    }
+    if (not dualEvents.empty()) {
+      DualNode::peerEvents(dualEvents);
     }
   }
 }
@@ -2536,7 +3731,8 @@ KvStoreDb<ClientType>::processRequestMsgHelper(
 
     const auto keyPrefixMatch =
         KvStoreFilters(keyPrefixList, *keyDumpParamsVal.originatorIds_ref());
-    auto thriftPub = dumpAllWithFilters(area_, kvStore_, keyPrefixMatch);
+    auto thriftPub =
+        dumpAllWithFilters(area_, kvStore_, keyIndex_, keyPrefixMatch);
     if (auto keyValHashes = keyDumpParamsVal.keyValHashes_ref()) {
       thriftPub =
           dumpDifference(area_, *thriftPub.keyVals_ref(), *keyValHashes);
@@ -2638,6 +3834,9 @@ template <class ClientType>
 void
 KvStoreDb<ClientType>::processFloodTopoSet(
     const thrift::FloodTopoSetParams& setParams) noexcept {
+  // [Monitoring] SPT children are flood peers
+  scheduleFloodTopoDump();
+
   if (setParams.allRoots_ref().has_value() and *setParams.allRoots_ref() and
       not(*setParams.setChild_ref())) {
     // process unset-child for all-roots command
@@ -2684,77 +3883,56 @@ KvStoreDb<ClientType>::sendTopoSetCmd(
     bool setChild,
     bool allRoots) noexcept {
   thrift::FloodTopoSetParams setParams;
-  setParams.rootId_ref() = rootId;
-  setParams.srcId_ref() = kvParams_.nodeId;
-  setParams.setChild_ref() = setChild;
-  if (allRoots) {
-    setParams.allRoots_ref() = allRoots;
-  }
-
-  if (kvParams_.enableThriftDualMsg) {
-    auto peerIt = thriftPeers_.find(peerName);
-    if (peerIt == thriftPeers_.end() or (not peerIt->second.client)) {
-      XLOG(ERR) << AreaTag()
-                << fmt::format(
-                       "[Dual] Invalid dual peer: {} to set topo cmd. Skip.",
-                       peerName);
-      return;
-    }
-    auto& client = peerIt->second.client;
-    auto startTime = std::chrono::steady_clock::now();
-    auto sf = client->semifuture_updateFloodTopologyChild(setParams, area_);
-    std::move(sf)
-        .via(evb_->getEvb())
-        .thenValue([startTime](folly::Unit&&) {
-          auto endTime = std::chrono::steady_clock::now();
-          auto timeDelta =
-              std::chrono::duration_cast<std::chrono::milliseconds>(
-                  endTime - startTime);
-
-          // record telemetry for thrift calls
-          fb303::fbData->addStatValue(
-              "kvstore.thrift.num_dual_msg_success", 1, fb303::COUNT);
-          fb303::fbData->addStatValue(
-              "kvstore.thrift.dual_msg_duration_ms",
-              timeDelta.count(),
-              fb303::AVG);
-        })
-        .thenError(
-            [this, peerName, startTime](const folly::exception_wrapper& ew) {
-              // state transition to IDLE
-              auto endTime = std::chrono::steady_clock::now();
-              auto timeDelta =
-                  std::chrono::duration_cast<std::chrono::milliseconds>(
-                      endTime - startTime);
-              processThriftFailure(
-                  peerName,
-                  fmt::format(
-                      "DUAL TOPO_SET failure with {}, {}", peerName, ew.what()),
-                  timeDelta);
-
-              // record telemetry for thrift calls
-              fb303::fbData->addStatValue(
-                  "kvstore.thrift.num_dual_msg_failure", 1, fb303::COUNT);
-            });
-  } else {
-    thrift::KvStoreRequest request;
-    request.cmd_ref() = thrift::Command::FLOOD_TOPO_SET;
-    request.floodTopoSetParams_ref() = setParams;
-    request.area_ref() = area_;
-
-    const auto& dstCmdSocketId = peers_.at(peerName).second;
-    const auto ret = sendMessageToPeer(dstCmdSocketId, request);
-    if (ret.hasError()) {
-      XLOG(ERR) << AreaTag()
-                << fmt::format(
-                       "{}: failed to {} spt-parent {}. Error: {}",
-                       rootId,
-                       (setChild ? "set" : "unset"),
-                       peerName,
-                       ret.error().errString);
-      collectSendFailureStats(ret.error(), dstCmdSocketId);
-    }
+  setParams.rootId_ref() = rootId;
+  setParams.srcId_ref() = kvParams_.nodeId;
+  setParams.setChild_ref() = setChild;
+  if (allRoots) {
+    setParams.allRoots_ref() = allRoots;
+  }
+
+  auto* client = getDualPeerClient(peerName);
+  if (not client) {
+    XLOG(ERR) << AreaTag()
+              << fmt::format(
+                     "[Dual] Invalid dual peer: {} to set topo cmd. Skip.",
+                     peerName);
+    return;
   }
+  auto startTime = std::chrono::steady_clock::now();
+  auto sf = client->semifuture_updateFloodTopologyChild(
+      peerRpcOptions_, setParams, area_);
+  std::move(sf)
+      .via(evb_->getEvb())
+      .thenValue([startTime](folly::Unit&&) {
+        auto endTime = std::chrono::steady_clock::now();
+        auto timeDelta = std::chrono::duration_cast<std::chrono::milliseconds>(
+            endTime - startTime);
+
+        // record telemetry for thrift calls
+        fb303::fbData->addStatValue(
+            "kvstore.thrift.num_dual_msg_success", 1, fb303::COUNT);
+        fb303::fbData->addStatValue(
+            "kvstore.thrift.dual_msg_duration_ms",
+            timeDelta.count(),
+            fb303::AVG);
+      })
+      .thenError(
+          [this, peerName, startTime](const folly::exception_wrapper& ew) {
+            // state transition to IDLE
+            auto endTime = std::chrono::steady_clock::now();
+            auto timeDelta =
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                    endTime - startTime);
+            processThriftFailure(
+                peerName,
+                fmt::format(
+                    "DUAL TOPO_SET failure with {}, {}", peerName, ew.what()),
+                timeDelta);
+
+            // record telemetry for thrift calls
+            fb303::fbData->addStatValue(
+                "kvstore.thrift.num_dual_msg_failure", 1, fb303::COUNT);
+          });
 }
 
 template <class ClientType>
@@ -2798,6 +3976,7 @@ KvStoreDb<ClientType>::processNexthopChange(
                     rootId,
                     oldNhStr,
                     newNhStr);
+  scheduleFloodTopoDump();
 
   // set new parent if any
   if (newNh.has_value()) {
@@ -2848,70 +4027,22 @@ KvStoreDb<ClientType>::processNexthopChange(
   }
 }
 
-// [TO BE DEPRECATED]
-// this will poll the sockets listening to the requests
-template <class ClientType>
-void
-KvStoreDb<ClientType>::attachCallbacks() {
-  XLOG(DBG2) << "KvStore: Registering events callbacks ...";
-
-  const auto peersSyncSndHwm = peerSyncSock_.setSockOpt(
-      ZMQ_SNDHWM, &kvParams_.zmqHwm, sizeof(kvParams_.zmqHwm));
-  if (peersSyncSndHwm.hasError()) {
-    XLOG(ERR) << "Error setting ZMQ_SNDHWM to " << kvParams_.zmqHwm << " "
-              << peersSyncSndHwm.error();
-  }
-  const auto peerSyncRcvHwm = peerSyncSock_.setSockOpt(
-      ZMQ_RCVHWM, &kvParams_.zmqHwm, sizeof(kvParams_.zmqHwm));
-  if (peerSyncRcvHwm.hasError()) {
-    XLOG(ERR) << "Error setting ZMQ_SNDHWM to " << kvParams_.zmqHwm << " "
-              << peerSyncRcvHwm.error();
-  }
-
-  // enable handover for inter process router socket
-  const int handover = 1;
-  const auto peerSyncHandover =
-      peerSyncSock_.setSockOpt(ZMQ_ROUTER_HANDOVER, &handover, sizeof(int));
-  if (peerSyncHandover.hasError()) {
-    XLOG(ERR) << "Error setting ZMQ_ROUTER_HANDOVER to " << handover << " "
-              << peerSyncHandover.error();
-  }
-
-  // set keep-alive to retire old flows
-  const auto peerSyncKeepAlive = peerSyncSock_.setKeepAlive(
-      Constants::kKeepAliveEnable,
-      Constants::kKeepAliveTime.count(),
-      Constants::kKeepAliveCnt,
-      Constants::kKeepAliveIntvl.count());
-  if (peerSyncKeepAlive.hasError()) {
-    XLOG(ERR) << "Error setting KeepAlive " << peerSyncKeepAlive.error();
-  }
-
-  if (kvParams_.maybeIpTos.has_value()) {
-    const int ipTos = kvParams_.maybeIpTos.value();
-    const auto peerSyncTos =
-        peerSyncSock_.setSockOpt(ZMQ_TOS, &ipTos, sizeof(int));
-    if (peerSyncTos.hasError()) {
-      XLOG(ERR) << "Error setting ZMQ_TOS to " << ipTos << " "
-                << peerSyncTos.error();
-    }
-  }
-}
-
 template <class ClientType>
 void
 KvStoreDb<ClientType>::cleanupTtlCountdownQueue() {
   // record all expired keys
   std::vector<std::string> expiredKeys;
   auto now = std::chrono::steady_clock::now();
+  ttlCountdownTimerExpiry_.reset();
 
-  // Iterate through ttlCountdownQueue_ until the top expires in the future
-  while (not ttlCountdownQueue_.empty()) {
-    auto top = ttlCountdownQueue_.top();
-    if (top.expiryTime > now) {
-      // Nothing in queue worth evicting
-      break;
-    }
+  // Advance timing wheel and collect all entries due by now
+  auto dueEntries = ttlCountdownQueue_.expire(now);
+  if (not dueEntries.empty()) {
+    fb303::fbData->addStatValue(
+        "kvstore.ttl_countdown.expired_keys", dueEntries.size(), fb303::SUM);
+  }
+
+  for (auto const& top : dueEntries) {
     auto it = kvStore_.find(top.key);
     if (it != kvStore_.end() and *it->second.version_ref() == top.version and
         *it->second.originatorId_ref() == top.originatorId and
@@ -2929,16 +4060,25 @@ KvStoreDb<ClientType>::cleanupTtlCountdownQueue() {
                  *it->second.ttl_ref(),
                  kvParams_.nodeId);
       logKvEvent("KEY_EXPIRE", top.key);
+      if (merkleTree_) {
+        merkleTree_->remove(top.key, it->second);
+      }
+      keyIndex_.erase(top.key);
+      removeKeyFamilyStats(top.key, it->second);
+      deltaBases_.erase(top.key);
+      expiringKeys_.erase(top.key);
+      hashDumpCache_.clear();
+      dumpSnapshot_.reset();
       kvStore_.erase(it);
     }
-    ttlCountdownQueue_.pop();
+  }
+  if (not expiredKeys.empty()) {
+    reportExpiringKeys();
   }
 
-  // Reschedule based on most recent timeout
-  if (not ttlCountdownQueue_.empty()) {
-    ttlCountdownTimer_->scheduleTimeout(
-        std::chrono::duration_cast<std::chrono::milliseconds>(
-            ttlCountdownQueue_.top().expiryTime - now));
+  // Reschedule based on next slot of the wheel
+  if (auto nextExpiryTime = ttlCountdownQueue_.getNextExpiryTime()) {
+    scheduleTtlCountdownTimer(*nextExpiryTime, now);
   }
 
   if (expiredKeys.empty()) {
@@ -2960,35 +4100,50 @@ KvStoreDb<ClientType>::cleanupTtlCountdownQueue() {
 
 template <class ClientType>
 void
-KvStoreDb<ClientType>::bufferPublication(thrift::Publication&& publication) {
+KvStoreDb<ClientType>::bufferPublication(
+    FloodPriority priority, thrift::Publication&& publication) {
   fb303::fbData->addStatValue("kvstore.rate_limit_suppress", 1, fb303::COUNT);
   fb303::fbData->addStatValue(
       "kvstore.rate_limit_keys", publication.keyVals_ref()->size(), fb303::AVG);
+  fb303::fbData->addStatValue(
+      fmt::format(
+          "kvstore.flood_priority.{}.rate_limit_suppress",
+          getFloodPriorityName(priority)),
+      1,
+      fb303::COUNT);
+
+  addToPublicationBuffer(
+      publicationBuffers_.at(static_cast<size_t>(priority)), publication);
+}
+
+template <class ClientType>
+void
+KvStoreDb<ClientType>::addToPublicationBuffer(
+    PublicationBuffer& buffer, thrift::Publication const& publication) {
+  if (not buffer.bufferedSince.has_value()) {
+    buffer.bufferedSince = std::chrono::steady_clock::now();
+  }
   std::optional<std::string> floodRootId{std::nullopt};
   if (publication.floodRootId_ref().has_value()) {
     floodRootId = publication.floodRootId_ref().value();
   }
   // update or add keys
   for (auto const& [key, _] : *publication.keyVals_ref()) {
-    publicationBuffer_[floodRootId].emplace(key);
+    buffer.keys[floodRootId].emplace(key);
   }
   for (auto const& key : *publication.expiredKeys_ref()) {
-    publicationBuffer_[floodRootId].emplace(key);
+    buffer.keys[floodRootId].emplace(key);
   }
 }
 
 template <class ClientType>
-void
-KvStoreDb<ClientType>::floodBufferedUpdates() {
-  if (!publicationBuffer_.size()) {
-    return;
-  }
-
+std::vector<thrift::Publication>
+KvStoreDb<ClientType>::drainPublicationBuffer(PublicationBuffer& buffer) {
   // merged-publications to be sent
   std::vector<thrift::Publication> publications;
 
   // merge publication per root-id
-  for (const auto& [rootId, keys] : publicationBuffer_) {
+  for (const auto& [rootId, keys] : buffer.keys) {
     thrift::Publication publication{};
     // convert from std::optional to std::optional
     std::optional<std::string> floodRootId{std::nullopt};
@@ -3007,9 +4162,31 @@ KvStoreDb<ClientType>::floodBufferedUpdates() {
     publications.emplace_back(std::move(publication));
   }
 
-  publicationBuffer_.clear();
+  buffer.keys.clear();
+  buffer.bufferedSince.reset();
+  return publications;
+}
 
-  for (auto& pub : publications) {
+template <class ClientType>
+void
+KvStoreDb<ClientType>::floodBufferedUpdates(FloodPriority priority) {
+  auto& buffer = publicationBuffers_.at(static_cast<size_t>(priority));
+  if (buffer.keys.empty()) {
+    return;
+  }
+
+  // record time spent by the oldest key in buffer
+  if (buffer.bufferedSince.has_value()) {
+    fb303::fbData->addHistogramValue(
+        fmt::format(
+            "kvstore.flood_priority.{}.queue_delay_ms",
+            getFloodPriorityName(priority)),
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - *buffer.bufferedSince)
+            .count());
+  }
+
+  for (auto& pub : drainPublicationBuffer(buffer)) {
     // when sending out merged publication, we maintain orginal-root-id
     // we act as a forwarder, NOT an initiator. Disable set-flood-root here
     floodPublication(
@@ -3017,6 +4194,91 @@ KvStoreDb<ClientType>::floodBufferedUpdates() {
   }
 }
 
+template <class ClientType>
+std::chrono::milliseconds
+KvStoreDb<ClientType>::getFloodBatchWindow() const {
+  CHECK(kvParams_.floodBatch.has_value());
+  return std::chrono::milliseconds(std::clamp<int64_t>(
+      std::llround(floodRttMs_),
+      *kvParams_.floodBatch->min_window_ms_ref(),
+      *kvParams_.floodBatch->max_window_ms_ref()));
+}
+
+template <class ClientType>
+void
+KvStoreDb<ClientType>::floodBatchedUpdates() {
+  size_t numKeys{0};
+  auto publications = drainPublicationBuffer(floodBatchBuffer_);
+  for (auto const& pub : publications) {
+    numKeys += pub.keyVals_ref()->size() + pub.expiredKeys_ref()->size();
+  }
+  fb303::fbData->addStatValue(
+      "kvstore.flood_batch.num_keys", numKeys, fb303::AVG);
+
+  for (auto& pub : publications) {
+    // same as buffered updates, we act as a forwarder of merged publication
+    floodPublication(
+        std::move(pub),
+        true /* rate-limit */,
+        false /* set-flood-root */,
+        false /* batch */);
+  }
+}
+
+template <class ClientType>
+FloodPriority
+KvStoreDb<ClientType>::getFloodPriority(
+    std::string const& key, bool isTtlUpdate) const {
+  if (isTtlUpdate) {
+    return FloodPriority::HIGH;
+  }
+  for (auto const& prefix : floodHighPriorityKeyPrefixes_) {
+    if (folly::StringPiece(key).startsWith(prefix)) {
+      return FloodPriority::HIGH;
+    }
+  }
+  return FloodPriority::NORMAL;
+}
+
+template <class ClientType>
+std::vector<std::pair<FloodPriority, thrift::Publication>>
+KvStoreDb<ClientType>::splitPublicationByPriority(
+    thrift::Publication&& publication) const {
+  auto keyVals = std::move(*publication.keyVals_ref());
+  auto expiredKeys = std::move(*publication.expiredKeys_ref());
+  publication.keyVals_ref()->clear();
+  publication.expiredKeys_ref()->clear();
+
+  // per-class publications share attributes other than keys, e.g. nodeIds
+  std::array<std::optional<thrift::Publication>, kNumFloodPriorities> pubs;
+  auto getPub = [&](FloodPriority priority) -> thrift::Publication& {
+    auto& pub = pubs.at(static_cast<size_t>(priority));
+    if (not pub.has_value()) {
+      pub.emplace(publication);
+    }
+    return *pub;
+  };
+
+  for (auto& [key, val] : keyVals) {
+    // ATTN: TTL update carries no value
+    auto priority = getFloodPriority(key, not val.value_ref().has_value());
+    getPub(priority).keyVals_ref()->emplace(key, std::move(val));
+  }
+  for (auto& key : expiredKeys) {
+    auto priority = getFloodPriority(key, false /* isTtlUpdate */);
+    getPub(priority).expiredKeys_ref()->emplace_back(std::move(key));
+  }
+
+  std::vector<std::pair<FloodPriority, thrift::Publication>> result;
+  for (size_t i = 0; i < kNumFloodPriorities; ++i) {
+    if (pubs.at(i).has_value()) {
+      result.emplace_back(
+          static_cast<FloodPriority>(i), std::move(pubs.at(i).value()));
+    }
+  }
+  return result;
+}
+
 template <class ClientType>
 void
 KvStoreDb<ClientType>::finalizeFullSync(
@@ -3063,7 +4325,7 @@ KvStoreDb<ClientType>::finalizeFullSync(
     // Skip final full-sync with those peers.
     return;
   }
-  params.senderId_ref() = kvParams_.nodeId;
+  params.senderId_ref() = nodeId;
   XLOG(INFO)
       << AreaTag()
       << fmt::format(
@@ -3076,7 +4338,8 @@ KvStoreDb<ClientType>::finalizeFullSync(
       "kvstore.thrift.num_finalized_sync", 1, fb303::COUNT);
 
   auto startTime = std::chrono::steady_clock::now();
-  auto sf = thriftPeer.client->semifuture_setKvStoreKeyVals(params, area_);
+  auto sf = thriftPeer.client->semifuture_setKvStoreKeyVals(
+      peerRpcOptions_, params, area_);
   std::move(sf)
       .via(evb_->getEvb())
       .thenValue([this, senderId, startTime](folly::Unit&&) {
@@ -3140,31 +4403,75 @@ KvStoreDb<ClientType>::getFloodPeers(const std::optional<std::string>& rootId) {
   return floodPeers;
 }
 
-template <class ClientType>
-void
-KvStoreDb<ClientType>::collectSendFailureStats(
-    const fbzmq::Error& error, const std::string& dstSockId) {
-  fb303::fbData->addStatValue(
-      fmt::format("kvstore.send_failure.{}.{}", dstSockId, error.errNum),
-      1,
-      fb303::COUNT);
-}
-
 template <class ClientType>
 void
 KvStoreDb<ClientType>::floodPublication(
-    thrift::Publication&& publication, bool rateLimit, bool setFloodRoot) {
-  // rate limit if configured
-  if (floodLimiter_ && rateLimit && !floodLimiter_->consume(1)) {
-    bufferPublication(std::move(publication));
-    pendingPublicationTimer_->scheduleTimeout(
-        Constants::kFloodPendingPublication);
-    return;
+    thrift::Publication&& publication,
+    bool rateLimit,
+    bool setFloodRoot,
+    bool batch) {
+  // [Flood Batching]
+  // hold updates arriving faster than peers acknowledge floods and flood them
+  // together once batch window passes.
+  if (floodBatchTimer_ and rateLimit and batch) {
+    const auto now = std::chrono::steady_clock::now();
+    if (lastFloodArrival_.has_value()) {
+      const double intervalMs =
+          std::chrono::duration<double, std::milli>(now - *lastFloodArrival_)
+              .count();
+      if (floodArrivalIntervalMs_ == std::numeric_limits<double>::max()) {
+        floodArrivalIntervalMs_ = intervalMs;
+      } else {
+        floodArrivalIntervalMs_ +=
+            Constants::kFloodBatchEwmaWeight *
+            (intervalMs - floodArrivalIntervalMs_);
+      }
+    }
+    lastFloodArrival_ = now;
+
+    const auto window = getFloodBatchWindow();
+    if (floodBatchTimer_->isScheduled() or
+        floodArrivalIntervalMs_ < window.count()) {
+      addToPublicationBuffer(floodBatchBuffer_, publication);
+      if (not floodBatchTimer_->isScheduled()) {
+        fb303::fbData->addStatValue(
+            "kvstore.flood_batch.window_ms", window.count(), fb303::AVG);
+        floodBatchTimer_->scheduleTimeout(window);
+      }
+      return;
+    }
   }
-  // merge with buffered publication and flood
-  if (publicationBuffer_.size()) {
-    bufferPublication(std::move(publication));
-    return floodBufferedUpdates();
+
+  // rate limit if configured. Each priority class is rate limited on its own.
+  if (kvParams_.floodRate && rateLimit) {
+    for (auto& [priority, pub] :
+         splitPublicationByPriority(std::move(publication))) {
+      fb303::fbData->addStatValue(
+          fmt::format(
+              "kvstore.flood_priority.{}.num_keys",
+              getFloodPriorityName(priority)),
+          pub.keyVals_ref()->size() + pub.expiredKeys_ref()->size(),
+          fb303::SUM);
+
+      const auto i = static_cast<size_t>(priority);
+      if (!floodLimiters_.at(i)->consume(1)) {
+        bufferPublication(priority, std::move(pub));
+        // ATTN: do NOT postpone already scheduled flush of buffered keys
+        if (not pendingPublicationTimer_->isScheduled()) {
+          pendingPublicationTimer_->scheduleTimeout(
+              Constants::kFloodPendingPublication);
+        }
+        continue;
+      }
+      // merge with buffered publication and flood
+      if (not publicationBuffers_.at(i).keys.empty()) {
+        bufferPublication(priority, std::move(pub));
+        floodBufferedUpdates(priority);
+        continue;
+      }
+      floodPublication(std::move(pub), false /* rate-limit */, setFloodRoot);
+    }
+    return;
   }
   // Update ttl on keys we are trying to advertise. Also remove keys which
   // are about to expire.
@@ -3190,7 +4497,7 @@ KvStoreDb<ClientType>::floodPublication(
   publication.nodeIds_ref()->emplace_back(kvParams_.nodeId);
 
   // Flood publication to internal subscribers
-  kvParams_.kvStoreUpdatesQueue.push(publication);
+  publishToLocalSubscribers(publication);
   fb303::fbData->addStatValue("kvstore.num_updates", 1, fb303::COUNT);
 
   // Process potential update to self-originated key-vals
@@ -3223,7 +4530,46 @@ KvStoreDb<ClientType>::floodPublication(
   params.nodeIds_ref().copy_from(publication.nodeIds_ref());
   params.floodRootId_ref().copy_from(publication.floodRootId_ref());
   params.timestamp_ms_ref() = getUnixTimeStampMs();
-  params.senderId_ref() = kvParams_.nodeId;
+  params.senderId_ref() = nodeId;
+
+  // [TTL Refresh Batching]
+  // ttl-only key-vals carry no value, hence hash is of no use. Strip it off
+  // for peers accepting compact ttl updates.
+  std::optional<thrift::KeySetParams> compactParams;
+  for (auto const& [key, val] : *params.keyVals_ref()) {
+    if (val.value_ref().has_value() or not val.hash_ref().has_value()) {
+      continue;
+    }
+    if (not compactParams.has_value()) {
+      compactParams = params;
+    }
+    compactParams->keyVals_ref()->at(key).hash_ref().reset();
+  }
+
+  // [Value Delta]
+  // encode changed large values as delta against their last flooded value
+  // for peers able to apply it
+  std::optional<thrift::KeySetParams> deltaParams;
+  size_t deltaBytesSaved{0};
+  for (auto const& [key, val] : *params.keyVals_ref()) {
+    auto baseIt = deltaBases_.find(key);
+    if (baseIt == deltaBases_.end()) {
+      continue;
+    }
+    auto delta = createValueDelta(baseIt->second, val);
+    deltaBases_.erase(baseIt);
+    if (not delta.has_value()) {
+      continue;
+    }
+    if (not deltaParams.has_value()) {
+      deltaParams = compactParams.has_value() ? *compactParams : params;
+    }
+    deltaBytesSaved +=
+        val.value_ref()->size() - delta->ops_ref()->front().data_ref()->size();
+    auto& deltaVal = deltaParams->keyVals_ref()->at(key);
+    deltaVal.value_ref().reset();
+    deltaVal.delta_ref() = std::move(*delta);
+  }
 
   std::optional<std::string> floodRootId{std::nullopt};
   if (params.floodRootId_ref().has_value()) {
@@ -3231,6 +4577,10 @@ KvStoreDb<ClientType>::floodPublication(
   }
   const auto& floodPeers = getFloodPeers(floodRootId);
 
+  // [Serialized Flood] key-vals serialized once per distinct params
+  std::unordered_map<const thrift::KeySetParams*, thrift::KeySetParams>
+      serializedParams;
+
   for (const auto& peerName : floodPeers) {
     auto peerIt = thriftPeers_.find(peerName);
     if (peerIt == thriftPeers_.end()) {
@@ -3257,6 +4607,32 @@ KvStoreDb<ClientType>::floodPublication(
       continue;
     }
 
+    // [Flood Digest]
+    // skip key-vals peer has recently merged, e.g. from other neighbors
+    std::vector<std::string> seenKeys;
+    if (thriftPeer.floodDigest.has_value() and
+        std::chrono::steady_clock::now() - thriftPeer.floodDigestTime >
+            2 * Constants::kKvStoreFloodDigestInterval) {
+      thriftPeer.floodDigest.reset();
+    }
+    if (thriftPeer.floodDigest.has_value()) {
+      for (auto const& [key, val] : *params.keyVals_ref()) {
+        if (KvStoreFloodDigest::mayContain(
+                *thriftPeer.floodDigest, key, val)) {
+          seenKeys.emplace_back(key);
+        }
+      }
+      fb303::fbData->addStatValue(
+          "kvstore.flood_digest.num_skipped_key_vals",
+          seenKeys.size(),
+          fb303::SUM);
+      if (seenKeys.size() == params.keyVals_ref()->size()) {
+        fb303::fbData->addStatValue(
+            "kvstore.flood_digest.num_skipped_floods", 1, fb303::COUNT);
+        continue;
+      }
+    }
+
     // record telemetry for flooding publications
     fb303::fbData->addStatValue(
         "kvstore.thrift.num_flood_pub", 1, fb303::COUNT);
@@ -3265,11 +4641,51 @@ KvStoreDb<ClientType>::floodPublication(
         publication.keyVals_ref()->size(),
         fb303::SUM);
 
+    const thrift::KeySetParams* peerParams = &params;
+    if (deltaParams.has_value() and thriftPeer.valueDeltas) {
+      peerParams = &deltaParams.value();
+      fb303::fbData->addStatValue(
+          "kvstore.value_delta.num_sent", 1, fb303::COUNT);
+      fb303::fbData->addStatValue(
+          "kvstore.value_delta.bytes_saved", deltaBytesSaved, fb303::SUM);
+    } else if (compactParams.has_value() and thriftPeer.compactTtlUpdates) {
+      peerParams = &compactParams.value();
+    }
+    std::optional<thrift::KeySetParams> unseenParams;
+    if (not seenKeys.empty()) {
+      unseenParams = *peerParams;
+      for (auto const& key : seenKeys) {
+        unseenParams->keyVals_ref()->erase(key);
+      }
+      peerParams = &unseenParams.value();
+    }
+    for (auto const& [key, val] : *peerParams->keyVals_ref()) {
+      *getKeyFamilyStatsOfKey(key).numFloodBytes_ref() +=
+          getKeyValBytes(key, val);
+    }
+    // [Serialized Flood]
+    // share serialized key-vals with other peers, unless trimmed per peer
+    if (thriftPeer.serializedKeyVals and not unseenParams.has_value()) {
+      auto it = serializedParams.find(peerParams);
+      if (it == serializedParams.end()) {
+        it = serializedParams
+                 .emplace(peerParams, serializeKeySetParams(*peerParams))
+                 .first;
+        fb303::fbData->addStatValue(
+            "kvstore.serialized_flood.bytes",
+            it->second.serializedKeyVals_ref()->computeChainDataLength(),
+            fb303::SUM);
+      }
+      peerParams = &it->second;
+      fb303::fbData->addStatValue(
+          "kvstore.serialized_flood.num_sent", 1, fb303::COUNT);
+    }
     auto startTime = std::chrono::steady_clock::now();
-    auto sf = thriftPeer.client->semifuture_setKvStoreKeyVals(params, area_);
+    auto sf = thriftPeer.client->semifuture_setKvStoreKeyVals(
+        peerRpcOptions_, *peerParams, area_);
     std::move(sf)
         .via(evb_->getEvb())
-        .thenValue([peerName, startTime](folly::Unit&&) {
+        .thenValue([this, peerName, startTime](folly::Unit&&) {
           XLOG(DBG4) << "Flooding ack received from peer: " << peerName;
 
           auto endTime = std::chrono::steady_clock::now();
@@ -3277,6 +4693,12 @@ KvStoreDb<ClientType>::floodPublication(
               std::chrono::duration_cast<std::chrono::milliseconds>(
                   endTime - startTime);
 
+          // [Flood Batching] smoothed round-trip time of floods
+          floodRttMs_ += Constants::kFloodBatchEwmaWeight *
+              (std::chrono::duration<double, std::milli>(endTime - startTime)
+                   .count() -
+               floodRttMs_);
+
           // record telemetry for thrift calls
           fb303::fbData->addStatValue(
               "kvstore.thrift.num_flood_pub_success", 1, fb303::COUNT);
@@ -3394,6 +4816,17 @@ size_t
 KvStoreDb<ClientType>::mergePublication(
     const thrift::Publication& rcvdPublication,
     std::optional<std::string> senderId) {
+  // [Value Delta]
+  // restore application data of delta-encoded key-vals before merge
+  if (std::any_of(
+          rcvdPublication.keyVals_ref()->cbegin(),
+          rcvdPublication.keyVals_ref()->cend(),
+          [](auto const& kv) { return kv.second.delta_ref().has_value(); })) {
+    auto publication = rcvdPublication;
+    resolveValueDeltas(publication);
+    return mergePublication(publication, std::move(senderId));
+  }
+
   // Add counters
   fb303::fbData->addStatValue("kvstore.received_publications", 1, fb303::COUNT);
   fb303::fbData->addStatValue(
@@ -3423,6 +4856,17 @@ KvStoreDb<ClientType>::mergePublication(
       keysTobeUpdated.merge(peerIt->second.pendingKeysDuringInitialization);
       peerIt->second.pendingKeysDuringInitialization.clear();
     }
+
+    // [Warm Restart Snapshot]
+    // Peer misses or has older version of unverified key. Hold it back.
+    for (auto it = keysTobeUpdated.begin(); it != keysTobeUpdated.end();) {
+      if (unverifiedKeys_.count(*it)) {
+        staleUnverifiedKeys_.emplace(*it);
+        it = keysTobeUpdated.erase(it);
+      } else {
+        ++it;
+      }
+    }
   }
   const bool needFinalizeFullSync =
       senderId.has_value() and not keysTobeUpdated.empty();
@@ -3441,12 +4885,105 @@ KvStoreDb<ClientType>::mergePublication(
     return 0;
   }
 
+  // [Flood Digest]
+  // ttl update of unknown version means an update was missed, e.g. skipped
+  // by peer on a false positive of our digest. Request key-val in full.
+  if (floodDigestTimer_ and nodeIds.has_value() and not nodeIds->empty()) {
+    std::vector<std::string> missedKeys;
+    for (auto const& [key, rcvdValue] : *rcvdPublication.keyVals_ref()) {
+      if (rcvdValue.value_ref().has_value() or
+          (kvParams_.filters.has_value() and
+           not kvParams_.filters->keyMatch(key, rcvdValue))) {
+        continue;
+      }
+      auto it = kvStore_.find(key);
+      if (it == kvStore_.end() or
+          *it->second.version_ref() < *rcvdValue.version_ref()) {
+        missedKeys.emplace_back(key);
+      }
+    }
+    if (not missedKeys.empty()) {
+      fb303::fbData->addStatValue(
+          "kvstore.flood_digest.num_missed_key_vals",
+          missedKeys.size(),
+          fb303::SUM);
+      requestFullValues(nodeIds->back(), missedKeys);
+    }
+  }
+
+  // Record digests of existing keys before merge to maintain Merkle tree.
+  // Record large values about to be overridden as base of delta flooding.
+  std::unordered_map<std::string, int64_t> oldDigests;
+  std::unordered_map<std::string, int64_t> oldBytes;
+  std::unordered_map<std::string, thrift::Value> deltaBases;
+  for (auto const& [key, rcvdValue] : *rcvdPublication.keyVals_ref()) {
+    auto it = kvStore_.find(key);
+    if (it == kvStore_.end()) {
+      continue;
+    }
+    if (merkleTree_) {
+      oldDigests.emplace(
+          key, KvStoreMerkleTree::getKeyDigest(key, it->second));
+    }
+    oldBytes.emplace(key, getKeyValBytes(key, it->second));
+    if (kvParams_.enableValueDelta and rcvdValue.value_ref().has_value() and
+        it->second.value_ref().has_value() and
+        it->second.value_ref()->size() >=
+            Constants::kKvStoreValueDeltaMinSize and
+        not deltaBases_.count(key)) {
+      deltaBases.emplace(key, it->second);
+    }
+  }
+
   // Generate delta with local KvStore
   thrift::Publication deltaPublication;
   deltaPublication.keyVals_ref() =
-      mergeKeyValues(
-          kvStore_, *rcvdPublication.keyVals_ref(), kvParams_.filters)
-          .first;
+      mergeKeyValsIntoShards(*rcvdPublication.keyVals_ref());
+  if (not deltaPublication.keyVals_ref()->empty()) {
+    // ttl-only updates do change hashes of key-vals as well
+    hashDumpCache_.clear();
+    dumpSnapshot_.reset();
+  }
+
+  // Update Merkle tree, key index and key family stats with merged key-vals.
+  // Ttl-only updates are no-op, except for update count.
+  for (auto const& [key, _] : *deltaPublication.keyVals_ref()) {
+    auto it = kvStore_.find(key);
+    if (it == kvStore_.end()) {
+      continue;
+    }
+    keyIndex_.upsert(key, *it->second.originatorId_ref());
+    if (auto baseIt = deltaBases.find(key); baseIt != deltaBases.end()) {
+      deltaBases_.emplace(key, std::move(baseIt->second));
+    }
+    if (floodDigestTimer_) {
+      floodDigest_.add(key, it->second);
+    }
+    auto oldBytesIt = oldBytes.find(key);
+    addKeyFamilyStats(
+        key,
+        it->second,
+        oldBytesIt != oldBytes.end() ? std::make_optional(oldBytesIt->second)
+                                     : std::nullopt);
+    if (merkleTree_) {
+      auto oldIt = oldDigests.find(key);
+      merkleTree_->update(
+          key,
+          oldIt != oldDigests.end() ? oldIt->second : 0,
+          KvStoreMerkleTree::getKeyDigest(key, it->second));
+    }
+    checkKeyTtl(key, it->second);
+  }
+  if (not deltaPublication.keyVals_ref()->empty()) {
+    reportExpiringKeys();
+  }
+  // merged keys are up to date with the rest of network
+  if (not unverifiedKeys_.empty()) {
+    for (auto const& [key, _] : *deltaPublication.keyVals_ref()) {
+      unverifiedKeys_.erase(key);
+      staleUnverifiedKeys_.erase(key);
+    }
+  }
   deltaPublication.floodRootId_ref().copy_from(
       rcvdPublication.floodRootId_ref());
   deltaPublication.area_ref() = area_;
@@ -3513,88 +5050,64 @@ KvStoreDb<ClientType>::logKvEvent(
   kvParams_.logSampleQueue.push(std::move(sample));
 }
 
+template <class ClientType>
+ClientType*
+KvStoreDb<ClientType>::getDualPeerClient(const std::string& peerName) {
+  auto peerIt = thriftPeers_.find(peerName);
+  if (peerIt == thriftPeers_.end() or
+      not peerIt->second.getOrCreateThriftClient(evb_, kvParams_.maybeIpTos)) {
+    return nullptr;
+  }
+  return peerIt->second.client.get();
+}
+
 template <class ClientType>
 bool
 KvStoreDb<ClientType>::sendDualMessages(
     const std::string& neighbor, const thrift::DualMessages& msgs) noexcept {
-  if (kvParams_.enableThriftDualMsg) {
-    auto peerIt = thriftPeers_.find(neighbor);
-    if (peerIt == thriftPeers_.end() or (not peerIt->second.client)) {
-      XLOG(ERR) << AreaTag()
-                << fmt::format(
-                       "[Dual] Invalid dual peer: {} to set topo cmd. Skip it.",
-                       neighbor);
-      return false;
-    }
+  auto* client = getDualPeerClient(neighbor);
+  if (not client) {
+    XLOG(ERR) << AreaTag()
+              << fmt::format(
+                     "[Dual] Invalid dual peer: {} to send dual messages. "
+                     "Skip.",
+                     neighbor);
+    return false;
+  }
 
-    auto& client = peerIt->second.client;
-    auto startTime = std::chrono::steady_clock::now();
-    auto sf = client->semifuture_processKvStoreDualMessage(msgs, area_);
-    std::move(sf)
-        .via(evb_->getEvb())
-        .thenValue([startTime](folly::Unit&&) {
-          auto endTime = std::chrono::steady_clock::now();
-          auto timeDelta =
-              std::chrono::duration_cast<std::chrono::milliseconds>(
-                  endTime - startTime);
+  auto startTime = std::chrono::steady_clock::now();
+  auto sf = client->semifuture_processKvStoreDualMessage(
+      peerRpcOptions_, msgs, area_);
+  std::move(sf)
+      .via(evb_->getEvb())
+      .thenValue([startTime](folly::Unit&&) {
+        auto endTime = std::chrono::steady_clock::now();
+        auto timeDelta = std::chrono::duration_cast<std::chrono::milliseconds>(
+            endTime - startTime);
 
-          // record telemetry for thrift calls
-          fb303::fbData->addStatValue(
-              "kvstore.thrift.num_dual_msg_success", 1, fb303::COUNT);
-          fb303::fbData->addStatValue(
-              "kvstore.thrift.dual_msg_duration_ms",
-              timeDelta.count(),
-              fb303::AVG);
-        })
-        .thenError([this, neighbor, startTime](
-                       const folly::exception_wrapper& ew) {
-          // state transition to IDLE
-          auto endTime = std::chrono::steady_clock::now();
-          auto timeDelta =
-              std::chrono::duration_cast<std::chrono::milliseconds>(
-                  endTime - startTime);
-          processThriftFailure(
-              neighbor,
-              fmt::format("DUAL MSG failure with {}, {}", neighbor, ew.what()),
-              timeDelta);
+        // record telemetry for thrift calls
+        fb303::fbData->addStatValue(
+            "kvstore.thrift.num_dual_msg_success", 1, fb303::COUNT);
+        fb303::fbData->addStatValue(
+            "kvstore.thrift.dual_msg_duration_ms",
+            timeDelta.count(),
+            fb303::AVG);
+      })
+      .thenError([this, neighbor, startTime](
+                     const folly::exception_wrapper& ew) {
+        // state transition to IDLE
+        auto endTime = std::chrono::steady_clock::now();
+        auto timeDelta = std::chrono::duration_cast<std::chrono::milliseconds>(
+            endTime - startTime);
+        processThriftFailure(
+            neighbor,
+            fmt::format("DUAL MSG failure with {}, {}", neighbor, ew.what()),
+            timeDelta);
 
-          // record telemetry for thrift calls
-          fb303::fbData->addStatValue(
-              "kvstore.thrift.num_dual_msg_failure", 1, fb303::COUNT);
-        });
-  } else {
-    if (peers_.count(neighbor) == 0) {
-      XLOG(ERR) << AreaTag()
-                << fmt::format(
-                       "[Dual] Invalid dual peer: {} to set topo cmd. Skip it.",
-                       neighbor);
-      return false;
-    }
-
-    const auto& neighborCmdSocketId = peers_.at(neighbor).second;
-    thrift::KvStoreRequest dualRequest;
-    dualRequest.cmd_ref() = thrift::Command::DUAL;
-    dualRequest.dualMessages_ref() = msgs;
-    dualRequest.area_ref() = area_;
-    const auto ret = sendMessageToPeer(neighborCmdSocketId, dualRequest);
-    // NOTE: we rely on zmq (on top of tcp) to reliably deliver message,
-    // if we switch to other protocols, we need to make sure its reliability.
-    // Due to zmq async fashion, in case of failure (means the other side
-    // is going down), it's ok to lose this pending message since later on,
-    // neighor will inform us it's gone. and we will delete it from our dual
-    // peers.
-    if (ret.hasError()) {
-      XLOG(ERR)
-          << AreaTag()
-          << fmt::format(
-                 "[Dual] Failed to send dual messages to {}  using id: {}. ",
-                 neighbor,
-                 neighborCmdSocketId)
-          << fmt::format("Error: {}", ret.error().errString);
-      collectSendFailureStats(ret.error(), neighborCmdSocketId);
-      return false;
-    }
-  }
+        // record telemetry for thrift calls
+        fb303::fbData->addStatValue(
+            "kvstore.thrift.num_dual_msg_failure", 1, fb303::COUNT);
+      });
   return true;
 }
 
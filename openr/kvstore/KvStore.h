@@ -7,10 +7,20 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <limits>
+#include <map>
+#include <set>
+#include <thread>
+
 #include <fbzmq/zmq/Zmq.h>
 #include <folly/TokenBucket.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
 #include <folly/gen/Base.h>
 #include <folly/io/async/AsyncTimeout.h>
+#include <thrift/lib/cpp/concurrency/Thread.h>
+#include <thrift/lib/cpp2/async/RpcOptions.h>
 #include <thrift/lib/cpp2/protocol/Serializer.h>
 
 #include <openr/common/AsyncThrottle.h>
@@ -20,7 +30,10 @@
 #include <openr/common/OpenrEventBase.h>
 #include <openr/common/Types.h>
 #include <openr/if/gen-cpp2/KvStore_types.h>
+#include <openr/if/gen-cpp2/OpenrCtrl_types.h>
 #include <openr/kvstore/Dual.h>
+#include <openr/kvstore/KvStoreFloodDigest.h>
+#include <openr/kvstore/KvStoreMerkleTree.h>
 #include <openr/kvstore/KvStoreUtil.h>
 #include <openr/messaging/ReplicateQueue.h>
 #include <openr/monitor/LogSample.h>
@@ -72,7 +85,7 @@ struct KvStoreParams {
   std::string nodeId;
 
   // Queue for publishing KvStore updates to other modules within a process
-  messaging::ReplicateQueue<KvStorePublication>& kvStoreUpdatesQueue;
+  messaging::SharedReplicateQueue<KvStorePublication>& kvStoreUpdatesQueue;
 
   // Queue for publishing kvstore peer initial sync events
   messaging::ReplicateQueue<KvStoreSyncEvent>& kvStoreEventsQueue;
@@ -97,16 +110,37 @@ struct KvStoreParams {
   std::chrono::milliseconds ttlDecr{Constants::kTtlDecrement};
   // TTL for self-originated keys
   std::chrono::milliseconds keyTtl{0};
+  // Use Merkle-tree bucket digests for full-sync
+  bool enableMerkleSync{false};
+  // Hash values with SPOOKY_V2 scheme if all peers support it
+  bool enableFastValueHash{false};
+  // Run KvStoreDb of every area on its own event base
+  bool enableAreaEventBases{false};
+  // Max number of keys per full-sync chunk. Unset for monolithic full-sync.
+  std::optional<int32_t> fullSyncChunkSize;
+  // Request zstd compressed full-sync chunks
+  bool enableFullSyncCompression{false};
+  // Directory of warm-restart snapshots. Unset to disable snapshots.
+  std::optional<std::string> snapshotDir;
+  // Interval of persisting warm-restart snapshots
+  std::chrono::seconds snapshotInterval{Constants::kKvStoreSnapshotInterval};
+  // Flood changes of large values as delta to previous version
+  bool enableValueDelta{false};
+  // Advertise digest of recently merged key-vals to peers
+  bool enableFloodDigest{false};
+  // Bounds of adaptive flood batching window. Unset to flood immediately.
+  std::optional<thrift::KvStoreFloodBatch> floodBatch;
+  // [Key Sharding] number of shards of key-vals of every area
+  size_t numKeyShards{1};
 
   // [TO BE DEPRECATED]
   // DUAL related config knob
   bool enableFloodOptimization{false};
   bool isFloodRoot{false};
-  bool enableThriftDualMsg{false};
 
   KvStoreParams(
       std::string nodeId,
-      messaging::ReplicateQueue<KvStorePublication>& kvStoreUpdatesQueue,
+      messaging::SharedReplicateQueue<KvStorePublication>& kvStoreUpdatesQueue,
       messaging::ReplicateQueue<KvStoreSyncEvent>& kvStoreEventsQueue,
       messaging::ReplicateQueue<LogSample>& logSampleQueue,
       fbzmq::Socket<ZMQ_ROUTER, fbzmq::ZMQ_SERVER> globalCmdSock,
@@ -120,8 +154,7 @@ struct KvStoreParams {
       std::chrono::milliseconds keyTtl,
       // DUAL related config knob
       bool enableFloodOptimization,
-      bool isFloodRoot,
-      bool enableThriftDualMsg)
+      bool isFloodRoot)
       : nodeId(nodeId),
         kvStoreUpdatesQueue(kvStoreUpdatesQueue),
         kvStoreEventsQueue(kvStoreEventsQueue),
@@ -133,10 +166,25 @@ struct KvStoreParams {
         ttlDecr(ttldecr),
         keyTtl(keyTtl),
         enableFloodOptimization(enableFloodOptimization),
-        isFloodRoot(isFloodRoot),
-        enableThriftDualMsg(enableThriftDualMsg) {}
+        isFloodRoot(isFloodRoot) {}
+};
+
+/*
+ * [Flood Priority]
+ *
+ * Priority class of key-vals when flooding is rate limited. Each class has its
+ * own token bucket and buffer, so that bulk updates (e.g. mass prefix churn)
+ * can not delay urgent ones. Buffers are flushed in ascending order.
+ */
+enum class FloodPriority : uint8_t {
+  // keys matching `high_priority_key_prefixes` and TTL updates
+  HIGH = 0,
+  // everything else
+  NORMAL = 1,
 };
 
+constexpr size_t kNumFloodPriorities{2};
+
 /*
  * The KvStoreDb class represents a KV Store database and stores KV pairs in
  * an internal map. KV store DB instance is created for each area.
@@ -151,7 +199,6 @@ class KvStoreDb : public DualNode {
       OpenrEventBase* evb,
       KvStoreParams& kvParams,
       const std::string& area,
-      fbzmq::Socket<ZMQ_ROUTER, fbzmq::ZMQ_CLIENT> peersyncSock,
       bool isFloodRoot,
       const std::string& nodeId,
       std::function<void()> initialKvStoreSyncedCallback);
@@ -187,7 +234,7 @@ class KvStoreDb : public DualNode {
     return selfOriginatedKeyVals_;
   }
 
-  std::unordered_map<std::string, thrift::Value> const&
+  KvStoreShardedMap const&
   getKeyValueMap() const {
     return kvStore_;
   }
@@ -195,8 +242,57 @@ class KvStoreDb : public DualNode {
   getTtlCountdownQueue() const {
     return ttlCountdownQueue_;
   }
+  // nullptr unless Merkle-tree sync is enabled
+  inline KvStoreMerkleTree const*
+  getMerkleTree() const {
+    return merkleTree_ ? &*merkleTree_ : nullptr;
+  }
+  inline KvStoreKeyIndex const&
+  getKeyIndex() const {
+    return keyIndex_;
+  }
+
+  /*
+   * [Hash Dump Cache]
+   *
+   * Hash dump of key-vals matching any of the key prefixes. Dump is built once
+   * and served from cache until KvStoreDb changes, i.e. merge, expiry or
+   * purge of key-vals. Caller MUST copy it before updating ttl.
+   */
+  std::shared_ptr<const thrift::Publication> dumpHashes(
+      std::vector<std::string> const& keyPrefixList);
+
+  /*
+   * [Snapshot Dump]
+   *
+   * Snapshot of all key-vals as of the latest publication to local
+   * subscribers. Snapshot is taken once and shared until KvStoreDb changes,
+   * so that dumps of reconnecting subscribers are filtered and serialized off
+   * the area event base.
+   */
+  std::shared_ptr<const KvStoreDumpSnapshot> getDumpSnapshot();
+
+  // dump key-vals falling into given Merkle-tree buckets. Used to respond
+  // full-sync request carrying bucket digests.
+  thrift::Publication dumpDifferingBuckets(
+      std::vector<int32_t> const& differingBuckets) const;
+
+  /*
+   * [Warm Restart Snapshot]
+   *
+   * Remove key-vals loaded from snapshot but NOT yet reconciled with peers
+   * from full-sync response, so that stale keys are never handed to peers.
+   */
+  void removeUnverifiedKeys(thrift::Publication& pub) const;
+
+  inline size_t
+  getNumUnverifiedKeys() const {
+    return unverifiedKeys_.size();
+  }
 
   // [TO BE DEPRECATED]
+  // Requests of peers of older versions over ZMQ. Dual messages and flood
+  // topology updates are sent over thrift, see getDualPeerClient().
   folly::Expected<fbzmq::Message, fbzmq::Error> processRequestMsgHelper(
       const std::string& requestId, thrift::KvStoreRequest& thriftReq);
 
@@ -206,6 +302,12 @@ class KvStoreDb : public DualNode {
   // Calculate size of KvStoreDB (just the key/val pairs)
   size_t getKeyValsSize() const;
 
+  // [Key Family Accounting] memory and churn of key families in this area
+  inline std::unordered_map<std::string, thrift::KvStoreKeyFamilyStats> const&
+  getKeyFamilyStats() const {
+    return keyFamilyStats_;
+  }
+
   // get multiple keys at once
   thrift::Publication getKeyVals(std::vector<std::string> const& keys);
 
@@ -302,7 +404,9 @@ class KvStoreDb : public DualNode {
    *      ttl-refreshing.
    */
   void persistSelfOriginatedKey(
-      std::string const& key, std::string const& value);
+      std::string const& key,
+      std::string const& value,
+      std::vector<int64_t> const& traceIds = {});
   void setSelfOriginatedKey(
       std::string const& key, std::string const& value, uint32_t version);
   void unsetSelfOriginatedKey(std::string const& key, std::string const& value);
@@ -332,6 +436,26 @@ class KvStoreDb : public DualNode {
    */
   void requestThriftPeerSync();
 
+  /*
+   * [Initial Sync]
+   *
+   * util methods to send full-sync request to peer in SYNCING state:
+   *    1) Monolithic, i.e. peer responds with all keys at once;
+   *    2) Chunked, i.e. peer responds with keys after `cursor` up to the
+   *       configured chunk size. Chunks are merged as they arrive and peer
+   *       stays in SYNCING state until the last chunk.
+   */
+  void requestThriftPeerFullSync(
+      std::string const& peerName,
+      std::chrono::steady_clock::time_point startTime);
+  void requestThriftPeerSyncChunk(
+      std::string const& peerName,
+      std::optional<std::string> const& cursor,
+      std::chrono::steady_clock::time_point startTime);
+
+  // util method to build KeyDumpParams of full-sync request, without hashes
+  thrift::KeyDumpParams getFullSyncDumpParams() const;
+
   /*
    * [Initial Sync]
    *
@@ -356,11 +480,90 @@ class KvStoreDb : public DualNode {
       thrift::Publication&& pub,
       std::chrono::milliseconds timeDelta);
 
+  /*
+   * [Initial Sync]
+   *
+   * util method to populate `tobeUpdatedKeys` for full-sync response received
+   * in Merkle-tree bucket mode, where responder doesn't know our key-vals.
+   * Keys are scoped to `differingBuckets` if set, or all keys otherwise
+   * (e.g. responder doesn't support bucket digests).
+   *
+   * ATTN: MUST be called before merging the response into local store.
+   */
+  void populateTobeUpdatedKeys(thrift::Publication& pub) const;
+
   void processThriftFailure(
       std::string const& peerName,
       folly::fbstring const& exceptionStr,
       std::chrono::milliseconds timeDelta);
 
+  // util method to process one chunk of chunked full-sync response
+  void processThriftSyncChunk(
+      std::string const& peerName,
+      uint64_t fullSyncId,
+      thrift::KvStoreSyncChunk&& chunk,
+      std::chrono::steady_clock::time_point startTime);
+
+  /*
+   * [Warm Restart Snapshot]
+   *
+   * KvStoreDb periodically persists key-vals learnt from other nodes into a
+   * snapshot file. On start, the snapshot is loaded and published to local
+   * subscribers right away, while every loaded key is marked as unverified:
+   *    1) unverified key is never flooded or sent to peers;
+   *    2) key gets verified once it is merged from any peer, or NOT reported
+   *       as missing/outdated by full-sync response of a peer, in which case
+   *       it is identical on both sides;
+   *    3) key reported as missing/outdated by a peer is purged when initial
+   *       sync completes, unless it got verified meanwhile;
+   *
+   * Since peers only reply with differences to our hashes, initial full-sync
+   * of a warmed up KvStoreDb carries little more than actual changes.
+   */
+  void loadSnapshot();
+  void persistSnapshot();
+  void reconcileUnverifiedKeys();
+
+  /*
+   * [Value Delta]
+   *
+   * Restore application data of delta-encoded key-vals in place. Key-vals
+   * whose base is missing locally are dropped from publication and requested
+   * in full from the last hop of publication.
+   */
+  void resolveValueDeltas(thrift::Publication& publication);
+
+  // fetch full key-vals from peer and merge them
+  void requestFullValues(
+      std::string const& peerName, std::vector<std::string> const& keys);
+
+  /*
+   * [Flood Digest]
+   *
+   * Rotate digest of recently merged key-vals and send it to all initialized
+   * peers with an otherwise empty `setKvStoreKeyVals` request.
+   */
+  void advertiseFloodDigest();
+
+  /*
+   * [Key Family Accounting]
+   *
+   * Stats of family of the key. Families beyond
+   * Constants::kKvStoreMaxKeyFamilies share kKvStoreKeyFamilyOther.
+   */
+  thrift::KvStoreKeyFamilyStats& getKeyFamilyStatsOfKey(
+      std::string const& key);
+
+  // account merged key-val, replacing `oldBytes` if key existed before
+  void addKeyFamilyStats(
+      std::string const& key,
+      thrift::Value const& value,
+      std::optional<int64_t> oldBytes);
+
+  // account key-val removed from kvStore_
+  void removeKeyFamilyStats(
+      std::string const& key, thrift::Value const& value);
+
   /*
    * [Incremental flooding]
    *
@@ -369,11 +572,28 @@ class KvStoreDb : public DualNode {
    * @param: publication => data element to flood
    * @param: rateLimit => if 'false', publication will not be rate limited
    * @param: setFloodRoot => if 'false', floodRootId will not be set
+   * @param: batch => if 'false', publication will not be batched
    */
   void floodPublication(
       thrift::Publication&& publication,
       bool rateLimit = true,
-      bool setFloodRoot = true);
+      bool setFloodRoot = true,
+      bool batch = true);
+
+  // [Snapshot Dump] push publication to local subscribers, tagged with the
+  // next sequence number of the area
+  void publishToLocalSubscribers(thrift::Publication publication);
+
+  /*
+   * [Flood Batching]
+   *
+   * Window to hold updates for before flooding them together, i.e. smoothed
+   * peer round-trip time of floods within configured bounds.
+   *
+   * Flood all updates batched within the window.
+   */
+  std::chrono::milliseconds getFloodBatchWindow() const;
+  void floodBatchedUpdates();
 
   /*
    * [Incremental flooding]
@@ -389,11 +609,37 @@ class KvStoreDb : public DualNode {
   /*
    * [Incremental flooding]
    *
-   * buffer publications blocked by the rate limiter
-   * flood pending update blocked by rate limiter
+   * buffer publications blocked by the rate limiter of the priority class
+   * flood pending update of the priority class blocked by rate limiter
    */
-  void bufferPublication(thrift::Publication&& publication);
-  void floodBufferedUpdates();
+  void bufferPublication(
+      FloodPriority priority, thrift::Publication&& publication);
+  void floodBufferedUpdates(FloodPriority priority);
+
+  struct PublicationBuffer;
+
+  /*
+   * merge keys of publication into buffer. Only keys are kept, latest value
+   * of each key is read from kvStore_ when the buffer is drained.
+   *
+   * build publications, one per flood-root-id, out of buffered keys and
+   * clear buffer
+   */
+  void addToPublicationBuffer(
+      PublicationBuffer& buffer, thrift::Publication const& publication);
+  std::vector<thrift::Publication> drainPublicationBuffer(
+      PublicationBuffer& buffer);
+
+  /*
+   * [Flood Priority]
+   *
+   * util method to classify key, or TTL update of the key. And to split
+   * publication into per-class publications in ascending priority order.
+   */
+  FloodPriority getFloodPriority(std::string const& key, bool isTtlUpdate)
+      const;
+  std::vector<std::pair<FloodPriority, thrift::Publication>>
+  splitPublicationByPriority(thrift::Publication&& publication) const;
 
   /*
    * [Dual]
@@ -408,6 +654,16 @@ class KvStoreDb : public DualNode {
       const std::string& neighbor,
       const thrift::DualMessages& msgs) noexcept override;
 
+  /*
+   * [Dual]
+   *
+   * Thrift client of a dual peer, created on demand. Dual messages and
+   * flood topology updates share the connection of flooding and full-sync,
+   * and are sent in order on it. nullptr if peer is unknown or its client
+   * can't be created.
+   */
+  ClientType* getDualPeerClient(const std::string& peerName);
+
   /*
    * [Dual]
    *
@@ -455,10 +711,21 @@ class KvStoreDb : public DualNode {
       const std::string& rootId, const std::string& peerName) noexcept;
   void unsetChildAll(const std::string& peerName) noexcept;
 
+  /*
+   * [Key Sharding]
+   *
+   * mergeKeyValues() of keyVals into kvStore_. Key-vals of large publications
+   * are split by shard once, and every slice merged into its shard on its own
+   * worker. Merged key-vals of all shards are gathered. Blocks until all
+   * shards are done, hence publications are still merged one after another.
+   */
+  std::unordered_map<std::string, thrift::Value> mergeKeyValsIntoShards(
+      std::unordered_map<std::string, thrift::Value> const& keyVals);
+
   /*
    * [Ttl Management]
    *
-   * add new query entries into ttlCountdownQueue from publication
+   * add or refresh (in place) ttlCountdownQueue entries from publication
    * and reschedule ttl expiry timer if needed
    */
   void updateTtlCountdownQueue(const thrift::Publication& publication);
@@ -470,22 +737,18 @@ class KvStoreDb : public DualNode {
    */
   void cleanupTtlCountdownQueue();
 
-  // [TO BE DEPRECATED]
-  // collect router-client send failure statistics in following form
-  // "kvstore.send_failure.dst-peer-id.error-code"
-  // error: fbzmq-Error
-  // dstSockId: destination socket identity
-  void collectSendFailureStats(
-      const fbzmq::Error& error, const std::string& dstSockId);
-
-  // [TO BE DEPRECATED]
-  // this will poll the sockets listening to the requests
-  void attachCallbacks();
+  /*
+   * [Hash Scheme]
+   *
+   * Hash scheme to originate values with. SPOOKY_V2 is ONLY used when it is
+   * enabled locally AND supported by every peer in the area.
+   */
+  thrift::KvStoreHashScheme getHashScheme() const;
 
-  // [TO BE DEPRECATED]
-  // Send message via socket
-  folly::Expected<size_t, fbzmq::Error> sendMessageToPeer(
-      const std::string& peerSocketId, const thrift::KvStoreRequest& request);
+  // schedule ttlCountdownTimer_ to fire at `dueTime`
+  void scheduleTtlCountdownTimer(
+      std::chrono::steady_clock::time_point dueTime,
+      std::chrono::steady_clock::time_point now);
 
   /*
    * [Logging]
@@ -512,6 +775,20 @@ class KvStoreDb : public DualNode {
   void advertiseTtlUpdates();
   void scheduleTtlUpdates(std::string const& key, bool advertiseImmediately);
 
+  /*
+   * [TTL Refresh Batching]
+   *
+   * Ttl refreshes are advertised in time-aligned batches instead of on each
+   * key's own schedule: timer fires at boundaries of `ttlRefreshBatchWindow_`
+   * (shifted by per-instance random phase to spread load across nodes), and
+   * every key due within the next window is refreshed early. Refreshes of
+   * all keys thus converge into one publication per peer per window.
+   *
+   * @return timeout to the first window boundary not before `timeout`
+   */
+  std::chrono::milliseconds getTtlRefreshBatchTimeout(
+      std::chrono::milliseconds timeout) const;
+
   /*
    * [Self Originated Key Management with throttling]
    *
@@ -540,28 +817,26 @@ class KvStoreDb : public DualNode {
   /*
    * [Monitoring]
    *
-   * fiber task and util function to periodically dump flooding topology.
-   *
-   * Signaling part consists of:
-   *  - Promise retained in state variable of KvStoreDb. Fiber awaits on it.
-   *    The promise is fulfilled in destructor of KvStoreDb.
-   *  - SemiFuture is passed to fiber for awaiting.
+   * Dump flooding topology upon change of DUAL state or of peers. Changes
+   * within one event loop iteration are dumped once, and only if SPT root or
+   * flood peers differ from the last dump.
    */
   void floodTopoDump() noexcept;
-  void floodTopoDumpTask() noexcept;
+  void scheduleFloodTopoDump() noexcept;
 
   /*
    * [Monitoring]
    *
-   * fiber task and util function to periodically check key ttl
+   * Track adj keys with ttl under threshold as they are merged, expired or
+   * purged, and report the ones whose originator is a peer.
    *
    * ATTN:
    *  - Adjacency key can be very important for LSDB protocol to run;
    *  - Adjacency key should NEVER be under certain threshold if KvStore
    *    has the adj key originator in its peer collection.
    */
-  void checkKeyTtl() noexcept;
-  void checkKeyTtlTask() noexcept;
+  void checkKeyTtl(std::string const& key, thrift::Value const& value);
+  void reportExpiringKeys() noexcept;
 
   /*
    * Private variables
@@ -576,10 +851,6 @@ class KvStoreDb : public DualNode {
   // area id tag for logging purpose
   const std::string areaTag_;
 
-  // [TO BE DEPRECATED]
-  // zmq ROUTER socket for requesting full dumps from peers
-  fbzmq::Socket<ZMQ_ROUTER, fbzmq::ZMQ_CLIENT> peerSyncSock_;
-
   // KvStore peer struct to convey peer information
   struct KvStorePeer {
     KvStorePeer(
@@ -624,39 +895,124 @@ class KvStoreDb : public DualNode {
     // Number of occured Thrift API errors in the process of syncing with
     // peer.
     int64_t numThriftApiErrors{0};
+
+    // Highest hash scheme advertised by peer in its full-sync response
+    thrift::KvStoreHashScheme hashScheme{
+        thrift::KvStoreHashScheme::BOOST_HASH_COMBINE};
+
+    // Identify current round of full-sync, bumped on every IDLE -> SYNCING
+    // transition. Responses of previous rounds are dropped.
+    uint64_t fullSyncId{0};
+
+    // Unset once peer is found NOT to serve chunked full-sync
+    bool chunkedSyncSupported{true};
+
+    // Set if peer accepts ttl-only key-vals without hash
+    bool compactTtlUpdates{false};
+
+    // Set if peer is able to apply delta-encoded values
+    bool valueDeltas{false};
+
+    // Set if peer accepts key-vals serialized once per flood
+    bool serializedKeyVals{false};
+
+    // Latest digest of key-vals recently merged by peer and time received
+    std::optional<thrift::KvStoreFloodDigest> floodDigest;
+    std::chrono::steady_clock::time_point floodDigestTime;
   };
 
   // Set of peers with all info over thrift channel
   std::unordered_map<std::string, KvStorePeer> thriftPeers_{};
 
-  // [TO BE DEPRECATED]
-  // The peers we will be talking to: both PUB and CMD URLs for each. We use
-  // peerAddCounter_ to uniquely identify a peering session's socket-id.
-  uint64_t peerAddCounter_{0};
-  std::unordered_map<
-      std::string /* node-name */,
-      std::pair<thrift::PeerSpec, std::string /* socket-id */>>
-      peers_;
+  // Options of every request to peers. Requests are sent in HIGH priority,
+  // served by peer-sync worker pool of the ctrl server rather than the one
+  // shared with operator and monitoring clients.
+  apache::thrift::RpcOptions peerRpcOptions_;
 
-  // [TO BE DEPRECATED]
-  // the serializer/deserializer helper we'll be using
-  apache::thrift::CompactSerializer serializer_;
+  // [Dual] Peers added with flood optimization enabled, to tell restarted
+  // peers from updated ones
+  std::unordered_map<std::string /* node-name */, thrift::PeerSpec>
+      dualPeers_;
 
   // Boolean flag indicating whether initial KvStoreDb sync with all peers
   // completed in OpenR initialization procedure.
-  bool initialSyncCompleted_{false};
+  // ATTN: read by KvStore from outside of the area event base.
+  std::atomic<bool> initialSyncCompleted_{false};
+
+  // store keys mapped to (version, originatoId, value), see [Key Sharding]
+  KvStoreShardedMap kvStore_;
+
+  // [Key Sharding] workers merging key-vals into shards of kvStore_. Only set
+  // with more than one shard.
+  std::unique_ptr<folly::CPUThreadPoolExecutor> mergeExecutor_;
+
+  // TTL count down queue. Timing wheel with one entry per key.
+  TtlCountdownQueue ttlCountdownQueue_{Constants::kTtlCountdownTick};
+
+  // Merkle tree over kvStore_ for bucketed full-sync. Kept up to date
+  // incrementally on every merge/expiry. Only maintained if Merkle-tree sync
+  // is enabled, i.e. `enableMerkleSync`.
+  std::optional<KvStoreMerkleTree> merkleTree_;
+
+  // Ordered key and originator index over kvStore_ for filtered dump. Kept
+  // up to date incrementally on every merge/expiry.
+  KvStoreKeyIndex keyIndex_;
+
+  // keys loaded from warm-restart snapshot and NOT yet verified by peers
+  std::unordered_set<std::string> unverifiedKeys_;
+
+  // adj keys merged with ttl under threshold, see checkKeyTtl()
+  std::unordered_set<std::string> expiringKeys_;
+
+  // SPT root and flood peers of the last flood topology dump, and timer
+  // coalescing changes into one dump
+  std::optional<std::pair<std::optional<std::string>, std::set<std::string>>>
+      lastFloodTopo_;
+  std::unique_ptr<folly::AsyncTimeout> floodTopoDumpTimer_;
+
+  // unverified keys reported as missing/outdated by peers during full-sync
+  std::unordered_set<std::string> staleUnverifiedKeys_;
 
-  // store keys mapped to (version, originatoId, value)
-  std::unordered_map<std::string, thrift::Value> kvStore_;
+  // timer to periodically persist warm-restart snapshot
+  std::unique_ptr<folly::AsyncTimeout> snapshotTimer_;
 
-  // TTL count down queue
-  TtlCountdownQueue ttlCountdownQueue_;
+  // last flooded value of large keys updated since, i.e. base of delta in
+  // next flooding of the key
+  std::unordered_map<std::string, thrift::Value> deltaBases_;
+
+  // memory and churn accounting per key family. Kept up to date
+  // incrementally on every merge/expiry/flood.
+  std::unordered_map<std::string, thrift::KvStoreKeyFamilyStats>
+      keyFamilyStats_;
+
+  // hash dumps of kvStore_ keyed by key prefix filters. Cleared whenever
+  // kvStore_ changes.
+  std::map<
+      std::vector<std::string> /* keyPrefixList */,
+      std::shared_ptr<const thrift::Publication>>
+      hashDumpCache_;
+
+  // [Snapshot Dump] sequence number of the latest publication to local
+  // subscribers, and snapshot of kvStore_ reset whenever kvStore_ changes
+  int64_t publicationSeqNum_{0};
+  std::shared_ptr<const KvStoreDumpSnapshot> dumpSnapshot_;
+
+  // digest of recently merged key-vals and timer to advertise it to peers
+  KvStoreFloodDigest floodDigest_;
+  std::unique_ptr<folly::AsyncTimeout> floodDigestTimer_;
 
   // TTL count down timer
   std::unique_ptr<folly::AsyncTimeout> ttlCountdownTimer_;
 
-  // Kvstore rate limiter
-  std::unique_ptr<folly::BasicTokenBucket<>> floodLimiter_{nullptr};
+  // time at which ttlCountdownTimer_ is going to fire, if scheduled
+  std::optional<std::chrono::steady_clock::time_point> ttlCountdownTimerExpiry_;
+
+  // Kvstore rate limiter per flood priority class
+  std::array<std::unique_ptr<folly::BasicTokenBucket<>>, kNumFloodPriorities>
+      floodLimiters_{};
+
+  // key prefixes flooded in FloodPriority::HIGH
+  std::vector<std::string> floodHighPriorityKeyPrefixes_;
 
   // timer to send pending kvstore publication
   std::unique_ptr<folly::AsyncTimeout> pendingPublicationTimer_{nullptr};
@@ -670,6 +1026,11 @@ class KvStoreDb : public DualNode {
   // timer to advertise ttl updates for self-originated key-vals
   std::unique_ptr<folly::AsyncTimeout> selfOriginatedKeyTtlTimer_;
 
+  // window of batching ttl updates and random phase of window boundaries
+  std::chrono::milliseconds ttlRefreshBatchWindow_{
+      Constants::kTtlRefreshBatchWindow};
+  std::chrono::milliseconds ttlRefreshBatchPhase_{0};
+
   // timer to advertise key-vals for self-originated keys
   std::unique_ptr<folly::AsyncTimeout> advertiseKeyValsTimer_;
 
@@ -685,6 +1046,10 @@ class KvStoreDb : public DualNode {
   // Set of local keys to be re-advertised.
   std::unordered_set<std::string /* key */> keysToAdvertise_;
 
+  // Convergence trace ids of keys to be re-advertised, see ConvergenceTracer
+  std::unordered_map<std::string /* key */, std::vector<int64_t>>
+      keysToAdvertiseTraceIds_;
+
   // Throttle advertisement of self-originated persisted keys.
   // Calls `advertiseSelfOriginatedKeys()`.
   std::unique_ptr<AsyncThrottle> advertiseSelfOriginatedKeysThrottled_;
@@ -697,11 +1062,31 @@ class KvStoreDb : public DualNode {
   // Calls `unsetPendingSelfOriginatedKeys()`.
   std::unique_ptr<AsyncThrottle> unsetSelfOriginatedKeysThrottled_;
 
-  // pending keys to flood publication
-  // map<flood-root-id: set<keys>>
-  std::
-      unordered_map<std::optional<std::string>, std::unordered_set<std::string>>
-          publicationBuffer_{};
+  struct PublicationBuffer {
+    // pending keys to flood publication
+    // map<flood-root-id: set<keys>>
+    std::unordered_map<
+        std::optional<std::string>,
+        std::unordered_set<std::string>>
+        keys;
+
+    // time at which the oldest pending key got buffered
+    std::optional<std::chrono::steady_clock::time_point> bufferedSince;
+  };
+
+  // pending publications per flood priority class
+  std::array<PublicationBuffer, kNumFloodPriorities> publicationBuffers_{};
+
+  // [Flood Batching] updates held within current batch window and timer to
+  // flood them
+  PublicationBuffer floodBatchBuffer_;
+  std::unique_ptr<folly::AsyncTimeout> floodBatchTimer_;
+
+  // smoothed interval between updates to flood and peer round-trip time of
+  // floods. Interval starts high so that first updates are never held back.
+  std::optional<std::chrono::steady_clock::time_point> lastFloodArrival_;
+  double floodArrivalIntervalMs_{std::numeric_limits<double>::max()};
+  double floodRttMs_{0};
 
   // Callback function to signal KvStore that KvStoreDb sync with all peers
   // are completed.
@@ -712,12 +1097,6 @@ class KvStoreDb : public DualNode {
   // response received
   size_t parallelSyncLimitOverThrift_{2};
 
-  // Stop signal for fiber to periodically dump flood topology
-  folly::fibers::Baton floodTopoStopSignal_;
-
-  // Stop signal for fiber to periodically check adj key ttl
-  folly::fibers::Baton ttlCheckStopSignal_;
-
   // event loop
   OpenrEventBase* evb_{nullptr};
 };
@@ -735,7 +1114,7 @@ class KvStore final : public OpenrEventBase {
       // the zmq context to use for IO
       fbzmq::Context& zmqContext,
       // Queue for publishing kvstore updates
-      messaging::ReplicateQueue<KvStorePublication>& kvStoreUpdatesQueue,
+      messaging::SharedReplicateQueue<KvStorePublication>& kvStoreUpdatesQueue,
       // [TO BE DEPRECATED] Queue for publishing kvstore initial sync events
       messaging::ReplicateQueue<KvStoreSyncEvent>& kvStoreEventsQueue,
       // Queue for receiving peer updates
@@ -751,7 +1130,7 @@ class KvStore final : public OpenrEventBase {
       // KvStoreConfig to drive the instance
       const thrift::KvStoreConfig& kvStoreConfig);
 
-  ~KvStore() override = default;
+  ~KvStore() override;
 
   void stop() override;
 
@@ -783,6 +1162,11 @@ class KvStore final : public OpenrEventBase {
       thrift::KeyDumpParams keyDumpParams,
       std::set<std::string> selectAreas = {});
 
+  // [Snapshot Dump] snapshots of selected areas, see
+  // KvStoreDb::getDumpSnapshot(). Unknown areas are skipped.
+  folly::SemiFuture<std::vector<std::shared_ptr<const KvStoreDumpSnapshot>>>
+  semifuture_getKvStoreDumpSnapshots(std::set<std::string> selectAreas);
+
   folly::SemiFuture<std::unique_ptr<SelfOriginatedKeyVals>>
   semifuture_dumpKvStoreSelfOriginatedKeys(std::string area);
 
@@ -790,6 +1174,20 @@ class KvStore final : public OpenrEventBase {
   semifuture_dumpKvStoreHashes(
       std::string area, thrift::KeyDumpParams keyDumpParams);
 
+  // serve one chunk of full-sync, see thrift::KvStoreSyncChunkParams
+  folly::SemiFuture<std::unique_ptr<thrift::KvStoreSyncChunk>>
+  semifuture_getKvStoreSyncChunk(
+      std::string area,
+      thrift::KeyDumpParams keyDumpParams,
+      thrift::KvStoreSyncChunkParams chunkParams);
+
+  // serve one page of key-vals in key order, see [Paginated Dump]
+  folly::SemiFuture<std::unique_ptr<thrift::KvStoreKeyValsPage>>
+  semifuture_getKvStoreKeyValsPage(
+      std::string area,
+      thrift::KeyDumpParams keyDumpParams,
+      thrift::PageParams pageParams);
+
   /*
    * [Public APIs]
    *
@@ -829,10 +1227,15 @@ class KvStore final : public OpenrEventBase {
   semifuture_getKvStoreAreaSummaryInternal(
       std::set<std::string> selectAreas = {});
 
+  // [Key Family Accounting] memory and churn per key family of an area
+  folly::SemiFuture<
+      std::unique_ptr<std::map<std::string, thrift::KvStoreKeyFamilyStats>>>
+  semifuture_getKvStoreKeyFamilyStats(std::string area);
+
   folly::SemiFuture<std::map<std::string, int64_t>> semifuture_getCounters();
 
   // API to get reader for kvStoreUpdatesQueue
-  messaging::RQueue<KvStorePublication> getKvStoreUpdatesReader();
+  messaging::SharedRQueue<KvStorePublication> getKvStoreUpdatesReader();
 
   // API to fetch state of peerNode, used for unit-testing
   folly::SemiFuture<std::optional<thrift::KvStorePeerState>>
@@ -859,9 +1262,10 @@ class KvStore final : public OpenrEventBase {
 
   // [TO BE DEPRECATED]
   // This function wraps `processRequestMsgHelper` and updates send/received
-  // bytes counters.
-  folly::Expected<fbzmq::Message, fbzmq::Error> processRequestMsg(
-      const std::string& requestId, fbzmq::Message&& msg);
+  // bytes counters. Request is served on event base of the area, and the
+  // response completed from there.
+  folly::SemiFuture<folly::Expected<fbzmq::Message, fbzmq::Error>>
+  processRequestMsg(const std::string& requestId, fbzmq::Message&& msg);
 
   // util function to process peer updates
   void processPeerUpdates(PeerEvent&& event);
@@ -873,12 +1277,23 @@ class KvStore final : public OpenrEventBase {
    */
   void processKeyValueRequest(KeyValueRequest&& kvRequest);
 
+  // Apply one key-value request to kvStoreDb of its area
+  void applyKeyValueRequest(
+      KvStoreDb<ClientType>& kvStoreDb, const SetKeyValueRequest& request);
+  void applyKeyValueRequest(
+      KvStoreDb<ClientType>& kvStoreDb, const PersistKeyValueRequest& request);
+  void applyKeyValueRequest(
+      KvStoreDb<ClientType>& kvStoreDb, const ClearKeyValueRequest& request);
+  void applyKeyValueRequest(
+      KvStoreDb<ClientType>& kvStoreDb, const BatchKeyValueRequest& request);
+
   /*
    * [Counter]
    *
-   * util methods called by getCounters() public API
+   * util methods called by getCounters() public API. Counters of every area
+   * are read on event base of the area and added up.
    */
-  std::map<std::string, int64_t> getGlobalCounters() const;
+  folly::SemiFuture<std::map<std::string, int64_t>> getGlobalCounters();
   void initGlobalCounters();
 
   /*
@@ -892,6 +1307,33 @@ class KvStore final : public OpenrEventBase {
   KvStoreDb<ClientType>& getAreaDbOrThrow(
       std::string const& areaId, std::string const& caller);
 
+  /*
+   * [Area Event Base]
+   *
+   * Return event base hosting KvStoreDb of the area. This is KvStore's own
+   * event base unless `enableAreaEventBases` is set. Follows the same default
+   * area fallback as `getAreaDbOrThrow()`.
+   */
+  OpenrEventBase* getAreaEvb(std::string const& areaId);
+
+  // util method to dump keys of single area. Must run on the area event base.
+  thrift::Publication dumpKvStoreKeysFromArea(
+      std::string const& area, thrift::KeyDumpParams const& keyDumpParams);
+
+  // util method to dump one full-sync chunk of single area. Must run on the
+  // area event base.
+  thrift::KvStoreSyncChunk dumpKvStoreSyncChunkFromArea(
+      std::string const& area,
+      thrift::KeyDumpParams const& keyDumpParams,
+      thrift::KvStoreSyncChunkParams const& chunkParams);
+
+  // util method to dump one page of key-vals of single area. Must run on the
+  // area event base.
+  thrift::KvStoreKeyValsPage dumpKvStoreKeysPageFromArea(
+      std::string const& area,
+      thrift::KeyDumpParams const& keyDumpParams,
+      thrift::PageParams const& pageParams);
+
   /*
    * Private variables
    */
@@ -902,6 +1344,13 @@ class KvStore final : public OpenrEventBase {
   // kvstore parameters common to all kvstoreDB
   KvStoreParams kvParams_;
 
+  // [Area Event Base]
+  // dedicated event base and thread per area. Declared ahead of `kvStoreDb_`
+  // to outlive KvStoreDb instances scheduled on them.
+  std::unordered_map<std::string /* area ID */, std::unique_ptr<OpenrEventBase>>
+      areaEvbs_{};
+  std::vector<std::thread> areaEvbThreads_{};
+
   // map of area IDs and instance of KvStoreDb
   std::unordered_map<std::string /* area ID */, KvStoreDb<ClientType>>
       kvStoreDb_{};
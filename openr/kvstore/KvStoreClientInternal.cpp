@@ -36,12 +36,13 @@ KvStoreClientInternal::KvStoreClientInternal(
             break;
           }
 
+          // ATTN: publication is shared with other readers
           folly::variant_match(
-              std::move(maybePub).value(),
-              [this](thrift::Publication&& pub) {
-                processPublication(std::move(pub));
+              *maybePub.value(),
+              [this](thrift::Publication const& pub) {
+                processPublication(pub);
               },
-              [](thrift::InitializationEvent&&) {
+              [](thrift::InitializationEvent const&) {
                 // Do not interested in initialization event
               });
         }
@@ -127,6 +128,42 @@ KvStoreClientInternal::setKey(
   return ret;
 }
 
+std::optional<folly::Unit>
+KvStoreClientInternal::setKeys(
+    AreaId const& area,
+    std::vector<std::pair<std::string, thrift::Value>> const& keyVals) {
+  CHECK(eventBase_->getEvb()->isInEventBaseThread());
+
+  XLOG(DBG3) << "KvStoreClientInternal: setKeys called for "
+             << keyVals.size() << " keys";
+
+  // ATTN: last value wins if the same key shows up more than once
+  std::unordered_map<std::string, thrift::Value> keyValsToSet;
+  for (auto const& [key, thriftValue] : keyVals) {
+    CHECK(thriftValue.value_ref());
+    keyValsToSet.insert_or_assign(key, thriftValue);
+  }
+
+  const auto ret = setKeysHelper(area, std::move(keyValsToSet));
+
+  bool needTtlUpdates{false};
+  for (auto const& [key, thriftValue] : keyVals) {
+    needTtlUpdates |= updateTtlBackoff(
+        area,
+        key,
+        *thriftValue.version_ref(),
+        *thriftValue.ttlVersion_ref(),
+        *thriftValue.ttl_ref(),
+        false /* advertiseImmediately */);
+  }
+  if (needTtlUpdates) {
+    // ATTN: always use throttled fashion for ttl update
+    advertiseTtlUpdatesThrottled_->operator()();
+  }
+
+  return ret;
+}
+
 void
 KvStoreClientInternal::scheduleTtlUpdates(
     AreaId const& area,
@@ -135,12 +172,29 @@ KvStoreClientInternal::scheduleTtlUpdates(
     uint32_t ttlVersion,
     int64_t ttl,
     bool advertiseImmediately) {
+  if (not updateTtlBackoff(
+          area, key, version, ttlVersion, ttl, advertiseImmediately)) {
+    return;
+  }
+
+  // ATTN: always use throttled fashion for ttl update
+  advertiseTtlUpdatesThrottled_->operator()();
+}
+
+bool
+KvStoreClientInternal::updateTtlBackoff(
+    AreaId const& area,
+    std::string const& key,
+    uint32_t version,
+    uint32_t ttlVersion,
+    int64_t ttl,
+    bool advertiseImmediately) {
   // infinite TTL does not need update
   auto& keyTtlBackoffs = keyTtlBackoffs_[area];
   if (ttl == Constants::kTtlInfinity) {
     // in case ttl is finite before
     keyTtlBackoffs.erase(key);
-    return;
+    return false;
   }
 
   // do not send value to reduce update overhead
@@ -165,9 +219,7 @@ KvStoreClientInternal::scheduleTtlUpdates(
   if (not advertiseImmediately) {
     keyTtlBackoffs.at(key).second.reportError();
   }
-
-  // ATTN: always use throttled fashion for ttl update
-  advertiseTtlUpdatesThrottled_->operator()();
+  return true;
 }
 
 void
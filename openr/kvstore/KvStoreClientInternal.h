@@ -54,6 +54,12 @@ class KvStoreClientInternal {
    *     specified, then the one greater than the latest known will be used.
    *  2) thrift::Value is explicitly provided;
    *
+   * [SET KEYS]:
+   *
+   * Advertise a batch of key-values with a single KvStore request. The batch
+   * shares one publication and one ttl-update scheduling pass instead of
+   * paying for them per key. Keys with finite ttl are refreshed together.
+   *
    * [UNSET KEY]:
    *
    * Stop key ttl-refreshing.
@@ -78,6 +84,10 @@ class KvStoreClientInternal {
   std::optional<folly::Unit> setKey(
       AreaId const& area, std::string const& key, thrift::Value const& value);
 
+  std::optional<folly::Unit> setKeys(
+      AreaId const& area,
+      std::vector<std::pair<std::string, thrift::Value>> const& keyVals);
+
   void unsetKey(AreaId const& area, std::string const& key);
 
   std::optional<thrift::Value> getKey(
@@ -136,9 +146,19 @@ class KvStoreClientInternal {
   /**
    * [TTL Management]
    *
+   *  - helper function to track TTL backoff of a key. Return true if key
+   *    needs TTL updates, i.e. has finite TTL.
    *  - helper function to schedule TTL update advertisement
    *  - helper function to advertise TTL updates
    */
+  bool updateTtlBackoff(
+      AreaId const& area,
+      std::string const& key,
+      uint32_t version,
+      uint32_t ttlVersion,
+      int64_t ttl,
+      bool advertiseImmediately);
+
   void scheduleTtlUpdates(
       AreaId const& area,
       std::string const& key,
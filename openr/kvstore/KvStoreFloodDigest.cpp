@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+
+#include <folly/hash/SpookyHashV2.h>
+#include <folly/logging/xlog.h>
+
+#include <openr/kvstore/KvStoreFloodDigest.h>
+
+namespace openr {
+
+KvStoreFloodDigest::KvStoreFloodDigest(size_t numBits, size_t numHashes)
+    : numHashes_(numHashes),
+      current_((numBits + 7) / 8, '\0'),
+      previous_((numBits + 7) / 8, '\0') {
+  CHECK_GT(numBits, 0) << "KvStoreFloodDigest must have at least one bit";
+  CHECK_GT(numHashes, 0) << "KvStoreFloodDigest must have at least one hash";
+}
+
+std::pair<uint64_t, uint64_t>
+KvStoreFloodDigest::getTupleHash(
+    std::string const& key, thrift::Value const& value) {
+  uint64_t h1 = static_cast<uint64_t>(*value.version_ref());
+  uint64_t h2 = static_cast<uint64_t>(*value.ttlVersion_ref());
+  folly::hash::SpookyHashV2::Hash128(key.data(), key.size(), &h1, &h2);
+  auto const& originatorId = *value.originatorId_ref();
+  folly::hash::SpookyHashV2::Hash128(
+      originatorId.data(), originatorId.size(), &h1, &h2);
+  // odd stride visits distinct bits for power-of-two sizes
+  return {h1, h2 | 1};
+}
+
+void
+KvStoreFloodDigest::add(std::string const& key, thrift::Value const& value) {
+  const auto [h1, h2] = getTupleHash(key, value);
+  const uint64_t numBits = current_.size() * 8;
+  for (size_t i = 0; i < numHashes_; ++i) {
+    const uint64_t bit = (h1 + i * h2) % numBits;
+    current_[bit / 8] |= static_cast<char>(1 << (bit % 8));
+  }
+}
+
+void
+KvStoreFloodDigest::rotate() {
+  previous_.swap(current_);
+  std::fill(current_.begin(), current_.end(), '\0');
+}
+
+thrift::KvStoreFloodDigest
+KvStoreFloodDigest::toThrift() const {
+  std::string bits(current_);
+  for (size_t i = 0; i < bits.size(); ++i) {
+    bits[i] |= previous_[i];
+  }
+  thrift::KvStoreFloodDigest digest;
+  digest.numHashes_ref() = static_cast<int32_t>(numHashes_);
+  digest.bits_ref() = std::move(bits);
+  return digest;
+}
+
+bool
+KvStoreFloodDigest::mayContain(
+    thrift::KvStoreFloodDigest const& digest,
+    std::string const& key,
+    thrift::Value const& value) {
+  auto const& bits = *digest.bits_ref();
+  if (bits.empty() or *digest.numHashes_ref() <= 0 or
+      *digest.numHashes_ref() > Constants::kKvStoreFloodDigestMaxHashes) {
+    return false;
+  }
+  const auto [h1, h2] = getTupleHash(key, value);
+  const uint64_t numBits = bits.size() * 8;
+  for (int32_t i = 0; i < *digest.numHashes_ref(); ++i) {
+    const uint64_t bit = (h1 + i * h2) % numBits;
+    if (not(bits[bit / 8] & (1 << (bit % 8)))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace openr
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <string>
+#include <utility>
+
+#include <openr/common/Constants.h>
+#include <openr/if/gen-cpp2/KvStore_types.h>
+
+namespace openr {
+
+/*
+ * [Flood Digest]
+ *
+ * KvStoreFloodDigest is a Bloom filter of <key, version, originatorId,
+ * ttlVersion> of key-vals recently merged by KvStoreDb. It is periodically
+ * sent to peers, which skip flooding key-vals the digest contains, i.e.
+ * duplicates the node has already received from another neighbor.
+ *
+ * Two generations are kept. Every rotation drops the older one, so a tuple
+ * stays in the digest for one to two rotation intervals. The advertised
+ * digest is the union of both generations.
+ *
+ * NOTE: a false positive makes the peer skip an update which was NOT seen.
+ * Receiver detects it on the next ttl refresh of unknown version and requests
+ * the key in full.
+ */
+class KvStoreFloodDigest {
+ public:
+  explicit KvStoreFloodDigest(
+      size_t numBits = Constants::kKvStoreFloodDigestBits,
+      size_t numHashes = Constants::kKvStoreFloodDigestNumHashes);
+
+  // record key-val as seen in current generation
+  void add(std::string const& key, thrift::Value const& value);
+
+  // drop older generation and start a new one
+  void rotate();
+
+  // union of both generations to advertise to peers
+  thrift::KvStoreFloodDigest toThrift() const;
+
+  /*
+   * Test key-val against digest received from peer. False positives are
+   * possible, false negatives are not.
+   *
+   * @return false for malformed digest
+   */
+  static bool mayContain(
+      thrift::KvStoreFloodDigest const& digest,
+      std::string const& key,
+      thrift::Value const& value);
+
+ private:
+  // bit positions of key-val are derived from two hashes (double hashing)
+  static std::pair<uint64_t, uint64_t> getTupleHash(
+      std::string const& key, thrift::Value const& value);
+
+  const size_t numHashes_{0};
+
+  // bit arrays of current and previous generation
+  std::string current_;
+  std::string previous_;
+};
+
+} // namespace openr
@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <iterator>
+
+#include <openr/kvstore/KvStoreKeyIndex.h>
+
+namespace openr {
+
+namespace {
+
+// characters with special meaning in RE2 syntax
+constexpr char kRegexMetaChars[] = ".[]()*+?{}|^$\\";
+
+// quantifiers making preceding character optional
+constexpr char kRegexOptionalQuantifiers[] = "*?{";
+
+bool
+isOneOf(char c, const char* chars) {
+  return c != '\0' and std::strchr(chars, c) != nullptr;
+}
+
+} // namespace
+
+void
+KvStoreKeyIndex::upsert(
+    std::string const& key, std::string const& originatorId) {
+  auto [it, inserted] = keys_.try_emplace(key, originatorId);
+  if (not inserted) {
+    if (it->second == originatorId) {
+      return;
+    }
+    // originator changed, unlink key from the old one
+    auto oldIt = originatorKeys_.find(it->second);
+    if (oldIt != originatorKeys_.end()) {
+      oldIt->second.erase(key);
+      if (oldIt->second.empty()) {
+        originatorKeys_.erase(oldIt);
+      }
+    }
+    it->second = originatorId;
+  }
+  originatorKeys_[originatorId].insert(key);
+}
+
+bool
+KvStoreKeyIndex::erase(std::string const& key) {
+  auto it = keys_.find(key);
+  if (it == keys_.end()) {
+    return false;
+  }
+  auto originatorIt = originatorKeys_.find(it->second);
+  if (originatorIt != originatorKeys_.end()) {
+    originatorIt->second.erase(key);
+    if (originatorIt->second.empty()) {
+      originatorKeys_.erase(originatorIt);
+    }
+  }
+  keys_.erase(it);
+  return true;
+}
+
+std::optional<std::vector<std::string>>
+KvStoreKeyIndex::getCandidateKeys(
+    std::vector<std::string> const& keyPrefixes,
+    std::set<std::string> const& originatorIds,
+    thrift::FilterOperator filterOperator) const {
+  const bool hasKeyFilter = not keyPrefixes.empty();
+  const bool hasOriginatorFilter = not originatorIds.empty();
+
+  // literal prefixes of all key filters. Unset if any of them has none.
+  std::optional<std::vector<std::string>> literalPrefixes;
+  if (hasKeyFilter) {
+    literalPrefixes.emplace();
+    for (auto const& regex : keyPrefixes) {
+      auto literalPrefix = getLiteralPrefix(regex);
+      if (literalPrefix.empty()) {
+        literalPrefixes.reset();
+        break;
+      }
+      literalPrefixes->emplace_back(std::move(literalPrefix));
+    }
+  }
+
+  std::vector<std::string> keys;
+  if (filterOperator == thrift::FilterOperator::OR) {
+    // key matching any of the attributes. Every attribute must be indexable.
+    if (not hasKeyFilter and not hasOriginatorFilter) {
+      return std::nullopt;
+    }
+    if (hasKeyFilter and not literalPrefixes.has_value()) {
+      return std::nullopt;
+    }
+    if (literalPrefixes.has_value()) {
+      collectKeysByPrefix(*literalPrefixes, keys);
+    }
+    collectKeysByOriginator(originatorIds, keys);
+  } else {
+    // key matching all of the attributes. Any indexable attribute will do.
+    if (literalPrefixes.has_value()) {
+      collectKeysByPrefix(*literalPrefixes, keys);
+    } else if (hasOriginatorFilter) {
+      collectKeysByOriginator(originatorIds, keys);
+    } else {
+      return std::nullopt;
+    }
+  }
+
+  // ranges of overlapping prefixes and originators may yield duplicates
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+  return keys;
+}
+
+std::optional<std::string>
+KvStoreKeyIndex::getChunkEnd(
+    std::optional<std::string> const& cursor, size_t maxKeys) const {
+  auto it = cursor.has_value() ? keys_.upper_bound(*cursor) : keys_.begin();
+  for (size_t i = 1; i < maxKeys and it != keys_.end(); ++i) {
+    ++it;
+  }
+  if (it == keys_.end() or std::next(it) == keys_.end()) {
+    return std::nullopt;
+  }
+  return it->first;
+}
+
+std::vector<std::string>
+KvStoreKeyIndex::getKeysInRange(
+    std::optional<std::string> const& cursor,
+    std::optional<std::string> const& end) const {
+  std::vector<std::string> keys;
+  if (cursor.has_value() and end.has_value() and *end <= *cursor) {
+    return keys;
+  }
+  auto it = cursor.has_value() ? keys_.upper_bound(*cursor) : keys_.begin();
+  auto endIt = end.has_value() ? keys_.upper_bound(*end) : keys_.end();
+  for (; it != endIt; ++it) {
+    keys.emplace_back(it->first);
+  }
+  return keys;
+}
+
+void
+KvStoreKeyIndex::collectKeysByPrefix(
+    std::vector<std::string> const& literalPrefixes,
+    std::vector<std::string>& keys) const {
+  for (auto const& prefix : literalPrefixes) {
+    auto it = keys_.lower_bound(prefix);
+    while (it != keys_.end() and
+           it->first.compare(0, prefix.size(), prefix) == 0) {
+      keys.emplace_back(it->first);
+      ++it;
+    }
+  }
+}
+
+void
+KvStoreKeyIndex::collectKeysByOriginator(
+    std::set<std::string> const& originatorIds,
+    std::vector<std::string>& keys) const {
+  for (auto const& originatorId : originatorIds) {
+    auto it = originatorKeys_.find(originatorId);
+    if (it == originatorKeys_.end()) {
+      continue;
+    }
+    keys.insert(keys.end(), it->second.begin(), it->second.end());
+  }
+}
+
+std::string
+KvStoreKeyIndex::getLiteralPrefix(std::string const& regex) {
+  // alternation anywhere can make the leading literal optional, e.g. `a|b`
+  for (size_t i = 0; i < regex.size(); ++i) {
+    if (regex[i] == '\\') {
+      ++i;
+    } else if (regex[i] == '|') {
+      return "";
+    }
+  }
+
+  std::string prefix;
+  size_t i = (not regex.empty() and regex[0] == '^') ? 1 : 0;
+  while (i < regex.size()) {
+    char literal;
+    size_t next;
+    if (regex[i] == '\\') {
+      // ONLY escaped punctuation is literal, e.g. `\.`. `\d` is a class.
+      if (i + 1 >= regex.size() or
+          not std::ispunct(static_cast<unsigned char>(regex[i + 1]))) {
+        break;
+      }
+      literal = regex[i + 1];
+      next = i + 2;
+    } else if (isOneOf(regex[i], kRegexMetaChars)) {
+      break;
+    } else {
+      literal = regex[i];
+      next = i + 1;
+    }
+
+    if (next < regex.size() and
+        isOneOf(regex[next], kRegexOptionalQuantifiers)) {
+      break;
+    }
+    prefix.push_back(literal);
+    if (next < regex.size() and regex[next] == '+') {
+      // at least one occurrence, but nothing is known after it
+      break;
+    }
+    i = next;
+  }
+  return prefix;
+}
+
+} // namespace openr
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <folly/container/F14Map.h>
+
+#include <openr/if/gen-cpp2/KvStore_types.h>
+
+namespace openr {
+
+/*
+ * [Key Index]
+ *
+ * Secondary index over keys of KvStoreDb, used to serve filtered dump without
+ * scanning the entire key space:
+ *
+ *  - keys are kept ordered, so that all keys sharing a literal prefix form a
+ *    contiguous range;
+ *  - keys are grouped by their originatorId;
+ *
+ * Key prefix filters are RE2 regexes anchored at start. Only the literal
+ * leading part of a regex, e.g. `adj:` out of `adj:.*`, is used to narrow
+ * down the range. Candidates returned by the index MUST still be matched
+ * against the filters.
+ */
+class KvStoreKeyIndex {
+ public:
+  // track key with its originatorId. Move key to new originator if changed.
+  void upsert(std::string const& key, std::string const& originatorId);
+
+  // stop tracking key. Return true if key was tracked.
+  bool erase(std::string const& key);
+
+  /*
+   * Collect keys which can possibly match the filters, in ascending order.
+   *
+   * @return std::nullopt if filters can not be narrowed down by the index,
+   *         e.g. no filter at all or a regex without literal prefix. Caller
+   *         should fall back to a full scan in that case.
+   */
+  std::optional<std::vector<std::string>> getCandidateKeys(
+      std::vector<std::string> const& keyPrefixes,
+      std::set<std::string> const& originatorIds,
+      thrift::FilterOperator filterOperator) const;
+
+  /*
+   * [Chunked Full-Sync]
+   *
+   * Inclusive upper bound of the chunk covering at most `maxKeys` (at least
+   * one) keys after `cursor`, which is exclusive and unset for the very first
+   * chunk.
+   *
+   * @return std::nullopt if the chunk reaches the end of the key space.
+   */
+  std::optional<std::string> getChunkEnd(
+      std::optional<std::string> const& cursor, size_t maxKeys) const;
+
+  // keys in range (cursor, end] in ascending order. Unset bound is open.
+  std::vector<std::string> getKeysInRange(
+      std::optional<std::string> const& cursor,
+      std::optional<std::string> const& end) const;
+
+  inline size_t
+  size() const {
+    return keys_.size();
+  }
+
+  /*
+   * Literal characters every match of the (start-anchored) regex begins
+   * with. Empty if unknown, e.g. regex starts with a wildcard or contains an
+   * alternation.
+   */
+  static std::string getLiteralPrefix(std::string const& regex);
+
+ private:
+  // append keys starting with any of the literal prefixes
+  void collectKeysByPrefix(
+      std::vector<std::string> const& literalPrefixes,
+      std::vector<std::string>& keys) const;
+
+  // append keys originated by any of the originators
+  void collectKeysByOriginator(
+      std::set<std::string> const& originatorIds,
+      std::vector<std::string>& keys) const;
+
+  // ordered keys mapped to their originatorId
+  std::map<std::string /* key */, std::string /* originatorId */> keys_;
+
+  // keys grouped by originatorId
+  folly::F14FastMap<std::string /* originatorId */, std::set<std::string>>
+      originatorKeys_;
+};
+
+} // namespace openr
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <fmt/format.h>
+#include <folly/hash/Hash.h>
+#include <folly/logging/xlog.h>
+
+#include <openr/kvstore/KvStoreMerkleTree.h>
+
+namespace openr {
+
+KvStoreMerkleTree::KvStoreMerkleTree(uint32_t depth)
+    : depth_(depth), nodes_(size_t(2) << depth, 0) {
+  // cap the depth to keep digest exchange within a sane size
+  CHECK_LE(depth_, 20) << "Merkle tree depth is too large: " << depth_;
+}
+
+int64_t
+KvStoreMerkleTree::getKeyDigest(
+    std::string const& key, thrift::Value const& value) {
+  uint64_t digest = folly::hash::fnv64(key);
+  digest = folly::hash::hash_128_to_64(
+      digest, static_cast<uint64_t>(*value.version_ref()));
+  digest = folly::hash::hash_128_to_64(
+      digest, folly::hash::fnv64(*value.originatorId_ref()));
+  digest = folly::hash::hash_128_to_64(
+      digest, static_cast<uint64_t>(value.hash_ref().value_or(0)));
+  return static_cast<int64_t>(digest);
+}
+
+uint32_t
+KvStoreMerkleTree::getBucket(std::string const& key) const {
+  // use independent hash from digest calculation to spread keys evenly
+  return folly::hash::twang_32from64(folly::hash::fnv64(key)) &
+      ((uint32_t(1) << depth_) - 1);
+}
+
+void
+KvStoreMerkleTree::add(std::string const& key, thrift::Value const& value) {
+  applyDigest(getBucket(key), getKeyDigest(key, value));
+}
+
+void
+KvStoreMerkleTree::remove(std::string const& key, thrift::Value const& value) {
+  // XOR is its own inverse
+  applyDigest(getBucket(key), getKeyDigest(key, value));
+}
+
+void
+KvStoreMerkleTree::update(
+    std::string const& key, int64_t oldDigest, int64_t newDigest) {
+  if (oldDigest == newDigest) {
+    // e.g. ttl refresh, nothing to update
+    return;
+  }
+  applyDigest(getBucket(key), oldDigest ^ newDigest);
+}
+
+void
+KvStoreMerkleTree::clear() {
+  std::fill(nodes_.begin(), nodes_.end(), 0);
+}
+
+void
+KvStoreMerkleTree::applyDigest(uint32_t bucket, int64_t digest) {
+  for (size_t idx = (size_t(1) << depth_) + bucket; idx >= 1; idx >>= 1) {
+    nodes_[idx] ^= digest;
+  }
+}
+
+std::vector<int64_t>
+KvStoreMerkleTree::getLeafDigests() const {
+  const auto leafStart = nodes_.begin() + getNumBuckets();
+  return std::vector<int64_t>(leafStart, nodes_.end());
+}
+
+std::optional<std::vector<int32_t>>
+KvStoreMerkleTree::getDifferingBuckets(
+    std::vector<int64_t> const& peerLeafDigests) const {
+  const size_t numBuckets = getNumBuckets();
+  if (peerLeafDigests.size() != numBuckets) {
+    XLOG(WARNING) << fmt::format(
+        "[Merkle Sync] Mismatched bucket layout. Local: {}, peer: {}",
+        numBuckets,
+        peerLeafDigests.size());
+    return std::nullopt;
+  }
+
+  // rebuild peer tree from its leaves
+  std::vector<int64_t> peerNodes(2 * numBuckets, 0);
+  std::copy(
+      peerLeafDigests.begin(),
+      peerLeafDigests.end(),
+      peerNodes.begin() + numBuckets);
+  for (size_t idx = numBuckets - 1; idx >= 1; --idx) {
+    peerNodes[idx] = peerNodes[2 * idx] ^ peerNodes[2 * idx + 1];
+  }
+
+  // descend from root, skip identical subtrees
+  std::vector<int32_t> differingBuckets;
+  std::vector<size_t> stack{1};
+  while (not stack.empty()) {
+    const auto idx = stack.back();
+    stack.pop_back();
+    if (nodes_[idx] == peerNodes[idx]) {
+      continue;
+    }
+    if (idx >= numBuckets) {
+      differingBuckets.emplace_back(static_cast<int32_t>(idx - numBuckets));
+      continue;
+    }
+    // push right child first so that buckets are visited in order
+    stack.emplace_back(2 * idx + 1);
+    stack.emplace_back(2 * idx);
+  }
+  return differingBuckets;
+}
+
+} // namespace openr
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <openr/if/gen-cpp2/KvStore_types.h>
+
+namespace openr {
+
+/*
+ * [Anti-Entropy]
+ *
+ * KvStoreMerkleTree maintains a fixed-shape binary hash tree over the key
+ * space of a single KvStoreDb. Every key is hashed into one of `2^depth` leaf
+ * buckets:
+ *
+ *  - leaf digest is the XOR of the per-key digests in that bucket;
+ *  - internal node digest is the XOR of its two children;
+ *
+ * XOR keeps the digest independent of insertion order and lets every
+ * add/remove adjust a single leaf-to-root path in O(depth), so the tree can
+ * be kept up to date on every merge instead of being rebuilt for each sync.
+ *
+ * The per-key digest covers <key, version, originatorId, hash>. TTL and
+ * ttl-version are intentionally left out: they are refreshed on every ttl
+ * update and would make buckets flap between peers that agree on content.
+ * Ttl refreshes are flooded separately and do not need full-sync repair.
+ *
+ * NOTE: key bucketing and digests use FNV/128-to-64 mixing from folly so
+ * that peers running on different platforms agree on the bucket layout.
+ */
+class KvStoreMerkleTree {
+ public:
+  explicit KvStoreMerkleTree(uint32_t depth);
+
+  // digest contribution of a single key-value
+  static int64_t getKeyDigest(
+      std::string const& key, thrift::Value const& value);
+
+  // leaf bucket a key falls into
+  uint32_t getBucket(std::string const& key) const;
+
+  /*
+   * Incremental maintenance. Callers MUST pass the exact value being
+   * added/removed, i.e. remove() must see the same (version, originatorId,
+   * hash) that add() saw, otherwise the tree gets out of sync with the store.
+   */
+  void add(std::string const& key, thrift::Value const& value);
+  void remove(std::string const& key, thrift::Value const& value);
+
+  // replace digest contribution of a key. Pass 0 as `oldDigest` for a newly
+  // inserted key.
+  void update(std::string const& key, int64_t oldDigest, int64_t newDigest);
+
+  // reset the tree to represent an empty key space
+  void clear();
+
+  inline uint32_t
+  getDepth() const {
+    return depth_;
+  }
+
+  inline size_t
+  getNumBuckets() const {
+    return size_t(1) << depth_;
+  }
+
+  inline int64_t
+  getRootDigest() const {
+    return nodes_.at(1);
+  }
+
+  // dump digests of all leaf buckets, indexed by bucket id
+  std::vector<int64_t> getLeafDigests() const;
+
+  /*
+   * Compare this tree with the peer's leaf digests. The peer tree is rebuilt
+   * from its leaves and both trees are descended from the root, pruning
+   * every identical subtree.
+   *
+   * @return
+   *  - sorted list of bucket ids whose digests differ;
+   *  - std::nullopt if the peer uses a different bucket layout, in which case
+   *    caller should fall back to a full comparison;
+   */
+  std::optional<std::vector<int32_t>> getDifferingBuckets(
+      std::vector<int64_t> const& peerLeafDigests) const;
+
+ private:
+  // XOR digest into leaf bucket and all of its ancestors
+  void applyDigest(uint32_t bucket, int64_t digest);
+
+  // depth of the tree. There are 2^depth_ leaf buckets.
+  const uint32_t depth_{0};
+
+  // heap-ordered tree with root at index 1. Children of node i are (2i) and
+  // (2i + 1). Leaves occupy [2^depth_, 2^(depth_ + 1)).
+  std::vector<int64_t> nodes_;
+};
+
+} // namespace openr
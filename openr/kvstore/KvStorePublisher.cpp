@@ -5,7 +5,10 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
+
 #include <openr/common/Util.h>
+#include <openr/kvstore/KvStoreKeyIndex.h>
 #include <openr/kvstore/KvStorePublisher.h>
 
 namespace openr {
@@ -21,6 +24,29 @@ KvStorePublisher::KvStorePublisher(
       publisher_(std::move(publisher)),
       subscription_time_(subscription_time),
       total_messages_(total_messages) {
+  initKeyPrefixFilter(std::move(filter));
+}
+
+KvStorePublisher::KvStorePublisher(
+    std::set<std::string> const& selectAreas,
+    thrift::KeyDumpParams filter,
+    apache::thrift::ServerStreamPublisher<thrift::EncodedStreamMessage>&&
+        encodedPublisher,
+    std::unique_ptr<StreamEncoder> encoder,
+    std::chrono::steady_clock::time_point subscription_time,
+    int64_t total_messages)
+    : selectAreas_(selectAreas),
+      filter_(filter),
+      encodedPublisher_(std::move(encodedPublisher)),
+      encoder_(std::move(encoder)),
+      subscription_time_(subscription_time),
+      total_messages_(total_messages) {
+  CHECK(encoder_);
+  initKeyPrefixFilter(std::move(filter));
+}
+
+void
+KvStorePublisher::initKeyPrefixFilter(thrift::KeyDumpParams filter) {
   std::vector<std::string> keyPrefix;
 
   if (filter.keys_ref().has_value()) {
@@ -37,6 +63,48 @@ KvStorePublisher::KvStorePublisher(
       KvStoreFilters(keyPrefix, std::move(*filter.originatorIds_ref()), op);
 }
 
+void
+KvStorePublisher::holdUntilSnapshots() {
+  if (not heldPubs_) {
+    heldPubs_.emplace();
+  }
+}
+
+void
+KvStorePublisher::startFromSnapshots(
+    std::unordered_map<std::string, int64_t> seqNums) {
+  startSeqNums_ = std::move(seqNums);
+  auto heldPubs = std::move(heldPubs_);
+  heldPubs_.reset();
+  if (not heldPubs) {
+    return;
+  }
+  for (auto& pub : *heldPubs) {
+    next(std::move(pub));
+  }
+}
+
+void
+KvStorePublisher::next(thrift::Publication&& pub) {
+  // skip publication already reflected in dump
+  if (pub.seqNum_ref().has_value()) {
+    auto it = startSeqNums_.find(*pub.area_ref());
+    if (it != startSeqNums_.end() and *pub.seqNum_ref() <= it->second) {
+      return;
+    }
+  }
+  if (heldPubs_) {
+    heldPubs_->emplace_back(std::move(pub));
+    return;
+  }
+
+  if (publisher_) {
+    publisher_->next(std::move(pub));
+  } else {
+    encodedPublisher_->next(encoder_->encode(pub));
+  }
+}
+
 /**
  * A publication object (param) can have multiple key value pairs as follows.
  * pub = {"prefix1": value1, "prefix2": value2, "random-key": random-value}
@@ -53,22 +121,39 @@ KvStorePublisher::KvStorePublisher(
  */
 void
 KvStorePublisher::publish(const thrift::Publication& pub) {
-  if (not(selectAreas_.empty() || selectAreas_.count(*pub.area_ref()))) {
+  if (not isAreaSelected(*pub.area_ref())) {
     return;
   }
-  if ((not filter_.keys_ref().has_value() or (*filter_.keys_ref()).empty()) and
-      (not filter_.originatorIds_ref().is_set() or
-       (*filter_.originatorIds_ref()).empty()) and
-      not *filter_.ignoreTtl_ref() and not *filter_.doNotPublishValue_ref()) {
+  if (isUnfiltered()) {
     // No filtering criteria. Accept all updates as TTL updates are not be
     // to be updated. If we don't optimize here, we will have go through
     // key values of a publication and copy them.
     auto filteredPub = std::make_unique<thrift::Publication>(pub);
     filteredPub->timestamp_ms_ref() = getUnixTimeStampMs();
-    publisher_.next(std::move(*filteredPub));
+    next(std::move(*filteredPub));
     return;
   }
 
+  publishFiltered(pub, getFilteredKeyVals(*pub.keyVals_ref()));
+}
+
+bool
+KvStorePublisher::isAreaSelected(std::string const& area) const {
+  return selectAreas_.empty() || selectAreas_.count(area);
+}
+
+bool
+KvStorePublisher::isUnfiltered() const {
+  return (not filter_.keys_ref().has_value() or
+          (*filter_.keys_ref()).empty()) and
+      (not filter_.originatorIds_ref().is_set() or
+       (*filter_.originatorIds_ref()).empty()) and
+      not *filter_.ignoreTtl_ref() and not *filter_.doNotPublishValue_ref();
+}
+
+void
+KvStorePublisher::publishFiltered(
+    const thrift::Publication& pub, thrift::KeyVals keyVals) {
   thrift::Publication publication_filtered;
   publication_filtered.expiredKeys_ref() = *pub.expiredKeys_ref();
 
@@ -85,15 +170,17 @@ KvStorePublisher::publish(const thrift::Publication& pub) {
   }
 
   publication_filtered.area_ref() = *pub.area_ref();
+  publication_filtered.seqNum_ref().from_optional(
+      pub.seqNum_ref().to_optional());
 
-  publication_filtered.keyVals_ref() = getFilteredKeyVals(*pub.keyVals_ref());
+  publication_filtered.keyVals_ref() = std::move(keyVals);
 
   if (publication_filtered.keyVals_ref()->size() or
       publication_filtered.expiredKeys_ref()->size()) {
     // There is at least one key value in the publication for the client
     // or there are some expiredKeys
     publication_filtered.timestamp_ms_ref() = getUnixTimeStampMs();
-    publisher_.next(std::move(publication_filtered));
+    next(std::move(publication_filtered));
   }
 }
 
@@ -103,25 +190,246 @@ KvStorePublisher::getFilteredKeyVals(const thrift::KeyVals& origKeyVals) {
   // flag
   thrift::KeyVals keyvals;
   for (auto& [key, val] : origKeyVals) {
-    if (*filter_.ignoreTtl_ref() and not val.value_ref().has_value()) {
-      // ignore TTL updates
-      continue;
+    filterKeyVal(key, val, keyvals);
+  }
+
+  return keyvals;
+}
+
+void
+KvStorePublisher::filterKeyVal(
+    std::string const& key,
+    thrift::Value const& val,
+    thrift::KeyVals& keyVals) const {
+  if (*filter_.ignoreTtl_ref() and not val.value_ref().has_value()) {
+    // ignore TTL updates
+    return;
+  }
+
+  if (not keyPrefixFilter_.keyMatch(key, val)) {
+    return;
+  }
+
+  if ((not *filter_.doNotPublishValue_ref()) or
+      (not val.value_ref().has_value())) {
+    keyVals.emplace(key, val);
+  } else {
+    // Exclude Value.value if it's filtered
+    keyVals.emplace(key, createThriftValueWithoutBinaryValue(val));
+  }
+}
+
+void
+KvStorePublisherDispatcher::add(
+    int64_t id, std::unique_ptr<KvStorePublisher> publisher) {
+  CHECK(publisher);
+  addToIndex(id, *publisher);
+  publishers_[id] = std::move(publisher);
+}
+
+bool
+KvStorePublisherDispatcher::erase(int64_t id) {
+  if (not publishers_.count(id)) {
+    return false;
+  }
+  removeFromIndex(id);
+  publishers_.erase(id);
+  return true;
+}
+
+std::vector<std::unique_ptr<KvStorePublisher>>
+KvStorePublisherDispatcher::releaseAll() {
+  std::vector<std::unique_ptr<KvStorePublisher>> publishers;
+  for (auto& [_, publisher] : publishers_) {
+    publishers.emplace_back(std::move(publisher));
+  }
+  publishers_.clear();
+  unfiltered_.clear();
+  registrations_.clear();
+  prefixTrie_.children.clear();
+  prefixTrie_.publishers.clear();
+  originatorPublishers_.clear();
+  wildcard_.clear();
+  return publishers;
+}
+
+void
+KvStorePublisherDispatcher::addToIndex(
+    int64_t id, KvStorePublisher const& publisher) {
+  if (publisher.isUnfiltered()) {
+    unfiltered_.insert(id);
+    return;
+  }
+
+  auto const& filter = publisher.getKeyPrefixFilter();
+  const auto keyPrefixes = filter.getKeyPrefixes();
+  const auto originatorIds = filter.getOriginatorIdList();
+
+  // literal prefixes of all key filters. Unset if any of them has none.
+  std::optional<std::vector<std::string>> literalPrefixes;
+  if (not keyPrefixes.empty()) {
+    literalPrefixes.emplace();
+    for (auto const& regex : keyPrefixes) {
+      auto literalPrefix = KvStoreKeyIndex::getLiteralPrefix(regex);
+      if (literalPrefix.empty()) {
+        literalPrefixes.reset();
+        break;
+      }
+      literalPrefixes->emplace_back(std::move(literalPrefix));
     }
+  }
+
+  Registration registration;
+  if (filter.getFilterOperator() == thrift::FilterOperator::OR) {
+    // key matching any of the attributes. Every attribute must be indexable.
+    if ((keyPrefixes.empty() and originatorIds.empty()) or
+        (not keyPrefixes.empty() and not literalPrefixes.has_value())) {
+      registration.isWildcard = true;
+    } else {
+      if (literalPrefixes.has_value()) {
+        registration.literalPrefixes = std::move(*literalPrefixes);
+      }
+      registration.originatorIds.assign(
+          originatorIds.begin(), originatorIds.end());
+    }
+  } else {
+    // key matching all of the attributes. Any indexable attribute will do.
+    if (literalPrefixes.has_value()) {
+      registration.literalPrefixes = std::move(*literalPrefixes);
+    } else if (not originatorIds.empty()) {
+      registration.originatorIds.assign(
+          originatorIds.begin(), originatorIds.end());
+    } else {
+      registration.isWildcard = true;
+    }
+  }
 
-    if (not keyPrefixFilter_.keyMatch(key, val)) {
+  if (registration.isWildcard) {
+    wildcard_.insert(id);
+  }
+  for (auto const& prefix : registration.literalPrefixes) {
+    auto* node = &prefixTrie_;
+    for (char c : prefix) {
+      auto& child = node->children[c];
+      if (not child) {
+        child = std::make_unique<TrieNode>();
+      }
+      node = child.get();
+    }
+    node->publishers.insert(id);
+  }
+  for (auto const& originatorId : registration.originatorIds) {
+    originatorPublishers_[originatorId].insert(id);
+  }
+  registrations_.emplace(id, std::move(registration));
+}
+
+void
+KvStorePublisherDispatcher::removeFromIndex(int64_t id) {
+  unfiltered_.erase(id);
+  auto it = registrations_.find(id);
+  if (it == registrations_.end()) {
+    return;
+  }
+  auto const& registration = it->second;
+
+  wildcard_.erase(id);
+  for (auto const& prefix : registration.literalPrefixes) {
+    // walk down the trie, then prune nodes left without any publisher
+    std::vector<TrieNode*> path{&prefixTrie_};
+    for (char c : prefix) {
+      path.emplace_back(path.back()->children.at(c).get());
+    }
+    path.back()->publishers.erase(id);
+    for (size_t i = prefix.size(); i > 0; --i) {
+      if (not path[i]->publishers.empty() or not path[i]->children.empty()) {
+        break;
+      }
+      path[i - 1]->children.erase(prefix[i - 1]);
+    }
+  }
+  for (auto const& originatorId : registration.originatorIds) {
+    auto originatorIt = originatorPublishers_.find(originatorId);
+    if (originatorIt == originatorPublishers_.end()) {
       continue;
     }
+    originatorIt->second.erase(id);
+    if (originatorIt->second.empty()) {
+      originatorPublishers_.erase(originatorIt);
+    }
+  }
+  registrations_.erase(it);
+}
 
-    if ((not *filter_.doNotPublishValue_ref()) or
-        (not val.value_ref().has_value())) {
-      keyvals.emplace(key, val);
-    } else {
-      // Exclude Value.value if it's filtered
-      keyvals.emplace(key, createThriftValueWithoutBinaryValue(val));
+void
+KvStorePublisherDispatcher::collectCandidates(
+    std::string const& key,
+    thrift::Value const& val,
+    std::vector<int64_t>& candidates) const {
+  candidates.insert(candidates.end(), wildcard_.begin(), wildcard_.end());
+
+  // every node along the key path is a literal prefix of the key
+  auto const* node = &prefixTrie_;
+  for (char c : key) {
+    auto it = node->children.find(c);
+    if (it == node->children.end()) {
+      break;
     }
+    node = it->second.get();
+    candidates.insert(
+        candidates.end(), node->publishers.begin(), node->publishers.end());
   }
 
-  return keyvals;
+  auto it = originatorPublishers_.find(*val.originatorId_ref());
+  if (it != originatorPublishers_.end()) {
+    candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+  }
+}
+
+void
+KvStorePublisherDispatcher::publish(const thrift::Publication& pub) {
+  const auto now = std::chrono::system_clock::now();
+  for (auto& [_, publisher] : publishers_) {
+    publisher->last_message_time_ = now;
+    publisher->total_messages_++;
+  }
+
+  // publishers without filter take publication as is
+  for (auto id : unfiltered_) {
+    publishers_.at(id)->publish(pub);
+  }
+
+  // filtered key-vals of every publisher interested in the area
+  folly::F14FastMap<int64_t, thrift::KeyVals> keyValsById;
+  for (auto const& [id, _] : registrations_) {
+    if (publishers_.at(id)->isAreaSelected(*pub.area_ref())) {
+      keyValsById[id];
+    }
+  }
+  if (keyValsById.empty()) {
+    return;
+  }
+
+  // single pass over key-vals. Route each key to interested publishers ONLY.
+  std::vector<int64_t> candidates;
+  for (auto const& [key, val] : *pub.keyVals_ref()) {
+    candidates.clear();
+    collectCandidates(key, val, candidates);
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(
+        std::unique(candidates.begin(), candidates.end()), candidates.end());
+    for (auto id : candidates) {
+      auto it = keyValsById.find(id);
+      if (it == keyValsById.end()) {
+        continue;
+      }
+      publishers_.at(id)->filterKeyVal(key, val, it->second);
+    }
+  }
+
+  for (auto& [id, keyVals] : keyValsById) {
+    publishers_.at(id)->publishFiltered(pub, std::move(keyVals));
+  }
 }
 
 } // namespace openr
@@ -7,7 +7,17 @@
 
 #pragma once
 
+#include <map>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+
+#include <folly/container/F14Map.h>
+#include <folly/container/F14Set.h>
+
+#include <openr/common/StreamEncoder.h>
 #include <openr/if/gen-cpp2/KvStore_types.h>
+#include <openr/if/gen-cpp2/OpenrCtrl_types.h>
 #include <openr/kvstore/KvStoreUtil.h>
 #include <thrift/lib/cpp2/async/ServerPublisherStream.h>
 
@@ -22,29 +32,175 @@ class KvStorePublisher {
           std::chrono::steady_clock::now(),
       int64_t total_messages = 0);
 
+  // [Encoded Stream] publish publications encoded by `encoder`
+  KvStorePublisher(
+      std::set<std::string> const& selectAreas,
+      thrift::KeyDumpParams filter,
+      apache::thrift::ServerStreamPublisher<thrift::EncodedStreamMessage>&&
+          encodedPublisher,
+      std::unique_ptr<StreamEncoder> encoder,
+      std::chrono::steady_clock::time_point subscription_time =
+          std::chrono::steady_clock::now(),
+      int64_t total_messages = 0);
+
   ~KvStorePublisher() {}
 
   // Invoked whenever there is change. Apply filter and publish changes
   void publish(const thrift::Publication& pub);
 
+  /*
+   * Building blocks of `publish()`, used by KvStorePublisherDispatcher to
+   * filter key-vals of all publishers in a single pass.
+   */
+
+  // true if updates of the area should be published
+  bool isAreaSelected(std::string const& area) const;
+
+  // true if publication is published as is, without any filtering
+  bool isUnfiltered() const;
+
+  // apply filter on single key-val. Append to `keyVals` if matched.
+  void filterKeyVal(
+      std::string const& key,
+      thrift::Value const& val,
+      thrift::KeyVals& keyVals) const;
+
+  // publish `pub` with key-vals replaced by already filtered `keyVals`
+  void publishFiltered(const thrift::Publication& pub, thrift::KeyVals keyVals);
+
+  inline KvStoreFilters const&
+  getKeyPrefixFilter() const {
+    return keyPrefixFilter_;
+  }
+
+  /*
+   * [Snapshot Dump]
+   *
+   * Hold publications back until dumps the stream starts off are taken, see
+   * startFromSnapshots().
+   */
+  void holdUntilSnapshots();
+
+  /*
+   * Start stream off dumps taken at given sequence number per area.
+   * Publications already reflected in the dumps are skipped, held ones are
+   * sent. Hence no update is lost or sent twice, whatever the order dumps and
+   * publications are processed in.
+   */
+  void startFromSnapshots(
+      std::unordered_map<std::string /* area */, int64_t> seqNums);
+
   template <class... Args>
   void
   complete(Args&&... args) {
-    std::move(publisher_).complete(std::forward<Args>(args)...);
+    if (publisher_) {
+      std::move(*publisher_).complete(std::forward<Args>(args)...);
+    } else {
+      std::move(*encodedPublisher_).complete(std::forward<Args>(args)...);
+    }
   }
 
  private:
   thrift::KeyVals getFilteredKeyVals(const thrift::KeyVals& origKeyVals);
 
+  // parse key prefixes and originator ids of `filter`
+  void initKeyPrefixFilter(thrift::KeyDumpParams filter);
+
+  // send publication on stream, encoded if stream is
+  void next(thrift::Publication&& pub);
+
   // set of areas whose updates should be published. If empty, publish all
   std::set<std::string> selectAreas_;
   thrift::KeyDumpParams filter_;
   KvStoreFilters keyPrefixFilter_{{}, {}};
-  apache::thrift::ServerStreamPublisher<thrift::Publication> publisher_;
+  // ATTN: exactly one of publisher_ and encodedPublisher_ is set
+  std::optional<apache::thrift::ServerStreamPublisher<thrift::Publication>>
+      publisher_;
+  std::optional<
+      apache::thrift::ServerStreamPublisher<thrift::EncodedStreamMessage>>
+      encodedPublisher_;
+  std::unique_ptr<StreamEncoder> encoder_;
+
+  // [Snapshot Dump] publications held until dumps are taken, and sequence
+  // number of dump per area
+  std::optional<std::vector<thrift::Publication>> heldPubs_;
+  std::unordered_map<std::string, int64_t> startSeqNums_;
 
  public:
   std::chrono::steady_clock::time_point subscription_time_;
   int64_t total_messages_;
   std::chrono::system_clock::time_point last_message_time_;
 };
+
+/*
+ * [Subscriber Index]
+ *
+ * Central dispatcher of KvStore publications to all KvStorePublishers.
+ * Instead of every publisher filtering every publication, filters of all
+ * publishers are compiled into one matching structure:
+ *
+ *  - trie over literal key prefixes, e.g. `adj:` out of `adj:.*`;
+ *  - map of originatorIds;
+ *  - wildcard list, for filters which can not be indexed;
+ *
+ * Each key of a publication is then routed to interested publishers ONLY,
+ * in a single pass. Full filter is still applied to every routed key.
+ */
+class KvStorePublisherDispatcher {
+ public:
+  void add(int64_t id, std::unique_ptr<KvStorePublisher> publisher);
+
+  // remove publisher. Return true if publisher was found.
+  bool erase(int64_t id);
+
+  // remove and return all publishers
+  std::vector<std::unique_ptr<KvStorePublisher>> releaseAll();
+
+  // route publication to all interested publishers
+  void publish(const thrift::Publication& pub);
+
+  inline size_t
+  size() const {
+    return publishers_.size();
+  }
+
+  inline std::unordered_map<int64_t, std::unique_ptr<KvStorePublisher>> const&
+  getPublishers() const {
+    return publishers_;
+  }
+
+ private:
+  struct TrieNode {
+    std::map<char, std::unique_ptr<TrieNode>> children;
+    folly::F14FastSet<int64_t> publishers;
+  };
+
+  // where publisher is registered in the matching structure
+  struct Registration {
+    std::vector<std::string> literalPrefixes;
+    std::vector<std::string> originatorIds;
+    bool isWildcard{false};
+  };
+
+  void addToIndex(int64_t id, KvStorePublisher const& publisher);
+  void removeFromIndex(int64_t id);
+
+  // collect publishers interested in a key-val
+  void collectCandidates(
+      std::string const& key,
+      thrift::Value const& val,
+      std::vector<int64_t>& candidates) const;
+
+  std::unordered_map<int64_t, std::unique_ptr<KvStorePublisher>> publishers_;
+
+  // publishers receiving publications as is
+  folly::F14FastSet<int64_t> unfiltered_;
+
+  // publishers with filter, indexed by trie/originator/wildcard
+  folly::F14FastMap<int64_t, Registration> registrations_;
+  TrieNode prefixTrie_;
+  folly::F14FastMap<std::string /* originatorId */, folly::F14FastSet<int64_t>>
+      originatorPublishers_;
+  folly::F14FastSet<int64_t> wildcard_;
+};
 } // namespace openr
@@ -50,6 +50,16 @@ KvStoreServiceHandler<ClientType>::semifuture_getKvStoreKeyValsFilteredArea(
           });
 }
 
+template <class ClientType>
+folly::SemiFuture<std::unique_ptr<thrift::KvStoreSyncChunk>>
+KvStoreServiceHandler<ClientType>::semifuture_getKvStoreSyncChunkArea(
+    std::unique_ptr<thrift::KeyDumpParams> filter,
+    std::unique_ptr<std::string> area,
+    std::unique_ptr<thrift::KvStoreSyncChunkParams> chunkParams) {
+  return kvStore_->semifuture_getKvStoreSyncChunk(
+      std::move(*area), std::move(*filter), std::move(*chunkParams));
+}
+
 template <class ClientType>
 folly::SemiFuture<std::unique_ptr<thrift::Publication>>
 KvStoreServiceHandler<ClientType>::semifuture_getKvStoreHashFilteredArea(
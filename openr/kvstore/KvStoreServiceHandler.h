@@ -63,6 +63,20 @@ class KvStoreServiceHandler final : public thrift::KvStoreServiceSvIf,
       std::unique_ptr<thrift::KeyDumpParams> filter,
       std::unique_ptr<std::string> area) override;
 
+  /*
+   * API to return one chunk of full-sync response by given:
+   *  - thrift::KeyDumpParams;
+   *  - a specific area;
+   *  - thrift::KvStoreSyncChunkParams, i.e. range of keys to cover;
+   *
+   * ATTN: used by KvStore peers to break down initial full-sync into chunks
+   */
+  folly::SemiFuture<std::unique_ptr<thrift::KvStoreSyncChunk>>
+  semifuture_getKvStoreSyncChunkArea(
+      std::unique_ptr<thrift::KeyDumpParams> filter,
+      std::unique_ptr<std::string> area,
+      std::unique_ptr<thrift::KvStoreSyncChunkParams> chunkParams) override;
+
   /*
    * API to return key-val HASHes(NO binary value included) only by given:
    *  - thrift::KeyDumpParams;
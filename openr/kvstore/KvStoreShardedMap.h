@@ -0,0 +1,260 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <folly/container/F14Map.h>
+#include <folly/hash/Hash.h>
+
+#include <openr/if/gen-cpp2/Types_types.h>
+
+namespace openr {
+
+/*
+ * [Key Sharding]
+ *
+ * KvStoreDb key-vals split by key hash into shards, each of its own map, so
+ * that key-vals of a large publication are merged into shards concurrently,
+ * see KvStoreDb::mergeKeyValsIntoShards(). A key always falls into the same
+ * shard, hence merges of a key are applied in order of publications.
+ *
+ * Exposes the subset of map interface used by KvStoreDb and utilities of
+ * KvStoreUtil.h. Iteration visits shards in turn, order is unspecified same
+ * as with a single map.
+ */
+class KvStoreShardedMap {
+ public:
+  using Shard = folly::F14NodeMap<std::string, thrift::Value>;
+  using key_type = Shard::key_type;
+  using mapped_type = Shard::mapped_type;
+  using value_type = Shard::value_type;
+  using size_type = size_t;
+
+  template <bool IsConst>
+  class Iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = KvStoreShardedMap::value_type;
+    using difference_type = std::ptrdiff_t;
+    using reference =
+        std::conditional_t<IsConst, value_type const&, value_type&>;
+    using pointer = std::conditional_t<IsConst, value_type const*, value_type*>;
+
+    Iterator() = default;
+
+    // iterator converts to const_iterator
+    template <
+        bool OtherIsConst,
+        typename = std::enable_if_t<IsConst and not OtherIsConst>>
+    /* implicit */ Iterator(Iterator<OtherIsConst> const& other)
+        : shards_(other.shards_), shardIdx_(other.shardIdx_), it_(other.it_) {}
+
+    reference
+    operator*() const {
+      return *it_;
+    }
+
+    pointer
+    operator->() const {
+      return &*it_;
+    }
+
+    Iterator&
+    operator++() {
+      ++it_;
+      skipShardEnds();
+      return *this;
+    }
+
+    Iterator
+    operator++(int) {
+      auto ret = *this;
+      ++*this;
+      return ret;
+    }
+
+    bool
+    operator==(Iterator const& other) const {
+      // iterators of different shards do not compare
+      return shardIdx_ == other.shardIdx_ and
+          (shardIdx_ == numShards() or it_ == other.it_);
+    }
+
+    bool
+    operator!=(Iterator const& other) const {
+      return not(*this == other);
+    }
+
+   private:
+    friend class KvStoreShardedMap;
+    friend class Iterator<not IsConst>;
+
+    using Shards = std::
+        conditional_t<IsConst, std::vector<Shard> const, std::vector<Shard>>;
+    using ShardIterator =
+        std::conditional_t<IsConst, Shard::const_iterator, Shard::iterator>;
+
+    Iterator(Shards* shards, size_t shardIdx, ShardIterator it)
+        : shards_(shards), shardIdx_(shardIdx), it_(it) {
+      skipShardEnds();
+    }
+
+    size_t
+    numShards() const {
+      return shards_ ? shards_->size() : 0;
+    }
+
+    // move past the end of current and empty shards
+    void
+    skipShardEnds() {
+      while (shardIdx_ < numShards() and it_ == (*shards_)[shardIdx_].end()) {
+        if (++shardIdx_ < numShards()) {
+          it_ = (*shards_)[shardIdx_].begin();
+        }
+      }
+    }
+
+    Shards* shards_{nullptr};
+    size_t shardIdx_{0};
+    ShardIterator it_{};
+  };
+
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+
+  explicit KvStoreShardedMap(size_t numShards = 1)
+      : shards_(std::max<size_t>(numShards, 1)) {}
+
+  size_t
+  numShards() const {
+    return shards_.size();
+  }
+
+  // shard the key falls into. Hash is mixed once more than the one of shard
+  // maps, otherwise keys of a shard would only fill a fraction of its slots.
+  size_t
+  getShardIndex(const std::string& key) const {
+    if (shards_.size() == 1) {
+      return 0;
+    }
+    return folly::hash::twang_mix64(folly::hasher<std::string>()(key)) %
+        shards_.size();
+  }
+
+  Shard&
+  getShard(size_t shardIdx) {
+    return shards_.at(shardIdx);
+  }
+
+  Shard const&
+  getShard(size_t shardIdx) const {
+    return shards_.at(shardIdx);
+  }
+
+  bool
+  empty() const {
+    return std::all_of(shards_.cbegin(), shards_.cend(), [](auto& shard) {
+      return shard.empty();
+    });
+  }
+
+  size_t
+  size() const {
+    size_t size{0};
+    for (auto const& shard : shards_) {
+      size += shard.size();
+    }
+    return size;
+  }
+
+  iterator
+  begin() {
+    return iterator(&shards_, 0, shards_.front().begin());
+  }
+
+  iterator
+  end() {
+    return iterator(&shards_, shards_.size(), {});
+  }
+
+  const_iterator
+  begin() const {
+    return const_iterator(&shards_, 0, shards_.front().begin());
+  }
+
+  const_iterator
+  end() const {
+    return const_iterator(&shards_, shards_.size(), {});
+  }
+
+  iterator
+  find(const std::string& key) {
+    const auto shardIdx = getShardIndex(key);
+    auto& shard = shards_[shardIdx];
+    auto it = shard.find(key);
+    return it == shard.end() ? end() : iterator(&shards_, shardIdx, it);
+  }
+
+  const_iterator
+  find(const std::string& key) const {
+    const auto shardIdx = getShardIndex(key);
+    auto const& shard = shards_[shardIdx];
+    auto it = shard.find(key);
+    return it == shard.end() ? end() : const_iterator(&shards_, shardIdx, it);
+  }
+
+  size_t
+  count(const std::string& key) const {
+    return shards_[getShardIndex(key)].count(key);
+  }
+
+  template <typename... Args>
+  std::pair<iterator, bool>
+  try_emplace(const std::string& key, Args&&... args) {
+    const auto shardIdx = getShardIndex(key);
+    auto [it, inserted] =
+        shards_[shardIdx].try_emplace(key, std::forward<Args>(args)...);
+    return {iterator(&shards_, shardIdx, it), inserted};
+  }
+
+  template <typename... Args>
+  std::pair<iterator, bool>
+  emplace(const std::string& key, Args&&... args) {
+    return try_emplace(key, std::forward<Args>(args)...);
+  }
+
+  iterator
+  erase(iterator pos) {
+    const auto shardIdx = pos.shardIdx_;
+    return iterator(&shards_, shardIdx, shards_[shardIdx].erase(pos.it_));
+  }
+
+  size_t
+  erase(const std::string& key) {
+    return shards_[getShardIndex(key)].erase(key);
+  }
+
+  void
+  clear() {
+    for (auto& shard : shards_) {
+      shard.clear();
+    }
+  }
+
+ private:
+  std::vector<Shard> shards_;
+};
+
+} // namespace openr
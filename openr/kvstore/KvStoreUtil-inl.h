@@ -5,6 +5,8 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/futures/Future.h>
 #include <folly/gen/Base.h>
 #include <openr/common/OpenrClient.h>
 #include <openr/common/Util.h>
@@ -38,6 +40,51 @@ parseThriftValues(
   return result;
 }
 
+// static
+template <typename ThriftType>
+std::unordered_map<std::string, ThriftType>
+parseThriftValues(
+    std::unordered_map<std::string, thrift::Value> const& keyVals,
+    size_t numThreads) {
+  numThreads = std::min(numThreads, keyVals.size());
+  if (numThreads <= 1) {
+    return parseThriftValues<ThriftType>(keyVals);
+  }
+
+  // split key-vals into one slice per thread, parsed independently
+  std::vector<std::vector<const std::pair<const std::string, thrift::Value>*>>
+      slices(numThreads);
+  size_t i{0};
+  for (auto const& keyVal : keyVals) {
+    slices.at(i++ % numThreads).emplace_back(&keyVal);
+  }
+
+  using ParsedSlice = std::vector<std::pair<std::string, ThriftType>>;
+  folly::CPUThreadPoolExecutor executor(numThreads);
+  std::vector<folly::SemiFuture<ParsedSlice>> parsed;
+  for (auto const& slice : slices) {
+    parsed.emplace_back(folly::via(&executor, [&slice]() {
+      ParsedSlice values;
+      values.reserve(slice.size());
+      for (auto const* keyVal : slice) {
+        values.emplace_back(
+            keyVal->first, parseThriftValue<ThriftType>(keyVal->second));
+      }
+      return values;
+    }));
+  }
+
+  std::unordered_map<std::string, ThriftType> result;
+  result.reserve(keyVals.size());
+  // ATTN: rethrows first parse error, same as parsing serially
+  for (auto& values : folly::collect(std::move(parsed)).get()) {
+    for (auto& [key, value] : values) {
+      result.emplace(std::move(key), std::move(value));
+    }
+  }
+  return result;
+}
+
 // static
 template <typename ThriftType>
 std::pair<
@@ -51,8 +98,9 @@ dumpAllWithPrefixMultipleAndParse(
     std::chrono::milliseconds processTimeout,
     const std::shared_ptr<folly::SSLContext> sslContext,
     std::optional<int> maybeIpTos /* std::nullopt */,
-    const folly::SocketAddress&
-        bindAddr /* folly::AsyncSocket::anyAddress()*/) {
+    const folly::SocketAddress& bindAddr /* folly::AsyncSocket::anyAddress()*/,
+    size_t maxConcurrency /* Constants::kKvStoreDumpMaxConcurrency */,
+    size_t numParseThreads /* Constants::kKvStoreDumpParseThreads */) {
   const auto [res, unreachableAddrs] = dumpAllWithThriftClientFromMultiple(
       area,
       sockAddrs,
@@ -61,11 +109,13 @@ dumpAllWithPrefixMultipleAndParse(
       processTimeout,
       sslContext,
       maybeIpTos,
-      bindAddr);
+      bindAddr,
+      maxConcurrency);
   if (not res) {
     return std::make_pair(std::nullopt, unreachableAddrs);
   }
-  return std::make_pair(parseThriftValues<ThriftType>(*res), unreachableAddrs);
+  return std::make_pair(
+      parseThriftValues<ThriftType>(*res, numParseThreads), unreachableAddrs);
 }
 
 void
@@ -98,10 +148,9 @@ dumpAllWithThriftClientFromMultiple(
     std::chrono::milliseconds processTimeout,
     const std::shared_ptr<folly::SSLContext> sslContext,
     std::optional<int> maybeIpTos /* std::nullopt */,
-    const folly::SocketAddress&
-        bindAddr /* folly::AsyncSocket::anyAddress()*/) {
+    const folly::SocketAddress& bindAddr /* folly::AsyncSocket::anyAddress()*/,
+    size_t maxConcurrency /* Constants::kKvStoreDumpMaxConcurrency */) {
   folly::EventBase evb;
-  std::vector<folly::SemiFuture<thrift::Publication>> calls;
   std::unordered_map<std::string, thrift::Value> merged;
   std::vector<folly::SocketAddress> unreachableAddrs;
 
@@ -121,10 +170,9 @@ dumpAllWithThriftClientFromMultiple(
 
   VLOG(1) << "Dump kvStore key-vals from: " << folly::join(",", addrStrs)
           << ". Required SSL secure connection: " << std::boolalpha
-          << (sslContext != nullptr);
+          << (sslContext != nullptr) << ". Max concurrency: " << maxConcurrency;
 
-  auto startTime = std::chrono::steady_clock::now();
-  for (auto const& sockAddr : sockAddrs) {
+  auto connect = [&](const folly::SocketAddress& sockAddr) {
     std::unique_ptr<thrift::OpenrCtrlCppAsyncClient> client{nullptr};
     if (sslContext) {
       VLOG(3) << "Try to connect Open/R SSL secure client.";
@@ -165,52 +213,76 @@ dumpAllWithThriftClientFromMultiple(
             << "via plain-text client. Exception: " << folly::exceptionStr(ex);
       }
     }
+    return client;
+  };
 
-    // Cannot connect to Open/R via either plain-text client or secured client
-    if (!client) {
-      unreachableAddrs.emplace_back(sockAddr);
-      continue;
-    }
+  // [Multi-node Dump]
+  // keep up to `maxConcurrency` requests in flight, issue the next one as
+  // soon as any completes and merge its response right away
+  size_t nextAddr{0};
+  size_t numCalls{0};
+  size_t numInFlight{0};
+  std::function<void()> issueCalls;
+  issueCalls = [&]() {
+    while (numInFlight < std::max<size_t>(maxConcurrency, 1) and
+           nextAddr < sockAddrs.size()) {
+      const auto& sockAddr = sockAddrs.at(nextAddr++);
+      auto client = connect(sockAddr);
+
+      // Cannot connect to Open/R via either plain-text client or secured
+      // client
+      if (!client) {
+        unreachableAddrs.emplace_back(sockAddr);
+        continue;
+      }
 
-    VLOG(3) << "Successfully connected to Open/R with addr: "
-            << sockAddr.getAddressStr();
+      VLOG(3) << "Successfully connected to Open/R with addr: "
+              << sockAddr.getAddressStr();
 
-    calls.emplace_back(
-        area ? client->semifuture_getKvStoreKeyValsFilteredArea(params, *area)
-             : client->semifuture_getKvStoreKeyValsFiltered(params));
-  }
+      ++numCalls;
+      ++numInFlight;
+      auto sf = area
+          ? client->semifuture_getKvStoreKeyValsFilteredArea(params, *area)
+          : client->semifuture_getKvStoreKeyValsFiltered(params);
+      // client is retained until its response is processed
+      std::move(sf).via(&evb).thenTry(
+          [&, client = std::move(client)](
+              folly::Try<thrift::Publication>&& result) mutable {
+            --numInFlight;
+            // folly::Try will contain either value or exception
+            if (result.hasException()) {
+              LOG(ERROR) << "Exception: "
+                         << folly::exceptionStr(result.exception());
+            } else {
+              const auto numKeyVals = result.value().keyVals_ref()->size();
+              const auto numUpdates = mergeDumpedKeyVals(
+                  merged, std::move(*result.value().keyVals_ref()));
+              VLOG(3) << "Received kvstore publication with: " << numKeyVals
+                      << " key-vals. Incurred " << numUpdates
+                      << " key-val updates.";
+            }
+            issueCalls();
+            if (numInFlight == 0) {
+              evb.terminateLoopSoon();
+            }
+          });
+    }
+  };
+
+  auto startTime = std::chrono::steady_clock::now();
+  issueCalls();
 
   // can't connect to ANY single Open/R instance
-  if (calls.empty()) {
+  if (numCalls == 0) {
     return std::make_pair(std::nullopt, unreachableAddrs);
   }
 
-  folly::collectAll(calls).via(&evb).thenValue(
-      [&](std::vector<folly::Try<openr::thrift::Publication>>&& results) {
-        VLOG(1) << "Merge key-vals from " << results.size()
-                << " different Open/R instances.";
-
-        // loop semifuture collection to merge all values
-        for (auto& result : results) {
-          // folly::Try will contain either value or exception
-          if (result.hasException()) {
-            LOG(ERROR) << "Exception: "
-                       << folly::exceptionStr(result.exception());
-          } else if (result.hasValue()) {
-            auto keyVals = *result.value().keyVals_ref();
-            const auto deltaPub = mergeKeyValues(merged, keyVals).first;
-
-            VLOG(3) << "Received kvstore publication with: " << keyVals.size()
-                    << " key-vals. Incurred " << deltaPub.size()
-                    << " key-val updates.";
-          }
-        }
-        evb.terminateLoopSoon();
-      });
-
   // magic happens here
   evb.loopForever();
 
+  VLOG(1) << "Merged key-vals from " << numCalls
+          << " different Open/R instances.";
+
   // record time used to fetch from all Open/R instances
   const auto elapsedTime =
       std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -219,7 +291,7 @@ dumpAllWithThriftClientFromMultiple(
 
   VLOG(1) << "Took: " << elapsedTime << "ms to retrieve KvStore snapshot";
 
-  return std::make_pair(merged, unreachableAddrs);
+  return std::make_pair(std::move(merged), unreachableAddrs);
 }
 
 } // namespace openr
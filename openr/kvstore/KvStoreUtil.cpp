@@ -5,12 +5,50 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <filesystem>
+
+#include <folly/FileUtil.h>
+#include <folly/String.h>
+#include <folly/compression/Compression.h>
+#include <folly/hash/SpookyHashV2.h>
 #include <folly/logging/xlog.h>
+#include <folly/system/MemoryMapping.h>
+#include <thrift/lib/cpp/util/EnumUtils.h>
+#include <thrift/lib/cpp2/protocol/CompactProtocol.h>
+#include <thrift/lib/cpp2/protocol/Serializer.h>
 
+#include <openr/common/Util.h>
 #include <openr/kvstore/KvStoreUtil.h>
 
 namespace openr {
 
+namespace {
+
+// codec of full-sync chunk compression. nullptr if NOT available.
+std::unique_ptr<folly::io::Codec>
+getSyncChunkCodec(thrift::KvStoreCompression compression) {
+  if (compression == thrift::KvStoreCompression::ZSTD and
+      folly::io::hasCodec(folly::io::CodecType::ZSTD)) {
+    return folly::io::getCodec(folly::io::CodecType::ZSTD);
+  }
+  return nullptr;
+}
+
+// copy of value with metadata and hash ONLY
+thrift::Value
+getValueHash(const thrift::Value& val) {
+  DCHECK(val.hash_ref().has_value());
+  thrift::Value value;
+  value.version_ref() = *val.version_ref();
+  value.originatorId_ref() = *val.originatorId_ref();
+  value.hash_ref().copy_from(val.hash_ref());
+  value.ttl_ref() = *val.ttl_ref();
+  value.ttlVersion_ref() = *val.ttlVersion_ref();
+  return value;
+}
+
+} // namespace
+
 std::optional<openr::KvStoreFilters>
 getKvStoreFilters(const thrift::KvStoreConfig& kvStoreConfig) {
   std::optional<openr::KvStoreFilters> kvFilters{std::nullopt};
@@ -36,12 +74,26 @@ getKvStoreFilters(const thrift::KvStoreConfig& kvStoreConfig) {
   return kvFilters;
 }
 
+namespace {
+
+inline std::pair<const std::string, thrift::Value> const&
+getKeyVal(std::pair<const std::string, thrift::Value> const& keyVal) {
+  return keyVal;
+}
+
+inline std::pair<const std::string, thrift::Value> const&
+getKeyVal(std::pair<const std::string, thrift::Value> const* keyVal) {
+  return *keyVal;
+}
+
+// mergeKeyValues() of key-vals held by a map or referred to by a shard slice
+template <typename KvStoreMapT, typename KeyValsT>
 std::pair<
     std::unordered_map<std::string, thrift::Value>,
     KvStoreNoMergeReasonStats>
-mergeKeyValues(
-    std::unordered_map<std::string, thrift::Value>& kvStore,
-    std::unordered_map<std::string, thrift::Value> const& keyVals,
+mergeKeyValueRange(
+    KvStoreMapT& kvStore,
+    KeyValsT const& keyVals,
     std::optional<KvStoreFilters> const& filters) {
   // the publication to build if we update our KV store
   std::unordered_map<std::string, thrift::Value> kvUpdates;
@@ -50,7 +102,8 @@ mergeKeyValues(
   // Counters for logging
   uint32_t ttlUpdateCnt{0}, valUpdateCnt{0};
 
-  for (const auto& [key, value] : keyVals) {
+  for (const auto& keyVal : keyVals) {
+    const auto& [key, value] = getKeyVal(keyVal);
     if (filters.has_value() && not filters->keyMatch(key, value)) {
       XLOG(DBG4) << "key: " << key << " not adding from "
                  << *value.originatorId_ref();
@@ -173,10 +226,8 @@ mergeKeyValues(
       CHECK(value.value_ref().has_value());
       if (kvStoreIt == kvStore.end()) {
         // create new entry
-        std::tie(kvStoreIt, std::ignore) = kvStore.emplace(
-            std::piecewise_construct,
-            std::forward_as_tuple(key),
-            std::forward_as_tuple(std::move(newValue)));
+        std::tie(kvStoreIt, std::ignore) =
+            kvStore.try_emplace(key, std::move(newValue));
       } else {
         // update the entry in place, the old value will be destructed
         kvStoreIt->second = std::move(newValue);
@@ -208,6 +259,41 @@ mergeKeyValues(
   return std::make_pair(std::move(kvUpdates), std::move(stats));
 }
 
+} // namespace
+
+template <typename KvStoreMapT>
+std::pair<
+    std::unordered_map<std::string, thrift::Value>,
+    KvStoreNoMergeReasonStats>
+mergeKeyValues(
+    KvStoreMapT& kvStore,
+    std::unordered_map<std::string, thrift::Value> const& keyVals,
+    std::optional<KvStoreFilters> const& filters) {
+  return mergeKeyValueRange(kvStore, keyVals, filters);
+}
+
+std::vector<KvStoreShardSlice>
+splitKeyValuesByShard(
+    KvStoreShardedMap const& kvStore,
+    std::unordered_map<std::string, thrift::Value> const& keyVals) {
+  std::vector<KvStoreShardSlice> slices(kvStore.numShards());
+  for (auto const& keyVal : keyVals) {
+    slices.at(kvStore.getShardIndex(keyVal.first)).push_back(&keyVal);
+  }
+  return slices;
+}
+
+std::pair<
+    std::unordered_map<std::string, thrift::Value>,
+    KvStoreNoMergeReasonStats>
+mergeKeyValuesIntoShard(
+    KvStoreShardedMap& kvStore,
+    size_t shardIdx,
+    KvStoreShardSlice const& keyVals,
+    std::optional<KvStoreFilters> const& filters) {
+  return mergeKeyValueRange(kvStore.getShard(shardIdx), keyVals, filters);
+}
+
 /**
  * Compare two values to find out which value is better
  */
@@ -316,6 +402,11 @@ KvStoreFilters::getOriginatorIdList() const {
   return originatorIds_;
 }
 
+thrift::FilterOperator
+KvStoreFilters::getFilterOperator() const {
+  return filterOperator_;
+}
+
 std::string
 KvStoreFilters::str() const {
   std::string result{};
@@ -330,6 +421,20 @@ KvStoreFilters::str() const {
   return result;
 }
 
+KvStoreFilters
+getKeyDumpFilters(thrift::KeyDumpParams const& keyDumpParams) {
+  std::vector<std::string> keyPrefixList;
+  if (keyDumpParams.keys_ref().has_value()) {
+    keyPrefixList = *keyDumpParams.keys_ref();
+  } else {
+    folly::split(",", *keyDumpParams.prefix_ref(), keyPrefixList, true);
+  }
+  return KvStoreFilters(
+      keyPrefixList,
+      *keyDumpParams.originatorIds_ref(),
+      keyDumpParams.oper_ref().value_or(thrift::FilterOperator::OR));
+}
+
 // dump the keys on which hashes differ from given keyVals
 // thriftPub.keyVals: better keys or keys exist only in MY-KEY-VAL
 // thriftPub.tobeUpdatedKeys: better keys or keys exist only in REQ-KEY-VAL
@@ -381,10 +486,11 @@ dumpDifference(
 // dump the entries of my KV store whose keys match filter
 // KvStoreFilters contains `thrift::FilterOperator`
 // Default to thrift::FilterOperator::OR
+template <typename KvStoreMapT>
 thrift::Publication
 dumpAllWithFilters(
     const std::string& area,
-    const std::unordered_map<std::string, thrift::Value>& kvStore,
+    const KvStoreMapT& kvStore,
     const KvStoreFilters& kvFilters,
     bool doNotPublishValue) {
   thrift::Publication thriftPub;
@@ -404,12 +510,59 @@ dumpAllWithFilters(
   return thriftPub;
 }
 
+template <typename KvStoreMapT>
+thrift::Publication
+dumpAllWithFilters(
+    const std::string& area,
+    const KvStoreMapT& kvStore,
+    const KvStoreKeyIndex& keyIndex,
+    const KvStoreFilters& kvFilters,
+    bool doNotPublishValue) {
+  auto candidateKeys = keyIndex.getCandidateKeys(
+      kvFilters.getKeyPrefixes(),
+      kvFilters.getOriginatorIdList(),
+      kvFilters.getFilterOperator());
+  if (not candidateKeys.has_value()) {
+    return dumpAllWithFilters(area, kvStore, kvFilters, doNotPublishValue);
+  }
+  return dumpKeysWithFilters(
+      area, kvStore, *candidateKeys, kvFilters, doNotPublishValue);
+}
+
+template <typename KvStoreMapT>
+thrift::Publication
+dumpKeysWithFilters(
+    const std::string& area,
+    const KvStoreMapT& kvStore,
+    const std::vector<std::string>& keys,
+    const KvStoreFilters& kvFilters,
+    bool doNotPublishValue) {
+  thrift::Publication thriftPub;
+  thriftPub.area_ref() = area;
+
+  for (auto const& key : keys) {
+    auto it = kvStore.find(key);
+    if (it == kvStore.end() or not kvFilters.keyMatch(key, it->second)) {
+      continue;
+    }
+    if (not doNotPublishValue) {
+      thriftPub.keyVals_ref()[key] = it->second;
+    } else {
+      thriftPub.keyVals_ref()[key] =
+          createThriftValueWithoutBinaryValue(it->second);
+    }
+  }
+
+  return thriftPub;
+}
+
 // dump the hashes of my KV store whose keys match the given prefix
 // if prefix is the empty string, the full hash store is dumped
+template <typename KvStoreMapT>
 thrift::Publication
 dumpHashWithFilters(
     const std::string& area,
-    const std::unordered_map<std::string, thrift::Value>& kvStore,
+    const KvStoreMapT& kvStore,
     const KvStoreFilters& kvFilters) {
   thrift::Publication thriftPub;
   thriftPub.area_ref() = area;
@@ -417,16 +570,65 @@ dumpHashWithFilters(
     if (not kvFilters.keyMatch(key, val)) {
       continue;
     }
-    DCHECK(val.hash_ref().has_value());
-    auto& value = thriftPub.keyVals_ref()[key];
-    value.version_ref() = *val.version_ref();
-    value.originatorId_ref() = *val.originatorId_ref();
-    value.hash_ref().copy_from(val.hash_ref());
-    value.ttl_ref() = *val.ttl_ref();
-    value.ttlVersion_ref() = *val.ttlVersion_ref();
+    thriftPub.keyVals_ref()[key] = getValueHash(val);
+  }
+  return thriftPub;
+}
+
+template <typename KvStoreMapT>
+thrift::Publication
+dumpHashOfKeys(
+    const std::string& area,
+    const KvStoreMapT& kvStore,
+    const std::vector<std::string>& keys) {
+  thrift::Publication thriftPub;
+  thriftPub.area_ref() = area;
+  for (auto const& key : keys) {
+    auto it = kvStore.find(key);
+    if (it == kvStore.end()) {
+      continue;
+    }
+    thriftPub.keyVals_ref()[key] = getValueHash(it->second);
   }
   return thriftPub;
 }
+
+thrift::KvStoreSyncChunk
+packSyncChunk(
+    thrift::Publication&& pub,
+    std::optional<std::string> const& chunkEnd,
+    thrift::KvStoreCompression compression) {
+  thrift::KvStoreSyncChunk chunk;
+  chunk.chunkEnd_ref().from_optional(chunkEnd);
+
+  auto codec = getSyncChunkCodec(compression);
+  if (not codec) {
+    chunk.publication_ref() = std::move(pub);
+    return chunk;
+  }
+  apache::thrift::CompactSerializer serializer;
+  chunk.compressedPublication_ref() =
+      codec->compress(writeThriftObjStr(pub, serializer));
+  chunk.compression_ref() = compression;
+  return chunk;
+}
+
+thrift::Publication
+unpackSyncChunk(thrift::KvStoreSyncChunk&& chunk) {
+  auto compressedPub = chunk.compressedPublication_ref();
+  if (not compressedPub.has_value()) {
+    return std::move(*chunk.publication_ref());
+  }
+  auto codec = getSyncChunkCodec(*chunk.compression_ref());
+  if (not codec) {
+    throw std::runtime_error(fmt::format(
+        "Unsupported full-sync chunk compression: {}",
+        apache::thrift::util::enumNameSafe(*chunk.compression_ref())));
+  }
+  apache::thrift::CompactSerializer serializer;
+  return readThriftObjStr<thrift::Publication>(
+      codec->uncompress(*compressedPub), serializer);
+}
 // update TTL with remainng time to expire, TTL version remains
 // same so existing keys will not be updated with this TTL
 void
@@ -435,27 +637,28 @@ updatePublicationTtl(
     const std::chrono::milliseconds ttlDecr,
     thrift::Publication& thriftPub) {
   auto timeNow = std::chrono::steady_clock::now();
-  for (const auto& qE : ttlCountdownQueue) {
+  auto& keyVals = *thriftPub.keyVals_ref();
+  for (auto kv = keyVals.begin(); kv != keyVals.end();) {
     // Find key and ensure we are taking time from right entry from queue
-    auto kv = thriftPub.keyVals_ref()->find(qE.key);
-    if (kv == thriftPub.keyVals_ref()->end() or
-        *kv->second.version_ref() != qE.version or
-        *kv->second.originatorId_ref() != qE.originatorId or
-        *kv->second.ttlVersion_ref() != qE.ttlVersion) {
+    auto qE = ttlCountdownQueue.find(kv->first);
+    if (not qE or *kv->second.version_ref() != qE->version or
+        *kv->second.originatorId_ref() != qE->originatorId or
+        *kv->second.ttlVersion_ref() != qE->ttlVersion) {
+      ++kv;
       continue;
     }
 
     // Compute timeLeft and do sanity check on it
     auto timeLeft = std::chrono::duration_cast<std::chrono::milliseconds>(
-        qE.expiryTime - timeNow);
+        qE->expiryTime - timeNow);
     if (timeLeft <= ttlDecr) {
-      thriftPub.keyVals_ref()->erase(kv);
+      kv = keyVals.erase(kv);
       continue;
     }
 
     // filter key from publication if time left is below ttl threshold
     if (timeLeft < Constants::kTtlThreshold) {
-      thriftPub.keyVals_ref()->erase(kv);
+      kv = keyVals.erase(kv);
       continue;
     }
 
@@ -463,7 +666,360 @@ updatePublicationTtl(
     // deterministically whenever it is exchanged between KvStores. This
     // will avoid looping of updates between stores.
     kv->second.ttl_ref() = timeLeft.count() - ttlDecr.count();
+    ++kv;
+  }
+}
+
+std::string
+getKvStoreSnapshotPath(
+    const std::string& snapshotDir, const std::string& area) {
+  return fmt::format("{}/kvstore_snapshot_{}.bin", snapshotDir, area);
+}
+
+bool
+writeKvStoreSnapshot(
+    const std::string& filePath,
+    const thrift::KvStoreSnapshot& snapshot) noexcept {
+  try {
+    apache::thrift::CompactSerializer serializer;
+    folly::writeFileAtomic(
+        filePath, writeThriftObjStr(snapshot, serializer), 0644);
+  } catch (std::exception const& ex) {
+    XLOG(ERR) << "Failed to write KvStore snapshot to " << filePath
+              << ". Error: " << folly::exceptionStr(ex);
+    return false;
+  }
+  return true;
+}
+
+std::optional<thrift::KvStoreSnapshot>
+readKvStoreSnapshot(const std::string& filePath) noexcept {
+  if (not std::filesystem::exists(filePath)) {
+    XLOG(INFO) << "KvStore snapshot " << filePath << " doesn't exist";
+    return std::nullopt;
+  }
+
+  thrift::KvStoreSnapshot snapshot;
+  try {
+    folly::MemoryMapping mapping(filePath.c_str());
+    apache::thrift::CompactSerializer::deserialize(mapping.range(), snapshot);
+  } catch (std::exception const& ex) {
+    XLOG(ERR) << "Failed to read KvStore snapshot from " << filePath
+              << ". Error: " << folly::exceptionStr(ex);
+    return std::nullopt;
   }
+
+  if (*snapshot.version_ref() != Constants::kKvStoreSnapshotVersion) {
+    XLOG(WARNING) << "Ignore KvStore snapshot " << filePath
+                  << " of version: " << *snapshot.version_ref();
+    return std::nullopt;
+  }
+  return snapshot;
+}
+
+void
+updateSnapshotTtl(
+    thrift::KvStoreSnapshot& snapshot,
+    int64_t nowMs,
+    const std::chrono::milliseconds ttlDecr) {
+  const auto elapsedMs =
+      std::max<int64_t>(0, nowMs - *snapshot.timestamp_ms_ref());
+  auto& keyVals = *snapshot.keyVals_ref();
+  for (auto kv = keyVals.begin(); kv != keyVals.end();) {
+    auto& ttl = *kv->second.ttl_ref();
+    if (ttl == Constants::kTtlInfinity) {
+      ++kv;
+      continue;
+    }
+    if (ttl - elapsedMs <= ttlDecr.count()) {
+      kv = keyVals.erase(kv);
+      continue;
+    }
+    ttl -= elapsedMs;
+    ++kv;
+  }
+}
+
+thrift::Publication
+dumpSnapshotWithFilters(
+    const KvStoreDumpSnapshot& snapshot,
+    const KvStoreFilters& kvFilters,
+    bool doNotPublishValue,
+    int64_t nowMs) {
+  const auto& area = *snapshot.snapshot.area_ref();
+  auto thriftPub = dumpAllWithFilters(
+      area, *snapshot.snapshot.keyVals_ref(), kvFilters, doNotPublishValue);
+
+  // age ttl of matched key-vals ONLY. Same threshold as regular dump.
+  thrift::KvStoreSnapshot dump;
+  dump.timestamp_ms_ref() = *snapshot.snapshot.timestamp_ms_ref();
+  dump.keyVals_ref() = std::move(*thriftPub.keyVals_ref());
+  updateSnapshotTtl(dump, nowMs, Constants::kTtlThreshold);
+
+  thriftPub.keyVals_ref() = std::move(*dump.keyVals_ref());
+  thriftPub.seqNum_ref() = snapshot.seqNum;
+  return thriftPub;
+}
+
+int64_t
+getValueDeltaHash(const std::string& value) {
+  return static_cast<int64_t>(
+      folly::hash::SpookyHashV2::Hash64(value.data(), value.size(), 0));
+}
+
+std::optional<thrift::ValueDelta>
+createValueDelta(const thrift::Value& base, const thrift::Value& value) {
+  if (not base.value_ref().has_value() or not value.value_ref().has_value()) {
+    return std::nullopt;
+  }
+  auto const& oldStr = *base.value_ref();
+  auto const& newStr = *value.value_ref();
+  if (newStr.size() < Constants::kKvStoreValueDeltaMinSize) {
+    return std::nullopt;
+  }
+
+  // longest common prefix, then longest common suffix of the remainder
+  const size_t maxCommon = std::min(oldStr.size(), newStr.size());
+  size_t prefix = 0;
+  while (prefix < maxCommon and oldStr[prefix] == newStr[prefix]) {
+    ++prefix;
+  }
+  size_t suffix = 0;
+  while (suffix < maxCommon - prefix and
+         oldStr[oldStr.size() - suffix - 1] ==
+             newStr[newStr.size() - suffix - 1]) {
+    ++suffix;
+  }
+
+  const size_t dataLen = newStr.size() - prefix - suffix;
+  if (dataLen * 2 > newStr.size()) {
+    return std::nullopt;
+  }
+
+  thrift::ValuePatchOp op;
+  op.offset_ref() = static_cast<int32_t>(prefix);
+  op.length_ref() = static_cast<int32_t>(oldStr.size() - prefix - suffix);
+  op.data_ref() = newStr.substr(prefix, dataLen);
+
+  thrift::ValueDelta delta;
+  delta.baseVersion_ref() = *base.version_ref();
+  delta.ops_ref()->emplace_back(std::move(op));
+  delta.valueHash_ref() = getValueDeltaHash(newStr);
+  return delta;
+}
+
+std::optional<std::string>
+applyValueDelta(const std::string& base, const thrift::ValueDelta& delta) {
+  std::string result;
+  result.reserve(base.size());
+  size_t pos = 0;
+  for (auto const& op : *delta.ops_ref()) {
+    if (*op.offset_ref() < 0 or *op.length_ref() < 0) {
+      return std::nullopt;
+    }
+    const size_t offset = *op.offset_ref();
+    const size_t length = *op.length_ref();
+    if (offset < pos or offset + length > base.size()) {
+      return std::nullopt;
+    }
+    result.append(base, pos, offset - pos);
+    result.append(*op.data_ref());
+    pos = offset + length;
+  }
+  result.append(base, pos, std::string::npos);
+
+  if (getValueDeltaHash(result) != *delta.valueHash_ref()) {
+    return std::nullopt;
+  }
+  return result;
+}
+
+std::string
+getKeyFamily(const std::string& key) {
+  const auto pos = key.find(Constants::kPrefixNameSeparator.data(), 0, 1);
+  if (pos == std::string::npos or pos == 0) {
+    return Constants::kKvStoreKeyFamilyOther.toString();
+  }
+  return key.substr(0, pos);
+}
+
+int64_t
+getKeyValBytes(const std::string& key, const thrift::Value& value) {
+  int64_t bytes = key.size() + value.originatorId_ref()->size();
+  if (value.value_ref().has_value()) {
+    bytes += value.value_ref()->size();
+  }
+  if (value.delta_ref().has_value()) {
+    for (auto const& op : *value.delta_ref()->ops_ref()) {
+      bytes += op.data_ref()->size();
+    }
+  }
+  return bytes;
+}
+
+size_t
+mergeDumpedKeyVals(
+    std::unordered_map<std::string, thrift::Value>& merged,
+    std::unordered_map<std::string, thrift::Value>&& keyVals) {
+  for (auto it = keyVals.begin(); it != keyVals.end();) {
+    auto mergedIt = merged.find(it->first);
+    if (mergedIt == merged.end()) {
+      ++it;
+      continue;
+    }
+    const auto& mergedVal = mergedIt->second;
+    const auto& val = it->second;
+    if (*mergedVal.version_ref() == *val.version_ref() and
+        *mergedVal.originatorId_ref() == *val.originatorId_ref() and
+        *mergedVal.ttlVersion_ref() >= *val.ttlVersion_ref()) {
+      it = keyVals.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  if (keyVals.empty()) {
+    return 0;
+  }
+  return mergeKeyValues(merged, keyVals).first.size();
 }
 
+thrift::KeySetParams
+serializeKeySetParams(const thrift::KeySetParams& params) {
+  thrift::KeySetParams serializedParams;
+  serializedParams.nodeIds_ref().copy_from(params.nodeIds_ref());
+  serializedParams.floodRootId_ref().copy_from(params.floodRootId_ref());
+  serializedParams.timestamp_ms_ref().copy_from(params.timestamp_ms_ref());
+  serializedParams.senderId_ref().copy_from(params.senderId_ref());
+  serializedParams.floodDigest_ref().copy_from(params.floodDigest_ref());
+
+  // Same bytes as `KeySetParams` with ONLY `keyVals` set
+  folly::IOBufQueue queue(folly::IOBufQueue::cacheChainLength());
+  apache::thrift::CompactProtocolWriter writer;
+  writer.setOutput(&queue);
+  const auto& keyVals = *params.keyVals_ref();
+  writer.writeStructBegin("KeySetParams");
+  writer.writeFieldBegin("keyVals", apache::thrift::protocol::T_MAP, 2);
+  writer.writeMapBegin(
+      apache::thrift::protocol::T_STRING,
+      apache::thrift::protocol::T_STRUCT,
+      keyVals.size());
+  for (auto const& [key, val] : keyVals) {
+    writer.writeString(key);
+    val.write(&writer);
+  }
+  writer.writeMapEnd();
+  writer.writeFieldEnd();
+  writer.writeFieldStop();
+  writer.writeStructEnd();
+  serializedParams.serializedKeyVals_ref() = std::move(*queue.move());
+  return serializedParams;
+}
+
+void
+deserializeKeySetParams(thrift::KeySetParams& params) {
+  if (not params.serializedKeyVals_ref().has_value()) {
+    return;
+  }
+  try {
+    auto keyValsOnly =
+        apache::thrift::CompactSerializer::deserialize<thrift::KeySetParams>(
+            &params.serializedKeyVals_ref().value());
+    params.keyVals_ref() = std::move(*keyValsOnly.keyVals_ref());
+  } catch (const std::exception& ex) {
+    throw thrift::KvStoreError(
+        fmt::format("Malformed serialized key-vals: {}", ex.what()));
+  }
+  params.serializedKeyVals_ref().reset();
+}
+
+// explicit instantiation for KvStoreDb storage and thrift::KeyVals
+template std::pair<
+    std::unordered_map<std::string, thrift::Value>,
+    KvStoreNoMergeReasonStats>
+mergeKeyValues<KvStoreMap>(
+    KvStoreMap& kvStore,
+    std::unordered_map<std::string, thrift::Value> const& keyVals,
+    std::optional<KvStoreFilters> const& filters);
+template std::pair<
+    std::unordered_map<std::string, thrift::Value>,
+    KvStoreNoMergeReasonStats>
+mergeKeyValues<std::unordered_map<std::string, thrift::Value>>(
+    std::unordered_map<std::string, thrift::Value>& kvStore,
+    std::unordered_map<std::string, thrift::Value> const& keyVals,
+    std::optional<KvStoreFilters> const& filters);
+
+template thrift::Publication dumpAllWithFilters<KvStoreMap>(
+    const std::string& area,
+    const KvStoreMap& kvStore,
+    const KvStoreFilters& kvFilters,
+    bool doNotPublishValue);
+template thrift::Publication
+dumpAllWithFilters<std::unordered_map<std::string, thrift::Value>>(
+    const std::string& area,
+    const std::unordered_map<std::string, thrift::Value>& kvStore,
+    const KvStoreFilters& kvFilters,
+    bool doNotPublishValue);
+
+template thrift::Publication dumpHashWithFilters<KvStoreMap>(
+    const std::string& area,
+    const KvStoreMap& kvStore,
+    const KvStoreFilters& kvFilters);
+template thrift::Publication
+dumpHashWithFilters<std::unordered_map<std::string, thrift::Value>>(
+    const std::string& area,
+    const std::unordered_map<std::string, thrift::Value>& kvStore,
+    const KvStoreFilters& kvFilters);
+
+// explicit instantiation for key-sharded KvStoreDb storage, see [Key Sharding]
+template std::pair<
+    std::unordered_map<std::string, thrift::Value>,
+    KvStoreNoMergeReasonStats>
+mergeKeyValues<KvStoreShardedMap>(
+    KvStoreShardedMap& kvStore,
+    std::unordered_map<std::string, thrift::Value> const& keyVals,
+    std::optional<KvStoreFilters> const& filters);
+template thrift::Publication dumpAllWithFilters<KvStoreShardedMap>(
+    const std::string& area,
+    const KvStoreShardedMap& kvStore,
+    const KvStoreFilters& kvFilters,
+    bool doNotPublishValue);
+template thrift::Publication dumpHashWithFilters<KvStoreShardedMap>(
+    const std::string& area,
+    const KvStoreShardedMap& kvStore,
+    const KvStoreFilters& kvFilters);
+
+// explicit instantiation of dumps served by key index
+template thrift::Publication dumpAllWithFilters<KvStoreMap>(
+    const std::string& area,
+    const KvStoreMap& kvStore,
+    const KvStoreKeyIndex& keyIndex,
+    const KvStoreFilters& kvFilters,
+    bool doNotPublishValue);
+template thrift::Publication dumpAllWithFilters<KvStoreShardedMap>(
+    const std::string& area,
+    const KvStoreShardedMap& kvStore,
+    const KvStoreKeyIndex& keyIndex,
+    const KvStoreFilters& kvFilters,
+    bool doNotPublishValue);
+template thrift::Publication dumpKeysWithFilters<KvStoreMap>(
+    const std::string& area,
+    const KvStoreMap& kvStore,
+    const std::vector<std::string>& keys,
+    const KvStoreFilters& kvFilters,
+    bool doNotPublishValue);
+template thrift::Publication dumpKeysWithFilters<KvStoreShardedMap>(
+    const std::string& area,
+    const KvStoreShardedMap& kvStore,
+    const std::vector<std::string>& keys,
+    const KvStoreFilters& kvFilters,
+    bool doNotPublishValue);
+template thrift::Publication dumpHashOfKeys<KvStoreMap>(
+    const std::string& area,
+    const KvStoreMap& kvStore,
+    const std::vector<std::string>& keys);
+template thrift::Publication dumpHashOfKeys<KvStoreShardedMap>(
+    const std::string& area,
+    const KvStoreShardedMap& kvStore,
+    const std::vector<std::string>& keys);
+
 }; // namespace openr
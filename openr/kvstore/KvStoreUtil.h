@@ -7,15 +7,38 @@
 
 #pragma once
 
+#include <folly/container/F14Map.h>
 #include <folly/io/async/AsyncSocket.h>
 #include <openr/common/Constants.h>
 #include <openr/common/Types.h>
 #include <openr/if/gen-cpp2/KvStore_types.h>
+#include <openr/kvstore/KvStoreKeyIndex.h>
+#include <openr/kvstore/KvStoreShardedMap.h>
+#include <openr/kvstore/TtlCountdownQueue.h>
 
 #include <folly/ssl/SSLSessionManager.h>
 
 namespace openr {
 
+/*
+ * In-memory storage backend of KvStoreDb key-vals.
+ *
+ * F14NodeMap probes open-addressed chunks of 14 slots with SIMD tag matching,
+ * hence lookup touches one cache line of metadata instead of walking bucket
+ * chains. Compared to std::unordered_map it also drops the per-node `next`
+ * pointer and cached hash. Node-based flavor is used since `thrift::Value` is
+ * large and references MUST stay valid across rehash.
+ *
+ * NOTE: iteration order is unspecified, same as std::unordered_map.
+ *
+ * NOTE: only the map layout changes. Keys are still owned std::string and
+ * values the thrift::Value shared with the wire type, i.e. neither interned
+ * keys nor arena or IOBuf-backed values are provided. Algorithms over the
+ * store are templated on the map type, so another backend can be plugged in
+ * by instantiating them for it, see KvStoreUtil.cpp.
+ */
+using KvStoreMap = folly::F14NodeMap<std::string, thrift::Value>;
+
 class KvStoreFilters {
  public:
   // takes the list of comma separated key prefixes to match,
@@ -40,6 +63,9 @@ class KvStoreFilters {
   // return set of origninator IDs
   std::set<std::string> getOriginatorIdList() const;
 
+  // return OR/AND matching logic
+  thrift::FilterOperator getFilterOperator() const;
+
   // print filters
   std::string str() const;
 
@@ -76,6 +102,15 @@ template <typename ThriftType>
 static std::unordered_map<std::string, ThriftType> parseThriftValues(
     std::unordered_map<std::string, thrift::Value> const& keyVals);
 
+/**
+ * Same as above, with values split evenly across `numThreads` threads.
+ * Parsed on the calling thread if `numThreads` is at most 1.
+ */
+template <typename ThriftType>
+static std::unordered_map<std::string, ThriftType> parseThriftValues(
+    std::unordered_map<std::string, thrift::Value> const& keyVals,
+    size_t numThreads);
+
 /**
  * Similar to the above but parses the values according to the ThriftType
  * passed. This will hide the version/originator & other details
@@ -90,6 +125,8 @@ static std::unordered_map<std::string, ThriftType> parseThriftValues(
  * @param sslContext - context to use for SSL connection
  * @param maybeIpTos - IP_TOS value for control plane if passed in
  * @param bindAddr - source addr for binding purpose. Default will be ANY
+ * @param maxConcurrency - max number of stores queried at once
+ * @param numParseThreads - number of threads parsing merged values
  *
  * @return
  *  - First member of the pair is key-value map obtained by merging data
@@ -109,13 +146,21 @@ dumpAllWithPrefixMultipleAndParse(
     std::chrono::milliseconds processTimeout = Constants::kServiceProcTimeout,
     const std::shared_ptr<folly::SSLContext> sslContext = nullptr,
     std::optional<int> maybeIpTos = std::nullopt,
-    const folly::SocketAddress& bindAddr = folly::AsyncSocket::anyAddress());
+    const folly::SocketAddress& bindAddr = folly::AsyncSocket::anyAddress(),
+    size_t maxConcurrency = Constants::kKvStoreDumpMaxConcurrency,
+    size_t numParseThreads = Constants::kKvStoreDumpParseThreads);
 
 /*
  * This will be a static method to do a full-dump of KvStore key-val to
  * multiple KvStore instances. It will fetch values from different KvStore
  * instances and merge them together to finally return thrift::Value
  *
+ * [Multi-node Dump]
+ * At most `maxConcurrency` stores are queried at once, the next one as soon
+ * as any completes. Every response is merged as it arrives and dropped
+ * right after, see mergeDumpedKeyVals(). Hence memory is bounded by merged
+ * key-vals plus responses in flight, regardless of number of stores.
+ *
  * @param sockAddrs - (address, port) to connect OpenR instance to
  * @param prefix - the key prefix used for key dumping. Dump all if empty
  * @param connectTimeout - timeout value set on connecting server
@@ -123,6 +168,7 @@ dumpAllWithPrefixMultipleAndParse(
  * @param sslContext - context to use for SSL connection
  * @param maybeIpTos - IP_TOS value for control plane if passed in
  * @param bindAddr - source addr for binding purpose. Default will be ANY
+ * @param maxConcurrency - max number of stores queried at once
  *
  * @return
  *  - First member of the pair is key-value map obtained by merging data
@@ -141,7 +187,22 @@ dumpAllWithThriftClientFromMultiple(
     std::chrono::milliseconds processTimeout = Constants::kServiceProcTimeout,
     const std::shared_ptr<folly::SSLContext> sslContext = nullptr,
     std::optional<int> maybeIpTos = std::nullopt,
-    const folly::SocketAddress& bindAddr = folly::AsyncSocket::anyAddress());
+    const folly::SocketAddress& bindAddr = folly::AsyncSocket::anyAddress(),
+    size_t maxConcurrency = Constants::kKvStoreDumpMaxConcurrency);
+
+/*
+ * [Multi-node Dump]
+ *
+ * Merge key-vals dumped from one of multiple stores into `merged`. Key-vals
+ * already merged with the same (version, originatorId) and no higher
+ * ttlVersion, i.e. the same value as reported by another store, are dropped
+ * upfront without comparing values.
+ *
+ * @return number of key-vals updated in `merged`
+ */
+size_t mergeDumpedKeyVals(
+    std::unordered_map<std::string, thrift::Value>& merged,
+    std::unordered_map<std::string, thrift::Value>&& keyVals);
 
 /*
  * Static method to retrieve loggable key-value information.
@@ -186,12 +247,17 @@ struct KvStoreNoMergeReasonStats {
   uint32_t numberOfNoNeedToUpdates{0};
 };
 
+// KvStoreFilters requested by KeyDumpParams. Default to OR operator.
+KvStoreFilters getKeyDumpFilters(thrift::KeyDumpParams const& keyDumpParams);
+
 /*
  * Static method to precess the key-values publication, attempt to merge it
  in
  * the existing map, and return a publication made out of the updated values.
  *
- * @param kvStore - key-value map with current key-values in KVStore
+ * @param kvStore - key-value map with current key-values in KVStore. Either
+ *                  KvStoreMap, KvStoreShardedMap or std::unordered_map
+ *                  (explicitly instantiated)
  * @param keyVals - key-value map with key-values to merge in
  * @param filters - optional filters, matching keys in keyVals will be
                     merged in
@@ -201,14 +267,39 @@ struct KvStoreNoMergeReasonStats {
  *    the updated values
  *  - the statistics
  */
+template <typename KvStoreMapT>
 std::pair<
     std::unordered_map<std::string, thrift::Value>,
     KvStoreNoMergeReasonStats>
 mergeKeyValues(
-    std::unordered_map<std::string, thrift::Value>& kvStore,
+    KvStoreMapT& kvStore,
     std::unordered_map<std::string, thrift::Value> const& keyVals,
     std::optional<KvStoreFilters> const& filters = std::nullopt);
 
+// [Key Sharding] key-vals of a publication falling into one shard, referring
+// to entries of the publication instead of copying them
+using KvStoreShardSlice =
+    std::vector<std::pair<const std::string, thrift::Value> const*>;
+
+// [Key Sharding] Split keyVals into one slice per shard of kvStore, in a
+// single pass over keyVals. Slices are valid as long as keyVals is.
+std::vector<KvStoreShardSlice> splitKeyValuesByShard(
+    KvStoreShardedMap const& kvStore,
+    std::unordered_map<std::string, thrift::Value> const& keyVals);
+
+// [Key Sharding] Same as mergeKeyValues(), but merges slice of key-vals
+// falling into shard `shardIdx` of kvStore, see splitKeyValuesByShard().
+// Shards are merged into independently, hence concurrently as long as
+// key-vals and filters are not modified meanwhile.
+std::pair<
+    std::unordered_map<std::string, thrift::Value>,
+    KvStoreNoMergeReasonStats>
+mergeKeyValuesIntoShard(
+    KvStoreShardedMap& kvStore,
+    size_t shardIdx,
+    KvStoreShardSlice const& keyVals,
+    std::optional<KvStoreFilters> const& filters = std::nullopt);
+
 /*
  * Compare two thrift::Values to figure out which value is better to
  * use, it will compare following attributes in order
@@ -233,19 +324,63 @@ thrift::Publication dumpDifference(
     std::unordered_map<std::string, thrift::Value> const& reqKeyVal);
 
 // Dump the entries of my KV store whose keys match the filter
+template <typename KvStoreMapT>
+thrift::Publication dumpAllWithFilters(
+    const std::string& area,
+    const KvStoreMapT& kvStore,
+    const KvStoreFilters& kvFilters,
+    bool doNotPublishValue = false);
+
+// Same as above, but ONLY visits candidate keys from the key index, i.e.
+// O(matching keys) instead of O(total keys). Falls back to full scan if
+// filters can not be served by the index.
+template <typename KvStoreMapT>
 thrift::Publication dumpAllWithFilters(
     const std::string& area,
-    const std::unordered_map<std::string, thrift::Value>& kvStore,
+    const KvStoreMapT& kvStore,
+    const KvStoreKeyIndex& keyIndex,
+    const KvStoreFilters& kvFilters,
+    bool doNotPublishValue = false);
+
+// Same as above, but ONLY visits given keys, e.g. keys of full-sync chunk
+template <typename KvStoreMapT>
+thrift::Publication dumpKeysWithFilters(
+    const std::string& area,
+    const KvStoreMapT& kvStore,
+    const std::vector<std::string>& keys,
     const KvStoreFilters& kvFilters,
     bool doNotPublishValue = false);
 
 // Dump the hashes of my KV store whose keys match the given prefix
 // If prefix is the empty sting, the full hash store is dumped
+template <typename KvStoreMapT>
 thrift::Publication dumpHashWithFilters(
     const std::string& area,
-    const std::unordered_map<std::string, thrift::Value>& kvStore,
+    const KvStoreMapT& kvStore,
     const KvStoreFilters& kvFilters);
 
+// Dump the hashes of given keys of my KV store. Missing keys are skipped.
+template <typename KvStoreMapT>
+thrift::Publication dumpHashOfKeys(
+    const std::string& area,
+    const KvStoreMapT& kvStore,
+    const std::vector<std::string>& keys);
+
+/*
+ * [Chunked Full-Sync]
+ *
+ * Wrap full-sync response covering keys up to `chunkEnd` into a chunk. The
+ * publication is serialized and compressed if `compression` is requested and
+ * its codec is available, otherwise it is sent as is.
+ */
+thrift::KvStoreSyncChunk packSyncChunk(
+    thrift::Publication&& pub,
+    std::optional<std::string> const& chunkEnd,
+    thrift::KvStoreCompression compression);
+
+// Extract publication out of full-sync chunk. Throws if payload is corrupted.
+thrift::Publication unpackSyncChunk(thrift::KvStoreSyncChunk&& chunk);
+
 // Update Time to expire filed in Publication
 // If timeleft is below Constants::kTtlThreshold, erase keyVals
 void updatePublicationTtl(
@@ -253,6 +388,123 @@ void updatePublicationTtl(
     const std::chrono::milliseconds ttlDecr,
     thrift::Publication& thriftPub);
 
+/*
+ * [Warm Restart Snapshot]
+ *
+ * Path of the snapshot file of `area` under directory `snapshotDir`
+ */
+std::string getKvStoreSnapshotPath(
+    const std::string& snapshotDir, const std::string& area);
+
+/*
+ * Serialize snapshot with compact protocol and write it over `filePath`
+ * atomically, i.e. a reader never observes a partially written snapshot.
+ *
+ * @return false on any I/O error
+ */
+bool writeKvStoreSnapshot(
+    const std::string& filePath,
+    const thrift::KvStoreSnapshot& snapshot) noexcept;
+
+/*
+ * Memory-map the snapshot file and deserialize it straight out of the mapped
+ * pages, without copying the file into an intermediate buffer.
+ *
+ * @return std::nullopt if file does not exist, is corrupted or carries other
+ *         version than Constants::kKvStoreSnapshotVersion
+ */
+std::optional<thrift::KvStoreSnapshot> readKvStoreSnapshot(
+    const std::string& filePath) noexcept;
+
+/*
+ * Age ttl of key-vals by the time elapsed since snapshot was taken. Keys
+ * which have expired meanwhile, or would expire within `ttlDecr`, are erased.
+ */
+void updateSnapshotTtl(
+    thrift::KvStoreSnapshot& snapshot,
+    int64_t nowMs,
+    const std::chrono::milliseconds ttlDecr);
+
+/*
+ * [Snapshot Dump]
+ *
+ * In-memory copy of key-vals of an area, reflecting all publications to local
+ * subscribers up to `seqNum`. Immutable once taken and shared by all dumps
+ * served off it.
+ */
+struct KvStoreDumpSnapshot {
+  int64_t seqNum{0};
+  thrift::KvStoreSnapshot snapshot;
+};
+
+/*
+ * Dump key-vals of `snapshot` matching the filter, with ttl aged by the time
+ * elapsed since snapshot was taken. Publication is tagged with `seqNum` of
+ * the snapshot.
+ */
+thrift::Publication dumpSnapshotWithFilters(
+    const KvStoreDumpSnapshot& snapshot,
+    const KvStoreFilters& kvFilters,
+    bool doNotPublishValue,
+    int64_t nowMs);
+
+/*
+ * [Value Delta]
+ *
+ * Hash of application data carried in `ValueDelta.valueHash`
+ */
+int64_t getValueDeltaHash(const std::string& value);
+
+/*
+ * Encode `value` as delta against `base`, i.e. replace the range between
+ * common prefix and common suffix of both.
+ *
+ * @return std::nullopt if either has no application data, `value` is
+ *         smaller than Constants::kKvStoreValueDeltaMinSize or the delta
+ *         would not save at least half of the bytes
+ */
+std::optional<thrift::ValueDelta> createValueDelta(
+    const thrift::Value& base, const thrift::Value& value);
+
+/*
+ * Apply patch ops of delta on top of `base`.
+ *
+ * @return std::nullopt if any op is out of bounds or result doesn't match
+ *         `ValueDelta.valueHash`
+ */
+std::optional<std::string> applyValueDelta(
+    const std::string& base, const thrift::ValueDelta& delta);
+
+/*
+ * [Key Family Accounting]
+ *
+ * Family of key, i.e. leading part up to Constants::kPrefixNameSeparator,
+ * e.g. `adj` out of `adj:node1`. Constants::kKvStoreKeyFamilyOther if key
+ * has no separator.
+ */
+std::string getKeyFamily(const std::string& key);
+
+/*
+ * Size in bytes of key, originatorId and value (or delta) of key-val, the same
+ * as accounted by KvStoreDb::getKeyValsSize() less fixed struct overhead.
+ */
+int64_t getKeyValBytes(const std::string& key, const thrift::Value& value);
+
+/*
+ * [Serialized Flood]
+ *
+ * Copy of `params` with key-vals serialized into `serializedKeyVals` in
+ * place of `keyVals`. Key-vals are written straight out of `params`, without
+ * intermediate copy.
+ */
+thrift::KeySetParams serializeKeySetParams(const thrift::KeySetParams& params);
+
+/*
+ * Restore `keyVals` of `params` out of `serializedKeyVals`, if set. Throws
+ * thrift::KvStoreError if serialized key-vals are malformed.
+ */
+void deserializeKeySetParams(thrift::KeySetParams& params);
+
 } // namespace openr
 
 #include <openr/kvstore/KvStoreUtil-inl.h>
@@ -249,7 +249,7 @@ KvStoreWrapper<ClientType>::recvPublication() {
 
     // TODO: add timeout to avoid infinite waiting
     if (auto* pub =
-            std::get_if<thrift::Publication>(&maybePublication.value())) {
+            std::get_if<thrift::Publication>(maybePublication.value().get())) {
       return *pub;
     }
   }
@@ -266,8 +266,8 @@ KvStoreWrapper<ClientType>::recvKvStoreSyncedSignal() {
     }
 
     // TODO: add timeout to avoid infinite waiting
-    if (auto* event =
-            std::get_if<thrift::InitializationEvent>(&maybeEvent.value())) {
+    if (auto* event = std::get_if<thrift::InitializationEvent>(
+            maybeEvent.value().get())) {
       CHECK(*event == thrift::InitializationEvent::KVSTORE_SYNCED);
       return;
     }
@@ -336,6 +336,16 @@ KvStoreWrapper<ClientType>::getSummary(std::set<std::string> selectAreas) {
       kvStore_->semifuture_getKvStoreAreaSummaryInternal(selectAreas).get());
 }
 
+template <class ClientType>
+size_t
+KvStoreWrapper<ClientType>::getKeyValsBytes(AreaId const& area) {
+  auto summaries = getSummary(std::set<std::string>{area.t});
+  if (summaries.empty()) {
+    return 0;
+  }
+  return *summaries.front().keyValsBytes_ref();
+}
+
 /*
  * ATTN: DO NOT REMOVE THIS.
  * This is explicitly instantiate all the possible template instances.
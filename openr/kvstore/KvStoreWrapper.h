@@ -62,7 +62,7 @@ class KvStoreWrapper {
   /**
    * Get reader for KvStore updates queue
    */
-  messaging::RQueue<KvStorePublication>
+  messaging::SharedRQueue<KvStorePublication>
   getReader() {
     return kvStoreUpdatesQueue_.getReader();
   }
@@ -196,6 +196,12 @@ class KvStoreWrapper {
   std::vector<thrift::KvStoreAreaSummary> getSummary(
       std::set<std::string> selectAreas);
 
+  /**
+   * API to get size (in bytes) of key-vals stored in given area. This is the
+   * same accounting as `KvStoreAreaSummary.keyValsBytes`.
+   */
+  size_t getKeyValsBytes(AreaId const& area);
+
   /**
    * Utility function to get peer-spec for owned KvStore
    */
@@ -252,8 +258,8 @@ class KvStoreWrapper {
   const thrift::KvStoreConfig kvStoreConfig_;
 
   // Queue for streaming KvStore updates
-  messaging::ReplicateQueue<KvStorePublication> kvStoreUpdatesQueue_;
-  messaging::RQueue<KvStorePublication> kvStoreUpdatesQueueReader_{
+  messaging::SharedReplicateQueue<KvStorePublication> kvStoreUpdatesQueue_;
+  messaging::SharedRQueue<KvStorePublication> kvStoreUpdatesQueueReader_{
       kvStoreUpdatesQueue_.getReader()};
 
   // Queue to get KvStore Initial Sync Updates
@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+
+#include <folly/logging/xlog.h>
+
+#include <openr/kvstore/TtlCountdownQueue.h>
+
+namespace openr {
+
+namespace {
+
+constexpr uint64_t kSlotMask{TtlCountdownQueue::kNumSlots - 1};
+
+// number of ticks covered by one slot of the level
+constexpr uint64_t
+getSlotSpan(size_t level) {
+  return uint64_t(1) << (TtlCountdownQueue::kNumSlotBits * level);
+}
+
+} // namespace
+
+TtlCountdownQueue::TtlCountdownQueue(
+    std::chrono::milliseconds tick,
+    std::chrono::steady_clock::time_point origin)
+    : tick_(tick), origin_(origin) {
+  CHECK_GT(tick_.count(), 0) << "TtlCountdownQueue tick must be positive";
+}
+
+uint64_t
+TtlCountdownQueue::toTick(
+    std::chrono::steady_clock::time_point time, bool roundUp) const {
+  if (time <= origin_) {
+    return 0;
+  }
+  const uint64_t elapsed =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(time - origin_)
+          .count();
+  const uint64_t tickNs =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(tick_).count();
+  uint64_t ticks = elapsed / tickNs;
+  if (roundUp and (elapsed % tickNs)) {
+    ++ticks;
+  }
+  return ticks;
+}
+
+std::chrono::steady_clock::time_point
+TtlCountdownQueue::toTime(uint64_t tick) const {
+  return origin_ + tick_ * static_cast<int64_t>(tick);
+}
+
+void
+TtlCountdownQueue::place(
+    std::string const& key, Node& node, uint64_t baseTick) {
+  // entries beyond the span of the wheel are parked on the top level and
+  // re-evaluated when their slot is cascaded
+  const uint64_t maxDelta = getSlotSpan(kNumLevels) - 1;
+  const uint64_t placeTick = std::min(node.expiryTick, baseTick + maxDelta);
+  const uint64_t delta = placeTick - baseTick;
+
+  size_t level = 0;
+  while (level + 1 < kNumLevels and delta >= getSlotSpan(level + 1)) {
+    ++level;
+  }
+
+  node.level = level;
+  node.slot = (placeTick >> (kNumSlotBits * level)) & kSlotMask;
+  slots_[node.level][node.slot].insert(key);
+  ++levelSizes_[node.level];
+}
+
+void
+TtlCountdownQueue::cascade(size_t level, uint64_t tick) {
+  auto& slot = slots_[level][(tick >> (kNumSlotBits * level)) & kSlotMask];
+  if (slot.empty()) {
+    return;
+  }
+
+  // every entry in this slot expires within [tick, tick + slotSpan), hence
+  // always lands on a lower level
+  auto keys = std::move(slot);
+  slot.clear();
+  levelSizes_[level] -= keys.size();
+  for (auto const& key : keys) {
+    auto it = entries_.find(key);
+    CHECK(it != entries_.end());
+    place(it->first, it->second, tick);
+  }
+}
+
+std::chrono::steady_clock::time_point
+TtlCountdownQueue::upsert(TtlCountdownQueueEntry entry) {
+  // never place entry into a tick which has already been processed
+  const uint64_t expiryTick =
+      std::max(toTick(entry.expiryTime, true /* roundUp */), currentTick_ + 1);
+
+  auto [it, inserted] = entries_.try_emplace(entry.key);
+  auto& node = it->second;
+  if (not inserted) {
+    // refresh in place: unlink from the old slot
+    slots_[node.level][node.slot].erase(it->first);
+    --levelSizes_[node.level];
+  }
+  node.entry = std::move(entry);
+  node.expiryTick = expiryTick;
+  place(it->first, node, currentTick_);
+  return toTime(expiryTick);
+}
+
+bool
+TtlCountdownQueue::erase(std::string const& key) {
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    return false;
+  }
+  slots_[it->second.level][it->second.slot].erase(key);
+  --levelSizes_[it->second.level];
+  entries_.erase(it);
+  return true;
+}
+
+TtlCountdownQueueEntry const*
+TtlCountdownQueue::find(std::string const& key) const {
+  auto it = entries_.find(key);
+  return it == entries_.end() ? nullptr : &it->second.entry;
+}
+
+std::vector<TtlCountdownQueueEntry>
+TtlCountdownQueue::expire(std::chrono::steady_clock::time_point now) {
+  std::vector<TtlCountdownQueueEntry> expiredEntries;
+  const uint64_t nowTick = toTick(now, false /* roundUp */);
+
+  while (currentTick_ < nowTick) {
+    if (entries_.empty()) {
+      currentTick_ = nowTick;
+      break;
+    }
+
+    uint64_t tick = currentTick_ + 1;
+    if (levelSizes_[0] == 0) {
+      // nothing can expire before next cascade, jump straight to it
+      const uint64_t nextCascadeTick = (currentTick_ | kSlotMask) + 1;
+      if (nextCascadeTick > nowTick) {
+        currentTick_ = nowTick;
+        break;
+      }
+      tick = nextCascadeTick;
+    }
+
+    // cascade from top to bottom so that entries can travel multiple levels
+    // within the same tick
+    for (size_t level = kNumLevels - 1; level > 0; --level) {
+      if ((tick & (getSlotSpan(level) - 1)) == 0) {
+        cascade(level, tick);
+      }
+    }
+
+    auto& slot = slots_[0][tick & kSlotMask];
+    for (auto const& key : slot) {
+      auto it = entries_.find(key);
+      CHECK(it != entries_.end());
+      expiredEntries.emplace_back(std::move(it->second.entry));
+      entries_.erase(it);
+    }
+    levelSizes_[0] -= slot.size();
+    slot.clear();
+    currentTick_ = tick;
+  }
+  return expiredEntries;
+}
+
+std::optional<std::chrono::steady_clock::time_point>
+TtlCountdownQueue::getNextExpiryTime() const {
+  if (entries_.empty()) {
+    return std::nullopt;
+  }
+
+  std::optional<uint64_t> nextTick;
+
+  // level-0 entries always expire within next kNumSlots ticks
+  if (levelSizes_[0]) {
+    for (uint64_t tick = currentTick_ + 1; tick <= currentTick_ + kNumSlots;
+         ++tick) {
+      if (not slots_[0][tick & kSlotMask].empty()) {
+        nextTick = tick;
+        break;
+      }
+    }
+  }
+
+  // higher levels need attention at the next cascade of a non-empty slot
+  for (size_t level = 1; level < kNumLevels; ++level) {
+    if (levelSizes_[level] == 0) {
+      continue;
+    }
+    const uint64_t span = getSlotSpan(level);
+    uint64_t tick = (currentTick_ / span + 1) * span;
+    for (size_t i = 0; i < kNumSlots; ++i, tick += span) {
+      if (nextTick.has_value() and tick >= *nextTick) {
+        break;
+      }
+      if (not slots_[level][(tick >> (kNumSlotBits * level)) & kSlotMask]
+                  .empty()) {
+        nextTick = tick;
+        break;
+      }
+    }
+  }
+
+  CHECK(nextTick.has_value());
+  return toTime(*nextTick);
+}
+
+} // namespace openr
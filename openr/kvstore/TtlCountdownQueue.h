@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <folly/container/F14Map.h>
+#include <folly/container/F14Set.h>
+
+namespace openr {
+
+struct TtlCountdownQueueEntry {
+  std::chrono::steady_clock::time_point expiryTime;
+  std::string key;
+  int64_t version{0};
+  int64_t ttlVersion{0};
+  std::string originatorId;
+};
+
+/*
+ * [TTL Countdown]
+ *
+ * TtlCountdownQueue tracks expiry of keys with finite TTL using a hashed
+ * hierarchical timing wheel (Varghese & Lauck). Time is quantized into ticks
+ * and the wheel holds `kNumLevels` levels of `kNumSlots` slots each, where a
+ * slot on level `L` spans `kNumSlots^L` ticks:
+ *
+ *  - key expiring within `kNumSlots` ticks sits on level 0, slot of its tick;
+ *  - key expiring further away sits on the level covering its distance, and is
+ *    cascaded down one or more levels when the wheel reaches its slot;
+ *
+ * There is at most ONE entry per key. TTL refresh updates the entry in place
+ * and moves it to its new slot, so both insert and cancel are O(1), instead of
+ * leaving a stale entry behind as a binary heap would.
+ *
+ * Entries are never expired early. They may expire up to one tick late.
+ */
+class TtlCountdownQueue {
+ public:
+  explicit TtlCountdownQueue(
+      std::chrono::milliseconds tick = std::chrono::milliseconds(10),
+      std::chrono::steady_clock::time_point origin =
+          std::chrono::steady_clock::now());
+
+  /*
+   * Insert new entry or replace existing entry of the same key.
+   *
+   * @return time at which the entry becomes due, i.e. the earliest time at
+   *         which `expire()` will return it. Aligned to tick boundary.
+   */
+  std::chrono::steady_clock::time_point upsert(TtlCountdownQueueEntry entry);
+
+  // remove entry of the key if any. Return true if entry was found.
+  bool erase(std::string const& key);
+
+  // lookup entry of the key. nullptr if key is not tracked.
+  TtlCountdownQueueEntry const* find(std::string const& key) const;
+
+  /*
+   * Advance the wheel to `now` and pop all entries which are due.
+   */
+  std::vector<TtlCountdownQueueEntry> expire(
+      std::chrono::steady_clock::time_point now);
+
+  /*
+   * Next time the wheel needs to be advanced, i.e. earliest level-0 expiry or
+   * cascade of a non-empty slot. std::nullopt if queue is empty.
+   */
+  std::optional<std::chrono::steady_clock::time_point> getNextExpiryTime()
+      const;
+
+  inline size_t
+  size() const {
+    return entries_.size();
+  }
+
+  inline bool
+  empty() const {
+    return entries_.empty();
+  }
+
+  inline std::chrono::milliseconds
+  getTick() const {
+    return tick_;
+  }
+
+  // number of slots per level. 256 slots * 4 levels cover 2^32 ticks.
+  static constexpr size_t kNumSlotBits{8};
+  static constexpr size_t kNumSlots{size_t(1) << kNumSlotBits};
+  static constexpr size_t kNumLevels{4};
+
+ private:
+  struct Node {
+    TtlCountdownQueueEntry entry;
+    // absolute tick at which entry expires
+    uint64_t expiryTick{0};
+    // current location in the wheel
+    uint8_t level{0};
+    uint16_t slot{0};
+  };
+
+  // convert time into absolute tick. Round up for expiry so that entries are
+  // never expired before their expiry time.
+  uint64_t toTick(std::chrono::steady_clock::time_point time, bool roundUp)
+      const;
+  std::chrono::steady_clock::time_point toTime(uint64_t tick) const;
+
+  // place node in the wheel relative to `baseTick`
+  void place(std::string const& key, Node& node, uint64_t baseTick);
+
+  // cascade slot of a higher level down to lower levels
+  void cascade(size_t level, uint64_t tick);
+
+  // size of a tick
+  const std::chrono::milliseconds tick_;
+
+  // time corresponding to tick 0
+  const std::chrono::steady_clock::time_point origin_;
+
+  // all ticks up to (including) currentTick_ have been processed
+  uint64_t currentTick_{0};
+
+  // one entry per key
+  folly::F14NodeMap<std::string, Node> entries_;
+
+  // keys stored in each slot of each level
+  std::array<std::array<folly::F14FastSet<std::string>, kNumSlots>, kNumLevels>
+      slots_;
+
+  // number of entries per level, used to skip over empty levels
+  std::array<size_t, kNumLevels> levelSizes_{};
+};
+
+} // namespace openr
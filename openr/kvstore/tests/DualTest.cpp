@@ -426,6 +426,36 @@ class DualBaseFixture : public ::testing::Test {
     }
   }
 
+  // trigger a node down/up event, where the node itself receives events of
+  // all associated links as a single batch
+  void
+  nodeEventsBatched(const std::string& node, bool up) {
+    std::map<std::string, std::optional<int64_t>> events;
+    for (auto& edge : edges) {
+      if ((edge.name1 != node and edge.name2 != node) or edge.up == up) {
+        continue; // link not affected
+      }
+      edge.up = up;
+      const auto& neighbor = edge.name1 == node ? edge.name2 : edge.name1;
+      events.emplace(
+          neighbor, up ? std::make_optional(edge.weight) : std::nullopt);
+    }
+    evb->runInEventBaseThread([&, node, events]() {
+      nodes.at(node)->peerEvents(events);
+      for (const auto& [neighbor, cost] : events) {
+        evb->runAfterDelay(
+            [&, node, neighbor = neighbor, cost = cost]() {
+              if (cost.has_value()) {
+                nodes.at(neighbor)->peerUp(node, *cost);
+              } else {
+                nodes.at(neighbor)->peerDown(node);
+              }
+            },
+            randomDelayMs());
+      }
+    });
+  }
+
   // flap a node
   void
   nodeFlap(const std::string& node) {
@@ -757,6 +787,45 @@ class DualBaseFixture : public ::testing::Test {
     return true;
   }
 
+  // Batched Node Failure Test
+  // bring n0 down and up with all of its link events delivered to n0 as a
+  // single batch, wait-and-validate after each
+  bool
+  batchedNodeFailureTest() {
+    VLOG(1) << "===> node (n0) batched down";
+    nodeEventsBatched("n0", false);
+
+    /* sleep override */
+    std::this_thread::sleep_for(syncms);
+    if (not validate()) {
+      LOG(ERROR) << "batched down node n0 validation failed";
+      return false;
+    }
+
+    VLOG(1) << "===> node (n0) batched up";
+    nodeEventsBatched("n0", true);
+
+    /* sleep override */
+    std::this_thread::sleep_for(syncms);
+    if (not validate()) {
+      LOG(ERROR) << "batched up node n0 validation failed";
+      return false;
+    }
+
+    // every root discovered by n0 went through both batches
+    thrift::DualCounters counters;
+    evb->runInEventBaseThreadAndWait(
+        [&]() { counters = nodes.at("n0")->getCounters(); });
+    for (const auto& [rootId, rootCounters] :
+         *counters.rootComputationCounters_ref()) {
+      if (*rootCounters.numPeerEventBatches_ref() < 2) {
+        LOG(ERROR) << "root " << rootId << " missed batched peer events";
+        return false;
+      }
+    }
+    return true;
+  }
+
   // Multiple Failure Test
   // randomly pick 20% links, capped between [2, 6]
   // bring them down/up and validate, same flap logic as above
@@ -940,6 +1009,7 @@ TEST_P(DualFixture, FabricTest) {
   EXPECT_TRUE(singleLinkFailureTest(flap));
   EXPECT_TRUE(singleNodeFailureTest(flap));
   EXPECT_TRUE(multiFailureTest(flap));
+  EXPECT_TRUE(batchedNodeFailureTest());
 }
 
 /**
@@ -975,6 +1045,7 @@ TEST_P(DualFixture, FullMeshTest) {
   EXPECT_TRUE(singleLinkFailureTest(flap));
   EXPECT_TRUE(singleNodeFailureTest(flap));
   EXPECT_TRUE(multiFailureTest(flap));
+  EXPECT_TRUE(batchedNodeFailureTest());
 }
 
 /**
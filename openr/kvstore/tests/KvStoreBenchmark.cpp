@@ -143,8 +143,11 @@ BM_KvStoreMergeKeyValues(
 
   uint64_t version = 1;
   for (uint32_t i = 0; i < iters; i++) {
-    std::unordered_map<std::string, thrift::Value> kvStore;
-    std::unordered_map<std::string, thrift::Value> update;
+    KvStoreMap kvStore;
+    std::optional<size_t> memBeforeInsert;
+    if (record) {
+      memBeforeInsert = sysMetrics.getRSSMemBytes();
+    }
     // Insert (key, value)s into kvStore
 
     for (uint32_t idx = 0; idx < numOfKeysInStore; idx++) {
@@ -162,20 +165,28 @@ BM_KvStoreMergeKeyValues(
           std::piecewise_construct,
           std::forward_as_tuple(key),
           std::forward_as_tuple(thriftValue));
+    }
 
-      if (idx < numOfUpdateKeys) {
-        auto updateThriftValue = createThriftValue(
-            version + 1, /* version */
-            "kvStore", /* node id */
-            value,
-            3600, /* ttl */
-            0 /* ttl version */,
-            0 /* hash */);
-        update.emplace(
-            std::piecewise_construct,
-            std::forward_as_tuple(key),
-            std::forward_as_tuple(updateThriftValue));
+    // RSS growth is measured before creating `update`, so it covers kvStore
+    // alone
+    if (record) {
+      auto rss = sysMetrics.getRSSMemBytes();
+      if (rss.has_value() and memBeforeInsert.has_value() and
+          rss.value() > memBeforeInsert.value()) {
+        counters["rss_per_key(B)"] =
+            (rss.value() - memBeforeInsert.value()) / numOfKeysInStore;
+      }
+    }
+
+    // Bump version of first numOfUpdateKeys keys of kvStore
+    std::unordered_map<std::string, thrift::Value> update;
+    for (auto const& [key, thriftValue] : kvStore) {
+      if (update.size() >= numOfUpdateKeys) {
+        break;
       }
+      auto updateThriftValue = thriftValue;
+      updateThriftValue.version_ref() = version + 1;
+      update.emplace(key, std::move(updateThriftValue));
     }
 
     if (record) {
@@ -241,6 +252,9 @@ BM_KvStoreDumpAll(
       if (mem.has_value()) {
         counters["memory_before_opertion(MB)"] = mem.value() / 1024 / 1024;
       }
+      // key-val bytes held by KvStoreDb per key
+      counters["key_vals_bytes_per_key(B)"] =
+          kvStore->getKeyValsBytes(kTestingAreaName) / numOfKeysInStore;
     }
 
     suspender.dismiss(); // Start measuring benchmark time
@@ -96,7 +96,7 @@ class KvStoreBenchmarkTestFixture {
 
   /*
    * Description:
-   * - Generate `numOfEntries` of keyVals and push corresponding queueEntry
+   * - Generate `numOfEntries` of keyVals and upsert corresponding queueEntry
    *   to TtlCountdownQueue
    * - Return a subset of keys that are kept in TtlCountdownQueue
    *
@@ -129,14 +129,15 @@ class KvStoreBenchmarkTestFixture {
       queueEntry.version = *keyValPair.second.version_ref();
       queueEntry.ttlVersion = *keyValPair.second.ttlVersion_ref();
       queueEntry.originatorId = *keyValPair.second.originatorId_ref();
-      ttlCountdownQueue.push(std::move(queueEntry));
+      ttlCountdownQueue.upsert(std::move(queueEntry));
     }
     return keyValsForReturn;
   }
 
   void
   checkThriftPublication(
-      uint32_t num, messaging::RQueue<KvStorePublication> kvStoreUpdatesQ) {
+      uint32_t num,
+      messaging::SharedRQueue<KvStorePublication> kvStoreUpdatesQ) {
     auto suspender = folly::BenchmarkSuspender();
     uint32_t total{0};
 
@@ -150,7 +151,8 @@ class KvStoreBenchmarkTestFixture {
 
       // stop measuring time as this is just parsing
       suspender.rehire();
-      if (auto* pub = std::get_if<thrift::Publication>(&(thriftPub.value()))) {
+      if (auto* pub =
+              std::get_if<thrift::Publication>(thriftPub.value().get())) {
         total += pub->keyVals_ref()->size();
       }
 
@@ -286,6 +286,23 @@ TEST_F(MultipleStoreFixture, dumpWithPrefixMultiple_differentKeys) {
     EXPECT_EQ("test_value2", dump["test_key2"].value_ref());
     EXPECT_EQ("test_value3", dump["test_key3"].value_ref());
   }
+
+  // one store at a time, values parsed in parallel
+  const auto [maybeSerial, unreachable] =
+      dumpAllWithPrefixMultipleAndParse<thrift::Value>(
+          kTestingAreaName,
+          sockAddrs_,
+          "test_",
+          Constants::kServiceConnTimeout,
+          Constants::kServiceProcTimeout,
+          nullptr /* sslContext */,
+          std::nullopt /* maybeIpTos */,
+          folly::AsyncSocket::anyAddress(),
+          1 /* maxConcurrency */,
+          2 /* numParseThreads */);
+  ASSERT_TRUE(maybeSerial.has_value());
+  EXPECT_TRUE(unreachable.empty());
+  EXPECT_EQ(maybe.value(), maybeSerial.value());
 }
 
 /**
@@ -633,6 +650,73 @@ TEST(KvStoreClientInternal, ApiTest) {
   openrEvbThread.join();
 }
 
+/**
+ * Set a batch of keys with both finite and infinite TTL through one setKeys
+ * call. Verify all of them land in KvStore and keys with finite TTL are kept
+ * alive by ttl refreshing well beyond their TTL.
+ */
+TEST(KvStoreClientInternal, SetKeysApiTest) {
+  fbzmq::Context context;
+  const std::string nodeId{"test_store"};
+
+  thrift::KvStoreConfig kvStoreConfig;
+  kvStoreConfig.node_name_ref() = nodeId;
+  const std::unordered_set<std::string> areaIds{kTestingAreaName};
+  auto store =
+      std::make_shared<KvStoreWrapper<thrift::OpenrCtrlCppAsyncClient>>(
+          context, areaIds, kvStoreConfig);
+  store->run();
+
+  std::unique_ptr<KvStoreClientInternal> client{nullptr};
+  OpenrEventBase openrEvb;
+  std::thread openrEvbThread([&]() { openrEvb.run(); });
+  openrEvb.waitUntilRunning();
+
+  const std::vector<std::pair<std::string, thrift::Value>> keyVals{
+      {"test_key1",
+       createThriftValue(
+           1, nodeId, std::string("test_value1"), Constants::kTtlInfinity)},
+      {"test_ttl_key2",
+       createThriftValue(1, nodeId, std::string("test_value2"), kTtl.count())},
+      {"test_ttl_key3",
+       createThriftValue(1, nodeId, std::string("test_value3"), kTtl.count())},
+  };
+
+  openrEvb.getEvb()->runInEventBaseThreadAndWait([&]() {
+    client = std::make_unique<KvStoreClientInternal>(
+        &openrEvb, nodeId, store->getKvStore());
+    EXPECT_TRUE(client->setKeys(kTestingAreaName, keyVals).has_value());
+  });
+
+  {
+    const auto keyValResponse = store->dumpAll(kTestingAreaName);
+    ASSERT_EQ(3, keyValResponse.size());
+    for (auto const& [key, thriftValue] : keyVals) {
+      ASSERT_EQ(1, keyValResponse.count(key));
+      EXPECT_EQ(thriftValue.value_ref(), keyValResponse.at(key).value_ref());
+    }
+  }
+
+  // keys shall not expire even after TTL bcoz client is updating their TTL
+  std::this_thread::sleep_for(kTtl * 3);
+  {
+    const auto keyValResponse = store->dumpAll(kTestingAreaName);
+    ASSERT_EQ(3, keyValResponse.size());
+    EXPECT_LT(0, *keyValResponse.at("test_ttl_key2").ttlVersion_ref());
+    EXPECT_LT(0, *keyValResponse.at("test_ttl_key3").ttlVersion_ref());
+  }
+
+  openrEvb.getEvb()->runInEventBaseThreadAndWait([&]() {
+    store->closeQueue();
+    client.reset();
+  });
+
+  store->stop();
+  openrEvb.stop();
+  openrEvb.waitUntilStopped();
+  openrEvbThread.join();
+}
+
 /*
  * Subscribing related API tests:
  *  1) SubscribeApi is for per-key callback subscribing API;
@@ -0,0 +1,406 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#include <fb303/ServiceData.h>
+#include <fbzmq/zmq/Zmq.h>
+#include <folly/Benchmark.h>
+#include <folly/Synchronized.h>
+#include <folly/init/Init.h>
+
+#include <openr/if/gen-cpp2/KvStoreServiceAsyncClient.h>
+#include <openr/if/gen-cpp2/KvStore_types.h>
+#include <openr/kvstore/KvStore.h>
+#include <openr/kvstore/KvStoreUtil.h>
+#include <openr/kvstore/KvStoreWrapper.h>
+#include <openr/tests/utils/Utils.h>
+
+#define BENCHMARK_COUNTERS_NAME_PARAM(name, counters, param_name, ...) \
+  BENCHMARK_IMPL_COUNTERS(                                             \
+      FB_CONCATENATE(name, FB_CONCATENATE(_, param_name)),             \
+      FOLLY_PP_STRINGIZE(name) "(" FOLLY_PP_STRINGIZE(param_name) ")", \
+      counters,                                                        \
+      iters,                                                           \
+      unsigned,                                                        \
+      iters) {                                                         \
+    name(counters, iters, ##__VA_ARGS__);                              \
+  }
+
+namespace {
+
+// The byte size of a value
+const int kSizeOfValue = 1024;
+
+// Number of key updates injected per iteration
+const uint32_t kNumOfUpdates = 1000;
+
+// Number of leaves per spine in Clos topology, i.e. 1 out of 5 nodes is spine
+const size_t kClosNodesPerSpine = 5;
+
+// Max time to wait for an update to reach all stores
+const std::chrono::seconds kConvergenceTimeout{30};
+
+} // namespace
+
+namespace openr {
+
+using KvStoreWrapperT = KvStoreWrapper<thrift::KvStoreServiceAsyncClient>;
+
+enum class Topology {
+  // every node peers with its two neighbors
+  RING,
+  // every node peers with its neighbors in square grid
+  GRID,
+  // every leaf peers with every spine
+  CLOS,
+};
+
+/**
+ * Pairs of node indexes peering with each other
+ */
+std::vector<std::pair<size_t, size_t>>
+getTopologyEdges(Topology topology, size_t numOfNodes) {
+  std::vector<std::pair<size_t, size_t>> edges;
+  switch (topology) {
+  case Topology::RING: {
+    for (size_t i = 0; i + 1 < numOfNodes; ++i) {
+      edges.emplace_back(i, i + 1);
+    }
+    if (numOfNodes > 2) {
+      edges.emplace_back(numOfNodes - 1, 0);
+    }
+    break;
+  }
+  case Topology::GRID: {
+    const size_t width = std::max<size_t>(1, std::sqrt(numOfNodes));
+    for (size_t i = 0; i < numOfNodes; ++i) {
+      if ((i + 1) % width and i + 1 < numOfNodes) {
+        edges.emplace_back(i, i + 1);
+      }
+      if (i + width < numOfNodes) {
+        edges.emplace_back(i, i + width);
+      }
+    }
+    break;
+  }
+  case Topology::CLOS: {
+    const size_t numOfSpines =
+        std::max<size_t>(1, numOfNodes / kClosNodesPerSpine);
+    for (size_t leaf = numOfSpines; leaf < numOfNodes; ++leaf) {
+      for (size_t spine = 0; spine < numOfSpines; ++spine) {
+        edges.emplace_back(leaf, spine);
+      }
+    }
+    break;
+  }
+  }
+  return edges;
+}
+
+/**
+ * Fixture of N in-process stores peering in given topology. Every store has a
+ * reader thread recording arrival time of each key published by it.
+ */
+class KvStoreFloodFixture {
+ public:
+  KvStoreFloodFixture(Topology topology, size_t numOfNodes) {
+    for (size_t i = 0; i < numOfNodes; ++i) {
+      thrift::KvStoreConfig kvStoreConfig;
+      kvStoreConfig.node_name_ref() = fmt::format("node-{}", i);
+      const std::unordered_set<std::string> areaIds{kTestingAreaName};
+      stores_.emplace_back(
+          std::make_unique<KvStoreWrapperT>(context_, areaIds, kvStoreConfig));
+      stores_.back()->run();
+      arrivals_.emplace_back(std::make_unique<ArrivalMap>());
+    }
+
+    for (auto const& [a, b] : getTopologyEdges(topology, numOfNodes)) {
+      stores_.at(a)->addPeer(
+          kTestingAreaName,
+          stores_.at(b)->getNodeId(),
+          stores_.at(b)->getPeerSpec());
+      stores_.at(b)->addPeer(
+          kTestingAreaName,
+          stores_.at(a)->getNodeId(),
+          stores_.at(a)->getPeerSpec());
+    }
+    waitForAllPeersInitialized();
+
+    for (size_t i = 0; i < numOfNodes; ++i) {
+      readers_.emplace_back(
+          [reader = stores_.at(i)->getReader(),
+           arrivals = arrivals_.at(i).get()]() mutable {
+            while (true) {
+              auto maybePub = reader.get();
+              if (maybePub.hasError()) {
+                break;
+              }
+              auto* pub =
+                  std::get_if<thrift::Publication>(maybePub.value().get());
+              if (not pub) {
+                continue;
+              }
+              const auto now = std::chrono::steady_clock::now();
+              arrivals->withWLock([&](auto& arrivals) {
+                for (auto const& [key, val] : *pub->keyVals_ref()) {
+                  if (val.value_ref().has_value()) {
+                    arrivals.try_emplace(key, now);
+                  }
+                }
+              });
+            }
+          });
+    }
+  }
+
+  ~KvStoreFloodFixture() {
+    for (auto& store : stores_) {
+      store->closeQueue();
+    }
+    for (auto& reader : readers_) {
+      reader.join();
+    }
+    for (auto& store : stores_) {
+      store->stop();
+    }
+  }
+
+  void
+  waitForAllPeersInitialized() const {
+    bool allInitialized = false;
+    while (not allInitialized) {
+      std::this_thread::yield();
+      allInitialized = true;
+      for (auto const& store : stores_) {
+        for (auto const& [_, spec] : store->getPeers(kTestingAreaName)) {
+          allInitialized &=
+              (*spec.state_ref() == thrift::KvStorePeerState::INITIALIZED);
+        }
+      }
+    }
+  }
+
+  // wait until every store received `numOfKeys` keys. False on timeout.
+  bool
+  waitForConvergence(size_t numOfKeys) const {
+    const auto start = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - start < kConvergenceTimeout) {
+      bool converged = true;
+      for (auto const& arrivals : arrivals_) {
+        converged &= (arrivals->rlock()->size() >= numOfKeys);
+      }
+      if (converged) {
+        return true;
+      }
+      std::this_thread::yield();
+    }
+    return false;
+  }
+
+  // time at which key reached the last store. Unset if it never did.
+  std::optional<std::chrono::steady_clock::time_point>
+  getConvergenceTime(std::string const& key) const {
+    std::optional<std::chrono::steady_clock::time_point> lastArrival;
+    for (auto const& arrivals : arrivals_) {
+      auto locked = arrivals->rlock();
+      auto it = locked->find(key);
+      if (it == locked->end()) {
+        return std::nullopt;
+      }
+      lastArrival = std::max(lastArrival.value_or(it->second), it->second);
+    }
+    return lastArrival;
+  }
+
+  using ArrivalMap = folly::Synchronized<
+      std::unordered_map<std::string, std::chrono::steady_clock::time_point>>;
+
+  fbzmq::Context context_;
+  std::vector<std::unique_ptr<KvStoreWrapperT>> stores_;
+  std::vector<std::unique_ptr<ArrivalMap>> arrivals_;
+  std::vector<std::thread> readers_;
+};
+
+// user + system CPU time consumed by this process
+std::chrono::microseconds
+getProcessCpuTime() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  const auto sec = usage.ru_utime.tv_sec + usage.ru_stime.tv_sec;
+  const auto usec = usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+  return std::chrono::seconds(sec) + std::chrono::microseconds(usec);
+}
+
+int64_t
+getPercentile(std::vector<int64_t> const& sortedValues, size_t percentile) {
+  if (sortedValues.empty()) {
+    return 0;
+  }
+  return sortedValues.at(std::min(
+      sortedValues.size() - 1, sortedValues.size() * percentile / 100));
+}
+
+/**
+ * Benchmark for flooding convergence in multi-store topology
+ * 1. Start `numOfNodes` stores peering in `topology` and wait for full-sync
+ * 2. Inject key updates at `updatesPerSec` rate, round-robin across stores
+ * 3. Wait until every update reaches every store
+ *
+ * Reports propagation latency percentiles (time for update to reach the last
+ * store), duplicate flood ratio (flooded publications merging nothing) and
+ * CPU time per update.
+ */
+static void
+BM_KvStoreFloodConvergence(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    Topology topology,
+    size_t numOfNodes,
+    uint32_t updatesPerSec) {
+  auto suspender = folly::BenchmarkSuspender();
+  const auto interval = std::chrono::duration_cast<std::chrono::microseconds>(
+                            std::chrono::seconds(1)) /
+      updatesPerSec;
+
+  for (uint32_t i = 0; i < iters; i++) {
+    auto fixture = std::make_unique<KvStoreFloodFixture>(topology, numOfNodes);
+
+    // Generate random key-vals beforehand for updating
+    std::vector<std::pair<std::string, thrift::Value>> keyVals;
+    keyVals.reserve(kNumOfUpdates);
+    for (uint32_t idx = 0; idx < kNumOfUpdates; idx++) {
+      const auto& store = fixture->stores_.at(idx % numOfNodes);
+      auto thriftVal = createThriftValue(
+          1 /* version */,
+          store->getNodeId() /* originatorId */,
+          genRandomStr(kSizeOfValue) /* value */);
+      thriftVal.hash_ref() = generateHash(
+          *thriftVal.version_ref(),
+          *thriftVal.originatorId_ref(),
+          thriftVal.value_ref());
+      keyVals.emplace_back(fmt::format("key-{}", idx), std::move(thriftVal));
+    }
+    std::vector<std::chrono::steady_clock::time_point> injectTimes;
+    injectTimes.reserve(kNumOfUpdates);
+
+    fb303::fbData->resetAllData();
+    const auto cpuTimeBefore = getProcessCpuTime();
+
+    suspender.dismiss(); // Start measuring benchmark time
+
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t idx = 0; idx < kNumOfUpdates; idx++) {
+      std::this_thread::sleep_until(start + interval * idx);
+      injectTimes.emplace_back(std::chrono::steady_clock::now());
+      fixture->stores_.at(idx % numOfNodes)
+          ->setKey(kTestingAreaName, keyVals[idx].first, keyVals[idx].second);
+    }
+    const bool converged = fixture->waitForConvergence(kNumOfUpdates);
+
+    suspender.rehire(); // Stop measuring benchmark time
+
+    const auto cpuTime = getProcessCpuTime() - cpuTimeBefore;
+    if (not converged) {
+      LOG(ERROR) << "Flooding did not converge within "
+                 << kConvergenceTimeout.count() << "s";
+    }
+
+    std::vector<int64_t> latencies;
+    latencies.reserve(kNumOfUpdates);
+    for (uint32_t idx = 0; idx < kNumOfUpdates; idx++) {
+      auto convergenceTime = fixture->getConvergenceTime(keyVals[idx].first);
+      if (not convergenceTime.has_value()) {
+        continue;
+      }
+      latencies.emplace_back(
+          std::chrono::duration_cast<std::chrono::microseconds>(
+              *convergenceTime - injectTimes[idx])
+              .count());
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    auto fbCounters = fb303::fbData->getCounters();
+    const auto numFloodPubs = fbCounters["kvstore.thrift.num_flood_pub.count"];
+    const auto numRedundantPubs =
+        fbCounters["kvstore.received_redundant_publications.count"];
+
+    counters["latency_p50(us)"] = getPercentile(latencies, 50);
+    counters["latency_p90(us)"] = getPercentile(latencies, 90);
+    counters["latency_p99(us)"] = getPercentile(latencies, 99);
+    counters["num_unconverged_updates"] = kNumOfUpdates - latencies.size();
+    counters["duplicate_flood_ratio(permille)"] =
+        numFloodPubs ? numRedundantPubs * 1000 / numFloodPubs : 0;
+    counters["cpu_per_update(us)"] = cpuTime.count() / kNumOfUpdates;
+
+    fixture.reset();
+  }
+}
+
+// Parameters are topology, number of stores and injected updates per second
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_KvStoreFloodConvergence,
+    counters,
+    ring_16_1000,
+    Topology::RING,
+    16,
+    1000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_KvStoreFloodConvergence,
+    counters,
+    ring_32_1000,
+    Topology::RING,
+    32,
+    1000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_KvStoreFloodConvergence,
+    counters,
+    grid_16_1000,
+    Topology::GRID,
+    16,
+    1000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_KvStoreFloodConvergence,
+    counters,
+    grid_64_1000,
+    Topology::GRID,
+    64,
+    1000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_KvStoreFloodConvergence,
+    counters,
+    clos_20_1000,
+    Topology::CLOS,
+    20,
+    1000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_KvStoreFloodConvergence,
+    counters,
+    clos_40_1000,
+    Topology::CLOS,
+    40,
+    1000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_KvStoreFloodConvergence,
+    counters,
+    clos_40_10000,
+    Topology::CLOS,
+    40,
+    10000);
+
+} // namespace openr
+
+int
+main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
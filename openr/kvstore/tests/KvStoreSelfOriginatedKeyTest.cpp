@@ -121,6 +121,46 @@ TEST_F(KvStoreSelfOriginatedKeyValueRequestFixture, ProcessSetKeyValueRequest) {
   evb.waitUntilStopped();
 }
 
+/**
+ * Validate ttl refreshes of keys set shortly one after another are coalesced
+ * into one publication.
+ */
+TEST_F(KvStoreSelfOriginatedKeyValueRequestFixture, TtlRefreshBatching) {
+  const std::string nodeId = "node-ttl-batch";
+  initKvStore(nodeId, kShortTtl);
+
+  const std::string key1 = "key1";
+  const std::string key2 = "key2";
+
+  OpenrEventBase evb;
+  evb.scheduleTimeout(std::chrono::milliseconds(0), [&]() noexcept {
+    kvRequestQueue_.push(SetKeyValueRequest(kTestingAreaName, key1, "value1"));
+    auto pub = kvStore_->recvPublication();
+    EXPECT_EQ(1, pub.keyVals_ref()->count(key1));
+  });
+
+  // set key2 within the same batch window(kShortTtl / 16) as key1
+  evb.scheduleTimeout(std::chrono::milliseconds(50), [&]() noexcept {
+    kvRequestQueue_.push(SetKeyValueRequest(kTestingAreaName, key2, "value2"));
+    auto pub = kvStore_->recvPublication();
+    EXPECT_EQ(1, pub.keyVals_ref()->count(key2));
+
+    // ttl refreshes of both keys are advertised in one publication
+    auto ttlPub = kvStore_->recvPublication();
+    EXPECT_EQ(2, ttlPub.keyVals_ref()->size());
+    for (auto const& key : {key1, key2}) {
+      ASSERT_EQ(1, ttlPub.keyVals_ref()->count(key));
+      EXPECT_EQ(1, *ttlPub.keyVals_ref()->at(key).ttlVersion_ref());
+      EXPECT_FALSE(ttlPub.keyVals_ref()->at(key).value_ref().has_value());
+    }
+    evb.stop();
+  });
+
+  // Start the event loop and wait until it is finished execution.
+  evb.run();
+  evb.waitUntilStopped();
+}
+
 /**
  * Validate versioning for receiving multiple SetKeyValueRequests.
  */
@@ -723,6 +763,41 @@ TEST_F(KvStoreSelfOriginatedKeyValueRequestFixture, UnsetKeyValue) {
   evb.waitUntilStopped();
 }
 
+/**
+ * Validate BatchKeyValueRequest processing. Keys persisted by one batch are
+ * flooded together, and requests of a batch are applied in order.
+ */
+TEST_F(
+    KvStoreSelfOriginatedKeyValueRequestFixture, ProcessBatchKeyValueRequest) {
+  const std::string nodeId = "node-batch";
+  initKvStore(nodeId);
+
+  // Persist 3 keys in one batch
+  BatchKeyValueRequest persistBatch(kTestingAreaName);
+  for (int i = 0; i < 3; ++i) {
+    persistBatch.addRequest(PersistKeyValueRequest(
+        kTestingAreaName, fmt::format("key{}", i), "value"));
+  }
+  kvRequestQueue_.push(std::move(persistBatch));
+
+  auto pub = kvStore_->recvPublication();
+  EXPECT_EQ(3, pub.keyVals_ref()->size());
+  EXPECT_EQ(3, kvStore_->dumpAllSelfOriginated(kTestingAreaName).size());
+
+  // Persist and then unset the same key in one batch, unset must win
+  BatchKeyValueRequest unsetBatch(kTestingAreaName);
+  unsetBatch.addRequest(
+      PersistKeyValueRequest(kTestingAreaName, "key0", "new-value"));
+  unsetBatch.addRequest(
+      ClearKeyValueRequest(kTestingAreaName, "key0", "deleted", true));
+  kvRequestQueue_.push(std::move(unsetBatch));
+
+  auto unsetPub = kvStore_->recvPublication();
+  EXPECT_EQ(1, unsetPub.keyVals_ref()->size());
+  EXPECT_EQ("deleted", *unsetPub.keyVals_ref()->at("key0").value_ref());
+  EXPECT_EQ(2, kvStore_->dumpAllSelfOriginated(kTestingAreaName).size());
+}
+
 /**
  * Validate throttling that batches together requests to persist and unset keys
  * to avoid unnecessary changes to the KvStore's key-vals. Verify that
@@ -7,6 +7,8 @@
 
 #include <fb303/ServiceData.h>
 #include <fbzmq/zmq/Zmq.h>
+#include <folly/MapUtil.h>
+#include <folly/experimental/TestUtil.h>
 #include <folly/init/Init.h>
 #include <gtest/gtest.h>
 #include <thrift/lib/cpp2/protocol/Serializer.h>
@@ -37,7 +39,6 @@ thrift::KvStoreConfig
 getTestKvConf(std::string nodeId) {
   thrift::KvStoreConfig kvConf;
   kvConf.node_name_ref() = nodeId;
-  kvConf.enable_thrift_dual_msg_ref() = false;
   return kvConf;
 }
 
@@ -380,6 +381,108 @@ TEST_F(KvStoreTestFixture, BasicSetKey) {
   kvStore->stop();
 }
 
+/**
+ * Dump hashes repeatedly from a single store. Verify unchanged area is served
+ * from cache and cache is invalidated by key update.
+ */
+TEST_F(KvStoreTestFixture, DumpHashesCache) {
+  fb303::fbData->resetAllData();
+
+  auto kvStore = createKvStore(getTestKvConf("node1"));
+  kvStore->run();
+
+  kvStore->setKey(
+      kTestingAreaName,
+      "key1",
+      createThriftValue(1, "node1", std::string("value1")));
+
+  auto dumpHashes = [&]() {
+    thrift::KeyDumpParams params;
+    params.prefix_ref() = "";
+    return *kvStore->getKvStore()
+                ->semifuture_dumpKvStoreHashes(kTestingAreaName, params)
+                .get();
+  };
+
+  const auto pub1 = dumpHashes();
+  const auto pub2 = dumpHashes();
+  EXPECT_EQ(1, pub1.keyVals_ref()->size());
+  EXPECT_EQ(*pub1.keyVals_ref(), *pub2.keyVals_ref());
+  EXPECT_FALSE(pub2.keyVals_ref()->at("key1").value_ref().has_value());
+
+  auto counters = fb303::fbData->getCounters();
+  EXPECT_EQ(1, counters.at("kvstore.hash_dump_cache.num_hits.count"));
+  EXPECT_EQ(1, counters.at("kvstore.hash_dump_cache.num_misses.count"));
+
+  // key update invalidates cached dump
+  kvStore->setKey(
+      kTestingAreaName,
+      "key2",
+      createThriftValue(1, "node1", std::string("value2")));
+  const auto pub3 = dumpHashes();
+  EXPECT_EQ(2, pub3.keyVals_ref()->size());
+
+  counters = fb303::fbData->getCounters();
+  EXPECT_EQ(1, counters.at("kvstore.hash_dump_cache.num_hits.count"));
+  EXPECT_EQ(2, counters.at("kvstore.hash_dump_cache.num_misses.count"));
+
+  kvStore->stop();
+}
+
+/**
+ * Set keys of different families, update and flood some of them. Verify
+ * memory and churn accounting of each family.
+ */
+TEST_F(KvStoreTestFixture, KeyFamilyStats) {
+  auto kvStore = createKvStore(getTestKvConf("node1"));
+  kvStore->run();
+
+  kvStore->setKey(
+      kTestingAreaName,
+      "adj:node1",
+      createThriftValue(1, "node1", std::string("value1")));
+  kvStore->setKey(
+      kTestingAreaName,
+      "adj:node2",
+      createThriftValue(1, "node2", std::string("value2")));
+  kvStore->setKey(
+      kTestingAreaName,
+      "prefix:node1",
+      createThriftValue(1, "node1", std::string("value1")));
+  // update replaces bytes of previous value
+  kvStore->setKey(
+      kTestingAreaName,
+      "adj:node2",
+      createThriftValue(2, "node2", std::string("value2-updated")));
+
+  auto stats = *kvStore->getKvStore()
+                    ->semifuture_getKvStoreKeyFamilyStats(kTestingAreaName)
+                    .get();
+  ASSERT_EQ(2, stats.size());
+
+  auto const& adjStats = stats.at("adj");
+  EXPECT_EQ(2, *adjStats.numKeys_ref());
+  EXPECT_EQ((9 + 5 + 6) + (9 + 5 + 14), *adjStats.numBytes_ref());
+  EXPECT_EQ(3, *adjStats.numUpdates_ref());
+
+  auto const& prefixStats = stats.at("prefix");
+  EXPECT_EQ(1, *prefixStats.numKeys_ref());
+  EXPECT_EQ(12 + 5 + 6, *prefixStats.numBytes_ref());
+  EXPECT_EQ(1, *prefixStats.numUpdates_ref());
+
+  // no peer to flood to
+  EXPECT_EQ(0, *adjStats.numFloodBytes_ref());
+
+  // unknown area
+  EXPECT_THROW(
+      kvStore->getKvStore()
+          ->semifuture_getKvStoreKeyFamilyStats("unknown_area")
+          .get(),
+      thrift::KvStoreError);
+
+  kvStore->stop();
+}
+
 //
 // Test counter reporting
 //
@@ -447,9 +550,9 @@ TEST_F(KvStoreTestFixture, CounterReport) {
   ASSERT_TRUE(
       counters.count("kvstore.received_publications." + area + ".count"));
   ASSERT_TRUE(counters.count("kvstore.num_flood_peers"));
-  ASSERT_TRUE(counters.count("kvstore.num_flood_peers." + area + ".sum"));
+  ASSERT_TRUE(counters.count("kvstore.num_flood_peers." + area));
   ASSERT_TRUE(counters.count("kvstore.num_expiring_keys"));
-  ASSERT_TRUE(counters.count("kvstore.num_expiring_keys." + area + ".sum"));
+  ASSERT_TRUE(counters.count("kvstore.num_expiring_keys." + area));
 
   // Verify the value of counter keys
   EXPECT_EQ(0, counters.at("kvstore.num_peers"));
@@ -470,9 +573,9 @@ TEST_F(KvStoreTestFixture, CounterReport) {
   EXPECT_EQ(0, counters.at("kvstore.cmd_key_dump.count"));
   EXPECT_EQ(0, counters.at("kvstore.cmd_key_get.count"));
   EXPECT_EQ(0, counters.at("kvstore.num_flood_peers"));
-  EXPECT_EQ(0, counters.at("kvstore.num_flood_peers." + area + ".sum"));
+  EXPECT_EQ(0, counters.at("kvstore.num_flood_peers." + area));
   EXPECT_EQ(0, counters.at("kvstore.num_expiring_keys"));
-  EXPECT_EQ(0, counters.at("kvstore.num_expiring_keys." + area + ".sum"));
+  EXPECT_EQ(0, counters.at("kvstore.num_expiring_keys." + area));
 
   // Verify four keys were set
   ASSERT_EQ(1, counters.count("kvstore.cmd_key_set.count"));
@@ -2273,10 +2376,127 @@ TEST_F(KvStoreTestFixture, DumpDifference) {
   }
 }
 
+/*
+ * Set burst of updates on store with flood batching. Verify updates are merged
+ * into batches by key and peer ends up with latest version of every key.
+ */
+TEST_F(KvStoreTestFixture, FloodBatching) {
+  fb303::fbData->resetAllData();
+
+  auto store0Conf = getTestKvConf("store0");
+  thrift::KvStoreFloodBatch floodBatch;
+  floodBatch.min_window_ms_ref() = 50;
+  floodBatch.max_window_ms_ref() = 100;
+  store0Conf.flood_batch_ref() = floodBatch;
+
+  auto store0 = createKvStore(store0Conf);
+  auto store1 = createKvStore(getTestKvConf("store1"));
+  store0->run();
+  store1->run();
+
+  store0->addPeer(kTestingAreaName, store1->getNodeId(), store1->getPeerSpec());
+  store1->addPeer(kTestingAreaName, store0->getNodeId(), store0->getPeerSpec());
+  waitForAllPeersInitialized();
+
+  // burst of updates, each key updated several times
+  const int kNumKeys = 10;
+  const int kNumVersions = 5;
+  for (int version = 1; version <= kNumVersions; ++version) {
+    for (int i = 0; i < kNumKeys; ++i) {
+      store0->setKey(
+          kTestingAreaName,
+          fmt::format("key{}", i),
+          createThriftValue(
+              version, "store0", fmt::format("value{}-{}", i, version)));
+    }
+  }
+
+  // peer eventually receives latest version of every key
+  auto getVersion = [&](std::string const& key) -> int64_t {
+    auto val = store1->getKey(kTestingAreaName, key);
+    return val.has_value() ? *val->version_ref() : 0;
+  };
+  for (int i = 0; i < kNumKeys; ++i) {
+    const auto key = fmt::format("key{}", i);
+    auto const start = std::chrono::steady_clock::now();
+    while (getVersion(key) != kNumVersions &&
+           (std::chrono::steady_clock::now() - start <
+            kTimeoutOfKvStorePropagation)) {
+      std::this_thread::yield();
+    }
+    EXPECT_EQ(kNumVersions, getVersion(key));
+  }
+
+  auto counters = fb303::fbData->getCounters();
+  ASSERT_TRUE(counters.count("kvstore.flood_batch.num_keys.avg"));
+  ASSERT_TRUE(counters.count("kvstore.flood_batch.window_ms.avg"));
+  EXPECT_LE(50, counters.at("kvstore.flood_batch.window_ms.avg"));
+  EXPECT_GE(100, counters.at("kvstore.flood_batch.window_ms.avg"));
+}
+
 /*
  * check key value is decremented with the TTL decrement value provided,
  * and is not synced if remaining TTL is < TTL decrement value provided
  */
+/**
+ * Verify that flood peers and expiring adj keys are reported upon changes of
+ * peers and key-vals, without waiting for any periodic check.
+ */
+TEST_F(KvStoreTestFixture, EventDrivenMonitoring) {
+  const std::string& area = kTestingAreaName;
+  const auto kvConf = getTestKvConf("node1");
+  const int64_t keyTtl = *kvConf.key_ttl_ms_ref();
+  auto kvStore = createKvStore(kvConf);
+  kvStore->run();
+
+  auto waitForCounter = [](std::string const& name, int64_t expected) {
+    auto const start = std::chrono::steady_clock::now();
+    while (fb303::fbData->getCounter(name) != expected and
+           std::chrono::steady_clock::now() - start <
+               kTimeoutOfKvStorePropagation) {
+      std::this_thread::yield();
+    }
+    EXPECT_EQ(expected, fb303::fbData->getCounter(name));
+  };
+  auto createAdjValue = [&](int64_t ttl, int64_t ttlVersion) {
+    auto value = createThriftValue(
+        1 /* version */,
+        "node2" /* originatorId */,
+        std::string("adj") /* value */,
+        ttl /* ttl */,
+        ttlVersion /* ttl version */);
+    value.hash_ref() = generateHash(
+        *value.version_ref(), *value.originatorId_ref(), value.value_ref());
+    return value;
+  };
+
+  // Unreachable peer, flooded to as flood optimization is off
+  EXPECT_TRUE(kvStore->addPeer(
+      kTestingAreaName, "node2", createPeerSpec("", "::1", 1)));
+  waitForCounter("kvstore.num_flood_peers." + area, 1);
+
+  // Adj key of a peer merged under half of key ttl is expiring, other keys
+  // are not considered
+  EXPECT_TRUE(kvStore->setKey(
+      kTestingAreaName, "adj:node2", createAdjValue(keyTtl / 4, 1)));
+  EXPECT_TRUE(kvStore->setKey(
+      kTestingAreaName, "prefix:node2", createAdjValue(keyTtl / 4, 1)));
+  waitForCounter("kvstore.num_expiring_keys." + area, 1);
+
+  // Refreshed ttl clears it
+  EXPECT_TRUE(kvStore->setKey(
+      kTestingAreaName, "adj:node2", createAdjValue(keyTtl, 2)));
+  waitForCounter("kvstore.num_expiring_keys." + area, 0);
+
+  // Originator is no longer a peer
+  EXPECT_TRUE(kvStore->setKey(
+      kTestingAreaName, "adj:node2", createAdjValue(keyTtl / 4, 3)));
+  waitForCounter("kvstore.num_expiring_keys." + area, 1);
+  EXPECT_TRUE(kvStore->delPeer(kTestingAreaName, "node2"));
+  waitForCounter("kvstore.num_expiring_keys." + area, 0);
+  waitForCounter("kvstore.num_flood_peers." + area, 0);
+}
+
 TEST_F(KvStoreTestFixture, TtlDecrementValue) {
   auto store1Conf = getTestKvConf("store1");
   store1Conf.ttl_decrement_ms_ref() = 300;
@@ -2611,6 +2831,61 @@ TEST_F(KvStoreTestFixture, RateLimiter) {
   EXPECT_GE(s1Supressed4 - s1Supressed3, 1);
 }
 
+/**
+ * Verify adjacency keys are flooded in high priority class, i.e. they are NOT
+ * held back by buffered bulk prefix keys when flooding is rate limited.
+ */
+TEST_F(KvStoreTestFixture, RateLimiterFloodPriority) {
+  fb303::fbData->resetAllData();
+
+  auto rateLimitConf = getTestKvConf("store1");
+  rateLimitConf.flood_rate_ref() = createKvStoreFloodRate(
+      1 /*flood_msg_per_sec*/, 1 /*flood_msg_burst_size*/);
+
+  auto store0 = createKvStore(getTestKvConf("store0"));
+  auto store1 = createKvStore(rateLimitConf);
+  store0->run();
+  store1->run();
+
+  store0->addPeer(kTestingAreaName, store1->getNodeId(), store1->getPeerSpec());
+  store1->addPeer(kTestingAreaName, store0->getNodeId(), store0->getPeerSpec());
+
+  // wait for initial sync, so that keys are flooded instead of synced
+  auto const start = std::chrono::steady_clock::now();
+  while (store1->getPeerState(kTestingAreaName, store0->getNodeId()) !=
+             thrift::KvStorePeerState::INITIALIZED and
+         std::chrono::steady_clock::now() - start <
+             kTimeoutOfKvStorePropagation) {
+    std::this_thread::yield();
+  }
+
+  // exhaust tokens of normal priority class with bulk prefix keys
+  const size_t numPrefixKeys{20};
+  for (size_t i = 0; i < numPrefixKeys; ++i) {
+    EXPECT_TRUE(store1->setKey(
+        kTestingAreaName,
+        fmt::format("prefix:node{}", i),
+        createThriftValue(1, "store1", "value")));
+  }
+
+  // adjacency key bypasses buffered prefix keys
+  EXPECT_TRUE(store1->setKey(
+      kTestingAreaName, "adj:node1", createThriftValue(1, "store1", "value")));
+  waitForKeyInStoreWithTimeout(store0, kTestingAreaName, "adj:node1");
+  EXPECT_GT(numPrefixKeys + 1, store0->dumpAll(kTestingAreaName).size());
+
+  // buffered prefix keys are eventually flooded
+  /* sleep override */
+  std::this_thread::sleep_for(std::chrono::seconds(2));
+  EXPECT_EQ(numPrefixKeys + 1, store0->dumpAll(kTestingAreaName).size());
+
+  auto counters = fb303::fbData->getCounters();
+  EXPECT_LE(
+      1, counters["kvstore.flood_priority.normal.rate_limit_suppress.count"]);
+  EXPECT_EQ(
+      0, counters["kvstore.flood_priority.high.rate_limit_suppress.count"]);
+}
+
 /**
  * this is to verify correctness of 3-way full-sync
  * tuple represents (key, value-version, value)
@@ -2724,6 +2999,163 @@ TEST_F(KvStoreTestFixture, FullSync) {
   evbThread.join();
 }
 
+/**
+ * Verify 3-way full-sync in chunks. storeA requests full-sync from storeB in
+ * chunks of 3 keys, compressed on the wire. Key spaces of storeA and storeB
+ * interleave, so that every chunk carries key-vals in both directions.
+ */
+TEST_F(KvStoreTestFixture, FullSyncChunked) {
+  auto confA = getTestKvConf("storeA");
+  confA.full_sync_chunk_size_ref() = 3;
+  confA.enable_full_sync_compression_ref() = true;
+  auto storeA = createKvStore(confA);
+  auto storeB = createKvStore(getTestKvConf("storeB"));
+  storeA->run();
+  storeB->run();
+
+  // storeA has key00..key19 with version 1 and storeB has key10..key29 with
+  // version 2. After sync both should have key00..key09 from storeA and
+  // key10..key29 from storeB.
+  for (int i = 0; i < 30; ++i) {
+    const auto key = fmt::format("key{:02}", i);
+    if (i < 20) {
+      EXPECT_TRUE(storeA->setKey(
+          kTestingAreaName, key, createThriftValue(1, "storeA", "a")));
+    }
+    if (i >= 10) {
+      EXPECT_TRUE(storeB->setKey(
+          kTestingAreaName, key, createThriftValue(2, "storeB", "b")));
+    }
+  }
+
+  storeA->addPeer(kTestingAreaName, "storeB", storeB->getPeerSpec());
+
+  // peer stays in SYNCING state until the last chunk is received
+  auto const start = std::chrono::steady_clock::now();
+  while (storeA->getPeerState(kTestingAreaName, "storeB") !=
+             thrift::KvStorePeerState::INITIALIZED and
+         std::chrono::steady_clock::now() - start <
+             kTimeoutOfKvStorePropagation) {
+    std::this_thread::yield();
+  }
+  EXPECT_EQ(
+      thrift::KvStorePeerState::INITIALIZED,
+      storeA->getPeerState(kTestingAreaName, "storeB"));
+
+  for (int i = 0; i < 30; ++i) {
+    const auto key = fmt::format("key{:02}", i);
+    waitForKeyInStoreWithTimeout(storeA, kTestingAreaName, key);
+    waitForKeyInStoreWithTimeout(storeB, kTestingAreaName, key);
+    auto valA = storeA->getKey(kTestingAreaName, key);
+    auto valB = storeB->getKey(kTestingAreaName, key);
+    EXPECT_EQ(i < 10 ? 1 : 2, *valA->version_ref());
+    EXPECT_EQ(*valA->version_ref(), *valB->version_ref());
+    EXPECT_EQ(valA->value_ref().value(), valB->value_ref().value());
+  }
+}
+
+/**
+ * [Key Sharding]
+ * Verify key-vals of large publications are merged into shards of storeA
+ * concurrently, and storeA serves full-sync of its sharded key-vals to
+ * storeB as usual. Updates from storeB are flooded back into storeA.
+ */
+TEST_F(KvStoreTestFixture, ShardedKeyMerge) {
+  auto confA = getTestKvConf("storeA");
+  confA.num_key_shards_ref() = 4;
+  auto storeA = createKvStore(confA);
+  auto storeB = createKvStore(getTestKvConf("storeB"));
+  storeA->run();
+  storeB->run();
+
+  auto getNumMerges = []() {
+    return folly::get_default(
+        fb303::fbData->getCounters(), "kvstore.sharded_merges.count", 0);
+  };
+  const auto numMerges = getNumMerges();
+  std::vector<std::pair<std::string, thrift::Value>> keyVals;
+  for (size_t i = 0; i < Constants::kKvStoreShardedMergeMinKeys * 4; ++i) {
+    keyVals.emplace_back(
+        fmt::format("key{}", i), createThriftValue(1, "storeA", "a"));
+  }
+  EXPECT_TRUE(storeA->setKeys(kTestingAreaName, keyVals));
+  EXPECT_EQ(numMerges + 1, getNumMerges());
+  EXPECT_EQ(keyVals.size(), storeA->dumpAll(kTestingAreaName).size());
+
+  // full-sync of all key-vals
+  storeB->addPeer(kTestingAreaName, "storeA", storeA->getPeerSpec());
+  storeA->addPeer(kTestingAreaName, "storeB", storeB->getPeerSpec());
+  for (auto const& [key, _] : keyVals) {
+    waitForKeyInStoreWithTimeout(storeB, kTestingAreaName, key);
+  }
+  EXPECT_EQ(
+      storeA->dumpAll(kTestingAreaName), storeB->dumpAll(kTestingAreaName));
+
+  // newer version from storeB wins in storeA
+  EXPECT_TRUE(storeB->setKey(
+      kTestingAreaName, "key0", createThriftValue(2, "storeB", "b")));
+  auto const start = std::chrono::steady_clock::now();
+  while (*storeA->getKey(kTestingAreaName, "key0")->version_ref() != 2 and
+         std::chrono::steady_clock::now() - start <
+             kTimeoutOfKvStorePropagation) {
+    std::this_thread::yield();
+  }
+  EXPECT_EQ(2, *storeA->getKey(kTestingAreaName, "key0")->version_ref());
+  EXPECT_EQ(keyVals.size(), storeA->dumpAll(kTestingAreaName).size());
+}
+
+/**
+ * Verify KvStore is warmed up from snapshot persisted before restart, and
+ * snapshot keys are reconciled with peers during initial full-sync:
+ *  - key1 is identical on peer, hence kept;
+ *  - key2 is gone from peer, hence purged and NOT pushed to peer;
+ *  - key3 is self-originated, hence NOT persisted;
+ */
+TEST_F(KvStoreTestFixture, WarmRestartSnapshot) {
+  folly::test::TemporaryDirectory tmpDir;
+  auto confA = getTestKvConf("storeA");
+  confA.warm_restart_snapshot_dir_ref() = tmpDir.path().string();
+
+  auto storeA = createKvStore(confA);
+  storeA->run();
+  EXPECT_TRUE(storeA->setKey(
+      kTestingAreaName, "key1", createThriftValue(1, "storeB", "value1")));
+  EXPECT_TRUE(storeA->setKey(
+      kTestingAreaName, "key2", createThriftValue(1, "storeB", "value2")));
+  EXPECT_TRUE(storeA->setKey(
+      kTestingAreaName, "key3", createThriftValue(1, "storeA", "value3")));
+  // snapshot is persisted on stop
+  storeA->stop();
+
+  auto storeB = createKvStore(getTestKvConf("storeB"));
+  storeB->run();
+  EXPECT_TRUE(storeB->setKey(
+      kTestingAreaName, "key1", createThriftValue(1, "storeB", "value1")));
+
+  // restart storeA, snapshot keys are available before any sync
+  auto restartedStoreA = createKvStore(confA);
+  restartedStoreA->run();
+  waitForKeyInStoreWithTimeout(restartedStoreA, kTestingAreaName, "key1");
+  waitForKeyInStoreWithTimeout(restartedStoreA, kTestingAreaName, "key2");
+  EXPECT_FALSE(restartedStoreA->getKey(kTestingAreaName, "key3").has_value());
+
+  restartedStoreA->addPeer(kTestingAreaName, "storeB", storeB->getPeerSpec());
+  auto const start = std::chrono::steady_clock::now();
+  while (restartedStoreA->getPeerState(kTestingAreaName, "storeB") !=
+             thrift::KvStorePeerState::INITIALIZED and
+         std::chrono::steady_clock::now() - start <
+             kTimeoutOfKvStorePropagation) {
+    std::this_thread::yield();
+  }
+  EXPECT_EQ(
+      thrift::KvStorePeerState::INITIALIZED,
+      restartedStoreA->getPeerState(kTestingAreaName, "storeB"));
+
+  EXPECT_TRUE(restartedStoreA->getKey(kTestingAreaName, "key1").has_value());
+  EXPECT_FALSE(restartedStoreA->getKey(kTestingAreaName, "key2").has_value());
+  EXPECT_FALSE(storeB->getKey(kTestingAreaName, "key2").has_value());
+}
+
 /*
  * Verify kvStore flooding is containted within an area.
  * Add a key in one area and verify that key is not flooded into the other.
@@ -2962,6 +3394,80 @@ TEST_F(KvStoreTestFixture, KeySyncMultipleArea) {
   }
 }
 
+/**
+ * Verify KvStore with dedicated event base per area. storeB spans two areas,
+ * each served by its own thread. Keys must be synced within each area, and
+ * cross-area APIs must gather results from all areas.
+ */
+TEST_F(KvStoreTestFixture, KeySyncMultipleAreaEventBases) {
+  const std::string podArea{"pod-area"};
+  const std::string planeArea{"plane-area"};
+  const AreaId podAreaId{podArea};
+  const AreaId planeAreaId{planeArea};
+
+  auto confB = getTestKvConf("storeB");
+  confB.enable_area_event_bases_ref() = true;
+
+  messaging::ReplicateQueue<PeerEvent> storeBPeerUpdatesQueue;
+  auto storeA = createKvStore(getTestKvConf("storeA"), {podArea});
+  auto storeB = createKvStore(
+      confB, {podArea, planeArea}, storeBPeerUpdatesQueue.getReader());
+  auto storeC = createKvStore(getTestKvConf("storeC"), {planeArea});
+
+  storeA->run();
+  storeB->run();
+  storeC->run();
+
+  storeA->addPeer(podAreaId, "storeB", storeB->getPeerSpec());
+  storeC->addPeer(planeAreaId, "storeB", storeB->getPeerSpec());
+
+  // peers of storeB are handed over to the event base of their area
+  thrift::PeersMap podPeers, planePeers;
+  podPeers.emplace(storeA->getNodeId(), storeA->getPeerSpec());
+  planePeers.emplace(storeC->getNodeId(), storeC->getPeerSpec());
+  storeBPeerUpdatesQueue.push(PeerEvent{
+      {podArea, AreaPeerEvent(podPeers, {} /*peersToDel*/)},
+      {planeArea, AreaPeerEvent(planePeers, {} /*peersToDel*/)}});
+
+  // synced signal is published once both areas complete initial sync
+  storeB->recvKvStoreSyncedSignal();
+
+  auto thriftValA = createThriftValue(
+      1 /* version */,
+      "storeA" /* originatorId */,
+      "valueA" /* value */,
+      Constants::kTtlInfinity /* ttl */);
+  auto thriftValC = createThriftValue(
+      1 /* version */,
+      "storeC" /* originatorId */,
+      "valueC" /* value */,
+      Constants::kTtlInfinity /* ttl */);
+
+  EXPECT_TRUE(storeA->setKey(podAreaId, "pod-key", thriftValA));
+  EXPECT_TRUE(storeC->setKey(planeAreaId, "plane-key", thriftValC));
+
+  waitForKeyInStoreWithTimeout(storeB, podAreaId, "pod-key");
+  waitForKeyInStoreWithTimeout(storeB, planeAreaId, "plane-key");
+
+  // key of one area must not leak into the other
+  EXPECT_FALSE(storeB->getKey(planeAreaId, "pod-key").has_value());
+  EXPECT_FALSE(storeB->getKey(podAreaId, "plane-key").has_value());
+  EXPECT_EQ(1, storeB->dumpAll(podAreaId).size());
+  EXPECT_EQ(1, storeB->dumpAll(planeAreaId).size());
+
+  // summary is gathered from both area event bases
+  auto summary = storeB->getSummary({});
+  ASSERT_EQ(2, summary.size());
+  EXPECT_EQ(1, *summary.at(0).keyValsCount_ref());
+  EXPECT_EQ(1, *summary.at(1).keyValsCount_ref());
+
+  // counters are added up across areas, queue depth is reported per area
+  auto counters = storeB->getCounters();
+  EXPECT_EQ(2, counters.at("kvstore.num_keys"));
+  EXPECT_EQ(1, counters.count("kvstore.evb_queue_depth.pod-area"));
+  EXPECT_EQ(1, counters.count("kvstore.evb_queue_depth.plane-area"));
+}
+
 /**
  * this is to verify correctness of 3-way full-sync between default and
  * non-default Areas. storeA is in kDefaultArea, while storeB is in areaB.
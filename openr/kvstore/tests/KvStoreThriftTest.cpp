@@ -43,10 +43,11 @@ class KvStoreThriftTestFixture : public ::testing::Test {
   }
 
   void
-  createKvStore(const std::string& nodeId) {
+  createKvStore(const std::string& nodeId, bool enableMerkleSync = false) {
     // create KvStoreConfig
     thrift::KvStoreConfig kvStoreConfig;
     kvStoreConfig.node_name_ref() = nodeId;
+    kvStoreConfig.enable_merkle_sync_ref() = enableMerkleSync;
     const std::unordered_set<std::string> areaIds{kTestingAreaName};
 
     stores_.emplace_back(
@@ -474,6 +475,98 @@ TEST_F(KvStoreThriftTestFixture, UnidirectionThriftFullSync) {
   EXPECT_EQ(v4->value_ref().value(), value2);
 }
 
+//
+// Test case for full-sync with Merkle-tree bucket digests. Same topology and
+// key set as `UnidirectionThriftFullSync`, except that keys are only
+// exchanged for differing buckets.
+//
+TEST_F(KvStoreThriftTestFixture, UnidirectionMerkleThriftFullSync) {
+  const std::string node1{"node-1"};
+  const std::string node2{"node-2"};
+  const std::string value1{"value-1"};
+  const std::string value2{"value-2"};
+
+  createKvStore(node1, true /* enableMerkleSync */);
+  createKvStore(node2, true /* enableMerkleSync */);
+  auto store1 = stores_.front();
+  auto store2 = stores_.back();
+
+  const std::string k0{"key0"};
+  const std::string k1{"key1"};
+  const std::string k2{"key2"};
+  const std::string k3{"key3"};
+  const std::string k4{"key4"};
+  std::vector<std::pair<std::string, int>> keyVersionAs = {
+      {k0, 5}, {k1, 1}, {k2, 9}, {k3, 1}};
+  std::vector<std::pair<std::string, int>> keyVersionBs = {
+      {k1, 1}, {k2, 1}, {k3, 9}, {k4, 6}};
+
+  for (const auto& [key, version] : keyVersionAs) {
+    auto val = createThriftValue(version, node1, value1);
+    EXPECT_TRUE(store1->setKey(kTestingAreaName, key, val));
+  }
+  for (const auto& [key, version] : keyVersionBs) {
+    auto val = createThriftValue(version, node1, key == k1 ? value1 : value2);
+    EXPECT_TRUE(store2->setKey(kTestingAreaName, key, val));
+  }
+
+  // Add peer ONLY for uni-direction
+  EXPECT_TRUE(store1->addPeer(
+      kTestingAreaName, store2->getNodeId(), store2->getPeerSpec()));
+  EXPECT_TRUE(verifyKvStorePeerState(
+      store1.get(),
+      node2,
+      thrift::KvStorePeerState::INITIALIZED,
+      kTestingAreaName));
+
+  // after 3-way full-sync, we expect both A and B have:
+  // (k0, 5, a), (k1, 1, a), (k2, 9, a), (k3, 9, b), (k4, 6, b)
+  const std::vector<std::tuple<std::string, int, std::string>> expKeyVals = {
+      {k0, 5, value1},
+      {k1, 1, value1},
+      {k2, 9, value1},
+      {k3, 9, value2},
+      {k4, 6, value2}};
+  for (const auto& [key, version, value] : expKeyVals) {
+    auto val = createThriftValue(version, node1, value);
+    EXPECT_TRUE(verifyKvStoreKeyVal(store1.get(), key, val, kTestingAreaName));
+    EXPECT_TRUE(verifyKvStoreKeyVal(store2.get(), key, val, kTestingAreaName));
+  }
+}
+
+//
+// Responder which doesn't maintain Merkle tree ignores bucket digests of
+// requester and responds with all of its keys instead.
+//
+TEST_F(KvStoreThriftTestFixture, MixedMerkleThriftFullSync) {
+  const std::string node1{"node-1"};
+  const std::string node2{"node-2"};
+
+  createKvStore(node1, true /* enableMerkleSync */);
+  createKvStore(node2, false /* enableMerkleSync */);
+  auto store1 = stores_.front();
+  auto store2 = stores_.back();
+
+  const auto val1 = createThriftValue(5, node1, "value-1");
+  const auto val2 = createThriftValue(6, node2, "value-2");
+  EXPECT_TRUE(store1->setKey(kTestingAreaName, "key1", val1));
+  EXPECT_TRUE(store2->setKey(kTestingAreaName, "key2", val2));
+
+  // Add peer ONLY for uni-direction
+  EXPECT_TRUE(store1->addPeer(
+      kTestingAreaName, store2->getNodeId(), store2->getPeerSpec()));
+  EXPECT_TRUE(verifyKvStorePeerState(
+      store1.get(),
+      node2,
+      thrift::KvStorePeerState::INITIALIZED,
+      kTestingAreaName));
+
+  for (auto* store : {store1.get(), store2.get()}) {
+    EXPECT_TRUE(verifyKvStoreKeyVal(store, "key1", val1, kTestingAreaName));
+    EXPECT_TRUE(verifyKvStoreKeyVal(store, "key2", val2, kTestingAreaName));
+  }
+}
+
 //
 // Test case for flooding publication over thrift.
 //
@@ -6,13 +6,21 @@
  */
 
 #include <fbzmq/zmq/Zmq.h>
+#include <folly/FileUtil.h>
+#include <folly/Random.h>
+#include <folly/compression/Compression.h>
+#include <folly/experimental/TestUtil.h>
 #include <folly/init/Init.h>
 #include <gtest/gtest.h>
 
 #include <openr/if/gen-cpp2/KvStoreServiceAsyncClient.h>
 #include <openr/if/gen-cpp2/KvStore_types.h>
+#include <openr/kvstore/KvStoreFloodDigest.h>
+#include <openr/kvstore/KvStoreKeyIndex.h>
+#include <openr/kvstore/KvStoreMerkleTree.h>
 #include <openr/kvstore/KvStoreUtil.h>
 #include <openr/kvstore/KvStoreWrapper.h>
+#include <openr/kvstore/TtlCountdownQueue.h>
 
 using namespace openr;
 
@@ -408,6 +416,740 @@ TEST(KvStoreUtil, KvStoreFiltersTest) {
   ASSERT_FALSE(andFilter.keyMatch(node3_key1, node3_val1)); // No match
 }
 
+//
+// validate utility functions against KvStoreDb storage backend
+//
+TEST(KvStoreUtil, KvStoreMapTest) {
+  KvStoreMap kvStore;
+  std::unordered_map<std::string, thrift::Value> keyVals;
+  keyVals.emplace("key1", createThriftValue(1, "node1", "value1"));
+  keyVals.emplace("key2", createThriftValue(1, "node2", "value2"));
+
+  // merge into empty store
+  auto updates = mergeKeyValues(kvStore, keyVals).first;
+  EXPECT_EQ(keyVals, updates);
+  EXPECT_EQ(2, kvStore.size());
+
+  // merge same content again is no-op
+  EXPECT_TRUE(mergeKeyValues(kvStore, keyVals).first.empty());
+
+  // dump with filters
+  const auto filters = KvStoreFilters({"key1"}, {} /* originatorIds */);
+  auto pub = dumpAllWithFilters(kTestingAreaName, kvStore, filters);
+  EXPECT_EQ(1, pub.keyVals_ref()->size());
+  EXPECT_EQ(1, pub.keyVals_ref()->count("key1"));
+
+  pub = dumpHashWithFilters(kTestingAreaName, kvStore, filters);
+  EXPECT_EQ(1, pub.keyVals_ref()->size());
+  EXPECT_FALSE(pub.keyVals_ref()->at("key1").value_ref().has_value());
+}
+
+//
+// [Key Sharding]
+// validate map interface of KvStoreShardedMap and merge into single shards
+//
+TEST(KvStoreUtil, KvStoreShardedMapTest) {
+  KvStoreShardedMap kvStore(4);
+  EXPECT_EQ(4, kvStore.numShards());
+  EXPECT_TRUE(kvStore.empty());
+  EXPECT_EQ(kvStore.begin(), kvStore.end());
+
+  std::unordered_map<std::string, thrift::Value> keyVals;
+  for (int i = 0; i < 100; ++i) {
+    keyVals.emplace(
+        fmt::format("key{}", i), createThriftValue(1, "node1", "value"));
+  }
+
+  // split once, then merge shard by shard, each only taking its own keys
+  auto const slices = splitKeyValuesByShard(kvStore, keyVals);
+  ASSERT_EQ(kvStore.numShards(), slices.size());
+  size_t numSliced{0};
+  for (auto const& slice : slices) {
+    numSliced += slice.size();
+  }
+  EXPECT_EQ(keyVals.size(), numSliced);
+
+  std::unordered_map<std::string, thrift::Value> updates;
+  for (size_t shardIdx = 0; shardIdx < kvStore.numShards(); ++shardIdx) {
+    auto shardUpdates =
+        mergeKeyValuesIntoShard(kvStore, shardIdx, slices.at(shardIdx)).first;
+    for (auto const& [key, _] : shardUpdates) {
+      EXPECT_EQ(shardIdx, kvStore.getShardIndex(key));
+    }
+    EXPECT_EQ(shardUpdates.size(), kvStore.getShard(shardIdx).size());
+    updates.merge(shardUpdates);
+  }
+  EXPECT_EQ(keyVals, updates);
+  EXPECT_EQ(keyVals.size(), kvStore.size());
+  EXPECT_TRUE(mergeKeyValues(kvStore, keyVals).first.empty());
+
+  // iteration visits every key once
+  std::unordered_map<std::string, thrift::Value> dump(
+      kvStore.begin(), kvStore.end());
+  EXPECT_EQ(keyVals, dump);
+
+  auto it = kvStore.find("key1");
+  ASSERT_NE(kvStore.end(), it);
+  EXPECT_EQ("key1", it->first);
+  EXPECT_EQ(kvStore.end(), kvStore.find("key100"));
+  kvStore.erase(it);
+  EXPECT_EQ(0, kvStore.count("key1"));
+  EXPECT_EQ(1, kvStore.erase("key2"));
+  EXPECT_EQ(keyVals.size() - 2, kvStore.size());
+
+  // dumps are the same as of a single map
+  KvStoreMap singleKvStore;
+  mergeKeyValues(singleKvStore, keyVals);
+  singleKvStore.erase("key1");
+  singleKvStore.erase("key2");
+  const auto filters = KvStoreFilters({"key1"}, {} /* originatorIds */);
+  EXPECT_EQ(
+      dumpAllWithFilters(kTestingAreaName, singleKvStore, filters),
+      dumpAllWithFilters(kTestingAreaName, kvStore, filters));
+  EXPECT_EQ(
+      dumpHashWithFilters(kTestingAreaName, singleKvStore, filters),
+      dumpHashWithFilters(kTestingAreaName, kvStore, filters));
+
+  kvStore.clear();
+  EXPECT_TRUE(kvStore.empty());
+}
+
+//
+// validate KvStoreMerkleTree incremental maintenance
+//
+TEST(KvStoreUtil, MerkleTreeAddRemoveTest) {
+  const auto val1 = createThriftValue(
+      1, "node1", "value1", Constants::kTtlInfinity, 0, 111);
+  const auto val2 = createThriftValue(
+      2, "node2", "value2", Constants::kTtlInfinity, 0, 222);
+
+  KvStoreMerkleTree tree1(4);
+  KvStoreMerkleTree tree2(4);
+  EXPECT_EQ(16u, tree1.getNumBuckets());
+  EXPECT_EQ(0, tree1.getRootDigest());
+
+  // digest is independent of insertion order
+  tree1.add("key1", val1);
+  tree1.add("key2", val2);
+  tree2.add("key2", val2);
+  tree2.add("key1", val1);
+  EXPECT_NE(0, tree1.getRootDigest());
+  EXPECT_EQ(tree1.getRootDigest(), tree2.getRootDigest());
+  EXPECT_EQ(tree1.getLeafDigests(), tree2.getLeafDigests());
+
+  // ttl change doesn't affect digest
+  auto val1TtlUpdate = val1;
+  val1TtlUpdate.ttl_ref() = 1000;
+  val1TtlUpdate.ttlVersion_ref() = 5;
+  EXPECT_EQ(
+      KvStoreMerkleTree::getKeyDigest("key1", val1),
+      KvStoreMerkleTree::getKeyDigest("key1", val1TtlUpdate));
+
+  // version change does affect digest
+  auto val1Update = val1;
+  val1Update.version_ref() = 10;
+  tree2.update(
+      "key1",
+      KvStoreMerkleTree::getKeyDigest("key1", val1),
+      KvStoreMerkleTree::getKeyDigest("key1", val1Update));
+  EXPECT_NE(tree1.getRootDigest(), tree2.getRootDigest());
+
+  // remove everything brings tree back to empty state
+  tree1.remove("key1", val1);
+  tree1.remove("key2", val2);
+  EXPECT_EQ(0, tree1.getRootDigest());
+  EXPECT_EQ(std::vector<int64_t>(16, 0), tree1.getLeafDigests());
+
+  tree1.add("key1", val1);
+  tree1.clear();
+  EXPECT_EQ(0, tree1.getRootDigest());
+}
+
+//
+// validate KvStoreMerkleTree bucket comparison
+//
+TEST(KvStoreUtil, MerkleTreeDifferingBucketsTest) {
+  KvStoreMerkleTree tree1(6);
+  KvStoreMerkleTree tree2(6);
+  for (int i = 0; i < 100; ++i) {
+    const auto key = fmt::format("key{}", i);
+    const auto val = createThriftValue(1, "node1", "value", 0, 0, i);
+    tree1.add(key, val);
+    tree2.add(key, val);
+  }
+
+  // identical trees
+  auto diff = tree1.getDifferingBuckets(tree2.getLeafDigests());
+  ASSERT_TRUE(diff.has_value());
+  EXPECT_TRUE(diff->empty());
+
+  // one key differs, ONLY its bucket is reported
+  const auto val = createThriftValue(2, "node1", "value", 0, 0, 1000);
+  tree1.add("key100", val);
+  diff = tree1.getDifferingBuckets(tree2.getLeafDigests());
+  ASSERT_TRUE(diff.has_value());
+  EXPECT_EQ(
+      std::vector<int32_t>{static_cast<int32_t>(tree1.getBucket("key100"))},
+      *diff);
+
+  // two keys differ, buckets are reported in sorted order
+  tree2.add("key101", val);
+  diff = tree1.getDifferingBuckets(tree2.getLeafDigests());
+  ASSERT_TRUE(diff.has_value());
+  std::set<int32_t> expected{
+      static_cast<int32_t>(tree1.getBucket("key100")),
+      static_cast<int32_t>(tree1.getBucket("key101"))};
+  EXPECT_EQ(std::vector<int32_t>(expected.begin(), expected.end()), *diff);
+
+  // mismatched layout
+  KvStoreMerkleTree tree3(5);
+  EXPECT_FALSE(tree1.getDifferingBuckets(tree3.getLeafDigests()).has_value());
+}
+
+//
+// validate TtlCountdownQueue in-place refresh and expiry across levels
+//
+TEST(KvStoreUtil, TtlCountdownQueueTest) {
+  const auto origin = std::chrono::steady_clock::now();
+  TtlCountdownQueue queue(std::chrono::milliseconds(10), origin);
+  EXPECT_TRUE(queue.empty());
+  EXPECT_FALSE(queue.getNextExpiryTime().has_value());
+
+  TtlCountdownQueueEntry entry1;
+  entry1.key = "key1";
+  entry1.expiryTime = origin + std::chrono::milliseconds(25);
+  // due time is rounded up to tick boundary
+  EXPECT_EQ(origin + std::chrono::milliseconds(30), queue.upsert(entry1));
+
+  TtlCountdownQueueEntry entry2;
+  entry2.key = "key2";
+  entry2.expiryTime = origin + std::chrono::seconds(100);
+  queue.upsert(entry2);
+  EXPECT_EQ(2, queue.size());
+
+  // never expire early
+  EXPECT_TRUE(queue.expire(origin + std::chrono::milliseconds(29)).empty());
+
+  // refresh in place, no duplicate entry
+  entry1.expiryTime = origin + std::chrono::milliseconds(50);
+  entry1.ttlVersion = 1;
+  queue.upsert(entry1);
+  EXPECT_EQ(2, queue.size());
+  ASSERT_NE(nullptr, queue.find("key1"));
+  EXPECT_EQ(1, queue.find("key1")->ttlVersion);
+  EXPECT_EQ(
+      origin + std::chrono::milliseconds(50),
+      queue.getNextExpiryTime().value());
+
+  EXPECT_TRUE(queue.expire(origin + std::chrono::milliseconds(30)).empty());
+  auto expired = queue.expire(origin + std::chrono::milliseconds(50));
+  ASSERT_EQ(1, expired.size());
+  EXPECT_EQ("key1", expired.at(0).key);
+  EXPECT_EQ(1, expired.at(0).ttlVersion);
+  EXPECT_EQ(nullptr, queue.find("key1"));
+
+  // key2 is parked on higher level and needs cascading before expiry
+  auto nextExpiryTime = queue.getNextExpiryTime();
+  ASSERT_TRUE(nextExpiryTime.has_value());
+  EXPECT_GT(*nextExpiryTime, origin + std::chrono::milliseconds(50));
+  EXPECT_LE(*nextExpiryTime, entry2.expiryTime);
+  EXPECT_TRUE(queue.expire(entry2.expiryTime - std::chrono::milliseconds(1))
+                  .empty());
+  expired = queue.expire(entry2.expiryTime);
+  ASSERT_EQ(1, expired.size());
+  EXPECT_EQ("key2", expired.at(0).key);
+  EXPECT_TRUE(queue.empty());
+
+  // cancel
+  queue.upsert(entry2);
+  EXPECT_TRUE(queue.erase("key2"));
+  EXPECT_FALSE(queue.erase("key2"));
+  EXPECT_TRUE(queue.empty());
+  EXPECT_TRUE(queue.expire(origin + std::chrono::seconds(200)).empty());
+}
+
+//
+// validate TtlCountdownQueue expires random keys no earlier than expiry time
+// and no later than one tick after
+//
+TEST(KvStoreUtil, TtlCountdownQueueRandomTest) {
+  const auto tick = std::chrono::milliseconds(10);
+  const auto origin = std::chrono::steady_clock::now();
+  TtlCountdownQueue queue(tick, origin);
+
+  std::unordered_map<std::string, std::chrono::steady_clock::time_point>
+      expiryTimes;
+  for (int i = 0; i < 1000; ++i) {
+    TtlCountdownQueueEntry entry;
+    entry.key = fmt::format("key{}", i);
+    entry.expiryTime =
+        origin + std::chrono::milliseconds(folly::Random::rand32(200'000));
+    expiryTimes[entry.key] = entry.expiryTime;
+    queue.upsert(std::move(entry));
+  }
+
+  auto prevNow = origin;
+  for (auto now = origin; not queue.empty();
+       now += std::chrono::milliseconds(50)) {
+    for (auto const& entry : queue.expire(now)) {
+      EXPECT_EQ(expiryTimes.at(entry.key), entry.expiryTime);
+      EXPECT_LE(entry.expiryTime, now);
+      EXPECT_GT(entry.expiryTime + tick, prevNow);
+      expiryTimes.erase(entry.key);
+    }
+    prevNow = now;
+  }
+  EXPECT_TRUE(expiryTimes.empty());
+}
+
+//
+// validate literal prefix extraction out of key prefix regexes
+//
+TEST(KvStoreUtil, KeyIndexLiteralPrefixTest) {
+  EXPECT_EQ("adj:", KvStoreKeyIndex::getLiteralPrefix("adj:"));
+  EXPECT_EQ("adj:", KvStoreKeyIndex::getLiteralPrefix("^adj:"));
+  EXPECT_EQ("adj:", KvStoreKeyIndex::getLiteralPrefix("adj:.*"));
+  EXPECT_EQ("10.0.0.", KvStoreKeyIndex::getLiteralPrefix("10\\.0\\.0\\."));
+  EXPECT_EQ("prefix:node", KvStoreKeyIndex::getLiteralPrefix("prefix:node\\d"));
+  // quantifier makes the last character optional
+  EXPECT_EQ("pre", KvStoreKeyIndex::getLiteralPrefix("pref?ix"));
+  EXPECT_EQ("pre", KvStoreKeyIndex::getLiteralPrefix("pref*ix"));
+  EXPECT_EQ("pref", KvStoreKeyIndex::getLiteralPrefix("pref+ix"));
+  EXPECT_EQ("a", KvStoreKeyIndex::getLiteralPrefix("a[bc]"));
+  // no literal prefix
+  EXPECT_EQ("", KvStoreKeyIndex::getLiteralPrefix(""));
+  EXPECT_EQ("", KvStoreKeyIndex::getLiteralPrefix(".*:key"));
+  EXPECT_EQ("", KvStoreKeyIndex::getLiteralPrefix("adj:|prefix:"));
+  EXPECT_EQ("", KvStoreKeyIndex::getLiteralPrefix("(adj|prefix):"));
+  EXPECT_EQ("", KvStoreKeyIndex::getLiteralPrefix("(?i)adj:"));
+}
+
+//
+// validate KvStoreKeyIndex incremental maintenance and candidate lookup
+//
+TEST(KvStoreUtil, KeyIndexTest) {
+  KvStoreKeyIndex index;
+  index.upsert("adj:node1", "node1");
+  index.upsert("adj:node2", "node2");
+  index.upsert("prefix:node1:10.0.0.0/24", "node1");
+  index.upsert("prefix:node2:10.0.1.0/24", "node2");
+  EXPECT_EQ(4, index.size());
+
+  // key prefix
+  auto keys = index.getCandidateKeys(
+      {"adj:"}, {} /* originatorIds */, thrift::FilterOperator::OR);
+  ASSERT_TRUE(keys.has_value());
+  EXPECT_EQ(std::vector<std::string>({"adj:node1", "adj:node2"}), *keys);
+
+  // OR: union of key prefixes and originators, without duplicates
+  keys = index.getCandidateKeys(
+      {"adj:", "adj:node1"}, {"node1"}, thrift::FilterOperator::OR);
+  ASSERT_TRUE(keys.has_value());
+  EXPECT_EQ(
+      std::vector<std::string>(
+          {"adj:node1", "adj:node2", "prefix:node1:10.0.0.0/24"}),
+      *keys);
+
+  // AND: narrowed by originator if key prefix is not indexable
+  keys = index.getCandidateKeys({".*"}, {"node2"}, thrift::FilterOperator::AND);
+  ASSERT_TRUE(keys.has_value());
+  EXPECT_EQ(
+      std::vector<std::string>({"adj:node2", "prefix:node2:10.0.1.0/24"}),
+      *keys);
+
+  // not indexable
+  EXPECT_FALSE(
+      index.getCandidateKeys({}, {}, thrift::FilterOperator::OR).has_value());
+  EXPECT_FALSE(
+      index.getCandidateKeys({".*"}, {"node1"}, thrift::FilterOperator::OR)
+          .has_value());
+
+  // originator change moves key over
+  index.upsert("adj:node1", "node3");
+  keys = index.getCandidateKeys({}, {"node1"}, thrift::FilterOperator::OR);
+  ASSERT_TRUE(keys.has_value());
+  EXPECT_EQ(std::vector<std::string>({"prefix:node1:10.0.0.0/24"}), *keys);
+  keys = index.getCandidateKeys({}, {"node3"}, thrift::FilterOperator::OR);
+  ASSERT_TRUE(keys.has_value());
+  EXPECT_EQ(std::vector<std::string>({"adj:node1"}), *keys);
+
+  // erase
+  EXPECT_TRUE(index.erase("adj:node1"));
+  EXPECT_FALSE(index.erase("adj:node1"));
+  EXPECT_EQ(3, index.size());
+  keys = index.getCandidateKeys({}, {"node3"}, thrift::FilterOperator::OR);
+  ASSERT_TRUE(keys.has_value());
+  EXPECT_TRUE(keys->empty());
+}
+
+//
+// validate indexed dumpAllWithFilters yields same result as full scan
+//
+TEST(KvStoreUtil, KeyIndexDumpAllWithFiltersTest) {
+  KvStoreMap kvStore;
+  KvStoreKeyIndex index;
+  for (int i = 0; i < 100; ++i) {
+    const auto node = fmt::format("node{}", i % 7);
+    const auto key = fmt::format("{}:{}:{}", i % 2 ? "adj" : "prefix", node, i);
+    kvStore.emplace(key, createThriftValue(1, node, "value"));
+    index.upsert(key, node);
+  }
+
+  const std::vector<std::vector<std::string>> keyPrefixes = {
+      {}, {"adj:"}, {"prefix:node1"}, {"adj:node[12]:", "prefix:"}, {".*:1"}};
+  const std::vector<std::set<std::string>> originatorIds = {
+      {}, {"node1"}, {"node2", "node5"}, {"node9"}};
+  for (auto const& prefixes : keyPrefixes) {
+    for (auto const& originators : originatorIds) {
+      for (auto oper :
+           {thrift::FilterOperator::OR, thrift::FilterOperator::AND}) {
+        const auto filters = KvStoreFilters(prefixes, originators, oper);
+        EXPECT_EQ(
+            *dumpAllWithFilters(kTestingAreaName, kvStore, filters)
+                 .keyVals_ref(),
+            *dumpAllWithFilters(kTestingAreaName, kvStore, index, filters)
+                 .keyVals_ref());
+      }
+    }
+  }
+}
+
+TEST(KvStoreUtil, KeyIndexChunkTest) {
+  KvStoreKeyIndex index;
+  for (auto const& key : {"key1", "key2", "key3", "key4", "key5"}) {
+    index.upsert(key, "node1");
+  }
+
+  // walk the key space in chunks of 2 keys
+  auto chunkEnd = index.getChunkEnd(std::nullopt, 2);
+  ASSERT_TRUE(chunkEnd.has_value());
+  EXPECT_EQ("key2", *chunkEnd);
+  EXPECT_EQ(
+      std::vector<std::string>({"key1", "key2"}),
+      index.getKeysInRange(std::nullopt, chunkEnd));
+
+  chunkEnd = index.getChunkEnd(std::string("key2"), 2);
+  ASSERT_TRUE(chunkEnd.has_value());
+  EXPECT_EQ("key4", *chunkEnd);
+  EXPECT_EQ(
+      std::vector<std::string>({"key3", "key4"}),
+      index.getKeysInRange(std::string("key2"), chunkEnd));
+
+  // last chunk reaches the end of the key space
+  EXPECT_FALSE(index.getChunkEnd(std::string("key4"), 2).has_value());
+  EXPECT_FALSE(index.getChunkEnd(std::string("key3"), 2).has_value());
+  EXPECT_EQ(
+      std::vector<std::string>({"key5"}),
+      index.getKeysInRange(std::string("key4"), std::nullopt));
+
+  // cursor need not be an existing key
+  EXPECT_EQ("key3", index.getChunkEnd(std::string("key1a"), 2).value());
+  EXPECT_TRUE(
+      index.getKeysInRange(std::string("key4"), std::string("key2")).empty());
+  EXPECT_FALSE(KvStoreKeyIndex().getChunkEnd(std::nullopt, 2).has_value());
+}
+
+TEST(KvStoreUtil, SyncChunkPackTest) {
+  thrift::Publication pub;
+  pub.area_ref() = kTestingAreaName;
+  pub.keyVals_ref()["key1"] = createThriftValue(1, "node1", "value1");
+  pub.keyVals_ref()["key2"] = createThriftValue(2, "node2", "value2");
+  pub.tobeUpdatedKeys_ref() = std::vector<std::string>{"key3"};
+
+  for (auto compression :
+       {thrift::KvStoreCompression::NONE, thrift::KvStoreCompression::ZSTD}) {
+    auto chunk = packSyncChunk(
+        thrift::Publication(pub), std::string("key2"), compression);
+    EXPECT_EQ("key2", chunk.chunkEnd_ref().value());
+    EXPECT_EQ(
+        compression != thrift::KvStoreCompression::NONE and
+            folly::io::hasCodec(folly::io::CodecType::ZSTD),
+        chunk.compressedPublication_ref().has_value());
+    EXPECT_EQ(pub, unpackSyncChunk(std::move(chunk)));
+  }
+
+  // last chunk
+  auto chunk = packSyncChunk(
+      thrift::Publication(pub), std::nullopt, thrift::KvStoreCompression::NONE);
+  EXPECT_FALSE(chunk.chunkEnd_ref().has_value());
+
+  // corrupted payload
+  chunk.compressedPublication_ref() = "garbage";
+  chunk.compression_ref() = thrift::KvStoreCompression::ZSTD;
+  EXPECT_ANY_THROW(unpackSyncChunk(std::move(chunk)));
+}
+
+TEST(KvStoreUtil, SnapshotReadWriteTest) {
+  folly::test::TemporaryDirectory tmpDir;
+  const auto filePath =
+      getKvStoreSnapshotPath(tmpDir.path().string(), kTestingAreaName);
+
+  // snapshot doesn't exist yet
+  EXPECT_FALSE(readKvStoreSnapshot(filePath).has_value());
+
+  thrift::KvStoreSnapshot snapshot;
+  snapshot.version_ref() = Constants::kKvStoreSnapshotVersion;
+  snapshot.area_ref() = kTestingAreaName;
+  snapshot.timestamp_ms_ref() = 1000;
+  snapshot.keyVals_ref()["key1"] = createThriftValue(1, "node1", "value1");
+  snapshot.keyVals_ref()["key2"] =
+      createThriftValue(2, "node2", "value2", 30000 /* ttl */);
+
+  EXPECT_TRUE(writeKvStoreSnapshot(filePath, snapshot));
+  auto loaded = readKvStoreSnapshot(filePath);
+  ASSERT_TRUE(loaded.has_value());
+  EXPECT_EQ(snapshot, *loaded);
+
+  // snapshot of other version is ignored
+  snapshot.version_ref() = Constants::kKvStoreSnapshotVersion + 1;
+  EXPECT_TRUE(writeKvStoreSnapshot(filePath, snapshot));
+  EXPECT_FALSE(readKvStoreSnapshot(filePath).has_value());
+
+  // corrupted snapshot is ignored
+  folly::writeFileAtomic(filePath, std::string("garbage"));
+  EXPECT_FALSE(readKvStoreSnapshot(filePath).has_value());
+
+  // write into non-existing directory fails
+  EXPECT_FALSE(writeKvStoreSnapshot(
+      getKvStoreSnapshotPath(tmpDir.path().string() + "/none", "area"),
+      snapshot));
+}
+
+TEST(KvStoreUtil, SnapshotTtlTest) {
+  thrift::KvStoreSnapshot snapshot;
+  snapshot.timestamp_ms_ref() = 1000;
+  snapshot.keyVals_ref()["infinite"] = createThriftValue(1, "node1", "value");
+  snapshot.keyVals_ref()["expiring"] =
+      createThriftValue(1, "node1", "value", 30000 /* ttl */);
+  snapshot.keyVals_ref()["expired"] =
+      createThriftValue(1, "node1", "value", 5000 /* ttl */);
+
+  updateSnapshotTtl(snapshot, 6000, std::chrono::milliseconds(1));
+  EXPECT_EQ(2, snapshot.keyVals_ref()->size());
+  EXPECT_EQ(
+      Constants::kTtlInfinity,
+      *snapshot.keyVals_ref()->at("infinite").ttl_ref());
+  EXPECT_EQ(25000, *snapshot.keyVals_ref()->at("expiring").ttl_ref());
+  EXPECT_EQ(0, snapshot.keyVals_ref()->count("expired"));
+}
+
+TEST(KvStoreUtil, DumpSnapshotWithFiltersTest) {
+  KvStoreDumpSnapshot dumpSnapshot;
+  dumpSnapshot.seqNum = 7;
+  dumpSnapshot.snapshot.area_ref() = kTestingAreaName;
+  dumpSnapshot.snapshot.timestamp_ms_ref() = 1000;
+  auto& keyVals = *dumpSnapshot.snapshot.keyVals_ref();
+  keyVals["adj:node1"] = createThriftValue(1, "node1", "value");
+  keyVals["adj:node2"] =
+      createThriftValue(1, "node2", "value", 30000 /* ttl */);
+  keyVals["adj:node3"] = createThriftValue(1, "node3", "value", 5000 /* ttl */);
+  keyVals["prefix:node1"] = createThriftValue(1, "node1", "value");
+
+  KvStoreFilters filters({"adj:"}, {});
+  const auto pub = dumpSnapshotWithFilters(
+      dumpSnapshot, filters, true /* doNotPublishValue */, 6000);
+  EXPECT_EQ(kTestingAreaName, *pub.area_ref());
+  EXPECT_EQ(7, *pub.seqNum_ref());
+  // expired key is left out, ttl of others is aged
+  EXPECT_EQ(2, pub.keyVals_ref()->size());
+  EXPECT_EQ(
+      Constants::kTtlInfinity, *pub.keyVals_ref()->at("adj:node1").ttl_ref());
+  EXPECT_EQ(25000, *pub.keyVals_ref()->at("adj:node2").ttl_ref());
+  EXPECT_FALSE(pub.keyVals_ref()->at("adj:node2").value_ref().has_value());
+
+  // snapshot is left untouched
+  EXPECT_EQ(4, keyVals.size());
+  EXPECT_EQ(30000, *keyVals.at("adj:node2").ttl_ref());
+}
+
+TEST(KvStoreUtil, ValueDeltaTest) {
+  const std::string prefix(2000, 'a');
+  const std::string suffix(2000, 'z');
+  const auto base = createThriftValue(1, "node1", prefix + "old" + suffix);
+
+  // single replace op between common prefix and suffix
+  {
+    const auto value =
+        createThriftValue(2, "node1", prefix + "brand-new" + suffix);
+    const auto delta = createValueDelta(base, value);
+    ASSERT_TRUE(delta.has_value());
+    EXPECT_EQ(1, *delta->baseVersion_ref());
+    ASSERT_EQ(1, delta->ops_ref()->size());
+    EXPECT_EQ(prefix.size(), *delta->ops_ref()->front().offset_ref());
+    EXPECT_EQ(3, *delta->ops_ref()->front().length_ref());
+    EXPECT_EQ("brand-new", *delta->ops_ref()->front().data_ref());
+
+    const auto restored = applyValueDelta(*base.value_ref(), *delta);
+    ASSERT_TRUE(restored.has_value());
+    EXPECT_EQ(*value.value_ref(), *restored);
+
+    // applied on top of other base
+    EXPECT_FALSE(applyValueDelta(prefix + "xyz" + suffix, *delta).has_value());
+    EXPECT_FALSE(applyValueDelta("short", *delta).has_value());
+  }
+
+  // truncated value
+  {
+    const auto value = createThriftValue(2, "node1", prefix + suffix);
+    const auto delta = createValueDelta(base, value);
+    ASSERT_TRUE(delta.has_value());
+    const auto restored = applyValueDelta(*base.value_ref(), *delta);
+    ASSERT_TRUE(restored.has_value());
+    EXPECT_EQ(*value.value_ref(), *restored);
+  }
+
+  // not worth it: small or mostly rewritten value
+  {
+    const auto smallBase = createThriftValue(1, "node1", "value1");
+    const auto smallValue = createThriftValue(2, "node1", "value2");
+    EXPECT_FALSE(createValueDelta(smallBase, smallValue).has_value());
+
+    const auto value = createThriftValue(2, "node1", std::string(4003, 'b'));
+    EXPECT_FALSE(createValueDelta(base, value).has_value());
+  }
+}
+
+TEST(KvStoreUtil, FloodDigestTest) {
+  KvStoreFloodDigest floodDigest;
+  const auto value = createThriftValue(2, "node1", "value");
+  floodDigest.add("key1", value);
+
+  auto digest = floodDigest.toThrift();
+  EXPECT_EQ(Constants::kKvStoreFloodDigestBits / 8, digest.bits_ref()->size());
+  EXPECT_TRUE(KvStoreFloodDigest::mayContain(digest, "key1", value));
+  EXPECT_FALSE(KvStoreFloodDigest::mayContain(digest, "key2", value));
+
+  // any change of version, originatorId or ttlVersion is a new tuple
+  auto newValue = value;
+  newValue.version_ref() = 3;
+  EXPECT_FALSE(KvStoreFloodDigest::mayContain(digest, "key1", newValue));
+  newValue = value;
+  newValue.originatorId_ref() = "node2";
+  EXPECT_FALSE(KvStoreFloodDigest::mayContain(digest, "key1", newValue));
+  newValue = value;
+  newValue.ttlVersion_ref() = 1;
+  EXPECT_FALSE(KvStoreFloodDigest::mayContain(digest, "key1", newValue));
+
+  // payload and ttl are not part of the tuple
+  newValue = value;
+  newValue.value_ref().reset();
+  newValue.ttl_ref() = 100;
+  EXPECT_TRUE(KvStoreFloodDigest::mayContain(digest, "key1", newValue));
+
+  // tuple survives one rotation, but not two
+  floodDigest.rotate();
+  EXPECT_TRUE(
+      KvStoreFloodDigest::mayContain(floodDigest.toThrift(), "key1", value));
+  floodDigest.rotate();
+  EXPECT_FALSE(
+      KvStoreFloodDigest::mayContain(floodDigest.toThrift(), "key1", value));
+
+  // malformed digest contains nothing
+  digest.numHashes_ref() = 0;
+  EXPECT_FALSE(KvStoreFloodDigest::mayContain(digest, "key1", value));
+  digest.numHashes_ref() = 4;
+  digest.bits_ref() = "";
+  EXPECT_FALSE(KvStoreFloodDigest::mayContain(digest, "key1", value));
+}
+
+TEST(KvStoreUtil, KeyFamilyTest) {
+  EXPECT_EQ("adj", getKeyFamily("adj:node1"));
+  EXPECT_EQ("prefix", getKeyFamily("prefix:node1:[10.0.0.0/8]"));
+  EXPECT_EQ("other", getKeyFamily("nodeLabel"));
+  EXPECT_EQ("other", getKeyFamily(":node1"));
+
+  auto value = createThriftValue(1, "node1", std::string("value1"));
+  // key + originatorId + value
+  EXPECT_EQ(9 + 5 + 6, getKeyValBytes("adj:node1", value));
+
+  // ttl update carries no value
+  value.value_ref().reset();
+  EXPECT_EQ(9 + 5, getKeyValBytes("adj:node1", value));
+}
+
+TEST(KvStoreUtil, MergeDumpedKeyValsTest) {
+  std::unordered_map<std::string, thrift::Value> merged;
+  EXPECT_EQ(
+      2,
+      mergeDumpedKeyVals(
+          merged,
+          {{"key1", createThriftValue(1, "node1", std::string("value1"))},
+           {"key2", createThriftValue(1, "node2", std::string("value2"))}}));
+
+  // same (version, originatorId) dropped upfront, newer ones merged
+  EXPECT_EQ(
+      2,
+      mergeDumpedKeyVals(
+          merged,
+          {{"key1", createThriftValue(1, "node1", std::string("value1"))},
+           {"key2", createThriftValue(2, "node2", std::string("value2"))},
+           {"key3", createThriftValue(1, "node3", std::string("value3"))}}));
+  EXPECT_EQ(3, merged.size());
+  EXPECT_EQ(2, *merged.at("key2").version_ref());
+
+  // higher ttlVersion of the same value is merged
+  EXPECT_EQ(
+      1,
+      mergeDumpedKeyVals(
+          merged,
+          {{"key1",
+            createThriftValue(
+                1, "node1", std::string("value1"), Constants::kTtlInfinity, 1)},
+           {"key3", createThriftValue(1, "node3", std::string("value3"))}}));
+  EXPECT_EQ(1, *merged.at("key1").ttlVersion_ref());
+}
+
+TEST(KvStoreUtil, ParseThriftValuesTest) {
+  std::unordered_map<std::string, thrift::Value> keyVals;
+  apache::thrift::CompactSerializer serializer;
+  for (int i = 0; i < 10; ++i) {
+    auto value = createThriftValue(i, "node1", std::string("value"));
+    keyVals.emplace(
+        fmt::format("key{}", i),
+        createThriftValue(
+            1, "node1", writeThriftObjStr(value, serializer)));
+  }
+  const auto parsed = parseThriftValues<thrift::Value>(keyVals);
+  EXPECT_EQ(10, parsed.size());
+  EXPECT_EQ(3, *parsed.at("key3").version_ref());
+  // parallel parse yields the same
+  EXPECT_EQ(parsed, parseThriftValues<thrift::Value>(keyVals, 4));
+  EXPECT_EQ(parsed, parseThriftValues<thrift::Value>(keyVals, 100));
+}
+
+TEST(KvStoreUtil, SerializedKeySetParamsTest) {
+  thrift::KeySetParams params;
+  params.keyVals_ref()->emplace(
+      "key1", createThriftValue(1, "node1", std::string("value1")));
+  auto ttlUpdate = createThriftValue(2, "node2", std::nullopt, 100, 3);
+  params.keyVals_ref()->emplace("key2", ttlUpdate);
+  params.nodeIds_ref() = std::vector<std::string>{"node1"};
+  params.senderId_ref() = "node1";
+  params.timestamp_ms_ref() = 1000;
+
+  auto serializedParams = serializeKeySetParams(params);
+  EXPECT_TRUE(serializedParams.keyVals_ref()->empty());
+  ASSERT_TRUE(serializedParams.serializedKeyVals_ref().has_value());
+  EXPECT_EQ(params.nodeIds_ref(), serializedParams.nodeIds_ref());
+  EXPECT_EQ(params.senderId_ref(), serializedParams.senderId_ref());
+  EXPECT_EQ(params.timestamp_ms_ref(), serializedParams.timestamp_ms_ref());
+
+  // key-vals restored as serialized
+  deserializeKeySetParams(serializedParams);
+  EXPECT_FALSE(serializedParams.serializedKeyVals_ref().has_value());
+  EXPECT_EQ(*params.keyVals_ref(), *serializedParams.keyVals_ref());
+
+  // no-op without serialized key-vals
+  deserializeKeySetParams(serializedParams);
+  EXPECT_EQ(*params.keyVals_ref(), *serializedParams.keyVals_ref());
+
+  // malformed
+  serializedParams.serializedKeyVals_ref() =
+      std::move(*folly::IOBuf::copyBuffer(std::string("\xff\xff")));
+  EXPECT_THROW(
+      deserializeKeySetParams(serializedParams), thrift::KvStoreError);
+}
+
 int
 main(int argc, char* argv[]) {
   // Parse command line flags
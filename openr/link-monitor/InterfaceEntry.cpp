@@ -5,6 +5,8 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <cmath>
+
 #include <folly/gen/Base.h>
 #include <folly/logging/xlog.h>
 
@@ -19,8 +21,10 @@ InterfaceEntry::InterfaceEntry(
     std::chrono::milliseconds const& initBackoff,
     std::chrono::milliseconds const& maxBackoff,
     AsyncThrottle& updateCallback,
-    folly::AsyncTimeout& updateTimeout)
+    folly::AsyncTimeout& updateTimeout,
+    std::optional<thrift::LinkFlapDampeningConfig> const& dampeningConfig)
     : backoff_(initBackoff, maxBackoff),
+      dampeningConfig_(dampeningConfig),
       updateCallback_(updateCallback),
       updateTimeout_(updateTimeout) {
   CHECK(not ifName.empty());
@@ -42,6 +46,7 @@ InterfaceEntry::updateAttrs(int ifIndex, bool isUp) {
   if (wasUp != isUp and wasUp) {
     // Penalize backoff on transitioning to DOWN state
     backoff_.reportError();
+    reportFlap();
   }
 
   // Look for active to down transition
@@ -67,12 +72,67 @@ InterfaceEntry::isActive() {
   if (now - lastErrorTime > backoff_.getMaxBackoff()) {
     backoff_.reportSuccess();
   }
-  return backoff_.canTryNow();
+  return backoff_.canTryNow() and not isFlapSuppressed();
 }
 
 std::chrono::milliseconds
 InterfaceEntry::getBackoffDuration() const {
-  return backoff_.getTimeRemainingUntilRetry();
+  auto backoff = backoff_.getTimeRemainingUntilRetry();
+  if (isFlapSuppressed()) {
+    // time for penalty to decay below reuse threshold
+    const auto& conf = *dampeningConfig_;
+    const auto suppressMs = *conf.half_life_ms_ref() *
+        std::log2(getFlapPenalty() / *conf.reuse_threshold_ref());
+    backoff = std::max(
+        backoff,
+        std::chrono::milliseconds(static_cast<int64_t>(std::ceil(suppressMs))));
+  }
+  return backoff;
+}
+
+double
+InterfaceEntry::getFlapPenalty() const {
+  if (not dampeningConfig_.has_value()) {
+    return 0;
+  }
+  const auto elapsedMs =
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::steady_clock::now() - flapPenaltyUpdateTime_)
+          .count();
+  return flapPenalty_ *
+      std::exp2(-static_cast<double>(elapsedMs) /
+                *dampeningConfig_->half_life_ms_ref());
+}
+
+bool
+InterfaceEntry::isFlapSuppressed() const {
+  // Suppression is cleared once penalty decays below reuse threshold
+  return isFlapSuppressed_ and
+      getFlapPenalty() >= *dampeningConfig_->reuse_threshold_ref();
+}
+
+void
+InterfaceEntry::reportFlap() {
+  if (not dampeningConfig_.has_value()) {
+    return;
+  }
+  const auto& conf = *dampeningConfig_;
+  const bool wasSuppressed = isFlapSuppressed();
+
+  // Cap penalty to the one decaying below reuse threshold in max suppress time
+  const double maxPenalty = *conf.reuse_threshold_ref() *
+      std::exp2(static_cast<double>(*conf.max_suppress_time_ms_ref()) /
+                *conf.half_life_ms_ref());
+  flapPenalty_ =
+      std::min(getFlapPenalty() + *conf.penalty_per_flap_ref(), maxPenalty);
+  flapPenaltyUpdateTime_ = std::chrono::steady_clock::now();
+  isFlapSuppressed_ =
+      wasSuppressed or flapPenalty_ >= *conf.suppress_threshold_ref();
+
+  XLOG_IF(INFO, isFlapSuppressed_ and not wasSuppressed) << fmt::format(
+      "Suppressing flapping interface {} with penalty {}",
+      info_.ifName,
+      flapPenalty_);
 }
 
 bool
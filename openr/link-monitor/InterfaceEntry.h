@@ -12,6 +12,7 @@
 #include <openr/common/AsyncThrottle.h>
 #include <openr/common/ExponentialBackoff.h>
 #include <openr/common/LsdbTypes.h>
+#include <openr/if/gen-cpp2/OpenrConfig_types.h>
 
 namespace openr {
 
@@ -23,6 +24,9 @@ namespace openr {
  * - Any change will always trigger throttled callback
  * - Interface transition from Active to Inactive schedules immediate timeout
  *   for fast reactions to down events.
+ * - If flap dampening is configured, every transition to DOWN state adds
+ *   penalty decaying with half-life. Interface is inactive while suppressed by
+ *   penalty, on top of exponential backoff.
  */
 class InterfaceEntry final {
  public:
@@ -31,7 +35,9 @@ class InterfaceEntry final {
       std::chrono::milliseconds const& initBackoff,
       std::chrono::milliseconds const& maxBackoff,
       AsyncThrottle& updateCallback,
-      folly::AsyncTimeout& updateTimeout);
+      folly::AsyncTimeout& updateTimeout,
+      std::optional<thrift::LinkFlapDampeningConfig> const& dampeningConfig =
+          std::nullopt);
 
   // Update attributes
   bool updateAttrs(int ifIndex, bool isUp);
@@ -43,9 +49,21 @@ class InterfaceEntry final {
   // it's not backed off
   bool isActive();
 
-  // Get backoff time
+  // Get backoff time, including remaining time suppressed by flap dampening
   std::chrono::milliseconds getBackoffDuration() const;
 
+  // Is flap dampening enabled for the interface
+  bool
+  isFlapDampeningEnabled() const {
+    return dampeningConfig_.has_value();
+  }
+
+  // Get accumulated flap penalty decayed till now
+  double getFlapPenalty() const;
+
+  // Is interface suppressed by flap dampening
+  bool isFlapSuppressed() const;
+
   // Used to check for updates if doing a re-sync
   bool
   operator==(const InterfaceEntry& interfaceEntry) {
@@ -87,9 +105,19 @@ class InterfaceEntry final {
   std::vector<folly::CIDRNetwork> getGlobalUnicastNetworks(bool enableV4) const;
 
  private:
+  // Penalize flap for dampening on transition to DOWN state
+  void reportFlap();
+
   // Backoff variables
   ExponentialBackoff<std::chrono::milliseconds> backoff_;
 
+  // Flap dampening variables. Penalty is decayed lazily from the time it was
+  // last updated.
+  std::optional<thrift::LinkFlapDampeningConfig> dampeningConfig_;
+  double flapPenalty_{0};
+  std::chrono::steady_clock::time_point flapPenaltyUpdateTime_;
+  bool isFlapSuppressed_{false};
+
   // Update callback
   AsyncThrottle& updateCallback_;
   folly::AsyncTimeout& updateTimeout_;
@@ -6,9 +6,11 @@
  */
 
 #include <fb303/ServiceData.h>
+#include <folly/executors/thread_factory/NamedThreadFactory.h>
 #include <folly/logging/xlog.h>
 
 #include <openr/common/Constants.h>
+#include <openr/common/ConvergenceTracer.h>
 #include <openr/common/EventLogger.h>
 #include <openr/common/LsdbUtil.h>
 #include <openr/common/NetworkUtil.h>
@@ -108,11 +110,22 @@ LinkMonitor::LinkMonitor(
       prefixForwardingAlgorithm_(
           *config->getConfig().prefix_forwarding_algorithm_ref()),
       useRttMetric_(*config->getLinkMonitorConfig().use_rtt_metric_ref()),
+      rttMetricMinChangePct_(
+          *config->getLinkMonitorConfig().rtt_metric_min_change_pct_ref()),
+      rttMetricDwellTime_(std::chrono::milliseconds(
+          *config->getLinkMonitorConfig().rtt_metric_dwell_time_ms_ref())),
+      rttMetricEwmaWeight_(
+          *config->getLinkMonitorConfig().rtt_metric_ewma_weight_pct_ref() /
+          100.0),
       linkflapInitBackoff_(std::chrono::milliseconds(
           *config->getLinkMonitorConfig().linkflap_initial_backoff_ms_ref())),
       linkflapMaxBackoff_(std::chrono::milliseconds(
           *config->getLinkMonitorConfig().linkflap_max_backoff_ms_ref())),
+      linkflapDampeningConfig_(config->getLinkMonitorConfig()
+                                   .linkflap_dampening_config_ref()
+                                   .to_optional()),
       areas_(config->getAreas()),
+      interfaceRegexMatcher_(config->getInterfaceRegexMatcher()),
       enableOrderedAdjPublication_(
           *config->getConfig().enable_ordered_adj_publication_ref()),
       interfaceUpdatesQueue_(interfaceUpdatesQueue),
@@ -127,6 +140,13 @@ LinkMonitor::LinkMonitor(
   CHECK(configStore_);
   CHECK(nlSock_);
 
+  if (auto numThreads = *config->getLinkMonitorConfig()
+                             .adj_db_serialize_num_threads_ref()) {
+    adjDbSerializeExecutor_ = std::make_unique<folly::CPUThreadPoolExecutor>(
+        numThreads,
+        std::make_shared<folly::NamedThreadFactory>("LinkMonitorAdjDb"));
+  }
+
   // Hold time for synchronizing adjacencies in KvStore. We expect all the
   // adjacencies to be fully established within hold time after Open/R starts.
   // TODO: remove this with strict Open/R initialization sequence
@@ -158,6 +178,10 @@ LinkMonitor::LinkMonitor(
   advertiseIfaceAddrTimer_ = folly::AsyncTimeout::make(
       *getEvb(), [this]() noexcept { advertiseIfaceAddr(); });
 
+  // Create timer to apply rtt metric changes deferred by dwell time
+  rttMetricDwellTimer_ = folly::AsyncTimeout::make(
+      *getEvb(), [this]() noexcept { processPendingRttMetricChanges(); });
+
   // Create config-store client
   XLOG(INFO) << "Loading link-monitor state";
   auto state =
@@ -209,6 +233,9 @@ LinkMonitor::LinkMonitor(
     }
   }
 
+  // publish initial interface snapshot with loaded drain state
+  updateInterfaceSnapshot();
+
   // start initial dump timer
   adjHoldTimer_->scheduleTimeout(initialAdjHoldTime);
 
@@ -274,9 +301,23 @@ LinkMonitor::LinkMonitor(
   fb303::fbData->addStatExportType("link_monitor.neighbor_down", fb303::SUM);
   fb303::fbData->addStatExportType(
       "link_monitor.advertise_adjacencies", fb303::SUM);
+  fb303::fbData->addStatExportType(
+      "link_monitor.advertise_adjacencies.skipped", fb303::SUM);
+  fb303::fbData->addStatExportType(
+      "link_monitor.adjacencies_rebuilt", fb303::SUM);
+  fb303::fbData->addStatExportType(
+      "link_monitor.rtt_metric_change.applied", fb303::SUM);
+  fb303::fbData->addStatExportType(
+      "link_monitor.rtt_metric_change.suppressed", fb303::SUM);
+  fb303::fbData->addStatExportType(
+      "link_monitor.rtt_metric_change.deferred", fb303::SUM);
   fb303::fbData->addStatExportType("link_monitor.advertise_links", fb303::SUM);
   fb303::fbData->addStatExportType(
       "link_monitor.sync_interface.failure", fb303::SUM);
+  fb303::fbData->addStatExportType(
+      "link_monitor.sync_interface.full_dump", fb303::SUM);
+  fb303::fbData->addStatExportType(
+      "link_monitor.sync_interface.skipped", fb303::SUM);
 }
 
 void
@@ -349,9 +390,8 @@ LinkMonitor::neighborUpEvent(
   } else {
     // use inproc address
     repUrl = fmt::format("inproc://{}-kvstore-cmd-global", remoteNodeName);
-    // TODO: address value of peerAddr under system test environment
-    peerAddr =
-        fmt::format("{}%{}", Constants::kPlatformHost.toString(), localIfName);
+    // KvStore of all mocked instances serves thrift on local host
+    peerAddr = Constants::kPlatformHost.toString();
   }
 
   CHECK(not repUrl.empty()) << "Got empty repUrl";
@@ -366,14 +406,15 @@ LinkMonitor::neighborUpEvent(
   // TODO: remove `isRestarting` flag once enable_ordered_adj_publication is
   // fully rolled out to PROD.
   bool isRestarting{false};
-  if (enableNewGRBehavior_) {
-    const auto& areaAdjacencies = adjacencies_.find(area);
-    if (areaAdjacencies != adjacencies_.end()) {
-      const auto& oldAdj = areaAdjacencies->second.find(adjId);
-      if (oldAdj != areaAdjacencies->second.end() and
-          oldAdj->second.isRestarting) {
-        isRestarting = true;
-      }
+  // Adjacency advertised before neighbor started GR
+  std::optional<thrift::Adjacency> restartingAdj;
+  const auto& areaAdjacencies = adjacencies_.find(area);
+  if (areaAdjacencies != adjacencies_.end()) {
+    const auto& oldAdj = areaAdjacencies->second.find(adjId);
+    if (oldAdj != areaAdjacencies->second.end() and
+        oldAdj->second.isRestarting) {
+      isRestarting = enableNewGRBehavior_;
+      restartingAdj = buildAdjacency(oldAdj->second);
     }
   }
 
@@ -392,9 +433,36 @@ LinkMonitor::neighborUpEvent(
       useRttMetric_ ? getRttMetric(rttUs) : 1, // baseMetric
       isRestarting,
       isGracefulRestart ? false : onlyUsedByOtherNode);
+  auto& adjValue = adjacencies_[area][adjId];
+  adjValue.smoothedRttUs = rttUs;
 
   // update kvstore peer
-  updateKvStorePeerNeighborUp(area, adjId, adjacencies_[area][adjId]);
+  updateKvStorePeerNeighborUp(area, adjId, adjValue);
+
+  // Adjacency coming back from GR is expected to be identical. Retain the
+  // advertised one, as fresh timestamp/rtt alone would lead to readvertisement
+  // and SPF computation across the area.
+  if (restartingAdj.has_value() and
+      not shouldSkipAdjAnnouncement(adjId, adjValue)) {
+    auto adj = buildAdjacency(adjValue);
+    adj.timestamp_ref() = *restartingAdj->timestamp_ref();
+    adj.rtt_ref() = *restartingAdj->rtt_ref();
+    if (adj == *restartingAdj) {
+      XLOG(INFO) << fmt::format(
+          "Adjacency [{}, {}] is unchanged after graceful restart. "
+          "Skip readvertisement in area: {}",
+          remoteNodeName,
+          localIfName,
+          area);
+      adjValue.adjacency.timestamp_ref() = *restartingAdj->timestamp_ref();
+      adjValue.adjacency.rtt_ref() = *restartingAdj->rtt_ref();
+      fb303::fbData->addStatValue(
+          "link_monitor.gr_readvertisement.suppressed", 1, fb303::SUM);
+      return;
+    }
+  }
+
+  markAdjacencyChanged(area, adjId);
 
   // Advertise new adjancies in a throttled fashion
   advertiseAdjacenciesThrottled_->operator()();
@@ -436,6 +504,7 @@ LinkMonitor::neighborAdjSyncedEvent(const NeighborEvent& event) {
 
   // reset flag to indicate adjacency can be used by everyone
   adjIt->second.onlyUsedByOtherNode = false;
+  markAdjacencyChanged(area, adjId);
 
   // advertise new adjacencies in a throttled fashion
   advertiseAdjacenciesThrottled_->operator()();
@@ -469,6 +538,7 @@ LinkMonitor::neighborDownEvent(const NeighborEvent& event) {
 
   // remove such adjacencies
   adjacencies_[area].erase(adjValueIt);
+  markAdjacencyChanged(area, adjId);
 
   // advertise adjacencies
   advertiseAdjacencies(area);
@@ -500,6 +570,7 @@ LinkMonitor::neighborRestartingEvent(const NeighborEvent& event) {
 
   // update adjacencies_ restarting-bit and advertise peers
   adjValueIt->second.isRestarting = true;
+  markAdjacencyChanged(area, adjId);
 
   // update KvStore Peer
   updateKvStorePeerNeighborDown(area, adjId, adjValueIt->second);
@@ -510,21 +581,104 @@ LinkMonitor::neighborRttChangeEvent(const NeighborEvent& event) {
   const auto& remoteNodeName = event.remoteNodeName;
   const auto& localIfName = event.localIfName;
   const auto& rttUs = event.rttUs;
-  int32_t newRttMetric = getRttMetric(rttUs);
   const auto& area = event.area;
 
-  XLOG(DBG1) << "Metric value changed for neighbor " << remoteNodeName
-             << " on interface: " << localIfName << " to " << newRttMetric;
+  // metric is not derived from rtt, nothing to update
+  if (not useRttMetric_) {
+    return;
+  }
+
+  XLOG(DBG1) << "RTT changed for neighbor " << remoteNodeName
+             << " on interface: " << localIfName << " to " << rttUs << "us";
 
   auto areaAdjIt = adjacencies_.find(area);
   if (areaAdjIt != adjacencies_.end()) {
     auto it = areaAdjIt->second.find({remoteNodeName, localIfName});
     if (it != areaAdjIt->second.end()) {
-      auto& adj = it->second.adjacency;
-      adj.metric_ref() = newRttMetric;
-      adj.rtt_ref() = rttUs;
-      advertiseAdjacenciesThrottled_->operator()();
+      auto& adjValue = it->second;
+      // smooth out rtt noise with EWMA
+      adjValue.smoothedRttUs = rttMetricEwmaWeight_ * rttUs +
+          (1 - rttMetricEwmaWeight_) * adjValue.smoothedRttUs;
+      if (maybeApplyRttMetricChange(it->first, adjValue)) {
+        advertiseAdjacenciesThrottled_->operator()();
+      }
+    }
+  }
+}
+
+bool
+LinkMonitor::maybeApplyRttMetricChange(
+    const AdjacencyKey& adjKey, AdjacencyValue& adjValue) {
+  const auto rttUs = static_cast<int64_t>(adjValue.smoothedRttUs);
+  const auto newRttMetric = getRttMetric(rttUs);
+  const auto oldRttMetric = adjValue.baseMetric;
+  adjValue.isRttMetricChangePending = false;
+
+  // hysteresis: suppress change smaller than configured percentage
+  if (newRttMetric == oldRttMetric or
+      std::abs(newRttMetric - oldRttMetric) * 100 <
+          rttMetricMinChangePct_ * oldRttMetric) {
+    XLOG(DBG2) << fmt::format(
+        "Suppress rtt metric change from {} to {} for neighbor {} on interface: {}",
+        oldRttMetric,
+        newRttMetric,
+        adjKey.first,
+        adjKey.second);
+    fb303::fbData->addStatValue(
+        "link_monitor.rtt_metric_change.suppressed", 1, fb303::SUM);
+    return false;
+  }
+
+  // dwell time: defer change till it has passed since last applied one
+  const auto now = std::chrono::steady_clock::now();
+  const auto dwellEnd = adjValue.lastRttMetricChange + rttMetricDwellTime_;
+  if (now < dwellEnd) {
+    adjValue.isRttMetricChangePending = true;
+    // fire on earliest expiry of all deferred changes
+    if ((not rttMetricDwellTimer_->isScheduled()) or
+        dwellEnd < rttMetricDwellTimerExpiry_) {
+      const auto timeout =
+          std::chrono::duration_cast<std::chrono::milliseconds>(dwellEnd - now);
+      rttMetricDwellTimer_->scheduleTimeout(
+          std::max(timeout, std::chrono::milliseconds(1)));
+      rttMetricDwellTimerExpiry_ = dwellEnd;
     }
+    fb303::fbData->addStatValue(
+        "link_monitor.rtt_metric_change.deferred", 1, fb303::SUM);
+    return false;
+  }
+
+  XLOG(INFO) << fmt::format(
+      "Metric value changed for neighbor {} on interface: {} from {} to {}",
+      adjKey.first,
+      adjKey.second,
+      oldRttMetric,
+      newRttMetric);
+  fb303::fbData->addStatValue(
+      "link_monitor.rtt_metric_change.applied", 1, fb303::SUM);
+
+  adjValue.baseMetric = newRttMetric;
+  adjValue.adjacency.metric_ref() = newRttMetric;
+  adjValue.adjacency.rtt_ref() = rttUs;
+  adjValue.lastRttMetricChange = now;
+  markAdjacencyChanged(adjValue.area, adjKey);
+  return true;
+}
+
+void
+LinkMonitor::processPendingRttMetricChanges() {
+  // Apply all deferred changes at once, to be advertised together
+  bool isChanged{false};
+  for (auto& [_, areaAdjacencies] : adjacencies_) {
+    for (auto& [adjKey, adjValue] : areaAdjacencies) {
+      if (adjValue.isRttMetricChangePending) {
+        // NOTE: reschedules dwell timer for changes not yet due
+        isChanged |= maybeApplyRttMetricChange(adjKey, adjValue);
+      }
+    }
+  }
+  if (isChanged) {
+    advertiseAdjacenciesThrottled_->operator()();
   }
 }
 
@@ -559,6 +713,8 @@ LinkMonitor::processKvStoreSyncEvent(KvStoreSyncEvent&& event) {
 
   // update adjacency status
   for (const auto& adjId : peerVal->second.establishedSparkNeighbors) {
+    // announcement of adjacency is no longer skipped
+    markAdjacencyChanged(area, adjId);
     auto areaAdjIt = adjacencies_.find(area);
     if (areaAdjIt != adjacencies_.end()) {
       auto it = areaAdjIt->second.find(adjId);
@@ -620,9 +776,7 @@ LinkMonitor::updateKvStorePeerNeighborUp(
   peersToAdd.emplace(remoteNodeName, adjVal.peerSpec);
   logPeerEvent("ADD_PEER", remoteNodeName, adjVal.peerSpec);
 
-  PeerEvent event;
-  event.emplace(area, AreaPeerEvent(peersToAdd, {} /*peersToDel*/));
-  peerUpdatesQueue_.push(std::move(event));
+  publishPeerEvent(area, std::move(peersToAdd), {} /* peersToDel */);
 }
 
 void
@@ -662,10 +816,7 @@ LinkMonitor::updateKvStorePeerNeighborDown(
 
     // send peer del event
     std::vector<std::string> peersToDel{remoteNodeName};
-
-    PeerEvent event;
-    event.emplace(area, AreaPeerEvent({} /* peersToAdd */, peersToDel));
-    peerUpdatesQueue_.push(std::move(event));
+    publishPeerEvent(area, {} /* peersToAdd */, std::move(peersToDel));
 
     // remove kvstore peer from internal store.
     areaPeers->second.erase(remoteNodeName);
@@ -691,43 +842,191 @@ LinkMonitor::updateKvStorePeerNeighborDown(
 
   thrift::PeersMap peersToAdd;
   peersToAdd.emplace(remoteNodeName, peer.tPeerSpec);
-  PeerEvent event;
-  event.emplace(area, AreaPeerEvent(peersToAdd, {} /* peersToDel */));
-  peerUpdatesQueue_.push(std::move(event));
+  publishPeerEvent(area, std::move(peersToAdd), {} /* peersToDel */);
+}
+
+void
+LinkMonitor::publishPeerEvent(
+    const std::string& area,
+    thrift::PeersMap&& peersToAdd,
+    std::vector<std::string>&& peersToDel) {
+  if (not neighborEventBatch_.has_value()) {
+    PeerEvent event;
+    event.emplace(
+        area, AreaPeerEvent(std::move(peersToAdd), std::move(peersToDel)));
+    peerUpdatesQueue_.push(std::move(event));
+    return;
+  }
+
+  // ATTN: KvStore adds peers of an event before deleting them. A peer deleted
+  // and added again within batch must be deleted first to reset its session,
+  // hence batch collected so far is published before such addition.
+  auto getAreaEvent = [this, &area]() {
+    return &neighborEventBatch_->peerEvent
+                .try_emplace(
+                    area,
+                    thrift::PeersMap{} /* peersToAdd */,
+                    std::vector<std::string>{} /* peersToDel */)
+                .first->second;
+  };
+  auto* areaEvent = getAreaEvent();
+  for (const auto& [peerName, _] : peersToAdd) {
+    auto& dels = areaEvent->peersToDel;
+    if (std::find(dels.begin(), dels.end(), peerName) != dels.end()) {
+      peerUpdatesQueue_.push(std::move(neighborEventBatch_->peerEvent));
+      neighborEventBatch_->peerEvent.clear();
+      areaEvent = getAreaEvent();
+      break;
+    }
+  }
+  for (auto& [peerName, peerSpec] : peersToAdd) {
+    areaEvent->peersToAdd.insert_or_assign(peerName, std::move(peerSpec));
+  }
+  for (auto& peerName : peersToDel) {
+    areaEvent->peersToAdd.erase(peerName);
+    auto& dels = areaEvent->peersToDel;
+    if (std::find(dels.begin(), dels.end(), peerName) == dels.end()) {
+      dels.emplace_back(std::move(peerName));
+    }
+  }
 }
 
 void
 LinkMonitor::advertiseAdjacencies(const std::string& area) {
+  advertiseAdjacencies(std::vector<std::string>{area});
+}
+
+void
+LinkMonitor::advertiseAdjacencies() {
+  // advertise to all areas. Once area configuration per link is implemented
+  // then adjacencies can be advertised to a specific area
+  std::vector<std::string> areas;
+  areas.reserve(areas_.size());
+  for (const auto& [areaId, _] : areas_) {
+    areas.emplace_back(areaId);
+  }
+  advertiseAdjacencies(areas);
+}
+
+void
+LinkMonitor::advertiseAdjacencies(const std::vector<std::string>& areas) {
   if (adjHoldTimer_->isScheduled()) {
     return;
   }
 
+  // Advertise once all neighbor events of batch are processed
+  if (neighborEventBatch_.has_value()) {
+    neighborEventBatch_->areasToAdvertise.insert(areas.begin(), areas.end());
+    return;
+  }
+
   // Cancel throttle timeout if scheduled
   if (advertiseAdjacenciesThrottled_->isActive()) {
     advertiseAdjacenciesThrottled_->cancel();
   }
 
-  // Extract information from `adjacencies_`
-  auto adjDb = buildAdjacencyDatabase(area);
+  struct AreaAdjDb {
+    thrift::AdjacencyDatabase adjDb;
+    std::optional<size_t> advertisedHash;
+    // Serialized `adjDb`, left empty if unchanged since last advertisement
+    std::string adjDbStr;
+    size_t adjDbHash{0};
+  };
+
+  // Extract information from `adjacencies_`. Caches are owned by LinkMonitor
+  // thread, hence databases are built here.
+  std::vector<AreaAdjDb> areaAdjDbs(areas.size());
+  for (size_t i = 0; i < areas.size(); ++i) {
+    areaAdjDbs[i].adjDb = buildAdjacencyDatabase(areas[i]);
+    areaAdjDbs[i].advertisedHash = adjDbCaches_[areas[i]].advertisedHash;
+  }
 
-  XLOG(INFO) << fmt::format(
-      "Updating adjacency database in KvStore with {} entries in area: {}",
-      adjDb.adjacencies_ref()->size(),
-      area);
+  // Skip advertisement if nothing has changed since last one. Perf events
+  // carry timestamp of this build, hence are excluded from comparison.
+  const auto serializeAdjDb = [this](AreaAdjDb& areaAdjDb) {
+    apache::thrift::CompactSerializer serializer;
+    auto& adjDb = areaAdjDb.adjDb;
+    auto perfEvents = adjDb.perfEvents_ref().to_optional();
+    adjDb.perfEvents_ref().reset();
+    auto adjDbStr = writeThriftObjStr(adjDb, serializer);
+    areaAdjDb.adjDbHash = std::hash<std::string>{}(adjDbStr);
+    if (areaAdjDb.advertisedHash == areaAdjDb.adjDbHash) {
+      return;
+    }
+    if (perfEvents.has_value()) {
+      addPerfEvent(perfEvents.value(), nodeId_, "ADJ_DB_SERIALIZED");
+      ConvergenceTracer::record(perfEvents.value(), "ADJ_DB_SERIALIZED");
+      adjDb.perfEvents_ref() = std::move(perfEvents.value());
+      adjDbStr = writeThriftObjStr(adjDb, serializer);
+    }
+    areaAdjDb.adjDbStr = std::move(adjDbStr);
+  };
+
+  if (adjDbSerializeExecutor_ and areaAdjDbs.size() > 1) {
+    std::vector<folly::Future<folly::Unit>> futures;
+    futures.reserve(areaAdjDbs.size());
+    for (auto& areaAdjDb : areaAdjDbs) {
+      futures.emplace_back(folly::via(
+          adjDbSerializeExecutor_.get(),
+          [&serializeAdjDb, &areaAdjDb]() { serializeAdjDb(areaAdjDb); }));
+    }
+    folly::collect(std::move(futures)).get();
+  } else {
+    for (auto& areaAdjDb : areaAdjDbs) {
+      serializeAdjDb(areaAdjDb);
+    }
+  }
 
-  // Persist `adj:node_Id` key into KvStore
+  // Persist `adj:node_Id` key of all changed areas into KvStore together
   const auto keyName = Constants::kAdjDbMarker.toString() + nodeId_;
-  std::string adjDbStr = writeThriftObjStr(adjDb, serializer_);
-  auto persistAdjacencyKeyVal =
-      PersistKeyValueRequest(AreaId{area}, keyName, adjDbStr);
-  kvRequestQueue_.push(std::move(persistAdjacencyKeyVal));
+  size_t numAdvertised{0};
+  for (size_t i = 0; i < areas.size(); ++i) {
+    const auto& area = areas[i];
+    auto& areaAdjDb = areaAdjDbs[i];
+    if (areaAdjDb.adjDbStr.empty()) {
+      XLOG(DBG2) << fmt::format(
+          "Skip updating unchanged adjacency database in area: {}", area);
+      fb303::fbData->addStatValue(
+          "link_monitor.advertise_adjacencies.skipped", 1, fb303::SUM);
+      continue;
+    }
+    adjDbCaches_[area].advertisedHash = areaAdjDb.adjDbHash;
+
+    XLOG(INFO) << fmt::format(
+        "Updating adjacency database in KvStore with {} entries in area: {}",
+        areaAdjDb.adjDb.adjacencies_ref()->size(),
+        area);
+    if (const auto& perfEvents = areaAdjDb.adjDb.perfEvents_ref()) {
+      const auto duration = getDurationBetweenPerfEvents(
+          *perfEvents, "ADJ_DB_UPDATED", "ADJ_DB_SERIALIZED");
+      if (duration.hasValue()) {
+        XLOG(DBG2) << fmt::format(
+            "Serialized adjacency database of area: {} in {}ms",
+            area,
+            duration->count());
+      }
+    }
+
+    std::vector<int64_t> traceIds;
+    if (const auto& perfEvents = areaAdjDb.adjDb.perfEvents_ref()) {
+      traceIds = *perfEvents->traceIds_ref();
+    }
+    kvRequestQueue_.push(PersistKeyValueRequest(
+        AreaId{area}, keyName, areaAdjDb.adjDbStr, std::move(traceIds)));
+    ++numAdvertised;
+  }
 
-  // Config is most likely to have changed. Update it in `ConfigStore`
+  // Config is most likely to have changed, or may have changed without
+  // affecting advertised adjacencies. Update it in `ConfigStore`
   configStore_->storeThriftObj(kConfigKey, state_); // not awaiting on result
 
+  if (numAdvertised == 0) {
+    return;
+  }
+
   // Update some flat counters
   fb303::fbData->addStatValue(
-      "link_monitor.advertise_adjacencies", 1, fb303::SUM);
+      "link_monitor.advertise_adjacencies", numAdvertised, fb303::SUM);
   fb303::fbData->setCounter("link_monitor.adjacencies", getTotalAdjacencies());
   for (const auto& [_, areaAdjacencies] : adjacencies_) {
     for (const auto& [_, adjValue] : areaAdjacencies) {
@@ -737,15 +1036,6 @@ LinkMonitor::advertiseAdjacencies(const std::string& area) {
     }
   }
 }
-void
-LinkMonitor::advertiseAdjacencies() {
-  // advertise to all areas. Once area configuration per link is implemented
-  // then adjacencies can be advertised to a specific area
-  for (const auto& [areaId, _] : areas_) {
-    // Update KvStore
-    advertiseAdjacencies(areaId);
-  }
-}
 
 void
 LinkMonitor::advertiseIfaceAddr() {
@@ -772,11 +1062,15 @@ void
 LinkMonitor::advertiseInterfaces() {
   fb303::fbData->addStatValue("link_monitor.advertise_links", 1, fb303::SUM);
 
+  // Make interface changes visible to readers before consumers act on them
+  updateInterfaceSnapshot();
+
   // Create interface database
   InterfaceDatabase ifDb;
   for (auto& [_, interface] : interfaces_) {
     // Perform regex match
-    if (not anyAreaShouldDiscoverOnIface(interface.getIfName())) {
+    if (getInterfaceMatch(interface.getIfIndex(), interface.getIfName())
+            .discoverAreas.empty()) {
       continue;
     }
     // Transform to `InterfaceInfo` object
@@ -808,12 +1102,9 @@ LinkMonitor::advertiseRedistAddrs() {
     }
 
     // Derive list of area to advertise (NOTE: areas are ordered persistently)
-    std::vector<std::string> dstAreas;
-    for (auto const& [areaId, areaConf] : areas_) {
-      if (areaConf.shouldRedistributeIface(interface.getIfName())) {
-        dstAreas.emplace_back(areaId);
-      }
-    }
+    const auto& dstAreas =
+        getInterfaceMatch(interface.getIfIndex(), interface.getIfName())
+            .redistributeAreas;
 
     // Do not advertise interface addresses if no destination area qualifies
     if (dstAreas.empty()) {
@@ -906,7 +1197,18 @@ LinkMonitor::advertiseRedistAddrs() {
 std::chrono::milliseconds
 LinkMonitor::getRetryTimeOnUnstableInterfaces() {
   std::chrono::milliseconds minRemainMs{0};
+  int64_t numSuppressed{0};
   for (auto& [_, interface] : interfaces_) {
+    if (interface.isFlapDampeningEnabled()) {
+      const bool isSuppressed = interface.isFlapSuppressed();
+      numSuppressed += isSuppressed ? 1 : 0;
+      fb303::fbData->setCounter(
+          "link_monitor.link_flap_penalty." + interface.getIfName(),
+          static_cast<int64_t>(interface.getFlapPenalty()));
+      fb303::fbData->setCounter(
+          "link_monitor.link_flap_suppressed." + interface.getIfName(),
+          isSuppressed ? 1 : 0);
+    }
     if (interface.isActive()) {
       continue;
     }
@@ -918,6 +1220,8 @@ LinkMonitor::getRetryTimeOnUnstableInterfaces() {
       minRemainMs = std::min(linkflapMaxBackoff_, curRemainMs);
     }
   }
+  fb303::fbData->setCounter(
+      "link_monitor.link_flap_suppressed_interfaces", numSuppressed);
 
   return minRemainMs;
 }
@@ -969,67 +1273,69 @@ LinkMonitor::buildAdjacencyDatabase(const std::string& area) {
 
   // populate thrift::AdjacencyDatabase.adjacencies based on
   // various condition.
+  auto& adjDbCache = adjDbCaches_[area];
   auto areaAdjIt = adjacencies_.find(area);
-  if (areaAdjIt != adjacencies_.end()) {
-    for (auto& [adjKey, adjValue] : areaAdjIt->second) {
-      if (shouldSkipAdjAnnouncement(adjKey, adjValue)) {
-        LOG(INFO) << fmt::format(
-            "Skip announcement of adjKey: [{}, {}] without initial sync.",
-            adjKey.first,
-            adjKey.second);
-        continue;
-      }
 
-      // NOTE: copy on purpose
-      auto adj = folly::copy(adjValue.adjacency);
-
-      // set link overload bit
-      adj.isOverloaded_ref() =
-          state_.overloadedLinks_ref()->count(*adj.ifName_ref()) > 0;
-
-      // Calculate the adj metric - there are three types of metric, which can
-      // be potentially combined:
-      // 1. base metric derived from RTT or default hop-count metric.
-      //    ATTN: link-metirc/adj-metric override can ONLY override base metric,
-      //          and adj-metric override can overrice link-metric override.
-      // 2. node-level incremental metric;
-      // 3. link-level incremental metric.
-      int32_t metric = adjValue.baseMetric;
-
-      // override metric with link metric if it exists
-      metric = folly::get_default(
-          *state_.linkMetricOverrides_ref(),
-          *adj.ifName_ref(),
-          adjValue.baseMetric);
-
-      // override metric with adj metric if it exists
-      thrift::AdjKey tAdjKey;
-      tAdjKey.nodeName_ref() = *adj.otherNodeName_ref();
-      tAdjKey.ifName_ref() = *adj.ifName_ref();
-      metric =
-          folly::get_default(*state_.adjMetricOverrides_ref(), tAdjKey, metric);
-
-      // increment the node-level metric
-      metric += *state_.nodeMetricIncrementVal_ref();
-
-      // increment the link-level metric
-      if (state_.linkMetiricIncrementMap_ref()->count(*adj.ifName_ref())) {
-        metric += state_.linkMetiricIncrementMap_ref()[*adj.ifName_ref()];
+  // link overload bit and metric overrides/increments apply to all
+  // adjacencies, rebuild every one of them once any has changed
+  const auto& cachedState = adjDbCache.state;
+  if ((not cachedState.has_value()) or
+      *cachedState->overloadedLinks_ref() != *state_.overloadedLinks_ref() or
+      *cachedState->linkMetricOverrides_ref() !=
+          *state_.linkMetricOverrides_ref() or
+      *cachedState->adjMetricOverrides_ref() !=
+          *state_.adjMetricOverrides_ref() or
+      *cachedState->nodeMetricIncrementVal_ref() !=
+          *state_.nodeMetricIncrementVal_ref() or
+      *cachedState->linkMetiricIncrementMap_ref() !=
+          *state_.linkMetiricIncrementMap_ref()) {
+    adjDbCache.adjacencies.clear();
+    adjDbCache.changedAdjKeys.clear();
+    if (areaAdjIt != adjacencies_.end()) {
+      for (const auto& [adjKey, _] : areaAdjIt->second) {
+        adjDbCache.changedAdjKeys.emplace(adjKey);
       }
+    }
+    adjDbCache.state = state_;
+  }
 
-      adj.metric_ref() = metric;
-
-      // set flag to indicate if adjacency will ONLY be used by other node
-      adj.adjOnlyUsedByOtherNode_ref() = adjValue.onlyUsedByOtherNode;
-
-      adjDb.adjacencies_ref()->emplace_back(std::move(adj));
+  for (const auto& adjKey : adjDbCache.changedAdjKeys) {
+    adjDbCache.adjacencies.erase(adjKey);
+    if (areaAdjIt == adjacencies_.end()) {
+      continue;
+    }
+    auto adjIt = areaAdjIt->second.find(adjKey);
+    if (adjIt == areaAdjIt->second.end()) {
+      continue;
     }
+    if (shouldSkipAdjAnnouncement(adjKey, adjIt->second)) {
+      LOG(INFO) << fmt::format(
+          "Skip announcement of adjKey: [{}, {}] without initial sync.",
+          adjKey.first,
+          adjKey.second);
+      continue;
+    }
+    adjDbCache.adjacencies.emplace(adjKey, buildAdjacency(adjIt->second));
+  }
+  fb303::fbData->addStatValue(
+      "link_monitor.adjacencies_rebuilt",
+      adjDbCache.changedAdjKeys.size(),
+      fb303::SUM);
+  adjDbCache.changedAdjKeys.clear();
+
+  adjDb.adjacencies_ref()->reserve(adjDbCache.adjacencies.size());
+  for (const auto& [_, adj] : adjDbCache.adjacencies) {
+    adjDb.adjacencies_ref()->emplace_back(adj);
   }
 
   // Add perf information if enabled
   if (enablePerfMeasurement_) {
     thrift::PerfEvents perfEvents;
     addPerfEvent(perfEvents, nodeId_, "ADJ_DB_UPDATED");
+    // every rebuild starts a convergence trace
+    const auto traceId = ConvergenceTracer::newTraceId();
+    perfEvents.traceIds_ref()->emplace_back(traceId);
+    ConvergenceTracer::record(traceId, "ADJ_DB_UPDATED");
     adjDb.perfEvents_ref() = perfEvents;
   } else {
     DCHECK(!adjDb.perfEvents_ref().has_value());
@@ -1038,11 +1344,64 @@ LinkMonitor::buildAdjacencyDatabase(const std::string& area) {
   return adjDb;
 }
 
+thrift::Adjacency
+LinkMonitor::buildAdjacency(const AdjacencyValue& adjValue) const {
+  // NOTE: copy on purpose
+  auto adj = folly::copy(adjValue.adjacency);
+
+  // set link overload bit
+  adj.isOverloaded_ref() =
+      state_.overloadedLinks_ref()->count(*adj.ifName_ref()) > 0;
+
+  // Calculate the adj metric - there are three types of metric, which can
+  // be potentially combined:
+  // 1. base metric derived from RTT or default hop-count metric.
+  //    ATTN: link-metirc/adj-metric override can ONLY override base metric,
+  //          and adj-metric override can overrice link-metric override.
+  // 2. node-level incremental metric;
+  // 3. link-level incremental metric.
+  int32_t metric = adjValue.baseMetric;
+
+  // override metric with link metric if it exists
+  metric = folly::get_default(
+      *state_.linkMetricOverrides_ref(),
+      *adj.ifName_ref(),
+      adjValue.baseMetric);
+
+  // override metric with adj metric if it exists
+  thrift::AdjKey tAdjKey;
+  tAdjKey.nodeName_ref() = *adj.otherNodeName_ref();
+  tAdjKey.ifName_ref() = *adj.ifName_ref();
+  metric =
+      folly::get_default(*state_.adjMetricOverrides_ref(), tAdjKey, metric);
+
+  // increment the node-level metric
+  metric += *state_.nodeMetricIncrementVal_ref();
+
+  // increment the link-level metric
+  metric += folly::get_default(
+      *state_.linkMetiricIncrementMap_ref(), *adj.ifName_ref(), 0);
+
+  adj.metric_ref() = metric;
+
+  // set flag to indicate if adjacency will ONLY be used by other node
+  adj.adjOnlyUsedByOtherNode_ref() = adjValue.onlyUsedByOtherNode;
+
+  return adj;
+}
+
+void
+LinkMonitor::markAdjacencyChanged(
+    const std::string& area, const AdjacencyKey& adjKey) {
+  adjDbCaches_[area].changedAdjKeys.emplace(adjKey);
+}
+
 InterfaceEntry* FOLLY_NULLABLE
-LinkMonitor::getOrCreateInterfaceEntry(const std::string& ifName) {
+LinkMonitor::getOrCreateInterfaceEntry(
+    int ifIndex, const std::string& ifName) {
   // Return null if ifName doesn't quality regex match criteria
-  if (not anyAreaShouldDiscoverOnIface(ifName) &&
-      not anyAreaShouldRedistributeIface(ifName)) {
+  const auto& match = getInterfaceMatch(ifIndex, ifName);
+  if (match.discoverAreas.empty() && match.redistributeAreas.empty()) {
     return nullptr;
   }
 
@@ -1060,11 +1419,25 @@ LinkMonitor::getOrCreateInterfaceEntry(const std::string& ifName) {
           linkflapInitBackoff_,
           linkflapMaxBackoff_,
           *advertiseIfaceAddrThrottled_,
-          *advertiseIfaceAddrTimer_));
+          *advertiseIfaceAddrTimer_,
+          linkflapDampeningConfig_));
 
   return &(res.first->second);
 }
 
+const InterfaceRegexMatcher::Result&
+LinkMonitor::getInterfaceMatch(int ifIndex, const std::string& ifName) {
+  auto it = ifIndexToMatch_.find(ifIndex);
+  if (it == ifIndexToMatch_.end() or it->second.first != ifName) {
+    // new or renamed interface
+    it = ifIndexToMatch_.insert_or_assign(
+        it,
+        ifIndex,
+        std::make_pair(ifName, interfaceRegexMatcher_->match(ifName)));
+  }
+  return it->second.second;
+}
+
 void
 LinkMonitor::syncInterfaceTask() noexcept {
   XLOG(INFO) << "[Interface Sync] Starting interface syncing fiber task";
@@ -1081,7 +1454,20 @@ LinkMonitor::syncInterfaceTask() noexcept {
       syncInterfaceStopSignal_.reset(); // Baton experienced timeout
     }
 
-    auto success = syncInterfaces();
+    bool success{true};
+    if (isFullInterfaceSyncNeeded()) {
+      // Losses until dump is received are covered by it
+      const auto numEventLosses = nlSock_->getNumEventLosses();
+      fb303::fbData->addStatValue(
+          "link_monitor.sync_interface.full_dump", 1, fb303::SUM);
+      success = syncInterfaces();
+      if (success) {
+        syncedNumEventLosses_ = numEventLosses;
+      }
+    } else {
+      fb303::fbData->addStatValue(
+          "link_monitor.sync_interface.skipped", 1, fb303::SUM);
+    }
     if (success) {
       expBackoff_.reportSuccess();
       timeout = std::chrono::milliseconds(Constants::kPlatformSyncInterval);
@@ -1106,6 +1492,44 @@ LinkMonitor::syncInterfaceTask() noexcept {
   XLOG(INFO) << "[Interface Sync] Interface-syncing fiber task got stopped.";
 }
 
+bool
+LinkMonitor::isFullInterfaceSyncNeeded() {
+  if (not syncedNumEventLosses_.has_value()) {
+    return true;
+  }
+
+  if (*syncedNumEventLosses_ != nlSock_->getNumEventLosses()) {
+    XLOG(INFO) << "[Interface Sync] Netlink events got lost. Full sync needed.";
+    return true;
+  }
+
+  // Without cache of links, e.g. no netlink event socket, fall back to dump
+  const auto& cache = nlSock_->getCache();
+  if (not cache.isSynced()) {
+    return true;
+  }
+
+  // Consistency check of link attributes in memory, no dump involved.
+  // Addresses aren't cached, their events are covered by event loss check.
+  const auto snapshot = cache.getSnapshot();
+  for (const auto& [ifIndex, link] : snapshot->links) {
+    const auto& ifName = link.getLinkName();
+    const auto& match = getInterfaceMatch(ifIndex, ifName);
+    if (match.discoverAreas.empty() && match.redistributeAreas.empty()) {
+      continue;
+    }
+    auto it = interfaces_.find(ifName);
+    if (it == interfaces_.end() or it->second.getIfIndex() != ifIndex or
+        it->second.isUp() != link.isUp()) {
+      XLOG(INFO) << fmt::format(
+          "[Interface Sync] Interface {} is inconsistent with netlink. Full sync needed.",
+          ifName);
+      return true;
+    }
+  }
+  return false;
+}
+
 bool
 LinkMonitor::syncInterfaces() {
   // Retrieve latest link snapshot from NetlinkProtocolSocket
@@ -1146,7 +1570,7 @@ LinkMonitor::syncInterfaces() {
     ifIndexToName_[info.ifIndex] = info.ifName;
 
     // Get interface entry
-    auto interfaceEntry = getOrCreateInterfaceEntry(info.ifName);
+    auto interfaceEntry = getOrCreateInterfaceEntry(info.ifIndex, info.ifName);
     if (not interfaceEntry) {
       continue;
     }
@@ -1196,7 +1620,7 @@ LinkMonitor::processLinkEvent(fbnl::Link&& link) {
   //       `[]` operator is used in purpose
   ifIndexToName_[ifIndex] = ifName;
 
-  auto interfaceEntry = getOrCreateInterfaceEntry(ifName);
+  auto interfaceEntry = getOrCreateInterfaceEntry(ifIndex, ifName);
   if (interfaceEntry) {
     const bool wasUp = interfaceEntry->isUp();
     interfaceEntry->updateAttrs(ifIndex, isUp);
@@ -1225,7 +1649,7 @@ LinkMonitor::processAddressEvent(fbnl::IfAddress&& addr) {
   }
 
   // Cached ifIndex -> ifName mapping
-  auto interfaceEntry = getOrCreateInterfaceEntry(it->second);
+  auto interfaceEntry = getOrCreateInterfaceEntry(ifIndex, it->second);
   if (interfaceEntry) {
     interfaceEntry->updateAddr(prefix.value(), isValid);
   }
@@ -1233,6 +1657,18 @@ LinkMonitor::processAddressEvent(fbnl::IfAddress&& addr) {
 
 void
 LinkMonitor::processNeighborEvents(NeighborEvents&& events) {
+  // Log one summary instead of every event of a large batch
+  const bool logSummary = events.size() > 1;
+  std::map<std::string /* event type */, int64_t> numEventsByType;
+  auto logEvent = [&](const NeighborEvent& event) {
+    if (logSummary) {
+      ++numEventsByType[toString(event.eventType)];
+    } else {
+      logNeighborEvent(event);
+    }
+  };
+
+  neighborEventBatch_.emplace();
   for (const auto& event : events) {
     const auto& neighborAddrV4 = event.neighborAddrV4;
     const auto& neighborAddrV6 = event.neighborAddrV6;
@@ -1250,28 +1686,28 @@ LinkMonitor::processNeighborEvents(NeighborEvents&& events) {
 
     switch (event.eventType) {
     case NeighborEventType::NEIGHBOR_UP:
-      logNeighborEvent(event);
+      logEvent(event);
       neighborUpEvent(event, false);
       break;
     case NeighborEventType::NEIGHBOR_RESTARTED: {
-      logNeighborEvent(event);
+      logEvent(event);
       neighborUpEvent(event, true);
       break;
     }
     case NeighborEventType::NEIGHBOR_ADJ_SYNCED: {
-      logNeighborEvent(event);
+      logEvent(event);
       neighborAdjSyncedEvent(event);
       break;
     }
     case NeighborEventType::NEIGHBOR_RESTARTING: {
       CHECK(initialNeighborsReceived_);
-      logNeighborEvent(event);
+      logEvent(event);
       neighborRestartingEvent(event);
       break;
     }
     case NeighborEventType::NEIGHBOR_DOWN: {
       CHECK(initialNeighborsReceived_);
-      logNeighborEvent(event);
+      logEvent(event);
       neighborDownEvent(event);
       break;
     }
@@ -1280,7 +1716,7 @@ LinkMonitor::processNeighborEvents(NeighborEvents&& events) {
       if (!useRttMetric_) {
         break;
       }
-      logNeighborEvent(event);
+      logEvent(event);
       neighborRttChangeEvent(event);
       break;
     }
@@ -1289,6 +1725,28 @@ LinkMonitor::processNeighborEvents(NeighborEvents&& events) {
     }
   } // for
 
+  // Commit batch: publish peer updates of all events at once, then advertise
+  // adjacencies of affected areas once
+  auto batch = std::move(neighborEventBatch_).value();
+  neighborEventBatch_.reset();
+  if (not batch.peerEvent.empty()) {
+    peerUpdatesQueue_.push(std::move(batch.peerEvent));
+  }
+  if (not batch.areasToAdvertise.empty()) {
+    advertiseAdjacencies(std::vector<std::string>(
+        batch.areasToAdvertise.begin(), batch.areasToAdvertise.end()));
+  }
+
+  if (logSummary) {
+    LogSample sample{};
+    sample.addString("event", "NEIGHBOR_EVENTS");
+    sample.addInt("num_events", events.size());
+    for (const auto& [eventType, numEvents] : numEventsByType) {
+      sample.addInt(fmt::format("num_{}", eventType), numEvents);
+    }
+    logSampleQueue_.push(std::move(sample));
+  }
+
   // Publish all peers to KvStore in OpenR initialization procedure.
   if (not initialNeighborsReceived_) {
     PeerEvent event;
@@ -1326,6 +1784,7 @@ LinkMonitor::semifuture_setNodeOverload(bool isOverloaded) {
       state_.isOverloaded_ref() = isOverloaded;
       SYSLOG(INFO) << EventTag() << (isOverloaded ? "Setting" : "Unsetting")
                    << " overload bit for node";
+      updateInterfaceSnapshot();
       advertiseAdjacencies();
     }
     p.setValue();
@@ -1374,6 +1833,7 @@ LinkMonitor::semifuture_setInterfaceOverload(
       SYSLOG(INFO) << EventTag() << "Unsetting overload bit for interface "
                    << interfaceName;
     }
+    updateInterfaceSnapshot();
     advertiseAdjacenciesThrottled_->operator()();
     p.setValue();
   });
@@ -1426,6 +1886,7 @@ LinkMonitor::semifuture_setLinkMetric(
           SYSLOG(INFO) << "Removing metric override for interface "
                        << interfaceName;
         }
+        updateInterfaceSnapshot();
         advertiseAdjacenciesThrottled_->operator()();
         p.setValue();
       });
@@ -1641,47 +2102,87 @@ LinkMonitor::semifuture_unsetInterfaceMetricIncrement(
   return sf;
 }
 
-folly::SemiFuture<std::unique_ptr<thrift::DumpLinksReply>>
-LinkMonitor::semifuture_getInterfaces() {
-  XLOG(DBG2) << "Dump Links requested, replying withV " << interfaces_.size()
-             << " links";
+std::shared_ptr<const InterfaceSnapshot>
+LinkMonitor::getInterfaceSnapshot() const {
+  return interfaceSnapshot_.load();
+}
 
-  folly::Promise<std::unique_ptr<thrift::DumpLinksReply>> p;
-  auto sf = p.getSemiFuture();
-  runInEventBaseThread([this, p = std::move(p)]() mutable {
-    // reply with the dump of known interfaces and their states
-    thrift::DumpLinksReply reply;
-    *reply.thisNodeName_ref() = nodeId_;
-    reply.isOverloaded_ref() = *state_.isOverloaded_ref();
-
-    // Fill interface details
-    for (auto& [_, interface] : interfaces_) {
-      const auto& ifName = interface.getIfName();
-
-      thrift::InterfaceDetails ifDetails;
-      ifDetails.info_ref() = interface.getInterfaceInfo().toThrift();
-      ifDetails.isOverloaded_ref() =
-          state_.overloadedLinks_ref()->count(ifName) > 0;
-
-      // Add metric override if any
-      if (state_.linkMetricOverrides_ref()->count(ifName) > 0) {
-        ifDetails.metricOverride_ref() =
-            state_.linkMetricOverrides_ref()->at(ifName);
-      }
+void
+LinkMonitor::updateInterfaceSnapshot() {
+  auto snapshot = std::make_shared<InterfaceSnapshot>();
+  if (auto prevSnapshot = interfaceSnapshot_.load()) {
+    snapshot->version = prevSnapshot->version + 1;
+  }
 
-      // Add link-backoff
-      auto backoffMs = interface.getBackoffDuration();
-      if (backoffMs.count() != 0) {
-        ifDetails.linkFlapBackOffMs_ref() = backoffMs.count();
-      } else {
-        ifDetails.linkFlapBackOffMs_ref().reset();
-      }
+  auto& reply = snapshot->dumpLinksReply;
+  *reply.thisNodeName_ref() = nodeId_;
+  reply.isOverloaded_ref() = *state_.isOverloaded_ref();
+
+  // Fill interface details
+  const auto now = std::chrono::steady_clock::now();
+  for (auto& [_, interface] : interfaces_) {
+    const auto& ifName = interface.getIfName();
 
-      reply.interfaceDetails_ref()->emplace(ifName, std::move(ifDetails));
+    thrift::InterfaceDetails ifDetails;
+    ifDetails.info_ref() = interface.getInterfaceInfo().toThrift();
+    ifDetails.isOverloaded_ref() =
+        state_.overloadedLinks_ref()->count(ifName) > 0;
+
+    // Add metric override if any
+    if (state_.linkMetricOverrides_ref()->count(ifName) > 0) {
+      ifDetails.metricOverride_ref() =
+          state_.linkMetricOverrides_ref()->at(ifName);
     }
-    p.setValue(std::make_unique<thrift::DumpLinksReply>(std::move(reply)));
-  });
-  return sf;
+
+    // Add link-backoff
+    auto backoffMs = interface.getBackoffDuration();
+    if (backoffMs.count() != 0) {
+      ifDetails.linkFlapBackOffMs_ref() = backoffMs.count();
+      snapshot->backoffExpiry.emplace(ifName, now + backoffMs);
+    } else {
+      ifDetails.linkFlapBackOffMs_ref().reset();
+    }
+
+    // Add link-flap dampening state
+    if (interface.isFlapDampeningEnabled()) {
+      ifDetails.linkFlapPenalty_ref() =
+          static_cast<int64_t>(interface.getFlapPenalty());
+      ifDetails.isLinkFlapSuppressed_ref() = interface.isFlapSuppressed();
+    }
+
+    reply.interfaceDetails_ref()->emplace(ifName, std::move(ifDetails));
+  }
+
+  fb303::fbData->setCounter(
+      "link_monitor.interface_snapshot.version", snapshot->version);
+  interfaceSnapshot_.store(std::move(snapshot));
+}
+
+folly::SemiFuture<std::unique_ptr<thrift::DumpLinksReply>>
+LinkMonitor::semifuture_getInterfaces() {
+  // Served from snapshot, never blocks on LinkMonitor thread
+  const auto snapshot = getInterfaceSnapshot();
+  XLOG(DBG2) << fmt::format(
+      "Dump Links requested, replying with {} links of snapshot version {}",
+      snapshot->dumpLinksReply.interfaceDetails_ref()->size(),
+      snapshot->version);
+
+  auto reply =
+      std::make_unique<thrift::DumpLinksReply>(snapshot->dumpLinksReply);
+
+  // Backoff keeps elapsing after snapshot has been published
+  const auto now = std::chrono::steady_clock::now();
+  for (const auto& [ifName, expiry] : snapshot->backoffExpiry) {
+    auto& ifDetails = reply->interfaceDetails_ref()->at(ifName);
+    if (expiry > now) {
+      ifDetails.linkFlapBackOffMs_ref() =
+          std::chrono::duration_cast<std::chrono::milliseconds>(expiry - now)
+              .count();
+    } else {
+      ifDetails.linkFlapBackOffMs_ref().reset();
+    }
+  }
+  return folly::makeSemiFuture(std::move(reply));
 }
 
 folly::SemiFuture<std::unique_ptr<std::vector<thrift::AdjacencyDatabase>>>
@@ -1834,24 +2335,6 @@ LinkMonitor::logPeerEvent(
                << ", port: " << std::to_string(ctrlPort);
 }
 
-bool
-LinkMonitor::anyAreaShouldDiscoverOnIface(std::string const& iface) const {
-  bool anyMatch = false;
-  for (auto const& [_, areaConf] : areas_) {
-    anyMatch |= areaConf.shouldDiscoverOnIface(iface);
-  }
-  return anyMatch;
-}
-
-bool
-LinkMonitor::anyAreaShouldRedistributeIface(std::string const& iface) const {
-  bool anyMatch = false;
-  for (auto const& [_, areaConf] : areas_) {
-    anyMatch |= areaConf.shouldRedistributeIface(iface);
-  }
-  return anyMatch;
-}
-
 const std::pair<int32_t, int32_t>
 LinkMonitor::getNodeSegmentLabelRange(
     AreaConfiguration const& areaConfig) const {
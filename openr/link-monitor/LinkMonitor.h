@@ -8,6 +8,8 @@
 #pragma once
 
 #include <folly/IPAddress.h>
+#include <folly/concurrency/AtomicSharedPtr.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
 #include <folly/futures/Future.h>
 #include <folly/io/async/AsyncTimeout.h>
 #include <glog/logging.h>
@@ -47,6 +49,12 @@ struct AdjacencyValue {
   // other nodes in the area. Otherwise, all nodes in the area could use the
   // adj for route computation.
   bool onlyUsedByOtherNode{false};
+  // EWMA smoothed rtt which rtt metric is derived from
+  double smoothedRttUs{0};
+  // time of last applied rtt metric change, for dwell time
+  std::chrono::steady_clock::time_point lastRttMetricChange{};
+  // rtt metric change deferred by dwell time
+  bool isRttMetricChangePending{false};
 
   AdjacencyValue() {}
   AdjacencyValue(
@@ -94,6 +102,22 @@ struct KvStorePeerValue {
         establishedSparkNeighbors(std::move(establishedSparkNeighbors)) {}
 };
 
+/*
+ * Immutable snapshot of interface state, published by LinkMonitor thread
+ * whenever interfaces or their overrides change. Readers on other threads
+ * (e.g. ctrl queries) load it without hopping onto LinkMonitor thread.
+ */
+struct InterfaceSnapshot {
+  // Incremented on every published snapshot
+  uint64_t version{0};
+  // Interfaces and their details as replied to `getInterfaces`
+  thrift::DumpLinksReply dumpLinksReply;
+  // Expiry of link-flap backoff of interfaces in backoff at snapshot time.
+  // Remaining backoff is derived from it when snapshot is read.
+  std::unordered_map<std::string, std::chrono::steady_clock::time_point>
+      backoffExpiry;
+};
+
 /*
  * This class is mainly responsible for
  *    - Monitor system interface status & address;
@@ -169,6 +193,10 @@ class LinkMonitor final : public OpenrEventBase {
   folly::SemiFuture<std::unique_ptr<thrift::DumpLinksReply>>
   semifuture_getInterfaces();
   folly::SemiFuture<InterfaceDatabase> semifuture_getAllLinks();
+
+  // Latest published interface snapshot, never null. Safe to call from any
+  // thread.
+  std::shared_ptr<const InterfaceSnapshot> getInterfaceSnapshot() const;
   folly::SemiFuture<std::unique_ptr<
       std::map<std::string, std::vector<thrift::AdjacencyDatabase>>>>
   semifuture_getAreaAdjacencies(thrift::AdjacenciesFilter filter = {});
@@ -209,6 +237,14 @@ class LinkMonitor final : public OpenrEventBase {
   void neighborDownEvent(const NeighborEvent& event);
   void neighborRttChangeEvent(const NeighborEvent& event);
 
+  // Apply rtt metric derived from smoothed rtt of adjacency, subject to
+  // hysteresis and dwell time. Return false if change is suppressed/deferred.
+  bool maybeApplyRttMetricChange(
+      const AdjacencyKey& adjKey, AdjacencyValue& adjValue);
+
+  // Apply rtt metric changes whose dwell time has expired
+  void processPendingRttMetricChanges();
+
   /*
    * [KvStore] initial sync event
    */
@@ -231,11 +267,21 @@ class LinkMonitor final : public OpenrEventBase {
   void syncInterfaceTask() noexcept;
   bool syncInterfaces();
 
+  // Interfaces are kept up to date by netlink events. Full dump of links and
+  // addresses is only needed before first sync, after netlink events got lost
+  // or if interfaces are found inconsistent with netlink cache of links.
+  bool isFullInterfaceSyncNeeded();
+
   // Get or create InterfaceEntry object.
   // Returns nullptr if ifName doesn't qualify regex match
   // used in syncInterfaces() and LINK/ADDRESS EVENT
   InterfaceEntry* FOLLY_NULLABLE
-  getOrCreateInterfaceEntry(const std::string& ifName);
+  getOrCreateInterfaceEntry(int ifIndex, const std::string& ifName);
+
+  // Get regex match decisions of all areas for interface. Cached by ifIndex
+  // and re-evaluated only if interface got renamed.
+  const InterfaceRegexMatcher::Result& getInterfaceMatch(
+      int ifIndex, const std::string& ifName);
 
   /*
    * [Kvstore] PEER UP/DOWN events sent to Kvstore over peerUpdatesQueue_
@@ -270,6 +316,16 @@ class LinkMonitor final : public OpenrEventBase {
    */
   void advertiseAdjacencies(const std::string& area);
   void advertiseAdjacencies(); // Advertise my adjacencies_ in to all areas
+  void advertiseAdjacencies(const std::vector<std::string>& areas);
+
+  /*
+   * [Kvstore] Publish peer updates to KvStore, or merge them into the batch
+   * of neighbor events being processed
+   */
+  void publishPeerEvent(
+      const std::string& area,
+      thrift::PeersMap&& peersToAdd,
+      std::vector<std::string>&& peersToDel);
 
   /*
    * [Spark/Fib] Advertise interfaces_ over interfaceUpdatesQueue_ to Spark/Fib
@@ -278,6 +334,14 @@ class LinkMonitor final : public OpenrEventBase {
    */
   void advertiseInterfaces();
 
+  /*
+   * [Ctrl] Publish a new InterfaceSnapshot from interfaces_ and state_
+   *
+   * Called upon interface advertisement and node/link overload or link metric
+   * override changes
+   */
+  void updateInterfaceSnapshot();
+
   /*
    * [PrefixManager] Advertise redistribute prefixes over prefixUpdatesQueue_ to
    * prefix manager "redistribute prefixes" includes addresses of interfaces
@@ -309,14 +373,16 @@ class LinkMonitor final : public OpenrEventBase {
   bool shouldSkipAdjAnnouncement(
       const AdjacencyKey& adjKey, const AdjacencyValue& adjVal);
 
-  // build AdjacencyDatabase
+  // build AdjacencyDatabase. Only adjacencies changed since last build are
+  // rebuilt, unless any state affecting all of them has changed.
   thrift::AdjacencyDatabase buildAdjacencyDatabase(const std::string& area);
 
-  // returns any(a.shouldDiscoverOnIface(iface) for a in areas_)
-  bool anyAreaShouldDiscoverOnIface(std::string const& iface) const;
+  // build advertised adjacency with link overload bit and metric applied
+  thrift::Adjacency buildAdjacency(const AdjacencyValue& adjValue) const;
 
-  // returns any(a.anyAreaShouldRedistributeIface(iface) for a in areas_)
-  bool anyAreaShouldRedistributeIface(std::string const& iface) const;
+  // util function to mark adjacency to be rebuilt before next advertisement
+  void markAdjacencyChanged(
+      const std::string& area, const AdjacencyKey& adjKey);
 
   /*
    * [Logging]
@@ -369,9 +435,15 @@ class LinkMonitor final : public OpenrEventBase {
   thrift::PrefixForwardingAlgorithm prefixForwardingAlgorithm_;
   // Use spark measured RTT to neighbor as link metric
   bool useRttMetric_{false};
+  // rtt metric hysteresis, dwell time and EWMA weight of new rtt sample
+  const int32_t rttMetricMinChangePct_{0};
+  const std::chrono::milliseconds rttMetricDwellTime_{0};
+  const double rttMetricEwmaWeight_{1};
   // link flap back offs
   std::chrono::milliseconds linkflapInitBackoff_;
   std::chrono::milliseconds linkflapMaxBackoff_;
+  // link flap dampening, if enabled
+  std::optional<thrift::LinkFlapDampeningConfig> linkflapDampeningConfig_;
 
   std::unordered_map<std::string, AreaConfiguration> const areas_;
 
@@ -406,6 +478,10 @@ class LinkMonitor final : public OpenrEventBase {
   // ser/deser binary data for transmission
   apache::thrift::CompactSerializer serializer_;
 
+  // Executor to serialize adjacency databases of multiple areas with
+  // concurrently. Not set if it's disabled by config.
+  std::unique_ptr<folly::CPUThreadPoolExecutor> adjDbSerializeExecutor_;
+
   // Currently active adjacencies.
   // An adjacency is uniquely identified by interface and remote node within an
   // area.
@@ -416,6 +492,20 @@ class LinkMonitor final : public OpenrEventBase {
       std::unordered_map<AdjacencyKey, AdjacencyValue>>
       adjacencies_;
 
+  // Adjacencies of an area as last built for advertisement, kept up to date
+  // incrementally. Ordered by key for stable serialization, which keeps
+  // changed bytes together for delta flooding of KvStore.
+  struct AdjacencyDbCache {
+    std::map<AdjacencyKey, thrift::Adjacency> adjacencies;
+    // adjacencies changed since last build
+    std::set<AdjacencyKey> changedAdjKeys;
+    // state entries were built with. All are rebuilt once it changes.
+    std::optional<thrift::LinkMonitorState> state;
+    // hash of last advertised adjacency database, perf events excluded
+    std::optional<size_t> advertisedHash;
+  };
+  std::unordered_map<std::string /* area */, AdjacencyDbCache> adjDbCaches_;
+
   // Previously announced KvStore peers
   std::unordered_map<
       std::string /* area */,
@@ -429,6 +519,9 @@ class LinkMonitor final : public OpenrEventBase {
   // Keyed by interface Name
   std::unordered_map<std::string, InterfaceEntry> interfaces_;
 
+  // Snapshot of interfaces_ for readers on other threads
+  folly::atomic_shared_ptr<const InterfaceSnapshot> interfaceSnapshot_;
+
   // Container storing map of advertised prefixes - Map<prefix, list<area>>
   std::map<folly::CIDRNetwork, std::vector<std::string>> advertisedPrefixes_;
 
@@ -436,6 +529,14 @@ class LinkMonitor final : public OpenrEventBase {
   // on address events
   std::unordered_map<int64_t, std::string> ifIndexToName_;
 
+  // Interface regexes of all areas, and decisions of them cached by ifIndex
+  // along with interface name they were taken for
+  std::shared_ptr<const InterfaceRegexMatcher> interfaceRegexMatcher_;
+  std::unordered_map<
+      int /* ifIndex */,
+      std::pair<std::string /* ifName */, InterfaceRegexMatcher::Result>>
+      ifIndexToMatch_;
+
   // Throttled versions of "advertise<>" functions. It batches
   // up multiple calls and send them in one go!
   std::unique_ptr<AsyncThrottle> advertiseAdjacenciesThrottled_;
@@ -444,9 +545,17 @@ class LinkMonitor final : public OpenrEventBase {
   // Timer for processing interfaces which are in backoff states
   std::unique_ptr<folly::AsyncTimeout> advertiseIfaceAddrTimer_;
 
+  // Timer to apply rtt metric changes deferred by dwell time
+  std::unique_ptr<folly::AsyncTimeout> rttMetricDwellTimer_;
+  std::chrono::steady_clock::time_point rttMetricDwellTimerExpiry_;
+
   // Exp backoff for resyncing InterfaceDb from netlink
   ExponentialBackoff<std::chrono::milliseconds> expBackoff_;
 
+  // Netlink event losses as of last successful full interface sync. Unset
+  // till first one.
+  std::optional<uint64_t> syncedNumEventLosses_;
+
   // Raw ptr to interact with ConfigStore
   PersistentStore* configStore_{nullptr};
 
@@ -460,6 +569,15 @@ class LinkMonitor final : public OpenrEventBase {
   // initialization procedure.
   bool initialNeighborsReceived_{false};
 
+  // Neighbor events of one NeighborEvents vector are processed as a single
+  // transaction. Peer updates and immediate adjacency advertisements are
+  // collected here and published once all events are processed.
+  struct NeighborEventBatch {
+    PeerEvent peerEvent;
+    std::set<std::string> areasToAdvertise;
+  };
+  std::optional<NeighborEventBatch> neighborEventBatch_;
+
   // Stop signal for fiber to periodically dump interface info from platform
   folly::fibers::Baton syncInterfaceStopSignal_;
 }; // LinkMonitor
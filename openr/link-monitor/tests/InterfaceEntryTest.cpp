@@ -222,6 +222,69 @@ TEST(InterfaceEntry, BackoffTest) {
   timeout->cancelTimeout();
 }
 
+/**
+ * Test penalty based flap dampening functionality of InterfaceEntry
+ */
+TEST(InterfaceEntry, FlapDampeningTest) {
+  OpenrEventBase evl;
+  AsyncThrottle throttle(evl.getEvb(), std::chrono::milliseconds(1), []() {});
+  auto timeout = folly::AsyncTimeout::make(*evl.getEvb(), []() noexcept {});
+  thrift::LinkFlapDampeningConfig dampeningConfig;
+  dampeningConfig.penalty_per_flap_ref() = 1000;
+  dampeningConfig.suppress_threshold_ref() = 2500;
+  dampeningConfig.reuse_threshold_ref() = 1500;
+  dampeningConfig.half_life_ms_ref() = 200;
+  dampeningConfig.max_suppress_time_ms_ref() = 400;
+  InterfaceEntry interface(
+      "iface1",
+      std::chrono::milliseconds(1),
+      std::chrono::milliseconds(8),
+      throttle,
+      *timeout,
+      dampeningConfig);
+  EXPECT_TRUE(interface.isFlapDampeningEnabled());
+
+  // 1. Flap interface twice, penalty stays below suppress threshold
+  EXPECT_TRUE(interface.updateAttrs(1, true));
+  EXPECT_TRUE(interface.updateAttrs(1, false));
+  EXPECT_TRUE(interface.updateAttrs(1, true));
+  EXPECT_TRUE(interface.updateAttrs(1, false));
+  EXPECT_TRUE(interface.updateAttrs(1, true));
+  EXPECT_LT(1500, interface.getFlapPenalty());
+  EXPECT_GT(2500, interface.getFlapPenalty());
+  EXPECT_FALSE(interface.isFlapSuppressed());
+
+  // 2. Third flap suppresses interface beyond exponential backoff
+  EXPECT_TRUE(interface.updateAttrs(1, false));
+  EXPECT_TRUE(interface.updateAttrs(1, true));
+  EXPECT_TRUE(interface.isFlapSuppressed());
+  /* sleep override */
+  std::this_thread::sleep_for(std::chrono::milliseconds(16));
+  EXPECT_TRUE(interface.isUp());
+  EXPECT_FALSE(interface.isActive());
+  auto backoff = interface.getBackoffDuration();
+  EXPECT_LT(std::chrono::milliseconds(8), backoff);
+  EXPECT_GE(std::chrono::milliseconds(400), backoff);
+
+  // 3. Penalty is capped by max suppress time
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_TRUE(interface.updateAttrs(1, false));
+    EXPECT_TRUE(interface.updateAttrs(1, true));
+  }
+  EXPECT_GE(6000, interface.getFlapPenalty());
+  backoff = interface.getBackoffDuration();
+  EXPECT_GE(std::chrono::milliseconds(400), backoff);
+
+  // 4. Interface is reused once penalty decays below reuse threshold
+  /* sleep override */
+  std::this_thread::sleep_for(backoff + std::chrono::milliseconds(1));
+  EXPECT_FALSE(interface.isFlapSuppressed());
+  EXPECT_TRUE(interface.isActive());
+  EXPECT_EQ(std::chrono::milliseconds(0), interface.getBackoffDuration());
+  throttle.cancel();
+  timeout->cancelTimeout();
+}
+
 } // namespace openr
 
 int
@@ -0,0 +1,490 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <thread>
+
+#include <fb303/ServiceData.h>
+#include <folly/Benchmark.h>
+#include <folly/Synchronized.h>
+#include <folly/init/Init.h>
+#include <folly/io/async/EventBase.h>
+#include <thrift/lib/cpp2/protocol/Serializer.h>
+
+#include <openr/common/Constants.h>
+#include <openr/common/NetworkUtil.h>
+#include <openr/common/Util.h>
+#include <openr/config-store/PersistentStore.h>
+#include <openr/config/Config.h>
+#include <openr/link-monitor/LinkMonitor.h>
+#include <openr/tests/mocks/NetlinkEventsInjector.h>
+#include <openr/tests/utils/Utils.h>
+
+#define BENCHMARK_COUNTERS_NAME_PARAM(name, counters, param_name, ...) \
+  BENCHMARK_IMPL_COUNTERS(                                             \
+      FB_CONCATENATE(name, FB_CONCATENATE(_, param_name)),             \
+      FOLLY_PP_STRINGIZE(name) "(" FOLLY_PP_STRINGIZE(param_name) ")", \
+      counters,                                                        \
+      iters,                                                           \
+      unsigned,                                                        \
+      iters) {                                                         \
+    name(counters, iters, ##__VA_ARGS__);                              \
+  }
+
+namespace fb303 = facebook::fb303;
+
+namespace {
+
+// Path of config store, which runs in dryrun mode
+const std::string kConfigStorePath = "/tmp/lm_benchmark_config_store.bin";
+
+// Interface index of the first interface created by benchmark
+const uint64_t kFirstIfIndex{100};
+
+// Max time to wait for LinkMonitor to process an event storm
+const std::chrono::seconds kConvergenceTimeout{30};
+
+// Time without any advertisement after which LinkMonitor is considered idle.
+// Covers the throttling of adjacency advertisement.
+const std::chrono::milliseconds kQuiescenceTime{
+    2 * openr::Constants::kAdjacencyThrottleTimeout};
+
+} // namespace
+
+namespace openr {
+
+enum class Storm {
+  // containers come up with an address and go away, i.e. link and address
+  // events on interfaces without neighbors
+  CONTAINER_CHURN,
+  // line card carrying all neighbors fails, i.e. link down of all interfaces
+  // and one batch of neighbor down events
+  LINE_CARD_FAILURE,
+  // all neighbors go through graceful restart at once
+  MASS_GR,
+};
+
+/**
+ * Fixture of LinkMonitor with mocked netlink. Reader threads record arrival
+ * time of every adjacency database sent towards KvStore and every interface
+ * database sent towards Spark.
+ */
+class LinkMonitorFixture {
+ public:
+  LinkMonitorFixture() {
+    nlSock_ = std::make_unique<fbnl::MockNetlinkProtocolSocket>(&nlEvb_);
+    nlEventsInjector_ = std::make_unique<NetlinkEventsInjector>(nlSock_.get());
+
+    auto tConfig = getBasicOpenrConfig("node-1");
+    tConfig.persistent_config_store_path_ref() = kConfigStorePath;
+    tConfig.adj_hold_time_s_ref() = 0;
+    // announce adjacencies without waiting for KvStore initial sync
+    tConfig.enable_ordered_adj_publication_ref() = true;
+    tConfig.link_monitor_config_ref()->linkflap_initial_backoff_ms_ref() = 1;
+    tConfig.link_monitor_config_ref()->linkflap_max_backoff_ms_ref() = 8;
+    tConfig.link_monitor_config_ref()->use_rtt_metric_ref() = false;
+    config_ = std::make_shared<Config>(tConfig);
+
+    configStore_ =
+        std::make_unique<PersistentStore>(config_, true /* dryrun */);
+    configStoreThread_ = std::thread([this]() { configStore_->run(); });
+    configStore_->waitUntilRunning();
+
+    linkMonitor_ = std::make_unique<LinkMonitor>(
+        config_,
+        nlSock_.get(),
+        configStore_.get(),
+        interfaceUpdatesQueue_,
+        prefixUpdatesQueue_,
+        peerUpdatesQueue_,
+        logSampleQueue_,
+        kvRequestQueue_,
+        neighborUpdatesQueue_.getReader(),
+        kvStoreEventsQueue_.getReader(),
+        nlSock_->getReader(),
+        false /* overrideDrainState */);
+    linkMonitorThread_ = std::thread([this]() { linkMonitor_->run(); });
+    linkMonitor_->waitUntilRunning();
+
+    readers_.emplace_back([this, q = kvRequestQueue_.getReader()]() mutable {
+      apache::thrift::CompactSerializer serializer;
+      while (true) {
+        auto maybeRequest = q.get();
+        if (maybeRequest.hasError()) {
+          break;
+        }
+        auto* request =
+            std::get_if<PersistKeyValueRequest>(&maybeRequest.value());
+        if (not request or
+            request->getKey().find(Constants::kAdjDbMarker.toString()) != 0) {
+          continue;
+        }
+        auto adjDb = readThriftObjStr<thrift::AdjacencyDatabase>(
+            request->getValue(), serializer);
+        adjDbs_.wlock()->emplace_back(
+            std::chrono::steady_clock::now(), adjDb.adjacencies_ref()->size());
+      }
+    });
+    readers_.emplace_back([this,
+                           q = interfaceUpdatesQueue_.getReader()]() mutable {
+      while (true) {
+        auto maybeIfDb = q.get();
+        if (maybeIfDb.hasError()) {
+          break;
+        }
+        size_t numUp{0};
+        for (const auto& info : maybeIfDb.value()) {
+          numUp += info.isUp ? 1 : 0;
+        }
+        ifDbs_.wlock()->emplace_back(
+            std::chrono::steady_clock::now(), maybeIfDb.value().size(), numUp);
+      }
+    });
+  }
+
+  ~LinkMonitorFixture() {
+    interfaceUpdatesQueue_.close();
+    prefixUpdatesQueue_.close();
+    peerUpdatesQueue_.close();
+    logSampleQueue_.close();
+    kvRequestQueue_.close();
+    neighborUpdatesQueue_.close();
+    kvStoreEventsQueue_.close();
+    nlSock_->closeQueue();
+    for (auto& reader : readers_) {
+      reader.join();
+    }
+
+    linkMonitor_->stop();
+    linkMonitorThread_.join();
+    linkMonitor_.reset();
+
+    configStore_->stop();
+    configStoreThread_.join();
+    configStore_.reset();
+
+    nlEventsInjector_.reset();
+    nlSock_.reset();
+  }
+
+  static std::string
+  getIfName(size_t idx) {
+    return fmt::format("iface_{}", idx);
+  }
+
+  static NeighborEvent
+  createNeighborEvent(NeighborEventType eventType, size_t idx) {
+    return NeighborEvent(
+        eventType,
+        fmt::format("node-{}", idx + 2),
+        toBinaryAddress(folly::IPAddress(
+            fmt::format("192.168.{}.{}", idx / 256, idx % 256))),
+        toBinaryAddress(folly::IPAddress(fmt::format("fe80::{:x}", idx + 1))),
+        getIfName(idx), /* local interface name */
+        "", /* remote interface name */
+        kTestingAreaName, /* area */
+        Constants::kKvStoreRepPort, /* ZMQ kvstore port */
+        1, /* openrCtrlThriftPort */
+        100 /* rtt */);
+  }
+
+  void
+  sendNeighborEvents(NeighborEventType eventType, size_t numOfNeighbors) {
+    NeighborEvents events;
+    events.reserve(numOfNeighbors);
+    for (size_t idx = 0; idx < numOfNeighbors; ++idx) {
+      events.emplace_back(createNeighborEvent(eventType, idx));
+    }
+    neighborUpdatesQueue_.push(NeighborInitEvent(std::move(events)));
+  }
+
+  // bring up interfaces and neighbors on them, and wait until all adjacencies
+  // are advertised
+  void
+  setupNeighbors(size_t numOfNeighbors) {
+    for (size_t idx = 0; idx < numOfNeighbors; ++idx) {
+      nlEventsInjector_->sendLinkEvent(
+          getIfName(idx), kFirstIfIndex + idx, true /* is up */);
+    }
+    sendNeighborEvents(NeighborEventType::NEIGHBOR_UP, numOfNeighbors);
+    waitForAdjDb(
+        std::chrono::steady_clock::now() - kConvergenceTimeout, numOfNeighbors);
+  }
+
+  // arrival time of first adjacency database with `numOfAdjs` adjacencies
+  // received since `since`. Unset on timeout.
+  std::optional<std::chrono::steady_clock::time_point>
+  waitForAdjDb(
+      std::chrono::steady_clock::time_point since, size_t numOfAdjs) const {
+    const auto start = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - start < kConvergenceTimeout) {
+      {
+        auto adjDbs = adjDbs_.rlock();
+        for (const auto& [ts, adjCount] : *adjDbs) {
+          if (ts >= since and adjCount == numOfAdjs) {
+            return ts;
+          }
+        }
+      }
+      std::this_thread::yield();
+    }
+    return std::nullopt;
+  }
+
+  // arrival time of first interface database with `numOfIfaces` interfaces,
+  // of which `numOfUp` are UP, received since `since`. Unset on timeout.
+  std::optional<std::chrono::steady_clock::time_point>
+  waitForIfDb(
+      std::chrono::steady_clock::time_point since,
+      size_t numOfIfaces,
+      size_t numOfUp) const {
+    const auto start = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - start < kConvergenceTimeout) {
+      {
+        auto ifDbs = ifDbs_.rlock();
+        for (const auto& [ts, ifCount, upCount] : *ifDbs) {
+          if (ts >= since and ifCount == numOfIfaces and upCount == numOfUp) {
+            return ts;
+          }
+        }
+      }
+      std::this_thread::yield();
+    }
+    return std::nullopt;
+  }
+
+  // wait until the value of SUM counter has grown to `value`. False on
+  // timeout.
+  bool
+  waitForCounter(const std::string& name, int64_t value) const {
+    const auto start = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - start < kConvergenceTimeout) {
+      if (getCounter(name) >= value) {
+        return true;
+      }
+      std::this_thread::yield();
+    }
+    return false;
+  }
+
+  static int64_t
+  getCounter(const std::string& name) {
+    return folly::get_default(
+        fb303::fbData->getCounters(), fmt::format("{}.sum", name), 0);
+  }
+
+  size_t
+  getNumAdjDbsSince(std::chrono::steady_clock::time_point since) const {
+    auto adjDbs = adjDbs_.rlock();
+    return std::count_if(adjDbs->begin(), adjDbs->end(), [&](const auto& e) {
+      return std::get<0>(e) >= since;
+    });
+  }
+
+  size_t
+  getNumIfDbsSince(std::chrono::steady_clock::time_point since) const {
+    auto ifDbs = ifDbs_.rlock();
+    return std::count_if(ifDbs->begin(), ifDbs->end(), [&](const auto& e) {
+      return std::get<0>(e) >= since;
+    });
+  }
+
+  std::optional<std::chrono::steady_clock::time_point>
+  getLastAdjDbTime() const {
+    auto adjDbs = adjDbs_.rlock();
+    if (adjDbs->empty()) {
+      return std::nullopt;
+    }
+    return std::get<0>(adjDbs->back());
+  }
+
+  folly::EventBase nlEvb_;
+  std::unique_ptr<fbnl::MockNetlinkProtocolSocket> nlSock_;
+  std::unique_ptr<NetlinkEventsInjector> nlEventsInjector_;
+  std::shared_ptr<Config> config_;
+
+  messaging::ReplicateQueue<InterfaceDatabase> interfaceUpdatesQueue_;
+  messaging::ReplicateQueue<PrefixEvent> prefixUpdatesQueue_;
+  messaging::ReplicateQueue<PeerEvent> peerUpdatesQueue_;
+  messaging::ReplicateQueue<LogSample> logSampleQueue_;
+  messaging::ReplicateQueue<KeyValueRequest> kvRequestQueue_;
+  messaging::ReplicateQueue<NeighborInitEvent> neighborUpdatesQueue_;
+  messaging::ReplicateQueue<KvStoreSyncEvent> kvStoreEventsQueue_;
+
+  std::unique_ptr<PersistentStore> configStore_;
+  std::thread configStoreThread_;
+  std::unique_ptr<LinkMonitor> linkMonitor_;
+  std::thread linkMonitorThread_;
+  std::vector<std::thread> readers_;
+
+  // arrival time and number of adjacencies of advertised adjacency databases
+  folly::Synchronized<
+      std::vector<std::tuple<std::chrono::steady_clock::time_point, size_t>>>
+      adjDbs_;
+  // arrival time, number of interfaces and of UP interfaces of advertised
+  // interface databases
+  folly::Synchronized<std::vector<
+      std::tuple<std::chrono::steady_clock::time_point, size_t, size_t>>>
+      ifDbs_;
+};
+
+// user + system CPU time consumed by this process
+std::chrono::microseconds
+getProcessCpuTime() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  const auto sec = usage.ru_utime.tv_sec + usage.ru_stime.tv_sec;
+  const auto usec = usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+  return std::chrono::seconds(sec) + std::chrono::microseconds(usec);
+}
+
+/**
+ * Benchmark for LinkMonitor processing event storms
+ * 1. Start LinkMonitor and, for neighbor storms, establish `scale` neighbors
+ *    on as many interfaces
+ * 2. Inject the storm of netlink and neighbor events
+ * 3. Wait until LinkMonitor has advertised final state and went idle
+ *
+ * Reports CPU time per injected event, time from injection until the final
+ * adjacency (or interface) database is sent out, and number of adjacency and
+ * interface advertisements emitted for the storm.
+ */
+static void
+BM_LinkMonitorEventStorm(
+    folly::UserCounters& counters, uint32_t iters, Storm storm, size_t scale) {
+  auto suspender = folly::BenchmarkSuspender();
+
+  for (uint32_t i = 0; i < iters; i++) {
+    auto fixture = std::make_unique<LinkMonitorFixture>();
+    if (storm != Storm::CONTAINER_CHURN) {
+      fixture->setupNeighbors(scale);
+    }
+    const auto numNeighborUp =
+        LinkMonitorFixture::getCounter("link_monitor.neighbor_up");
+
+    const auto cpuTimeBefore = getProcessCpuTime();
+    const auto start = std::chrono::steady_clock::now();
+    size_t numOfEvents{0};
+    std::optional<std::chrono::steady_clock::time_point> finalTime;
+
+    suspender.dismiss(); // Start measuring benchmark time
+
+    switch (storm) {
+    case Storm::CONTAINER_CHURN: {
+      for (size_t idx = 0; idx < scale; ++idx) {
+        const auto ifName = LinkMonitorFixture::getIfName(idx);
+        fixture->nlEventsInjector_->sendLinkEvent(
+            ifName, kFirstIfIndex + idx, true /* is up */);
+        fixture->nlEventsInjector_->sendAddrEvent(
+            ifName,
+            fmt::format("fe80::{:x}/64", idx + 1),
+            true /* is valid */);
+      }
+      for (size_t idx = 0; idx < scale; ++idx) {
+        fixture->nlEventsInjector_->sendLinkEvent(
+            LinkMonitorFixture::getIfName(idx),
+            kFirstIfIndex + idx,
+            false /* is up */);
+      }
+      numOfEvents = 3 * scale;
+      finalTime = fixture->waitForIfDb(start, scale, 0 /* numOfUp */);
+      break;
+    }
+    case Storm::LINE_CARD_FAILURE: {
+      for (size_t idx = 0; idx < scale; ++idx) {
+        fixture->nlEventsInjector_->sendLinkEvent(
+            LinkMonitorFixture::getIfName(idx),
+            kFirstIfIndex + idx,
+            false /* is up */);
+      }
+      fixture->sendNeighborEvents(NeighborEventType::NEIGHBOR_DOWN, scale);
+      numOfEvents = 2 * scale;
+      finalTime = fixture->waitForAdjDb(start, 0 /* numOfAdjs */);
+      break;
+    }
+    case Storm::MASS_GR: {
+      fixture->sendNeighborEvents(
+          NeighborEventType::NEIGHBOR_RESTARTING, scale);
+      fixture->sendNeighborEvents(
+          NeighborEventType::NEIGHBOR_RESTARTED, scale);
+      numOfEvents = 2 * scale;
+      // identical adjacencies may never be readvertised, wait for events
+      if (fixture->waitForCounter(
+              "link_monitor.neighbor_up", numNeighborUp + scale)) {
+        finalTime = std::chrono::steady_clock::now();
+      }
+      break;
+    }
+    }
+
+    suspender.rehire(); // Stop measuring benchmark time
+
+    // let throttled advertisements go out before counting them
+    std::this_thread::sleep_for(kQuiescenceTime);
+    const auto cpuTime = getProcessCpuTime() - cpuTimeBefore;
+    if (not finalTime.has_value()) {
+      LOG(ERROR) << "LinkMonitor did not converge within "
+                 << kConvergenceTimeout.count() << "s";
+    }
+    if (auto lastAdjDbTime = fixture->getLastAdjDbTime();
+        lastAdjDbTime.has_value() and *lastAdjDbTime > start) {
+      finalTime = std::max(finalTime.value_or(start), *lastAdjDbTime);
+    }
+
+    counters["cpu_per_event(us)"] = cpuTime.count() / numOfEvents;
+    counters["convergence_time(ms)"] = finalTime.has_value()
+        ? std::chrono::duration_cast<std::chrono::milliseconds>(
+              *finalTime - start)
+              .count()
+        : -1;
+    counters["num_adj_advertisements"] = fixture->getNumAdjDbsSince(start);
+    counters["num_if_advertisements"] = fixture->getNumIfDbsSince(start);
+
+    fixture.reset();
+  }
+}
+
+// Parameters are the type of storm and the number of interfaces/neighbors
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_LinkMonitorEventStorm,
+    counters,
+    container_churn_100,
+    Storm::CONTAINER_CHURN,
+    100);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_LinkMonitorEventStorm,
+    counters,
+    container_churn_1000,
+    Storm::CONTAINER_CHURN,
+    1000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_LinkMonitorEventStorm,
+    counters,
+    line_card_failure_100,
+    Storm::LINE_CARD_FAILURE,
+    100);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_LinkMonitorEventStorm,
+    counters,
+    line_card_failure_1000,
+    Storm::LINE_CARD_FAILURE,
+    1000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_LinkMonitorEventStorm, counters, mass_gr_100, Storm::MASS_GR, 100);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_LinkMonitorEventStorm, counters, mass_gr_1000, Storm::MASS_GR, 1000);
+
+} // namespace openr
+
+int
+main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
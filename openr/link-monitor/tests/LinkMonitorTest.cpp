@@ -5,6 +5,7 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <fb303/ServiceData.h>
 #include <folly/Subprocess.h>
 #include <folly/init/Init.h>
 #include <folly/io/async/EventBase.h>
@@ -32,6 +33,8 @@
 using namespace openr;
 using namespace folly::literals::shell_literals;
 
+namespace fb303 = facebook::fb303;
+
 using ::testing::InSequence;
 
 // node-1 connects node-2 via interface iface_2_1 and iface_2_2, node-3 via
@@ -765,6 +768,21 @@ TEST_F(LinkMonitorTestFixture, DrainState) {
   EXPECT_FALSE(*res->isOverloaded_ref());
 }
 
+// Interface snapshot is versioned and immutable once published
+TEST_F(LinkMonitorTestFixture, InterfaceSnapshot) {
+  auto snapshot = linkMonitor->getInterfaceSnapshot();
+  ASSERT_NE(nullptr, snapshot);
+  EXPECT_FALSE(*snapshot->dumpLinksReply.isOverloaded_ref());
+
+  linkMonitor->semifuture_setNodeOverload(true).get();
+  auto newSnapshot = linkMonitor->getInterfaceSnapshot();
+  EXPECT_LT(snapshot->version, newSnapshot->version);
+  EXPECT_TRUE(*newSnapshot->dumpLinksReply.isOverloaded_ref());
+
+  // snapshot held by reader is not affected
+  EXPECT_FALSE(*snapshot->dumpLinksReply.isOverloaded_ref());
+}
+
 // receive neighbor up/down events from "spark"
 // form peer connections and inform KvStore of adjacencies
 TEST_F(LinkMonitorTestFixture, BasicOperation) {
@@ -1299,6 +1317,162 @@ TEST_F(LinkMonitorTestFixture, Throttle) {
   checkNextAdjPub("adj:node-1");
 }
 
+// Event not changing the adjacency database shouldn't be advertised again
+TEST_F(LinkMonitorTestFixture, SkipUnchangedAdjAdvertisement) {
+  const auto skippedCounter = "link_monitor.advertise_adjacencies.skipped.sum";
+
+  // create interfaces
+  nlEventsInjector->sendLinkEvent(if_2_1, 100, true);
+  recvAndReplyIfUpdate();
+  nlEventsInjector->sendLinkEvent(if_3_1, 101, true);
+  recvAndReplyIfUpdate();
+
+  // neighbor up on nb2 and initial sync
+  {
+    auto neighborEvent = nb2_up_event;
+    neighborUpdatesQueue.push(
+        NeighborInitEvent(NeighborEvents({std::move(neighborEvent)})));
+    kvStoreEventsQueue.push(KvStoreSyncEvent("node-2", kTestingAreaName));
+
+    expectedAdjDbs.push(createAdjDb("node-1", {adj_2_1}, kNodeLabel));
+    checkNextAdjPub("adj:node-1");
+  }
+
+  // metric override on interface without adjacency is not advertised
+  {
+    const auto skippedBefore =
+        folly::get_default(fb303::fbData->getCounters(), skippedCounter, 0);
+
+    linkMonitor->semifuture_setLinkMetric(if_3_1, 123).get();
+
+    // wait for throttled advertisement
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+
+    // no adj events
+    CHECK_EQ(0, kvStoreWrapper->getReader().size());
+    EXPECT_LT(
+        skippedBefore,
+        folly::get_default(fb303::fbData->getCounters(), skippedCounter, 0));
+  }
+
+  // neighbor down on nb2 is advertised
+  {
+    auto neighborEvent = nb2_down_event;
+    neighborUpdatesQueue.push(
+        NeighborInitEvent(NeighborEvents({std::move(neighborEvent)})));
+
+    expectedAdjDbs.push(createAdjDb("node-1", {}, kNodeLabel));
+    checkNextAdjPub("adj:node-1");
+  }
+}
+
+// Neighbor events of one vector are processed as a single transaction
+TEST_F(LinkMonitorTestFixture, BatchedNeighborEvents) {
+  const auto advertisedCounter = "link_monitor.advertise_adjacencies.sum";
+
+  // neighbor up on nb2 and nb3 in one batch
+  {
+    neighborUpdatesQueue.push(
+        NeighborInitEvent(NeighborEvents({nb2_up_event, nb3_up_event})));
+    kvStoreEventsQueue.push(KvStoreSyncEvent("node-2", kTestingAreaName));
+    kvStoreEventsQueue.push(KvStoreSyncEvent("node-3", kTestingAreaName));
+
+    expectedAdjDbs.push(createAdjDb("node-1", {adj_2_1, adj_3_1}, kNodeLabel));
+    checkNextAdjPub("adj:node-1");
+  }
+
+  // neighbor down on nb2 and nb3 in one batch is advertised once
+  {
+    const auto advertisedBefore =
+        folly::get_default(fb303::fbData->getCounters(), advertisedCounter, 0);
+
+    neighborUpdatesQueue.push(
+        NeighborInitEvent(NeighborEvents({nb2_down_event, nb3_down_event})));
+
+    expectedAdjDbs.push(createAdjDb("node-1", {}, kNodeLabel));
+    checkNextAdjPub("adj:node-1");
+
+    // wait for any further advertisement
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    EXPECT_EQ(
+        advertisedBefore + 1,
+        folly::get_default(fb303::fbData->getCounters(), advertisedCounter, 0));
+    CHECK_EQ(0, kvStoreWrapper->getReader().size());
+  }
+}
+
+class RttMetricTestFixture : public LinkMonitorTestFixture {
+ public:
+  thrift::OpenrConfig
+  createConfig() override {
+    auto tConfig = LinkMonitorTestFixture::createConfig();
+
+    // override LM config
+    auto& lmConf = *tConfig.link_monitor_config_ref();
+    lmConf.use_rtt_metric_ref() = true;
+    lmConf.rtt_metric_min_change_pct_ref() = 20;
+
+    return tConfig;
+  }
+};
+
+// RTT metric change smaller than hysteresis is suppressed
+TEST_F(RttMetricTestFixture, RttMetricHysteresis) {
+  const auto suppressedCounter =
+      "link_monitor.rtt_metric_change.suppressed.sum";
+
+  // neighbor up on nb2 with rtt 1000us and initial sync
+  {
+    auto neighborEvent = nb2_up_event;
+    neighborEvent.rttUs = 1000;
+    neighborUpdatesQueue.push(
+        NeighborInitEvent(NeighborEvents({std::move(neighborEvent)})));
+    kvStoreEventsQueue.push(KvStoreSyncEvent("node-2", kTestingAreaName));
+
+    auto adj = adj_2_1;
+    adj.metric_ref() = 10;
+    adj.rtt_ref() = 1000;
+    expectedAdjDbs.push(createAdjDb("node-1", {adj}, kNodeLabel));
+    checkNextAdjPub("adj:node-1");
+  }
+
+  // 10% change of metric is suppressed
+  {
+    const auto suppressedBefore =
+        folly::get_default(fb303::fbData->getCounters(), suppressedCounter, 0);
+
+    auto neighborEvent = nb2_up_event;
+    neighborEvent.eventType = NeighborEventType::NEIGHBOR_RTT_CHANGE;
+    neighborEvent.rttUs = 1100;
+    neighborUpdatesQueue.push(
+        NeighborInitEvent(NeighborEvents({std::move(neighborEvent)})));
+
+    // wait for throttled advertisement
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+
+    // no adj events
+    CHECK_EQ(0, kvStoreWrapper->getReader().size());
+    EXPECT_LT(
+        suppressedBefore,
+        folly::get_default(fb303::fbData->getCounters(), suppressedCounter, 0));
+  }
+
+  // 50% change of metric is applied
+  {
+    auto neighborEvent = nb2_up_event;
+    neighborEvent.eventType = NeighborEventType::NEIGHBOR_RTT_CHANGE;
+    neighborEvent.rttUs = 1500;
+    neighborUpdatesQueue.push(
+        NeighborInitEvent(NeighborEvents({std::move(neighborEvent)})));
+
+    auto adj = adj_2_1;
+    adj.metric_ref() = 15;
+    adj.rtt_ref() = 1500;
+    expectedAdjDbs.push(createAdjDb("node-1", {adj}, kNodeLabel));
+    checkNextAdjPub("adj:node-1");
+  }
+}
+
 // parallel adjacencies between two nodes via different interfaces
 TEST_F(LinkMonitorTestFixture, ParallelAdj) {
   {
@@ -1542,6 +1716,10 @@ TEST_F(LinkMonitorTestFixture, NeighborGracefulRestartSuccess) {
   }
 
   // neighbor restarted on iface_2_1 (GR Success)
+  const auto grSuppressedCounter =
+      "link_monitor.gr_readvertisement.suppressed.sum";
+  const auto numGrSuppressed = folly::get_default(
+      fb303::fbData->getCounters(), grSuppressedCounter, 0);
   {
     auto neighborEvent = nb2_up_event;
     neighborEvent.eventType = NeighborEventType::NEIGHBOR_RESTARTED;
@@ -1562,6 +1740,11 @@ TEST_F(LinkMonitorTestFixture, NeighborGracefulRestartSuccess) {
     checkPeerDump(*adj_2_1.otherNodeName_ref(), peerSpec_2_1);
     // neighbor started GR, no adj update should happen
     CHECK_EQ(0, kvStoreWrapper->getReader().size());
+    // adjacencies are unchanged, readvertisement of both is suppressed
+    EXPECT_EQ(
+        numGrSuppressed + 2,
+        folly::get_default(
+            fb303::fbData->getCounters(), grSuppressedCounter, 0));
   }
 
   // before neighbor 2 finish initial sync, make sure additional events will
@@ -0,0 +1,404 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <string>
+#include "openr/messaging/ConflatingQueue.h"
+namespace openr {
+namespace messaging {
+
+template <typename Key, typename Value, typename Hash>
+ConflatingRQueue<Key, Value, Hash>::ConflatingRQueue(
+    std::shared_ptr<ConflatingQueue<Key, Value, Hash>> queue)
+    : queue_(std::move(queue)) {
+  assert(queue_);
+}
+
+template <typename Key, typename Value, typename Hash>
+folly::Expected<std::pair<Key, Value>, QueueError>
+ConflatingRQueue<Key, Value, Hash>::get() {
+  return queue_->get();
+}
+
+template <typename Key, typename Value, typename Hash>
+folly::Expected<std::vector<std::pair<Key, Value>>, QueueError>
+ConflatingRQueue<Key, Value, Hash>::getBatch(size_t maxItems) {
+  return queue_->getBatch(maxItems);
+}
+
+#if FOLLY_HAS_COROUTINES
+template <typename Key, typename Value, typename Hash>
+folly::coro::Task<folly::Expected<std::pair<Key, Value>, QueueError>>
+ConflatingRQueue<Key, Value, Hash>::getCoro() {
+  auto val = co_await queue_->getCoro();
+  co_return val;
+}
+#endif
+
+template <typename Key, typename Value, typename Hash>
+size_t
+ConflatingRQueue<Key, Value, Hash>::size() {
+  return queue_->size();
+}
+
+template <typename Key, typename Value, typename Hash>
+ConflatingQueue<Key, Value, Hash>::ConflatingQueue() {}
+
+template <typename Key, typename Value, typename Hash>
+ConflatingQueue<Key, Value, Hash>::ConflatingQueue(const std::string& queueId)
+    : queueId_(queueId) {}
+
+template <typename Key, typename Value, typename Hash>
+ConflatingQueue<Key, Value, Hash>::~ConflatingQueue() {
+  close();
+}
+
+template <typename Key, typename Value, typename Hash>
+template <typename ValueT>
+bool
+ConflatingQueue<Key, Value, Hash>::push(const Key& key, ValueT&& value) {
+  std::lock_guard<std::mutex> l(lock_);
+
+  // If queue is closed, don't enqueue
+  if (closed_) {
+    return false;
+  }
+  ++writes_;
+
+  // Replace value of pending key in place
+  auto it = values_.find(key);
+  if (it != values_.end()) {
+    it->second = Value(std::forward<ValueT>(value));
+    ++conflations_;
+    return true;
+  }
+
+  if (pendingReads_.size()) {
+    // Unblock a pending read
+    auto& pendingRead = pendingReads_.front().get();
+    pendingRead.data.emplace(key, Value(std::forward<ValueT>(value)));
+    pendingRead.baton.post();
+    pendingReads_.pop_front();
+  } else {
+    // Add key into the queue
+    keys_.emplace_back(key);
+    values_.emplace(key, Value(std::forward<ValueT>(value)));
+  }
+
+  return true;
+}
+
+template <typename Key, typename Value, typename Hash>
+folly::Expected<std::pair<Key, Value>, QueueError>
+ConflatingQueue<Key, Value, Hash>::get() {
+  PendingRead pendingRead;
+
+  // Queue is closed
+  auto maybeImmediateRead = getAnyImpl(pendingRead);
+  if (maybeImmediateRead.hasError()) {
+    return folly::makeUnexpected(maybeImmediateRead.error());
+  }
+
+  // Post our own baton if read is immediate
+  if (maybeImmediateRead.value()) {
+    CHECK(pendingRead.data);
+    pendingRead.baton.post();
+  }
+
+  // Wait for baton and read the data
+  pendingRead.baton.wait();
+  if (pendingRead.data) {
+    std::lock_guard<std::mutex> l(lock_);
+    ++reads_;
+    return std::move(pendingRead.data).value();
+  }
+  return folly::makeUnexpected(QueueError::QUEUE_CLOSED);
+}
+
+template <typename Key, typename Value, typename Hash>
+folly::Expected<std::vector<std::pair<Key, Value>>, QueueError>
+ConflatingQueue<Key, Value, Hash>::getBatch(size_t maxItems) {
+  CHECK_GT(maxItems, 0);
+  auto maybeData = get();
+  if (maybeData.hasError()) {
+    return folly::makeUnexpected(maybeData.error());
+  }
+  std::vector<std::pair<Key, Value>> batch;
+  batch.emplace_back(std::move(maybeData).value());
+
+  // Move keys already pending, without waiting for more
+  std::lock_guard<std::mutex> l(lock_);
+  while (batch.size() < maxItems and keys_.size()) {
+    batch.emplace_back(popFront());
+    ++reads_;
+  }
+  return batch;
+}
+
+#if FOLLY_HAS_COROUTINES
+template <typename Key, typename Value, typename Hash>
+folly::coro::Task<folly::Expected<std::pair<Key, Value>, QueueError>>
+ConflatingQueue<Key, Value, Hash>::getCoro() {
+  PendingRead pendingRead;
+
+  // Queue is closed
+  auto maybeImmediateRead = getAnyImpl(pendingRead);
+  if (maybeImmediateRead.hasError()) {
+    co_return folly::makeUnexpected(maybeImmediateRead.error());
+  }
+
+  // Wait if there is no data
+  if (maybeImmediateRead.value()) {
+    CHECK(pendingRead.data);
+    pendingRead.baton.post();
+  }
+
+  // Wait for baton and read the data
+  co_await pendingRead.baton;
+  if (pendingRead.data) {
+    {
+      std::lock_guard<std::mutex> l(lock_);
+      ++reads_;
+    }
+    co_return std::move(pendingRead.data).value();
+  }
+  co_return folly::makeUnexpected(QueueError::QUEUE_CLOSED);
+}
+#endif
+
+template <typename Key, typename Value, typename Hash>
+folly::Expected<bool, QueueError>
+ConflatingQueue<Key, Value, Hash>::getAnyImpl(PendingRead& pendingRead) {
+  std::lock_guard<std::mutex> l(lock_);
+
+  // If queue is closed, return immediately
+  if (closed_) {
+    return folly::makeUnexpected(QueueError::QUEUE_CLOSED);
+  }
+
+  // Perform immediate read if data is available
+  if (keys_.size()) {
+    pendingRead.data.emplace(popFront());
+    return true;
+  }
+
+  // Else enqueue read request
+  pendingReads_.emplace_back(pendingRead);
+  return false;
+}
+
+template <typename Key, typename Value, typename Hash>
+std::pair<Key, Value>
+ConflatingQueue<Key, Value, Hash>::popFront() {
+  auto it = values_.find(keys_.front());
+  CHECK(it != values_.end());
+  std::pair<Key, Value> data(std::move(keys_.front()), std::move(it->second));
+  values_.erase(it);
+  keys_.pop_front();
+  return data;
+}
+
+template <typename Key, typename Value, typename Hash>
+void
+ConflatingQueue<Key, Value, Hash>::close() {
+  std::lock_guard<std::mutex> l(lock_);
+
+  if (not closed_) {
+    closed_ = true;
+    // Either one of these must be zero
+    assert(pendingReads_.size() == 0 || keys_.size() == 0);
+    // Set empy value to all pending reads
+    while (pendingReads_.size()) {
+      auto& pendingRead = pendingReads_.front().get();
+      pendingRead.baton.post();
+      pendingReads_.pop_front();
+    }
+    keys_.clear();
+    values_.clear();
+  }
+}
+
+template <typename Key, typename Value, typename Hash>
+bool
+ConflatingQueue<Key, Value, Hash>::isClosed() {
+  std::lock_guard<std::mutex> l(lock_);
+  return closed_;
+}
+
+template <typename Key, typename Value, typename Hash>
+std::string
+ConflatingQueue<Key, Value, Hash>::getQueueId() {
+  return queueId_;
+}
+
+template <typename Key, typename Value, typename Hash>
+size_t
+ConflatingQueue<Key, Value, Hash>::size() {
+  std::lock_guard<std::mutex> l(lock_);
+  return keys_.size();
+}
+
+template <typename Key, typename Value, typename Hash>
+size_t
+ConflatingQueue<Key, Value, Hash>::numPendingReads() {
+  std::lock_guard<std::mutex> l(lock_);
+  return pendingReads_.size();
+}
+
+template <typename Key, typename Value, typename Hash>
+size_t
+ConflatingQueue<Key, Value, Hash>::numWrites() {
+  std::lock_guard<std::mutex> l(lock_);
+  return writes_;
+}
+
+template <typename Key, typename Value, typename Hash>
+size_t
+ConflatingQueue<Key, Value, Hash>::numReads() {
+  std::lock_guard<std::mutex> l(lock_);
+  return reads_;
+}
+
+template <typename Key, typename Value, typename Hash>
+size_t
+ConflatingQueue<Key, Value, Hash>::numConflations() {
+  std::lock_guard<std::mutex> l(lock_);
+  return conflations_;
+}
+
+template <typename Key, typename Value, typename Hash>
+RWQueueStats
+ConflatingQueue<Key, Value, Hash>::getStats() {
+  std::lock_guard<std::mutex> l(lock_);
+  return RWQueueStats{queueId_, reads_, writes_, keys_.size()};
+}
+
+template <typename Key, typename Value, typename Hash>
+ReplicateConflatingQueue<Key, Value, Hash>::~ReplicateConflatingQueue() {
+  close();
+}
+
+template <typename Key, typename Value, typename Hash>
+template <typename ValueT>
+bool
+ReplicateConflatingQueue<Key, Value, Hash>::push(
+    const Key& key, ValueT&& value) {
+  std::vector<std::shared_ptr<ConflatingQueue<Key, Value, Hash>>> readers;
+
+  // Copy reader information - and cleans up stale reader
+  {
+    auto lockedReaders = readers_.wlock();
+    if (closed_) {
+      return false;
+    }
+    for (auto it = lockedReaders->begin(); it != lockedReaders->end();) {
+      if (it->use_count() == 1) {
+        (*it)->close(); // Close before erasing
+        it = lockedReaders->erase(it);
+      } else {
+        readers.emplace_back(*it); // NOTE: intentionally copying shared_ptr
+        ++it;
+      }
+    }
+    ++writes_;
+  }
+
+  // Replicate values
+  if (readers.size()) {
+    for (size_t i = 0; i < readers.size() - 1; i++) {
+      readers.at(i)->push(key, Value(value)); // Intended copy
+    }
+    // Perfect forwarding for last reader
+    readers.back()->push(key, std::forward<ValueT>(value));
+  }
+
+  return true;
+}
+
+template <typename Key, typename Value, typename Hash>
+ConflatingRQueue<Key, Value, Hash>
+ReplicateConflatingQueue<Key, Value, Hash>::getReader(
+    const std::optional<std::string>& readerId) {
+  auto lockedReaders = readers_.wlock();
+  if (closed_) {
+    throw std::runtime_error("queue is closed");
+  }
+  lockedReaders->emplace_back(
+      std::make_shared<ConflatingQueue<Key, Value, Hash>>(
+          readerId.value_or("")));
+  return ConflatingRQueue<Key, Value, Hash>(lockedReaders->back());
+}
+
+template <typename Key, typename Value, typename Hash>
+size_t
+ReplicateConflatingQueue<Key, Value, Hash>::getNumReaders() {
+  auto lockedReaders = readers_.wlock();
+  for (auto it = lockedReaders->begin(); it != lockedReaders->end();) {
+    if (it->use_count() == 1) {
+      (*it)->close(); // Close before erasing
+      it = lockedReaders->erase(it);
+    } else {
+      ++it;
+    }
+  }
+  return lockedReaders->size();
+}
+
+template <typename Key, typename Value, typename Hash>
+void
+ReplicateConflatingQueue<Key, Value, Hash>::close() {
+  auto lockedReaders = readers_.wlock();
+  closed_ = true;
+  for (auto& queue : *lockedReaders) {
+    queue->close();
+  }
+  lockedReaders->clear();
+}
+
+template <typename Key, typename Value, typename Hash>
+size_t
+ReplicateConflatingQueue<Key, Value, Hash>::getNumWrites() {
+  auto lockedReaders = readers_.wlock();
+  return writes_;
+}
+
+template <typename Key, typename Value, typename Hash>
+size_t
+ReplicateConflatingQueue<Key, Value, Hash>::getNumConflations() {
+  size_t conflations{0};
+  auto lockedReaders = readers_.wlock();
+  for (auto& queue : *lockedReaders) {
+    conflations += queue->numConflations();
+  }
+  return conflations;
+}
+
+template <typename Key, typename Value, typename Hash>
+std::vector<RWQueueStats>
+ReplicateConflatingQueue<Key, Value, Hash>::getReplicationStats() {
+  std::vector<RWQueueStats> stats;
+  uint32_t queueCount = 0;
+  auto lockedReaders = readers_.wlock();
+  for (auto it = lockedReaders->begin(); it != lockedReaders->end();) {
+    if (it->use_count() == 1) {
+      (*it)->close(); // Close before erasing
+      it = lockedReaders->erase(it);
+    } else {
+      RWQueueStats stat = (*it)->getStats();
+      if (stat.queueId.empty()) {
+        stat.queueId = std::to_string(queueCount++);
+      }
+      stats.push_back(stat);
+      ++it;
+    }
+  }
+  return stats;
+}
+
+} // namespace messaging
+} // namespace openr
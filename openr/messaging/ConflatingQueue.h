@@ -0,0 +1,270 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <folly/Expected.h>
+#include <folly/Synchronized.h>
+#include <folly/fibers/Baton.h>
+#if FOLLY_HAS_COROUTINES
+#include <folly/experimental/coro/Task.h>
+#endif
+
+#include <openr/messaging/Queue.h>
+#include <openr/messaging/ReplicateQueue.h>
+
+namespace openr {
+namespace messaging {
+
+template <typename Key, typename Value, typename Hash>
+class ConflatingQueue;
+
+/**
+ * Read-only interface for ConflatingQueue class.
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class ConflatingRQueue {
+ public:
+  explicit ConflatingRQueue(
+      std::shared_ptr<ConflatingQueue<Key, Value, Hash>> queue);
+
+  /**
+   * Blocking read for native threads/fibers. In-case of fibers, the fiber
+   * performing blocking read will be suspended.
+   */
+  folly::Expected<std::pair<Key, Value>, QueueError> get();
+
+  /**
+   * Blocking read of all pending keys, up to `maxItems`. See RQueue.
+   */
+  folly::Expected<std::vector<std::pair<Key, Value>>, QueueError> getBatch(
+      size_t maxItems);
+
+#if FOLLY_HAS_COROUTINES
+  /**
+   * Read methods for co-routines
+   */
+  folly::coro::Task<folly::Expected<std::pair<Key, Value>, QueueError>>
+  getCoro();
+#endif
+
+  // Utility function to retrieve number of pending keys in underlying queue
+  size_t size();
+
+ private:
+  std::shared_ptr<ConflatingQueue<Key, Value, Hash>> queue_{nullptr};
+};
+
+/**
+ * Queue of state-like streams, where only the latest value of every key
+ * matters. Pushing a value for a key that is still pending replaces its
+ * value in place, keeping the position of the key in the queue. Readers
+ * always get the newest value of a key, and queue memory is bounded by the
+ * number of keys rather than the number of pushes.
+ *
+ * Readers and writers behave as in RWQueue: multiple writers and readers,
+ * non-blocking push, and QUEUE_CLOSED error for reads once queue is closed.
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class ConflatingQueue {
+ public:
+  ConflatingQueue();
+  explicit ConflatingQueue(const std::string& queueId);
+  ~ConflatingQueue();
+
+  /**
+   * Non blocking push of the latest value of `key`.
+   * Return true/false!!
+   */
+  template <typename ValueT>
+  bool push(const Key& key, ValueT&& value);
+
+  /**
+   * Blocking read for native threads/fibers. Returns pending key in order it
+   * was first pushed, along with its latest value.
+   */
+  folly::Expected<std::pair<Key, Value>, QueueError> get();
+
+  /**
+   * Blocking read of all pending keys, up to `maxItems`. See RWQueue.
+   */
+  folly::Expected<std::vector<std::pair<Key, Value>>, QueueError> getBatch(
+      size_t maxItems);
+
+#if FOLLY_HAS_COROUTINES
+  /**
+   * Read methods for co-routines
+   */
+  folly::coro::Task<folly::Expected<std::pair<Key, Value>, QueueError>>
+  getCoro();
+#endif
+
+  /**
+   * Close the queue. All new push will be ignored and pending data will be lost
+   */
+  void close();
+  bool isClosed();
+
+  /**
+   * Get the queue id (name)
+   */
+  std::string getQueueId();
+
+  /**
+   * Return number of pending keys
+   */
+  size_t size();
+
+  /**
+   * Return number of active reads
+   */
+  size_t numPendingReads();
+
+  /**
+   * Return the number of values pushed to the queue
+   */
+  size_t numWrites();
+
+  /**
+   * Return the number of values processed by readers
+   */
+  size_t numReads();
+
+  /**
+   * Return the number of pending values replaced by a newer one
+   */
+  size_t numConflations();
+
+  /**
+   * Package and return the individual queue stats.
+   */
+  RWQueueStats getStats();
+
+ private:
+  // Name/id of the queue
+  std::string queueId_{""};
+
+  struct PendingRead {
+    folly::fibers::Baton baton;
+    std::optional<std::pair<Key, Value>> data;
+  };
+
+  /**
+   * Implementation for reading a pending or future key.
+   *
+   * @returns true/false indicating if immediate read is performed
+   * @returns QUEUE_CLOSED error if queue is closed.
+   */
+  folly::Expected<bool, QueueError> getAnyImpl(PendingRead& pendingRead);
+
+  // Pop the first pending key along with its value. Lock must be held.
+  std::pair<Key, Value> popFront();
+
+  // Lock to protect below private variables
+  std::mutex lock_;
+
+  // State of queue
+  bool closed_{false};
+
+  // Pending reads - readers are actively waiting for data
+  std::deque<std::reference_wrapper<PendingRead>> pendingReads_;
+
+  // Pending keys in order of their first push, and latest value of each
+  std::deque<Key> keys_;
+  std::unordered_map<Key, Value, Hash> values_;
+
+  // Pushed values
+  size_t writes_{0};
+
+  // Received values
+  size_t reads_{0};
+
+  // Pushed values replacing a pending one
+  size_t conflations_{0};
+};
+
+/**
+ * Replicated flavor of ConflatingQueue. Each reader gets latest value of
+ * every key pushed by every writer, conflated per reader, so that a slow
+ * reader doesn't hold back others nor go through stale values.
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class ReplicateConflatingQueue : public ReplicateQueueBase {
+ public:
+  ReplicateConflatingQueue() = default;
+
+  ~ReplicateConflatingQueue() override;
+
+  /**
+   * non-copyable
+   */
+  ReplicateConflatingQueue(ReplicateConflatingQueue const&) = delete;
+  ReplicateConflatingQueue& operator=(ReplicateConflatingQueue const&) =
+      delete;
+
+  /**
+   * Push latest value of `key`. Will get replicated to all the readers.
+   * This also cleans up any lingering queue which has no active reader
+   */
+  template <typename ValueT>
+  bool push(const Key& key, ValueT&& value);
+
+  /**
+   * Get new reader stream of this queue. Stream will get closed automatically
+   * when reader is destructed.
+   */
+  ConflatingRQueue<Key, Value, Hash> getReader(
+      const std::optional<std::string>& readerId = std::nullopt);
+
+  /**
+   * Number of replicated streams/readers
+   */
+  size_t getNumReaders() override;
+
+  /**
+   * Close the underlying queue. All subsequent writes and reads will fails.
+   */
+  void close();
+
+  /**
+   * Number of values pushed on queue before replication
+   */
+  size_t getNumWrites() override;
+
+  /**
+   * Number of pending values replaced by a newer one, summed across readers
+   */
+  size_t getNumConflations();
+
+  /**
+   * Queue stats for each replicated queue
+   */
+  std::vector<RWQueueStats> getReplicationStats() override;
+
+ private:
+  folly::Synchronized<
+      std::list<std::shared_ptr<ConflatingQueue<Key, Value, Hash>>>>
+      readers_;
+  bool closed_{false}; // Protected by above Synchronized lock
+  size_t writes_{0};
+};
+
+} // namespace messaging
+} // namespace openr
+
+#include <openr/messaging/ConflatingQueue-inl.h>
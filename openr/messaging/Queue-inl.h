@@ -24,6 +24,12 @@ RQueue<ValueType>::get() {
   return queue_->get();
 }
 
+template <typename ValueType>
+folly::Expected<std::vector<ValueType>, QueueError>
+RQueue<ValueType>::getBatch(size_t maxItems) {
+  return queue_->getBatch(maxItems);
+}
+
 #if FOLLY_HAS_COROUTINES
 template <typename ValueType>
 folly::coro::Task<folly::Expected<ValueType, QueueError>>
@@ -31,6 +37,13 @@ RQueue<ValueType>::getCoro() {
   auto val = co_await queue_->getCoro();
   co_return val;
 }
+
+template <typename ValueType>
+folly::coro::Task<folly::Expected<std::vector<ValueType>, QueueError>>
+RQueue<ValueType>::getBatchCoro(size_t maxItems) {
+  auto vals = co_await queue_->getBatchCoro(maxItems);
+  co_return vals;
+}
 #endif
 
 template <typename ValueType>
@@ -49,7 +62,17 @@ template <typename ValueType>
 RWQueue<ValueType>::RWQueue() {}
 
 template <typename ValueType>
-RWQueue<ValueType>::RWQueue(const std::string& queueId) : queueId_(queueId) {}
+RWQueue<ValueType>::RWQueue(QueueBackend backend)
+    : RWQueue(std::string{""}, backend) {}
+
+template <typename ValueType>
+RWQueue<ValueType>::RWQueue(const std::string& queueId, QueueBackend backend)
+    : queueId_(queueId), backend_(backend) {
+  if (backend_ == QueueBackend::LOCK_FREE_MPSC) {
+    mpscQueue_ = std::make_unique<
+        folly::UMPSCQueue<ValueType, false /* MayBlock */>>();
+  }
+}
 
 template <typename ValueType>
 RWQueue<ValueType>::~RWQueue() {
@@ -60,22 +83,58 @@ template <typename ValueType>
 template <typename ValueTypeT>
 bool
 RWQueue<ValueType>::push(ValueTypeT&& val) {
-  std::lock_guard<std::mutex> l(lock_);
+  if (backend_ == QueueBackend::LOCK_FREE_MPSC) {
+    // If queue is closed, don't enqueue
+    if (closed_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    mpscQueue_->enqueue(ValueType(std::forward<ValueTypeT>(val)));
+    writes_.fetch_add(1, std::memory_order_relaxed);
+
+    // Wake up the reader if it is waiting. Pairs with the fence of reader
+    // between publishing `mpscWaiter_` and re-checking the queue.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (mpscWaiter_.load(std::memory_order_relaxed)) {
+      if (auto* baton = mpscWaiter_.exchange(nullptr)) {
+        baton->post();
+      }
+    }
+    return true;
+  }
+
+  std::unique_lock<std::mutex> l(lock_);
+
+  // Make room for data if queue is full. Pending reads imply empty queue.
+  while (capacity_ and queue_.size() >= capacity_ and not closed_) {
+    if (overflowPolicy_ == QueueOverflowPolicy::DROP_OLDEST) {
+      queue_.pop_front();
+      ++drops_;
+      continue;
+    }
+    folly::fibers::Baton baton;
+    pendingWrites_.emplace_back(baton);
+    l.unlock();
+    baton.wait();
+    l.lock();
+  }
 
   // If queue is closed, don't enqueue
   if (closed_) {
     return false;
   }
 
+  const auto now = std::chrono::steady_clock::now();
   if (pendingReads_.size()) {
-    // Unblock a pending read
+    // Unblock a pending read, data is handed over without queueing
     auto& pendingRead = pendingReads_.front().get();
     pendingRead.data.emplace(std::forward<ValueTypeT>(val));
     pendingRead.baton.post();
     pendingReads_.pop_front();
+    latency_.addValue(std::chrono::microseconds(0), now);
   } else {
     // Add data into the queue
-    queue_.emplace_back(std::forward<ValueTypeT>(val));
+    queue_.emplace_back(
+        QueuedData{ValueType(std::forward<ValueTypeT>(val)), now});
   }
   ++writes_;
 
@@ -85,6 +144,19 @@ RWQueue<ValueType>::push(ValueTypeT&& val) {
 template <typename ValueType>
 folly::Expected<ValueType, QueueError>
 RWQueue<ValueType>::get() {
+  if (backend_ == QueueBackend::LOCK_FREE_MPSC) {
+    while (true) {
+      auto maybeData = tryGetLockFree();
+      if (maybeData.hasError()) {
+        return folly::makeUnexpected(maybeData.error());
+      }
+      if (maybeData->has_value()) {
+        return std::move(maybeData->value());
+      }
+      mpscBaton_.wait();
+    }
+  }
+
   PendingRead pendingRead;
 
   // Queue is closed
@@ -110,10 +182,51 @@ RWQueue<ValueType>::get() {
   return folly::makeUnexpected(QueueError::QUEUE_CLOSED);
 }
 
+template <typename ValueType>
+folly::Expected<std::vector<ValueType>, QueueError>
+RWQueue<ValueType>::getBatch(size_t maxItems) {
+  CHECK_GT(maxItems, 0);
+  auto maybeData = get();
+  if (maybeData.hasError()) {
+    return folly::makeUnexpected(maybeData.error());
+  }
+  std::vector<ValueType> batch;
+  batch.emplace_back(std::move(maybeData).value());
+  drainPending(batch, maxItems);
+  return batch;
+}
+
 #if FOLLY_HAS_COROUTINES
+template <typename ValueType>
+folly::coro::Task<folly::Expected<std::vector<ValueType>, QueueError>>
+RWQueue<ValueType>::getBatchCoro(size_t maxItems) {
+  CHECK_GT(maxItems, 0);
+  auto maybeData = co_await getCoro();
+  if (maybeData.hasError()) {
+    co_return folly::makeUnexpected(maybeData.error());
+  }
+  std::vector<ValueType> batch;
+  batch.emplace_back(std::move(maybeData).value());
+  drainPending(batch, maxItems);
+  co_return batch;
+}
+
 template <typename ValueType>
 folly::coro::Task<folly::Expected<ValueType, QueueError>>
 RWQueue<ValueType>::getCoro() {
+  if (backend_ == QueueBackend::LOCK_FREE_MPSC) {
+    while (true) {
+      auto maybeData = tryGetLockFree();
+      if (maybeData.hasError()) {
+        co_return folly::makeUnexpected(maybeData.error());
+      }
+      if (maybeData->has_value()) {
+        co_return std::move(maybeData->value());
+      }
+      co_await mpscBaton_;
+    }
+  }
+
   PendingRead pendingRead;
 
   // Queue is closed
@@ -150,8 +263,7 @@ RWQueue<ValueType>::getAnyImpl(PendingRead& pendingRead) {
 
   // Perform immediate read if data is available
   if (queue_.size()) {
-    pendingRead.data.emplace(std::move(queue_.front()));
-    queue_.pop_front();
+    pendingRead.data.emplace(popFront(std::chrono::steady_clock::now()));
     return true;
   }
 
@@ -160,9 +272,107 @@ RWQueue<ValueType>::getAnyImpl(PendingRead& pendingRead) {
   return false;
 }
 
+template <typename ValueType>
+folly::Expected<std::optional<ValueType>, QueueError>
+RWQueue<ValueType>::tryGetLockFree() {
+  // If queue is closed, return immediately
+  if (closed_.load(std::memory_order_acquire)) {
+    return folly::makeUnexpected(QueueError::QUEUE_CLOSED);
+  }
+
+  // Perform immediate read if data is available
+  if (auto data = mpscQueue_->try_dequeue()) {
+    reads_.fetch_add(1, std::memory_order_relaxed);
+    return std::optional<ValueType>(std::move(data).value());
+  }
+
+  // Else publish baton to writers, and check again for data written before
+  // writers could see it
+  mpscBaton_.reset();
+  mpscWaiter_.store(&mpscBaton_, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (closed_.load(std::memory_order_relaxed) or not mpscQueue_->empty()) {
+    // Take baton back and retry right away, unless a writer already took it
+    // and is posting it
+    if (mpscWaiter_.exchange(nullptr)) {
+      mpscBaton_.post();
+    }
+  }
+  return std::optional<ValueType>();
+}
+
+template <typename ValueType>
+void
+RWQueue<ValueType>::drainPending(
+    std::vector<ValueType>& batch, size_t maxItems) {
+  if (backend_ == QueueBackend::LOCK_FREE_MPSC) {
+    while (batch.size() < maxItems and not isClosed()) {
+      auto data = mpscQueue_->try_dequeue();
+      if (not data) {
+        break;
+      }
+      reads_.fetch_add(1, std::memory_order_relaxed);
+      batch.emplace_back(std::move(data).value());
+    }
+    return;
+  }
+
+  std::lock_guard<std::mutex> l(lock_);
+  const auto now = std::chrono::steady_clock::now();
+  while (batch.size() < maxItems and queue_.size()) {
+    batch.emplace_back(popFront(now));
+    ++reads_;
+  }
+}
+
+template <typename ValueType>
+ValueType
+RWQueue<ValueType>::popFront(std::chrono::steady_clock::time_point now) {
+  auto& front = queue_.front();
+  latency_.addValue(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          now - front.enqueueTime),
+      now);
+  ValueType data = std::move(front.data);
+  queue_.pop_front();
+
+  // Hand over the room to a waiting writer
+  if (pendingWrites_.size()) {
+    pendingWrites_.front().get().post();
+    pendingWrites_.pop_front();
+  }
+  return data;
+}
+
+template <typename ValueType>
+void
+RWQueue<ValueType>::setCapacity(size_t capacity, QueueOverflowPolicy policy) {
+  CHECK(backend_ == QueueBackend::LOCKED)
+      << "Capacity is only supported by LOCKED backend";
+  std::lock_guard<std::mutex> l(lock_);
+  capacity_ = capacity;
+  overflowPolicy_ = policy;
+
+  // Let waiting writers re-evaluate new limits
+  while (pendingWrites_.size()) {
+    pendingWrites_.front().get().post();
+    pendingWrites_.pop_front();
+  }
+}
+
 template <typename ValueType>
 void
 RWQueue<ValueType>::close() {
+  if (backend_ == QueueBackend::LOCK_FREE_MPSC) {
+    // Pending data is released along with the queue as only the reader may
+    // dequeue
+    closed_.store(true, std::memory_order_seq_cst);
+    if (auto* baton = mpscWaiter_.exchange(nullptr)) {
+      baton->post();
+    }
+    return;
+  }
+
   std::lock_guard<std::mutex> l(lock_);
 
   if (not closed_) {
@@ -175,6 +385,11 @@ RWQueue<ValueType>::close() {
       pendingRead.baton.post();
       pendingReads_.pop_front();
     }
+    // Release waiting writers, their push fails
+    while (pendingWrites_.size()) {
+      pendingWrites_.front().get().post();
+      pendingWrites_.pop_front();
+    }
     queue_.clear();
   }
 }
@@ -182,8 +397,7 @@ RWQueue<ValueType>::close() {
 template <typename ValueType>
 bool
 RWQueue<ValueType>::isClosed() {
-  std::lock_guard<std::mutex> l(lock_);
-  return closed_;
+  return closed_.load(std::memory_order_acquire);
 }
 
 template <typename ValueType>
@@ -195,6 +409,9 @@ RWQueue<ValueType>::getQueueId() {
 template <typename ValueType>
 size_t
 RWQueue<ValueType>::size() {
+  if (backend_ == QueueBackend::LOCK_FREE_MPSC) {
+    return isClosed() ? 0 : mpscQueue_->size();
+  }
   std::lock_guard<std::mutex> l(lock_);
   return queue_.size();
 }
@@ -202,6 +419,9 @@ RWQueue<ValueType>::size() {
 template <typename ValueType>
 size_t
 RWQueue<ValueType>::numPendingReads() {
+  if (backend_ == QueueBackend::LOCK_FREE_MPSC) {
+    return mpscWaiter_.load(std::memory_order_acquire) ? 1 : 0;
+  }
   std::lock_guard<std::mutex> l(lock_);
   return pendingReads_.size();
 }
@@ -209,22 +429,39 @@ RWQueue<ValueType>::numPendingReads() {
 template <typename ValueType>
 size_t
 RWQueue<ValueType>::numWrites() {
-  std::lock_guard<std::mutex> l(lock_);
-  return writes_;
+  return writes_.load(std::memory_order_relaxed);
 }
 
 template <typename ValueType>
 size_t
 RWQueue<ValueType>::numReads() {
+  return reads_.load(std::memory_order_relaxed);
+}
+
+template <typename ValueType>
+size_t
+RWQueue<ValueType>::numDrops() {
   std::lock_guard<std::mutex> l(lock_);
-  return reads_;
+  return drops_;
 }
 
 template <typename ValueType>
 RWQueueStats
 RWQueue<ValueType>::getStats() {
+  if (backend_ == QueueBackend::LOCK_FREE_MPSC) {
+    return RWQueueStats{"", numReads(), numWrites(), size()};
+  }
   std::lock_guard<std::mutex> l(lock_);
-  return RWQueueStats{"", reads_, writes_, queue_.size()};
+  const auto now = std::chrono::steady_clock::now();
+  return RWQueueStats{
+      "",
+      numReads(),
+      numWrites(),
+      queue_.size(),
+      drops_,
+      latency_.getPercentile(50, now).count(),
+      latency_.getPercentile(99, now).count(),
+      latency_.getMax(now).count()};
 }
 
 } // namespace messaging
@@ -8,17 +8,23 @@
 #pragma once
 
 #include <any>
+#include <atomic>
+#include <chrono>
 #include <deque>
 #include <memory>
 #include <mutex>
 #include <utility>
+#include <vector>
 
 #include <folly/Expected.h>
+#include <folly/concurrency/UnboundedQueue.h>
 #include <folly/fibers/Baton.h>
 #if FOLLY_HAS_COROUTINES
 #include <folly/experimental/coro/Task.h>
 #endif
 
+#include <openr/common/LatencyHistogram.h>
+
 namespace openr {
 namespace messaging {
 
@@ -26,14 +32,45 @@ enum class QueueError {
   QUEUE_CLOSED,
 };
 
+/**
+ * Backend storing pending data of RWQueue, picked at construction.
+ */
+enum class QueueBackend {
+  // Lock protected deque. Any number of concurrent readers and writers.
+  LOCKED,
+  // Lock-free segment based queue (folly::UMPSCQueue) with a cached baton
+  // for the reader. Any number of concurrent writers but ONE reader at a
+  // time, e.g. the single fiber/coroutine of the module owning the reader.
+  LOCK_FREE_MPSC,
+};
+
+/**
+ * What a push does to a LOCKED RWQueue holding `capacity` data elements.
+ */
+enum class QueueOverflowPolicy {
+  // Writer waits until a reader makes room. The waiting fiber is suspended,
+  // native thread is blocked; reader MUST NOT run on the same thread unless
+  // both are fibers.
+  BLOCK,
+  // Oldest pending data element is dropped to make room
+  DROP_OLDEST,
+};
+
 // Stats recording of
 struct RWQueueStats {
   std::string queueId; // TODO: Change to const post T98477650
   const size_t reads{0};
   const size_t writes{0};
   const size_t size{0};
+  // Data elements dropped on overflow
+  const size_t drops{0};
+  // Enqueue-to-dequeue latency of recent reads, see LatencyHistogram
+  const int64_t latencyP50Us{0};
+  const int64_t latencyP99Us{0};
+  const int64_t latencyMaxUs{0};
 };
 
+
 template <typename ValueType>
 class RWQueue;
 
@@ -52,11 +89,21 @@ class RQueue {
    */
   folly::Expected<ValueType, QueueError> get();
 
+  /**
+   * Blocking read of all pending data, up to `maxItems`. Waits like get() for
+   * first data element, then returns it along with the ones already queued
+   * behind it, without waiting for more.
+   */
+  folly::Expected<std::vector<ValueType>, QueueError> getBatch(
+      size_t maxItems);
+
 #if FOLLY_HAS_COROUTINES
   /**
    * Read methods for co-routines
    */
   folly::coro::Task<folly::Expected<ValueType, QueueError>> getCoro();
+  folly::coro::Task<folly::Expected<std::vector<ValueType>, QueueError>>
+  getBatchCoro(size_t maxItems);
 #endif
 
   // Utility function to retrieve size of pending data in underlying queue
@@ -84,11 +131,14 @@ template <typename ValueType>
 class RWQueue {
  public:
   RWQueue();
-  explicit RWQueue(const std::string&);
+  explicit RWQueue(QueueBackend backend);
+  explicit RWQueue(
+      const std::string&, QueueBackend backend = QueueBackend::LOCKED);
   ~RWQueue();
 
   /**
-   * Non blocking push. Any typed value can be pushed!
+   * Push any typed value. Non blocking, unless queue is full with BLOCK
+   * overflow policy.
    * Return true/false!!
    */
   template <typename ValueTypeT>
@@ -100,13 +150,30 @@ class RWQueue {
    */
   folly::Expected<ValueType, QueueError> get();
 
+  /**
+   * Blocking read of all pending data, up to `maxItems`. Waits like get() for
+   * first data element, then returns it along with the ones already queued
+   * behind it, without waiting for more.
+   */
+  folly::Expected<std::vector<ValueType>, QueueError> getBatch(
+      size_t maxItems);
+
 #if FOLLY_HAS_COROUTINES
   /**
    * Read methods for co-routines
    */
   folly::coro::Task<folly::Expected<ValueType, QueueError>> getCoro();
+  folly::coro::Task<folly::Expected<std::vector<ValueType>, QueueError>>
+  getBatchCoro(size_t maxItems);
 #endif
 
+  /**
+   * Bound number of pending data elements to `capacity` (0 for unbounded,
+   * the default), applying `policy` to pushes on a full queue. Only supported
+   * by LOCKED backend.
+   */
+  void setCapacity(size_t capacity, QueueOverflowPolicy policy);
+
   /**
    * Close the queue. All new push will be ignored and pending data will be lost
    */
@@ -139,19 +206,37 @@ class RWQueue {
   size_t numReads();
 
   /**
-   * Package and return the individual queue stats.
+   * Return the number of messages dropped on overflow
+   */
+  size_t numDrops();
+
+  /**
+   * Package and return the individual queue stats. Latency is only tracked
+   * by LOCKED backend.
    */
   RWQueueStats getStats();
 
+  QueueBackend
+  getBackend() const {
+    return backend_;
+  }
+
  private:
   // Name/id of the queue
   std::string queueId_{""};
 
+  const QueueBackend backend_{QueueBackend::LOCKED};
+
   struct PendingRead {
     folly::fibers::Baton baton;
     std::optional<ValueType> data;
   };
 
+  struct QueuedData {
+    ValueType data;
+    std::chrono::steady_clock::time_point enqueueTime;
+  };
+
   /**
    * Implementation for reading a pending or future data element.
    *
@@ -160,23 +245,66 @@ class RWQueue {
    */
   folly::Expected<bool, QueueError> getAnyImpl(PendingRead& pendingRead);
 
-  // Lock to protect below private variables
+  /**
+   * Read attempt of LOCK_FREE_MPSC backend.
+   *
+   * @returns data element if available
+   * @returns std::nullopt if reader must wait on `mpscBaton_` and retry
+   * @returns QUEUE_CLOSED error if queue is closed.
+   */
+  folly::Expected<std::optional<ValueType>, QueueError> tryGetLockFree();
+
+  /**
+   * Move data elements already queued into `batch`, without waiting, until it
+   * holds `maxItems`.
+   */
+  void drainPending(std::vector<ValueType>& batch, size_t maxItems);
+
+  /**
+   * Pop the oldest data element of LOCKED backend, recording its latency and
+   * waking up a writer waiting for room. Lock must be held.
+   */
+  ValueType popFront(std::chrono::steady_clock::time_point now);
+
+  // Lock to protect below private variables of LOCKED backend
   std::mutex lock_;
 
   // State of queue
-  bool closed_{false};
+  std::atomic<bool> closed_{false};
 
   // Pending reads - readers are actively waiting for data
   std::deque<std::reference_wrapper<PendingRead>> pendingReads_;
 
+  // Writers waiting for room in a full queue with BLOCK overflow policy
+  std::deque<std::reference_wrapper<folly::fibers::Baton>> pendingWrites_;
+
   // Pending data
-  std::deque<ValueType> queue_;
+  std::deque<QueuedData> queue_;
+
+  // Max number of pending data elements, 0 for unbounded
+  size_t capacity_{0};
+  QueueOverflowPolicy overflowPolicy_{QueueOverflowPolicy::DROP_OLDEST};
+
+  // Messages dropped on overflow
+  size_t drops_{0};
+
+  // Enqueue-to-dequeue latency of read messages
+  LatencyHistogram latency_;
+
+  // Pending data of LOCK_FREE_MPSC backend
+  std::unique_ptr<folly::UMPSCQueue<ValueType, false /* MayBlock */>>
+      mpscQueue_;
+
+  // Baton of the single reader, reused across reads, and set for writers to
+  // post while the reader waits for data
+  folly::fibers::Baton mpscBaton_;
+  std::atomic<folly::fibers::Baton*> mpscWaiter_{nullptr};
 
   // Sent messages
-  size_t writes_{0};
+  std::atomic<size_t> writes_{0};
 
   // Received messages
-  size_t reads_{0};
+  std::atomic<size_t> reads_{0};
 };
 
 } // namespace messaging
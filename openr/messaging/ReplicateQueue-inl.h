@@ -17,6 +17,10 @@ namespace messaging {
 template <typename ValueType>
 ReplicateQueue<ValueType>::ReplicateQueue() {}
 
+template <typename ValueType>
+ReplicateQueue<ValueType>::ReplicateQueue(QueueBackend readerBackend)
+    : readerBackend_(readerBackend) {}
+
 template <typename ValueType>
 ReplicateQueue<ValueType>::~ReplicateQueue() {
   close();
@@ -26,36 +30,46 @@ template <typename ValueType>
 template <typename ValueTypeT>
 bool
 ReplicateQueue<ValueType>::push(ValueTypeT&& value) {
-  std::vector<std::shared_ptr<RWQueue<ValueType>>> readers;
+  if constexpr (
+      detail::IsSharedConstPtr<ValueType>::value and
+      not std::is_convertible_v<ValueTypeT&&, ValueType>) {
+    // Wrap plain value into shared immutable object before replication
+    using ElementType =
+        typename detail::IsSharedConstPtr<ValueType>::ElementType;
+    return push(ValueType(
+        std::make_shared<ElementType>(std::forward<ValueTypeT>(value))));
+  } else {
+    std::vector<std::shared_ptr<RWQueue<ValueType>>> readers;
 
-  // Copy reader information - and cleans up stale reader
-  {
-    auto lockedReaders = readers_.wlock();
-    if (closed_) {
-      return false;
-    }
-    for (auto it = lockedReaders->begin(); it != lockedReaders->end();) {
-      if (it->use_count() == 1) {
-        (*it)->close(); // Close before erasing
-        it = lockedReaders->erase(it);
-      } else {
-        readers.emplace_back(*it); // NOTE: intentionally copying shared_ptr
-        ++it;
+    // Copy reader information - and cleans up stale reader
+    {
+      auto lockedReaders = readers_.wlock();
+      if (closed_) {
+        return false;
+      }
+      for (auto it = lockedReaders->begin(); it != lockedReaders->end();) {
+        if (it->use_count() == 1) {
+          (*it)->close(); // Close before erasing
+          it = lockedReaders->erase(it);
+        } else {
+          readers.emplace_back(*it); // NOTE: intentionally copying shared_ptr
+          ++it;
+        }
       }
     }
-  }
 
-  // Replicate messages
-  if (readers.size()) {
-    for (size_t i = 0; i < readers.size() - 1; i++) {
-      readers.at(i)->push(ValueType(value)); // Intended copy
+    // Replicate messages
+    if (readers.size()) {
+      for (size_t i = 0; i < readers.size() - 1; i++) {
+        readers.at(i)->push(ValueType(value)); // Intended copy
+      }
+      // Perfect forwarding for last reader
+      readers.back()->push(std::forward<ValueTypeT>(value));
     }
-    // Perfect forwarding for last reader
-    readers.back()->push(std::forward<ValueTypeT>(value));
-  }
-  ++writes_;
+    ++writes_;
 
-  return true;
+    return true;
+  }
 }
 
 /**
@@ -72,13 +86,29 @@ ReplicateQueue<ValueType>::getReader(
   }
   if (readerId) {
     lockedReaders->emplace_back(
-        std::make_shared<RWQueue<ValueType>>(*readerId));
+        std::make_shared<RWQueue<ValueType>>(*readerId, readerBackend_));
   } else {
-    lockedReaders->emplace_back(std::make_shared<RWQueue<ValueType>>());
+    lockedReaders->emplace_back(
+        std::make_shared<RWQueue<ValueType>>(readerBackend_));
+  }
+  if (readerCapacity_) {
+    lockedReaders->back()->setCapacity(readerCapacity_, readerOverflowPolicy_);
   }
   return RQueue<ValueType>(lockedReaders->back());
 }
 
+template <typename ValueType>
+void
+ReplicateQueue<ValueType>::setReaderCapacity(
+    size_t capacity, QueueOverflowPolicy policy) {
+  auto lockedReaders = readers_.wlock();
+  readerCapacity_ = capacity;
+  readerOverflowPolicy_ = policy;
+  for (auto& queue : *lockedReaders) {
+    queue->setCapacity(capacity, policy);
+  }
+}
+
 template <typename ValueType>
 size_t
 ReplicateQueue<ValueType>::getNumReaders() {
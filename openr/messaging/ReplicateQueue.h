@@ -9,6 +9,8 @@
 
 #include <openr/messaging/Queue.h>
 #include <list>
+#include <memory>
+#include <type_traits>
 
 namespace openr {
 namespace messaging {
@@ -24,18 +26,41 @@ class ReplicateQueueBase {
   virtual std::vector<RWQueueStats> getReplicationStats() = 0;
 };
 
+namespace detail {
+
+// Detect shared-immutable value type, i.e. `std::shared_ptr<const T>`
+template <typename T>
+struct IsSharedConstPtr : std::false_type {};
+
+template <typename T>
+struct IsSharedConstPtr<std::shared_ptr<const T>> : std::true_type {
+  using ElementType = T;
+};
+
+} // namespace detail
+
 /**
  * Multiple writers and readers. Each reader gets every written element push by
  * every writer. Writer pays the cost of replicating data to all readers. If no
  * reader exists then all the messages are silently dropped.
  *
  * Pushed object must be copy constructible.
+ *
+ * For `ReplicateQueue<std::shared_ptr<const T>>` (see SharedReplicateQueue),
+ * replication is a reference count bump and all readers observe the very same
+ * immutable object. Pushing a plain `T` wraps it into a shared object once.
  */
 template <typename ValueType>
 class ReplicateQueue : public ReplicateQueueBase {
  public:
   ReplicateQueue();
 
+  /**
+   * Readers store pending data in `readerBackend`. With LOCK_FREE_MPSC, each
+   * reader must be read by one fiber/coroutine at a time.
+   */
+  explicit ReplicateQueue(QueueBackend readerBackend);
+
   ~ReplicateQueue();
 
   /**
@@ -64,6 +89,13 @@ class ReplicateQueue : public ReplicateQueueBase {
   RQueue<ValueType> getReader(
       const std::optional<std::string>& readerId = std::nullopt);
 
+  /**
+   * Bound pending data of every reader, current and future ones. See
+   * RWQueue::setCapacity. With BLOCK policy, a slow reader holds back push
+   * and hence every other reader.
+   */
+  void setReaderCapacity(size_t capacity, QueueOverflowPolicy policy);
+
   /**
    * Number of replicated streams/readers
    */
@@ -96,8 +128,22 @@ class ReplicateQueue : public ReplicateQueueBase {
   folly::Synchronized<std::list<std::shared_ptr<RWQueue<ValueType>>>> readers_;
   bool closed_{false}; // Protected by above Synchronized lock
   size_t writes_{0};
+  QueueBackend readerBackend_{QueueBackend::LOCKED};
+  size_t readerCapacity_{0}; // Protected by above Synchronized lock
+  QueueOverflowPolicy readerOverflowPolicy_{QueueOverflowPolicy::DROP_OLDEST};
 };
 
+/**
+ * Shared-immutable broadcast flavor of ReplicateQueue. Use it for large
+ * objects with many readers (e.g. KvStore publications) to avoid a deep copy
+ * per reader. Readers MUST NOT mutate received object; copy it if needed.
+ */
+template <typename T>
+using SharedReplicateQueue = ReplicateQueue<std::shared_ptr<const T>>;
+
+template <typename T>
+using SharedRQueue = RQueue<std::shared_ptr<const T>>;
+
 } // namespace messaging
 } // namespace openr
 
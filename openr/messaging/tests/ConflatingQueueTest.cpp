@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include <folly/executors/ManualExecutor.h>
+#include <folly/fibers/FiberManager.h>
+#include <folly/fibers/FiberManagerMap.h>
+#include <folly/io/async/EventBase.h>
+
+#include <openr/messaging/ConflatingQueue.h>
+
+using namespace openr::messaging;
+
+TEST(ConflatingQueueTest, ConflatePendingKeys) {
+  ConflatingQueue<std::string, int> q;
+
+  q.push("a", 1);
+  q.push("b", 1);
+  q.push("a", 2); // replaces pending value of "a", keeping its position
+  q.push("c", 1);
+  q.push("a", 3);
+
+  EXPECT_EQ(3, q.size());
+  EXPECT_EQ(5, q.numWrites());
+  EXPECT_EQ(2, q.numConflations());
+
+  EXPECT_EQ(std::make_pair(std::string("a"), 3), q.get().value());
+  EXPECT_EQ(std::make_pair(std::string("b"), 1), q.get().value());
+
+  // key read already is queued again
+  q.push("a", 4);
+  auto batch = q.getBatch(10).value();
+  ASSERT_EQ(2, batch.size());
+  EXPECT_EQ(std::make_pair(std::string("c"), 1), batch.at(0));
+  EXPECT_EQ(std::make_pair(std::string("a"), 4), batch.at(1));
+
+  EXPECT_EQ(0, q.size());
+  EXPECT_EQ(6, q.numWrites());
+  EXPECT_EQ(4, q.numReads());
+  EXPECT_EQ(2, q.numConflations());
+}
+
+TEST(ConflatingQueueTest, PendingReads) {
+  ConflatingQueue<int, std::string> q;
+
+  folly::EventBase evb;
+  auto& manager = folly::fibers::getFiberManager(evb);
+  manager.addTask([&q]() mutable {
+    EXPECT_EQ(std::make_pair(1, std::string("one")), q.get().value());
+    EXPECT_EQ(std::make_pair(2, std::string("two-2")), q.get().value());
+    auto x = q.get(); // Perform read until queue is closed
+    EXPECT_TRUE(x.hasError());
+    EXPECT_EQ(x.error(), QueueError::QUEUE_CLOSED);
+  });
+
+  evb.loopOnce(); // Fiber should get stuck at the read
+  EXPECT_EQ(1, q.numPendingReads());
+
+  // first push unblocks the read, others are conflated while pending
+  q.push(1, std::string("one"));
+  q.push(2, std::string("two-1"));
+  q.push(2, std::string("two-2"));
+  EXPECT_EQ(0, q.numPendingReads());
+  EXPECT_EQ(1, q.size());
+  EXPECT_EQ(1, q.numConflations());
+
+  evb.loopOnce();
+  EXPECT_EQ(1, q.numPendingReads());
+  EXPECT_EQ(0, q.size());
+
+  q.close();
+  evb.loopOnce();
+  EXPECT_TRUE(q.isClosed());
+  EXPECT_EQ(0, q.numPendingReads());
+  EXPECT_FALSE(q.push(3, std::string("three")));
+  EXPECT_EQ(q.get().error(), QueueError::QUEUE_CLOSED);
+}
+
+#if FOLLY_HAS_COROUTINES
+TEST(ConflatingQueueTest, CoroTest) {
+  auto q = std::make_shared<ConflatingQueue<int, int>>();
+  ConflatingRQueue<int, int> rq(q);
+
+  auto coroRead = [](ConflatingRQueue<int, int>& rq,
+                     std::pair<int, int> expected) -> folly::coro::Task<void> {
+    auto item = co_await rq.getCoro();
+    EXPECT_EQ(expected, item.value());
+  };
+
+  folly::ManualExecutor executor;
+  coroRead(rq, {1, 2}).scheduleOn(&executor).start();
+  executor.drive();
+  EXPECT_EQ(1, q->numPendingReads());
+
+  q->push(1, 2);
+  executor.drive();
+  EXPECT_EQ(0, q->numPendingReads());
+  EXPECT_EQ(0, rq.size());
+}
+#endif
+
+TEST(ReplicateConflatingQueueTest, Test) {
+  ReplicateConflatingQueue<std::string, int> q;
+  auto reader1 = q.getReader("reader1");
+  auto reader2 = q.getReader();
+  EXPECT_EQ(2, q.getNumReaders());
+
+  q.push("a", 1);
+  q.push("b", 1);
+  EXPECT_EQ(std::make_pair(std::string("a"), 1), reader1.get().value());
+
+  // reader2 is behind, only sees latest value of "a"
+  q.push("a", 2);
+  EXPECT_EQ(std::make_pair(std::string("b"), 1), reader1.get().value());
+  EXPECT_EQ(std::make_pair(std::string("a"), 2), reader1.get().value());
+  EXPECT_EQ(2, reader2.size());
+  EXPECT_EQ(std::make_pair(std::string("a"), 2), reader2.get().value());
+  EXPECT_EQ(std::make_pair(std::string("b"), 1), reader2.get().value());
+
+  EXPECT_EQ(3, q.getNumWrites());
+  EXPECT_EQ(1, q.getNumConflations());
+
+  auto stats = q.getReplicationStats();
+  ASSERT_EQ(2, stats.size());
+  EXPECT_EQ("reader1", stats.at(0).queueId);
+  EXPECT_EQ(3, stats.at(0).reads);
+  EXPECT_EQ(2, stats.at(1).reads);
+
+  q.close();
+  EXPECT_EQ(reader1.get().error(), QueueError::QUEUE_CLOSED);
+  EXPECT_FALSE(q.push("a", 3));
+}
@@ -10,14 +10,31 @@
 #include <folly/init/Init.h>
 #include <folly/io/async/EventBase.h>
 
+#include <openr/common/OpenrEventBase.h>
 #include <openr/messaging/Queue.h>
 #include <openr/messaging/ReplicateQueue.h>
 
+/*
+ * Like BENCHMARK_COUNTERS_PARAM(), but allows a custom name to be specified for
+ * each parameter, rather than using the parameter value.
+ */
+#define BENCHMARK_COUNTERS_NAME_PARAM(name, counters, param_name, ...) \
+  BENCHMARK_IMPL_COUNTERS(                                             \
+      FB_CONCATENATE(name, FB_CONCATENATE(_, param_name)),             \
+      FOLLY_PP_STRINGIZE(name) "(" FOLLY_PP_STRINGIZE(param_name) ")", \
+      counters,                                                        \
+      iters,                                                           \
+      unsigned,                                                        \
+      iters) {                                                         \
+    name(counters, iters, ##__VA_ARGS__);                              \
+  }
+
 namespace openr {
 
 static void
 BM_RWQueue(
     uint32_t iters,
+    const messaging::QueueBackend kBackend,
     const size_t kNumReaders,
     const size_t kNumWriters,
     const size_t kCount) {
@@ -32,7 +49,7 @@ BM_RWQueue(
   // Queue under testing. We use primitive type. This is good enough for us to
   // measure the performance overhead of messaging queue.
   //
-  messaging::RWQueue<size_t> q;
+  messaging::RWQueue<size_t> q(kBackend);
 
   //
   // Add reader tasks. Reader would continue to read as long as queue is open
@@ -105,6 +122,7 @@ BM_RWQueue(
 static void
 BM_ReplicateQueue(
     uint32_t iters,
+    const messaging::QueueBackend kBackend,
     const size_t kNumReaders,
     const size_t kNumWriters,
     const size_t kCount) {
@@ -119,7 +137,7 @@ BM_ReplicateQueue(
   // Queue under testing. We use primitive type. This is good enough for us to
   // measure the performance overhead of messaging queue.
   //
-  messaging::ReplicateQueue<size_t> q;
+  messaging::ReplicateQueue<size_t> q(kBackend);
 
   //
   // Add reader tasks. Reader would continue to read as long as queue is open
@@ -196,21 +214,176 @@ BM_ReplicateQueue(
  *
  * In our benchmark we intends to keep Number of Messages Written same. So when
  * we increase writers, we reduce number of messages per writer (third param)
+ *
+ * Each benchmark is run with the LOCKED backend and, wherever every queue has
+ * a single reader, with the LOCK_FREE_MPSC one.
+ */
+
+using messaging::QueueBackend;
+
+BENCHMARK_NAMED_PARAM(
+    BM_RWQueue, M1000000_R1_W1, QueueBackend::LOCKED, 1, 1, 1000000);
+BENCHMARK_NAMED_PARAM(
+    BM_RWQueue, M1000000_R10_W1, QueueBackend::LOCKED, 10, 1, 1000000);
+BENCHMARK_NAMED_PARAM(
+    BM_RWQueue, M1000000_R100_W1, QueueBackend::LOCKED, 100, 1, 1000000);
+BENCHMARK_NAMED_PARAM(
+    BM_RWQueue, M1000000_R1000_W1, QueueBackend::LOCKED, 1000, 1, 1000000);
+BENCHMARK_NAMED_PARAM(
+    BM_RWQueue, M1000000_R1_W10, QueueBackend::LOCKED, 1, 10, 100000);
+BENCHMARK_NAMED_PARAM(
+    BM_RWQueue, M1000000_R1_W100, QueueBackend::LOCKED, 1, 100, 10000);
+BENCHMARK_NAMED_PARAM(
+    BM_RWQueue, M1000000_R1_W1000, QueueBackend::LOCKED, 1, 1000, 1000);
+BENCHMARK_NAMED_PARAM(
+    BM_RWQueue,
+    LockFree_M1000000_R1_W1,
+    QueueBackend::LOCK_FREE_MPSC,
+    1,
+    1,
+    1000000);
+BENCHMARK_NAMED_PARAM(
+    BM_RWQueue,
+    LockFree_M1000000_R1_W10,
+    QueueBackend::LOCK_FREE_MPSC,
+    1,
+    10,
+    100000);
+BENCHMARK_NAMED_PARAM(
+    BM_RWQueue,
+    LockFree_M1000000_R1_W100,
+    QueueBackend::LOCK_FREE_MPSC,
+    1,
+    100,
+    10000);
+BENCHMARK_NAMED_PARAM(
+    BM_RWQueue,
+    LockFree_M1000000_R1_W1000,
+    QueueBackend::LOCK_FREE_MPSC,
+    1,
+    1000,
+    1000);
+
+BENCHMARK_NAMED_PARAM(
+    BM_ReplicateQueue, M1000000_R1_W1, QueueBackend::LOCKED, 1, 1, 1000000);
+BENCHMARK_NAMED_PARAM(
+    BM_ReplicateQueue, M1000000_R10_W1, QueueBackend::LOCKED, 10, 1, 1000000);
+BENCHMARK_NAMED_PARAM(
+    BM_ReplicateQueue,
+    M1000000_R100_W1,
+    QueueBackend::LOCKED,
+    100,
+    1,
+    1000000);
+BENCHMARK_NAMED_PARAM(
+    BM_ReplicateQueue, M1000000_R1_W10, QueueBackend::LOCKED, 1, 10, 100000);
+BENCHMARK_NAMED_PARAM(
+    BM_ReplicateQueue, M1000000_R1_W100, QueueBackend::LOCKED, 1, 100, 10000);
+BENCHMARK_NAMED_PARAM(
+    BM_ReplicateQueue,
+    LockFree_M1000000_R1_W1,
+    QueueBackend::LOCK_FREE_MPSC,
+    1,
+    1,
+    1000000);
+BENCHMARK_NAMED_PARAM(
+    BM_ReplicateQueue,
+    LockFree_M1000000_R10_W1,
+    QueueBackend::LOCK_FREE_MPSC,
+    10,
+    1,
+    1000000);
+BENCHMARK_NAMED_PARAM(
+    BM_ReplicateQueue,
+    LockFree_M1000000_R1_W10,
+    QueueBackend::LOCK_FREE_MPSC,
+    1,
+    10,
+    100000);
+
+/**
+ * Module-like OpenrEventBase with `kNumReaders` queues, each read by a task of
+ * OpenrEventBase::addQueueReaderTask() (coroutine if available) or of its
+ * fiber flavor. Messages are pushed one at a time and awaited, measuring time
+ * from push to callback. `fibers` counter reports fibers allocated for
+ * readers, each owning a 256KB stack.
+ */
+static void
+BM_QueueReaderTask(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    const bool kUseFiber,
+    const size_t kNumReaders,
+    const size_t kCount) {
+  auto suspender = folly::BenchmarkSuspender();
+
+  std::atomic<size_t> totalReads{0};
+  std::vector<std::shared_ptr<messaging::RWQueue<size_t>>> queues;
+  for (size_t i = 0; i < kNumReaders; ++i) {
+    queues.emplace_back(std::make_shared<messaging::RWQueue<size_t>>());
+  }
+
+  OpenrEventBase evb;
+  std::thread evbThread([&evb]() { evb.run(); });
+  evb.waitUntilRunning();
+  evb.getEvb()->runInEventBaseThreadAndWait([&]() {
+    auto callback = [&totalReads](std::vector<size_t>&& batch) {
+      totalReads += batch.size();
+    };
+    for (auto& q : queues) {
+      if (kUseFiber) {
+        evb.addQueueReaderFiberTask(
+            "benchmark", messaging::RQueue<size_t>(q), 1, callback);
+      } else {
+        evb.addQueueReaderTask(
+            "benchmark", messaging::RQueue<size_t>(q), 1, callback);
+      }
+    }
+  });
+
+  size_t expectedReads{0};
+  while (iters--) {
+    suspender.dismiss();
+    for (size_t m = 0; m < kCount; ++m) {
+      queues.at(m % kNumReaders)->push(m);
+      ++expectedReads;
+      while (totalReads != expectedReads) {
+        std::this_thread::yield();
+      }
+    }
+    suspender.rehire();
+  }
+
+  evb.getEvb()->runInEventBaseThreadAndWait([&]() {
+    counters["fibers"] =
+        folly::fibers::getFiberManager(*evb.getEvb()).fibersAllocated();
+  });
+
+  //
+  // Close queues & wait for all readers to terminate
+  //
+  for (auto& q : queues) {
+    q->close();
+  }
+  evb.stop();
+  evb.waitUntilStopped();
+  evbThread.join();
+}
+
+/**
+ * The first parameter is whether readers are fiber tasks
+ * The second parameter is the number of queues and readers
+ * The third parameter is the number of messages pushed
  */
 
-BENCHMARK_NAMED_PARAM(BM_RWQueue, M1000000_R1_W1, 1, 1, 1000000);
-BENCHMARK_NAMED_PARAM(BM_RWQueue, M1000000_R10_W1, 10, 1, 1000000);
-BENCHMARK_NAMED_PARAM(BM_RWQueue, M1000000_R100_W1, 100, 1, 1000000);
-BENCHMARK_NAMED_PARAM(BM_RWQueue, M1000000_R1000_W1, 1000, 1, 1000000);
-BENCHMARK_NAMED_PARAM(BM_RWQueue, M1000000_R1_W10, 1, 10, 100000);
-BENCHMARK_NAMED_PARAM(BM_RWQueue, M1000000_R1_W100, 1, 100, 10000);
-BENCHMARK_NAMED_PARAM(BM_RWQueue, M1000000_R1_W1000, 1, 1000, 1000);
-
-BENCHMARK_NAMED_PARAM(BM_ReplicateQueue, M1000000_R1_W1, 1, 1, 1000000);
-BENCHMARK_NAMED_PARAM(BM_ReplicateQueue, M1000000_R10_W1, 10, 1, 1000000);
-BENCHMARK_NAMED_PARAM(BM_ReplicateQueue, M1000000_R100_W1, 100, 1, 1000000);
-BENCHMARK_NAMED_PARAM(BM_ReplicateQueue, M1000000_R1_W10, 1, 10, 100000);
-BENCHMARK_NAMED_PARAM(BM_ReplicateQueue, M1000000_R1_W100, 1, 100, 10000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_QueueReaderTask, counters, Fiber_M10000_R1, true, 1, 10000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_QueueReaderTask, counters, Default_M10000_R1, false, 1, 10000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_QueueReaderTask, counters, Fiber_M10000_R16, true, 16, 10000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_QueueReaderTask, counters, Default_M10000_R16, false, 16, 10000);
 
 } // namespace openr
 
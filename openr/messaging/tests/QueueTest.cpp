@@ -106,6 +106,90 @@ TEST(RWQueueTest, OrderedPushGet) {
   EXPECT_EQ(0, q.size());
 }
 
+TEST(RWQueueTest, GetBatch) {
+  for (auto backend : {QueueBackend::LOCKED, QueueBackend::LOCK_FREE_MPSC}) {
+    RWQueue<int> q(backend);
+    for (int i = 1; i <= 5; ++i) {
+      q.push(i);
+    }
+
+    // read up to max items, the rest is left pending
+    EXPECT_EQ(std::vector<int>({1, 2, 3}), q.getBatch(3).value());
+    EXPECT_EQ(2, q.size());
+    EXPECT_EQ(std::vector<int>({4, 5}), q.getBatch(10).value());
+    EXPECT_EQ(0, q.size());
+    EXPECT_EQ(5, q.numReads());
+
+    // blocking read returns all data pushed before reader is resumed
+    folly::EventBase evb;
+    auto& manager = folly::fibers::getFiberManager(evb);
+    manager.addTask([&q]() mutable {
+      EXPECT_EQ(std::vector<int>({6, 7}), q.getBatch(10).value());
+      auto x = q.getBatch(10); // Pending read until queue is closed
+      EXPECT_TRUE(x.hasError());
+      EXPECT_EQ(x.error(), QueueError::QUEUE_CLOSED);
+    });
+
+    evb.loopOnce(); // Fiber should get stuck at the read
+    EXPECT_EQ(1, q.numPendingReads());
+    q.push(6);
+    q.push(7);
+    evb.loopOnce();
+    EXPECT_EQ(7, q.numReads());
+
+    q.close();
+    evb.loopOnce();
+    EXPECT_EQ(0, q.numPendingReads());
+  }
+}
+
+TEST(RWQueueTest, BoundedDropOldest) {
+  RWQueue<int> q;
+  q.setCapacity(2, QueueOverflowPolicy::DROP_OLDEST);
+
+  EXPECT_TRUE(q.push(1));
+  EXPECT_TRUE(q.push(2));
+  EXPECT_TRUE(q.push(3));
+  EXPECT_EQ(2, q.size());
+  EXPECT_EQ(1, q.numDrops());
+  EXPECT_EQ(3, q.numWrites());
+
+  EXPECT_EQ(std::vector<int>({2, 3}), q.getBatch(10).value());
+
+  auto stats = q.getStats();
+  EXPECT_EQ(1, stats.drops);
+  EXPECT_EQ(2, stats.reads);
+  EXPECT_LE(stats.latencyP50Us, stats.latencyP99Us);
+  EXPECT_LE(stats.latencyP99Us, stats.latencyMaxUs);
+}
+
+TEST(RWQueueTest, BoundedBlock) {
+  RWQueue<int> q;
+  q.setCapacity(1, QueueOverflowPolicy::BLOCK);
+
+  folly::EventBase evb;
+  auto& manager = folly::fibers::getFiberManager(evb);
+  manager.addTask([&q]() mutable {
+    EXPECT_TRUE(q.push(1));
+    EXPECT_TRUE(q.push(2)); // Blocks until 1 is read
+    EXPECT_FALSE(q.push(3)); // Blocks until queue is closed
+  });
+
+  evb.loopOnce(); // Writer should get stuck at second push
+  EXPECT_EQ(1, q.size());
+  EXPECT_EQ(1, q.numWrites());
+
+  EXPECT_EQ(1, q.get().value());
+  evb.loopOnce(); // Writer pushes 2 and gets stuck again
+  EXPECT_EQ(1, q.size());
+  EXPECT_EQ(2, q.numWrites());
+  EXPECT_EQ(0, q.numDrops());
+
+  q.close();
+  evb.loopOnce();
+  EXPECT_EQ(2, q.numWrites());
+}
+
 TEST(RWQueueTest, ClosedPendingReads) {
   RWQueue<int> q;
 
@@ -270,7 +354,136 @@ TEST(RWQueueTest, MultiThreadTest) {
   EXPECT_EQ(kNumWriters * kCountPerWriter, totalReads);
 }
 
+TEST(RWQueueTest, LockFreeSizeAndReaders) {
+  RWQueue<int> q(QueueBackend::LOCK_FREE_MPSC);
+  EXPECT_EQ(QueueBackend::LOCK_FREE_MPSC, q.getBackend());
+
+  q.push(1);
+  q.push(2);
+  EXPECT_EQ(2, q.size());
+  EXPECT_EQ(0, q.numPendingReads());
+  EXPECT_EQ(1, q.get().value());
+  EXPECT_EQ(2, q.get().value());
+  EXPECT_EQ(0, q.size());
+  EXPECT_EQ(2, q.numWrites());
+  EXPECT_EQ(2, q.numReads());
+
+  folly::EventBase evb;
+  auto& manager = folly::fibers::getFiberManager(evb);
+  manager.addTask([&q]() mutable {
+    EXPECT_EQ(3, q.get().value());
+    EXPECT_EQ(4, q.get().value());
+    auto x = q.get(); // Pending read until queue is closed
+    EXPECT_TRUE(x.hasError());
+    EXPECT_EQ(x.error(), QueueError::QUEUE_CLOSED);
+  });
+
+  evb.loopOnce(); // Fiber should get stuck at the read
+  EXPECT_EQ(1, q.numPendingReads());
+
+  q.push(3);
+  q.push(4);
+  evb.loopOnce();
+  EXPECT_EQ(0, q.size());
+  EXPECT_EQ(1, q.numPendingReads());
+  EXPECT_EQ(4, q.numReads());
+
+  q.close();
+  evb.loopOnce();
+  EXPECT_TRUE(q.isClosed());
+  EXPECT_EQ(0, q.numPendingReads());
+  EXPECT_FALSE(q.push(5));
+  EXPECT_EQ(q.get().error(), QueueError::QUEUE_CLOSED);
+}
+
+TEST(RWQueueTest, LockFreeMultiThreadTest) {
+  const size_t kNumWriters{16};
+  const size_t kCountPerWriter{8192};
+  RWQueue<size_t> q(QueueBackend::LOCK_FREE_MPSC);
+  std::vector<std::unique_ptr<folly::EventBase>> evbs;
+
+  // Add single reader task, verifying order of messages of every writer
+  size_t totalReads{0};
+  evbs.emplace_back(std::make_unique<folly::EventBase>());
+  folly::fibers::getFiberManager(*evbs.back()).addTask([&q, &totalReads]() {
+    std::vector<size_t> nextNums(kNumWriters, 0);
+    while (true) {
+      auto maybeNum = q.get();
+      if (maybeNum.hasError()) {
+        EXPECT_EQ(QueueError::QUEUE_CLOSED, maybeNum.error());
+        break;
+      }
+      const size_t writer = maybeNum.value() / kCountPerWriter;
+      EXPECT_EQ(nextNums.at(writer)++, maybeNum.value() % kCountPerWriter);
+      if (++totalReads == kNumWriters * kCountPerWriter) {
+        LOG(INFO) << "Closing queue";
+        q.close();
+      }
+    }
+  });
+
+  // Add writer tasks, each in its own thread
+  for (size_t i = 0; i < kNumWriters; ++i) {
+    evbs.emplace_back(std::make_unique<folly::EventBase>());
+    folly::fibers::getFiberManager(*evbs.back()).addTask([&q, i]() {
+      for (size_t j = 0; j < kCountPerWriter; ++j) {
+        q.push(i * kCountPerWriter + j);
+      }
+    });
+  }
+
+  std::vector<std::thread> evbThreads;
+  for (auto& evb : evbs) {
+    evbThreads.emplace_back([evbPtr = evb.get()]() { evbPtr->loop(); });
+  }
+  for (auto& evbThread : evbThreads) {
+    evbThread.join();
+  }
+
+  EXPECT_EQ(kNumWriters * kCountPerWriter, totalReads);
+  EXPECT_EQ(kNumWriters * kCountPerWriter, q.numWrites());
+  EXPECT_EQ(kNumWriters * kCountPerWriter, q.numReads());
+}
+
 #if FOLLY_HAS_COROUTINES
+TEST(RWQueueTest, LockFreeCoroTest) {
+  const size_t kNumWriters{16};
+  const size_t kCountPerWriter{8192};
+  RWQueue<int> q(QueueBackend::LOCK_FREE_MPSC);
+
+  size_t totalReads{0};
+  auto readerCoro = [&]() -> folly::coro::Task<void> {
+    while (true) {
+      auto item = co_await q.getCoro();
+      if (item.hasError()) {
+        break;
+      }
+      if (++totalReads == kNumWriters * kCountPerWriter) {
+        q.close();
+      }
+    }
+    co_return;
+  };
+
+  auto writerCoro = [&q](size_t count) -> folly::coro::Task<void> {
+    for (size_t i = 0; i < count; ++i) {
+      q.push(i);
+    }
+    co_return;
+  };
+
+  folly::ManualExecutor executor;
+  readerCoro().scheduleOn(&executor).start();
+  for (size_t i = 0; i < kNumWriters; ++i) {
+    writerCoro(kCountPerWriter).scheduleOn(&executor).start();
+  }
+
+  executor.drain();
+  EXPECT_EQ(kNumWriters * kCountPerWriter, totalReads);
+  EXPECT_EQ(0, q.numPendingReads());
+  EXPECT_EQ(totalReads, q.numReads());
+}
+
 TEST(RWQueueTest, CoroTest) {
   const size_t kNumReaders{16};
   const size_t kNumWriters{16};
@@ -368,5 +581,21 @@ TEST(RQueueTest, ReadTest) {
   executor.drive();
   EXPECT_EQ(0, rwq->numPendingReads());
   EXPECT_EQ(0, rwq->size());
+
+  auto coroBatchRead = [](RQueue<int>& rq, std::vector<int> expected)
+      -> folly::coro::Task<void> {
+    auto items = co_await rq.getBatchCoro(10);
+    EXPECT_EQ(expected, items.value());
+  };
+
+  rwq->push(6);
+  rwq->push(7);
+  coroBatchRead(rq, {6, 7}).scheduleOn(&executor).start();
+  executor.drive();
+  EXPECT_EQ(0, rwq->size());
 #endif
+
+  rwq->push(8);
+  rwq->push(9);
+  EXPECT_EQ(std::vector<int>({8, 9}), rq.getBatch(10).value());
 }
@@ -110,3 +110,35 @@ TEST(ReplicateQueueTest, OpenQueueTest) {
 
   q.close();
 }
+
+TEST(ReplicateQueueTest, SharedQueueTest) {
+  SharedReplicateQueue<std::string> q;
+  auto r1 = q.getReader("r1");
+  auto r2 = q.getReader("r2");
+
+  // push plain value, it gets wrapped into shared object once
+  EXPECT_TRUE(q.push(std::string("hello world")));
+
+  // push shared object directly
+  auto val = std::make_shared<const std::string>("foo bar");
+  EXPECT_TRUE(q.push(val));
+  EXPECT_EQ(2, q.getNumWrites());
+
+  // all readers see the very same object
+  auto v1 = r1.get();
+  auto v2 = r2.get();
+  ASSERT_TRUE(v1.hasValue());
+  ASSERT_TRUE(v2.hasValue());
+  EXPECT_EQ("hello world", *v1.value());
+  EXPECT_EQ(v1.value().get(), v2.value().get());
+
+  v1 = r1.get();
+  v2 = r2.get();
+  ASSERT_TRUE(v1.hasValue());
+  ASSERT_TRUE(v2.hasValue());
+  EXPECT_EQ(val.get(), v1.value().get());
+  EXPECT_EQ(val.get(), v2.value().get());
+  EXPECT_EQ(3, val.use_count());
+
+  q.close();
+}
@@ -7,6 +7,9 @@
 
 #include "openr/monitor/LogSample.h"
 
+#include <type_traits>
+
+#include <fmt/format.h>
 #include <folly/DynamicConverter.h>
 #include <folly/json.h>
 
@@ -23,6 +26,52 @@ const std::string STRINGTAGSET_KEY{"tagset"};
 
 const std::string kTimeCol{"time"};
 
+// Value of `key` out of `values`, throws if it doesn't exist
+template <typename Values>
+const typename Values::mapped_type&
+getValue(
+    const Values& values, folly::StringPiece keyType, folly::StringPiece key) {
+  auto it = values.find(key.str());
+  if (it == values.end()) {
+    throw std::invalid_argument(
+        fmt::format("invalid key: {} with keyType: {} ", key, keyType));
+  }
+  return it->second;
+}
+
+// Render non-empty `values` as json object of `keyType`
+template <typename Values>
+void
+addJsonObject(
+    folly::dynamic& json, const std::string& keyType, const Values& values) {
+  if (values.empty()) {
+    return;
+  }
+  auto obj = folly::dynamic::object();
+  for (auto const& [key, value] : values) {
+    if constexpr (std::is_arithmetic_v<typename Values::mapped_type> or
+                  std::is_same_v<typename Values::mapped_type, std::string>) {
+      obj.insert(key, value);
+    } else {
+      obj.insert(key, folly::dynamic(value.begin(), value.end()));
+    }
+  }
+  json.insert(keyType, std::move(obj));
+}
+
+// Parse json object of `keyType`, if any, into `values`
+template <typename Values>
+void
+parseJsonObject(
+    const folly::dynamic& json, const std::string& keyType, Values& values) {
+  if (auto obj = json.get_ptr(keyType)) {
+    for (auto const& [key, value] : obj->items()) {
+      values[key.asString()] =
+          folly::convertTo<typename Values::mapped_type>(value);
+    }
+  }
+}
+
 } // anonymous namespace
 
 namespace openr {
@@ -31,9 +80,7 @@ LogSample::LogSample() : LogSample(std::chrono::system_clock::now()) {}
 
 LogSample::LogSample(std::chrono::system_clock::time_point timestamp)
     : timestamp_(timestamp) {
-  json_ = folly::dynamic::object;
-
-  // add the timestamp to the json sample
+  // add the timestamp to the sample
   addInt(
       kTimeCol,
       std::chrono::duration_cast<std::chrono::seconds>(
@@ -43,7 +90,13 @@ LogSample::LogSample(std::chrono::system_clock::time_point timestamp)
 
 LogSample::LogSample(
     folly::dynamic json, std::chrono::system_clock::time_point timestamp)
-    : json_(json), timestamp_(timestamp) {}
+    : timestamp_(timestamp) {
+  parseJsonObject(json, INT_KEY, *data_.ints_ref());
+  parseJsonObject(json, DOUBLE_KEY, *data_.doubles_ref());
+  parseJsonObject(json, STRING_KEY, *data_.strings_ref());
+  parseJsonObject(json, STRINGVECTOR_KEY, *data_.stringVectors_ref());
+  parseJsonObject(json, STRINGTAGSET_KEY, *data_.stringTagsets_ref());
+}
 
 LogSample
 LogSample::fromJson(const std::string& json) {
@@ -56,134 +109,93 @@ LogSample::fromJson(const std::string& json) {
 
 std::string
 LogSample::toJson() const {
+  folly::dynamic json = folly::dynamic::object;
+  addJsonObject(json, INT_KEY, *data_.ints_ref());
+  addJsonObject(json, DOUBLE_KEY, *data_.doubles_ref());
+  addJsonObject(json, STRING_KEY, *data_.strings_ref());
+  addJsonObject(json, STRINGVECTOR_KEY, *data_.stringVectors_ref());
+  addJsonObject(json, STRINGTAGSET_KEY, *data_.stringTagsets_ref());
+
   folly::json::serialization_opts opts;
   opts.sort_keys = true;
-  return folly::json::serialize(json_, opts);
+  return folly::json::serialize(json, opts);
 }
 
 void
 LogSample::addInt(folly::StringPiece key, int64_t value) {
-  if (json_.find(INT_KEY) == json_.items().end()) {
-    json_.insert(INT_KEY, folly::dynamic::object());
-  }
-
-  json_[INT_KEY][key] = value;
+  (*data_.ints_ref())[key.str()] = value;
 }
 
 void
 LogSample::addDouble(folly::StringPiece key, double value) {
-  if (json_.find(DOUBLE_KEY) == json_.items().end()) {
-    json_.insert(DOUBLE_KEY, folly::dynamic::object());
-  }
-
-  json_[DOUBLE_KEY][key] = value;
+  (*data_.doubles_ref())[key.str()] = value;
 }
 
 void
 LogSample::addString(folly::StringPiece key, folly::StringPiece value) {
-  if (json_.find(STRING_KEY) == json_.items().end()) {
-    json_.insert(STRING_KEY, folly::dynamic::object());
-  }
-
-  json_[STRING_KEY][key] = value;
+  (*data_.strings_ref())[key.str()] = value.str();
 }
 
 void
 LogSample::addStringVector(
     folly::StringPiece key, const std::vector<std::string>& values) {
-  if (json_.find(STRINGVECTOR_KEY) == json_.items().end()) {
-    json_.insert(STRINGVECTOR_KEY, folly::dynamic::object());
-  }
-
-  json_[STRINGVECTOR_KEY][key] = folly::dynamic(values.begin(), values.end());
+  (*data_.stringVectors_ref())[key.str()] = values;
 }
 
 void
 LogSample::addStringTagset(
     folly::StringPiece key, const std::set<std::string>& tags) {
-  if (json_.find(STRINGTAGSET_KEY) == json_.items().end()) {
-    json_.insert(STRINGTAGSET_KEY, folly::dynamic::object());
-  }
-
-  json_[STRINGTAGSET_KEY][key] = folly::dynamic(tags.begin(), tags.end());
+  (*data_.stringTagsets_ref())[key.str()] = tags;
 }
 
 int64_t
 LogSample::getInt(folly::StringPiece key) const {
-  return folly::convertTo<int64_t>(getInnerValue(INT_KEY, key));
+  return getValue(*data_.ints_ref(), INT_KEY, key);
 }
 
 double
 LogSample::getDouble(folly::StringPiece key) const {
-  return folly::convertTo<double>(getInnerValue(DOUBLE_KEY, key));
+  return getValue(*data_.doubles_ref(), DOUBLE_KEY, key);
 }
 
 std::string
 LogSample::getString(folly::StringPiece key) const {
-  return folly::convertTo<std::string>(getInnerValue(STRING_KEY, key));
+  return getValue(*data_.strings_ref(), STRING_KEY, key);
 }
 
 std::vector<std::string>
 LogSample::getStringVector(folly::StringPiece key) const {
-  return folly::convertTo<std::vector<std::string>>(
-      getInnerValue(STRINGVECTOR_KEY, key));
+  return getValue(*data_.stringVectors_ref(), STRINGVECTOR_KEY, key);
 }
 
 std::set<std::string>
 LogSample::getStringTagset(folly::StringPiece key) const {
-  return folly::convertTo<std::set<std::string>>(
-      getInnerValue(STRINGTAGSET_KEY, key));
+  return getValue(*data_.stringTagsets_ref(), STRINGTAGSET_KEY, key);
 }
 
 bool
 LogSample::isIntSet(folly::StringPiece key) const {
-  return isInnerValueSet(INT_KEY, key);
+  return data_.ints_ref()->count(key.str());
 }
 
 bool
 LogSample::isDoubleSet(folly::StringPiece key) const {
-  return isInnerValueSet(DOUBLE_KEY, key);
+  return data_.doubles_ref()->count(key.str());
 }
 
 bool
 LogSample::isStringSet(folly::StringPiece key) const {
-  return isInnerValueSet(STRING_KEY, key);
+  return data_.strings_ref()->count(key.str());
 }
 
 bool
 LogSample::isStringVectorSet(folly::StringPiece key) const {
-  return isInnerValueSet(STRINGVECTOR_KEY, key);
+  return data_.stringVectors_ref()->count(key.str());
 }
 
 bool
 LogSample::isStringTagsetSet(folly::StringPiece key) const {
-  return isInnerValueSet(STRINGTAGSET_KEY, key);
-}
-
-bool
-LogSample::isInnerValueSet(
-    folly::StringPiece keyType, folly::StringPiece key) const {
-  if (auto obj = json_.get_ptr(keyType)) {
-    if (auto data = obj->get_ptr(key)) {
-      (void)data;
-      return true;
-    }
-  }
-
-  return false;
-}
-
-const folly::dynamic&
-LogSample::getInnerValue(
-    folly::StringPiece keyType, folly::StringPiece key) const {
-  if (auto obj = json_.get_ptr(keyType)) {
-    if (auto data = obj->get_ptr(key)) {
-      return *data;
-    }
-  }
-
-  throw std::invalid_argument(
-      fmt::format("invalid key: {} with keyType: {} ", key, keyType));
+  return data_.stringTagsets_ref()->count(key.str());
 }
 
 } // namespace openr
@@ -15,6 +15,8 @@
 #include <folly/Range.h>
 #include <folly/dynamic.h>
 
+#include <openr/if/gen-cpp2/Types_types.h>
+
 namespace openr {
 
 /**
@@ -39,6 +41,10 @@ namespace openr {
  * NOTE: Timestamp is critical part of Sample as it tells when event/log was
  * generated. It must be a measurement related to system clock (no steady
  * clock) to get absolute notion of time.
+ *
+ * [Typed Log Sample] Values are kept typed in thrift::LogSampleData, which
+ * is cheap to build and pass through the log sample queue. JSON is rendered
+ * ONLY by toJson(), at the export boundary.
  */
 class LogSample {
  public:
@@ -63,6 +69,14 @@ class LogSample {
    */
   std::string toJson() const;
 
+  /**
+   * Typed values of the Sample, e.g. for binary exporters
+   */
+  const thrift::LogSampleData&
+  getData() const {
+    return data_;
+  }
+
   /**
    * Get the timestamp associated with this sample.
    */
@@ -102,13 +116,8 @@ class LogSample {
   bool isStringTagsetSet(folly::StringPiece key) const;
 
  private:
-  bool isInnerValueSet(
-      folly::StringPiece keyType, folly::StringPiece key) const;
-  const folly::dynamic& getInnerValue(
-      folly::StringPiece keyType, folly::StringPiece key) const;
-
-  // Internal json representation of this sample
-  folly::dynamic json_ = folly::dynamic::object;
+  // Typed values of this sample
+  thrift::LogSampleData data_;
 
   // Timepoint associated with this sample
   std::chrono::system_clock::time_point timestamp_;
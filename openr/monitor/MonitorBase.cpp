@@ -8,6 +8,7 @@
 #include "openr/monitor/MonitorBase.h"
 #include <folly/logging/xlog.h>
 #include <openr/common/Constants.h>
+#include <openr/common/ThreadLocalStats.h>
 
 namespace openr {
 
@@ -16,18 +17,34 @@ MonitorBase::MonitorBase(
     const std::string& category,
     messaging::RQueue<LogSample> logSampleQueue)
     : category_{category},
+      config_{config},
       maxLogEvents_{
           folly::to<uint32_t>(*config->getMonitorConfig().max_event_log_ref())},
       startTime_{std::chrono::steady_clock::now()} {
   // Initialize stats counter
   fb303::fbData->addStatExportType("monitor.log.publish.failure", fb303::COUNT);
+  fb303::fbData->addStatExportType("monitor.log.rate_limited", fb303::COUNT);
+
+  // Counters in shared memory are refreshed along with process counters
+  const auto& monitorConfig = config->getMonitorConfig();
+  if (auto shmName = monitorConfig.shared_counters_name_ref()) {
+    try {
+      sharedCounters_ = std::make_unique<SharedCounterRegion>(
+          *shmName, *monitorConfig.shared_counters_capacity_ref());
+    } catch (const std::exception& e) {
+      XLOG(ERR) << "Failed to export counters in shared memory. Error: "
+                << folly::exceptionStr(e);
+    }
+  }
 
   // Periodically set process cpu/uptime/memory counter
-  setProcessCounterTimer_ =
-      folly::AsyncTimeout::make(*getEvb(), [this]() noexcept {
+  const std::chrono::seconds processCountersInterval(
+      *monitorConfig.process_counters_interval_s_ref());
+  setProcessCounterTimer_ = folly::AsyncTimeout::make(
+      *getEvb(), [this, processCountersInterval]() noexcept {
         updateProcessCounters();
-        setProcessCounterTimer_->scheduleTimeout(
-            Constants::kCounterSubmitInterval);
+        updateSharedCounters();
+        setProcessCounterTimer_->scheduleTimeout(processCountersInterval);
       });
   // Schedule an immediate timeout
   setProcessCounterTimer_->scheduleTimeout(0);
@@ -44,58 +61,146 @@ MonitorBase::MonitorBase(
     dumpHeapProfileTimer_->scheduleTimeout(0);
   }
 
-  // Fiber task to read the LogSample from queue and publish
-  addFiberTask(
-      [q = std::move(logSampleQueue), config, this]() mutable noexcept {
-        XLOG(INFO) << "Starting log sample updates processing fiber "
-                   << "with isLogSubmissionEnable() flag: "
-                   << config->isLogSubmissionEnabled();
-        while (true) {
-          // perform read log from the queue
-          auto maybeLog = q.get();
-          XLOG(DBG2) << "Received log sample update";
-          if (maybeLog.hasError()) {
-            XLOG(INFO) << "Terminating log sample updates processing fiber";
-            break;
-          }
-
-          // validate, process and publish the event logs
-          try {
-            auto inputLog = maybeLog.value();
-            // add common attributes
-            inputLog.addString("node_name", config->getNodeName());
-            inputLog.addString("domain", *config->getConfig().domain_ref());
-
-            // throws std::invalid_argument if not exist
-            inputLog.getString("event");
-
-            // add to recent log list
-            if (recentLog_.size() >= maxLogEvents_) {
-              recentLog_.pop_front();
-            }
-            recentLog_.emplace_back(inputLog.toJson());
-
-            // publish the log if enable log submission
-            if (config->isLogSubmissionEnabled()) {
-              processEventLog(inputLog);
-            }
-          } catch (const std::exception& e) {
-            fb303::fbData->addStatValue(
-                "monitor.log.publish.failure", 1, fb303::COUNT);
-            XLOG(ERR) << "Failed to publish the log. Error: "
-                      << folly::exceptionStr(e);
-          }
-        }
+  // Rate limit configured event types
+  for (auto const& [event, limit] :
+       *monitorConfig.event_log_rate_limits_ref()) {
+    eventRateLimiters_.emplace(
+        event,
+        std::make_pair(
+            folly::DynamicTokenBucket(), static_cast<double>(limit)));
+  }
+
+  // Fiber task to read batches of LogSample from queue and publish
+  XLOG(INFO) << "Log sample updates processing with isLogSubmissionEnable() "
+             << "flag: " << config->isLogSubmissionEnabled();
+  addQueueReaderFiberTask(
+      "monitor.log_samples",
+      std::move(logSampleQueue),
+      Constants::kQueueReadBatchSize,
+      [this](std::vector<LogSample>&& logSamples) {
+        processLogSamples(std::move(logSamples));
       });
 }
 
+void
+MonitorBase::processLogSamples(std::vector<LogSample>&& logSamples) {
+  fb303::fbData->addStatValue(
+      "monitor.log.batch_size", logSamples.size(), fb303::AVG);
+
+  std::vector<LogSample> eventLogs;
+  eventLogs.reserve(logSamples.size());
+  for (auto& inputLog : logSamples) {
+    // validate the event logs
+    try {
+      // throws std::invalid_argument if not exist
+      const auto event = inputLog.getString("event");
+      if (not isWithinRateLimit(event)) {
+        fb303::fbData->addStatValue(
+            "monitor.log.rate_limited", 1, fb303::COUNT);
+        continue;
+      }
+    } catch (const std::exception& e) {
+      fb303::fbData->addStatValue(
+          "monitor.log.publish.failure", 1, fb303::COUNT);
+      XLOG(ERR) << "Failed to publish the log. Error: "
+                << folly::exceptionStr(e);
+      continue;
+    }
+
+    // add common attributes
+    inputLog.addString("node_name", config_->getNodeName());
+    inputLog.addString("domain", *config_->getConfig().domain_ref());
+    eventLogs.emplace_back(std::move(inputLog));
+  }
+  if (eventLogs.empty()) {
+    return;
+  }
+
+  // add to recent log list, rendered as json on retrieval
+  const auto maxLogEvents = getMaxLogEvents();
+  recentLog_.withWLock([&](auto& recentLog) {
+    for (auto const& eventLog : eventLogs) {
+      if (maxLogEvents > 0) {
+        recentLog.emplace_back(eventLog);
+      }
+    }
+    trimRecentLog(recentLog);
+  });
+
+  // publish the logs if enable log submission
+  if (config_->isLogSubmissionEnabled()) {
+    processEventLogs(eventLogs);
+  }
+}
+
+void
+MonitorBase::processEventLogs(std::vector<LogSample> const& eventLogs) {
+  for (auto const& eventLog : eventLogs) {
+    try {
+      processEventLog(eventLog);
+    } catch (const std::exception& e) {
+      fb303::fbData->addStatValue(
+          "monitor.log.publish.failure", 1, fb303::COUNT);
+      XLOG(ERR) << "Failed to publish the log. Error: "
+                << folly::exceptionStr(e);
+    }
+  }
+}
+
+bool
+MonitorBase::isWithinRateLimit(const std::string& event) {
+  auto it = eventRateLimiters_.find(event);
+  if (it == eventRateLimiters_.end()) {
+    return true;
+  }
+  auto& [tokenBucket, limit] = it->second;
+  return tokenBucket.consume(1, limit, limit);
+}
+
+uint32_t
+MonitorBase::getMaxLogEvents() const {
+  if (memoryPressure_.load() >= MemoryPressureLevel::COMPACT_LOGS) {
+    return std::min(maxLogEvents_, Constants::kMemoryPressureMaxEventLogs);
+  }
+  return maxLogEvents_;
+}
+
+size_t
+MonitorBase::trimRecentLog(std::list<LogSample>& recentLog) const {
+  const auto maxLogEvents = getMaxLogEvents();
+  size_t numDropped{0};
+  while (recentLog.size() > maxLogEvents) {
+    recentLog.pop_front();
+    ++numDropped;
+  }
+  return numDropped;
+}
+
+void
+MonitorBase::setMemoryPressure(MemoryPressureLevel level) {
+  memoryPressure_.store(level);
+  const auto numDropped = recentLog_.withWLock(
+      [this](auto& recentLog) { return trimRecentLog(recentLog); });
+  if (numDropped > 0) {
+    fb303::fbData->addStatValue(
+        "monitor.memory_pressure.event_logs_dropped", numDropped, fb303::COUNT);
+  }
+}
+
 std::list<std::string>
 MonitorBase::getRecentEventLogs() {
-  return recentLog_;
+  std::list<std::string> recentLogs;
+  for (auto const& eventLog : *recentLog_.rlock()) {
+    recentLogs.emplace_back(eventLog.toJson());
+  }
+  return recentLogs;
 }
 
 void
 MonitorBase::updateProcessCounters() {
+  // aggregate hot path stats, see [Thread Local Stats]
+  ThreadLocalStat::flushAll();
+
   // set process.uptime.seconds counter
   const auto now = std::chrono::steady_clock::now();
   fb303::fbData->setCounter(
@@ -109,6 +214,15 @@ MonitorBase::updateProcessCounters() {
     fb303::fbData->setCounter("process.memory.rss", rssMem.value());
   }
 
+  // set process.memory.allocated/allocator_resident counters, if jemalloc
+  if (const auto allocated = SystemMetrics::getAllocatedBytes()) {
+    fb303::fbData->setCounter("process.memory.allocated", allocated.value());
+  }
+  if (const auto resident = SystemMetrics::getAllocatorResidentBytes()) {
+    fb303::fbData->setCounter(
+        "process.memory.allocator_resident", resident.value());
+  }
+
   // set process.cpu.pct counter
   const auto cpuPct = systemMetrics_.getCPUpercentage();
   if (cpuPct.has_value()) {
@@ -116,4 +230,18 @@ MonitorBase::updateProcessCounters() {
   }
 }
 
+void
+MonitorBase::updateSharedCounters() {
+  if (not sharedCounters_) {
+    return;
+  }
+  // Module threads keep updating fb303 counters as is, copy is done here
+  std::map<std::string, int64_t> counters;
+  fb303::fbData->getCounters(counters);
+  const auto failures = sharedCounters_->setCounters(counters);
+  fb303::fbData->setCounter(
+      "monitor.shared_counters.size", sharedCounters_->size());
+  fb303::fbData->setCounter("monitor.shared_counters.dropped", failures);
+}
+
 } // namespace openr
@@ -8,12 +8,16 @@
 #pragma once
 
 #include <folly/Function.h>
+#include <folly/Synchronized.h>
+#include <folly/TokenBucket.h>
 
 #include <fb303/ServiceData.h>
+#include <openr/common/MemoryPressure.h>
 #include <openr/common/OpenrEventBase.h>
 #include <openr/config/Config.h>
 #include <openr/messaging/ReplicateQueue.h>
 #include <openr/monitor/LogSample.h>
+#include <openr/monitor/SharedCounters.h>
 #include <openr/monitor/SystemMetrics.h>
 
 namespace fb303 = facebook::fb303;
@@ -23,11 +27,13 @@ namespace openr {
 /**
  * This class is a base class for Open/R monitoring. It
  * implements common functions:
- * 1. Start a fiber to read the log queue and export logs to database based on
- *    subclass's processEventLog() implementation.
- * 2. Store and return the most recent logs;
+ * 1. Start a fiber to read the log queue in batches and export logs to
+ *    database based on subclass's processEventLogs() implementation. Logs are
+ *    rate limited per event type if configured.
+ * 2. Store and return the most recent logs, rendered as JSON on retrieval;
  * 3. Export process counters: process.memory.rss, process.uptime,
  *    and process.cpu.pct
+ * 4. Optionally export all counters into shared memory, see SharedCounters.h
  */
 class MonitorBase : public OpenrEventBase {
  public:
@@ -39,6 +45,11 @@ class MonitorBase : public OpenrEventBase {
   // Get recent event logs
   std::list<std::string> getRecentEventLogs();
 
+  // [Memory Governor] Recent event logs are cut down to
+  // kMemoryPressureMaxEventLogs from COMPACT_LOGS on. Safe to call from any
+  // thread.
+  void setMemoryPressure(MemoryPressureLevel level);
+
   // Destructor
   virtual ~MonitorBase() = default;
 
@@ -50,20 +61,51 @@ class MonitorBase : public OpenrEventBase {
   // Pure virtual function for processing and publishing a log
   virtual void processEventLog(LogSample const& eventLog) = 0;
 
+  /**
+   * Process and publish a batch of valid logs. Defaults to processEventLog()
+   * of every log, override for batched submission.
+   */
+  virtual void processEventLogs(std::vector<LogSample> const& eventLogs);
+
+  // Validate, record and publish a batch of logs read off the log queue
+  void processLogSamples(std::vector<LogSample>&& logSamples);
+
+  // Check rate limit of event type of log, consuming a token if within
+  bool isWithinRateLimit(const std::string& event);
+
   // Get the heap profile
   virtual void dumpHeapProfile() = 0;
 
   // Set process counters
   void updateProcessCounters();
 
+  // Copy all counters into shared-memory region
+  void updateSharedCounters();
+
   // Common information added to each log: "domain", "node-name", etc
   LogSample commonLogToMerge_;
 
+  // Config of node, e.g. for common attributes added to each log
+  const std::shared_ptr<const Config> config_;
+
   // Number of last log events to queue
   const uint32_t maxLogEvents_{0};
 
-  // List of recent log
-  std::list<std::string> recentLog_{};
+  // [Memory Governor] level notified by Watchdog
+  std::atomic<MemoryPressureLevel> memoryPressure_{MemoryPressureLevel::NONE};
+
+  // Number of last log events to queue under current memory pressure
+  uint32_t getMaxLogEvents() const;
+
+  // Drop oldest logs past getMaxLogEvents(), returns number of dropped logs
+  size_t trimRecentLog(std::list<LogSample>& recentLog) const;
+
+  // List of recent log, read from other threads
+  folly::Synchronized<std::list<LogSample>> recentLog_{};
+
+  // Token bucket and limit in logs per second of rate limited event types
+  std::unordered_map<std::string, std::pair<folly::DynamicTokenBucket, double>>
+      eventRateLimiters_;
 
   // Timer to periodically set process cpu/uptime/memory counter
   std::unique_ptr<folly::AsyncTimeout> setProcessCounterTimer_;
@@ -76,6 +118,9 @@ class MonitorBase : public OpenrEventBase {
 
   // Get the system metrics for resource usage counters
   SystemMetrics systemMetrics_{};
+
+  // Shared-memory export of counters, if enabled
+  std::unique_ptr<SharedCounterRegion> sharedCounters_;
 };
 
 } // namespace openr
@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <system_error>
+
+#include <fmt/format.h>
+#include <folly/logging/xlog.h>
+
+#include <openr/monitor/SharedCounters.h>
+
+namespace openr {
+
+using shared_counters::Header;
+using shared_counters::Slot;
+
+namespace {
+
+size_t
+getRegionSize(uint32_t capacity) {
+  return sizeof(Header) + sizeof(Slot) * capacity;
+}
+
+/**
+ * Read a consistent value of the slot. Writer holds seq odd while updating
+ * value, so retry until the same even seq is seen before and after the read.
+ */
+int64_t
+readSlot(const Slot& slot) {
+  while (true) {
+    const auto seqBefore = slot.seq.load(std::memory_order_acquire);
+    if (seqBefore & 1) {
+      continue;
+    }
+    const auto value = slot.value.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.seq.load(std::memory_order_relaxed) == seqBefore) {
+      return value;
+    }
+  }
+}
+
+} // namespace
+
+SharedCounterRegion::SharedCounterRegion(
+    const std::string& shmName, uint32_t capacity)
+    : shmName_(shmName), capacity_(capacity) {
+  // start over on restart, stale counters must not be exported
+  shm_unlink(shmName_.c_str());
+  const int fd = shm_open(shmName_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (fd < 0) {
+    throw std::system_error(
+        errno,
+        std::generic_category(),
+        fmt::format("Failed to create shared memory {}", shmName_));
+  }
+
+  mappedSize_ = getRegionSize(capacity_);
+  if (ftruncate(fd, mappedSize_) != 0) {
+    const int err = errno;
+    close(fd);
+    shm_unlink(shmName_.c_str());
+    throw std::system_error(
+        err,
+        std::generic_category(),
+        fmt::format("Failed to size shared memory {}", shmName_));
+  }
+  mapped_ =
+      mmap(nullptr, mappedSize_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  const int err = errno;
+  close(fd);
+  if (mapped_ == MAP_FAILED) {
+    shm_unlink(shmName_.c_str());
+    throw std::system_error(
+        err,
+        std::generic_category(),
+        fmt::format("Failed to map shared memory {}", shmName_));
+  }
+
+  // slots first, header last, so region is valid once magic is seen
+  slots_ =
+      reinterpret_cast<Slot*>(static_cast<char*>(mapped_) + sizeof(Header));
+  for (uint32_t i = 0; i < capacity_; ++i) {
+    new (&slots_[i]) Slot{};
+  }
+  header_ = new (mapped_) Header{};
+  header_->version = shared_counters::kVersion;
+  header_->capacity = capacity_;
+  header_->numSlots.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  header_->magic = shared_counters::kMagic;
+
+  XLOG(INFO) << "Exporting up to " << capacity_
+             << " counters in shared memory " << shmName_;
+}
+
+SharedCounterRegion::~SharedCounterRegion() {
+  munmap(mapped_, mappedSize_);
+  shm_unlink(shmName_.c_str());
+}
+
+Slot*
+SharedCounterRegion::getSlot(const std::string& key) {
+  {
+    auto keyToSlot = keyToSlot_.rlock();
+    if (auto it = keyToSlot->find(key); it != keyToSlot->end()) {
+      return it->second;
+    }
+  }
+  if (key.size() >= shared_counters::kMaxNameLength) {
+    return nullptr;
+  }
+
+  auto keyToSlot = keyToSlot_.wlock();
+  if (auto it = keyToSlot->find(key); it != keyToSlot->end()) {
+    return it->second;
+  }
+  const auto index = header_->numSlots.load(std::memory_order_relaxed);
+  if (index >= capacity_) {
+    return nullptr;
+  }
+  auto slot = &slots_[index];
+  std::memcpy(slot->name, key.data(), key.size());
+  slot->name[key.size()] = '\0';
+  // publish the slot along with its name
+  header_->numSlots.store(index + 1, std::memory_order_release);
+  keyToSlot->emplace(key, slot);
+  return slot;
+}
+
+bool
+SharedCounterRegion::setCounter(const std::string& key, int64_t value) {
+  auto slot = getSlot(key);
+  if (not slot) {
+    return false;
+  }
+  const auto seq = slot->seq.load(std::memory_order_relaxed);
+  slot->seq.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot->value.store(value, std::memory_order_relaxed);
+  slot->seq.store(seq + 2, std::memory_order_release);
+  return true;
+}
+
+size_t
+SharedCounterRegion::setCounters(
+    const std::map<std::string, int64_t>& counters) {
+  size_t failures{0};
+  for (const auto& [key, value] : counters) {
+    failures += setCounter(key, value) ? 0 : 1;
+  }
+  return failures;
+}
+
+size_t
+SharedCounterRegion::size() const {
+  return header_->numSlots.load(std::memory_order_acquire);
+}
+
+std::optional<std::map<std::string, int64_t>>
+SharedCounterRegion::readCounters(const std::string& shmName) {
+  const int fd = shm_open(shmName.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    return std::nullopt;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 or
+      static_cast<size_t>(st.st_size) < sizeof(Header)) {
+    close(fd);
+    return std::nullopt;
+  }
+  const size_t size = st.st_size;
+  void* mapped = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    return std::nullopt;
+  }
+
+  std::optional<std::map<std::string, int64_t>> counters;
+  const auto header = static_cast<const Header*>(mapped);
+  if (header->magic == shared_counters::kMagic and
+      header->version == shared_counters::kVersion and
+      size >= getRegionSize(header->capacity)) {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const auto slots = reinterpret_cast<const Slot*>(
+        static_cast<const char*>(mapped) + sizeof(Header));
+    const auto numSlots = std::min(
+        header->numSlots.load(std::memory_order_acquire), header->capacity);
+    counters.emplace();
+    for (uint32_t i = 0; i < numSlots; ++i) {
+      const auto& slot = slots[i];
+      counters->emplace(
+          std::string(slot.name, strnlen(slot.name, sizeof(slot.name))),
+          readSlot(slot));
+    }
+  }
+  munmap(mapped, size);
+  return counters;
+}
+
+} // namespace openr
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include <folly/Synchronized.h>
+
+namespace openr {
+
+/**
+ * Layout of the shared-memory counter region. The region starts with a
+ * header, followed by `capacity` fixed size slots. Slots are allocated in
+ * order and never reused, and `numSlots` is published only once name of the
+ * new slot is written, so readers can walk slots [0, numSlots) lock free.
+ *
+ * Value of every slot is protected by a seqlock: `seq` is odd while value is
+ * being written. Readers retry while `seq` is odd or changed across the read.
+ */
+namespace shared_counters {
+
+constexpr uint64_t kMagic{0x4f50454e52435452}; // "OPENRCTR"
+constexpr uint32_t kVersion{1};
+constexpr size_t kMaxNameLength{120};
+
+struct Header {
+  uint64_t magic;
+  uint32_t version;
+  uint32_t capacity;
+  std::atomic<uint32_t> numSlots;
+};
+
+struct Slot {
+  char name[kMaxNameLength];
+  std::atomic<uint32_t> seq;
+  std::atomic<int64_t> value;
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+static_assert(std::atomic<int64_t>::is_always_lock_free);
+
+} // namespace shared_counters
+
+/**
+ * POSIX shared-memory region exporting counters to external agents, which
+ * can read all counters without any RPC nor work on Open/R threads.
+ *
+ * Counters are updated in place. Slot allocation is thread safe, however
+ * every counter must have a single writer at a time, as seqlock doesn't
+ * serialize concurrent writers.
+ */
+class SharedCounterRegion {
+ public:
+  /**
+   * Create region with room for `capacity` counters at shared-memory object
+   * `shmName` (e.g. "/openr_counters"). Existing object of the same name is
+   * replaced. Throws std::system_error on failure.
+   */
+  SharedCounterRegion(const std::string& shmName, uint32_t capacity);
+
+  // Unmap and unlink the shared-memory object
+  ~SharedCounterRegion();
+
+  /**
+   * non-copyable
+   */
+  SharedCounterRegion(SharedCounterRegion const&) = delete;
+  SharedCounterRegion& operator=(SharedCounterRegion const&) = delete;
+
+  /**
+   * Set value of counter `key`, allocating its slot on first use. Returns
+   * false if key is too long or region is full.
+   */
+  bool setCounter(const std::string& key, int64_t value);
+
+  /**
+   * Set all `counters`. Returns number of counters that couldn't be set.
+   */
+  size_t setCounters(const std::map<std::string, int64_t>& counters);
+
+  // Number of allocated slots
+  size_t size() const;
+
+  /**
+   * Read all counters of region `shmName`, as external agents would.
+   * Returns std::nullopt if region doesn't exist or has unexpected layout.
+   */
+  static std::optional<std::map<std::string, int64_t>> readCounters(
+      const std::string& shmName);
+
+ private:
+  shared_counters::Slot* getSlot(const std::string& key);
+
+  const std::string shmName_;
+  const uint32_t capacity_{0};
+  size_t mappedSize_{0};
+  void* mapped_{nullptr};
+  shared_counters::Header* header_{nullptr};
+  shared_counters::Slot* slots_{nullptr};
+
+  // Slot of every allocated counter
+  folly::Synchronized<std::unordered_map<std::string, shared_counters::Slot*>>
+      keyToSlot_;
+};
+
+} // namespace openr
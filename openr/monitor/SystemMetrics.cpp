@@ -7,12 +7,37 @@
 
 #include "openr/monitor/SystemMetrics.h"
 
+#include <fcntl.h>
+#include <unistd.h>
+#include <array>
+
 #include <folly/logging/xlog.h>
+#include <folly/memory/Malloc.h>
+#include <folly/memory/MallctlHelper.h>
 
 namespace openr {
 
 namespace {
 
+// Refreshed jemalloc stat of `name`, std::nullopt if jemalloc isn't in use
+std::optional<size_t>
+readJemallocStat(const char* name) {
+  if (not folly::usingJEMalloc()) {
+    return std::nullopt;
+  }
+  try {
+    // stats are cached by jemalloc until epoch is bumped
+    uint64_t epoch{1};
+    folly::mallctlWrite("epoch", epoch);
+    size_t value{0};
+    folly::mallctlRead(name, &value);
+    return value;
+  } catch (const std::exception& ex) {
+    XLOG(ERR) << "Failed to read jemalloc stat " << name << ": " << ex.what();
+  }
+  return std::nullopt;
+}
+
 /* Return memory the process currently used from /proc/[pid]/status.
  / The /proc is a pseudo-filesystem providing an API to kernel data
  / structures.
@@ -48,18 +73,80 @@ getMemBytes(const std::string& memoryType) {
 }
 } // namespace
 
+SystemMetrics::SystemMetrics()
+    : statmFd_(::open("/proc/self/statm", O_RDONLY | O_CLOEXEC)) {
+  if (statmFd_ < 0) {
+    XLOG(WARNING) << "Failed to open /proc/self/statm, falling back to "
+                  << "/proc/self/status for memory usage";
+  }
+}
+
+SystemMetrics::~SystemMetrics() {
+  if (statmFd_ >= 0) {
+    ::close(statmFd_);
+  }
+}
+
+std::optional<SystemMetrics::StatmMem>
+SystemMetrics::readStatm() {
+  if (statmFd_ < 0) {
+    return std::nullopt;
+  }
+  // e.g. "2500 560 300 80 0 1200 0", sizes in pages: total program size,
+  // resident set size, followed by five more fields
+  std::array<char, 128> buf;
+  const auto len = ::pread(statmFd_, buf.data(), buf.size(), 0);
+  if (len <= 0) {
+    return std::nullopt;
+  }
+  std::array<size_t, 2> pages{0, 0};
+  size_t field{0};
+  bool inField{false};
+  for (ssize_t i = 0; i < len and field < pages.size(); ++i) {
+    const char c = buf[i];
+    if (c >= '0' and c <= '9') {
+      pages[field] = pages[field] * 10 + (c - '0');
+      inField = true;
+    } else if (inField) {
+      ++field;
+      inField = false;
+    }
+  }
+  if (field < pages.size()) {
+    return std::nullopt;
+  }
+  static const size_t pageSize = ::sysconf(_SC_PAGESIZE);
+  return StatmMem{pages[0] * pageSize, pages[1] * pageSize};
+}
+
 // Return RSS memory the process currently used
 std::optional<size_t>
 SystemMetrics::getRSSMemBytes() {
+  if (const auto statm = readStatm()) {
+    return statm->rssBytes;
+  }
   return getMemBytes("VmRSS");
 }
 
 // Return virtual memory the process currently used
 std::optional<size_t>
 SystemMetrics::getVirtualMemBytes() {
+  if (const auto statm = readStatm()) {
+    return statm->virtualBytes;
+  }
   return getMemBytes("VmSize");
 }
 
+std::optional<size_t>
+SystemMetrics::getAllocatedBytes() {
+  return readJemallocStat("stats.allocated");
+}
+
+std::optional<size_t>
+SystemMetrics::getAllocatorResidentBytes() {
+  return readJemallocStat("stats.resident");
+}
+
 /* Return CPU% the process used
  / This need to be called twice to get the time difference
  / and calculate the CPU%.
@@ -93,6 +180,15 @@ SystemMetrics::getCPUpercentage() {
   return cpuPct;
 }
 
+std::optional<std::chrono::nanoseconds>
+SystemMetrics::getThreadCpuTime() {
+  struct timespec ts;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+    return std::nullopt;
+  }
+  return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+}
+
 // get current timestamp
 uint64_t
 SystemMetrics::getCurrentNanoTime() {
@@ -11,6 +11,7 @@
 #include <re2/re2.h>
 #include <sys/resource.h>
 #include <sys/time.h>
+#include <time.h>
 #include <chrono>
 #include <fstream>
 #include <optional>
@@ -23,6 +24,13 @@ namespace openr {
  */
 class SystemMetrics {
  public:
+  SystemMetrics();
+  ~SystemMetrics();
+
+  // non-copyable, owns file descriptor of /proc/self/statm
+  SystemMetrics(SystemMetrics const&) = delete;
+  SystemMetrics& operator=(SystemMetrics const&) = delete;
+
   // get RSS memory the process used, aka, memory is allocated to the process in
   // RAM.
   std::optional<size_t> getRSSMemBytes();
@@ -35,7 +43,31 @@ class SystemMetrics {
   // get CPU% the process used
   std::optional<double> getCPUpercentage();
 
+  // get CPU time the calling thread used, in user and system mode
+  static std::optional<std::chrono::nanoseconds> getThreadCpuTime();
+
+  /**
+   * get bytes allocated by the application, and bytes of physical memory
+   * mapped by the allocator, from jemalloc stats. std::nullopt if jemalloc
+   * isn't in use. Stats are refreshed by every call.
+   */
+  static std::optional<size_t> getAllocatedBytes();
+  static std::optional<size_t> getAllocatorResidentBytes();
+
  private:
+  /**
+   * Total program size and resident set size in bytes, read from
+   * /proc/self/statm through pre-opened fd, with integer only parsing
+   */
+  struct StatmMem {
+    size_t virtualBytes{0};
+    size_t rssBytes{0};
+  };
+  std::optional<StatmMem> readStatm();
+
+  // fd of /proc/self/statm, -1 if it couldn't be opened
+  int statmFd_{-1};
+
   /**
   / To record CPU used time of current process (in nanoseconds)
   */
@@ -87,6 +87,20 @@ TEST(LogSampleTest, ApiTest) {
   opts.sort_keys = true;
   auto expectedJson = folly::parseJson(jsonSample);
   EXPECT_EQ(folly::json::serialize(expectedJson, opts), sample.toJson());
+
+  // Verify typed values
+  EXPECT_EQ(123, sample.getData().ints_ref()->at("int-key"));
+  EXPECT_EQ(tags, sample.getData().stringTagsets_ref()->at("tagset-key"));
+  EXPECT_TRUE(sample.getData().stringVectors_ref()->count("vector-key"));
+
+  // Latest value of key wins
+  sample.addInt("int-key", 456);
+  EXPECT_EQ(456, sample.getInt("int-key"));
+
+  // Verify json round trip
+  auto parsed = LogSample::fromJson(sample.toJson());
+  EXPECT_EQ(sample.getData(), parsed.getData());
+  EXPECT_EQ(sample.getTimestamp(), parsed.getTimestamp());
 }
 
 TEST(LogSampleTest, fromJsonTest) {
@@ -38,6 +38,8 @@ class MonitorTestFixture : public ::testing::Test {
     openr::thrift::OpenrConfig config;
     *config.node_name_ref() = "node1";
     *config.domain_ref() = "domain1";
+    config.monitor_config_ref()->event_log_rate_limits_ref() = {
+        {"event_rate_limited", 1}};
 
     monitor = make_unique<MonitorMock>(
         std::make_unique<openr::Config>(config),
@@ -112,6 +114,35 @@ TEST_F(MonitorTestFixture, LogBasicOperation) {
   }
 }
 
+TEST_F(MonitorTestFixture, RateLimitPerEventType) {
+  // Logs beyond 1 per second of rate limited event type are dropped
+  EXPECT_CALL(*monitor, processEventLog(_)).Times(2);
+  for (int i = 0; i < 3; ++i) {
+    LogSample log;
+    log.addString("event", "event_rate_limited");
+    log.addInt("num", i);
+    eventLogUpdatesQueue.push(std::move(log));
+  }
+  LogSample lastLog;
+  lastLog.addString("event", "event_unit_test");
+  lastLog.addInt("num", 100);
+  eventLogUpdatesQueue.push(std::move(lastLog));
+
+  // Wait for the fiber to process the last log
+  while (true) {
+    const auto recentLogs = monitor->getRecentEventLogs();
+    if (not recentLogs.empty() and
+        LogSample::fromJson(recentLogs.back()).getInt("num") == 100) {
+      ASSERT_EQ(2, recentLogs.size());
+      auto sample = LogSample::fromJson(recentLogs.front());
+      EXPECT_EQ("event_rate_limited", sample.getString("event"));
+      EXPECT_EQ(0, sample.getInt("num"));
+      break;
+    }
+    std::this_thread::yield();
+  }
+}
+
 TEST_F(MonitorTestFixture, ProcessCounterTest) {
   // Wait for calling getCPUpercentage() twice for calculating the cpu% counter
   while (true) {
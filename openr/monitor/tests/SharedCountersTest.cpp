@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <openr/monitor/SharedCounters.h>
+
+#include <thread>
+
+#include <fmt/format.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace openr;
+
+namespace {
+std::string
+getShmName() {
+  return fmt::format("/openr_counters_test_{}", getpid());
+}
+} // namespace
+
+TEST(SharedCountersTest, SetAndRead) {
+  const auto shmName = getShmName();
+  {
+    SharedCounterRegion region(shmName, 2);
+    EXPECT_TRUE(region.setCounter("a", 1));
+    EXPECT_EQ(
+        1, region.setCounters({{"a", 2}, {"b", -3}, {"c", 4}})); // c dropped
+    EXPECT_FALSE(region.setCounter(std::string(200, 'x'), 1));
+    EXPECT_EQ(2, region.size());
+
+    auto counters = SharedCounterRegion::readCounters(shmName);
+    ASSERT_TRUE(counters.has_value());
+    EXPECT_EQ(
+        (std::map<std::string, int64_t>{{"a", 2}, {"b", -3}}),
+        counters.value());
+  }
+
+  // region is unlinked on destruction
+  EXPECT_FALSE(SharedCounterRegion::readCounters(shmName).has_value());
+}
+
+TEST(SharedCountersTest, ConcurrentRead) {
+  const auto shmName = getShmName();
+  SharedCounterRegion region(shmName, 16);
+  region.setCounter("counter", 0);
+
+  // writer keeps value increasing, reader must never see it go back
+  constexpr int64_t kMaxValue{100000};
+  std::thread writer([&]() {
+    for (int64_t i = 1; i <= kMaxValue; ++i) {
+      region.setCounter("counter", i);
+    }
+  });
+  int64_t lastValue{0};
+  while (lastValue < kMaxValue) {
+    auto counters = SharedCounterRegion::readCounters(shmName);
+    ASSERT_TRUE(counters.has_value());
+    const auto value = counters->at("counter");
+    EXPECT_GE(value, lastValue);
+    lastValue = value;
+  }
+  writer.join();
+}
+
+int
+main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+  google::InstallFailureSignalHandler();
+
+  return RUN_ALL_TESTS();
+}
@@ -47,6 +47,30 @@ TEST(MonitorTestFixture, SystemMetrics) {
   auto cpu2 = systemMetrics_.getCPUpercentage();
   EXPECT_TRUE(cpu2.has_value());
   EXPECT_GT(cpu2.value(), 0);
+
+  // Thread CPU time grows along with work done by the thread
+  auto threadCpu1 = SystemMetrics::getThreadCpuTime();
+  ASSERT_TRUE(threadCpu1.has_value());
+  fill(v.begin(), v.end(), 2);
+  auto threadCpu2 = SystemMetrics::getThreadCpuTime();
+  ASSERT_TRUE(threadCpu2.has_value());
+  EXPECT_GT(threadCpu2.value(), threadCpu1.value());
+}
+
+TEST(MonitorTestFixture, AllocatorMetrics) {
+  const auto allocated1 = SystemMetrics::getAllocatedBytes();
+  if (not allocated1.has_value()) {
+    GTEST_SKIP() << "jemalloc is not in use";
+  }
+  // Allocated bytes grow along with live allocations
+  std::vector<int64_t> v(0x100000, 1);
+  const auto allocated2 = SystemMetrics::getAllocatedBytes();
+  ASSERT_TRUE(allocated2.has_value());
+  EXPECT_GT(allocated2.value(), allocated1.value() + 4 * 0x100000);
+
+  const auto resident = SystemMetrics::getAllocatorResidentBytes();
+  ASSERT_TRUE(resident.has_value());
+  EXPECT_GE(resident.value(), allocated2.value());
 }
 
 int
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <openr/nl/NetlinkCache.h>
+
+namespace openr::fbnl {
+
+NetlinkCache::NetlinkCache() : snapshot_(std::make_shared<const Snapshot>()) {}
+
+std::shared_ptr<const NetlinkCache::Snapshot>
+NetlinkCache::getSnapshot() const {
+  return snapshot_.load();
+}
+
+std::optional<int>
+NetlinkCache::getIfIndex(const std::string& ifName) const {
+  auto snapshot = getSnapshot();
+  auto it = snapshot->ifNameToIndex.find(ifName);
+  if (it == snapshot->ifNameToIndex.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+std::optional<std::string>
+NetlinkCache::getIfName(int ifIndex) const {
+  auto snapshot = getSnapshot();
+  auto it = snapshot->links.find(ifIndex);
+  if (it == snapshot->links.end()) {
+    return std::nullopt;
+  }
+  return it->second.getLinkName();
+}
+
+std::optional<int>
+NetlinkCache::getLoopbackIfIndex() const {
+  return getSnapshot()->loopbackIfIndex;
+}
+
+void
+NetlinkCache::startSync() {
+  syncing_ = true;
+  eventLinks_.clear();
+  eventNeighbors_.clear();
+}
+
+void
+NetlinkCache::sync(std::vector<Link> links, std::vector<Neighbor> neighbors) {
+  // Entries updated by events are kept as is, others are replaced by dumps
+  for (auto it = links_.begin(); it != links_.end();) {
+    it = eventLinks_.count(it->first) ? std::next(it) : links_.erase(it);
+  }
+  for (auto& link : links) {
+    if (not eventLinks_.count(link.getIfIndex())) {
+      const auto ifIndex = link.getIfIndex();
+      links_.insert_or_assign(ifIndex, std::move(link));
+    }
+  }
+
+  for (auto it = neighbors_.begin(); it != neighbors_.end();) {
+    it = eventNeighbors_.count(it->first) ? std::next(it)
+                                          : neighbors_.erase(it);
+  }
+  for (auto& neighbor : neighbors) {
+    NeighborKey key{neighbor.getIfIndex(), neighbor.getDestination()};
+    if (not eventNeighbors_.count(key)) {
+      neighbors_.insert_or_assign(std::move(key), std::move(neighbor));
+    }
+  }
+
+  syncing_ = false;
+  eventLinks_.clear();
+  eventNeighbors_.clear();
+  changed_ = true;
+  synced_ = true;
+}
+
+void
+NetlinkCache::updateLink(const Link& link, bool isDeleted) {
+  if (syncing_) {
+    eventLinks_.emplace(link.getIfIndex());
+  }
+  if (isDeleted) {
+    links_.erase(link.getIfIndex());
+  } else {
+    links_.insert_or_assign(link.getIfIndex(), link);
+  }
+  changed_ = true;
+}
+
+void
+NetlinkCache::updateNeighbor(const Neighbor& neighbor, bool isDeleted) {
+  NeighborKey key{neighbor.getIfIndex(), neighbor.getDestination()};
+  if (syncing_) {
+    eventNeighbors_.emplace(key);
+  }
+  if (isDeleted) {
+    neighbors_.erase(key);
+  } else {
+    neighbors_.insert_or_assign(std::move(key), neighbor);
+  }
+  changed_ = true;
+}
+
+void
+NetlinkCache::publish() {
+  if (not changed_) {
+    return;
+  }
+
+  auto snapshot = std::make_shared<Snapshot>();
+  snapshot->links = links_;
+  snapshot->neighbors = neighbors_;
+  for (const auto& [ifIndex, link] : links_) {
+    snapshot->ifNameToIndex.emplace(link.getLinkName(), ifIndex);
+    if (link.isLoopback()) {
+      snapshot->loopbackIfIndex = ifIndex;
+    }
+  }
+  snapshot_.store(std::move(snapshot));
+  changed_ = false;
+}
+
+} // namespace openr::fbnl
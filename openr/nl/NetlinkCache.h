@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <folly/IPAddress.h>
+#include <folly/concurrency/AtomicSharedPtr.h>
+
+#include <openr/nl/NetlinkTypes.h>
+
+namespace openr::fbnl {
+
+/**
+ * Read-mostly cache of links and neighbors in kernel. It is synced from dumps
+ * once and kept up to date from events afterwards, hence lookups never need a
+ * dump.
+ *
+ * Readers get an immutable snapshot without any lock. Writer applies changes
+ * to its own copy and publishes a new snapshot with `publish()`, e.g. once per
+ * batch of events, in RCU fashion. Older snapshots live as long as readers
+ * hold them.
+ *
+ * NOTE: Reader APIs are thread-safe. Writer APIs must be invoked from a single
+ * thread, the event base of NetlinkProtocolSocket.
+ */
+class NetlinkCache {
+ public:
+  // Interface index and destination of a neighbor
+  using NeighborKey = std::pair<int, folly::IPAddress>;
+
+  struct Snapshot {
+    // Links by interface index, and index of every link name
+    std::unordered_map<int, Link> links;
+    std::unordered_map<std::string, int> ifNameToIndex;
+    std::optional<int> loopbackIfIndex;
+
+    // Neighbors by interface index and destination
+    std::map<NeighborKey, Neighbor> neighbors;
+  };
+
+  NetlinkCache();
+
+  //
+  // Reader APIs
+  //
+
+  // Set once cache has been synced from dumps. Until then lookups may miss
+  // entries existing in kernel.
+  bool
+  isSynced() const {
+    return synced_.load();
+  }
+
+  // Latest published snapshot, never null
+  std::shared_ptr<const Snapshot> getSnapshot() const;
+
+  std::optional<int> getIfIndex(const std::string& ifName) const;
+  std::optional<std::string> getIfName(int ifIndex) const;
+  std::optional<int> getLoopbackIfIndex() const;
+
+  //
+  // Writer APIs. Changes are visible to readers on `publish()`
+  //
+
+  // Dumps to sync from have been requested. Events applied until `sync()`
+  // are newer than dumps and take precedence over their entries.
+  void startSync();
+
+  // Replace entries with dumped ones, except the ones updated by events since
+  // `startSync()`
+  void sync(std::vector<Link> links, std::vector<Neighbor> neighbors);
+
+  // Apply link or neighbor event
+  void updateLink(const Link& link, bool isDeleted);
+  void updateNeighbor(const Neighbor& neighbor, bool isDeleted);
+
+  // Publish a new snapshot if anything changed since last one
+  void publish();
+
+ private:
+  // Links and neighbors of the writer. Index of link names is derived on
+  // `publish()`
+  std::unordered_map<int, Link> links_;
+  std::map<NeighborKey, Neighbor> neighbors_;
+  bool changed_{false};
+
+  // Links and neighbors updated by events while dumps are pending
+  bool syncing_{false};
+  std::unordered_set<int> eventLinks_;
+  std::set<NeighborKey> eventNeighbors_;
+
+  folly::atomic_shared_ptr<const Snapshot> snapshot_;
+  std::atomic<bool> synced_{false};
+};
+
+} // namespace openr::fbnl
@@ -8,6 +8,7 @@
 #include <folly/logging/xlog.h>
 
 #include <openr/nl/NetlinkMessageBase.h>
+#include <openr/nl/NetlinkRouteMessage.h>
 
 namespace openr::fbnl {
 
@@ -23,6 +24,94 @@ NetlinkMessageBase::NetlinkMessageBase(int type)
 
 NetlinkMessageBase::~NetlinkMessageBase() {
   CHECK(promise_.isFulfilled());
+  CHECK(not batch_) << "Batched netlink request is never completed";
+}
+
+void*
+NetlinkMessageBase::operator new(size_t size) {
+  return NetlinkMessagePool::getInstance().allocate(size);
+}
+
+void
+NetlinkMessageBase::operator delete(void* ptr, size_t size) noexcept {
+  NetlinkMessagePool::getInstance().deallocate(ptr, size);
+}
+
+NetlinkMessagePool&
+NetlinkMessagePool::getInstance() {
+  // Leaked intentionally, messages may outlive static destructors
+  static auto* pool = new NetlinkMessagePool();
+  return *pool;
+}
+
+void*
+NetlinkMessagePool::allocate(size_t size) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = freeLists_.find(size);
+    if (it != freeLists_.end() and not it->second.empty()) {
+      auto ptr = it->second.back();
+      it->second.pop_back();
+      --numFree_;
+      numHits_.fetch_add(1, std::memory_order_relaxed);
+      return ptr;
+    }
+  }
+  numMisses_.fetch_add(1, std::memory_order_relaxed);
+  return ::operator new(size);
+}
+
+void
+NetlinkMessagePool::deallocate(void* ptr, size_t size) noexcept {
+  if (not ptr) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& freeList = freeLists_[size];
+    if (freeList.size() < kMaxFreePerSize) {
+      freeList.emplace_back(ptr);
+      ++numFree_;
+      return;
+    }
+  }
+  ::operator delete(ptr);
+}
+
+size_t
+NetlinkMessagePool::getNumFree() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return numFree_;
+}
+
+NetlinkRequestBatch::NetlinkRequestBatch(
+    size_t numRequests, size_t numMessages)
+    : statuses_(numRequests, 0), numPending_(numMessages) {
+  if (numMessages == 0) {
+    promise_.setValue(std::move(statuses_));
+  }
+}
+
+folly::SemiFuture<std::vector<int>>
+NetlinkRequestBatch::getSemiFuture() {
+  return promise_.getSemiFuture();
+}
+
+void
+NetlinkRequestBatch::setReturnStatus(std::optional<size_t> index, int status) {
+  if (index.has_value()) {
+    statuses_.at(index.value()) = status;
+  }
+  // Last completed message fulfills the promise. Release ordering of the
+  // decrement makes statuses of all messages visible to it.
+  if (numPending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    promise_.setValue(std::move(statuses_));
+  }
+}
+
+void
+NetlinkMessageBase::rcvdRouteMessage(const struct nlmsghdr* nlmsg) {
+  rcvdRoute(NetlinkRouteMessage::parseMessage(nlmsg));
 }
 
 struct nlmsghdr*
@@ -94,6 +183,10 @@ NetlinkMessageBase::addAttributes(
 
 folly::SemiFuture<int>
 NetlinkMessageBase::getSemiFuture() {
+  CHECK(not batch_) << "Batched netlink request has no individual future";
+  if (not promise_.valid()) {
+    promise_ = folly::Promise<int>();
+  }
   return promise_.getSemiFuture();
 }
 
@@ -101,7 +194,23 @@ void
 NetlinkMessageBase::setReturnStatus(int status) {
   XLOG(DBG3) << "Netlink request completed. retval=" << status << ", "
              << folly::errnoStr(std::abs(status));
-  promise_.setValue(status);
+  if (batch_) {
+    auto batch = std::move(batch_);
+    batch_ = nullptr;
+    batch->setReturnStatus(batchIndex_, status);
+    return;
+  }
+  if (promise_.valid()) {
+    promise_.setValue(status);
+  }
+}
+
+void
+NetlinkMessageBase::setRequestBatch(
+    std::shared_ptr<NetlinkRequestBatch> batch, std::optional<size_t> index) {
+  CHECK(not promise_.valid()) << "Netlink request already has a future";
+  batch_ = std::move(batch);
+  batchIndex_ = index;
 }
 
 folly::Expected<folly::IPAddress, folly::IPAddressFormatError>
@@ -7,8 +7,13 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <queue>
+#include <unordered_map>
+#include <vector>
 
 #include <limits.h>
 #include <linux/lwtunnel.h>
@@ -25,6 +30,78 @@ namespace openr::fbnl {
 
 constexpr uint16_t kMaxNlPayloadSize{4096};
 
+/**
+ * Pool of memory for netlink message objects, with a free-list per object
+ * size i.e. per message type. Every message carries a `kMaxNlPayloadSize`
+ * buffer, and one is created for every request (e.g. one per route added).
+ * Memory of destroyed messages is handed out to the next messages of the
+ * same size instead of going back to the heap. At most `kMaxFreePerSize`
+ * objects per size are kept for reuse.
+ *
+ * Messages are usually created by the thread making the request and destroyed
+ * in the netlink event base thread, hence the pool is thread-safe.
+ */
+class NetlinkMessagePool {
+ public:
+  static constexpr size_t kMaxFreePerSize{1024};
+
+  // Pool shared by all netlink messages. Never destroyed.
+  static NetlinkMessagePool& getInstance();
+
+  void* allocate(size_t size);
+  void deallocate(void* ptr, size_t size) noexcept;
+
+  // Allocations served from the pool and the ones served from the heap
+  uint64_t
+  getNumHits() const {
+    return numHits_.load(std::memory_order_relaxed);
+  }
+
+  uint64_t
+  getNumMisses() const {
+    return numMisses_.load(std::memory_order_relaxed);
+  }
+
+  // Number of objects kept for reuse
+  size_t getNumFree() const;
+
+ private:
+  mutable std::mutex mutex_;
+  std::unordered_map<size_t, std::vector<void*>> freeLists_;
+  size_t numFree_{0};
+
+  std::atomic<uint64_t> numHits_{0};
+  std::atomic<uint64_t> numMisses_{0};
+};
+
+/**
+ * Aggregated status of a batch of netlink requests. Messages of a batch report
+ * their status here instead of fulfilling a promise each, and single promise
+ * with status of every request, in request order, is fulfilled once all the
+ * messages of the batch are completed.
+ *
+ * Messages can be completed from any thread, but each request index must be
+ * completed exactly once.
+ */
+class NetlinkRequestBatch {
+ public:
+  // `numRequests` is number of statuses reported and `numMessages` number of
+  // messages completing the batch. This allows auxiliary messages (e.g. delete
+  // before add) whose status is not reported.
+  NetlinkRequestBatch(size_t numRequests, size_t numMessages);
+
+  folly::SemiFuture<std::vector<int>> getSemiFuture();
+
+  // Record completion of a message. `index` is std::nullopt for auxiliary
+  // messages.
+  void setReturnStatus(std::optional<size_t> index, int status);
+
+ private:
+  std::vector<int> statuses_;
+  std::atomic<size_t> numPending_{0};
+  folly::Promise<std::vector<int>> promise_;
+};
+
 /*
  * Data structure representing a netlink message, either to be sent or received.
  * It wraps `struct nlmsghdr` and provides buffer for appending message payload.
@@ -91,6 +168,10 @@ class NetlinkMessageBase {
   // construct message with type
   explicit NetlinkMessageBase(int type);
 
+  // Messages of all types are allocated from NetlinkMessagePool
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr, size_t size) noexcept;
+
   // get pointer to NLMSG Header
   struct nlmsghdr* getMessagePtr();
 
@@ -113,6 +194,16 @@ class NetlinkMessageBase {
    *      from kernel. At the end `setReturnStatus(..)` will be invoked.
    */
 
+  // Undecoded route received from kernel. Sub-classes can inspect it before
+  // paying for decoding, which is deferred to `rcvdRoute(..)` by default.
+  virtual void rcvdRouteMessage(const struct nlmsghdr* nlmsg);
+
+  // Undecoded nexthop object received from kernel, see NetlinkNexthopMessage
+  virtual void
+  rcvdNexthopMessage(const struct nlmsghdr* /* nlmsg */) {
+    CHECK(false) << "Must be implemented by subclass";
+  }
+
   virtual void
   rcvdRoute(Route&& /* route */) {
     CHECK(false) << "Must be implemented by subclass";
@@ -154,11 +245,40 @@ class NetlinkMessageBase {
    */
   virtual void setReturnStatus(int status);
 
+  /**
+   * Make this message part of a batch. Status is reported to the batch at
+   * `index` instead of the per message promise, which is never allocated.
+   * Must be invoked before message is sent.
+   */
+  void setRequestBatch(
+      std::shared_ptr<NetlinkRequestBatch> batch, std::optional<size_t> index);
+
+  /**
+   * Batched messages are acked by kernel only on error. Success of them is
+   * implied by the ack of a later barrier message instead, see
+   * `NetlinkProtocolSocket::sendNetlinkMessage()`.
+   */
+  bool
+  isBatched() const {
+    return batch_ != nullptr;
+  }
+
   std::chrono::steady_clock::time_point
   getCreateTs() const {
     return createTs_;
   }
 
+  // Mark message as sent to kernel. Ack latency is measured from it
+  void
+  setSendTs() {
+    sendTs_ = std::chrono::steady_clock::now();
+  }
+
+  std::chrono::steady_clock::time_point
+  getSendTs() const {
+    return sendTs_;
+  }
+
   // parse IP address
   static folly::Expected<folly::IPAddress, folly::IPAddressFormatError> parseIp(
       const struct rtattr* ipAttr, unsigned char family);
@@ -201,12 +321,20 @@ class NetlinkMessageBase {
   NetlinkMessageBase(NetlinkMessageBase const&) = delete;
   NetlinkMessageBase& operator=(NetlinkMessageBase const&) = delete;
 
-  // Promise to relay the status code received from kernel
-  folly::Promise<int> promise_;
+  // Promise to relay the status code received from kernel. Allocated only
+  // when future is requested
+  folly::Promise<int> promise_{folly::Promise<int>::makeEmpty()};
+
+  // Batch this message belongs to, if any, and index of its status
+  std::shared_ptr<NetlinkRequestBatch> batch_{nullptr};
+  std::optional<size_t> batchIndex_;
 
   // Timestamp when message object was created
   const std::chrono::steady_clock::time_point createTs_{
       std::chrono::steady_clock::now()};
+
+  // Timestamp when message was sent to kernel
+  std::chrono::steady_clock::time_point sendTs_;
 };
 
 } // namespace openr::fbnl
@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/logging/xlog.h>
+
+#include <openr/nl/NetlinkNexthopMessage.h>
+
+namespace openr::fbnl {
+NetlinkNexthopMessage::NetlinkNexthopMessage() : NetlinkMessageBase() {}
+
+NetlinkNexthopMessage::~NetlinkNexthopMessage() {
+  CHECK(not nexthopsPromise_.has_value() or nexthopsPromise_->isFulfilled());
+}
+
+folly::SemiFuture<folly::Expected<std::vector<NexthopObject>, int>>
+NetlinkNexthopMessage::getNexthopsSemiFuture() {
+  nexthopsPromise_.emplace();
+  return nexthopsPromise_->getSemiFuture();
+}
+
+void
+NetlinkNexthopMessage::rcvdNexthopMessage(const struct nlmsghdr* nlmsg) {
+  rcvdNexthops_.emplace_back(parseMessage(nlmsg));
+}
+
+void
+NetlinkNexthopMessage::setReturnStatus(int status) {
+  if (nexthopsPromise_.has_value()) {
+    if (status == 0) {
+      nexthopsPromise_->setValue(std::move(rcvdNexthops_));
+    } else {
+      nexthopsPromise_->setValue(folly::makeUnexpected(status));
+    }
+  }
+  NetlinkMessageBase::setReturnStatus(status);
+}
+
+void
+NetlinkNexthopMessage::init(int type) {
+  if (type != RTM_NEWNEXTHOP && type != RTM_DELNEXTHOP &&
+      type != RTM_GETNEXTHOP) {
+    XLOG(ERR) << "Incorrect Netlink message type";
+    return;
+  }
+
+  // initialize netlink header
+  msghdr_->nlmsg_len = NLMSG_LENGTH(sizeof(struct nhmsg));
+  msghdr_->nlmsg_type = type;
+  msghdr_->nlmsg_flags = NLM_F_REQUEST | NLM_F_ACK;
+
+  if (type == RTM_GETNEXTHOP) {
+    // Get all nexthop objects
+    msghdr_->nlmsg_flags |= NLM_F_DUMP;
+  }
+
+  if (type == RTM_NEWNEXTHOP) {
+    // We create new nexthop or replace existing
+    msghdr_->nlmsg_flags |= NLM_F_CREATE;
+    msghdr_->nlmsg_flags |= NLM_F_REPLACE;
+  }
+
+  // intialize the nexthop message header
+  auto nlmsgAlen = NLMSG_ALIGN(sizeof(struct nlmsghdr));
+  nhmsg_ = reinterpret_cast<struct nhmsg*>((char*)msghdr_ + nlmsgAlen);
+  nhmsg_->nh_family = AF_UNSPEC;
+}
+
+int
+NetlinkNexthopMessage::addNexthop(
+    uint32_t id, const NextHop& nextHop, uint8_t family, uint8_t protocolId) {
+  if (nextHop.getLabelAction().has_value()) {
+    XLOG(ERR) << "MPLS nexthops are not supported as nexthop objects";
+    return EINVAL;
+  }
+  if (not nextHop.getIfIndex().has_value()) {
+    XLOG(ERR) << "Nexthop interface not provided";
+    return EINVAL;
+  }
+
+  init(RTM_NEWNEXTHOP);
+  const auto& gateway = nextHop.getGateway();
+  if (gateway.has_value()) {
+    nhmsg_->nh_family = gateway->isV4() ? AF_INET : AF_INET6;
+  } else {
+    nhmsg_->nh_family = family;
+  }
+  nhmsg_->nh_protocol = protocolId;
+
+  int status{0};
+  if ((status = addNexthopId(id))) {
+    return status;
+  }
+
+  const uint32_t ifIndex = nextHop.getIfIndex().value();
+  if ((status = addAttributes(
+           NHA_OIF,
+           reinterpret_cast<const char*>(&ifIndex),
+           sizeof(uint32_t)))) {
+    return status;
+  }
+
+  if (gateway.has_value()) {
+    const char* const gwPtr = reinterpret_cast<const char*>(gateway->bytes());
+    if ((status = addAttributes(NHA_GATEWAY, gwPtr, gateway->byteCount()))) {
+      return status;
+    }
+  }
+
+  return status;
+}
+
+int
+NetlinkNexthopMessage::addNexthopGroup(
+    uint32_t id, const NexthopGroupMembers& members, uint8_t protocolId) {
+  if (members.empty()) {
+    XLOG(ERR) << "Nexthop group must have at least one member";
+    return EINVAL;
+  }
+
+  init(RTM_NEWNEXTHOP);
+  nhmsg_->nh_protocol = protocolId;
+
+  int status{0};
+  if ((status = addNexthopId(id))) {
+    return status;
+  }
+
+  // Kernel weight is encoded as `weight - 1` same as `rtnh_hops`
+  std::vector<struct nexthop_grp> group(members.size());
+  for (size_t i = 0; i < members.size(); ++i) {
+    const auto& [memberId, weight] = members.at(i);
+    group[i].id = memberId;
+    group[i].weight = weight ? weight - 1 : 0;
+  }
+  return addAttributes(
+      NHA_GROUP,
+      reinterpret_cast<const char*>(group.data()),
+      group.size() * sizeof(struct nexthop_grp));
+}
+
+NexthopObject
+NetlinkNexthopMessage::parseMessage(const struct nlmsghdr* nlmsg) {
+  const struct nhmsg* const nhEntry =
+      reinterpret_cast<struct nhmsg*>(NLMSG_DATA(nlmsg));
+
+  NexthopObject nexthop;
+  nexthop.protocolId = nhEntry->nh_protocol;
+
+  const struct rtattr* nhAttr = reinterpret_cast<const struct rtattr*>(
+      reinterpret_cast<const char*>(nhEntry) +
+      NLMSG_ALIGN(sizeof(struct nhmsg)));
+  int nhAttrLen = NLMSG_PAYLOAD(nlmsg, sizeof(struct nhmsg));
+  // process all nexthop attributes
+  for (; RTA_OK(nhAttr, nhAttrLen); nhAttr = RTA_NEXT(nhAttr, nhAttrLen)) {
+    switch (nhAttr->rta_type) {
+    case NHA_ID: {
+      nexthop.id = *(reinterpret_cast<const uint32_t*>(RTA_DATA(nhAttr)));
+    } break;
+    case NHA_GROUP: {
+      // Kernel weight is encoded as `weight - 1` same as `rtnh_hops`
+      const auto* group =
+          reinterpret_cast<const struct nexthop_grp*>(RTA_DATA(nhAttr));
+      const size_t numMembers =
+          RTA_PAYLOAD(nhAttr) / sizeof(struct nexthop_grp);
+      for (size_t i = 0; i < numMembers; ++i) {
+        nexthop.members.emplace_back(
+            group[i].id, static_cast<uint8_t>(group[i].weight + 1));
+      }
+    } break;
+    }
+  }
+  return nexthop;
+}
+
+int
+NetlinkNexthopMessage::deleteNexthop(uint32_t id) {
+  init(RTM_DELNEXTHOP);
+
+  return addNexthopId(id);
+}
+
+int
+NetlinkNexthopMessage::addNexthopId(uint32_t id) {
+  return addAttributes(
+      NHA_ID, reinterpret_cast<const char*>(&id), sizeof(uint32_t));
+}
+
+} // namespace openr::fbnl
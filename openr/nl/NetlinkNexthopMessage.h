@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <openr/nl/NetlinkMessageBase.h>
+#include <openr/nl/NetlinkTypes.h>
+
+extern "C" {
+#include <linux/nexthop.h>
+}
+
+namespace openr::fbnl {
+
+// Members of a nexthop group as pair of <nexthop-id, weight>. Weight follows
+// the NextHop convention where 0 and 1 both mean equal share.
+using NexthopGroupMembers = std::vector<std::pair<uint32_t, uint8_t>>;
+
+// Nexthop object or group read from kernel
+struct NexthopObject {
+  uint32_t id{0};
+  uint8_t protocolId{0};
+  // Members of a group, empty for a nexthop object
+  NexthopGroupMembers members;
+
+  bool
+  isGroup() const {
+    return not members.empty();
+  }
+};
+
+/**
+ * Message specialization for rtnetlink NEXTHOP type (Linux 5.3+)
+ *
+ * For reference: https://man7.org/linux/man-pages/man8/ip-nexthop.8.html
+ *
+ * RTM_NEWNEXTHOP, RTM_DELNEXTHOP, RTM_GETNEXTHOP
+ *    Add, delete or retrieve a nexthop object or a nexthop group. Carries a
+ *    struct nhmsg. Routes reference the object with RTA_NH_ID instead of
+ *    carrying RTA_MULTIPATH, so changing the group updates every route using
+ *    it.
+ *
+ * NOTE: Only plain IP nexthops (gateway + interface) are supported. MPLS
+ * encapsulation is not supported. `GET` only retrieves ids, protocol and
+ * group members of the objects.
+ */
+class NetlinkNexthopMessage final : public NetlinkMessageBase {
+ public:
+  NetlinkNexthopMessage();
+
+  ~NetlinkNexthopMessage() override;
+
+  // Override setReturnStatus. Set nexthopsPromise_ with rcvdNexthops_ if
+  // this is a GET request
+  void setReturnStatus(int status) override;
+
+  // Get future for nexthop objects received in response to GET request
+  folly::SemiFuture<folly::Expected<std::vector<NexthopObject>, int>>
+  getNexthopsSemiFuture();
+
+  // initiallize nexthop message with default params
+  void init(int type);
+
+  // parse Netlink Nexthop message
+  static NexthopObject parseMessage(const struct nlmsghdr* nlh);
+
+  // Add or replace a single nexthop object. `family` is used for interface
+  // only nexthops, otherwise it is derived from the gateway address.
+  int addNexthop(
+      uint32_t id, const NextHop& nextHop, uint8_t family, uint8_t protocolId);
+
+  // Add or replace a nexthop group of existing nexthop objects
+  int addNexthopGroup(
+      uint32_t id, const NexthopGroupMembers& members, uint8_t protocolId);
+
+  // Delete nexthop object or group
+  int deleteNexthop(uint32_t id);
+
+ private:
+  // inherited class implementation
+  void rcvdNexthopMessage(const struct nlmsghdr* nlmsg) override;
+
+  // add NHA_ID attribute
+  int addNexthopId(uint32_t id);
+
+  //
+  // Private variables for rtnetlink msg exchange
+  //
+
+  // pointer to nexthop message header
+  //   struct nhmsg {
+  //     unsigned char nh_family;
+  //     unsigned char nh_scope;     /* return only */
+  //     unsigned char nh_protocol;  /* Routing protocol that installed nh */
+  //     unsigned char resvd;
+  //     unsigned int nh_flags;      /* RTNH_F flags */
+  //   };
+  struct nhmsg* nhmsg_{nullptr};
+
+  // promise to be fulfilled when receiving kernel reply, ONLY allocated for
+  // GET request
+  std::optional<
+      folly::Promise<folly::Expected<std::vector<NexthopObject>, int>>>
+      nexthopsPromise_;
+  std::vector<NexthopObject> rcvdNexthops_;
+};
+
+} // namespace openr::fbnl
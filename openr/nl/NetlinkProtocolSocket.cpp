@@ -15,14 +15,144 @@ namespace fb303 = facebook::fb303;
 
 namespace openr::fbnl {
 
+namespace {
+
+// Create netlink socket subscribed to multicast `groups`
+int
+createSocket(uint32_t groups) {
+  int fd = ::socket(PF_NETLINK, SOCK_RAW, NETLINK_ROUTE);
+  if (fd < 0) {
+    XLOG(FATAL) << "Netlink socket create failed.";
+  }
+  int size = kNetlinkSockRecvBuf;
+  // increase socket recv buffer size
+  if (setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size)) < 0) {
+    XLOG(FATAL) << "Netlink socket set recv buffer failed.";
+  };
+
+  // Bind on the source address. We let kernel chose the available port-ID
+  struct sockaddr_nl saddr;
+  ::memset(&saddr, 0, sizeof(saddr));
+  saddr.nl_family = AF_NETLINK;
+  saddr.nl_pid = 0; // We let kernel assign the port-ID
+  saddr.nl_groups = groups;
+  if (bind(fd, (struct sockaddr*)&saddr, sizeof(saddr)) != 0) {
+    XLOG(FATAL) << "Failed to bind netlink socket: " << folly::errnoStr(errno);
+  }
+  return fd;
+}
+
+} // namespace
+
+NetlinkProtocolSocket::EventSocket::EventSocket(
+    folly::EventBase* evb, NetlinkProtocolSocket& parent)
+    : EventHandler(evb), parent_(parent) {
+  /* We can subscribe to different Netlink mutlicast groups for specific types
+   * of events: link, IPv4/IPv6 address and neighbor. */
+  fd_ = createSocket(
+      RTMGRP_LINK // listen for link events
+      | RTMGRP_IPV4_IFADDR // listen for IPv4 address events
+      | RTMGRP_IPV6_IFADDR // listen for IPv6 address events
+      | RTMGRP_NEIGH); // listen for Neighbor (ARP) events
+  XLOG(INFO) << "Created netlink event socket. fd=" << fd_;
+
+  if (parent_.uring_) {
+    parent_.uring_->addSocket(fd_);
+    return;
+  }
+
+  // NOTE: We mask `READ` event with `PERSIST` to make sure the handler remains
+  // registered after the read event
+  changeHandlerFD(folly::NetworkSocket{fd_});
+  registerHandler(folly::EventHandler::READ | folly::EventHandler::PERSIST);
+}
+
+NetlinkProtocolSocket::EventSocket::~EventSocket() {
+  XLOG(INFO) << "Closing netlink event socket. fd=" << fd_;
+  if (parent_.uring_) {
+    parent_.uring_->removeSocket(fd_);
+  }
+  unregisterHandler();
+  close(fd_);
+}
+
+void
+NetlinkProtocolSocket::EventSocket::handlerReady(uint16_t events) noexcept {
+  CHECK_EQ(events, folly::EventHandler::READ);
+  const auto readTime = std::chrono::steady_clock::now();
+
+  for (size_t batch = 0; batch < kNlRecvMaxBatches; ++batch) {
+    const int numMsgs = parent_.recvBatch(fd_);
+    if (numMsgs < 0) {
+      const int err = errno;
+      if (err != EINTR && err != EAGAIN) {
+        processRecvError(err);
+      }
+      break;
+    }
+
+    for (int i = 0; i < numMsgs; ++i) {
+      processEvents(parent_.recvBufs_[i].data(), parent_.recvMsgs_[i].msg_len);
+    }
+    if (static_cast<size_t>(numMsgs) < kNlRecvBatch) {
+      break;
+    }
+  }
+
+  publishEvents(readTime);
+}
+
+void
+NetlinkProtocolSocket::EventSocket::processEvents(
+    const char* data, uint32_t len) {
+  parent_.bytesRxStat_.add(len);
+  try {
+    parent_.processMessage(data, len, true /* fromEventSocket */);
+  } catch (std::exception const& e) {
+    XLOG(ERR) << "Error processing netlink event" << folly::exceptionStr(e);
+    fbData->addStatValue("netlink.errors", 1, fb303::SUM);
+  }
+}
+
+void
+NetlinkProtocolSocket::EventSocket::processRecvError(int err) {
+  // e.g. ENOBUFS if events overran socket buffer. Events got lost.
+  XLOG(ERR) << "Error in netlink event socket receive. err: "
+            << folly::errnoStr(err);
+  fbData->addStatValue("netlink.errors", 1, fb303::SUM);
+  fbData->addStatValue("netlink.notifications.errors", 1, fb303::SUM);
+  if (err == ENOBUFS) {
+    ++parent_.numEventLosses_;
+    parent_.syncCache();
+  }
+}
+
+void
+NetlinkProtocolSocket::EventSocket::publishEvents(
+    std::chrono::steady_clock::time_point readTime) {
+  // Changes of the events become visible to readers of the cache at once
+  parent_.cache_.publish();
+
+  // Time taken to deliver events read from the socket to subscribers. Measured
+  // separately from `netlink.requests.latency_ms`
+  const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - readTime);
+  fbData->addStatValue(
+      "netlink.notifications.latency_us", latency.count(), fb303::AVG);
+}
+
 NetlinkProtocolSocket::NetlinkProtocolSocket(
     folly::EventBase* evb,
     messaging::ReplicateQueue<NetlinkEvent>& netlinkEventsQ,
-    bool enableIPv6RouteReplaceSemantics)
+    bool enableIPv6RouteReplaceSemantics,
+    std::chrono::milliseconds eventCoalescingWindow,
+    bool enableIoUring)
     : EventHandler(evb),
       evb_(evb),
       netlinkEventsQueue_(netlinkEventsQ),
-      enableIPv6RouteReplaceSemantics_(enableIPv6RouteReplaceSemantics) {
+      enableIPv6RouteReplaceSemantics_(enableIPv6RouteReplaceSemantics),
+      eventCoalescingWindow_(eventCoalescingWindow),
+      enableIoUring_(enableIoUring) {
   // We expect ctrl-evb not be running. Attaching and scheduling
   // of timers is not thread safe.
   CHECK_NOTNULL(evb_);
@@ -46,10 +176,14 @@ NetlinkProtocolSocket::NetlinkProtocolSocket(
       kv.second->setReturnStatus(-ETIMEDOUT);
     }
     nlSeqNumMap_.clear(); // Clear all timed out requests
+    nlBarriers_.clear();
 
     XLOG(INFO) << "Closing netlink socket. fd=" << nlSock_
                << ", port=" << portId_;
     unregisterHandler();
+    if (uring_) {
+      uring_->removeSocket(nlSock_);
+    }
     close(nlSock_);
     init();
 
@@ -57,6 +191,20 @@ NetlinkProtocolSocket::NetlinkProtocolSocket(
     sendNetlinkMessage();
   });
 
+  eventCoalescingTimer_ =
+      folly::AsyncTimeout::make(*evb_, [this]() noexcept { flushEvents(); });
+
+  // Point every message of `recvBatch()` to its buffer once
+  recvBufs_.resize(kNlRecvBatch);
+  recvIovs_.resize(kNlRecvBatch);
+  recvMsgs_.resize(kNlRecvBatch);
+  for (size_t i = 0; i < kNlRecvBatch; ++i) {
+    recvIovs_[i].iov_base = recvBufs_[i].data();
+    recvIovs_[i].iov_len = kMaxNlPayloadSize;
+    recvMsgs_[i].msg_hdr.msg_iov = &recvIovs_[i];
+    recvMsgs_[i].msg_hdr.msg_iovlen = 1;
+  }
+
   // Create consumer for procesing netlink messages to be sent in an event loop
   notifConsumer_ =
       folly::NotificationQueue<std::unique_ptr<NetlinkMessageBase>>::Consumer::
@@ -79,6 +227,7 @@ NetlinkProtocolSocket::NetlinkProtocolSocket(
 
 NetlinkProtocolSocket::~NetlinkProtocolSocket() {
   XLOG(INFO) << "Shutting down netlink protocol socket";
+  *alive_ = false;
 
   // Clear all requests expecting a reply
   for (auto& kv : nlSeqNumMap_) {
@@ -89,6 +238,7 @@ NetlinkProtocolSocket::~NetlinkProtocolSocket() {
     kv.second->setReturnStatus(-ESHUTDOWN);
   }
   nlSeqNumMap_.clear(); // Clear all timed out requests
+  nlBarriers_.clear();
 
   // Clear all requests that yet needs to be sent
   std::unique_ptr<NetlinkMessageBase> msg;
@@ -101,6 +251,9 @@ NetlinkProtocolSocket::~NetlinkProtocolSocket() {
   if (nlSock_ > 0) {
     XLOG(INFO) << "Closing netlink socket. fd=" << nlSock_
                << ", port=" << portId_;
+    if (uring_) {
+      uring_->removeSocket(nlSock_);
+    }
     close(nlSock_);
   } else {
     XLOG(INFO) << "Netlink socket was never initialized";
@@ -109,45 +262,62 @@ NetlinkProtocolSocket::~NetlinkProtocolSocket() {
 
 void
 NetlinkProtocolSocket::init() {
-  // Create netlink socket
-  nlSock_ = ::socket(PF_NETLINK, SOCK_RAW, NETLINK_ROUTE);
-  if (nlSock_ < 0) {
-    XLOG(FATAL) << "Netlink socket create failed.";
+  // Events are received on their own socket. See EventSocket
+  if (not eventSock_) {
+    // Backend reading both sockets, if any, must exist before event socket
+    if (enableIoUring_) {
+      uring_ = NetlinkUring::create(
+          evb_,
+          [this](int fd, const char* data, int len) {
+            processUringRecv(fd, data, len);
+          },
+          [this]() { processUringRecvDone(); });
+      if (not uring_) {
+        XLOG(WARNING) << "Reading netlink sockets with recvmmsg, io_uring is "
+                      << "not supported";
+      }
+    }
+    eventSock_ = std::make_unique<EventSocket>(evb_, *this);
+    syncCache();
   }
-  int size = kNetlinkSockRecvBuf;
-  // increase socket recv buffer size
-  if (setsockopt(nlSock_, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size)) < 0) {
-    XLOG(FATAL) << "Netlink socket set recv buffer failed.";
-  };
 
-  // Bind on the source address. We let kernel chose the available port-ID
-  struct sockaddr_nl saddr;
-  ::memset(&saddr, 0, sizeof(saddr));
-  saddr.nl_family = AF_NETLINK;
-  saddr.nl_pid = 0; // We let kernel assign the port-ID
-  /* We can subscribe to different Netlink mutlicast groups for specific types
-   * of events: link, IPv4/IPv6 address and neighbor. */
-  saddr.nl_groups = RTMGRP_LINK // listen for link events
-      | RTMGRP_IPV4_IFADDR // listen for IPv4 address events
-      | RTMGRP_IPV6_IFADDR // listen for IPv6 address events
-      | RTMGRP_NEIGH; // listen for Neighbor (ARP) events
-
-  if (bind(nlSock_, (struct sockaddr*)&saddr, sizeof(saddr)) != 0) {
-    XLOG(FATAL) << "Failed to bind netlink socket: " << folly::errnoStr(errno);
+  // Create netlink socket for requests
+  nlSock_ = createSocket(0 /* no multicast groups */);
+
+  // Let kernel filter dump requests by their headers and attributes. Older
+  // kernels don't support it and dumps are filtered in user space instead.
+  int strictCheck = 1;
+  if (setsockopt(
+          nlSock_,
+          SOL_NETLINK,
+          NETLINK_GET_STRICT_CHK,
+          &strictCheck,
+          sizeof(strictCheck)) < 0) {
+    XLOG(INFO) << "Kernel-side dump filtering is not supported. Error: "
+               << folly::errnoStr(errno);
+    strictDumpFiltering_ = false;
+  } else {
+    strictDumpFiltering_ = true;
   }
 
-  // Retrieve and set pid that we will use for all subsequent messages
-  portId_ = saddr.nl_pid;
-  XLOG(INFO) << "Created netlink socket. fd=" << nlSock_
+  // Set pid that we will use for all subsequent messages. Kernel identifies
+  // the socket itself and echoes it in replies.
+  portId_ = 0;
+  XLOG(INFO) << "Created netlink request socket. fd=" << nlSock_
              << ", port=" << portId_;
 
   // Set fd in event handler and register for polling
   // NOTE: We mask `READ` event with `PERSIST` to make sure the handler remains
   // registered after the read event
-  XLOG(INFO) << "Registering netlink socket fd " << nlSock_
-             << " with EventBase for read events";
-  changeHandlerFD(folly::NetworkSocket{nlSock_});
-  registerHandler(folly::EventHandler::READ | folly::EventHandler::PERSIST);
+  if (uring_) {
+    XLOG(INFO) << "Reading netlink socket fd " << nlSock_ << " with io_uring";
+    uring_->addSocket(nlSock_);
+  } else {
+    XLOG(INFO) << "Registering netlink socket fd " << nlSock_
+               << " with EventBase for read events";
+    changeHandlerFD(folly::NetworkSocket{nlSock_});
+    registerHandler(folly::EventHandler::READ | folly::EventHandler::PERSIST);
+  }
 
   // Resume sending netlink messages if any queued
   sendNetlinkMessage();
@@ -166,30 +336,18 @@ NetlinkProtocolSocket::handlerReady(uint16_t events) noexcept {
 
 void
 NetlinkProtocolSocket::processAck(uint32_t ack, int status) {
-  XLOG(DBG2) << "Completed netlink request. seq=" << ack
-             << ", retval=" << status;
-  if (std::abs(status) != EEXIST && std::abs(status) != ESRCH && status != 0) {
-    XLOG(ERR) << "Netlink request error for seq=" << ack
-              << ", retval=" << status;
-    fbData->addStatValue("netlink.requests.error", 1, fb303::SUM);
-  } else {
-    fbData->addStatValue("netlink.requests.success", 1, fb303::SUM);
-  }
-
-  auto it = nlSeqNumMap_.find(ack);
-  if (it != nlSeqNumMap_.end()) {
-    // Calculate and add the latency of the request in fb303
-    auto requestLatency = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::steady_clock::now() - it->second->getCreateTs());
-    fbData->addStatValue(
-        "netlink.requests.latency_ms", requestLatency.count(), fb303::AVG);
-
-    // Set return status on promise
-    it->second->setReturnStatus(status);
-    nlSeqNumMap_.erase(it);
-  } else {
-    XLOG(ERR) << "Broken promise for netlink request. seq=" << ack;
-    fbData->addStatValue("netlink.errors", 1, fb303::SUM);
+  completeRequest(ack, status);
+
+  // Ack of a barrier. Batched requests sent before it which haven't reported
+  // an error have succeeded.
+  auto barrierIt = nlBarriers_.find(ack);
+  if (barrierIt != nlBarriers_.end()) {
+    for (const auto seq : barrierIt->second) {
+      if (nlSeqNumMap_.count(seq)) {
+        completeRequest(seq, 0);
+      }
+    }
+    nlBarriers_.erase(barrierIt);
   }
 
   // Cancel timer if there are no more expected responses
@@ -202,38 +360,182 @@ NetlinkProtocolSocket::processAck(uint32_t ack, int status) {
 
   // We've successfully completed at-least one message. Send more messages
   // if any pending. Here we add optimization to wait for some more acks and
-  // send pending message in batch of atleast `kMinIovMsg`
-  if (nlSeqNumMap_.empty() or (kMaxIovMsg - nlSeqNumMap_.size() > kMinIovMsg)) {
+  // send pending message in batch of atleast `kMinIovMsg`, or half of the
+  // in-flight window if smaller
+  const auto minFree = std::min(kMinIovMsg, inflightWindow_ / 2);
+  if (nlSeqNumMap_.empty() or nlSeqNumMap_.size() + minFree < inflightWindow_) {
     sendNetlinkMessage();
   }
 }
 
 void
-NetlinkProtocolSocket::sendNetlinkMessage() {
-  CHECK(evb_->isInEventBaseThread());
-  struct sockaddr_nl nladdr = {
-      .nl_family = AF_NETLINK, .nl_pad = 0, .nl_pid = 0, .nl_groups = 0};
-  CHECK_LE(nlSeqNumMap_.size(), kMaxIovMsg)
-      << "We must have capacity to send at-least one message!";
-  uint32_t count{0};
-  const uint32_t iovSize =
-      std::min(msgQueue_.size(), kMaxIovMsg - nlSeqNumMap_.size());
+NetlinkProtocolSocket::syncCache() {
+  XLOG(INFO) << "Syncing netlink cache of links and neighbors";
+  cache_.startSync();
+  folly::collectAll(getAllLinks(), getAllNeighbors())
+      .via(evb_)
+      .thenValue([this, alive = alive_](auto&& results) {
+        if (not *alive) {
+          return;
+        }
+        auto& [links, neighbors] = results;
+        if (links.hasException() or links->hasError() or
+            neighbors.hasException() or neighbors->hasError()) {
+          XLOG(ERR) << "Failed to dump links and neighbors. Retrying";
+          fbData->addStatValue("netlink.errors", 1, fb303::SUM);
+          evb_->runAfterDelay(
+              [this, alive]() {
+                if (*alive) {
+                  syncCache();
+                }
+              },
+              kNlRequestAckTimeout.count());
+          return;
+        }
+        cache_.sync(std::move(links->value()), std::move(neighbors->value()));
+        cache_.publish();
+      });
+}
+
+void
+NetlinkProtocolSocket::publishEvent(NetlinkEvent&& event) {
+  if (eventCoalescingWindow_.count() == 0) {
+    netlinkEventsQueue_.push(std::move(event));
+    return;
+  }
+
+  ++numBurstEvents_;
+  auto key = getEventKey(event);
+  if (key.has_value()) {
+    auto [it, inserted] =
+        pendingEventIndex_.emplace(std::move(*key), pendingEvents_.size());
+    if (not inserted) {
+      // Supersede earlier event of the same link, address or neighbor
+      pendingEvents_.at(it->second) = std::move(event);
+      fbData->addStatValue("netlink.notifications.coalesced", 1, fb303::SUM);
+      return;
+    }
+  }
+  pendingEvents_.emplace_back(std::move(event));
+
+  // First event of the window
+  if (not eventCoalescingTimer_->isScheduled()) {
+    eventCoalescingTimer_->scheduleTimeout(eventCoalescingWindow_);
+  }
+}
+
+void
+NetlinkProtocolSocket::flushEvents() {
+  fbData->addStatValue(
+      "netlink.notifications.burst_size", numBurstEvents_, fb303::AVG);
+  for (auto& event : pendingEvents_) {
+    netlinkEventsQueue_.push(std::move(event));
+  }
+  pendingEvents_.clear();
+  pendingEventIndex_.clear();
+  numBurstEvents_ = 0;
+}
+
+std::optional<NetlinkProtocolSocket::EventKey>
+NetlinkProtocolSocket::getEventKey(const NetlinkEvent& event) {
+  if (auto* link = std::get_if<Link>(&event)) {
+    return EventKey(event.index(), link->getIfIndex(), std::nullopt);
+  }
+  if (auto* addr = std::get_if<IfAddress>(&event)) {
+    return EventKey(event.index(), addr->getIfIndex(), addr->getPrefix());
+  }
+  if (auto* neighbor = std::get_if<Neighbor>(&event)) {
+    const auto& destination = neighbor->getDestination();
+    return EventKey(
+        event.index(),
+        neighbor->getIfIndex(),
+        folly::CIDRNetwork(destination, destination.bitCount()));
+  }
+  return std::nullopt;
+}
+
+void
+NetlinkProtocolSocket::completeRequest(uint32_t seq, int status) {
+  XLOG(DBG2) << "Completed netlink request. seq=" << seq
+             << ", retval=" << status;
+  if (std::abs(status) != EEXIST && std::abs(status) != ESRCH && status != 0) {
+    XLOG(ERR) << "Netlink request error for seq=" << seq
+              << ", retval=" << status;
+    fbData->addStatValue("netlink.requests.error", 1, fb303::SUM);
+  } else {
+    fbData->addStatValue("netlink.requests.success", 1, fb303::SUM);
+  }
 
-  if (!iovSize) {
+  auto it = nlSeqNumMap_.find(seq);
+  if (it == nlSeqNumMap_.end()) {
+    XLOG(ERR) << "Broken promise for netlink request. seq=" << seq;
+    fbData->addStatValue("netlink.errors", 1, fb303::SUM);
     return;
   }
 
-  auto iov = std::make_unique<struct iovec[]>(iovSize);
+  // Calculate and add the latency of the request in fb303
+  const auto now = std::chrono::steady_clock::now();
+  auto requestLatency = std::chrono::duration_cast<std::chrono::milliseconds>(
+      now - it->second->getCreateTs());
+  fbData->addStatValue(
+      "netlink.requests.latency_ms", requestLatency.count(), fb303::AVG);
+
+  // Dumps take as long as kernel has objects to send. Only acks of other
+  // requests reflect how fast kernel keeps up with us.
+  const auto flags = it->second->getMessagePtr()->nlmsg_flags;
+  if ((flags & NLM_F_DUMP) != NLM_F_DUMP) {
+    updateInflightWindow(now - it->second->getSendTs(), false /* overrun */);
+  }
 
-  while (count < iovSize && !msgQueue_.empty()) {
-    auto m = std::move(msgQueue_.front());
-    msgQueue_.pop();
+  // Set return status on promise
+  it->second->setReturnStatus(status);
+  nlSeqNumMap_.erase(it);
+}
 
+void
+NetlinkProtocolSocket::updateInflightWindow(
+    std::chrono::steady_clock::duration ackLatency, bool overrun) {
+  if (overrun or ackLatency > kNlAckLatencyTarget) {
+    const auto now = std::chrono::steady_clock::now();
+    if (now - lastWindowDecreaseTs_ < kNlAckLatencyTarget) {
+      return;
+    }
+    lastWindowDecreaseTs_ = now;
+    inflightWindow_ = std::max(kMinInflightWindow, inflightWindow_ / 2);
+    fbData->addStatValue("netlink.requests.window_decrease", 1, fb303::SUM);
+  } else if (inflightWindow_ < kMaxInflightWindow) {
+    ++inflightWindow_;
+  }
+  fbData->setCounter("netlink.requests.window", inflightWindow_);
+}
+
+void
+NetlinkProtocolSocket::failBatchedRequests(int status) {
+  for (const auto& [_, seqs] : nlBarriers_) {
+    for (const auto seq : seqs) {
+      if (nlSeqNumMap_.count(seq)) {
+        completeRequest(seq, status);
+      }
+    }
+  }
+  // Barriers remain pending and are completed by their own ack
+  nlBarriers_.clear();
+}
+
+void
+NetlinkProtocolSocket::sendNetlinkMessage() {
+  CHECK(evb_->isInEventBaseThread());
+  struct sockaddr_nl nladdr = {
+      .nl_family = AF_NETLINK, .nl_pad = 0, .nl_pid = 0, .nl_groups = 0};
+
+  // Fill sequence number and PID of the message, and track it as in-flight
+  auto addInflight = [this](
+                         std::unique_ptr<NetlinkMessageBase> m,
+                         struct iovec& iov) {
     struct nlmsghdr* nlmsg_hdr = m->getMessagePtr();
-    iov[count].iov_base = reinterpret_cast<void*>(m->getMessagePtr());
-    iov[count].iov_len = m->getDataLength();
+    iov.iov_base = reinterpret_cast<void*>(nlmsg_hdr);
+    iov.iov_len = m->getDataLength();
 
-    // fill sequence number and PID
     nlmsg_hdr->nlmsg_pid = portId_;
     nlmsg_hdr->nlmsg_seq = nextNlSeqNum_++;
     if (nextNlSeqNum_ == 0) {
@@ -248,36 +550,88 @@ NetlinkProtocolSocket::sendNetlinkMessage() {
     }
 
     // Add seq number -> netlink request mapping
+    m->setSendTs();
     auto res = nlSeqNumMap_.insert({nlmsg_hdr->nlmsg_seq, std::move(m)});
     CHECK(res.second) << "Entry exists for " << nlmsg_hdr->nlmsg_seq;
-    count++;
     XLOG(DBG2) << "Sending netlink request."
                << " seq=" << nlmsg_hdr->nlmsg_seq
                << ", type=" << nlmsg_hdr->nlmsg_type
                << ", len=" << nlmsg_hdr->nlmsg_len
                << ", flags=" << nlmsg_hdr->nlmsg_flags;
-  }
+    return nlmsg_hdr->nlmsg_seq;
+  };
 
-  auto outMsg = std::make_unique<struct msghdr>();
-  outMsg->msg_name = &nladdr;
-  outMsg->msg_namelen = sizeof(nladdr);
-  outMsg->msg_iov = &iov[0];
-  outMsg->msg_iovlen = count;
+  // Fill the in-flight window, in batches of at most `kMaxIovMsg` messages
+  // per `sendmsg`. One slot of every batch is reserved for the barrier.
+  bool sent{false};
+  while (not msgQueue_.empty() and nlSeqNumMap_.size() + 1 < inflightWindow_) {
+    const size_t iovSize = std::min(
+        {msgQueue_.size(),
+         kMaxIovMsg - 1,
+         inflightWindow_ - nlSeqNumMap_.size() - 1});
+    auto iov = std::make_unique<struct iovec[]>(iovSize + 1);
+    uint32_t count{0};
+    std::vector<uint32_t> batchedSeqs;
+
+    while (count < iovSize && !msgQueue_.empty()) {
+      auto m = std::move(msgQueue_.front());
+      msgQueue_.pop();
+
+      // Kernel acks batched messages only on error
+      const bool batched = m->isBatched();
+      if (batched) {
+        m->getMessagePtr()->nlmsg_flags &= ~NLM_F_ACK;
+      }
+      const auto seq = addInflight(std::move(m), iov[count]);
+      if (batched) {
+        batchedSeqs.emplace_back(seq);
+      }
+      count++;
+    }
 
-  // `sendmsg` return -1 in case of error else number of bytes sent. `errno`
-  // will be set to an appropriate code in case of error.
-  int bytesSent = sendmsg(nlSock_, outMsg.get(), 0);
-  if (bytesSent < 0) {
-    XLOG(ERR) << "Error sending on netlink socket. Error: "
-              << folly::errnoStr(std::abs(errno)) << ", errno=" << errno
-              << ", fd=" << nlSock_ << ", num-messages=" << outMsg->msg_iovlen;
-    fbData->addStatValue("netlink.errors", 1, fb303::SUM);
-  } else {
-    fbData->addStatValue("netlink.bytes.tx", bytesSent, fb303::SUM);
+    // Kernel acks control messages without handling them
+    if (not batchedSeqs.empty()) {
+      auto barrier = std::make_unique<NetlinkMessageBase>(NLMSG_NOOP);
+      barrier->getMessagePtr()->nlmsg_flags = NLM_F_REQUEST | NLM_F_ACK;
+      const auto seq = addInflight(std::move(barrier), iov[count]);
+      nlBarriers_.emplace(seq, std::move(batchedSeqs));
+      fbData->addStatValue("netlink.requests.barriers", 1, fb303::SUM);
+      count++;
+    }
+
+    auto outMsg = std::make_unique<struct msghdr>();
+    outMsg->msg_name = &nladdr;
+    outMsg->msg_namelen = sizeof(nladdr);
+    outMsg->msg_iov = &iov[0];
+    outMsg->msg_iovlen = count;
+
+    // `sendmsg` return -1 in case of error else number of bytes sent. `errno`
+    // will be set to an appropriate code in case of error.
+    int bytesSent = sendmsg(nlSock_, outMsg.get(), 0);
+    if (bytesSent < 0) {
+      XLOG(ERR) << "Error sending on netlink socket. Error: "
+                << folly::errnoStr(std::abs(errno)) << ", errno=" << errno
+                << ", fd=" << nlSock_
+                << ", num-messages=" << outMsg->msg_iovlen;
+      fbData->addStatValue("netlink.errors", 1, fb303::SUM);
+    } else {
+      bytesTxStat_.add(bytesSent);
+    }
+    requestsStat_.add(outMsg->msg_iovlen);
+    XLOG(DBG2) << "Sent " << outMsg->msg_iovlen << " netlink requests on fd "
+               << nlSock_;
+    sent = true;
   }
-  fbData->addStatValue("netlink.requests", outMsg->msg_iovlen, fb303::SUM);
-  XLOG(DBG2) << "Sent " << outMsg->msg_iovlen << " netlink requests on fd "
-             << nlSock_;
+
+  if (not sent) {
+    return;
+  }
+
+  // Report reuse of message objects. See NetlinkMessagePool
+  const auto& pool = NetlinkMessagePool::getInstance();
+  fbData->setCounter("netlink.message_pool.hits", pool.getNumHits());
+  fbData->setCounter("netlink.message_pool.misses", pool.getNumMisses());
+  fbData->setCounter("netlink.message_pool.free", pool.getNumFree());
 
   // Schedule timer to wait for acks and send next set of messages
   nlMessageTimer_->scheduleTimeout(kNlRequestAckTimeout);
@@ -285,9 +639,9 @@ NetlinkProtocolSocket::sendNetlinkMessage() {
 
 void
 NetlinkProtocolSocket::processMessage(
-    const std::array<char, kMaxNlPayloadSize>& rxMsg, uint32_t bytesRead) {
+    const char* rxMsg, uint32_t bytesRead, bool fromEventSocket) {
   // first netlink message header
-  struct nlmsghdr* nlh = (struct nlmsghdr*)rxMsg.data();
+  struct nlmsghdr* nlh = (struct nlmsghdr*)rxMsg;
   do {
     if (!NLMSG_OK(nlh, bytesRead)) {
       break;
@@ -296,18 +650,21 @@ NetlinkProtocolSocket::processMessage(
     XLOG(DBG2) << "Received reply for netlink request."
                << " seq=" << nlh->nlmsg_seq << ", type=" << nlh->nlmsg_type
                << ", len=" << nlh->nlmsg_len << ", flags=" << nlh->nlmsg_flags;
-    auto nlSeqIt = nlSeqNumMap_.find(nlh->nlmsg_seq);
+    // Events may bear sequence number of the request triggering them. They're
+    // never responses though.
+    auto nlSeqIt = fromEventSocket ? nlSeqNumMap_.end()
+                                   : nlSeqNumMap_.find(nlh->nlmsg_seq);
 
     switch (nlh->nlmsg_type) {
     case RTM_NEWROUTE:
     case RTM_DELROUTE: {
-      // next RTM message to be processed
-      auto route = NetlinkRouteMessage::parseMessage(nlh);
+      // next RTM message to be processed. Decoded by the request only if it
+      // is interested in the route.
       if (nlSeqIt != nlSeqNumMap_.end()) {
         // Extend message timer as we received a valid ack
         nlMessageTimer_->scheduleTimeout(kNlRequestAckTimeout);
         // Received route in response to request
-        nlSeqIt->second->rcvdRoute(std::move(route));
+        nlSeqIt->second->rcvdRouteMessage(nlh);
       } else {
         // Route notification
         fbData->addStatValue("netlink.notifications.route", 1, fb303::SUM);
@@ -328,8 +685,9 @@ NetlinkProtocolSocket::processMessage(
       } else {
         // Link notification
         XLOG(DBG1) << "Link event. " << link.str();
-        fbData->addStatValue("netlink.notifications.link", 1, fb303::SUM);
-        netlinkEventsQueue_.push(link);
+        linkNotificationsStat_.add();
+        cache_.updateLink(link, nlh->nlmsg_type == RTM_DELLINK);
+        publishEvent(std::move(link));
       }
     } break;
 
@@ -362,8 +720,8 @@ NetlinkProtocolSocket::processMessage(
       if (isNotification) {
         // IfAddress notification
         XLOG(DBG1) << "Address event. " << addr.str();
-        fbData->addStatValue("netlink.notifications.addr", 1, fb303::SUM);
-        netlinkEventsQueue_.push(addr);
+        addrNotificationsStat_.add();
+        publishEvent(std::move(addr));
       }
     } break;
 
@@ -380,8 +738,9 @@ NetlinkProtocolSocket::processMessage(
       } else {
         // Neighbor notification
         XLOG(DBG2) << "Neighbor event. " << neighbor.str();
-        fbData->addStatValue("netlink.notifications.neighbor", 1, fb303::SUM);
-        netlinkEventsQueue_.push(neighbor);
+        neighborNotificationsStat_.add();
+        cache_.updateNeighbor(neighbor, nlh->nlmsg_type == RTM_DELNEIGH);
+        publishEvent(std::move(neighbor));
       }
     } break;
 
@@ -398,15 +757,28 @@ NetlinkProtocolSocket::processMessage(
       } else {
         // Rule notification
         XLOG(DBG2) << "Rule event. " << rule.str();
-        fbData->addStatValue("netlink.notifications.rule", 1, fb303::SUM);
-        netlinkEventsQueue_.push(rule);
+        ruleNotificationsStat_.add();
+        publishEvent(std::move(rule));
+      }
+    } break;
+
+    case RTM_DELNEXTHOP:
+    case RTM_NEWNEXTHOP: {
+      // nexthop objects are only received in response to GET request
+      if (nlSeqIt != nlSeqNumMap_.end() and
+          nlSeqIt->second->getMessageType() == RTM_GETNEXTHOP) {
+        // Extend message timer as we received a valid ack
+        nlMessageTimer_->scheduleTimeout(kNlRequestAckTimeout);
+        nlSeqIt->second->rcvdNexthopMessage(nlh);
+      } else {
+        XLOG(DBG2) << "Ignoring nexthop message. seq=" << nlh->nlmsg_seq;
       }
     } break;
 
     case NLMSG_ERROR: {
       const struct nlmsgerr* const ack =
           reinterpret_cast<struct nlmsgerr*>(NLMSG_DATA(nlh));
-      if (ack->msg.nlmsg_pid != portId_) {
+      if (fromEventSocket or ack->msg.nlmsg_pid != portId_) {
         XLOG(ERR) << "received netlink message with wrong PID, received: "
                   << ack->msg.nlmsg_pid << " expected: " << portId_;
         fbData->addStatValue("netlink.errors", 1, fb303::SUM);
@@ -420,8 +792,10 @@ NetlinkProtocolSocket::processMessage(
       break;
 
     case NLMSG_DONE: {
-      // End of multipart message
-      processAck(nlh->nlmsg_seq, 0);
+      // End of multipart message. Never received on event socket.
+      if (not fromEventSocket) {
+        processAck(nlh->nlmsg_seq, 0);
+      }
     } break;
 
     default:
@@ -431,26 +805,95 @@ NetlinkProtocolSocket::processMessage(
   } while ((nlh = NLMSG_NEXT(nlh, bytesRead)));
 }
 
+int
+NetlinkProtocolSocket::recvBatch(int fd) {
+  return ::recvmmsg(
+      fd, recvMsgs_.data(), recvMsgs_.size(), MSG_DONTWAIT, nullptr);
+}
+
 void
 NetlinkProtocolSocket::recvNetlinkMessage() {
-  // messages buffer
-  std::array<char, kMaxNlPayloadSize> recvMsg = {};
-
-  int32_t bytesRead = ::recv(nlSock_, recvMsg.data(), kMaxNlPayloadSize, 0);
-  XLOG(DBG4) << "Message received with size: " << bytesRead;
+  // Replies of a burst of requests are drained with a `recvmmsg` per
+  // kNlRecvBatch messages instead of a wakeup and `recv` for each of them.
+  // Socket remains readable if not drained, we yield to other events then.
+  for (size_t batch = 0; batch < kNlRecvMaxBatches; ++batch) {
+    const int numMsgs = recvBatch(nlSock_);
+    if (numMsgs < 0) {
+      const int err = errno;
+      if (err != EINTR && err != EAGAIN) {
+        processRecvError(err);
+      }
+      return;
+    }
 
-  if (bytesRead < 0) {
-    if (errno == EINTR || errno == EAGAIN) {
+    recvBatchSizeStat_.add(numMsgs);
+    for (int i = 0; i < numMsgs; ++i) {
+      const uint32_t bytesRead = recvMsgs_[i].msg_len;
+      XLOG(DBG4) << "Message received with size: " << bytesRead;
+      bytesRxStat_.add(bytesRead);
+      processMessage(recvBufs_[i].data(), bytesRead);
+    }
+    if (static_cast<size_t>(numMsgs) < kNlRecvBatch) {
       return;
     }
-    XLOG(ERR) << "Error in netlink socket receive: " << bytesRead
-              << " err: " << folly::errnoStr(std::abs(errno));
-    fbData->addStatValue("netlink.errors", 1, fb303::SUM);
+  }
+}
+
+void
+NetlinkProtocolSocket::processRecvError(int err) {
+  XLOG(ERR) << "Error in netlink socket receive. err: "
+            << folly::errnoStr(err);
+  fbData->addStatValue("netlink.errors", 1, fb303::SUM);
+  if (err == ENOBUFS) {
+    // Replies overran the socket buffer and some got lost. Back off, and
+    // don't let barriers imply success of batched requests.
+    updateInflightWindow(
+        std::chrono::steady_clock::duration::zero(), true /* overrun */);
+    failBatchedRequests(-ENOBUFS);
+  }
+}
+
+void
+NetlinkProtocolSocket::processUringRecv(int fd, const char* data, int len) {
+  const bool fromEventSocket = eventSock_ and fd == eventSock_->getFd();
+  if (not data) {
+    if (fromEventSocket) {
+      eventSock_->processRecvError(-len);
+    } else {
+      processRecvError(-len);
+    }
+    return;
+  }
+
+  if (fromEventSocket) {
+    if (not uringEventsReadTime_.has_value()) {
+      uringEventsReadTime_ = std::chrono::steady_clock::now();
+    }
+    eventSock_->processEvents(data, len);
     return;
-  } else {
-    fbData->addStatValue("netlink.bytes.rx", bytesRead, fb303::SUM);
   }
-  processMessage(recvMsg, static_cast<uint32_t>(bytesRead));
+
+  ++uringNumMsgs_;
+  XLOG(DBG4) << "Message received with size: " << len;
+  bytesRxStat_.add(len);
+  try {
+    processMessage(data, len);
+  } catch (std::exception const& e) {
+    XLOG(ERR) << "Error processing netlink message" << folly::exceptionStr(e);
+    fbData->addStatValue("netlink.errors", 1, fb303::SUM);
+  }
+}
+
+void
+NetlinkProtocolSocket::processUringRecvDone() {
+  if (uringNumMsgs_) {
+    recvBatchSizeStat_.add(uringNumMsgs_);
+    uringNumMsgs_ = 0;
+  }
+  if (uringEventsReadTime_.has_value()) {
+    eventSock_->publishEvents(*uringEventsReadTime_);
+    uringEventsReadTime_.reset();
+  }
 }
 
 folly::SemiFuture<folly::Unit>
@@ -471,6 +914,20 @@ NetlinkProtocolSocket::collectReturnStatus(
       });
 }
 
+int
+NetlinkProtocolSocket::getFirstError(
+    const std::vector<int>& statuses,
+    const std::unordered_set<int>& ignoredErrors) {
+  for (auto status : statuses) {
+    auto retval = std::abs(status);
+    if (retval == 0 or ignoredErrors.count(retval)) {
+      continue;
+    }
+    return retval;
+  }
+  return 0;
+}
+
 folly::SemiFuture<int>
 NetlinkProtocolSocket::addRoute(const openr::fbnl::Route& route) {
   XLOG(DBG1) << "Netlink add route. " << route.str();
@@ -506,6 +963,70 @@ NetlinkProtocolSocket::addRoute(const openr::fbnl::Route& route) {
   return future;
 }
 
+folly::SemiFuture<std::vector<int>>
+NetlinkProtocolSocket::addRoutes(
+    const std::vector<openr::fbnl::Route>& routes) {
+  XLOG(DBG1) << "Netlink add routes. numRoutes=" << routes.size();
+
+  // Build all the messages before enqueuing any of them, so that number of
+  // messages completing the batch is known upfront
+  std::vector<std::unique_ptr<NetlinkMessageBase>> msgs;
+  std::vector<std::optional<size_t>> indices;
+  std::vector<std::pair<size_t, int>> failures;
+  msgs.reserve(routes.size());
+  indices.reserve(routes.size());
+  for (size_t i = 0; i < routes.size(); ++i) {
+    const auto& route = routes.at(i);
+    auto rtmMsg = std::make_unique<NetlinkRouteMessage>();
+
+    int status{0};
+    switch (route.getFamily()) {
+    case AF_INET6:
+      if (not enableIPv6RouteReplaceSemantics_) {
+        // Special case for IPv6 route add. See `addRoute(...)`
+        // NOTE: Status of the delete is not reported
+        auto delMsg = std::make_unique<NetlinkRouteMessage>();
+        if (delMsg->deleteRoute(route) == 0) {
+          msgs.emplace_back(std::move(delMsg));
+          indices.emplace_back(std::nullopt);
+        }
+      }
+      FOLLY_FALLTHROUGH;
+    case AF_INET:
+      status = rtmMsg->addRoute(route);
+      break;
+    case AF_MPLS:
+      status = rtmMsg->addLabelRoute(route);
+      break;
+    default:
+      status = -EPROTONOSUPPORT;
+    }
+
+    if (status != 0) {
+      failures.emplace_back(i, status);
+    } else {
+      msgs.emplace_back(std::move(rtmMsg));
+      indices.emplace_back(i);
+    }
+  }
+
+  // Failed routes complete the batch right away
+  auto batch = std::make_shared<NetlinkRequestBatch>(
+      routes.size(), msgs.size() + failures.size());
+  auto future = batch->getSemiFuture();
+  for (const auto& [index, status] : failures) {
+    batch->setReturnStatus(index, status);
+  }
+  for (size_t i = 0; i < msgs.size(); ++i) {
+    msgs.at(i)->setRequestBatch(batch, indices.at(i));
+  }
+  notifQueue_.putMessages(
+      std::make_move_iterator(msgs.begin()),
+      std::make_move_iterator(msgs.end()));
+
+  return future;
+}
+
 folly::SemiFuture<int>
 NetlinkProtocolSocket::deleteRoute(const openr::fbnl::Route& route) {
   XLOG(DBG1) << "Netlink delete route. " << route.str();
@@ -632,6 +1153,73 @@ NetlinkProtocolSocket::deleteRule(const openr::fbnl::Rule& rule) {
   return future;
 }
 
+folly::SemiFuture<int>
+NetlinkProtocolSocket::addNexthop(
+    uint32_t id,
+    const openr::fbnl::NextHop& nextHop,
+    uint8_t family,
+    uint8_t protocolId) {
+  XLOG(DBG1) << "Netlink add nexthop. id " << id << ", " << nextHop.str();
+  auto nhMsg = std::make_unique<openr::fbnl::NetlinkNexthopMessage>();
+  auto future = nhMsg->getSemiFuture();
+
+  int status = nhMsg->addNexthop(id, nextHop, family, protocolId);
+  if (status != 0) {
+    nhMsg->setReturnStatus(status);
+  } else {
+    notifQueue_.putMessage(std::move(nhMsg));
+  }
+
+  return future;
+}
+
+folly::SemiFuture<int>
+NetlinkProtocolSocket::addNexthopGroup(
+    uint32_t id, const NexthopGroupMembers& members, uint8_t protocolId) {
+  XLOG(DBG1) << "Netlink add nexthop group. id " << id << ", members "
+             << members.size();
+  auto nhMsg = std::make_unique<openr::fbnl::NetlinkNexthopMessage>();
+  auto future = nhMsg->getSemiFuture();
+
+  int status = nhMsg->addNexthopGroup(id, members, protocolId);
+  if (status != 0) {
+    nhMsg->setReturnStatus(status);
+  } else {
+    notifQueue_.putMessage(std::move(nhMsg));
+  }
+
+  return future;
+}
+
+folly::SemiFuture<int>
+NetlinkProtocolSocket::deleteNexthop(uint32_t id) {
+  XLOG(DBG1) << "Netlink delete nexthop. id " << id;
+  auto nhMsg = std::make_unique<openr::fbnl::NetlinkNexthopMessage>();
+  auto future = nhMsg->getSemiFuture();
+
+  int status = nhMsg->deleteNexthop(id);
+  if (status != 0) {
+    nhMsg->setReturnStatus(status);
+  } else {
+    notifQueue_.putMessage(std::move(nhMsg));
+  }
+
+  return future;
+}
+
+folly::SemiFuture<folly::Expected<std::vector<NexthopObject>, int>>
+NetlinkProtocolSocket::getAllNexthops() {
+  XLOG(DBG1) << "Netlink get nexthops";
+  auto nhMsg = std::make_unique<openr::fbnl::NetlinkNexthopMessage>();
+  auto future = nhMsg->getNexthopsSemiFuture();
+
+  // Initialize message fields to get all nexthop objects
+  nhMsg->init(RTM_GETNEXTHOP);
+  notifQueue_.putMessage(std::move(nhMsg));
+
+  return future;
+}
+
 folly::SemiFuture<folly::Expected<std::vector<fbnl::Link>, int>>
 NetlinkProtocolSocket::getAllLinks() {
   XLOG(DBG3) << "Netlink get links";
@@ -691,7 +1279,7 @@ NetlinkProtocolSocket::getRoutes(const fbnl::Route& filter) {
   auto future = routeMsg->getRoutesSemiFuture();
 
   // Initialize message fields to get all addresses
-  routeMsg->initGet(0, filter);
+  routeMsg->initGet(0, filter, strictDumpFiltering_);
   notifQueue_.putMessage(std::move(routeMsg));
 
   return future;
@@ -7,6 +7,10 @@
 
 #pragma once
 
+#include <map>
+#include <optional>
+#include <tuple>
+
 #include <folly/IPAddress.h>
 #include <folly/futures/Future.h>
 #include <folly/io/async/AsyncTimeout.h>
@@ -14,14 +18,27 @@
 #include <folly/io/async/EventHandler.h>
 #include <folly/io/async/NotificationQueue.h>
 
+#include <openr/common/ThreadLocalStats.h>
 #include <openr/messaging/ReplicateQueue.h>
 #include <openr/nl/NetlinkAddrMessage.h>
+#include <openr/nl/NetlinkCache.h>
 #include <openr/nl/NetlinkLinkMessage.h>
 #include <openr/nl/NetlinkMessageBase.h>
 #include <openr/nl/NetlinkNeighborMessage.h>
+#include <openr/nl/NetlinkNexthopMessage.h>
 #include <openr/nl/NetlinkRouteMessage.h>
 #include <openr/nl/NetlinkRuleMessage.h>
 #include <openr/nl/NetlinkTypes.h>
+#include <openr/nl/NetlinkUring.h>
+
+extern "C" {
+#include <linux/netlink.h>
+#include <sys/socket.h>
+}
+
+#ifndef NETLINK_GET_STRICT_CHK
+#define NETLINK_GET_STRICT_CHK 12
+#endif
 
 namespace openr::fbnl {
 
@@ -32,11 +49,26 @@ using NetlinkEvent =
 // Receive socket buffer for netlink socket
 constexpr uint32_t kNetlinkSockRecvBuf{1 * 1024 * 1024};
 
-// Maximum number of in-flight messages. `kMinIovMsg` indicates the soft
-// requirement for sending bufferred messages.
+// Maximum number of messages sent per `sendmsg`. `kMinIovMsg` indicates the
+// soft requirement for sending bufferred messages.
 constexpr size_t kMaxIovMsg{500};
 constexpr size_t kMinIovMsg{200};
 
+// Bounds of the in-flight window, i.e. the number of messages sent to kernel
+// but not yet acked. Window starts at `kMaxIovMsg` and adapts to ack latency
+// and receive buffer overruns.
+constexpr size_t kMinInflightWindow{50};
+constexpr size_t kMaxInflightWindow{4 * kMaxIovMsg};
+
+// Ack latency above which the in-flight window is shrunk
+constexpr std::chrono::milliseconds kNlAckLatencyTarget{100};
+
+// Maximum number of messages read per `recvmmsg`, and number of reads per
+// wakeup of a socket before yielding to other events of the event base. Not
+// applicable to io_uring backend, see NetlinkUring.
+constexpr size_t kNlRecvBatch{16};
+constexpr size_t kNlRecvMaxBatches{8};
+
 // Timeout for an ack from kernel for netlink messages we sent. The response for
 // big request (e.g. adding 5k routes or getting 10k routes) is sent back in
 // multiple parts. If we don't receive any part of below specified timeout, we
@@ -66,9 +98,16 @@ constexpr std::chrono::milliseconds kNlRequestAckTimeout{1000};
  * Above threading model allows multiple requests to be sent in parallel and
  * process their response asynchronously. Outstanding requests to kernel is
  * rate-limited to not overwhelm the socket buffers. Rate-limiting of requests
- * is governed by params kMaxIovMsg and kMinIovMsg. This allows adding 100k
- * routes in under 2 seconds. These performance benchmarks can be observed
- * by running associated UTs and it might vary on different systems.
+ * is governed by an in-flight window, grown by one message per timely ack and
+ * halved when acks take longer than kNlAckLatencyTarget or replies overrun the
+ * receive buffer (ENOBUFS). Messages of bulk requests (e.g. `addRoutes`) are
+ * acked by kernel only on error and are followed by a single acked barrier
+ * message, sparing the kernel and the receive buffer an ack per message.
+ * Replies and events are read with `recvmmsg`, up to kNlRecvBatch messages per
+ * syscall into buffers allocated once, or with io_uring if enabled, see
+ * NetlinkUring. This allows adding 100k routes in under 2 seconds. These
+ * performance benchmarks can be observed by running associated UTs and it
+ * might vary on different systems.
  *
  * NOTE Logging:
  * Netlink protocol is tricky when it comes to debugging. To faciliate debugging
@@ -89,6 +128,15 @@ constexpr std::chrono::milliseconds kNlRequestAckTimeout{1000};
  *   netlink.requests.success : Request that completed successfully
  *   netlink.requests.error : Request with non zero return code
  *   netlink.requests.latency_ms : Average latency of netlink request
+ *   netlink.requests.window : Current in-flight window
+ *   netlink.requests.window_decrease : Times in-flight window was shrunk
+ *   netlink.requests.barriers : Barriers acking batched requests
+ *   netlink.recv.batch_size : Average messages read per `recvmmsg`, or per
+ *                             wakeup with io_uring
+ *   netlink.uring.buffers_exhausted : Times io_uring receives ran out of
+ *                                     buffers and were re-armed
+ *   netlink.notifications.coalesced : Events superseded by a later event
+ *   netlink.notifications.burst_size : Average events per coalescing window
  *   netlink.bytes.rx : Bytes received over netlink socket
  *   netlink.bytes.tx : Bytes sent over netlink socket
  *   netlink.notifications.link : Received link notifications
@@ -98,10 +146,23 @@ constexpr std::chrono::milliseconds kNlRequestAckTimeout{1000};
  */
 class NetlinkProtocolSocket : public folly::EventHandler {
  public:
+  /**
+   * Non-zero `eventCoalescingWindow` coalesces LINK/ADDR/NEIGHBOR events
+   * received within the window. Only the latest event of every link,
+   * interface address and neighbor is published, in order of their first
+   * event within the window. Consumers hence process latest state instead of
+   * every transition during bursts of events (e.g. interface flaps).
+   *
+   * `enableIoUring` reads both sockets with io_uring backend instead of
+   * `recvmmsg`, if kernel supports it. See NetlinkUring.
+   */
   explicit NetlinkProtocolSocket(
       folly::EventBase* evb,
       messaging::ReplicateQueue<NetlinkEvent>& netlinkEventsQ,
-      bool enableIPv6RouteReplaceSemantics = false);
+      bool enableIPv6RouteReplaceSemantics = false,
+      std::chrono::milliseconds eventCoalescingWindow =
+          std::chrono::milliseconds(0),
+      bool enableIoUring = false);
 
   virtual ~NetlinkProtocolSocket();
 
@@ -123,6 +184,19 @@ class NetlinkProtocolSocket : public folly::EventHandler {
    */
   virtual folly::SemiFuture<int> addRoute(const openr::fbnl::Route& route);
 
+  /**
+   * Add or replace routes in bulk. Semantics for every route is same as of
+   * `addRoute(...)`. All the messages are enqueued at once and share a single
+   * promise, avoiding a future per route for large route updates. Messages
+   * are sent in batches of `kMaxIovMsg` per `sendmsg` and acked only on error,
+   * see `sendNetlinkMessage()`.
+   *
+   * @returns status code of every route in the order of `routes`. 0 on
+   *          success else appropriate system error code
+   */
+  virtual folly::SemiFuture<std::vector<int>> addRoutes(
+      const std::vector<openr::fbnl::Route>& routes);
+
   /**
    * Delete route. This API deletes all the paths associated with the route
    * based on key (destination-address or mpls top-label). Supports AF_INET,
@@ -179,12 +253,67 @@ class NetlinkProtocolSocket : public folly::EventHandler {
    */
   virtual folly::SemiFuture<int> deleteRule(const openr::fbnl::Rule& rule);
 
+  /**
+   * Add or replace a kernel nexthop object (Linux 5.3+). Routes reference it
+   * or a group containing it via `Route::getNexthopId()`. `family` is only
+   * used for nexthops without gateway address.
+   *
+   * @returns 0 on success else appropriate system error code
+   */
+  virtual folly::SemiFuture<int> addNexthop(
+      uint32_t id,
+      const openr::fbnl::NextHop& nextHop,
+      uint8_t family,
+      uint8_t protocolId);
+
+  /**
+   * Add or replace a kernel nexthop group. All members must be existing
+   * nexthop objects. Replacing the group atomically updates every route that
+   * references it.
+   *
+   * @returns 0 on success else appropriate system error code
+   */
+  virtual folly::SemiFuture<int> addNexthopGroup(
+      uint32_t id, const NexthopGroupMembers& members, uint8_t protocolId);
+
+  /**
+   * Delete a kernel nexthop object or group. NOTE: Kernel removes all routes
+   * still referencing the deleted object.
+   *
+   * @returns 0 on success else appropriate system error code
+   */
+  virtual folly::SemiFuture<int> deleteNexthop(uint32_t id);
+
+  /**
+   * API to get nexthop objects and groups of all protocols from kernel
+   */
+  virtual folly::SemiFuture<folly::Expected<std::vector<NexthopObject>, int>>
+  getAllNexthops();
+
   /**
    * API to get interfaces from kernel
    */
   virtual folly::SemiFuture<folly::Expected<std::vector<fbnl::Link>, int>>
   getAllLinks();
 
+  /**
+   * Links and neighbors in kernel, kept up to date from events. Serves
+   * lookups without a dump once synced. See NetlinkCache
+   */
+  const NetlinkCache&
+  getCache() const {
+    return cache_;
+  }
+
+  /**
+   * Number of times events got lost as they overran socket buffer (ENOBUFS).
+   * Subscribers keeping state from events should resync once it changes.
+   */
+  uint64_t
+  getNumEventLosses() const {
+    return numEventLosses_.load();
+  }
+
   /**
    * API to get interface addresses from kernel.
    */
@@ -211,6 +340,10 @@ class NetlinkProtocolSocket : public folly::EventHandler {
    * - protocol
    * - address family
    * - type
+   *
+   * If kernel supports strict checking of dump requests (>= 4.20), filter is
+   * applied by kernel and only the matching routes are dumped. Table and type
+   * are filtered by kernel for IPv4 and IPv6 routes only.
    */
   virtual folly::SemiFuture<folly::Expected<std::vector<fbnl::Route>, int>>
   getRoutes(const fbnl::Route& filter);
@@ -237,6 +370,15 @@ class NetlinkProtocolSocket : public folly::EventHandler {
       std::vector<folly::SemiFuture<int>>&& futures,
       std::unordered_set<int> ignoredErrors = {});
 
+  /**
+   * Utility function to reduce statuses of a batch request, e.g. result of
+   * `addRoutes(...)`, into first non-zero value(aka error code) which is not
+   * ignored. Returns 0 if there is none.
+   */
+  static int getFirstError(
+      const std::vector<int>& statuses,
+      const std::unordered_set<int>& ignoredErrors = {});
+
  protected:
   // Initialize netlink socket and add to eventloop for polling
   virtual void init();
@@ -248,22 +390,106 @@ class NetlinkProtocolSocket : public folly::EventHandler {
   // Implement EventHandler callback for reading netlink messages
   void handlerReady(uint16_t events) noexcept override;
 
-  // Send a message batch to netlink socket from queue_
+  // Send messages from queue_ to netlink socket while the in-flight window
+  // permits. Batched messages don't request an ack. Every `sendmsg` carrying
+  // any of them ends with an acked NLMSG_NOOP barrier instead. Kernel handles
+  // messages in order, hence ack of the barrier implies success of batched
+  // messages sent before it without an error reported.
   void sendNetlinkMessage();
 
   // Receive messages from netlink socket. Invoke `processMessage` for every
   // message received.
   void recvNetlinkMessage();
 
+  // Handle receive error of request socket
+  void processRecvError(int err);
+
+  // Process message, or receive error, read by io_uring backend from either
+  // socket
+  void processUringRecv(int fd, const char* data, int len);
+
+  // Invoked once messages read by io_uring backend on a wakeup are processed
+  void processUringRecvDone();
+
+  // Read up to kNlRecvBatch messages from `fd` into recvBufs_ without
+  // blocking. Returns number of messages read, their lengths are in
+  // recvMsgs_. Returns -1 and sets errno on error.
+  int recvBatch(int fd);
+
   // Process received netlink message. Set return values for pending requests
-  // or send notifications.
+  // or send notifications. Every message of the event socket is a
+  // notification.
   void processMessage(
-      const std::array<char, kMaxNlPayloadSize>& rxMsg, uint32_t bytesRead);
+      const char* rxMsg, uint32_t bytesRead, bool fromEventSocket = false);
+
+  /**
+   * Socket subscribed to LINK/ADDR/NEIGHBOR events, apart from the request
+   * socket. Events are hence neither queued behind replies of a burst of
+   * requests (e.g. route programming) in the socket buffer nor lost along
+   * with them on buffer overrun, and vice versa. Both sockets are served by
+   * the same event base.
+   */
+  class EventSocket : public folly::EventHandler {
+   public:
+    EventSocket(folly::EventBase* evb, NetlinkProtocolSocket& parent);
+    ~EventSocket() override;
+
+    int
+    getFd() const {
+      return fd_;
+    }
+
+    // Process events of a message read from socket
+    void processEvents(const char* data, uint32_t len);
+
+    // Handle receive error
+    void processRecvError(int err);
+
+    // Publish changes of the events read since `readTime` to readers of the
+    // cache
+    void publishEvents(std::chrono::steady_clock::time_point readTime);
+
+   private:
+    void handlerReady(uint16_t events) noexcept override;
+
+    NetlinkProtocolSocket& parent_;
+    int fd_{-1};
+  };
 
   // Process ack message. Set return status on pending requests in nlSeqNumMap_
   // Resume sending messages from queue_ if any pending
   void processAck(uint32_t ack, int status);
 
+  // Publish event to netlinkEventsQueue_, or buffer it for coalescing
+  void publishEvent(NetlinkEvent&& event);
+
+  // Publish coalesced events
+  void flushEvents();
+
+  // Sync cache_ from dumps of links and neighbors. Invoked once event socket
+  // is subscribed, and again whenever events got lost.
+  void syncCache();
+
+  // Type, interface and address of the state carried by an event. Events of
+  // the same key supersede each other.
+  using EventKey = std::tuple<size_t, int, std::optional<folly::CIDRNetwork>>;
+
+  // Rule events have no key and are never coalesced
+  static std::optional<EventKey> getEventKey(const NetlinkEvent& event);
+
+  // Set return status on pending request and remove it from nlSeqNumMap_
+  void completeRequest(uint32_t seq, int status);
+
+  // Grow in-flight window on timely ack. Halve it on late ack or receive
+  // buffer overrun, at most once per kNlAckLatencyTarget so that late acks of
+  // the same burst shrink it only once.
+  void updateInflightWindow(
+      std::chrono::steady_clock::duration ackLatency, bool overrun);
+
+  // Fail batched requests awaiting their barrier. Their errors may have been
+  // lost in an overrun of the receive buffer.
+  void failBatchedRequests(int status);
+
   // Event base for serializing read/write requests to netlink socket. Also
   // ensure thread safety of private member variables.
   folly::EventBase* evb_{nullptr};
@@ -282,10 +508,69 @@ class NetlinkProtocolSocket : public folly::EventHandler {
   // Use new IPv6 route replace semantics. See documentation for addRoute(...)
   const bool enableIPv6RouteReplaceSemantics_{false};
 
+  // Events are coalesced if non-zero. See constructor
+  const std::chrono::milliseconds eventCoalescingWindow_{0};
+
+  // Read sockets with io_uring backend. See constructor
+  const bool enableIoUring_{false};
+
+  // Events buffered in the current coalescing window, and index of the latest
+  // event of every key among them
+  std::vector<NetlinkEvent> pendingEvents_;
+  std::map<EventKey, size_t> pendingEventIndex_;
+  size_t numBurstEvents_{0};
+
+  // Timer publishing buffered events at the end of coalescing window
+  std::unique_ptr<folly::AsyncTimeout> eventCoalescingTimer_{nullptr};
+
+  // Set if kernel accepted NETLINK_GET_STRICT_CHK on the socket, hence applies
+  // filters of route dump requests. Read by threads making requests.
+  std::atomic<bool> strictDumpFiltering_{false};
+
   // Netlink socket fd. Created when class is constructed. Re-created on timeout
   // when no response is received for any of our pending requests.
   int nlSock_{-1};
 
+  // io_uring backend reading both sockets if enabled and supported by kernel,
+  // created right before event socket. Replies read, and time of the first
+  // event read, on the current wakeup.
+  std::unique_ptr<NetlinkUring> uring_;
+  size_t uringNumMsgs_{0};
+  std::optional<std::chrono::steady_clock::time_point> uringEventsReadTime_;
+
+  // Socket receiving events. Created along with the first request socket.
+  std::unique_ptr<EventSocket> eventSock_;
+
+  // Links and neighbors. Updated from events by event base thread
+  NetlinkCache cache_;
+
+  // Number of ENOBUFS errors on event socket. Read by other threads
+  std::atomic<uint64_t> numEventLosses_{0};
+
+  // Reset on destruction. Guards callbacks of sync dumps completing after it
+  std::shared_ptr<bool> alive_{std::make_shared<bool>(true)};
+
+  // Buffers of `recvBatch()`, set up once. Shared by request and event socket
+  // as both are read from the event base thread.
+  std::vector<std::array<char, kMaxNlPayloadSize>> recvBufs_;
+  std::vector<struct iovec> recvIovs_;
+  std::vector<struct mmsghdr> recvMsgs_;
+
+  // Per message stats, see [Thread Local Stats]
+  ThreadLocalStat bytesRxStat_{"netlink.bytes.rx", facebook::fb303::SUM};
+  ThreadLocalStat bytesTxStat_{"netlink.bytes.tx", facebook::fb303::SUM};
+  ThreadLocalStat requestsStat_{"netlink.requests", facebook::fb303::SUM};
+  ThreadLocalStat recvBatchSizeStat_{
+      "netlink.recv.batch_size", facebook::fb303::AVG};
+  ThreadLocalStat linkNotificationsStat_{
+      "netlink.notifications.link", facebook::fb303::SUM};
+  ThreadLocalStat addrNotificationsStat_{
+      "netlink.notifications.addr", facebook::fb303::SUM};
+  ThreadLocalStat neighborNotificationsStat_{
+      "netlink.notifications.neighbor", facebook::fb303::SUM};
+  ThreadLocalStat ruleNotificationsStat_{
+      "netlink.notifications.rule", facebook::fb303::SUM};
+
   // nl_pid stands for port-ID and not process-ID. Netlink sockets are bound on
   // this specified port. This must be unique for every netlink socket that
   // is created on the system. Ironically kernel assigns the process-ID as the
@@ -321,6 +606,15 @@ class NetlinkProtocolSocket : public folly::EventHandler {
   std::unordered_map<uint32_t, std::shared_ptr<NetlinkMessageBase>>
       nlSeqNumMap_;
 
+  // Sequence number of every pending barrier to the batched messages sent
+  // before it. See `sendNetlinkMessage()`
+  std::unordered_map<uint32_t, std::vector<uint32_t>> nlBarriers_;
+
+  // Maximum number of in-flight messages, within [kMinInflightWindow,
+  // kMaxInflightWindow]. See `updateInflightWindow()`
+  size_t inflightWindow_{kMaxIovMsg};
+  std::chrono::steady_clock::time_point lastWindowDecreaseTs_;
+
   // Timer to help keep track of timeout of messages sent to kernel. It also
   // ensures the aliveness of the netlink socket-fd. Timer is
   // - Started when a new message is sent
@@ -5,36 +5,143 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <fb303/ServiceData.h>
+#include <folly/hash/Hash.h>
 #include <folly/logging/xlog.h>
 
 #include <openr/nl/NetlinkRouteMessage.h>
 
+using facebook::fb303::fbData;
+namespace fb303 = facebook::fb303;
+
 namespace openr::fbnl {
 
+namespace {
+
+// Max number of next-hop sets of which encoding is cached per thread. Cache is
+// reset once full, so that sets no longer in use age out.
+constexpr size_t kMaxMultipathCacheSize{1024};
+
+/**
+ * Encoded RTA_MULTIPATH payload of a next-hop set. Most routes share their
+ * next-hops with many others, hence building their messages reuses encoding of
+ * the set rather than encoding every next-hop again. Encoding depends on
+ * family, type and scope of route as well (e.g. RTA_VIA for v4 route over v6
+ * next-hop), which are part of the key.
+ */
+struct MultipathCacheEntry {
+  uint8_t family{0};
+  uint8_t type{0};
+  uint8_t scope{0};
+  NextHopSet nextHops;
+  std::string payload;
+};
+
+// Keyed by `hashMultipath()`. Entry of colliding key is replaced on miss.
+// Per thread as routes are built by threads of callers of
+// NetlinkProtocolSocket.
+std::unordered_map<size_t, MultipathCacheEntry>&
+getMultipathCache() {
+  static thread_local std::unordered_map<size_t, MultipathCacheEntry> cache;
+  return cache;
+}
+
+size_t
+hashMultipath(const Route& route) {
+  // Combined in an order independent way, as iteration order of equal sets
+  // may differ
+  size_t nextHopsHash{0};
+  for (const auto& nh : route.getNextHops()) {
+    const auto gateway = nh.getGateway();
+    const auto action = nh.getLabelAction();
+    const auto labels = nh.getPushLabels();
+    nextHopsHash += folly::hash::hash_combine(
+        nh.getIfIndex().value_or(0),
+        gateway.has_value() ? std::hash<folly::IPAddress>()(*gateway) : 0,
+        std::max(nh.getWeight(), uint8_t(1)),
+        action.has_value() ? static_cast<int>(*action) + 1 : 0,
+        nh.getSwapLabel().value_or(0),
+        labels.has_value()
+            ? folly::hash::hash_range(labels->begin(), labels->end())
+            : 0,
+        nh.getFamily());
+  }
+  return folly::hash::hash_combine(
+      route.getFamily(), route.getType(), route.getScope(), nextHopsHash);
+}
+
+} // namespace
+
 NetlinkRouteMessage::NetlinkRouteMessage() : NetlinkMessageBase() {}
 
 NetlinkRouteMessage::~NetlinkRouteMessage() {
   CHECK(routePromise_.isFulfilled());
 }
 
+uint32_t
+RouteMessageView::getRouteTable() const {
+  // 32bit Routing table ID; if set, rtm_table is ignored
+  if (auto tableAttr = getAttribute(RTA_TABLE)) {
+    return *(reinterpret_cast<const uint32_t*> RTA_DATA(tableAttr));
+  }
+  return rtmsg_->rtm_table;
+}
+
+std::optional<folly::CIDRNetwork>
+RouteMessageView::getDestination() const {
+  auto dstAttr = getAttribute(RTA_DST);
+  if (not dstAttr or rtmsg_->rtm_family == AF_MPLS) {
+    return std::nullopt;
+  }
+  auto ipAddress = NetlinkMessageBase::parseIp(dstAttr, rtmsg_->rtm_family);
+  if (ipAddress.hasError()) {
+    return std::nullopt;
+  }
+  return std::make_pair(ipAddress.value(), (uint8_t)rtmsg_->rtm_dst_len);
+}
+
+const struct rtattr*
+RouteMessageView::getAttribute(uint16_t type) const {
+  auto routeAttrLen = RTM_PAYLOAD(nlmsg_);
+  for (auto routeAttr = RTM_RTA(rtmsg_); RTA_OK(routeAttr, routeAttrLen);
+       routeAttr = RTA_NEXT(routeAttr, routeAttrLen)) {
+    if (routeAttr->rta_type == type) {
+      return routeAttr;
+    }
+  }
+  return nullptr;
+}
+
+Route
+RouteMessageView::toRoute() const {
+  return NetlinkRouteMessage::parseMessage(nlmsg_);
+}
+
 void
-NetlinkRouteMessage::rcvdRoute(Route&& route) {
+NetlinkRouteMessage::rcvdRouteMessage(const struct nlmsghdr* nlmsg) {
   //
-  // Implement application side filters for table and protocol if specified
+  // Implement application side filters for table and protocol if specified.
+  // Only the header and table attribute are read for routes filtered out.
   //
+  const RouteMessageView view(nlmsg);
 
-  if (filters_.table && filters_.table != route.getRouteTable()) {
+  if (filters_.protocol && filters_.protocol != view.getProtocolId()) {
     return; // ignore the route
   }
 
-  if (filters_.protocol && filters_.protocol != route.getProtocolId()) {
+  if (filters_.type && filters_.type != view.getType()) {
     return; // ignore the route
   }
 
-  if (filters_.type && filters_.type != route.getType()) {
+  if (filters_.table && filters_.table != view.getRouteTable()) {
     return; // ignore the route
   }
 
+  rcvdRoute(parseMessage(nlmsg));
+}
+
+void
+NetlinkRouteMessage::rcvdRoute(Route&& route) {
   NextHopSet reversedMplsLabelNhs;
   bool reverted = false;
   for (auto nh : route.getNextHops()) {
@@ -56,6 +163,12 @@ NetlinkRouteMessage::rcvdRoute(Route&& route) {
 
 void
 NetlinkRouteMessage::setReturnStatus(int status) {
+  // Kernel fails the dump of a table which doesn't exist, instead of dumping
+  // no routes
+  if (kernelTableFilter_ and status == -ENOENT) {
+    status = 0;
+  }
+
   if (status == 0) {
     routePromise_.setValue(std::move(rcvdRoutes_));
   } else {
@@ -121,9 +234,29 @@ NetlinkRouteMessage::init(int type, uint32_t rtFlags, const Route& route) {
 }
 
 void
-NetlinkRouteMessage::initGet(uint32_t flags, const Route& route) {
+NetlinkRouteMessage::initGet(
+    uint32_t flags, const Route& route, bool strictFilter) {
   init(RTM_GETROUTE, flags, route);
-  addRtaTable(route.getRouteTable());
+  if (not strictFilter) {
+    addRtaTable(route.getRouteTable());
+    return;
+  }
+
+  // Strictly checked headers must not carry fields the dump of the family
+  // doesn't filter by. Routes are still filtered by user space filters.
+  rtmsg_->rtm_scope = 0;
+  rtmsg_->rtm_flags &= RTM_F_CLONED;
+  const auto family = route.getFamily();
+  if (family == AF_INET or family == AF_INET6) {
+    // Filter by table, protocol and type
+    kernelTableFilter_ = filters_.table != 0;
+    addRtaTable(route.getRouteTable());
+  } else {
+    // Filter by protocol only. MPLS dumps reject any other filter.
+    rtmsg_->rtm_table = 0;
+    rtmsg_->rtm_type = 0;
+    rtmsg_->rtm_flags = 0;
+  }
 }
 
 uint32_t
@@ -388,9 +521,28 @@ NetlinkRouteMessage::addPushNexthop(
 
 int
 NetlinkRouteMessage::addNextHops(const Route& route) {
-  std::array<char, kMaxNlPayloadSize> nhop = {};
   int status{0};
   if (route.getNextHops().size() && route.isMultiPath()) {
+    // Copy encoding of the next-hop set if cached
+    auto& cache = getMultipathCache();
+    const auto hash = hashMultipath(route);
+    auto it = cache.find(hash);
+    if (it != cache.end() and it->second.family == route.getFamily() and
+        it->second.type == route.getType() and
+        it->second.scope == route.getScope() and
+        it->second.nextHops == route.getNextHops()) {
+      fbData->addStatValue("netlink.route.multipath_cache.hit", 1, fb303::SUM);
+      const auto& payload = it->second.payload;
+      if ((status = addAttributes(
+               RTA_MULTIPATH, payload.data(), payload.size()))) {
+        return status;
+      }
+      showRtmMsg(rtmsg_);
+      return 0;
+    }
+    fbData->addStatValue("netlink.route.multipath_cache.miss", 1, fb303::SUM);
+
+    std::array<char, kMaxNlPayloadSize> nhop = {};
     if ((status = addMultiPathNexthop(nhop, route))) {
       return status;
     }
@@ -404,6 +556,18 @@ NetlinkRouteMessage::addNextHops(const Route& route) {
     }
     // print attributes when log level is enabled
     showMultiPathAttributes(reinterpret_cast<struct rtattr*>(nhop.data()));
+
+    if (cache.size() >= kMaxMultipathCacheSize) {
+      cache.clear();
+    }
+    cache.insert_or_assign(
+        hash,
+        MultipathCacheEntry{
+            route.getFamily(),
+            route.getType(),
+            route.getScope(),
+            route.getNextHops(),
+            std::string(data, payloadLen)});
   } else if (!route.isMultiPath() && route.getNextHops().size() == 1) {
     addSingleMplsNexthop(route);
   }
@@ -710,6 +874,12 @@ NetlinkRouteMessage::parseMessage(const struct nlmsghdr* nlmsg) {
       uint32_t table = *(reinterpret_cast<uint32_t*> RTA_DATA(routeAttr));
       routeBuilder.setRouteTable(table);
     } break;
+
+    // Nexthop object referenced by the route
+    case RTA_NH_ID: {
+      routeBuilder.setNexthopId(
+          *(reinterpret_cast<uint32_t*> RTA_DATA(routeAttr)));
+    } break;
     }
   }
 
@@ -813,6 +983,17 @@ NetlinkRouteMessage::addRoute(const Route& route) {
     return status;
   }
 
+  // Reference nexthop object instead of encoding nexthops inline
+  if (route.getNexthopId().has_value()) {
+    const uint32_t nexthopId = route.getNexthopId().value();
+    const char* const nhIdPtr = reinterpret_cast<const char*>(&nexthopId);
+    if ((status = addAttributes(RTA_NH_ID, nhIdPtr, sizeof(uint32_t)))) {
+      return status;
+    }
+    showRtmMsg(rtmsg_);
+    return 0;
+  }
+
   return addNextHops(route);
 }
 
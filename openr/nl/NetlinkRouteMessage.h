@@ -29,6 +29,55 @@ constexpr uint32_t kLabelBosShift{8};
 constexpr uint32_t kLabelShift{12};
 constexpr uint32_t kLabelSizeBits{20};
 
+/**
+ * Read-only view of a received rtnetlink ROUTE message. Fields are decoded
+ * from the message buffer as they are read, hence routes of a dump can be
+ * inspected (e.g. filtered by table or protocol) without building `Route`
+ * objects for them. The view doesn't own the buffer, which must outlive it.
+ */
+class RouteMessageView {
+ public:
+  explicit RouteMessageView(const struct nlmsghdr* nlmsg)
+      : nlmsg_(nlmsg),
+        rtmsg_(reinterpret_cast<const struct rtmsg*>(NLMSG_DATA(nlmsg))) {}
+
+  uint8_t
+  getFamily() const {
+    return rtmsg_->rtm_family;
+  }
+
+  uint8_t
+  getProtocolId() const {
+    return rtmsg_->rtm_protocol;
+  }
+
+  uint8_t
+  getType() const {
+    return rtmsg_->rtm_type;
+  }
+
+  uint8_t
+  getScope() const {
+    return rtmsg_->rtm_scope;
+  }
+
+  // 32bit table ID of RTA_TABLE if present, otherwise `rtm_table`
+  uint32_t getRouteTable() const;
+
+  // Destination prefix, std::nullopt for MPLS or default route
+  std::optional<folly::CIDRNetwork> getDestination() const;
+
+  // Top level attribute of `type`, nullptr if not present
+  const struct rtattr* getAttribute(uint16_t type) const;
+
+  // Fully decode the route
+  Route toRoute() const;
+
+ private:
+  const struct nlmsghdr* nlmsg_{nullptr};
+  const struct rtmsg* rtmsg_{nullptr};
+};
+
 /**
  * Message specialization for rtnetlink ROUTE type
  *
@@ -73,8 +122,10 @@ class NetlinkRouteMessage final : public NetlinkMessageBase {
   // initiallize route message with default params
   void init(int type, uint32_t flags, const Route& route);
 
-  // initiallize get route message, with RTA_TABLE set
-  void initGet(uint32_t flags, const Route& route);
+  // initiallize get route message, with RTA_TABLE set. With `strictFilter`
+  // the header is made valid for strict checking of dump requests by kernel,
+  // which then filters routes by it.
+  void initGet(uint32_t flags, const Route& route, bool strictFilter = false);
 
   // add a unicast route
   int addRoute(const Route& route);
@@ -95,7 +146,9 @@ class NetlinkRouteMessage final : public NetlinkMessageBase {
   static Route parseMessage(const struct nlmsghdr* nlmsg);
 
  private:
-  // inherited class implementation
+  // inherited class implementation. Routes not matching the filters of GET
+  // request are skipped before being decoded.
+  void rcvdRouteMessage(const struct nlmsghdr* nlmsg) override;
   void rcvdRoute(Route&& route) override;
 
   // process netlink next hops
@@ -178,6 +231,9 @@ class NetlinkRouteMessage final : public NetlinkMessageBase {
     uint8_t type{0};
   } filters_;
 
+  // Set if kernel filters the dump request by table
+  bool kernelTableFilter_{false};
+
   // promise to be fulfilled when receiving kernel reply
   folly::Promise<folly::Expected<std::vector<Route>, int>> routePromise_;
   std::vector<Route> rcvdRoutes_;
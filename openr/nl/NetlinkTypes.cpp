@@ -182,6 +182,17 @@ RouteBuilder::isMultiPath() const {
   return isMultiPath_;
 }
 
+RouteBuilder&
+RouteBuilder::setNexthopId(uint32_t nexthopId) {
+  nexthopId_ = nexthopId;
+  return *this;
+}
+
+std::optional<uint32_t>
+RouteBuilder::getNexthopId() const {
+  return nexthopId_;
+}
+
 void
 RouteBuilder::reset() {
   type_ = RTN_UNICAST;
@@ -196,6 +207,7 @@ RouteBuilder::reset() {
   advMss_.reset();
   nextHops_.clear();
   isMultiPath_ = true;
+  nexthopId_.reset();
 }
 
 Route::Route(const RouteBuilder& builder)
@@ -213,7 +225,8 @@ Route::Route(const RouteBuilder& builder)
       nextHops_(builder.getNextHops()),
       dst_(builder.getDestination()),
       mplsLabel_(builder.getMplsLabel()),
-      isMultiPath_(builder.isMultiPath()) {}
+      isMultiPath_(builder.isMultiPath()),
+      nexthopId_(builder.getNexthopId()) {}
 
 Route::~Route() {}
 
@@ -241,6 +254,7 @@ Route::operator=(Route&& other) noexcept {
   family_ = std::move(other.family_);
   mplsLabel_ = std::move(other.mplsLabel_);
   isMultiPath_ = std::move(other.isMultiPath_);
+  nexthopId_ = std::move(other.nexthopId_);
   return *this;
 }
 
@@ -268,6 +282,7 @@ Route::operator=(const Route& other) {
   family_ = other.family_;
   mplsLabel_ = other.mplsLabel_;
   isMultiPath_ = other.isMultiPath_;
+  nexthopId_ = other.nexthopId_;
   return *this;
 }
 
@@ -284,7 +299,8 @@ operator==(const Route& lhs, const Route& rhs) {
        lhs.getFlags() == rhs.getFlags() &&
        lhs.getPriority() == rhs.getPriority() && lhs.getTos() == rhs.getTos() &&
        lhs.getMtu() == rhs.getMtu() && lhs.getAdvMss() == rhs.getAdvMss() &&
-       lhs.getFamily() == rhs.getFamily());
+       lhs.getFamily() == rhs.getFamily() &&
+       lhs.getNexthopId() == rhs.getNexthopId());
 
   if (!ret) {
     return false;
@@ -375,6 +391,11 @@ Route::isMultiPath() const {
   return isMultiPath_;
 }
 
+std::optional<uint32_t>
+Route::getNexthopId() const {
+  return nexthopId_;
+}
+
 std::string
 Route::str() const {
   std::string result;
@@ -407,6 +428,9 @@ Route::str() const {
   if (advMss_) {
     result += fmt::format(", advmss {}", advMss_.value());
   }
+  if (nexthopId_) {
+    result += fmt::format(", nhid {}", nexthopId_.value());
+  }
   for (auto const& nextHop : nextHops_) {
     result += "\n  " + nextHop.str();
   }
@@ -423,6 +447,11 @@ Route::setNextHops(const NextHopSet& nextHops) {
   nextHops_ = nextHops;
 }
 
+void
+Route::setNexthopId(std::optional<uint32_t> nexthopId) {
+  nexthopId_ = nexthopId;
+}
+
 /*=================================NextHop====================================*/
 
 NextHop
@@ -229,6 +229,11 @@ class RouteBuilder {
   RouteBuilder& setMultiPath(bool isMultiPath);
   bool isMultiPath() const;
 
+  // Kernel nexthop object (RTA_NH_ID) referenced by the route. When set, the
+  // route is programmed against the object and `nextHops_` is informational.
+  RouteBuilder& setNexthopId(uint32_t nexthopId);
+  std::optional<uint32_t> getNexthopId() const;
+
   void reset();
 
  private:
@@ -247,6 +252,7 @@ class RouteBuilder {
   folly::CIDRNetwork dst_;
   std::optional<uint32_t> mplsLabel_;
   bool isMultiPath_{true};
+  std::optional<uint32_t> nexthopId_;
 };
 
 class Route final {
@@ -291,12 +297,16 @@ class Route final {
 
   bool isMultiPath() const;
 
+  std::optional<uint32_t> getNexthopId() const;
+
   void setPriority(uint32_t priority);
 
   std::string str() const;
 
   void setNextHops(const NextHopSet& nextHops);
 
+  void setNexthopId(std::optional<uint32_t> nexthopId);
+
  private:
   uint8_t type_{RTN_UNICAST};
   uint32_t routeTable_{RT_TABLE_MAIN};
@@ -313,6 +323,7 @@ class Route final {
   folly::CIDRNetwork dst_;
   std::optional<uint32_t> mplsLabel_;
   bool isMultiPath_{true};
+  std::optional<uint32_t> nexthopId_;
 };
 
 bool operator==(const Route& lhs, const Route& rhs);
@@ -0,0 +1,418 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <optional>
+
+#include <fb303/ServiceData.h>
+#include <folly/String.h>
+#include <folly/logging/xlog.h>
+
+#include <openr/nl/NetlinkMessageBase.h>
+#include <openr/nl/NetlinkUring.h>
+
+extern "C" {
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#endif
+}
+
+// Multishot `recvmsg` was the last of the features used below to be added to
+// kernel headers
+#if defined(IORING_RECV_MULTISHOT) && defined(__NR_io_uring_setup)
+#define OPENR_NL_URING 1
+#endif
+
+using facebook::fb303::fbData;
+namespace fb303 = facebook::fb303;
+
+namespace openr::fbnl {
+
+#ifdef OPENR_NL_URING
+
+namespace {
+
+// Tag of submissions whose completion is of no interest, e.g. cancellations.
+// Receives are tagged by generation and fd, generation starts at 1.
+constexpr uint64_t kIgnoredUserData{0};
+
+// Buffer group of buffers provided to kernel
+constexpr uint16_t kBufGroup{0};
+
+// Submission queue entries. Receives are armed one per socket at a time.
+constexpr unsigned kSqEntries{8};
+
+// Completion queue entries. Every buffer is held by at most one completion,
+// hence queue doesn't overflow.
+constexpr unsigned kCqEntries{2 * kNlUringNumBufs};
+
+int
+ioUringSetup(unsigned entries, struct io_uring_params* params) {
+  return ::syscall(__NR_io_uring_setup, entries, params);
+}
+
+int
+ioUringEnter(int ringFd, unsigned toSubmit) {
+  return ::syscall(
+      __NR_io_uring_enter, ringFd, toSubmit, 0, 0, nullptr, size_t(0));
+}
+
+int
+ioUringRegister(int ringFd, unsigned opcode, void* arg, unsigned nrArgs) {
+  return ::syscall(__NR_io_uring_register, ringFd, opcode, arg, nrArgs);
+}
+
+// NOTE: `io_uring_buf_ring::bufs` is a flexible array member of a union,
+// which C++ compilers may lay out past an empty struct. Entries, and the
+// tail overlaying the first of them, are addressed explicitly instead.
+struct io_uring_buf*
+getBufRingEntry(void* bufRing, uint16_t index) {
+  return reinterpret_cast<struct io_uring_buf*>(bufRing) + index;
+}
+
+uint16_t*
+getBufRingTail(void* bufRing) {
+  return &getBufRingEntry(bufRing, 0)->resv;
+}
+
+} // namespace
+
+std::unique_ptr<NetlinkUring>
+NetlinkUring::create(
+    folly::EventBase* evb,
+    RecvCallback onRecv,
+    RecvDoneCallback onRecvDone) {
+  std::unique_ptr<NetlinkUring> uring(
+      new NetlinkUring(evb, std::move(onRecv), std::move(onRecvDone)));
+  if (not uring->init()) {
+    return nullptr;
+  }
+  return uring;
+}
+
+NetlinkUring::NetlinkUring(
+    folly::EventBase* evb, RecvCallback onRecv, RecvDoneCallback onRecvDone)
+    : EventHandler(evb),
+      onRecv_(std::move(onRecv)),
+      onRecvDone_(std::move(onRecvDone)) {}
+
+NetlinkUring::~NetlinkUring() {
+  unregisterHandler();
+  // Closing ring cancels receives and releases sockets along with buffer
+  // group
+  if (ringFd_ >= 0) {
+    XLOG(INFO) << "Closing netlink io_uring. fd=" << ringFd_;
+    close(ringFd_);
+  }
+  if (bufRing_) {
+    munmap(bufRing_, bufRingSize_);
+  }
+  if (sqes_) {
+    munmap(sqes_, sqesSize_);
+  }
+  if (cqRing_ and cqRing_ != sqRing_) {
+    munmap(cqRing_, cqRingSize_);
+  }
+  if (sqRing_) {
+    munmap(sqRing_, sqRingSize_);
+  }
+}
+
+bool
+NetlinkUring::init() {
+  // Multishot receives came along with single issuer rings in kernel 6.0.
+  // Setup of the ring fails on older kernels.
+  struct io_uring_params params;
+  ::memset(&params, 0, sizeof(params));
+  params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_SINGLE_ISSUER;
+  params.cq_entries = kCqEntries;
+  ringFd_ = ioUringSetup(kSqEntries, &params);
+  if (ringFd_ < 0) {
+    XLOG(WARNING) << "Failed to set up netlink io_uring: "
+                  << folly::errnoStr(errno);
+    return false;
+  }
+
+  // Map submission and completion queues, in one mapping if kernel permits
+  sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cqRingSize_ =
+      params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  const bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+  if (singleMmap) {
+    sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+  }
+  auto mapRing = [this](size_t size, off_t offset) -> void* {
+    void* ptr = ::mmap(
+        nullptr,
+        size,
+        PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE,
+        ringFd_,
+        offset);
+    return ptr == MAP_FAILED ? nullptr : ptr;
+  };
+  sqRing_ = mapRing(sqRingSize_, IORING_OFF_SQ_RING);
+  cqRing_ = singleMmap ? sqRing_ : mapRing(cqRingSize_, IORING_OFF_CQ_RING);
+  sqesSize_ = params.sq_entries * sizeof(struct io_uring_sqe);
+  sqes_ = reinterpret_cast<struct io_uring_sqe*>(
+      mapRing(sqesSize_, IORING_OFF_SQES));
+  if (not sqRing_ or not cqRing_ or not sqes_) {
+    XLOG(WARNING) << "Failed to map netlink io_uring: "
+                  << folly::errnoStr(errno);
+    return false;
+  }
+
+  auto* sq = reinterpret_cast<char*>(sqRing_);
+  sqHead_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+  sqTail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+  sqArray_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+  sqMask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+  sqEntries_ = params.sq_entries;
+  auto* cq = reinterpret_cast<char*>(cqRing_);
+  cqHead_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+  cqTail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+  cqMask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+
+  // Provide buffers to kernel. Every one of them fits the largest message
+  // along with the header kernel prepends.
+  bufRingSize_ = kNlUringNumBufs * sizeof(struct io_uring_buf);
+  bufRing_ = ::mmap(
+      nullptr,
+      bufRingSize_,
+      PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS,
+      -1,
+      0);
+  if (bufRing_ == MAP_FAILED) {
+    bufRing_ = nullptr;
+    XLOG(WARNING) << "Failed to allocate netlink io_uring buffer ring: "
+                  << folly::errnoStr(errno);
+    return false;
+  }
+  struct io_uring_buf_reg reg;
+  ::memset(&reg, 0, sizeof(reg));
+  reg.ring_addr = reinterpret_cast<uint64_t>(bufRing_);
+  reg.ring_entries = kNlUringNumBufs;
+  reg.bgid = kBufGroup;
+  if (ioUringRegister(ringFd_, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+    XLOG(WARNING) << "Failed to register netlink io_uring buffer ring: "
+                  << folly::errnoStr(errno);
+    return false;
+  }
+  bufSize_ = sizeof(struct io_uring_recvmsg_out) + kMaxNlPayloadSize;
+  bufs_.resize(kNlUringNumBufs * bufSize_);
+  for (uint16_t bid = 0; bid < kNlUringNumBufs; ++bid) {
+    recycleBuffer(bid);
+  }
+  publishBuffers();
+
+  XLOG(INFO) << "Created netlink io_uring. fd=" << ringFd_;
+
+  // NOTE: We mask `READ` event with `PERSIST` to make sure the handler remains
+  // registered after the read event
+  changeHandlerFD(folly::NetworkSocket{ringFd_});
+  registerHandler(folly::EventHandler::READ | folly::EventHandler::PERSIST);
+  return true;
+}
+
+void
+NetlinkUring::addSocket(int fd) {
+  // Tag receive with a new generation, completions of an earlier socket of
+  // the same fd are then told apart
+  const uint64_t userData =
+      (static_cast<uint64_t>(++generation_) << 32) | static_cast<uint32_t>(fd);
+  sockets_[fd] = userData;
+  armRecv(fd, userData);
+  submit();
+}
+
+void
+NetlinkUring::removeSocket(int fd) {
+  auto it = sockets_.find(fd);
+  if (it == sockets_.end()) {
+    return;
+  }
+  auto* sqe = getSqe();
+  sqe->opcode = IORING_OP_ASYNC_CANCEL;
+  sqe->fd = -1;
+  sqe->addr = it->second;
+  sqe->user_data = kIgnoredUserData;
+  sockets_.erase(it);
+  submit();
+}
+
+void
+NetlinkUring::armRecv(int fd, uint64_t userData) {
+  auto* sqe = getSqe();
+  sqe->opcode = IORING_OP_RECVMSG;
+  sqe->fd = fd;
+  sqe->addr = reinterpret_cast<uint64_t>(&msgHdr_);
+  sqe->len = 1;
+  sqe->ioprio = IORING_RECV_MULTISHOT;
+  sqe->flags = IOSQE_BUFFER_SELECT;
+  sqe->buf_group = kBufGroup;
+  sqe->user_data = userData;
+}
+
+struct io_uring_sqe*
+NetlinkUring::getSqe() {
+  const unsigned head = __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+  if (*sqTail_ + sqQueued_ - head >= sqEntries_) {
+    submit();
+  }
+  const unsigned index = (*sqTail_ + sqQueued_) & sqMask_;
+  sqArray_[index] = index;
+  ++sqQueued_;
+  auto* sqe = &sqes_[index];
+  ::memset(sqe, 0, sizeof(*sqe));
+  return sqe;
+}
+
+void
+NetlinkUring::submit() {
+  if (not sqQueued_) {
+    return;
+  }
+  __atomic_store_n(sqTail_, *sqTail_ + sqQueued_, __ATOMIC_RELEASE);
+  unsigned toSubmit = sqQueued_;
+  sqQueued_ = 0;
+  while (toSubmit) {
+    const int ret = ioUringEnter(ringFd_, toSubmit);
+    if (ret < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      // Kernel holds unsubmitted entries, they're submitted with next ones
+      XLOG(ERR) << "Failed to submit to netlink io_uring: "
+                << folly::errnoStr(errno);
+      fbData->addStatValue("netlink.errors", 1, fb303::SUM);
+      return;
+    }
+    toSubmit -= std::min<unsigned>(ret, toSubmit);
+  }
+}
+
+void
+NetlinkUring::recycleBuffer(uint16_t bid) {
+  auto* buf = getBufRingEntry(bufRing_, bufRingTail_ & (kNlUringNumBufs - 1));
+  buf->addr = reinterpret_cast<uint64_t>(bufs_.data() + bid * bufSize_);
+  buf->len = bufSize_;
+  buf->bid = bid;
+  ++bufRingTail_;
+}
+
+void
+NetlinkUring::publishBuffers() {
+  auto* tail = getBufRingTail(bufRing_);
+  numBufsAvailable_ += static_cast<uint16_t>(bufRingTail_ - *tail);
+  __atomic_store_n(tail, bufRingTail_, __ATOMIC_RELEASE);
+}
+
+void
+NetlinkUring::handlerReady(uint16_t events) noexcept {
+  CHECK_EQ(events, folly::EventHandler::READ);
+
+  // All completions are reaped before buffers are handed back, running out of
+  // buffers is then told apart from an overrun. See `numBufsAvailable_`.
+  unsigned head = *cqHead_;
+  const unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+  for (; head != tail; ++head) {
+    const auto& cqe = cqes_[head & cqMask_];
+    const uint64_t userData = cqe.user_data;
+    const int res = cqe.res;
+    const uint32_t flags = cqe.flags;
+
+    std::optional<uint16_t> bid;
+    if (flags & IORING_CQE_F_BUFFER) {
+      bid = flags >> IORING_CQE_BUFFER_SHIFT;
+      --numBufsAvailable_;
+    }
+    if (userData == kIgnoredUserData) {
+      continue;
+    }
+
+    // Completion of a removed socket. Its buffer is recycled only.
+    const int fd = static_cast<int>(userData & 0xffffffff);
+    auto it = sockets_.find(fd);
+    const bool isActive = it != sockets_.end() and it->second == userData;
+
+    if (res >= 0 and bid.has_value()) {
+      if (isActive) {
+        const auto* out = reinterpret_cast<const struct io_uring_recvmsg_out*>(
+            bufs_.data() + *bid * bufSize_);
+        const auto* payload = reinterpret_cast<const char*>(out + 1) +
+            out->namelen + out->controllen;
+        // Length of a truncated message exceeds the bytes received
+        const int len = std::min<int>(
+            out->payloadlen,
+            res - (payload - reinterpret_cast<const char*>(out)));
+        onRecv_(fd, payload, len);
+      }
+      recycleBuffer(*bid);
+    } else if (res == -ENOBUFS and numBufsAvailable_ == 0) {
+      // Kernel ran out of buffers, no message is lost. Receive is re-armed
+      // once they've been recycled.
+      fbData->addStatValue("netlink.uring.buffers_exhausted", 1, fb303::SUM);
+    } else if (res < 0 and res != -ECANCELED and isActive) {
+      onRecv_(fd, nullptr, res);
+    }
+
+    // Multishot receive ended, e.g. on error or overflow of completion
+    // queue. Re-arm it unless socket got removed or can't be read from.
+    if (not(flags & IORING_CQE_F_MORE) and isActive) {
+      if (res >= 0 or res == -ENOBUFS or res == -EINTR or res == -EAGAIN) {
+        rearmSockets_.emplace_back(fd);
+      } else {
+        XLOG(ERR) << "Stopped receiving from netlink socket. fd=" << fd
+                  << ", err: " << folly::errnoStr(-res);
+        sockets_.erase(it);
+      }
+    }
+  }
+  __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+
+  // Hand buffers back to kernel before re-arming receives
+  publishBuffers();
+  for (const auto fd : rearmSockets_) {
+    auto it = sockets_.find(fd);
+    if (it != sockets_.end()) {
+      armRecv(fd, it->second);
+    }
+  }
+  rearmSockets_.clear();
+  submit();
+
+  onRecvDone_();
+}
+
+#else // OPENR_NL_URING
+
+std::unique_ptr<NetlinkUring>
+NetlinkUring::create(folly::EventBase*, RecvCallback, RecvDoneCallback) {
+  XLOG(WARNING) << "Netlink io_uring is not supported by kernel headers";
+  return nullptr;
+}
+
+NetlinkUring::~NetlinkUring() {}
+
+void
+NetlinkUring::addSocket(int) {}
+
+void
+NetlinkUring::removeSocket(int) {}
+
+void
+NetlinkUring::handlerReady(uint16_t) noexcept {}
+
+#endif // OPENR_NL_URING
+
+} // namespace openr::fbnl
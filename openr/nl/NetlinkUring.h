@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <folly/Function.h>
+#include <folly/io/async/EventBase.h>
+#include <folly/io/async/EventHandler.h>
+
+extern "C" {
+#include <sys/socket.h>
+}
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace openr::fbnl {
+
+// Number of buffers provided to kernel for receiving, shared by all sockets.
+// Must be a power of 2.
+constexpr uint16_t kNlUringNumBufs{64};
+
+/**
+ * io_uring backend for reading netlink sockets. One multishot `recvmsg` is
+ * armed per socket. Kernel reads every message into a buffer of a ring
+ * provided to it upfront (IORING_REGISTER_PBUF_RING) as soon as it arrives,
+ * and posts a completion. Completions are reaped once the ring fd turns
+ * readable on event base, hence a burst of replies costs neither a readiness
+ * wakeup nor a `recvmmsg` per batch of messages. Buffers are handed back to
+ * kernel once their message has been processed.
+ *
+ * Kernel is driven with raw syscalls, there is no dependency on liburing.
+ * Multishot `recvmsg` requires kernel 6.0+. `create()` returns nullptr on
+ * older kernels, or if built against older kernel headers, and callers read
+ * sockets by themselves then.
+ *
+ * NOTE: io_uring reports both an overrun of the socket receive buffer and
+ * running out of provided buffers as ENOBUFS. The latter is recovered from
+ * by re-arming the receive, while no message is lost. ENOBUFS is reported to
+ * the caller unless all buffers are known to have been in use. Running out of
+ * buffers may hence rarely be reported as an overrun, never vice versa.
+ *
+ * NOTE: Not thread-safe. All APIs must be invoked from the event base thread,
+ * which must be the thread creating it.
+ */
+class NetlinkUring : public folly::EventHandler {
+ public:
+  // Invoked with every message read from socket `fd`, or with `data` null
+  // and negative errno as `len` on receive error. Must not throw.
+  using RecvCallback =
+      folly::Function<void(int fd, const char* data, int len)>;
+
+  // Invoked once completions reaped on a wakeup have been processed
+  using RecvDoneCallback = folly::Function<void()>;
+
+  static std::unique_ptr<NetlinkUring> create(
+      folly::EventBase* evb,
+      RecvCallback onRecv,
+      RecvDoneCallback onRecvDone);
+
+  ~NetlinkUring() override;
+
+  // Start receiving from socket `fd`
+  void addSocket(int fd);
+
+  // Stop receiving from socket `fd`. Must be invoked before closing it.
+  void removeSocket(int fd);
+
+ private:
+  NetlinkUring(
+      folly::EventBase* evb,
+      RecvCallback onRecv,
+      RecvDoneCallback onRecvDone);
+
+  NetlinkUring(NetlinkUring const&) = delete;
+  NetlinkUring& operator=(NetlinkUring const&) = delete;
+
+  // Set up rings and provide buffers to kernel. Returns false if kernel
+  // doesn't support it.
+  bool init();
+
+  // Reap completions when ring fd is readable
+  void handlerReady(uint16_t events) noexcept override;
+
+  // Queue multishot `recvmsg` of socket `fd`, tagged by `userData`
+  void armRecv(int fd, uint64_t userData);
+
+  // Next free submission queue entry. Submits queued ones if ring is full.
+  struct io_uring_sqe* getSqe();
+
+  // Submit queued submission queue entries to kernel
+  void submit();
+
+  // Hand buffer `bid` back to kernel. Visible to it on `publishBuffers()`
+  void recycleBuffer(uint16_t bid);
+  void publishBuffers();
+
+  RecvCallback onRecv_;
+  RecvDoneCallback onRecvDone_;
+
+  int ringFd_{-1};
+
+  // Submission and completion queues mapped from the ring
+  void* sqRing_{nullptr};
+  size_t sqRingSize_{0};
+  void* cqRing_{nullptr};
+  size_t cqRingSize_{0};
+  struct io_uring_sqe* sqes_{nullptr};
+  size_t sqesSize_{0};
+  unsigned* sqHead_{nullptr};
+  unsigned* sqTail_{nullptr};
+  unsigned* sqArray_{nullptr};
+  unsigned sqMask_{0};
+  unsigned sqEntries_{0};
+  unsigned sqQueued_{0};
+  unsigned* cqHead_{nullptr};
+  unsigned* cqTail_{nullptr};
+  struct io_uring_cqe* cqes_{nullptr};
+  unsigned cqMask_{0};
+
+  // Ring of buffers provided to kernel, and the buffers. Every buffer holds
+  // a message preceded by the header kernel writes for `recvmsg`.
+  void* bufRing_{nullptr};
+  size_t bufRingSize_{0};
+  uint16_t bufRingTail_{0};
+  std::vector<char> bufs_;
+  size_t bufSize_{0};
+
+  // Buffers provided to kernel which no completion has been reaped for yet.
+  // Never lower than the number of buffers kernel has left.
+  size_t numBufsAvailable_{0};
+
+  // `msghdr` of all receives. Kernel writes no address or control message.
+  struct msghdr msgHdr_ {};
+
+  // Tag of the receive armed on every socket. Completions of a removed
+  // socket have a stale tag.
+  std::unordered_map<int, uint64_t> sockets_;
+  uint32_t generation_{0};
+
+  // Sockets whose multishot receive ended, re-armed after buffers got
+  // recycled
+  std::vector<int> rearmSockets_;
+};
+
+} // namespace openr::fbnl
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <openr/nl/NetlinkCache.h>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+extern "C" {
+#include <linux/neighbour.h>
+#include <net/if.h>
+}
+
+using namespace openr::fbnl;
+
+namespace {
+
+Link
+createLink(int ifIndex, const std::string& ifName, uint32_t flags = IFF_UP) {
+  return LinkBuilder()
+      .setIfIndex(ifIndex)
+      .setLinkName(ifName)
+      .setFlags(flags)
+      .build();
+}
+
+Neighbor
+createNeighbor(int ifIndex, const std::string& destination) {
+  return NeighborBuilder()
+      .setIfIndex(ifIndex)
+      .setDestination(folly::IPAddress(destination))
+      .setState(NUD_REACHABLE)
+      .build();
+}
+
+} // namespace
+
+TEST(NetlinkCacheTest, SyncAndUpdate) {
+  NetlinkCache cache;
+  EXPECT_FALSE(cache.isSynced());
+  EXPECT_FALSE(cache.getIfIndex("eth0").has_value());
+
+  cache.startSync();
+  cache.sync(
+      {createLink(1, "lo", IFF_UP | IFF_LOOPBACK), createLink(2, "eth0")},
+      {createNeighbor(2, "fe80::1")});
+  EXPECT_TRUE(cache.isSynced());
+
+  // Nothing is visible before publishing
+  EXPECT_FALSE(cache.getIfIndex("eth0").has_value());
+  auto oldSnapshot = cache.getSnapshot();
+  cache.publish();
+  EXPECT_EQ(2, cache.getIfIndex("eth0").value());
+  EXPECT_EQ("lo", cache.getIfName(1).value());
+  EXPECT_EQ(1, cache.getLoopbackIfIndex().value());
+  EXPECT_EQ(1, cache.getSnapshot()->neighbors.size());
+
+  // Rename, add and delete links
+  cache.updateLink(createLink(2, "eth1"), false /* isDeleted */);
+  cache.updateLink(createLink(3, "eth2"), false /* isDeleted */);
+  cache.updateLink(createLink(1, "lo"), true /* isDeleted */);
+  cache.updateNeighbor(createNeighbor(2, "fe80::1"), true /* isDeleted */);
+  cache.publish();
+  EXPECT_FALSE(cache.getIfIndex("eth0").has_value());
+  EXPECT_EQ(2, cache.getIfIndex("eth1").value());
+  EXPECT_EQ("eth2", cache.getIfName(3).value());
+  EXPECT_FALSE(cache.getIfName(1).has_value());
+  EXPECT_FALSE(cache.getLoopbackIfIndex().has_value());
+  EXPECT_TRUE(cache.getSnapshot()->neighbors.empty());
+
+  // Snapshots held by readers are immutable
+  EXPECT_TRUE(oldSnapshot->links.empty());
+}
+
+TEST(NetlinkCacheTest, EventsDuringSync) {
+  NetlinkCache cache;
+  cache.startSync();
+  cache.sync({createLink(1, "eth0"), createLink(2, "eth1")}, {});
+  cache.publish();
+
+  // Events received while dumps are pending are newer than dumped entries
+  cache.startSync();
+  cache.updateLink(createLink(1, "eth0", 0), false /* isDeleted */);
+  cache.updateLink(createLink(3, "eth2"), true /* isDeleted */);
+  cache.updateNeighbor(createNeighbor(1, "fe80::2"), false /* isDeleted */);
+  cache.sync(
+      {createLink(1, "eth0"), createLink(3, "eth2"), createLink(4, "eth3")},
+      {});
+  cache.publish();
+
+  auto snapshot = cache.getSnapshot();
+  ASSERT_EQ(2, snapshot->links.size());
+  EXPECT_FALSE(snapshot->links.at(1).isUp());
+  EXPECT_EQ("eth3", snapshot->links.at(4).getLinkName());
+  // Link missing from dump is deleted, deleted one is not resurrected
+  EXPECT_FALSE(cache.getIfName(2).has_value());
+  EXPECT_FALSE(cache.getIfName(3).has_value());
+  EXPECT_EQ(1, snapshot->neighbors.size());
+}
+
+int
+main(int argc, char* argv[]) {
+  // Parse command line flags
+  testing::InitGoogleTest(&argc, argv);
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  google::InstallFailureSignalHandler();
+  FLAGS_logtostderr = true;
+
+  // Run the tests
+  return RUN_ALL_TESTS();
+}
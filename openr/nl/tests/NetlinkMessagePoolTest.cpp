@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <openr/nl/NetlinkLinkMessage.h>
+#include <openr/nl/NetlinkMessageBase.h>
+#include <openr/nl/NetlinkRouteMessage.h>
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+using namespace openr;
+using namespace openr::fbnl;
+
+TEST(NetlinkMessagePool, ReuseBySize) {
+  auto& pool = NetlinkMessagePool::getInstance();
+  const auto numHits = pool.getNumHits();
+  const auto numMisses = pool.getNumMisses();
+  const auto numFree = pool.getNumFree();
+
+  // Memory of destroyed message is reused by the next one of the same type
+  auto routeMsg = std::make_unique<NetlinkRouteMessage>();
+  const void* routeMsgPtr = routeMsg.get();
+  routeMsg.reset();
+  EXPECT_EQ(numFree + 1, pool.getNumFree());
+
+  routeMsg = std::make_unique<NetlinkRouteMessage>();
+  EXPECT_EQ(routeMsgPtr, routeMsg.get());
+  EXPECT_EQ(numFree, pool.getNumFree());
+
+  // Message of other type is not served from memory of route messages
+  auto linkMsg = std::make_unique<NetlinkLinkMessage>();
+  EXPECT_NE(routeMsgPtr, static_cast<const void*>(linkMsg.get()));
+
+  EXPECT_EQ(numHits + 1, pool.getNumHits());
+  EXPECT_EQ(numMisses + 2, pool.getNumMisses());
+
+  routeMsg.reset();
+  linkMsg.reset();
+  EXPECT_EQ(numFree + 2, pool.getNumFree());
+}
+
+TEST(NetlinkMessagePool, BoundedFreeList) {
+  auto& pool = NetlinkMessagePool::getInstance();
+  const auto numFree = pool.getNumFree();
+
+  std::vector<std::unique_ptr<NetlinkRouteMessage>> msgs;
+  for (size_t i = 0; i < NetlinkMessagePool::kMaxFreePerSize + 10; ++i) {
+    msgs.emplace_back(std::make_unique<NetlinkRouteMessage>());
+  }
+  EXPECT_GE(numFree, pool.getNumFree());
+
+  // Memory beyond the bound goes back to the heap
+  msgs.clear();
+  EXPECT_GE(NetlinkMessagePool::kMaxFreePerSize + numFree, pool.getNumFree());
+  EXPECT_LE(NetlinkMessagePool::kMaxFreePerSize, pool.getNumFree());
+}
+
+int
+main(int argc, char* argv[]) {
+  // Parse command line flags
+  testing::InitGoogleTest(&argc, argv);
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  google::InstallFailureSignalHandler();
+  FLAGS_logtostderr = true;
+
+  // Run the tests
+  return RUN_ALL_TESTS();
+}
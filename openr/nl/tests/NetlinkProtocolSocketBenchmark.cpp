@@ -0,0 +1,437 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <fmt/format.h>
+#include <folly/Benchmark.h>
+#include <folly/IPAddress.h>
+#include <folly/Subprocess.h>
+#include <folly/init/Init.h>
+#include <folly/io/async/EventBase.h>
+#include <folly/system/Shell.h>
+
+#include <openr/nl/NetlinkProtocolSocket.h>
+
+extern "C" {
+#include <sched.h>
+#include <unistd.h>
+}
+
+/**
+ * Benchmarks of NetlinkProtocolSocket against the kernel. Must be run as root.
+ * Process moves into a network namespace of its own with a veth pair, hence
+ * routes and addresses of the host are never touched.
+ *
+ * Run with `--json` (or `--bm_json_verbose <file>`) for machine-readable
+ * results to be compared across releases. Benchmarks suffixed `_uring` read
+ * sockets with io_uring backend, to be compared against the ones of the same
+ * name without the suffix.
+ */
+
+/**
+ * Defines a benchmark that allows users to record customized counter during
+ * benchmarking and passes parameters to it with a custom name.
+ */
+#define BENCHMARK_COUNTERS_NAME_PARAM(name, counters, param_name, ...) \
+  BENCHMARK_IMPL_COUNTERS(                                             \
+      FB_CONCATENATE(name, FB_CONCATENATE(_, param_name)),             \
+      FOLLY_PP_STRINGIZE(name) "(" FOLLY_PP_STRINGIZE(param_name) ")", \
+      counters,                                                        \
+      iters,                                                           \
+      unsigned,                                                        \
+      iters) {                                                         \
+    name(counters, iters, ##__VA_ARGS__);                              \
+  }
+
+using namespace folly::literals::shell_literals;
+
+namespace {
+// Virtual interfaces of the namespace
+const std::string kVethNameX("vethBenchX");
+const std::string kVethNameY("vethBenchY");
+
+// Open/R protocolId
+const uint8_t kRouteProtoId{99};
+
+// Label of the first pushed label
+const int32_t kBaseLabel{100};
+
+void
+runCommand(std::vector<std::string> cmd) {
+  folly::Subprocess proc(std::move(cmd));
+  CHECK_EQ(0, proc.wait().exitStatus());
+}
+
+// Move process into a network namespace of its own and create veth pair
+void
+setupNetworkNamespace() {
+  PCHECK(::unshare(CLONE_NEWNET) == 0) << "Failed creating network namespace";
+  runCommand("ip link set lo up"_shellify());
+  runCommand("ip link add {} type veth peer name {}"_shellify(
+      kVethNameX.c_str(), kVethNameY.c_str()));
+  runCommand("ip link set dev {} up"_shellify(kVethNameX.c_str()));
+  runCommand("ip link set dev {} up"_shellify(kVethNameY.c_str()));
+}
+
+} // namespace
+
+namespace openr::fbnl {
+
+/**
+ * NetlinkProtocolSocket served by its own event base thread, reading sockets
+ * with io_uring backend if `enableIoUring` is set
+ */
+class NetlinkBenchmarkWrapper {
+ public:
+  explicit NetlinkBenchmarkWrapper(bool enableIoUring) {
+    nlSock = std::make_unique<NetlinkProtocolSocket>(
+        &evb,
+        netlinkEventsQ,
+        false /* enableIPv6RouteReplaceSemantics */,
+        std::chrono::milliseconds(0),
+        enableIoUring);
+    evbThread = std::thread([this]() { evb.loopForever(); });
+    evb.waitUntilRunning();
+
+    for (const auto& link : nlSock->getAllLinks().get().value()) {
+      if (link.getLinkName() == kVethNameX) {
+        ifIndex = link.getIfIndex();
+      }
+    }
+    CHECK_NE(0, ifIndex) << "Interface " << kVethNameX << " not found";
+  }
+
+  ~NetlinkBenchmarkWrapper() {
+    netlinkEventsQ.close();
+    evb.runInEventBaseThreadAndWait([this]() { nlSock.reset(); });
+    evb.terminateLoopSoon();
+    evbThread.join();
+  }
+
+  // IPv6 routes of `numNexthops` link-local gateways, each pushing
+  // `numLabels` labels
+  std::vector<Route>
+  createRoutes(size_t numRoutes, size_t numNexthops, size_t numLabels) const {
+    std::vector<Route> routes;
+    routes.reserve(numRoutes);
+    for (size_t i = 0; i < numRoutes; ++i) {
+      RouteBuilder rtBuilder;
+      rtBuilder.setProtocolId(kRouteProtoId)
+          .setDestination(folly::IPAddress::createNetwork(
+              fmt::format("fd00:{:x}:{:x}::/64", i >> 16, i & 0xffff)))
+          .setValid(true);
+      for (size_t j = 0; j < numNexthops; ++j) {
+        NextHopBuilder nhBuilder;
+        nhBuilder.setIfIndex(ifIndex).setGateway(
+            folly::IPAddress(fmt::format("fe80::{:x}", j + 1)));
+        if (numLabels) {
+          std::vector<int32_t> labels(numLabels);
+          for (size_t k = 0; k < numLabels; ++k) {
+            labels[k] = kBaseLabel + k;
+          }
+          nhBuilder.setPushLabels(labels).setLabelAction(
+              thrift::MplsActionCode::PUSH);
+        }
+        rtBuilder.addNextHop(nhBuilder.build());
+      }
+      routes.emplace_back(rtBuilder.build());
+    }
+    return routes;
+  }
+
+  // Add routes, `batchSize` of them per `addRoutes` call. All batches are
+  // enqueued at once. Returns number of failed routes
+  size_t
+  addRoutes(const std::vector<Route>& routes, size_t batchSize) {
+    std::vector<folly::SemiFuture<std::vector<int>>> futures;
+    for (size_t i = 0; i < routes.size(); i += batchSize) {
+      const auto end = std::min(routes.size(), i + batchSize);
+      futures.emplace_back(nlSock->addRoutes(
+          std::vector<Route>(routes.begin() + i, routes.begin() + end)));
+    }
+    size_t numErrors{0};
+    for (auto& future : futures) {
+      for (const auto status : std::move(future).get()) {
+        numErrors += status != 0;
+      }
+    }
+    return numErrors;
+  }
+
+  // Delete routes. Returns number of failed routes
+  size_t
+  deleteRoutes(const std::vector<Route>& routes) {
+    std::vector<folly::SemiFuture<int>> futures;
+    for (const auto& route : routes) {
+      futures.emplace_back(nlSock->deleteRoute(route));
+    }
+    size_t numErrors{0};
+    for (auto& future : futures) {
+      numErrors += std::move(future).get() != 0;
+    }
+    return numErrors;
+  }
+
+  folly::EventBase evb;
+  messaging::ReplicateQueue<NetlinkEvent> netlinkEventsQ;
+  std::unique_ptr<NetlinkProtocolSocket> nlSock;
+  std::thread evbThread;
+  int ifIndex{0};
+};
+
+/**
+ * Benchmark for route programming
+ * 1. Generate IPv6 routes of given ECMP width and label stack
+ * 2. Add routes in batches of given size
+ * 3. Delete routes
+ *
+ * Counters
+ * - add_routes_per_sec: route add throughput
+ * - delete_routes_per_sec: route delete throughput
+ * - errors: routes failed to be added or deleted
+ */
+static void
+BM_RouteProgramming(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    unsigned numOfRoutes,
+    unsigned batchSize,
+    unsigned numOfNexthops,
+    unsigned numOfLabels,
+    bool enableIoUring = false) {
+  auto suspender = folly::BenchmarkSuspender();
+  auto wrapper = std::make_unique<NetlinkBenchmarkWrapper>(enableIoUring);
+  const auto routes =
+      wrapper->createRoutes(numOfRoutes, numOfNexthops, numOfLabels);
+
+  for (uint32_t i = 0; i < iters; i++) {
+    suspender.dismiss(); // Start measuring benchmark time
+    const auto addStartTime = std::chrono::steady_clock::now();
+    auto numErrors = wrapper->addRoutes(routes, batchSize);
+    const auto delStartTime = std::chrono::steady_clock::now();
+    numErrors += wrapper->deleteRoutes(routes);
+    const auto endTime = std::chrono::steady_clock::now();
+    suspender.rehire(); // Stop measuring time again
+
+    const auto addUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                           delStartTime - addStartTime)
+                           .count();
+    const auto delUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                           endTime - delStartTime)
+                           .count();
+    counters["add_routes_per_sec"] =
+        numOfRoutes * 1000000L / std::max(addUs, 1L);
+    counters["delete_routes_per_sec"] =
+        numOfRoutes * 1000000L / std::max(delUs, 1L);
+    counters["errors"] = numErrors;
+  }
+}
+
+/**
+ * Benchmark for dumping and parsing routes
+ * 1. Add routes
+ * 2. Dump routes of Open/R from kernel
+ *
+ * Counters
+ * - routes_per_sec: routes dumped and parsed per second
+ */
+static void
+BM_RouteDump(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    unsigned numOfRoutes,
+    unsigned numOfNexthops,
+    bool enableIoUring = false) {
+  auto suspender = folly::BenchmarkSuspender();
+  auto wrapper = std::make_unique<NetlinkBenchmarkWrapper>(enableIoUring);
+  const auto routes = wrapper->createRoutes(numOfRoutes, numOfNexthops, 0);
+  CHECK_EQ(0, wrapper->addRoutes(routes, routes.size()));
+
+  for (uint32_t i = 0; i < iters; i++) {
+    suspender.dismiss(); // Start measuring benchmark time
+    const auto startTime = std::chrono::steady_clock::now();
+    auto kernelRoutes = wrapper->nlSock->getIPv6Routes(kRouteProtoId).get();
+    const auto elapsedUs =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - startTime)
+            .count();
+    suspender.rehire(); // Stop measuring time again
+
+    CHECK(kernelRoutes.hasValue());
+    CHECK_EQ(numOfRoutes, kernelRoutes->size());
+    counters["routes_per_sec"] =
+        numOfRoutes * 1000000L / std::max(elapsedUs, 1L);
+  }
+
+  CHECK_EQ(0, wrapper->deleteRoutes(routes));
+}
+
+/**
+ * Benchmark for event delivery while routes are being programmed
+ * 1. Add and delete routes in a loop from another thread
+ * 2. Add addresses one by one and wait for the event of each
+ *
+ * Counters
+ * - avg_latency_us: time from address add request to delivery of its event
+ * - max_latency_us: worst of above
+ */
+static void
+BM_EventLatency(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    unsigned numOfEvents,
+    unsigned numOfLoadRoutes,
+    bool enableIoUring = false) {
+  auto suspender = folly::BenchmarkSuspender();
+  auto wrapper = std::make_unique<NetlinkBenchmarkWrapper>(enableIoUring);
+  auto eventsReader = wrapper->netlinkEventsQ.getReader();
+  const auto routes = wrapper->createRoutes(numOfLoadRoutes, 4, 0);
+
+  // Route programming load
+  std::atomic<bool> stopLoad{false};
+  std::thread loadThread([&]() {
+    while (not routes.empty() and not stopLoad) {
+      wrapper->addRoutes(routes, routes.size());
+      wrapper->deleteRoutes(routes);
+    }
+  });
+
+  for (uint32_t i = 0; i < iters; i++) {
+    std::vector<IfAddress> addrs;
+    int64_t totalUs{0};
+    int64_t maxUs{0};
+
+    suspender.dismiss(); // Start measuring benchmark time
+    for (unsigned j = 0; j < numOfEvents; ++j) {
+      const auto prefix = folly::IPAddress::createNetwork(
+          fmt::format("fc00:{:x}::{:x}/128", i + 1, j + 1));
+      IfAddressBuilder builder;
+      auto addr = builder.setIfIndex(wrapper->ifIndex)
+                      .setPrefix(prefix)
+                      .setValid(true)
+                      .build();
+
+      const auto startTime = std::chrono::steady_clock::now();
+      CHECK_EQ(0, wrapper->nlSock->addIfAddress(addr).get());
+      while (true) {
+        auto event = eventsReader.get();
+        CHECK(event.hasValue());
+        auto* addrEvent = std::get_if<IfAddress>(&event.value());
+        if (addrEvent and addrEvent->isValid() and
+            addrEvent->getPrefix() == prefix) {
+          break;
+        }
+      }
+      const auto latencyUs =
+          std::chrono::duration_cast<std::chrono::microseconds>(
+              std::chrono::steady_clock::now() - startTime)
+              .count();
+      totalUs += latencyUs;
+      maxUs = std::max(maxUs, latencyUs);
+      addrs.emplace_back(std::move(addr));
+    }
+    suspender.rehire(); // Stop measuring time again
+
+    for (const auto& addr : addrs) {
+      wrapper->nlSock->deleteIfAddress(addr).get();
+    }
+    counters["avg_latency_us"] = totalUs / std::max(numOfEvents, 1U);
+    counters["max_latency_us"] = maxUs;
+  }
+
+  stopLoad = true;
+  loadThread.join();
+}
+
+/*
+ * @params counters: reserved counter for customized profile
+ * @params first integer: num of routes
+ * @params second integer: num of routes per addRoutes call
+ * @params third integer: num of nexthops of every route
+ * @params fourth integer: num of labels pushed by every nexthop
+ * @params fifth: read sockets with io_uring backend, false by default
+ */
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_RouteProgramming, counters, 10k_batch_1, 10000, 1, 1, 0);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_RouteProgramming, counters, 10k_batch_100, 10000, 100, 1, 0);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_RouteProgramming, counters, 10k_batch_10k, 10000, 10000, 1, 0);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_RouteProgramming, counters, 100k_batch_10k, 100000, 10000, 1, 0);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_RouteProgramming, counters, 10k_ecmp_16, 10000, 10000, 16, 0);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_RouteProgramming, counters, 10k_ecmp_64, 10000, 10000, 64, 0);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_RouteProgramming, counters, 10k_ecmp_128, 10000, 10000, 128, 0);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_RouteProgramming, counters, 10k_labels_2, 10000, 10000, 4, 2);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_RouteProgramming, counters, 10k_labels_8, 10000, 10000, 4, 8);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_RouteProgramming, counters, 10k_batch_1_uring, 10000, 1, 1, 0, true);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_RouteProgramming,
+    counters,
+    10k_batch_10k_uring,
+    10000,
+    10000,
+    1,
+    0,
+    true);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_RouteProgramming,
+    counters,
+    100k_batch_10k_uring,
+    100000,
+    10000,
+    1,
+    0,
+    true);
+
+/*
+ * @params counters: reserved counter for customized profile
+ * @params first integer: num of routes
+ * @params second integer: num of nexthops of every route
+ * @params third: read sockets with io_uring backend, false by default
+ */
+BENCHMARK_COUNTERS_NAME_PARAM(BM_RouteDump, counters, 10k, 10000, 1);
+BENCHMARK_COUNTERS_NAME_PARAM(BM_RouteDump, counters, 100k, 100000, 1);
+BENCHMARK_COUNTERS_NAME_PARAM(BM_RouteDump, counters, 10k_ecmp_16, 10000, 16);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_RouteDump, counters, 100k_uring, 100000, 1, true);
+
+/*
+ * @params counters: reserved counter for customized profile
+ * @params first integer: num of address events
+ * @params second integer: num of routes programmed in a loop meanwhile
+ * @params third: read sockets with io_uring backend, false by default
+ */
+BENCHMARK_COUNTERS_NAME_PARAM(BM_EventLatency, counters, idle, 100, 0);
+BENCHMARK_COUNTERS_NAME_PARAM(BM_EventLatency, counters, load_10k, 100, 10000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_EventLatency, counters, load_10k_uring, 100, 10000, true);
+
+} // namespace openr::fbnl
+
+int
+main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  if (getuid()) {
+    LOG(ERROR) << "Netlink benchmarks must be run as root";
+    return 1;
+  }
+  setupNetworkNamespace();
+  folly::runBenchmarks();
+  return 0;
+}
@@ -32,6 +32,8 @@ extern "C" {
 
 DEFINE_bool(
     enable_ipv6_rr_semantics, false, "Enable ipv6 route replace semantics");
+DEFINE_bool(
+    enable_io_uring, false, "Read netlink sockets with io_uring backend");
 
 using namespace openr;
 using namespace openr::fbnl;
@@ -141,7 +143,11 @@ class NlMessageFixture : public ::testing::Test {
 
     // netlink protocol socket
     nlSock = std::make_unique<NetlinkProtocolSocket>(
-        &evb, netlinkEventsQ, FLAGS_enable_ipv6_rr_semantics);
+        &evb,
+        netlinkEventsQ,
+        FLAGS_enable_ipv6_rr_semantics,
+        std::chrono::milliseconds(0),
+        FLAGS_enable_io_uring);
 
     // start event thread
     eventThread = std::thread([&]() { evb.loopForever(); });
@@ -741,6 +747,127 @@ TEST_F(NlMessageFixture, LinkEventPublication) {
   }
 }
 
+/*
+ * Flap link within coalescing window of a socket. Verify fewer link events
+ * than transitions are published and the latest one carries final state.
+ */
+TEST_F(NlMessageFixture, LinkEventCoalescing) {
+  folly::EventBase coalescingEvb;
+  messaging::ReplicateQueue<NetlinkEvent> coalescedEventsQ;
+  auto coalescedEventsReader = coalescedEventsQ.getReader();
+  auto coalescingSock = std::make_unique<NetlinkProtocolSocket>(
+      &coalescingEvb,
+      coalescedEventsQ,
+      FLAGS_enable_ipv6_rr_semantics,
+      std::chrono::milliseconds(500));
+  std::thread coalescingThread([&]() { coalescingEvb.loopForever(); });
+  coalescingEvb.waitUntilRunning();
+  // Socket is subscribed to events once it serves a request
+  coalescingSock->getAllLinks().get().value();
+
+  const size_t numFlaps{5};
+  for (size_t i = 0; i < numFlaps; i++) {
+    bringDownIntf(kVethNameX);
+    bringUpIntf(kVethNameX);
+  }
+  bringDownIntf(kVethNameX);
+
+  // Read until final state of link is published
+  size_t numLinkEvents{0};
+  while (true) {
+    auto event = coalescedEventsReader.get();
+    ASSERT_TRUE(event.hasValue());
+    auto* link = std::get_if<Link>(&event.value());
+    if (not link or link->getLinkName() != kVethNameX) {
+      continue;
+    }
+    ++numLinkEvents;
+    if (not link->isUp()) {
+      break;
+    }
+  }
+  EXPECT_LT(numLinkEvents, 2 * numFlaps + 1);
+  EXPECT_LT(
+      0,
+      facebook::fb303::fbData
+          ->getCounters()["netlink.notifications.coalesced.sum"]);
+
+  coalescedEventsQ.close();
+  coalescingEvb.runInEventBaseThreadAndWait(
+      [&]() { coalescingSock.reset(); });
+  coalescingEvb.terminateLoopSoon();
+  coalescingThread.join();
+}
+
+/*
+ * Read sockets with io_uring backend. Add routes in bulk and dump them, with
+ * far more replies than buffers provided to kernel. Verify every route is
+ * dumped, and events are delivered. Skipped if kernel doesn't support it.
+ */
+TEST_F(NlMessageFixture, IoUringRouteDump) {
+  folly::EventBase probeEvb;
+  if (not NetlinkUring::create(
+          &probeEvb, [](int, const char*, int) {}, []() {})) {
+    GTEST_SKIP() << "io_uring is not supported";
+  }
+
+  folly::EventBase uringEvb;
+  messaging::ReplicateQueue<NetlinkEvent> uringEventsQ;
+  auto uringEventsReader = uringEventsQ.getReader();
+  auto uringSock = std::make_unique<NetlinkProtocolSocket>(
+      &uringEvb,
+      uringEventsQ,
+      FLAGS_enable_ipv6_rr_semantics,
+      std::chrono::milliseconds(0),
+      true /* enableIoUring */);
+  std::thread uringThread([&]() { uringEvb.loopForever(); });
+  uringEvb.waitUntilRunning();
+
+  const uint32_t count{10000};
+  std::vector<NextHop> paths;
+  paths.emplace_back(buildNextHop(
+      std::nullopt,
+      std::nullopt,
+      std::nullopt,
+      ipAddrY1V6, /* NH address */
+      ifIndexX /* interface index */));
+  std::vector<Route> routes;
+  for (uint32_t i = 0; i < count; i++) {
+    const auto prefix = folly::IPAddress::createNetwork(
+        fmt::format("fd00:{:x}:{:x}::/64", i >> 16, i & 0xffff));
+    routes.emplace_back(buildRoute(kRouteProtoId, prefix, std::nullopt, paths));
+  }
+  auto statuses = uringSock->addRoutes(routes).get();
+  EXPECT_EQ(std::vector<int>(count, 0), statuses);
+
+  auto kernelRoutes = uringSock->getIPv6Routes(kRouteProtoId).get().value();
+  EXPECT_EQ(count, kernelRoutes.size());
+  EXPECT_EQ(findRoutesInKernelRoutes(kernelRoutes, routes), count);
+
+  std::vector<folly::SemiFuture<int>> futures;
+  for (auto& route : routes) {
+    futures.emplace_back(uringSock->deleteRoute(route));
+  }
+  NetlinkProtocolSocket::collectReturnStatus(std::move(futures)).get();
+  EXPECT_EQ(0, uringSock->getIPv6Routes(kRouteProtoId).get().value().size());
+
+  // Event of link going down is delivered
+  bringDownIntf(kVethNameX);
+  while (true) {
+    auto event = uringEventsReader.get();
+    ASSERT_TRUE(event.hasValue());
+    auto* link = std::get_if<Link>(&event.value());
+    if (link and link->getLinkName() == kVethNameX and not link->isUp()) {
+      break;
+    }
+  }
+
+  uringEventsQ.close();
+  uringEvb.runInEventBaseThreadAndWait([&]() { uringSock.reset(); });
+  uringEvb.terminateLoopSoon();
+  uringThread.join();
+}
+
 /*
  * Spawn RQueue of `NetlinkEvent` to verify:
  *  1) ADDR_EVENT(ADD) is populated through replicate queue;
@@ -1825,6 +1952,97 @@ TEST_F(NlMessageFixture, MultipleLabelRoutes) {
   EXPECT_EQ(0, kernelRoutes.size());
 }
 
+/*
+ * Add routes in bulk. Verify per route status is reported in order and every
+ * valid route is programmed
+ */
+TEST_F(NlMessageFixture, BulkRouteAdd) {
+  const uint32_t count{1000};
+  std::vector<NextHop> paths;
+  paths.emplace_back(buildNextHop(
+      std::nullopt,
+      std::nullopt,
+      std::nullopt,
+      ipAddrY1V6, /* NH address */
+      ifIndexX /* interface index */));
+  std::vector<Route> routes;
+  for (uint32_t i = 0; i < count; i++) {
+    const auto prefix =
+        folly::IPAddress::createNetwork(fmt::format("fd00:{:x}::/64", i + 1));
+    routes.emplace_back(buildRoute(kRouteProtoId, prefix, std::nullopt, paths));
+  }
+  // Route with unsupported family, will fail
+  routes.emplace_back(
+      buildRoute(kRouteProtoId, std::nullopt, std::nullopt, paths));
+
+  const auto ackCount = getAckCount();
+  auto statuses = nlSock->addRoutes(routes).get();
+  ASSERT_EQ(count + 1, statuses.size());
+  EXPECT_EQ(-EPROTONOSUPPORT, statuses.back());
+  statuses.pop_back();
+  EXPECT_EQ(std::vector<int>(count, 0), statuses);
+  EXPECT_EQ(0, getErrorCount());
+  EXPECT_GE(getAckCount(), ackCount + count);
+
+  auto kernelRoutes = nlSock->getIPv6Routes(kRouteProtoId).get().value();
+  routes.pop_back();
+  EXPECT_EQ(count, kernelRoutes.size());
+  EXPECT_EQ(findRoutesInKernelRoutes(kernelRoutes, routes), count);
+
+  // Empty batch completes right away
+  EXPECT_TRUE(nlSock->addRoutes({}).get().empty());
+
+  std::vector<folly::SemiFuture<int>> futures;
+  for (auto& route : routes) {
+    futures.emplace_back(nlSock->deleteRoute(route));
+  }
+  NetlinkProtocolSocket::collectReturnStatus(std::move(futures)).get();
+  EXPECT_EQ(0, nlSock->getIPv6Routes(kRouteProtoId).get().value().size());
+}
+
+/*
+ * Routes added in bulk are acked by kernel only on error. Verify error of a
+ * route in the middle is reported at its index and others succeed on ack of
+ * the barrier
+ */
+TEST_F(NlMessageFixture, BulkRouteAddAckOnError) {
+  const uint32_t count{100};
+  const uint32_t invalidIfindex{1000};
+  std::vector<Route> routes;
+  for (uint32_t i = 0; i < count; i++) {
+    std::vector<NextHop> paths;
+    paths.emplace_back(buildNextHop(
+        std::nullopt,
+        std::nullopt,
+        std::nullopt,
+        ipAddrY1V6, /* NH address */
+        i == count / 2 ? invalidIfindex : ifIndexX /* interface index */));
+    const auto prefix =
+        folly::IPAddress::createNetwork(fmt::format("fd00:{:x}::/64", i + 1));
+    routes.emplace_back(buildRoute(kRouteProtoId, prefix, std::nullopt, paths));
+  }
+
+  auto statuses = nlSock->addRoutes(routes).get();
+  ASSERT_EQ(count, statuses.size());
+  EXPECT_EQ(-ENODEV, statuses.at(count / 2));
+  statuses.erase(statuses.begin() + count / 2);
+  EXPECT_EQ(std::vector<int>(count - 1, 0), statuses);
+  EXPECT_LT(
+      0,
+      facebook::fb303::fbData->getCounters()["netlink.requests.barriers.sum"]);
+
+  auto kernelRoutes = nlSock->getIPv6Routes(kRouteProtoId).get().value();
+  EXPECT_EQ(count - 1, kernelRoutes.size());
+
+  routes.erase(routes.begin() + count / 2);
+  std::vector<folly::SemiFuture<int>> futures;
+  for (auto& route : routes) {
+    futures.emplace_back(nlSock->deleteRoute(route));
+  }
+  NetlinkProtocolSocket::collectReturnStatus(std::move(futures)).get();
+  EXPECT_EQ(0, nlSock->getIPv6Routes(kRouteProtoId).get().value().size());
+}
+
 /*
  * Flap multiple links up and down and stress test link events
  */
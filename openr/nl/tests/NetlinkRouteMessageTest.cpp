@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <openr/nl/NetlinkRouteMessage.h>
+
+#include <fb303/ServiceData.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+using namespace openr;
+using namespace openr::fbnl;
+
+namespace {
+const uint8_t kProtocolId = 99;
+const uint32_t kRouteTable = 1000;
+} // namespace
+
+TEST(RouteMessageView, DecodeOnRead) {
+  const folly::CIDRNetwork dst{folly::IPAddress("fc00:cafe:3::3"), 128};
+  auto nh = NextHopBuilder()
+                .setGateway(folly::IPAddress("fe80::1"))
+                .setIfIndex(1)
+                .build();
+  auto route = RouteBuilder()
+                   .setDestination(dst)
+                   .setProtocolId(kProtocolId)
+                   .setRouteTable(kRouteTable)
+                   .addNextHop(nh)
+                   .build();
+
+  NetlinkRouteMessage msg;
+  ASSERT_EQ(0, msg.addRoute(route));
+
+  // Table beyond 8 bits is carried by RTA_TABLE attribute
+  const RouteMessageView view(msg.getMessagePtr());
+  EXPECT_EQ(AF_INET6, view.getFamily());
+  EXPECT_EQ(kProtocolId, view.getProtocolId());
+  EXPECT_EQ(RTN_UNICAST, view.getType());
+  EXPECT_EQ(kRouteTable, view.getRouteTable());
+  EXPECT_EQ(dst, view.getDestination());
+  EXPECT_NE(nullptr, view.getAttribute(RTA_MULTIPATH));
+
+  // Fully decoded route matches the encoded one
+  auto decodedRoute = view.toRoute();
+  EXPECT_EQ(dst, decodedRoute.getDestination());
+  EXPECT_EQ(kProtocolId, decodedRoute.getProtocolId());
+  EXPECT_EQ(kRouteTable, decodedRoute.getRouteTable());
+  ASSERT_EQ(1, decodedRoute.getNextHops().size());
+  EXPECT_EQ(nh.getGateway(), decodedRoute.getNextHops().begin()->getGateway());
+
+  msg.setReturnStatus(0);
+}
+
+TEST(NetlinkRouteMessage, StrictDumpRequest) {
+  // IPv6 dump is filtered by kernel on table, protocol and type
+  {
+    auto filter = RouteBuilder()
+                      .setDestination({folly::IPAddressV6("::"), 0})
+                      .setProtocolId(kProtocolId)
+                      .setRouteTable(kRouteTable)
+                      .build();
+    NetlinkRouteMessage msg;
+    msg.initGet(0, filter, true /* strictFilter */);
+
+    const RouteMessageView view(msg.getMessagePtr());
+    EXPECT_EQ(AF_INET6, view.getFamily());
+    EXPECT_EQ(kProtocolId, view.getProtocolId());
+    EXPECT_EQ(RTN_UNICAST, view.getType());
+    EXPECT_EQ(0, view.getScope());
+    EXPECT_EQ(kRouteTable, view.getRouteTable());
+
+    // Missing table is reported as no routes
+    auto future = msg.getRoutesSemiFuture();
+    msg.setReturnStatus(-ENOENT);
+    auto routes = std::move(future).get();
+    ASSERT_TRUE(routes.hasValue());
+    EXPECT_TRUE(routes->empty());
+  }
+
+  // MPLS dump is filtered by kernel on protocol only
+  {
+    auto filter = RouteBuilder()
+                      .setMplsLabel(0)
+                      .setProtocolId(kProtocolId)
+                      .setRouteTable(kRouteTable)
+                      .build();
+    NetlinkRouteMessage msg;
+    msg.initGet(0, filter, true /* strictFilter */);
+
+    const RouteMessageView view(msg.getMessagePtr());
+    EXPECT_EQ(AF_MPLS, view.getFamily());
+    EXPECT_EQ(kProtocolId, view.getProtocolId());
+    EXPECT_EQ(0, view.getType());
+    EXPECT_EQ(0, view.getRouteTable());
+    EXPECT_EQ(nullptr, view.getAttribute(RTA_TABLE));
+
+    auto future = msg.getRoutesSemiFuture();
+    msg.setReturnStatus(-ENOENT);
+    EXPECT_TRUE(std::move(future).get().hasError());
+  }
+}
+
+TEST(NetlinkRouteMessage, MultipathCache) {
+  auto createRoute = [](const std::string& dst, uint8_t weight) {
+    return RouteBuilder()
+        .setDestination({folly::IPAddress(dst), 128})
+        .setProtocolId(kProtocolId)
+        .addNextHop(NextHopBuilder()
+                        .setGateway(folly::IPAddress("fe80::1"))
+                        .setIfIndex(1)
+                        .setWeight(weight)
+                        .build())
+        .addNextHop(NextHopBuilder()
+                        .setGateway(folly::IPAddress("fe80::2"))
+                        .setIfIndex(2)
+                        .build())
+        .build();
+  };
+  auto getMultipath = [](NetlinkRouteMessage& msg) {
+    const auto* rta =
+        RouteMessageView(msg.getMessagePtr()).getAttribute(RTA_MULTIPATH);
+    CHECK(rta);
+    return std::string(
+        reinterpret_cast<const char*>(RTA_DATA(rta)), RTA_PAYLOAD(rta));
+  };
+  auto getCounter = [](const std::string& name) {
+    return facebook::fb303::fbData->getCounters()[name];
+  };
+
+  // Encoding of next-hops is reused by routes sharing them
+  NetlinkRouteMessage msg1, msg2, msg3;
+  const auto hits = getCounter("netlink.route.multipath_cache.hit.sum");
+  const auto misses = getCounter("netlink.route.multipath_cache.miss.sum");
+  ASSERT_EQ(0, msg1.addRoute(createRoute("fc00::1", 2)));
+  ASSERT_EQ(0, msg2.addRoute(createRoute("fc00::2", 2)));
+  ASSERT_EQ(0, msg3.addRoute(createRoute("fc00::3", 3)));
+  EXPECT_EQ(hits + 1, getCounter("netlink.route.multipath_cache.hit.sum"));
+  EXPECT_EQ(misses + 2, getCounter("netlink.route.multipath_cache.miss.sum"));
+  EXPECT_EQ(getMultipath(msg1), getMultipath(msg2));
+  EXPECT_NE(getMultipath(msg1), getMultipath(msg3));
+
+  // Decoded next-hops match encoded ones
+  const auto route = RouteMessageView(msg2.getMessagePtr()).toRoute();
+  EXPECT_EQ(createRoute("fc00::2", 2).getNextHops(), route.getNextHops());
+
+  msg1.setReturnStatus(0);
+  msg2.setReturnStatus(0);
+  msg3.setReturnStatus(0);
+}
+
+int
+main(int argc, char* argv[]) {
+  // Parse command line flags
+  testing::InitGoogleTest(&argc, argv);
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  google::InstallFailureSignalHandler();
+  FLAGS_logtostderr = true;
+
+  // Run the tests
+  return RUN_ALL_TESTS();
+}
@@ -19,6 +19,10 @@
 
 DEFINE_int32(
     fib_thrift_port, 60100, "Thrift server port for the NetlinkFibHandler");
+DEFINE_bool(
+    enable_nexthop_objects,
+    false,
+    "Program unicast routes with kernel nexthop objects (Linux 5.3+)");
 
 using openr::NetlinkFibHandler;
 
@@ -49,7 +53,8 @@ main(int argc, char** argv) {
   nlEvb->waitUntilRunning();
 
   apache::thrift::ThriftServer linuxFibAgentServer;
-  auto fibHandler = std::make_shared<NetlinkFibHandler>(nlSock.get());
+  auto fibHandler = std::make_shared<NetlinkFibHandler>(
+      nlSock.get(), FLAGS_enable_nexthop_objects);
 
   // start FibService thread
   auto fibThriftThread = std::thread([fibHandler, &linuxFibAgentServer]() {
@@ -5,6 +5,7 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <folly/String.h>
 #include <folly/gen/Base.h>
 #include <folly/logging/xlog.h>
 
@@ -24,6 +25,30 @@ namespace {
 const uint8_t kMinRouteProtocolId = 17;
 const uint8_t kMaxRouteProtocolId = 253;
 
+// Nexthop objects are family specific. Interface only nexthops take the
+// family of the route.
+uint8_t
+getNexthopFamily(uint8_t routeFamily, const fbnl::NextHop& nh) {
+  const auto& gateway = nh.getGateway();
+  if (not gateway.has_value()) {
+    return routeFamily;
+  }
+  return gateway->isV4() ? AF_INET : AF_INET6;
+}
+
+// Key of the kernel nexthop object. Weight is a property of group membership
+// and not of the nexthop object.
+std::string
+getNexthopKey(uint8_t protocol, uint8_t routeFamily, const fbnl::NextHop& nh) {
+  const auto& gateway = nh.getGateway();
+  return fmt::format(
+      "{}|{}|{}|{}",
+      protocol,
+      getNexthopFamily(routeFamily, nh),
+      gateway.has_value() ? gateway->str() : "",
+      nh.getIfIndex().value_or(0));
+}
+
 template <typename T>
 folly::SemiFuture<T>
 createSemiFutureWithClientIdError() {
@@ -34,9 +59,11 @@ createSemiFutureWithClientIdError() {
 
 } // namespace
 
-NetlinkFibHandler::NetlinkFibHandler(fbnl::NetlinkProtocolSocket* nlSock)
+NetlinkFibHandler::NetlinkFibHandler(
+    fbnl::NetlinkProtocolSocket* nlSock, bool enableNexthopObjects)
     : facebook::fb303::BaseService("openr"),
       nlSock_(nlSock),
+      enableNexthopObjects_(enableNexthopObjects),
       startTime_(std::chrono::duration_cast<std::chrono::seconds>(
                      std::chrono::system_clock::now().time_since_epoch())
                      .count()) {
@@ -105,13 +132,38 @@ NetlinkFibHandler::semifuture_addUnicastRoutes(
   XLOG(INFO) << "Adding/Updating unicast routes of client "
              << getClientName(clientId) << ", numRoutes=" << routes->size();
 
+  // Digests of routes, if tracked for differential sync
+  std::unordered_map<folly::CIDRNetwork, uint64_t> digests;
+  if (routeDigests_.rlock()->count(protocol.value())) {
+    for (auto const& route : *routes) {
+      digests.emplace(
+          toIPNetwork(*route.dest_ref()), getUnicastRouteDigest(route));
+    }
+  }
+
   // Add routes and return a collected semifuture
   std::vector<folly::SemiFuture<int>> result;
-  for (auto& route : *routes) {
-    result.emplace_back(nlSock_->addRoute(buildRoute(route, protocol.value())));
+  if (enableNexthopObjects_) {
+    std::vector<fbnl::Route> nlRoutes;
+    nlRoutes.reserve(routes->size());
+    for (auto& route : *routes) {
+      nlRoutes.emplace_back(buildRoute(route, protocol.value()));
+    }
+    addNexthopObjectRoutes(std::move(nlRoutes), protocol.value(), result);
+  } else {
+    std::vector<fbnl::Route> nlRoutes;
+    nlRoutes.reserve(routes->size());
+    for (auto& route : *routes) {
+      nlRoutes.emplace_back(buildRoute(route, protocol.value()));
+    }
+    addRoutesBatch(std::move(nlRoutes), result);
   }
-  return fbnl::NetlinkProtocolSocket::collectReturnStatus(
-      std::move(result), {EEXIST});
+  return trackRouteDigests(
+      protocol.value(),
+      std::move(digests),
+      {},
+      fbnl::NetlinkProtocolSocket::collectReturnStatus(
+          std::move(result), {EEXIST}));
 }
 
 folly::SemiFuture<folly::Unit>
@@ -127,14 +179,25 @@ NetlinkFibHandler::semifuture_deleteUnicastRoutes(
 
   // Delete routes and return a collected semifuture
   std::vector<folly::SemiFuture<int>> result;
+  std::vector<folly::CIDRNetwork> deletedPrefixes;
+  deletedPrefixes.reserve(prefixes->size());
   for (auto& prefix : *prefixes) {
     fbnl::RouteBuilder rtBuilder;
     rtBuilder.setDestination(toIPNetwork(prefix));
     rtBuilder.setProtocolId(protocol.value());
     result.emplace_back(nlSock_->deleteRoute(rtBuilder.build()));
+    if (enableNexthopObjects_) {
+      deleteNexthopObjectRoute(
+          rtBuilder.getDestination(), protocol.value(), result);
+    }
+    deletedPrefixes.emplace_back(rtBuilder.getDestination());
   }
-  return fbnl::NetlinkProtocolSocket::collectReturnStatus(
-      std::move(result), {ESRCH});
+  return trackRouteDigests(
+      protocol.value(),
+      {},
+      deletedPrefixes,
+      fbnl::NetlinkProtocolSocket::collectReturnStatus(
+          std::move(result), {ESRCH}));
 }
 
 folly::SemiFuture<folly::Unit>
@@ -150,10 +213,12 @@ NetlinkFibHandler::semifuture_addMplsRoutes(
 
   // Add routes and return a collected semifuture
   std::vector<folly::SemiFuture<int>> result;
+  std::vector<fbnl::Route> nlRoutes;
+  nlRoutes.reserve(routes->size());
   for (auto& route : *routes) {
-    result.emplace_back(
-        nlSock_->addRoute(buildMplsRoute(route, protocol.value())));
+    nlRoutes.emplace_back(buildMplsRoute(route, protocol.value()));
   }
+  addRoutesBatch(std::move(nlRoutes), result);
   return fbnl::NetlinkProtocolSocket::collectReturnStatus(
       std::move(result), {EEXIST});
 }
@@ -224,11 +289,21 @@ NetlinkFibHandler::semifuture_syncFib(
   }
 
   // Go over the new routes. Add or update
-  std::unordered_set<folly::CIDRNetwork> newPrefixes;
+  const bool trackDigests = routeDigests_.rlock()->count(protocol.value());
+  std::unordered_map<folly::CIDRNetwork, uint64_t> digests;
+  std::unordered_set<PackedPrefix> newPrefixes;
+  std::vector<fbnl::Route> routesToAdd;
   for (auto& route : *unicastRoutes) {
-    const auto network = toIPNetwork(*route.dest_ref());
-    newPrefixes.insert(network);
+    const auto packed = PackedPrefix::fromIpPrefix(*route.dest_ref());
+    const auto network = packed.toNetwork();
+    newPrefixes.insert(packed);
+    if (trackDigests) {
+      digests.emplace(network, getUnicastRouteDigest(route));
+    }
     auto nlRoute = buildRoute(route, protocol.value());
+    if (enableNexthopObjects_) {
+      nlRoute.setNexthopId(getNexthopGroupId(nlRoute, protocol.value()));
+    }
     auto it = existingRoutes.find(network);
     if (it != existingRoutes.end() and it->second == nlRoute) {
       // Existing route is same as the one we're trying to add. SKIP
@@ -242,12 +317,17 @@ NetlinkFibHandler::semifuture_syncFib(
       XLOG(INFO) << "Adding unicast-route \n[NEW]" << nlRoute.str();
     }
     // Add new route or replace existing one
-    result.emplace_back(nlSock_->addRoute(nlRoute));
+    routesToAdd.emplace_back(std::move(nlRoute));
+  }
+  if (enableNexthopObjects_) {
+    addNexthopObjectRoutes(std::move(routesToAdd), protocol.value(), result);
+  } else {
+    addRoutesBatch(std::move(routesToAdd), result);
   }
 
   // Go over the old routes to remove stale ones
   for (auto& [prefix, nlRoute] : existingRoutes) {
-    if (newPrefixes.count(prefix)) {
+    if (newPrefixes.count(PackedPrefix::fromNetwork(prefix))) {
       // not a stale route
       continue;
     }
@@ -257,11 +337,145 @@ NetlinkFibHandler::semifuture_syncFib(
     result.emplace_back(nlSock_->deleteRoute(nlRoute));
   }
 
+  // Release groups of stale routes including the ones removed from kernel
+  // by other means
+  if (enableNexthopObjects_) {
+    std::vector<folly::CIDRNetwork> stalePrefixes;
+    {
+      auto registry = nexthopRegistry_.rlock();
+      auto it = registry->routeGroups.find(protocol.value());
+      if (it != registry->routeGroups.end()) {
+        for (auto const& [prefix, _] : it->second) {
+          if (not newPrefixes.count(PackedPrefix::fromNetwork(prefix))) {
+            stalePrefixes.emplace_back(prefix);
+          }
+        }
+      }
+    }
+    for (auto const& prefix : stalePrefixes) {
+      deleteNexthopObjectRoute(prefix, protocol.value(), result);
+    }
+    // Every route of the protocol is replaced or deleted by now
+    flushKernelNexthops(protocol.value(), result);
+  }
+
+  // Full sync replaces digests of all routes
+  if (trackDigests) {
+    routeDigests_.wlock()->insert_or_assign(
+        protocol.value(), std::unordered_map<folly::CIDRNetwork, uint64_t>());
+  }
+
   // Return collected result
   // NOTE: We're ignoring EEXIST error code. ESRCH error code must not be
   // raised because we're deleting route that already exist
-  return fbnl::NetlinkProtocolSocket::collectReturnStatus(
-      std::move(result), {EEXIST});
+  return trackRouteDigests(
+      protocol.value(),
+      std::move(digests),
+      {},
+      fbnl::NetlinkProtocolSocket::collectReturnStatus(
+          std::move(result), {EEXIST}));
+}
+
+folly::SemiFuture<std::unique_ptr<std::map<int32_t, int64_t>>>
+NetlinkFibHandler::semifuture_getUnicastRouteDigests(
+    int16_t clientId, int32_t numRanges) {
+  const auto protocol = getProtocol(clientId);
+  if (not protocol.has_value() or numRanges <= 0) {
+    return createSemiFutureWithClientIdError<
+        std::unique_ptr<std::map<int32_t, int64_t>>>();
+  }
+  XLOG(INFO) << "Get unicast route digests of client "
+             << getClientName(clientId) << ", numRanges=" << numRanges;
+
+  seedRouteDigests(protocol.value());
+  auto routeDigests = routeDigests_.rlock();
+  return folly::makeSemiFuture(std::make_unique<std::map<int32_t, int64_t>>(
+      getUnicastRouteRangeDigests(
+          routeDigests->at(protocol.value()), numRanges)));
+}
+
+folly::SemiFuture<folly::Unit>
+NetlinkFibHandler::semifuture_syncFibRanges(
+    int16_t clientId,
+    int32_t numRanges,
+    std::unique_ptr<std::vector<int32_t>> ranges,
+    std::unique_ptr<std::vector<thrift::UnicastRoute>> unicastRoutes) {
+  const auto protocol = getProtocol(clientId);
+  if (not protocol.has_value() or numRanges <= 0) {
+    return createSemiFutureWithClientIdError<folly::Unit>();
+  }
+  XLOG(INFO) << "Syncing unicast FIB ranges for client "
+             << getClientName(clientId) << ", numRanges=" << ranges->size()
+             << ", numRoutes=" << unicastRoutes->size();
+
+  // Programmed routes are known from their digests. Unlike full sync, this
+  // doesn't dump routes from kernel.
+  seedRouteDigests(protocol.value());
+  const std::unordered_set<int32_t> rangesToSync(
+      ranges->begin(), ranges->end());
+  std::unordered_map<folly::CIDRNetwork, uint64_t> digests;
+  std::vector<const thrift::UnicastRoute*> routesToAdd;
+  std::vector<folly::CIDRNetwork> stalePrefixes;
+  {
+    auto routeDigests = routeDigests_.rlock();
+    auto const& programmedDigests = routeDigests->at(protocol.value());
+    for (auto const& route : *unicastRoutes) {
+      const auto network = toIPNetwork(*route.dest_ref());
+      const auto digest = getUnicastRouteDigest(route);
+      digests.emplace(network, digest);
+      auto it = programmedDigests.find(network);
+      if (it != programmedDigests.end() and it->second == digest) {
+        // Route is already programmed. SKIP
+        continue;
+      }
+      routesToAdd.emplace_back(&route);
+    }
+    for (auto const& [prefix, _] : programmedDigests) {
+      if (rangesToSync.count(getPrefixRange(prefix, numRanges)) and
+          not digests.count(prefix)) {
+        stalePrefixes.emplace_back(prefix);
+      }
+    }
+  }
+
+  // Add or update routes
+  std::vector<folly::SemiFuture<int>> result;
+  std::vector<fbnl::Route> nlRoutes;
+  std::unordered_map<folly::CIDRNetwork, uint64_t> updatedDigests;
+  for (auto const* route : routesToAdd) {
+    auto nlRoute = buildRoute(*route, protocol.value());
+    XLOG(INFO) << "Adding/Updating unicast-route \n[NEW]" << nlRoute.str();
+    updatedDigests.emplace(
+        nlRoute.getDestination(), digests.at(nlRoute.getDestination()));
+    nlRoutes.emplace_back(std::move(nlRoute));
+  }
+  if (enableNexthopObjects_) {
+    addNexthopObjectRoutes(std::move(nlRoutes), protocol.value(), result);
+  } else {
+    addRoutesBatch(std::move(nlRoutes), result);
+  }
+
+  // Delete stale routes within synced ranges
+  for (auto const& prefix : stalePrefixes) {
+    XLOG(INFO) << "Deleting unicast-route "
+               << folly::IPAddress::networkToString(prefix);
+    fbnl::RouteBuilder rtBuilder;
+    rtBuilder.setDestination(prefix);
+    rtBuilder.setProtocolId(protocol.value());
+    result.emplace_back(nlSock_->deleteRoute(rtBuilder.build()));
+    if (enableNexthopObjects_) {
+      deleteNexthopObjectRoute(prefix, protocol.value(), result);
+    }
+  }
+
+  // NOTE: Stale route may have been removed by other means, hence we ignore
+  // ESRCH along with EEXIST
+  return trackRouteDigests(
+      protocol.value(),
+      std::move(updatedDigests),
+      stalePrefixes,
+      fbnl::NetlinkProtocolSocket::collectReturnStatus(
+          std::move(result), {EEXIST, ESRCH}));
 }
 
 folly::SemiFuture<folly::Unit>
@@ -293,6 +507,7 @@ NetlinkFibHandler::semifuture_syncMplsFib(
 
   // Go over the new routes. Add or update
   std::unordered_set<uint32_t> newLabels;
+  std::vector<fbnl::Route> routesToAdd;
   for (auto& route : *mplsRoutes) {
     const auto label = *route.topLabel_ref();
     newLabels.insert(label);
@@ -310,8 +525,9 @@ NetlinkFibHandler::semifuture_syncMplsFib(
       XLOG(INFO) << "Adding mpls-route \n[NEW]" << nlRoute.str();
     }
     // Add new route or replace existing one
-    result.emplace_back(nlSock_->addRoute(nlRoute));
+    routesToAdd.emplace_back(std::move(nlRoute));
   }
+  addRoutesBatch(std::move(routesToAdd), result);
 
   // Go over the old routes to remove stale ones
   for (auto& [topLabel, nlRoute] : existingRoutes) {
@@ -546,8 +762,436 @@ NetlinkFibHandler::buildMplsRoute(
   return rtBuilder.setValid(true).build();
 }
 
+std::optional<std::string>
+NetlinkFibHandler::getNexthopGroupKey(const fbnl::Route& route) const {
+  const auto family = route.getFamily();
+  if (not enableNexthopObjects_ or route.getType() != RTN_UNICAST or
+      route.getNextHops().empty() or
+      (family != AF_INET and family != AF_INET6)) {
+    return std::nullopt;
+  }
+
+  // Kernel doesn't support MPLS encap in nexthop objects and rejects groups
+  // mixing IPv4 and IPv6 nexthops. Such routes are programmed inline.
+  std::vector<std::string> memberKeys;
+  std::optional<uint8_t> groupFamily;
+  for (auto const& nh : route.getNextHops()) {
+    if (nh.getLabelAction().has_value() or not nh.getIfIndex().has_value()) {
+      return std::nullopt;
+    }
+    const uint8_t nhFamily = getNexthopFamily(family, nh);
+    if (groupFamily.has_value() and groupFamily.value() != nhFamily) {
+      return std::nullopt;
+    }
+    groupFamily = nhFamily;
+    memberKeys.emplace_back(fmt::format(
+        "{}*{}",
+        getNexthopKey(route.getProtocolId(), family, nh),
+        nh.getWeight()));
+  }
+  std::sort(memberKeys.begin(), memberKeys.end());
+  return folly::join(",", memberKeys);
+}
+
+std::pair<fbnl::NexthopGroupMembers, std::vector<std::string>>
+NetlinkFibHandler::acquireNexthops(
+    NexthopRegistry& registry,
+    const fbnl::Route& route,
+    std::vector<folly::SemiFuture<int>>& result) {
+  const auto family = route.getFamily();
+  const auto protocol = route.getProtocolId();
+  fbnl::NexthopGroupMembers members;
+  std::vector<std::string> memberKeys;
+  for (auto const& nh : route.getNextHops()) {
+    auto key = getNexthopKey(protocol, family, nh);
+    auto& entry = registry.nexthops[key];
+    if (entry.refCount++ == 0) {
+      entry.id = registry.nextNexthopId++;
+      result.emplace_back(nlSock_->addNexthop(entry.id, nh, family, protocol));
+    }
+    members.emplace_back(entry.id, nh.getWeight());
+    memberKeys.emplace_back(std::move(key));
+  }
+  return {std::move(members), std::move(memberKeys)};
+}
+
+void
+NetlinkFibHandler::releaseNexthops(
+    NexthopRegistry& registry,
+    const std::vector<std::string>& memberKeys,
+    std::vector<folly::SemiFuture<int>>& result) {
+  for (auto const& key : memberKeys) {
+    auto it = registry.nexthops.find(key);
+    CHECK(it != registry.nexthops.end());
+    if (--it->second.refCount == 0) {
+      result.emplace_back(nlSock_->deleteNexthop(it->second.id));
+      registry.nexthops.erase(it);
+    }
+  }
+}
+
+uint32_t
+NetlinkFibHandler::acquireNexthopGroup(
+    NexthopRegistry& registry,
+    const std::string& key,
+    const fbnl::Route& route,
+    std::vector<folly::SemiFuture<int>>& result) {
+  auto it = registry.groupIds.find(key);
+  if (it != registry.groupIds.end()) {
+    ++registry.groups.at(it->second).refCount;
+    return it->second;
+  }
+
+  // Program member nexthops followed by the group referencing them
+  auto [members, memberKeys] = acquireNexthops(registry, route, result);
+  const auto groupId = registry.nextGroupId++;
+  result.emplace_back(
+      nlSock_->addNexthopGroup(groupId, members, route.getProtocolId()));
+  registry.groupIds.emplace(key, groupId);
+  registry.groups.emplace(
+      groupId,
+      NexthopGroupEntry{key, std::move(members), std::move(memberKeys), 1});
+  return groupId;
+}
+
+void
+NetlinkFibHandler::releaseNexthopGroup(
+    NexthopRegistry& registry,
+    uint32_t groupId,
+    std::vector<folly::SemiFuture<int>>& result) {
+  auto it = registry.groups.find(groupId);
+  CHECK(it != registry.groups.end());
+  if (--it->second.refCount) {
+    return;
+  }
+
+  // NOTE: Requests are sent in order, hence group is deleted only after the
+  // last route referencing it is replaced or removed
+  result.emplace_back(nlSock_->deleteNexthop(groupId));
+  releaseNexthops(registry, it->second.memberKeys, result);
+  registry.groupIds.erase(it->second.key);
+  registry.groups.erase(it);
+}
+
+std::optional<uint32_t>
+NetlinkFibHandler::getNexthopGroupId(
+    const fbnl::Route& route, uint8_t protocol) {
+  const auto key = getNexthopGroupKey(route);
+  if (not key.has_value()) {
+    return std::nullopt;
+  }
+
+  auto registry = nexthopRegistry_.rlock();
+  auto protoIt = registry->routeGroups.find(protocol);
+  if (protoIt == registry->routeGroups.end()) {
+    return std::nullopt;
+  }
+  auto it = protoIt->second.find(route.getDestination());
+  if (it == protoIt->second.end() or
+      registry->groups.at(it->second).key != key.value()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+void
+NetlinkFibHandler::addRoutesBatch(
+    std::vector<fbnl::Route>&& routes,
+    std::vector<folly::SemiFuture<int>>& result) {
+  if (routes.empty()) {
+    return;
+  }
+  auto future = nlSock_->addRoutes(routes);
+  result.emplace_back(std::move(future).deferValue(
+      [routes = std::move(routes)](std::vector<int>&& statuses) {
+        for (size_t i = 0; i < statuses.size(); ++i) {
+          const auto status = std::abs(statuses.at(i));
+          if (status != 0 and status != EEXIST) {
+            XLOG(ERR) << "Failed programming route " << routes.at(i).str()
+                      << ". Error: " << folly::errnoStr(status);
+          }
+        }
+        return fbnl::NetlinkProtocolSocket::getFirstError(statuses, {EEXIST});
+      }));
+}
+
+void
+NetlinkFibHandler::addNexthopObjectRoutes(
+    std::vector<fbnl::Route>&& routes,
+    uint8_t protocol,
+    std::vector<folly::SemiFuture<int>>& result) {
+  loadKernelNexthops(protocol);
+  auto registry = nexthopRegistry_.wlock();
+  auto& routeGroups = registry->routeGroups[protocol];
+
+  // Find groups whose every route moves to the same new nexthop set. Such
+  // groups are rewritten in place with one RTM_NEWNEXTHOP instead of
+  // replacing each of the routes.
+  struct GroupMove {
+    const fbnl::Route* route{nullptr};
+    std::string key;
+    size_t numRoutes{0};
+    bool isUniform{true};
+  };
+  std::unordered_map<uint32_t, GroupMove> moves;
+  std::vector<std::optional<std::string>> keys;
+  std::vector<std::optional<uint32_t>> oldGroupIds;
+  std::unordered_set<folly::CIDRNetwork> prefixes;
+  for (auto const& route : routes) {
+    keys.emplace_back(getNexthopGroupKey(route));
+    oldGroupIds.emplace_back(std::nullopt);
+    const bool isDuplicate = not prefixes.insert(route.getDestination()).second;
+    auto it = routeGroups.find(route.getDestination());
+    if (it == routeGroups.end()) {
+      continue;
+    }
+    oldGroupIds.back() = it->second;
+    auto& move = moves[it->second];
+    auto const& key = keys.back();
+    if (isDuplicate or not key.has_value() or
+        (move.route and move.key != key.value())) {
+      move.isUniform = false;
+    } else if (not move.route) {
+      move.route = &route;
+      move.key = key.value();
+    }
+    ++move.numRoutes;
+  }
+
+  std::unordered_set<uint32_t> rewrittenGroups;
+  for (auto& [groupId, move] : moves) {
+    auto& group = registry->groups.at(groupId);
+    if (not move.isUniform or move.numRoutes != group.refCount or
+        move.key == group.key or registry->groupIds.count(move.key)) {
+      continue;
+    }
+
+    // Acquire new members before releasing old ones to retain common nexthops
+    auto [members, memberKeys] =
+        acquireNexthops(*registry, *move.route, result);
+    result.emplace_back(nlSock_->addNexthopGroup(groupId, members, protocol));
+    releaseNexthops(*registry, group.memberKeys, result);
+    registry->groupIds.erase(group.key);
+    registry->groupIds.emplace(move.key, groupId);
+    group.key = move.key;
+    group.members = std::move(members);
+    group.memberKeys = std::move(memberKeys);
+    rewrittenGroups.insert(groupId);
+  }
+
+  for (size_t i = 0; i < routes.size(); ++i) {
+    auto& route = routes.at(i);
+    auto const& oldGroupId = oldGroupIds.at(i);
+    if (oldGroupId.has_value() and rewrittenGroups.count(oldGroupId.value())) {
+      // Route already references the rewritten group
+      continue;
+    }
+
+    // Take reference on new group before releasing the old one
+    std::optional<uint32_t> prevGroupId;
+    auto it = routeGroups.find(route.getDestination());
+    if (it != routeGroups.end()) {
+      prevGroupId = it->second;
+      routeGroups.erase(it);
+    }
+    route.setNexthopId(std::nullopt);
+    if (keys.at(i).has_value()) {
+      const auto groupId =
+          acquireNexthopGroup(*registry, keys.at(i).value(), route, result);
+      route.setNexthopId(groupId);
+      routeGroups.emplace(route.getDestination(), groupId);
+    }
+    result.emplace_back(nlSock_->addRoute(route));
+    if (prevGroupId.has_value()) {
+      releaseNexthopGroup(*registry, prevGroupId.value(), result);
+    }
+  }
+
+  XLOG(DBG1) << "Nexthop objects: " << registry->nexthops.size()
+             << " nexthops, " << registry->groups.size() << " groups, "
+             << rewrittenGroups.size() << " groups rewritten in place";
+}
+
+void
+NetlinkFibHandler::deleteNexthopObjectRoute(
+    const folly::CIDRNetwork& prefix,
+    uint8_t protocol,
+    std::vector<folly::SemiFuture<int>>& result) {
+  auto registry = nexthopRegistry_.wlock();
+  auto& routeGroups = registry->routeGroups[protocol];
+  auto it = routeGroups.find(prefix);
+  if (it == routeGroups.end()) {
+    return;
+  }
+  const auto groupId = it->second;
+  routeGroups.erase(it);
+  releaseNexthopGroup(*registry, groupId, result);
+}
+
+void
+NetlinkFibHandler::loadKernelNexthops(uint8_t protocol) {
+  if (nexthopRegistry_.rlock()->loadedProtocols.count(protocol)) {
+    return;
+  }
+
+  // NOTE: Synchronous call to retrieve all nexthop objects
+  auto nexthops = nlSock_->getAllNexthops().get();
+  if (nexthops.hasError()) {
+    throw fbnl::NlException("Failed fetching nexthops", nexthops.error());
+  }
+
+  auto registry = nexthopRegistry_.wlock();
+  if (not registry->loadedProtocols.insert(protocol).second) {
+    return; // Loaded concurrently
+  }
+  std::vector<uint32_t> staleGroupIds;
+  std::vector<uint32_t> staleNexthopIds;
+  for (auto const& nexthop : nexthops.value()) {
+    // Ids are shared by all protocols
+    if (nexthop.id >= NexthopRegistry::kGroupIdBase) {
+      registry->nextGroupId = std::max(registry->nextGroupId, nexthop.id + 1);
+    } else {
+      registry->nextNexthopId =
+          std::max(registry->nextNexthopId, nexthop.id + 1);
+    }
+    if (nexthop.protocolId != protocol) {
+      continue;
+    }
+    // Groups are deleted before their members, as deleting the last member
+    // removes the group as well
+    if (nexthop.isGroup()) {
+      staleGroupIds.emplace_back(nexthop.id);
+    } else {
+      staleNexthopIds.emplace_back(nexthop.id);
+    }
+  }
+  XLOG(INFO) << "Loaded " << nexthops->size()
+             << " nexthop objects from kernel, " << staleGroupIds.size()
+             << " groups and " << staleNexthopIds.size()
+             << " nexthops of protocol " << static_cast<int>(protocol)
+             << " are stale";
+  if (staleGroupIds.empty() and staleNexthopIds.empty()) {
+    return;
+  }
+  staleGroupIds.insert(
+      staleGroupIds.end(), staleNexthopIds.begin(), staleNexthopIds.end());
+  registry->staleNexthopIds.emplace(protocol, std::move(staleGroupIds));
+}
+
+void
+NetlinkFibHandler::flushKernelNexthops(
+    uint8_t protocol, std::vector<folly::SemiFuture<int>>& result) {
+  std::vector<uint32_t> staleIds;
+  {
+    auto registry = nexthopRegistry_.wlock();
+    auto it = registry->staleNexthopIds.find(protocol);
+    if (it == registry->staleNexthopIds.end()) {
+      return;
+    }
+    staleIds = std::move(it->second);
+    registry->staleNexthopIds.erase(it);
+  }
+
+  XLOG(INFO) << "Deleting " << staleIds.size()
+             << " stale nexthop objects of protocol "
+             << static_cast<int>(protocol);
+  for (auto const id : staleIds) {
+    // Object may be gone already, e.g. removed along with its members
+    result.emplace_back(nlSock_->deleteNexthop(id).deferValue(
+        [](int status) { return std::abs(status) == ENOENT ? 0 : status; }));
+  }
+}
+
+void
+NetlinkFibHandler::seedRouteDigests(uint8_t protocol) {
+  if (routeDigests_.rlock()->count(protocol)) {
+    return;
+  }
+
+  // NOTE: Synchronous call to retrieve all routes, same as in syncFib
+  auto v4Routes = nlSock_->getIPv4Routes(protocol).get();
+  auto v6Routes = nlSock_->getIPv6Routes(protocol).get();
+  if (v4Routes.hasError()) {
+    throw fbnl::NlException("Failed fetching IPv4 routes", v4Routes.error());
+  }
+  if (v6Routes.hasError()) {
+    throw fbnl::NlException("Failed fetching IPv6 routes", v6Routes.error());
+  }
+
+  std::unordered_map<folly::CIDRNetwork, uint64_t> digests;
+  for (auto& routesPtr : {&v4Routes, &v6Routes}) {
+    for (auto& nlRoute : routesPtr->value()) {
+      thrift::UnicastRoute route;
+      route.dest_ref() = toIpPrefix(nlRoute.getDestination());
+      // Linux will report a null next-hop for RTN_BLACKHOLE type while
+      // RIB does not
+      if (nlRoute.getType() != RTN_BLACKHOLE) {
+        route.nextHops_ref() = toThriftNextHops(nlRoute.getNextHops());
+      }
+      digests.emplace(nlRoute.getDestination(), getUnicastRouteDigest(route));
+    }
+  }
+  XLOG(INFO) << "Loaded digests of " << digests.size()
+             << " unicast routes from kernel for protocol "
+             << static_cast<int>(protocol);
+
+  // Keep digests if seeded concurrently
+  routeDigests_.wlock()->emplace(protocol, std::move(digests));
+}
+
+folly::SemiFuture<folly::Unit>
+NetlinkFibHandler::trackRouteDigests(
+    uint8_t protocol,
+    std::unordered_map<folly::CIDRNetwork, uint64_t>&& updated,
+    const std::vector<folly::CIDRNetwork>& deleted,
+    folly::SemiFuture<folly::Unit>&& result) {
+  // prefixes whose programming state is unknown if `result` fails
+  std::vector<folly::CIDRNetwork> changedPrefixes;
+  {
+    auto routeDigests = routeDigests_.wlock();
+    auto it = routeDigests->find(protocol);
+    if (it == routeDigests->end()) {
+      return std::move(result); // Not tracked until seeded
+    }
+    changedPrefixes.reserve(updated.size() + deleted.size());
+    for (auto const& prefix : deleted) {
+      changedPrefixes.emplace_back(prefix);
+      it->second.erase(prefix);
+    }
+    for (auto& [prefix, digest] : updated) {
+      changedPrefixes.emplace_back(prefix);
+      it->second.insert_or_assign(prefix, digest);
+    }
+  }
+
+  if (changedPrefixes.empty()) {
+    return std::move(result);
+  }
+  return std::move(result).deferError(
+      [this, protocol, prefixes = std::move(changedPrefixes)](
+          folly::exception_wrapper&& ew) {
+        // Programming state of routes is unknown. Mark them to be synced.
+        {
+          auto routeDigests = routeDigests_.wlock();
+          auto it = routeDigests->find(protocol);
+          if (it != routeDigests->end()) {
+            for (auto const& prefix : prefixes) {
+              it->second.insert_or_assign(prefix, 0);
+            }
+          }
+        }
+        ew.throw_exception();
+      });
+}
+
 std::optional<int>
 NetlinkFibHandler::getIfIndex(const std::string& ifName) {
+  // Served by netlink cache without a dump once synced
+  const auto& nlCache = nlSock_->getCache();
+  if (nlCache.isSynced()) {
+    return nlCache.getIfIndex(ifName);
+  }
+
   // Lambda function to lookup ifName in cache
   auto getCachedIndex = [this, &ifName]() -> std::optional<int> {
     auto cache = ifNameToIndex_.rlock();
@@ -571,6 +1215,12 @@ NetlinkFibHandler::getIfIndex(const std::string& ifName) {
 
 std::optional<std::string>
 NetlinkFibHandler::getIfName(const int ifIndex) {
+  // Served by netlink cache without a dump once synced
+  const auto& nlCache = nlSock_->getCache();
+  if (nlCache.isSynced()) {
+    return nlCache.getIfName(ifIndex);
+  }
+
   // Lambda function to lookup ifIndex in cache
   auto getCachedName = [this, ifIndex]() -> std::optional<std::string> {
     auto cache = ifIndexToName_.rlock();
@@ -594,6 +1244,11 @@ NetlinkFibHandler::getIfName(const int ifIndex) {
 
 std::optional<int>
 NetlinkFibHandler::getLoopbackIfIndex() {
+  const auto& nlCache = nlSock_->getCache();
+  if (nlCache.isSynced()) {
+    return nlCache.getLoopbackIfIndex();
+  }
+
   auto index = loopbackIfIndex_.load();
   if (index < 0) {
     initializeInterfaceCache();
@@ -627,6 +1282,18 @@ NetlinkFibHandler::initializeInterfaceCache() noexcept {
   }
 }
 
+apache::thrift::ServerStream<thrift::RouteOperationAck>
+NetlinkFibHandler::subscribeRouteAcks(int16_t clientId) {
+  return routeStreamServer_.subscribeRouteAcks(clientId);
+}
+
+#if FOLLY_HAS_COROUTINES
+apache::thrift::SinkConsumer<thrift::RouteOperationBatch, int64_t>
+NetlinkFibHandler::programRoutes(int16_t clientId) {
+  return routeStreamServer_.programRoutes(clientId);
+}
+#endif
+
 void
 NetlinkFibHandler::sendNeighborDownInfo(
     std::unique_ptr<std::vector<std::string>> neighborIps) {
@@ -14,11 +14,12 @@
 
 #include <openr/common/MplsUtil.h>
 #include <openr/common/NetworkUtil.h>
-#include <openr/if/gen-cpp2/FibService.h>
+#include <openr/if/gen-cpp2/FibServiceCpp.h>
 #include <openr/if/gen-cpp2/NeighborListenerClientForFibagent.h>
 #include <openr/if/gen-cpp2/Types_types.h>
 #include <openr/nl/NetlinkProtocolSocket.h>
 #include <openr/nl/NetlinkTypes.h>
+#include <openr/platform/RouteStreamServer.h>
 
 namespace openr {
 /**
@@ -28,11 +29,24 @@ namespace openr {
  * - Translates netlink representation of routes to thrift for get* queries
  * - All APIs exposed are asynchronous. Sync API retries the existing routing
  *   state in synchronous way and program changes asynchrnously.
+ * - [Nexthop Objects] Optionally programs unicast routes against refcounted
+ *   kernel nexthop groups (RTM_NEWNEXTHOP) instead of inline RTA_MULTIPATH.
+ *   Routes sharing the same nexthop set share one group. When every route of
+ *   a group moves to the same new nexthop set, the group is rewritten in place
+ *   and none of the routes need to be replaced. Objects left in kernel by a
+ *   previous run are never reused: ids are allocated above all existing
+ *   objects, and the stale ones are flushed by the next full sync.
+ * - [Route Digests] Tracks digest of every unicast route it programs, for
+ *   differential sync. Digests are seeded from kernel on first use, so that
+ *   routes which survived a restart are not programmed again.
+ * - [Route Streaming] Serves streamed route programming of FibServiceCpp
+ *   with the asynchronous APIs above, see RouteStreamServer.
  */
-class NetlinkFibHandler : public virtual thrift::FibServiceSvIf,
+class NetlinkFibHandler : public virtual thrift::FibServiceCppSvIf,
                           public facebook::fb303::BaseService {
  public:
-  explicit NetlinkFibHandler(fbnl::NetlinkProtocolSocket* nlSock);
+  explicit NetlinkFibHandler(
+      fbnl::NetlinkProtocolSocket* nlSock, bool enableNexthopObjects = false);
   ~NetlinkFibHandler() override;
 
   void
@@ -66,10 +80,28 @@ class NetlinkFibHandler : public virtual thrift::FibServiceSvIf,
       int16_t clientId,
       std::unique_ptr<std::vector<thrift::UnicastRoute>> routes) override;
 
+  folly::SemiFuture<std::unique_ptr<std::map<int32_t, int64_t>>>
+  semifuture_getUnicastRouteDigests(
+      int16_t clientId, int32_t numRanges) override;
+
+  folly::SemiFuture<folly::Unit> semifuture_syncFibRanges(
+      int16_t clientId,
+      int32_t numRanges,
+      std::unique_ptr<std::vector<int32_t>> ranges,
+      std::unique_ptr<std::vector<thrift::UnicastRoute>> routes) override;
+
   folly::SemiFuture<folly::Unit> semifuture_syncMplsFib(
       int16_t clientId,
       std::unique_ptr<std::vector<thrift::MplsRoute>> routes) override;
 
+  apache::thrift::ServerStream<thrift::RouteOperationAck> subscribeRouteAcks(
+      int16_t clientId) override;
+
+#if FOLLY_HAS_COROUTINES
+  apache::thrift::SinkConsumer<thrift::RouteOperationBatch, int64_t>
+  programRoutes(int16_t clientId) override;
+#endif
+
   void sendNeighborDownInfo(
       std::unique_ptr<std::vector<std::string>> neighborIp) override;
 
@@ -146,13 +178,44 @@ class NetlinkFibHandler : public virtual thrift::FibServiceSvIf,
       fbnl::RouteBuilder& rtBuilder,
       const std::vector<thrift::NextHopThrift>& nhop);
 
+  /**
+   * Program routes with a single bulk netlink request. Aggregated status of
+   * the batch is appended to `result`, and failed routes are logged.
+   */
+  void addRoutesBatch(
+      std::vector<fbnl::Route>&& routes,
+      std::vector<folly::SemiFuture<int>>& result);
+
+  /**
+   * [Nexthop Objects] Program unicast routes against kernel nexthop groups.
+   * Resulting futures of all netlink requests are appended to `result`.
+   */
+  void addNexthopObjectRoutes(
+      std::vector<fbnl::Route>&& routes,
+      uint8_t protocol,
+      std::vector<folly::SemiFuture<int>>& result);
+  void deleteNexthopObjectRoute(
+      const folly::CIDRNetwork& prefix,
+      uint8_t protocol,
+      std::vector<folly::SemiFuture<int>>& result);
+
+  /**
+   * [Nexthop Objects] Return the group currently referenced by the route if
+   * it still matches the nexthops of `route`. Used by sync to compare against
+   * routes read from kernel.
+   */
+  std::optional<uint32_t> getNexthopGroupId(
+      const fbnl::Route& route, uint8_t protocol);
+
   /**
    * APIs to convert ifName <-> ifIndex for thrift <-> netlink route conversions
    * Returns `folly::none` if can't find the mapping.
    *
-   * Cache is used for optimized response to subsequent query for same interface
-   * name or index. Entries in cache are lazily initialized on first instance by
-   * querying `getAllLinks`.
+   * Mappings are served by the cache of netlink socket, kept up to date from
+   * link events, once it is synced. Until then a local cache is used for
+   * optimized response to subsequent query for same interface name or index.
+   * Entries in it are lazily initialized on first instance by querying
+   * `getAllLinks`.
    *
    * Returns `std::nullopt` if mapping is not found
    */
@@ -181,6 +244,104 @@ class NetlinkFibHandler : public virtual thrift::FibServiceSvIf,
    */
   void initializeInterfaceCache() noexcept;
 
+  // [Nexthop Objects] Kernel nexthop object or group
+  struct NexthopEntry {
+    uint32_t id{0};
+    size_t refCount{0};
+  };
+  struct NexthopGroupEntry {
+    std::string key;
+    fbnl::NexthopGroupMembers members;
+    std::vector<std::string> memberKeys;
+    size_t refCount{0};
+  };
+  struct NexthopRegistry {
+    // Nexthops and groups use disjoint id ranges as kernel doesn't allow
+    // replacing one with the other
+    static constexpr uint32_t kGroupIdBase{1u << 28};
+    uint32_t nextNexthopId{1};
+    uint32_t nextGroupId{kGroupIdBase};
+    // Protocols whose objects in kernel are loaded, see loadKernelNexthops()
+    std::unordered_set<uint8_t> loadedProtocols;
+    // Objects left in kernel by previous run per protocol, groups first
+    std::unordered_map<uint8_t, std::vector<uint32_t>> staleNexthopIds;
+    std::unordered_map<std::string, NexthopEntry> nexthops;
+    std::unordered_map<std::string, uint32_t> groupIds;
+    std::unordered_map<uint32_t, NexthopGroupEntry> groups;
+    // Group referenced by each route, per protocol
+    std::unordered_map<
+        uint8_t,
+        std::unordered_map<folly::CIDRNetwork, uint32_t>>
+        routeGroups;
+  };
+
+  // Key identifying the nexthop set of the route. Returns `std::nullopt` if
+  // route can't be programmed with nexthop objects (e.g. MPLS, blackhole).
+  std::optional<std::string> getNexthopGroupKey(
+      const fbnl::Route& route) const;
+
+  // Find or create the group for nexthop set of `route` and take a reference
+  uint32_t acquireNexthopGroup(
+      NexthopRegistry& registry,
+      const std::string& key,
+      const fbnl::Route& route,
+      std::vector<folly::SemiFuture<int>>& result);
+
+  // Drop a reference and remove group/nexthops from kernel when unused
+  void releaseNexthopGroup(
+      NexthopRegistry& registry,
+      uint32_t groupId,
+      std::vector<folly::SemiFuture<int>>& result);
+
+  // Create nexthop objects of `route` & return group members with their keys
+  std::pair<fbnl::NexthopGroupMembers, std::vector<std::string>>
+  acquireNexthops(
+      NexthopRegistry& registry,
+      const fbnl::Route& route,
+      std::vector<folly::SemiFuture<int>>& result);
+  void releaseNexthops(
+      NexthopRegistry& registry,
+      const std::vector<std::string>& memberKeys,
+      std::vector<folly::SemiFuture<int>>& result);
+
+  // Dump nexthop objects in kernel once per protocol, before programming any
+  // of its own. Ids are allocated above every existing object, as adding one
+  // replaces the existing object of same id. Objects of `protocol` are left
+  // by a previous run and recorded as stale. Blocks on netlink dump.
+  void loadKernelNexthops(uint8_t protocol);
+
+  // Delete stale objects of `protocol`. Must only follow replacement of all
+  // routes of the protocol, as kernel removes routes referencing them.
+  void flushKernelNexthops(
+      uint8_t protocol, std::vector<folly::SemiFuture<int>>& result);
+
+  // [Route Digests] Load digests of routes in kernel for the protocol unless
+  // they are known already. Blocks on netlink route dump.
+  void seedRouteDigests(uint8_t protocol);
+
+  // [Route Digests] Record digests of add/updated routes and erase deleted
+  // ones, if digests are known for the protocol. Digests of add/updated and
+  // deleted routes are marked unknown if `result` fails, as a failed delete
+  // may leave the route in kernel.
+  folly::SemiFuture<folly::Unit> trackRouteDigests(
+      uint8_t protocol,
+      std::unordered_map<folly::CIDRNetwork, uint64_t>&& updated,
+      const std::vector<folly::CIDRNetwork>& deleted,
+      folly::SemiFuture<folly::Unit>&& result);
+
+  // Program routes with kernel nexthop objects
+  const bool enableNexthopObjects_{false};
+
+  // Digest of programmed unicast routes per protocol. Digest of 0 marks a
+  // route with unknown programming state.
+  folly::Synchronized<std::unordered_map<
+      uint8_t,
+      std::unordered_map<folly::CIDRNetwork, uint64_t>>>
+      routeDigests_;
+
+  // Registry of nexthop objects & groups programmed in kernel
+  folly::Synchronized<NexthopRegistry> nexthopRegistry_;
+
   // Cache for interface index <-> name mapping
   folly::Synchronized<std::unordered_map<std::string, int>> ifNameToIndex_;
   folly::Synchronized<std::unordered_map<int, std::string>> ifIndexToName_;
@@ -190,6 +351,9 @@ class NetlinkFibHandler : public virtual thrift::FibServiceSvIf,
 
   // Time when service started, in number of seconds, since epoch
   const int64_t startTime_{0};
+
+  // [Route Streaming] Declared last so that ack streams are terminated first
+  RouteStreamServer routeStreamServer_{*this};
 };
 
 } // namespace openr
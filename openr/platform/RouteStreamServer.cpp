@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/logging/xlog.h>
+#if FOLLY_HAS_COROUTINES
+#include <folly/experimental/coro/ViaIfAsync.h>
+#endif
+
+#include <openr/common/Constants.h>
+#include <openr/platform/RouteStreamServer.h>
+
+namespace openr {
+
+RouteStreamServer::RouteStreamServer(thrift::FibServiceSvIf& handler)
+    : handler_(handler) {}
+
+RouteStreamServer::~RouteStreamServer() {
+  close();
+}
+
+apache::thrift::ServerStream<thrift::RouteOperationAck>
+RouteStreamServer::subscribeRouteAcks(int16_t clientId) {
+  const auto token = nextToken_++;
+  auto streamAndPublisher =
+      apache::thrift::ServerStream<thrift::RouteOperationAck>::createPublisher(
+          [this, clientId, token]() {
+            publishers_.withWLock([&](auto& publishers) {
+              auto it = publishers.find(clientId);
+              if (it != publishers.end() and it->second.token == token) {
+                publishers.erase(it);
+              }
+            });
+            XLOG(INFO) << "Route ack stream-" << token << " of client "
+                       << clientId << " ended.";
+          });
+
+  std::optional<AckPublisher> replaced;
+  publishers_.withWLock([&](auto& publishers) {
+    auto it = publishers.find(clientId);
+    if (it != publishers.end()) {
+      replaced = std::move(it->second);
+      publishers.erase(it);
+    }
+    publishers.emplace(
+        clientId,
+        AckPublisher{token, std::move(streamAndPublisher.second)});
+  });
+  XLOG(INFO) << "Route ack stream-" << token << " of client " << clientId
+             << " started.";
+
+  // ATTN: complete() invokes the callback acquiring the lock, see
+  // OpenrCtrlHandler::closeFibPublishers()
+  if (replaced.has_value()) {
+    std::move(replaced->publisher).complete();
+  }
+  return std::move(streamAndPublisher.first);
+}
+
+void
+RouteStreamServer::close() {
+  std::vector<AckPublisher> publishersToClose;
+  publishers_.withWLock([&](auto& publishers) {
+    for (auto& [_, publisher] : publishers) {
+      publishersToClose.emplace_back(std::move(publisher));
+    }
+    publishers.clear();
+  });
+  for (auto& publisher : publishersToClose) {
+    std::move(publisher.publisher).complete();
+  }
+}
+
+void
+RouteStreamServer::publishAck(
+    int16_t clientId, thrift::RouteOperationAck&& ack) {
+  publishers_.withWLock([&](auto& publishers) {
+    auto it = publishers.find(clientId);
+    if (it == publishers.end()) {
+      XLOG(WARNING) << "Dropping ack of batch " << *ack.seqNum_ref()
+                    << " of client " << clientId << " without ack stream";
+      return;
+    }
+    it->second.publisher.next(std::move(ack));
+  });
+}
+
+#if FOLLY_HAS_COROUTINES
+apache::thrift::SinkConsumer<thrift::RouteOperationBatch, int64_t>
+RouteStreamServer::programRoutes(int16_t clientId) {
+  return apache::thrift::SinkConsumer<thrift::RouteOperationBatch, int64_t>{
+      [this, clientId](
+          folly::coro::AsyncGenerator<thrift::RouteOperationBatch&&> batches)
+          -> folly::coro::Task<int64_t> {
+        int64_t numBatches{0};
+        while (auto batch = co_await batches.next()) {
+          auto ack = co_await programBatch(clientId, std::move(*batch));
+          publishAck(clientId, std::move(ack));
+          ++numBatches;
+        }
+        XLOG(INFO) << "Programmed " << numBatches
+                   << " streamed route batches of client " << clientId;
+        co_return numBatches;
+      },
+      Constants::kRouteStreamSinkBufferSize};
+}
+
+folly::coro::Task<thrift::RouteOperationAck>
+RouteStreamServer::programBatch(
+    int16_t clientId, thrift::RouteOperationBatch batch) {
+  thrift::RouteOperationAck ack;
+  ack.seqNum_ref() = *batch.seqNum_ref();
+
+  // Deletions first. A failure fails the whole batch.
+  if (not batch.unicastRoutesToDelete_ref()->empty()) {
+    auto result = co_await folly::coro::co_awaitTry(
+        handler_.semifuture_deleteUnicastRoutes(
+            clientId,
+            std::make_unique<std::vector<thrift::IpPrefix>>(
+                std::move(*batch.unicastRoutesToDelete_ref()))));
+    if (result.hasException()) {
+      ack.error_ref() = result.exception().what().toStdString();
+      co_return ack;
+    }
+  }
+  if (not batch.mplsRoutesToDelete_ref()->empty()) {
+    auto result =
+        co_await folly::coro::co_awaitTry(handler_.semifuture_deleteMplsRoutes(
+            clientId,
+            std::make_unique<std::vector<int32_t>>(
+                std::move(*batch.mplsRoutesToDelete_ref()))));
+    if (result.hasException()) {
+      ack.error_ref() = result.exception().what().toStdString();
+      co_return ack;
+    }
+  }
+
+  // Additions. Routes failed to program are listed in the ack.
+  if (not batch.unicastRoutesToUpdate_ref()->empty()) {
+    auto result =
+        co_await folly::coro::co_awaitTry(handler_.semifuture_addUnicastRoutes(
+            clientId,
+            std::make_unique<std::vector<thrift::UnicastRoute>>(
+                std::move(*batch.unicastRoutesToUpdate_ref()))));
+    if (auto error =
+            result.tryGetExceptionObject<thrift::PlatformFibUpdateError>()) {
+      for (auto& [_, prefixes] : *error->vrf2failedAddUpdatePrefixes_ref()) {
+        ack.failedUnicastRoutes_ref()->insert(
+            ack.failedUnicastRoutes_ref()->end(),
+            prefixes.begin(),
+            prefixes.end());
+      }
+    } else if (result.hasException()) {
+      ack.error_ref() = result.exception().what().toStdString();
+      co_return ack;
+    }
+  }
+  if (not batch.mplsRoutesToUpdate_ref()->empty()) {
+    auto result =
+        co_await folly::coro::co_awaitTry(handler_.semifuture_addMplsRoutes(
+            clientId,
+            std::make_unique<std::vector<thrift::MplsRoute>>(
+                std::move(*batch.mplsRoutesToUpdate_ref()))));
+    if (auto error =
+            result.tryGetExceptionObject<thrift::PlatformFibUpdateError>()) {
+      *ack.failedMplsRoutes_ref() = *error->failedAddUpdateMplsLabels_ref();
+    } else if (result.hasException()) {
+      ack.error_ref() = result.exception().what().toStdString();
+      co_return ack;
+    }
+  }
+  co_return ack;
+}
+#endif
+
+} // namespace openr
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <unordered_map>
+
+#include <folly/Synchronized.h>
+#if FOLLY_HAS_COROUTINES
+#include <folly/experimental/coro/AsyncGenerator.h>
+#include <folly/experimental/coro/Task.h>
+#endif
+#include <thrift/lib/cpp2/async/ServerPublisherStream.h>
+
+#include <openr/if/gen-cpp2/FibServiceCpp.h>
+
+namespace openr {
+
+/**
+ * [Route Streaming] Serves streamed route programming of FibServiceCpp on top
+ * of the unary route APIs of a FibService handler, e.g. NetlinkFibHandler.
+ *
+ * Batches streamed by a client are programmed in order, deletions before
+ * additions, and acked on the ack stream of that client. Routes failed to add
+ * are listed per route in the ack. Any other failure fails the batch as a
+ * whole.
+ *
+ * Ack streams are completed on destruction, hence it MUST NOT outlive the
+ * handler it serves.
+ */
+class RouteStreamServer {
+ public:
+  explicit RouteStreamServer(thrift::FibServiceSvIf& handler);
+  ~RouteStreamServer();
+
+  RouteStreamServer(const RouteStreamServer&) = delete;
+  RouteStreamServer& operator=(const RouteStreamServer&) = delete;
+
+  // Ack stream of `clientId`, terminating its previous ack stream if any
+  apache::thrift::ServerStream<thrift::RouteOperationAck> subscribeRouteAcks(
+      int16_t clientId);
+
+#if FOLLY_HAS_COROUTINES
+  apache::thrift::SinkConsumer<thrift::RouteOperationBatch, int64_t>
+  programRoutes(int16_t clientId);
+#endif
+
+  // Terminate all ack streams
+  void close();
+
+ private:
+#if FOLLY_HAS_COROUTINES
+  folly::coro::Task<thrift::RouteOperationAck> programBatch(
+      int16_t clientId, thrift::RouteOperationBatch batch);
+#endif
+
+  // Publish ack on the ack stream of `clientId`. Dropped if there is none.
+  void publishAck(int16_t clientId, thrift::RouteOperationAck&& ack);
+
+  thrift::FibServiceSvIf& handler_;
+
+  // Ack stream per client. Token tells apart a replaced stream.
+  struct AckPublisher {
+    int64_t token{0};
+    apache::thrift::ServerStreamPublisher<thrift::RouteOperationAck>
+        publisher;
+  };
+  folly::Synchronized<std::unordered_map<int16_t, AckPublisher>> publishers_;
+  std::atomic<int64_t> nextToken_{0};
+};
+
+} // namespace openr
@@ -5,6 +5,7 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <fb303/ServiceData.h>
 #include <folly/Format.h>
 #include <folly/IPAddress.h>
 #include <folly/Random.h>
@@ -23,6 +24,8 @@
 
 using namespace openr;
 
+namespace fb303 = facebook::fb303;
+
 namespace {
 
 const std::vector<std::string> kInterfaces{"eth0", "eth1", "eth2", "eth4"};
@@ -374,6 +377,39 @@ TEST_P(FibHandlerFixture, UnicastAddRouteWithLabelPush) {
   EXPECT_EQ(r1, routes->at(0));
 }
 
+//
+// Unicast and MPLS routes of an update are programmed with one bulk netlink
+// request instead of one request per route
+//
+TEST_P(FibHandlerFixture, BulkRouteAdd) {
+  const int16_t kClientId = 786;
+  const bool isV4 = GetParam();
+  auto getNumBatches = []() {
+    return fb303::fbData->getCounters()["nlmock.add_routes.sum"];
+  };
+
+  const auto numBatches = getNumBatches();
+  auto rts = createUnicastRoutes(100, isV4);
+  handler
+      .semifuture_addUnicastRoutes(
+          kClientId, std::make_unique<std::vector<thrift::UnicastRoute>>(rts))
+      .get();
+  auto routes = handler.semifuture_getRouteTableByClient(kClientId).get();
+  ASSERT_EQ(100, routes->size());
+  EXPECT_EQ(numBatches + 1, getNumBatches());
+
+  const auto phpAction = createMplsAction(thrift::MplsActionCode::PHP);
+  auto mplsRts = createMplsRoutes(100, isV4, phpAction);
+  handler
+      .semifuture_addMplsRoutes(
+          kClientId, std::make_unique<std::vector<thrift::MplsRoute>>(mplsRts))
+      .get();
+  auto mplsRoutes =
+      handler.semifuture_getMplsRouteTableByClient(kClientId).get();
+  ASSERT_EQ(100, mplsRoutes->size());
+  EXPECT_EQ(numBatches + 2, getNumBatches());
+}
+
 //
 // Test correctness of SyncFib
 //
@@ -412,6 +448,258 @@ TEST_P(FibHandlerFixture, UnicastSync) {
   EXPECT_EQ(rts, *routes);
 }
 
+/**
+ * Fixture with nexthop objects enabled. Exposes MockNetlinkProtocolSocket for
+ * inspecting nexthop objects and groups programmed by the handler.
+ */
+class NexthopObjectsFixture : public testing::TestWithParam<bool> {
+ public:
+  void
+  SetUp() override {
+    // Add loopback interface with index=0
+    ASSERT_EQ(
+        0,
+        nlSock
+            .addLink(
+                fbnl::utils::createLink(0, "lo", true, true /* isLoopback */))
+            .get());
+
+    // Add interfaces to fake netlink with index starting at 1
+    for (size_t i = 0; i < kInterfaces.size(); ++i) {
+      ASSERT_EQ(
+          0,
+          nlSock
+              .addLink(fbnl::utils::createLink(
+                  i + 1, kInterfaces.at(i), true, false))
+              .get());
+    }
+  }
+
+  void
+  addRoutes(const std::vector<thrift::UnicastRoute>& routes) {
+    handler
+        .semifuture_addUnicastRoutes(
+            kClientId,
+            std::make_unique<std::vector<thrift::UnicastRoute>>(routes))
+        .get();
+  }
+
+  void
+  verifyRoutes(std::vector<thrift::UnicastRoute> expected) {
+    auto routes = handler.semifuture_getRouteTableByClient(kClientId).get();
+    sortNextHops(*routes);
+    sortNextHops(expected);
+    EXPECT_EQ(expected, *routes);
+  }
+
+  int64_t
+  getNumRouteAdds() {
+    return fb303::fbData->getCounters()["nlmock.add_route.sum"];
+  }
+
+  const int16_t kClientId{786};
+
+ private:
+  folly::EventBase nlEvb_;
+
+ public:
+  fbnl::MockNetlinkProtocolSocket nlSock{&nlEvb_};
+  NetlinkFibHandler handler{
+      dynamic_cast<fbnl::NetlinkProtocolSocket*>(&nlSock),
+      true /* enableNexthopObjects */};
+};
+
+//
+// Routes with same nexthops share one nexthop group. Expanding nexthops of
+// all routes in a group rewrites the group in place without replacing routes.
+// Groups and nexthops are removed when the last route referencing them goes.
+//
+TEST_P(NexthopObjectsFixture, UnicastSharedGroup) {
+  const bool isV4 = GetParam();
+
+  // Three routes with the same two nexthops
+  std::vector<thrift::UnicastRoute> rts;
+  for (size_t i = 0; i < 3; ++i) {
+    rts.emplace_back(createUnicastRoute(i, 2, isV4));
+    *rts.back().nextHops_ref() = *rts.front().nextHops_ref();
+  }
+  addRoutes(rts);
+  verifyRoutes(rts);
+  EXPECT_EQ(1, nlSock.getNexthopGroupCount());
+  EXPECT_EQ(2, nlSock.getNexthopCount());
+
+  // Add a nexthop to all routes. Group is updated without route replace
+  const auto numRouteAdds = getNumRouteAdds();
+  const auto nh = createNextHop(2 /* index */, isV4);
+  for (auto& rt : rts) {
+    rt.nextHops_ref()->push_back(nh);
+  }
+  addRoutes(rts);
+  verifyRoutes(rts);
+  EXPECT_EQ(numRouteAdds, getNumRouteAdds());
+  EXPECT_EQ(1, nlSock.getNexthopGroupCount());
+  EXPECT_EQ(3, nlSock.getNexthopCount());
+
+  // Shrink nexthops of one route. It moves to a new group sharing nexthop
+  rts.at(0).nextHops_ref()->resize(1);
+  addRoutes({rts.at(0)});
+  verifyRoutes(rts);
+  EXPECT_EQ(numRouteAdds + 1, getNumRouteAdds());
+  EXPECT_EQ(2, nlSock.getNexthopGroupCount());
+  EXPECT_EQ(3, nlSock.getNexthopCount());
+
+  // Delete the route. Its group is removed but nexthops remain in use
+  handler
+      .semifuture_deleteUnicastRoute(
+          kClientId, std::make_unique<thrift::IpPrefix>(*rts.at(0).dest_ref()))
+      .get();
+  rts.erase(rts.begin());
+  verifyRoutes(rts);
+  EXPECT_EQ(1, nlSock.getNexthopGroupCount());
+  EXPECT_EQ(3, nlSock.getNexthopCount());
+
+  // Sync with no routes. All nexthop objects are removed
+  handler
+      .semifuture_syncFib(
+          kClientId, std::make_unique<std::vector<thrift::UnicastRoute>>())
+      .get();
+  verifyRoutes({});
+  EXPECT_EQ(0, nlSock.getNexthopGroupCount());
+  EXPECT_EQ(0, nlSock.getNexthopCount());
+}
+
+//
+// Nexthop objects of a previous run stay in kernel along with routes
+// referencing them. Restarted handler allocates ids above them, hence
+// routes of previous run keep their nexthops until replaced. Full sync
+// replaces all routes and flushes the stale objects.
+//
+TEST_P(NexthopObjectsFixture, UnicastSyncAfterRestart) {
+  const bool isV4 = GetParam();
+
+  std::vector<thrift::UnicastRoute> rts{
+      createUnicastRoute(0, 2, isV4), createUnicastRoute(1, 1, isV4)};
+  addRoutes(rts);
+  verifyRoutes(rts);
+  const auto numGroups = nlSock.getNexthopGroupCount();
+  const auto numNexthops = nlSock.getNexthopCount();
+  EXPECT_LT(0, numGroups);
+
+  // Restarted handler programs a route with new nexthop before sync.
+  // Objects of previous run must not be replaced.
+  NetlinkFibHandler restarted(
+      dynamic_cast<fbnl::NetlinkProtocolSocket*>(&nlSock),
+      true /* enableNexthopObjects */);
+  auto rt = createUnicastRoute(2, 1, isV4);
+  rt.nextHops_ref() =
+      std::vector<thrift::NextHopThrift>{createNextHop(3 /* index */, isV4)};
+  restarted
+      .semifuture_addUnicastRoutes(
+          kClientId, std::make_unique<std::vector<thrift::UnicastRoute>>(1, rt))
+      .get();
+  rts.emplace_back(rt);
+  verifyRoutes(rts);
+  EXPECT_EQ(numGroups + 1, nlSock.getNexthopGroupCount());
+  EXPECT_EQ(numNexthops + 1, nlSock.getNexthopCount());
+
+  // Full sync moves routes of previous run to new objects, and deletes the
+  // stale ones
+  restarted
+      .semifuture_syncFib(
+          kClientId, std::make_unique<std::vector<thrift::UnicastRoute>>(rts))
+      .get();
+  verifyRoutes(rts);
+  EXPECT_EQ(numGroups + 1, nlSock.getNexthopGroupCount());
+  EXPECT_EQ(numNexthops + 1, nlSock.getNexthopCount());
+
+  // No more stale objects to flush
+  restarted
+      .semifuture_syncFib(
+          kClientId, std::make_unique<std::vector<thrift::UnicastRoute>>(rts))
+      .get();
+  verifyRoutes(rts);
+  EXPECT_EQ(numGroups + 1, nlSock.getNexthopGroupCount());
+  EXPECT_EQ(numNexthops + 1, nlSock.getNexthopCount());
+}
+
+//
+// Differential sync programs only routes in the requested ranges whose
+// digest differs from the programmed state. A restarted handler seeds its
+// digests from the kernel and re-syncing the same routes writes nothing.
+//
+TEST_P(NexthopObjectsFixture, UnicastDifferentialSync) {
+  const bool isV4 = GetParam();
+  const int32_t kNumRanges = 8;
+
+  auto getDigests = [&](NetlinkFibHandler& fibHandler) {
+    return *fibHandler.semifuture_getUnicastRouteDigests(kClientId, kNumRanges)
+                .get();
+  };
+  auto syncRanges = [&](NetlinkFibHandler& fibHandler,
+                        const std::vector<int32_t>& ranges,
+                        const std::vector<thrift::UnicastRoute>& routes) {
+    fibHandler
+        .semifuture_syncFibRanges(
+            kClientId,
+            kNumRanges,
+            std::make_unique<std::vector<int32_t>>(ranges),
+            std::make_unique<std::vector<thrift::UnicastRoute>>(routes))
+        .get();
+  };
+
+  // Nothing is programmed to begin with
+  EXPECT_TRUE(getDigests(handler).empty());
+
+  // Compute expected digests of routes
+  auto rts = createUnicastRoutes(16, isV4);
+  std::unordered_map<folly::CIDRNetwork, uint64_t> routeDigests;
+  for (const auto& rt : rts) {
+    routeDigests.emplace(
+        toIPNetwork(*rt.dest_ref()), getUnicastRouteDigest(rt));
+  }
+  const auto digests = getUnicastRouteRangeDigests(routeDigests, kNumRanges);
+  std::vector<int32_t> ranges;
+  for (const auto& [range, _] : digests) {
+    ranges.emplace_back(range);
+  }
+
+  // Sync all ranges. Programmed digests match the expected ones
+  syncRanges(handler, ranges, rts);
+  verifyRoutes(rts);
+  EXPECT_EQ(digests, getDigests(handler));
+
+  // Restarted handler learns digests from kernel. Re-sync writes no routes
+  NetlinkFibHandler restarted(
+      dynamic_cast<fbnl::NetlinkProtocolSocket*>(&nlSock),
+      true /* enableNexthopObjects */);
+  EXPECT_EQ(digests, getDigests(restarted));
+  const auto numRouteAdds = getNumRouteAdds();
+  syncRanges(restarted, ranges, rts);
+  EXPECT_EQ(numRouteAdds, getNumRouteAdds());
+
+  // Sync one range without its routes. Only that range is withdrawn
+  const auto range = ranges.front();
+  std::vector<thrift::UnicastRoute> remaining;
+  for (const auto& rt : rts) {
+    if (getPrefixRange(toIPNetwork(*rt.dest_ref()), kNumRanges) != range) {
+      remaining.emplace_back(rt);
+    }
+  }
+
+  // Failed deletes leave routes in kernel. Their range is marked unknown
+  nlSock.setRouteFaults(std::chrono::microseconds(0), 1.0);
+  EXPECT_THROW(syncRanges(restarted, {range}, {}), fbnl::NlException);
+  nlSock.setRouteFaults(std::chrono::microseconds(0), 0);
+  verifyRoutes(rts);
+  EXPECT_EQ(0, getDigests(restarted).at(range));
+
+  // Retry withdraws the range
+  syncRanges(restarted, {range}, {});
+  verifyRoutes(remaining);
+  EXPECT_EQ(numRouteAdds, getNumRouteAdds());
+  EXPECT_EQ(0, getDigests(restarted).count(range));
+}
+
 //
 // Test correctness of multiple client support. Incrementally add and remove
 // route for same prefix1 from client1 and client2. Verify that addition or
@@ -766,6 +1054,7 @@ TEST_P(FibHandlerFixture, MplsMultipleClient) {
 // instantiate parameterized tests
 //
 INSTANTIATE_TEST_CASE_P(Netlink, FibHandlerFixture, testing::Bool());
+INSTANTIATE_TEST_CASE_P(Netlink, NexthopObjectsFixture, testing::Bool());
 
 int
 main(int argc, char* argv[]) {
@@ -5,6 +5,10 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
+
+#include <folly/futures/Future.h>
+
 #include <openr/policy/PolicyManager.h>
 
 namespace openr {
@@ -24,4 +28,39 @@ PolicyManager::applyPolicy(
   return {prefixEntry, "Always Allow"};
 }
 
+std::vector<std::pair<std::shared_ptr<thrift::PrefixEntry>, std::string>>
+PolicyManager::applyPolicyBatch(
+    const std::string& policyStatementName,
+    const std::vector<PolicyInput>& inputs,
+    folly::Executor* executor) {
+  std::vector<std::pair<std::shared_ptr<thrift::PrefixEntry>, std::string>>
+      results(inputs.size());
+  // every chunk writes its own slice of results only
+  auto evaluate = [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      const auto& input = inputs[i];
+      results[i] = applyPolicy(
+          policyStatementName,
+          input.prefixEntry,
+          input.policyActionData,
+          input.policyMatchData);
+    }
+  };
+
+  if (not executor or inputs.size() <= kPolicyBatchChunkSize) {
+    evaluate(0, inputs.size());
+    return results;
+  }
+
+  std::vector<folly::Future<folly::Unit>> futures;
+  for (size_t begin = 0; begin < inputs.size();
+       begin += kPolicyBatchChunkSize) {
+    const size_t end = std::min(begin + kPolicyBatchChunkSize, inputs.size());
+    futures.emplace_back(folly::via(
+        executor, [&evaluate, begin, end]() { evaluate(begin, end); }));
+  }
+  folly::collect(std::move(futures)).get();
+  return results;
+}
+
 } // namespace openr
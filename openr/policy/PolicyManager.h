@@ -7,7 +7,14 @@
 
 #pragma once
 
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include <configerator/structs/neteng/config/gen-cpp2/routing_policy_types.h>
+#include <folly/Executor.h>
 #include <openr/if/gen-cpp2/Types_types.h>
 #include <openr/policy/PolicyStructs.h>
 
@@ -17,6 +24,9 @@ class PolicyManagerImpl;
 
 /**
  * PolicyManager manages all policies defined in the config file.
+ *
+ * Policies are fixed once constructed, hence applyPolicy() may be called
+ * concurrently from multiple threads.
  */
 class PolicyManager {
  public:
@@ -24,6 +34,16 @@ class PolicyManager {
       const neteng::config::routing_policy::PolicyConfig& config);
   ~PolicyManager();
 
+  // Input of one prefix entry in batch policy evaluation
+  struct PolicyInput {
+    std::shared_ptr<thrift::PrefixEntry> prefixEntry;
+    std::optional<OpenrPolicyActionData> policyActionData;
+    std::optional<OpenrPolicyMatchData> policyMatchData;
+  };
+
+  // Number of prefix entries evaluated by one task of batch evaluation
+  static constexpr size_t kPolicyBatchChunkSize{64};
+
   std::pair<std::shared_ptr<thrift::PrefixEntry>, std::string /*policy name*/>
   applyPolicy(
       const std::string& policyStatementName,
@@ -33,6 +53,17 @@ class PolicyManager {
       const std::optional<OpenrPolicyMatchData>& policyMatchData =
           std::nullopt) noexcept;
 
+  /**
+   * Batch flavor of applyPolicy(), results are in order of `inputs`. Batch
+   * is split into chunks evaluated concurrently on `executor` if given, and
+   * the caller blocks until all of them are done. Evaluated inline otherwise.
+   */
+  std::vector<std::pair<std::shared_ptr<thrift::PrefixEntry>, std::string>>
+  applyPolicyBatch(
+      const std::string& policyStatementName,
+      const std::vector<PolicyInput>& inputs,
+      folly::Executor* executor = nullptr);
+
   // PolicyManagerImpl uses forward declaration
   // Use shared_ptr because it works with incomplete type, where unique_ptr
   // requires full declaration
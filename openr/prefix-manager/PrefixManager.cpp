@@ -5,9 +5,13 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
+
 #include <fb303/ServiceData.h>
 #include <folly/IPAddress.h>
+#include <folly/executors/thread_factory/NamedThreadFactory.h>
 #include <folly/futures/Future.h>
+#include <folly/hash/Hash.h>
 #include <folly/logging/xlog.h>
 #include <thrift/lib/cpp2/protocol/Serializer.h>
 #ifndef NO_FOLLY_EXCEPTION_TRACER
@@ -27,13 +31,56 @@ namespace openr {
 
 namespace fb303 = facebook::fb303;
 
+namespace detail {
+
+PrefixSyncThrottleTuner::PrefixSyncThrottleTuner(
+    std::chrono::milliseconds minThrottle,
+    std::chrono::milliseconds maxThrottle)
+    : minThrottle_(minThrottle),
+      maxThrottle_(maxThrottle),
+      lastChangeIntervalMs_(2 * maxThrottle.count()),
+      changeIntervalMs_(2 * maxThrottle.count()) {}
+
+void
+PrefixSyncThrottleTuner::recordChange(
+    std::chrono::steady_clock::time_point now) {
+  if (lastChangeTime_.has_value()) {
+    lastChangeIntervalMs_ = std::min<double>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            now - *lastChangeTime_)
+            .count(),
+        2 * maxThrottle_.count());
+    changeIntervalMs_ = kSampleWeight * lastChangeIntervalMs_ +
+        (1 - kSampleWeight) * changeIntervalMs_;
+  }
+  lastChangeTime_ = now;
+}
+
+std::chrono::milliseconds
+PrefixSyncThrottleTuner::getThrottle(size_t numPendingUpdates) const {
+  const double maxMs = maxThrottle_.count();
+  const double pendingWindowMs = maxMs *
+      std::min<double>(1, static_cast<double>(numPendingUpdates) /
+                           kPendingUpdatesAtMax);
+  // idle, change rate is not accounted for
+  const double rateWindowMs =
+      lastChangeIntervalMs_ >= maxMs ? 0 : maxMs - changeIntervalMs_;
+  return std::clamp(
+      std::chrono::milliseconds(
+          static_cast<int64_t>(std::max(rateWindowMs, pendingWindowMs))),
+      minThrottle_,
+      maxThrottle_);
+}
+
+} // namespace detail
+
 PrefixManager::PrefixManager(
     messaging::ReplicateQueue<DecisionRouteUpdate>& staticRouteUpdatesQueue,
     messaging::ReplicateQueue<KeyValueRequest>& kvRequestQueue,
     messaging::ReplicateQueue<DecisionRouteUpdate>& prefixMgrRouteUpdatesQueue,
     messaging::ReplicateQueue<thrift::InitializationEvent>&
         initializationEventQueue,
-    messaging::RQueue<KvStorePublication> kvStoreUpdatesQueue,
+    messaging::SharedRQueue<KvStorePublication> kvStoreUpdatesQueue,
     messaging::RQueue<PrefixEvent> prefixUpdatesQueue,
     messaging::RQueue<DecisionRouteUpdate> fibRouteUpdatesQueue,
     std::shared_ptr<const Config> config)
@@ -44,6 +91,7 @@ PrefixManager::PrefixManager(
       prefixMgrRouteUpdatesQueue_(prefixMgrRouteUpdatesQueue),
       initializationEventQueue_(initializationEventQueue),
       v4OverV6Nexthop_(config->isV4OverV6NexthopEnabled()),
+      numPrefixKeyShards_(config->getPrefixKeyShards()),
       preferOpenrOriginatedRoutes_(
           *config->getConfig().prefer_openr_originated_routes_ref()) {
   CHECK(config);
@@ -70,6 +118,11 @@ PrefixManager::PrefixManager(
 
   if (auto policyConf = config->getAreaPolicies()) {
     policyManager_ = std::make_unique<PolicyManager>(*policyConf);
+    if (config->getPolicyNumThreads() > 0) {
+      policyExecutor_ = std::make_unique<folly::CPUThreadPoolExecutor>(
+          config->getPolicyNumThreads(),
+          std::make_shared<folly::NamedThreadFactory>("PolicyPool"));
+    }
   }
 
   for (const auto& [areaId, areaConf] : config->getAreas()) {
@@ -98,6 +151,20 @@ PrefixManager::PrefixManager(
     initialSyncKvStoreTimer_->scheduleTimeout(initialPrefixHoldTime);
   }
 
+  // Resumes redistribution of routes left pending by previous run
+  redistributeTimer_ = folly::AsyncTimeout::make(*getEvb(), [this]() noexcept {
+    redistributePendingRoutes(Constants::kMaxRedistributedRoutesPerRun);
+  });
+
+  // Adapt throttle of KvStore sync to prefix churn if configured
+  if (config->getPrefixSyncMaxThrottle().count() > 0) {
+    syncThrottleTuner_.emplace(
+        Constants::kKvStoreSyncMinThrottleTimeout,
+        std::max(
+            Constants::kKvStoreSyncMinThrottleTimeout,
+            config->getPrefixSyncMaxThrottle()));
+  }
+
   // Create throttled update state
   syncKvStoreThrottled_ = std::make_unique<AsyncThrottle>(
       getEvb(), Constants::kKvStoreSyncThrottleTimeout, [this]() noexcept {
@@ -131,145 +198,139 @@ PrefixManager::PrefixManager(
     }
   });
 
-  // Schedule fiber to read prefix updates messages
-  addFiberTask([q = std::move(prefixUpdatesQueue), this]() mutable noexcept {
-    while (true) {
-      auto maybeUpdate = q.get(); // perform read
-      if (maybeUpdate.hasError()) {
-        XLOG(DBG1) << "Terminating prefix update request processing fiber";
-        break;
-      }
-      auto& update = maybeUpdate.value();
-
-      // if no specified dstination areas, apply to all areas
-      std::unordered_set<std::string> dstAreas;
-      if (update.dstAreas.empty()) {
-        dstAreas = allAreaIds();
-      } else {
-        for (const auto& area : update.dstAreas) {
-          dstAreas.emplace(area);
+  // Schedule reader of prefix updates messages. Prefix events queued up are
+  // read at once, so that a burst is synced to KvStore together.
+  addQueueReaderTask(
+      "prefix_updates",
+      std::move(prefixUpdatesQueue),
+      Constants::kQueueReadBatchSize,
+      [this](std::vector<PrefixEvent>&& updates) {
+        for (auto& update : updates) {
+          processPrefixEvent(update);
         }
-      }
+      });
 
-      switch (update.eventType) {
-      case PrefixEventType::ADD_PREFIXES: {
-        XLOGF(
-            DBG1,
-            "[Prefix Event] Announcing {} prefixes to areas: {}",
-            update.prefixes.size() + update.prefixEntries.size(),
-            folly::join(",", dstAreas));
-        advertisePrefixesImpl(std::move(update.prefixes), dstAreas);
-        advertisePrefixesImpl(
-            std::move(std::move(update.prefixEntries)),
-            dstAreas,
-            update.policyName);
-
-        if (uninitializedPrefixTypes_.erase(update.type)) {
-          // Received initial prefixes of certain type in OpenR initialization
-          // process.
-          XLOG(INFO) << fmt::format(
-              "[Initialization] Received {} prefixes of type {}.",
-              update.prefixes.size() + update.prefixEntries.size(),
-              apache::thrift::util::enumNameSafe<thrift::PrefixType>(
-                  update.type));
-          // Publish initial unicast routes for the prefix type, so they will be
-          // programmed in warmboot.
-          sendStaticUnicastRoutes(update.type);
-
-          triggerInitialPrefixDbSync();
+  // Reader of route updates from Fib.
+  addQueueReaderTask(
+      "fib_route_updates",
+      std::move(fibRouteUpdatesQueue),
+      Constants::kQueueReadBatchSize,
+      [this](std::vector<DecisionRouteUpdate>&& routeUpdates) {
+        try {
+          XLOG(DBG2) << "Received RIB updates from Decision";
+          for (auto& routeUpdate : routeUpdates) {
+            processFibRouteUpdates(std::move(routeUpdate));
+          }
+        } catch (const std::exception&) {
+#ifndef NO_FOLLY_EXCEPTION_TRACER
+          // collect stack strace then fail the process
+          for (auto& exInfo :
+               folly::exception_tracer::getCurrentExceptions()) {
+            XLOG(ERR) << exInfo;
+          }
+#endif
+          throw;
         }
-        break;
-      }
-      case PrefixEventType::WITHDRAW_PREFIXES:
-        XLOGF(
-            DBG1,
-            "[Prefix Event] Withdrawing {} prefixes from areas: {}",
-            update.prefixes.size() + update.prefixEntries.size(),
-            folly::join(",", dstAreas));
-        withdrawPrefixesImpl(update.prefixes);
-        withdrawPrefixEntriesImpl(update.prefixEntries);
-        break;
-      case PrefixEventType::WITHDRAW_PREFIXES_BY_TYPE:
-        XLOGF(
-            DBG1,
-            "[Prefix Event] Withdrawing all prefix with type {} from all areas",
-            apache::thrift::util::enumNameSafe(update.type));
-        withdrawPrefixesByTypeImpl(update.type);
-        break;
-      case PrefixEventType::SYNC_PREFIXES_BY_TYPE:
-        syncPrefixesByTypeImpl(
-            update.type, update.prefixes, dstAreas, update.policyName);
-        break;
-      default:
-        XLOG(ERR) << "Unknown command received. "
-                  << static_cast<int>(update.eventType);
-      }
-    }
-  });
-
-  // Fiber to process route updates from Fib.
-  addFiberTask([q = std::move(fibRouteUpdatesQueue), this]() mutable noexcept {
-    while (true) {
-      auto maybeThriftObj = q.get(); // perform read
-      if (maybeThriftObj.hasError()) {
-        XLOG(DBG1) << "Terminating route delta processing fiber";
-        break;
-      }
+      });
 
-      try {
-        XLOG(DBG2) << "Received RIB updates from Decision";
-        processFibRouteUpdates(std::move(maybeThriftObj).value());
-      } catch (const std::exception&) {
-#ifndef NO_FOLLY_EXCEPTION_TRACER
-        // collect stack strace then fail the process
-        for (auto& exInfo : folly::exception_tracer::getCurrentExceptions()) {
-          XLOG(ERR) << exInfo;
+  // Reader of publication from KvStore
+  addQueueReaderTask(
+      "kvstore_updates",
+      std::move(kvStoreUpdatesQueue),
+      Constants::kQueueReadBatchSize,
+      [this](std::vector<std::shared_ptr<const KvStorePublication>>&& pubs) {
+        for (const auto& publication : pubs) {
+          // process different types of event
+          // ATTN: publication is shared with other readers. DO NOT mutate.
+          folly::variant_match(
+              *publication,
+              [this](thrift::Publication const& pub) {
+                // Process KvStore Thrift publication.
+                processPublication(pub);
+              },
+              [this](thrift::InitializationEvent const& event) {
+                CHECK(event == thrift::InitializationEvent::KVSTORE_SYNCED)
+                    << fmt::format(
+                           "Unexpected initialization event: {}",
+                           apache::thrift::util::enumNameSafe(event));
+
+                XLOG(INFO) << "[Initialization] All prefix keys are retrieved "
+                              "from KvStore.";
+                initialKvStoreSynced_ = true;
+                triggerInitialPrefixDbSync();
+              });
         }
-#endif
-        throw;
-      }
+      });
+}
+
+void
+PrefixManager::processPrefixEvent(PrefixEvent& update) {
+  // if no specified dstination areas, apply to all areas
+  std::unordered_set<std::string> dstAreas;
+  if (update.dstAreas.empty()) {
+    dstAreas = allAreaIds();
+  } else {
+    for (const auto& area : update.dstAreas) {
+      dstAreas.emplace(area);
     }
-  });
+  }
 
-  // Fiber to process publication from KvStore
-  addFiberTask([q = std::move(kvStoreUpdatesQueue), this]() mutable noexcept {
-    XLOG(INFO) << "Starting KvStore updates processing fiber";
-    while (true) {
-      auto maybePub = q.get(); // perform read
-      if (maybePub.hasError()) {
-        XLOG(DBG1) << fmt::format(
-            "Terminating KvStore updates processing fiber, error: {}",
-            maybePub.error());
-        break;
-      }
-      if (not maybePub.hasValue()) {
-        continue;
-      }
+  switch (update.eventType) {
+  case PrefixEventType::ADD_PREFIXES: {
+    XLOGF(
+        DBG1,
+        "[Prefix Event] Announcing {} prefixes to areas: {}",
+        update.prefixes.size() + update.prefixEntries.size(),
+        folly::join(",", dstAreas));
+    advertisePrefixesImpl(std::move(update.prefixes), dstAreas);
+    advertisePrefixesImpl(
+        std::move(std::move(update.prefixEntries)),
+        dstAreas,
+        update.policyName);
+
+    if (uninitializedPrefixTypes_.erase(update.type)) {
+      // Received initial prefixes of certain type in OpenR initialization
+      // process.
+      XLOG(INFO) << fmt::format(
+          "[Initialization] Received {} prefixes of type {}.",
+          update.prefixes.size() + update.prefixEntries.size(),
+          apache::thrift::util::enumNameSafe<thrift::PrefixType>(update.type));
+      // Publish initial unicast routes for the prefix type, so they will be
+      // programmed in warmboot.
+      sendStaticUnicastRoutes(update.type);
 
-      // process different types of event
-      folly::variant_match(
-          std::move(maybePub).value(),
-          [this](thrift::Publication&& pub) {
-            // Process KvStore Thrift publication.
-            processPublication(std::move(pub));
-          },
-          [this](thrift::InitializationEvent&& event) {
-            CHECK(event == thrift::InitializationEvent::KVSTORE_SYNCED)
-                << fmt::format(
-                       "Unexpected initialization event: {}",
-                       apache::thrift::util::enumNameSafe(event));
-
-            XLOG(INFO)
-                << "[Initialization] All prefix keys are retrieved from KvStore.";
-            initialKvStoreSynced_ = true;
-            triggerInitialPrefixDbSync();
-          });
+      triggerInitialPrefixDbSync();
     }
-  });
+    break;
+  }
+  case PrefixEventType::WITHDRAW_PREFIXES:
+    XLOGF(
+        DBG1,
+        "[Prefix Event] Withdrawing {} prefixes from areas: {}",
+        update.prefixes.size() + update.prefixEntries.size(),
+        folly::join(",", dstAreas));
+    withdrawPrefixesImpl(update.prefixes);
+    withdrawPrefixEntriesImpl(update.prefixEntries);
+    break;
+  case PrefixEventType::WITHDRAW_PREFIXES_BY_TYPE:
+    XLOGF(
+        DBG1,
+        "[Prefix Event] Withdrawing all prefix with type {} from all areas",
+        apache::thrift::util::enumNameSafe(update.type));
+    withdrawPrefixesByTypeImpl(update.type);
+    break;
+  case PrefixEventType::SYNC_PREFIXES_BY_TYPE:
+    syncPrefixesByTypeImpl(
+        update.type, update.prefixes, dstAreas, update.policyName);
+    break;
+  default:
+    XLOG(ERR) << "Unknown command received. "
+              << static_cast<int>(update.eventType);
+  }
 }
 
 void
-PrefixManager::processPublication(thrift::Publication&& thriftPub) {
+PrefixManager::processPublication(thrift::Publication const& thriftPub) {
   folly::small_vector<folly::CIDRNetwork> changed{};
   for (const auto& [keyStr, val] : *thriftPub.keyVals_ref()) {
     // Only interested in prefix updates.
@@ -283,6 +344,23 @@ PrefixManager::processPublication(thrift::Publication&& thriftPub) {
     try {
       const auto prefixDb = readThriftObjStr<thrift::PrefixDatabase>(
           *val.value_ref(), serializer_);
+
+      // Clear self-advertised shard keys no longer advertised, e.g. of
+      // previous incarnation, upon next syncKvStore().
+      if (auto maybeShard = PrefixKey::parsePrefixShardKey(keyStr);
+          maybeShard.hasValue()) {
+        const auto shardId = maybeShard->second;
+        const auto areaIt = prefixShards_.find(area);
+        if (*prefixDb.thisNodeName_ref() == nodeId_ and
+            not *prefixDb.deletePrefix_ref() and
+            (areaIt == prefixShards_.end() or
+             areaIt->second.count(shardId) == 0)) {
+          changedPrefixShards_[area].emplace(shardId);
+          scheduleSyncKvStore();
+        }
+        continue;
+      }
+
       if (prefixDb.prefixEntries()->size() != 1) {
         LOG(WARNING) << "Skip processing unexpected number of prefix entries";
         continue;
@@ -309,7 +387,7 @@ PrefixManager::processPublication(thrift::Publication&& thriftPub) {
 
         // Populate pendingState to check keys
         pendingUpdates_.addPrefixChange(network);
-        syncKvStoreThrottled_->operator()();
+        scheduleSyncKvStore();
       }
     } catch (const std::exception& ex) {
       XLOG(ERR) << "Failed to deserialize corresponding value for key "
@@ -379,12 +457,13 @@ PrefixManager::buildOriginatedPrefixes(
     }
 
     // ATTN: upon initialization, no supporting routes
-    originatedPrefixDb_.emplace(
+    auto [it, _] = originatedPrefixDb_.emplace(
         network,
         OriginatedRoute(
             prefix,
             std::move(unicastEntry),
             std::unordered_set<folly::CIDRNetwork>{}));
+    originatedPrefixTrie_.insert(network, &it->second);
   }
 
   // Publish static routes for config originated prefixes. This makes sure
@@ -491,7 +570,7 @@ PrefixManager::addKvStoreKeyHelper(const PrefixEntry& entry) {
       tPrefixEntry->area_stack_ref()->begin(),
       tPrefixEntry->area_stack_ref()->end()};
 
-  for (const auto& toArea : entry.dstAreas) {
+  for (const auto& toArea : *entry.dstAreas) {
     // prevent area_stack loop
     // ATTN: for local-originated prefixes, `area_stack` is explicitly
     //       set to empty.
@@ -506,11 +585,7 @@ PrefixManager::addKvStoreKeyHelper(const PrefixEntry& entry) {
     const auto& policy = areaToPolicy_.at(toArea);
     if (policy) {
       std::tie(postPolicyTPrefixEntry, hitPolicyName) =
-          policyManager_->applyPolicy(
-              *policy,
-              tPrefixEntry,
-              entry.policyActionData,
-              entry.policyMatchData);
+          applyPolicyMemoized(*policy, entry, entry.policyActionData);
 
       // policy reject prefix, nothing to do.
       if (not postPolicyTPrefixEntry) {
@@ -531,15 +606,21 @@ PrefixManager::addKvStoreKeyHelper(const PrefixEntry& entry) {
       postPolicyTPrefixEntry = tPrefixEntry;
     }
 
-    const auto prefixKeyStr =
-        PrefixKey(nodeId_, entry.network, toArea).getPrefixKeyV2();
-    auto prefixDb = createPrefixDb(nodeId_, {*postPolicyTPrefixEntry});
-    auto prefixDbStr = writeThriftObjStr(std::move(prefixDb), serializer_);
-
-    // advertise key to `KvStore`
-    auto persistPrefixKeyVal =
-        PersistKeyValueRequest(AreaId{toArea}, prefixKeyStr, prefixDbStr);
-    kvRequestQueue_.push(std::move(persistPrefixKeyVal));
+    if (numPrefixKeyShards_ > 0) {
+      // advertised along with the rest of its shard
+      const auto shardId = getPrefixShardId(entry.network);
+      prefixShards_[toArea][shardId][entry.network] = *postPolicyTPrefixEntry;
+      changedPrefixShards_[toArea].emplace(shardId);
+    } else {
+      const auto prefixKeyStr =
+          PrefixKey(nodeId_, entry.network, toArea).getPrefixKeyV2();
+      auto prefixDb = createPrefixDb(nodeId_, {*postPolicyTPrefixEntry});
+      auto prefixDbStr = writeThriftObjStr(std::move(prefixDb), serializer_);
+
+      // advertise key to `KvStore`
+      addKvStoreRequest(
+          PersistKeyValueRequest(AreaId{toArea}, prefixKeyStr, prefixDbStr));
+    }
 
     fb303::fbData->addStatValue(
         "prefix_manager.route_advertisements", 1, fb303::SUM);
@@ -582,18 +663,31 @@ PrefixManager::deleteKvStoreKeyHelper(
   deletedPrefixDb.deletePrefix_ref() = true;
 
   for (const auto& area : deletedArea) {
+    if (numPrefixKeyShards_ > 0) {
+      // withdrawn along with the update of its shard
+      const auto shardId = getPrefixShardId(prefix);
+      prefixShards_[area][shardId].erase(prefix);
+      changedPrefixShards_[area].emplace(shardId);
+
+      XLOG(DBG1) << "[Prefix Withdraw] "
+                 << "Area: " << area << ", "
+                 << folly::IPAddress::networkToString(prefix);
+      fb303::fbData->addStatValue(
+          "prefix_manager.route_withdraws", 1, fb303::SUM);
+      continue;
+    }
+
     const auto prefixKeyStr = PrefixKey(nodeId_, prefix, area).getPrefixKeyV2();
     thrift::PrefixEntry entry;
     entry.prefix_ref() = toIpPrefix(prefix);
     deletedPrefixDb.prefixEntries_ref() = {entry};
 
     // Remove prefix from KvStore and flood deletion by setting deleted value.
-    auto unsetPrefixRequest = ClearKeyValueRequest(
+    addKvStoreRequest(ClearKeyValueRequest(
         AreaId{area},
         prefixKeyStr,
         writeThriftObjStr(std::move(deletedPrefixDb), serializer_),
-        true);
-    kvRequestQueue_.push(std::move(unsetPrefixRequest));
+        true));
 
     XLOG(DBG1) << "[Prefix Withdraw] "
                << "Area: " << area << ", " << toString(*entry.prefix_ref());
@@ -602,6 +696,77 @@ PrefixManager::deleteKvStoreKeyHelper(
   }
 }
 
+uint32_t
+PrefixManager::getPrefixShardId(const folly::CIDRNetwork& prefix) const {
+  // ATTN: must be stable across restarts to override shard keys of previous
+  //       incarnation
+  return folly::hash::hash_combine(prefix.first.hash(), prefix.second) %
+      numPrefixKeyShards_;
+}
+
+void
+PrefixManager::syncPrefixShardsInKvStore() {
+  for (const auto& [area, shardIds] : changedPrefixShards_) {
+    auto& areaShards = prefixShards_[area];
+    for (const auto shardId : shardIds) {
+      const auto prefixKeyStr = PrefixKey::getPrefixShardKey(nodeId_, shardId);
+      auto shardIt = areaShards.find(shardId);
+      if (shardIt == areaShards.end() or shardIt->second.empty()) {
+        // Remove shard from KvStore and flood deletion by setting deleted
+        // value without any prefix entry.
+        thrift::PrefixDatabase deletedPrefixDb;
+        deletedPrefixDb.thisNodeName_ref() = nodeId_;
+        deletedPrefixDb.deletePrefix_ref() = true;
+        addKvStoreRequest(ClearKeyValueRequest(
+            AreaId{area},
+            prefixKeyStr,
+            writeThriftObjStr(std::move(deletedPrefixDb), serializer_),
+            true));
+        if (shardIt != areaShards.end()) {
+          areaShards.erase(shardIt);
+        }
+        continue;
+      }
+
+      std::vector<thrift::PrefixEntry> entries;
+      entries.reserve(shardIt->second.size());
+      for (const auto& [_, entry] : shardIt->second) {
+        entries.emplace_back(entry);
+      }
+      auto prefixDb = createPrefixDb(nodeId_, std::move(entries));
+      addKvStoreRequest(PersistKeyValueRequest(
+          AreaId{area},
+          prefixKeyStr,
+          writeThriftObjStr(std::move(prefixDb), serializer_)));
+    }
+    fb303::fbData->addStatValue(
+        "prefix_manager.prefix_shard_advertisements",
+        shardIds.size(),
+        fb303::SUM);
+  }
+  changedPrefixShards_.clear();
+}
+
+void
+PrefixManager::addKvStoreRequest(BatchKeyValueRequest::Request&& request) {
+  const auto area = std::visit(
+      [](auto&& request) -> AreaId { return request.getArea(); }, request);
+  auto [it, _] = pendingKvStoreRequests_.try_emplace(area.t, area);
+  it->second.addRequest(std::move(request));
+}
+
+void
+PrefixManager::flushKvStoreRequests() {
+  for (auto& [_, batchRequest] : pendingKvStoreRequests_) {
+    fb303::fbData->addStatValue(
+        "prefix_manager.kvstore_requests",
+        batchRequest.getRequests().size(),
+        fb303::SUM);
+    kvRequestQueue_.push(std::move(batchRequest));
+  }
+  pendingKvStoreRequests_.clear();
+}
+
 void
 PrefixManager::triggerInitialPrefixDbSync() {
   if (not config_->isInitializationProcessEnabled()) {
@@ -653,8 +818,7 @@ namespace {
 
 std::pair<thrift::PrefixType, const PrefixEntry>
 getBestPrefixEntry(
-    const std::unordered_map<thrift::PrefixType, PrefixEntry>&
-        prefixTypeToEntry,
+    const PrefixTypeToEntry& prefixTypeToEntry,
     bool preferOpenrOriginatedRoutes) {
   // select the best entry/entries by comparing metric_ref() field
   const auto bestTypes = selectBestPrefixMetrics(prefixTypeToEntry);
@@ -670,29 +834,61 @@ getBestPrefixEntry(
 
 } // namespace
 
+void
+PrefixManager::scheduleSyncKvStore() {
+  if (syncThrottleTuner_) {
+    syncThrottleTuner_->recordChange();
+    // Pick throttle of the next sync, kept until the sync runs
+    if (not syncKvStoreThrottled_->isActive()) {
+      const auto throttle =
+          syncThrottleTuner_->getThrottle(pendingUpdates_.size());
+      syncKvStoreThrottled_->setTimeout(throttle);
+      fb303::fbData->setCounter(
+          "prefix_manager.sync_throttle_ms", throttle.count());
+      fb303::fbData->setCounter(
+          "prefix_manager.sync_change_interval_ms",
+          static_cast<int64_t>(syncThrottleTuner_->getChangeIntervalMs()));
+    }
+  }
+  syncKvStoreThrottled_->operator()();
+}
+
 void
 PrefixManager::syncKvStore() {
   XLOG(DBG1) << "[KvStore Sync] Syncing " << pendingUpdates_.size()
              << " pending updates.";
+  fb303::fbData->addStatValue(
+      "prefix_manager.sync_batch_size", pendingUpdates_.size(), fb303::AVG);
   DecisionRouteUpdate routeUpdatesForDecision;
   DecisionRouteUpdate routeUpdatesForBgp;
-  size_t receivedPrefixCnt = 0;
   size_t syncedPrefixCnt = 0;
-  size_t awaitingPrefixCnt = 0;
+  // prefixes to advertise, after running their area policies in batch
+  std::vector<folly::CIDRNetwork> prefixesToAdvertise;
+
+  // ATTN: advertisement of a prefix only changes along with its entries or
+  //       FIB programming of it or its prepend label, all of which are
+  //       recorded in `pendingUpdates_`. Visit these prefixes only, so that
+  //       sync cost doesn't grow with size of `prefixMap_`.
+  auto prefixesToSync = pendingUpdates_.getChangedPrefixes();
+  for (const auto label : pendingUpdates_.getChangedLabels()) {
+    auto labelIt = labelToPrefixes_.find(label);
+    if (labelIt != labelToPrefixes_.end()) {
+      prefixesToSync.insert(labelIt->second.begin(), labelIt->second.end());
+    }
+  }
 
-  // Withdraw prefixes that no longer exist.
-  for (auto const& prefix : pendingUpdates_.getChangedPrefixes()) {
-    auto it = prefixMap_.find(prefix);
-    if (it == prefixMap_.end()) {
-      // Delete prefixes that do not exist in prefixMap_.
+  for (const auto& prefix : prefixesToSync) {
+    auto prefixIt = prefixMap_.find(prefix);
+    if (prefixIt == prefixMap_.end()) {
+      // Withdraw prefixes that no longer exist.
       deletePrefixKeysInKvStore(prefix, routeUpdatesForDecision);
       advertisedPrefixEntries_.erase(prefix);
+      awaitingPrefixes_.erase(prefix);
+      invalidatePolicyCache(prefix);
       ++syncedPrefixCnt;
+      continue;
     }
-  }
-
-  for (const auto& [prefix, prefixEntries] : prefixMap_) {
-    receivedPrefixCnt += prefixEntries.size();
+    const auto& prefixEntries = prefixIt->second;
 
     // Check if prefix is updated and ready to be advertised.
     auto [_, bestEntry] =
@@ -710,11 +906,9 @@ PrefixManager::syncKvStore() {
           prefix, bestEntry, routeUpdatesForDecision, routeUpdatesForBgp);
     }
     if (needToAdvertise) {
-      XLOG(DBG1) << fmt::format(
-          "Adding/updating keys for {}",
-          folly::IPAddress::networkToString(prefix));
-      updatePrefixKeysInKvStore(prefix, bestEntry);
+      prefixesToAdvertise.emplace_back(prefix);
       advertisedPrefixEntries_[prefix] = bestEntry;
+      awaitingPrefixes_.erase(prefix);
       ++syncedPrefixCnt;
       continue;
     } else if (readyToBeAdvertised) {
@@ -724,7 +918,7 @@ PrefixManager::syncKvStore() {
     }
 
     // The prefix is awaiting to be advertised.
-    ++awaitingPrefixCnt;
+    awaitingPrefixes_.emplace(prefix);
 
     // Check if previously advertised prefix is no longer ready to be
     // advertised.
@@ -740,9 +934,29 @@ PrefixManager::syncKvStore() {
     }
   } // for
 
+  if (policyManager_) {
+    std::vector<std::pair<std::string, const PrefixEntry*>> toApply;
+    for (const auto& prefix : prefixesToAdvertise) {
+      collectAreaPolicies(advertisedPrefixEntries_.at(prefix), toApply);
+    }
+    applyPoliciesInBatch(toApply);
+  }
+  for (const auto& prefix : prefixesToAdvertise) {
+    XLOG(DBG1) << fmt::format(
+        "Adding/updating keys for {}",
+        folly::IPAddress::networkToString(prefix));
+    updatePrefixKeysInKvStore(prefix, advertisedPrefixEntries_.at(prefix));
+  }
+
   // Reset pendingUpdates_ since all pending updates are processed.
   pendingUpdates_.clear();
 
+  // Advertise updated shards at once, if prefix keys are sharded.
+  syncPrefixShardsInKvStore();
+
+  // Send key updates of each area to KvStore in one batch
+  flushKvStoreRequests();
+
   // Push originatedRoutes update to staticRouteUpdatesQueue_.
   if (not routeUpdatesForDecision.empty()) {
     CHECK(routeUpdatesForDecision.mplsRoutesToUpdate.empty());
@@ -762,17 +976,41 @@ PrefixManager::syncKvStore() {
   XLOG(DBG1) << fmt::format(
       "[KvStore Sync] Updated {} prefixes in KvStore; {} more awaiting FIB-ACK.",
       syncedPrefixCnt,
-      awaitingPrefixCnt);
+      awaitingPrefixes_.size());
 
   // Update flat counters
   fb303::fbData->setCounter(
-      "prefix_manager.received_prefixes", receivedPrefixCnt);
+      "prefix_manager.received_prefixes", numPrefixEntries_);
   // TODO: report per-area advertised prefixes if openr is running in
   // multi-areas.
   fb303::fbData->setCounter(
       "prefix_manager.advertised_prefixes", advertisedPrefixEntries_.size());
   fb303::fbData->setCounter(
-      "prefix_manager.awaiting_prefixes", awaitingPrefixCnt);
+      "prefix_manager.awaiting_prefixes", awaitingPrefixes_.size());
+}
+
+void
+PrefixManager::addPrefixEntryIndex(const PrefixEntry& entry) {
+  ++numPrefixEntries_;
+  if (auto labelRef = entry.tPrefixEntry->prependLabel_ref()) {
+    labelToPrefixes_[*labelRef].emplace(entry.network);
+  }
+}
+
+void
+PrefixManager::removePrefixEntryIndex(const PrefixEntry& entry) {
+  --numPrefixEntries_;
+  auto labelRef = entry.tPrefixEntry->prependLabel_ref();
+  if (not labelRef.has_value()) {
+    return;
+  }
+  auto labelIt = labelToPrefixes_.find(*labelRef);
+  CHECK(labelIt != labelToPrefixes_.end());
+  // remove one instance only, other entries of prefix may have same label
+  labelIt->second.erase(labelIt->second.find(entry.network));
+  if (labelIt->second.empty()) {
+    labelToPrefixes_.erase(labelIt);
+  }
 }
 
 folly::SemiFuture<bool>
@@ -827,6 +1065,70 @@ PrefixManager::syncPrefixesByType(
   return sf;
 }
 
+folly::SemiFuture<bool>
+PrefixManager::syncPrefixesByTypeChunk(
+    thrift::PrefixType prefixType, std::vector<thrift::PrefixEntry> prefixes) {
+  folly::Promise<bool> p;
+  auto sf = p.getSemiFuture();
+  runInEventBaseThread([this,
+                        p = std::move(p),
+                        prefixType = std::move(prefixType),
+                        prefixes = std::move(prefixes)]() mutable noexcept {
+    auto& receivedPrefixes = chunkedPrefixSyncs_[prefixType];
+    for (auto const& entry : prefixes) {
+      CHECK(prefixType == *entry.type_ref());
+      receivedPrefixes.emplace(toIPNetwork(*entry.prefix_ref()));
+    }
+    auto dstAreas = allAreaIds();
+    p.setValue(advertisePrefixesImpl(std::move(prefixes), dstAreas));
+  });
+  return sf;
+}
+
+folly::SemiFuture<bool>
+PrefixManager::commitSyncPrefixesByType(thrift::PrefixType prefixType) {
+  folly::Promise<bool> p;
+  auto sf = p.getSemiFuture();
+  runInEventBaseThread([this,
+                        p = std::move(p),
+                        prefixType = std::move(prefixType)]() mutable noexcept {
+    // ATTN: sync without any chunk withdraws all prefixes of the type, as
+    //       syncPrefixesByType() with empty prefixes does
+    auto receivedPrefixes = std::move(chunkedPrefixSyncs_[prefixType]);
+    chunkedPrefixSyncs_.erase(prefixType);
+
+    std::vector<thrift::PrefixEntry> toRemove;
+    for (auto const& [prefix, typeToPrefixes] : prefixMap_) {
+      auto it = typeToPrefixes.find(prefixType);
+      if (it != typeToPrefixes.end() and not receivedPrefixes.count(prefix)) {
+        toRemove.emplace_back(*it->second.tPrefixEntry);
+      }
+    }
+    XLOG(INFO) << fmt::format(
+        "Committed chunked sync of {} prefixes of type {}, withdrawing {}",
+        receivedPrefixes.size(),
+        toString(prefixType),
+        toRemove.size());
+    p.setValue(withdrawPrefixesImpl(toRemove));
+  });
+  return sf;
+}
+
+folly::SemiFuture<folly::Unit>
+PrefixManager::abortSyncPrefixesByType(thrift::PrefixType prefixType) {
+  folly::Promise<folly::Unit> p;
+  auto sf = p.getSemiFuture();
+  runInEventBaseThread([this,
+                        p = std::move(p),
+                        prefixType = std::move(prefixType)]() mutable noexcept {
+    XLOG(WARNING) << "Aborted chunked sync of prefixes of type "
+                  << toString(prefixType);
+    chunkedPrefixSyncs_.erase(prefixType);
+    p.setValue();
+  });
+  return sf;
+}
+
 folly::SemiFuture<std::unique_ptr<std::vector<thrift::PrefixEntry>>>
 PrefixManager::getPrefixes() {
   folly::Promise<std::unique_ptr<std::vector<thrift::PrefixEntry>>> p;
@@ -943,6 +1245,7 @@ PrefixManager::removeOriginatedPrefixes(
     // clean up data structure
     if (typeIt->second.empty()) {
       originatedPrefixMap_.erase(prefixCidr);
+      invalidatePolicyCache(prefixCidr);
     }
   }
 }
@@ -962,6 +1265,7 @@ PrefixManager::removeOriginatedPrefixes(
     // clean up data structure
     if (typeIt->second.empty()) {
       originatedPrefixMap_.erase(prefixCidr);
+      invalidatePolicyCache(prefixCidr);
     }
   }
 }
@@ -1009,11 +1313,8 @@ PrefixManager::filterAndAddOriginatedRoute(
       continue;
     }
 
-    auto [postPolicyTPrefixEntry, hitPolicyName] = policyManager_->applyPolicy(
-        policy,
-        prePolicyTPrefixEntry,
-        std::nullopt /* policy Action Data */,
-        prePolicyPrefixEntry.policyMatchData);
+    auto [postPolicyTPrefixEntry, hitPolicyName] = applyPolicyMemoized(
+        policy, prePolicyPrefixEntry, std::nullopt /* policy Action Data */);
     if (routeFilterType == thrift::RouteFilterType::POSTFILTER_ADVERTISED and
         postPolicyTPrefixEntry) {
       // add post filter advertised route
@@ -1109,12 +1410,26 @@ PrefixManager::getOriginatedPrefixes() {
   return sf;
 }
 
+folly::SemiFuture<folly::Unit>
+PrefixManager::updateOriginatedPrefixes(
+    std::vector<thrift::OriginatedPrefix> prefixes) {
+  folly::Promise<folly::Unit> p;
+  auto sf = p.getSemiFuture();
+  runInEventBaseThread([this,
+                        p = std::move(p),
+                        prefixes = std::move(prefixes)]() mutable noexcept {
+    updateOriginatedPrefixesImpl(prefixes);
+    p.setValue();
+  });
+  return sf;
+}
+
 void
 PrefixManager::filterAndAddAdvertisedRoute(
     std::vector<thrift::AdvertisedRouteDetail>& routes,
     apache::thrift::optional_field_ref<thrift::PrefixType&> const& typeFilter,
     folly::CIDRNetwork const& prefix,
-    std::unordered_map<thrift::PrefixType, PrefixEntry> const& prefixEntries) {
+    PrefixTypeToEntry const& prefixEntries) {
   // Return immediately if no prefix-entry
   if (prefixEntries.empty()) {
     return;
@@ -1152,7 +1467,7 @@ PrefixManager::filterAndAddAreaRoute(
     std::vector<thrift::AdvertisedRoute>& routes,
     const std::string& area,
     const thrift::RouteFilterType& routeFilterType,
-    std::unordered_map<thrift::PrefixType, PrefixEntry> const& prefixEntries,
+    PrefixTypeToEntry const& prefixEntries,
     apache::thrift::optional_field_ref<thrift::PrefixType&> const& typeFilter) {
   // Return immediately if no prefix-entry
   if (prefixEntries.empty()) {
@@ -1165,7 +1480,7 @@ PrefixManager::filterAndAddAreaRoute(
   const auto& bestPrefixEntry = bestTypeEntry.second;
 
   // The prefix will not be advertised to user provided area
-  if (not bestPrefixEntry.dstAreas.count(area)) {
+  if (not bestPrefixEntry.dstAreas->count(area)) {
     return;
   }
   // return if type does not match
@@ -1191,12 +1506,8 @@ PrefixManager::filterAndAddAreaRoute(
 
   const auto& policy = areaToPolicy_.at(area);
   if (policy) {
-    std::tie(postPolicyTPrefixEntry, hitPolicyName) =
-        policyManager_->applyPolicy(
-            *policy,
-            prePolicyTPrefixEntry,
-            std::nullopt /* policy Action Data */,
-            bestPrefixEntry.policyMatchData);
+    std::tie(postPolicyTPrefixEntry, hitPolicyName) = applyPolicyMemoized(
+        *policy, bestPrefixEntry, std::nullopt /* policy Action Data */);
   } else {
     postPolicyTPrefixEntry = prePolicyTPrefixEntry;
   }
@@ -1221,29 +1532,134 @@ PrefixManager::filterAndAddAreaRoute(
   }
 }
 
+std::pair<std::shared_ptr<thrift::PrefixEntry>, std::string>
+PrefixManager::applyPolicyMemoized(
+    const std::string& policyName,
+    const PrefixEntry& prefixEntry,
+    const std::optional<OpenrPolicyActionData>& policyActionData) {
+  const auto& tPrefixEntry = prefixEntry.tPrefixEntry;
+  auto& result = policyCache_[policyName][prefixEntry.network]
+                             [*tPrefixEntry->type_ref()];
+
+  if (result.isValidFor(prefixEntry, policyActionData)) {
+    fb303::fbData->addStatValue(
+        "prefix_manager.policy_cache.hit", 1, fb303::SUM);
+    return {result.postPolicyTPrefixEntry, result.hitPolicyName};
+  }
+
+  fb303::fbData->addStatValue(
+      "prefix_manager.policy_cache.miss", 1, fb303::SUM);
+  std::tie(result.postPolicyTPrefixEntry, result.hitPolicyName) =
+      policyManager_->applyPolicy(
+          policyName,
+          tPrefixEntry,
+          policyActionData,
+          prefixEntry.policyMatchData);
+  result.prePolicyTPrefixEntry = tPrefixEntry;
+  result.policyActionData = policyActionData;
+  result.policyMatchData = prefixEntry.policyMatchData;
+  return {result.postPolicyTPrefixEntry, result.hitPolicyName};
+}
+
+void
+PrefixManager::invalidatePolicyCache(const folly::CIDRNetwork& prefix) {
+  for (auto& [_, prefixToResults] : policyCache_) {
+    prefixToResults.erase(prefix);
+  }
+}
+
+void
+PrefixManager::applyPoliciesInBatch(
+    const std::vector<std::pair<std::string, const PrefixEntry*>>& toApply) {
+  // results to compute, grouped by policy. Same result may be wanted by
+  // several areas sharing a policy, compute it once.
+  std::unordered_map<
+      std::string,
+      std::vector<std::pair<PolicyResult*, const PrefixEntry*>>>
+      policyToMisses;
+  std::unordered_set<PolicyResult*> visited;
+  for (const auto& [policyName, prefixEntry] : toApply) {
+    auto& result = policyCache_[policyName][prefixEntry->network]
+                               [*prefixEntry->tPrefixEntry->type_ref()];
+    if (visited.emplace(&result).second and
+        not result.isValidFor(*prefixEntry, prefixEntry->policyActionData)) {
+      policyToMisses[policyName].emplace_back(&result, prefixEntry);
+    }
+  }
+
+  for (auto& [policyName, misses] : policyToMisses) {
+    std::vector<PolicyManager::PolicyInput> inputs;
+    inputs.reserve(misses.size());
+    for (const auto& [_, prefixEntry] : misses) {
+      inputs.push_back(
+          {prefixEntry->tPrefixEntry,
+           prefixEntry->policyActionData,
+           prefixEntry->policyMatchData});
+    }
+    auto outputs = policyManager_->applyPolicyBatch(
+        policyName, inputs, policyExecutor_.get());
+
+    // ATTN: cache is only touched on PrefixManager thread
+    for (size_t i = 0; i < misses.size(); ++i) {
+      auto& [result, prefixEntry] = misses[i];
+      std::tie(result->postPolicyTPrefixEntry, result->hitPolicyName) =
+          std::move(outputs[i]);
+      result->prePolicyTPrefixEntry = prefixEntry->tPrefixEntry;
+      result->policyActionData = prefixEntry->policyActionData;
+      result->policyMatchData = prefixEntry->policyMatchData;
+    }
+    fb303::fbData->addStatValue(
+        "prefix_manager.policy_cache.miss", misses.size(), fb303::SUM);
+    fb303::fbData->addStatValue(
+        "prefix_manager.policy_batch_size", misses.size(), fb303::AVG);
+  }
+}
+
+void
+PrefixManager::collectAreaPolicies(
+    const PrefixEntry& prefixEntry,
+    std::vector<std::pair<std::string, const PrefixEntry*>>& toApply) const {
+  const auto& areaStack = *prefixEntry.tPrefixEntry->area_stack_ref();
+  for (const auto& toArea : *prefixEntry.dstAreas) {
+    // same area_stack loop prevention as addKvStoreKeyHelper()
+    if (std::find(areaStack.begin(), areaStack.end(), toArea) !=
+        areaStack.end()) {
+      continue;
+    }
+    if (const auto& policy = areaToPolicy_.at(toArea)) {
+      toApply.emplace_back(*policy, &prefixEntry);
+    }
+  }
+}
+
 std::vector<PrefixEntry>
 PrefixManager::applyOriginationPolicy(
     const std::vector<PrefixEntry>& prefixEntries,
     const std::string& policyName) {
   // Store them before applying origination policy for future debugging purpose
   storeOriginatedPrefixes(prefixEntries, policyName);
+
+  std::vector<std::pair<std::string, const PrefixEntry*>> toApply;
+  toApply.reserve(prefixEntries.size());
+  for (const auto& prefixEntry : prefixEntries) {
+    toApply.emplace_back(policyName, &prefixEntry);
+  }
+  applyPoliciesInBatch(toApply);
+
   std::vector<PrefixEntry> postOriginationPrefixes = {};
   for (auto prefix : prefixEntries) {
-    auto [postPolicyTPrefixEntry, _] = policyManager_->applyPolicy(
-        policyName,
-        prefix.tPrefixEntry,
-        prefix.policyActionData,
-        prefix.policyMatchData);
+    auto [postPolicyTPrefixEntry, _] =
+        applyPolicyMemoized(policyName, prefix, prefix.policyActionData);
     if (postPolicyTPrefixEntry) {
       XLOG(DBG1) << fmt::format(
           "Prefixes {} : accepted/modified by origination policy {}",
           folly::IPAddress::networkToString(prefix.network),
           policyName);
-      auto dstAreasCp = prefix.dstAreas;
       postOriginationPrefixes.emplace_back(
           std::move(postPolicyTPrefixEntry),
-          std::move(dstAreasCp),
+          std::unordered_set<std::string>{},
           std::move(prefix.nexthops));
+      postOriginationPrefixes.back().dstAreas = prefix.dstAreas;
     } else {
       XLOG(DBG1) << fmt::format(
           "Not processing prefixes {} : denied by origination policy {}",
@@ -1281,10 +1697,11 @@ PrefixManager::advertisePrefixesImpl(
     return false;
   }
 
+  const auto sharedDstAreas =
+      std::make_shared<const std::unordered_set<std::string>>(dstAreas);
   std::vector<PrefixEntry> toAddOrUpdate;
   for (auto& prefixEntry : prefixEntries) {
-    auto dstAreasCp = dstAreas;
-    prefixEntry.dstAreas = std::move(dstAreasCp);
+    prefixEntry.dstAreas = sharedDstAreas;
 
     // Create PrefixEntry and set unicastRotues
     toAddOrUpdate.push_back(std::move(prefixEntry));
@@ -1317,16 +1734,20 @@ PrefixManager::advertisePrefixesImpl(
         continue;
       }
       // Case 2: update existing `PrefixEntry`
+      removePrefixEntryIndex(it->second);
       it->second = entry;
     }
+    it->second.dstAreas = internAreas(entry.dstAreas);
+    addPrefixEntryIndex(entry);
     // Case 3: store pendingUpdate for batch processing
     pendingUpdates_.addPrefixChange(prefixCidr);
     updated = true;
   }
 
   if (updated) {
+    prefixMapVersion_.fetch_add(1, std::memory_order_release);
     // schedule `syncKvStore` after throttled timeout
-    syncKvStoreThrottled_->operator()();
+    scheduleSyncKvStore();
   }
 
   return updated;
@@ -1349,9 +1770,15 @@ PrefixManager::withdrawPrefixesImpl(
 
     // iterator usage to avoid multiple times of map access
     auto typeIt = prefixMap_.find(prefixCidr);
+    if (typeIt == prefixMap_.end()) {
+      continue;
+    }
 
     // ONLY populate changed collection when successfully erased key
-    if (typeIt != prefixMap_.end() and typeIt->second.erase(type)) {
+    auto entryIt = typeIt->second.find(type);
+    if (entryIt != typeIt->second.end()) {
+      removePrefixEntryIndex(entryIt->second);
+      typeIt->second.erase(entryIt);
       updated = true;
       // store pendingUpdate for batch processing
       pendingUpdates_.addPrefixChange(prefixCidr);
@@ -1363,8 +1790,9 @@ PrefixManager::withdrawPrefixesImpl(
   }
 
   if (updated) {
+    prefixMapVersion_.fetch_add(1, std::memory_order_release);
     // schedule `syncKvStore` after throttled timeout
-    syncKvStoreThrottled_->operator()();
+    scheduleSyncKvStore();
   }
 
   return updated;
@@ -1386,9 +1814,15 @@ PrefixManager::withdrawPrefixEntriesImpl(
 
     // iterator usage to avoid multiple times of map access
     auto typeIt = prefixMap_.find(prefixEntry.network);
+    if (typeIt == prefixMap_.end()) {
+      continue;
+    }
 
     // ONLY populate changed collection when successfully erased key
-    if (typeIt != prefixMap_.end() and typeIt->second.erase(type)) {
+    auto entryIt = typeIt->second.find(type);
+    if (entryIt != typeIt->second.end()) {
+      removePrefixEntryIndex(entryIt->second);
+      typeIt->second.erase(entryIt);
       updated = true;
       // store pendingUpdate for batch processing
       pendingUpdates_.addPrefixChange(prefixEntry.network);
@@ -1400,8 +1834,9 @@ PrefixManager::withdrawPrefixEntriesImpl(
   }
 
   if (updated) {
+    prefixMapVersion_.fetch_add(1, std::memory_order_release);
     // schedule `syncKvStore` after throttled timeout
-    syncKvStoreThrottled_->operator()();
+    scheduleSyncKvStore();
   }
 
   return updated;
@@ -1440,6 +1875,26 @@ PrefixManager::syncPrefixesByTypeImpl(
   return updated;
 }
 
+std::shared_ptr<const std::unordered_set<std::string>>
+PrefixManager::internAreas(
+    std::shared_ptr<const std::unordered_set<std::string>> areas) {
+  CHECK(areas);
+  // ATTN: there are only a handful of distinct area sets, scan them linearly
+  //       and drop the ones no longer referenced by any entry on the way.
+  for (auto it = internedAreas_.begin(); it != internedAreas_.end();) {
+    if (*it == areas or **it == *areas) {
+      return *it;
+    }
+    if (it->use_count() == 1) {
+      it = internedAreas_.erase(it);
+      continue;
+    }
+    ++it;
+  }
+  internedAreas_.emplace_back(areas);
+  return areas;
+}
+
 bool
 PrefixManager::withdrawPrefixesByTypeImpl(thrift::PrefixType type) {
   std::vector<thrift::PrefixEntry> toRemove;
@@ -1463,12 +1918,10 @@ PrefixManager::aggregatesToAdvertise(const folly::CIDRNetwork& prefix) {
     return;
   }
 
-  for (auto& [network, route] : originatedPrefixDb_) {
-    // folly::CIDRNetwork.first -> IPAddress
-    // folly::CIDRNetwork.second -> cidr length
-    if (not prefix.first.inSubnet(network.first, network.second)) {
-      continue;
-    }
+  // only originated prefixes containing the FIB prefix address are visited
+  for (auto* entry : originatedPrefixTrie_.findCovering(prefix.first)) {
+    auto& [network, routePtr] = *entry;
+    auto& route = *routePtr;
 
     XLOG(DBG1) << "[Route Origination] Adding supporting route "
                << folly::IPAddress::networkToString(prefix)
@@ -1562,6 +2015,113 @@ PrefixManager::processOriginatedPrefixes() {
   }
 }
 
+void
+PrefixManager::updateOriginatedPrefixesImpl(
+    const std::vector<thrift::OriginatedPrefix>& prefixes) {
+  std::unordered_map<folly::CIDRNetwork, const thrift::OriginatedPrefix*>
+      newPrefixes;
+  for (const auto& prefix : prefixes) {
+    newPrefixes.emplace(
+        folly::IPAddress::createNetwork(*prefix.prefix_ref()), &prefix);
+  }
+
+  std::vector<thrift::PrefixEntry> withdrawnPrefixes{};
+  DecisionRouteUpdate routeUpdatesForDecision;
+  routeUpdatesForDecision.prefixType = thrift::PrefixType::CONFIG;
+  // advertise state of changed prefixes, which get rebuilt below
+  std::unordered_map<folly::CIDRNetwork, bool> changedPrefixes;
+
+  // Step1: drop removed and changed prefixes
+  for (auto it = originatedPrefixDb_.begin();
+       it != originatedPrefixDb_.end();) {
+    const auto network = it->first;
+    auto& route = it->second;
+    auto newIt = newPrefixes.find(network);
+    if (newIt != newPrefixes.end() and
+        *newIt->second == route.originatedPrefix) {
+      newPrefixes.erase(newIt);
+      ++it;
+      continue;
+    }
+
+    const bool removed = newIt == newPrefixes.end();
+    if (not removed) {
+      changedPrefixes.emplace(network, route.isAdvertised);
+    }
+    if (route.isAdvertised) {
+      if (removed) {
+        XLOG(INFO) << "[Route Origination] Withdrawing removed originated "
+                   << "route " << folly::IPAddress::networkToString(network);
+        withdrawnPrefixes.emplace_back(createPrefixEntry(
+            toIpPrefix(network), thrift::PrefixType::CONFIG));
+      }
+    } else if (
+        (removed or not newIt->second->install_to_fib_ref().value_or(false)) and
+        advertiseStatus_.count(network) > 0 and
+        advertiseStatus_[network].publishedRoute.has_value()) {
+      // static route published upon initialization is no longer wanted
+      routeUpdatesForDecision.unicastRoutesToDelete.emplace_back(network);
+      advertiseStatus_[network].publishedRoute.reset();
+    }
+
+    // clean reverse mapping: RIB prefixEntry -> OriginatedPrefixes
+    for (const auto& ribPrefix : route.supportingRoutes) {
+      auto ribPrefixIt = ribPrefixDb_.find(ribPrefix);
+      if (ribPrefixIt != ribPrefixDb_.end()) {
+        auto& networks = ribPrefixIt->second;
+        networks.erase(
+            std::remove(networks.begin(), networks.end(), network),
+            networks.end());
+      }
+    }
+    originatedPrefixTrie_.erase(network);
+    it = originatedPrefixDb_.erase(it);
+  }
+
+  // Step2: build new and changed prefixes along with their supporting routes
+  for (const auto& [network, prefix] : newPrefixes) {
+    RibUnicastEntry unicastEntry(network, {});
+    unicastEntry.bestPrefixEntry =
+        toPrefixEntryThrift(*prefix, thrift::PrefixType::CONFIG);
+    auto [it, _] = originatedPrefixDb_.emplace(
+        network,
+        OriginatedRoute(
+            *prefix,
+            std::move(unicastEntry),
+            std::unordered_set<folly::CIDRNetwork>{}));
+    auto& route = it->second;
+    originatedPrefixTrie_.insert(network, &route);
+
+    for (auto& [ribPrefix, networks] : ribPrefixDb_) {
+      if (ribPrefix.first.inSubnet(network.first, network.second)) {
+        networks.emplace_back(network);
+        route.supportingRoutes.emplace(ribPrefix);
+      }
+    }
+
+    // ATTN: changed prefix still having enough supporting routes is marked
+    //       as NOT advertised so that it's re-advertised with new attributes.
+    //       Otherwise it keeps its state, for withdrawal if advertised.
+    auto changedIt = changedPrefixes.find(network);
+    if (changedIt != changedPrefixes.end()) {
+      route.isAdvertised =
+          changedIt->second and (not route.supportingRoutesFulfilled());
+    }
+    XLOG(INFO) << "[Route Origination] "
+               << (changedIt != changedPrefixes.end() ? "Updated" : "Added")
+               << " originated route "
+               << folly::IPAddress::networkToString(network);
+  }
+
+  withdrawPrefixesImpl(withdrawnPrefixes);
+  if (not routeUpdatesForDecision.empty()) {
+    staticRouteUpdatesQueue_.push(std::move(routeUpdatesForDecision));
+  }
+
+  // Step3: advertise/withdraw based on supporting routes
+  processOriginatedPrefixes();
+}
+
 void
 PrefixManager::processFibRouteUpdates(DecisionRouteUpdate&& fibRouteUpdate) {
   // Forward fib update to bgprib for route announcement.
@@ -1634,7 +2194,7 @@ PrefixManager::storeProgrammedRoutes(
   }
 
   // schedule `syncKvStore` after throttled timeout
-  syncKvStoreThrottled_->operator()();
+  scheduleSyncKvStore();
 }
 
 namespace {
@@ -1661,16 +2221,61 @@ PrefixManager::redistributePrefixesAcrossAreas(
       fibRouteUpdate.unicastRoutesToUpdate.size(),
       fibRouteUpdate.unicastRoutesToDelete.size());
 
+  // Coalesce with routes not redistributed yet, latest route of a prefix wins
+  for (auto& [prefix, route] : fibRouteUpdate.unicastRoutesToUpdate) {
+    pendingRedistributions_.insert_or_assign(prefix, std::move(route));
+  }
+  for (const auto& prefix : fibRouteUpdate.unicastRoutesToDelete) {
+    pendingRedistributions_.insert_or_assign(prefix, std::nullopt);
+  }
+
+  // ATTN: redistribute all routes at once before initial RIB routes are
+  //       reported, so that they are part of the initial prefix db sync.
+  redistributePendingRoutes(
+      uninitializedPrefixTypes_.count(thrift::PrefixType::RIB)
+          ? pendingRedistributions_.size()
+          : Constants::kMaxRedistributedRoutesPerRun);
+}
+
+void
+PrefixManager::redistributePendingRoutes(size_t maxRoutes) {
   std::vector<PrefixEntry> advertisedPrefixes{};
   std::vector<thrift::PrefixEntry> withdrawnPrefixes{};
+  const auto allAreas = allAreaIds();
+  size_t numRoutes{0};
+  size_t numUnchangedRoutes{0};
 
   // ATTN: Routes imported from local BGP won't show up inside
   // `fibRouteUpdate`. However, local-originated static route
   // (e.g. from route-aggregation) can come along.
+  while (not pendingRedistributions_.empty() and numRoutes < maxRoutes) {
+    auto pendingIt = pendingRedistributions_.begin();
+    const auto prefix = pendingIt->first;
+    auto maybeRoute = std::move(pendingIt->second);
+    pendingRedistributions_.erase(pendingIt);
+    ++numRoutes;
+
+    if (not maybeRoute.has_value()) {
+      // Delete unicast route
+      // TODO: remove this when advertise RibUnicastEntry for routes to delete
+      if (originatedPrefixDb_.count(prefix)) {
+        // skip local-originated prefix as it won't be considered as
+        // part of its own supporting routes.
+        continue;
+      }
 
-  // Add/Update unicast routes
-  for (auto& [prefix, route] : fibRouteUpdate.unicastRoutesToUpdate) {
+      // Routes to be withdrawn via KvStore
+      withdrawnPrefixes.emplace_back(
+          createPrefixEntry(toIpPrefix(prefix), thrift::PrefixType::RIB));
+
+      // adjust supporting route count due to prefix withdrawn
+      aggregatesToWithdraw(prefix);
+      continue;
+    }
+
+    // Add/Update unicast route
     // NOTE: future expansion - run egress policy here
+    auto& route = maybeRoute.value();
 
     //
     // Cross area, modify attributes
@@ -1711,13 +2316,13 @@ PrefixManager::redistributePrefixesAcrossAreas(
     resetNonTransitiveAttrs(prefixEntry);
 
     // Populate routes to be advertised to KvStore
-    auto dstAreas = allAreaIds();
+    auto dstAreas = allAreas;
     for (const auto& nh : route.nexthops) {
       if (nh.area_ref().has_value()) {
         dstAreas.erase(*nh.area_ref());
       }
     }
-    advertisedPrefixes.emplace_back(
+    PrefixEntry entry(
         std::make_shared<thrift::PrefixEntry>(std::move(prefixEntry)),
         std::move(dstAreas),
         policyActionData,
@@ -1725,23 +2330,18 @@ PrefixManager::redistributePrefixesAcrossAreas(
 
     // Adjust supporting route count due to prefix advertisement
     aggregatesToAdvertise(prefix);
-  }
 
-  // Delete unicast routes
-  for (const auto& prefix : fibRouteUpdate.unicastRoutesToDelete) {
-    // TODO: remove this when advertise RibUnicastEntry for routes to delete
-    if (originatedPrefixDb_.count(prefix)) {
-      // skip local-originated prefix as it won't be considered as
-      // part of its own supporting routes.
-      continue;
+    // Skip route whose redistribution outcome, i.e. redistributed entry and
+    // its destination areas, didn't change.
+    auto prefixIt = prefixMap_.find(prefix);
+    if (prefixIt != prefixMap_.end()) {
+      auto typeIt = prefixIt->second.find(thrift::PrefixType::RIB);
+      if (typeIt != prefixIt->second.end() and typeIt->second == entry) {
+        ++numUnchangedRoutes;
+        continue;
+      }
     }
-
-    // Routes to be withdrawn via KvStore
-    withdrawnPrefixes.emplace_back(
-        createPrefixEntry(toIpPrefix(prefix), thrift::PrefixType::RIB));
-
-    // adjust supporting route count due to prefix withdrawn
-    aggregatesToWithdraw(prefix);
+    advertisedPrefixes.emplace_back(std::move(entry));
   }
 
   // Maybe advertise/withdrawn for local originated routes
@@ -1755,6 +2355,25 @@ PrefixManager::redistributePrefixesAcrossAreas(
     withdrawPrefixesImpl(withdrawnPrefixes);
   }
 
+  fb303::fbData->addStatValue(
+      "prefix_manager.redistribution.routes", numRoutes, fb303::SUM);
+  fb303::fbData->addStatValue(
+      "prefix_manager.redistribution.unchanged_routes",
+      numUnchangedRoutes,
+      fb303::SUM);
+  fb303::fbData->setCounter(
+      "prefix_manager.redistribution.pending_routes",
+      pendingRedistributions_.size());
+
+  // Yield to other events, and resume with remaining routes in next loop
+  if (not pendingRedistributions_.empty()) {
+    XLOG(DBG1) << fmt::format(
+        "Redistributed {} routes; {} more pending.",
+        numRoutes,
+        pendingRedistributions_.size());
+    redistributeTimer_->scheduleTimeout(std::chrono::milliseconds(0));
+  }
+
   // ignore mpls updates
 }
 
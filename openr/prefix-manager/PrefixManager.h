@@ -7,12 +7,18 @@
 
 #pragma once
 
+#include <atomic>
+
 #include <folly/IPAddress.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/small_vector.h>
+#include <folly/sorted_vector_types.h>
 #include <folly/futures/Future.h>
 #include <folly/gen/Base.h>
 
 #include <openr/common/AsyncThrottle.h>
 #include <openr/common/OpenrEventBase.h>
+#include <openr/common/PrefixTrie.h>
 #include <openr/common/Types.h>
 #include <openr/common/Util.h>
 #include <openr/config/Config.h>
@@ -46,6 +52,11 @@ class PrefixManagerPendingUpdates {
     return changedPrefixes_;
   }
 
+  const std::unordered_set<int32_t>&
+  getChangedLabels() {
+    return changedLabels_;
+  }
+
   bool
   hasPrefix(const folly::CIDRNetwork& prefix) {
     return changedPrefixes_.count(prefix) > 0;
@@ -76,8 +87,64 @@ class PrefixManagerPendingUpdates {
   std::unordered_set<int32_t> changedLabels_{};
 };
 
+/**
+ * [Adaptive Sync Throttle]
+ *
+ * Pick the window prefix changes are batched for before syncing to KvStore,
+ * within [min, max], out of the moving average of the interval between
+ * changes and the number of changes pending sync:
+ *  - idle, i.e. first change in more than max: sync after min, unless the
+ *    pending set asks for more as below;
+ *  - churn: the window grows as changes come closer together, from min for
+ *    changes max apart up to max for back-to-back changes;
+ *  - large pending set: the window grows with it, reaching max at
+ *    kPendingUpdatesAtMax pending changes;
+ */
+class PrefixSyncThrottleTuner {
+ public:
+  PrefixSyncThrottleTuner(
+      std::chrono::milliseconds minThrottle,
+      std::chrono::milliseconds maxThrottle);
+
+  // record a prefix change requesting KvStore sync
+  void recordChange(
+      std::chrono::steady_clock::time_point now =
+          std::chrono::steady_clock::now());
+
+  // throttle window for the next sync with `numPendingUpdates` pending
+  std::chrono::milliseconds getThrottle(size_t numPendingUpdates) const;
+
+  double
+  getChangeIntervalMs() const {
+    return changeIntervalMs_;
+  }
+
+ private:
+  const std::chrono::milliseconds minThrottle_;
+  const std::chrono::milliseconds maxThrottle_;
+
+  std::optional<std::chrono::steady_clock::time_point> lastChangeTime_;
+
+  // interval between the latest two changes
+  double lastChangeIntervalMs_{0};
+
+  // moving average. A single gap is accounted for at most twice max.
+  double changeIntervalMs_{0};
+
+  // weight of the latest sample in moving average
+  static constexpr double kSampleWeight{0.2};
+
+  // number of pending changes batched for max irrespective of change rate
+  static constexpr size_t kPendingUpdatesAtMax{10000};
+};
+
 } // namespace detail
 
+// Entries of a prefix keyed by their source type. Few sources advertise the
+// same prefix, hence entries are kept sorted inline rather than hashed.
+using PrefixTypeToEntry =
+    folly::small_sorted_vector_map<thrift::PrefixType, PrefixEntry, 1>;
+
 class PrefixManager final : public OpenrEventBase {
  public:
   PrefixManager(
@@ -89,7 +156,7 @@ class PrefixManager final : public OpenrEventBase {
       messaging::ReplicateQueue<thrift::InitializationEvent>&
           initializationEventQueue,
       // consumer queue
-      messaging::RQueue<KvStorePublication> kvStoreUpdatesQueue,
+      messaging::SharedRQueue<KvStorePublication> kvStoreUpdatesQueue,
       messaging::RQueue<PrefixEvent> prefixUpdatesQueue,
       messaging::RQueue<DecisionRouteUpdate> fibRouteUpdatesQueue,
       // config
@@ -127,6 +194,25 @@ class PrefixManager final : public OpenrEventBase {
   folly::SemiFuture<bool> syncPrefixesByType(
       thrift::PrefixType prefixType, std::vector<thrift::PrefixEntry> prefixes);
 
+  /*
+   * Chunked syncPrefixesByType() for large prefix sets, e.g. streamed by
+   * external agents:
+   *  - chunk: advertise prefixes of the chunk right away, and remember them
+   *    as received by the ongoing sync of @type
+   *  - commit: withdraw prefixes of @type not received by any chunk since
+   *    last commit/abort, and end the sync
+   *  - abort: end the sync without withdrawing anything
+   * Chunks of @type arriving before commit/abort belong to the same sync.
+   */
+  folly::SemiFuture<bool> syncPrefixesByTypeChunk(
+      thrift::PrefixType prefixType, std::vector<thrift::PrefixEntry> prefixes);
+
+  folly::SemiFuture<bool> commitSyncPrefixesByType(
+      thrift::PrefixType prefixType);
+
+  folly::SemiFuture<folly::Unit> abortSyncPrefixesByType(
+      thrift::PrefixType prefixType);
+
   folly::SemiFuture<std::unique_ptr<std::vector<thrift::PrefixEntry>>>
   getPrefixes();
 
@@ -136,9 +222,27 @@ class PrefixManager final : public OpenrEventBase {
   folly::SemiFuture<std::unique_ptr<std::vector<thrift::AdvertisedRouteDetail>>>
   getAdvertisedRoutesFiltered(thrift::AdvertisedRouteFilter filter);
 
+  /**
+   * [Ctrl Cache] Version of prefixMap_, i.e. of the routes returned by
+   * getAdvertisedRoutesFiltered(). Safe to read from any thread.
+   */
+  int64_t
+  getAdvertisedRoutesVersion() const {
+    return prefixMapVersion_.load(std::memory_order_acquire);
+  }
+
   folly::SemiFuture<std::unique_ptr<std::vector<thrift::OriginatedPrefixEntry>>>
   getOriginatedPrefixes();
 
+  /*
+   * Replace prefixes originated from config, e.g. upon config reload.
+   * Removed prefixes get withdrawn, new or changed ones get (re)advertised
+   * once their supporting routes are fulfilled. Unchanged prefixes are left
+   * untouched.
+   */
+  folly::SemiFuture<folly::Unit> updateOriginatedPrefixes(
+      std::vector<thrift::OriginatedPrefix> prefixes);
+
   /**
    * Helper functinon used in getAreaAdvertisedRoutes()
    * Filter routes with 1. <type> attribute
@@ -147,7 +251,7 @@ class PrefixManager final : public OpenrEventBase {
       std::vector<thrift::AdvertisedRoute>& routes,
       const std::string& area,
       const thrift::RouteFilterType& routeFilterType,
-      std::unordered_map<thrift::PrefixType, PrefixEntry> const& prefixEntries,
+      PrefixTypeToEntry const& prefixEntries,
       apache::thrift::optional_field_ref<thrift::PrefixType&> const&
           typeFilter);
   /**
@@ -179,7 +283,7 @@ class PrefixManager final : public OpenrEventBase {
       std::vector<thrift::AdvertisedRouteDetail>& routes,
       apache::thrift::optional_field_ref<thrift::PrefixType&> const& typeFilter,
       folly::CIDRNetwork const& prefix,
-      std::unordered_map<thrift::PrefixType, PrefixEntry> const& prefixEntries);
+      PrefixTypeToEntry const& prefixEntries);
 
   /*
    * Dump routes from prefixEvent that are subject to origination policy.
@@ -213,7 +317,10 @@ class PrefixManager final : public OpenrEventBase {
 
  private:
   // Process thrift publication from KvStore.
-  void processPublication(thrift::Publication&& thriftPub);
+  void processPublication(thrift::Publication const& thriftPub);
+
+  // Process prefix advertisement/withdrawal request from other modules
+  void processPrefixEvent(PrefixEvent& update);
 
   /*
    * Private helpers to update `prefixMap_`
@@ -240,6 +347,14 @@ class PrefixManager final : public OpenrEventBase {
       const std::vector<thrift::PrefixEntry>& tPrefixEntries);
   bool withdrawPrefixEntriesImpl(const std::vector<PrefixEntry>& prefixEntries);
   bool withdrawPrefixesByTypeImpl(thrift::PrefixType type);
+
+  /*
+   * Return the stored area set equal to @areas, or start storing @areas if
+   * there is none. Entries with same destination areas thus share one set
+   * instead of holding a copy each.
+   */
+  std::shared_ptr<const std::unordered_set<std::string>> internAreas(
+      std::shared_ptr<const std::unordered_set<std::string>> areas);
   bool syncPrefixesByTypeImpl(
       thrift::PrefixType type,
       const std::vector<thrift::PrefixEntry>& tPrefixEntries,
@@ -249,6 +364,33 @@ class PrefixManager final : public OpenrEventBase {
       const std::vector<PrefixEntry>& prefixEntries,
       const std::string& policyName);
 
+  /*
+   * Run policy on prefix entry, reusing result of previous run if the policy
+   * input of the prefix is unchanged since. See [Policy Memoization].
+   */
+  std::pair<std::shared_ptr<thrift::PrefixEntry>, std::string>
+  applyPolicyMemoized(
+      const std::string& policyName,
+      const PrefixEntry& prefixEntry,
+      const std::optional<OpenrPolicyActionData>& policyActionData);
+
+  // Drop memoized policy results of prefix from all policies.
+  void invalidatePolicyCache(const folly::CIDRNetwork& prefix);
+
+  /*
+   * Run (policy, prefix entry) pairs whose memoized result is missing or
+   * stale as one batch per policy, possibly spread over `policyExecutor_`,
+   * and memoize the results for later applyPolicyMemoized() calls.
+   */
+  void applyPoliciesInBatch(
+      const std::vector<std::pair<std::string, const PrefixEntry*>>&
+          toApply);
+
+  // Append area policies `prefixEntry` is advertised through to `toApply`
+  void collectAreaPolicies(
+      const PrefixEntry& prefixEntry,
+      std::vector<std::pair<std::string, const PrefixEntry*>>& toApply) const;
+
   /*
    * Trigger inital prefix sync after all dependent OpenR initialization signals
    * are reveived.
@@ -270,6 +412,9 @@ class PrefixManager final : public OpenrEventBase {
    */
   void syncKvStore();
 
+  // Schedule throttled syncKvStore for a prefix change
+  void scheduleSyncKvStore();
+
   // Update KvStore keys of one prefix entry.
   void updatePrefixKeysInKvStore(
       const folly::CIDRNetwork& prefix, const PrefixEntry& prefixEntry);
@@ -283,11 +428,27 @@ class PrefixManager final : public OpenrEventBase {
       const folly::CIDRNetwork& prefix,
       DecisionRouteUpdate& routeUpdatesForDecision);
 
+  // Track entry added to or removed from prefixMap_ in prefix entry indices.
+  // Must be called upon every insertion/removal of prefixMap_ entries.
+  void addPrefixEntryIndex(const PrefixEntry& entry);
+  void removePrefixEntryIndex(const PrefixEntry& entry);
+
   // Delete KvStore keys form the areas for one prefix entry.
   void deleteKvStoreKeyHelper(
       const folly::CIDRNetwork& prefix,
       const std::unordered_set<std::string>& deletedArea);
 
+  // Shard key the prefix is encoded into, with sharded prefix keys.
+  uint32_t getPrefixShardId(const folly::CIDRNetwork& prefix) const;
+
+  // Advertise, or clear if empty, prefix shard keys changed since last call.
+  void syncPrefixShardsInKvStore();
+
+  // Queue key-value request for the batch of its area, which is sent to
+  // KvStore by flushKvStoreRequests() at the end of syncKvStore().
+  void addKvStoreRequest(BatchKeyValueRequest::Request&& request);
+  void flushKvStoreRequests();
+
   /*
    * Send static unicast routes for prefix entries of certain type in OpenR
    * initialization process.
@@ -342,6 +503,13 @@ class PrefixManager final : public OpenrEventBase {
    */
   void processOriginatedPrefixes();
 
+  /*
+   * Util function to diff `prefixes` against originatedPrefixDb_ and apply
+   * the changes. See updateOriginatedPrefixes().
+   */
+  void updateOriginatedPrefixesImpl(
+      const std::vector<thrift::OriginatedPrefix>& prefixes);
+
   // Process Fib route update.
   void processFibRouteUpdates(DecisionRouteUpdate&& fibRouteUpdate);
 
@@ -354,6 +522,10 @@ class PrefixManager final : public OpenrEventBase {
   // routers in BGP.
   void redistributePrefixesAcrossAreas(DecisionRouteUpdate&& fibRouteUpdate);
 
+  // Redistribute up to @maxRoutes of `pendingRedistributions_`, and schedule
+  // the rest for next event loop run.
+  void redistributePendingRoutes(size_t maxRoutes);
+
   // get all areaIds
   std::unordered_set<std::string> allAreaIds();
 
@@ -396,23 +568,69 @@ class PrefixManager final : public OpenrEventBase {
   // V4 prefix over V6 nexthop enabled
   const bool v4OverV6Nexthop_{false};
 
+  // Number of shard keys prefixes are hashed into per area. 0 for one key
+  // per prefix.
+  const uint32_t numPrefixKeyShards_{0};
+
+  // Post-policy entries of advertised prefixes per shard key, and the shard
+  // keys changed since last syncPrefixShardsInKvStore(). Used with sharded
+  // prefix keys only.
+  std::unordered_map<
+      std::string /* area */,
+      std::unordered_map<
+          uint32_t /* shard */,
+          std::unordered_map<folly::CIDRNetwork, thrift::PrefixEntry>>>
+      prefixShards_;
+  std::unordered_map<std::string /* area */, std::unordered_set<uint32_t>>
+      changedPrefixShards_;
+
+  // Key-value requests per area not yet sent to KvStore
+  std::unordered_map<std::string /* area */, BatchKeyValueRequest>
+      pendingKvStoreRequests_;
+
   // Throttled version of syncKvStore. It batches up multiple calls and
   // send them in one go!
   std::unique_ptr<AsyncThrottle> syncKvStoreThrottled_;
   std::unique_ptr<folly::AsyncTimeout> initialSyncKvStoreTimer_;
 
+  // Picks timeout of syncKvStoreThrottled_, unset if not adaptive. See
+  // [Adaptive Sync Throttle].
+  std::optional<detail::PrefixSyncThrottleTuner> syncThrottleTuner_;
+
+  // FIB routes to be redistributed across areas, std::nullopt for deleted
+  // ones. Bounded number of them is processed per event loop run, see
+  // redistributePendingRoutes().
+  std::unordered_map<folly::CIDRNetwork, std::optional<RibUnicastEntry>>
+      pendingRedistributions_;
+  std::unique_ptr<folly::AsyncTimeout> redistributeTimer_;
+
   // TODO: Merge this with advertiseStatus_.
   // The current prefix db this node is advertising. In-case if multiple entries
   // exists for a given prefix, best-route-selection process would select the
   // ones with the best metric. Lowest prefix-type is used as a tie-breaker for
   // advertising the best selected routes to KvStore.
-  std::unordered_map<
-      folly::CIDRNetwork,
-      std::unordered_map<thrift::PrefixType, PrefixEntry>>
-      prefixMap_;
+  std::unordered_map<folly::CIDRNetwork, PrefixTypeToEntry> prefixMap_;
+
+  // [Ctrl Cache] bumped on every change of prefixMap_
+  std::atomic<int64_t> prefixMapVersion_{0};
+
+  // Destination area sets shared by entries of `prefixMap_`, see
+  // internAreas().
+  std::vector<std::shared_ptr<const std::unordered_set<std::string>>>
+      internedAreas_;
   // Advertised prefixes in KvStore and associated best PrefixEntry.
   std::unordered_map<folly::CIDRNetwork, PrefixEntry> advertisedPrefixEntries_;
 
+  // Indices of prefixMap_ entries, which let syncKvStore() visit changed
+  // prefixes only instead of all of prefixMap_:
+  // * prefixes per prepend label, once per entry with the label
+  // * total number of entries
+  // * prefixes awaiting to be advertised, e.g. for FIB-ACK
+  std::unordered_map<int32_t, std::unordered_multiset<folly::CIDRNetwork>>
+      labelToPrefixes_;
+  size_t numPrefixEntries_{0};
+  std::unordered_set<folly::CIDRNetwork> awaitingPrefixes_;
+
   // For prefixes came from PrefixEvent with an origination policy,
   // store the pre-policy version in originatedPrefixMap_.
   // Used in thrift request getAdvertisedRoutesWithOriginationPolicy().
@@ -442,11 +660,63 @@ class PrefixManager final : public OpenrEventBase {
   };
   std::unordered_map<folly::CIDRNetwork, AdervertiseStatus> advertiseStatus_{};
 
+  // Prefixes received per prefix type by ongoing chunked sync, see
+  // syncPrefixesByTypeChunk().
+  std::unordered_map<
+      thrift::PrefixType,
+      std::unordered_set<folly::CIDRNetwork>>
+      chunkedPrefixSyncs_;
+
   // store pending updates from advertise/withdraw operation
   detail::PrefixManagerPendingUpdates pendingUpdates_;
 
   std::unique_ptr<PolicyManager> policyManager_{nullptr};
 
+  // Pool evaluating batches of policies, see `policy_num_threads` config
+  std::unique_ptr<folly::CPUThreadPoolExecutor> policyExecutor_{nullptr};
+
+  /*
+   * [Policy Memoization]
+   *
+   * Area and origination policies are re-run for every advertised prefix on
+   * each sync, although most prefixes are unchanged. Results are memoized per
+   * (policy, prefix, type) along with the policy input, and reused as long as
+   * the input compares equal. Policies are fixed for the lifetime of
+   * `policyManager_`, so the cache is cleared along with it only. Entries of
+   * withdrawn prefixes are dropped.
+   *
+   * Large syncs fill the cache in batches first, see applyPoliciesInBatch(),
+   * so that results are computed in parallel and then read in order.
+   */
+  struct PolicyResult {
+    // policy input
+    std::shared_ptr<thrift::PrefixEntry> prePolicyTPrefixEntry;
+    std::optional<OpenrPolicyActionData> policyActionData;
+    OpenrPolicyMatchData policyMatchData;
+
+    // policy output, nullptr if rejected
+    std::shared_ptr<thrift::PrefixEntry> postPolicyTPrefixEntry;
+    std::string hitPolicyName;
+
+    // true if result was computed for the same policy input
+    bool
+    isValidFor(
+        const PrefixEntry& prefixEntry,
+        const std::optional<OpenrPolicyActionData>& actionData) const {
+      // ATTN: same shared entry is the common case, compare content otherwise
+      return prePolicyTPrefixEntry and policyActionData == actionData and
+          policyMatchData == prefixEntry.policyMatchData and
+          (prePolicyTPrefixEntry == prefixEntry.tPrefixEntry or
+           *prePolicyTPrefixEntry == *prefixEntry.tPrefixEntry);
+    }
+  };
+  std::unordered_map<
+      std::string /* policy */,
+      std::unordered_map<
+          folly::CIDRNetwork,
+          std::unordered_map<thrift::PrefixType, PolicyResult>>>
+      policyCache_;
+
   /*
    * [Route Origination/Aggregation]
    *
@@ -526,6 +796,13 @@ class PrefixManager final : public OpenrEventBase {
    */
   std::unordered_map<folly::CIDRNetwork, OriginatedRoute> originatedPrefixDb_;
 
+  /*
+   * index over `originatedPrefixDb_` so that a FIB prefixEntry finds the
+   * originated prefixes covering it by walking a single trie path.
+   * ATTN: values point into `originatedPrefixDb_`, whose nodes are stable.
+   */
+  PrefixTrie<OriginatedRoute*> originatedPrefixTrie_;
+
   /*
    * prefixes received from OpenR/Fib.
    * ATTN: to avoid loop through ALL entries inside `originatedPrefixes`,
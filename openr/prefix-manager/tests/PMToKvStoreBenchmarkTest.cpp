@@ -5,6 +5,9 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <sys/resource.h>
+
+#include <fmt/format.h>
 #include <folly/Benchmark.h>
 #include <folly/init/Init.h>
 #include <openr/if/gen-cpp2/KvStoreServiceAsyncClient.h>
@@ -33,15 +36,39 @@ namespace detail {
 // Prefix length of a subnet
 static const uint8_t kBitMaskLen = 128;
 
+// Policy used as both area and origination policy by multi-area profile
+const std::string kPolicyName{"benchmark_policy"};
+
+// CPU time consumed and peak RSS of the process so far
+struct ResourceUsage {
+  std::chrono::microseconds cpuTime{0};
+  size_t maxRssBytes{0};
+};
+
+ResourceUsage
+getResourceUsage() {
+  struct rusage usage {};
+  getrusage(RUSAGE_SELF, &usage);
+  ResourceUsage resourceUsage;
+  resourceUsage.cpuTime =
+      std::chrono::seconds(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+      std::chrono::microseconds(
+          usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+  // ru_maxrss is in KB on Linux
+  resourceUsage.maxRssBytes = usage.ru_maxrss * 1024;
+  return resourceUsage;
+}
+
 } // namespace detail
 
 namespace openr {
 
 class PMToKvStoreBMTestFixture {
  public:
-  explicit PMToKvStoreBMTestFixture(const std::string& nodeId) {
-    // construct basic `OpenrConfig`
-    auto tConfig = getBasicOpenrConfig(nodeId);
+  explicit PMToKvStoreBMTestFixture(const std::string& nodeId)
+      : PMToKvStoreBMTestFixture(getBasicOpenrConfig(nodeId)) {}
+
+  explicit PMToKvStoreBMTestFixture(const thrift::OpenrConfig& tConfig) {
     config_ = std::make_shared<Config>(tConfig);
 
     // spawn `KvStore` and `PrefixManager` for benchmarking
@@ -98,10 +125,21 @@ class PMToKvStoreBMTestFixture {
   }
 
   void
-  checkPrefixesInKvStore(uint32_t num) {
+  pushPrefixEvent(PrefixEvent&& event) {
+    prefixUpdatesQueue_.push(std::move(event));
+  }
+
+  void
+  pushFibRouteUpdate(DecisionRouteUpdate&& routeUpdate) {
+    fibRouteUpdatesQueue_.push(std::move(routeUpdate));
+  }
+
+  void
+  checkPrefixesInKvStore(
+      uint32_t num, const std::string& area = kTestingAreaName) {
     while (true) {
       auto res = kvStoreWrapper_->dumpHashes(
-          kTestingAreaName, Constants::kPrefixDbMarker.toString());
+          area, Constants::kPrefixDbMarker.toString());
       if (res.size() >= num) {
         break;
       }
@@ -110,7 +148,9 @@ class PMToKvStoreBMTestFixture {
     }
   }
 
-  void
+  // Wait for `num` keys (deleted keys only if `checkDeletion`) flooded by
+  // KvStore, return number of keys flooded meanwhile
+  uint32_t
   checkThriftPublication(uint32_t num, bool checkDeletion) {
     auto suspender = folly::BenchmarkSuspender();
     uint32_t total{0};
@@ -127,7 +167,8 @@ class PMToKvStoreBMTestFixture {
       // stop measuring time as this is just parsing
       suspender.rehire();
 
-      if (auto* pub = std::get_if<thrift::Publication>(&thriftPub.value())) {
+      if (auto* pub =
+              std::get_if<thrift::Publication>(thriftPub.value().get())) {
         if (not checkDeletion) {
           total += pub->keyVals_ref()->size();
         } else {
@@ -144,7 +185,7 @@ class PMToKvStoreBMTestFixture {
       suspender.dismiss();
 
       if (total >= num) {
-        return;
+        return total;
       }
 
       // wait until all keys are populated
@@ -504,6 +545,284 @@ BM_PrefixManagerPrefixFlap(
   }
 }
 
+/*
+ * Report churn profile metrics of `numOfChanges` prefix changes, measured
+ * from `before` until KvStore flooded `numOfFloodedKeys` resulting keys.
+ */
+static void
+reportChurnCounters(
+    folly::UserCounters& counters,
+    const detail::ResourceUsage& before,
+    std::chrono::steady_clock::duration timeToConsistency,
+    uint32_t numOfChanges,
+    uint32_t numOfFloodedKeys) {
+  const auto after = detail::getResourceUsage();
+  counters["time_to_consistency(ms)"] =
+      std::chrono::duration_cast<std::chrono::milliseconds>(timeToConsistency)
+          .count();
+  counters["cpu_per_change(ns)"] =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          after.cpuTime - before.cpuTime)
+          .count() /
+      std::max<uint32_t>(numOfChanges, 1);
+  counters["peak_rss(MB)"] = after.maxRssBytes / 1024 / 1024;
+  counters["keys_flooded"] = numOfFloodedKeys;
+  counters["prefix_changes"] = numOfChanges;
+}
+
+/*
+ * Benchmark for BGP route-refresh: The BGP agent re-syncs its full prefix
+ * set, of which only `numOfChangedPrefixes` differ from what was synced
+ * before. The time measured is until the changed prefixes are flooded.
+ * Test setup:
+ *  - Sync `numOfPrefixes` BGP prefixes and wait for them in KvStore
+ * Benchmark:
+ *  - Sync the same prefixes again with metrics of `numOfChangedPrefixes`
+ *    updated
+ */
+static void
+BM_PrefixManagerRouteRefresh(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    uint32_t numOfPrefixes,
+    uint32_t numOfChangedPrefixes) {
+  auto suspender = folly::BenchmarkSuspender();
+  CHECK_LE(numOfChangedPrefixes, numOfPrefixes);
+
+  for (uint32_t i = 0; i < iters; ++i) {
+    auto testFixture = std::make_unique<PMToKvStoreBMTestFixture>("node-1");
+    auto prefixMgr = testFixture->getPrefixManager();
+
+    auto prefixes =
+        generatePrefixEntries(testFixture->getPrefixGenerator(), numOfPrefixes);
+    for (auto& prefix : prefixes) {
+      prefix.type_ref() = thrift::PrefixType::BGP;
+    }
+    prefixMgr->syncPrefixesByType(thrift::PrefixType::BGP, prefixes).get();
+    testFixture->checkPrefixesInKvStore(numOfPrefixes);
+
+    auto refreshedPrefixes = prefixes; // NOTE explicitly copy
+    for (uint32_t j = 0; j < numOfChangedPrefixes; ++j) {
+      auto& metrics = *refreshedPrefixes.at(j).metrics_ref();
+      metrics.path_preference_ref() = *metrics.path_preference_ref() + 1;
+    }
+
+    const auto before = detail::getResourceUsage();
+    const auto start = std::chrono::steady_clock::now();
+    suspender.dismiss();
+
+    prefixMgr
+        ->syncPrefixesByType(
+            thrift::PrefixType::BGP, std::move(refreshedPrefixes))
+        .get();
+    const auto numOfFloodedKeys =
+        testFixture->checkThriftPublication(numOfChangedPrefixes, false);
+
+    suspender.rehire();
+    reportChurnCounters(
+        counters,
+        before,
+        std::chrono::steady_clock::now() - start,
+        numOfChangedPrefixes,
+        numOfFloodedKeys);
+  }
+}
+
+/*
+ * Benchmark for steady flapping: In every round, 1% of prefixes is withdrawn
+ * while the ones withdrawn in previous round come back. The time measured
+ * is until KvStore floods the withdrawals and re-advertisements of all
+ * rounds.
+ * Test setup:
+ *  - Advertise `numOfPrefixes` and wait for them in KvStore
+ * Benchmark:
+ *  - `numOfRounds` flapping rounds, e.g. one per second in production
+ */
+static void
+BM_PrefixManagerFlapOnePercent(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    uint32_t numOfPrefixes,
+    uint32_t numOfRounds) {
+  auto suspender = folly::BenchmarkSuspender();
+  const uint32_t numOfFlappedPrefixes =
+      std::max<uint32_t>(numOfPrefixes / 100, 1);
+  CHECK_LE(numOfFlappedPrefixes * (numOfRounds + 1), numOfPrefixes);
+
+  for (uint32_t i = 0; i < iters; ++i) {
+    auto testFixture = std::make_unique<PMToKvStoreBMTestFixture>("node-1");
+    auto prefixMgr = testFixture->getPrefixManager();
+
+    auto prefixes =
+        generatePrefixEntries(testFixture->getPrefixGenerator(), numOfPrefixes);
+    prefixMgr->advertisePrefixes(prefixes).get();
+    testFixture->checkPrefixesInKvStore(numOfPrefixes);
+
+    auto getChunk = [&](uint32_t round) {
+      return std::vector<thrift::PrefixEntry>(
+          prefixes.begin() + round * numOfFlappedPrefixes,
+          prefixes.begin() + (round + 1) * numOfFlappedPrefixes);
+    };
+
+    uint32_t numOfChanges{0};
+    uint32_t numOfFloodedKeys{0};
+    const auto before = detail::getResourceUsage();
+    const auto start = std::chrono::steady_clock::now();
+    suspender.dismiss();
+
+    for (uint32_t round = 0; round < numOfRounds; ++round) {
+      uint32_t numOfRoundChanges = numOfFlappedPrefixes;
+      prefixMgr->withdrawPrefixes(getChunk(round)).get();
+      if (round > 0) {
+        prefixMgr->advertisePrefixes(getChunk(round - 1)).get();
+        numOfRoundChanges += numOfFlappedPrefixes;
+      }
+      numOfFloodedKeys +=
+          testFixture->checkThriftPublication(numOfRoundChanges, false);
+      numOfChanges += numOfRoundChanges;
+    }
+
+    suspender.rehire();
+    reportChurnCounters(
+        counters,
+        before,
+        std::chrono::steady_clock::now() - start,
+        numOfChanges,
+        numOfFloodedKeys);
+  }
+}
+
+/*
+ * Benchmark for multi-area advertisement with policies: Prefixes go through
+ * origination policy, and then area policy of each area they are advertised
+ * to.
+ * Test setup:
+ *  - Configure `numOfAreas` areas, all with area policy
+ * Benchmark:
+ *  - Advertise `numOfPrefixes` prefixes with origination policy into all
+ *    areas
+ */
+static void
+BM_PrefixManagerMultiAreaPolicy(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    uint32_t numOfAreas,
+    uint32_t numOfPrefixes) {
+  auto suspender = folly::BenchmarkSuspender();
+
+  std::vector<thrift::AreaConfig> areaConfigs;
+  for (uint32_t area = 0; area < numOfAreas; ++area) {
+    areaConfigs.emplace_back(createAreaConfig(
+        std::to_string(area), {".*"}, {".*"}, detail::kPolicyName));
+  }
+  auto tConfig = getBasicOpenrConfig("node-1", areaConfigs);
+  std::map<std::string, neteng::config::routing_policy::Filter> policy;
+  policy[detail::kPolicyName] = neteng::config::routing_policy::Filter();
+  tConfig.area_policies_ref() = neteng::config::routing_policy::PolicyConfig();
+  tConfig.area_policies_ref()->filters_ref() =
+      neteng::config::routing_policy::PolicyFilters();
+  tConfig.area_policies_ref()->filters_ref()->routePropagationPolicy_ref() =
+      neteng::config::routing_policy::Filters();
+  tConfig.area_policies_ref()
+      ->filters_ref()
+      ->routePropagationPolicy_ref()
+      ->objects_ref() = policy;
+
+  for (uint32_t i = 0; i < iters; ++i) {
+    auto testFixture = std::make_unique<PMToKvStoreBMTestFixture>(tConfig);
+
+    auto event = PrefixEvent(
+        PrefixEventType::ADD_PREFIXES,
+        thrift::PrefixType::BGP,
+        {},
+        {},
+        detail::kPolicyName);
+    for (auto& prefix : generatePrefixEntries(
+             testFixture->getPrefixGenerator(), numOfPrefixes)) {
+      prefix.type_ref() = thrift::PrefixType::BGP;
+      event.prefixEntries.emplace_back(
+          std::make_shared<thrift::PrefixEntry>(std::move(prefix)),
+          std::unordered_set<std::string>{});
+    }
+
+    const auto before = detail::getResourceUsage();
+    const auto start = std::chrono::steady_clock::now();
+    suspender.dismiss();
+
+    testFixture->pushPrefixEvent(std::move(event));
+    const auto numOfFloodedKeys = testFixture->checkThriftPublication(
+        numOfPrefixes * numOfAreas, false);
+
+    suspender.rehire();
+    reportChurnCounters(
+        counters,
+        before,
+        std::chrono::steady_clock::now() - start,
+        numOfPrefixes,
+        numOfFloodedKeys);
+  }
+}
+
+/*
+ * Benchmark for route aggregation: FIB routes of `numOfAggregates`
+ * originated prefixes show up, and each originated prefix is advertised
+ * once it has enough supporting routes.
+ * Test setup:
+ *  - Configure `numOfAggregates` originated prefixes requiring
+ *    `numOfSupportingRoutes` supporting routes each
+ * Benchmark:
+ *  - FIB route update with all supporting routes of all aggregates
+ */
+static void
+BM_PrefixManagerAggregates(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    uint32_t numOfAggregates,
+    uint32_t numOfSupportingRoutes) {
+  auto suspender = folly::BenchmarkSuspender();
+  CHECK_LE(numOfAggregates, 0xffff);
+  CHECK_LE(numOfSupportingRoutes, 0xffff);
+
+  auto tConfig = getBasicOpenrConfig("node-1");
+  std::vector<thrift::OriginatedPrefix> originatedPrefixes;
+  std::vector<thrift::PrefixEntry> supportingRoutes;
+  for (uint32_t aggregate = 0; aggregate < numOfAggregates; ++aggregate) {
+    thrift::OriginatedPrefix originatedPrefix;
+    originatedPrefix.prefix_ref() =
+        fmt::format("2001:db8:{:x}::/48", aggregate);
+    originatedPrefix.minimum_supporting_routes_ref() = numOfSupportingRoutes;
+    originatedPrefix.install_to_fib_ref() = false;
+    originatedPrefixes.emplace_back(std::move(originatedPrefix));
+    for (uint32_t route = 0; route < numOfSupportingRoutes; ++route) {
+      supportingRoutes.emplace_back(createPrefixEntry(toIpPrefix(
+          fmt::format("2001:db8:{:x}:{:x}::/64", aggregate, route))));
+    }
+  }
+  tConfig.originated_prefixes_ref() = std::move(originatedPrefixes);
+
+  for (uint32_t i = 0; i < iters; ++i) {
+    auto testFixture = std::make_unique<PMToKvStoreBMTestFixture>(tConfig);
+    auto routeUpdate =
+        generateDecisionRouteUpdateFromPrefixEntries(supportingRoutes);
+
+    const auto before = detail::getResourceUsage();
+    const auto start = std::chrono::steady_clock::now();
+    suspender.dismiss();
+
+    testFixture->pushFibRouteUpdate(std::move(routeUpdate));
+    const auto numOfFloodedKeys =
+        testFixture->checkThriftPublication(numOfAggregates, false);
+
+    suspender.rehire();
+    reportChurnCounters(
+        counters,
+        before,
+        std::chrono::steady_clock::now() - start,
+        supportingRoutes.size(),
+        numOfFloodedKeys);
+  }
+}
+
 /*
  * @first integer: number of prefixes existing inside PrefixManager
  * @second integer: number of prefixes to advertise
@@ -567,6 +886,47 @@ BENCHMARK_COUNTERS_NAME_PARAM(
 BENCHMARK_NAMED_PARAM(BM_PrefixManagerPrefixFlap, 100_25000, 100, 25000);
 BENCHMARK_NAMED_PARAM(BM_PrefixManagerPrefixFlap, 10000_25000, 10000, 25000);
 
+/*
+ * @first integer: number of prefixes synced by BGP agent
+ * @second integer: number of prefixes changed by route-refresh
+ */
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManagerRouteRefresh, counters, 100000_1000, 100000, 1000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManagerRouteRefresh, counters, 300000_1000, 300000, 1000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManagerRouteRefresh, counters, 300000_30000, 300000, 30000);
+/*
+ * @first integer: number of prefixes existing inside PrefixManager
+ * @second integer: number of rounds flapping 1% of prefixes each
+ */
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManagerFlapOnePercent, counters, 10000_10, 10000, 10);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManagerFlapOnePercent, counters, 100000_10, 100000, 10);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManagerFlapOnePercent, counters, 300000_10, 300000, 10);
+/*
+ * @first integer: number of areas with area policy
+ * @second integer: number of prefixes advertised with origination policy
+ */
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManagerMultiAreaPolicy, counters, 2_10000, 2, 10000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManagerMultiAreaPolicy, counters, 4_10000, 4, 10000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManagerMultiAreaPolicy, counters, 4_100000, 4, 100000);
+/*
+ * @first integer: number of originated aggregate prefixes
+ * @second integer: number of supporting routes per aggregate
+ */
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManagerAggregates, counters, 10_1000, 10, 1000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManagerAggregates, counters, 100_1000, 100, 1000);
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_PrefixManagerAggregates, counters, 1000_100, 1000, 100);
+
 /*
  * TODO: add decision route processing benchmark
  */
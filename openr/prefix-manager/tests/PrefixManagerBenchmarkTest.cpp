@@ -122,12 +122,22 @@ class PrefixManagerBenchmarkTestFixture {
     // Start measuring time
     suspender.dismiss();
     while (true) {
-      auto total = kvRequestReaderQ.size();
-      if (total != 0) {
+      if (kvRequestReaderQ.size() != 0) {
         // Stop measuring time
         suspender.rehire();
 
-        if (total >= num) {
+        // Count keys of requests, which are batched per area
+        while (kvRequestReaderQ.size() != 0) {
+          auto maybeRequest = kvRequestReaderQ.get();
+          CHECK(maybeRequest.hasValue());
+          if (auto pBatchRequest =
+                  std::get_if<BatchKeyValueRequest>(&maybeRequest.value())) {
+            numKeyValRequests_ += pBatchRequest->getRequests().size();
+          } else {
+            ++numKeyValRequests_;
+          }
+        }
+        if (numKeyValRequests_ >= num) {
           return;
         }
 
@@ -146,7 +156,7 @@ class PrefixManagerBenchmarkTestFixture {
   messaging::ReplicateQueue<DecisionRouteUpdate> staticRouteUpdatesQueue_;
   messaging::ReplicateQueue<PrefixEvent> prefixUpdatesQueue_;
   messaging::ReplicateQueue<DecisionRouteUpdate> prefixMgrRouteUpdatesQueue_;
-  messaging::ReplicateQueue<KvStorePublication> kvStoreUpdatesQueue_;
+  messaging::SharedReplicateQueue<KvStorePublication> kvStoreUpdatesQueue_;
   messaging::ReplicateQueue<thrift::InitializationEvent>
       initializationEventQueue_;
   messaging::ReplicateQueue<DecisionRouteUpdate> fibRouteUpdatesQueue_;
@@ -158,6 +168,9 @@ class PrefixManagerBenchmarkTestFixture {
   std::unique_ptr<KvStoreWrapper<thrift::KvStoreServiceAsyncClient>>
       kvStoreWrapper_;
   PrefixGenerator prefixGenerator_; // for prefixes generation usage
+
+  // Total keys of requests read by checkKeyValRequest()
+  uint32_t numKeyValRequests_{0};
 };
 
 /*
@@ -238,6 +251,75 @@ BM_AdvertiseWithKvRequestQueue(
   }
 }
 
+/*
+ * Benchmark test for steady-state Prefix Updates: The time measured includes
+ * prefix manager processing time and pushes KeyValRequests into
+ * kvRequestQueue. As syncKvStore() only visits changed prefixes, it's
+ * expected to stay flat for the same `numOfUpdatedPrefixes` as
+ * `numOfExistingPrefixes` grows.
+ * Test setup:
+ *  - Generate `numOfExistingPrefixes` and inject them into prefix manager
+ * Benchmark:
+ *  - Update metrics of `numOfUpdatedPrefixes` chunk from previous injected
+ *    prefixes and observe KeyValRequests
+ */
+static void
+BM_UpdateWithKvRequestQueue(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    uint32_t numOfExistingPrefixes,
+    uint32_t numOfUpdatedPrefixes) {
+  // Spawn suspender object to NOT calculating setup time into benchmark
+  auto suspender = folly::BenchmarkSuspender();
+
+  // Make sure num of updated prefixes are subset of existing prefixes
+  CHECK_LE(numOfUpdatedPrefixes, numOfExistingPrefixes);
+
+  const std::string nodeId{"node-1"};
+  for (uint32_t i = 0; i < iters; ++i) {
+    auto testFixture =
+        std::make_unique<PrefixManagerBenchmarkTestFixture>(nodeId, 1);
+
+    // Create a reader to read requests showing up in kvRequestQueue
+    auto kvRequestReaderQ = testFixture->kvRequestQueue_.getReader();
+    // Generate `numOfExistingPrefixes`
+    auto prefixes = generatePrefixEntries(
+        testFixture->getPrefixGenerator(), numOfExistingPrefixes);
+    // Generate events to be pushed into prefixUpdatesQueue_
+    auto events = PrefixEvent(
+        PrefixEventType::ADD_PREFIXES, thrift::PrefixType::BGP, prefixes);
+    testFixture->prefixUpdatesQueue_.push(std::move(events));
+
+    // Verify corresponding requests inside kvRequestQueue
+    testFixture->checkKeyValRequest(numOfExistingPrefixes, kvRequestReaderQ);
+
+    auto prefixesToUpdate = prefixes; // NOTE explicitly copy
+    prefixesToUpdate.resize(numOfUpdatedPrefixes);
+    for (auto& prefix : prefixesToUpdate) {
+      prefix.metrics_ref()->path_preference_ref() =
+          *prefix.metrics_ref()->path_preference_ref() + 1;
+    }
+
+    // Generate events to be pushed into prefixUpdatesQueue_
+    auto updateEvents = PrefixEvent(
+        PrefixEventType::ADD_PREFIXES,
+        thrift::PrefixType::BGP,
+        prefixesToUpdate);
+
+    // Start measuring benchmark time
+    suspender.dismiss();
+
+    // Push events and wait until requests show up in kvRequestQueue
+    testFixture->prefixUpdatesQueue_.push(std::move(updateEvents));
+    testFixture->checkKeyValRequest(
+        numOfExistingPrefixes + numOfUpdatedPrefixes, kvRequestReaderQ);
+
+    // Stop measuring benchmark time
+    suspender.rehire();
+  }
+  counters["num_of_prefixes"] = numOfExistingPrefixes;
+}
+
 /*
  * Benchmark test for Prefix Withdrawals: The time measured includes prefix
  * manager processing time and pushes KeyValRequests into kvRequestQueue.
@@ -503,6 +585,18 @@ BENCHMARK_COUNTERS_PARAM(
 BENCHMARK_COUNTERS_PARAM(
     BM_AdvertiseWithKvRequestQueue, counters, 100000, 100000);
 
+/*
+ * @first integer: number of prefixes existing inside PrefixManager
+ * @second integer: number of prefixes to update
+ */
+
+BENCHMARK_COUNTERS_PARAM(BM_UpdateWithKvRequestQueue, counters, 1000, 1);
+BENCHMARK_COUNTERS_PARAM(BM_UpdateWithKvRequestQueue, counters, 10000, 1);
+BENCHMARK_COUNTERS_PARAM(BM_UpdateWithKvRequestQueue, counters, 100000, 1);
+BENCHMARK_COUNTERS_PARAM(BM_UpdateWithKvRequestQueue, counters, 1000, 100);
+BENCHMARK_COUNTERS_PARAM(BM_UpdateWithKvRequestQueue, counters, 10000, 100);
+BENCHMARK_COUNTERS_PARAM(BM_UpdateWithKvRequestQueue, counters, 100000, 100);
+
 /*
  * @first integer: number of prefixes existing inside PrefixManager
  * @second integer: number of prefixes to withdraw
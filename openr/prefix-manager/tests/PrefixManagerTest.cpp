@@ -5,7 +5,9 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <fb303/ServiceData.h>
 #include <folly/IPAddress.h>
+#include <folly/MapUtil.h>
 #include <folly/init/Init.h>
 #include <glog/logging.h>
 #include <gmock/gmock.h>
@@ -346,6 +348,47 @@ TEST_F(PrefixManagerTestFixture, RemoveUpdateType) {
   EXPECT_TRUE(prefixManager->withdrawPrefixes({prefixEntry8}).get());
 }
 
+TEST_F(PrefixManagerTestFixture, ChunkedSyncPrefixesByType) {
+  const auto type = thrift::PrefixType::PREFIX_ALLOCATOR;
+  EXPECT_TRUE(
+      prefixManager->advertisePrefixes({prefixEntry2, prefixEntry4}).get());
+  EXPECT_TRUE(prefixManager->advertisePrefixes({prefixEntry3}).get());
+
+  // prefixes of chunks are advertised right away
+  EXPECT_FALSE(
+      prefixManager->syncPrefixesByTypeChunk(type, {prefixEntry4}).get());
+  EXPECT_TRUE(
+      prefixManager->syncPrefixesByTypeChunk(type, {prefixEntry6, prefixEntry8})
+          .get());
+  EXPECT_EQ(4, prefixManager->getPrefixesByType(type).get()->size());
+
+  // commit withdraws prefixEntry2 which was not sent in any chunk. Prefix of
+  // other type is left untouched.
+  EXPECT_TRUE(prefixManager->commitSyncPrefixesByType(type).get());
+  EXPECT_FALSE(prefixManager->withdrawPrefixes({prefixEntry2}).get());
+  EXPECT_EQ(3, prefixManager->getPrefixesByType(type).get()->size());
+  EXPECT_EQ(
+      1,
+      prefixManager->getPrefixesByType(thrift::PrefixType::DEFAULT)
+          .get()
+          ->size());
+
+  // aborted sync withdraws nothing, neither does the next one include chunks
+  // of the aborted sync
+  EXPECT_TRUE(
+      prefixManager->syncPrefixesByTypeChunk(type, {prefixEntry2}).get());
+  prefixManager->abortSyncPrefixesByType(type).get();
+  EXPECT_EQ(4, prefixManager->getPrefixesByType(type).get()->size());
+  EXPECT_FALSE(
+      prefixManager->syncPrefixesByTypeChunk(type, {prefixEntry4}).get());
+  EXPECT_TRUE(prefixManager->commitSyncPrefixesByType(type).get());
+  EXPECT_EQ(1, prefixManager->getPrefixesByType(type).get()->size());
+
+  // sync without any chunk withdraws all prefixes of the type
+  EXPECT_TRUE(prefixManager->commitSyncPrefixesByType(type).get());
+  EXPECT_EQ(0, prefixManager->getPrefixesByType(type).get()->size());
+}
+
 TEST_F(PrefixManagerTestFixture, VerifyKvStore) {
   int scheduleAt{0};
   auto prefixKey = PrefixKey(
@@ -1484,7 +1527,7 @@ TEST_F(PrefixManagerTestFixture, GetAdvertisedRoutes) {
  */
 TEST(PrefixManager, FilterAdvertisedRoutes) {
   std::vector<thrift::AdvertisedRouteDetail> routes;
-  std::unordered_map<thrift::PrefixType, PrefixEntry> entries;
+  PrefixTypeToEntry entries;
   thrift::AdvertisedRouteFilter filter;
   PrefixManager::filterAndAddAdvertisedRoute(
       routes, filter.prefixType_ref(), folly::CIDRNetwork(), entries);
@@ -1880,6 +1923,65 @@ TEST_F(PrefixManagerMultiAreaTestFixture, DecisionRouteNexthopUpdates) {
   }
 }
 
+/**
+ * Test cross-AREA route redistribution skips FIB route updates which don't
+ * change the redistributed prefix entry, e.g. from Decision rebuilds
+ */
+TEST_F(PrefixManagerMultiAreaTestFixture, DecisionRouteUnchangedUpdates) {
+  auto getCounter = [](const std::string& name) {
+    return folly::get_default(fb303::fbData->getCounters(), name, 0);
+  };
+  const auto unchangedRoutes =
+      getCounter("prefix_manager.redistribution.unchanged_routes.sum");
+  const auto prefixStr =
+      PrefixKey(nodeId_, toIPNetwork(addr1), "A").getPrefixKeyV2();
+
+  auto path1_2_1 = createNextHop(
+      toBinaryAddress(folly::IPAddress("fe80::2")),
+      std::string("iface_1_2_1"),
+      1);
+  path1_2_1.area_ref() = "A";
+  auto unicast1A = RibUnicastEntry(
+      toIPNetwork(addr1), {path1_2_1}, prefixEntry1, "A", false);
+
+  auto pushAndReadPublications = [&](size_t numPublications) {
+    DecisionRouteUpdate routeUpdate;
+    routeUpdate.addRouteToUpdate(unicast1A);
+    fibRouteUpdatesQueue.push(std::move(routeUpdate));
+
+    std::map<std::pair<std::string, std::string>, thrift::PrefixEntry> got,
+        gotDeleted;
+    for (size_t i = 0; i < numPublications; ++i) {
+      auto pub = kvStoreWrapper->recvPublication();
+      readPublication(pub, got, gotDeleted);
+    }
+    return got;
+  };
+
+  // 1. Inject prefix1 from area A, {B, C} receive announcement
+  auto got = pushAndReadPublications(2);
+  EXPECT_EQ(2, got.size());
+  EXPECT_EQ(1, got.count(std::make_pair(prefixStr, std::string("B"))));
+  EXPECT_EQ(1, got.count(std::make_pair(prefixStr, std::string("C"))));
+
+  // 2. Same route again is skipped
+  pushAndReadPublications(0);
+
+  // 3. Route with updated metrics is redistributed again. Its publications
+  //    also imply that the previous route update is processed.
+  unicast1A.bestPrefixEntry.metrics_ref()->path_preference_ref() = 100;
+  got = pushAndReadPublications(2);
+  EXPECT_EQ(2, got.size());
+  EXPECT_EQ(
+      100,
+      *got.at(std::make_pair(prefixStr, std::string("B")))
+           .metrics_ref()
+           ->path_preference_ref());
+  EXPECT_EQ(
+      unchangedRoutes + 1,
+      getCounter("prefix_manager.redistribution.unchanged_routes.sum"));
+}
+
 class RouteOriginationFixture : public PrefixManagerMultiAreaTestFixture {
  public:
   void
@@ -1923,14 +2025,14 @@ class RouteOriginationFixture : public PrefixManagerMultiAreaTestFixture {
   // return false if publication is tll update.
   void
   waitForKvStorePublication(
-      messaging::RQueue<KvStorePublication>& reader,
+      messaging::SharedRQueue<KvStorePublication>& reader,
       std::unordered_map<
           std::pair<std::string /* prefixStr */, std::string /* areaStr */>,
           thrift::PrefixEntry>& exp,
       std::unordered_set<std::pair<std::string, std::string>>& expDeleted) {
     while (exp.size() or expDeleted.size()) {
       auto maybePub = reader.get().value();
-      if (auto* pub = std::get_if<thrift::Publication>(&maybePub)) {
+      if (auto* pub = std::get_if<thrift::Publication>(maybePub.get())) {
         for (const auto& [key, thriftVal] : *pub->keyVals_ref()) {
           if (not thriftVal.value_ref().has_value()) {
             // skip TTL update
@@ -2119,6 +2221,62 @@ TEST_F(RouteOriginationOverrideFixture, ReadFromConfig) {
   waitForKvStorePublication(kvStoreUpdatesReader, exp, expDeleted);
 }
 
+//
+// Test case to verify update of originated prefixes, e.g. upon config reload:
+//  - removed prefix(v4) is withdrawn from ALL areas;
+//  - changed prefix(v6) is re-advertised with new attributes;
+//
+TEST_F(RouteOriginationOverrideFixture, UpdateOriginatedPrefixes) {
+  auto kvStoreUpdatesReader = kvStoreWrapper->getReader();
+
+  const auto bestPrefixEntryV4_ =
+      createPrefixEntry(toIpPrefix(v4Prefix_), thrift::PrefixType::CONFIG);
+  auto bestPrefixEntryV6_ =
+      createPrefixEntry(toIpPrefix(v6Prefix_), thrift::PrefixType::CONFIG);
+
+  // wait for initial advertisement of both prefixes
+  {
+    std::unordered_map<
+        std::pair<std::string, std::string>,
+        thrift::PrefixEntry>
+        exp({
+            {prefixKeyV4AreaA_, bestPrefixEntryV4_},
+            {prefixKeyV4AreaB_, bestPrefixEntryV4_},
+            {prefixKeyV4AreaC_, bestPrefixEntryV4_},
+            {prefixKeyV6AreaA_, bestPrefixEntryV6_},
+            {prefixKeyV6AreaB_, bestPrefixEntryV6_},
+            {prefixKeyV6AreaC_, bestPrefixEntryV6_},
+        });
+    std::unordered_set<std::pair<std::string, std::string>> expDeleted{};
+    waitForKvStorePublication(kvStoreUpdatesReader, exp, expDeleted);
+  }
+
+  thrift::OriginatedPrefix originatedPrefixV6;
+  originatedPrefixV6.prefix_ref() = v6Prefix_;
+  originatedPrefixV6.minimum_supporting_routes_ref() = 0;
+  originatedPrefixV6.tags_ref() = {"RELOADED"};
+  prefixManager->updateOriginatedPrefixes({originatedPrefixV6}).get();
+
+  {
+    bestPrefixEntryV6_.tags_ref() = {"RELOADED"};
+    std::unordered_map<
+        std::pair<std::string, std::string>,
+        thrift::PrefixEntry>
+        exp({
+            {prefixKeyV6AreaA_, bestPrefixEntryV6_},
+            {prefixKeyV6AreaB_, bestPrefixEntryV6_},
+            {prefixKeyV6AreaC_, bestPrefixEntryV6_},
+        });
+    std::unordered_set<std::pair<std::string, std::string>> expDeleted{
+        prefixKeyV4AreaA_, prefixKeyV4AreaB_, prefixKeyV4AreaC_};
+    waitForKvStorePublication(kvStoreUpdatesReader, exp, expDeleted);
+  }
+
+  auto prefixEntries = *prefixManager->getOriginatedPrefixes().get();
+  ASSERT_THAT(prefixEntries, testing::SizeIs(1));
+  EXPECT_EQ(v6Prefix_, *prefixEntries.at(0).prefix_ref()->prefix_ref());
+}
+
 TEST_F(RouteOriginationFixture, BasicAdvertiseWithdraw) {
   // RQueue interface to read route updates
   auto staticRoutesReader = staticRouteUpdatesQueue.getReader();
@@ -2683,6 +2841,35 @@ TEST(PrefixManagerPendingUpdates, updatePrefixes) {
   EXPECT_TRUE(updates.getChangedPrefixes().empty());
 }
 
+TEST(PrefixSyncThrottleTuner, Throttle) {
+  const std::chrono::milliseconds minThrottle{1};
+  const std::chrono::milliseconds maxThrottle{500};
+  detail::PrefixSyncThrottleTuner tuner(minThrottle, maxThrottle);
+  auto now = std::chrono::steady_clock::now();
+
+  // idle, isolated change is synced after min
+  tuner.recordChange(now);
+  EXPECT_EQ(minThrottle, tuner.getThrottle(1));
+
+  // large pending set is batched longer, up to max
+  EXPECT_EQ(std::chrono::milliseconds(250), tuner.getThrottle(5000));
+  EXPECT_EQ(maxThrottle, tuner.getThrottle(20000));
+
+  // churn, the window grows as changes come closer together
+  for (int i = 0; i < 20; ++i) {
+    now += std::chrono::milliseconds(10);
+    tuner.recordChange(now);
+  }
+  EXPECT_GT(50, tuner.getChangeIntervalMs());
+  EXPECT_LT(std::chrono::milliseconds(450), tuner.getThrottle(1));
+  EXPECT_GE(maxThrottle, tuner.getThrottle(1));
+
+  // first change after a quiet period is synced after min again
+  now += std::chrono::seconds(1);
+  tuner.recordChange(now);
+  EXPECT_EQ(minThrottle, tuner.getThrottle(1));
+}
+
 class RouteOriginationKnobTestFixture : public PrefixManagerTestFixture {
  protected:
   thrift::OpenrConfig
@@ -3432,6 +3619,186 @@ TEST_F(PrefixManagerTestFixture, WithdrawPrefix) {
   evb.run();
 }
 
+class PrefixManagerShardedKeyTestFixture : public PrefixManagerTestFixture {
+ protected:
+  thrift::OpenrConfig
+  createConfig() override {
+    auto tConfig = getBasicOpenrConfig(nodeId_);
+    // single shard to hold all of the prefixes
+    tConfig.prefix_key_shards_ref() = 1;
+    return tConfig;
+  }
+};
+
+TEST_F(PrefixManagerShardedKeyTestFixture, AdvertiseWithdrawPrefixes) {
+  int scheduleAt{0};
+  const auto shardKeyStr = PrefixKey::getPrefixShardKey(nodeId_, 0);
+  auto getShardDb = [&]() {
+    auto maybeValue = kvStoreWrapper->getKey(kTestingAreaName, shardKeyStr);
+    EXPECT_TRUE(maybeValue.has_value());
+    return readThriftObjStr<thrift::PrefixDatabase>(
+        maybeValue.value().value_ref().value(), serializer);
+  };
+
+  // 1. Advertise two prefix entries.
+  // 2. Check that both are in the shard key, without per prefix keys.
+  // 3. Withdraw one prefix, and check it's removed from the shard.
+  // 4. Withdraw the other prefix, and check the shard is withdrawn.
+  evb.scheduleTimeout(
+      std::chrono::milliseconds(scheduleAt += 0), [&]() noexcept {
+        prefixManager->advertisePrefixes({prefixEntry1, prefixEntry2}).get();
+      });
+
+  evb.scheduleTimeout(
+      std::chrono::milliseconds(
+          scheduleAt += 3 * Constants::kKvStoreSyncThrottleTimeout.count()),
+      [&]() noexcept {
+        auto db = getShardDb();
+        EXPECT_FALSE(*db.deletePrefix_ref());
+        EXPECT_EQ(2, db.prefixEntries_ref()->size());
+        EXPECT_EQ(1, getNumPrefixes(Constants::kPrefixDbMarker.toString()));
+
+        prefixManager->withdrawPrefixes({prefixEntry1}).get();
+      });
+
+  evb.scheduleTimeout(
+      std::chrono::milliseconds(
+          scheduleAt += 3 * Constants::kKvStoreSyncThrottleTimeout.count()),
+      [&]() noexcept {
+        auto db = getShardDb();
+        EXPECT_FALSE(*db.deletePrefix_ref());
+        ASSERT_EQ(1, db.prefixEntries_ref()->size());
+        EXPECT_EQ(
+            *prefixEntry2.prefix_ref(),
+            *db.prefixEntries_ref()->front().prefix_ref());
+
+        prefixManager->withdrawPrefixes({prefixEntry2}).get();
+      });
+
+  evb.scheduleTimeout(
+      std::chrono::milliseconds(
+          scheduleAt += 3 * Constants::kKvStoreSyncThrottleTimeout.count()),
+      [&]() noexcept {
+        // Shard is withdrawn by setting deleted value without any entry
+        auto db = getShardDb();
+        EXPECT_TRUE(*db.deletePrefix_ref());
+        EXPECT_EQ(0, db.prefixEntries_ref()->size());
+        EXPECT_EQ(0, getNumPrefixes(Constants::kPrefixDbMarker.toString()));
+
+        evb.stop();
+      });
+
+  evb.run();
+}
+
+class PrefixManagerAreaPolicyTestFixture : public PrefixManagerTestFixture {
+ protected:
+  thrift::OpenrConfig
+  createConfig() override {
+    auto tConfig = getBasicOpenrConfig(
+        nodeId_,
+        {createAreaConfig(kTestingAreaName, {".*"}, {".*"}, kPolicyName)});
+
+    std::map<std::string, neteng::config::routing_policy::Filter> policy;
+    policy[kPolicyName] = neteng::config::routing_policy::Filter();
+    tConfig.area_policies_ref() =
+        neteng::config::routing_policy::PolicyConfig();
+    tConfig.area_policies_ref()->filters_ref() =
+        neteng::config::routing_policy::PolicyFilters();
+    tConfig.area_policies_ref()->filters_ref()->routePropagationPolicy_ref() =
+        neteng::config::routing_policy::Filters();
+    tConfig.area_policies_ref()
+        ->filters_ref()
+        ->routePropagationPolicy_ref()
+        ->objects_ref() = policy;
+    return tConfig;
+  }
+
+  const std::string kPolicyName{"test_policy"};
+};
+
+// Verify area policy is run once per unchanged prefix entry, and its result
+// is reused by later advertisement and route queries.
+TEST_F(PrefixManagerAreaPolicyTestFixture, PolicyMemoization) {
+  auto getCounter = [](const std::string& name) {
+    return folly::get_default(fb303::fbData->getCounters(), name, 0);
+  };
+  const auto hits = getCounter("prefix_manager.policy_cache.hit.sum");
+  const auto misses = getCounter("prefix_manager.policy_cache.miss.sum");
+  auto getRoutes = [&]() {
+    return prefixManager
+        ->getAreaAdvertisedRoutes(
+            kTestingAreaName,
+            thrift::RouteFilterType::POSTFILTER_ADVERTISED,
+            thrift::AdvertisedRouteFilter())
+        .get();
+  };
+
+  prefixManager->advertisePrefixes({prefixEntry1}).get();
+  EXPECT_EQ(1, getRoutes()->size());
+  EXPECT_EQ(1, getRoutes()->size());
+
+  // Wait for syncKvStore() to advertise the prefix
+  std::this_thread::sleep_for(3 * Constants::kKvStoreSyncThrottleTimeout);
+  EXPECT_EQ(1, getRoutes()->size());
+  EXPECT_EQ(misses + 1, getCounter("prefix_manager.policy_cache.miss.sum"));
+  EXPECT_EQ(hits + 3, getCounter("prefix_manager.policy_cache.hit.sum"));
+
+  // Updated prefix entry runs the policy again
+  auto updatedEntry = prefixEntry1;
+  updatedEntry.metrics_ref()->path_preference_ref() = 100;
+  prefixManager->advertisePrefixes({updatedEntry}).get();
+  EXPECT_EQ(1, getRoutes()->size());
+  EXPECT_EQ(misses + 2, getCounter("prefix_manager.policy_cache.miss.sum"));
+}
+
+class PrefixManagerPolicyPoolTestFixture
+    : public PrefixManagerAreaPolicyTestFixture {
+ protected:
+  thrift::OpenrConfig
+  createConfig() override {
+    auto tConfig = PrefixManagerAreaPolicyTestFixture::createConfig();
+    tConfig.policy_num_threads_ref() = 2;
+    return tConfig;
+  }
+};
+
+// Verify area policy of prefixes synced at once is run in batch on the pool,
+// once per prefix, and results are used for advertisement.
+TEST_F(PrefixManagerPolicyPoolTestFixture, BatchEvaluation) {
+  auto getCounter = [](const std::string& name) {
+    return folly::get_default(fb303::fbData->getCounters(), name, 0);
+  };
+  const auto hits = getCounter("prefix_manager.policy_cache.hit.sum");
+  const auto misses = getCounter("prefix_manager.policy_cache.miss.sum");
+
+  // several chunks of batch evaluation
+  const size_t numPrefixes = 4 * PolicyManager::kPolicyBatchChunkSize;
+  std::vector<thrift::PrefixEntry> prefixEntries;
+  for (size_t i = 0; i < numPrefixes; ++i) {
+    prefixEntries.emplace_back(createPrefixEntry(
+        toIpPrefix(fmt::format("fc00:{:x}::/64", i)),
+        thrift::PrefixType::DEFAULT));
+  }
+  prefixManager->advertisePrefixes(prefixEntries).get();
+
+  // Wait for syncKvStore() to advertise the prefixes
+  std::this_thread::sleep_for(3 * Constants::kKvStoreSyncThrottleTimeout);
+  EXPECT_EQ(
+      misses + numPrefixes,
+      getCounter("prefix_manager.policy_cache.miss.sum"));
+  EXPECT_EQ(
+      hits + numPrefixes, getCounter("prefix_manager.policy_cache.hit.sum"));
+
+  auto routes = prefixManager
+                    ->getAreaAdvertisedRoutes(
+                        kTestingAreaName,
+                        thrift::RouteFilterType::POSTFILTER_ADVERTISED,
+                        thrift::AdvertisedRouteFilter())
+                    .get();
+  EXPECT_EQ(numPrefixes, routes->size());
+}
+
 class PrefixManagerInitialKvStoreSyncTestFixture
     : public PrefixManagerTestFixture {
  protected:
@@ -14,6 +14,7 @@ class ConfigCli:
     def __init__(self):
         self.config.add_command(ConfigShowCli().show, name="show")
         self.config.add_command(ConfigDryRunCli().dryrun, name="dryrun")
+        self.config.add_command(ConfigReloadCli().reload, name="reload")
         self.config.add_command(ConfigCompareCli().compare, name="compare")
         self.config.add_command(
             ConfigPrefixAllocatorCli().config_prefix_allocator,
@@ -60,6 +61,16 @@ class ConfigDryRunCli:
         # ctx.exit(ret_val if ret_val else 0)
 
 
+class ConfigReloadCli:
+    @click.command()
+    @click.argument("file")
+    @click.pass_obj
+    def reload(cli_opts: Bunch, file: str) -> None:  # noqa: B902
+        """Apply openr config file to running openr without restart"""
+
+        config.ConfigReloadCmd(cli_opts).run(file)
+
+
 class ConfigCompareCli:
     @click.command()
     @click.argument("file")
@@ -39,6 +39,21 @@ class ConfigDryRunCmd(OpenrCtrlCmd):
         return 0
 
 
+class ConfigReloadCmd(OpenrCtrlCmd):
+    def _run(self, client: OpenrCtrl.Client, file: str, *args, **kwargs) -> int:
+        try:
+            changed_fields = client.reloadConfig(file)
+        except OpenrError as ex:
+            click.echo(click.style("FAILED: {}".format(ex), fg="red"))
+            return 1
+
+        if changed_fields:
+            click.echo("Applied changes of: {}".format(", ".join(changed_fields)))
+        else:
+            click.echo(click.style("SAME", fg="green"))
+        return 0
+
+
 class ConfigCompareCmd(OpenrCtrlCmd):
     def _run(self, client: OpenrCtrl.Client, file: str, *args, **kwargs):
         running_conf = client.getRunningConfig()
@@ -9,11 +9,12 @@ import ipaddress
 import json
 import sys
 from collections import defaultdict
-from typing import Any, Dict, List, Optional, Set, Sequence, Tuple
+from typing import Any, Dict, Iterator, List, Optional, Set, Sequence, Tuple
 
 import click
 from openr.cli.utils import utils
 from openr.cli.utils.commands import OpenrCtrlCmd
+from openr.clients.openr_client import get_openr_ctrl_client
 from openr.KvStore import ttypes as kv_store_types
 from openr.Network import ttypes as network_types
 from openr.OpenrCtrl import OpenrCtrl, ttypes as ctrl_types
@@ -36,17 +37,35 @@ class DecisionRoutesComputedCmd(OpenrCtrlCmd):
     ) -> None:
         if "all" in nodes:
             nodes = self._get_all_nodes(client)
+        route_dbs = self._get_route_dbs(client, sorted(nodes))
         if json:
             route_db_dict = {}
-            for node in nodes:
-                route_db = client.getRouteDbComputed(node)
+            for node, route_db in route_dbs:
                 route_db_dict[node] = utils.route_db_to_dict(route_db)
             utils.print_routes_json(route_db_dict, prefixes, labels)
         else:
-            for node in nodes:
-                route_db = client.getRouteDbComputed(node)
+            # Print routes of each node as soon as they are computed
+            for _, route_db in route_dbs:
                 utils.print_route_db(route_db, prefixes, labels)
 
+    def _get_route_dbs(
+        self, client: OpenrCtrl.Client, nodes: List[str]
+    ) -> Iterator[Tuple[str, openr_types.RouteDatabase]]:
+        """
+        Routes computed for `nodes`, in order. Routes of multiple nodes are
+        computed in parallel, each over a client of its own.
+        """
+
+        if len(nodes) == 1:
+            yield nodes[0], client.getRouteDbComputed(nodes[0])
+            return
+
+        def _get_route_db(node: str) -> openr_types.RouteDatabase:
+            with get_openr_ctrl_client(self.host, self.cli_opts) as node_client:
+                return node_client.getRouteDbComputed(node)
+
+        yield from utils.run_for_nodes(nodes, _get_route_db)
+
     def _get_all_nodes(self, client: OpenrCtrl.Client) -> set:
         """return all the nodes' name in the network"""
 
@@ -57,8 +57,19 @@ class FibUnicastRoutesCmd(OpenrCtrlCmd):
         *args,
         **kwargs,
     ) -> None:
-        unicast_route_list = client.getUnicastRoutesFiltered(prefix_or_ip)
         host_name = client.getMyNodeName()
+        if not prefix_or_ip and not json:
+            self.print_unicast_route_pages(client, host_name)
+            return
+
+        if prefix_or_ip:
+            unicast_route_list = client.getUnicastRoutesFiltered(prefix_or_ip)
+        else:
+            unicast_route_list = [
+                route
+                for page in utils.iter_pages(client.getUnicastRoutesPage)
+                for route in page.routes
+            ]
 
         if json:
             routes = {
@@ -73,6 +84,21 @@ class FibUnicastRoutesCmd(OpenrCtrlCmd):
                 "Unicast Routes for {}".format(host_name), unicast_route_list
             )
 
+    def print_unicast_route_pages(
+        self, client: OpenrCtrl.Client, host_name: str
+    ) -> None:
+        """
+        Dump the whole route table in pages, printing routes as pages arrive
+        instead of waiting for the full table
+        """
+
+        caption = "Unicast Routes for {}".format(host_name)
+        for page in utils.iter_pages(client.getUnicastRoutesPage):
+            if not page.routes and not caption:
+                continue
+            utils.print_unicast_routes(caption, page.routes)
+            caption = ""
+
 
 class FibMplsRoutesCmd(OpenrCtrlCmd):
     def _run(
@@ -526,6 +552,8 @@ class StreamSummaryCmd(OpenrCtrlCmd):
             uptime,
             stream_session_info.total_streamed_msgs,
             last_msg_time,
+            stream_session_info.pending_msgs,
+            stream_session_info.dropped_msgs,
         ]
         return row
 
@@ -555,6 +583,8 @@ class StreamSummaryCmd(OpenrCtrlCmd):
             "Uptime",
             "Total Messages",
             "Time of Last Message",
+            "Pending Messages",
+            "Dropped Messages",
         ]
         table = ""
         table = prettytable.PrettyTable(columns)
@@ -17,7 +17,17 @@ import time
 from builtins import str
 from collections.abc import Iterable
 from itertools import combinations
-from typing import Any, Callable, Dict, List, Optional, Set, AbstractSet
+from typing import (
+    Any,
+    Callable,
+    Dict,
+    Iterator,
+    List,
+    Optional,
+    Set,
+    AbstractSet,
+    Tuple,
+)
 
 import bunch
 import hexdump
@@ -29,7 +39,7 @@ from openr.clients.openr_client import get_openr_ctrl_client, get_openr_ctrl_cpp
 from openr.KvStore import ttypes as kvstore_types
 from openr.Network import ttypes as network_types
 from openr.OpenrCtrl import OpenrCtrl
-from openr.OpenrCtrl.ttypes import StreamSubscriberType
+from openr.OpenrCtrl.ttypes import KvStoreKeyValsPage, StreamSubscriberType
 from openr.thrift.KvStore import types as kvstore_types_py3
 from openr.thrift.OpenrCtrlCpp.clients import OpenrCtrlCpp as OpenrCtrlCppClient
 from openr.Types import ttypes as openr_types
@@ -263,6 +273,20 @@ class KvKeysCmd(KvStoreCmdBase):
             print(utils.json_dumps(data))
             return
 
+        rows, num_keys, db_bytes = self.get_kvstore_keys_rows(resp, ttl)
+        print(
+            printing.render_horizontal_table(
+                rows,
+                self.get_kvstore_keys_labels(ttl),
+                self.get_kvstore_keys_caption(num_keys, db_bytes),
+            )
+        )
+
+    def get_kvstore_keys_rows(
+        self, resp: Dict[str, kvstore_types.Publication], ttl: bool
+    ) -> Tuple[List[List[Any]], int, int]:
+        """rows of keys table along with number of keys and their size"""
+
         rows = []
         db_bytes = 0
         num_keys = 0
@@ -296,14 +320,17 @@ class KvKeysCmd(KvStoreCmdBase):
                     )
                     row.append(f"{ttlStr} - {value.ttlVersion}")
                 rows.append(row)
+        return rows, num_keys, db_bytes
 
-        db_bytes_str = printing.sprint_bytes(db_bytes)
-        caption = f"KvStore Data - {num_keys} keys, {db_bytes_str}"
+    def get_kvstore_keys_labels(self, ttl: bool) -> List[str]:
         column_labels = ["Key", "Originator", "Ver", "Hash", "Size", "Area"]
         if ttl:
             column_labels = column_labels + ["TTL - Ver"]
+        return column_labels
 
-        print(printing.render_horizontal_table(rows, column_labels, caption))
+    def get_kvstore_keys_caption(self, num_keys: int, db_bytes: int) -> str:
+        db_bytes_str = printing.sprint_bytes(db_bytes)
+        return f"KvStore Data - {num_keys} keys, {db_bytes_str}"
 
 
 class KeysCmd(KvKeysCmd):
@@ -325,12 +352,47 @@ class KeysCmd(KvKeysCmd):
             prefix, {originator} if originator else None
         )
 
-        area_kv = {}
-        for area in self.areas:
-            resp = client.getKvStoreKeyValsFilteredArea(keyDumpParams, area)
-            area_kv[area] = resp
+        # Keys of every area are dumped in pages. JSON output needs all of
+        # them, table output is printed as pages arrive.
+        if json:
+            area_kv = {}
+            for area in self.areas:
+                pub = kvstore_types.Publication(keyVals={}, area=area)
+                for page in self.iter_key_pages(client, keyDumpParams, area):
+                    pub.keyVals.update(page.publication.keyVals)
+                area_kv[area] = pub
+            self.print_kvstore_keys(area_kv, ttl, json)
+            return
+
+        num_keys = 0
+        db_bytes = 0
+        for area in sorted(self.areas):
+            for page in self.iter_key_pages(client, keyDumpParams, area):
+                rows, page_keys, page_bytes = self.get_kvstore_keys_rows(
+                    {area: page.publication}, ttl
+                )
+                if not rows:
+                    continue
+                num_keys += page_keys
+                db_bytes += page_bytes
+                print(
+                    printing.render_horizontal_table(
+                        rows, self.get_kvstore_keys_labels(ttl)
+                    )
+                )
+        print(printing.caption_fmt(self.get_kvstore_keys_caption(num_keys, db_bytes)))
 
-        self.print_kvstore_keys(area_kv, ttl, json)
+    def iter_key_pages(
+        self,
+        client: OpenrCtrl.Client,
+        keyDumpParams: kvstore_types.KeyDumpParams,
+        area: str,
+    ) -> Iterator[KvStoreKeyValsPage]:
+        return utils.iter_pages(
+            lambda page_params: client.getKvStoreKeyValsFilteredAreaPage(
+                keyDumpParams, area, page_params
+            )
+        )
 
 
 class KvKeyValsCmd(KvStoreCmdBase):
@@ -737,10 +799,13 @@ class KvCompareCmd(KvStoreCmdBase):
     ):
         """get the kvs of a set of nodes"""
 
-        kv_dict = {}
-        for node in nodes:
+        def _dump_node_kvs(node: str) -> kvstore_types.Publication:
             node_ip = all_nodes_to_ips.get(node, node)
-            kv = utils.dump_node_kvs(self.cli_opts, node_ip, area)
+            return utils.dump_node_kvs(self.cli_opts, node_ip, area)
+
+        # Nodes are dumped in parallel, each over a client of its own
+        kv_dict = {}
+        for node, kv in utils.run_for_nodes(sorted(nodes), _dump_node_kvs):
             if kv is not None:
                 kv_dict[node] = kv.keyVals
                 print("dumped kv from {}".format(node))
@@ -360,12 +360,16 @@ class LMLinksCmd(LMCmdBase):
                 (v.linkFlapBackOffMs if v.linkFlapBackOffMs else 0)
                 / 1000
             )
+            # pyre-fixme[16]: `object` has no attribute `isLinkFlapSuppressed`.
+            hold_state = "Suppressed" if v.isLinkFlapSuppressed else "Hold"
             if backoff_sec == 0:
                 state = "Up"
             elif not utils.is_color_output_supported():
                 state = backoff_sec
             else:
-                state = click.style("Hold ({} s)".format(backoff_sec), fg="yellow")
+                state = click.style(
+                    "{} ({} s)".format(hold_state, backoff_sec), fg="yellow"
+                )
         else:
             state = (
                 click.style("Down", fg="red")
@@ -8,8 +8,14 @@
 import time
 import unittest
 
-from openr.cli.utils.utils import find_adj_list_deltas, parse_prefix_database
+from openr.cli.utils.utils import (
+    find_adj_list_deltas,
+    iter_pages,
+    parse_prefix_database,
+    run_for_nodes,
+)
 from openr.Network import ttypes as network_types
+from openr.OpenrCtrl import ttypes as ctrl_types
 from openr.Types import ttypes as openr_types
 from openr.utils import ipnetwork
 from openr.utils.serializer import object_to_dict
@@ -125,3 +131,41 @@ class UtilsTests(unittest.TestCase):
         data = {}
         parse_prefix_database("2.0.0.0/8", "bgp", data, prefix_db)
         self.assertEqual(data["node1"].prefixEntries, [bgp2])
+
+    def test_iter_pages(self) -> None:
+        routes = list(range(5))
+        page_params_list = []
+
+        def get_page(page_params):
+            page_params_list.append(page_params)
+            start = int(page_params.continuationToken or 0)
+            end = start + page_params.pageSize
+            next_token = str(end) if end < len(routes) else None
+            return ctrl_types.UnicastRoutesPage(
+                routes=routes[start:end],
+                pageInfo=ctrl_types.PageInfo(
+                    snapshotVersion=7, continuationToken=next_token
+                ),
+            )
+
+        pages = list(iter_pages(get_page, page_size=2))
+        self.assertEqual([[0, 1], [2, 3], [4]], [page.routes for page in pages])
+
+        # First page has no token, next ones pass token and snapshot version
+        self.assertIsNone(page_params_list[0].continuationToken)
+        self.assertIsNone(page_params_list[0].snapshotVersion)
+        self.assertEqual("2", page_params_list[1].continuationToken)
+        self.assertEqual(7, page_params_list[1].snapshotVersion)
+        self.assertEqual(2, page_params_list[2].pageSize)
+
+    def test_run_for_nodes(self) -> None:
+        # Results come back in order of nodes
+        results = list(run_for_nodes(["c", "a", "b"], lambda node: node * 2))
+        self.assertEqual([("c", "cc"), ("a", "aa"), ("b", "bb")], results)
+        self.assertEqual([], list(run_for_nodes([], lambda node: node)))
+
+        def fail(node):
+            raise RuntimeError(node)
+
+        with self.assertRaises(RuntimeError):
+            list(run_for_nodes(["a"], fail))
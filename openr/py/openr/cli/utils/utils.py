@@ -5,6 +5,7 @@
 # LICENSE file in the root directory of this source tree.
 
 
+import concurrent.futures
 import copy
 import curses
 import datetime
@@ -21,6 +22,7 @@ from typing import (
     Any,
     Dict,
     Iterable,
+    Iterator,
     List,
     Optional,
     Set,
@@ -1201,6 +1203,57 @@ def dump_node_kvs(
     return pub
 
 
+def iter_pages(
+    get_page: Callable[[ctrl_types.PageParams], Any],
+    page_size: int = Consts.DEFAULT_PAGE_SIZE,
+) -> Iterator[Any]:
+    """
+    Iterate pages of a paginated dump, see [Paginated Dump] in OpenrCtrl.thrift.
+    Pages are yielded as they arrive so callers can print them right away.
+
+    :param get_page: Function fetching the page for given page params, e.g.
+                     `client.getUnicastRoutesPage`
+    :param page_size: Max number of keys covered by a page
+    """
+
+    page_params = ctrl_types.PageParams(pageSize=page_size)
+    while True:
+        page = get_page(page_params)
+        yield page
+        if page.pageInfo.continuationToken is None:
+            return
+        page_params = ctrl_types.PageParams(
+            pageSize=page_size,
+            continuationToken=page.pageInfo.continuationToken,
+            snapshotVersion=page.pageInfo.snapshotVersion,
+        )
+
+
+def run_for_nodes(
+    nodes: Iterable[str],
+    func: Callable[[str], Any],
+    max_workers: int = Consts.MAX_PARALLEL_NODE_QUERIES,
+) -> Iterator[Tuple[str, Any]]:
+    """
+    Run `func` for every node in parallel, e.g. to query each node. Thrift
+    clients are not thread-safe, hence `func` must use a client of its own.
+
+    :return: (node, result) pairs in order of `nodes`. Each is yielded as soon
+             as it and the ones before it are done. Exception raised by `func`
+             is re-raised.
+    """
+
+    nodes = list(nodes)
+    if not nodes:
+        return
+    with concurrent.futures.ThreadPoolExecutor(
+        max_workers=min(max_workers, len(nodes))
+    ) as executor:
+        futures = [executor.submit(func, node) for node in nodes]
+        for node, future in zip(nodes, futures):
+            yield node, future.result()
+
+
 def print_allocations_table(alloc_str) -> None:
     """print static allocations"""
 
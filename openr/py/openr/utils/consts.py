@@ -17,6 +17,10 @@ class Consts:
     DEFAULT_TIMEOUT = 2  # seconds
     DEFAULT_FIB_AGENT_PORT = 5909
 
+    # Paginated dumps and multi-node queries
+    DEFAULT_PAGE_SIZE = 1000
+    MAX_PARALLEL_NODE_QUERIES = 16
+
     TIMEOUT_MS = 10000  # 10 seconds
     CONST_TTL_INF = -(2 ** 31)
     IP_TOS = 192
@@ -12,6 +12,98 @@
 #include <folly/logging/xlog.h>
 #include <openr/spark/IoProvider.h>
 
+namespace {
+
+// Control message buffer of a received message
+// XXX: hardcoded, but this hardly should be a problem
+union RecvCtrlBuf {
+  char ctrlBuf[CMSG_SPACE(1024)];
+  struct cmsghdr align;
+};
+
+// Control message buffer of a sent message, aligned by control message hdr
+union SendCtrlBuf {
+  char cbuf[CMSG_SPACE(sizeof(struct in6_pktinfo))];
+  struct cmsghdr align;
+};
+
+// Prepare message header to receive data into `buf`, along with control data
+// and address of the sender
+void
+initRecvMsg(
+    struct msghdr& msg,
+    struct iovec& entry,
+    RecvCtrlBuf& u,
+    sockaddr_storage& addrStorage,
+    unsigned char* buf,
+    int len) {
+  ::memset(&msg, 0, sizeof(msg));
+
+  // we only expect to receive one block of data, single entry
+  // in the vector
+  msg.msg_iov = &entry;
+  msg.msg_iovlen = 1;
+
+  // this part is important - if we don't zero the buffer,
+  // the CMSG_NXTHDR may burp, because it tries extracting
+  // fields from "next header" in the buffer
+  ::memset(&u.ctrlBuf[0], 0, sizeof(u.ctrlBuf));
+
+  // control message buffer used to receive dest IP from the kernel
+  msg.msg_control = u.ctrlBuf;
+  msg.msg_controllen = sizeof(u.ctrlBuf);
+
+  // prepare to receive either v4 or v6 addresses
+  ::memset(&addrStorage, 0, sizeof(addrStorage));
+  msg.msg_name = &addrStorage;
+  msg.msg_namelen = sizeof(sockaddr_storage);
+
+  // write the data here
+  entry.iov_base = buf;
+  entry.iov_len = len;
+}
+
+// Prepare message header to send `packet` to `addrStorage` via given interface
+// and source address
+void
+initSendMsg(
+    struct msghdr& msg,
+    struct iovec& entry,
+    SendCtrlBuf& u,
+    sockaddr_storage& addrStorage,
+    socklen_t addrLen,
+    int ifIndex,
+    folly::IPAddressV6 const& srcAddr,
+    std::string const& packet) {
+  ::memset(&msg, 0, sizeof(msg));
+  msg.msg_name = reinterpret_cast<void*>(&addrStorage);
+  msg.msg_namelen = addrLen;
+
+  // set the source address and source if index for this message
+  // this goes into ancilliary data fields
+  msg.msg_control = u.cbuf;
+  msg.msg_controllen = sizeof(u.cbuf);
+  struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+
+  cmsg->cmsg_level = IPPROTO_IPV6;
+  cmsg->cmsg_type = IPV6_PKTINFO;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(struct in6_pktinfo));
+
+  auto pktinfo = (struct in6_pktinfo*)CMSG_DATA(cmsg);
+  pktinfo->ipi6_ifindex = ifIndex;
+  ::memcpy(&pktinfo->ipi6_addr, srcAddr.bytes(), srcAddr.byteCount());
+
+  // the IO vector for data to be sent
+  msg.msg_iov = &entry;
+  msg.msg_iovlen = 1;
+
+  // write the data here (we need to remove the const qualifier)
+  entry.iov_base = const_cast<char*>(packet.data());
+  entry.iov_len = packet.size();
+}
+
+} // namespace
+
 namespace openr {
 
 int
@@ -68,20 +160,27 @@ IoProvider::sendmsg(int sockfd, const struct msghdr* msg, int flags) {
   return ::sendmsg(sockfd, msg, flags);
 }
 
-std::tuple<
-    ssize_t /* size */,
-    int /* ifIndex */,
-    folly::SocketAddress /* srcAddr */,
-    int /* hopLimit */,
-    std::chrono::microseconds /* kernel timestamp */>
+int
+IoProvider::recvmmsg(
+    int sockfd,
+    struct mmsghdr* msgvec,
+    unsigned int vlen,
+    int flags,
+    struct timespec* timeout) {
+  return ::recvmmsg(sockfd, msgvec, vlen, flags, timeout);
+}
+
+int
+IoProvider::sendmmsg(
+    int sockfd, struct mmsghdr* msgvec, unsigned int vlen, int flags) {
+  return ::sendmmsg(sockfd, msgvec, vlen, flags);
+}
+
+IoProvider::RecvResult
 IoProvider::recvMessage(
     int fd, unsigned char* buf, int len, openr::IoProvider* ioProvider) {
   // the control message buffer
-  // XXX: hardcoded, but this hardly should be a problem
-  union {
-    char ctrlBuf[CMSG_SPACE(1024)];
-    struct cmsghdr align;
-  } u;
+  RecvCtrlBuf u;
 
   // the message header to receive into
   struct msghdr msg;
@@ -92,30 +191,7 @@ IoProvider::recvMessage(
   // for address of the sender
   sockaddr_storage addrStorage;
 
-  ::memset(&msg, 0, sizeof(msg));
-
-  // we only expect to receive one block of data, single entry
-  // in the vector
-  msg.msg_iov = &entry;
-  msg.msg_iovlen = 1;
-
-  // this part is important - if we don't zero the buffer,
-  // the CMSG_NXTHDR may burp, because it tries extracting
-  // fields from "next header" in the buffer
-  ::memset(&u.ctrlBuf[0], 0, sizeof(u.ctrlBuf));
-
-  // control message buffer used to receive dest IP from the kernel
-  msg.msg_control = u.ctrlBuf;
-  msg.msg_controllen = sizeof(u.ctrlBuf);
-
-  // prepare to receive either v4 or v6 addresses
-  ::memset(&addrStorage, 0, sizeof(addrStorage));
-  msg.msg_name = &addrStorage;
-  msg.msg_namelen = sizeof(sockaddr_storage);
-
-  // write the data here
-  entry.iov_base = buf;
-  entry.iov_len = len;
+  initRecvMsg(msg, entry, u, addrStorage, buf, len);
 
   ssize_t bytesRead = ioProvider->recvmsg(fd, &msg, MSG_DONTWAIT);
 
@@ -128,6 +204,65 @@ IoProvider::recvMessage(
     throw std::runtime_error("Message truncated");
   }
 
+  return parseRecvMessage(msg, bytesRead, addrStorage);
+}
+
+std::vector<IoProvider::RecvResult>
+IoProvider::recvMessages(
+    int fd,
+    unsigned char* buf,
+    int len,
+    size_t numMsgs,
+    IoProvider* ioProvider) {
+  // control buffer, address of the sender and IO vector of every message
+  std::vector<RecvCtrlBuf> ctrlBufs(numMsgs);
+  std::vector<sockaddr_storage> addrStorages(numMsgs);
+  std::vector<struct iovec> entries(numMsgs);
+  std::vector<struct mmsghdr> msgs(numMsgs);
+  for (size_t i = 0; i < numMsgs; ++i) {
+    initRecvMsg(
+        msgs[i].msg_hdr,
+        entries[i],
+        ctrlBufs[i],
+        addrStorages[i],
+        buf + i * len,
+        len);
+    msgs[i].msg_len = 0;
+  }
+
+  const int numRead =
+      ioProvider->recvmmsg(fd, msgs.data(), numMsgs, MSG_DONTWAIT, nullptr);
+
+  if (numRead < 0) {
+    const int err = errno;
+    if (err == EAGAIN or err == EWOULDBLOCK) {
+      return {};
+    }
+    throw std::runtime_error(fmt::format(
+        "Failed reading messages on fd {}: {}", fd, folly::errnoStr(err)));
+  }
+
+  std::vector<RecvResult> results;
+  results.reserve(numRead);
+  for (int i = 0; i < numRead; ++i) {
+    auto& msg = msgs[i].msg_hdr;
+    if (msg.msg_flags & MSG_TRUNC) {
+      XLOG(ERR) << "Message truncated on fd " << fd;
+      results.emplace_back(
+          -1, -1, folly::SocketAddress(), 0, std::chrono::microseconds(0));
+      continue;
+    }
+    results.emplace_back(
+        parseRecvMessage(msg, msgs[i].msg_len, addrStorages[i]));
+  }
+  return results;
+}
+
+IoProvider::RecvResult
+IoProvider::parseRecvMessage(
+    struct msghdr& msg,
+    ssize_t bytesRead,
+    struct sockaddr_storage& addrStorage) {
   // grab the inIndex we received this packet on and the hopLimit
   // those are available since we requested them via socket options
   struct cmsghdr* cmsg{nullptr};
@@ -195,46 +330,71 @@ IoProvider::sendMessage(
     std::string const& packet,
     IoProvider* ioProvider) {
   struct msghdr msg;
-  struct cmsghdr* cmsg{nullptr};
-
-  // pack control buffer, aligned by control message hdr
-  union {
-    char cbuf[CMSG_SPACE(sizeof(struct in6_pktinfo))];
-    struct cmsghdr align;
-  } u;
+  struct iovec entry;
+  SendCtrlBuf u;
 
   // Set the destination address for the message
   sockaddr_storage addrStorage;
   dstAddr.getAddress(&addrStorage);
 
-  ::memset(&msg, 0, sizeof(msg));
-  msg.msg_name = reinterpret_cast<void*>(&addrStorage);
-  msg.msg_namelen = dstAddr.getActualSize();
+  initSendMsg(
+      msg,
+      entry,
+      u,
+      addrStorage,
+      dstAddr.getActualSize(),
+      ifIndex,
+      srcAddr,
+      packet);
 
-  // set the source address and source if index for this message
-  // this goes into ancilliary data fields
-  msg.msg_control = u.cbuf;
-  msg.msg_controllen = sizeof(u.cbuf);
-  cmsg = CMSG_FIRSTHDR(&msg);
-
-  cmsg->cmsg_level = IPPROTO_IPV6;
-  cmsg->cmsg_type = IPV6_PKTINFO;
-  cmsg->cmsg_len = CMSG_LEN(sizeof(struct in6_pktinfo));
-
-  auto pktinfo = (struct in6_pktinfo*)CMSG_DATA(cmsg);
-  pktinfo->ipi6_ifindex = ifIndex;
-  ::memcpy(&pktinfo->ipi6_addr, srcAddr.bytes(), srcAddr.byteCount());
+  return ioProvider->sendmsg(fd, &msg, MSG_DONTWAIT);
+}
 
-  // the IO vector for data to be sent
-  struct iovec entry;
-  msg.msg_iov = &entry;
-  msg.msg_iovlen = 1;
+std::vector<ssize_t>
+IoProvider::sendMessages(
+    int fd,
+    folly::SocketAddress const& dstAddr,
+    std::vector<SendRequest> const& requests,
+    IoProvider* ioProvider) {
+  // Destination address is shared by all messages
+  sockaddr_storage addrStorage;
+  dstAddr.getAddress(&addrStorage);
 
-  // write the data here (we need to remove the const qualifier)
-  entry.iov_base = const_cast<char*>(packet.data());
-  entry.iov_len = packet.size();
+  const size_t numMsgs = requests.size();
+  std::vector<SendCtrlBuf> ctrlBufs(numMsgs);
+  std::vector<struct iovec> entries(numMsgs);
+  std::vector<struct mmsghdr> msgs(numMsgs);
+  for (size_t i = 0; i < numMsgs; ++i) {
+    const auto& request = requests[i];
+    initSendMsg(
+        msgs[i].msg_hdr,
+        entries[i],
+        ctrlBufs[i],
+        addrStorage,
+        dstAddr.getActualSize(),
+        request.ifIndex,
+        request.srcAddr,
+        request.packet);
+    msgs[i].msg_len = 0;
+  }
 
-  return ioProvider->sendmsg(fd, &msg, MSG_DONTWAIT);
+  // sendmmsg() stops at the first message failing to be sent, and reports the
+  // error only if no message was sent. Skip the failing one and go on with the
+  // rest.
+  std::vector<ssize_t> results(numMsgs, 0);
+  size_t numSent = 0;
+  while (numSent < numMsgs) {
+    const int ret = ioProvider->sendmmsg(
+        fd, msgs.data() + numSent, numMsgs - numSent, MSG_DONTWAIT);
+    if (ret <= 0) {
+      results[numSent++] = ret < 0 ? -errno : -EAGAIN;
+      continue;
+    }
+    for (int i = 0; i < ret; ++i, ++numSent) {
+      results[numSent] = msgs[numSent].msg_len;
+    }
+  }
+  return results;
 }
 
 } // namespace openr
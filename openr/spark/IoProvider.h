@@ -13,6 +13,9 @@
 #include <sys/types.h>
 #include <unistd.h>
 #include <chrono>
+#include <string>
+#include <tuple>
+#include <vector>
 
 #include <folly/IPAddress.h>
 #include <folly/SocketAddress.h>
@@ -60,22 +63,47 @@ class IoProvider {
 
   virtual ssize_t sendmsg(int sockfd, const struct msghdr* msg, int flags);
 
+  virtual int recvmmsg(
+      int sockfd,
+      struct mmsghdr* msgvec,
+      unsigned int vlen,
+      int flags,
+      struct timespec* timeout);
+
+  virtual int sendmmsg(
+      int sockfd, struct mmsghdr* msgvec, unsigned int vlen, int flags);
+
   virtual int setsockopt(
       int sockfd, int level, int optname, const void* optval, socklen_t optlen);
 
   // Utility functions that operate on sockets
 
-  /*
-   * Receive a message on fd, and return its size, interface index,
-   * and the source address
-   */
-  static std::tuple<
+  using RecvResult = std::tuple<
       ssize_t /* size */,
       int /* ifIndex */,
       folly::SocketAddress /* srcAddr */,
       int /* hopLimit */,
-      std::chrono::microseconds /* kernel timestamp */>
-  recvMessage(int fd, unsigned char* buf, int len, IoProvider* ioProvider);
+      std::chrono::microseconds /* kernel timestamp */>;
+
+  /*
+   * Receive a message on fd, and return its size, interface index,
+   * and the source address
+   */
+  static RecvResult recvMessage(
+      int fd, unsigned char* buf, int len, IoProvider* ioProvider);
+
+  /*
+   * Receive up to `numMsgs` messages on fd with a single syscall, message i
+   * into `len` bytes at `buf + i * len`. Returns the same as `recvMessage()`
+   * for every message received, in order, with size -1 for truncated ones.
+   * Returns no message if none is pending.
+   */
+  static std::vector<RecvResult> recvMessages(
+      int fd,
+      unsigned char* buf,
+      int len,
+      size_t numMsgs,
+      IoProvider* ioProvider);
 
   /*
    * Send message on fd via given interface to the address provided
@@ -89,7 +117,32 @@ class IoProvider {
       std::string const& packet,
       IoProvider* ioProvider);
 
+  // Message to be sent by `sendMessages()`
+  struct SendRequest {
+    int ifIndex{0};
+    folly::IPAddressV6 srcAddr;
+    std::string packet;
+  };
+
+  /*
+   * Send every message on fd via its own interface to the address provided,
+   * in as few syscalls as possible. Returns the number of bytes sent for
+   * every message, in order, or negated errno of its failure.
+   */
+  static std::vector<ssize_t> sendMessages(
+      int fd,
+      folly::SocketAddress const& dstAddr,
+      std::vector<SendRequest> const& requests,
+      IoProvider* ioProvider);
+
  private:
+  // Extract interface index, hop limit and timestamp from control data of a
+  // received message
+  static RecvResult parseRecvMessage(
+      struct msghdr& msg,
+      ssize_t bytesRead,
+      struct sockaddr_storage& addrStorage);
+
   IoProvider(IoProvider const&) = delete;
   IoProvider& operator=(IoProvider const&) = delete;
 };
@@ -5,9 +5,13 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
+#include <iterator>
+
 #include <fb303/ServiceData.h>
 #include <folly/IPAddress.h>
 #include <folly/SocketAddress.h>
+#include <folly/Varint.h>
 #include <folly/futures/Future.h>
 #include <folly/futures/Promise.h>
 #include <folly/logging/xlog.h>
@@ -39,6 +43,73 @@ const int kSparkHopLimit = 255;
 // number of restarting packets to send out per interface before I'm going down
 const int kNumRestartingPktSent = 3;
 
+//
+// Number of packets read per syscall, and max number of such reads per wakeup
+// so that timers are not starved under a burst of packets
+//
+const size_t kRecvBatchSize = 16;
+const size_t kMaxRecvBatches = 8;
+
+//
+// Heartbeat msgs of interfaces due within this window are sent in one syscall.
+// It is small compared to the hold time, which is a multiple of the keep-alive
+// time.
+//
+const std::chrono::milliseconds kHeartbeatBatchWindow{50};
+
+//
+// Max number of (neighbor, interface) pairs with memoized area. Cache is
+// cleared once full, which only happens with unusually many neighbors.
+//
+const size_t kMaxNeighborAreaCacheSize = 4096;
+
+//
+// Number of heartbeat msgs sent over an interface without any neighbor
+// instability before its keep-alive time is doubled under adaptive keep-alive
+//
+const uint32_t kAdaptiveKeepAliveStableHeartbeats = 30;
+
+//
+// Type of SparkHelloPacket from compact protocol header of its first field,
+// i.e. (field-id delta << 4 | struct type), without deserializing it
+//
+const char*
+getPacketTypeName(const uint8_t* buf, ssize_t len) {
+  if (len <= 0) {
+    return "unknown";
+  }
+  switch (buf[0]) {
+  case 0x3C: // 3: helloMsg
+    return "hello";
+  case 0x4C: // 4: heartbeatMsg
+    return "heartbeat";
+  case 0x5C: // 5: handshakeMsg
+    return "handshake";
+  default:
+    return "unknown";
+  }
+}
+
+//
+// Number of times keep-alive time can be doubled without exceeding the max
+//
+uint32_t
+getMaxKeepAliveLevel(openr::Config const& config) {
+  const auto maxKeepAliveTimeMs =
+      config.getSparkConfig().max_keepalive_time_ms_ref();
+  if (not maxKeepAliveTimeMs.has_value()) {
+    return 0;
+  }
+  uint32_t level{0};
+  auto keepAliveTime = config.getSparkKeepAliveTime();
+  while (keepAliveTime * 2 <=
+         std::chrono::milliseconds(*maxKeepAliveTimeMs)) {
+    keepAliveTime *= 2;
+    ++level;
+  }
+  return level;
+}
+
 //
 // Subscribe/unsubscribe to a multicast group on given interface
 //
@@ -292,7 +363,8 @@ Spark::Spark(
     std::shared_ptr<IoProvider> ioProvider,
     std::shared_ptr<const Config> config,
     std::pair<uint32_t, uint32_t> version,
-    std::optional<uint32_t> maybeMaxAllowedPps)
+    std::optional<uint32_t> maybeMaxAllowedPps,
+    uint32_t shardId)
     : myDomainName_(*config->getConfig().domain_ref()),
       myNodeName_(config->getNodeName()),
       neighborDiscoveryPort_(static_cast<uint16_t>(
@@ -304,17 +376,17 @@ Spark::Spark(
       handshakeTime_(std::chrono::milliseconds(
           *config->getSparkConfig().fastinit_hello_time_ms_ref())),
       initializationHoldTime_(3 * fastInitHelloTime_ + handshakeTime_),
-      keepAliveTime_(std::chrono::seconds(
-          *config->getSparkConfig().keepalive_time_s_ref())),
-      handshakeHoldTime_(std::chrono::seconds(
-          *config->getSparkConfig().keepalive_time_s_ref())),
-      holdTime_(
-          std::chrono::seconds(*config->getSparkConfig().hold_time_s_ref())),
+      keepAliveTime_(config->getSparkKeepAliveTime()),
+      handshakeHoldTime_(config->getSparkKeepAliveTime()),
+      holdTime_(config->getSparkHoldTime()),
       gracefulRestartTime_(std::chrono::seconds(
           *config->getSparkConfig().graceful_restart_time_s_ref())),
       enableV4_(config->isV4Enabled()),
       v4OverV6Nexthop_(config->isV4OverV6NexthopEnabled()),
       enableFloodOptimization_(config->isFloodOptimizationEnabled()),
+      shardId_(shardId),
+      numShards_(*config->getSparkConfig().num_shards_ref()),
+      maxKeepAliveLevel_(getMaxKeepAliveLevel(*config)),
       neighborUpdatesQueue_(neighborUpdatesQueue),
       kOpenrCtrlThriftPort_(
           *config->getThriftServerConfig().openr_ctrl_port_ref()),
@@ -325,6 +397,7 @@ Spark::Spark(
       config_(std::move(config)) {
   CHECK(gracefulRestartTime_ >= 3 * keepAliveTime_)
       << "Keep-alive-time must be less than hold-time.";
+  CHECK_LT(shardId_, numShards_) << "Invalid Spark shard";
   CHECK(keepAliveTime_ > std::chrono::milliseconds(0))
       << "heartbeatMsg interval can't be 0";
   CHECK(helloTime_ > std::chrono::milliseconds(0))
@@ -335,16 +408,10 @@ Spark::Spark(
       << "fastInit helloMsg interval must be smaller than normal interval";
   CHECK(ioProvider_) << "Got null IoProvider";
 
-  // Initialize list of BucketedTimeSeries
-  const std::chrono::seconds sec{1};
+  // Initialize list of token buckets
   if (maybeMaxAllowedPps) {
     maybeMaxAllowedPps_ = maybeMaxAllowedPps;
-    const int32_t numBuckets = *maybeMaxAllowedPps_ / 3;
-    for (size_t i = 0; i < Constants::kNumTimeSeries; i++) {
-      timeSeriesVector_.emplace_back(
-          folly::BucketedTimeSeries<int64_t, std::chrono::steady_clock>(
-              numBuckets, sec));
-    }
+    neighborTokenBuckets_.resize(Constants::kNumTimeSeries);
   }
   // Timer for collecting neighbors successfully discovered and publishing them
   // to neighborUpdatesQueue_ in OpenR initialization procedure.
@@ -568,6 +635,21 @@ Spark::prepareSocket() noexcept {
   });
   XLOG(INFO) << "Attached socket/events callbacks...";
 
+  // buffer to receive batch of packets into
+  recvBuf_.resize(kRecvBatchSize * kMinIpv6Mtu);
+
+  // send heartbeat msgs due within batching window
+  heartbeatBatchTimer_ =
+      folly::AsyncTimeout::make(*getEvb(), [this]() noexcept {
+        auto ifNames = std::move(pendingHeartbeatIfNames_);
+        pendingHeartbeatIfNames_.clear();
+        sendHeartbeatMsgs(ifNames);
+      });
+
+  // fire per neighbor timers
+  neighborTimersTimeout_ = folly::AsyncTimeout::make(
+      *getEvb(), [this]() noexcept { processNeighborTimers(); });
+
   // update counters every few seconds
   counterUpdateTimer_ = folly::AsyncTimeout::make(*getEvb(), [this]() noexcept {
     updateGlobalCounters();
@@ -609,42 +691,68 @@ Spark::sanityCheckMsg(
 
 bool
 Spark::shouldProcessPacket(
-    std::string const& ifName, folly::IPAddress const& addr) {
+    std::string const& ifName,
+    folly::IPAddress const& addr,
+    bool isEstablishedHeartbeat) {
   if (not maybeMaxAllowedPps_.has_value()) {
     return true; // no rate limit
   }
 
+  // burst of one second worth of pkts
+  const auto now = folly::DynamicTokenBucket::defaultClockNow();
+  const double neighborPps = *maybeMaxAllowedPps_;
   size_t index = std::hash<std::tuple<std::string, folly::IPAddress>>{}(
                      std::make_tuple(ifName, addr)) %
       Constants::kNumTimeSeries;
-  // check our timeseries to see if we want to process anymore right now
-  timeSeriesVector_[index].update(std::chrono::steady_clock::now());
-
-  if (timeSeriesVector_[index].count() > *maybeMaxAllowedPps_) {
+  if (not neighborTokenBuckets_[index].consume(
+          1, neighborPps, neighborPps, now)) {
     // drop the packet
     return false;
   }
-  // otherwise, count this packet and process it
-  timeSeriesVector_[index].addValue(std::chrono::steady_clock::now(), 1);
 
-  return true;
+  // ATTN: heartbeat keeps established adjacency up. Don't let hello storm
+  // from a misbehaving peer over the same interface flap it.
+  if (isEstablishedHeartbeat) {
+    return true;
+  }
+
+  const double ifPps =
+      neighborPps * Constants::kMaxAllowedPpsPerInterfaceFactor;
+  return ifNameToTokenBuckets_[ifName].consume(1, ifPps, ifPps, now);
+}
+
+bool
+Spark::isNeighborEstablished(
+    std::string const& ifName, std::string const& neighborName) const {
+  auto ifIt = sparkNeighbors_.find(ifName);
+  if (ifIt == sparkNeighbors_.end()) {
+    return false;
+  }
+  auto neighborIt = ifIt->second.find(neighborName);
+  return neighborIt != ifIt->second.end() and
+      neighborIt->second.state == thrift::SparkNeighState::ESTABLISHED;
 }
 
 bool
 Spark::parsePacket(
+    const uint8_t* buf,
+    IoProvider::RecvResult const& recvResult,
     thrift::SparkHelloPacket& pkt,
     std::string& ifName,
     std::chrono::microseconds& recvTime) {
-  // the read buffer
-  uint8_t buf[kMinIpv6Mtu];
-
   ssize_t bytesRead;
   int ifIndex;
   folly::SocketAddress clientAddr;
   int hopLimit;
 
-  std::tie(bytesRead, ifIndex, clientAddr, hopLimit, recvTime) =
-      IoProvider::recvMessage(mcastFd_, buf, kMinIpv6Mtu, ioProvider_.get());
+  std::tie(bytesRead, ifIndex, clientAddr, hopLimit, recvTime) = recvResult;
+
+  // truncated pkt
+  if (bytesRead < 0) {
+    XLOG(ERR) << fmt::format(
+        "Dropping truncated pkt read from fd: {}", mcastFd_);
+    return false;
+  }
 
   if (hopLimit < kSparkHopLimit) {
     XLOG(ERR) << fmt::format(
@@ -656,6 +764,15 @@ Spark::parsePacket(
   }
 
   auto res = findInterfaceFromIfindex(ifIndex);
+  if (!res.has_value() and numShards_ > 1) {
+    // pkt of interface owned by other shard, or not tracked at all
+    XLOG(DBG4) << fmt::format(
+        "Skip pkt from {} with ifIndex: {} NOT tracked by shard: {}",
+        clientAddr.getAddressStr(),
+        ifIndex,
+        shardId_);
+    return false;
+  }
   if (!res.has_value()) {
     XLOG(ERR) << fmt::format(
         "Received packet from {} with unknown ifIndex: {}. Skip processing.",
@@ -668,38 +785,51 @@ Spark::parsePacket(
   ifName = res.value();
 
   // update counters for packets received, dropped and processed
-  fb303::fbData->addStatValue("spark.packet_recv", 1, fb303::SUM);
+  packetRecvStat_.add();
 
   // update counters for total size of packets received
-  fb303::fbData->addStatValue("spark.packet_recv_size", bytesRead, fb303::SUM);
+  packetRecvSizeStat_.add(bytesRead);
 
-  if (not shouldProcessPacket(ifName, clientAddr.getIPAddress())) {
+  XLOG(DBG3) << fmt::format(
+      "Read a total of {} bytes from fd {}", bytesRead, mcastFd_);
+
+  if (static_cast<size_t>(bytesRead) > kMinIpv6Mtu) {
     XLOG(ERR) << fmt::format(
-        "Dropping pkt due to rate limiting on iface: {} from addr: {}",
+        "Message from {} has been truncated.", clientAddr.getAddressStr());
+    return false;
+  }
+
+  // Fast path for heartbeat msg, the vast majority of pkts. Decoded ahead of
+  // rate limiting to tell heartbeat of established neighbor.
+  auto heartbeatMsg = decodeHeartbeatPacket(folly::ByteRange(buf, bytesRead));
+  const bool isEstablishedHeartbeat = heartbeatMsg.has_value() and
+      isNeighborEstablished(ifName, *heartbeatMsg->nodeName_ref());
+
+  if (not shouldProcessPacket(
+          ifName, clientAddr.getIPAddress(), isEstablishedHeartbeat)) {
+    const auto packetType = heartbeatMsg.has_value()
+        ? "heartbeat"
+        : getPacketTypeName(buf, bytesRead);
+    XLOG(ERR) << fmt::format(
+        "Dropping {} pkt due to rate limiting on iface: {} from addr: {}",
+        packetType,
         ifName,
         clientAddr.getAddressStr());
 
     fb303::fbData->addStatValue("spark.packet_dropped", 1, fb303::SUM);
+    fb303::fbData->addStatValue(
+        fmt::format("spark.packet_dropped.{}", packetType), 1, fb303::SUM);
     return false;
   }
 
-  fb303::fbData->addStatValue("spark.packet_processed", 1, fb303::SUM);
+  packetProcessedStat_.add();
 
-  if (bytesRead >= 0) {
-    XLOG(DBG3) << fmt::format(
-        "Read a total of {} bytes from fd {}", bytesRead, mcastFd_);
-
-    if (static_cast<size_t>(bytesRead) > kMinIpv6Mtu) {
-      XLOG(ERR) << fmt::format(
-          "Message from {} has been truncated.", clientAddr.getAddressStr());
-      return false;
-    }
-  } else {
-    XLOG(ERR) << fmt::format(
-        "Failed reading from fd: {} with error: {}",
-        mcastFd_,
-        folly::errnoStr(errno));
-    return false;
+  if (heartbeatMsg.has_value()) {
+    pkt = thrift::SparkHelloPacket();
+    pkt.heartbeatMsg_ref() = std::move(heartbeatMsg.value());
+    fb303::fbData->addStatValue(
+        "spark.heartbeat.fast_path_decoded", 1, fb303::SUM);
+    return true;
   }
 
   // Copy buffer into string object and parse it into helloPacket.
@@ -723,6 +853,72 @@ Spark::parsePacket(
   return true;
 }
 
+std::optional<thrift::SparkHeartbeatMsg>
+Spark::decodeHeartbeatPacket(folly::ByteRange data) {
+  // Compact protocol field headers, i.e. (field-id delta << 4 | type), of
+  // SparkHelloPacket with heartbeatMsg only. Fields are serialized in order.
+  constexpr uint8_t kHeartbeatMsgField{0x4C}; // 4: struct
+  constexpr uint8_t kNodeNameField{0x18}; // 1: string
+  constexpr uint8_t kSeqNumField{0x16}; // 2: i64
+  constexpr uint8_t kHoldAdjacencyTrueField{0x11}; // 3: bool true
+  constexpr uint8_t kHoldAdjacencyFalseField{0x12}; // 3: bool false
+  constexpr uint8_t kHoldTimeField{0x16}; // 4: i64
+  constexpr uint8_t kStop{0x00};
+
+  if (data.size() < 2 or data[0] != kHeartbeatMsgField or
+      data[1] != kNodeNameField) {
+    return std::nullopt;
+  }
+  data.advance(2);
+
+  thrift::SparkHeartbeatMsg heartbeatMsg;
+  auto nodeNameLen = folly::tryDecodeVarint(data);
+  if (nodeNameLen.hasError() or nodeNameLen.value() > data.size()) {
+    return std::nullopt;
+  }
+  heartbeatMsg.nodeName_ref() = std::string(
+      reinterpret_cast<const char*>(data.data()), nodeNameLen.value());
+  data.advance(nodeNameLen.value());
+
+  if (data.empty() or data[0] != kSeqNumField) {
+    return std::nullopt;
+  }
+  data.advance(1);
+  auto seqNum = folly::tryDecodeVarint(data);
+  if (seqNum.hasError()) {
+    return std::nullopt;
+  }
+  heartbeatMsg.seqNum_ref() = folly::decodeZigZag(seqNum.value());
+
+  if (data.empty()) {
+    return std::nullopt;
+  }
+  if (data[0] == kHoldAdjacencyTrueField) {
+    heartbeatMsg.holdAdjacency_ref() = true;
+  } else if (data[0] == kHoldAdjacencyFalseField) {
+    heartbeatMsg.holdAdjacency_ref() = false;
+  } else {
+    return std::nullopt;
+  }
+  data.advance(1);
+
+  // optional holdTime under adaptive keep-alive
+  if ((not data.empty()) and data[0] == kHoldTimeField) {
+    data.advance(1);
+    auto holdTime = folly::tryDecodeVarint(data);
+    if (holdTime.hasError()) {
+      return std::nullopt;
+    }
+    heartbeatMsg.holdTime_ref() = folly::decodeZigZag(holdTime.value());
+  }
+
+  // end of heartbeatMsg and end of pkt
+  if (data.size() != 2 or data[0] != kStop or data[1] != kStop) {
+    return std::nullopt;
+  }
+  return heartbeatMsg;
+}
+
 PacketValidationResult
 Spark::validateV4AddressSubnet(
     std::string const& ifName, thrift::BinaryAddress neighV4Addr) {
@@ -785,6 +981,9 @@ Spark::processRttChange(
   // update rtt value
   sparkNeighbor.rtt = roundedNewRtt;
 
+  // link is not stable, detect failure over it as fast as configured
+  resetKeepAlive(ifName);
+
   // notify the rtt changes if use the rtt metric
   if (*config_->getLinkMonitorConfig().use_rtt_metric_ref()) {
     XLOG(DBG1) << fmt::format(
@@ -907,7 +1106,7 @@ Spark::sendHandshakeMsg(
   thrift::SparkHandshakeMsg handshakeMsg;
   handshakeMsg.nodeName_ref() = myNodeName_;
   handshakeMsg.isAdjEstablished_ref() = isAdjEstablished;
-  handshakeMsg.holdTime_ref() = holdTime_.count();
+  handshakeMsg.holdTime_ref() = getHoldTime(ifName).count();
   handshakeMsg.gracefulRestartTime_ref() = gracefulRestartTime_.count();
   handshakeMsg.transportAddressV6_ref() = toBinaryAddress(v6Addr);
   handshakeMsg.transportAddressV4_ref() = toBinaryAddress(v4Addr);
@@ -918,6 +1117,8 @@ Spark::sendHandshakeMsg(
   handshakeMsg.neighborNodeName_ref() = neighborName;
   // ATTN: notify peer if I can support DUAL or not
   handshakeMsg.enableFloodOptimization_ref() = enableFloodOptimization_;
+  // ATTN: notify peer that I honor hold time of its heartbeat msg
+  handshakeMsg.enableAdaptiveHoldTime_ref() = true;
 
   thrift::SparkHelloPacket pkt;
   pkt.handshakeMsg_ref() = std::move(handshakeMsg);
@@ -968,82 +1169,251 @@ Spark::sendHandshakeMsg(
 }
 
 void
-Spark::sendHeartbeatMsg(std::string const& ifName) {
-  SCOPE_EXIT {
-    // increment seq# after packet has been sent (even if it didnt go out)
-    ++mySeqNum_;
-  };
+Spark::queueHeartbeatMsg(std::string const& ifName) {
+  if (std::find(
+          pendingHeartbeatIfNames_.begin(),
+          pendingHeartbeatIfNames_.end(),
+          ifName) != pendingHeartbeatIfNames_.end()) {
+    return;
+  }
+  pendingHeartbeatIfNames_.emplace_back(ifName);
+  if (not heartbeatBatchTimer_->isScheduled()) {
+    // ATTN: keep batching window small compared to keep-alive time under
+    // fast failure detection
+    heartbeatBatchTimer_->scheduleTimeout(
+        std::min<std::chrono::milliseconds>(
+            kHeartbeatBatchWindow, keepAliveTime_ / 4));
+  }
+}
 
-  SCOPE_FAIL {
-    XLOG(ERR) << fmt::format(
-        "[SparkHeartbeatMsg] Failed sending pkt over: {}", ifName);
-  };
+std::string
+Spark::getHeartbeatPacket(
+    int64_t seqNum, bool holdAdjacency, std::optional<int64_t> holdTime) {
+  const auto key = std::make_pair(holdAdjacency, holdTime);
+  auto cacheIt = heartbeatPacketCache_.find(key);
+  if (cacheIt == heartbeatPacketCache_.end()) {
+    auto serialize = [&](int64_t seq) {
+      thrift::SparkHeartbeatMsg heartbeatMsg;
+      heartbeatMsg.nodeName_ref() = myNodeName_;
+      heartbeatMsg.seqNum_ref() = seq;
+      heartbeatMsg.holdAdjacency_ref() = holdAdjacency;
+      if (holdTime.has_value()) {
+        heartbeatMsg.holdTime_ref() = holdTime.value();
+      }
 
-  if (ifNameToActiveNeighbors_.find(ifName) == ifNameToActiveNeighbors_.end()) {
-    XLOG(DBG3) << fmt::format(
-        "[SparkHeartbeatMsg] Interface: {} does NOT have any active neighbors. Skip sending.",
-        ifName);
-    return;
+      thrift::SparkHelloPacket pkt;
+      pkt.heartbeatMsg_ref() = std::move(heartbeatMsg);
+      return writeThriftObjStr(pkt, serializer_);
+    };
+
+    // Compact protocol encodes seqNum as zigzag varint, single byte for both
+    // 0 and 1. The only byte differing between the two pkts is the seqNum.
+    const auto pkt0 = serialize(0);
+    const auto pkt1 = serialize(1);
+    CHECK_EQ(pkt0.size(), pkt1.size());
+    const auto offset = static_cast<size_t>(
+        std::mismatch(pkt0.begin(), pkt0.end(), pkt1.begin()).first -
+        pkt0.begin());
+    CHECK_LT(offset, pkt0.size());
+    CHECK(std::equal(
+        pkt0.begin() + offset + 1, pkt0.end(), pkt1.begin() + offset + 1));
+
+    HeartbeatPacketCache packetCache{
+        pkt0.substr(0, offset), pkt0.substr(offset + 1)};
+    cacheIt = heartbeatPacketCache_.emplace(key, std::move(packetCache)).first;
+    fb303::fbData->addStatValue(
+        "spark.heartbeat.packet_cache_miss", 1, fb303::SUM);
   }
 
-  // in some cases, getting link-local address may fail and throw
-  // e.g. when iface has not yet auto-configured it, or iface is removed but
-  // down event has not arrived yet
-  const auto& interfaceEntry = interfaceDb_.at(ifName);
-  const auto ifIndex = interfaceEntry.ifIndex;
-  const auto v6Addr = interfaceEntry.v6LinkLocalNetwork.first;
+  // patch in encoded seqNum
+  uint8_t seqNumBuf[folly::kMaxVarintLength64];
+  const auto seqNumLen =
+      folly::encodeVarint(folly::encodeZigZag(seqNum), seqNumBuf);
 
-  // build heartbeat msg
-  thrift::SparkHeartbeatMsg heartbeatMsg;
-  heartbeatMsg.nodeName_ref() = myNodeName_;
-  heartbeatMsg.seqNum_ref() = mySeqNum_;
-  heartbeatMsg.holdAdjacency_ref() = false;
-  if (enableOrderedAdjPublication_) {
-    // ATTN: notify peer to set special adjacency flag when node is still within
-    // initialization procedure
-    heartbeatMsg.holdAdjacency_ref() = (not initialized_);
+  const auto& cache = cacheIt->second;
+  std::string packet;
+  packet.reserve(cache.prefix.size() + seqNumLen + cache.suffix.size());
+  packet.append(cache.prefix);
+  packet.append(reinterpret_cast<const char*>(seqNumBuf), seqNumLen);
+  packet.append(cache.suffix);
+  return packet;
+}
+
+std::chrono::milliseconds
+Spark::getKeepAliveTime(std::string const& ifName) const {
+  auto it = ifNameToAdaptiveKeepAlive_.find(ifName);
+  if (it == ifNameToAdaptiveKeepAlive_.end()) {
+    return keepAliveTime_;
   }
+  return keepAliveTime_ * (uint64_t{1} << it->second.level);
+}
 
-  thrift::SparkHelloPacket pkt;
-  pkt.heartbeatMsg_ref() = std::move(heartbeatMsg);
+std::chrono::milliseconds
+Spark::getHoldTime(std::string const& ifName) const {
+  auto it = ifNameToAdaptiveKeepAlive_.find(ifName);
+  if (it == ifNameToAdaptiveKeepAlive_.end()) {
+    return holdTime_;
+  }
+  return holdTime_ * (uint64_t{1} << it->second.level);
+}
 
-  auto packet = writeThriftObjStr(pkt, serializer_);
+void
+Spark::backoffKeepAlive(std::string const& ifName) {
+  if (maxKeepAliveLevel_ == 0 or
+      ifNameToActiveNeighbors_.find(ifName) == ifNameToActiveNeighbors_.end()) {
+    return;
+  }
 
-  // send the pkt
-  folly::SocketAddress dstAddr(
-      folly::IPAddress(Constants::kSparkMcastAddr.toString()),
-      neighborDiscoveryPort_);
+  auto& adaptiveKeepAlive = ifNameToAdaptiveKeepAlive_[ifName];
+  if (adaptiveKeepAlive.level >= maxKeepAliveLevel_) {
+    return;
+  }
 
-  if (kMinIpv6Mtu < packet.size()) {
-    XLOG(ERR) << "[SparkHeartbeatMsg] Heartbeat pkt is too big. Abort sending.";
+  // ATTN: neighbor NOT honoring hold time of heartbeat msg keeps the one
+  // negotiated via handshake msg, i.e. at current level
+  for (const auto& [_, neighbor] : sparkNeighbors_.at(ifName)) {
+    if (neighbor.state == thrift::SparkNeighState::ESTABLISHED and
+        (not neighbor.enableAdaptiveHoldTime)) {
+      adaptiveKeepAlive.stableHeartbeats = 0;
+      return;
+    }
+  }
+
+  if (++adaptiveKeepAlive.stableHeartbeats <
+      kAdaptiveKeepAliveStableHeartbeats) {
     return;
   }
+  ++adaptiveKeepAlive.level;
+  adaptiveKeepAlive.stableHeartbeats = 0;
 
-  auto bytesSent = IoProvider::sendMessage(
-      mcastFd_, ifIndex, v6Addr.asV6(), dstAddr, packet, ioProvider_.get());
+  XLOG(INFO) << fmt::format(
+      "[SparkHeartbeatMsg] Backing off keep-alive time over iface: {} to {}ms, hold time: {}ms",
+      ifName,
+      getKeepAliveTime(ifName).count(),
+      getHoldTime(ifName).count());
+  fb303::fbData->addStatValue(
+      "spark.heartbeat.keepalive_backoff", 1, fb303::SUM);
+}
 
-  if ((bytesSent < 0) || (static_cast<size_t>(bytesSent) != packet.size())) {
-    XLOG(ERR) << fmt::format(
-        "[SparkHeartbeatMsg] Failed sending pkt towards: {} over: {} due to error: {}",
-        dstAddr.getAddressStr(),
-        ifName,
-        folly::errnoStr(errno));
+void
+Spark::resetKeepAlive(std::string const& ifName) {
+  auto it = ifNameToAdaptiveKeepAlive_.find(ifName);
+  if (it == ifNameToAdaptiveKeepAlive_.end()) {
+    return;
+  }
+  const bool isBackedOff = it->second.level > 0;
+  ifNameToAdaptiveKeepAlive_.erase(it);
+  if (not isBackedOff) {
     return;
   }
 
-  // update telemetry for SparkHeartbeatMsg
-  for (auto& [_, neighbor] : sparkNeighbors_.at(ifName)) {
-    neighbor.lastHeartbeatMsgSentAt =
-        getCurrentTime<std::chrono::milliseconds>();
+  XLOG(INFO) << fmt::format(
+      "[SparkHeartbeatMsg] Resetting keep-alive time over iface: {} to {}ms",
+      ifName,
+      keepAliveTime_.count());
+  fb303::fbData->addStatValue(
+      "spark.heartbeat.keepalive_reset", 1, fb303::SUM);
+
+  // don't wait for the backed off interval to send the next heartbeat msg
+  auto timerIt = ifNameToHeartbeatTimers_.find(ifName);
+  if (timerIt != ifNameToHeartbeatTimers_.end()) {
+    timerIt->second->scheduleTimeout(
+        addJitter<std::chrono::milliseconds>(keepAliveTime_));
+  }
+}
+
+void
+Spark::sendHeartbeatMsgs(std::vector<std::string> const& ifNames) {
+  // build heartbeat msg of every interface
+  std::vector<std::string> sendIfNames;
+  std::vector<IoProvider::SendRequest> requests;
+  std::vector<uint64_t> seqNums;
+  for (const auto& ifName : ifNames) {
+    if (ifNameToActiveNeighbors_.find(ifName) ==
+        ifNameToActiveNeighbors_.end()) {
+      XLOG(DBG3) << fmt::format(
+          "[SparkHeartbeatMsg] Interface: {} does NOT have any active neighbors. Skip sending.",
+          ifName);
+      continue;
+    }
+
+    // interface may have been removed since heartbeat msg got queued
+    auto it = interfaceDb_.find(ifName);
+    if (it == interfaceDb_.end()) {
+      XLOG(DBG3) << fmt::format(
+          "[SparkHeartbeatMsg] Interface: {} is no longer being tracked.",
+          ifName);
+      continue;
+    }
+    const auto& interfaceEntry = it->second;
+
+    // ATTN: notify peer to set special adjacency flag when node is still
+    // within initialization procedure
+    const bool holdAdjacency = enableOrderedAdjPublication_ and
+        (not initialized_);
+    // ATTN: advertise hold time of interface under adaptive keep-alive only
+    const auto holdTime = maxKeepAliveLevel_ > 0
+        ? std::make_optional<int64_t>(getHoldTime(ifName).count())
+        : std::nullopt;
+    auto packet = getHeartbeatPacket(mySeqNum_, holdAdjacency, holdTime);
+
+    // increment seq# after packet has been built (even if it didnt go out)
+    seqNums.emplace_back(mySeqNum_++);
+
+    if (kMinIpv6Mtu < packet.size()) {
+      XLOG(ERR)
+          << "[SparkHeartbeatMsg] Heartbeat pkt is too big. Abort sending.";
+      seqNums.pop_back();
+      continue;
+    }
+
+    requests.emplace_back(IoProvider::SendRequest{
+        interfaceEntry.ifIndex,
+        interfaceEntry.v6LinkLocalNetwork.first.asV6(),
+        std::move(packet)});
+    sendIfNames.emplace_back(ifName);
+  }
+
+  if (requests.empty()) {
+    return;
   }
 
+  // send all pkts at once
+  folly::SocketAddress dstAddr(
+      folly::IPAddress(Constants::kSparkMcastAddr.toString()),
+      neighborDiscoveryPort_);
+  const auto results = IoProvider::sendMessages(
+      mcastFd_, dstAddr, requests, ioProvider_.get());
   fb303::fbData->addStatValue(
-      "spark.heartbeat.bytes_sent", packet.size(), fb303::SUM);
-  fb303::fbData->addStatValue("spark.heartbeat.packet_sent", 1, fb303::SUM);
+      "spark.heartbeat.send_batch_size", requests.size(), fb303::AVG);
 
-  XLOG(DBG2) << "[SparkHeartbeatMsg] Successfully sent " << bytesSent
-             << " bytes over intf: " << ifName
-             << ", with sequenceId: " << mySeqNum_;
+  for (size_t i = 0; i < results.size(); ++i) {
+    const auto& ifName = sendIfNames.at(i);
+    const auto& packet = requests.at(i).packet;
+    const auto bytesSent = results.at(i);
+
+    if ((bytesSent < 0) || (static_cast<size_t>(bytesSent) != packet.size())) {
+      XLOG(ERR) << fmt::format(
+          "[SparkHeartbeatMsg] Failed sending pkt towards: {} over: {} due to error: {}",
+          dstAddr.getAddressStr(),
+          ifName,
+          folly::errnoStr(bytesSent < 0 ? -bytesSent : 0));
+      continue;
+    }
+
+    // update telemetry for SparkHeartbeatMsg
+    for (auto& [_, neighbor] : sparkNeighbors_.at(ifName)) {
+      neighbor.lastHeartbeatMsgSentAt =
+          getCurrentTime<std::chrono::milliseconds>();
+    }
+
+    heartbeatBytesSentStat_.add(packet.size());
+    heartbeatPacketSentStat_.add();
+
+    XLOG(DBG2) << "[SparkHeartbeatMsg] Successfully sent " << bytesSent
+               << " bytes over intf: " << ifName
+               << ", with sequenceId: " << seqNums.at(i);
+  }
 }
 
 void
@@ -1143,17 +1513,14 @@ Spark::neighborUpWrapper(
     std::string const& ifName,
     std::string const& neighborName) {
   // stop sending out handshake msg, no longer in NEGOTIATE stage
-  neighbor.negotiateTimer.reset();
+  cancelNeighborTimer(NeighborTimer::NEGOTIATE, neighbor);
 
   // remove negotiate hold timer, no longer in NEGOTIATE stage
-  neighbor.negotiateHoldTimer.reset();
+  cancelNeighborTimer(NeighborTimer::NEGOTIATE_HOLD, neighbor);
 
-  // create heartbeat hold timer when promote to "ESTABLISHED"
-  neighbor.heartbeatHoldTimer = folly::AsyncTimeout::make(
-      *getEvb(), [this, ifName, neighborName]() noexcept {
-        processHeartbeatTimeout(ifName, neighborName);
-      });
-  neighbor.heartbeatHoldTimer->scheduleTimeout(neighbor.heartbeatHoldTime);
+  // start heartbeat hold timer when promote to "ESTABLISHED"
+  scheduleNeighborTimer(
+      NeighborTimer::HEARTBEAT_HOLD, neighbor, neighbor.heartbeatHoldTime);
 
   // add neighborName to collection
   ifNameToActiveNeighbors_[ifName].emplace(neighborName);
@@ -1171,10 +1538,8 @@ Spark::neighborUpWrapper(
   // ATTN: both WARM_BOOT(GR) and COLD_BOOT shared the SAME:
   //  negotiation -> established
   // state transiion. Differentiate them by reporting different types of events.
-  if (neighbor.gracefulRestartHoldTimer) {
-    // stop the graceful-restart hold-timer
-    neighbor.gracefulRestartHoldTimer.reset();
-
+  // stop the graceful-restart hold-timer
+  if (cancelNeighborTimer(NeighborTimer::GRACEFUL_RESTART_HOLD, neighbor)) {
     notifySparkNeighborEvent(NeighborEventType::NEIGHBOR_RESTARTED, neighbor);
   } else {
     notifySparkNeighborEvent(NeighborEventType::NEIGHBOR_UP, neighbor);
@@ -1199,6 +1564,9 @@ Spark::neighborDownWrapper(
   if (ifNameToActiveNeighbors_.at(ifName).empty()) {
     ifNameToActiveNeighbors_.erase(ifName);
   }
+
+  // link is not stable, detect failure over it as fast as configured
+  resetKeepAlive(ifName);
 }
 
 void
@@ -1260,28 +1628,11 @@ Spark::processNegotiation(
     std::string const& neighborName,
     SparkNeighbor& neighbor) {
   // Starts timer to periodically send hankshake msg
-  const std::string neighborAreaId = neighbor.area;
-  neighbor.negotiateTimer = folly::AsyncTimeout::make(
-      *getEvb(), [this, ifName, neighborName, neighborAreaId]() noexcept {
-        sendHandshakeMsg(ifName, neighborName, neighborAreaId, false);
-        // send out handshake msg periodically to this neighbor
-        CHECK(sparkNeighbors_.count(ifName) > 0)
-            << fmt::format("Key NOT found for: {}", ifName);
-        CHECK(sparkNeighbors_.at(ifName).count(neighborName) > 0)
-            << fmt::format("Key NOT found: {} under: {}", neighborName, ifName);
-        sparkNeighbors_.at(ifName)
-            .at(neighborName)
-            .negotiateTimer->scheduleTimeout(handshakeTime_);
-      });
-  neighbor.negotiateTimer->scheduleTimeout(handshakeTime_);
+  scheduleNeighborTimer(NeighborTimer::NEGOTIATE, neighbor, handshakeTime_);
 
-  // Starts negotiate hold-timer
-  neighbor.negotiateHoldTimer = folly::AsyncTimeout::make(
-      *getEvb(), [this, ifName, neighborName]() noexcept {
-        // prevent to stucking in NEGOTIATE forever
-        processNegotiateTimeout(ifName, neighborName);
-      });
-  neighbor.negotiateHoldTimer->scheduleTimeout(handshakeHoldTime_);
+  // Starts negotiate hold-timer to prevent stucking in NEGOTIATE forever
+  scheduleNeighborTimer(
+      NeighborTimer::NEGOTIATE_HOLD, neighbor, handshakeHoldTime_);
 }
 
 void
@@ -1306,7 +1657,88 @@ Spark::processNegotiateTimeout(
   logStateTransition(neighborName, ifName, oldState, neighbor.state);
 
   // stop sending out handshake msg, no longer in NEGOTIATE stage
-  neighbor.negotiateTimer.reset();
+  cancelNeighborTimer(NeighborTimer::NEGOTIATE, neighbor);
+}
+
+void
+Spark::scheduleNeighborTimer(
+    NeighborTimer timer,
+    SparkNeighbor const& neighbor,
+    std::chrono::milliseconds timeout) {
+  neighborTimers_.schedule(
+      NeighborTimerKey{
+          timer, neighbor.localIfName, neighbor.nodeName, neighbor.id},
+      std::chrono::steady_clock::now() + timeout);
+  scheduleNeighborTimersTimeout();
+}
+
+bool
+Spark::cancelNeighborTimer(NeighborTimer timer, SparkNeighbor const& neighbor) {
+  // ATTN: timeout armed for the earliest deadline is kept as is. Firing early
+  // finds nothing expired and re-arms for the next deadline.
+  const NeighborTimerKey key{
+      timer, neighbor.localIfName, neighbor.nodeName, neighbor.id};
+  return neighborTimers_.erase(key) > 0;
+}
+
+void
+Spark::scheduleNeighborTimersTimeout() {
+  auto deadline = neighborTimers_.nextDeadline();
+  if (not deadline.has_value()) {
+    return;
+  }
+  // Restarting the heartbeat hold-timer only postpones the deadline, hence
+  // common case keeps the timeout armed as is
+  if (neighborTimersTimeout_->isScheduled() and
+      neighborTimersDeadline_ <= deadline.value()) {
+    return;
+  }
+  const auto now = std::chrono::steady_clock::now();
+  neighborTimersDeadline_ = deadline.value();
+  neighborTimersTimeout_->scheduleTimeout(
+      std::chrono::ceil<std::chrono::milliseconds>(
+          std::max(neighborTimersDeadline_, now) - now));
+}
+
+void
+Spark::processNeighborTimers() {
+  // ATTN: handling a timer may stop other timers, or remove the neighbor.
+  // Pop expired timers one by one so that stopped ones never fire.
+  while (auto key =
+             neighborTimers_.popNextExpired(std::chrono::steady_clock::now())) {
+    auto const& [timer, ifName, neighborName, id] = key.value();
+
+    // ignore timers of neighbors which have been removed meanwhile
+    auto ifIt = sparkNeighbors_.find(ifName);
+    if (ifIt == sparkNeighbors_.end()) {
+      continue;
+    }
+    auto neighborIt = ifIt->second.find(neighborName);
+    if (neighborIt == ifIt->second.end() or neighborIt->second.id != id) {
+      continue;
+    }
+    auto& neighbor = neighborIt->second;
+
+    switch (timer) {
+    case NeighborTimer::NEGOTIATE:
+      // send out handshake msg periodically to this neighbor
+      sendHandshakeMsg(ifName, neighborName, neighbor.area, false);
+      scheduleNeighborTimer(NeighborTimer::NEGOTIATE, neighbor, handshakeTime_);
+      break;
+    case NeighborTimer::NEGOTIATE_HOLD:
+      processNegotiateTimeout(ifName, neighborName);
+      break;
+    case NeighborTimer::HEARTBEAT_HOLD:
+      processHeartbeatTimeout(ifName, neighborName);
+      break;
+    case NeighborTimer::GRACEFUL_RESTART_HOLD:
+      // change the state back to IDLE
+      processGRTimeout(ifName, neighborName);
+      break;
+    }
+  }
+
+  scheduleNeighborTimersTimeout();
 }
 
 void
@@ -1349,13 +1781,13 @@ Spark::processGRMsg(
   // notify link-monitor for RESTARTING event
   notifySparkNeighborEvent(NeighborEventType::NEIGHBOR_RESTARTING, neighbor);
 
+  // neighbor will come back with hold time negotiated from scratch
+  resetKeepAlive(ifName);
+
   // start graceful-restart timer
-  neighbor.gracefulRestartHoldTimer = folly::AsyncTimeout::make(
-      *getEvb(), [this, ifName, neighborName]() noexcept {
-        // change the state back to IDLE
-        processGRTimeout(ifName, neighborName);
-      });
-  neighbor.gracefulRestartHoldTimer->scheduleTimeout(
+  scheduleNeighborTimer(
+      NeighborTimer::GRACEFUL_RESTART_HOLD,
+      neighbor,
       neighbor.gracefulRestartHoldTime);
 
   // state transition
@@ -1366,7 +1798,7 @@ Spark::processGRMsg(
   logStateTransition(neighborName, ifName, oldState, neighbor.state);
 
   // neihbor is restarting, shutdown heartbeat hold timer
-  neighbor.heartbeatHoldTimer.reset();
+  cancelNeighborTimer(NeighborTimer::HEARTBEAT_HOLD, neighbor);
 }
 
 void
@@ -1416,7 +1848,7 @@ Spark::processHelloMsg(
     // TODO: Spark is yet to support area change due to dynamic configuration.
     //       To avoid running area deducing logic for every single helloMsg,
     //       ONLY deduce for unknown neighbors.
-    auto areaId = getNeighborArea(neighborName, ifName, config_->getAreas());
+    auto areaId = getNeighborAreaCached(neighborName, ifName);
     if (not areaId.has_value()) {
       return;
     }
@@ -1441,6 +1873,7 @@ Spark::processHelloMsg(
             areaId.value()));
 
     auto& neighbor = ifNeighbors.at(neighborName);
+    neighbor.id = nextNeighborId_++;
     checkNeighborState(neighbor, thrift::SparkNeighState::IDLE);
   }
 
@@ -1663,6 +2096,8 @@ Spark::processHandshakeMsg(
   neighbor.transportAddressV6 = *handshakeMsg.transportAddressV6_ref();
   neighbor.enableFloodOptimization =
       handshakeMsg.enableFloodOptimization_ref().value_or(false);
+  neighbor.enableAdaptiveHoldTime =
+      handshakeMsg.enableAdaptiveHoldTime_ref().value_or(false);
 
   // update neighbor holdTime as "NEGOTIATING" process
   neighbor.heartbeatHoldTime = std::max(
@@ -1685,9 +2120,9 @@ Spark::processHandshakeMsg(
       logStateTransition(neighborName, ifName, oldState, neighbor.state);
 
       // stop sending out handshake msg, no longer in NEGOTIATE stage
-      neighbor.negotiateTimer.reset();
+      cancelNeighborTimer(NeighborTimer::NEGOTIATE, neighbor);
       // remove negotiate hold timer, no longer in NEGOTIATE stage
-      neighbor.negotiateHoldTimer.reset();
+      cancelNeighborTimer(NeighborTimer::NEGOTIATE_HOLD, neighbor);
 
       return;
     }
@@ -1721,9 +2156,9 @@ Spark::processHandshakeMsg(
       logStateTransition(neighborName, ifName, oldState, neighbor.state);
 
       // stop sending out handshake msg, no longer in NEGOTIATE stage
-      neighbor.negotiateTimer.reset();
+      cancelNeighborTimer(NeighborTimer::NEGOTIATE, neighbor);
       // remove negotiate hold timer, no longer in NEGOTIATE stage
-      neighbor.negotiateHoldTimer.reset();
+      cancelNeighborTimer(NeighborTimer::NEGOTIATE_HOLD, neighbor);
       return;
     }
   }
@@ -1749,7 +2184,9 @@ Spark::processHandshakeMsg(
 
 void
 Spark::processHeartbeatMsg(
-    thrift::SparkHeartbeatMsg const& heartbeatMsg, std::string const& ifName) {
+    thrift::SparkHeartbeatMsg const& heartbeatMsg,
+    std::string const& ifName,
+    std::chrono::microseconds const& myRecvTimeInUs) {
   auto const& remoteSeqNum = *heartbeatMsg.seqNum_ref();
 
   XLOG(DBG3) << "[SparkHeartbeatMsg] Received SparkHeartbeatMsg over intf: "
@@ -1785,8 +2222,25 @@ Spark::processHeartbeatMsg(
     return;
   }
 
-  // Reset the hold-timer for neighbor as we have received a keep-alive msg
-  neighbor.heartbeatHoldTimer->scheduleTimeout(neighbor.heartbeatHoldTime);
+  // ATTN: neighbor under adaptive keep-alive advertises its current hold time
+  if (auto holdTime = heartbeatMsg.holdTime_ref()) {
+    neighbor.heartbeatHoldTime =
+        std::max(std::chrono::milliseconds(*holdTime), holdTime_);
+  }
+
+  // Reset the hold-timer for neighbor as we have received a keep-alive msg.
+  // Hold time counts from kernel receive timestamp of the pkt, hence time it
+  // waited in socket buffer while Spark was busy does not delay detection.
+  const auto queuedTime = std::clamp(
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          getCurrentTime<std::chrono::microseconds>() - myRecvTimeInUs),
+      std::chrono::milliseconds(0),
+      neighbor.heartbeatHoldTime);
+  heartbeatRecvQueuedTimeStat_.add(queuedTime.count());
+  scheduleNeighborTimer(
+      NeighborTimer::HEARTBEAT_HOLD,
+      neighbor,
+      neighbor.heartbeatHoldTime - queuedTime);
 
   // Check adjOnlyUsedByOtherNode bit to report to LinkMonitor
   if (neighbor.shouldResetAdjacency(heartbeatMsg)) {
@@ -1801,22 +2255,80 @@ Spark::processHeartbeatMsg(
 
 void
 Spark::processPacket() {
-  // receive and parse pkt
-  thrift::SparkHelloPacket helloPacket;
-  std::string ifName;
-  std::chrono::microseconds myRecvTime;
+  for (size_t batch = 0; batch < kMaxRecvBatches; ++batch) {
+    // receive batch of pkts
+    const auto recvResults = IoProvider::recvMessages(
+        mcastFd_,
+        recvBuf_.data(),
+        kMinIpv6Mtu,
+        kRecvBatchSize,
+        ioProvider_.get());
+    if (recvResults.empty()) {
+      return;
+    }
+    fb303::fbData->addStatValue(
+        "spark.packet_recv_batch_size", recvResults.size(), fb303::AVG);
 
-  if (!parsePacket(helloPacket, ifName, myRecvTime)) {
-    return;
-  }
+    // parse pkts. Failure of one pkt doesn't affect the rest of batch
+    struct ReceivedPacket {
+      thrift::SparkHelloPacket helloPacket;
+      std::string ifName;
+      std::chrono::microseconds myRecvTime;
+    };
+    std::vector<ReceivedPacket> packets;
+    packets.reserve(recvResults.size());
+    for (size_t i = 0; i < recvResults.size(); ++i) {
+      ReceivedPacket packet;
+      try {
+        if (parsePacket(
+                recvBuf_.data() + i * kMinIpv6Mtu,
+                recvResults.at(i),
+                packet.helloPacket,
+                packet.ifName,
+                packet.myRecvTime)) {
+          packets.emplace_back(std::move(packet));
+        }
+      } catch (std::exception const& err) {
+        if (isThrowParserErrorsOn_) {
+          throw;
+        }
+        XLOG(ERR) << "Spark: error parsing hello packet "
+                  << folly::exceptionStr(err);
+      }
+    }
+
+    // ATTN: heartbeat msgs keep established adjacencies up, hence they are
+    // processed ahead of hello and handshake msgs of the same batch
+    std::stable_partition(
+        packets.begin(), packets.end(), [](ReceivedPacket const& packet) {
+          return packet.helloPacket.heartbeatMsg_ref().has_value();
+        });
 
-  // Spark specific msg processing
-  if (helloPacket.helloMsg_ref().has_value()) {
-    processHelloMsg(helloPacket.helloMsg_ref().value(), ifName, myRecvTime);
-  } else if (helloPacket.heartbeatMsg_ref().has_value()) {
-    processHeartbeatMsg(helloPacket.heartbeatMsg_ref().value(), ifName);
-  } else if (helloPacket.handshakeMsg_ref().has_value()) {
-    processHandshakeMsg(helloPacket.handshakeMsg_ref().value(), ifName);
+    for (auto& [helloPacket, ifName, myRecvTime] : packets) {
+      try {
+        // Spark specific msg processing
+        if (helloPacket.helloMsg_ref().has_value()) {
+          processHelloMsg(
+              helloPacket.helloMsg_ref().value(), ifName, myRecvTime);
+        } else if (helloPacket.heartbeatMsg_ref().has_value()) {
+          processHeartbeatMsg(
+              helloPacket.heartbeatMsg_ref().value(), ifName, myRecvTime);
+        } else if (helloPacket.handshakeMsg_ref().has_value()) {
+          processHandshakeMsg(helloPacket.handshakeMsg_ref().value(), ifName);
+        }
+      } catch (std::exception const& err) {
+        if (isThrowParserErrorsOn_) {
+          throw;
+        }
+        XLOG(ERR) << "Spark: error processing hello packet "
+                  << folly::exceptionStr(err);
+      }
+    }
+
+    // socket is drained
+    if (recvResults.size() < kRecvBatchSize) {
+      return;
+    }
   }
 }
 
@@ -1902,9 +2414,8 @@ Spark::sendHelloMsg(
   }
 
   // update telemetry for SparkHelloMsg
-  fb303::fbData->addStatValue(
-      "spark.hello.bytes_sent", packet.size(), fb303::SUM);
-  fb303::fbData->addStatValue("spark.hello.packet_sent", 1, fb303::SUM);
+  helloBytesSentStat_.add(packet.size());
+  helloPacketSentStat_.add();
 
   XLOG(DBG2) << "[SparkHelloMsg] Successfully sent " << bytesSent
              << " bytes over intf: " << ifName
@@ -1934,9 +2445,11 @@ Spark::processInitializationEvent(thrift::InitializationEvent&& event) {
   // force to send SparkHeartbeatMsg immediately to notify peers.
   // NOTE: it is ok for this pkt to be lost as we will continuously send it as
   // the name suggests.
+  std::vector<std::string> ifNames;
   for (const auto& [ifName, _] : interfaceDb_) {
-    sendHeartbeatMsg(ifName);
+    ifNames.emplace_back(ifName);
   }
+  sendHeartbeatMsgs(ifNames);
 
   // logging for initialization stage duration computation
   logInitializationEvent("Spark", thrift::InitializationEvent::INITIALIZED);
@@ -1962,6 +2475,9 @@ Spark::processInterfaceUpdates(InterfaceDatabase&& ifDb) {
     if (not info.isUp) {
       continue;
     }
+    if (not isInterfaceOfShard(info.ifName)) {
+      continue;
+    }
     if (v6LinkLocalNetworks.empty()) {
       XLOG(DBG2) << "IPv6 link local address not found";
       continue;
@@ -2043,6 +2559,8 @@ Spark::deleteInterface(const std::vector<std::string>& toDel) {
     }
     sparkNeighbors_.erase(ifName);
     ifNameToHeartbeatTimers_.erase(ifName);
+    ifNameToAdaptiveKeepAlive_.erase(ifName);
+    ifNameToTokenBuckets_.erase(ifName);
 
     // unsubscribe the socket from mcast group on this interface
     // On error, log and continue
@@ -2098,10 +2616,14 @@ Spark::addInterface(
       // heartbeatTimers will start as soon as intf is in UP state
       auto heartbeatTimer =
           folly::AsyncTimeout::make(*getEvb(), [this, ifName]() noexcept {
-            sendHeartbeatMsg(ifName);
+            // ATTN: raised hold time goes out with this heartbeat msg,
+            // before the longer interval to the next one
+            backoffKeepAlive(ifName);
+            queueHeartbeatMsg(ifName);
             // schedule heartbeatTimers periodically as soon as intf is UP
             ifNameToHeartbeatTimers_.at(ifName)->scheduleTimeout(
-                addJitter<std::chrono::milliseconds>(keepAliveTime_));
+                addJitter<std::chrono::milliseconds>(
+                    getKeepAliveTime(ifName)));
           });
 
       ifNameToHeartbeatTimers_.emplace(ifName, std::move(heartbeatTimer));
@@ -2222,16 +2744,36 @@ Spark::updateGlobalCounters() {
     }
   }
   fb303::fbData->setCounter(
-      "spark.num_tracked_interfaces", sparkNeighbors_.size());
+      getShardCounterName("spark.num_tracked_interfaces"),
+      sparkNeighbors_.size());
   fb303::fbData->setCounter(
-      "spark.num_tracked_neighbors", trackedNeighborCount);
+      getShardCounterName("spark.num_tracked_neighbors"),
+      trackedNeighborCount);
   fb303::fbData->setCounter(
-      "spark.num_adjacent_neighbors", adjacentNeighborCount);
+      getShardCounterName("spark.num_adjacent_neighbors"),
+      adjacentNeighborCount);
   fb303::fbData->setCounter(
-      "spark.tracked_adjacent_neighbors_diff",
+      getShardCounterName("spark.tracked_adjacent_neighbors_diff"),
       trackedNeighborCount - adjacentNeighborCount);
-  fb303::fbData->setCounter("spark.my_seq_num", mySeqNum_);
-  fb303::fbData->setCounter("spark.pending_timers", getEvb()->timer().count());
+  fb303::fbData->setCounter(
+      getShardCounterName("spark.my_seq_num"), mySeqNum_);
+  fb303::fbData->setCounter(
+      getShardCounterName("spark.pending_timers"),
+      getEvb()->timer().count());
+}
+
+bool
+Spark::isInterfaceOfShard(std::string const& ifName) const {
+  return numShards_ == 1 or
+      std::hash<std::string>{}(ifName) % numShards_ == shardId_;
+}
+
+std::string
+Spark::getShardCounterName(std::string const& name) const {
+  if (numShards_ == 1) {
+    return name;
+  }
+  return fmt::format("{}.shard_{}", name, shardId_);
 }
 
 // This is a static function
@@ -2239,23 +2781,25 @@ std::optional<std::string>
 Spark::getNeighborArea(
     const std::string& peerNodeName,
     const std::string& localIfName,
-    const std::unordered_map<std::string /* areaId */, AreaConfiguration>&
-        areaConfigs) {
-  // IMPT: ordered set. Function yeilds lowest areaId in case of multiple
-  // candidate areas
-  std::set<std::string> candidateAreas{};
-
-  // looping through areaIdRegexList
-  for (const auto& [areaId, areaConfig] : areaConfigs) {
-    if (areaConfig.shouldDiscoverOnIface(localIfName) &&
-        areaConfig.shouldPeerWithNeighbor(peerNodeName)) {
-      XLOG(DBG1) << fmt::format(
-          "Area: {} found for neighbor: {} on interface: {}",
-          areaId,
-          peerNodeName,
-          localIfName);
-      candidateAreas.insert(areaId);
-    }
+    const InterfaceRegexMatcher& interfaceRegexMatcher,
+    const NeighborRegexMatcher& neighborRegexMatcher) {
+  // IMPT: ordered. Function yeilds lowest areaId in case of multiple
+  // candidate areas. Both matchers return areas ordered by area id.
+  const auto ifAreas = interfaceRegexMatcher.match(localIfName).discoverAreas;
+  const auto neighborAreas = neighborRegexMatcher.match(peerNodeName);
+  std::vector<std::string> candidateAreas{};
+  std::set_intersection(
+      ifAreas.begin(),
+      ifAreas.end(),
+      neighborAreas.begin(),
+      neighborAreas.end(),
+      std::back_inserter(candidateAreas));
+  for (const auto& areaId : candidateAreas) {
+    XLOG(DBG1) << fmt::format(
+        "Area: {} found for neighbor: {} on interface: {}",
+        areaId,
+        peerNodeName,
+        localIfName);
   }
 
   if (candidateAreas.empty()) {
@@ -2272,6 +2816,30 @@ Spark::getNeighborArea(
   return *candidateAreas.begin();
 }
 
+std::optional<std::string>
+Spark::getNeighborAreaCached(
+    const std::string& peerNodeName, const std::string& ifName) {
+  auto key = std::make_pair(peerNodeName, ifName);
+  auto it = neighborAreaCache_.find(key);
+  if (it != neighborAreaCache_.end()) {
+    return it->second;
+  }
+
+  // ATTN: areas not found are evaluated every time, to keep reporting them
+  auto areaId = getNeighborArea(
+      peerNodeName,
+      ifName,
+      *config_->getInterfaceRegexMatcher(),
+      *config_->getNeighborRegexMatcher());
+  if (areaId.has_value()) {
+    if (neighborAreaCache_.size() >= kMaxNeighborAreaCacheSize) {
+      neighborAreaCache_.clear();
+    }
+    neighborAreaCache_.emplace(std::move(key), areaId.value());
+  }
+  return areaId;
+}
+
 void
 Spark::setThrowParserErrors(bool val) {
   isThrowParserErrorsOn_ = val;
@@ -8,15 +8,19 @@
 #pragma once
 
 #include <fmt/format.h>
+#include <folly/Range.h>
 #include <folly/SocketAddress.h>
+#include <folly/hash/Hash.h>
 #include <folly/io/async/AsyncTimeout.h>
-#include <folly/stats/BucketedTimeSeries.h>
+#include <folly/TokenBucket.h>
 #include <thrift/lib/cpp2/protocol/Serializer.h>
 
 #include <openr/common/Constants.h>
 #include <openr/common/LsdbTypes.h>
 #include <openr/common/OpenrEventBase.h>
 #include <openr/common/StepDetector.h>
+#include <openr/common/ThreadLocalStats.h>
+#include <openr/common/TimerWheel.h>
 #include <openr/config/Config.h>
 #include <openr/if/gen-cpp2/Types_types.h>
 #include <openr/messaging/ReplicateQueue.h>
@@ -60,7 +64,9 @@ class Spark final : public OpenrEventBase {
       std::pair<uint32_t, uint32_t> version = std::make_pair(
           Constants::kOpenrVersion, Constants::kOpenrSupportedVersion),
       // rate limit
-      std::optional<uint32_t> maybeMaxAllowedPps = Constants::kMaxAllowedPps);
+      std::optional<uint32_t> maybeMaxAllowedPps = Constants::kMaxAllowedPps,
+      // shard of interfaces owned, out of SparkConfig.num_shards
+      uint32_t shardId = 0);
 
   ~Spark() override = default;
 
@@ -84,6 +90,12 @@ class Spark final : public OpenrEventBase {
   // Turn on the throwing of parsing errors.
   void setThrowParserErrors(bool);
 
+  // Decode pkt carrying only heartbeat msg, as serialized by Spark, without
+  // full thrift deserialization. Returns std::nullopt for any other pkt,
+  // which has to be deserialized as usual.
+  static std::optional<thrift::SparkHeartbeatMsg> decodeHeartbeatPacket(
+      folly::ByteRange data);
+
  private:
   //
   // Interface tracking
@@ -123,12 +135,21 @@ class Spark final : public OpenrEventBase {
   PacketValidationResult sanityCheckMsg(
       std::string const& neighborName, std::string const& ifName);
 
-  // Determine if we should process the next packte from this ifName, addr pair
+  // Determine if we should process the next packte from this ifName, addr
+  // pair. Heartbeat of established neighbor is exempted from the limit of
+  // interface, which sees hellos and handshakes of every neighbor over it.
   bool shouldProcessPacket(
-      std::string const& ifName, folly::IPAddress const& addr);
+      std::string const& ifName,
+      folly::IPAddress const& addr,
+      bool isEstablishedHeartbeat);
+
+  // util call to check if neighbor has established adjacency over interface
+  bool isNeighborEstablished(
+      std::string const& ifName, std::string const& neighborName) const;
 
-  // process hello packet from a neighbor. we want to see if
-  // the neighbor could be added as adjacent peer.
+  // process hello packets from neighbors. we want to see if
+  // the neighbor could be added as adjacent peer. Pending packets are read in
+  // batches, a bounded number of them per call.
   void processPacket();
 
   // process helloMsg in Spark context
@@ -139,7 +160,9 @@ class Spark final : public OpenrEventBase {
 
   // process heartbeatMsg in Spark context
   void processHeartbeatMsg(
-      thrift::SparkHeartbeatMsg const& heartbeatMsg, std::string const& ifName);
+      thrift::SparkHeartbeatMsg const& heartbeatMsg,
+      std::string const& ifName,
+      std::chrono::microseconds const& myRecvTimeInUs);
 
   // process handshakeMsg to update sparkNeighbors_ db
   void processHandshakeMsg(
@@ -158,8 +181,29 @@ class Spark final : public OpenrEventBase {
       std::string const& neighborAreaId,
       bool isAdjEstablished);
 
-  // util call to send heartbeat msg
-  void sendHeartbeatMsg(std::string const& ifName);
+  // util call to send heartbeat msg of every interface in a batch
+  void sendHeartbeatMsgs(std::vector<std::string> const& ifNames);
+
+  // util call to get serialized heartbeat pkt. Serialization is cached and
+  // only seqNum is encoded per pkt.
+  std::string getHeartbeatPacket(
+      int64_t seqNum, bool holdAdjacency, std::optional<int64_t> holdTime);
+
+  // keep-alive and hold time currently used on interface, scaled up from the
+  // configured ones under adaptive keep-alive
+  std::chrono::milliseconds getKeepAliveTime(std::string const& ifName) const;
+  std::chrono::milliseconds getHoldTime(std::string const& ifName) const;
+
+  // util call to back off keep-alive of interface once it has been stable
+  void backoffKeepAlive(std::string const& ifName);
+
+  // util call to fall back to configured keep-alive of interface on
+  // instability of any neighbor over it
+  void resetKeepAlive(std::string const& ifName);
+
+  // util call to send heartbeat msg of interface along with the ones of other
+  // interfaces due within a short window
+  void queueHeartbeatMsg(std::string const& ifName);
 
   /*
    * [Interface Update/Initialization Event Management]
@@ -192,6 +236,12 @@ class Spark final : public OpenrEventBase {
   // set flat counter/stats
   void updateGlobalCounters();
 
+  // util function to check if interface belongs to shard of this instance
+  bool isInterfaceOfShard(std::string const& ifName) const;
+
+  // name of counter, suffixed with shard if sharded
+  std::string getShardCounterName(std::string const& name) const;
+
   // utility method to add regex for:
   //
   //  tuple(areaId, neighbor_regex, interface_regex)
@@ -216,11 +266,17 @@ class Spark final : public OpenrEventBase {
   static std::optional<std::string> getNeighborArea(
       const std::string& peerNodeName,
       const std::string& ifName,
-      const std::unordered_map<std::string /* areaId */, AreaConfiguration>&
-          areaConfigs);
+      const InterfaceRegexMatcher& interfaceRegexMatcher,
+      const NeighborRegexMatcher& neighborRegexMatcher);
+
+  // memoized getNeighborArea() against areas of config_
+  std::optional<std::string> getNeighborAreaCached(
+      const std::string& peerNodeName, const std::string& ifName);
 
-  // function to receive and parse received pkt
+  // function to parse received pkt
   bool parsePacket(
+      const uint8_t* buf /* data of received pkt */,
+      IoProvider::RecvResult const& recvResult /* info of received pkt */,
       thrift::SparkHelloPacket& pkt /* packet( type will be renamed later) */,
       std::string& ifName /* interface */,
       std::chrono::microseconds& recvTime /* kernel timestamp when recved */);
@@ -242,6 +298,25 @@ class Spark final : public OpenrEventBase {
   //
   // Spark related function call
   //
+
+  // per neighbor timers
+  enum class NeighborTimer : uint8_t {
+    // periodically send out handshake pkt
+    NEGOTIATE = 1,
+    // negotiate stage hold-timer
+    NEGOTIATE_HOLD = 2,
+    // heartbeat hold-timer
+    HEARTBEAT_HOLD = 3,
+    // graceful restart hold-timer
+    GRACEFUL_RESTART_HOLD = 4,
+  };
+
+  using NeighborTimerKey = std::tuple<
+      NeighborTimer,
+      std::string /* ifName */,
+      std::string /* neighborName */,
+      uint64_t /* neighbor id */>;
+
   struct SparkNeighbor {
     SparkNeighbor(
         const thrift::StepDetectorConfig&,
@@ -283,17 +358,9 @@ class Spark final : public OpenrEventBase {
     // neighbor event(thrift::SparkNeighEvent::HELLO_RCVD_NO_INFO)
     thrift::SparkNeighEvent event{thrift::SparkNeighEvent::HELLO_RCVD_NO_INFO};
 
-    // timer to periodically send out handshake pkt
-    std::unique_ptr<folly::AsyncTimeout> negotiateTimer{nullptr};
-
-    // negotiate stage hold-timer
-    std::unique_ptr<folly::AsyncTimeout> negotiateHoldTimer{nullptr};
-
-    // heartbeat hold-timer
-    std::unique_ptr<folly::AsyncTimeout> heartbeatHoldTimer{nullptr};
-
-    // graceful restart hold-timer
-    std::unique_ptr<folly::AsyncTimeout> gracefulRestartHoldTimer{nullptr};
+    // unique id of this neighbor instance. Timers of a neighbor which has
+    // been removed and discovered again never fire for the new instance.
+    uint64_t id{0};
 
     // telemetry for the Spark control pkt sent time
     std::chrono::milliseconds lastHelloMsgSentAt{0};
@@ -307,6 +374,9 @@ class Spark final : public OpenrEventBase {
     // flag to indicate if flood-optimization is supported or NOT
     bool enableFloodOptimization{false};
 
+    // flag to indicate if neighbor honors hold time of heartbeat msg
+    bool enableAdaptiveHoldTime{false};
+
     // hold time
     std::chrono::milliseconds heartbeatHoldTime{0};
     std::chrono::milliseconds gracefulRestartHoldTime{0};
@@ -396,6 +466,18 @@ class Spark final : public OpenrEventBase {
   void processNegotiateTimeout(
       std::string const& ifName, std::string const& neighborName);
 
+  // (re)start or stop timer of a neighbor. Stopping returns true if the timer
+  // was running.
+  void scheduleNeighborTimer(
+      NeighborTimer timer,
+      SparkNeighbor const& neighbor,
+      std::chrono::milliseconds timeout);
+  bool cancelNeighborTimer(NeighborTimer timer, SparkNeighbor const& neighbor);
+
+  // fire expired neighbor timers and wait for the next one
+  void processNeighborTimers();
+  void scheduleNeighborTimersTimeout();
+
   // Util function for state transition
   static thrift::SparkNeighState getNextState(
       std::optional<thrift::SparkNeighState> const& currState,
@@ -451,6 +533,16 @@ class Spark final : public OpenrEventBase {
   // This flag indicates that if DUAL flood-optimization is supported or NOT
   const bool enableFloodOptimization_{false};
 
+  // Interfaces are sharded among Spark instances by hash of name. This
+  // instance only tracks interfaces of its own shard. Others' pkts are
+  // received on its socket as well, and dropped.
+  const uint32_t shardId_{0};
+  const uint32_t numShards_{1};
+
+  // Max number of times keep-alive and hold time of an interface are doubled
+  // under adaptive keep-alive. 0 if disabled.
+  const uint32_t maxKeepAliveLevel_{0};
+
   // the next sequence number to be used on any interface for outgoing hellos
   // NOTE: we increment this on hello sent out of any interfaces
   uint64_t mySeqNum_{1};
@@ -491,6 +583,58 @@ class Spark final : public OpenrEventBase {
       std::unique_ptr<folly::AsyncTimeout>>
       ifNameToHeartbeatTimers_{};
 
+  // Adaptive keep-alive state of each interface. Keep-alive and hold time are
+  // doubled per level, and level is raised after a number of heartbeat msgs
+  // without any neighbor instability.
+  struct AdaptiveKeepAlive {
+    uint32_t level{0};
+    uint32_t stableHeartbeats{0};
+  };
+  std::unordered_map<std::string /* ifName */, AdaptiveKeepAlive>
+      ifNameToAdaptiveKeepAlive_{};
+
+  // timers of all the neighbors. Heartbeat hold-timer is restarted on every
+  // heartbeat msg, which only moves the key between slots of the wheel.
+  // Single AsyncTimeout is armed for the earliest deadline.
+  TimerWheel<
+      NeighborTimerKey,
+      std::chrono::steady_clock,
+      folly::hasher<NeighborTimerKey>>
+      neighborTimers_{Constants::kSparkNeighborTimerTick};
+  std::unique_ptr<folly::AsyncTimeout> neighborTimersTimeout_{nullptr};
+  std::chrono::steady_clock::time_point neighborTimersDeadline_{};
+
+  // id of the next discovered neighbor
+  uint64_t nextNeighborId_{1};
+
+  // area deduced for (neighborName, ifName). Areas are immutable once Spark
+  // is created, hence entries are never stale. Only found areas are cached.
+  std::unordered_map<
+      std::pair<std::string /* neighborName */, std::string /* ifName */>,
+      std::string /* areaId */,
+      folly::hasher<std::pair<std::string, std::string>>>
+      neighborAreaCache_{};
+
+  // interfaces of which heartbeat msg is due, sent in a batch once
+  // heartbeatBatchTimer_ fires
+  std::vector<std::string> pendingHeartbeatIfNames_{};
+  std::unique_ptr<folly::AsyncTimeout> heartbeatBatchTimer_{nullptr};
+
+  // Serialized heartbeat pkt, split around the encoded seqNum. It only
+  // changes with the holdAdjacency flag and the advertised hold time, which
+  // is per interface under adaptive keep-alive.
+  struct HeartbeatPacketCache {
+    std::string prefix;
+    std::string suffix;
+  };
+  std::map<
+      std::pair<bool /* holdAdjacency */, std::optional<int64_t>>,
+      HeartbeatPacketCache>
+      heartbeatPacketCache_{};
+
+  // buffer of received pkts, read in batches
+  std::vector<uint8_t> recvBuf_{};
+
   // number of active neighbors for each interface
   std::unordered_map<
       std::string /* ifName */,
@@ -505,10 +649,14 @@ class Spark final : public OpenrEventBase {
   // instances, hence the shared_ptr
   std::shared_ptr<IoProvider> ioProvider_{nullptr};
 
-  // vector of BucketedTimeSeries to make sure we don't take too many
+  // vector of token buckets to make sure we don't take too many
   // hello packets from any one iface, address pair
-  std::vector<folly::BucketedTimeSeries<int64_t, std::chrono::steady_clock>>
-      timeSeriesVector_{};
+  std::vector<folly::DynamicTokenBucket> neighborTokenBuckets_{};
+
+  // token bucket of each interface, to make sure a storm of hello and
+  // handshake packets from many addresses doesn't starve Spark
+  std::unordered_map<std::string /* ifName */, folly::DynamicTokenBucket>
+      ifNameToTokenBuckets_{};
 
   // flag to indicate if ordered publication is enabled
   bool enableOrderedAdjPublication_{false};
@@ -519,6 +667,23 @@ class Spark final : public OpenrEventBase {
   // Timer for updating and submitting counters periodically
   std::unique_ptr<folly::AsyncTimeout> counterUpdateTimer_{nullptr};
 
+  // Per packet stats, see [Thread Local Stats]
+  ThreadLocalStat packetRecvStat_{"spark.packet_recv", facebook::fb303::SUM};
+  ThreadLocalStat packetRecvSizeStat_{
+      "spark.packet_recv_size", facebook::fb303::SUM};
+  ThreadLocalStat packetProcessedStat_{
+      "spark.packet_processed", facebook::fb303::SUM};
+  ThreadLocalStat helloBytesSentStat_{
+      "spark.hello.bytes_sent", facebook::fb303::SUM};
+  ThreadLocalStat helloPacketSentStat_{
+      "spark.hello.packet_sent", facebook::fb303::SUM};
+  ThreadLocalStat heartbeatBytesSentStat_{
+      "spark.heartbeat.bytes_sent", facebook::fb303::SUM};
+  ThreadLocalStat heartbeatPacketSentStat_{
+      "spark.heartbeat.packet_sent", facebook::fb303::SUM};
+  ThreadLocalStat heartbeatRecvQueuedTimeStat_{
+      "spark.heartbeat.recv_queued_time_ms", facebook::fb303::AVG};
+
   // Timer for collecting neighbors successfully discovered and publishing them
   // to neighborUpdatesQueue_ in OpenR initialization procedure.
   std::unique_ptr<folly::AsyncTimeout> initializationHoldTimer_{nullptr};
@@ -16,7 +16,8 @@ SparkWrapper::SparkWrapper(
     std::pair<uint32_t, uint32_t> version,
     std::shared_ptr<IoProvider> ioProvider,
     std::shared_ptr<const Config> config,
-    bool isRateLimitEnabled)
+    bool isRateLimitEnabled,
+    uint32_t shardId)
     : myNodeName_(myNodeName), config_(config) {
   // apply isRateLimitEnabled.
   // Using a plain bool enable/disable for rate-limit here, to leave
@@ -30,16 +31,18 @@ SparkWrapper::SparkWrapper(
             std::move(ioProvider),
             config,
             version,
-            std::nullopt) // no Spark receive rate-limit, for testing
+            std::nullopt, // no Spark receive rate-limit, for testing
+            shardId)
       : std::make_shared<Spark>(
             interfaceUpdatesQueue_.getReader(),
             initializationEventQueue_.getReader(),
             neighborUpdatesQueue_,
             std::move(ioProvider),
             config,
-            version
+            version,
             // Go with the default Spark rate-limit
-        );
+            Constants::kMaxAllowedPps,
+            shardId);
   // For testing - fuzz testing particularly - we want parsing errors to
   // be thrown upward, not suppressed.
   spark_->setThrowParserErrors(true);
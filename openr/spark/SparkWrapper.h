@@ -30,7 +30,8 @@ class SparkWrapper {
       std::pair<uint32_t, uint32_t> version,
       std::shared_ptr<IoProvider> ioProvider,
       std::shared_ptr<const Config> config,
-      bool isRateLimitEnabled = true);
+      bool isRateLimitEnabled = true,
+      uint32_t shardId = 0);
 
   ~SparkWrapper();
 
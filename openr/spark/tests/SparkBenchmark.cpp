@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <fmt/format.h>
+#include <folly/Benchmark.h>
+#include <folly/hash/Hash.h>
+#include <folly/init/Init.h>
+#include <folly/io/async/AsyncTimeout.h>
+#include <folly/io/async/EventBase.h>
+
+#include <openr/common/Constants.h>
+#include <openr/common/TimerWheel.h>
+
+namespace {
+// Heartbeat hold time of a neighbor
+const std::chrono::milliseconds kHeartbeatHoldTime{10000};
+} // namespace
+
+namespace openr {
+
+/**
+ * Benchmark for restarting heartbeat hold-timer of every neighbor on receipt
+ * of its heartbeat msg, with one AsyncTimeout per neighbor
+ */
+void
+BM_HeartbeatHoldAsyncTimeout(uint32_t iters, size_t numOfNeighbors) {
+  auto suspender = folly::BenchmarkSuspender();
+  folly::EventBase evb;
+
+  std::vector<std::unique_ptr<folly::AsyncTimeout>> timers;
+  timers.reserve(numOfNeighbors);
+  for (size_t i = 0; i < numOfNeighbors; ++i) {
+    timers.emplace_back(folly::AsyncTimeout::make(evb, []() noexcept {}));
+    timers.back()->scheduleTimeout(kHeartbeatHoldTime);
+  }
+  suspender.dismiss(); // Start measuring benchmark time
+
+  for (uint32_t i = 0; i < iters; i++) {
+    for (auto& timer : timers) {
+      timer->scheduleTimeout(kHeartbeatHoldTime);
+    }
+  }
+
+  suspender.rehire(); // Stop measuring time again
+}
+
+/**
+ * Benchmark for restarting heartbeat hold-timer of every neighbor on receipt
+ * of its heartbeat msg, with timers of all the neighbors in a TimerWheel as
+ * Spark does
+ */
+void
+BM_HeartbeatHoldTimerWheel(uint32_t iters, size_t numOfNeighbors) {
+  auto suspender = folly::BenchmarkSuspender();
+  using Key = std::pair<std::string, uint64_t>;
+  TimerWheel<Key, std::chrono::steady_clock, folly::hasher<Key>> timers(
+      Constants::kSparkNeighborTimerTick);
+
+  std::vector<Key> keys;
+  keys.reserve(numOfNeighbors);
+  for (size_t i = 0; i < numOfNeighbors; ++i) {
+    keys.emplace_back(fmt::format("neighbor-{}", i), i);
+    timers.schedule(
+        keys.back(), std::chrono::steady_clock::now() + kHeartbeatHoldTime);
+  }
+  suspender.dismiss(); // Start measuring benchmark time
+
+  for (uint32_t i = 0; i < iters; i++) {
+    for (auto& key : keys) {
+      timers.schedule(
+          key, std::chrono::steady_clock::now() + kHeartbeatHoldTime);
+    }
+  }
+
+  suspender.rehire(); // Stop measuring time again
+}
+
+// The parameter is the number of neighbors
+BENCHMARK_PARAM(BM_HeartbeatHoldAsyncTimeout, 10);
+BENCHMARK_PARAM(BM_HeartbeatHoldAsyncTimeout, 100);
+BENCHMARK_PARAM(BM_HeartbeatHoldAsyncTimeout, 1000);
+BENCHMARK_PARAM(BM_HeartbeatHoldAsyncTimeout, 10000);
+
+BENCHMARK_PARAM(BM_HeartbeatHoldTimerWheel, 10);
+BENCHMARK_PARAM(BM_HeartbeatHoldTimerWheel, 100);
+BENCHMARK_PARAM(BM_HeartbeatHoldTimerWheel, 1000);
+BENCHMARK_PARAM(BM_HeartbeatHoldTimerWheel, 10000);
+
+} // namespace openr
+
+int
+main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
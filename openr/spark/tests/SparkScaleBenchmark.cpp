@@ -0,0 +1,345 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <sys/resource.h>
+
+#include <thread>
+
+#include <fmt/format.h>
+#include <folly/Benchmark.h>
+#include <folly/init/Init.h>
+
+#include <openr/common/Constants.h>
+#include <openr/config/Config.h>
+#include <openr/monitor/SystemMetrics.h>
+#include <openr/spark/SparkWrapper.h>
+#include <openr/tests/mocks/MockIoProvider.h>
+#include <openr/tests/utils/Utils.h>
+
+#define BENCHMARK_COUNTERS_NAME_PARAM(name, counters, param_name, ...) \
+  BENCHMARK_IMPL_COUNTERS(                                             \
+      FB_CONCATENATE(name, FB_CONCATENATE(_, param_name)),             \
+      FOLLY_PP_STRINGIZE(name) "(" FOLLY_PP_STRINGIZE(param_name) ")", \
+      counters,                                                        \
+      iters,                                                           \
+      unsigned,                                                        \
+      iters) {                                                         \
+    name(counters, iters, ##__VA_ARGS__);                              \
+  }
+
+namespace {
+
+// Number of peer Spark instances simulated neighbors are spread over. Every
+// link towards the Spark under test ends on one of them, so that thousands of
+// neighbors don't need thousands of threads.
+const size_t kNumOfPeers = 8;
+
+// Latency of every simulated link
+const int32_t kLinkLatencyMs = 1;
+
+// Max time to wait for all adjacencies to be established
+const std::chrono::seconds kEstablishTimeout{120};
+
+// Number of heartbeat rounds CPU time is measured over
+const int kNumOfHeartbeatRounds = 10;
+
+const std::string kDutNodeName{"dut"};
+
+} // namespace
+
+namespace openr {
+
+/**
+ * CPU time consumed so far by the thread running Spark
+ */
+std::chrono::microseconds
+getSparkThreadCpuTime(SparkWrapper& spark) {
+  std::chrono::microseconds cpuTime{0};
+  spark.get()->getEvb()->runInEventBaseThreadAndWait([&cpuTime]() {
+    struct rusage usage;
+    getrusage(RUSAGE_THREAD, &usage);
+    const auto sec = usage.ru_utime.tv_sec + usage.ru_stime.tv_sec;
+    const auto usec = usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+    cpuTime = std::chrono::seconds(sec) + std::chrono::microseconds(usec);
+  });
+  return cpuTime;
+}
+
+/**
+ * Spark under test connected with `numOfNeighbors` simulated neighbors over
+ * MockIoProvider, one point-to-point link per neighbor.
+ */
+class SparkScaleFixture {
+ public:
+  explicit SparkScaleFixture(size_t numOfNeighbors)
+      : numOfNeighbors_(numOfNeighbors) {
+    mockIoProvider_ = std::make_shared<MockIoProvider>();
+    mockIoProviderThread_ = std::make_unique<std::thread>(
+        [this]() { mockIoProvider_->start(); });
+    mockIoProvider_->waitUntilRunning();
+
+    // link i connects interface "dut-i" with "peer-i"
+    IfNameAndifIndex ifNameAndIfIndex;
+    ConnectedIfPairs connectedPairs;
+    for (size_t i = 0; i < numOfNeighbors_; ++i) {
+      const auto dutIfName = getDutIfName(i);
+      const auto peerIfName = getPeerIfName(i);
+      ifNameAndIfIndex.emplace_back(dutIfName, 2 * i + 1);
+      ifNameAndIfIndex.emplace_back(peerIfName, 2 * i + 2);
+      connectedPairs[dutIfName].emplace_back(peerIfName, kLinkLatencyMs);
+      connectedPairs[peerIfName].emplace_back(dutIfName, kLinkLatencyMs);
+    }
+    mockIoProvider_->addIfNameIfIndex(ifNameAndIfIndex);
+    mockIoProvider_->setConnectedPairs(std::move(connectedPairs));
+
+    config_ = std::make_shared<Config>(getBasicOpenrConfig(kDutNodeName));
+    dut_ = createSpark(kDutNodeName, config_);
+    for (size_t p = 0; p < std::min(kNumOfPeers, numOfNeighbors_); ++p) {
+      const auto peerNodeName = fmt::format("peer-{}", p);
+      peers_.emplace_back(createSpark(
+          peerNodeName,
+          std::make_shared<Config>(getBasicOpenrConfig(peerNodeName))));
+    }
+  }
+
+  ~SparkScaleFixture() {
+    dut_.reset();
+    peers_.clear();
+    mockIoProvider_->stop();
+    mockIoProviderThread_->join();
+  }
+
+  /**
+   * Start tracking interfaces of every link and wait for Spark under test to
+   * report all adjacencies UP. Returns number of established adjacencies.
+   */
+  size_t
+  establishAdjacencies() {
+    InterfaceDatabase dutIfDb;
+    std::vector<InterfaceDatabase> peerIfDbs(peers_.size());
+    for (size_t i = 0; i < numOfNeighbors_; ++i) {
+      // every link is a /24 of its own, link-local address is the same
+      dutIfDb.emplace_back(
+          getDutIfName(i),
+          true /* isUp */,
+          2 * i + 1 /* ifIndex */,
+          std::unordered_set<folly::CIDRNetwork>{
+              getV4Network(i, 1),
+              folly::IPAddress::createNetwork("fe80::1/128")});
+      peerIfDbs.at(i % peers_.size())
+          .emplace_back(
+              getPeerIfName(i),
+              true /* isUp */,
+              2 * i + 2 /* ifIndex */,
+              std::unordered_set<folly::CIDRNetwork>{
+                  getV4Network(i, 2),
+                  folly::IPAddress::createNetwork("fe80::2/128")});
+    }
+    for (size_t p = 0; p < peers_.size(); ++p) {
+      peers_.at(p)->updateInterfaceDb(peerIfDbs.at(p));
+    }
+    dut_->updateInterfaceDb(dutIfDb);
+
+    size_t numOfUp{0};
+    const auto deadline = std::chrono::steady_clock::now() + kEstablishTimeout;
+    while (numOfUp < numOfNeighbors_) {
+      const auto now = std::chrono::steady_clock::now();
+      if (now >= deadline) {
+        break;
+      }
+      auto events = dut_->recvNeighborEvent(
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+              deadline - now));
+      if (not events.has_value()) {
+        break;
+      }
+      for (const auto& event : events.value()) {
+        if (event.eventType == NeighborEventType::NEIGHBOR_UP) {
+          ++numOfUp;
+        }
+      }
+    }
+    return numOfUp;
+  }
+
+  /**
+   * Number of adjacencies reported DOWN by Spark under test within timeout.
+   * Every simulated neighbor is alive, hence each of them is a false
+   * hold-timer expiration.
+   */
+  size_t
+  countNeighborDown(std::chrono::milliseconds timeout) {
+    size_t numOfDown{0};
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (true) {
+      const auto now = std::chrono::steady_clock::now();
+      if (now >= deadline) {
+        break;
+      }
+      auto events = dut_->recvNeighborEvent(
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+              deadline - now));
+      if (not events.has_value()) {
+        break;
+      }
+      for (const auto& event : events.value()) {
+        if (event.eventType == NeighborEventType::NEIGHBOR_DOWN) {
+          ++numOfDown;
+        }
+      }
+    }
+    return numOfDown;
+  }
+
+  // block event-base of Spark under test, e.g. as a slow callback would
+  void
+  delayEventBase(std::chrono::milliseconds delay) {
+    dut_->get()->getEvb()->runInEventBaseThread(
+        [delay]() { std::this_thread::sleep_for(delay); });
+  }
+
+  SparkWrapper&
+  getDut() {
+    return *dut_;
+  }
+
+  std::shared_ptr<const Config>
+  getConfig() const {
+    return config_;
+  }
+
+ private:
+  std::unique_ptr<SparkWrapper>
+  createSpark(
+      std::string const& nodeName, std::shared_ptr<const Config> config) {
+    return std::make_unique<SparkWrapper>(
+        nodeName,
+        std::make_pair(
+            Constants::kOpenrVersion, Constants::kOpenrSupportedVersion),
+        mockIoProvider_,
+        std::move(config));
+  }
+
+  static std::string
+  getDutIfName(size_t link) {
+    return fmt::format("dut-{}", link);
+  }
+
+  static std::string
+  getPeerIfName(size_t link) {
+    return fmt::format("peer-{}", link);
+  }
+
+  static folly::CIDRNetwork
+  getV4Network(size_t link, size_t host) {
+    return folly::IPAddress::createNetwork(
+        fmt::format("10.{}.{}.{}", link / 256, link % 256, host),
+        24,
+        false /* apply mask */);
+  }
+
+  const size_t numOfNeighbors_{0};
+  std::shared_ptr<MockIoProvider> mockIoProvider_{nullptr};
+  std::unique_ptr<std::thread> mockIoProviderThread_{nullptr};
+  std::shared_ptr<const Config> config_{nullptr};
+  std::unique_ptr<SparkWrapper> dut_{nullptr};
+  std::vector<std::unique_ptr<SparkWrapper>> peers_;
+};
+
+/**
+ * Benchmark for Spark at scale
+ * 1. Connect Spark under test with `numOfNeighbors` simulated neighbors and
+ *    wait for every adjacency to be established (measured)
+ * 2. Keep adjacencies up for a number of heartbeat rounds
+ * 3. Block event-base of Spark under test for `evbDelay` and count neighbors
+ *    whose hold-timer falsely expired
+ *
+ * Reports time to full adjacency, CPU time of Spark thread per heartbeat
+ * round, false hold-timer expirations and RSS growth per neighbor. Memory is
+ * split over both ends of adjacencies as peers run in the same process.
+ */
+static void
+BM_SparkScale(
+    folly::UserCounters& counters,
+    uint32_t iters,
+    size_t numOfNeighbors,
+    std::chrono::milliseconds evbDelay) {
+  auto suspender = folly::BenchmarkSuspender();
+  SystemMetrics sysMetrics;
+
+  for (uint32_t i = 0; i < iters; i++) {
+    auto fixture = std::make_unique<SparkScaleFixture>(numOfNeighbors);
+    const auto memBefore = sysMetrics.getRSSMemBytes();
+
+    suspender.dismiss(); // Start measuring benchmark time
+    const auto start = std::chrono::steady_clock::now();
+    const auto numOfUp = fixture->establishAdjacencies();
+    const auto establishTime =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+    suspender.rehire(); // Stop measuring benchmark time
+
+    const auto memAfter = sysMetrics.getRSSMemBytes();
+    if (numOfUp < numOfNeighbors) {
+      LOG(ERROR) << "Only " << numOfUp << " out of " << numOfNeighbors
+                 << " adjacencies established within "
+                 << kEstablishTimeout.count() << "s";
+    }
+
+    // CPU time of Spark thread under steady heartbeats
+    const auto keepAliveTime = fixture->getConfig()->getSparkKeepAliveTime();
+    const auto cpuTimeBefore = getSparkThreadCpuTime(fixture->getDut());
+    std::this_thread::sleep_for(keepAliveTime * kNumOfHeartbeatRounds);
+    const auto cpuTime =
+        getSparkThreadCpuTime(fixture->getDut()) - cpuTimeBefore;
+
+    // false hold-timer expirations once event-base catches up
+    fixture->delayEventBase(evbDelay);
+    const auto numOfDown = fixture->countNeighborDown(
+        evbDelay + 2 * fixture->getConfig()->getSparkHoldTime());
+
+    counters["time_to_full_adjacency(ms)"] = establishTime.count();
+    counters["num_adjacencies_not_established"] = numOfNeighbors - numOfUp;
+    counters["cpu_per_heartbeat_round(us)"] =
+        cpuTime.count() / kNumOfHeartbeatRounds;
+    counters["false_hold_expirations"] = numOfDown;
+    if (memBefore.has_value() and memAfter.has_value() and
+        memAfter.value() > memBefore.value()) {
+      counters["memory_per_neighbor(bytes)"] =
+          (memAfter.value() - memBefore.value()) / (2 * numOfNeighbors);
+    }
+
+    fixture.reset();
+  }
+}
+
+// Parameters are number of neighbors and event-base delay in milliseconds
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_SparkScale, counters, 1000_0, 1000, std::chrono::milliseconds(0));
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_SparkScale, counters, 1000_1500, 1000, std::chrono::milliseconds(1500));
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_SparkScale, counters, 5000_0, 5000, std::chrono::milliseconds(0));
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_SparkScale, counters, 5000_1500, 5000, std::chrono::milliseconds(1500));
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_SparkScale, counters, 10000_0, 10000, std::chrono::milliseconds(0));
+BENCHMARK_COUNTERS_NAME_PARAM(
+    BM_SparkScale,
+    counters,
+    10000_1500,
+    10000,
+    std::chrono::milliseconds(1500));
+
+} // namespace openr
+
+int
+main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
@@ -13,9 +13,11 @@
 #include <openr/common/Constants.h>
 #include <openr/common/MplsUtil.h>
 #include <openr/common/NetworkUtil.h>
+#include <openr/common/Util.h>
 #include <openr/config/Config.h>
 #include <openr/spark/SparkWrapper.h>
 #include <openr/tests/mocks/MockIoProvider.h>
+#include <openr/tests/mocks/MockIoProviderUtils.h>
 #include <openr/tests/utils/Utils.h>
 
 using namespace openr;
@@ -723,6 +725,222 @@ TEST_F(SimpleSparkFixture, HeartbeatTimerExpireTest) {
   }
 }
 
+/*
+ * Fixture to create two Spark instances with fast failure detection, i.e.
+ * keep-alive and hold time in milliseconds.
+ */
+class FastDetectionSparkFixture : public SimpleSparkFixture {
+ protected:
+  void
+  createConfig() override {
+    auto tConfig1 = getBasicOpenrConfig(nodeName1_);
+    auto tConfig2 = getBasicOpenrConfig(nodeName2_);
+    for (auto* tConfig : {&tConfig1, &tConfig2}) {
+      tConfig->kvstore_config_ref()->enable_flood_optimization_ref() = true;
+      tConfig->spark_config_ref()->keepalive_time_ms_ref() = 20;
+      tConfig->spark_config_ref()->hold_time_ms_ref() = 80;
+    }
+
+    config1_ = std::make_shared<Config>(tConfig1);
+    config2_ = std::make_shared<Config>(tConfig2);
+  }
+};
+
+//
+// Start 2 Spark instances with fast failure detection and wait them forming
+// adj. Then stop heartbeats and verify both detect it within sub-second.
+//
+TEST_F(FastDetectionSparkFixture, HeartbeatTimerExpireTest) {
+  // create Spark instances and establish connections
+  createAndConnect();
+
+  // adjacency is kept while heartbeats are exchanged
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  EXPECT_TRUE(
+      node1_->getSparkNeighState(iface1, nodeName2_) == ESTABLISHED);
+  EXPECT_TRUE(
+      node2_->getSparkNeighState(iface2, nodeName1_) == ESTABLISHED);
+
+  // remove underneath connections between to nodes
+  auto startTime = std::chrono::steady_clock::now();
+  mockIoProvider_->setConnectedPairs({});
+
+  // wait for sparks to lose each other
+  EXPECT_TRUE(node1_->waitForEvents(NB_DOWN).has_value());
+  EXPECT_TRUE(node2_->waitForEvents(NB_DOWN).has_value());
+
+  auto detectionTime = std::chrono::steady_clock::now() - startTime;
+  LOG(INFO) << "Detected failure in "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(
+                   detectionTime)
+                   .count()
+            << "ms";
+  EXPECT_LT(detectionTime, std::chrono::seconds(1));
+}
+
+//
+// Shard interfaces of node-1 among 2 Spark instances. Each neighbor is
+// discovered only by the instance owning the interface it is connected to.
+//
+TEST_F(SparkFixture, ShardedInterfacesTest) {
+  mockIoProvider_->addIfNameIfIndex({{iface1, ifIndex1}, {iface2, ifIndex2}});
+  ConnectedIfPairs connectedPairs = {
+      {iface1, {{iface2, 10}}},
+      {iface2, {{iface1, 10}}},
+  };
+  mockIoProvider_->setConnectedPairs(connectedPairs);
+
+  const std::string nodeName1 = "node-1";
+  const std::string nodeName2 = "node-2";
+  auto tConfig1 = getBasicOpenrConfig(nodeName1);
+  tConfig1.spark_config_ref()->num_shards_ref() = 2;
+  auto config1 = std::make_shared<Config>(tConfig1);
+  auto config2 = std::make_shared<Config>(getBasicOpenrConfig(nodeName2));
+
+  const auto version = std::make_pair(
+      Constants::kOpenrVersion, Constants::kOpenrSupportedVersion);
+  std::vector<std::shared_ptr<SparkWrapper>> shards;
+  for (uint32_t shardId = 0; shardId < 2; ++shardId) {
+    shards.emplace_back(std::make_shared<SparkWrapper>(
+        nodeName1, version, mockIoProvider_, config1, true, shardId));
+  }
+  auto node2 = createSpark(nodeName2, config2);
+
+  // every shard receives all the interfaces and picks its own
+  for (auto& shard : shards) {
+    shard->updateInterfaceDb({InterfaceInfo(
+        iface1 /* ifName */,
+        true /* isUp */,
+        ifIndex1 /* ifIndex */,
+        {ip1V4, ip1V6} /* networks */)});
+  }
+  node2->updateInterfaceDb({InterfaceInfo(
+      iface2 /* ifName */,
+      true /* isUp */,
+      ifIndex2 /* ifIndex */,
+      {ip2V4, ip2V6} /* networks */)});
+
+  const auto ownerShardId = std::hash<std::string>{}(iface1) % 2;
+  auto& ownerShard = shards.at(ownerShardId);
+  auto& otherShard = shards.at(1 - ownerShardId);
+  {
+    auto events = ownerShard->waitForEvents(NB_UP);
+    ASSERT_TRUE(events.has_value() and events.value().size() == 1);
+    EXPECT_EQ(iface1, events.value().back().localIfName);
+    EXPECT_EQ(nodeName2, events.value().back().remoteNodeName);
+    EXPECT_TRUE(node2->waitForEvents(NB_UP).has_value());
+  }
+
+  EXPECT_FALSE(otherShard->getSparkNeighState(iface1, nodeName2).has_value());
+}
+
+//
+// Storm of hello msgs from many addresses over iface1 exhausts its rate-limit.
+// Heartbeats of established neighbor are exempted, hence adjacency stays up,
+// while drops are counted per pkt type.
+//
+TEST_F(SparkFixture, HelloStormUnderRateLimitTest) {
+  mockIoProvider_->addIfNameIfIndex(
+      {{iface1, ifIndex1}, {iface2, ifIndex2}, {iface3, ifIndex3}});
+  ConnectedIfPairs connectedPairs = {
+      {iface1, {{iface2, 10}}},
+      {iface2, {{iface1, 10}}},
+      {iface3, {{iface1, 10}}},
+  };
+  mockIoProvider_->setConnectedPairs(connectedPairs);
+
+  const std::string nodeName1 = "node-1";
+  const std::string nodeName2 = "node-2";
+  auto config1 = std::make_shared<Config>(getBasicOpenrConfig(nodeName1));
+  auto config2 = std::make_shared<Config>(getBasicOpenrConfig(nodeName2));
+
+  // ATTN: SparkWrapper goes with default Spark rate-limit when
+  // isRateLimitEnabled is false
+  auto node1 = std::make_shared<SparkWrapper>(
+      nodeName1,
+      std::make_pair(
+          Constants::kOpenrVersion, Constants::kOpenrSupportedVersion),
+      mockIoProvider_,
+      config1,
+      false /* isRateLimitEnabled */);
+  auto node2 = createSpark(nodeName2, config2);
+
+  node1->updateInterfaceDb({InterfaceInfo(
+      iface1 /* ifName */,
+      true /* isUp */,
+      ifIndex1 /* ifIndex */,
+      {ip1V4, ip1V6} /* networks */)});
+  node2->updateInterfaceDb({InterfaceInfo(
+      iface2 /* ifName */,
+      true /* isUp */,
+      ifIndex2 /* ifIndex */,
+      {ip2V4, ip2V6} /* networks */)});
+  ASSERT_TRUE(node1->waitForEvents(NB_UP).has_value());
+  ASSERT_TRUE(node2->waitForEvents(NB_UP).has_value());
+
+  // misbehaving peers behind iface3, each below rate-limit of neighbor
+  const folly::IPAddress mcastAddr(Constants::kSparkMcastAddr.toString());
+  const int stormFd = MockIoProviderUtils::createSocketAndJoinGroup(
+      mockIoProvider_, ifIndex3, mcastAddr);
+  apache::thrift::CompactSerializer serializer;
+  auto sendHello = [&](int peer) {
+    thrift::SparkHelloMsg helloMsg;
+    helloMsg.domainName_ref() = kDomainName;
+    helloMsg.nodeName_ref() = fmt::format("stormer-{}", peer);
+    helloMsg.ifName_ref() = iface3;
+    helloMsg.version_ref() = Constants::kOpenrVersion;
+    thrift::SparkHelloPacket pkt;
+    pkt.helloMsg_ref() = std::move(helloMsg);
+    auto packet = writeThriftObjStr(pkt, serializer);
+
+    const auto srcAddr = folly::IPAddress(fmt::format("fe80::1:{}", peer));
+    struct msghdr msg;
+    MockIoProviderUtils::AlignedCtrlBuf<struct in6_pktinfo> u;
+    sockaddr_storage dstAddrStorage;
+    struct iovec entry;
+    MockIoProviderUtils::prepareSendMessage(
+        (MockIoProviderUtils::bufferArgs<struct in6_pktinfo>){
+            .msg = msg,
+            .data = packet.data(),
+            .len = packet.size(),
+            .entry = entry,
+            .u = u,
+        },
+        (MockIoProviderUtils::networkArgs){
+            .srcIfIndex = ifIndex3,
+            .srcIPAddr = srcAddr,
+            .dstIPAddr = mcastAddr,
+            .dstPort = Constants::kSparkMcastPort,
+            .dstAddrStorage = dstAddrStorage,
+        });
+    mockIoProvider_->sendmsg(stormFd, &msg, MSG_DONTWAIT);
+  };
+
+  // keep storming for longer than hold time
+  const auto holdTime = config1->getSparkHoldTime();
+  const auto stormStart = std::chrono::steady_clock::now();
+  while (std::chrono::steady_clock::now() - stormStart < 2 * holdTime) {
+    for (int peer = 0; peer < 100; ++peer) {
+      sendHello(peer);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+
+  EXPECT_FALSE(node1
+                   ->waitForEvents(
+                       NB_DOWN,
+                       std::chrono::milliseconds(100),
+                       std::chrono::milliseconds(500))
+                   .has_value());
+  EXPECT_EQ(ESTABLISHED, node1->getSparkNeighState(iface1, nodeName2).value());
+  EXPECT_EQ(ESTABLISHED, node2->getSparkNeighState(iface2, nodeName1).value());
+
+  auto counters = fb303::fbData->getCounters();
+  ASSERT_TRUE(counters.count("spark.packet_dropped.hello.sum"));
+  EXPECT_LT(0, counters.at("spark.packet_dropped.hello.sum"));
+  EXPECT_EQ(0, counters.count("spark.packet_dropped.heartbeat.sum"));
+}
+
 //
 // Start 2 Spark instances and wait them forming adj. Then
 // update interface from one instance's perspective. Due to same
@@ -2077,6 +2295,57 @@ TEST_F(SparkFixture, MultiplePeersWithDiffAreaOverSameLink) {
   }
 }
 
+/**
+ * Validate heartbeat pkts are decoded without thrift deserialization and any
+ * other pkt is left to thrift.
+ */
+TEST(SparkTest, DecodeHeartbeatPacket) {
+  apache::thrift::CompactSerializer serializer;
+  auto toBytes = [](std::string const& str) {
+    return folly::ByteRange(folly::StringPiece(str));
+  };
+
+  const std::vector<int64_t> seqNums{
+      0, 1, 300, std::numeric_limits<int64_t>::max()};
+  // hold time is only advertised under adaptive keep-alive
+  const std::vector<std::optional<int64_t>> holdTimes{
+      std::nullopt, 80, 160000};
+  for (auto seqNum : seqNums) {
+    for (bool holdAdjacency : {true, false}) {
+      for (auto const& holdTime : holdTimes) {
+        thrift::SparkHeartbeatMsg heartbeatMsg;
+        heartbeatMsg.nodeName_ref() = "node-1";
+        heartbeatMsg.seqNum_ref() = seqNum;
+        heartbeatMsg.holdAdjacency_ref() = holdAdjacency;
+        if (holdTime.has_value()) {
+          heartbeatMsg.holdTime_ref() = holdTime.value();
+        }
+        thrift::SparkHelloPacket pkt;
+        pkt.heartbeatMsg_ref() = heartbeatMsg;
+        const auto bytes = writeThriftObjStr(pkt, serializer);
+
+        auto decoded = Spark::decodeHeartbeatPacket(toBytes(bytes));
+        ASSERT_TRUE(decoded.has_value());
+        EXPECT_EQ(heartbeatMsg, decoded.value());
+
+        // truncated pkt
+        EXPECT_FALSE(Spark::decodeHeartbeatPacket(
+                         toBytes(bytes.substr(0, bytes.size() - 1)))
+                         .has_value());
+      }
+    }
+  }
+
+  // hello msg
+  thrift::SparkHelloMsg helloMsg;
+  helloMsg.nodeName_ref() = "node-1";
+  thrift::SparkHelloPacket pkt;
+  pkt.helloMsg_ref() = std::move(helloMsg);
+  EXPECT_FALSE(
+      Spark::decodeHeartbeatPacket(toBytes(writeThriftObjStr(pkt, serializer)))
+          .has_value());
+}
+
 int
 main(int argc, char* argv[]) {
   // Parse command line flags
@@ -1770,6 +1770,83 @@ TEST(MockIoProviderTestSetup, PartialMeshOfNodesTest) {
   mockIoProviderThread.join();
 }
 
+//
+// This test sends and receives packets in batches along the follow topology.
+//
+// 3-node topology: 1 -> 2 (unidirectional)
+//                  3 (1-node island)
+//
+TEST(MockIoProviderTestSetup, BatchedSendRecvTest) {
+  folly::IPAddressV6 ipAddr1V6("fe80::1");
+  folly::IPAddressV6 ipAddr3V6("fe80::3");
+
+  std::string ifName1("iface1");
+  std::string ifName2("iface2");
+  std::string ifName3("iface3");
+
+  int ifIndex1 = 1;
+  int ifIndex2 = 2;
+  int ifIndex3 = 3;
+
+  auto mockIoProvider = std::make_shared<MockIoProvider>();
+  mockIoProvider->addIfNameIfIndex(
+      {{ifName1, ifIndex1}, {ifName2, ifIndex2}, {ifName3, ifIndex3}});
+  mockIoProvider->setConnectedPairs({{ifName1, {{ifName2, 0}}}});
+
+  int fd1 = createSocketAndJoinGroup(
+      mockIoProvider, ifIndex1, folly::IPAddress(kDiscardMulticastAddr));
+  int fd2 = createSocketAndJoinGroup(
+      mockIoProvider, ifIndex2, folly::IPAddress(kDiscardMulticastAddr));
+  createSocketAndJoinGroup(
+      mockIoProvider, ifIndex3, folly::IPAddress(kDiscardMulticastAddr));
+
+  // Failure of a message doesn't prevent following ones from being sent
+  std::vector<IoProvider::SendRequest> requests{
+      {ifIndex1, ipAddr1V6, "Batched message #1 from node1 to node2."},
+      {ifIndex3, ipAddr3V6, "Batched message from island node3."},
+      {ifIndex1, ipAddr1V6, "Batched message #2 from node1 to node2."},
+  };
+  folly::SocketAddress dstAddr(
+      folly::IPAddress(kDiscardMulticastAddr), kMockedUdpPort);
+  auto sendResults = IoProvider::sendMessages(
+      fd1, dstAddr, requests, mockIoProvider.get());
+  ASSERT_EQ(3, sendResults.size());
+  EXPECT_EQ(requests.at(0).packet.size(), sendResults.at(0));
+  EXPECT_GT(0, sendResults.at(1));
+  EXPECT_EQ(requests.at(2).packet.size(), sendResults.at(2));
+
+  // Both messages are received with one call once due
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  const size_t numMsgs = 4;
+  std::vector<unsigned char> recvBuf(numMsgs * kMinIpv6PktSize);
+  auto recvResults = IoProvider::recvMessages(
+      fd2, recvBuf.data(), kMinIpv6PktSize, numMsgs, mockIoProvider.get());
+  ASSERT_EQ(2, recvResults.size());
+  for (size_t i = 0; i < recvResults.size(); ++i) {
+    const auto& packet = requests.at(i * 2).packet;
+    const auto& [size, ifIndex, srcAddr, hopLimit, _] = recvResults.at(i);
+    EXPECT_EQ(packet.size(), size);
+    EXPECT_EQ(ifIndex2, ifIndex);
+    EXPECT_EQ(ipAddr1V6, srcAddr.getIPAddress());
+    EXPECT_EQ(255, hopLimit);
+    EXPECT_EQ(
+        packet,
+        std::string(
+            reinterpret_cast<const char*>(recvBuf.data()) +
+                i * kMinIpv6PktSize,
+            packet.size()));
+  }
+
+  // Nothing left to receive
+  EXPECT_TRUE(IoProvider::recvMessages(
+                  fd2,
+                  recvBuf.data(),
+                  kMinIpv6PktSize,
+                  numMsgs,
+                  mockIoProvider.get())
+                  .empty());
+}
+
 int
 main(int argc, char* argv[]) {
   testing::InitGoogleTest(&argc, argv);
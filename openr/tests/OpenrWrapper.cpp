@@ -5,6 +5,9 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <pthread.h>
+#include <time.h>
+
 #include <openr/tests/OpenrWrapper.h>
 #include <openr/tests/utils/Utils.h>
 
@@ -25,7 +28,8 @@ OpenrWrapper<Serializer>::OpenrWrapper(
     std::chrono::milliseconds linkFlapInitialBackoff,
     std::chrono::milliseconds linkFlapMaxBackoff,
     std::shared_ptr<IoProvider> ioProvider,
-    uint32_t memLimit)
+    uint32_t memLimit,
+    bool enablePrefixAllocation)
     : context_(context),
       nodeId_(nodeId),
       ioProvider_(std::move(ioProvider)),
@@ -54,7 +58,7 @@ OpenrWrapper<Serializer>::OpenrWrapper(
   tConfig.decision_config_ref()->enable_bgp_route_programming_ref() = true;
 
   // prefix allocation config
-  tConfig.enable_prefix_allocation_ref() = true;
+  tConfig.enable_prefix_allocation_ref() = enablePrefixAllocation;
   thrift::PrefixAllocationConfig pfxAllocationConf;
   pfxAllocationConf.loopback_interface_ref() = "";
   pfxAllocationConf.prefix_allocation_mode_ref() =
@@ -81,6 +85,41 @@ OpenrWrapper<Serializer>::OpenrWrapper(
   tConfig.persistent_config_store_path_ref() =
       fmt::format("/tmp/{}_openr_config_store.bin", nodeId_);
 
+  // create and start kvstore thread
+  const Config kvStoreConfig(tConfig);
+  kvStore_ = std::make_unique<KvStore<thrift::OpenrCtrlCppAsyncClient>>(
+      context_,
+      kvStoreUpdatesQueue_,
+      kvStoreEventsQueue_,
+      peerUpdatesQueue_.getReader(),
+      kvRequestQueue_.getReader(),
+      logSampleQueue_,
+      KvStoreGlobalCmdUrl{kvStoreGlobalCmdUrl_},
+      kvStoreConfig.getAreaIds(),
+      kvStoreConfig.toThriftKvStoreConfig());
+  std::thread kvStoreThread([this]() noexcept {
+    VLOG(1) << nodeId_ << " KvStore running.";
+    kvStore_->run();
+    VLOG(1) << nodeId_ << " KvStore stopped.";
+  });
+  kvStore_->waitUntilRunning();
+  allThreads_.emplace_back(std::move(kvStoreThread));
+
+  // start thrift server for KvStore peers to sync with. Spark advertises its
+  // port to neighbors, from which LinkMonitor creates KvStore peers.
+  kvStoreServiceHandler_ = std::make_shared<
+      KvStoreServiceHandler<thrift::OpenrCtrlCppAsyncClient>>(
+      nodeId_, kvStore_.get());
+  auto server = std::make_shared<apache::thrift::ThriftServer>();
+  server->setNumIOWorkerThreads(1);
+  server->setNumAcceptThreads(1);
+  server->setNumCPUWorkerThreads(1);
+  server->setPort(0);
+  server->setInterface(kvStoreServiceHandler_);
+  kvStoreThriftServerThread_.start(std::move(server));
+  tConfig.thrift_server_ref()->openr_ctrl_port_ref() =
+      kvStoreThriftServerThread_.getAddress()->getPort();
+
   config_ = std::make_shared<Config>(tConfig);
 
   // create MockNetlinkProtocolSocket
@@ -100,25 +139,6 @@ OpenrWrapper<Serializer>::OpenrWrapper(
   configStore_->waitUntilRunning();
   allThreads_.emplace_back(std::move(configStoreThread));
 
-  // create and start kvstore thread
-  kvStore_ = std::make_unique<KvStore<thrift::OpenrCtrlCppAsyncClient>>(
-      context_,
-      kvStoreUpdatesQueue_,
-      kvStoreEventsQueue_,
-      peerUpdatesQueue_.getReader(),
-      kvRequestQueue_.getReader(),
-      logSampleQueue_,
-      KvStoreGlobalCmdUrl{kvStoreGlobalCmdUrl_},
-      config_->getAreaIds(),
-      config_->toThriftKvStoreConfig());
-  std::thread kvStoreThread([this]() noexcept {
-    VLOG(1) << nodeId_ << " KvStore running.";
-    kvStore_->run();
-    VLOG(1) << nodeId_ << " KvStore stopped.";
-  });
-  kvStore_->waitUntilRunning();
-  allThreads_.emplace_back(std::move(kvStoreThread));
-
   // kvstore client
   kvStoreClient_ = std::make_unique<KvStoreClientInternal>(
       &eventBase_, nodeId_, kvStore_.get());
@@ -218,18 +238,32 @@ OpenrWrapper<Serializer>::OpenrWrapper(
       fibRouteUpdatesQueue_,
       logSampleQueue_);
 
+  // record time of programmed route updates
+  eventBase_.addFiberTask(
+      [this, q = fibRouteUpdatesQueue_.getReader()]() mutable noexcept {
+        while (true) {
+          auto maybeUpdate = q.get();
+          if (maybeUpdate.hasError()) {
+            break;
+          }
+          lastFibUpdateTime_ = std::chrono::steady_clock::now();
+        }
+      });
+
   //
   // create PrefixAllocator
   //
-  prefixAllocator_ = std::make_unique<PrefixAllocator>(
-      kTestingAreaName,
-      config_,
-      nlSock_.get(),
-      kvStore_.get(),
-      configStore_.get(),
-      prefixUpdatesQueue_,
-      logSampleQueue_,
-      Constants::kPrefixAllocatorSyncInterval);
+  if (enablePrefixAllocation) {
+    prefixAllocator_ = std::make_unique<PrefixAllocator>(
+        kTestingAreaName,
+        config_,
+        nlSock_.get(),
+        kvStore_.get(),
+        configStore_.get(),
+        prefixUpdatesQueue_,
+        logSampleQueue_,
+        Constants::kPrefixAllocatorSyncInterval);
+  }
 
   // Watchdog thread to monitor thread aliveness
   watchdog = std::make_unique<Watchdog>(config_);
@@ -267,13 +301,15 @@ OpenrWrapper<Serializer>::run() {
   allThreads_.emplace_back(std::move(prefixManagerThread));
 
   // Spawn a PrefixAllocator thread
-  std::thread prefixAllocatorThread([this]() noexcept {
-    VLOG(1) << nodeId_ << " PrefixAllocator running.";
-    prefixAllocator_->run();
-    VLOG(1) << nodeId_ << " PrefixAllocator stopped.";
-  });
-  prefixAllocator_->waitUntilRunning();
-  allThreads_.emplace_back(std::move(prefixAllocatorThread));
+  if (prefixAllocator_) {
+    std::thread prefixAllocatorThread([this]() noexcept {
+      VLOG(1) << nodeId_ << " PrefixAllocator running.";
+      prefixAllocator_->run();
+      VLOG(1) << nodeId_ << " PrefixAllocator stopped.";
+    });
+    prefixAllocator_->waitUntilRunning();
+    allThreads_.emplace_back(std::move(prefixAllocatorThread));
+  }
 
   // start spark thread
   std::thread sparkThread([this]() {
@@ -361,12 +397,17 @@ OpenrWrapper<Serializer>::stop() {
   linkMonitor_->waitUntilStopped();
   spark_->stop();
   spark_->waitUntilStopped();
-  prefixAllocator_->stop();
-  prefixAllocator_->waitUntilStopped();
+  if (prefixAllocator_) {
+    prefixAllocator_->stop();
+    prefixAllocator_->waitUntilStopped();
+  }
   prefixManager_->stop();
   prefixManager_->waitUntilStopped();
   monitor_->stop();
   monitor_->waitUntilStopped();
+  // stop serving peers before KvStore goes away
+  kvStoreThriftServerThread_.stop();
+  kvStoreThriftServerThread_.join();
   kvStore_->stop();
   kvStore_->waitUntilStopped();
   configStore_->stop();
@@ -470,6 +511,17 @@ OpenrWrapper<Serializer>::updateInterfaceDb(const InterfaceDatabase& ifDb) {
   interfaceUpdatesQueue_.push(ifDb);
 }
 
+template <class Serializer>
+void
+OpenrWrapper<Serializer>::setInterface(const InterfaceInfo& interfaceInfo) {
+  nlEventsInjector_->sendLinkEvent(
+      interfaceInfo.ifName, interfaceInfo.ifIndex, interfaceInfo.isUp);
+  for (const auto& network : interfaceInfo.networks) {
+    nlEventsInjector_->sendAddrEvent(
+        interfaceInfo.ifName, folly::IPAddress::networkToString(network), true);
+  }
+}
+
 template <class Serializer>
 thrift::RouteDatabase
 OpenrWrapper<Serializer>::fibDumpRouteDatabase() {
@@ -515,6 +567,23 @@ OpenrWrapper<Serializer>::getCounters() {
   return facebook::fb303::fbData->getCounters();
 }
 
+template <class Serializer>
+std::chrono::nanoseconds
+OpenrWrapper<Serializer>::getCpuTime() {
+  std::chrono::nanoseconds cpuTime{0};
+  for (auto& thread : allThreads_) {
+    clockid_t clockId;
+    struct timespec ts;
+    if (thread.joinable() and
+        pthread_getcpuclockid(thread.native_handle(), &clockId) == 0 and
+        clock_gettime(clockId, &ts) == 0) {
+      cpuTime += std::chrono::seconds(ts.tv_sec) +
+          std::chrono::nanoseconds(ts.tv_nsec);
+    }
+  }
+  return cpuTime;
+}
+
 // define template instance for some common serializers
 template class OpenrWrapper<apache::thrift::CompactSerializer>;
 template class OpenrWrapper<apache::thrift::BinarySerializer>;
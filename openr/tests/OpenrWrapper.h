@@ -9,6 +9,7 @@
 
 #include <fb303/BaseService.h>
 #include <fbzmq/zmq/Zmq.h>
+#include <thrift/lib/cpp2/util/ScopedServerThread.h>
 
 #include <openr/allocators/PrefixAllocator.h>
 #include <openr/config/Config.h>
@@ -16,6 +17,7 @@
 #include <openr/fib/Fib.h>
 #include <openr/if/gen-cpp2/OpenrCtrlCppAsyncClient.h>
 #include <openr/kvstore/KvStore.h>
+#include <openr/kvstore/KvStoreServiceHandler.h>
 #include <openr/link-monitor/LinkMonitor.h>
 #include <openr/monitor/LogSample.h>
 #include <openr/monitor/Monitor.h>
@@ -52,7 +54,8 @@ class OpenrWrapper {
       std::chrono::milliseconds linkFlapInitialBackoff,
       std::chrono::milliseconds linkFlapMaxBackoff,
       std::shared_ptr<IoProvider> ioProvider,
-      uint32_t memLimit = openr::memLimitMB);
+      uint32_t memLimit = openr::memLimitMB,
+      bool enablePrefixAllocation = true);
 
   ~OpenrWrapper() {
     stop();
@@ -76,6 +79,12 @@ class OpenrWrapper {
    */
   void updateInterfaceDb(const InterfaceDatabase& ifDb);
 
+  /**
+   * mimick netlink link and address events of interface, LinkMonitor then
+   * advertises it to Spark like on a real system
+   */
+  void setInterface(const InterfaceInfo& interfaceInfo);
+
   /**
    * get route databse from fib
    */
@@ -106,6 +115,28 @@ class OpenrWrapper {
    */
   std::map<std::string, int64_t> getCounters();
 
+  /*
+   * CPU time consumed by module threads of this instance
+   */
+  std::chrono::nanoseconds getCpuTime();
+
+  /*
+   * time of last route update programmed by fib, unset if none yet
+   */
+  std::optional<std::chrono::steady_clock::time_point>
+  getLastFibUpdateTime() const {
+    auto lastFibUpdateTime = lastFibUpdateTime_.load();
+    if (lastFibUpdateTime == std::chrono::steady_clock::time_point()) {
+      return std::nullopt;
+    }
+    return lastFibUpdateTime;
+  }
+
+  const std::string&
+  getNodeId() const {
+    return nodeId_;
+  }
+
   /*
    * watchdog thread (used for checking memory limit exceeded)
    */
@@ -144,6 +175,14 @@ class OpenrWrapper {
   // event loop to use with KvStoreClientInternal
   OpenrEventBase eventBase_;
 
+  // thrift server of KvStore for peers to sync with
+  std::shared_ptr<KvStoreServiceHandler<thrift::OpenrCtrlCppAsyncClient>>
+      kvStoreServiceHandler_;
+  apache::thrift::util::ScopedServerThread kvStoreThriftServerThread_;
+
+  // updated by reader of fibRouteUpdatesQueue_
+  std::atomic<std::chrono::steady_clock::time_point> lastFibUpdateTime_{};
+
   // sub modules owned by this wrapper
   std::shared_ptr<Config> config_;
   std::unique_ptr<PersistentStore> configStore_;
@@ -168,7 +207,7 @@ class OpenrWrapper {
   messaging::ReplicateQueue<thrift::InitializationEvent>
       initializationEventQueue_;
   messaging::ReplicateQueue<PrefixEvent> prefixUpdatesQueue_;
-  messaging::ReplicateQueue<KvStorePublication> kvStoreUpdatesQueue_;
+  messaging::SharedReplicateQueue<KvStorePublication> kvStoreUpdatesQueue_;
   messaging::ReplicateQueue<DecisionRouteUpdate> staticRoutesQueue_;
   messaging::ReplicateQueue<DecisionRouteUpdate> prefixMgrRoutesQueue_;
   messaging::ReplicateQueue<DecisionRouteUpdate> fibRouteUpdatesQueue_;
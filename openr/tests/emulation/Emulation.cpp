@@ -0,0 +1,471 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_set>
+
+#include <fb303/ServiceData.h>
+#include <fmt/format.h>
+#include <folly/Conv.h>
+#include <folly/MapUtil.h>
+#include <glog/logging.h>
+
+#include <openr/common/LsdbUtil.h>
+#include <openr/common/NetworkUtil.h>
+#include <openr/tests/emulation/Emulation.h>
+
+namespace fb303 = facebook::fb303;
+
+namespace openr {
+
+namespace {
+
+// Spark timers passed to every node
+const std::chrono::milliseconds kSpark2HelloTime(100);
+const std::chrono::milliseconds kSpark2FastInitHelloTime(20);
+const std::chrono::milliseconds kSpark2HandshakeTime(20);
+const std::chrono::milliseconds kSpark2HeartbeatTime(20);
+const std::chrono::milliseconds kSpark2HandshakeHoldTime(200);
+const std::chrono::milliseconds kSpark2HeartbeatHoldTime(500);
+const std::chrono::milliseconds kSpark2GRHoldTime(1000);
+const std::chrono::milliseconds kLinkFlapInitialBackoff(1);
+const std::chrono::milliseconds kLinkFlapMaxBackoff(8);
+
+// MockIoProvider maps interfaces of all nodes, keep clear of other indexes
+const int kIfIndexBase{1000};
+
+// Tokens of line, with comment stripped
+std::vector<std::string>
+tokenize(const std::string& line) {
+  std::istringstream stream(line.substr(0, line.find('#')));
+  std::vector<std::string> tokens;
+  std::string token;
+  while (stream >> token) {
+    tokens.emplace_back(std::move(token));
+  }
+  return tokens;
+}
+
+// Call `func` with tokens of every non empty line and its line number
+template <typename Func>
+void
+forEachLine(const std::string& content, Func&& func) {
+  std::istringstream stream(content);
+  std::string line;
+  for (size_t lineNum = 1; std::getline(stream, line); ++lineNum) {
+    auto tokens = tokenize(line);
+    if (not tokens.empty()) {
+      func(lineNum, tokens);
+    }
+  }
+}
+
+folly::CIDRNetwork
+getLinkLocalAddr(size_t nodeIdx) {
+  return folly::IPAddress::createNetwork(
+      fmt::format("fe80::{:x}/64", nodeIdx + 1), -1, false);
+}
+
+int64_t
+getCounterDelta(
+    const std::map<std::string, int64_t>& before,
+    const std::map<std::string, int64_t>& after,
+    const std::string& key) {
+  return folly::get_default(after, key, 0) - folly::get_default(before, key, 0);
+}
+
+} // namespace
+
+EmulationTopology
+EmulationTopology::parse(const std::string& content) {
+  EmulationTopology topology;
+  std::unordered_set<std::string> nodes;
+  auto addNode = [&](const std::string& node) {
+    if (nodes.insert(node).second) {
+      topology.nodes.emplace_back(node);
+    }
+  };
+
+  forEachLine(content, [&](size_t lineNum, const auto& tokens) {
+    if (tokens.size() < 2 or tokens.size() > 3) {
+      throw std::invalid_argument(fmt::format(
+          "Line {}: expected <node> <node> [<latency_ms>]", lineNum));
+    }
+    EmulationLink link{tokens.at(0), tokens.at(1)};
+    if (link.node1 == link.node2) {
+      throw std::invalid_argument(
+          fmt::format("Line {}: link of {} to itself", lineNum, link.node1));
+    }
+    if (tokens.size() == 3) {
+      auto latencyMs = folly::tryTo<int32_t>(tokens.at(2));
+      if (latencyMs.hasError() or *latencyMs < 0) {
+        throw std::invalid_argument(fmt::format(
+            "Line {}: invalid latency {}", lineNum, tokens.at(2)));
+      }
+      link.latencyMs = *latencyMs;
+    }
+    addNode(link.node1);
+    addNode(link.node2);
+    topology.links.emplace_back(std::move(link));
+  });
+  return topology;
+}
+
+std::string
+EmulationEvent::toString() const {
+  switch (type) {
+  case EmulationEventType::LINK_DOWN:
+    return fmt::format("link-down {} {}", node1, node2);
+  case EmulationEventType::LINK_UP:
+    return fmt::format("link-up {} {}", node1, node2);
+  case EmulationEventType::NODE_DOWN:
+    return fmt::format("node-down {}", node1);
+  case EmulationEventType::NODE_UP:
+    return fmt::format("node-up {}", node1);
+  }
+  return "";
+}
+
+std::vector<EmulationEvent>
+EmulationEvent::parseScenario(
+    const std::string& content, const EmulationTopology& topology) {
+  const std::unordered_set<std::string> nodes(
+      topology.nodes.begin(), topology.nodes.end());
+  std::vector<EmulationEvent> events;
+
+  forEachLine(content, [&](size_t lineNum, const auto& tokens) {
+    const auto& command = tokens.at(0);
+    EmulationEvent event;
+    size_t numNodes{1};
+    if (command == "link-down") {
+      event.type = EmulationEventType::LINK_DOWN;
+      numNodes = 2;
+    } else if (command == "link-up") {
+      event.type = EmulationEventType::LINK_UP;
+      numNodes = 2;
+    } else if (command == "node-down") {
+      event.type = EmulationEventType::NODE_DOWN;
+    } else if (command == "node-up") {
+      event.type = EmulationEventType::NODE_UP;
+    } else {
+      throw std::invalid_argument(
+          fmt::format("Line {}: unknown event {}", lineNum, command));
+    }
+    if (tokens.size() != numNodes + 1) {
+      throw std::invalid_argument(fmt::format(
+          "Line {}: expected {} node(s) for {}", lineNum, numNodes, command));
+    }
+    for (size_t i = 1; i < tokens.size(); ++i) {
+      if (not nodes.count(tokens.at(i))) {
+        throw std::invalid_argument(
+            fmt::format("Line {}: unknown node {}", lineNum, tokens.at(i)));
+      }
+    }
+    event.node1 = tokens.at(1);
+    if (numNodes == 2) {
+      event.node2 = tokens.at(2);
+      const bool hasLink = std::any_of(
+          topology.links.begin(), topology.links.end(), [&](const auto& l) {
+            return (l.node1 == event.node1 and l.node2 == event.node2) or
+                (l.node1 == event.node2 and l.node2 == event.node1);
+          });
+      if (not hasLink) {
+        throw std::invalid_argument(fmt::format(
+            "Line {}: no link between {} and {}",
+            lineNum,
+            event.node1,
+            event.node2));
+      }
+    }
+    events.emplace_back(std::move(event));
+  });
+  return events;
+}
+
+Emulation::Emulation(EmulationTopology topology, EmulationParams params)
+    : topology_(std::move(topology)),
+      params_(std::move(params)),
+      mockIoProvider_(std::make_shared<MockIoProvider>()) {
+  mockIoProviderThread_ = std::thread([this]() {
+    LOG(INFO) << "Starting mockIoProvider thread.";
+    mockIoProvider_->start();
+    LOG(INFO) << "mockIoProvider thread got stopped.";
+  });
+  mockIoProvider_->waitUntilRunning();
+
+  for (size_t i = 0; i < topology_.nodes.size(); ++i) {
+    nodeIndexes_.emplace(topology_.nodes.at(i), i);
+    loopbackNodes_.emplace(getLoopbackPrefix(i), i);
+  }
+
+  // Interfaces are named by link, as MockIoProvider is shared by all nodes
+  IfNameAndifIndex ifNameAndIfIndexes;
+  for (size_t linkIdx = 0; linkIdx < topology_.links.size(); ++linkIdx) {
+    auto createEndpoint = [&](const std::string& node, size_t side) {
+      const auto nodeIdx = nodeIndexes_.at(node);
+      const auto ifName = fmt::format("if{}-{}", linkIdx, side);
+      const int ifIndex = kIfIndexBase + 2 * linkIdx + side;
+      ifNameAndIfIndexes.emplace_back(ifName, ifIndex);
+      return Endpoint{
+          nodeIdx,
+          InterfaceInfo(ifName, false, ifIndex, {getLinkLocalAddr(nodeIdx)})};
+    };
+    const auto& link = topology_.links.at(linkIdx);
+    endpoints_.emplace_back(
+        createEndpoint(link.node1, 0), createEndpoint(link.node2, 1));
+  }
+  mockIoProvider_->addIfNameIfIndex(ifNameAndIfIndexes);
+  isLinkUp_.assign(topology_.links.size(), false);
+}
+
+Emulation::~Emulation() {
+  // Stop all nodes before MockIoProvider they send Spark packets to
+  nodes_.clear();
+  LOG(INFO) << "Stopping mockIoProvider thread.";
+  mockIoProvider_->stop();
+  mockIoProviderThread_.join();
+}
+
+folly::CIDRNetwork
+Emulation::getLoopbackPrefix(size_t nodeIdx) {
+  return folly::IPAddress::createNetwork(
+      fmt::format("fd00::{:x}/128", nodeIdx + 1));
+}
+
+EmulationStepResult
+Emulation::start() {
+  CHECK(nodes_.empty()) << "Emulation is already started";
+  const auto before = takeSnapshot();
+
+  for (size_t i = 0; i < topology_.nodes.size(); ++i) {
+    nodes_.emplace_back(
+        std::make_unique<OpenrWrapper<apache::thrift::CompactSerializer>>(
+            context_,
+            topology_.nodes.at(i),
+            false /* v4Enabled */,
+            kSpark2HelloTime,
+            kSpark2FastInitHelloTime,
+            kSpark2HandshakeTime,
+            kSpark2HeartbeatTime,
+            kSpark2HandshakeHoldTime,
+            kSpark2HeartbeatHoldTime,
+            kSpark2GRHoldTime,
+            kLinkFlapInitialBackoff,
+            kLinkFlapMaxBackoff,
+            mockIoProvider_,
+            params_.memLimitMB,
+            false /* enablePrefixAllocation */));
+    nodes_.back()->run();
+    nodes_.back()->addPrefixEntries(
+        thrift::PrefixType::LOOPBACK,
+        {createPrefixEntry(toIpPrefix(getLoopbackPrefix(i)))});
+  }
+  LOG(INFO) << "Started " << nodes_.size() << " nodes";
+
+  for (size_t linkIdx = 0; linkIdx < topology_.links.size(); ++linkIdx) {
+    setLinkState(linkIdx, true);
+  }
+  updateConnectedPairs();
+
+  return waitForConvergence(
+      fmt::format(
+          "start {} nodes, {} links",
+          topology_.nodes.size(),
+          topology_.links.size()),
+      before);
+}
+
+EmulationStepResult
+Emulation::runEvent(const EmulationEvent& event) {
+  CHECK(not nodes_.empty()) << "Emulation is not started";
+  const bool isUp =
+      (event.type == EmulationEventType::LINK_UP or
+       event.type == EmulationEventType::NODE_UP);
+  const bool isNodeEvent =
+      (event.type == EmulationEventType::NODE_DOWN or
+       event.type == EmulationEventType::NODE_UP);
+
+  const auto before = takeSnapshot();
+  for (size_t linkIdx = 0; linkIdx < topology_.links.size(); ++linkIdx) {
+    const auto& link = topology_.links.at(linkIdx);
+    const bool matches = isNodeEvent
+        ? (link.node1 == event.node1 or link.node2 == event.node1)
+        : ((link.node1 == event.node1 and link.node2 == event.node2) or
+           (link.node1 == event.node2 and link.node2 == event.node1));
+    if (matches) {
+      setLinkState(linkIdx, isUp);
+    }
+  }
+  updateConnectedPairs();
+
+  return waitForConvergence(event.toString(), before);
+}
+
+void
+Emulation::setLinkState(size_t linkIdx, bool isUp) {
+  isLinkUp_.at(linkIdx) = isUp;
+  auto& [endpoint1, endpoint2] = endpoints_.at(linkIdx);
+  for (auto* endpoint : {&endpoint1, &endpoint2}) {
+    endpoint->interfaceInfo.isUp = isUp;
+    nodes_.at(endpoint->nodeIdx)->setInterface(endpoint->interfaceInfo);
+  }
+}
+
+void
+Emulation::updateConnectedPairs() {
+  ConnectedIfPairs connectedPairs;
+  for (size_t linkIdx = 0; linkIdx < topology_.links.size(); ++linkIdx) {
+    if (not isLinkUp_.at(linkIdx)) {
+      continue;
+    }
+    const auto latencyMs = topology_.links.at(linkIdx).latencyMs;
+    const auto& ifName1 = endpoints_.at(linkIdx).first.interfaceInfo.ifName;
+    const auto& ifName2 = endpoints_.at(linkIdx).second.interfaceInfo.ifName;
+    connectedPairs[ifName1].emplace_back(ifName2, latencyMs);
+    connectedPairs[ifName2].emplace_back(ifName1, latencyMs);
+  }
+  mockIoProvider_->setConnectedPairs(std::move(connectedPairs));
+}
+
+std::vector<size_t>
+Emulation::getComponentIds() const {
+  // Union-find over links which are up
+  std::vector<size_t> parents(topology_.nodes.size());
+  std::iota(parents.begin(), parents.end(), 0);
+  auto find = [&](size_t nodeIdx) {
+    while (parents.at(nodeIdx) != nodeIdx) {
+      nodeIdx = parents.at(nodeIdx) = parents.at(parents.at(nodeIdx));
+    }
+    return nodeIdx;
+  };
+  for (size_t linkIdx = 0; linkIdx < topology_.links.size(); ++linkIdx) {
+    if (isLinkUp_.at(linkIdx)) {
+      parents.at(find(endpoints_.at(linkIdx).first.nodeIdx)) =
+          find(endpoints_.at(linkIdx).second.nodeIdx);
+    }
+  }
+
+  std::vector<size_t> componentIds(topology_.nodes.size());
+  for (size_t i = 0; i < componentIds.size(); ++i) {
+    componentIds.at(i) = find(i);
+  }
+  return componentIds;
+}
+
+size_t
+Emulation::getNumNodesWithWrongRoutes() {
+  const auto componentIds = getComponentIds();
+  std::unordered_map<size_t, size_t> componentSizes;
+  for (const auto componentId : componentIds) {
+    ++componentSizes[componentId];
+  }
+
+  size_t numNodesWithWrongRoutes{0};
+  for (size_t i = 0; i < nodes_.size(); ++i) {
+    const auto routeDb = nodes_.at(i)->fibDumpRouteDatabase();
+    bool isWrong{false};
+    size_t numLoopbackRoutes{0};
+    for (const auto& route : *routeDb.unicastRoutes_ref()) {
+      auto it = loopbackNodes_.find(toIPNetwork(*route.dest_ref()));
+      if (it == loopbackNodes_.end()) {
+        continue;
+      }
+      // route to own or unreachable loopback
+      isWrong |= (it->second == i) or
+          (componentIds.at(it->second) != componentIds.at(i));
+      ++numLoopbackRoutes;
+    }
+    isWrong |=
+        (numLoopbackRoutes + 1 != componentSizes.at(componentIds.at(i)));
+    if (isWrong) {
+      VLOG(1) << "Node " << nodes_.at(i)->getNodeId() << " has "
+              << numLoopbackRoutes << " routes to loopbacks, expected "
+              << componentSizes.at(componentIds.at(i)) - 1;
+      ++numNodesWithWrongRoutes;
+    }
+  }
+  return numNodesWithWrongRoutes;
+}
+
+Emulation::Snapshot
+Emulation::takeSnapshot() {
+  Snapshot snapshot;
+  snapshot.time = std::chrono::steady_clock::now();
+  snapshot.counters = fb303::fbData->getCounters();
+  for (auto& node : nodes_) {
+    snapshot.cpuTimes.emplace_back(node->getCpuTime());
+  }
+  return snapshot;
+}
+
+EmulationStepResult
+Emulation::waitForConvergence(std::string description, const Snapshot& before) {
+  EmulationStepResult result;
+  result.description = std::move(description);
+
+  // Fibs are compared against topology once quiet, and again once quiet for
+  // another period if they don't match yet, e.g. on slow failure detection.
+  auto lastCheck = before.time;
+  while (true) {
+    std::this_thread::sleep_for(params_.pollInterval);
+    const auto now = std::chrono::steady_clock::now();
+    auto lastUpdate = before.time;
+    for (const auto& node : nodes_) {
+      auto nodeLastUpdate = node->getLastFibUpdateTime();
+      if (nodeLastUpdate.has_value()) {
+        lastUpdate = std::max(lastUpdate, *nodeLastUpdate);
+      }
+    }
+
+    const bool timedOut = now - before.time >= params_.convergenceTimeout;
+    if (not timedOut and
+        now - std::max(lastUpdate, lastCheck) < params_.quietPeriod) {
+      continue;
+    }
+    lastCheck = now;
+    result.numNodesWithWrongRoutes = getNumNodesWithWrongRoutes();
+    if (result.numNodesWithWrongRoutes == 0) {
+      result.convergenceTime =
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+              lastUpdate - before.time);
+      break;
+    }
+    if (timedOut) {
+      LOG(ERROR) << result.description << ": "
+                 << result.numNodesWithWrongRoutes
+                 << " nodes did not converge within "
+                 << params_.convergenceTimeout.count() << "ms";
+      break;
+    }
+  }
+
+  const auto after = takeSnapshot();
+  result.numReceivedKeyVals = getCounterDelta(
+      before.counters, after.counters, "kvstore.received_key_vals.sum");
+  result.numUpdatedKeyVals = getCounterDelta(
+      before.counters, after.counters, "kvstore.updated_key_vals.sum");
+  for (size_t i = 0; i < nodes_.size(); ++i) {
+    const auto cpuTime = after.cpuTimes.at(i) -
+        (i < before.cpuTimes.size() ? before.cpuTimes.at(i)
+                                    : std::chrono::nanoseconds(0));
+    result.totalCpuTime += cpuTime;
+    if (cpuTime >= result.maxNodeCpuTime) {
+      result.maxNodeCpuTime = cpuTime;
+      result.maxCpuNode = nodes_.at(i)->getNodeId();
+    }
+  }
+  if (not nodes_.empty()) {
+    result.rssBytesPerNode =
+        systemMetrics_.getRSSMemBytes().value_or(0) / nodes_.size();
+  }
+  return result;
+}
+
+} // namespace openr
@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <fbzmq/zmq/Zmq.h>
+#include <folly/IPAddress.h>
+#include <thrift/lib/cpp2/protocol/Serializer.h>
+
+#include <openr/monitor/SystemMetrics.h>
+#include <openr/tests/OpenrWrapper.h>
+#include <openr/tests/mocks/MockIoProvider.h>
+
+namespace openr {
+
+/**
+ * Link between two emulated nodes
+ */
+struct EmulationLink {
+  std::string node1;
+  std::string node2;
+  // one way latency of Spark packets
+  int32_t latencyMs{1};
+};
+
+/**
+ * Topology of emulated network, parsed from text with one link per line:
+ *
+ *   <node> <node> [<latency_ms>]
+ *
+ * Empty lines and comments starting with '#' are ignored. Nodes are numbered
+ * in order of first appearance.
+ */
+struct EmulationTopology {
+  std::vector<std::string> nodes;
+  std::vector<EmulationLink> links;
+
+  // throws std::invalid_argument on malformed content
+  static EmulationTopology parse(const std::string& content);
+};
+
+enum class EmulationEventType {
+  LINK_DOWN,
+  LINK_UP,
+  NODE_DOWN,
+  NODE_UP,
+};
+
+/**
+ * Scripted change of emulated network, parsed from text with one event per
+ * line, ignoring empty lines and comments starting with '#':
+ *
+ *   link-down <node> <node>
+ *   link-up <node> <node>
+ *   node-down <node>
+ *   node-up <node>
+ *
+ * Link events apply to all links between the two nodes. Node events apply to
+ * all links of the node, i.e. the node is isolated but keeps running.
+ */
+struct EmulationEvent {
+  EmulationEventType type;
+  std::string node1;
+  // empty for node events
+  std::string node2;
+
+  std::string toString() const;
+
+  // throws std::invalid_argument on malformed content or unknown nodes
+  static std::vector<EmulationEvent> parseScenario(
+      const std::string& content, const EmulationTopology& topology);
+};
+
+struct EmulationParams {
+  // network is converged once no fib of any node changed for this long
+  std::chrono::milliseconds quietPeriod{5000};
+  // give up waiting for convergence after this long
+  std::chrono::milliseconds convergenceTimeout{300000};
+  // interval of checking for convergence
+  std::chrono::milliseconds pollInterval{100};
+  // memory limit of watchdog, for the whole process
+  uint32_t memLimitMB{1 << 20};
+};
+
+/**
+ * Measurements of one step, i.e. bring-up or event of the scenario
+ */
+struct EmulationStepResult {
+  std::string description;
+  // time from the step to the last fib update of any node. Unset if the
+  // network didn't converge within timeout.
+  std::optional<std::chrono::milliseconds> convergenceTime;
+  // nodes whose fib doesn't match reachability of current topology
+  size_t numNodesWithWrongRoutes{0};
+  // key-vals received by all stores, and those of them updating the store.
+  // Their ratio is the flood amplification, 1 when every update reaches
+  // every store exactly once.
+  int64_t numReceivedKeyVals{0};
+  int64_t numUpdatedKeyVals{0};
+  // CPU time of all nodes, and the node using most of it
+  std::chrono::nanoseconds totalCpuTime{0};
+  std::chrono::nanoseconds maxNodeCpuTime{0};
+  std::string maxCpuNode;
+  // RSS of the process, divided by number of nodes
+  size_t rssBytesPerNode{0};
+
+  double
+  getFloodAmplification() const {
+    return numUpdatedKeyVals
+        ? static_cast<double>(numReceivedKeyVals) / numUpdatedKeyVals
+        : 0;
+  }
+};
+
+/**
+ * In-process emulation of an Open/R network. Every node is a full Open/R
+ * instance (OpenrWrapper) on mocked netlink. Spark packets of all nodes go
+ * through one MockIoProvider, KvStores peer over thrift on local host.
+ *
+ * Every node advertises a loopback prefix. After each step the harness waits
+ * until fibs stop changing, and checks that every node has routes to exactly
+ * the loopbacks of nodes it can reach in the current topology.
+ *
+ * NOTE: Counters of fb303 are shared by all nodes, hence flood amplification
+ * is measured network-wide. Use from a single thread only.
+ */
+class Emulation {
+ public:
+  Emulation(EmulationTopology topology, EmulationParams params);
+  ~Emulation();
+
+  // No-copy
+  Emulation(const Emulation&) = delete;
+  Emulation& operator=(const Emulation&) = delete;
+
+  // start all nodes with all links up, and wait for convergence
+  EmulationStepResult start();
+
+  // apply event, and wait for convergence
+  EmulationStepResult runEvent(const EmulationEvent& event);
+
+  // loopback prefix advertised by node
+  static folly::CIDRNetwork getLoopbackPrefix(size_t nodeIdx);
+
+ private:
+  // interface of node on one end of link
+  struct Endpoint {
+    size_t nodeIdx{0};
+    InterfaceInfo interfaceInfo;
+  };
+
+  struct Snapshot {
+    std::chrono::steady_clock::time_point time;
+    std::map<std::string, int64_t> counters;
+    std::vector<std::chrono::nanoseconds> cpuTimes;
+  };
+
+  // set interfaces of link up or down on both ends
+  void setLinkState(size_t linkIdx, bool isUp);
+
+  // connect interfaces of links which are up in MockIoProvider
+  void updateConnectedPairs();
+
+  // id of connected component of every node over links which are up
+  std::vector<size_t> getComponentIds() const;
+
+  size_t getNumNodesWithWrongRoutes();
+
+  Snapshot takeSnapshot();
+
+  EmulationStepResult waitForConvergence(
+      std::string description, const Snapshot& before);
+
+  const EmulationTopology topology_;
+  const EmulationParams params_;
+
+  fbzmq::Context context_;
+  std::shared_ptr<MockIoProvider> mockIoProvider_;
+  std::thread mockIoProviderThread_;
+  SystemMetrics systemMetrics_;
+
+  std::unordered_map<std::string, size_t> nodeIndexes_;
+  std::vector<std::unique_ptr<OpenrWrapper<apache::thrift::CompactSerializer>>>
+      nodes_;
+  // both ends of every link of topology_
+  std::vector<std::pair<Endpoint, Endpoint>> endpoints_;
+  std::vector<bool> isLinkUp_;
+  // node index of each loopback prefix
+  std::unordered_map<folly::CIDRNetwork, size_t> loopbackNodes_;
+};
+
+} // namespace openr
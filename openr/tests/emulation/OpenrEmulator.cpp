@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <iostream>
+
+#include <fmt/format.h>
+#include <folly/FileUtil.h>
+#include <folly/init/Init.h>
+#include <glog/logging.h>
+
+#include <openr/tests/emulation/Emulation.h>
+
+DEFINE_string(topology_file, "", "Links of emulated network, see Emulation.h");
+DEFINE_string(scenario_file, "", "Events to run after start, see Emulation.h");
+DEFINE_int32(
+    quiet_period_ms, 5000, "Network is converged once fibs idle for this long");
+DEFINE_int32(convergence_timeout_s, 300, "Max time to wait for convergence");
+
+namespace {
+
+std::string
+readFileOrDie(const std::string& path) {
+  std::string content;
+  CHECK(folly::readFile(path.c_str(), content)) << "Failed to read " << path;
+  return content;
+}
+
+void
+printResult(const openr::EmulationStepResult& result) {
+  std::cout << fmt::format(
+                   "{:<32} converged: {:>8} wrong: {:>5} amplification: "
+                   "{:>6.2f} ({}/{}) cpu: {:>8}ms max: {:>6}ms ({}) "
+                   "rss/node: {:>6}KB",
+                   result.description,
+                   result.convergenceTime.has_value()
+                       ? fmt::format("{}ms", result.convergenceTime->count())
+                       : "no",
+                   result.numNodesWithWrongRoutes,
+                   result.getFloodAmplification(),
+                   result.numReceivedKeyVals,
+                   result.numUpdatedKeyVals,
+                   result.totalCpuTime.count() / 1000000,
+                   result.maxNodeCpuTime.count() / 1000000,
+                   result.maxCpuNode,
+                   result.rssBytesPerNode / 1024)
+            << std::endl;
+}
+
+} // namespace
+
+int
+main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  CHECK(not FLAGS_topology_file.empty()) << "--topology_file is required";
+
+  const auto topology =
+      openr::EmulationTopology::parse(readFileOrDie(FLAGS_topology_file));
+  std::vector<openr::EmulationEvent> events;
+  if (not FLAGS_scenario_file.empty()) {
+    events = openr::EmulationEvent::parseScenario(
+        readFileOrDie(FLAGS_scenario_file), topology);
+  }
+
+  openr::EmulationParams params;
+  params.quietPeriod = std::chrono::milliseconds(FLAGS_quiet_period_ms);
+  params.convergenceTimeout = std::chrono::seconds(FLAGS_convergence_timeout_s);
+
+  openr::Emulation emulation(topology, params);
+  printResult(emulation.start());
+  for (const auto& event : events) {
+    printResult(emulation.runEvent(event));
+  }
+  return 0;
+}
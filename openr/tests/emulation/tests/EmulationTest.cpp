@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <openr/tests/emulation/Emulation.h>
+
+using namespace openr;
+
+TEST(EmulationTest, ParseTopology) {
+  const auto topology = EmulationTopology::parse(
+      "# ring of three\n"
+      "node1 node2\n"
+      "\n"
+      "node2  node3 5  # slow link\n"
+      "node3\tnode1 0\n");
+  EXPECT_EQ(
+      std::vector<std::string>({"node1", "node2", "node3"}), topology.nodes);
+  ASSERT_EQ(3, topology.links.size());
+  EXPECT_EQ("node1", topology.links.at(0).node1);
+  EXPECT_EQ("node2", topology.links.at(0).node2);
+  EXPECT_EQ(1, topology.links.at(0).latencyMs);
+  EXPECT_EQ(5, topology.links.at(1).latencyMs);
+  EXPECT_EQ(0, topology.links.at(2).latencyMs);
+
+  EXPECT_TRUE(EmulationTopology::parse("").links.empty());
+  EXPECT_THROW(EmulationTopology::parse("node1\n"), std::invalid_argument);
+  EXPECT_THROW(
+      EmulationTopology::parse("node1 node1\n"), std::invalid_argument);
+  EXPECT_THROW(
+      EmulationTopology::parse("node1 node2 -1\n"), std::invalid_argument);
+  EXPECT_THROW(
+      EmulationTopology::parse("node1 node2 1 2\n"), std::invalid_argument);
+}
+
+TEST(EmulationTest, ParseScenario) {
+  const auto topology =
+      EmulationTopology::parse("node1 node2\nnode2 node3\n");
+  const auto events = EmulationEvent::parseScenario(
+      "link-down node2 node1\n"
+      "link-up node1 node2 # restore\n"
+      "node-down node3\n"
+      "node-up node3\n",
+      topology);
+  ASSERT_EQ(4, events.size());
+  EXPECT_EQ(EmulationEventType::LINK_DOWN, events.at(0).type);
+  EXPECT_EQ("link-down node2 node1", events.at(0).toString());
+  EXPECT_EQ(EmulationEventType::LINK_UP, events.at(1).type);
+  EXPECT_EQ(EmulationEventType::NODE_DOWN, events.at(2).type);
+  EXPECT_EQ("node3", events.at(2).node1);
+  EXPECT_TRUE(events.at(2).node2.empty());
+  EXPECT_EQ("node-up node3", events.at(3).toString());
+
+  // unknown event, node or link
+  EXPECT_THROW(
+      EmulationEvent::parseScenario("reboot node1\n", topology),
+      std::invalid_argument);
+  EXPECT_THROW(
+      EmulationEvent::parseScenario("node-down node4\n", topology),
+      std::invalid_argument);
+  EXPECT_THROW(
+      EmulationEvent::parseScenario("link-down node1 node3\n", topology),
+      std::invalid_argument);
+  EXPECT_THROW(
+      EmulationEvent::parseScenario("node-down node1 node2\n", topology),
+      std::invalid_argument);
+}
+
+TEST(EmulationTest, LoopbackPrefix) {
+  EXPECT_EQ(
+      folly::IPAddress::createNetwork("fd00::1/128"),
+      Emulation::getLoopbackPrefix(0));
+  EXPECT_EQ(
+      folly::IPAddress::createNetwork("fd00::7d0/128"),
+      Emulation::getLoopbackPrefix(1999));
+}
+
+int
+main(int argc, char** argv) {
+  // Basic initialization
+  testing::InitGoogleTest(&argc, argv);
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = true;
+
+  // Run the tests
+  return RUN_ALL_TESTS();
+}
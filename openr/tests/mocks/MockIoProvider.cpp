@@ -258,6 +258,62 @@ MockIoProvider::sendmsg(int sockFd, const struct msghdr* msg, int /* flags */) {
   return -1;
 }
 
+int
+MockIoProvider::recvmmsg(
+    int sockFd,
+    struct mmsghdr* msgvec,
+    unsigned int vlen,
+    int flags,
+    struct timespec* /* timeout */) {
+  VLOG(4) << "MockIoProvider::recvmmsg called";
+
+  unsigned int numRecvd = 0;
+  for (; numRecvd < vlen; ++numRecvd) {
+    // Spark is signaled of the first message only. Following messages are
+    // delivered along if they are due, so that latency is still emulated.
+    if (numRecvd > 0) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = mailboxes_.find(sockFd);
+      if (it == mailboxes_.end() or it->second.empty() or
+          not it->second.front().isActive()) {
+        break;
+      }
+    }
+    auto len = recvmsg(sockFd, &msgvec[numRecvd].msg_hdr, flags);
+    if (len < 0) {
+      break;
+    }
+    msgvec[numRecvd].msg_len = len;
+  }
+
+  if (numRecvd == 0) {
+    errno = EAGAIN;
+    return -1;
+  }
+  return numRecvd;
+}
+
+int
+MockIoProvider::sendmmsg(
+    int sockFd, struct mmsghdr* msgvec, unsigned int vlen, int flags) {
+  VLOG(4) << "MockIoProvider::sendmmsg called";
+
+  unsigned int numSent = 0;
+  for (; numSent < vlen; ++numSent) {
+    auto len = sendmsg(sockFd, &msgvec[numSent].msg_hdr, flags);
+    if (len < 0) {
+      break;
+    }
+    msgvec[numSent].msg_len = len;
+  }
+
+  if (numSent == 0) {
+    errno = ENETUNREACH;
+    return -1;
+  }
+  return numSent;
+}
+
 //
 // Simply accept all setsockopts, and build fd to ifName mapping
 //
@@ -97,6 +97,21 @@ class MockIoProvider final : public IoProvider {
 
   ssize_t sendmsg(int sockfd, const struct msghdr* msg, int flags) override;
 
+  // Batched variants deliver and send messages one by one as above. Only
+  // messages which are due are received.
+  int recvmmsg(
+      int sockfd,
+      struct mmsghdr* msgvec,
+      unsigned int vlen,
+      int flags,
+      struct timespec* timeout) override;
+
+  int sendmmsg(
+      int sockfd,
+      struct mmsghdr* msgvec,
+      unsigned int vlen,
+      int flags) override;
+
   int setsockopt(
       int sockfd,
       int level,
@@ -6,7 +6,9 @@
  */
 
 #include <unistd.h>
+#include <thread>
 
+#include <folly/Random.h>
 #include <folly/futures/Promise.h>
 #include <folly/gen/Base.h>
 #include <glog/logging.h>
@@ -41,6 +43,7 @@ void
 MockNetlinkFibHandler::addUnicastRoutes(
     int16_t, std::unique_ptr<std::vector<openr::thrift::UnicastRoute>> routes) {
   ensureHealthy();
+  injectLatency();
 
   // Acquire locks
   auto unicastRouteDb = unicastRouteDb_.wlock();
@@ -53,7 +56,7 @@ MockNetlinkFibHandler::addUnicastRoutes(
         toIPAddress(*route.dest_ref()->prefixAddress_ref()),
         *route.dest_ref()->prefixLength_ref());
 
-    if (dirtyPrefixes->count(prefix)) {
+    if (dirtyPrefixes->count(prefix) or injectError()) {
       failedPrefixes.emplace_back(*route.dest_ref());
       continue;
     }
@@ -83,6 +86,7 @@ void
 MockNetlinkFibHandler::deleteUnicastRoutes(
     int16_t, std::unique_ptr<std::vector<openr::thrift::IpPrefix>> prefixes) {
   ensureHealthy();
+  injectLatency();
 
   // Acquire locks
   auto unicastRouteDb = unicastRouteDb_.wlock();
@@ -102,6 +106,7 @@ void
 MockNetlinkFibHandler::syncFib(
     int16_t, std::unique_ptr<std::vector<openr::thrift::UnicastRoute>> routes) {
   ensureHealthy();
+  injectLatency();
 
   // Acquire locks
   auto unicastRouteDb = unicastRouteDb_.wlock();
@@ -115,7 +120,7 @@ MockNetlinkFibHandler::syncFib(
         toIPAddress(*route.dest_ref()->prefixAddress_ref()),
         *route.dest_ref()->prefixLength_ref());
 
-    if (dirtyPrefixes->count(prefix)) {
+    if (dirtyPrefixes->count(prefix) or injectError()) {
       failedPrefixesToAdd.emplace_back(*route.dest_ref());
       continue;
     }
@@ -160,6 +165,7 @@ void
 MockNetlinkFibHandler::addMplsRoutes(
     int16_t, std::unique_ptr<std::vector<openr::thrift::MplsRoute>> routes) {
   ensureHealthy();
+  injectLatency();
 
   // Acquire locks
   auto mplsRouteDb = mplsRouteDb_.wlock();
@@ -169,7 +175,7 @@ MockNetlinkFibHandler::addMplsRoutes(
   std::vector<int32_t> failedLabels;
   for (auto& route : *routes) {
     // If route is marked dirty add it to exception and continue
-    if (dirtyLabels->count(*route.topLabel_ref())) {
+    if (dirtyLabels->count(*route.topLabel_ref()) or injectError()) {
       failedLabels.emplace_back(*route.topLabel_ref());
       continue;
     }
@@ -192,6 +198,7 @@ void
 MockNetlinkFibHandler::deleteMplsRoutes(
     int16_t, std::unique_ptr<std::vector<int32_t>> labels) {
   ensureHealthy();
+  injectLatency();
 
   // Acquire locks
   auto mplsRouteDb = mplsRouteDb_.wlock();
@@ -208,6 +215,7 @@ void
 MockNetlinkFibHandler::syncMplsFib(
     int16_t, std::unique_ptr<std::vector<openr::thrift::MplsRoute>> routes) {
   ensureHealthy();
+  injectLatency();
 
   // Acquire locks
   auto mplsRouteDb = mplsRouteDb_.wlock();
@@ -218,7 +226,7 @@ MockNetlinkFibHandler::syncMplsFib(
   mplsRouteDb->clear();
   for (auto& route : *routes) {
     // If route is marked dirty add it to exception and continue
-    if (dirtyLabels->count(*route.topLabel_ref())) {
+    if (dirtyLabels->count(*route.topLabel_ref()) or injectError()) {
       failedLabelsToAdd.emplace_back(*route.topLabel_ref());
       continue;
     }
@@ -248,6 +256,18 @@ MockNetlinkFibHandler::syncMplsFib(
   }
 }
 
+apache::thrift::ServerStream<thrift::RouteOperationAck>
+MockNetlinkFibHandler::subscribeRouteAcks(int16_t clientId) {
+  return routeStreamServer_.subscribeRouteAcks(clientId);
+}
+
+#if FOLLY_HAS_COROUTINES
+apache::thrift::SinkConsumer<thrift::RouteOperationBatch, int64_t>
+MockNetlinkFibHandler::programRoutes(int16_t clientId) {
+  return routeStreamServer_.programRoutes(clientId);
+}
+#endif
+
 int64_t
 MockNetlinkFibHandler::aliveSince() {
   int64_t res = 0;
@@ -361,6 +381,7 @@ MockNetlinkFibHandler::stop() {
   fibMplsSyncCount_ = 0;
   addMplsRoutesCount_ = 0;
   delMplsRoutesCount_ = 0;
+  injectedErrorsCount_ = 0;
 }
 
 void
@@ -372,6 +393,7 @@ MockNetlinkFibHandler::restart() {
   startTime_.withWLock([&](auto& startTime) {
     startTime += 1; // Always increment on restart for unique number
   });
+  routeStreamServer_.close();
   fibSyncCount_ = 0;
   addRoutesCount_ = 0;
   delRoutesCount_ = 0;
@@ -380,6 +402,24 @@ MockNetlinkFibHandler::restart() {
   delMplsRoutesCount_ = 0;
 }
 
+void
+MockNetlinkFibHandler::injectLatency() {
+  if (const auto latencyUs = latencyUs_.load()) {
+    /* sleep override */
+    std::this_thread::sleep_for(std::chrono::microseconds(latencyUs));
+  }
+}
+
+bool
+MockNetlinkFibHandler::injectError() {
+  const double errorRate = errorRate_;
+  if (errorRate > 0 and folly::Random::randDouble01() < errorRate) {
+    ++injectedErrorsCount_;
+    return true;
+  }
+  return false;
+}
+
 void
 MockNetlinkFibHandler::ensureHealthy() {
   if (not isHealthy_) {
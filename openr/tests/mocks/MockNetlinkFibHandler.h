@@ -9,10 +9,11 @@
 
 #include <folly/IPAddress.h>
 
-#include <openr/if/gen-cpp2/FibService.h>
+#include <openr/if/gen-cpp2/FibServiceCpp.h>
 #include <openr/if/gen-cpp2/Platform_types.h>
 #include <openr/if/gen-cpp2/Types_types.h>
 #include <openr/messaging/Queue.h>
+#include <openr/platform/RouteStreamServer.h>
 
 namespace openr {
 
@@ -27,7 +28,7 @@ using UnicastRoutes = std::unordered_map<folly::CIDRNetwork, NextHops>;
  * NetlinkEvent Publisher as well as Fib Service on linux platform.
  */
 
-class MockNetlinkFibHandler final : public thrift::FibServiceSvIf {
+class MockNetlinkFibHandler final : public thrift::FibServiceCppSvIf {
  public:
   MockNetlinkFibHandler();
 
@@ -69,6 +70,14 @@ class MockNetlinkFibHandler final : public thrift::FibServiceSvIf {
       int16_t clientId,
       std::unique_ptr<std::vector<openr::thrift::MplsRoute>> routes) override;
 
+  apache::thrift::ServerStream<thrift::RouteOperationAck> subscribeRouteAcks(
+      int16_t clientId) override;
+
+#if FOLLY_HAS_COROUTINES
+  apache::thrift::SinkConsumer<thrift::RouteOperationBatch, int64_t>
+  programRoutes(int16_t clientId) override;
+#endif
+
   // Wait for adding/deleting routes to complete
   void waitForUpdateUnicastRoutes();
   void waitForDeleteUnicastRoutes();
@@ -127,6 +136,23 @@ class MockNetlinkFibHandler final : public thrift::FibServiceSvIf {
       std::vector<folly::CIDRNetwork> const& dirtyPrefixes,
       std::vector<int32_t> const& dirtyLabels);
 
+  /**
+   * Injects faults into route programming. Every call adding, deleting or
+   * syncing routes takes `latency` to return. Every route to add fails at
+   * `errorRate` probability, same as a dirty one.
+   */
+  void
+  setFaults(std::chrono::microseconds latency, double errorRate) {
+    latencyUs_ = latency.count();
+    errorRate_ = errorRate;
+  }
+
+  // Number of routes failed because of injected errors
+  size_t
+  getInjectedErrorsCount() {
+    return injectedErrorsCount_;
+  }
+
   void stop();
 
   void restart();
@@ -135,6 +161,12 @@ class MockNetlinkFibHandler final : public thrift::FibServiceSvIf {
   // Make sure the FibHandler is in healthy state. Else throw exception
   void ensureHealthy();
 
+  // Wait for injected latency
+  void injectLatency();
+
+  // True if route to add must fail as per injected error rate
+  bool injectError();
+
   // Time when service started, in number of seconds, since epoch
   folly::Synchronized<int64_t> startTime_{0};
 
@@ -159,6 +191,11 @@ class MockNetlinkFibHandler final : public thrift::FibServiceSvIf {
   std::atomic<size_t> delMplsRoutesCount_{0};
   std::atomic<bool> isHealthy_{true};
 
+  // Injected faults
+  std::atomic<int64_t> latencyUs_{0};
+  std::atomic<double> errorRate_{0};
+  std::atomic<size_t> injectedErrorsCount_{0};
+
   // A baton for synchronization
   folly::Baton<> updateUnicastRoutesBaton_;
   folly::Baton<> deleteUnicastRoutesBaton_;
@@ -170,6 +207,9 @@ class MockNetlinkFibHandler final : public thrift::FibServiceSvIf {
   // We use queue for signalling & waiting for unhealthy exceptions as it can
   // be repetitive
   messaging::RWQueue<folly::Unit> unhealthyExceptionQueue_;
+
+  // Streamed route programming, declared last to terminate ack streams first
+  RouteStreamServer routeStreamServer_{*this};
 };
 
 } // namespace openr
@@ -9,6 +9,8 @@
 #include <openr/tests/mocks/MockNetlinkProtocolSocket.h>
 
 #include <fb303/ServiceData.h>
+#include <folly/Random.h>
+#include <folly/futures/Future.h>
 
 namespace fb303 = facebook::fb303;
 
@@ -53,12 +55,38 @@ MockNetlinkProtocolSocket::MockNetlinkProtocolSocket(folly::EventBase* evb)
     : NetlinkProtocolSocket(evb, netlinkEventsQueue_) {
   // Initialize stats
   fb303::fbData->addStatExportType("nlmock.add_route", fb303::SUM);
+  fb303::fbData->addStatExportType("nlmock.add_routes", fb303::SUM);
   fb303::fbData->addStatExportType("nlmock.delete_route", fb303::SUM);
+  fb303::fbData->addStatExportType("nlmock.add_nexthop", fb303::SUM);
 }
 
 folly::SemiFuture<int>
 MockNetlinkProtocolSocket::addRoute(const fbnl::Route& route) {
+  return delayRouteOp(addRouteImpl(route));
+}
+
+folly::SemiFuture<std::vector<int>>
+MockNetlinkProtocolSocket::addRoutes(const std::vector<fbnl::Route>& routes) {
+  fb303::fbData->addStatValue("nlmock.add_routes", 1, fb303::SUM);
+  std::vector<int> statuses;
+  statuses.reserve(routes.size());
+  for (const auto& route : routes) {
+    statuses.emplace_back(addRouteImpl(route));
+  }
+  return delayRouteOp(std::move(statuses));
+}
+
+folly::SemiFuture<int>
+MockNetlinkProtocolSocket::deleteRoute(const fbnl::Route& route) {
+  return delayRouteOp(deleteRouteImpl(route));
+}
+
+int
+MockNetlinkProtocolSocket::addRouteImpl(const fbnl::Route& route) {
   fb303::fbData->addStatValue("nlmock.add_route", 1, fb303::SUM);
+  if (injectRouteError()) {
+    return -EIO;
+  }
   // Blindly replace existing route
   const auto proto = route.getProtocolId();
   if (route.getFamily() == AF_MPLS) {
@@ -66,12 +94,15 @@ MockNetlinkProtocolSocket::addRoute(const fbnl::Route& route) {
   } else {
     unicastRoutes_[proto][route.getDestination()] = route;
   }
-  return folly::SemiFuture<int>(0);
+  return 0;
 }
 
-folly::SemiFuture<int>
-MockNetlinkProtocolSocket::deleteRoute(const fbnl::Route& route) {
+int
+MockNetlinkProtocolSocket::deleteRouteImpl(const fbnl::Route& route) {
   fb303::fbData->addStatValue("nlmock.delete_route", 1, fb303::SUM);
+  if (injectRouteError()) {
+    return -EIO;
+  }
   // Count number of elements erased
   int cnt{0};
   const auto proto = route.getProtocolId();
@@ -81,7 +112,25 @@ MockNetlinkProtocolSocket::deleteRoute(const fbnl::Route& route) {
     cnt = unicastRoutes_[proto].erase(route.getDestination());
   }
   // Return 0 on success else ESRCH (no such process) error code
-  return folly::SemiFuture<int>(cnt ? 0 : ESRCH);
+  return cnt ? 0 : ESRCH;
+}
+
+bool
+MockNetlinkProtocolSocket::injectRouteError() const {
+  return routeErrorRate_ > 0 and
+      folly::Random::randDouble01() < routeErrorRate_;
+}
+
+template <typename T>
+folly::SemiFuture<T>
+MockNetlinkProtocolSocket::delayRouteOp(T&& status) const {
+  if (routeLatency_.count() == 0) {
+    return folly::SemiFuture<T>(std::forward<T>(status));
+  }
+  return folly::futures::sleep(routeLatency_)
+      .deferValue([status = std::forward<T>(status)](folly::Unit) mutable {
+        return std::move(status);
+      });
 }
 
 folly::SemiFuture<folly::Expected<std::vector<fbnl::Route>, int>>
@@ -107,7 +156,24 @@ MockNetlinkProtocolSocket::getRoutes(const fbnl::Route& filter) {
       return;
     }
 
+    // Resolve nexthops of the referenced group same as kernel does
     result.emplace_back(route);
+    auto groupIt = route.getNexthopId().has_value()
+        ? nexthopGroups_.find(route.getNexthopId().value())
+        : nexthopGroups_.end();
+    if (groupIt != nexthopGroups_.end()) {
+      fbnl::NextHopSet nextHops;
+      for (auto const& [id, weight] : groupIt->second) {
+        auto const& nh = nexthops_.at(id);
+        fbnl::NextHopBuilder nhBuilder;
+        nhBuilder.setIfIndex(nh.getIfIndex().value()).setWeight(weight);
+        if (nh.getGateway().has_value()) {
+          nhBuilder.setGateway(nh.getGateway().value());
+        }
+        nextHops.emplace(nhBuilder.build());
+      }
+      result.back().setNextHops(nextHops);
+    }
   };
 
   // Loop through mpls routes
@@ -210,4 +276,70 @@ MockNetlinkProtocolSocket::getAllNeighbors() {
   CHECK(false) << "Not implemented";
 }
 
+folly::SemiFuture<int>
+MockNetlinkProtocolSocket::addNexthop(
+    uint32_t id,
+    const fbnl::NextHop& nextHop,
+    uint8_t /* family */,
+    uint8_t protocolId) {
+  fb303::fbData->addStatValue("nlmock.add_nexthop", 1, fb303::SUM);
+  // Kernel doesn't allow replacing a group with a nexthop
+  if (nexthopGroups_.count(id) or not nextHop.getIfIndex().has_value()) {
+    return folly::SemiFuture<int>(-EINVAL);
+  }
+  nexthops_.insert_or_assign(id, nextHop);
+  nexthopProtocols_.insert_or_assign(id, protocolId);
+  return folly::SemiFuture<int>(0);
+}
+
+folly::SemiFuture<int>
+MockNetlinkProtocolSocket::addNexthopGroup(
+    uint32_t id,
+    const NexthopGroupMembers& members,
+    uint8_t protocolId) {
+  fb303::fbData->addStatValue("nlmock.add_nexthop", 1, fb303::SUM);
+  // All members must exist
+  if (nexthops_.count(id) or members.empty()) {
+    return folly::SemiFuture<int>(-EINVAL);
+  }
+  for (auto const& [memberId, _] : members) {
+    if (not nexthops_.count(memberId)) {
+      return folly::SemiFuture<int>(-EINVAL);
+    }
+  }
+  nexthopGroups_[id] = members;
+  nexthopProtocols_.insert_or_assign(id, protocolId);
+  return folly::SemiFuture<int>(0);
+}
+
+folly::SemiFuture<int>
+MockNetlinkProtocolSocket::deleteNexthop(uint32_t id) {
+  // Kernel removes routes referencing the deleted group
+  for (auto& [_, routes] : unicastRoutes_) {
+    for (auto it = routes.begin(); it != routes.end();) {
+      if (it->second.getNexthopId() == id) {
+        it = routes.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  const auto cnt = nexthops_.erase(id) + nexthopGroups_.erase(id);
+  nexthopProtocols_.erase(id);
+  return folly::SemiFuture<int>(cnt ? 0 : -ENOENT);
+}
+
+folly::SemiFuture<folly::Expected<std::vector<NexthopObject>, int>>
+MockNetlinkProtocolSocket::getAllNexthops() {
+  std::vector<NexthopObject> nexthops;
+  for (auto const& [id, _] : nexthops_) {
+    nexthops.emplace_back(NexthopObject{id, nexthopProtocols_.at(id), {}});
+  }
+  for (auto const& [id, members] : nexthopGroups_) {
+    nexthops.emplace_back(NexthopObject{id, nexthopProtocols_.at(id), members});
+  }
+  return folly::SemiFuture<folly::Expected<std::vector<NexthopObject>, int>>(
+      std::move(nexthops));
+}
+
 } // namespace openr::fbnl
@@ -47,10 +47,23 @@ class MockNetlinkProtocolSocket : public NetlinkProtocolSocket {
    */
   folly::SemiFuture<int> addLink(const fbnl::Link& link);
 
+  /**
+   * API to inject faults into route programming. Every route add or delete
+   * request, or a bulk of them, completes after `latency`. Every route fails
+   * with EIO at `errorRate` probability without changing the state.
+   */
+  void
+  setRouteFaults(std::chrono::microseconds latency, double errorRate) {
+    routeLatency_ = latency;
+    routeErrorRate_ = errorRate;
+  }
+
   /**
    * Overrides API of NetlinkProtocolSocket for testing
    */
   folly::SemiFuture<int> addRoute(const fbnl::Route& route) override;
+  folly::SemiFuture<std::vector<int>> addRoutes(
+      const std::vector<fbnl::Route>& routes) override;
   folly::SemiFuture<int> deleteRoute(const fbnl::Route& route) override;
   folly::SemiFuture<folly::Expected<std::vector<fbnl::Route>, int>> getRoutes(
       const fbnl::Route& filter) override;
@@ -66,6 +79,32 @@ class MockNetlinkProtocolSocket : public NetlinkProtocolSocket {
   folly::SemiFuture<folly::Expected<std::vector<fbnl::Neighbor>, int>>
   getAllNeighbors() override;
 
+  folly::SemiFuture<int> addNexthop(
+      uint32_t id,
+      const fbnl::NextHop& nextHop,
+      uint8_t family,
+      uint8_t protocolId) override;
+  folly::SemiFuture<int> addNexthopGroup(
+      uint32_t id,
+      const NexthopGroupMembers& members,
+      uint8_t protocolId) override;
+  folly::SemiFuture<int> deleteNexthop(uint32_t id) override;
+  folly::SemiFuture<folly::Expected<std::vector<NexthopObject>, int>>
+  getAllNexthops() override;
+
+  /*
+   * API to inspect nexthop objects and groups
+   */
+  size_t
+  getNexthopCount() const {
+    return nexthops_.size();
+  }
+
+  size_t
+  getNexthopGroupCount() const {
+    return nexthopGroups_.size();
+  }
+
   /*
    * API to manipulate netlinkEvents queue
    */
@@ -91,6 +130,21 @@ class MockNetlinkProtocolSocket : public NetlinkProtocolSocket {
   }
 
  private:
+  // Program route in memory and return its status
+  int addRouteImpl(const fbnl::Route& route);
+  int deleteRouteImpl(const fbnl::Route& route);
+
+  // True if route operation must fail as per injected error rate
+  bool injectRouteError() const;
+
+  // Complete route operation after injected latency
+  template <typename T>
+  folly::SemiFuture<T> delayRouteOp(T&& status) const;
+
+  // Injected faults of route programming
+  std::chrono::microseconds routeLatency_{0};
+  double routeErrorRate_{0};
+
   // map<ifIndex -> Link>
   // NOTE: using map for ordered entries
   std::map<int, fbnl::Link> links_;
@@ -105,6 +159,12 @@ class MockNetlinkProtocolSocket : public NetlinkProtocolSocket {
       unicastRoutes_;
   std::unordered_map<uint8_t, std::map<uint32_t, fbnl::Route>> mplsRoutes_;
 
+  // map<nexthop-id -> NextHop> and map<group-id -> members>
+  std::unordered_map<uint32_t, fbnl::NextHop> nexthops_;
+  std::unordered_map<uint32_t, NexthopGroupMembers> nexthopGroups_;
+  // map<nexthop or group id -> protocolId>
+  std::unordered_map<uint32_t, uint8_t> nexthopProtocols_;
+
   // queue to publish LINK/ADDR updates
   messaging::ReplicateQueue<NetlinkEvent> netlinkEventsQueue_;
 };
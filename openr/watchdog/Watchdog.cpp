@@ -5,7 +5,17 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <thread>
+
 #include <fb303/ServiceData.h>
+#include <folly/String.h>
+#include <folly/experimental/symbolizer/StackTrace.h>
+#include <folly/experimental/symbolizer/Symbolizer.h>
 #include <folly/logging/xlog.h>
 #include <openr/common/Constants.h>
 #include <openr/common/Util.h>
@@ -15,12 +25,147 @@ namespace fb303 = facebook::fb303;
 
 namespace openr {
 
+namespace {
+
+// [Module Accounting] Usage of thread as of previous update
+struct ThreadUsage {
+  std::chrono::steady_clock::time_point timestamp;
+  std::chrono::nanoseconds cpuTime{0};
+  uint64_t allocBytes{0};
+  uint64_t deallocBytes{0};
+};
+
+/**
+ * [Module Accounting]
+ * Export CPU time and allocations of the calling evb thread since previous
+ * update, as rates and CPU% of the update interval. Previous usage is kept on
+ * the thread itself.
+ */
+void
+updateThreadUsageCounters(
+    const std::string& name, uint64_t allocBytes, uint64_t deallocBytes) {
+  static thread_local std::optional<ThreadUsage> prevUsage;
+
+  ThreadUsage usage;
+  usage.timestamp = std::chrono::steady_clock::now();
+  usage.cpuTime = SystemMetrics::getThreadCpuTime().value_or(
+      std::chrono::nanoseconds(0));
+  usage.allocBytes = allocBytes;
+  usage.deallocBytes = deallocBytes;
+
+  fb303::fbData->setCounter(
+      fmt::format("watchdog.thread_cpu_time_ms.{}", name),
+      std::chrono::duration_cast<std::chrono::milliseconds>(usage.cpuTime)
+          .count());
+  if (prevUsage.has_value() and usage.cpuTime >= prevUsage->cpuTime and
+      usage.allocBytes >= prevUsage->allocBytes and
+      usage.deallocBytes >= prevUsage->deallocBytes) {
+    const auto elapsed = usage.timestamp - prevUsage->timestamp;
+    const auto cpuTime = usage.cpuTime - prevUsage->cpuTime;
+    if (elapsed.count() > 0) {
+      fb303::fbData->setCounter(
+          fmt::format("watchdog.thread_cpu_pct.{}", name),
+          std::lround(100.0 * cpuTime / elapsed));
+    }
+    fb303::fbData->addStatValue(
+        fmt::format("watchdog.thread_cpu_us.{}", name),
+        std::chrono::duration_cast<std::chrono::microseconds>(cpuTime).count(),
+        fb303::RATE);
+    fb303::fbData->addStatValue(
+        fmt::format("watchdog.thread_alloc_bytes.{}", name),
+        usage.allocBytes - prevUsage->allocBytes,
+        fb303::RATE);
+    fb303::fbData->addStatValue(
+        fmt::format("watchdog.thread_dealloc_bytes.{}", name),
+        usage.deallocBytes - prevUsage->deallocBytes,
+        fb303::RATE);
+  }
+  prevUsage = usage;
+}
+
+/**
+ * [Stall Detection]
+ * Stack of a stalled thread is captured by the thread itself, on signal. A
+ * single capture is in flight at a time, requested by watchdog thread only.
+ */
+constexpr int kStallSignal{SIGUSR2};
+std::array<uintptr_t, 64> stallFrames;
+std::atomic<ssize_t> numStallFrames{-1};
+std::atomic<bool> stallFramesReady{false};
+
+void
+onStallSignal(int /* signum */) {
+  // NOTE: async-signal-safe calls only
+  numStallFrames.store(folly::symbolizer::getStackTraceSafe(
+      stallFrames.data(), stallFrames.size()));
+  stallFramesReady.store(true);
+}
+
+void
+installStallSignalHandler() {
+  struct sigaction sa {};
+  sa.sa_handler = onStallSignal;
+  sa.sa_flags = SA_RESTART;
+  sigemptyset(&sa.sa_mask);
+  if (sigaction(kStallSignal, &sa, nullptr) != 0) {
+    XLOG(ERR) << "[Stall Detector] Failed to install signal handler: "
+              << folly::errnoStr(errno);
+  }
+}
+
+// Symbolized stack of `thread`, std::nullopt if not captured in time
+std::optional<std::string>
+captureStack(pthread_t thread) {
+  stallFramesReady.store(false);
+  if (pthread_kill(thread, kStallSignal) != 0) {
+    return std::nullopt;
+  }
+  // NOTE: a capture which times out may still land in a later one
+  const auto deadline =
+      std::chrono::steady_clock::now() + Constants::kStallStackTimeout;
+  while (not stallFramesReady.load()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return std::nullopt;
+    }
+    /* sleep override */
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  const auto numFrames = numStallFrames.load();
+  if (numFrames <= 0) {
+    return std::nullopt;
+  }
+
+  std::vector<folly::symbolizer::SymbolizedFrame> frames(numFrames);
+  folly::symbolizer::Symbolizer symbolizer;
+  symbolizer.symbolize(stallFrames.data(), frames.data(), numFrames);
+  folly::symbolizer::StringSymbolizePrinter printer;
+  printer.println(frames.data(), numFrames);
+  return printer.str();
+}
+
+} // namespace
+
 Watchdog::Watchdog(std::shared_ptr<const Config> config)
     : myNodeName_(config->getNodeName()),
       interval_(*config->getWatchdogConfig().interval_s_ref()),
       threadTimeout_(*config->getWatchdogConfig().thread_timeout_s_ref()),
       maxMemoryMB_(*config->getWatchdogConfig().max_memory_mb_ref()),
-      isDeadThreadDetected_(false) {
+      stallThreshold_(
+          *config->getWatchdogConfig().stall_threshold_ms_ref()),
+      isDeadThreadDetected_(false),
+      heapProfileThresholdsPct_(
+          *config->getWatchdogConfig().heap_profile_thresholds_pct_ref()),
+      heapProfileMinInterval_(
+          *config->getWatchdogConfig().heap_profile_min_interval_s_ref()),
+      heapProfilePrefix_(
+          *config->getWatchdogConfig().heap_profile_prefix_ref()),
+      heapProfileMaxDumps_(
+          *config->getWatchdogConfig().heap_profile_max_dumps_ref()),
+      memoryPressureThresholdsPct_(
+          *config->getWatchdogConfig()
+               .memory_pressure_thresholds_pct_ref()) {
+  std::sort(heapProfileThresholdsPct_.begin(), heapProfileThresholdsPct_.end());
+
   // Schedule periodic timer for checking thread health
   watchdogTimer_ = folly::AsyncTimeout::make(*getEvb(), [this]() noexcept {
     // check dead thread
@@ -39,6 +184,16 @@ Watchdog::Watchdog(std::shared_ptr<const Config> config)
     watchdogTimer_->scheduleTimeout(interval_);
   });
   watchdogTimer_->scheduleTimeout(interval_);
+
+  // Check for stalls at twice the rate of soft threshold
+  if (stallThreshold_.count() > 0) {
+    installStallSignalHandler();
+    stallTimer_ = folly::AsyncTimeout::make(*getEvb(), [this]() noexcept {
+      monitorStalls();
+      stallTimer_->scheduleTimeout(stallThreshold_ / 2);
+    });
+    stallTimer_->scheduleTimeout(stallThreshold_ / 2);
+  }
 }
 
 void
@@ -59,6 +214,23 @@ Watchdog::addQueue(messaging::ReplicateQueueBase& q, const std::string& qName) {
   }
 }
 
+void
+Watchdog::addMemoryPressureHandler(MemoryPressureHandler handler) {
+  CHECK(handler);
+  getEvb()->runInEventBaseThreadAndWait(
+      [this, handler = std::move(handler)]() mutable {
+        memoryPressureHandlers_.emplace_back(std::move(handler));
+      });
+}
+
+MemoryPressureLevel
+Watchdog::getMemoryPressureLevel() {
+  MemoryPressureLevel result;
+  getEvb()->runImmediatelyOrRunInEventBaseThreadAndWait(
+      [&result, this]() { result = memoryPressureLevel_; });
+  return result;
+}
+
 bool
 Watchdog::memoryLimitExceeded() {
   bool result;
@@ -73,6 +245,8 @@ Watchdog::monitorMemory() {
   if (not memInUse_.has_value()) {
     return;
   }
+  maybeDumpHeapProfile(memInUse_.value() / 1e6);
+  updateMemoryPressure(memInUse_.value() / 1e6);
   if (memInUse_.value() / 1e6 > maxMemoryMB_) {
     XLOG(WARNING) << fmt::format(
         "[Mem Detector] Critical memory usage: {} bytes. Memory limit: {} MB.",
@@ -100,6 +274,118 @@ Watchdog::monitorMemory() {
   }
 }
 
+size_t
+Watchdog::getHeapProfileLevel(
+    double memUsedMB,
+    uint32_t maxMemoryMB,
+    const std::vector<int32_t>& thresholdsPct) {
+  if (maxMemoryMB == 0) {
+    return 0;
+  }
+  const double pct = 100.0 * memUsedMB / maxMemoryMB;
+  return std::upper_bound(thresholdsPct.begin(), thresholdsPct.end(), pct) -
+      thresholdsPct.begin();
+}
+
+MemoryPressureLevel
+Watchdog::getMemoryPressureLevel(
+    double memUsedMB,
+    uint32_t maxMemoryMB,
+    const std::vector<int32_t>& thresholdsPct,
+    MemoryPressureLevel currentLevel) {
+  const auto level = static_cast<MemoryPressureLevel>(
+      getHeapProfileLevel(memUsedMB, maxMemoryMB, thresholdsPct));
+  if (level >= currentLevel) {
+    return level;
+  }
+  // stay in a stage until memory falls below its threshold by hysteresis
+  const double hysteresisMB =
+      maxMemoryMB * Constants::kMemoryPressureHysteresisPct / 100.0;
+  return std::min(
+      currentLevel,
+      static_cast<MemoryPressureLevel>(getHeapProfileLevel(
+          memUsedMB + hysteresisMB, maxMemoryMB, thresholdsPct)));
+}
+
+void
+Watchdog::updateMemoryPressure(double memUsedMB) {
+  const auto level = getMemoryPressureLevel(
+      memUsedMB,
+      maxMemoryMB_,
+      memoryPressureThresholdsPct_,
+      memoryPressureLevel_);
+  fb303::fbData->setCounter(
+      "watchdog.memory_pressure.level", static_cast<int64_t>(level));
+  if (level == memoryPressureLevel_) {
+    return;
+  }
+
+  XLOG(WARNING) << fmt::format(
+      "[Memory Governor] Memory usage {} MB out of limit {} MB, memory "
+      "pressure level changes from {} to {}",
+      memUsedMB,
+      maxMemoryMB_,
+      toString(memoryPressureLevel_),
+      toString(level));
+  fb303::fbData->addStatValue(
+      level > memoryPressureLevel_ ? "watchdog.memory_pressure.escalations"
+                                   : "watchdog.memory_pressure.relaxations",
+      1,
+      fb303::COUNT);
+  memoryPressureLevel_ = level;
+  for (const auto& handler : memoryPressureHandlers_) {
+    handler(level);
+  }
+}
+
+void
+Watchdog::maybeDumpHeapProfile(double memUsedMB) {
+  const auto level =
+      getHeapProfileLevel(memUsedMB, maxMemoryMB_, heapProfileThresholdsPct_);
+  if (level <= heapProfileLevel_) {
+    // re-arm thresholds memory fell below
+    heapProfileLevel_ = level;
+    return;
+  }
+
+  // rate limit dumps, threshold is retried on next check
+  const auto now = std::chrono::steady_clock::now();
+  if (lastHeapProfileTime_.has_value() and
+      now - lastHeapProfileTime_.value() < heapProfileMinInterval_) {
+    fb303::fbData->addStatValue(
+        "watchdog.heap_profile.rate_limited", 1, fb303::COUNT);
+    return;
+  }
+  lastHeapProfileTime_ = now;
+  heapProfileLevel_ = level;
+
+  const auto path =
+      fmt::format("{}.{}.heap", heapProfilePrefix_, heapProfileSeqNum_++);
+  try {
+    memory::dumpHeapProfile(path);
+  } catch (const std::exception& ex) {
+    XLOG(ERR) << "[Heap Profiling] Failed to dump heap profile: " << ex.what();
+    fb303::fbData->addStatValue(
+        "watchdog.heap_profile.failures", 1, fb303::COUNT);
+    return;
+  }
+  XLOG(INFO) << fmt::format(
+      "[Heap Profiling] Memory usage {} MB reached {}% of limit {} MB. "
+      "Heap profile dumped to {}",
+      memUsedMB,
+      heapProfileThresholdsPct_.at(level - 1),
+      maxMemoryMB_,
+      path);
+  fb303::fbData->addStatValue("watchdog.heap_profile.dumps", 1, fb303::COUNT);
+
+  // rotate out oldest dumps
+  heapProfilePaths_.emplace_back(path);
+  while (heapProfilePaths_.size() > heapProfileMaxDumps_) {
+    std::remove(heapProfilePaths_.front().c_str());
+    heapProfilePaths_.pop_front();
+  }
+}
+
 void
 Watchdog::monitorThreadStatus() {
   // Use steady_clock for watchdog as system_clock can change
@@ -137,11 +423,65 @@ Watchdog::monitorThreadStatus() {
   isDeadThreadDetected_ = (stuckThreads.size() ? true : false);
 }
 
+void
+Watchdog::monitorStalls() {
+  const auto now = std::chrono::steady_clock::now();
+  for (auto const& evb : monitorEvbs_) {
+    // heartbeat timestamp lags by up to heartbeat interval in a healthy loop
+    const auto lastTs = evb->getTimestamp();
+    const auto stallTime =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            now - lastTs - OpenrEventBase::kHeartbeatInterval);
+    if (stallTime < stallThreshold_) {
+      stalledEvbs_.erase(evb);
+      continue;
+    }
+    // report every stall once
+    auto [it, inserted] = stalledEvbs_.emplace(evb, lastTs);
+    if (not inserted and it->second == lastTs) {
+      continue;
+    }
+    it->second = lastTs;
+
+    const auto name = evb->getEvbName();
+    std::string task;
+    if (const auto runningTask = evb->getRunningTask()) {
+      task = fmt::format(
+          ", running {} for {}ms",
+          runningTask->tag,
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+              now - runningTask->startTime)
+              .count());
+    }
+    std::optional<std::string> stack;
+    if (const auto thread = evb->getThread()) {
+      stack = captureStack(*thread);
+    }
+    XLOG(WARNING) << fmt::format(
+        "[Stall Detector] {} thread stalled for {}ms{}. Stack:\n{}",
+        name,
+        stallTime.count(),
+        task,
+        stack.value_or("<not captured>"));
+
+    fb303::fbData->addStatValue(
+        fmt::format("watchdog.stalls.{}", name), 1, fb303::COUNT);
+    fb303::fbData->addStatValue(
+        fmt::format("watchdog.stall_ms.{}", name),
+        stallTime.count(),
+        fb303::AVG);
+    if (not stack.has_value()) {
+      fb303::fbData->addStatValue(
+          "watchdog.stall_stack_failures", 1, fb303::COUNT);
+    }
+  }
+}
+
 void
 Watchdog::updateThreadCounters() {
   for (auto& evb : monitorEvbs_) {
     // Asynchronously fetch thread mem usage data inside each individual evb
-    evb->runInEventBaseThread([name = evb->getEvbName()]() {
+    evb->runInEventBaseThread([evb, name = evb->getEvbName()]() {
       auto allocBytes = memory::getThreadBytesImpl(true);
       auto deallocBytes = memory::getThreadBytesImpl(false);
       auto diff =
@@ -149,6 +489,27 @@ Watchdog::updateThreadCounters() {
 
       fb303::fbData->setCounter(
           fmt::format("watchdog.thread_mem_usage_kb.{}", name), diff);
+      updateThreadUsageCounters(name, allocBytes, deallocBytes);
+
+      // Loop lag, busy ratio and longest tasks since previous update
+      const auto stats = evb->getStats();
+      fb303::fbData->setCounter(
+          fmt::format("watchdog.evb_loop_lag_p50_us.{}", name),
+          stats.loopLagP50.count());
+      fb303::fbData->setCounter(
+          fmt::format("watchdog.evb_loop_lag_p99_us.{}", name),
+          stats.loopLagP99.count());
+      fb303::fbData->setCounter(
+          fmt::format("watchdog.evb_loop_lag_max_us.{}", name),
+          stats.loopLagMax.count());
+      fb303::fbData->setCounter(
+          fmt::format("watchdog.evb_busy_pct.{}", name),
+          std::lround(stats.busyPct));
+      for (const auto& [tag, duration] : stats.longestTasks) {
+        fb303::fbData->setCounter(
+            fmt::format("watchdog.evb_task_max_us.{}.{}", name, tag),
+            duration.count());
+      }
     });
 
     // Record eventbase's notification queue size to support memory check
@@ -196,6 +557,25 @@ Watchdog::updateQueueCounters() {
       fb303::fbData->setCounter(
           fmt::format("messaging.rw_queue.{}-{}.sent", qName, stat.queueId),
           stat.writes);
+
+      fb303::fbData->setCounter(
+          fmt::format("messaging.rw_queue.{}-{}.dropped", qName, stat.queueId),
+          stat.drops);
+
+      fb303::fbData->setCounter(
+          fmt::format(
+              "messaging.rw_queue.{}-{}.latency_us.p50", qName, stat.queueId),
+          stat.latencyP50Us);
+
+      fb303::fbData->setCounter(
+          fmt::format(
+              "messaging.rw_queue.{}-{}.latency_us.p99", qName, stat.queueId),
+          stat.latencyP99Us);
+
+      fb303::fbData->setCounter(
+          fmt::format(
+              "messaging.rw_queue.{}-{}.latency_us.max", qName, stat.queueId),
+          stat.latencyMaxUs);
     }
   }
 }
@@ -7,9 +7,13 @@
 
 #pragma once
 
+#include <deque>
+#include <functional>
+
 #include <folly/container/F14Map.h>
 #include <folly/container/F14Set.h>
 #include <folly/io/async/AsyncTimeout.h>
+#include <openr/common/MemoryPressure.h>
 #include <openr/common/OpenrEventBase.h>
 #include <openr/config/Config.h>
 #include <openr/messaging/ReplicateQueue.h>
@@ -34,13 +38,53 @@ class Watchdog final : public OpenrEventBase {
    */
   void addQueue(messaging::ReplicateQueueBase& q, const std::string& qName);
 
+  /**
+   * [Heap Profiling] Number of `thresholdsPct` reached by memory usage of
+   * `memUsedMB` out of `maxMemoryMB`. Thresholds must be sorted.
+   */
+  static size_t getHeapProfileLevel(
+      double memUsedMB,
+      uint32_t maxMemoryMB,
+      const std::vector<int32_t>& thresholdsPct);
+
+  /**
+   * [Memory Governor] Register handler of memory pressure level changes.
+   * Handlers are called on watchdog thread, and must hand work over to the
+   * thread of their module.
+   */
+  using MemoryPressureHandler = std::function<void(MemoryPressureLevel)>;
+  void addMemoryPressureHandler(MemoryPressureHandler handler);
+
+  /**
+   * [Memory Governor] Level of memory pressure at `memUsedMB` out of
+   * `maxMemoryMB`, given the current level. Level is raised as memory grows
+   * past sorted `thresholdsPct`, and lowered only once it falls
+   * `kMemoryPressureHysteresisPct` below them.
+   */
+  static MemoryPressureLevel getMemoryPressureLevel(
+      double memUsedMB,
+      uint32_t maxMemoryMB,
+      const std::vector<int32_t>& thresholdsPct,
+      MemoryPressureLevel currentLevel);
+
+  MemoryPressureLevel getMemoryPressureLevel();
+
  private:
   // monitor thread status in case they get stuck
   void monitorThreadStatus();
 
+  // [Stall Detection] log stack of threads stalled past soft threshold
+  void monitorStalls();
+
   // monitor memory usage
   void monitorMemory();
 
+  // [Heap Profiling] dump heap profile when memory grows past a threshold
+  void maybeDumpHeapProfile(double memUsedMB);
+
+  // [Memory Governor] update memory pressure level and notify handlers
+  void updateMemoryPressure(double memUsedMB);
+
   // update per-eventbase related counters
   void updateThreadCounters();
 
@@ -70,12 +114,40 @@ class Watchdog final : public OpenrEventBase {
   // critcal memory threhsold
   uint32_t maxMemoryMB_{0};
 
+  // [Stall Detection] soft stall threshold, 0 if disabled, and its timer
+  const std::chrono::milliseconds stallThreshold_{0};
+  std::unique_ptr<folly::AsyncTimeout> stallTimer_{nullptr};
+
+  // [Stall Detection] heartbeat timestamp of stalled evbs, already reported
+  folly::F14FastMap<OpenrEventBase*, std::chrono::steady_clock::time_point>
+      stalledEvbs_;
+
   // boolean to indicate previous failure
   bool isDeadThreadDetected_{false};
 
   // amount of time memory usage sustained above memory limit
   std::optional<std::chrono::steady_clock::time_point> memExceedTime_;
 
+  // [Heap Profiling] sorted soft thresholds, in percent of maxMemoryMB_
+  std::vector<int32_t> heapProfileThresholdsPct_;
+
+  // [Heap Profiling] number of thresholds already dumped at
+  size_t heapProfileLevel_{0};
+
+  // [Heap Profiling] rate limit and rotation of dumps
+  const std::chrono::seconds heapProfileMinInterval_;
+  const std::string heapProfilePrefix_;
+  const size_t heapProfileMaxDumps_{0};
+  std::optional<std::chrono::steady_clock::time_point> lastHeapProfileTime_;
+  uint64_t heapProfileSeqNum_{0};
+  std::deque<std::string> heapProfilePaths_;
+
+  // [Memory Governor] stage thresholds, in percent of maxMemoryMB_, current
+  // level and handlers notified of its changes
+  const std::vector<int32_t> memoryPressureThresholdsPct_;
+  MemoryPressureLevel memoryPressureLevel_{MemoryPressureLevel::NONE};
+  std::vector<MemoryPressureHandler> memoryPressureHandlers_;
+
   // Get the system metrics for resource usage counters
   SystemMetrics systemMetrics_{};
 
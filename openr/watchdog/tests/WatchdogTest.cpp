@@ -21,6 +21,7 @@ using namespace openr;
 
 namespace {
 const std::chrono::seconds kWatchdogInterval{2};
+const std::chrono::milliseconds kStallThreshold{300};
 } // namespace
 
 class WatchdogTestFixture : public ::testing::Test {
@@ -30,6 +31,7 @@ class WatchdogTestFixture : public ::testing::Test {
     // create config
     thrift::WatchdogConfig watchdogConf;
     watchdogConf.set_interval_s(kWatchdogInterval.count());
+    watchdogConf.stall_threshold_ms_ref() = kStallThreshold.count();
 
     auto tConfig = getBasicOpenrConfig(nodeId_);
     tConfig.set_watchdog_config(watchdogConf);
@@ -108,6 +110,12 @@ TEST_F(WatchdogTestFixture, CounterReport) {
             "watchdog.evb_queue_size.{}", dummyEvb_->getEvbName())));
         ASSERT_TRUE(counters.count(fmt::format(
             "watchdog.thread_mem_usage_kb.{}", dummyEvb_->getEvbName())));
+        ASSERT_TRUE(counters.count(fmt::format(
+            "watchdog.evb_loop_lag_p99_us.{}", dummyEvb_->getEvbName())));
+        ASSERT_TRUE(counters.count(fmt::format(
+            "watchdog.evb_busy_pct.{}", dummyEvb_->getEvbName())));
+        ASSERT_TRUE(counters.count(fmt::format(
+            "watchdog.thread_cpu_time_ms.{}", dummyEvb_->getEvbName())));
 
         evb.stop();
       });
@@ -182,6 +190,10 @@ TEST_F(WatchdogTestFixture, QueueCounterReport) {
               fb303::fbData->getCounter(fmt::format(
                   "messaging.rw_queue.{}-{}.sent", "Queue1", stat.queueId)),
               stat.writes);
+          ASSERT_EQ(
+              fb303::fbData->getCounter(fmt::format(
+                  "messaging.rw_queue.{}-{}.dropped", "Queue1", stat.queueId)),
+              stat.drops);
         }
         stats = q2.getReplicationStats();
         for (auto& stat : stats) {
@@ -206,6 +218,88 @@ TEST_F(WatchdogTestFixture, QueueCounterReport) {
   teardownDummyEvb();
 }
 
+TEST_F(WatchdogTestFixture, StallDetection) {
+  fb303::fbData->resetAllData();
+  setupDummyEvb();
+
+  // stall dummyEvb past soft threshold, within a tagged task
+  dummyEvb_->getEvb()->runInEventBaseThreadAndWait([&]() {
+    const auto startTime = dummyEvb_->startTask("blocking");
+    /* sleep override */
+    std::this_thread::sleep_for(4 * kStallThreshold);
+    dummyEvb_->recordTaskDuration("blocking", startTime);
+  });
+  /* sleep override */
+  std::this_thread::sleep_for(kStallThreshold);
+
+  // reported once per stall
+  const auto counters = fb303::fbData->getCounters();
+  EXPECT_EQ(
+      1,
+      counters.at(
+          fmt::format("watchdog.stalls.{}.count", dummyEvb_->getEvbName())));
+  EXPECT_GE(
+      counters.at(
+          fmt::format("watchdog.stall_ms.{}.avg", dummyEvb_->getEvbName())),
+      kStallThreshold.count());
+  teardownDummyEvb();
+}
+
+TEST(WatchdogTest, HeapProfileLevel) {
+  const std::vector<int32_t> thresholds{70, 85};
+  EXPECT_EQ(0, Watchdog::getHeapProfileLevel(0, 800, thresholds));
+  EXPECT_EQ(0, Watchdog::getHeapProfileLevel(559, 800, thresholds));
+  EXPECT_EQ(1, Watchdog::getHeapProfileLevel(560, 800, thresholds));
+  EXPECT_EQ(1, Watchdog::getHeapProfileLevel(679, 800, thresholds));
+  EXPECT_EQ(2, Watchdog::getHeapProfileLevel(680, 800, thresholds));
+  EXPECT_EQ(2, Watchdog::getHeapProfileLevel(1000, 800, thresholds));
+
+  // no threshold or no limit
+  EXPECT_EQ(0, Watchdog::getHeapProfileLevel(1000, 800, {}));
+  EXPECT_EQ(0, Watchdog::getHeapProfileLevel(1000, 0, thresholds));
+}
+
+TEST(WatchdogTest, MemoryPressureLevel) {
+  const std::vector<int32_t> thresholds{70, 80, 90, 95};
+  const auto level = [&thresholds](double memUsedMB, auto currentLevel) {
+    return Watchdog::getMemoryPressureLevel(
+        memUsedMB, 1000, thresholds, currentLevel);
+  };
+
+  // escalation straight to the stage of current usage
+  EXPECT_EQ(MemoryPressureLevel::NONE, level(699, MemoryPressureLevel::NONE));
+  EXPECT_EQ(
+      MemoryPressureLevel::SHRINK_CACHES,
+      level(700, MemoryPressureLevel::NONE));
+  EXPECT_EQ(
+      MemoryPressureLevel::REJECT_DUMPS,
+      level(960, MemoryPressureLevel::SHRINK_CACHES));
+
+  // relaxation only once usage falls below threshold by hysteresis
+  EXPECT_EQ(
+      MemoryPressureLevel::SHRINK_CACHES,
+      level(660, MemoryPressureLevel::SHRINK_CACHES));
+  EXPECT_EQ(
+      MemoryPressureLevel::NONE,
+      level(640, MemoryPressureLevel::SHRINK_CACHES));
+  EXPECT_EQ(
+      MemoryPressureLevel::REJECT_DUMPS,
+      level(940, MemoryPressureLevel::REJECT_DUMPS));
+  EXPECT_EQ(
+      MemoryPressureLevel::COMPACT_LOGS,
+      level(890, MemoryPressureLevel::REJECT_DUMPS));
+
+  // governor disabled without thresholds or limit
+  EXPECT_EQ(
+      MemoryPressureLevel::NONE,
+      Watchdog::getMemoryPressureLevel(
+          1000, 1000, {}, MemoryPressureLevel::NONE));
+  EXPECT_EQ(
+      MemoryPressureLevel::NONE,
+      Watchdog::getMemoryPressureLevel(
+          1000, 0, thresholds, MemoryPressureLevel::NONE));
+}
+
 int
 main(int argc, char* argv[]) {
   // Parse command line flags